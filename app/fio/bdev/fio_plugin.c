@@ -72,7 +72,8 @@ struct spdk_fio_thread {
 	bool				failed; /* true if the thread failed to initialize */
 
 	struct io_u		**iocq;		/* io completion queue */
-	unsigned int		iocq_count;	/* number of iocq entries filled by last getevents */
+	unsigned int		iocq_count;	/* number of iocq entries filled */
+	unsigned int		iocq_reaped;	/* number of iocq entries returned by last getevents */
 	unsigned int		iocq_size;	/* number of iocq entries allocated */
 
 	TAILQ_ENTRY(spdk_fio_thread)	link;
@@ -997,7 +998,7 @@ spdk_fio_event(struct thread_data *td, int event)
 	struct spdk_fio_thread *fio_thread = td->io_ops_data;
 
 	assert(event >= 0);
-	assert((unsigned)event < fio_thread->iocq_count);
+	assert((unsigned)event < fio_thread->iocq_reaped);
 	return fio_thread->iocq[event];
 }
 
@@ -1007,6 +1008,33 @@ spdk_fio_poll_thread(struct spdk_fio_thread *fio_thread)
 	return spdk_thread_poll(fio_thread->thread, 0, 0);
 }
 
+/* Drop the entries returned by the last getevents, fio has consumed them by now */
+static void
+spdk_fio_drop_reaped(struct spdk_fio_thread *fio_thread)
+{
+	fio_thread->iocq_count -= fio_thread->iocq_reaped;
+	memmove(fio_thread->iocq, &fio_thread->iocq[fio_thread->iocq_reaped],
+		fio_thread->iocq_count * sizeof(*fio_thread->iocq));
+	fio_thread->iocq_reaped = 0;
+}
+
+static int
+spdk_fio_commit(struct thread_data *td)
+{
+	struct spdk_fio_thread *fio_thread = td->io_ops_data;
+
+	/* Make room for the completions below, the queue only fits iodepth entries */
+	spdk_fio_drop_reaped(fio_thread);
+
+	/* Bdev modules may hold submitted I/O until they're polled (e.g. NVMe with delayed
+	 * doorbells), so poll once per batch to push it to the device before fio waits for
+	 * completions.  Anything completed meanwhile is returned by the next getevents.
+	 */
+	spdk_fio_poll_thread(fio_thread);
+
+	return 0;
+}
+
 static int
 spdk_fio_getevents(struct thread_data *td, unsigned int min,
 		   unsigned int max, const struct timespec *t)
@@ -1020,13 +1048,14 @@ spdk_fio_getevents(struct thread_data *td, unsigned int min,
 		clock_gettime(CLOCK_MONOTONIC_RAW, &t0);
 	}
 
-	fio_thread->iocq_count = 0;
+	/* Keep the entries completed since the last call, e.g. on commit */
+	spdk_fio_drop_reaped(fio_thread);
 
 	for (;;) {
 		spdk_fio_poll_thread(fio_thread);
 
 		if (fio_thread->iocq_count >= min) {
-			return fio_thread->iocq_count;
+			break;
 		}
 
 		if (t) {
@@ -1039,7 +1068,9 @@ spdk_fio_getevents(struct thread_data *td, unsigned int min,
 		}
 	}
 
-	return fio_thread->iocq_count;
+	fio_thread->iocq_reaped = spdk_min(fio_thread->iocq_count, max);
+
+	return fio_thread->iocq_reaped;
 }
 
 static int
@@ -1511,7 +1542,7 @@ struct ioengine_ops ioengine = {
 	.init			= spdk_fio_init,
 	/* .prep		= unused, */
 	.queue			= spdk_fio_queue,
-	/* .commit		= unused, */
+	.commit			= spdk_fio_commit,
 	.getevents		= spdk_fio_getevents,
 	.event			= spdk_fio_event,
 	/* .errdetails		= unused, */
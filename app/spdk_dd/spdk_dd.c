@@ -34,6 +34,7 @@ struct spdk_dd_opts {
 	int64_t		io_unit_size;
 	int64_t		io_unit_count;
 	uint32_t	queue_depth;
+	uint32_t	num_jobs;
 	bool		aio;
 	bool		sparse;
 };
@@ -41,6 +42,7 @@ struct spdk_dd_opts {
 static struct spdk_dd_opts g_opts = {
 	.io_unit_size = 4096,
 	.queue_depth = 2,
+	.num_jobs = 1,
 };
 
 enum dd_submit_type {
@@ -49,7 +51,10 @@ enum dd_submit_type {
 	DD_WRITE,
 };
 
+struct dd_job;
+
 struct dd_io {
+	struct dd_job		*job;
 	uint64_t		offset;
 	uint64_t		length;
 	struct iocb		iocb;
@@ -104,6 +109,7 @@ struct dd_job {
 	struct dd_target	output;
 
 	struct dd_io		*ios;
+	uint32_t		num_ios;
 
 	union {
 #ifdef SPDK_CONFIG_URING
@@ -120,13 +126,14 @@ struct dd_job {
 	} u;
 
 	uint32_t		outstanding;
+	/* End of the range copied by this job, relative to the start of the input region */
 	uint64_t		copy_size;
 	STAILQ_HEAD(, dd_io)	seek_queue;
 
-	struct timespec		start_time;
-	uint64_t		total_bytes;
-	uint64_t		incremental_bytes;
-	struct spdk_poller	*status_poller;
+	struct spdk_thread	*thread;
+	/* Number of bytes submitted for write, only updated by the job's thread */
+	uint64_t		copied_bytes;
+	bool			done;
 };
 
 struct dd_flags {
@@ -147,13 +154,28 @@ static struct dd_flags g_flags[] = {
 	{NULL, 0}
 };
 
+/* The first job runs on the app thread and owns the targets, the remaining ones
+ * (--jobs) run on threads of their own and use the targets' descriptors only. */
 static struct dd_job g_job = {};
+static struct dd_job *g_parallel_jobs;
+static uint32_t g_num_jobs = 1;
+static uint32_t g_running_jobs;
+static uint64_t g_copy_size;
+static uint64_t g_progress_bytes;
+static struct timespec g_start_time;
+static struct spdk_poller *g_status_poller;
 static int g_error = 0;
 static bool g_interrupt;
 
 static void dd_target_seek(struct dd_io *io);
 static void _dd_bdev_seek_hole_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg);
 
+static struct dd_job *
+dd_get_job(uint32_t i)
+{
+	return i == 0 ? &g_job : &g_parallel_jobs[i - 1];
+}
+
 static void
 dd_cleanup_bdev(struct dd_target io)
 {
@@ -207,7 +229,7 @@ dd_exit(int rc)
 		}
 	}
 
-	spdk_poller_unregister(&g_job.status_poller);
+	spdk_poller_unregister(&g_status_poller);
 
 	spdk_app_stop(rc);
 }
@@ -226,19 +248,25 @@ dd_show_progress(bool finish)
 	int i = 0;
 	uint64_t milliseconds;
 	uint64_t size, tmp_size;
+	uint64_t total_bytes = 0;
+	uint32_t j;
 
-	size = g_job.incremental_bytes;
+	/* The counters of the other jobs are read without synchronization, which at worst
+	 * makes an intermediate report lag behind by a few I/Os. */
+	for (j = 0; j < g_num_jobs; j++) {
+		total_bytes += dd_get_job(j)->copied_bytes;
+	}
 
-	g_job.incremental_bytes = 0;
-	g_job.total_bytes += size;
+	size = total_bytes - g_progress_bytes;
+	g_progress_bytes = total_bytes;
 
 	if (finish) {
 		struct timespec time_now;
 
 		clock_gettime(CLOCK_REALTIME, &time_now);
 
-		milliseconds = spdk_max(1, TIMESPEC_TO_MS(time_now) - TIMESPEC_TO_MS(g_job.start_time));
-		size = g_job.total_bytes;
+		milliseconds = spdk_max(1, TIMESPEC_TO_MS(time_now) - TIMESPEC_TO_MS(g_start_time));
+		size = total_bytes;
 	} else {
 		milliseconds = STATUS_POLLER_PERIOD_SEC * 1000;
 	}
@@ -271,7 +299,7 @@ dd_show_progress(bool finish)
 	}
 
 	printf("\33[2K\rCopying: %" PRIu64 "/%" PRIu64 " [%sB] (%s%" PRIu64 " %sBps)",
-	       g_job.total_bytes / size_unit, g_job.copy_size / size_unit, size_unit_str, speed_type,
+	       total_bytes / size_unit, g_copy_size / size_unit, size_unit_str, speed_type,
 	       speed / speed_unit, speed_unit_str);
 	fflush(stdout);
 }
@@ -289,23 +317,33 @@ dd_finalize_output(void)
 	off_t curr_offset;
 	int rc = 0;
 
-	if (g_job.outstanding > 0) {
-		return;
-	}
-
+	/* Holes at the end of the input leave the output file short, extend it */
 	if (g_opts.output_file) {
 		curr_offset = lseek(g_job.output.u.aio.fd, 0, SEEK_END);
 		if (curr_offset == (off_t) -1) {
 			SPDK_ERRLOG("Could not seek output file for finalize: %s\n", strerror(errno));
 			g_error = errno;
-		} else if ((uint64_t)curr_offset < g_job.copy_size + g_job.output.pos) {
-			rc = ftruncate(g_job.output.u.aio.fd, g_job.copy_size + g_job.output.pos);
+		} else if ((uint64_t)curr_offset < g_copy_size + g_job.output.pos) {
+			rc = ftruncate(g_job.output.u.aio.fd, g_copy_size + g_job.output.pos);
 			if (rc != 0) {
 				SPDK_ERRLOG("Could not truncate output file for finalize: %s\n", strerror(errno));
 				g_error = errno;
 			}
 		}
 	}
+}
+
+static void
+dd_job_done(void *ctx)
+{
+	assert(g_running_jobs > 0);
+	if (--g_running_jobs > 0) {
+		return;
+	}
+
+	if (g_opts.sparse && g_error == 0 && g_interrupt == false) {
+		dd_finalize_output();
+	}
 
 	if (g_error == 0) {
 		dd_show_progress(true);
@@ -314,6 +352,36 @@ dd_finalize_output(void)
 	dd_exit(g_error);
 }
 
+static void
+dd_job_check_done(struct dd_job *job)
+{
+	if (job->outstanding > 0 || job->done) {
+		return;
+	}
+
+	job->done = true;
+
+	if (job == &g_job) {
+		dd_job_done(NULL);
+		return;
+	}
+
+	spdk_put_io_channel(job->input.u.bdev.ch);
+	spdk_put_io_channel(job->output.u.bdev.ch);
+	spdk_thread_send_msg(spdk_thread_get_app_thread(), dd_job_done, NULL);
+	spdk_thread_exit(job->thread);
+}
+
+/* Number of bytes left to copy by the job from the current input position */
+static uint64_t
+dd_job_remaining(struct dd_job *job)
+{
+	uint64_t read_region_start = g_opts.input_offset * g_opts.io_unit_size;
+	uint64_t read_offset = job->input.pos - read_region_start;
+
+	return job->copy_size > read_offset ? job->copy_size - read_offset : 0;
+}
+
 #ifdef SPDK_CONFIG_URING
 static void
 dd_uring_submit(struct dd_io *io, struct dd_target *target, uint64_t length, uint64_t offset)
@@ -339,8 +407,8 @@ _dd_write_bdev_done(struct spdk_bdev_io *bdev_io,
 {
 	struct dd_io *io = cb_arg;
 
-	assert(g_job.outstanding > 0);
-	g_job.outstanding--;
+	assert(io->job->outstanding > 0);
+	io->job->outstanding--;
 	spdk_bdev_free_io(bdev_io);
 	dd_target_seek(io);
 }
@@ -348,7 +416,8 @@ _dd_write_bdev_done(struct spdk_bdev_io *bdev_io,
 static void
 dd_target_write(struct dd_io *io)
 {
-	struct dd_target *target = &g_job.output;
+	struct dd_job *job = io->job;
+	struct dd_target *target = &job->output;
 	uint64_t length = SPDK_CEIL_DIV(io->length, target->block_size) * target->block_size;
 	uint64_t read_region_start = g_opts.input_offset * g_opts.io_unit_size;
 	uint64_t read_offset = io->offset - read_region_start;
@@ -357,18 +426,12 @@ dd_target_write(struct dd_io *io)
 	int rc = 0;
 
 	if (g_error != 0 || g_interrupt == true) {
-		if (g_job.outstanding == 0) {
-			if (g_error == 0) {
-				dd_show_progress(true);
-				printf("\n\n");
-			}
-			dd_exit(g_error);
-		}
+		dd_job_check_done(job);
 		return;
 	}
 
-	g_job.incremental_bytes += io->length;
-	g_job.outstanding++;
+	job->copied_bytes += io->length;
+	job->outstanding++;
 	io->type = DD_WRITE;
 
 	if (target->type == DD_TARGET_TYPE_FILE) {
@@ -393,12 +456,10 @@ dd_target_write(struct dd_io *io)
 
 	if (rc != 0) {
 		SPDK_ERRLOG("%s\n", strerror(-rc));
-		assert(g_job.outstanding > 0);
-		g_job.outstanding--;
+		assert(job->outstanding > 0);
+		job->outstanding--;
 		g_error = rc;
-		if (g_job.outstanding == 0) {
-			dd_exit(rc);
-		}
+		dd_job_check_done(job);
 		return;
 	}
 }
@@ -412,25 +473,24 @@ _dd_read_bdev_done(struct spdk_bdev_io *bdev_io,
 
 	spdk_bdev_free_io(bdev_io);
 
-	assert(g_job.outstanding > 0);
-	g_job.outstanding--;
+	assert(io->job->outstanding > 0);
+	io->job->outstanding--;
 	dd_target_write(io);
 }
 
 static void
 dd_target_read(struct dd_io *io)
 {
-	struct dd_target *target = &g_job.input;
+	struct dd_job *job = io->job;
+	struct dd_target *target = &job->input;
 	int rc = 0;
 
 	if (g_error != 0 || g_interrupt == true) {
-		if (g_job.outstanding == 0) {
-			dd_exit(g_error);
-		}
+		dd_job_check_done(job);
 		return;
 	}
 
-	g_job.outstanding++;
+	job->outstanding++;
 	io->type = DD_READ;
 
 	if (target->type == DD_TARGET_TYPE_FILE) {
@@ -455,12 +515,10 @@ dd_target_read(struct dd_io *io)
 
 	if (rc != 0) {
 		SPDK_ERRLOG("%s\n", strerror(-rc));
-		assert(g_job.outstanding > 0);
-		g_job.outstanding--;
+		assert(job->outstanding > 0);
+		job->outstanding--;
 		g_error = rc;
-		if (g_job.outstanding == 0) {
-			dd_exit(rc);
-		}
+		dd_job_check_done(job);
 		return;
 	}
 }
@@ -472,8 +530,8 @@ _dd_target_populate_buffer_done(struct spdk_bdev_io *bdev_io,
 {
 	struct dd_io *io = cb_arg;
 
-	assert(g_job.outstanding > 0);
-	g_job.outstanding--;
+	assert(io->job->outstanding > 0);
+	io->job->outstanding--;
 	spdk_bdev_free_io(bdev_io);
 	dd_target_read(io);
 }
@@ -481,29 +539,24 @@ _dd_target_populate_buffer_done(struct spdk_bdev_io *bdev_io,
 static void
 dd_target_populate_buffer(struct dd_io *io)
 {
-	struct dd_target *target = &g_job.output;
+	struct dd_job *job = io->job;
+	struct dd_target *target = &job->output;
 	uint64_t read_region_start = g_opts.input_offset * g_opts.io_unit_size;
-	uint64_t read_offset = g_job.input.pos - read_region_start;
+	uint64_t read_offset = job->input.pos - read_region_start;
 	uint64_t write_region_start = g_opts.output_offset * g_opts.io_unit_size;
 	uint64_t write_offset = write_region_start + read_offset;
 	uint64_t length;
 	int rc = 0;
 
-	io->offset = g_job.input.pos;
-	io->length = spdk_min(io->length, g_job.copy_size - read_offset);
+	io->offset = job->input.pos;
+	io->length = spdk_min(io->length, dd_job_remaining(job));
 
 	if (io->length == 0 || g_error != 0 || g_interrupt == true) {
-		if (g_job.outstanding == 0) {
-			if (g_error == 0) {
-				dd_show_progress(true);
-				printf("\n\n");
-			}
-			dd_exit(g_error);
-		}
+		dd_job_check_done(job);
 		return;
 	}
 
-	g_job.input.pos += io->length;
+	job->input.pos += io->length;
 
 	if ((io->length % target->block_size) == 0) {
 		dd_target_read(io);
@@ -511,7 +564,7 @@ dd_target_populate_buffer(struct dd_io *io)
 	}
 
 	/* Read whole blocks from output to combine buffers later */
-	g_job.outstanding++;
+	job->outstanding++;
 	io->type = DD_POPULATE;
 
 	length = SPDK_CEIL_DIV(io->length, target->block_size) * target->block_size;
@@ -538,22 +591,81 @@ dd_target_populate_buffer(struct dd_io *io)
 
 	if (rc != 0) {
 		SPDK_ERRLOG("%s\n", strerror(-rc));
-		assert(g_job.outstanding > 0);
-		g_job.outstanding--;
+		assert(job->outstanding > 0);
+		job->outstanding--;
 		g_error = rc;
-		if (g_job.outstanding == 0) {
-			dd_exit(rc);
-		}
+		dd_job_check_done(job);
 		return;
 	}
 }
 
+static void
+_dd_unmap_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct dd_job *job = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		SPDK_ERRLOG("Could not unmap a hole in output bdev\n");
+		g_error = -EIO;
+	}
+
+	assert(job->outstanding > 0);
+	job->outstanding--;
+	dd_job_check_done(job);
+}
+
+/* The input region [job->input.pos, pos) is a hole, skip over it. An output bdev may
+ * still hold stale data in that region, so it is unmapped, while holes in output files
+ * are left as they are created. */
+static void
+dd_job_skip_hole(struct dd_job *job, uint64_t pos)
+{
+	struct dd_target *target = &job->output;
+	uint64_t read_region_start = g_opts.input_offset * g_opts.io_unit_size;
+	uint64_t write_region_start = g_opts.output_offset * g_opts.io_unit_size;
+	uint64_t start, end;
+	int rc;
+
+	pos = spdk_min(pos, read_region_start + job->copy_size);
+	if (pos <= job->input.pos) {
+		return;
+	}
+
+	start = write_region_start + job->input.pos - read_region_start;
+	end = write_region_start + pos - read_region_start;
+	job->input.pos = pos;
+
+	if (target->type != DD_TARGET_TYPE_BDEV ||
+	    !spdk_bdev_io_type_supported(target->u.bdev.bdev, SPDK_BDEV_IO_TYPE_UNMAP)) {
+		return;
+	}
+
+	/* Only whole blocks may be unmapped, partial ones are left untouched */
+	start = SPDK_CEIL_DIV(start, target->block_size) * target->block_size;
+	end = end / target->block_size * target->block_size;
+	if (start >= end) {
+		return;
+	}
+
+	job->outstanding++;
+	rc = spdk_bdev_unmap(target->u.bdev.desc, target->u.bdev.ch, start, end - start,
+			     _dd_unmap_done, job);
+	if (rc != 0) {
+		SPDK_ERRLOG("%s\n", strerror(-rc));
+		assert(job->outstanding > 0);
+		job->outstanding--;
+		g_error = rc;
+	}
+}
+
 static off_t
-dd_file_seek_data(void)
+dd_file_seek_data(struct dd_job *job)
 {
 	off_t next_data_offset = (off_t) -1;
 
-	next_data_offset = lseek(g_job.input.u.aio.fd, g_job.input.pos, SEEK_DATA);
+	next_data_offset = lseek(job->input.u.aio.fd, job->input.pos, SEEK_DATA);
 
 	if (next_data_offset == (off_t) -1) {
 		/* NXIO with SEEK_DATA means there are no more data to read.
@@ -561,11 +673,12 @@ dd_file_seek_data(void)
 		 * inserting a hole to the end of the file.
 		 */
 		if (errno == ENXIO) {
-			dd_finalize_output();
-		} else if (g_job.outstanding == 0) {
+			dd_job_skip_hole(job, UINT64_MAX);
+			dd_job_check_done(job);
+		} else if (job->outstanding == 0) {
 			SPDK_ERRLOG("Could not seek input file for data: %s\n", strerror(errno));
 			g_error = errno;
-			dd_exit(g_error);
+			dd_job_check_done(job);
 		}
 	}
 
@@ -573,16 +686,16 @@ dd_file_seek_data(void)
 }
 
 static off_t
-dd_file_seek_hole(void)
+dd_file_seek_hole(struct dd_job *job)
 {
 	off_t next_hole_offset = (off_t) -1;
 
-	next_hole_offset = lseek(g_job.input.u.aio.fd, g_job.input.pos, SEEK_HOLE);
+	next_hole_offset = lseek(job->input.u.aio.fd, job->input.pos, SEEK_HOLE);
 
-	if (next_hole_offset == (off_t) -1 && g_job.outstanding == 0) {
+	if (next_hole_offset == (off_t) -1 && job->outstanding == 0) {
 		SPDK_ERRLOG("Could not seek input file for hole: %s\n", strerror(errno));
 		g_error = errno;
-		dd_exit(g_error);
+		dd_job_check_done(job);
 	}
 
 	return next_hole_offset;
@@ -594,54 +707,46 @@ _dd_bdev_seek_data_done(struct spdk_bdev_io *bdev_io,
 			void *cb_arg)
 {
 	struct dd_io *io = cb_arg;
+	struct dd_job *job = io->job;
 	uint64_t next_data_offset_blocks = UINT64_MAX;
-	struct dd_target *target = &g_job.input;
+	struct dd_target *target = &job->input;
 	int rc = 0;
 
-	if (g_error != 0 || g_interrupt == true) {
-		STAILQ_REMOVE_HEAD(&g_job.seek_queue, link);
-		if (g_job.outstanding == 0) {
-			if (g_error == 0) {
-				dd_show_progress(true);
-				printf("\n\n");
-			}
-			dd_exit(g_error);
-		}
-		return;
-	}
-
-	assert(g_job.outstanding > 0);
-	g_job.outstanding--;
+	assert(job->outstanding > 0);
+	job->outstanding--;
 
 	next_data_offset_blocks = spdk_bdev_io_get_seek_offset(bdev_io);
 	spdk_bdev_free_io(bdev_io);
 
-	/* UINT64_MAX means there are no more data to read.
-	 * But in case of input and output files, we may have to finalize output file
-	 * inserting a hole to the end of the file.
-	 */
-	if (next_data_offset_blocks == UINT64_MAX) {
-		STAILQ_REMOVE_HEAD(&g_job.seek_queue, link);
-		dd_finalize_output();
+	if (g_error != 0 || g_interrupt == true) {
+		STAILQ_REMOVE_HEAD(&job->seek_queue, link);
+		dd_job_check_done(job);
 		return;
 	}
 
-	g_job.input.pos = next_data_offset_blocks * g_job.input.block_size;
+	/* UINT64_MAX means there are no more data to read, the rest of the range is a hole.
+	 * The same goes for data found past the end of the range copied by this job.
+	 */
+	dd_job_skip_hole(job, next_data_offset_blocks == UINT64_MAX ? UINT64_MAX :
+			 next_data_offset_blocks * target->block_size);
+	if (dd_job_remaining(job) == 0) {
+		STAILQ_REMOVE_HEAD(&job->seek_queue, link);
+		dd_job_check_done(job);
+		return;
+	}
 
-	g_job.outstanding++;
+	job->outstanding++;
 	rc = spdk_bdev_seek_hole(target->u.bdev.desc, target->u.bdev.ch,
-				 g_job.input.pos / g_job.input.block_size,
+				 job->input.pos / target->block_size,
 				 _dd_bdev_seek_hole_done, io);
 
 	if (rc != 0) {
 		SPDK_ERRLOG("%s\n", strerror(-rc));
-		STAILQ_REMOVE_HEAD(&g_job.seek_queue, link);
-		assert(g_job.outstanding > 0);
-		g_job.outstanding--;
+		STAILQ_REMOVE_HEAD(&job->seek_queue, link);
+		assert(job->outstanding > 0);
+		job->outstanding--;
 		g_error = rc;
-		if (g_job.outstanding == 0) {
-			dd_exit(rc);
-		}
+		dd_job_check_done(job);
 	}
 }
 
@@ -651,58 +756,51 @@ _dd_bdev_seek_hole_done(struct spdk_bdev_io *bdev_io,
 			void *cb_arg)
 {
 	struct dd_io *io = cb_arg;
-	struct dd_target *target = &g_job.input;
+	struct dd_job *job = io->job;
+	struct dd_target *target = &job->input;
 	uint64_t next_hole_offset_blocks = UINT64_MAX;
 	struct dd_io *seek_io;
 	int rc = 0;
 
 	/* First seek operation is the one in progress, i.e. this one just ended */
-	STAILQ_REMOVE_HEAD(&g_job.seek_queue, link);
-
-	if (g_error != 0 || g_interrupt == true) {
-		if (g_job.outstanding == 0) {
-			if (g_error == 0) {
-				dd_show_progress(true);
-				printf("\n\n");
-			}
-			dd_exit(g_error);
-		}
-		return;
-	}
+	STAILQ_REMOVE_HEAD(&job->seek_queue, link);
 
-	assert(g_job.outstanding > 0);
-	g_job.outstanding--;
+	assert(job->outstanding > 0);
+	job->outstanding--;
 
 	next_hole_offset_blocks = spdk_bdev_io_get_seek_offset(bdev_io);
 	spdk_bdev_free_io(bdev_io);
 
+	if (g_error != 0 || g_interrupt == true) {
+		dd_job_check_done(job);
+		return;
+	}
+
 	/* UINT64_MAX means there are no more holes. */
 	if (next_hole_offset_blocks == UINT64_MAX) {
 		io->length = g_opts.io_unit_size;
 	} else {
 		io->length = spdk_min((uint64_t)g_opts.io_unit_size,
-				      next_hole_offset_blocks * g_job.input.block_size - g_job.input.pos);
+				      next_hole_offset_blocks * target->block_size - job->input.pos);
 	}
 
 	dd_target_populate_buffer(io);
 
 	/* If input reading is not at the end, start following seek operation in the queue */
-	if (!STAILQ_EMPTY(&g_job.seek_queue) && g_job.input.pos < g_job.input.total_size) {
-		seek_io = STAILQ_FIRST(&g_job.seek_queue);
+	if (!STAILQ_EMPTY(&job->seek_queue) && dd_job_remaining(job) > 0) {
+		seek_io = STAILQ_FIRST(&job->seek_queue);
 		assert(seek_io != NULL);
-		g_job.outstanding++;
+		job->outstanding++;
 		rc = spdk_bdev_seek_data(target->u.bdev.desc, target->u.bdev.ch,
-					 g_job.input.pos / g_job.input.block_size,
+					 job->input.pos / target->block_size,
 					 _dd_bdev_seek_data_done, seek_io);
 
 		if (rc != 0) {
 			SPDK_ERRLOG("%s\n", strerror(-rc));
-			assert(g_job.outstanding > 0);
-			g_job.outstanding--;
+			assert(job->outstanding > 0);
+			job->outstanding--;
 			g_error = rc;
-			if (g_job.outstanding == 0) {
-				dd_exit(rc);
-			}
+			dd_job_check_done(job);
 		}
 	}
 }
@@ -710,9 +808,8 @@ _dd_bdev_seek_hole_done(struct spdk_bdev_io *bdev_io,
 static void
 dd_target_seek(struct dd_io *io)
 {
-	struct dd_target *target = &g_job.input;
-	uint64_t read_region_start = g_opts.input_offset * g_opts.io_unit_size;
-	uint64_t read_offset = g_job.input.pos - read_region_start;
+	struct dd_job *job = io->job;
+	struct dd_target *target = &job->input;
 	off_t next_data_offset = (off_t) -1;
 	off_t next_hole_offset = (off_t) -1;
 	int rc = 0;
@@ -722,31 +819,29 @@ dd_target_seek(struct dd_io *io)
 		return;
 	}
 
-	if (g_job.copy_size - read_offset == 0 || g_error != 0 || g_interrupt == true) {
-		if (g_job.outstanding == 0) {
-			if (g_error == 0) {
-				dd_show_progress(true);
-				printf("\n\n");
-			}
-			dd_exit(g_error);
-		}
+	if (dd_job_remaining(job) == 0 || g_error != 0 || g_interrupt == true) {
+		dd_job_check_done(job);
 		return;
 	}
 
 	if (target->type == DD_TARGET_TYPE_FILE) {
-		next_data_offset = dd_file_seek_data();
+		next_data_offset = dd_file_seek_data(job);
 		if (next_data_offset < 0) {
 			return;
-		} else if ((uint64_t)next_data_offset > g_job.input.pos) {
-			g_job.input.pos = next_data_offset;
 		}
 
-		next_hole_offset = dd_file_seek_hole();
+		dd_job_skip_hole(job, next_data_offset);
+		if (dd_job_remaining(job) == 0) {
+			dd_job_check_done(job);
+			return;
+		}
+
+		next_hole_offset = dd_file_seek_hole(job);
 		if (next_hole_offset < 0) {
 			return;
-		} else if ((uint64_t)next_hole_offset > g_job.input.pos) {
+		} else if ((uint64_t)next_hole_offset > job->input.pos) {
 			io->length = spdk_min((uint64_t)g_opts.io_unit_size,
-					      (uint64_t)(next_hole_offset - g_job.input.pos));
+					      (uint64_t)(next_hole_offset - job->input.pos));
 		} else {
 			io->length = g_opts.io_unit_size;
 		}
@@ -754,25 +849,24 @@ dd_target_seek(struct dd_io *io)
 		dd_target_populate_buffer(io);
 	} else if (target->type == DD_TARGET_TYPE_BDEV) {
 		/* Check if other seek operation is in progress */
-		if (STAILQ_EMPTY(&g_job.seek_queue)) {
-			g_job.outstanding++;
+		if (STAILQ_EMPTY(&job->seek_queue)) {
+			job->outstanding++;
 			rc = spdk_bdev_seek_data(target->u.bdev.desc, target->u.bdev.ch,
-						 g_job.input.pos / g_job.input.block_size,
+						 job->input.pos / target->block_size,
 						 _dd_bdev_seek_data_done, io);
 
 		}
 
-		STAILQ_INSERT_TAIL(&g_job.seek_queue, io, link);
+		STAILQ_INSERT_TAIL(&job->seek_queue, io, link);
 	}
 
 	if (rc != 0) {
 		SPDK_ERRLOG("%s\n", strerror(-rc));
-		assert(g_job.outstanding > 0);
-		g_job.outstanding--;
+		STAILQ_REMOVE_HEAD(&job->seek_queue, link);
+		assert(job->outstanding > 0);
+		job->outstanding--;
 		g_error = rc;
-		if (g_job.outstanding == 0) {
-			dd_exit(rc);
-		}
+		dd_job_check_done(job);
 		return;
 	}
 }
@@ -780,8 +874,8 @@ dd_target_seek(struct dd_io *io)
 static void
 dd_complete_poll(struct dd_io *io)
 {
-	assert(g_job.outstanding > 0);
-	g_job.outstanding--;
+	assert(io->job->outstanding > 0);
+	io->job->outstanding--;
 
 	switch (io->type) {
 	case DD_POPULATE:
@@ -1065,6 +1159,139 @@ dd_register_buffers(void)
 }
 #endif
 
+static int
+dd_job_alloc_ios(struct dd_job *job, uint32_t num_ios)
+{
+	uint32_t i;
+
+	job->ios = calloc(num_ios, sizeof(struct dd_io));
+	if (job->ios == NULL) {
+		SPDK_ERRLOG("%s\n", strerror(ENOMEM));
+		return -ENOMEM;
+	}
+
+	job->num_ios = num_ios;
+	for (i = 0; i < num_ios; i++) {
+		job->ios[i].job = job;
+		job->ios[i].buf = spdk_malloc(g_opts.io_unit_size, 0x1000, NULL, 0, SPDK_MALLOC_DMA);
+		if (job->ios[i].buf == NULL) {
+			SPDK_ERRLOG("%s - try smaller block size value\n", strerror(ENOMEM));
+			return -ENOMEM;
+		}
+		job->ios[i].length = (uint64_t)g_opts.io_unit_size;
+	}
+
+	return 0;
+}
+
+static void
+dd_job_start(void *ctx)
+{
+	struct dd_job *job = ctx;
+	uint32_t i;
+
+	job->input.u.bdev.ch = spdk_bdev_get_io_channel(job->input.u.bdev.desc);
+	job->output.u.bdev.ch = spdk_bdev_get_io_channel(job->output.u.bdev.desc);
+	if (job->input.u.bdev.ch == NULL || job->output.u.bdev.ch == NULL) {
+		SPDK_ERRLOG("Could not get I/O channel: %s\n", strerror(ENOMEM));
+		g_error = -ENOMEM;
+		job->done = true;
+		if (job->input.u.bdev.ch != NULL) {
+			spdk_put_io_channel(job->input.u.bdev.ch);
+		}
+		if (job->output.u.bdev.ch != NULL) {
+			spdk_put_io_channel(job->output.u.bdev.ch);
+		}
+		spdk_thread_send_msg(spdk_thread_get_app_thread(), dd_job_done, NULL);
+		spdk_thread_exit(job->thread);
+		return;
+	}
+
+	for (i = 0; i < job->num_ios; i++) {
+		dd_target_seek(&job->ios[i]);
+	}
+}
+
+/* Split the copy into --jobs ranges of whole I/O units, each copied by its own thread
+ * with its own queue of I/Os. The first range is copied by g_job on the app thread. */
+static int
+dd_init_parallel_jobs(void)
+{
+	uint64_t read_region_start = g_opts.input_offset * g_opts.io_unit_size;
+	uint64_t num_units = SPDK_CEIL_DIV(g_copy_size, g_opts.io_unit_size);
+	uint64_t units_per_job, start, end;
+	struct spdk_cpuset cpumask;
+	char thread_name[32];
+	struct dd_job *job;
+	uint32_t i, core;
+	int rc;
+
+	if (g_opts.io_unit_size % g_job.output.block_size != 0) {
+		SPDK_ERRLOG("--bs value must be a multiple of output native block size (%d) with --jobs\n",
+			    g_job.output.block_size);
+		return -EINVAL;
+	}
+
+	if (num_units == 0) {
+		return 0;
+	}
+
+	units_per_job = SPDK_CEIL_DIV(num_units, g_opts.num_jobs);
+	g_num_jobs = SPDK_CEIL_DIV(num_units, units_per_job);
+	g_job.copy_size = spdk_min(units_per_job * g_opts.io_unit_size, g_copy_size);
+	if (g_num_jobs == 1) {
+		return 0;
+	}
+
+	g_parallel_jobs = calloc(g_num_jobs - 1, sizeof(struct dd_job));
+	if (g_parallel_jobs == NULL) {
+		SPDK_ERRLOG("%s\n", strerror(ENOMEM));
+		g_num_jobs = 1;
+		return -ENOMEM;
+	}
+
+	core = spdk_env_get_current_core();
+	for (i = 1; i < g_num_jobs; i++) {
+		job = &g_parallel_jobs[i - 1];
+		start = i * units_per_job * g_opts.io_unit_size;
+		end = spdk_min(start + units_per_job * g_opts.io_unit_size, g_copy_size);
+
+		job->input = g_job.input;
+		job->output = g_job.output;
+		job->input.u.bdev.ch = NULL;
+		job->output.u.bdev.ch = NULL;
+		job->input.pos = read_region_start + start;
+		job->copy_size = end;
+		STAILQ_INIT(&job->seek_queue);
+
+		rc = dd_job_alloc_ios(job, spdk_min(g_opts.queue_depth,
+						    SPDK_CEIL_DIV(end - start, g_opts.io_unit_size)));
+		if (rc < 0) {
+			return rc;
+		}
+
+		/* Spread the jobs over the cores of the app, round-robin */
+		core = spdk_env_get_next_core(core);
+		if (core == UINT32_MAX) {
+			core = spdk_env_get_first_core();
+		}
+		spdk_cpuset_zero(&cpumask);
+		spdk_cpuset_set_cpu(&cpumask, core, true);
+		snprintf(thread_name, sizeof(thread_name), "dd_job%u", i);
+
+		job->thread = spdk_thread_create(thread_name, &cpumask);
+		if (job->thread == NULL) {
+			SPDK_ERRLOG("Could not create thread for job %u\n", i);
+			return -ENOMEM;
+		}
+	}
+
+	g_opts.queue_depth = spdk_min(g_opts.queue_depth,
+				      SPDK_CEIL_DIV(g_job.copy_size, g_opts.io_unit_size));
+
+	return 0;
+}
+
 static void
 dd_run(void *arg1)
 {
@@ -1112,9 +1339,9 @@ dd_run(void *arg1)
 	}
 
 	if (g_opts.io_unit_count != 0) {
-		g_job.copy_size = write_size;
+		g_copy_size = write_size;
 	} else {
-		g_job.copy_size = g_job.input.total_size - g_job.input.pos;
+		g_copy_size = g_job.input.total_size - g_job.input.pos;
 	}
 
 	g_job.output.pos = g_opts.output_offset * g_opts.io_unit_size;
@@ -1169,21 +1396,21 @@ dd_run(void *arg1)
 		return;
 	}
 
-	g_job.ios = calloc(g_opts.queue_depth, sizeof(struct dd_io));
-	if (g_job.ios == NULL) {
-		SPDK_ERRLOG("%s\n", strerror(ENOMEM));
-		dd_exit(-ENOMEM);
-		return;
-	}
+	g_job.copy_size = g_copy_size;
+	STAILQ_INIT(&g_job.seek_queue);
 
-	for (i = 0; i < g_opts.queue_depth; i++) {
-		g_job.ios[i].buf = spdk_malloc(g_opts.io_unit_size, 0x1000, NULL, 0, SPDK_MALLOC_DMA);
-		if (g_job.ios[i].buf == NULL) {
-			SPDK_ERRLOG("%s - try smaller block size value\n", strerror(ENOMEM));
-			dd_exit(-ENOMEM);
+	if (g_opts.num_jobs > 1) {
+		rc = dd_init_parallel_jobs();
+		if (rc < 0) {
+			dd_exit(rc);
 			return;
 		}
-		g_job.ios[i].length = (uint64_t)g_opts.io_unit_size;
+	}
+
+	rc = dd_job_alloc_ios(&g_job, g_opts.queue_depth);
+	if (rc < 0) {
+		dd_exit(rc);
+		return;
 	}
 
 	if (g_opts.input_file || g_opts.output_file) {
@@ -1234,14 +1461,17 @@ dd_run(void *arg1)
 		}
 	}
 
-	clock_gettime(CLOCK_REALTIME, &g_job.start_time);
+	clock_gettime(CLOCK_REALTIME, &g_start_time);
 
-	g_job.status_poller = SPDK_POLLER_REGISTER(dd_status_poller, NULL,
-			      STATUS_POLLER_PERIOD_SEC * SPDK_SEC_TO_USEC);
+	g_status_poller = SPDK_POLLER_REGISTER(dd_status_poller, NULL,
+					       STATUS_POLLER_PERIOD_SEC * SPDK_SEC_TO_USEC);
 
-	STAILQ_INIT(&g_job.seek_queue);
+	g_running_jobs = g_num_jobs;
+	for (i = 1; i < g_num_jobs; i++) {
+		spdk_thread_send_msg(g_parallel_jobs[i - 1].thread, dd_job_start, &g_parallel_jobs[i - 1]);
+	}
 
-	for (i = 0; i < g_opts.queue_depth; i++) {
+	for (i = 0; i < g_job.num_ios; i++) {
 		dd_target_seek(&g_job.ios[i]);
 	}
 
@@ -1261,6 +1491,7 @@ enum dd_cmdline_opts {
 	DD_OPTION_COUNT,
 	DD_OPTION_AIO,
 	DD_OPTION_SPARSE,
+	DD_OPTION_JOBS,
 };
 
 static struct option g_cmdline_opts[] = {
@@ -1342,6 +1573,12 @@ static struct option g_cmdline_opts[] = {
 		.flag = NULL,
 		.val = DD_OPTION_SPARSE,
 	},
+	{
+		.name = "jobs",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = DD_OPTION_JOBS,
+	},
 	{
 		.name = NULL
 	}
@@ -1363,7 +1600,9 @@ usage(void)
 	printf(" --skip Skip this many I/O units at start of input. (default: 0)\n");
 	printf(" --seek Skip this many I/O units at start of output. (default: 0)\n");
 	printf(" --aio Force usage of AIO. (by default io_uring is used if available)\n");
-	printf(" --sparse Enable hole skipping in input target\n");
+	printf(" --sparse Enable hole skipping in input target. Holes are unmapped in output bdev.\n");
+	printf(" --jobs Number of threads the copy is split across, each with --qd I/Os. Requires --ib and --ob. (default: %d)\n",
+	       g_opts.num_jobs);
 	printf(" Available iflag and oflag values:\n");
 	printf("  append - append mode\n");
 	printf("  direct - use direct I/O for data\n");
@@ -1419,6 +1658,9 @@ parse_args(int argc, char *argv)
 	case DD_OPTION_SPARSE:
 		g_opts.sparse = true;
 		break;
+	case DD_OPTION_JOBS:
+		g_opts.num_jobs = spdk_strtol(optarg, 10);
+		break;
 	default:
 		usage();
 		return 1;
@@ -1429,7 +1671,8 @@ parse_args(int argc, char *argv)
 static void
 dd_free(void)
 {
-	uint32_t i;
+	struct dd_job *job;
+	uint32_t i, j;
 
 	free(g_opts.input_file);
 	free(g_opts.output_file);
@@ -1453,13 +1696,18 @@ dd_free(void)
 		}
 	}
 
-	if (g_job.ios) {
-		for (i = 0; i < g_opts.queue_depth; i++) {
-			spdk_free(g_job.ios[i].buf);
-		}
+	for (i = 0; i < g_num_jobs; i++) {
+		job = dd_get_job(i);
+		if (job->ios) {
+			for (j = 0; j < job->num_ios; j++) {
+				spdk_free(job->ios[j].buf);
+			}
 
-		free(g_job.ios);
+			free(job->ios);
+		}
 	}
+
+	free(g_parallel_jobs);
 }
 
 int
@@ -1529,6 +1777,18 @@ main(int argc, char **argv)
 		goto end;
 	}
 
+	if (g_opts.num_jobs == 0 || (int32_t)g_opts.num_jobs < 0) {
+		SPDK_ERRLOG("Invalid --jobs value\n");
+		rc = EINVAL;
+		goto end;
+	}
+
+	if (g_opts.num_jobs > 1 && (g_opts.input_bdev == NULL || g_opts.output_bdev == NULL)) {
+		SPDK_ERRLOG("--jobs may be used only with --ib and --ob\n");
+		rc = EINVAL;
+		goto end;
+	}
+
 	rc = spdk_app_start(&opts, dd_run, NULL);
 	if (rc) {
 		SPDK_ERRLOG("Error occurred while performing copy\n");
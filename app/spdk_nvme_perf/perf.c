@@ -124,6 +124,9 @@ struct ns_worker_stats {
 	uint64_t		idle_tsc;
 	uint64_t		last_busy_tsc;
 	uint64_t		last_idle_tsc;
+	/* time spent submitting I/O and reaping completions, with --cycles-per-io */
+	uint64_t		submit_cycles;
+	uint64_t		complete_cycles;
 };
 
 struct ns_worker_ctx {
@@ -295,6 +298,7 @@ static struct spdk_key *g_psk = NULL;
 	}
 
 static bool g_dump_transport_stats;
+static bool g_cycles_per_io;
 static pthread_mutex_t g_stats_mutex;
 
 #define MAX_ALLOWED_PCI_DEVICE_NUM 128
@@ -1511,6 +1515,9 @@ submit_single_io(struct perf_task *task)
 	}
 
 	rc = entry->fn_table->submit_io(task, ns_ctx, entry, offset_in_ios);
+	if (spdk_unlikely(g_cycles_per_io)) {
+		ns_ctx->stats.submit_cycles += spdk_get_ticks() - task->submit_tsc;
+	}
 
 	if (spdk_unlikely(rc != 0)) {
 		if (g_continue_on_error) {
@@ -1725,7 +1732,7 @@ work_fn(void *arg)
 	bool warmup = false;
 	int rc;
 	int64_t check_rc;
-	uint64_t check_now;
+	uint64_t check_now, submit_cycles;
 	TAILQ_HEAD(, perf_task)	swap;
 	struct perf_task *task;
 
@@ -1789,10 +1796,17 @@ work_fn(void *arg)
 			}
 
 			check_now = spdk_get_ticks();
+			submit_cycles = ns_ctx->stats.submit_cycles;
 			check_rc = ns_ctx->entry->fn_table->check_io(ns_ctx);
 
 			if (check_rc > 0) {
 				ns_ctx->stats.busy_tsc += check_now - ns_ctx->stats.last_tsc;
+				if (spdk_unlikely(g_cycles_per_io)) {
+					/* I/O resubmitted from the completion callbacks is accounted
+					 * as submission */
+					ns_ctx->stats.complete_cycles += spdk_get_ticks() - check_now -
+									 (ns_ctx->stats.submit_cycles - submit_cycles);
+				}
 			} else {
 				ns_ctx->stats.idle_tsc += check_now - ns_ctx->stats.last_tsc;
 			}
@@ -1983,6 +1997,7 @@ usage(char *program_name)
 	printf("\t-G, --enable-debug enable debug logging (flag disabled, must reconfigure with --enable-debug)\n");
 #endif
 	printf("\t--transport-stats dump transport statistics\n");
+	printf("\t--cycles-per-io report CPU cycles spent per I/O submitting and completing it\n");
 	printf("\n\n");
 }
 
@@ -2021,6 +2036,99 @@ print_bucket(void *ctx, uint64_t start, uint64_t end, uint64_t count,
 	       so_far_pct, count);
 }
 
+static const char *
+get_ns_transport_name(struct ns_entry *entry)
+{
+	switch (entry->type) {
+	case ENTRY_TYPE_NVME_NS:
+		return spdk_nvme_transport_id_trtype_str(
+			       spdk_nvme_ctrlr_get_transport_id(entry->u.nvme.ctrlr)->trtype);
+	case ENTRY_TYPE_AIO_FILE:
+		return "AIO";
+	case ENTRY_TYPE_URING_FILE:
+		return "URING";
+	default:
+		return "unknown";
+	}
+}
+
+struct cycles_per_io {
+	const char	*name;
+	uint64_t	submit_cycles;
+	uint64_t	complete_cycles;
+	uint64_t	io_submitted;
+	uint64_t	io_completed;
+};
+
+static void
+print_cycles_per_io_line(const char *name, int name_len, uint32_t lcore,
+			 const struct cycles_per_io *cycles)
+{
+	double submit, complete;
+
+	submit = cycles->io_submitted ? (double)cycles->submit_cycles / cycles->io_submitted : 0;
+	complete = cycles->io_completed ? (double)cycles->complete_cycles / cycles->io_completed : 0;
+
+	if (lcore != UINT32_MAX) {
+		printf("%-*.*s from core %2u: %10s %10.1f %10.1f %10.1f\n", name_len, name_len, name,
+		       lcore, cycles->name, submit, complete, submit + complete);
+	} else {
+		printf("%-*s: %10s %10.1f %10.1f %10.1f\n", name_len + 13, name, cycles->name,
+		       submit, complete, submit + complete);
+	}
+}
+
+#define MAX_TRANSPORT_CYCLES 8
+
+static void
+print_cycles_per_io(uint32_t max_strlen)
+{
+	struct cycles_per_io transports[MAX_TRANSPORT_CYCLES] = {}, ns_cycles, *total;
+	struct worker_thread	*worker;
+	struct ns_worker_ctx	*ns_ctx;
+	int i, num_transports = 0;
+
+	printf("========================================================\n");
+	printf("%*s\n", max_strlen + 57, "CPU cycles per I/O");
+	printf("%-*s: %10s %10s %10s %10s\n", max_strlen + 13, "Device Information",
+	       "Transport", "Submit", "Complete", "Total");
+
+	TAILQ_FOREACH(worker, &g_workers, link) {
+		TAILQ_FOREACH(ns_ctx, &worker->ns_ctx, link) {
+			ns_cycles.name = get_ns_transport_name(ns_ctx->entry);
+			ns_cycles.submit_cycles = ns_ctx->stats.submit_cycles;
+			ns_cycles.complete_cycles = ns_ctx->stats.complete_cycles;
+			ns_cycles.io_submitted = ns_ctx->stats.io_submitted;
+			ns_cycles.io_completed = ns_ctx->stats.io_completed;
+
+			print_cycles_per_io_line(ns_ctx->entry->name, max_strlen, worker->lcore, &ns_cycles);
+
+			for (i = 0; i < num_transports; i++) {
+				if (!strcmp(transports[i].name, ns_cycles.name)) {
+					break;
+				}
+			}
+			if (i == MAX_TRANSPORT_CYCLES) {
+				continue;
+			} else if (i == num_transports) {
+				transports[num_transports++].name = ns_cycles.name;
+			}
+
+			total = &transports[i];
+			total->submit_cycles += ns_cycles.submit_cycles;
+			total->complete_cycles += ns_cycles.complete_cycles;
+			total->io_submitted += ns_cycles.io_submitted;
+			total->io_completed += ns_cycles.io_completed;
+		}
+	}
+
+	printf("========================================================\n");
+	for (i = 0; i < num_transports; i++) {
+		print_cycles_per_io_line("Total", max_strlen, UINT32_MAX, &transports[i]);
+	}
+	printf("\n");
+}
+
 static void
 print_performance(void)
 {
@@ -2092,6 +2200,10 @@ print_performance(void)
 		printf("\n");
 	}
 
+	if (g_cycles_per_io && ns_count != 0) {
+		print_cycles_per_io(max_strlen);
+	}
+
 	if (g_latency_sw_tracking_level == 0 || total_io_completed == 0) {
 		return;
 	}
@@ -2535,6 +2647,8 @@ static const struct option g_perf_cmdline_opts[] = {
 	{"use-every-core", no_argument, NULL, PERF_USE_EVERY_CORE},
 #define PERF_NO_HUGE		270
 	{"no-huge", no_argument, NULL, PERF_NO_HUGE},
+#define PERF_CYCLES_PER_IO	271
+	{"cycles-per-io", no_argument, NULL, PERF_CYCLES_PER_IO},
 	/* Should be the last element */
 	{0, 0, 0, 0}
 };
@@ -2809,6 +2923,9 @@ parse_args(int argc, char **argv, struct spdk_env_opts *env_opts)
 		case PERF_NO_HUGE:
 			env_opts->no_huge = true;
 			break;
+		case PERF_CYCLES_PER_IO:
+			g_cycles_per_io = true;
+			break;
 		case PERF_HELP:
 			usage(argv[0]);
 			return HELP_RETURN_CODE;
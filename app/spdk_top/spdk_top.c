@@ -72,7 +72,7 @@
 #define CORE_WIN_FIRST_COL 16
 #define CORE_WIN_WIDTH 48
 #define CORE_WIN_HEIGHT 11
-#define POLLER_WIN_HEIGHT 8
+#define POLLER_WIN_HEIGHT 9
 #define POLLER_WIN_WIDTH 64
 #define POLLER_WIN_FIRST_COL 14
 #define FIRST_DATA_ROW 7
@@ -109,6 +109,7 @@ enum column_pollers_type {
 	COL_POLLERS_RUN_COUNTER,
 	COL_POLLERS_PERIOD,
 	COL_POLLERS_BUSY_COUNT,
+	COL_POLLERS_BUSY_TIME,
 	COL_POLLERS_NONE = 255,
 };
 
@@ -147,6 +148,7 @@ struct run_counter_history {
 	uint64_t thread_id;
 	uint64_t last_run_counter;
 	uint64_t last_busy_counter;
+	uint64_t last_busy_tsc;
 	TAILQ_ENTRY(run_counter_history) link;
 };
 
@@ -164,6 +166,8 @@ PANEL *g_panels[NUMBER_OF_TABS];
 uint16_t g_max_row, g_max_col;
 uint16_t g_data_win_size, g_max_data_rows;
 uint32_t g_last_threads_count, g_last_pollers_count, g_last_cores_count;
+/* Generation of the last pollers report, only the pollers that changed since are requested */
+static uint64_t g_pollers_generation;
 uint8_t g_current_sort_col[NUMBER_OF_TABS] = {COL_THREADS_NAME, COL_POLLERS_NAME, COL_CORES_CORE};
 uint8_t g_current_sort_col2[NUMBER_OF_TABS] = {COL_THREADS_NONE, COL_POLLERS_NONE, COL_CORES_NONE};
 bool g_interval_data = true;
@@ -187,6 +191,7 @@ static struct col_desc g_col_desc[NUMBER_OF_TABS][TABS_COL_COUNT] = {
 		{.name = "Run count", .max_data_string = MAX_POLLER_RUN_COUNT},
 		{.name = "Period [us]", .max_data_string = MAX_PERIOD_STR_LEN},
 		{.name = "Status (busy count)", .max_data_string = MAX_POLLER_IND_STR_LEN},
+		{.name = "Busy [us]", .max_data_string = MAX_TIME_STR_LEN},
 		{.name = (char *)NULL}
 	},
 	{	{.name = "Core", .max_data_string = MAX_CORE_STR_LEN},
@@ -226,6 +231,9 @@ struct rpc_poller_info {
 	uint64_t id;
 	uint64_t run_count;
 	uint64_t busy_count;
+	uint64_t busy_tsc;
+	uint64_t idle_tsc;
+	uint64_t max_run_tsc;
 	uint64_t period_ticks;
 	enum spdk_poller_type type;
 	char thread_name[MAX_THREAD_NAME];
@@ -371,6 +379,9 @@ static const struct spdk_json_object_decoder rpc_pollers_decoders[] = {
 	{"id", offsetof(struct rpc_poller_info, id), spdk_json_decode_uint64},
 	{"run_count", offsetof(struct rpc_poller_info, run_count), spdk_json_decode_uint64},
 	{"busy_count", offsetof(struct rpc_poller_info, busy_count), spdk_json_decode_uint64},
+	{"busy_tsc", offsetof(struct rpc_poller_info, busy_tsc), spdk_json_decode_uint64, true},
+	{"idle_tsc", offsetof(struct rpc_poller_info, idle_tsc), spdk_json_decode_uint64, true},
+	{"max_run_tsc", offsetof(struct rpc_poller_info, max_run_tsc), spdk_json_decode_uint64, true},
 	{"period_ticks", offsetof(struct rpc_poller_info, period_ticks), spdk_json_decode_uint64, true},
 };
 
@@ -403,11 +414,57 @@ rpc_decode_pollers_array(struct spdk_json_val *poller, struct rpc_poller_info *o
 	return 0;
 }
 
+struct rpc_pollers_thread_info {
+	char *name;
+	uint64_t id;
+	bool delta;
+};
+
 static const struct spdk_json_object_decoder rpc_thread_pollers_decoders[] = {
-	{"name", offsetof(struct rpc_thread_info, name), spdk_json_decode_string},
-	{"id", offsetof(struct rpc_thread_info, id), spdk_json_decode_uint64},
+	{"name", offsetof(struct rpc_pollers_thread_info, name), spdk_json_decode_string},
+	{"id", offsetof(struct rpc_pollers_thread_info, id), spdk_json_decode_uint64},
+	{"delta", offsetof(struct rpc_pollers_thread_info, delta), spdk_json_decode_bool, true},
 };
 
+/* Fill in the pollers of a thread that were omitted from a delta report, as they didn't change */
+static int
+rpc_merge_unchanged_pollers(struct rpc_poller_info *out, uint64_t *poller_count,
+			    uint64_t first_poller, uint64_t thread_id)
+{
+	struct rpc_poller_info *last, *poller;
+	uint64_t i, j;
+
+	for (i = 0; i < g_last_pollers_count; i++) {
+		last = &g_pollers_info[i];
+		if (last->thread_id != thread_id) {
+			continue;
+		}
+
+		for (j = first_poller; j < *poller_count; j++) {
+			if (out[j].id == last->id) {
+				break;
+			}
+		}
+		if (j < *poller_count) {
+			continue;
+		}
+
+		if (*poller_count == RPC_MAX_POLLERS) {
+			return -1;
+		}
+
+		poller = &out[(*poller_count)++];
+		*poller = *last;
+		poller->name = strdup(last->name);
+		poller->state = strdup(last->state);
+		if (poller->name == NULL || poller->state == NULL) {
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
 static int
 rpc_decode_pollers_threads_array(struct spdk_json_val *val, struct rpc_poller_info *out,
 				 uint32_t *num_pollers)
@@ -416,8 +473,8 @@ rpc_decode_pollers_threads_array(struct spdk_json_val *val, struct rpc_poller_in
 	/* This is a temporary poller structure to hold thread name and id.
 	 * It is filled with data only once per thread change and then
 	 * that memory is copied to each poller running on that thread. */
-	struct rpc_thread_info thread_info = {};
-	uint64_t poller_count = 0, i, thread_name_length;
+	struct rpc_pollers_thread_info thread_info = {};
+	uint64_t poller_count = 0, first_poller, i, thread_name_length;
 	int rc;
 	const char *poller_typenames[] = { "active_pollers", "timed_pollers", "paused_pollers" };
 	enum spdk_poller_type poller_types[] = { SPDK_ACTIVE_POLLER, SPDK_TIMED_POLLER, SPDK_PAUSED_POLLER };
@@ -430,6 +487,7 @@ rpc_decode_pollers_threads_array(struct spdk_json_val *val, struct rpc_poller_in
 	}
 
 	for (thread = spdk_json_array_first(thread); thread != NULL; thread = spdk_json_next(thread)) {
+		thread_info.delta = false;
 		rc = spdk_json_decode_object_relaxed(thread, rpc_thread_pollers_decoders,
 						     SPDK_COUNTOF(rpc_thread_pollers_decoders), &thread_info);
 		if (rc) {
@@ -438,6 +496,7 @@ rpc_decode_pollers_threads_array(struct spdk_json_val *val, struct rpc_poller_in
 		}
 
 		thread_name_length = strlen(thread_info.name);
+		first_poller = poller_count;
 
 		for (i = 0; i < SPDK_COUNTOF(poller_types); i++) {
 			/* Find poller array */
@@ -456,6 +515,14 @@ rpc_decode_pollers_threads_array(struct spdk_json_val *val, struct rpc_poller_in
 				goto end;
 			}
 		}
+
+		if (thread_info.delta) {
+			rc = rpc_merge_unchanged_pollers(out, &poller_count, first_poller, thread_info.id);
+			if (rc) {
+				printf("Could not merge unchanged pollers.\n");
+				goto end;
+			}
+		}
 	}
 
 	*num_pollers = poller_count;
@@ -570,7 +637,8 @@ static const struct spdk_json_object_decoder rpc_scheduler_decoders[] = {
 };
 
 static int
-rpc_send_req(char *rpc_name, struct spdk_jsonrpc_client_response **resp)
+rpc_send_req_generation(char *rpc_name, uint64_t generation,
+			struct spdk_jsonrpc_client_response **resp)
 {
 	struct spdk_jsonrpc_client_response *json_resp = NULL;
 	struct spdk_json_write_ctx *w;
@@ -583,6 +651,11 @@ rpc_send_req(char *rpc_name, struct spdk_jsonrpc_client_response **resp)
 	}
 
 	w = spdk_jsonrpc_begin_request(request, 1, rpc_name);
+	if (generation != 0) {
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_uint64(w, "generation", generation);
+		spdk_json_write_object_end(w);
+	}
 	spdk_jsonrpc_end_request(request, w);
 	spdk_jsonrpc_client_send_request(g_rpc_client, request);
 
@@ -612,6 +685,12 @@ rpc_send_req(char *rpc_name, struct spdk_jsonrpc_client_response **resp)
 	return 0;
 }
 
+static int
+rpc_send_req(char *rpc_name, struct spdk_jsonrpc_client_response **resp)
+{
+	return rpc_send_req_generation(rpc_name, 0, resp);
+}
+
 static uint64_t
 get_cpu_usage(uint64_t busy_ticks, uint64_t idle_ticks)
 {
@@ -702,7 +781,7 @@ sort_threads(const void *p1, const void *p2)
 
 static void
 store_last_counters(uint64_t poller_id, uint64_t thread_id, uint64_t last_run_counter,
-		    uint64_t last_busy_counter)
+		    uint64_t last_busy_counter, uint64_t last_busy_tsc)
 {
 	struct run_counter_history *history;
 
@@ -710,6 +789,7 @@ store_last_counters(uint64_t poller_id, uint64_t thread_id, uint64_t last_run_co
 		if ((history->poller_id == poller_id) && (history->thread_id == thread_id)) {
 			history->last_run_counter = last_run_counter;
 			history->last_busy_counter = last_busy_counter;
+			history->last_busy_tsc = last_busy_tsc;
 			return;
 		}
 	}
@@ -723,6 +803,7 @@ store_last_counters(uint64_t poller_id, uint64_t thread_id, uint64_t last_run_co
 	history->thread_id = thread_id;
 	history->last_run_counter = last_run_counter;
 	history->last_busy_counter = last_busy_counter;
+	history->last_busy_tsc = last_busy_tsc;
 
 	TAILQ_INSERT_TAIL(&g_run_counter_history, history, link);
 }
@@ -830,6 +911,24 @@ get_last_busy_counter(uint64_t poller_id, uint64_t thread_id)
 	return 0;
 }
 
+static uint64_t
+get_poller_busy_tsc(const struct rpc_poller_info *poller)
+{
+	struct run_counter_history *history;
+
+	if (!g_interval_data) {
+		return poller->busy_tsc;
+	}
+
+	TAILQ_FOREACH(history, &g_run_counter_history, link) {
+		if ((history->poller_id == poller->id) && (history->thread_id == poller->thread_id)) {
+			return poller->busy_tsc - spdk_min(history->last_busy_tsc, poller->busy_tsc);
+		}
+	}
+
+	return poller->busy_tsc;
+}
+
 static int
 subsort_pollers(enum column_pollers_type sort_column, const void *p1, const void *p2)
 {
@@ -872,6 +971,10 @@ subsort_pollers(enum column_pollers_type sort_column, const void *p1, const void
 			}
 		}
 		break;
+	case COL_POLLERS_BUSY_TIME:
+		count1 = get_poller_busy_tsc(poller1);
+		count2 = get_poller_busy_tsc(poller2);
+		break;
 	case COL_POLLERS_NONE:
 	default:
 		return 0;
@@ -906,28 +1009,41 @@ get_pollers_data(void)
 	uint64_t i = 0;
 	uint32_t current_pollers_count;
 	struct rpc_poller_info pollers_info[RPC_MAX_POLLERS];
+	uint64_t generation = 0;
+	const struct spdk_json_object_decoder generation_decoder[] = {
+		{"generation", 0, spdk_json_decode_uint64, true}
+	};
 
-	rc = rpc_send_req("thread_get_pollers", &json_resp);
+	/* Only the pollers that changed since the last report are sent, the rest is kept from it */
+	rc = rpc_send_req_generation("thread_get_pollers", g_pollers_generation, &json_resp);
 	if (rc) {
+		/* The target may not support generations, or may have been restarted */
+		g_pollers_generation = 0;
 		return rc;
 	}
 
 	/* Decode json */
 	memset(&pollers_info, 0, sizeof(pollers_info));
-	if (rpc_decode_pollers_threads_array(json_resp->result, pollers_info, &current_pollers_count)) {
+	if (rpc_decode_pollers_threads_array(json_resp->result, pollers_info, &current_pollers_count) ||
+	    spdk_json_decode_object_relaxed(json_resp->result, generation_decoder,
+					    SPDK_COUNTOF(generation_decoder), &generation)) {
 		rc = -EINVAL;
 		for (i = 0; i < current_pollers_count; i++) {
 			free_rpc_poller(&pollers_info[i]);
 		}
+		g_pollers_generation = 0;
 		goto end;
 	}
 
+	g_pollers_generation = generation;
+
 	pthread_mutex_lock(&g_thread_lock);
 
 	/* Save last run counter of each poller before updating g_pollers_stats. */
 	for (i = 0; i < g_last_pollers_count; i++) {
 		store_last_counters(g_pollers_info[i].id, g_pollers_info[i].thread_id,
-				    g_pollers_info[i].run_count, g_pollers_info[i].busy_count);
+				    g_pollers_info[i].run_count, g_pollers_info[i].busy_count,
+				    g_pollers_info[i].busy_tsc);
 	}
 
 	/* Free old pollers values before allocating memory for new ones */
@@ -1490,7 +1606,7 @@ draw_poller_tab_row(uint64_t current_row, uint8_t item_index)
 	uint64_t last_run_counter, last_busy_counter;
 	uint16_t col = TABS_DATA_START_COL;
 	char run_count[MAX_POLLER_RUN_COUNT], period_ticks[MAX_PERIOD_STR_LEN],
-	     status[MAX_POLLER_IND_STR_LEN];
+	     status[MAX_POLLER_IND_STR_LEN], busy_time[MAX_TIME_STR_LEN];
 
 	last_busy_counter = get_last_busy_counter(g_pollers_info[current_row].id,
 			    g_pollers_info[current_row].thread_id);
@@ -1579,6 +1695,13 @@ draw_poller_tab_row(uint64_t current_row, uint8_t item_index)
 				wattroff(g_tabs[POLLERS_TAB], COLOR_PAIR(9));
 			}
 		}
+		col += col_desc[COL_POLLERS_BUSY_COUNT].max_data_string + 2;
+	}
+
+	if (!col_desc[COL_POLLERS_BUSY_TIME].disabled) {
+		get_time_str(get_poller_busy_tsc(&g_pollers_info[current_row]), busy_time);
+		print_max_len(g_tabs[POLLERS_TAB], TABS_DATA_START_ROW + item_index, col,
+			      col_desc[COL_POLLERS_BUSY_TIME].max_data_string, ALIGN_RIGHT, busy_time);
 	}
 }
 
@@ -2798,7 +2921,8 @@ static void
 draw_poller_win_content(WINDOW *poller_win, struct rpc_poller_info *poller_info)
 {
 	uint64_t last_run_counter, last_busy_counter, busy_count;
-	char poller_period[MAX_TIME_STR_LEN];
+	char poller_period[MAX_TIME_STR_LEN], busy_time[MAX_TIME_STR_LEN],
+	     max_run_time[MAX_TIME_STR_LEN];
 
 	box(poller_win, 0, 0);
 
@@ -2846,6 +2970,12 @@ draw_poller_win_content(WINDOW *poller_win, struct rpc_poller_info *poller_info)
 		print_in_middle(poller_win, 6, 1, POLLER_WIN_WIDTH + 6, "Idle", COLOR_PAIR(7));
 	}
 
+	print_left(poller_win, 7, 2, POLLER_WIN_WIDTH, "Busy [us]:            Max run [us]:", COLOR_PAIR(5));
+	get_time_str(get_poller_busy_tsc(poller_info), busy_time);
+	mvwprintw(poller_win, 7, POLLER_WIN_FIRST_COL, "%s", busy_time);
+	get_time_str(poller_info->max_run_tsc, max_run_time);
+	mvwprintw(poller_win, 7, POLLER_WIN_FIRST_COL + 23, "%s", max_run_time);
+
 	wnoutrefresh(poller_win);
 }
 
@@ -384,6 +384,29 @@ trace_print_json(void)
 	return 0;
 }
 
+static void
+print_tpoint_stats(void)
+{
+	struct spdk_trace_parser_tpoint_stats stats;
+	const struct spdk_trace_tpoint *tpoint;
+	uint64_t tsc_rate = g_file->tsc_rate;
+	uint16_t i;
+
+	printf("\n%-20s %12s %12s %12s %12s\n", "tracepoint", "count", "avg (us)", "min (us)",
+	       "max (us)");
+	for (i = 0; i < SPDK_TRACE_MAX_TPOINT_ID; i++) {
+		tpoint = &g_file->tpoint[i];
+		if (spdk_trace_parser_get_tpoint_stats(g_parser, i, &stats) != 0 || stats.count == 0) {
+			continue;
+		}
+
+		printf("%-20.20s %12ju %12.3f %12.3f %12.3f\n", tpoint->name, stats.count,
+		       get_us_from_tsc(stats.total_tsc / stats.count, tsc_rate),
+		       get_us_from_tsc(stats.min_tsc, tsc_rate),
+		       get_us_from_tsc(stats.max_tsc, tsc_rate));
+	}
+}
+
 static void
 usage(void)
 {
@@ -404,6 +427,7 @@ usage(void)
 	fprintf(stderr, "                      newest trace file in /dev/shm\n");
 #endif
 	fprintf(stderr, "                 '-j' to use JSON to format the output\n");
+	fprintf(stderr, "                 '-S' to display latency statistics of each tracepoint\n");
 }
 
 #if defined(__linux__)
@@ -434,9 +458,10 @@ main(int argc, char **argv)
 	int				rc = 0;
 	char				shm_name[64];
 	int				shm_id = -1, shm_pid = -1;
+	bool				print_stats = false;
 
 	g_exe_name = argv[0];
-	while ((op = getopt(argc, argv, "c:f:i:jp:s:t")) != -1) {
+	while ((op = getopt(argc, argv, "c:f:i:jp:s:St")) != -1) {
 		switch (op) {
 		case 'c':
 			lcore = atoi(optarg);
@@ -465,6 +490,9 @@ main(int argc, char **argv)
 		case 'j':
 			print_format = PRINT_FMT_JSON;
 			break;
+		case 'S':
+			print_stats = true;
+			break;
 		default:
 			usage();
 			exit(1);
@@ -521,6 +549,9 @@ main(int argc, char **argv)
 	case PRINT_FMT_DEFAULT:
 	default:
 		rc = trace_print(lcore);
+		if (rc == 0 && print_stats) {
+			print_tpoint_stats();
+		}
 		break;
 	}
 
@@ -14,12 +14,23 @@
 #define TRACE_FILE_COPY_SIZE	(32 * 1024)
 #define TRACE_PATH_MAX		2048
 
+/*
+ * The poll interval adapts to how much of the fullest lcore's circular buffer a single pass
+ * consumed. It grows while passes take less than TRACE_POLL_FILL_LOW percent of a buffer and
+ * shrinks once they take more than TRACE_POLL_FILL_HIGH percent, leaving enough headroom for
+ * bursts before the buffer wraps.
+ */
+#define TRACE_POLL_FILL_LOW		12
+#define TRACE_POLL_FILL_HIGH		25
+#define TRACE_POLL_INTERVAL_MAX_US	1000
+
 static char *g_exe_name;
 static int g_verbose = 1;
 static uint64_t g_tsc_rate;
 static uint64_t g_utsc_rate;
 static bool g_shutdown = false;
 static uint64_t g_file_size;
+static uint32_t g_max_poll_interval_us = TRACE_POLL_INTERVAL_MAX_US;
 
 struct lcore_trace_record_ctx {
 	char lcore_file[TRACE_PATH_MAX];
@@ -421,9 +432,6 @@ out:
 		       in_history->lcore);
 	}
 
-	/* Update tpoint_count info */
-	memcpy(lcore_port->out_history, lcore_port->in_history, sizeof(struct spdk_trace_history));
-
 	/* Update last_entry_tsc to align with appended entries */
 	last_idx = lcore_trace_last_entry_idx(in_history, shm_cir_next);
 	lcore_port->last_entry_tsc = in_history->entries[last_idx].tsc;
@@ -510,6 +518,8 @@ trace_files_aggregate(struct aggr_trace_record_ctx *ctx)
 			continue;
 		}
 
+		/* Take the tpoint_count info once, rather than on every poll */
+		memcpy(lcore_port->out_history, lcore_port->in_history, sizeof(struct spdk_trace_history));
 		lcore_port->out_history->num_entries = lcore_port->num_entries;
 		rc = cont_write(ctx->out_fd, lcore_port->out_history, sizeof(struct spdk_trace_history));
 		if (rc < 0) {
@@ -556,6 +566,18 @@ out:
 	return rc;
 }
 
+static uint32_t
+trace_poll_interval_update(uint32_t interval_us, uint64_t max_fill)
+{
+	if (max_fill > TRACE_POLL_FILL_HIGH) {
+		return interval_us / 2;
+	} else if (max_fill < TRACE_POLL_FILL_LOW) {
+		return spdk_min(spdk_max(interval_us * 2, 1), g_max_poll_interval_us);
+	}
+
+	return interval_us;
+}
+
 static void
 __shutdown_signal(int signo)
 {
@@ -603,6 +625,8 @@ usage(void)
 	printf("                      (one of -i or -p must be specified)\n");
 	printf("                 '-f' to specify output trace file name\n");
 	printf("                 '-t' to specify the duration of the trace record in seconds\n");
+	printf("                 '-I' to specify the maximum poll interval in microseconds\n");
+	printf("                      (default: %d, 0 polls continuously)\n", TRACE_POLL_INTERVAL_MAX_US);
 	printf("                 '-h' to print usage information\n");
 }
 
@@ -617,12 +641,15 @@ main(int argc, char **argv)
 	int				rc = 0;
 	int				record_duration_in_sec = 0;
 	uint64_t			last_record_tsc = UINT64_MAX;
+	uint64_t			num_entries, max_fill;
+	uint32_t			poll_interval_us = 0;
+	long				max_poll_interval_us;
 	int				i;
 	struct aggr_trace_record_ctx	ctx = {};
 	struct lcore_trace_record_ctx	*lcore_port;
 
 	g_exe_name = argv[0];
-	while ((op = getopt(argc, argv, "f:i:p:qs:t:h")) != -1) {
+	while ((op = getopt(argc, argv, "f:i:I:p:qs:t:h")) != -1) {
 		switch (op) {
 		case 'i':
 			shm_id = spdk_strtol(optarg, 10);
@@ -642,6 +669,15 @@ main(int argc, char **argv)
 		case 't':
 			record_duration_in_sec = spdk_strtol(optarg, 10);
 			break;
+		case 'I':
+			max_poll_interval_us = spdk_strtol(optarg, 10);
+			if (max_poll_interval_us < 0 || max_poll_interval_us > UINT32_MAX) {
+				fprintf(stderr, "-I must be a non-negative integer\n");
+				usage();
+				exit(1);
+			}
+			g_max_poll_interval_us = max_poll_interval_us;
+			break;
 		case 'h':
 			usage();
 			exit(EXIT_SUCCESS);
@@ -702,16 +738,28 @@ main(int argc, char **argv)
 
 	printf("Start to poll trace shm file %s\n", shm_name);
 	while (!g_shutdown && rc == 0 && (spdk_get_ticks() <= last_record_tsc)) {
+		max_fill = 0;
 		for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
 			lcore_port = &ctx.lcore_ports[i];
 
 			if (!lcore_port->valid) {
 				continue;
 			}
+
+			num_entries = lcore_port->num_entries;
 			rc = lcore_trace_record(lcore_port);
 			if (rc) {
 				break;
 			}
+
+			/* Percentage of the circular buffer consumed by this pass */
+			max_fill = spdk_max(max_fill, (lcore_port->num_entries - num_entries) * 100 /
+					    lcore_port->in_history->num_entries);
+		}
+
+		poll_interval_us = trace_poll_interval_update(poll_interval_us, max_fill);
+		if (rc == 0 && poll_interval_us > 0) {
+			usleep(poll_interval_us);
 		}
 	}
 
@@ -15,10 +15,13 @@
 #include "spdk/util.h"
 #include "spdk/xor.h"
 #include "spdk/dif.h"
+#include "spdk/histogram_data.h"
 
 #define DATA_PATTERN 0x5a
 #define ALIGN_4K 0x1000
 #define COMP_BUF_PAD_PERCENTAGE 1.1L
+#define AP_SEQ_MAX_STAGES 8
+#define AP_CRYPTO_KEY_NAME "accel_perf_key"
 
 static uint64_t	g_tsc_rate;
 static uint64_t g_tsc_end;
@@ -47,6 +50,14 @@ static int g_num_workers = 0;
 static char *g_cd_file_in_name = NULL;
 static pthread_mutex_t g_workers_lock = PTHREAD_MUTEX_INITIALIZER;
 static struct spdk_app_opts g_opts = {};
+/* Operations executed as a single accel sequence by the "sequence" workload */
+static enum spdk_accel_opcode g_seq_stages[AP_SEQ_MAX_STAGES];
+static uint32_t g_seq_stage_count = 0;
+static bool g_seq_accel_bufs = false;
+static struct spdk_accel_crypto_key *g_crypto_key = NULL;
+static const double g_latency_cutoffs[] = {
+	0.5, 0.9, 0.99, 0.999, -1,
+};
 
 struct ap_compress_seg {
 	void		*uncompressed_data;
@@ -73,6 +84,21 @@ struct display_info {
 	int thread;
 };
 
+/* Buffer holding the data between two stages of a sequence */
+struct ap_seq_buf {
+	void				*base;
+	struct iovec			*iovs;
+	uint32_t			iovcnt;
+	struct iovec			accel_iov;
+	struct spdk_memory_domain	*domain;
+	void				*domain_ctx;
+};
+
+struct ap_seq_step {
+	struct ap_task	*task;
+	uint32_t	stage;
+};
+
 struct ap_task {
 	void			*src;
 	struct iovec		*src_iovs;
@@ -91,6 +117,12 @@ struct ap_task {
 	uint32_t		num_blocks; /* used for the DIF related operations */
 	struct spdk_dif_ctx	dif_ctx;
 	struct spdk_dif_error	dif_err;
+	struct ap_seq_buf	*seq_bufs; /* used for the sequence workload */
+	uint32_t		seq_bufcnt;
+	struct ap_seq_step	*seq_steps;
+	int			seq_status;
+	uint64_t		submit_tsc;
+	uint64_t		step_tsc;
 	TAILQ_ENTRY(ap_task)	link;
 };
 
@@ -110,23 +142,112 @@ struct worker_thread {
 	void				*task_base;
 	struct display_info		display;
 	enum spdk_accel_opcode		workload;
+	/* Sequence workload: per-opcode stats and latency of whole sequences and of each stage */
+	struct spdk_accel_opcode_stats	opc_stats[SPDK_ACCEL_OPC_LAST];
+	struct spdk_histogram_data	*seq_latency;
+	struct spdk_histogram_data	*stage_latency[AP_SEQ_MAX_STAGES];
 };
 
+static inline bool
+seq_stage_is_data(enum spdk_accel_opcode opcode)
+{
+	/* Stages that write their output to a new buffer */
+	return opcode == SPDK_ACCEL_OPC_COPY || opcode == SPDK_ACCEL_OPC_ENCRYPT ||
+	       opcode == SPDK_ACCEL_OPC_DECRYPT;
+}
+
+static bool
+seq_has_stage(enum spdk_accel_opcode opcode)
+{
+	uint32_t i;
+
+	for (i = 0; i < g_seq_stage_count; i++) {
+		if (g_seq_stages[i] == opcode) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static int
+parse_seq_stages(const char *arg)
+{
+	char *str, *tok, *sp = NULL;
+	enum spdk_accel_opcode opcode;
+	int rc = 0;
+
+	str = strdup(arg);
+	if (str == NULL) {
+		return -ENOMEM;
+	}
+
+	g_seq_stage_count = 0;
+	for (tok = strtok_r(str, ",", &sp); tok != NULL; tok = strtok_r(NULL, ",", &sp)) {
+		for (opcode = 0; opcode < SPDK_ACCEL_OPC_LAST; opcode++) {
+			if (strcmp(tok, spdk_accel_get_opcode_name(opcode)) == 0) {
+				break;
+			}
+		}
+
+		if (opcode != SPDK_ACCEL_OPC_COPY && opcode != SPDK_ACCEL_OPC_FILL &&
+		    opcode != SPDK_ACCEL_OPC_CRC32C && opcode != SPDK_ACCEL_OPC_ENCRYPT &&
+		    opcode != SPDK_ACCEL_OPC_DECRYPT) {
+			fprintf(stderr, "Unsupported sequence stage: %s\n", tok);
+			rc = -EINVAL;
+			break;
+		}
+
+		if (g_seq_stage_count == AP_SEQ_MAX_STAGES) {
+			fprintf(stderr, "Sequence can have at most %u stages\n", AP_SEQ_MAX_STAGES);
+			rc = -EINVAL;
+			break;
+		}
+
+		g_seq_stages[g_seq_stage_count++] = opcode;
+	}
+
+	free(str);
+	return rc;
+}
+
+static void
+dump_seq_config(void)
+{
+	const char *module_name;
+	uint32_t i;
+
+	printf("Stages:        ");
+	for (i = 0; i < g_seq_stage_count; i++) {
+		module_name = NULL;
+		spdk_accel_get_opc_module_name(g_seq_stages[i], &module_name);
+		printf(" %s%s(%s)", i > 0 ? "-> " : "", spdk_accel_get_opcode_name(g_seq_stages[i]),
+		       module_name ? module_name : "none");
+	}
+	printf("\n");
+	printf("Buffers:        %s\n", g_seq_accel_bufs ? "accel domain" : "local memory");
+}
+
 static void
 dump_user_config(void)
 {
 	const char *module_name = NULL;
 	int rc;
 
-	rc = spdk_accel_get_opc_module_name(g_workload_selection, &module_name);
-	if (rc) {
-		printf("error getting module name (%d)\n", rc);
+	if (g_seq_stage_count == 0) {
+		rc = spdk_accel_get_opc_module_name(g_workload_selection, &module_name);
+		if (rc) {
+			printf("error getting module name (%d)\n", rc);
+		}
 	}
 
 	printf("\nSPDK Configuration:\n");
 	printf("Core mask:      %s\n\n", g_opts.reactor_mask);
 	printf("Accel Perf Configuration:\n");
 	printf("Workload Type:  %s\n", g_workload_type);
+	if (g_seq_stage_count > 0) {
+		dump_seq_config();
+	}
 	if (g_workload_selection == SPDK_ACCEL_OPC_CRC32C ||
 	    g_workload_selection == SPDK_ACCEL_OPC_COPY_CRC32C) {
 		printf("CRC-32C seed:   %u\n", g_crc32c_seed);
@@ -156,7 +277,9 @@ dump_user_config(void)
 		printf("Metadata size:  %u bytes\n", g_md_size_bytes);
 	}
 	printf("Vector count    %u\n", g_chained_count);
-	printf("Module:         %s\n", module_name);
+	if (g_seq_stage_count == 0) {
+		printf("Module:         %s\n", module_name);
+	}
 	if (g_workload_selection == SPDK_ACCEL_OPC_COMPRESS ||
 	    g_workload_selection == SPDK_ACCEL_OPC_DECOMPRESS) {
 		printf("File Name:      %s\n", g_cd_file_in_name);
@@ -179,10 +302,15 @@ usage(void)
 	printf("\t[-o transfer size in bytes (default: 4KiB. For compress/decompress, 0 means the input file size)]\n");
 	printf("\t[-t time in seconds]\n");
 	printf("\t[-w workload type must be one of these: copy, fill, crc32c, copy_crc32c, compare, compress, decompress, dualcast, xor,\n");
-	printf("\t[                                       dif_verify, dif_verify_copy, dif_generate, dif_generate_copy, dix_generate, dix_verify\n");
-	printf("\t[-M assign module to the operation, not compatible with accel_assign_opc RPC\n");
+	printf("\t[                                       dif_verify, dif_verify_copy, dif_generate, dif_generate_copy, dix_generate, dix_verify,\n");
+	printf("\t[                                       sequence\n");
+	printf("\t[-O for sequence workload, comma separated list of stages executed as one accel sequence,\n");
+	printf("\t    each one of: copy, fill, crc32c, encrypt, decrypt (e.g. decrypt,crc32c,copy)\n");
+	printf("\t[-D for sequence workload, allocate the buffers between stages from the accel memory domain\n");
+	printf("\t[-M assign module to the operation (to each stage for sequence), not compatible with accel_assign_opc RPC\n");
 	printf("\t[-l for compress/decompress workloads, name of uncompressed input file\n");
 	printf("\t[-S for crc32c workload, use this seed value (default 0)\n");
+	printf("\t[-b for encrypt/decrypt stages of sequence workload, logical block size (default 512)\n");
 	printf("\t[-P for compare workload, percentage of operations that should miscompare (percent, default 0)\n");
 	printf("\t[-f for fill workload, use this BYTE value (default 255)\n");
 	printf("\t[-x for xor workload, use this number of source buffers (default, minimum: 2)]\n");
@@ -198,6 +326,7 @@ parse_args(int ch, char *arg)
 
 	switch (ch) {
 	case 'a':
+	case 'b':
 	case 'C':
 	case 'f':
 	case 'T':
@@ -222,6 +351,9 @@ parse_args(int ch, char *arg)
 	case 'a':
 		g_allocate_depth = argval;
 		break;
+	case 'b':
+		g_block_size_bytes = argval;
+		break;
 	case 'C':
 		g_chained_count = argval;
 		break;
@@ -255,6 +387,15 @@ parse_args(int ch, char *arg)
 	case 'y':
 		g_verify = true;
 		break;
+	case 'D':
+		g_seq_accel_bufs = true;
+		break;
+	case 'O':
+		if (parse_seq_stages(optarg)) {
+			usage();
+			return 1;
+		}
+		break;
 	case 'w':
 		g_workload_type = optarg;
 		if (!strcmp(g_workload_type, "copy")) {
@@ -287,6 +428,8 @@ parse_args(int ch, char *arg)
 			g_workload_selection = SPDK_ACCEL_OPC_DIX_VERIFY;
 		} else if (!strcmp(g_workload_type, "dix_generate")) {
 			g_workload_selection = SPDK_ACCEL_OPC_DIX_GENERATE;
+		} else if (!strcmp(g_workload_type, "sequence")) {
+			g_workload_selection = SPDK_ACCEL_OPC_LAST;
 		} else {
 			fprintf(stderr, "Unsupported workload type: %s\n", optarg);
 			usage();
@@ -310,10 +453,19 @@ static void
 unregister_worker(void *arg1)
 {
 	struct worker_thread *worker = arg1;
+	uint32_t i;
 
 	if (worker->ch) {
-		spdk_accel_get_opcode_stats(worker->ch, worker->workload,
-					    &worker->stats, sizeof(worker->stats));
+		if (g_seq_stage_count > 0) {
+			for (i = 0; i < g_seq_stage_count; i++) {
+				spdk_accel_get_opcode_stats(worker->ch, g_seq_stages[i],
+							    &worker->opc_stats[g_seq_stages[i]],
+							    sizeof(worker->opc_stats[0]));
+			}
+		} else {
+			spdk_accel_get_opcode_stats(worker->ch, worker->workload,
+						    &worker->stats, sizeof(worker->stats));
+		}
 		spdk_put_io_channel(worker->ch);
 		worker->ch = NULL;
 	}
@@ -356,6 +508,80 @@ accel_perf_construct_iovs(void *buf, uint64_t sz, struct iovec *iovs, uint32_t i
 	assert(sz == 0);
 }
 
+static int
+_get_seq_task_data_bufs(struct ap_task *task)
+{
+	struct ap_seq_buf *buf;
+	uint32_t i;
+
+	task->seq_bufcnt = 1;
+	for (i = 0; i < g_seq_stage_count; i++) {
+		if (seq_stage_is_data(g_seq_stages[i])) {
+			task->seq_bufcnt++;
+		}
+	}
+
+	task->seq_bufs = calloc(task->seq_bufcnt, sizeof(*task->seq_bufs));
+	task->seq_steps = calloc(g_seq_stage_count, sizeof(*task->seq_steps));
+	if (task->seq_bufs == NULL || task->seq_steps == NULL) {
+		fprintf(stderr, "cannot allocate sequence buffers for task=%p\n", task);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < g_seq_stage_count; i++) {
+		task->seq_steps[i].task = task;
+		task->seq_steps[i].stage = i;
+	}
+
+	for (i = 0; i < task->seq_bufcnt; i++) {
+		/* Buffers in between the first and the last stage are allocated on submission */
+		if (g_seq_accel_bufs && i > 0 && i < task->seq_bufcnt - 1) {
+			continue;
+		}
+
+		buf = &task->seq_bufs[i];
+		buf->base = spdk_dma_zmalloc(g_xfer_size_bytes, 0, NULL);
+		if (buf->base == NULL) {
+			fprintf(stderr, "Unable to alloc sequence buffer\n");
+			return -ENOMEM;
+		}
+		memset(buf->base, i == 0 ? DATA_PATTERN : ~DATA_PATTERN, g_xfer_size_bytes);
+
+		buf->iovs = calloc(g_chained_count, sizeof(struct iovec));
+		if (buf->iovs == NULL) {
+			fprintf(stderr, "cannot allocate sequence iovs for task=%p\n", task);
+			return -ENOMEM;
+		}
+		buf->iovcnt = g_chained_count;
+		accel_perf_construct_iovs(buf->base, g_xfer_size_bytes, buf->iovs, buf->iovcnt);
+	}
+
+	if (seq_has_stage(SPDK_ACCEL_OPC_CRC32C)) {
+		task->crc_dst = spdk_dma_zmalloc(sizeof(*task->crc_dst), 0, NULL);
+		if (task->crc_dst == NULL) {
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+static void
+_free_seq_task_buffers(struct ap_task *task)
+{
+	uint32_t i;
+
+	if (task->seq_bufs) {
+		for (i = 0; i < task->seq_bufcnt; i++) {
+			spdk_dma_free(task->seq_bufs[i].base);
+			free(task->seq_bufs[i].iovs);
+		}
+		free(task->seq_bufs);
+	}
+	free(task->seq_steps);
+	spdk_dma_free(task->crc_dst);
+}
+
 static int
 _get_task_data_bufs(struct ap_task *task)
 {
@@ -368,6 +594,10 @@ _get_task_data_bufs(struct ap_task *task)
 	uint32_t num_blocks, transfer_size_with_md;
 	int rc;
 
+	if (g_seq_stage_count > 0) {
+		return _get_seq_task_data_bufs(task);
+	}
+
 	/* For dualcast, the DSA HW requires 4K alignment on destination addresses but
 	 * we do this for all modules to keep it simple.
 	 */
@@ -681,6 +911,159 @@ _get_task(struct worker_thread *worker)
 	return task;
 }
 
+static void
+accel_seq_step_done(void *arg)
+{
+	struct ap_seq_step *step = arg;
+	struct ap_task *task = step->task;
+	uint64_t now;
+
+	/* Steps of an aborted sequence are completed without being executed */
+	if (task->seq_status != 0) {
+		return;
+	}
+
+	now = spdk_get_ticks();
+	spdk_histogram_data_tally(task->worker->stage_latency[step->stage], now - task->step_tsc);
+	task->step_tsc = now;
+}
+
+static void
+_put_seq_accel_bufs(struct worker_thread *worker, struct ap_task *task)
+{
+	struct ap_seq_buf *buf;
+	uint32_t i;
+
+	if (!g_seq_accel_bufs) {
+		return;
+	}
+
+	for (i = 1; i + 1 < task->seq_bufcnt; i++) {
+		buf = &task->seq_bufs[i];
+		if (buf->iovs != NULL) {
+			spdk_accel_put_buf(worker->ch, buf->accel_iov.iov_base, buf->domain, buf->domain_ctx);
+			buf->iovs = NULL;
+		}
+	}
+}
+
+static void
+accel_seq_done(void *arg, int status)
+{
+	struct ap_task *task = arg;
+	struct worker_thread *worker = task->worker;
+
+	if (status == 0) {
+		spdk_histogram_data_tally(worker->seq_latency, spdk_get_ticks() - task->submit_tsc);
+		worker->stats.executed++;
+		worker->stats.num_bytes += g_xfer_size_bytes;
+	}
+
+	_put_seq_accel_bufs(worker, task);
+	accel_done(task, status);
+}
+
+static int
+_submit_seq_stages(struct worker_thread *worker, struct ap_task *task,
+		   struct spdk_accel_sequence **seq)
+{
+	struct ap_seq_buf *src, *dst;
+	struct ap_seq_step *step;
+	uint32_t i, b = 0;
+	int rc = 0;
+
+	if (g_seq_accel_bufs) {
+		for (i = 1; i + 1 < task->seq_bufcnt; i++) {
+			dst = &task->seq_bufs[i];
+			rc = spdk_accel_get_buf(worker->ch, g_xfer_size_bytes, &dst->accel_iov.iov_base,
+						&dst->domain, &dst->domain_ctx);
+			if (rc != 0) {
+				return rc;
+			}
+			dst->accel_iov.iov_len = g_xfer_size_bytes;
+			dst->iovs = &dst->accel_iov;
+			dst->iovcnt = 1;
+		}
+	}
+
+	for (i = 0; i < g_seq_stage_count; i++) {
+		step = &task->seq_steps[i];
+		src = &task->seq_bufs[b];
+		dst = seq_stage_is_data(g_seq_stages[i]) ? &task->seq_bufs[b + 1] : NULL;
+
+		switch (g_seq_stages[i]) {
+		case SPDK_ACCEL_OPC_COPY:
+			rc = spdk_accel_append_copy(seq, worker->ch, dst->iovs, dst->iovcnt,
+						    dst->domain, dst->domain_ctx,
+						    src->iovs, src->iovcnt, src->domain, src->domain_ctx,
+						    accel_seq_step_done, step);
+			break;
+		case SPDK_ACCEL_OPC_FILL:
+			/* The buffers are allocated contiguously, so fill can cover all of the iovecs */
+			rc = spdk_accel_append_fill(seq, worker->ch, src->iovs[0].iov_base, g_xfer_size_bytes,
+						    src->domain, src->domain_ctx, g_fill_pattern,
+						    accel_seq_step_done, step);
+			break;
+		case SPDK_ACCEL_OPC_CRC32C:
+			rc = spdk_accel_append_crc32c(seq, worker->ch, task->crc_dst, src->iovs, src->iovcnt,
+						      src->domain, src->domain_ctx, g_crc32c_seed,
+						      accel_seq_step_done, step);
+			break;
+		case SPDK_ACCEL_OPC_ENCRYPT:
+			rc = spdk_accel_append_encrypt(seq, worker->ch, g_crypto_key, dst->iovs, dst->iovcnt,
+						       dst->domain, dst->domain_ctx,
+						       src->iovs, src->iovcnt, src->domain, src->domain_ctx,
+						       0, g_block_size_bytes, accel_seq_step_done, step);
+			break;
+		case SPDK_ACCEL_OPC_DECRYPT:
+			rc = spdk_accel_append_decrypt(seq, worker->ch, g_crypto_key, dst->iovs, dst->iovcnt,
+						       dst->domain, dst->domain_ctx,
+						       src->iovs, src->iovcnt, src->domain, src->domain_ctx,
+						       0, g_block_size_bytes, accel_seq_step_done, step);
+			break;
+		default:
+			assert(false);
+			rc = -EINVAL;
+			break;
+		}
+
+		if (rc != 0) {
+			return rc;
+		}
+
+		if (dst != NULL) {
+			b++;
+		}
+	}
+
+	return 0;
+}
+
+/* Build and execute the sequence using the same ap task that just completed. */
+static void
+_submit_sequence(struct worker_thread *worker, struct ap_task *task)
+{
+	struct spdk_accel_sequence *seq = NULL;
+	int rc;
+
+	task->seq_status = 0;
+	task->submit_tsc = task->step_tsc = spdk_get_ticks();
+	worker->current_queue_depth++;
+
+	rc = _submit_seq_stages(worker, task, &seq);
+	if (rc != 0) {
+		task->seq_status = rc;
+		if (seq != NULL) {
+			spdk_accel_sequence_abort(seq);
+		}
+		_put_seq_accel_bufs(worker, task);
+		accel_done(task, rc);
+		return;
+	}
+
+	spdk_accel_sequence_finish(seq, accel_seq_done, task);
+}
+
 /* Submit one operation using the same ap task that just completed. */
 static void
 _submit_single(struct worker_thread *worker, struct ap_task *task)
@@ -690,6 +1073,11 @@ _submit_single(struct worker_thread *worker, struct ap_task *task)
 
 	assert(worker);
 
+	if (g_seq_stage_count > 0) {
+		_submit_sequence(worker, task);
+		return;
+	}
+
 	switch (worker->workload) {
 	case SPDK_ACCEL_OPC_COPY:
 		rc = spdk_accel_submit_copy(worker->ch, task->dst, task->src,
@@ -787,6 +1175,11 @@ _free_task_buffers(struct ap_task *task)
 {
 	uint32_t i;
 
+	if (g_seq_stage_count > 0) {
+		_free_seq_task_buffers(task);
+		return;
+	}
+
 	if (g_workload_selection == SPDK_ACCEL_OPC_DECOMPRESS ||
 	    g_workload_selection == SPDK_ACCEL_OPC_COMPRESS) {
 		free(task->dst_iovs);
@@ -1004,6 +1397,103 @@ accel_done(void *arg1, int status)
 	}
 }
 
+static void
+check_cutoff(void *ctx, uint64_t start, uint64_t end, uint64_t count,
+	     uint64_t total, uint64_t so_far)
+{
+	const double **cutoff = ctx;
+
+	if (count == 0) {
+		return;
+	}
+
+	while ((double)so_far / total >= **cutoff && **cutoff > 0) {
+		printf(" %9.3f", (double)end * SPDK_SEC_TO_USEC / g_tsc_rate);
+		(*cutoff)++;
+	}
+}
+
+static void
+dump_latency(const char *name, struct spdk_histogram_data *histogram)
+{
+	const double *cutoff = g_latency_cutoffs;
+
+	printf("%-20s", name);
+	spdk_histogram_data_iterate(histogram, check_cutoff, &cutoff);
+	printf("\n");
+}
+
+static void
+dump_seq_result(void)
+{
+	struct spdk_accel_opcode_stats stats;
+	struct spdk_histogram_data *seq_latency, *stage_latency[AP_SEQ_MAX_STAGES] = {};
+	struct worker_thread *worker;
+	const char *module_name;
+	char tmp[64];
+	uint64_t total_bytes = 0;
+	enum spdk_accel_opcode opcode;
+	uint32_t i;
+
+	seq_latency = spdk_histogram_data_alloc();
+	for (i = 0; i < g_seq_stage_count; i++) {
+		stage_latency[i] = spdk_histogram_data_alloc();
+	}
+
+	/*
+	 * Operations merged with, or elided by, other stages don't show up in the stats of their
+	 * opcode, which is what makes it possible to see the effect of fusing them.
+	 */
+	printf("\n%-20s %16s %16s %16s\n", "Stage", "Module", "Executed", "Bandwidth");
+	printf("------------------------------------------------------------------------------------\n");
+	for (opcode = 0; opcode < SPDK_ACCEL_OPC_LAST; opcode++) {
+		if (!seq_has_stage(opcode)) {
+			continue;
+		}
+
+		memset(&stats, 0, sizeof(stats));
+		for (worker = g_workers; worker != NULL; worker = worker->next) {
+			stats.executed += worker->opc_stats[opcode].executed;
+			stats.num_bytes += worker->opc_stats[opcode].num_bytes;
+		}
+
+		module_name = NULL;
+		spdk_accel_get_opc_module_name(opcode, &module_name);
+		printf("%-20s %16s %14" PRIu64 "/s %10" PRIu64 " MiB/s\n",
+		       spdk_accel_get_opcode_name(opcode), module_name ? module_name : "none",
+		       stats.executed / g_time_in_sec,
+		       stats.num_bytes / (g_time_in_sec * 1024 * 1024));
+	}
+
+	for (worker = g_workers; worker != NULL; worker = worker->next) {
+		total_bytes += worker->stats.num_bytes;
+		if (seq_latency != NULL) {
+			spdk_histogram_data_merge(seq_latency, worker->seq_latency);
+		}
+		for (i = 0; i < g_seq_stage_count; i++) {
+			if (stage_latency[i] != NULL) {
+				spdk_histogram_data_merge(stage_latency[i], worker->stage_latency[i]);
+			}
+		}
+	}
+
+	printf("\n%-20s %9s %9s %9s %9s (us)\n", "Latency", "50%", "90%", "99%", "99.9%");
+	printf("------------------------------------------------------------------------------------\n");
+	for (i = 0; i < g_seq_stage_count; i++) {
+		if (stage_latency[i] != NULL) {
+			snprintf(tmp, sizeof(tmp), "%u: %s", i, spdk_accel_get_opcode_name(g_seq_stages[i]));
+			dump_latency(tmp, stage_latency[i]);
+			spdk_histogram_data_free(stage_latency[i]);
+		}
+	}
+	if (seq_latency != NULL) {
+		dump_latency("sequence", seq_latency);
+		spdk_histogram_data_free(seq_latency);
+	}
+
+	printf("\nBytes/cycle: %.4f\n", (double)total_bytes / (g_time_in_sec * g_tsc_rate));
+}
+
 static int
 dump_result(void)
 {
@@ -1044,6 +1534,10 @@ dump_result(void)
 	printf("%-12s %18" PRIu64 "/s %10" PRIu64 " MiB/s %16"PRIu64 " %16" PRIu64 "\n",
 	       "Total", total_xfer_per_sec, total_bw_in_MiBps, total_failed, total_miscompared);
 
+	if (g_seq_stage_count > 0) {
+		dump_seq_result();
+	}
+
 	return total_failed ? 1 : 0;
 }
 
@@ -1126,6 +1620,21 @@ _init_thread(void *arg1)
 		goto error;
 	}
 
+	if (g_seq_stage_count > 0) {
+		worker->seq_latency = spdk_histogram_data_alloc();
+		if (worker->seq_latency == NULL) {
+			fprintf(stderr, "Unable to allocate histogram\n");
+			goto error;
+		}
+		for (i = 0; i < (int)g_seq_stage_count; i++) {
+			worker->stage_latency[i] = spdk_histogram_data_alloc();
+			if (worker->stage_latency[i] == NULL) {
+				fprintf(stderr, "Unable to allocate histogram\n");
+				goto error;
+			}
+		}
+	}
+
 	TAILQ_INIT(&worker->tasks_pool);
 
 	worker->task_base = calloc(num_tasks, sizeof(struct ap_task));
@@ -1381,6 +1890,46 @@ error:
 	spdk_app_stop(rc);
 }
 
+static int
+accel_perf_prep_sequence(void)
+{
+	struct spdk_accel_crypto_key_create_param param = {
+		.cipher = "AES_XTS",
+		.hex_key = "00112233445566778899aabbccddeeff",
+		.hex_key2 = "ffeeddccbbaa99887766554433221100",
+		.key_name = AP_CRYPTO_KEY_NAME,
+	};
+	const char *module_name = NULL;
+	uint32_t i;
+	int rc;
+
+	for (i = 0; g_module_name && i < g_seq_stage_count; i++) {
+		rc = spdk_accel_get_opc_module_name(g_seq_stages[i], &module_name);
+		if (rc != 0 || strcmp(g_module_name, module_name) != 0) {
+			fprintf(stderr, "Module '%s' was assigned via JSON config or RPC, instead of '%s'\n",
+				module_name, g_module_name);
+			fprintf(stderr, "-M option is not compatible with accel_assign_opc RPC\n");
+			return -EINVAL;
+		}
+	}
+
+	if (!seq_has_stage(SPDK_ACCEL_OPC_ENCRYPT) && !seq_has_stage(SPDK_ACCEL_OPC_DECRYPT)) {
+		return 0;
+	}
+
+	/* The key is destroyed along with the accel framework */
+	rc = spdk_accel_crypto_key_create(&param);
+	if (rc != 0) {
+		fprintf(stderr, "Unable to create crypto key (%d)\n", rc);
+		return rc;
+	}
+
+	g_crypto_key = spdk_accel_crypto_key_get(AP_CRYPTO_KEY_NAME);
+	assert(g_crypto_key != NULL);
+
+	return 0;
+}
+
 static void
 accel_perf_prep(void *arg1)
 {
@@ -1388,7 +1937,7 @@ accel_perf_prep(void *arg1)
 	const char *module_name = NULL;
 	int rc = 0;
 
-	if (g_module_name) {
+	if (g_module_name && g_seq_stage_count == 0) {
 		rc = spdk_accel_get_opc_module_name(g_workload_selection, &module_name);
 		if (rc != 0 || strcmp(g_module_name, module_name) != 0) {
 			fprintf(stderr, "Module '%s' was assigned via JSON config or RPC, instead of '%s'\n",
@@ -1399,6 +1948,15 @@ accel_perf_prep(void *arg1)
 		}
 	}
 
+	if (g_seq_stage_count > 0) {
+		rc = accel_perf_prep_sequence();
+		if (rc != 0) {
+			goto error_end;
+		}
+		accel_perf_start(arg1);
+		return;
+	}
+
 	if (g_workload_selection != SPDK_ACCEL_OPC_COMPRESS &&
 	    g_workload_selection != SPDK_ACCEL_OPC_DECOMPRESS) {
 		accel_perf_start(arg1);
@@ -1488,6 +2046,7 @@ int
 main(int argc, char **argv)
 {
 	struct worker_thread *worker, *tmp;
+	uint32_t i;
 	int rc;
 
 	pthread_mutex_init(&g_workers_lock, NULL);
@@ -1497,18 +2056,41 @@ main(int argc, char **argv)
 	g_opts.shutdown_cb = shutdown_cb;
 	g_opts.rpc_addr = NULL;
 
-	rc = spdk_app_parse_args(argc, argv, &g_opts, "a:C:o:q:t:yw:M:P:f:T:l:S:x:", NULL,
+	rc = spdk_app_parse_args(argc, argv, &g_opts, "a:b:C:o:q:t:yw:DM:O:P:f:T:l:S:x:", NULL,
 				 parse_args, usage);
 	if (rc != SPDK_APP_PARSE_ARGS_SUCCESS) {
 		return rc == SPDK_APP_PARSE_ARGS_HELP ? 0 : 1;
 	}
 
-	if (g_workload_selection == SPDK_ACCEL_OPC_LAST) {
+	if (g_workload_type == NULL) {
 		fprintf(stderr, "Must provide a workload type\n");
 		usage();
 		return -1;
 	}
 
+	if ((g_workload_selection == SPDK_ACCEL_OPC_LAST) != (g_seq_stage_count > 0)) {
+		fprintf(stderr, "-O must be provided for, and only for, the sequence workload\n");
+		usage();
+		return -1;
+	}
+
+	if (g_seq_stage_count > 0) {
+		if (g_verify) {
+			fprintf(stderr, "Sequence workload does not support the verify option\n");
+			return -1;
+		}
+		if (g_xfer_size_bytes == 0 || g_chained_count == 0 ||
+		    (uint32_t)g_xfer_size_bytes < g_chained_count) {
+			usage();
+			return -1;
+		}
+		if ((seq_has_stage(SPDK_ACCEL_OPC_ENCRYPT) || seq_has_stage(SPDK_ACCEL_OPC_DECRYPT)) &&
+		    (g_block_size_bytes == 0 || g_xfer_size_bytes % g_block_size_bytes != 0)) {
+			fprintf(stderr, "Transfer size must be a multiple of the block size\n");
+			return -1;
+		}
+	}
+
 	if (g_allocate_depth > 0 && g_queue_depth > g_allocate_depth) {
 		fprintf(stdout, "allocate depth must be at least as big as queue depth\n");
 		usage();
@@ -1535,12 +2117,22 @@ main(int argc, char **argv)
 		return -1;
 	}
 
-	if (g_module_name && spdk_accel_assign_opc(g_workload_selection, g_module_name)) {
+	if (g_module_name && g_seq_stage_count == 0 &&
+	    spdk_accel_assign_opc(g_workload_selection, g_module_name)) {
 		fprintf(stderr, "Was not able to assign '%s' module to the workload\n", g_module_name);
 		usage();
 		return -1;
 	}
 
+	for (i = 0; g_module_name && i < g_seq_stage_count; i++) {
+		if (spdk_accel_assign_opc(g_seq_stages[i], g_module_name)) {
+			fprintf(stderr, "Was not able to assign '%s' module to %s\n", g_module_name,
+				spdk_accel_get_opcode_name(g_seq_stages[i]));
+			usage();
+			return -1;
+		}
+	}
+
 	g_rc = spdk_app_start(&g_opts, accel_perf_prep, NULL);
 	if (g_rc) {
 		SPDK_ERRLOG("ERROR starting application\n");
@@ -1551,6 +2143,14 @@ main(int argc, char **argv)
 	worker = g_workers;
 	while (worker) {
 		tmp = worker->next;
+		if (worker->seq_latency != NULL) {
+			spdk_histogram_data_free(worker->seq_latency);
+		}
+		for (i = 0; i < g_seq_stage_count; i++) {
+			if (worker->stage_latency[i] != NULL) {
+				spdk_histogram_data_free(worker->stage_latency[i]);
+			}
+		}
 		free(worker);
 		worker = tmp;
 	}
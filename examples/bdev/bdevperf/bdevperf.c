@@ -24,7 +24,7 @@
 #define BDEVPERF_CONFIG_MAX_FILENAME 1024
 #define BDEVPERF_CONFIG_UNDEFINED -1
 #define BDEVPERF_CONFIG_ERROR -2
-#define PATTERN_TYPES_STR "(read, write, randread, randwrite, rw, randrw, verify, reset, unmap, flush, write_zeroes)"
+#define PATTERN_TYPES_STR "(read, write, randread, randwrite, rw, randrw, verify, reset, unmap, flush, write_zeroes, replay)"
 #define BDEVPERF_MAX_COREMASK_STRING 64
 
 struct bdevperf_task {
@@ -36,8 +36,11 @@ struct bdevperf_task {
 	void				*md_buf;
 	void				*verify_md_buf;
 	uint64_t			offset_blocks;
+	uint64_t			num_blocks;
 	struct bdevperf_task		*task_to_abort;
 	enum spdk_bdev_io_type		io_type;
+	/* time the I/O was due to be submitted, used to account its latency in open-loop mode */
+	uint64_t			arrival_tsc;
 	TAILQ_ENTRY(bdevperf_task)	link;
 	struct spdk_bdev_io_wait_entry	bdev_io_wait;
 };
@@ -76,6 +79,12 @@ static double g_zipf_theta;
 static bool g_random_map = false;
 static bool g_unique_writes = false;
 static bool g_hide_metadata = false;
+static uint64_t g_arrival_rate = 0;
+static bool g_arrival_fixed = false;
+static uint64_t g_slo_latency_usec = 0;
+static const char *g_replay_log_file_name = NULL;
+static double g_replay_speedup = 1.0;
+static bool g_replay_timed = false;
 
 static struct spdk_cpuset g_all_cpuset;
 static struct spdk_poller *g_perf_timer = NULL;
@@ -113,6 +122,26 @@ static const double g_latency_cutoffs[] = {
 static const char *g_rpc_log_file_name = NULL;
 static FILE *g_rpc_log_file = NULL;
 
+/* I/O of a recorded trace, offset and length are in bytes */
+struct bdevperf_replay_io {
+	uint64_t			time_in_usec;
+	uint64_t			offset;
+	uint64_t			length;
+	enum spdk_bdev_io_type		io_type;
+};
+
+/* I/O of a single device in the trace, replayed by the jobs of the bdev with the same name */
+struct bdevperf_replay_file {
+	char				*name;
+	struct bdevperf_replay_io	*ios;
+	uint64_t			num_ios;
+	uint64_t			max_ios;
+	uint64_t			num_unmaps;
+	TAILQ_ENTRY(bdevperf_replay_file) link;
+};
+
+static TAILQ_HEAD(, bdevperf_replay_file) g_replay_files = TAILQ_HEAD_INITIALIZER(g_replay_files);
+
 struct latency_info {
 	uint64_t	min;
 	uint64_t	max;
@@ -132,6 +161,7 @@ enum job_config_rw {
 	JOB_CONFIG_RW_UNMAP,
 	JOB_CONFIG_RW_FLUSH,
 	JOB_CONFIG_RW_WRITE_ZEROES,
+	JOB_CONFIG_RW_REPLAY,
 };
 
 struct bdevperf_job {
@@ -183,6 +213,31 @@ struct bdevperf_job {
 
 	/* counter used for generating unique write data (-U option) */
 	uint32_t			write_io_count;
+
+	/* Open-loop mode (-O option or timed replay). I/Os are issued at their arrival times,
+	 * independently of completions, with at most queue_depth of them outstanding. */
+	bool				open_loop;
+	uint64_t			arrival_rate;
+	double				arrival_interval_ticks;
+	uint64_t			arrival_start_tsc;
+	uint64_t			next_arrival_tsc;
+	uint64_t			last_blocked_tsc;
+	int				arrivals_outstanding;
+	uint64_t			arrivals_submitted;
+	uint64_t			arrivals_delayed;
+	uint64_t			arrival_lag_ticks;
+	uint64_t			arrival_max_lag_ticks;
+	struct spdk_poller		*arrival_poller;
+
+	/* replay workload (-I option) */
+	const struct bdevperf_replay_file *replay;
+	uint64_t			replay_idx;
+	uint64_t			replay_bytes;
+	double				replay_ticks_per_usec;
+
+	/* latency SLO (-Q option) */
+	uint64_t			slo_latency_ticks;
+	uint64_t			io_within_slo;
 };
 
 struct spdk_bdevperf {
@@ -271,6 +326,8 @@ parse_workload_type(enum job_config_rw ret)
 		return "rw";
 	case JOB_CONFIG_RW_RANDRW:
 		return "randrw";
+	case JOB_CONFIG_RW_REPLAY:
+		return "replay";
 	default:
 		fprintf(stderr, "wrong workload_type code\n");
 	}
@@ -364,7 +421,13 @@ bdevperf_job_get_stats(struct bdevperf_job *job,
 		io_per_second = get_ema_io_per_second(job, ema_period);
 	}
 	tsc_rate = spdk_get_ticks_hz();
-	mb_per_second = io_per_second * job->io_size / (1024 * 1024);
+	if (job->replay != NULL) {
+		/* Replayed I/O sizes vary, use the average size of the completed I/O */
+		mb_per_second = job->io_completed == 0 ? 0.0 :
+				io_per_second * job->replay_bytes / job->io_completed / (1024 * 1024);
+	} else {
+		mb_per_second = io_per_second * job->io_size / (1024 * 1024);
+	}
 
 	spdk_histogram_data_iterate(job->histogram, get_avg_latency, &latency_info);
 
@@ -390,6 +453,34 @@ bdevperf_job_get_stats(struct bdevperf_job *job,
 	job_stats->io_time_in_usec = time_in_usec;
 }
 
+static double
+ticks_to_usec(uint64_t ticks)
+{
+	return (double)ticks * SPDK_SEC_TO_USEC / spdk_get_ticks_hz();
+}
+
+static double
+get_avg_arrival_lag(struct bdevperf_job *job)
+{
+	if (job->arrivals_submitted == 0) {
+		return 0.0;
+	}
+
+	return ticks_to_usec(job->arrival_lag_ticks) / job->arrivals_submitted;
+}
+
+static double
+get_slo_attainment(struct bdevperf_job *job)
+{
+	uint64_t total_io = job->io_completed + job->io_failed;
+
+	if (total_io == 0) {
+		return 0.0;
+	}
+
+	return (double)job->io_within_slo * 100 / total_io;
+}
+
 static void
 performance_dump_job_stdout(struct bdevperf_job *job,
 			    struct bdevperf_stats *job_stats)
@@ -414,6 +505,26 @@ performance_dump_job_stdout(struct bdevperf_job *job,
 		printf("\t Verification LBA range: start 0x%" PRIx64 " length 0x%" PRIx64 "\n",
 		       job->ios_base, job->size_in_ios);
 	}
+	if (job->replay != NULL) {
+		printf("\t Replay of %s: %" PRIu64 "/%" PRIu64 " I/O submitted",
+		       job->replay->name, job->replay_idx, job->replay->num_ios);
+		if (job->open_loop) {
+			printf(", speed-up %.2f", g_replay_speedup);
+		}
+		printf("\n");
+	} else if (job->open_loop) {
+		printf("\t Open loop: %s arrivals at %" PRIu64 " IO/s\n",
+		       g_arrival_fixed ? "fixed" : "poisson", job->arrival_rate);
+	}
+	if (job->open_loop) {
+		printf("\t Submission lag: avg %.2f us, max %.2f us, %" PRIu64 " I/O delayed by queue depth\n",
+		       get_avg_arrival_lag(job), ticks_to_usec(job->arrival_max_lag_ticks),
+		       job->arrivals_delayed);
+	}
+	if (job->slo_latency_ticks != 0) {
+		printf("\t Latency SLO %" PRIu64 " us: met by %.4f%% of I/O\n",
+		       g_slo_latency_usec, get_slo_attainment(job));
+	}
 
 	printf("\t %-20s: %10.2f %10.2f %10.2f",
 	       job->name,
@@ -471,6 +582,35 @@ performance_dump_job_json(struct bdevperf_job *job,
 	spdk_json_write_named_double(w, "avg_latency_us", job_stats->average_latency);
 	spdk_json_write_named_double(w, "min_latency_us", job_stats->min_latency);
 	spdk_json_write_named_double(w, "max_latency_us", job_stats->max_latency);
+
+	if (job->replay != NULL) {
+		spdk_json_write_named_object_begin(w, "replay");
+		spdk_json_write_named_string(w, "device", job->replay->name);
+		spdk_json_write_named_uint64(w, "io_submitted", job->replay_idx);
+		spdk_json_write_named_uint64(w, "io_total", job->replay->num_ios);
+		if (job->open_loop) {
+			spdk_json_write_named_double(w, "speedup", g_replay_speedup);
+		}
+		spdk_json_write_object_end(w);
+	}
+	if (job->open_loop) {
+		spdk_json_write_named_object_begin(w, "open_loop");
+		if (job->replay == NULL) {
+			spdk_json_write_named_string(w, "distribution", g_arrival_fixed ? "fixed" : "poisson");
+			spdk_json_write_named_uint64(w, "arrival_rate", job->arrival_rate);
+		}
+		spdk_json_write_named_uint64(w, "io_delayed", job->arrivals_delayed);
+		spdk_json_write_named_double(w, "avg_lag_us", get_avg_arrival_lag(job));
+		spdk_json_write_named_double(w, "max_lag_us", ticks_to_usec(job->arrival_max_lag_ticks));
+		spdk_json_write_object_end(w);
+	}
+	if (job->slo_latency_ticks != 0) {
+		spdk_json_write_named_object_begin(w, "slo");
+		spdk_json_write_named_uint64(w, "latency_us", g_slo_latency_usec);
+		spdk_json_write_named_uint64(w, "io_within_slo", job->io_within_slo);
+		spdk_json_write_named_double(w, "attainment", get_slo_attainment(job));
+		spdk_json_write_object_end(w);
+	}
 }
 
 static void
@@ -865,9 +1005,12 @@ bdevperf_job_empty(struct bdevperf_job *job)
 
 	end_tsc = spdk_get_ticks() - g_start_tsc;
 	job->run_time_in_usec = end_tsc * SPDK_SEC_TO_USEC / spdk_get_ticks_hz();
-	/* keep histogram info before channel is destroyed */
-	spdk_bdev_channel_get_histogram(job->ch, bdevperf_channel_get_histogram_cb,
-					job->histogram);
+	/* keep histogram info before channel is destroyed. In open-loop mode, the job
+	 * histogram is filled with the latencies measured from the arrival times instead. */
+	if (!job->open_loop) {
+		spdk_bdev_channel_get_histogram(job->ch, bdevperf_channel_get_histogram_cb,
+						job->histogram);
+	}
 	spdk_put_io_channel(job->ch);
 	spdk_thread_send_msg(g_main_thread, bdevperf_job_end, job);
 }
@@ -902,6 +1045,7 @@ bdevperf_job_drain(void *ctx)
 	struct bdevperf_job *job = ctx;
 
 	spdk_poller_unregister(&job->run_timer);
+	spdk_poller_unregister(&job->arrival_poller);
 	if (job->reset) {
 		spdk_poller_unregister(&job->reset_timer);
 	}
@@ -972,14 +1116,14 @@ bdevperf_verify_dif(struct bdevperf_task *task)
 	}
 
 	if (spdk_bdev_is_md_interleaved(bdev)) {
-		rc = spdk_dif_verify(&task->iov, 1, job->io_size_blocks, &dif_ctx, &err_blk);
+		rc = spdk_dif_verify(&task->iov, 1, task->num_blocks, &dif_ctx, &err_blk);
 	} else {
 		struct iovec md_iov = {
 			.iov_base	= task->md_buf,
-			.iov_len	= spdk_bdev_get_md_size(bdev) * job->io_size_blocks,
+			.iov_len	= spdk_bdev_get_md_size(bdev) * task->num_blocks,
 		};
 
-		rc = spdk_dix_verify(&task->iov, 1, &md_iov, job->io_size_blocks, &dif_ctx, &err_blk);
+		rc = spdk_dix_verify(&task->iov, 1, &md_iov, task->num_blocks, &dif_ctx, &err_blk);
 	}
 
 	if (rc != 0) {
@@ -990,6 +1134,22 @@ bdevperf_verify_dif(struct bdevperf_task *task)
 	return rc;
 }
 
+static void
+bdevperf_job_account_latency(struct bdevperf_job *job, struct bdevperf_task *task, bool success)
+{
+	uint64_t latency_ticks = spdk_get_ticks() - task->arrival_tsc;
+
+	/* The bdev histogram only covers the time spent in the bdev layer, which hides the time
+	 * an I/O waited for a free task in open-loop mode, so the job keeps its own. */
+	if (job->open_loop) {
+		spdk_histogram_data_tally(job->histogram, latency_ticks);
+	}
+
+	if (success && latency_ticks <= job->slo_latency_ticks) {
+		job->io_within_slo++;
+	}
+}
+
 static void
 bdevperf_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
@@ -1056,15 +1216,27 @@ bdevperf_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 
 	spdk_bdev_free_io(bdev_io);
 
+	if (job->replay != NULL && success) {
+		job->replay_bytes += task->num_blocks * spdk_bdev_get_data_block_size(job->bdev);
+	}
+
+	if (job->open_loop || job->slo_latency_ticks != 0) {
+		bdevperf_job_account_latency(job, task, success);
+	}
+
 	/*
 	 * is_draining indicates when time has expired for the test run
 	 * and we are just waiting for the previously submitted I/O
 	 * to complete.  In this case, do not submit a new I/O to replace
-	 * the one just completed.
+	 * the one just completed.  In open-loop mode, new I/O is only
+	 * submitted by the arrival poller.
 	 */
-	if (!job->is_draining) {
+	if (!job->is_draining && !job->open_loop) {
 		bdevperf_submit_single(job, task);
 	} else {
+		if (job->open_loop) {
+			job->arrivals_outstanding--;
+		}
 		bdevperf_end_task(task);
 	}
 }
@@ -1143,14 +1315,14 @@ bdevperf_generate_dif(struct bdevperf_task *task)
 	}
 
 	if (spdk_bdev_desc_is_md_interleaved(desc)) {
-		rc = spdk_dif_generate(&task->iov, 1, job->io_size_blocks, &dif_ctx);
+		rc = spdk_dif_generate(&task->iov, 1, task->num_blocks, &dif_ctx);
 	} else {
 		struct iovec md_iov = {
 			.iov_base	= task->md_buf,
-			.iov_len	= spdk_bdev_desc_get_md_size(desc) * job->io_size_blocks,
+			.iov_len	= spdk_bdev_desc_get_md_size(desc) * task->num_blocks,
 		};
 
-		rc = spdk_dix_generate(&task->iov, 1, &md_iov, job->io_size_blocks, &dif_ctx);
+		rc = spdk_dix_generate(&task->iov, 1, &md_iov, task->num_blocks, &dif_ctx);
 	}
 
 	if (rc != 0) {
@@ -1189,32 +1361,32 @@ bdevperf_submit_task(void *arg)
 				rc = spdk_bdev_writev_blocks_with_md(desc, ch, &task->iov, 1,
 								     task->md_buf,
 								     task->offset_blocks,
-								     job->io_size_blocks,
+								     task->num_blocks,
 								     cb_fn, task);
 			}
 		}
 		break;
 	case SPDK_BDEV_IO_TYPE_FLUSH:
 		rc = spdk_bdev_flush_blocks(desc, ch, task->offset_blocks,
-					    job->io_size_blocks, bdevperf_complete, task);
+					    task->num_blocks, bdevperf_complete, task);
 		break;
 	case SPDK_BDEV_IO_TYPE_UNMAP:
 		rc = spdk_bdev_unmap_blocks(desc, ch, task->offset_blocks,
-					    job->io_size_blocks, bdevperf_complete, task);
+					    task->num_blocks, bdevperf_complete, task);
 		break;
 	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
 		rc = spdk_bdev_write_zeroes_blocks(desc, ch, task->offset_blocks,
-						   job->io_size_blocks, bdevperf_complete, task);
+						   task->num_blocks, bdevperf_complete, task);
 		break;
 	case SPDK_BDEV_IO_TYPE_READ:
 		if (g_zcopy) {
-			rc = spdk_bdev_zcopy_start(desc, ch, NULL, 0, task->offset_blocks, job->io_size_blocks,
+			rc = spdk_bdev_zcopy_start(desc, ch, NULL, 0, task->offset_blocks, task->num_blocks,
 						   true, bdevperf_zcopy_populate_complete, task);
 		} else {
 			rc = spdk_bdev_readv_blocks_with_md(desc, ch, &task->iov, 1,
 							    task->md_buf,
 							    task->offset_blocks,
-							    job->io_size_blocks,
+							    task->num_blocks,
 							    bdevperf_complete, task);
 		}
 		break;
@@ -1318,6 +1490,40 @@ bdevperf_job_get_task(struct bdevperf_job *job)
 	return task;
 }
 
+static void
+bdevperf_job_replay_prep_task(struct bdevperf_job *job, struct bdevperf_task *task)
+{
+	const struct bdevperf_replay_io *io = &job->replay->ios[job->replay_idx++];
+	uint32_t block_size = spdk_bdev_get_data_block_size(job->bdev);
+	uint64_t bdev_num_blocks = spdk_bdev_get_num_blocks(job->bdev);
+	uint64_t num_blocks;
+
+	task->io_type = io->io_type;
+	task->offset_blocks = io->offset / block_size;
+	if (io->io_type == SPDK_BDEV_IO_TYPE_FLUSH && io->length == 0) {
+		task->offset_blocks = 0;
+		num_blocks = bdev_num_blocks;
+	} else {
+		num_blocks = spdk_divide_round_up(io->offset + io->length, block_size) - task->offset_blocks;
+		num_blocks = spdk_max(spdk_min(num_blocks, bdev_num_blocks), 1);
+	}
+
+	/* Wrap I/O beyond the end of the bdev, so traces of larger devices can be replayed */
+	if (task->offset_blocks + num_blocks > bdev_num_blocks) {
+		task->offset_blocks %= bdev_num_blocks - num_blocks + 1;
+	}
+
+	task->num_blocks = num_blocks;
+	task->iov.iov_base = task->buf;
+	task->iov.iov_len = spdk_min(num_blocks, job->io_size_blocks) *
+			    spdk_bdev_desc_get_block_size(job->bdev_desc);
+
+	if (job->replay_idx == job->replay->num_ios) {
+		/* Nothing left to replay, the job ends once the outstanding I/O completes */
+		bdevperf_job_drain(job);
+	}
+}
+
 static void
 bdevperf_submit_single(struct bdevperf_job *job, struct bdevperf_task *task)
 {
@@ -1325,6 +1531,12 @@ bdevperf_submit_single(struct bdevperf_job *job, struct bdevperf_task *task)
 	uint64_t rand_value;
 	uint32_t first_clear;
 
+	if (job->replay != NULL) {
+		bdevperf_job_replay_prep_task(job, task);
+		bdevperf_submit_task(task);
+		return;
+	}
+
 	if (job->zipf) {
 		offset_in_ios = spdk_zipf_generate(job->zipf);
 	} else if (job->is_random) {
@@ -1388,6 +1600,12 @@ bdevperf_submit_single(struct bdevperf_job *job, struct bdevperf_task *task)
 	 */
 	task->offset_blocks = (offset_in_ios + job->ios_base) * job->io_size_blocks;
 
+	task->num_blocks = job->io_size_blocks;
+
+	if (!job->open_loop && job->slo_latency_ticks != 0) {
+		task->arrival_tsc = spdk_get_ticks();
+	}
+
 	if (job->flush) {
 		task->io_type = SPDK_BDEV_IO_TYPE_FLUSH;
 	} else if (job->unmap) {
@@ -1486,6 +1704,75 @@ bdevperf_timeout_cb(void *cb_arg, struct spdk_bdev_io *bdev_io)
 	bdevperf_submit_task(task);
 }
 
+static uint64_t
+bdevperf_job_get_arrival_interval(struct bdevperf_job *job)
+{
+	double u;
+
+	if (g_arrival_fixed) {
+		return (uint64_t)(job->arrival_interval_ticks + 0.5);
+	}
+
+	/* Exponentially distributed interval, u is uniform in (0, 1] */
+	u = ((double)rand_r(&job->seed) + 1.0) / ((double)RAND_MAX + 1.0);
+
+	return (uint64_t)(-log(u) * job->arrival_interval_ticks + 0.5);
+}
+
+static void
+bdevperf_job_update_next_arrival(struct bdevperf_job *job)
+{
+	const struct bdevperf_replay_io *io;
+
+	if (job->replay != NULL) {
+		io = &job->replay->ios[job->replay_idx];
+		job->next_arrival_tsc = job->arrival_start_tsc +
+					(uint64_t)(io->time_in_usec * job->replay_ticks_per_usec);
+	} else {
+		job->next_arrival_tsc += bdevperf_job_get_arrival_interval(job);
+	}
+}
+
+static int
+bdevperf_job_arrival_poll(void *ctx)
+{
+	struct bdevperf_job *job = ctx;
+	struct bdevperf_task *task;
+	uint64_t now = spdk_get_ticks();
+	int count = 0;
+
+	while (job->next_arrival_tsc <= now) {
+		if (job->arrivals_outstanding == job->queue_depth) {
+			/* The I/O is submitted once a task completes. Its latency is still
+			 * accounted from the time it was due, so the time it waited here
+			 * isn't hidden from the results. */
+			job->last_blocked_tsc = now;
+			break;
+		}
+
+		task = bdevperf_job_get_task(job);
+		task->arrival_tsc = job->next_arrival_tsc;
+		if (task->arrival_tsc <= job->last_blocked_tsc) {
+			job->arrivals_delayed++;
+		}
+
+		job->arrival_lag_ticks += now - task->arrival_tsc;
+		job->arrival_max_lag_ticks = spdk_max(job->arrival_max_lag_ticks, now - task->arrival_tsc);
+		job->arrivals_submitted++;
+		job->arrivals_outstanding++;
+		count++;
+
+		bdevperf_submit_single(job, task);
+		if (job->is_draining) {
+			break;
+		}
+
+		bdevperf_job_update_next_arrival(job);
+	}
+
+	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
 static void
 bdevperf_job_run(void *ctx)
 {
@@ -1503,7 +1790,18 @@ bdevperf_job_run(void *ctx)
 							10 * SPDK_SEC_TO_USEC);
 	}
 
-	for (i = 0; i < job->queue_depth; i++) {
+	if (job->open_loop) {
+		job->arrival_start_tsc = spdk_get_ticks();
+		job->next_arrival_tsc = job->arrival_start_tsc;
+		if (job->replay != NULL) {
+			bdevperf_job_update_next_arrival(job);
+		}
+		job->arrival_poller = SPDK_POLLER_REGISTER(bdevperf_job_arrival_poll, job, 0);
+		return;
+	}
+
+	/* A replay job may run out of I/O before the queue is full */
+	for (i = 0; i < job->queue_depth && !job->is_draining; i++) {
 		task = bdevperf_job_get_task(job);
 		bdevperf_submit_single(job, task);
 	}
@@ -1856,9 +2154,69 @@ job_init_rw(struct bdevperf_job *job, enum job_config_rw rw)
 	case JOB_CONFIG_RW_WRITE_ZEROES:
 		job->write_zeroes = true;
 		break;
+	case JOB_CONFIG_RW_REPLAY:
+		/* Set up from the trace by bdevperf_job_init_replay() */
+		break;
 	}
 }
 
+static int
+bdevperf_job_init_replay(struct bdevperf_job *job)
+{
+	struct bdevperf_replay_file *file;
+	uint32_t block_size = spdk_bdev_get_data_block_size(job->bdev);
+	uint64_t i, num_blocks, max_blocks = 1;
+
+	if (TAILQ_EMPTY(&g_replay_files)) {
+		fprintf(stderr, "replay workload requires a trace given with -I option\n");
+		return -EINVAL;
+	}
+	if (g_zcopy || job->arrival_rate != 0) {
+		fprintf(stderr, "-Z and -O options can't be used with replay workload\n");
+		return -EINVAL;
+	}
+
+	/* A trace of a single device is replayed on every bdev */
+	file = TAILQ_FIRST(&g_replay_files);
+	if (TAILQ_NEXT(file, link) != NULL) {
+		TAILQ_FOREACH(file, &g_replay_files, link) {
+			if (!strcmp(file->name, job->name)) {
+				break;
+			}
+		}
+		if (file == NULL) {
+			printf("Skipping %s because the trace has no I/O for it\n", job->name);
+			return -ENOENT;
+		}
+	}
+
+	if (file->num_unmaps != 0 && !spdk_bdev_io_type_supported(job->bdev, SPDK_BDEV_IO_TYPE_UNMAP)) {
+		fprintf(stderr, "Trace of %s contains unmaps, which %s does not support\n",
+			file->name, job->name);
+		return -ENOTSUP;
+	}
+
+	for (i = 0; i < file->num_ios; i++) {
+		if (file->ios[i].io_type != SPDK_BDEV_IO_TYPE_READ &&
+		    file->ios[i].io_type != SPDK_BDEV_IO_TYPE_WRITE) {
+			continue;
+		}
+		num_blocks = spdk_divide_round_up(file->ios[i].offset + file->ios[i].length, block_size) -
+			     file->ios[i].offset / block_size;
+		max_blocks = spdk_max(max_blocks, num_blocks);
+	}
+
+	/* Buffers are sized for the largest I/O of the trace */
+	max_blocks = spdk_min(max_blocks, spdk_bdev_get_num_blocks(job->bdev));
+	job->io_size = max_blocks * block_size;
+	job->replay = file;
+	job->rw_percentage = 0;
+	job->open_loop = g_replay_timed;
+	job->replay_ticks_per_usec = (double)spdk_get_ticks_hz() / SPDK_SEC_TO_USEC / g_replay_speedup;
+
+	return 0;
+}
+
 static int
 bdevperf_construct_job(struct spdk_bdev *bdev, struct job_config *config,
 		       struct spdk_thread *thread)
@@ -1906,11 +2264,26 @@ bdevperf_construct_job(struct spdk_bdev *bdev, struct job_config *config,
 	job->continue_on_failure = g_continue_on_failure;
 	job->queue_depth = config->iodepth;
 	job->bdev = bdev;
-	job->io_size_blocks = job->io_size / data_block_size;
-	job->buf_size = job->io_size_blocks * block_size;
 	job->abort = g_abort;
 	job_init_rw(job, config->rw);
 	job->md_check = spdk_bdev_get_dif_type(job->bdev) == SPDK_DIF_DISABLE;
+	job->arrival_rate = g_arrival_rate;
+	if (job->arrival_rate != 0) {
+		job->open_loop = true;
+		job->arrival_interval_ticks = (double)spdk_get_ticks_hz() / job->arrival_rate;
+	}
+
+	if (job->workload_type == JOB_CONFIG_RW_REPLAY) {
+		rc = bdevperf_job_init_replay(job);
+		if (rc != 0) {
+			bdevperf_job_free(job);
+			return rc == -ENOENT ? 0 : rc;
+		}
+	}
+
+	job->io_size_blocks = job->io_size / data_block_size;
+	job->buf_size = job->io_size_blocks * block_size;
+	job->slo_latency_ticks = g_slo_latency_usec * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
 
 	if ((job->io_size % data_block_size) != 0) {
 		SPDK_ERRLOG("IO size (%d) is not multiples of data block size of bdev %s (%"PRIu32")\n",
@@ -2104,6 +2477,8 @@ parse_rw(const char *str, enum job_config_rw ret)
 		ret = JOB_CONFIG_RW_RW;
 	} else if (!strcmp(str, "randrw")) {
 		ret = JOB_CONFIG_RW_RANDRW;
+	} else if (!strcmp(str, "replay")) {
+		ret = JOB_CONFIG_RW_REPLAY;
 	} else {
 		fprintf(stderr, "rw must be one of\n"
 			PATTERN_TYPES_STR "\n");
@@ -2597,6 +2972,288 @@ error:
 	return 1;
 }
 
+static struct bdevperf_replay_file *
+replay_file_get(const char *name)
+{
+	struct bdevperf_replay_file *file;
+
+	TAILQ_FOREACH(file, &g_replay_files, link) {
+		if (!strcmp(file->name, name)) {
+			return file;
+		}
+	}
+
+	file = calloc(1, sizeof(*file));
+	if (file == NULL) {
+		return NULL;
+	}
+
+	file->name = strdup(name);
+	if (file->name == NULL) {
+		free(file);
+		return NULL;
+	}
+
+	TAILQ_INSERT_TAIL(&g_replay_files, file, link);
+	return file;
+}
+
+static int
+replay_file_add_io(const char *name, const struct bdevperf_replay_io *io)
+{
+	struct bdevperf_replay_file *file;
+	struct bdevperf_replay_io *ios;
+	uint64_t max_ios;
+
+	file = replay_file_get(name);
+	if (file == NULL) {
+		return -ENOMEM;
+	}
+
+	if (file->num_ios == file->max_ios) {
+		max_ios = spdk_max(file->max_ios * 2, 1024);
+		ios = realloc(file->ios, max_ios * sizeof(*ios));
+		if (ios == NULL) {
+			return -ENOMEM;
+		}
+		file->ios = ios;
+		file->max_ios = max_ios;
+	}
+
+	file->ios[file->num_ios++] = *io;
+	if (io->io_type == SPDK_BDEV_IO_TYPE_UNMAP) {
+		file->num_unmaps++;
+	}
+
+	return 0;
+}
+
+/*
+ * fio iolog, version 2: "<file> <action> [<offset> <length>]"
+ *            version 3: "<time in msec> <file> <action> [<offset> <length>]"
+ * Returns 1 if the line describes an I/O, 0 if it should be skipped.
+ */
+static int
+parse_fio_iolog_line(char **tokens, int num_tokens, int version, const char **name,
+		     struct bdevperf_replay_io *io)
+{
+	const char *action;
+	char *end;
+
+	if (version == 3) {
+		if (num_tokens < 3) {
+			return -EINVAL;
+		}
+		errno = 0;
+		io->time_in_usec = strtoull(tokens[0], &end, 10) * 1000;
+		if (errno || *end != '\0') {
+			return -EINVAL;
+		}
+		tokens++;
+		num_tokens--;
+	} else if (num_tokens < 2) {
+		return -EINVAL;
+	}
+
+	*name = tokens[0];
+	action = tokens[1];
+
+	if (!strcmp(action, "sync") || !strcmp(action, "datasync")) {
+		io->io_type = SPDK_BDEV_IO_TYPE_FLUSH;
+		io->offset = 0;
+		io->length = 0;
+		return 1;
+	} else if (!strcmp(action, "read")) {
+		io->io_type = SPDK_BDEV_IO_TYPE_READ;
+	} else if (!strcmp(action, "write")) {
+		io->io_type = SPDK_BDEV_IO_TYPE_WRITE;
+	} else if (!strcmp(action, "trim")) {
+		io->io_type = SPDK_BDEV_IO_TYPE_UNMAP;
+	} else {
+		/* add, open, close, wait */
+		return 0;
+	}
+
+	if (num_tokens < 4) {
+		return -EINVAL;
+	}
+	errno = 0;
+	io->offset = strtoull(tokens[2], &end, 10);
+	if (errno || *end != '\0') {
+		return -EINVAL;
+	}
+	io->length = strtoull(tokens[3], &end, 10);
+	if (errno || *end != '\0' || io->length == 0) {
+		return -EINVAL;
+	}
+
+	return 1;
+}
+
+/*
+ * blkparse default output:
+ * "<major,minor> <cpu> <seq> <time in sec> <pid> <action> <RWBS> <sector> + <sectors> [<process>]"
+ * Only the queue (Q) events are replayed.  Other lines, e.g. the summary printed at the end, are
+ * skipped.
+ */
+static int
+parse_blkparse_line(char **tokens, int num_tokens, const char **name,
+		    struct bdevperf_replay_io *io)
+{
+	const char *rwbs;
+	uint64_t sector = 0, num_sectors = 0;
+	double time_in_sec;
+	char *end;
+
+	if (num_tokens < 7 || strcmp(tokens[5], "Q")) {
+		return 0;
+	}
+
+	*name = tokens[0];
+	rwbs = tokens[6];
+
+	errno = 0;
+	time_in_sec = strtod(tokens[3], &end);
+	if (errno || *end != '\0' || time_in_sec < 0) {
+		return 0;
+	}
+	io->time_in_usec = (uint64_t)(time_in_sec * SPDK_SEC_TO_USEC);
+
+	if (num_tokens >= 10 && !strcmp(tokens[8], "+")) {
+		sector = strtoull(tokens[7], NULL, 10);
+		num_sectors = strtoull(tokens[9], NULL, 10);
+	}
+	io->offset = sector * 512;
+	io->length = num_sectors * 512;
+
+	if (strchr(rwbs, 'D') != NULL && num_sectors != 0) {
+		io->io_type = SPDK_BDEV_IO_TYPE_UNMAP;
+	} else if (strchr(rwbs, 'W') != NULL && num_sectors != 0) {
+		io->io_type = SPDK_BDEV_IO_TYPE_WRITE;
+	} else if (strchr(rwbs, 'R') != NULL && num_sectors != 0) {
+		io->io_type = SPDK_BDEV_IO_TYPE_READ;
+	} else if (strchr(rwbs, 'F') != NULL) {
+		io->io_type = SPDK_BDEV_IO_TYPE_FLUSH;
+		io->offset = 0;
+		io->length = 0;
+	} else {
+		return 0;
+	}
+
+	return 1;
+}
+
+#define REPLAY_MAX_TOKENS 12
+
+static int
+read_replay_log(void)
+{
+	struct bdevperf_replay_file *file;
+	struct bdevperf_replay_io io;
+	char *line = NULL, *tokens[REPLAY_MAX_TOKENS], *saveptr;
+	const char *name = NULL;
+	size_t line_size = 0;
+	uint64_t lineno = 0, start_usec = UINT64_MAX, i, num_ios = 0;
+	int version = 0, num_tokens, rc = 0, num_files = 0;
+	FILE *f;
+
+	if (g_replay_log_file_name == NULL) {
+		return 0;
+	}
+
+	f = fopen(g_replay_log_file_name, "r");
+	if (f == NULL) {
+		fprintf(stderr, "Could not open trace %s: %s\n", g_replay_log_file_name,
+			spdk_strerror(errno));
+		return 1;
+	}
+
+	while (getline(&line, &line_size, f) >= 0) {
+		lineno++;
+
+		if (lineno == 1) {
+			if (!strncmp(line, "fio version 2 iolog", strlen("fio version 2 iolog"))) {
+				version = 2;
+				continue;
+			} else if (!strncmp(line, "fio version 3 iolog", strlen("fio version 3 iolog"))) {
+				version = 3;
+				continue;
+			}
+		}
+
+		num_tokens = 0;
+		for (tokens[0] = strtok_r(line, " \t\r\n", &saveptr);
+		     tokens[num_tokens] != NULL && num_tokens < REPLAY_MAX_TOKENS - 1;
+		     tokens[num_tokens] = strtok_r(NULL, " \t\r\n", &saveptr)) {
+			num_tokens++;
+		}
+		if (num_tokens == 0) {
+			continue;
+		}
+
+		memset(&io, 0, sizeof(io));
+		if (version != 0) {
+			rc = parse_fio_iolog_line(tokens, num_tokens, version, &name, &io);
+		} else {
+			rc = parse_blkparse_line(tokens, num_tokens, &name, &io);
+		}
+
+		if (rc < 0) {
+			fprintf(stderr, "Invalid line %" PRIu64 " in trace %s\n", lineno,
+				g_replay_log_file_name);
+			goto out;
+		} else if (rc == 0) {
+			continue;
+		}
+
+		rc = replay_file_add_io(name, &io);
+		if (rc != 0) {
+			fprintf(stderr, "Unable to allocate memory for trace\n");
+			goto out;
+		}
+
+		start_usec = spdk_min(start_usec, io.time_in_usec);
+		num_ios++;
+	}
+
+	if (num_ios == 0) {
+		fprintf(stderr, "No I/O found in trace %s\n", g_replay_log_file_name);
+		rc = -EINVAL;
+		goto out;
+	}
+
+	/* Replay the trace from its first I/O, with the devices kept in sync */
+	TAILQ_FOREACH(file, &g_replay_files, link) {
+		for (i = 0; i < file->num_ios; i++) {
+			file->ios[i].time_in_usec -= start_usec;
+		}
+		num_files++;
+	}
+
+	/* fio version 2 iologs carry no timestamps, they are replayed at queue depth */
+	g_replay_timed = version != 2 && g_replay_speedup > 0;
+
+	printf("Replaying %" PRIu64 " I/O of %d devices from %s\n", num_ios, num_files,
+	       g_replay_log_file_name);
+out:
+	free(line);
+	fclose(f);
+	return rc == 0 ? 0 : 1;
+}
+
+static void
+free_replay_log(void)
+{
+	struct bdevperf_replay_file *file, *tmp;
+
+	TAILQ_FOREACH_SAFE(file, &g_replay_files, link, tmp) {
+		TAILQ_REMOVE(&g_replay_files, file, link);
+		free(file->ios);
+		free(file->name);
+		free(file);
+	}
+}
+
 static void
 bdevperf_run(void *arg1)
 {
@@ -2817,6 +3474,26 @@ bdevperf_parse_arg(int ch, char *arg)
 		g_unique_writes = true;
 	} else if (ch == 'N') {
 		g_hide_metadata = true;
+	} else if (ch == 'I') {
+		g_replay_log_file_name = arg;
+	} else if (ch == 'K') {
+		char *endptr;
+
+		errno = 0;
+		g_replay_speedup = strtod(arg, &endptr);
+		if (errno || arg == endptr || g_replay_speedup < 0) {
+			fprintf(stderr, "Illegal speed-up value %s\n", arg);
+			return -EINVAL;
+		}
+	} else if (ch == 'a') {
+		if (!strcmp(arg, "poisson")) {
+			g_arrival_fixed = false;
+		} else if (!strcmp(arg, "fixed")) {
+			g_arrival_fixed = true;
+		} else {
+			fprintf(stderr, "Invalid arrival distribution: %s\n", arg);
+			return -EINVAL;
+		}
 	} else {
 		tmp = spdk_strtoll(arg, 10);
 		if (tmp < 0) {
@@ -2848,6 +3525,12 @@ bdevperf_parse_arg(int ch, char *arg)
 			g_summarize_performance = false;
 			g_show_performance_period_in_usec = tmp * SPDK_SEC_TO_USEC;
 			break;
+		case 'O':
+			g_arrival_rate = tmp;
+			break;
+		case 'Q':
+			g_slo_latency_usec = tmp;
+			break;
 		default:
 			return -EINVAL;
 		}
@@ -2884,12 +3567,19 @@ bdevperf_usage(void)
 	printf(" -J                        File name to open with append mode and log JSON RPC calls.\n");
 	printf(" -U                        generate unique data for each write I/O, has no effect on non-write I/O\n");
 	printf(" -N                        Enable hide_metadata option to each bdev\n");
+	printf(" -O <rate>                 open-loop mode: submit I/O at <rate> IO/s per job, independently of completions,\n");
+	printf("                           with at most <depth> I/O outstanding. Latency is measured from the time each I/O was due.\n");
+	printf(" -a <distribution>         arrival distribution for -O, must be one of (poisson, fixed). Default: poisson\n");
+	printf(" -Q <latency>              latency SLO in microseconds, report the percentage of I/O completed within it\n");
+	printf(" -I <trace>                trace to replay with replay workload, in fio iolog or blkparse text format\n");
+	printf(" -K <speed-up>             speed-up of trace replay, 0 ignores the timestamps and replays at queue depth. Default: 1.0\n");
 }
 
 static void
 bdevperf_fini(void)
 {
 	free_job_config();
+	free_replay_log();
 	free(g_workload_type);
 
 	if (g_rpc_log_file != NULL) {
@@ -2904,7 +3594,9 @@ verify_test_params(void)
 	if (!g_bdevperf_conf_file && g_queue_depth <= 0) {
 		goto out;
 	}
-	if (!g_bdevperf_conf_file && g_io_size <= 0) {
+	if (!g_bdevperf_conf_file && g_io_size <= 0 &&
+	    (g_workload_type == NULL || strcmp(g_workload_type, "replay"))) {
+		/* replay workload takes the I/O size from the trace */
 		goto out;
 	}
 	if (!g_bdevperf_conf_file && !g_workload_type) {
@@ -2968,6 +3660,11 @@ verify_test_params(void)
 		}
 	}
 
+	if (!strcmp(g_workload_type, "replay") && g_replay_log_file_name == NULL) {
+		fprintf(stderr, "-I must be specified for replay workload.\n");
+		return 1;
+	}
+
 	if (!strcmp(g_workload_type, "rw") ||
 	    !strcmp(g_workload_type, "randrw")) {
 		if (g_rw_percentage < 0 || g_rw_percentage > 100) {
@@ -3007,7 +3704,7 @@ main(int argc, char **argv)
 	opts.rpc_addr = NULL;
 	opts.shutdown_cb = spdk_bdevperf_shutdown_cb;
 
-	if ((rc = spdk_app_parse_args(argc, argv, &opts, "Zzfq:o:t:w:k:CEF:J:M:P:S:T:Xlj:DUN", NULL,
+	if ((rc = spdk_app_parse_args(argc, argv, &opts, "Zzfq:o:t:w:k:CEF:I:J:K:M:O:P:Q:S:T:Xa:lj:DUN", NULL,
 				      bdevperf_parse_arg, bdevperf_usage)) !=
 	    SPDK_APP_PARSE_ARGS_SUCCESS) {
 		return rc;
@@ -3019,7 +3716,7 @@ main(int argc, char **argv)
 		opts.rpc_addr = SPDK_DEFAULT_RPC_ADDR;
 	}
 
-	if (read_job_config()) {
+	if (read_job_config() || read_replay_log()) {
 		bdevperf_fini();
 		return 1;
 	}
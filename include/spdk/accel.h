@@ -56,7 +56,8 @@ enum spdk_accel_opcode {
 	SPDK_ACCEL_OPC_DIF_GENERATE_COPY	= 14,
 	SPDK_ACCEL_OPC_DIX_GENERATE		= 15,
 	SPDK_ACCEL_OPC_DIX_VERIFY		= 16,
-	SPDK_ACCEL_OPC_LAST			= 17,
+	SPDK_ACCEL_OPC_GF_DOT_PROD		= 17,
+	SPDK_ACCEL_OPC_LAST			= 18,
 };
 
 enum spdk_accel_cipher {
@@ -385,6 +386,30 @@ int spdk_accel_get_compress_level_range(enum spdk_accel_comp_algo comp_algo,
 int spdk_accel_submit_xor(struct spdk_io_channel *ch, void *dst, void **sources, uint32_t nsrcs,
 			  uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg);
 
+/**
+ * Submit a GF(2^8) dot product request.
+ *
+ * Each destination buffer i is filled with the sum of coefs[i * nsrcs + j] * sources[j] over
+ * all sources, calculated in GF(2^8) as described in spdk/gf.h. It can be used to generate
+ * RAID-6 P and Q syndromes in a single pass and to recover up to two lost buffers.
+ *
+ * \param ch I/O channel associated with this call.
+ * \param dsts Array of destination buffers.
+ * \param ndsts Number of destination buffers, 1 or 2.
+ * \param sources Array of source buffers.
+ * \param nsrcs Number of source buffers in the array.
+ * \param coefs Coefficient matrix with ndsts rows of nsrcs coefficients. Must remain valid until
+ * the operation completes.
+ * \param nbytes Length in bytes.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_submit_gf_dot_prod(struct spdk_io_channel *ch, void **dsts, uint32_t ndsts,
+				  void **sources, uint32_t nsrcs, const uint8_t *coefs,
+				  uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg);
+
 /**
  * Build and submit a data encryption request.
  *
@@ -1142,6 +1167,19 @@ struct spdk_accel_opts {
 	uint32_t	sequence_count;
 	/** Maximum number of accel buffers per IO channel */
 	uint32_t	buf_count;
+	/**
+	 * Number of helper threads the software module executes CPU-heavy operations
+	 * (compression, encryption and DIF/DIX) on, 0 means these are executed inline.
+	 */
+	uint32_t	sw_worker_count;
+	/** Minimum size in bytes of an operation for the software module to hand it to a worker */
+	uint32_t	sw_offload_min_size;
+	/**
+	 * Maximum number of operations of a single opcode an IO channel keeps outstanding on a
+	 * hardware module.  Any operations above that are executed by the software module, if it
+	 * can execute them.  0 means no limit.
+	 */
+	uint32_t	hw_queue_depth;
 
 } __attribute__((packed));
 
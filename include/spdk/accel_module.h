@@ -95,7 +95,9 @@ struct spdk_accel_task {
 	uint8_t				op_code;
 	bool				has_aux;
 	int16_t				status;
-	uint8_t				reserved[4];
+	/* Set while the task is counted against its module's queue depth */
+	bool				module_outstanding;
+	uint8_t				reserved[3];
 	struct accel_io_channel		*accel_ch;
 	struct spdk_accel_sequence	*seq;
 	union {
@@ -152,6 +154,7 @@ struct spdk_accel_task {
 		uint32_t		*crc_dst;
 		uint32_t		*output_size;
 		uint32_t		block_size; /* for crypto op */
+		const uint8_t		*gf_coefs; /* for gf_dot_prod op */
 	};
 	uint64_t			iv; /* Initialization vector (tweak) for crypto op */
 	struct spdk_accel_task_aux_data	*aux;
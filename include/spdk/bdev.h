@@ -136,6 +136,58 @@ struct spdk_bdev_enable_histogram_opts {
 } __attribute__((packed));
 SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_enable_histogram_opts) == 9, "Incorrect size");
 
+/**
+ * Number of I/O size buckets of a bdev heatmap.  Bucket n counts the I/O of [2^n, 2^(n+1))
+ * blocks, the last bucket counts all larger I/O too.
+ */
+#define SPDK_BDEV_HEATMAP_NUM_SIZE_BUCKETS	16
+
+/**
+ * Number of latency buckets of a bdev heatmap.  Bucket 0 counts the I/O completed in less
+ * than a microsecond, bucket n counts the I/O completed in [2^(n-1), 2^n) microseconds and
+ * the last bucket counts all slower I/O too.
+ */
+#define SPDK_BDEV_HEATMAP_NUM_LATENCY_BUCKETS	24
+
+#define SPDK_BDEV_HEATMAP_DEFAULT_NUM_REGIONS	64
+#define SPDK_BDEV_HEATMAP_MAX_NUM_REGIONS	1024
+
+/** Number of counters of a heatmap with the specified number of LBA regions. */
+#define SPDK_BDEV_HEATMAP_NUM_COUNTS(num_regions) \
+	((size_t)(num_regions) * SPDK_BDEV_HEATMAP_NUM_SIZE_BUCKETS * SPDK_BDEV_HEATMAP_NUM_LATENCY_BUCKETS)
+
+/**
+ * Structure with optional enable heatmap parameters
+ */
+struct spdk_bdev_heatmap_opts {
+	/** Size of this structure in bytes */
+	size_t size;
+
+	/**
+	 * Number of LBA regions the bdev is divided into, up to SPDK_BDEV_HEATMAP_MAX_NUM_REGIONS.
+	 * Default: SPDK_BDEV_HEATMAP_DEFAULT_NUM_REGIONS.
+	 */
+	uint32_t num_regions;
+
+	/** I/O type to collect.  Default: 0, all the I/O types addressing a range of blocks. */
+	uint8_t io_type;
+} __attribute__((packed));
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_heatmap_opts) == 13, "Incorrect size");
+
+/**
+ * Number of I/O counted by LBA region of the first block, I/O size and latency.
+ */
+struct spdk_bdev_heatmap {
+	/** Number of LBA regions */
+	uint32_t num_regions;
+
+	/** Number of blocks in each LBA region.  The last region may be shorter. */
+	uint64_t region_size;
+
+	/** Counters, use spdk_bdev_heatmap_get_index() to locate one. */
+	uint64_t count[];
+};
+
 /** bdev QoS rate limit type */
 enum spdk_bdev_qos_rate_limit_type {
 	/** IOPS rate limit for both read and write */
@@ -215,8 +267,40 @@ struct spdk_bdev_opts {
 	/* Size of the per-thread iobuf caches */
 	uint32_t iobuf_small_cache_size;
 	uint32_t iobuf_large_cache_size;
+
+	/**
+	 * Maximum number of child requests a split copy keeps outstanding at a time.  This
+	 * also sets how many chunks are read and written in parallel when the copy is emulated
+	 * for bdevs without native copy support.
+	 */
+	uint32_t copy_queue_depth;
+
+	/**
+	 * Record the bdev tracepoints of only one in this many I/Os submitted on a channel.
+	 * Bdev modules honor the same selection through spdk_bdev_io_trace_sampled().
+	 * 0 and 1 trace every I/O.
+	 */
+	uint32_t trace_sample_rate;
+
+	/**
+	 * Number of spdk_bdev_io in a second pool, sized for bdev modules whose I/O context
+	 * fits in bdev_io_small_ctx_size bytes. The bdevs of such modules allocate their I/Os
+	 * from this pool instead of the main one, whose spdk_bdev_io are sized for the largest
+	 * context of all modules. 0 disables the small pool.
+	 */
+	uint32_t bdev_io_small_pool_size;
+
+	/** Maximum I/O context size, in bytes, of the modules using the small spdk_bdev_io pool. */
+	uint32_t bdev_io_small_ctx_size;
+
+	/**
+	 * Data copies to and from bounce buffers of at least this many bytes are submitted to
+	 * the accel framework and complete asynchronously, so they can be offloaded to a DMA
+	 * engine (e.g. IOAT or DSA) instead of being done by the CPU. 0 always uses the CPU.
+	 */
+	uint32_t bounce_accel_copy_threshold;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_opts) == 32, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_opts) == 52, "Incorrect size");
 
 /**
  * Union for controller attributes field, to list whether bdev supports fdp etc.
@@ -270,6 +354,21 @@ SPDK_STATIC_ASSERT(sizeof(union spdk_bdev_nvme_cdw13) == 4, "Incorrect size");
 /**
  * Structure with optional IO request parameters
  */
+/**
+ * Priority hint of an I/O.
+ *
+ * The bdev layer serves the queued I/O of higher priority first, and bdev modules may
+ * use the hint to schedule the I/O they submit to the device.
+ */
+enum spdk_bdev_io_priority {
+	/** Default priority */
+	SPDK_BDEV_IO_PRIORITY_DEFAULT = 0,
+	/** Latency-critical I/O, served ahead of the I/O of default priority */
+	SPDK_BDEV_IO_PRIORITY_HIGH,
+	/** Background I/O, e.g. a rebuild, served behind the I/O of default priority */
+	SPDK_BDEV_IO_PRIORITY_LOW,
+};
+
 struct spdk_bdev_ext_io_opts {
 	/** Size of this structure in bytes */
 	size_t size;
@@ -297,8 +396,10 @@ struct spdk_bdev_ext_io_opts {
 	union spdk_bdev_nvme_cdw12 nvme_cdw12;
 	/** defined by \ref spdk_bdev_nvme_cdw13 */
 	union spdk_bdev_nvme_cdw13 nvme_cdw13;
+	/** Priority of the I/O, defined by \ref spdk_bdev_io_priority */
+	uint8_t priority;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_ext_io_opts) == 52, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_ext_io_opts) == 53, "Incorrect size");
 
 /**
  * Get the options for the bdev module.
@@ -836,6 +937,50 @@ void spdk_bdev_get_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits);
 void spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 				   void (*cb_fn)(void *cb_arg, int status), void *cb_arg);
 
+/**
+ * Set the quality of service class of a bdev descriptor.
+ *
+ * Once any descriptor of a bdev is classified, the QoS rate limits of the bdev are
+ * shared between its descriptors instead of being served first come, first served.
+ * Each descriptor that submitted I/O recently gets a share of the limits proportional
+ * to its weight, raised to its minimum and capped at its maximum, and unclassified
+ * descriptors get the default weight of 1.  The sharing is work-conserving: once a
+ * descriptor used up its share, it may use the part of the limits that is not
+ * reserved for the shares of the other descriptors.  The maximum limits are enforced
+ * even if no rate limit is set on that type for the bdev, but the classes only take
+ * effect while QoS is enabled on the bdev by spdk_bdev_set_qos_rate_limits().
+ *
+ * \param desc Block device descriptor.
+ * \param weight Relative weight of the descriptor.  If 0 and no limits are given, the
+ * descriptor is unclassified.
+ * \param min_limits Guaranteed rates, ordered based on the @ref spdk_bdev_qos_rate_limit_type
+ * enum, in the same units as spdk_bdev_set_qos_rate_limits(), 0 if not set.  May be NULL.
+ * \param max_limits Maximum rates, ordered and interpreted as min_limits.  May be NULL.
+ *
+ * \return 0 on success, -EINVAL if a limit is invalid or a minimum exceeds its maximum.
+ */
+int spdk_bdev_desc_set_qos_class(struct spdk_bdev_desc *desc, uint32_t weight,
+				 const uint64_t *min_limits, const uint64_t *max_limits);
+
+/**
+ * Set the I/O coalescing window of a bdev.
+ *
+ * When enabled, each channel of the bdev holds the reads and writes submitted to it
+ * for up to window_us microseconds, and merges the ones that are contiguous and of
+ * the same type into a single I/O submitted to the bdev module.  The merged I/O is
+ * bounded by max_size_kb and by the bdev's own limits on I/O size, number of segments
+ * and optimal I/O boundary.  I/Os with metadata, a memory domain or an accel sequence,
+ * and I/Os of bdevs with QoS rate limits are not coalesced.
+ *
+ * \param bdev Block device.
+ * \param window_us Maximum time an I/O is held to be merged, 0 disables coalescing.
+ * \param max_size_kb Maximum size of a merged I/O in KiB, at least two blocks.
+ * \param cb_fn Callback function to be called when all the channels were updated.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void spdk_bdev_set_coalescing(struct spdk_bdev *bdev, uint64_t window_us, uint32_t max_size_kb,
+			      void (*cb_fn)(void *cb_arg, int status), void *cb_arg);
+
 /**
  * Get minimum I/O buffer address alignment for a bdev.
  *
@@ -2318,6 +2463,57 @@ void spdk_bdev_histogram_get(struct spdk_bdev *bdev, struct spdk_histogram_data
 void spdk_bdev_channel_get_histogram(struct spdk_io_channel *ch, spdk_bdev_histogram_data_cb cb_fn,
 				     void *cb_arg);
 
+typedef void (*spdk_bdev_heatmap_status_cb)(void *cb_arg, int status);
+typedef void (*spdk_bdev_heatmap_data_cb)(void *cb_arg, int status,
+		const struct spdk_bdev_heatmap *heatmap);
+
+/**
+ * Initialize bdev heatmap options structure.
+ *
+ * \param opts The structure to initialize.
+ * \param size The size of *opts.
+ */
+void spdk_bdev_heatmap_opts_init(struct spdk_bdev_heatmap_opts *opts, size_t size);
+
+/**
+ * Enable or disable collecting a heatmap of the I/O on a bdev.  The counters are kept
+ * by each channel and merged when the heatmap is retrieved.  Enabling the heatmap
+ * again resets it.
+ *
+ * \param bdev Block device.
+ * \param cb_fn Callback function to be called when the heatmap is enabled or disabled.
+ * \param cb_arg Argument to pass to cb_fn.
+ * \param enable Enable/disable flag
+ * \param opts Optional structure with enable heatmap options, NULL to use the defaults.
+ */
+void spdk_bdev_heatmap_enable(struct spdk_bdev *bdev, spdk_bdev_heatmap_status_cb cb_fn,
+			      void *cb_arg, bool enable, const struct spdk_bdev_heatmap_opts *opts);
+
+/**
+ * Get the heatmap of a bdev, merged from all its channels.  The heatmap passed to cb_fn
+ * is only valid during the execution of cb_fn.
+ *
+ * \param bdev Block device.
+ * \param cb_fn Callback function to be called with the heatmap.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void spdk_bdev_heatmap_get(struct spdk_bdev *bdev, spdk_bdev_heatmap_data_cb cb_fn, void *cb_arg);
+
+/**
+ * Get the index of a counter of a heatmap.
+ *
+ * \param region LBA region.
+ * \param size_bucket I/O size bucket.
+ * \param latency_bucket Latency bucket.
+ * \return index of the counter in spdk_bdev_heatmap.count.
+ */
+static inline size_t
+spdk_bdev_heatmap_get_index(uint32_t region, uint32_t size_bucket, uint32_t latency_bucket)
+{
+	return ((size_t)region * SPDK_BDEV_HEATMAP_NUM_SIZE_BUCKETS + size_bucket) *
+	       SPDK_BDEV_HEATMAP_NUM_LATENCY_BUCKETS + latency_bucket;
+}
+
 /**
  * Retrieves media events.  Can only be called from the context of
  * SPDK_BDEV_EVENT_MEDIA_MANAGEMENT event callback.  These events are sent by
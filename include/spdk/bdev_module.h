@@ -373,6 +373,16 @@ struct spdk_bdev_fn_table {
 
 	/** Check if bdev can handle spdk_accel_sequence to handle I/O of specific type. */
 	bool (*accel_sequence_supported)(void *ctx, enum spdk_bdev_io_type type);
+
+	/**
+	 * Get the number of I/Os that can be outstanding on the given I/O channel before the
+	 * module runs out of resources. Optional - may be NULL, 0 means no limit.
+	 *
+	 * The bdev layer queues I/Os over that limit itself and submits them once earlier I/Os
+	 * complete, instead of submitting them to have them completed with
+	 * SPDK_BDEV_IO_STATUS_NOMEM. The value is read once, when the channel is created.
+	 */
+	uint32_t (*get_max_outstanding_io)(struct spdk_io_channel *ch);
 };
 
 /** bdev I/O completion status */
@@ -418,7 +428,7 @@ struct spdk_bdev_module_claim {
 	TAILQ_ENTRY(spdk_bdev_module_claim) link;
 };
 
-typedef TAILQ_HEAD(, spdk_bdev_io) bdev_io_tailq_t;
+typedef TAILQ_HEAD(bdev_io_tailq, spdk_bdev_io) bdev_io_tailq_t;
 typedef STAILQ_HEAD(, spdk_bdev_io) bdev_io_stailq_t;
 typedef TAILQ_HEAD(, lba_range) lba_range_tailq_t;
 
@@ -769,6 +779,23 @@ struct spdk_bdev {
 		bool	histogram_in_progress;
 		uint8_t	histogram_io_type;
 
+		/** heatmap enabled on this bdev */
+		bool	heatmap_enabled;
+		bool	heatmap_in_progress;
+		uint8_t	heatmap_io_type;
+		uint32_t heatmap_num_regions;
+		uint64_t heatmap_region_size;
+
+		/** accumulated heatmap of previously deleted channels of this bdev */
+		struct spdk_bdev_heatmap *heatmap;
+
+		/** I/O coalescing window in microseconds, 0 if disabled */
+		uint64_t coalesce_window_us;
+
+		/** maximum size of a coalesced I/O in KiB */
+		uint32_t coalesce_max_size_kb;
+		bool	coalesce_in_progress;
+
 		/** Currently locked ranges for this bdev.  Used to populate new channels. */
 		lba_range_tailq_t locked_ranges;
 
@@ -965,9 +992,22 @@ struct spdk_bdev_io_internal_fields {
 			/** Whether we are currently inside the submit request call */
 			uint8_t in_submit_request		: 1;
 
-			uint8_t reserved			: 2;
+			/** Whether the tracepoints of this I/O are recorded */
+			uint8_t trace_sampled			: 1;
+
+			/** Whether the redirect data structure is valid */
+			uint8_t redirected			: 1;
+
+			/** Whether this I/O merges the I/Os in the coalesce data structure */
+			uint8_t coalesced			: 1;
+
+			/**
+			 * Whether the iovs were translated from the memory domain of the I/O to the
+			 * system domain, the original ones are in the bounce_buf data structure
+			 */
+			uint8_t translated			: 1;
 		};
-		uint8_t raw;
+		uint16_t raw;
 	} f;
 
 	/** Status for the IO */
@@ -976,7 +1016,10 @@ struct spdk_bdev_io_internal_fields {
 	/** Retry state (resubmit, re-pull, re-push, etc.) */
 	uint8_t retry_state;
 
-	uint8_t	reserved[5];
+	/** Status passed to spdk_bdev_io_complete_remote(), applied on the submitting thread */
+	int8_t remote_status;
+
+	uint8_t	reserved[3];
 
 	/** The bdev descriptor that was used when submitting this I/O. */
 	struct spdk_bdev_desc *desc;
@@ -1021,19 +1064,42 @@ struct spdk_bdev_io_internal_fields {
 		int aio_result;
 	} error;
 
-	struct {
-		/** stored user callback in case we split the I/O and use a temporary callback */
-		spdk_bdev_io_completion_cb stored_user_cb;
+	union {
+		struct {
+			/** stored user callback in case we split the I/O and use a temporary callback */
+			spdk_bdev_io_completion_cb stored_user_cb;
+
+			/** number of blocks remaining in a split i/o */
+			uint64_t remaining_num_blocks;
+
+			/** current offset of the split I/O in the bdev */
+			uint64_t current_offset_blocks;
+
+			/** count of outstanding batched split I/Os */
+			uint32_t outstanding;
+		} split;
+
+		/** Original submission of an I/O redirected by spdk_bdev_io_redirect() */
+		struct {
+			/** The bdev I/O channel the I/O was submitted on */
+			struct spdk_bdev_channel *ch;
+
+			/** The bdev descriptor the I/O was submitted with */
+			struct spdk_bdev_desc *desc;
 
-		/** number of blocks remaining in a split i/o */
-		uint64_t remaining_num_blocks;
+			/** offset of the I/O in the original bdev */
+			uint64_t offset_blocks;
 
-		/** current offset of the split I/O in the bdev */
-		uint64_t current_offset_blocks;
+			/** tsc at the original submission */
+			uint64_t submit_tsc;
+		} redirect;
 
-		/** count of outstanding batched split I/Os */
-		uint32_t outstanding;
-	} split;
+		/** I/Os merged into this one by the coalescing stage of the channel */
+		struct {
+			/** The merged I/Os, completed with the status of this one */
+			TAILQ_HEAD(, spdk_bdev_io) ios;
+		} coalesce;
+	};
 
 	struct {
 		/** bdev allocated memory associated with this request */
@@ -1092,7 +1158,8 @@ struct spdk_bdev_io {
 	/** Enumerated value representing the I/O type. */
 	uint8_t type;
 
-	uint8_t reserved0;
+	/** Priority of the I/O, defined by \ref spdk_bdev_io_priority. */
+	uint8_t priority;
 
 	/** Number of IO submission retries */
 	uint16_t num_retries;
@@ -1345,6 +1412,21 @@ void spdk_bdev_io_set_md_buf(struct spdk_bdev_io *bdev_io, void *md_buf, size_t
 void spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io,
 			   enum spdk_bdev_io_status status);
 
+/**
+ * Complete a bdev_io from any thread, including threads other than the one the I/O
+ * was submitted on.
+ *
+ * The completion is delivered on the thread the I/O was submitted on.  Completions
+ * targeting the same thread are chained together and delivered with a single
+ * message, which is cheaper than sending a message per I/O and completing it with
+ * spdk_bdev_io_complete().
+ *
+ * \param bdev_io I/O to complete.
+ * \param status The I/O completion status.
+ */
+void spdk_bdev_io_complete_remote(struct spdk_bdev_io *bdev_io,
+				  enum spdk_bdev_io_status status);
+
 /**
  * Complete a bdev_io with an NVMe status code and DW0 completion queue entry
  *
@@ -1385,6 +1467,31 @@ void spdk_bdev_io_complete_aio_status(struct spdk_bdev_io *bdev_io, int aio_resu
 void spdk_bdev_io_complete_base_io_status(struct spdk_bdev_io *bdev_io,
 		const struct spdk_bdev_io *base_io);
 
+/**
+ * Submit a bdev_io received by a virtual bdev to its base bdev at another offset, reusing the
+ * bdev_io instead of allocating a new one for the base bdev.
+ *
+ * The bdev_io is completed on the original bdev once the base bdev completes it, without any
+ * completion callback in the calling module. While it is on the base bdev, the I/O can't be
+ * aborted through the original bdev.
+ *
+ * Only read, write, unmap, write zeroes and flush requests without a memory domain or an accel
+ * sequence that don't need to be split for the base bdev can be redirected.
+ *
+ * \param bdev_io I/O received by the virtual bdev.
+ * \param desc Descriptor of the base bdev.
+ * \param ch I/O channel of the base bdev.
+ * \param offset_blocks Offset of the I/O in the base bdev.
+ *
+ * \return 0 on success, the bdev_io is owned by the base bdev.
+ * \return -ENOTSUP if the bdev_io can't be redirected, it's left unchanged and should be
+ * submitted to the base bdev as a new I/O.
+ * \return -EINVAL if the I/O is out of the base bdev's range.
+ * \return -EBADF if desc is not open for writing and the I/O writes data.
+ */
+int spdk_bdev_io_redirect(struct spdk_bdev_io *bdev_io, struct spdk_bdev_desc *desc,
+			  struct spdk_io_channel *ch, uint64_t offset_blocks);
+
 /**
  * Get a thread that given bdev_io was submitted on.
  *
@@ -1468,6 +1575,22 @@ spdk_bdev_io_from_ctx(void *ctx)
 	return SPDK_CONTAINEROF(ctx, struct spdk_bdev_io, driver_ctx);
 }
 
+/**
+ * Check whether the tracepoints of an I/O should be recorded.
+ *
+ * When the trace_sample_rate bdev option is set, only one in that many I/Os is traced.
+ * Bdev modules should check this before recording tracepoints related to the I/O, so
+ * that a sampled I/O can be followed through all of the layers.
+ *
+ * \param bdev_io I/O
+ * \return true if the tracepoints of the I/O should be recorded.
+ */
+static inline bool
+spdk_bdev_io_trace_sampled(const struct spdk_bdev_io *bdev_io)
+{
+	return bdev_io->internal.f.trace_sampled;
+}
+
 struct spdk_bdev_part_base;
 
 /**
@@ -1535,6 +1658,9 @@ struct spdk_bdev_part {
 
 		/* number of blocks from the start of the base bdev to the start of this part */
 		uint64_t			offset_blocks;
+
+		/* Whether I/Os are redirected to the base bdev instead of resubmitted */
+		bool				redirect_io;
 	} internal;
 };
 
@@ -1605,9 +1731,18 @@ struct spdk_bdev_part_construct_opts {
 	uint64_t opts_size;
 	/** UUID of the bdev */
 	struct spdk_uuid uuid;
+
+	/**
+	 * Remap the I/Os that allow it in place and submit them to the base bdev with
+	 * spdk_bdev_io_redirect(), instead of submitting a new I/O to the base bdev for
+	 * each of them. Such I/Os can't be aborted through the part bdev.
+	 */
+	bool redirect_io;
+
+	uint8_t reserved[7];
 };
 
-SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_part_construct_opts) == 24, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_part_construct_opts) == 32, "Incorrect size");
 
 /**
  * Initialize options that will be passed to spdk_bdev_part_construct_ext().
@@ -127,6 +127,20 @@ uint32_t spdk_bit_array_find_first_set(const struct spdk_bit_array *ba, uint32_t
  */
 uint32_t spdk_bit_array_find_first_clear(const struct spdk_bit_array *ba, uint32_t start_bit_index);
 
+/**
+ * Find the index of the first run of num_bits contiguous cleared bits in the array.
+ *
+ * \param ba The bit array to search.
+ * \param start_bit_index The bit index from which to start searching (0 to start
+ * from the beginning of the array).
+ * \param num_bits Length of the run of cleared bits to find.
+ *
+ * \return the index of the first bit of the run. If no such run exists or num_bits is 0,
+ * returns UINT32_MAX.
+ */
+uint32_t spdk_bit_array_find_first_clear_run(const struct spdk_bit_array *ba,
+		uint32_t start_bit_index, uint32_t num_bits);
+
 /**
  * Count the number of set bits in the array.
  *
@@ -103,6 +103,19 @@ bool spdk_bit_pool_is_allocated(const struct spdk_bit_pool *pool, uint32_t bit_i
  */
 uint32_t spdk_bit_pool_allocate_bit(struct spdk_bit_pool *pool);
 
+/**
+ * Allocate a run of contiguous bits from the bit pool.
+ *
+ * The lowest run of num_bits free bits is allocated.
+ *
+ * \param pool Bit pool to allocate the bits from
+ * \param num_bits Number of contiguous bits to allocate
+ *
+ * \return index of the first allocated bit, UINT32_MAX if no run of num_bits free bits
+ * exists or num_bits is 0
+ */
+uint32_t spdk_bit_pool_allocate_contig_bits(struct spdk_bit_pool *pool, uint32_t num_bits);
+
 /**
  * Free a bit back to the bit pool.
  *
@@ -261,6 +261,8 @@ struct spdk_bs_dev {
 	uint64_t	blockcnt;
 	uint32_t	blocklen; /* In bytes */
 	uint32_t        phys_blocklen; /* In bytes */
+	/* Writes crossing a multiple of this are split by the device, in blocks, 0 if none */
+	uint32_t	optimal_io_boundary;
 };
 
 struct spdk_bs_type {
@@ -315,8 +317,21 @@ struct spdk_bs_opts {
 	 * Context to pass with esnap_bs_dev_create.
 	 */
 	void *esnap_ctx;
+
+	/**
+	 * Maximum number of clusters copied at once by inflate, decouple parent and
+	 * shallow copy operations.
+	 */
+	uint32_t max_cluster_copies;
+
+	/**
+	 * Maximum number of background unmaps in flight when reclaiming the clusters freed from
+	 * blobs that clear with unmap. The freed clusters are coalesced into large unmaps and only
+	 * become free once unmapped. 0 (the default) unmaps them inline instead.
+	 */
+	uint32_t reclaim_unmap_depth;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 88, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 96, "Incorrect size");
 
 /**
  * Initialize a spdk_bs_opts structure to the default blobstore option values.
@@ -1240,6 +1255,21 @@ void spdk_blob_set_esnap_bs_dev(struct spdk_blob *blob, struct spdk_bs_dev *back
  */
 struct spdk_bs_dev *spdk_blob_get_esnap_bs_dev(const struct spdk_blob *blob);
 
+/**
+ * Set the rate of copy-on-read of an esnap clone.
+ *
+ * Once enabled, the first read of a cluster that is not allocated yet allocates the cluster and
+ * copies it from the external snapshot before being served locally, so that later reads don't
+ * reach the external snapshot. Reads beyond the rate, or beyond the copies in flight on their
+ * channel, are served by the external snapshot as usual. The setting is not persisted.
+ *
+ * \param blob A blob that is an esnap clone.
+ * \param clusters_per_sec Largest number of clusters copied per second, 0 to disable.
+ *
+ * \return 0 on success, -EINVAL if the blob is not an esnap clone, -EPERM if it is read-only.
+ */
+int spdk_blob_set_esnap_copy_on_read(struct spdk_blob *blob, uint32_t clusters_per_sec);
+
 /**
  * Determine if the blob is degraded. A degraded blob cannot perform IO.
  *
@@ -731,6 +731,20 @@ bool spdk_iommu_is_enabled(void);
  */
 uint64_t spdk_vtophys(const void *buf, uint64_t *size);
 
+/**
+ * Get the physical addresses of the buffers described by an iovec array.
+ *
+ * \param iovs Array of iovecs describing the buffers.
+ * \param iovcnt Number of iovecs in the array.
+ * \param paddrs Array of at least iovcnt elements, filled with the physical address of
+ * each buffer.
+ *
+ * \return number of buffers translated.  If it's less than iovcnt, the buffer at that
+ * index couldn't be translated or isn't physically contiguous, and its physical address
+ * is set to SPDK_VTOPHYS_ERROR.
+ */
+int spdk_vtophys_iov(const struct iovec *iovs, int iovcnt, uint64_t *paddrs);
+
 struct spdk_pci_addr {
 	uint32_t			domain;
 	uint8_t				bus;
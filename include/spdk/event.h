@@ -198,8 +198,13 @@ struct spdk_app_opts {
 	 * If set, disable CPU claiming.
 	 */
 	bool disable_cpumask_locks;
+
+	/**
+	 * If set, log messages are written asynchronously, see spdk_log_enable_async().
+	 */
+	bool log_async;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_app_opts) == 253, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_app_opts) == 254, "Incorrect size");
 
 /**
  * Initialize the default value of opts
@@ -349,6 +354,17 @@ struct spdk_event *spdk_event_allocate(uint32_t lcore, spdk_event_fn fn,
  */
 void spdk_event_call(struct spdk_event *event);
 
+/**
+ * Pass the given event to the associated lcore and call the function ahead of
+ * the events passed with spdk_event_call().
+ *
+ * Priority events are meant for latency sensitive work that is rare compared
+ * to the regular events, as they can delay the regular events indefinitely.
+ *
+ * \param event Event to execute.
+ */
+void spdk_event_call_priority(struct spdk_event *event);
+
 /**
  * Enable or disable monitoring of context switches.
  *
@@ -363,6 +379,24 @@ void spdk_framework_enable_context_switch_monitor(bool enabled);
  */
 bool spdk_framework_context_switch_monitor_enabled(void);
 
+/**
+ * Set how long reactors in interrupt mode keep checking for events without blocking after
+ * being woken up, before waiting for the next interrupt again.
+ *
+ * A window lets the events arriving in a burst be handled without a wakeup each, at the cost
+ * of keeping the core busy for the window after every wakeup.
+ *
+ * \param window_us Window in microseconds, 0 to block again right away (default).
+ */
+void spdk_framework_set_interrupt_poll_window(uint64_t window_us);
+
+/**
+ * Get how long reactors in interrupt mode keep checking for events after being woken up.
+ *
+ * \return the window in microseconds.
+ */
+uint64_t spdk_framework_get_interrupt_poll_window(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -138,8 +138,29 @@ struct spdk_ftl_conf {
 	/* Enable fast shutdown path */
 	bool					fast_shutdown;
 
-	/* Hole at bytes 0x79 - 0x7f. */
-	uint8_t					reserved2[7];
+	/*
+	 * Separate frequently and rarely updated user data into different bands during
+	 * compaction, to reduce the amount of data moved by garbage collection
+	 */
+	bool					hot_cold_streams;
+
+	/*
+	 * Keep L2P pages referenced again while resident on a separate list and evict
+	 * pages used only once (e.g. by a sequential scan) first
+	 */
+	bool					l2p_scan_resistant;
+
+	/* Maximum number of NV cache chunks compacted in parallel, 0 selects the default */
+	uint8_t					nv_cache_compaction_chunks;
+
+	/*
+	 * Number of FDP placement handles of the base bdev, which the writers of user data
+	 * and relocated data are spread across. 0 disables placement handles.
+	 */
+	uint8_t					fdp_placement_handles;
+
+	/* Hole at bytes 0x7d - 0x7f. */
+	uint8_t					reserved2[3];
 
 	/*
 	 * The size of spdk_ftl_conf according to the caller of this library is used for ABI
@@ -0,0 +1,73 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+/**
+ * \file
+ * GF(2^8) arithmetic utility functions
+ *
+ * The field is generated by the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d) with the generator
+ * {02}, the same as used for RAID-6 Q parity.
+ */
+
+#ifndef SPDK_GF_H
+#define SPDK_GF_H
+
+#include "spdk/stdinc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of destination buffers of spdk_gf_dot_prod() */
+#define SPDK_GF_DOT_PROD_MAX_DESTS	2
+
+/**
+ * Multiply two elements of GF(2^8).
+ *
+ * \param a First factor.
+ * \param b Second factor.
+ * \return The product.
+ */
+uint8_t spdk_gf_mul(uint8_t a, uint8_t b);
+
+/**
+ * Get the multiplicative inverse of an element of GF(2^8).
+ *
+ * \param a Element to invert, must not be 0.
+ * \return The inverse of a, or 0 if a is 0.
+ */
+uint8_t spdk_gf_inv(uint8_t a);
+
+/**
+ * Get the n-th power of the generator {02} of GF(2^8).
+ *
+ * \param n Exponent.
+ * \return {02}^n.
+ */
+uint8_t spdk_gf_pow2(uint32_t n);
+
+/**
+ * Calculate dot products of source buffers and coefficient vectors in GF(2^8).
+ *
+ * For each destination buffer i, dests[i][b] = sum over j of coefs[i * n + j] * sources[j][b],
+ * where the sum is an XOR. With all coefficients of a row set to 1 this is an XOR of the
+ * sources; with the coefficients set to {02}^j it is the RAID-6 Q syndrome.
+ *
+ * \param dests Array of destination buffers.
+ * \param ndests Number of destination buffers, at most SPDK_GF_DOT_PROD_MAX_DESTS.
+ * \param sources Array of source buffers.
+ * \param n Number of source buffers in the array.
+ * \param coefs Coefficient matrix with ndests rows of n coefficients.
+ * \param len Length of each buffer in bytes.
+ * \return 0 on success, negative error code otherwise.
+ */
+int spdk_gf_dot_prod(void **dests, uint32_t ndests, void **sources, uint32_t n,
+		     const uint8_t *coefs, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPDK_GF_H */
@@ -118,6 +118,22 @@ void spdk_idxd_detach(struct spdk_idxd_device *idxd);
  */
 int spdk_idxd_set_config(bool kernel_mode);
 
+/**
+ * Set how operations are grouped into DSA batch descriptors.
+ *
+ * Operations submitted on a channel are accumulated in a batch that's submitted to the
+ * device with a single descriptor. The batch is submitted as soon as it holds
+ * max_batch_size descriptors (capped by the batch size supported by the work queue) or,
+ * otherwise, from spdk_idxd_process_events() once it has been open for max_latency_us.
+ *
+ * \param max_batch_size Number of descriptors after which the batch is submitted.
+ * \param max_latency_us Maximum time a batch is held before being submitted. 0 submits
+ * the batch on every call to spdk_idxd_process_events().
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_idxd_set_batch_opts(uint16_t max_batch_size, uint32_t max_latency_us);
+
 /**
  * Build and submit an idxd memory copy request.
  *
@@ -87,6 +87,22 @@ void spdk_log_close(void);
  */
 void spdk_log_enable_timestamps(bool value);
 
+/**
+ * Enable or disable asynchronous logging.
+ *
+ * When enabled, spdk_log() formats the message into a lock-free ring and returns, and a
+ * dedicated thread writes the queued messages to stderr and syslog. Messages longer than 1023
+ * characters are truncated, each call site may log at most 100 messages per second and messages
+ * finding the ring full are dropped. Suppressed and dropped messages are counted and reported.
+ * It has no effect on a log callback set with spdk_log_open(). Disabling asynchronous logging,
+ * which spdk_log_close() also does, writes all the messages still queued.
+ *
+ * \param enable true to enable asynchronous logging, false to disable it.
+ *
+ * \return 0 on success, negated errno on failure.
+ */
+int spdk_log_enable_async(bool enable);
+
 enum spdk_log_level {
 	/** All messages will be suppressed. */
 	SPDK_LOG_DISABLED = -1,
@@ -449,6 +449,20 @@ void spdk_lvol_set_external_parent(struct spdk_lvol *lvol, const void *esnap_id,
 				   uint32_t esnap_id_len,
 				   spdk_lvol_op_complete cb_fn, void *cb_arg);
 
+/**
+ * Set the rate of copy-on-read of an esnap clone lvol.
+ *
+ * Clusters read for the first time are copied from the external snapshot, up to the given
+ * number of clusters per second, so that later reads are served locally. See
+ * spdk_blob_set_esnap_copy_on_read(). The setting is not persisted.
+ *
+ * \param lvol Handle to an esnap clone lvol.
+ * \param clusters_per_sec Largest number of clusters copied per second, 0 to disable.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_lvol_set_esnap_copy_on_read(struct spdk_lvol *lvol, uint32_t clusters_per_sec);
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,7 @@ enum spdk_bdev_nvme_multipath_policy {
 enum spdk_bdev_nvme_multipath_selector {
 	BDEV_NVME_MP_SELECTOR_ROUND_ROBIN = 1,
 	BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH,
+	BDEV_NVME_MP_SELECTOR_LATENCY,
 };
 
 struct spdk_bdev_nvme_ctrlr_opts {
@@ -102,8 +103,57 @@ struct spdk_bdev_nvme_opts {
 	uint32_t dhchap_digests;
 	uint32_t dhchap_dhgroups;
 	bool rdma_umr_per_io;
+	/* Hole at bytes 121-123. */
+	uint8_t reserved121[3];
+	/*
+	 * If nonzero, active-active nvme bdevs prefer io paths whose controller is on the NUMA node
+	 * of the submitting core, and use remote paths only when every local path has at least this
+	 * many outstanding I/Os.
+	 */
+	uint32_t numa_affinity_qd_threshold;
+	/*
+	 * In interrupt mode, number of consecutive polls without completions after which a poll
+	 * group that started polling on an interrupt returns to waiting for interrupts.
+	 * 0 disables adaptive polling.
+	 */
+	uint32_t intr_adaptive_idle_polls;
+	/*
+	 * In interrupt mode, number of completion entries and time in microseconds (in 100
+	 * microsecond granularity) the PCIe controllers aggregate before raising an interrupt.
+	 * 0 leaves the controller setting unchanged.
+	 */
+	uint16_t intr_coalescing_threshold;
+	uint16_t intr_coalescing_time_us;
+	/*
+	 * Number and size of the receive buffers provided to the socket group of each NVMe/TCP
+	 * poll group. If tcp_recv_buf_count is nonzero, TCP I/O qpairs receive the stream
+	 * through these buffers instead of a receive pipe of each socket.
+	 */
+	uint32_t tcp_recv_buf_count;
+	uint32_t tcp_recv_buf_size;
+	/*
+	 * If nonzero, NVMe/TCP I/O qpairs send with zero-copy each flush of at least this many
+	 * bytes.
+	 */
+	uint32_t tcp_zcopy_threshold;
+	/*
+	 * If nonzero, NVMe/RDMA I/O qpairs copy write payloads up to this many bytes into
+	 * pre-registered buffers and send them in capsule.
+	 */
+	uint32_t rdma_inline_copy_size;
+	/*
+	 * If nonzero, the I/O qpair of each thread is connected on the first I/O submitted by
+	 * that thread, and disconnected again after no I/O was submitted on it for this many
+	 * milliseconds.
+	 */
+	uint32_t io_qpair_idle_timeout_ms;
+	/*
+	 * If nonzero, read and write I/Os larger than this many bytes are split into I/Os of
+	 * this size, so that active-active nvme bdevs spread them over all their io paths.
+	 */
+	uint32_t multipath_stripe_size;
 };
-SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_nvme_opts) == 128, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_nvme_opts) == 160, "Incorrect size");
 
 /**
  * Connect to the NVMe controller and populate namespaces as bdevs.
@@ -134,7 +184,7 @@ int spdk_bdev_nvme_create(struct spdk_nvme_transport_id *trid,
  *
  * \param name NVMe bdev name.
  * \param policy Multipath policy (active-passive or active-active).
- * \param selector Multipath selector (round_robin, queue_depth).
+ * \param selector Multipath selector (round_robin, queue_depth, latency).
  * \param rr_min_io Number of IO to route to a path before switching to another for round-robin.
  * \param cb_fn Function to be called back after completion.
  * \param cb_arg Argument passed to the callback function.
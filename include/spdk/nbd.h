@@ -10,6 +10,9 @@
 #ifndef SPDK_NBD_H_
 #define SPDK_NBD_H_
 
+#include "spdk/stdinc.h"
+#include "spdk/assert.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,12 +55,52 @@ typedef void (*spdk_nbd_start_cb)(void *cb_arg, struct spdk_nbd_disk *nbd,
 void spdk_nbd_start(const char *bdev_name, const char *nbd_path,
 		    spdk_nbd_start_cb cb_fn, void *cb_arg);
 
+/**
+ * Options of a network block device.
+ */
+struct spdk_nbd_start_opts {
+	/* Size of this structure in bytes. */
+	size_t size;
+
+	/* Number of connections between the kernel and the device. The kernel spreads the
+	 * requests over them and each one is served by its own SPDK thread, with its own bdev
+	 * I/O channel. 1 by default.
+	 */
+	uint32_t num_connections;
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nbd_start_opts) == 16, "Incorrect size");
+
+/**
+ * Initialize network block device options.
+ *
+ * \param opts Network block device options.
+ * \param opts_size Must be set to sizeof(struct spdk_nbd_start_opts).
+ */
+void spdk_nbd_start_opts_init(struct spdk_nbd_start_opts *opts, size_t opts_size);
+
+/**
+ * Start a network block device backed by the bdev, with options.
+ *
+ * \param bdev_name Name of bdev exposed as a network block device.
+ * \param nbd_path Path to the registered network block device.
+ * \param opts Options of the device, NULL for the defaults.
+ * \param cb_fn Callback to be always called.
+ * \param cb_arg Passed to cb_fn.
+ */
+void spdk_nbd_start_ext(const char *bdev_name, const char *nbd_path,
+			const struct spdk_nbd_start_opts *opts,
+			spdk_nbd_start_cb cb_fn, void *cb_arg);
+
 /**
  * Stop the running network block device safely.
  *
+ * Stopping a started device always completes asynchronously: the connections are stopped
+ * on their threads once the I/O they have in flight completes, and the device is released
+ * after the last one. The nbd pointer must not be used after this call returns 1.
+ *
  * \param nbd A pointer to the network block device to stop.
  *
- * \return 0 on success.
+ * \return 0 if nbd is NULL, 1 otherwise, the device being stopped in the background.
  */
 int spdk_nbd_stop(struct spdk_nbd_disk *nbd);
 
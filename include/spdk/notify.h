@@ -33,7 +33,7 @@ struct spdk_notify_event {
  * Callback type for event enumeration.
  *
  * \param idx Event index
- * \param event Event data
+ * \param event Event data, only valid during the callback.
  * \param ctx User context
  * \return Non zero to break iteration.
  */
@@ -70,6 +70,8 @@ void spdk_notify_foreach_type(spdk_notify_foreach_type_cb cb_fn, void *ctx);
 /**
  * Send given notification.
  *
+ * \note This function is thread safe and doesn't take any lock.
+ *
  * \param type Notification type
  * \param ctx Notification context
  *
@@ -77,10 +79,19 @@ void spdk_notify_foreach_type(spdk_notify_foreach_type_cb cb_fn, void *ctx);
  */
 uint64_t spdk_notify_send(const char *type, const char *ctx);
 
+/**
+ * Return the number of notifications sent so far, that is the index the next notification
+ * will get.
+ *
+ * \return Number of notifications sent.
+ */
+uint64_t spdk_notify_get_event_count(void);
+
 /**
  * Call cb_fn with events from given range.
  *
- * \note Whole function call is under lock so user callback should not sleep.
+ * \note This function doesn't take any lock. Events overwritten while the range is walked are
+ * skipped and the walk stops at the first event that is still being sent.
  *
  * \param start_idx First event index
  * \param cb_fn User callback function. Return non-zero to break iteration.
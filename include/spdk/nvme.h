@@ -1822,8 +1822,17 @@ struct spdk_nvme_io_qpair_opts {
 	 * New added fields should be put at the end of the struct.
 	 */
 	size_t opts_size;
+
+	/**
+	 * The number of requests to allocate for this NVMe I/O queue in a separate pool used for
+	 * the child requests of split I/O, so that splitting doesn't use up the requests needed
+	 * by new I/O. Child requests come from the io_queue_requests pool once this one is empty.
+	 *
+	 * Default is 0, i.e. child requests only come from the io_queue_requests pool.
+	 */
+	uint32_t io_queue_child_requests;
 };
-SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_io_qpair_opts) == 80, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_io_qpair_opts) == 88, "Incorrect size");
 
 /**
  * Get the default options for I/O qpair creation for a specific NVMe controller.
@@ -2179,6 +2188,35 @@ int spdk_nvme_qpair_get_fd(struct spdk_nvme_qpair *qpair,
 int32_t spdk_nvme_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 		uint32_t max_completions);
 
+/**
+ * Start a batch of submissions on an I/O queue pair.
+ *
+ * Until spdk_nvme_qpair_submit_batch_end() is called, commands submitted on the
+ * queue pair are placed on the submission queue but the transport does not notify
+ * the controller about them, e.g. the PCIe transport does not ring the submission
+ * queue doorbell. This allows the cost of the notification to be paid once for all
+ * commands of the batch.
+ *
+ * The caller must ensure that each queue pair is only used from one thread at a
+ * time.
+ *
+ * \param qpair I/O queue pair to start the batch on.
+ *
+ * \return 0 on success, -EINVAL if the queue pair is the admin queue, or -EBUSY if
+ * a batch was already started on the queue pair.
+ */
+int spdk_nvme_qpair_submit_batch_begin(struct spdk_nvme_qpair *qpair);
+
+/**
+ * End a batch of submissions started by spdk_nvme_qpair_submit_batch_begin() and
+ * notify the controller about all commands submitted within the batch.
+ *
+ * \param qpair I/O queue pair to end the batch on.
+ *
+ * \return 0 on success, or -EINVAL if no batch was started on the queue pair.
+ */
+int spdk_nvme_qpair_submit_batch_end(struct spdk_nvme_qpair *qpair);
+
 /**
  * Returns the reason the qpair is disconnected.
  *
@@ -3081,6 +3119,29 @@ typedef void (*spdk_nvme_poll_group_interrupt_cb)(struct spdk_nvme_poll_group *g
 int spdk_nvme_poll_group_set_interrupt_callback(struct spdk_nvme_poll_group *group,
 		spdk_nvme_poll_group_interrupt_cb cb_fn, void *cb_ctx);
 
+/**
+ * Enable adaptive polling of a poll group in interrupt mode.
+ *
+ * When an interrupt event of a qpair in the poll group completes any request, the poll group
+ * stops waiting for interrupts and the callback registered by
+ * spdk_nvme_poll_group_set_interrupt_callback() is executed continuously to poll it, until
+ * idle_polls consecutive polls found no completion. The poll group then waits for interrupts
+ * again. This avoids taking an interrupt per completion under load while letting an idle poll
+ * group consume no CPU.
+ *
+ * The interrupt callback must be registered before calling this function, and the callback
+ * must call spdk_nvme_poll_group_process_completions().
+ *
+ * \param group Poll group.
+ * \param idle_polls Number of consecutive polls without completions after which the poll group
+ * returns to waiting for interrupts, or 0 to disable adaptive polling.
+ *
+ * \return 0 on success, -EINVAL if no interrupt callback is registered, -ENOTSUP if interrupts
+ * are not supported, or negative errno otherwise.
+ */
+int spdk_nvme_poll_group_set_adaptive_polling(struct spdk_nvme_poll_group *group,
+		uint32_t idle_polls);
+
 /**
  * Destroy an empty poll group.
  *
@@ -4367,6 +4428,18 @@ uint16_t spdk_nvme_qpair_get_id(struct spdk_nvme_qpair *qpair);
  */
 uint32_t spdk_nvme_qpair_get_num_outstanding_reqs(struct spdk_nvme_qpair *qpair);
 
+/**
+ * Gets the number of times a request couldn't be allocated on the specified qpair because its
+ * request pool was empty.
+ *
+ * Submission functions return -ENOMEM in that case. A high count means that io_queue_requests,
+ * or io_queue_child_requests for workloads that split many I/O, is too small.
+ *
+ * \param qpair Pointer to the NVMe queue pair.
+ * \returns number of failed request allocations for the specified qpair.
+ */
+uint64_t spdk_nvme_qpair_get_num_req_alloc_failures(struct spdk_nvme_qpair *qpair);
+
 /**
  * \brief Prints (SPDK_NOTICELOG) the contents of an NVMe submission queue entry (command).
  *
@@ -4699,6 +4772,9 @@ struct spdk_nvme_transport_ops {
 
 	/* Optional callback for transports to process removal events of attached controllers. */
 	int (*ctrlr_scan_attached)(struct spdk_nvme_probe_ctx *probe_ctx);
+
+	/* Optional callback to notify the controller about commands submitted within a batch. */
+	void (*qpair_submit_batch_end)(struct spdk_nvme_qpair *qpair);
 };
 
 /**
@@ -4762,8 +4838,48 @@ struct spdk_nvme_transport_opts {
 	 * Configure UMR per IO request if supported by the system
 	 */
 	bool rdma_umr_per_io;
+
+	/* Hole at byte 23. */
+	uint8_t reserved23[1];
+
+	/**
+	 * It is used for TCP transport.
+	 *
+	 * The number of receive buffers provided to the socket group of each TCP poll group.
+	 * If nonzero, I/O queue pairs in a poll group take the received stream through
+	 * spdk_sock_recv_next() instead of copying it through a receive pipe of each socket.
+	 * It is zero, which means disabled, by default.
+	 */
+	uint32_t tcp_recv_buf_count;
+
+	/**
+	 * It is used for TCP transport.
+	 *
+	 * The size in bytes of each receive buffer, see tcp_recv_buf_count.
+	 */
+	uint32_t tcp_recv_buf_size;
+
+	/**
+	 * It is used for TCP transport.
+	 *
+	 * If nonzero, zero-copy send is enabled on the sockets of I/O queue pairs, and used for
+	 * each flush of at least this many bytes, e.g. H2C data PDUs of large writes. The sock
+	 * layer completes such a send only after the kernel has reported that it is done with
+	 * the data. It is zero, which means the sock implementation settings are used, by default.
+	 */
+	uint32_t tcp_zcopy_threshold;
+
+	/**
+	 * It is used for RDMA transport.
+	 *
+	 * If nonzero, write payloads of I/O queue pairs up to this many bytes, capped by the
+	 * in-capsule data size of the controller, are copied into buffers registered with each
+	 * request and sent in capsule, which saves the memory translation of the payload. The
+	 * buffers take this many bytes per request. It is zero, which means disabled, by default.
+	 */
+	uint32_t rdma_inline_copy_size;
 };
-SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_transport_opts) == 24, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_transport_opts) == 40, "Incorrect size");
 
 /**
  * Get the current NVMe transport options.
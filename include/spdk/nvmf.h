@@ -103,15 +103,21 @@ struct spdk_nvmf_transport_opts {
 	uint32_t acceptor_poll_rate;
 	/* Use zero-copy operations if the underlying bdev supports them */
 	bool zcopy;
+	/* Track the size of host to controller transfers of each host */
+	bool host_io_stats;
 
-	/* Hole at bytes 61-63. */
-	uint8_t reserved61[3];
+	/* Hole at bytes 62-63. */
+	uint8_t reserved62[2];
 	/* ACK timeout in milliseconds */
 	uint32_t ack_timeout;
 	/* Size of RDMA data WR pool */
 	uint32_t data_wr_pool_size;
+	/* I/O commands admitted per second from each host, 0 for no limit */
+	uint32_t host_max_iops;
+	/* I/O commands a host can submit at once above host_max_iops, 0 for a tenth of it */
+	uint32_t host_max_burst;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_nvmf_transport_opts) == 72, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvmf_transport_opts) == 80, "Incorrect size");
 
 struct spdk_nvmf_listen_opts {
 	/**
@@ -172,6 +178,8 @@ struct spdk_nvmf_poll_group_stat {
 	uint64_t pending_bdev_io;
 	/* NVMe IO commands completed (excludes admin commands) */
 	uint64_t completed_nvme_io;
+	/* NVMe IO commands rejected because their host was over host_max_iops */
+	uint64_t rejected_nvme_io;
 };
 
 /**
@@ -220,6 +220,10 @@ struct spdk_nvmf_poll_group {
 	/* Statistics */
 	struct spdk_nvmf_poll_group_stat		stat;
 
+	/* Controllers whose keep alive timer is checked by this poll group, by deadline */
+	TAILQ_HEAD(spdk_nvmf_keep_alive_ctrlrs, spdk_nvmf_ctrlr)	keep_alive_ctrlrs;
+	struct spdk_poller				*keep_alive_poller;
+
 	spdk_nvmf_poll_group_destroy_done_fn		destroy_cb_fn;
 	void						*destroy_cb_arg;
 
@@ -273,6 +277,12 @@ struct spdk_nvmf_transport {
 	TAILQ_ENTRY(spdk_nvmf_transport)	link;
 
 	pthread_mutex_t				mutex;
+
+	/* Protected by mutex, only used if opts.host_io_stats is set */
+	TAILQ_HEAD(, nvmf_transport_host_stats)	host_stats;
+
+	/* Protected by mutex, only used if opts.host_max_iops is set */
+	TAILQ_HEAD(, nvmf_transport_host_admission)	host_admission;
 };
 
 typedef void (*spdk_nvmf_transport_qpair_fini_cb)(void *cb_arg);
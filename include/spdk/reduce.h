@@ -79,7 +79,16 @@ struct spdk_reduce_vol_params {
 	 * specified by the user
 	 */
 	uint8_t                 comp_algo;
-	uint8_t                 reserved[3];
+
+	/**
+	 * Pack the last, partially filled backing io unit of compressed chunks together,
+	 *  in units of backing device blocks, so that several chunks share a backing io
+	 *  unit.  Only has an effect when the backing io unit spans several backing
+	 *  device blocks.  Volumes created with this set must not be loaded by versions
+	 *  of libreduce that do not support it.
+	 */
+	uint8_t			pack_chunks;
+	uint8_t                 reserved[2];
 };
 
 struct spdk_reduce_vol;
@@ -295,6 +304,22 @@ const char *spdk_reduce_vol_get_pm_path(const struct spdk_reduce_vol *vol);
  */
 const struct spdk_reduce_vol_info *spdk_reduce_vol_get_info(const struct spdk_reduce_vol *vol);
 
+/**
+ * Set the size of the read cache of a libreduce compressed volume.
+ *
+ * The read cache keeps the most recently read chunks decompressed, so that later reads of
+ * the same chunks are served without reading and decompressing them again.  Writes and
+ * unmaps invalidate the cached copy of their chunk.  The cache is empty after this call.
+ *
+ * This function must be called from the thread doing the I/O to the volume.
+ *
+ * \param vol Previously loaded or initialized compressed volume.
+ * \param cache_size Size of the cache in bytes, rounded down to a multiple of the chunk size.
+ * 0 disables the cache, which is the default.
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_reduce_vol_set_read_cache_size(struct spdk_reduce_vol *vol, uint64_t cache_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -92,6 +92,16 @@ struct spdk_governor {
 	 */
 	int (*set_core_freq_min)(uint32_t lcore_id);
 
+	/**
+	 * Set core frequency to one of the available frequencies.
+	 *
+	 * \param lcore_id Core number.
+	 * \param freq Frequency, one of those returned by get_core_avail_freqs.
+	 *
+	 * \return 1 on success, 0 already at this frequency, negative on error.
+	 */
+	int (*set_core_freq)(uint32_t lcore_id, uint32_t freq);
+
 	/**
 	 * Get capabilities of a given core.
 	 *
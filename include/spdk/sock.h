@@ -189,6 +189,15 @@ struct spdk_sock_impl_opts {
 	 * example: "TLS_AES_256_GCM_SHA384:TLS_AES_128_GCM_SHA256"
 	 */
 	const char *tls_cipher_suites;
+
+	/**
+	 * Busy poll timeout in microseconds, 0 to disable busy polling. When set, the sockets
+	 * prefer busy polling (SO_BUSY_POLL and SO_PREFER_BUSY_POLL) and each poll group busy
+	 * polls the NIC queues of its sockets when checking them for events. Unless another
+	 * placement mode is set, sockets are grouped by their NAPI ID, so that each poll group
+	 * owns a set of NIC queues. Used by posix socket module.
+	 */
+	uint32_t busy_poll_usecs;
 };
 
 /**
@@ -215,6 +215,50 @@ int spdk_thread_lib_init_ext(spdk_thread_op_fn thread_op_fn,
  */
 void spdk_thread_lib_fini(void);
 
+/**
+ * Options of the per-thread arena the pollers and I/O channels of a thread are
+ * allocated from.
+ */
+struct spdk_thread_arena_opts {
+	/**
+	 * The size of spdk_thread_arena_opts according to the caller of this library is used for
+	 * ABI compatibility.  The library uses this field to know how many fields in this
+	 * structure are valid. And the library will populate any remaining fields with default values.
+	 * New added fields should be put at the end of the struct.
+	 */
+	size_t opts_size;
+
+	/**
+	 * Size of the memory chunks the objects are carved from. 0 disables the arena
+	 * and every object is allocated separately. Default is 0.
+	 */
+	uint32_t chunk_size;
+
+	/**
+	 * Allocate the chunks from hugepage memory, local to the NUMA node the thread
+	 * runs on. Default is false.
+	 */
+	bool hugepages;
+} __attribute__((packed));
+SPDK_STATIC_ASSERT(sizeof(struct spdk_thread_arena_opts) == 13, "Incorrect size");
+
+/**
+ * Set the options of the per-thread arenas. Only the threads created afterwards use them.
+ *
+ * \param opts Options to set.
+ *
+ * \return 0 on success, -EINVAL if the options are invalid.
+ */
+int spdk_thread_arena_set_opts(const struct spdk_thread_arena_opts *opts);
+
+/**
+ * Get the options of the per-thread arenas.
+ *
+ * \param opts Output parameter for options.
+ * \param opts_size sizeof(*opts)
+ */
+void spdk_thread_arena_get_opts(struct spdk_thread_arena_opts *opts, size_t opts_size);
+
 /**
  * Creates a new SPDK thread object.
  *
@@ -781,6 +825,25 @@ struct spdk_thread *spdk_io_channel_get_thread(struct spdk_io_channel *ch);
 void spdk_for_each_channel(void *io_device, spdk_channel_msg fn, void *ctx,
 			   spdk_channel_for_each_cpl cpl);
 
+/**
+ * Call 'fn' on each channel associated with io_device, on all the channels at once.
+ *
+ * Same as spdk_for_each_channel(), except that the message is sent to the threads of all the
+ * channels at once, so calls to 'fn' on different threads may overlap in time and happen in
+ * any order. Use it when 'fn' doesn't depend on the other channels. 'fn' must call
+ * spdk_for_each_channel_continue() once done with its channel. A non 0 status doesn't stop
+ * the calls on the other channels, the first one is passed to 'cpl'.
+ *
+ * \param io_device 'fn' will be called on each channel associated with this io_device.
+ * \param fn Called on the appropriate thread for each channel associated with io_device.
+ * \param ctx Context buffer registered to spdk_io_channel_iter that can be obtained
+ * form the function spdk_io_channel_iter_get_ctx().
+ * \param cpl Called on the thread that spdk_for_each_channel_parallel was initially called
+ * from when 'fn' has been called on each channel and each call has been continued.
+ */
+void spdk_for_each_channel_parallel(void *io_device, spdk_channel_msg fn, void *ctx,
+				    spdk_channel_for_each_cpl cpl);
+
 /**
  * Get io_device from the I/O channel iterator.
  *
@@ -1068,6 +1131,9 @@ void spdk_spin_unlock(struct spdk_spinlock *sspin);
  */
 bool spdk_spin_held(struct spdk_spinlock *sspin);
 
+/** Maximum number of buffer size classes between the small and the large buffers */
+#define SPDK_IOBUF_MAX_CLASSES	4
+
 struct spdk_iobuf_opts {
 	/** Maximum number of small buffers */
 	uint64_t small_pool_count;
@@ -1088,6 +1154,26 @@ struct spdk_iobuf_opts {
 
 	/** Enable per-NUMA node buffer pools */
 	uint8_t	enable_numa;
+
+	/**
+	 * Number of additional buffer size classes.  A buffer request is served by the
+	 * smallest class that fits it, so the requests larger than small_bufsize don't
+	 * have to consume a large buffer.
+	 */
+	uint8_t num_classes;
+	/**
+	 * Size of a single buffer of each additional class, in ascending order.  All of them
+	 * must be larger than small_bufsize and smaller than large_bufsize.
+	 */
+	uint32_t class_bufsize[SPDK_IOBUF_MAX_CLASSES];
+	/** Maximum number of buffers of each additional class */
+	uint64_t class_pool_count[SPDK_IOBUF_MAX_CLASSES];
+
+	/**
+	 * Let the channels that ran out of buffers take them from the caches of the other
+	 * channels on the same NUMA node instead of only waiting for buffers to be released.
+	 */
+	uint8_t	enable_steal;
 };
 
 struct spdk_iobuf_pool_stats {
@@ -1097,12 +1183,16 @@ struct spdk_iobuf_pool_stats {
 	uint64_t	main;
 	/** Buffer missed and request to get buffer was queued */
 	uint64_t	retry;
+	/** Buffer taken from the cache of another channel */
+	uint64_t	steal;
 };
 
 struct spdk_iobuf_module_stats {
 	struct spdk_iobuf_pool_stats	small_pool;
 	struct spdk_iobuf_pool_stats	large_pool;
 	const char			*module;
+	/** Statistics of the additional buffer size classes, see spdk_iobuf_opts.num_classes */
+	struct spdk_iobuf_pool_stats	class_pool[SPDK_IOBUF_MAX_CLASSES];
 };
 
 struct spdk_iobuf_entry;
@@ -1120,6 +1210,24 @@ struct spdk_iobuf_buffer {
 	STAILQ_ENTRY(spdk_iobuf_buffer)	stailq;
 };
 
+struct spdk_iobuf_iov_entry;
+
+typedef void (*spdk_iobuf_get_iov_cb)(struct spdk_iobuf_iov_entry *entry, struct iovec *iovs,
+				      int iovcnt);
+
+/** iobuf scatter-gather request, see `spdk_iobuf_get_iov()` */
+struct spdk_iobuf_iov_entry {
+	/** Wait queue entry of the buffer currently waited for */
+	struct spdk_iobuf_entry		iobuf;
+	struct spdk_iobuf_channel	*ch;
+	/** Buffers gathered so far */
+	struct iovec			*iovs;
+	int				iovcnt;
+	/** Number of bytes left to gather */
+	uint64_t			len;
+	spdk_iobuf_get_iov_cb		cb_fn;
+};
+
 typedef STAILQ_HEAD(, spdk_iobuf_entry) spdk_iobuf_entry_stailq_t;
 typedef STAILQ_HEAD(, spdk_iobuf_buffer) spdk_iobuf_buffer_stailq_t;
 
@@ -1145,6 +1253,8 @@ struct spdk_iobuf_node_cache {
 	struct spdk_iobuf_pool_cache	small;
 	/** Large buffer memory pool cache */
 	struct spdk_iobuf_pool_cache	large;
+	/** Memory pool caches of the additional buffer size classes */
+	struct spdk_iobuf_pool_cache	classes[SPDK_IOBUF_MAX_CLASSES];
 };
 
 #ifndef SPDK_CONFIG_MAX_NUMA_NODES
@@ -1223,7 +1333,8 @@ int spdk_iobuf_unregister_module(const char *name);
  * \param ch iobuf channel to initialize.
  * \param name Name of the module registered via `spdk_iobuf_register_module()`.
  * \param small_cache_size Number of small buffers to be cached by this channel.
- * \param large_cache_size Number of large buffers to be cached by this channel.
+ * \param large_cache_size Number of large buffers to be cached by this channel.  The channel
+ * caches as many buffers of each additional size class too.
  *
  * \return 0 on success, negative errno otherwise.
  */
@@ -1290,6 +1401,62 @@ void *spdk_iobuf_get(struct spdk_iobuf_channel *ch, uint64_t len, struct spdk_io
  */
 void spdk_iobuf_put(struct spdk_iobuf_channel *ch, void *buf, uint64_t len);
 
+/**
+ * Get a set of buffers from the iobuf pool, covering len bytes in total.  This allows requests
+ * larger than large_bufsize to be served without splitting them.  Each buffer but the last one is
+ * a large buffer, the last one is the smallest buffer that fits the remaining bytes.
+ *
+ * If not all of the buffers are available and entry with cb_fn is provided, the buffers acquired
+ * so far are kept and the request is queued until the remaining ones become available.
+ *
+ * \param ch iobuf channel.
+ * \param len Total length of the buffers to retrieve.
+ * \param iovs Array of iovecs to be filled with the buffers.
+ * \param iovcnt Size of the iovs array.  It must be at least len divided by large_bufsize,
+ *               rounded up.
+ * \param entry Wait queue entry (optional).
+ * \param cb_fn Callback to be executed once all of the buffers are available.  If they are
+ *              available immediately, it is NOT executed.  Mandatory only if entry provided.
+ *
+ * \return number of iovecs filled if all of the buffers were available, 0 if the request was
+ * queued, -EINVAL if iovcnt is too small, -ENOMEM if the buffers are not available and the
+ * request wasn't queued.
+ */
+int spdk_iobuf_get_iov(struct spdk_iobuf_channel *ch, uint64_t len, struct iovec *iovs, int iovcnt,
+		       struct spdk_iobuf_iov_entry *entry, spdk_iobuf_get_iov_cb cb_fn);
+
+/**
+ * Release a set of buffers acquired through `spdk_iobuf_get_iov()` back to the iobuf pool.
+ *
+ * \param ch iobuf channel.
+ * \param iovs Array of iovecs describing the buffers, as filled by `spdk_iobuf_get_iov()`.
+ * \param iovcnt Number of iovecs.
+ */
+void spdk_iobuf_put_iov(struct spdk_iobuf_channel *ch, struct iovec *iovs, int iovcnt);
+
+/**
+ * Abort an outstanding scatter-gather request.  The buffers gathered so far are released back to
+ * the iobuf pool.
+ *
+ * \param entry Entry of the request queued by `spdk_iobuf_get_iov()`.
+ */
+void spdk_iobuf_iov_entry_abort(struct spdk_iobuf_iov_entry *entry);
+
+/**
+ * Get the memory regions backing the iobuf pools.
+ *
+ * The buffers of each pool are carved out of a single, virtually contiguous region, so the
+ * regions can be registered up front with a device or an io_uring instance that doesn't need
+ * to pin the pages on each I/O.
+ *
+ * \param regions Array filled with the regions.  May be NULL if max_regions is 0.
+ * \param max_regions Number of entries in the `regions` array.
+ *
+ * \return total number of regions, which may be larger than max_regions, in which case only the
+ * first max_regions entries are filled.  0 if iobuf isn't initialized.
+ */
+int spdk_iobuf_get_regions(struct iovec *regions, int max_regions);
+
 typedef void (*spdk_iobuf_get_stats_cb)(struct spdk_iobuf_module_stats *modules,
 					uint32_t num_modules, void *cb_arg);
 
@@ -37,10 +37,22 @@ struct spdk_trace_parser_opts {
 	uint16_t	lcore;
 };
 
+/** Latency statistics of a tracepoint, relative to the creation of its object */
+struct spdk_trace_parser_tpoint_stats {
+	/** Number of entries with a known object */
+	uint64_t	count;
+	/** Sum of the tsc elapsed since the object was created */
+	uint64_t	total_tsc;
+	/** Lowest tsc elapsed since the object was created */
+	uint64_t	min_tsc;
+	/** Highest tsc elapsed since the object was created */
+	uint64_t	max_tsc;
+};
+
 /**
- * Initialize the parser using a specified trace file.  This results in parsing the traces, merging
- * entries from multiple cores together and sorting them by their tsc, so it can take a significant
- * amount of time to complete.
+ * Initialize the parser using a specified trace file.  This results in parsing the traces of each
+ * core (in parallel, if there are multiple cores) and sorting them by their tsc.  The entries from
+ * multiple cores are merged together as they're retrieved.
  *
  * \param opts Describes the trace file to parse.
  *
@@ -124,6 +136,20 @@ bool spdk_trace_parser_next_entry(struct spdk_trace_parser *parser,
  */
 uint64_t spdk_trace_parser_get_entry_count(const struct spdk_trace_parser *parser, uint16_t lcore);
 
+/**
+ * Return the latency statistics of a tracepoint.  Each entry of the tracepoint, whose object was
+ * created by an entry retrieved earlier, adds the tsc elapsed since that creation.  The statistics
+ * only cover the entries already retrieved via spdk_trace_parser_next_entry().
+ *
+ * \param parser Parser object to be used.
+ * \param tpoint_id Tracepoint identifier.
+ * \param stats Statistics of the tracepoint.
+ *
+ * \return 0 on success, -EINVAL if tpoint_id is invalid.
+ */
+int spdk_trace_parser_get_tpoint_stats(const struct spdk_trace_parser *parser, uint16_t tpoint_id,
+				       struct spdk_trace_parser_tpoint_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
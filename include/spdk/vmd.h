@@ -74,7 +74,8 @@ int spdk_vmd_get_led_state(struct spdk_pci_device *pci_device, enum spdk_vmd_led
 
 /**
  * Checks for hotplug/hotremove events of the devices behind the VMD.  Needs to be called
- * periodically to detect them.
+ * periodically to detect them. It doesn't block, a hot inserted device that isn't visible yet is
+ * looked for again by the following calls.
  *
  * \return number of hotplug events detected or negative errno in case of errors
  */
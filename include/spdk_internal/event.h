@@ -57,7 +57,13 @@ struct spdk_reactor {
 	uint64_t					tsc_last;
 
 	struct spdk_ring				*events;
+	/* Control events, e.g. from the scheduler, run ahead of the regular ones */
+	struct spdk_ring				*priority_events;
 	int						events_fd;
+	/* Set once events_fd was written, until the reactor checks the event queues */
+	bool						events_notified;
+	/* Number of events processed per reactor iteration, adapted to the backlog */
+	uint32_t					event_batch_size;
 
 	/* The last known rusage values */
 	struct rusage					rusage;
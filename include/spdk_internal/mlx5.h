@@ -393,6 +393,26 @@ int spdk_mlx5_qp_set_psv(struct spdk_mlx5_qp *qp, uint32_t psv_index, uint32_t c
 int spdk_mlx5_umr_configure_sig(struct spdk_mlx5_qp *qp, struct spdk_mlx5_umr_attr *umr_attr,
 				struct spdk_mlx5_umr_sig_attr *sig_attr, uint64_t wr_id, uint32_t flags);
 
+/**
+ * Configure User Memory Region obtained using \ref spdk_mlx5_mkey_pool_get_bulk with both crypto and CRC32C
+ * capabilities. The MKey must be taken from a pool created with SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO and
+ * SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE flags.
+ *
+ * A single RDMA operation which references this UMR transforms the data and calculates its CRC32C.
+ * \b crypto_attr::enc_order defines whether the signature is calculated over encrypted or plain data.
+ *
+ * \param qp Qpair to be used for UMR configuration. The same rules as in \ref spdk_mlx5_umr_configure_sig apply
+ * \param umr_attr Common UMR attributes, describe memory layout
+ * \param sig_attr Signature UMR attributes
+ * \param crypto_attr Crypto UMR attributes
+ * \param wr_id wrid which is returned in the CQE
+ * \param flags SPDK_MLX5_WQE_CTRL_CE_CQ_UPDATE to have a signaled completion; Any of SPDK_MLX5_WQE_CTRL_FENCE* or 0
+ * \return 0 on success, negated errno on failure
+ */
+int spdk_mlx5_umr_configure_sig_crypto(struct spdk_mlx5_qp *qp, struct spdk_mlx5_umr_attr *umr_attr,
+				       struct spdk_mlx5_umr_sig_attr *sig_attr,
+				       struct spdk_mlx5_umr_crypto_attr *crypto_attr, uint64_t wr_id, uint32_t flags);
+
 /**
  * Return a NULL terminated array of devices which support crypto operation on Nvidia NICs
  *
@@ -457,7 +477,8 @@ int spdk_mlx5_crypto_devs_allow(const char *const dev_names[], size_t devs_count
 
 /**
  * Creates a pool of memory keys for a given \b PD. If params::flags has SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO enabled,
- * then a device associated with PD must support crypto operations.
+ * then a device associated with PD must support crypto operations. Both SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO and
+ * SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE may be set to create MKeys for \ref spdk_mlx5_umr_configure_sig_crypto.
  *
  * Can be called several times for different PDs. Has no effect if a pool for \b PD with the same \b flags already exists
  *
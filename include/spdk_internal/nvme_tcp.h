@@ -100,6 +100,9 @@ struct nvme_tcp_pdu {
 	bool						has_hdgst;
 	bool						ddgst_enable;
 	uint32_t					data_digest_crc32;
+	/* Length of the data already covered by data_digest_crc32, when the digest is
+	 * computed while the payload is being received */
+	uint32_t					ddgst_offset;
 	uint8_t						data_digest[SPDK_NVME_TCP_DIGEST_LEN];
 
 	uint8_t						ch_valid_bytes;
@@ -201,11 +204,27 @@ nvme_tcp_pdu_calc_header_digest(struct nvme_tcp_pdu *pdu)
 	return crc32c;
 }
 
+static inline uint32_t
+nvme_tcp_pdu_pad_data_digest(struct nvme_tcp_pdu *pdu, uint32_t crc32c)
+{
+	uint32_t mod;
+
+	mod = pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT;
+	if (mod != 0) {
+		uint32_t pad_length = SPDK_NVME_TCP_DIGEST_ALIGNMENT - mod;
+		uint8_t pad[3] = {0, 0, 0};
+
+		assert(pad_length > 0);
+		assert(pad_length <= sizeof(pad));
+		crc32c = spdk_crc32c_update(pad, pad_length, crc32c);
+	}
+	return crc32c;
+}
+
 static uint32_t
 nvme_tcp_pdu_calc_data_digest(struct nvme_tcp_pdu *pdu)
 {
 	uint32_t crc32c = SPDK_CRC32C_XOR;
-	uint32_t mod;
 
 	assert(pdu->data_len != 0);
 
@@ -216,15 +235,31 @@ nvme_tcp_pdu_calc_data_digest(struct nvme_tcp_pdu *pdu)
 					      0, pdu->data_len, &crc32c, pdu->dif_ctx);
 	}
 
-	mod = pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT;
-	if (mod != 0) {
-		uint32_t pad_length = SPDK_NVME_TCP_DIGEST_ALIGNMENT - mod;
-		uint8_t pad[3] = {0, 0, 0};
+	return nvme_tcp_pdu_pad_data_digest(pdu, crc32c);
+}
 
-		assert(pad_length > 0);
-		assert(pad_length <= sizeof(pad));
-		crc32c = spdk_crc32c_update(pad, pad_length, crc32c);
+/* Update crc32c with len bytes of the PDU data, starting at offset. Padding isn't included.
+ * Not usable for PDUs with DIF. */
+static inline uint32_t
+nvme_tcp_pdu_update_data_digest(struct nvme_tcp_pdu *pdu, uint32_t offset, uint32_t len,
+				uint32_t crc32c)
+{
+	uint32_t i, iov_len;
+
+	assert(pdu->dif_ctx == NULL);
+
+	for (i = 0; i < pdu->data_iovcnt && len > 0; i++) {
+		if (offset >= pdu->data_iov[i].iov_len) {
+			offset -= pdu->data_iov[i].iov_len;
+			continue;
+		}
+
+		iov_len = spdk_min(pdu->data_iov[i].iov_len - offset, len);
+		crc32c = spdk_crc32c_update((uint8_t *)pdu->data_iov[i].iov_base + offset, iov_len, crc32c);
+		len -= iov_len;
+		offset = 0;
 	}
+
 	return crc32c;
 }
 
@@ -14,6 +14,11 @@ struct spdk_poller;
 struct spdk_poller_stats {
 	uint64_t	run_count;
 	uint64_t	busy_count;
+	/* TSC spent in the poller function, split by the value it returned. */
+	uint64_t	busy_tsc;
+	uint64_t	idle_tsc;
+	/* Longest single execution of the poller function. */
+	uint64_t	max_run_tsc;
 };
 
 struct io_device;
@@ -25,6 +30,16 @@ const char *spdk_poller_get_state_str(struct spdk_poller *poller);
 uint64_t spdk_poller_get_period_ticks(struct spdk_poller *poller);
 void spdk_poller_get_stats(struct spdk_poller *poller, struct spdk_poller_stats *stats);
 
+/*
+ * Stats generations allow reporting only the pollers that changed since a previous report.  Each
+ * report picks a new, higher generation and assigns it to every thread it visits.  Pollers that
+ * run afterwards, and changes to the set of pollers of a thread, are tagged with it.  These must
+ * be called from the thread owning the pollers.
+ */
+bool spdk_poller_stats_changed(struct spdk_poller *poller, uint64_t generation);
+void spdk_thread_set_stats_generation(struct spdk_thread *thread, uint64_t generation);
+bool spdk_thread_pollers_changed(struct spdk_thread *thread, uint64_t generation);
+
 const char *spdk_io_channel_get_io_device_name(struct spdk_io_channel *ch);
 int spdk_io_channel_get_ref_count(struct spdk_io_channel *ch);
 
@@ -32,6 +47,10 @@ const char *spdk_io_device_get_name(struct io_device *dev);
 
 struct spdk_poller *spdk_thread_get_first_active_poller(struct spdk_thread *thread);
 struct spdk_poller *spdk_thread_get_next_active_poller(struct spdk_poller *prev);
+/*
+ * The timed pollers are kept in a timer wheel, so these visit every timed poller of the thread
+ * once, but not in the order of their expiration.
+ */
 struct spdk_poller *spdk_thread_get_first_timed_poller(struct spdk_thread *thread);
 struct spdk_poller *spdk_thread_get_next_timed_poller(struct spdk_poller *prev);
 struct spdk_poller *spdk_thread_get_first_paused_poller(struct spdk_thread *thread);
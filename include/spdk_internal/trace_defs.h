@@ -103,6 +103,8 @@
 #define TRACE_RDMA_QP_DISCONNECT					SPDK_TPOINT_ID(TRACE_GROUP_NVMF_RDMA, 0x10)
 #define TRACE_RDMA_QP_DESTROY						SPDK_TPOINT_ID(TRACE_GROUP_NVMF_RDMA, 0x11)
 #define TRACE_RDMA_REQUEST_STATE_READY_TO_COMPLETE_PENDING		SPDK_TPOINT_ID(TRACE_GROUP_NVMF_RDMA, 0x12)
+#define TRACE_RDMA_REQUEST_STATE_GENERATING_DIF				SPDK_TPOINT_ID(TRACE_GROUP_NVMF_RDMA, 0x13)
+#define TRACE_RDMA_REQUEST_STATE_VERIFYING_DIF				SPDK_TPOINT_ID(TRACE_GROUP_NVMF_RDMA, 0x14)
 
 /* Thread tracepoint definitions */
 #define TRACE_THREAD_IOCH_GET		SPDK_TPOINT_ID(TRACE_GROUP_THREAD, 0x0)
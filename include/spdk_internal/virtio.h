@@ -101,6 +101,8 @@ struct virtio_dev_ops {
 struct vq_desc_extra {
 	void *cookie;
 	uint16_t ndescs;
+	/** Next free buffer id, only used by packed virtqueues. */
+	uint16_t next;
 };
 
 struct virtqueue {
@@ -120,6 +122,35 @@ struct virtqueue {
 
 	uint64_t vq_ring_mem; /**< physical address of vring */
 
+	/** Offsets of the driver (avail) and device (used) areas within the vring memory. */
+	uint32_t vq_avail_offset;
+	uint32_t vq_used_offset;
+
+	/** Set if VIRTIO_F_RING_PACKED was negotiated. */
+	bool vq_packed;
+
+	/**
+	 * Packed virtqueue state. vq_avail_idx and vq_used_cons_idx are then
+	 * ring positions rather than free running counters, and vq_desc_head_idx
+	 * is the head of the free buffer id list chained through vq_descx[].next.
+	 */
+	struct {
+		struct vring_packed_desc *desc;
+		struct vring_packed_desc_event *driver;
+		struct vring_packed_desc_event *device;
+		/** AVAIL/USED flags for descriptors made available in the current lap. */
+		uint16_t avail_flags;
+		/** avail_flags at the start of the current request, used by abort. */
+		uint16_t req_avail_flags;
+		/** Flags of the current request's head descriptor, written last. */
+		uint16_t req_head_flags;
+		/** Buffer id of the current request. */
+		uint16_t req_id;
+		/** Descriptors made available since the last notification check. */
+		uint16_t num_added;
+		bool used_wrap_counter;
+	} vq_packed_ring;
+
 	/**
 	 * Head of the free chain in the descriptor table. If
 	 * there are no free descriptors, this will be set to
@@ -18,6 +18,7 @@
 #include "spdk/json.h"
 #include "spdk/crc32.h"
 #include "spdk/util.h"
+#include "spdk/gf.h"
 #include "spdk/hexlify.h"
 #include "spdk/string.h"
 
@@ -32,6 +33,7 @@
 #define ACCEL_TASKS_PER_CHANNEL		2048
 #define ACCEL_SMALL_CACHE_SIZE		128
 #define ACCEL_LARGE_CACHE_SIZE		16
+#define ACCEL_SW_OFFLOAD_MIN_SIZE	(64 * 1024)
 /* Set MSB, so we don't return NULL pointers as buffers */
 #define ACCEL_BUFFER_BASE		((void *)(1ull << 63))
 #define ACCEL_BUFFER_OFFSET_MASK	((uintptr_t)ACCEL_BUFFER_BASE - 1)
@@ -66,12 +68,18 @@ static struct accel_module g_modules_opc[SPDK_ACCEL_OPC_LAST] = {};
 static char *g_modules_opc_override[SPDK_ACCEL_OPC_LAST] = {};
 TAILQ_HEAD(, spdk_accel_driver) g_accel_drivers = TAILQ_HEAD_INITIALIZER(g_accel_drivers);
 static struct spdk_accel_driver *g_accel_driver;
+/* Module executing operations that don't fit within hw_queue_depth */
+static struct spdk_accel_module_if *g_overflow_module;
+static bool g_overflow_opc[SPDK_ACCEL_OPC_LAST];
 static struct spdk_accel_opts g_opts = {
 	.small_cache_size = ACCEL_SMALL_CACHE_SIZE,
 	.large_cache_size = ACCEL_LARGE_CACHE_SIZE,
 	.task_count = ACCEL_TASKS_PER_CHANNEL,
 	.sequence_count = ACCEL_TASKS_PER_CHANNEL,
 	.buf_count = ACCEL_TASKS_PER_CHANNEL,
+	.sw_worker_count = 0,
+	.sw_offload_min_size = ACCEL_SW_OFFLOAD_MIN_SIZE,
+	.hw_queue_depth = 0,
 };
 static struct accel_stats g_stats;
 static struct spdk_spinlock g_stats_lock;
@@ -80,7 +88,7 @@ static const char *g_opcode_strings[SPDK_ACCEL_OPC_LAST] = {
 	"copy", "fill", "dualcast", "compare", "crc32c", "copy_crc32c",
 	"compress", "decompress", "encrypt", "decrypt", "xor",
 	"dif_verify", "dif_verify_copy", "dif_generate", "dif_generate_copy",
-	"dix_generate", "dix_verify"
+	"dix_generate", "dix_verify", "gf_dot_prod"
 };
 
 enum accel_sequence_state {
@@ -143,6 +151,10 @@ struct accel_buffer {
 
 struct accel_io_channel {
 	struct spdk_io_channel			*module_ch[SPDK_ACCEL_OPC_LAST];
+	/* Number of tasks outstanding on module_ch, only tracked if hw_queue_depth is set */
+	uint32_t				module_outstanding[SPDK_ACCEL_OPC_LAST];
+	/* Software module's channel, used once a hardware module reaches hw_queue_depth */
+	struct spdk_io_channel			*overflow_ch;
 	struct spdk_io_channel			*driver_channel;
 	void					*task_pool_base;
 	struct spdk_accel_sequence		*seq_pool_base;
@@ -295,6 +307,7 @@ _get_task(struct accel_io_channel *accel_ch, spdk_accel_completion_cb cb_fn, voi
 	accel_task->accel_ch = accel_ch;
 	accel_task->s.iovs = NULL;
 	accel_task->d.iovs = NULL;
+	accel_task->module_outstanding = false;
 
 	return accel_task;
 }
@@ -319,6 +332,12 @@ spdk_accel_task_complete(struct spdk_accel_task *accel_task, int status)
 		accel_update_task_stats(accel_ch, accel_task, failed, 1);
 	}
 
+	if (accel_task->module_outstanding) {
+		assert(accel_ch->module_outstanding[accel_task->op_code] > 0);
+		accel_ch->module_outstanding[accel_task->op_code]--;
+		accel_task->module_outstanding = false;
+	}
+
 	if (accel_task->seq) {
 		accel_sequence_task_cb(accel_task->seq, accel_task, status);
 		return;
@@ -342,6 +361,13 @@ spdk_accel_task_complete(struct spdk_accel_task *accel_task, int status)
 	cb_fn(cb_arg, status);
 }
 
+static inline bool
+accel_task_can_overflow(struct spdk_accel_task *task)
+{
+	/* The software module doesn't support memory domains */
+	return g_overflow_opc[task->op_code] && task->src_domain == NULL && task->dst_domain == NULL;
+}
+
 static inline int
 accel_submit_task(struct accel_io_channel *accel_ch, struct spdk_accel_task *task)
 {
@@ -349,9 +375,25 @@ accel_submit_task(struct accel_io_channel *accel_ch, struct spdk_accel_task *tas
 	struct spdk_accel_module_if *module = g_modules_opc[task->op_code].module;
 	int rc;
 
+	if (spdk_unlikely(accel_ch->overflow_ch != NULL) && module != g_overflow_module) {
+		if (accel_ch->module_outstanding[task->op_code] >= g_opts.hw_queue_depth &&
+		    accel_task_can_overflow(task)) {
+			/* Hardware module's queue is full, don't wait for it, use the CPU instead */
+			module_ch = accel_ch->overflow_ch;
+			module = g_overflow_module;
+		} else {
+			accel_ch->module_outstanding[task->op_code]++;
+			task->module_outstanding = true;
+		}
+	}
+
 	rc = module->submit_tasks(module_ch, task);
 	if (spdk_unlikely(rc != 0)) {
 		accel_update_task_stats(accel_ch, task, failed, 1);
+		if (task->module_outstanding) {
+			accel_ch->module_outstanding[task->op_code]--;
+			task->module_outstanding = false;
+		}
 	}
 
 	return rc;
@@ -881,6 +923,48 @@ spdk_accel_submit_xor(struct spdk_io_channel *ch, void *dst, void **sources, uin
 	return accel_submit_task(accel_ch, accel_task);
 }
 
+int
+spdk_accel_submit_gf_dot_prod(struct spdk_io_channel *ch, void **dsts, uint32_t ndsts,
+			      void **sources, uint32_t nsrcs, const uint8_t *coefs,
+			      uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
+
+	if (spdk_unlikely(ndsts == 0 || ndsts > SPDK_GF_DOT_PROD_MAX_DESTS || nsrcs == 0)) {
+		return -EINVAL;
+	}
+
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (spdk_unlikely(accel_task == NULL)) {
+		return -ENOMEM;
+	}
+
+	ACCEL_TASK_ALLOC_AUX_BUF(accel_task);
+
+	accel_task->d.iovs = &accel_task->aux->iovs[SPDK_ACCEL_AUX_IOV_DST];
+	accel_task->d2.iovs = &accel_task->aux->iovs[SPDK_ACCEL_AUX_IOV_DST2];
+	accel_task->nsrcs.srcs = sources;
+	accel_task->nsrcs.cnt = nsrcs;
+	accel_task->d.iovs[0].iov_base = dsts[0];
+	accel_task->d.iovs[0].iov_len = nbytes;
+	accel_task->d.iovcnt = 1;
+	if (ndsts > 1) {
+		accel_task->d2.iovs[0].iov_base = dsts[1];
+		accel_task->d2.iovs[0].iov_len = nbytes;
+		accel_task->d2.iovcnt = 1;
+	} else {
+		accel_task->d2.iovcnt = 0;
+	}
+	accel_task->gf_coefs = coefs;
+	accel_task->nbytes = nbytes;
+	accel_task->op_code = SPDK_ACCEL_OPC_GF_DOT_PROD;
+	accel_task->src_domain = NULL;
+	accel_task->dst_domain = NULL;
+
+	return accel_submit_task(accel_ch, accel_task);
+}
+
 int
 spdk_accel_submit_dif_verify(struct spdk_io_channel *ch,
 			     struct iovec *iovs, size_t iovcnt, uint32_t num_blocks,
@@ -2446,6 +2530,7 @@ accel_task_set_dstbuf(struct spdk_accel_task *task, struct spdk_accel_task *next
 	case SPDK_ACCEL_OPC_DECRYPT:
 	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
 	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
+	case SPDK_ACCEL_OPC_COPY_CRC32C:
 		if (task->dst_domain != next->src_domain) {
 			return false;
 		}
@@ -2489,6 +2574,50 @@ accel_task_set_dstbuf(struct spdk_accel_task *task, struct spdk_accel_task *next
 	return true;
 }
 
+static bool
+accel_sequence_can_fuse_copy_crc32c(void)
+{
+	/* Only fuse if the module doing crc32c can also do the copy as part of the same operation
+	 * and there's no driver, which plans the whole sequence on its own */
+	return g_accel_driver == NULL &&
+	       g_modules_opc[SPDK_ACCEL_OPC_COPY_CRC32C].module ==
+	       g_modules_opc[SPDK_ACCEL_OPC_CRC32C].module;
+}
+
+static bool
+accel_sequence_fuse_copy_crc32c(struct spdk_accel_task *copy, struct spdk_accel_task *crc,
+				bool crc_first)
+{
+	if (!accel_sequence_can_fuse_copy_crc32c()) {
+		return false;
+	}
+
+	/* crc32c is calculated either over copy's src (if it's executed first) or its dst */
+	if (crc_first) {
+		if (crc->src_domain != copy->src_domain ||
+		    !accel_compare_iovs(crc->s.iovs, crc->s.iovcnt, copy->s.iovs, copy->s.iovcnt)) {
+			return false;
+		}
+	} else {
+		if (crc->src_domain != copy->dst_domain ||
+		    !accel_compare_iovs(crc->s.iovs, crc->s.iovcnt, copy->d.iovs, copy->d.iovcnt)) {
+			return false;
+		}
+	}
+
+	crc->s.iovs = copy->s.iovs;
+	crc->s.iovcnt = copy->s.iovcnt;
+	crc->src_domain = copy->src_domain;
+	crc->src_domain_ctx = copy->src_domain_ctx;
+	crc->d.iovs = copy->d.iovs;
+	crc->d.iovcnt = copy->d.iovcnt;
+	crc->dst_domain = copy->dst_domain;
+	crc->dst_domain_ctx = copy->dst_domain_ctx;
+	crc->op_code = SPDK_ACCEL_OPC_COPY_CRC32C;
+
+	return true;
+}
+
 static void
 accel_sequence_merge_tasks(struct spdk_accel_sequence *seq, struct spdk_accel_task *task,
 			   struct spdk_accel_task **next_task)
@@ -2497,6 +2626,13 @@ accel_sequence_merge_tasks(struct spdk_accel_sequence *seq, struct spdk_accel_ta
 
 	switch (task->op_code) {
 	case SPDK_ACCEL_OPC_COPY:
+		/* A copy followed by crc32c of the copied data is done in a single pass */
+		if (next->op_code == SPDK_ACCEL_OPC_CRC32C) {
+			if (accel_sequence_fuse_copy_crc32c(task, next, false)) {
+				accel_sequence_complete_task(seq, task);
+			}
+			break;
+		}
 		/* We only allow changing src of operations that actually have a src, e.g. we never
 		 * do it for fill.  Theoretically, it is possible, but we'd have to be careful to
 		 * change the src of the operation after fill (which in turn could also be a fill).
@@ -2533,12 +2669,17 @@ accel_sequence_merge_tasks(struct spdk_accel_sequence *seq, struct spdk_accel_ta
 	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
 	case SPDK_ACCEL_OPC_DIX_GENERATE:
 	case SPDK_ACCEL_OPC_DIX_VERIFY:
+	case SPDK_ACCEL_OPC_COPY_CRC32C:
 		/* We can only merge tasks when one of them is a copy */
 		if (next->op_code != SPDK_ACCEL_OPC_COPY) {
 			break;
 		}
 		if (!accel_task_set_dstbuf(task, next)) {
-			break;
+			/* If the copy can't be removed, try to at least do it together with crc32c */
+			if (task->op_code != SPDK_ACCEL_OPC_CRC32C ||
+			    !accel_sequence_fuse_copy_crc32c(next, task, true)) {
+				break;
+			}
 		}
 		/* We're removing next_task from the tasks queue, so we need to update its pointer,
 		 * so that the TAILQ_FOREACH_SAFE() loop below works correctly */
@@ -3053,6 +3194,15 @@ accel_create_channel(void *io_device, void *ctx_buf)
 		}
 	}
 
+	memset(accel_ch->module_outstanding, 0, sizeof(accel_ch->module_outstanding));
+	if (g_overflow_module != NULL) {
+		accel_ch->overflow_ch = g_overflow_module->get_io_channel();
+		if (accel_ch->overflow_ch == NULL) {
+			SPDK_ERRLOG("Failed to get %s module's IO channel\n", g_overflow_module->name);
+			goto err;
+		}
+	}
+
 	rc = spdk_iobuf_channel_init(&accel_ch->iobuf, "accel", g_opts.small_cache_size,
 				     g_opts.large_cache_size);
 	if (rc != 0) {
@@ -3062,6 +3212,10 @@ accel_create_channel(void *io_device, void *ctx_buf)
 
 	return 0;
 err:
+	if (accel_ch->overflow_ch != NULL) {
+		spdk_put_io_channel(accel_ch->overflow_ch);
+		accel_ch->overflow_ch = NULL;
+	}
 	if (accel_ch->driver_channel != NULL) {
 		spdk_put_io_channel(accel_ch->driver_channel);
 	}
@@ -3109,6 +3263,11 @@ accel_destroy_channel(void *io_device, void *ctx_buf)
 		spdk_put_io_channel(accel_ch->driver_channel);
 	}
 
+	if (accel_ch->overflow_ch != NULL) {
+		spdk_put_io_channel(accel_ch->overflow_ch);
+		accel_ch->overflow_ch = NULL;
+	}
+
 	for (i = 0; i < SPDK_ACCEL_OPC_LAST; i++) {
 		assert(accel_ch->module_ch[i] != NULL);
 		spdk_put_io_channel(accel_ch->module_ch[i]);
@@ -3213,6 +3372,53 @@ accel_memory_domain_invalidate(struct spdk_memory_domain *domain, void *domain_c
 	buf->buf = NULL;
 }
 
+static bool
+accel_opc_can_overflow(enum spdk_accel_opcode opcode)
+{
+	switch (opcode) {
+	/* Crypto keys and compression algorithms are specific to the module they're executed by */
+	case SPDK_ACCEL_OPC_ENCRYPT:
+	case SPDK_ACCEL_OPC_DECRYPT:
+	case SPDK_ACCEL_OPC_COMPRESS:
+	case SPDK_ACCEL_OPC_DECOMPRESS:
+		return false;
+	default:
+		return true;
+	}
+}
+
+static void
+accel_init_overflow(void)
+{
+	struct spdk_accel_module_if *module;
+	enum spdk_accel_opcode op;
+	bool used = false;
+
+	g_overflow_module = NULL;
+	memset(g_overflow_opc, 0, sizeof(g_overflow_opc));
+	if (g_opts.hw_queue_depth == 0) {
+		return;
+	}
+
+	module = _module_find_by_name("software");
+	if (module == NULL) {
+		return;
+	}
+
+	for (op = 0; op < SPDK_ACCEL_OPC_LAST; op++) {
+		if (g_modules_opc[op].module == module) {
+			continue;
+		}
+		g_overflow_opc[op] = accel_opc_can_overflow(op) && module->supports_opcode(op);
+		used |= g_overflow_opc[op];
+	}
+
+	/* Only set up the overflow if there are any hardware modules it could help */
+	if (used) {
+		g_overflow_module = module;
+	}
+}
+
 int
 spdk_accel_initialize(void)
 {
@@ -3306,6 +3512,8 @@ spdk_accel_initialize(void)
 		accel_module_init_opcode(op);
 	}
 
+	accel_init_overflow();
+
 	rc = spdk_iobuf_register_module("accel");
 	if (rc != 0) {
 		SPDK_ERRLOG("Failed to register accel iobuf module\n");
@@ -3384,6 +3592,9 @@ accel_write_options(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "task_count", g_opts.task_count);
 	spdk_json_write_named_uint32(w, "sequence_count", g_opts.sequence_count);
 	spdk_json_write_named_uint32(w, "buf_count", g_opts.buf_count);
+	spdk_json_write_named_uint32(w, "sw_worker_count", g_opts.sw_worker_count);
+	spdk_json_write_named_uint32(w, "sw_offload_min_size", g_opts.sw_offload_min_size);
+	spdk_json_write_named_uint32(w, "hw_queue_depth", g_opts.hw_queue_depth);
 	spdk_json_write_object_end(w);
 	spdk_json_write_object_end(w);
 }
@@ -3591,6 +3802,9 @@ spdk_accel_set_opts(const struct spdk_accel_opts *opts)
 	SET_FIELD(task_count);
 	SET_FIELD(sequence_count);
 	SET_FIELD(buf_count);
+	SET_FIELD(sw_worker_count);
+	SET_FIELD(sw_offload_min_size);
+	SET_FIELD(hw_queue_depth);
 
 	g_opts.opts_size = opts->opts_size;
 
@@ -3624,12 +3838,15 @@ spdk_accel_get_opts(struct spdk_accel_opts *opts, size_t opts_size)
 	SET_FIELD(task_count);
 	SET_FIELD(sequence_count);
 	SET_FIELD(buf_count);
+	SET_FIELD(sw_worker_count);
+	SET_FIELD(sw_offload_min_size);
+	SET_FIELD(hw_queue_depth);
 
 #undef SET_FIELD
 
 	/* Do not remove this statement, you should always update this statement when you adding a new field,
 	 * and do not forget to add the SET_FIELD statement for your added field. */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_accel_opts) == 28, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_accel_opts) == 40, "Incorrect size");
 }
 
 struct accel_get_stats_ctx {
@@ -361,6 +361,9 @@ struct rpc_accel_opts {
 	uint32_t	task_count;
 	uint32_t	sequence_count;
 	uint32_t	buf_count;
+	uint32_t	sw_worker_count;
+	uint32_t	sw_offload_min_size;
+	uint32_t	hw_queue_depth;
 };
 
 static const struct spdk_json_object_decoder rpc_accel_set_options_decoders[] = {
@@ -369,6 +372,9 @@ static const struct spdk_json_object_decoder rpc_accel_set_options_decoders[] =
 	{"task_count", offsetof(struct rpc_accel_opts, task_count), spdk_json_decode_uint32, true},
 	{"sequence_count", offsetof(struct rpc_accel_opts, sequence_count), spdk_json_decode_uint32, true},
 	{"buf_count", offsetof(struct rpc_accel_opts, buf_count), spdk_json_decode_uint32, true},
+	{"sw_worker_count", offsetof(struct rpc_accel_opts, sw_worker_count), spdk_json_decode_uint32, true},
+	{"sw_offload_min_size", offsetof(struct rpc_accel_opts, sw_offload_min_size), spdk_json_decode_uint32, true},
+	{"hw_queue_depth", offsetof(struct rpc_accel_opts, hw_queue_depth), spdk_json_decode_uint32, true},
 };
 
 static void
@@ -386,6 +392,9 @@ rpc_accel_set_options(struct spdk_jsonrpc_request *request, const struct spdk_js
 	rpc_opts.task_count = opts.task_count;
 	rpc_opts.sequence_count = opts.sequence_count;
 	rpc_opts.buf_count = opts.buf_count;
+	rpc_opts.sw_worker_count = opts.sw_worker_count;
+	rpc_opts.sw_offload_min_size = opts.sw_offload_min_size;
+	rpc_opts.hw_queue_depth = opts.hw_queue_depth;
 
 	if (spdk_json_decode_object(params, rpc_accel_set_options_decoders,
 				    SPDK_COUNTOF(rpc_accel_set_options_decoders), &rpc_opts)) {
@@ -399,6 +408,9 @@ rpc_accel_set_options(struct spdk_jsonrpc_request *request, const struct spdk_js
 	opts.task_count = rpc_opts.task_count;
 	opts.sequence_count = rpc_opts.sequence_count;
 	opts.buf_count = rpc_opts.buf_count;
+	opts.sw_worker_count = rpc_opts.sw_worker_count;
+	opts.sw_offload_min_size = rpc_opts.sw_offload_min_size;
+	opts.hw_queue_depth = rpc_opts.hw_queue_depth;
 
 	rc = spdk_accel_set_opts(&opts);
 	if (rc != 0) {
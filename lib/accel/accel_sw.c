@@ -17,7 +17,9 @@
 #include "spdk/crc32.h"
 #include "spdk/util.h"
 #include "spdk/xor.h"
+#include "spdk/gf.h"
 #include "spdk/dif.h"
+#include "spdk/string.h"
 
 #ifdef SPDK_CONFIG_HAVE_LZ4
 #include <lz4.h>
@@ -66,8 +68,32 @@ struct sw_accel_io_channel {
 #endif
 	struct spdk_poller		*completion_poller;
 	STAILQ_HEAD(, spdk_accel_task)	tasks_to_complete;
+	struct spdk_thread		*thread;
+	/* Number of tasks currently executed by the worker threads */
+	uint32_t			num_offloaded;
+	uint32_t			next_worker;
 };
 
+struct sw_accel_task {
+	struct spdk_accel_task		base;
+	/* Channel the task was submitted on and that it's completed on */
+	struct sw_accel_io_channel	*sw_ch;
+	struct sw_accel_worker		*worker;
+};
+
+/* Helper thread executing CPU-heavy operations, so that they don't stall the reactors */
+struct sw_accel_worker {
+	struct spdk_thread		*thread;
+	/* Worker's own channel, providing it with separate (de)compression state */
+	struct spdk_io_channel		*ch;
+};
+
+static struct sw_accel_worker *g_sw_workers;
+static uint32_t g_sw_num_workers;
+static uint32_t g_sw_num_workers_running;
+static uint32_t g_sw_offload_min_size;
+static struct spdk_thread *g_sw_fini_thread;
+
 typedef int (*sw_accel_crypto_op)(const uint8_t *k2, const uint8_t *k1,
 				  const uint8_t *initial_tweak, const uint64_t len_bytes,
 				  const void *in, void *out);
@@ -113,6 +139,7 @@ sw_accel_supports_opcode(enum spdk_accel_opcode opc)
 	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
 	case SPDK_ACCEL_OPC_DIX_GENERATE:
 	case SPDK_ACCEL_OPC_DIX_VERIFY:
+	case SPDK_ACCEL_OPC_GF_DOT_PROD:
 		return true;
 	default:
 		return false;
@@ -615,6 +642,21 @@ _sw_accel_xor(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_t
 			    accel_task->d.iovs[0].iov_len);
 }
 
+static int
+_sw_accel_gf_dot_prod(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	void *dsts[SPDK_GF_DOT_PROD_MAX_DESTS];
+	uint32_t ndsts = 1;
+
+	dsts[0] = accel_task->d.iovs[0].iov_base;
+	if (accel_task->d2.iovcnt > 0) {
+		dsts[ndsts++] = accel_task->d2.iovs[0].iov_base;
+	}
+
+	return spdk_gf_dot_prod(dsts, ndsts, accel_task->nsrcs.srcs, accel_task->nsrcs.cnt,
+				accel_task->gf_coefs, accel_task->d.iovs[0].iov_len);
+}
+
 static int
 _sw_accel_dif_verify(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
 {
@@ -700,12 +742,156 @@ accel_comp_poll(void *arg)
 	return SPDK_POLLER_BUSY;
 }
 
+static int
+sw_accel_execute_task(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	int rc = 0;
+
+	switch (accel_task->op_code) {
+	case SPDK_ACCEL_OPC_COPY:
+		_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
+				    accel_task->s.iovs, accel_task->s.iovcnt);
+		break;
+	case SPDK_ACCEL_OPC_FILL:
+		rc = _sw_accel_fill(accel_task->d.iovs, accel_task->d.iovcnt,
+				    accel_task->fill_pattern);
+		break;
+	case SPDK_ACCEL_OPC_DUALCAST:
+		rc = _sw_accel_dualcast_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
+					     accel_task->d2.iovs, accel_task->d2.iovcnt,
+					     accel_task->s.iovs, accel_task->s.iovcnt);
+		break;
+	case SPDK_ACCEL_OPC_COMPARE:
+		rc = _sw_accel_compare(accel_task->s.iovs, accel_task->s.iovcnt,
+				       accel_task->s2.iovs, accel_task->s2.iovcnt);
+		break;
+	case SPDK_ACCEL_OPC_CRC32C:
+		_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs, accel_task->s.iovcnt, accel_task->seed);
+		break;
+	case SPDK_ACCEL_OPC_COPY_CRC32C:
+		_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
+				    accel_task->s.iovs, accel_task->s.iovcnt);
+		_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs,
+				  accel_task->s.iovcnt, accel_task->seed);
+		break;
+	case SPDK_ACCEL_OPC_COMPRESS:
+		rc = _sw_accel_compress(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DECOMPRESS:
+		rc = _sw_accel_decompress(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_XOR:
+		rc = _sw_accel_xor(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_ENCRYPT:
+		rc = _sw_accel_encrypt(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DECRYPT:
+		rc = _sw_accel_decrypt(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+		rc = _sw_accel_dif_verify(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
+		rc = _sw_accel_dif_verify_copy(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_GENERATE:
+		rc = _sw_accel_dif_generate(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+		rc = _sw_accel_dif_generate_copy(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIX_GENERATE:
+		rc = _sw_accel_dix_generate(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIX_VERIFY:
+		rc = _sw_accel_dix_verify(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_GF_DOT_PROD:
+		rc = _sw_accel_gf_dot_prod(sw_ch, accel_task);
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	return rc;
+}
+
+static bool
+sw_accel_task_should_offload(struct spdk_accel_task *accel_task)
+{
+	if (g_sw_num_workers == 0 || accel_task->nbytes < g_sw_offload_min_size) {
+		return false;
+	}
+
+	switch (accel_task->op_code) {
+	case SPDK_ACCEL_OPC_COMPRESS:
+	case SPDK_ACCEL_OPC_DECOMPRESS:
+	case SPDK_ACCEL_OPC_ENCRYPT:
+	case SPDK_ACCEL_OPC_DECRYPT:
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
+	case SPDK_ACCEL_OPC_DIF_GENERATE:
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+	case SPDK_ACCEL_OPC_DIX_GENERATE:
+	case SPDK_ACCEL_OPC_DIX_VERIFY:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void
+sw_accel_offload_done(void *ctx)
+{
+	struct sw_accel_task *task = ctx;
+	struct sw_accel_io_channel *sw_ch = task->sw_ch;
+
+	assert(sw_ch->num_offloaded > 0);
+	sw_ch->num_offloaded--;
+	_add_to_comp_list(sw_ch, &task->base, task->base.status);
+}
+
+static void
+sw_accel_offload_execute(void *ctx)
+{
+	struct sw_accel_task *task = ctx;
+	struct sw_accel_io_channel *worker_ch = spdk_io_channel_get_ctx(task->worker->ch);
+	int rc;
+
+	task->base.status = sw_accel_execute_task(worker_ch, &task->base);
+	rc = spdk_thread_send_msg(task->sw_ch->thread, sw_accel_offload_done, task);
+	if (spdk_unlikely(rc != 0)) {
+		SPDK_ERRLOG("Failed to send completion of task %p back: %s\n", task, spdk_strerror(-rc));
+		assert(0);
+	}
+}
+
+static bool
+sw_accel_offload_task(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	struct sw_accel_task *task = SPDK_CONTAINEROF(accel_task, struct sw_accel_task, base);
+
+	task->sw_ch = sw_ch;
+	task->worker = &g_sw_workers[sw_ch->next_worker];
+	if (spdk_thread_send_msg(task->worker->thread, sw_accel_offload_execute, task) != 0) {
+		/* Just execute it inline if the worker can't be reached */
+		return false;
+	}
+
+	sw_ch->next_worker = (sw_ch->next_worker + 1) % g_sw_num_workers;
+	sw_ch->num_offloaded++;
+
+	return true;
+}
+
 static int
 sw_accel_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *accel_task)
 {
 	struct sw_accel_io_channel *sw_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *tmp;
-	int rc = 0;
+	int rc;
 
 	/*
 	 * Lazily initialize our completion poller. We don't want to complete
@@ -716,74 +902,13 @@ sw_accel_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *accel_
 	}
 
 	do {
-		switch (accel_task->op_code) {
-		case SPDK_ACCEL_OPC_COPY:
-			_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
-					    accel_task->s.iovs, accel_task->s.iovcnt);
-			break;
-		case SPDK_ACCEL_OPC_FILL:
-			rc = _sw_accel_fill(accel_task->d.iovs, accel_task->d.iovcnt,
-					    accel_task->fill_pattern);
-			break;
-		case SPDK_ACCEL_OPC_DUALCAST:
-			rc = _sw_accel_dualcast_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
-						     accel_task->d2.iovs, accel_task->d2.iovcnt,
-						     accel_task->s.iovs, accel_task->s.iovcnt);
-			break;
-		case SPDK_ACCEL_OPC_COMPARE:
-			rc = _sw_accel_compare(accel_task->s.iovs, accel_task->s.iovcnt,
-					       accel_task->s2.iovs, accel_task->s2.iovcnt);
-			break;
-		case SPDK_ACCEL_OPC_CRC32C:
-			_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs, accel_task->s.iovcnt, accel_task->seed);
-			break;
-		case SPDK_ACCEL_OPC_COPY_CRC32C:
-			_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
-					    accel_task->s.iovs, accel_task->s.iovcnt);
-			_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs,
-					  accel_task->s.iovcnt, accel_task->seed);
-			break;
-		case SPDK_ACCEL_OPC_COMPRESS:
-			rc = _sw_accel_compress(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DECOMPRESS:
-			rc = _sw_accel_decompress(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_XOR:
-			rc = _sw_accel_xor(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_ENCRYPT:
-			rc = _sw_accel_encrypt(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DECRYPT:
-			rc = _sw_accel_decrypt(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIF_VERIFY:
-			rc = _sw_accel_dif_verify(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
-			rc = _sw_accel_dif_verify_copy(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIF_GENERATE:
-			rc = _sw_accel_dif_generate(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
-			rc = _sw_accel_dif_generate_copy(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIX_GENERATE:
-			rc = _sw_accel_dix_generate(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIX_VERIFY:
-			rc = _sw_accel_dix_verify(sw_ch, accel_task);
-			break;
-		default:
-			assert(false);
-			break;
-		}
-
 		tmp = STAILQ_NEXT(accel_task, link);
 
-		_add_to_comp_list(sw_ch, accel_task, rc);
+		if (!sw_accel_task_should_offload(accel_task) ||
+		    !sw_accel_offload_task(sw_ch, accel_task)) {
+			rc = sw_accel_execute_task(sw_ch, accel_task);
+			_add_to_comp_list(sw_ch, accel_task, rc);
+		}
 
 		accel_task = tmp;
 	} while (accel_task);
@@ -802,6 +927,9 @@ sw_accel_create_cb(void *io_device, void *ctx_buf)
 
 	STAILQ_INIT(&sw_ch->tasks_to_complete);
 	sw_ch->completion_poller = NULL;
+	sw_ch->thread = spdk_get_thread();
+	sw_ch->num_offloaded = 0;
+	sw_ch->next_worker = 0;
 
 #ifdef SPDK_CONFIG_HAVE_LZ4
 	sw_ch->lz4_stream = LZ4_createStream();
@@ -851,6 +979,7 @@ sw_accel_destroy_cb(void *io_device, void *ctx_buf)
 {
 	struct sw_accel_io_channel *sw_ch = ctx_buf;
 
+	assert(sw_ch->num_offloaded == 0);
 #ifdef SPDK_CONFIG_HAVE_LZ4
 	LZ4_freeStream(sw_ch->lz4_stream);
 	LZ4_freeStreamDecode(sw_ch->lz4_stream_decode);
@@ -867,23 +996,136 @@ sw_accel_get_io_channel(void)
 static size_t
 sw_accel_module_get_ctx_size(void)
 {
-	return sizeof(struct spdk_accel_task);
+	return sizeof(struct sw_accel_task);
+}
+
+static void
+sw_accel_worker_start(void *ctx)
+{
+	struct sw_accel_worker *worker = ctx;
+
+	worker->ch = spdk_get_io_channel(&g_sw_module);
+	if (worker->ch == NULL) {
+		SPDK_ERRLOG("Failed to get IO channel for worker %s\n", spdk_thread_get_name(worker->thread));
+		assert(0);
+	}
+}
+
+static void
+sw_accel_module_finish(void)
+{
+	free(g_sw_workers);
+	g_sw_workers = NULL;
+	g_sw_num_workers = 0;
+
+	spdk_io_device_unregister(&g_sw_module, NULL);
+	spdk_accel_module_finish();
+}
+
+static void
+sw_accel_worker_stopped(void *ctx)
+{
+	assert(g_sw_num_workers_running > 0);
+	if (--g_sw_num_workers_running == 0) {
+		sw_accel_module_finish();
+	}
+}
+
+static void
+sw_accel_worker_stop(void *ctx)
+{
+	struct sw_accel_worker *worker = ctx;
+
+	if (worker->ch != NULL) {
+		spdk_put_io_channel(worker->ch);
+		worker->ch = NULL;
+	}
+
+	spdk_thread_exit(worker->thread);
+	spdk_thread_send_msg(g_sw_fini_thread, sw_accel_worker_stopped, NULL);
+}
+
+static void
+sw_accel_stop_workers(void)
+{
+	uint32_t i, num_workers = g_sw_num_workers_running;
+
+	/* Stop offloading any new tasks */
+	g_sw_num_workers = 0;
+	g_sw_fini_thread = spdk_get_thread();
+	for (i = 0; i < num_workers; i++) {
+		spdk_thread_send_msg(g_sw_workers[i].thread, sw_accel_worker_stop, &g_sw_workers[i]);
+	}
+}
+
+static int
+sw_accel_start_workers(uint32_t num_workers)
+{
+	char name[32];
+	struct sw_accel_worker *worker;
+	uint32_t i;
+
+	g_sw_workers = calloc(num_workers, sizeof(*g_sw_workers));
+	if (g_sw_workers == NULL) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		worker = &g_sw_workers[i];
+		snprintf(name, sizeof(name), "accel_sw_worker%"PRIu32, i);
+		worker->thread = spdk_thread_create(name, NULL);
+		if (worker->thread == NULL) {
+			SPDK_ERRLOG("Failed to create accel sw worker thread %s\n", name);
+			break;
+		}
+
+		g_sw_num_workers_running++;
+		spdk_thread_send_msg(worker->thread, sw_accel_worker_start, worker);
+	}
+
+	if (g_sw_num_workers_running == 0) {
+		free(g_sw_workers);
+		g_sw_workers = NULL;
+		return -ENOMEM;
+	}
+
+	g_sw_num_workers = g_sw_num_workers_running;
+
+	return 0;
 }
 
 static int
 sw_accel_module_init(void)
 {
+	struct spdk_accel_opts opts;
+	int rc;
+
 	spdk_io_device_register(&g_sw_module, sw_accel_create_cb, sw_accel_destroy_cb,
 				sizeof(struct sw_accel_io_channel), "sw_accel_module");
 
+	spdk_accel_get_opts(&opts, sizeof(opts));
+	if (opts.sw_worker_count > 0) {
+		g_sw_offload_min_size = opts.sw_offload_min_size;
+		rc = sw_accel_start_workers(opts.sw_worker_count);
+		if (rc != 0) {
+			SPDK_ERRLOG("Failed to start the software module's workers\n");
+			spdk_io_device_unregister(&g_sw_module, NULL);
+			return rc;
+		}
+	}
+
 	return 0;
 }
 
 static void
 sw_accel_module_fini(void *ctxt)
 {
-	spdk_io_device_unregister(&g_sw_module, NULL);
-	spdk_accel_module_finish();
+	if (g_sw_num_workers_running > 0) {
+		sw_accel_stop_workers();
+		return;
+	}
+
+	sw_accel_module_finish();
 }
 
 static int
@@ -49,15 +49,22 @@ int __itt_init_ittlib(const char *, __itt_group_id);
 #define SPDK_BDEV_QOS_MIN_BYTES_PER_SEC		(1024 * 1024)
 #define SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC	(UINT64_MAX / (1024 * 1024))
 #define SPDK_BDEV_QOS_LIMIT_NOT_DEFINED		UINT64_MAX
+#define SPDK_BDEV_QOS_DEFAULT_WEIGHT		1
+#define SPDK_BDEV_QOS_LOCAL_QUOTA_DIVISOR	64
 #define SPDK_BDEV_IO_POLL_INTERVAL_IN_MSEC	1000
 
+/* Number of submit time buckets a channel uses to count its submitted I/O. Each bucket
+ * covers about one to two seconds, see bdev_channel_create().
+ */
+#define BDEV_TIMEOUT_BUCKETS			32
+
 /* The maximum number of children requests for a UNMAP or WRITE ZEROES command
  * when splitting into children requests at a time.
  */
 #define SPDK_BDEV_MAX_CHILDREN_UNMAP_WRITE_ZEROES_REQS (8)
 #define BDEV_RESET_CHECK_OUTSTANDING_IO_PERIOD 1000000
 
-/* The maximum number of children requests for a COPY command
+/* The default maximum number of children requests for a COPY command
  * when splitting into children requests at a time.
  */
 #define SPDK_BDEV_MAX_CHILDREN_COPY_REQS (8)
@@ -93,6 +100,9 @@ RB_GENERATE_STATIC(bdev_name_tree, spdk_bdev_name, node, bdev_name_cmp);
 struct spdk_bdev_mgr {
 	struct spdk_mempool *bdev_io_pool;
 
+	/* Pool of spdk_bdev_io for modules with a small I/O context, see bdev_io_small_pool_size */
+	struct spdk_mempool *small_bdev_io_pool;
+
 	void *zero_buffer;
 
 	TAILQ_HEAD(bdev_module_list, spdk_bdev_module) bdev_modules;
@@ -142,14 +152,40 @@ struct lba_range {
 	struct spdk_bdev_channel	*owner_ch;
 	TAILQ_ENTRY(lba_range)		tailq;
 	TAILQ_ENTRY(lba_range)		tailq_module;
+	RB_ENTRY(lba_range)		node;
 };
 
+static int
+bdev_lba_range_cmp(struct lba_range *range1, struct lba_range *range2)
+{
+	if (range1->offset != range2->offset) {
+		return range1->offset < range2->offset ? -1 : 1;
+	}
+
+	/* Ranges locked on a channel may share the same offset, so break the tie
+	 * with the address of the range object.
+	 */
+	if (range1 != range2) {
+		return (uintptr_t)range1 < (uintptr_t)range2 ? -1 : 1;
+	}
+
+	return 0;
+}
+
+RB_HEAD(bdev_lba_range_tree, lba_range);
+RB_GENERATE_STATIC(bdev_lba_range_tree, lba_range, node, bdev_lba_range_cmp);
+
 static struct spdk_bdev_opts	g_bdev_opts = {
 	.bdev_io_pool_size = SPDK_BDEV_IO_POOL_SIZE,
 	.bdev_io_cache_size = SPDK_BDEV_IO_CACHE_SIZE,
 	.bdev_auto_examine = SPDK_BDEV_AUTO_EXAMINE,
 	.iobuf_small_cache_size = BUF_SMALL_CACHE_SIZE,
 	.iobuf_large_cache_size = BUF_LARGE_CACHE_SIZE,
+	.copy_queue_depth = SPDK_BDEV_MAX_CHILDREN_COPY_REQS,
+	.trace_sample_rate = 0,
+	.bdev_io_small_pool_size = 0,
+	.bdev_io_small_ctx_size = 0,
+	.bounce_accel_copy_threshold = 0,
 };
 
 static spdk_bdev_init_cb	g_init_cb_fn = NULL;
@@ -176,6 +212,17 @@ struct spdk_bdev_qos_limit {
 	/** Maximum allowed IOs or bytes to be issued in one timeslice (e.g., 1ms). */
 	uint32_t max_per_timeslice;
 
+	/** Minimum amount of IOs or bytes a channel takes from remaining_this_timeslice
+	 *  at once and then consumes locally.
+	 */
+	uint32_t local_quota_batch;
+
+	/** Sum of the fair shares not yet consumed by the active descriptors in the
+	 *  current timeslice.  Only the quota above this amount can be borrowed by
+	 *  descriptors which already used up their own share.
+	 */
+	int64_t reserved_this_timeslice;
+
 	/** Function to check whether to queue the IO.
 	 * If The IO is allowed to pass, the quota will be reduced correspondingly.
 	 */
@@ -205,6 +252,18 @@ struct spdk_bdev_qos {
 
 	/** Poller that processes queued I/O commands each time slice. */
 	struct spdk_poller *poller;
+
+	/** Whether the rate limits are shared between the descriptors by their QoS classes. */
+	bool fair_share;
+};
+
+/* Per-thread cache of one of the bdev_io pools, and the I/Os waiting for it to refill */
+struct bdev_io_cache {
+	struct spdk_mempool	*pool;
+	bdev_io_stailq_t	per_thread_cache;
+	uint32_t		per_thread_cache_count;
+	uint32_t		bdev_io_cache_size;
+	TAILQ_HEAD(, spdk_bdev_io_wait_entry)	io_wait_queue;
 };
 
 struct spdk_bdev_mgmt_channel {
@@ -215,14 +274,22 @@ struct spdk_bdev_mgmt_channel {
 	 *  this, non-DPDK threads fetching from the mempool
 	 *  incur a cmpxchg on get and put.
 	 */
-	bdev_io_stailq_t per_thread_cache;
-	uint32_t	per_thread_cache_count;
-	uint32_t	bdev_io_cache_size;
+	struct bdev_io_cache	io_cache;
+
+	/* Cache of the small bdev_io pool, always empty if that pool is disabled */
+	struct bdev_io_cache	small_io_cache;
 
 	struct spdk_iobuf_channel iobuf;
 
 	TAILQ_HEAD(, spdk_bdev_shared_resource)	shared_resources;
-	TAILQ_HEAD(, spdk_bdev_io_wait_entry)	io_wait_queue;
+
+	/*
+	 * Completions waiting to be delivered on this thread, chained through
+	 *  internal.buf_link in LIFO order.  Both deferred completions from the
+	 *  submission context and completions from other threads are pushed here
+	 *  and the whole chain is delivered with a single message.
+	 */
+	struct spdk_bdev_io	*pending_completions;
 };
 
 /*
@@ -240,9 +307,15 @@ struct spdk_bdev_shared_resource {
 	 */
 	uint64_t		io_outstanding;
 
+	/*
+	 * Number of I/O the bdev module can have outstanding on this channel, published
+	 *  through get_max_outstanding_io().  0 if the module doesn't limit it.
+	 */
+	uint64_t		max_outstanding;
+
 	/*
 	 * Queue of IO awaiting retry because of a previous NOMEM status returned
-	 *  on this channel.
+	 *  on this channel, or because the module had no free slots for them.
 	 */
 	bdev_io_tailq_t		nomem_io;
 
@@ -270,6 +343,7 @@ struct spdk_bdev_shared_resource {
 
 #define BDEV_CH_RESET_IN_PROGRESS	(1 << 0)
 #define BDEV_CH_QOS_ENABLED		(1 << 1)
+#define BDEV_CH_COALESCE_ENABLED	(1 << 2)
 
 struct spdk_bdev_channel {
 	struct spdk_bdev	*bdev;
@@ -283,6 +357,12 @@ struct spdk_bdev_channel {
 	/* Per io_device per thread data */
 	struct spdk_bdev_shared_resource *shared_resource;
 
+	/* Cache of the pool the bdev_io of this channel are allocated from */
+	struct bdev_io_cache	*io_cache;
+
+	/* Last memory domain that couldn't translate its data to the system domain */
+	struct spdk_memory_domain *untranslatable_domain;
+
 	struct spdk_bdev_io_stat *stat;
 
 	/*
@@ -313,10 +393,28 @@ struct spdk_bdev_channel {
 	/* Counts number of bdev_io in the io_submitted TAILQ */
 	uint16_t		queue_depth;
 
+	/*
+	 * Number of bdev_io in the io_submitted TAILQ per coarse submit time epoch, so that
+	 * the timeout poller only walks the list when some I/O may have timed out.
+	 */
+	struct {
+		uint64_t	epoch[BDEV_TIMEOUT_BUCKETS];
+		uint32_t	count[BDEV_TIMEOUT_BUCKETS];
+		/* I/O whose bucket has since been reused by a later epoch */
+		uint32_t	older;
+		/* log2 of the number of ticks per epoch */
+		uint32_t	shift;
+	} timeout;
+
 	uint16_t		trace_id;
 
+	/* Number of I/Os left to submit before the next one is traced */
+	uint32_t		trace_sample_countdown;
+
 	struct spdk_histogram_data *histogram;
 
+	struct spdk_bdev_heatmap *heatmap;
+
 #ifdef SPDK_CONFIG_VTUNE
 	uint64_t		start_tsc;
 	uint64_t		interval_tsc;
@@ -326,8 +424,33 @@ struct spdk_bdev_channel {
 
 	lba_range_tailq_t	locked_ranges;
 
+	/**
+	 * Same ranges as locked_ranges, sorted by offset, so that the I/O submission
+	 *  path only has to look at the ranges which may overlap the I/O.
+	 */
+	struct bdev_lba_range_tree	locked_range_tree;
+
+	/** Length of the longest range in locked_ranges. */
+	uint64_t		locked_range_max_length;
+
 	/** List of I/Os queued by QoS. */
 	bdev_io_tailq_t		qos_queued_io;
+
+	/**
+	 * IOs or bytes taken from the shared QoS quota but not used yet, indexed by
+	 *  the rate limit type.  Only accessed from the thread owning the channel.
+	 */
+	int64_t			qos_local_quota[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+
+	/** Contiguous reads or writes held back to be merged into a single I/O. */
+	struct {
+		bdev_io_tailq_t		ios;
+		uint64_t		offset_blocks;
+		uint64_t		num_blocks;
+		uint32_t		iovcnt;
+		uint64_t		max_blocks;
+		struct spdk_poller	*poller;
+	} coalesce;
 };
 
 struct media_event_entry {
@@ -337,6 +460,23 @@ struct media_event_entry {
 
 #define MEDIA_EVENT_POOL_SIZE 64
 
+struct bdev_desc_qos_limit {
+	/** Guaranteed IOs or bytes per second, 0 if not set. */
+	uint64_t min;
+
+	/** Maximum IOs or bytes per second, 0 if not set. */
+	uint64_t max;
+
+	/** Remaining IOs or bytes of the descriptor's fair share in the current timeslice. */
+	int64_t share_remaining;
+
+	/** Remaining IOs or bytes allowed by the max limit in the current timeslice. */
+	int64_t max_remaining;
+
+	/** Maximum allowed IOs or bytes in one timeslice, 0 if max is not set. */
+	uint32_t max_per_timeslice;
+};
+
 struct spdk_bdev_desc {
 	struct spdk_bdev		*bdev;
 	bool				write;
@@ -361,6 +501,17 @@ struct spdk_bdev_desc {
 	void			*cb_arg;
 	struct spdk_poller	*io_timeout_poller;
 	struct spdk_bdev_module_claim	*claim;
+
+	/* QoS class, protected by the bdev spinlock */
+	struct {
+		/* Relative weight, 0 if the descriptor is not classified */
+		uint32_t			weight;
+		/* Set when I/O was submitted through the descriptor in the current timeslice */
+		bool				active;
+		/* Weight used to calculate the fair shares, 0 if the descriptor was idle */
+		uint32_t			active_weight;
+		struct bdev_desc_qos_limit	limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	} qos;
 };
 
 struct spdk_bdev_iostat_ctx {
@@ -420,13 +571,13 @@ static int bdev_readv_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io
 				     uint64_t num_blocks,
 				     struct spdk_memory_domain *domain, void *domain_ctx,
 				     struct spdk_accel_sequence *seq, uint32_t dif_check_flags,
-				     spdk_bdev_io_completion_cb cb, void *cb_arg);
+				     uint8_t priority, spdk_bdev_io_completion_cb cb, void *cb_arg);
 static int bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 				      struct iovec *iov, int iovcnt, void *md_buf,
 				      uint64_t offset_blocks, uint64_t num_blocks,
 				      struct spdk_memory_domain *domain, void *domain_ctx,
 				      struct spdk_accel_sequence *seq, uint32_t dif_check_flags,
-				      uint32_t nvme_cdw12_raw, uint32_t nvme_cdw13_raw,
+				      uint32_t nvme_cdw12_raw, uint32_t nvme_cdw13_raw, uint8_t priority,
 				      spdk_bdev_io_completion_cb cb, void *cb_arg);
 
 static int bdev_lock_lba_range(struct spdk_bdev_desc *desc, struct spdk_io_channel *_ch,
@@ -451,20 +602,71 @@ static bool bdev_io_should_split(struct spdk_bdev_io *bdev_io);
 #define bdev_get_ext_io_opt(opts, field, defval) \
 	((opts) != NULL ? SPDK_GET_FIELD(opts, field, defval) : (defval))
 
+/* Must be called after submit_tsc of the I/O is set. */
 static inline void
 bdev_ch_add_to_io_submitted(struct spdk_bdev_io *bdev_io)
 {
-	TAILQ_INSERT_TAIL(&bdev_io->internal.ch->io_submitted, bdev_io, internal.ch_link);
-	bdev_io->internal.ch->queue_depth++;
+	struct spdk_bdev_channel *ch = bdev_io->internal.ch;
+	uint64_t epoch = bdev_io->internal.submit_tsc >> ch->timeout.shift;
+	uint32_t idx = epoch % BDEV_TIMEOUT_BUCKETS;
+
+	if (spdk_unlikely(ch->timeout.epoch[idx] != epoch)) {
+		ch->timeout.older += ch->timeout.count[idx];
+		ch->timeout.count[idx] = 0;
+		ch->timeout.epoch[idx] = epoch;
+	}
+	ch->timeout.count[idx]++;
+
+	TAILQ_INSERT_TAIL(&ch->io_submitted, bdev_io, internal.ch_link);
+	ch->queue_depth++;
 }
 
 static inline void
 bdev_ch_remove_from_io_submitted(struct spdk_bdev_io *bdev_io)
 {
-	TAILQ_REMOVE(&bdev_io->internal.ch->io_submitted, bdev_io, internal.ch_link);
-	bdev_io->internal.ch->queue_depth--;
+	struct spdk_bdev_channel *ch = bdev_io->internal.ch;
+	uint64_t epoch = bdev_io->internal.submit_tsc >> ch->timeout.shift;
+	uint32_t idx = epoch % BDEV_TIMEOUT_BUCKETS;
+
+	if (spdk_likely(ch->timeout.epoch[idx] == epoch)) {
+		assert(ch->timeout.count[idx] > 0);
+		ch->timeout.count[idx]--;
+	} else {
+		assert(ch->timeout.older > 0);
+		ch->timeout.older--;
+	}
+
+	TAILQ_REMOVE(&ch->io_submitted, bdev_io, internal.ch_link);
+	ch->queue_depth--;
+}
+
+/* Decide whether the tracepoints of an I/O submitted on the channel are recorded. */
+static inline bool
+bdev_io_trace_sample(struct spdk_bdev_channel *ch)
+{
+	if (spdk_likely(g_bdev_opts.trace_sample_rate <= 1)) {
+		return true;
+	}
+
+	if (ch->trace_sample_countdown == 0) {
+		ch->trace_sample_countdown = g_bdev_opts.trace_sample_rate - 1;
+		return true;
+	}
+
+	ch->trace_sample_countdown--;
+	return false;
 }
 
+#define bdev_io_trace_record_tsc(bdev_io, tsc, tpoint_id, ...)		\
+	do {								\
+		if ((bdev_io)->internal.f.trace_sampled) {		\
+			spdk_trace_record_tsc(tsc, tpoint_id, __VA_ARGS__);	\
+		}							\
+	} while (0)
+
+#define bdev_io_trace_record(bdev_io, tpoint_id, ...) \
+	bdev_io_trace_record_tsc(bdev_io, 0, tpoint_id, __VA_ARGS__)
+
 void
 spdk_bdev_get_opts(struct spdk_bdev_opts *opts, size_t opts_size)
 {
@@ -490,10 +692,15 @@ spdk_bdev_get_opts(struct spdk_bdev_opts *opts, size_t opts_size)
 	SET_FIELD(bdev_auto_examine);
 	SET_FIELD(iobuf_small_cache_size);
 	SET_FIELD(iobuf_large_cache_size);
+	SET_FIELD(copy_queue_depth);
+	SET_FIELD(trace_sample_rate);
+	SET_FIELD(bdev_io_small_pool_size);
+	SET_FIELD(bdev_io_small_ctx_size);
+	SET_FIELD(bounce_accel_copy_threshold);
 
 	/* Do not remove this statement, you should always update this statement when you adding a new field,
 	 * and do not forget to add the SET_FIELD statement for your added field. */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_opts) == 32, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_opts) == 52, "Incorrect size");
 
 #undef SET_FIELD
 }
@@ -527,6 +734,19 @@ spdk_bdev_set_opts(struct spdk_bdev_opts *opts)
 		return -1;
 	}
 
+	if (offsetof(struct spdk_bdev_opts, bdev_io_small_pool_size) +
+	    sizeof(opts->bdev_io_small_pool_size) <= opts->opts_size &&
+	    opts->bdev_io_small_pool_size != 0 && opts->bdev_io_small_pool_size < min_pool_size) {
+		SPDK_ERRLOG("bdev_io_small_pool_size must be at least %" PRIu32 "\n", min_pool_size);
+		return -1;
+	}
+
+	if (offsetof(struct spdk_bdev_opts, copy_queue_depth) + sizeof(opts->copy_queue_depth) <=
+	    opts->opts_size && opts->copy_queue_depth == 0) {
+		SPDK_ERRLOG("copy_queue_depth must be at least 1\n");
+		return -1;
+	}
+
 #define SET_FIELD(field) \
         if (offsetof(struct spdk_bdev_opts, field) + sizeof(opts->field) <= opts->opts_size) { \
                 g_bdev_opts.field = opts->field; \
@@ -537,6 +757,11 @@ spdk_bdev_set_opts(struct spdk_bdev_opts *opts)
 	SET_FIELD(bdev_auto_examine);
 	SET_FIELD(iobuf_small_cache_size);
 	SET_FIELD(iobuf_large_cache_size);
+	SET_FIELD(copy_queue_depth);
+	SET_FIELD(trace_sample_rate);
+	SET_FIELD(bdev_io_small_pool_size);
+	SET_FIELD(bdev_io_small_ctx_size);
+	SET_FIELD(bounce_accel_copy_threshold);
 
 	g_bdev_opts.opts_size = opts->opts_size;
 
@@ -993,6 +1218,37 @@ bdev_io_get_block_size(struct spdk_bdev_io *bdev_io)
 	return bdev_desc_get_block_size(bdev_io->internal.desc);
 }
 
+static inline int
+bdev_io_priority_rank(const struct spdk_bdev_io *bdev_io)
+{
+	switch (bdev_io->priority) {
+	case SPDK_BDEV_IO_PRIORITY_HIGH:
+		return 2;
+	case SPDK_BDEV_IO_PRIORITY_LOW:
+		return 0;
+	default:
+		return 1;
+	}
+}
+
+/* Queue the I/O behind the queued I/Os of the same or higher priority. */
+static inline void
+bdev_io_queue_by_priority(bdev_io_tailq_t *queue, struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev_io *tmp = TAILQ_LAST(queue, bdev_io_tailq);
+	int rank = bdev_io_priority_rank(bdev_io);
+
+	while (spdk_unlikely(tmp != NULL && bdev_io_priority_rank(tmp) < rank)) {
+		tmp = TAILQ_PREV(tmp, bdev_io_tailq, internal.link);
+	}
+
+	if (spdk_likely(tmp != NULL)) {
+		TAILQ_INSERT_AFTER(queue, tmp, bdev_io, internal.link);
+	} else {
+		TAILQ_INSERT_HEAD(queue, bdev_io, internal.link);
+	}
+}
+
 static inline void
 bdev_queue_nomem_io_head(struct spdk_bdev_shared_resource *shared_resource,
 			 struct spdk_bdev_io *bdev_io, enum bdev_io_retry_state state)
@@ -1009,6 +1265,26 @@ bdev_queue_nomem_io_head(struct spdk_bdev_shared_resource *shared_resource,
 	TAILQ_INSERT_HEAD(&shared_resource->nomem_io, bdev_io, internal.link);
 }
 
+static inline bool
+bdev_shared_resource_has_slot(struct spdk_bdev_shared_resource *shared_resource,
+			      struct spdk_bdev_io *bdev_io)
+{
+	/* Aborts are never held back, they may be what frees the module's slots */
+	return shared_resource->max_outstanding == 0 ||
+	       shared_resource->io_outstanding < shared_resource->max_outstanding ||
+	       bdev_io->type == SPDK_BDEV_IO_TYPE_ABORT;
+}
+
+static inline void
+bdev_queue_no_slot_io(struct spdk_bdev_shared_resource *shared_resource,
+		      struct spdk_bdev_io *bdev_io)
+{
+	/* The module will have a free slot as soon as any I/O completes, so retry then */
+	shared_resource->nomem_threshold = shared_resource->max_outstanding - 1;
+	bdev_io->internal.retry_state = BDEV_IO_RETRY_STATE_SUBMIT;
+	TAILQ_INSERT_HEAD(&shared_resource->nomem_io, bdev_io, internal.link);
+}
+
 static inline void
 bdev_queue_nomem_io_tail(struct spdk_bdev_shared_resource *shared_resource,
 			 struct spdk_bdev_io *bdev_io, enum bdev_io_retry_state state)
@@ -1019,7 +1295,7 @@ bdev_queue_nomem_io_tail(struct spdk_bdev_shared_resource *shared_resource,
 
 	assert(state != BDEV_IO_RETRY_STATE_INVALID);
 	bdev_io->internal.retry_state = state;
-	TAILQ_INSERT_TAIL(&shared_resource->nomem_io, bdev_io, internal.link);
+	bdev_io_queue_by_priority(&shared_resource->nomem_io, bdev_io);
 }
 
 void
@@ -1322,6 +1598,40 @@ bdev_io_pull_data_done(struct spdk_bdev_io *bdev_io, int rc)
 	_bdev_io_set_md_buf(bdev_io);
 }
 
+static inline bool
+bdev_io_use_accel_bounce_copy(struct spdk_bdev_io *bdev_io)
+{
+	uint32_t threshold = g_bdev_opts.bounce_accel_copy_threshold;
+
+	return threshold != 0 && bdev_io->internal.bounce_buf.iov.iov_len >= threshold;
+}
+
+/*
+ * Copy data to or from the bounce buffer through accel. The bdev_io is tracked like a memory
+ * domain transfer until cb_fn is called. Returns an error if the copy couldn't be submitted,
+ * the caller then does it with the CPU.
+ */
+static int
+bdev_io_accel_bounce_copy(struct spdk_bdev_io *bdev_io, struct iovec *dst_iovs, uint32_t dst_iovcnt,
+			  struct iovec *src_iovs, uint32_t src_iovcnt, spdk_accel_completion_cb cb_fn)
+{
+	struct spdk_bdev_channel *ch = bdev_io->internal.ch;
+	struct spdk_accel_sequence *seq = NULL;
+	int rc;
+
+	rc = spdk_accel_append_copy(&seq, ch->accel_channel, dst_iovs, dst_iovcnt, NULL, NULL,
+				    src_iovs, src_iovcnt, NULL, NULL, NULL, NULL);
+	if (spdk_unlikely(rc != 0)) {
+		return rc;
+	}
+
+	TAILQ_INSERT_TAIL(&ch->io_memory_domain, bdev_io, internal.link);
+	bdev_io_increment_outstanding(ch, ch->shared_resource);
+	spdk_accel_sequence_finish(seq, cb_fn, bdev_io);
+
+	return 0;
+}
+
 static void
 bdev_io_pull_data_done_and_track(void *ctx, int status)
 {
@@ -1445,6 +1755,13 @@ bdev_io_pull_data(struct spdk_bdev_io *bdev_io)
 					    spdk_memory_domain_get_dma_device_id(
 						    bdev_io->internal.memory_domain));
 			}
+		} else if (bdev_io_use_accel_bounce_copy(bdev_io) &&
+			   bdev_io_accel_bounce_copy(bdev_io, bdev_io->u.bdev.iovs, 1,
+						     bdev_io->internal.bounce_buf.orig_iovs,
+						     (uint32_t)bdev_io->internal.bounce_buf.orig_iovcnt,
+						     bdev_io_pull_data_done_and_track) == 0) {
+			/* Continue to submit IO in completion callback */
+			return;
 		} else {
 			assert(bdev_io->u.bdev.iovcnt == 1);
 			spdk_copy_iovs_to_buf(bdev_io->u.bdev.iovs[0].iov_base,
@@ -1650,6 +1967,11 @@ bdev_shared_ch_retry_io(struct spdk_bdev_shared_resource *shared_resource)
 
 	while (!TAILQ_EMPTY(&shared_resource->nomem_io)) {
 		bdev_io = TAILQ_FIRST(&shared_resource->nomem_io);
+		if (bdev_io->internal.retry_state == BDEV_IO_RETRY_STATE_SUBMIT &&
+		    !bdev_shared_resource_has_slot(shared_resource, bdev_io)) {
+			shared_resource->nomem_threshold = shared_resource->max_outstanding - 1;
+			break;
+		}
 		TAILQ_REMOVE(&shared_resource->nomem_io, bdev_io, internal.link);
 
 		switch (bdev_io->internal.retry_state) {
@@ -1914,6 +2236,13 @@ bdev_io_push_bounce_data(struct spdk_bdev_io *bdev_io)
 					    spdk_memory_domain_get_dma_device_id(
 						    bdev_io->internal.memory_domain));
 			}
+		} else if (bdev_io_use_accel_bounce_copy(bdev_io) &&
+			   bdev_io_accel_bounce_copy(bdev_io, bdev_io->internal.bounce_buf.orig_iovs,
+						     (uint32_t)bdev_io->internal.bounce_buf.orig_iovcnt,
+						     &bdev_io->internal.bounce_buf.iov, 1,
+						     bdev_io_push_bounce_data_done_and_track) == 0) {
+			/* Continue IO completion in async callback */
+			return;
 		} else {
 			spdk_copy_buf_to_iovs(bdev_io->internal.bounce_buf.orig_iovs,
 					      bdev_io->internal.bounce_buf.orig_iovcnt,
@@ -2048,6 +2377,14 @@ spdk_bdev_io_get_aux_buf(struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_aux_buf_
 	bdev_io_get_buf(bdev_io, len);
 }
 
+static bool
+bdev_module_uses_small_io_pool(struct spdk_bdev_module *module)
+{
+	return g_bdev_mgr.small_bdev_io_pool != NULL &&
+	       (module->get_ctx_size == NULL ||
+		(uint32_t)module->get_ctx_size() <= g_bdev_opts.bdev_io_small_ctx_size);
+}
+
 static int
 bdev_module_get_max_ctx_size(void)
 {
@@ -2063,6 +2400,50 @@ bdev_module_get_max_ctx_size(void)
 	return max_bdev_module_size;
 }
 
+static void
+bdev_coalescing_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	if (bdev->internal.coalesce_window_us == 0) {
+		return;
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "method", "bdev_set_coalescing");
+
+	spdk_json_write_named_object_begin(w, "params");
+	spdk_json_write_named_string(w, "name", bdev->name);
+	spdk_json_write_named_uint64(w, "window_us", bdev->internal.coalesce_window_us);
+	spdk_json_write_named_uint32(w, "max_size_kb", bdev->internal.coalesce_max_size_kb);
+	spdk_json_write_object_end(w);
+
+	spdk_json_write_object_end(w);
+}
+
+static void
+bdev_enable_heatmap_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	if (!bdev->internal.heatmap_enabled) {
+		return;
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "method", "bdev_enable_heatmap");
+
+	spdk_json_write_named_object_begin(w, "params");
+	spdk_json_write_named_string(w, "name", bdev->name);
+	spdk_json_write_named_bool(w, "enable", bdev->internal.heatmap_enabled);
+	spdk_json_write_named_uint32(w, "num_regions", bdev->internal.heatmap_num_regions);
+
+	if (bdev->internal.heatmap_io_type) {
+		spdk_json_write_named_string(w, "opc",
+					     spdk_bdev_get_io_type_name(bdev->internal.heatmap_io_type));
+	}
+
+	spdk_json_write_object_end(w);
+
+	spdk_json_write_object_end(w);
+}
+
 static void
 bdev_enable_histogram_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
 {
@@ -2134,6 +2515,12 @@ spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_bool(w, "bdev_auto_examine", g_bdev_opts.bdev_auto_examine);
 	spdk_json_write_named_uint32(w, "iobuf_small_cache_size", g_bdev_opts.iobuf_small_cache_size);
 	spdk_json_write_named_uint32(w, "iobuf_large_cache_size", g_bdev_opts.iobuf_large_cache_size);
+	spdk_json_write_named_uint32(w, "copy_queue_depth", g_bdev_opts.copy_queue_depth);
+	spdk_json_write_named_uint32(w, "trace_sample_rate", g_bdev_opts.trace_sample_rate);
+	spdk_json_write_named_uint32(w, "bdev_io_small_pool_size", g_bdev_opts.bdev_io_small_pool_size);
+	spdk_json_write_named_uint32(w, "bdev_io_small_ctx_size", g_bdev_opts.bdev_io_small_ctx_size);
+	spdk_json_write_named_uint32(w, "bounce_accel_copy_threshold",
+				     g_bdev_opts.bounce_accel_copy_threshold);
 	spdk_json_write_object_end(w);
 	spdk_json_write_object_end(w);
 
@@ -2154,6 +2541,8 @@ spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 
 		bdev_qos_config_json(bdev, w);
 		bdev_enable_histogram_config_json(bdev, w);
+		bdev_enable_heatmap_config_json(bdev, w);
+		bdev_coalescing_config_json(bdev, w);
 	}
 
 	spdk_spin_unlock(&g_bdev_mgr.spinlock);
@@ -2167,29 +2556,65 @@ spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 }
 
 static void
-bdev_mgmt_channel_destroy(void *io_device, void *ctx_buf)
+bdev_io_cache_init(struct bdev_io_cache *cache, struct spdk_mempool *pool)
+{
+	cache->pool = pool;
+	STAILQ_INIT(&cache->per_thread_cache);
+	cache->per_thread_cache_count = 0;
+	cache->bdev_io_cache_size = pool != NULL ? g_bdev_opts.bdev_io_cache_size : 0;
+	TAILQ_INIT(&cache->io_wait_queue);
+}
+
+/* Pre-populate bdev_io cache to ensure this thread cannot be starved. */
+static int
+bdev_io_cache_fill(struct bdev_io_cache *cache)
 {
-	struct spdk_bdev_mgmt_channel *ch = ctx_buf;
 	struct spdk_bdev_io *bdev_io;
 
-	spdk_iobuf_channel_fini(&ch->iobuf);
+	while (cache->per_thread_cache_count < cache->bdev_io_cache_size) {
+		bdev_io = spdk_mempool_get(cache->pool);
+		if (bdev_io == NULL) {
+			return -ENOMEM;
+		}
+		cache->per_thread_cache_count++;
+		STAILQ_INSERT_HEAD(&cache->per_thread_cache, bdev_io, internal.buf_link);
+	}
 
-	while (!STAILQ_EMPTY(&ch->per_thread_cache)) {
-		bdev_io = STAILQ_FIRST(&ch->per_thread_cache);
-		STAILQ_REMOVE_HEAD(&ch->per_thread_cache, internal.buf_link);
-		ch->per_thread_cache_count--;
-		spdk_mempool_put(g_bdev_mgr.bdev_io_pool, (void *)bdev_io);
+	return 0;
+}
+
+static void
+bdev_io_cache_fini(struct bdev_io_cache *cache)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	while (!STAILQ_EMPTY(&cache->per_thread_cache)) {
+		bdev_io = STAILQ_FIRST(&cache->per_thread_cache);
+		STAILQ_REMOVE_HEAD(&cache->per_thread_cache, internal.buf_link);
+		cache->per_thread_cache_count--;
+		spdk_mempool_put(cache->pool, (void *)bdev_io);
 	}
 
-	assert(ch->per_thread_cache_count == 0);
+	assert(cache->per_thread_cache_count == 0);
+}
+
+static void
+bdev_mgmt_channel_destroy(void *io_device, void *ctx_buf)
+{
+	struct spdk_bdev_mgmt_channel *ch = ctx_buf;
+
+	assert(ch->pending_completions == NULL);
+
+	spdk_iobuf_channel_fini(&ch->iobuf);
+
+	bdev_io_cache_fini(&ch->io_cache);
+	bdev_io_cache_fini(&ch->small_io_cache);
 }
 
 static int
 bdev_mgmt_channel_create(void *io_device, void *ctx_buf)
 {
 	struct spdk_bdev_mgmt_channel *ch = ctx_buf;
-	struct spdk_bdev_io *bdev_io;
-	uint32_t i;
 	int rc;
 
 	rc = spdk_iobuf_channel_init(&ch->iobuf, "bdev",
@@ -2200,25 +2625,25 @@ bdev_mgmt_channel_create(void *io_device, void *ctx_buf)
 		return -1;
 	}
 
-	STAILQ_INIT(&ch->per_thread_cache);
-	ch->bdev_io_cache_size = g_bdev_opts.bdev_io_cache_size;
+	bdev_io_cache_init(&ch->io_cache, g_bdev_mgr.bdev_io_pool);
+	bdev_io_cache_init(&ch->small_io_cache, g_bdev_mgr.small_bdev_io_pool);
+	ch->pending_completions = NULL;
 
-	/* Pre-populate bdev_io cache to ensure this thread cannot be starved. */
-	ch->per_thread_cache_count = 0;
-	for (i = 0; i < ch->bdev_io_cache_size; i++) {
-		bdev_io = spdk_mempool_get(g_bdev_mgr.bdev_io_pool);
-		if (bdev_io == NULL) {
-			SPDK_ERRLOG("You need to increase bdev_io_pool_size using bdev_set_options RPC.\n");
-			assert(false);
-			bdev_mgmt_channel_destroy(io_device, ctx_buf);
-			return -1;
-		}
-		ch->per_thread_cache_count++;
-		STAILQ_INSERT_HEAD(&ch->per_thread_cache, bdev_io, internal.buf_link);
+	if (bdev_io_cache_fill(&ch->io_cache) != 0) {
+		SPDK_ERRLOG("You need to increase bdev_io_pool_size using bdev_set_options RPC.\n");
+		assert(false);
+		bdev_mgmt_channel_destroy(io_device, ctx_buf);
+		return -1;
+	}
+
+	if (bdev_io_cache_fill(&ch->small_io_cache) != 0) {
+		SPDK_ERRLOG("You need to increase bdev_io_small_pool_size using bdev_set_options RPC.\n");
+		assert(false);
+		bdev_mgmt_channel_destroy(io_device, ctx_buf);
+		return -1;
 	}
 
 	TAILQ_INIT(&ch->shared_resources);
-	TAILQ_INIT(&ch->io_wait_queue);
 
 	return 0;
 }
@@ -2394,6 +2819,22 @@ spdk_bdev_initialize(spdk_bdev_init_cb cb_fn, void *cb_arg)
 		return;
 	}
 
+	if (g_bdev_opts.bdev_io_small_pool_size != 0) {
+		snprintf(mempool_name, sizeof(mempool_name), "bdev_io_small_%d", getpid());
+		g_bdev_mgr.small_bdev_io_pool = spdk_mempool_create(mempool_name,
+						g_bdev_opts.bdev_io_small_pool_size,
+						sizeof(struct spdk_bdev_io) +
+						spdk_min(g_bdev_opts.bdev_io_small_ctx_size,
+								(uint32_t)bdev_module_get_max_ctx_size()),
+						0,
+						SPDK_ENV_NUMA_ID_ANY);
+		if (g_bdev_mgr.small_bdev_io_pool == NULL) {
+			SPDK_ERRLOG("could not allocate small spdk_bdev_io pool\n");
+			bdev_init_complete(-1);
+			return;
+		}
+	}
+
 	g_bdev_mgr.zero_buffer = spdk_zmalloc(ZERO_BUFFER_SIZE, ZERO_BUFFER_SIZE,
 					      NULL, SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
 	if (!g_bdev_mgr.zero_buffer) {
@@ -2434,6 +2875,18 @@ bdev_mgr_unregister_cb(void *io_device)
 		}
 
 		spdk_mempool_free(g_bdev_mgr.bdev_io_pool);
+		g_bdev_mgr.bdev_io_pool = NULL;
+	}
+
+	if (g_bdev_mgr.small_bdev_io_pool) {
+		if (spdk_mempool_count(g_bdev_mgr.small_bdev_io_pool) != g_bdev_opts.bdev_io_small_pool_size) {
+			SPDK_ERRLOG("small bdev IO pool count is %zu but should be %u\n",
+				    spdk_mempool_count(g_bdev_mgr.small_bdev_io_pool),
+				    g_bdev_opts.bdev_io_small_pool_size);
+		}
+
+		spdk_mempool_free(g_bdev_mgr.small_bdev_io_pool);
+		g_bdev_mgr.small_bdev_io_pool = NULL;
 	}
 
 	spdk_free(g_bdev_mgr.zero_buffer);
@@ -2650,7 +3103,7 @@ spdk_bdev_finish(spdk_bdev_fini_cb cb_fn, void *cb_arg)
 struct spdk_bdev_io *
 bdev_channel_get_io(struct spdk_bdev_channel *channel)
 {
-	struct spdk_bdev_mgmt_channel *ch = channel->shared_resource->mgmt_ch;
+	struct bdev_io_cache *ch = channel->io_cache;
 	struct spdk_bdev_io *bdev_io;
 
 	if (ch->per_thread_cache_count > 0) {
@@ -2664,7 +3117,7 @@ bdev_channel_get_io(struct spdk_bdev_channel *channel)
 		 */
 		bdev_io = NULL;
 	} else {
-		bdev_io = spdk_mempool_get(g_bdev_mgr.bdev_io_pool);
+		bdev_io = spdk_mempool_get(ch->pool);
 	}
 
 	return bdev_io;
@@ -2673,12 +3126,12 @@ bdev_channel_get_io(struct spdk_bdev_channel *channel)
 void
 spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
 {
-	struct spdk_bdev_mgmt_channel *ch;
+	struct bdev_io_cache *ch;
 
 	assert(bdev_io != NULL);
 	assert(bdev_io->internal.status != SPDK_BDEV_IO_STATUS_PENDING);
 
-	ch = bdev_io->internal.ch->shared_resource->mgmt_ch;
+	ch = bdev_io->internal.ch->io_cache;
 
 	if (bdev_io->internal.f.has_buf) {
 		bdev_io_put_buf(bdev_io);
@@ -2697,7 +3150,7 @@ spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
 	} else {
 		/* We should never have a full cache with entries on the io wait queue. */
 		assert(TAILQ_EMPTY(&ch->io_wait_queue));
-		spdk_mempool_put(g_bdev_mgr.bdev_io_pool, (void *)bdev_io);
+		spdk_mempool_put(ch->pool, (void *)bdev_io);
 	}
 }
 
@@ -2789,25 +3242,43 @@ bdev_get_io_size_in_byte(struct spdk_bdev_io *bdev_io)
 	}
 }
 
+static inline int64_t *
+bdev_qos_local_quota(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io)
+{
+	return &io->internal.ch->qos_local_quota[limit - io->bdev->internal.qos->rate_limits];
+}
+
 static inline bool
 bdev_qos_rw_queue_io(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io, uint64_t delta)
 {
-	int64_t remaining_this_timeslice;
+	int64_t remaining_this_timeslice, *local_quota;
+	uint64_t batch;
 
 	if (!limit->max_per_timeslice) {
 		/* The QoS is disabled */
 		return false;
 	}
 
-	remaining_this_timeslice = __atomic_sub_fetch(&limit->remaining_this_timeslice, delta,
+	/* Use the quota cached in the channel first, so that most IOs don't touch the
+	 * shared counter, which otherwise bounces between all the submitting threads.
+	 */
+	local_quota = bdev_qos_local_quota(limit, io);
+	if (*local_quota >= (int64_t)delta) {
+		*local_quota -= delta;
+		return false;
+	}
+
+	batch = spdk_max(delta - *local_quota, limit->local_quota_batch);
+	remaining_this_timeslice = __atomic_sub_fetch(&limit->remaining_this_timeslice, batch,
 				   __ATOMIC_RELAXED);
-	if (remaining_this_timeslice + (int64_t)delta > 0) {
+	if (remaining_this_timeslice + (int64_t)batch > 0) {
 		/* There was still a quota for this delta -> the IO shouldn't be queued
 		 *
 		 * We allow a slight quota overrun here so an IO bigger than the per-timeslice
 		 * quota can be allowed once a while. Such overrun then taken into account in
 		 * the QoS poller, where the next timeslice quota is calculated.
 		 */
+		*local_quota += batch - delta;
 		return false;
 	}
 
@@ -2816,14 +3287,15 @@ bdev_qos_rw_queue_io(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io,
 	 * amount of IOs or bytes allowed.
 	 */
 	__atomic_add_fetch(
-		&limit->remaining_this_timeslice, delta, __ATOMIC_RELAXED);
+		&limit->remaining_this_timeslice, batch, __ATOMIC_RELAXED);
 	return true;
 }
 
 static inline void
 bdev_qos_rw_rewind_io(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io, uint64_t delta)
 {
-	__atomic_add_fetch(&limit->remaining_this_timeslice, delta, __ATOMIC_RELAXED);
+	/* The quota was taken from the channel, give it back there. */
+	*bdev_qos_local_quota(limit, io) += delta;
 }
 
 static bool
@@ -2960,6 +3432,10 @@ bdev_io_do_submit(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_i
 	}
 
 	if (spdk_likely(TAILQ_EMPTY(&shared_resource->nomem_io))) {
+		if (spdk_unlikely(!bdev_shared_resource_has_slot(shared_resource, bdev_io))) {
+			bdev_queue_no_slot_io(shared_resource, bdev_io);
+			return;
+		}
 		bdev_io_increment_outstanding(bdev_ch, shared_resource);
 		bdev_io->internal.f.in_submit_request = true;
 		bdev_submit_request(bdev, ch, bdev_io);
@@ -2974,18 +3450,155 @@ bdev_io_do_submit(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_i
 	}
 }
 
-static bool
-bdev_qos_queue_io(struct spdk_bdev_qos *qos, struct spdk_bdev_io *bdev_io)
+static uint64_t
+bdev_qos_io_delta(enum spdk_bdev_qos_rate_limit_type type, struct spdk_bdev_io *bdev_io)
 {
-	int i;
-
-	if (bdev_qos_io_to_limit(bdev_io) == true) {
-		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-			if (!qos->rate_limits[i].queue_io) {
-				continue;
-			}
+	switch (type) {
+	case SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT:
+		return 1;
+	case SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT:
+		return bdev_get_io_size_in_byte(bdev_io);
+	case SPDK_BDEV_QOS_R_BPS_RATE_LIMIT:
+		return bdev_is_read_io(bdev_io) ? bdev_get_io_size_in_byte(bdev_io) : 0;
+	case SPDK_BDEV_QOS_W_BPS_RATE_LIMIT:
+		return bdev_is_read_io(bdev_io) ? 0 : bdev_get_io_size_in_byte(bdev_io);
+	default:
+		return 0;
+	}
+}
 
-			if (qos->rate_limits[i].queue_io(&qos->rate_limits[i],
+/* Same overrun semantics as bdev_qos_rw_queue_io(), returns true if the quota was taken. */
+static inline bool
+bdev_qos_take_quota(int64_t *remaining, uint64_t delta)
+{
+	if (__atomic_sub_fetch(remaining, delta, __ATOMIC_RELAXED) + (int64_t)delta > 0) {
+		return true;
+	}
+
+	__atomic_add_fetch(remaining, delta, __ATOMIC_RELAXED);
+	return false;
+}
+
+enum bdev_qos_quota_source {
+	BDEV_QOS_QUOTA_NONE = 0,
+	BDEV_QOS_QUOTA_SHARE,
+	BDEV_QOS_QUOTA_BORROWED,
+};
+
+static void
+bdev_qos_fair_rewind_quota(struct spdk_bdev_qos *qos, struct spdk_bdev_desc *desc,
+			   enum spdk_bdev_qos_rate_limit_type type, uint64_t delta,
+			   enum bdev_qos_quota_source source)
+{
+	struct spdk_bdev_qos_limit *limit = &qos->rate_limits[type];
+	struct bdev_desc_qos_limit *desc_limit = &desc->qos.limits[type];
+
+	if (desc_limit->max_per_timeslice) {
+		__atomic_add_fetch(&desc_limit->max_remaining, delta, __ATOMIC_RELAXED);
+	}
+
+	switch (source) {
+	case BDEV_QOS_QUOTA_SHARE:
+		__atomic_add_fetch(&desc_limit->share_remaining, delta, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&limit->reserved_this_timeslice, delta, __ATOMIC_RELAXED);
+	/* fallthrough */
+	case BDEV_QOS_QUOTA_BORROWED:
+		__atomic_add_fetch(&limit->remaining_this_timeslice, delta, __ATOMIC_RELAXED);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Fair share mode.  Each active descriptor owns a share of the bdev rate limits for
+ *  the current timeslice, proportional to its weight and bounded by its min and max
+ *  limits.  I/O is charged against the descriptor's own share first.  Once the share
+ *  is used up, the descriptor may borrow the bdev quota that is not reserved for the
+ *  shares of the other descriptors, so the idle bandwidth is not wasted.
+ */
+static bool
+bdev_qos_fair_queue_io(struct spdk_bdev_qos *qos, struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev_desc *desc = bdev_io->internal.desc;
+	enum bdev_qos_quota_source source[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES] = {};
+	uint64_t delta[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES] = {};
+	struct spdk_bdev_qos_limit *limit;
+	struct bdev_desc_qos_limit *desc_limit;
+	int64_t remaining, reserved;
+	int i;
+
+	__atomic_store_n(&desc->qos.active, true, __ATOMIC_RELAXED);
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		limit = &qos->rate_limits[i];
+		desc_limit = &desc->qos.limits[i];
+
+		delta[i] = bdev_qos_io_delta(i, bdev_io);
+		if (delta[i] == 0) {
+			continue;
+		}
+
+		if (desc_limit->max_per_timeslice &&
+		    !bdev_qos_take_quota(&desc_limit->max_remaining, delta[i])) {
+			break;
+		}
+
+		if (!limit->max_per_timeslice) {
+			continue;
+		}
+
+		if (bdev_qos_take_quota(&desc_limit->share_remaining, delta[i])) {
+			__atomic_sub_fetch(&limit->reserved_this_timeslice, delta[i], __ATOMIC_RELAXED);
+			__atomic_sub_fetch(&limit->remaining_this_timeslice, delta[i], __ATOMIC_RELAXED);
+			source[i] = BDEV_QOS_QUOTA_SHARE;
+			continue;
+		}
+
+		remaining = __atomic_load_n(&limit->remaining_this_timeslice, __ATOMIC_RELAXED);
+		reserved = __atomic_load_n(&limit->reserved_this_timeslice, __ATOMIC_RELAXED);
+		if (remaining - spdk_max(reserved, 0) > 0) {
+			/* As with the other limits, a slight overrun is allowed here. */
+			__atomic_sub_fetch(&limit->remaining_this_timeslice, delta[i], __ATOMIC_RELAXED);
+			source[i] = BDEV_QOS_QUOTA_BORROWED;
+			continue;
+		}
+
+		if (desc_limit->max_per_timeslice) {
+			__atomic_add_fetch(&desc_limit->max_remaining, delta[i], __ATOMIC_RELAXED);
+		}
+		break;
+	}
+
+	if (i == SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES) {
+		return false;
+	}
+
+	for (i -= 1; i >= 0; i--) {
+		if (delta[i] != 0) {
+			bdev_qos_fair_rewind_quota(qos, desc, i, delta[i], source[i]);
+		}
+	}
+
+	return true;
+}
+
+static bool
+bdev_qos_queue_io(struct spdk_bdev_qos *qos, struct spdk_bdev_io *bdev_io)
+{
+	int i;
+
+	if (spdk_unlikely(__atomic_load_n(&qos->fair_share, __ATOMIC_RELAXED))) {
+		return bdev_qos_io_to_limit(bdev_io) && bdev_qos_fair_queue_io(qos, bdev_io);
+	}
+
+	if (bdev_qos_io_to_limit(bdev_io) == true) {
+		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+			if (!qos->rate_limits[i].queue_io) {
+				continue;
+			}
+
+			if (qos->rate_limits[i].queue_io(&qos->rate_limits[i],
 							 bdev_io) == true) {
 				for (i -= 1; i >= 0 ; i--) {
 					if (!qos->rate_limits[i].queue_io) {
@@ -3220,6 +3833,7 @@ bdev_io_split_submit(struct spdk_bdev_io *bdev_io, struct iovec *iov, int iovcnt
 					       bdev_io_use_memory_domain(bdev_io) ? bdev_io->internal.memory_domain_ctx : NULL,
 					       NULL,
 					       bdev_io->u.bdev.dif_check_flags,
+					       bdev_io->priority,
 					       bdev_io_split_done, bdev_io);
 		break;
 	case SPDK_BDEV_IO_TYPE_WRITE:
@@ -3234,6 +3848,7 @@ bdev_io_split_submit(struct spdk_bdev_io *bdev_io, struct iovec *iov, int iovcnt
 						bdev_io->u.bdev.dif_check_flags,
 						bdev_io->u.bdev.nvme_cdw12.raw,
 						bdev_io->u.bdev.nvme_cdw13.raw,
+						bdev_io->priority,
 						bdev_io_split_done, bdev_io);
 		break;
 	case SPDK_BDEV_IO_TYPE_UNMAP:
@@ -3283,9 +3898,9 @@ bdev_io_split_submit(struct spdk_bdev_io *bdev_io, struct iovec *iov, int iovcnt
 			bdev_io->internal.status = SPDK_BDEV_IO_STATUS_FAILED;
 			if (bdev_io->internal.split.outstanding == 0) {
 				bdev_ch_remove_from_io_submitted(bdev_io);
-				spdk_trace_record(TRACE_BDEV_IO_DONE, bdev_io->internal.ch->trace_id,
-						  0, (uintptr_t)bdev_io, bdev_io->internal.caller_ctx,
-						  bdev_io->internal.ch->queue_depth);
+				bdev_io_trace_record(bdev_io, TRACE_BDEV_IO_DONE, bdev_io->internal.ch->trace_id,
+						     0, (uintptr_t)bdev_io, bdev_io->internal.caller_ctx,
+						     bdev_io->internal.ch->queue_depth);
 				bdev_io->internal.cb(bdev_io, false, bdev_io->internal.caller_ctx);
 			}
 		}
@@ -3415,9 +4030,10 @@ _bdev_rw_split(void *_bdev_io)
 								SPDK_ERRLOG("The first child io was less than a block size\n");
 								bdev_io->internal.status = SPDK_BDEV_IO_STATUS_FAILED;
 								bdev_ch_remove_from_io_submitted(bdev_io);
-								spdk_trace_record(TRACE_BDEV_IO_DONE, bdev_io->internal.ch->trace_id,
-										  0, (uintptr_t)bdev_io, bdev_io->internal.caller_ctx,
-										  bdev_io->internal.ch->queue_depth);
+								bdev_io_trace_record(bdev_io, TRACE_BDEV_IO_DONE,
+										     bdev_io->internal.ch->trace_id,
+										     0, (uintptr_t)bdev_io, bdev_io->internal.caller_ctx,
+										     bdev_io->internal.ch->queue_depth);
 								bdev_io->internal.cb(bdev_io, false, bdev_io->internal.caller_ctx);
 							}
 
@@ -3511,7 +4127,7 @@ bdev_copy_split(struct spdk_bdev_io *bdev_io)
 	remaining = bdev_io->internal.split.remaining_num_blocks;
 
 	assert(bdev_io->bdev->max_copy != 0);
-	while (remaining && (num_children_reqs < SPDK_BDEV_MAX_CHILDREN_COPY_REQS)) {
+	while (remaining && (num_children_reqs < g_bdev_opts.copy_queue_depth)) {
 		copy_blocks = spdk_min(remaining, bdev_io->bdev->max_copy);
 
 		rc = bdev_io_split_submit(bdev_io, NULL, 0, NULL, copy_blocks,
@@ -3580,9 +4196,9 @@ bdev_io_split_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 	if (parent_io->internal.split.remaining_num_blocks == 0) {
 		assert(parent_io->internal.cb != bdev_io_split_done);
 		bdev_ch_remove_from_io_submitted(parent_io);
-		spdk_trace_record(TRACE_BDEV_IO_DONE, parent_io->internal.ch->trace_id,
-				  0, (uintptr_t)parent_io, bdev_io->internal.caller_ctx,
-				  parent_io->internal.ch->queue_depth);
+		bdev_io_trace_record(parent_io, TRACE_BDEV_IO_DONE, parent_io->internal.ch->trace_id,
+				     0, (uintptr_t)parent_io, bdev_io->internal.caller_ctx,
+				     parent_io->internal.ch->queue_depth);
 
 		if (spdk_likely(parent_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS)) {
 			if (bdev_io_needs_sequence_exec(parent_io->internal.desc, parent_io)) {
@@ -3675,6 +4291,208 @@ bdev_rw_split_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 	_bdev_rw_split(bdev_io);
 }
 
+static inline bool
+bdev_io_can_coalesce(struct spdk_bdev_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	if (bdev_io->type != SPDK_BDEV_IO_TYPE_READ && bdev_io->type != SPDK_BDEV_IO_TYPE_WRITE) {
+		return false;
+	}
+
+	/* The merged I/O only describes plain data buffers */
+	if (bdev_io->internal.f.has_accel_sequence || bdev_io->internal.f.has_memory_domain ||
+	    bdev_io->internal.f.has_bounce_buf || bdev_io->internal.f.redirected ||
+	    bdev_io->u.bdev.md_buf != NULL || bdev_io->bdev->md_len != 0) {
+		return false;
+	}
+
+	return bdev_io->u.bdev.iovcnt > 0 && bdev_io->u.bdev.iovs[0].iov_base != NULL &&
+	       bdev_io->u.bdev.iovcnt <= SPDK_BDEV_IO_NUM_CHILD_IOV &&
+	       bdev_io->u.bdev.num_blocks < ch->coalesce.max_blocks;
+}
+
+static bool
+bdev_coalesce_can_append(struct spdk_bdev_channel *ch, struct spdk_bdev_io *first,
+			 struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev *bdev = ch->bdev;
+	uint64_t offset = ch->coalesce.offset_blocks;
+	uint64_t num_blocks = ch->coalesce.num_blocks + bdev_io->u.bdev.num_blocks;
+	uint32_t iovcnt = ch->coalesce.iovcnt + bdev_io->u.bdev.iovcnt;
+	uint32_t io_boundary;
+
+	if (bdev_io->type != first->type || bdev_io->internal.desc != first->internal.desc ||
+	    bdev_io->priority != first->priority ||
+	    bdev_io->u.bdev.offset_blocks != offset + ch->coalesce.num_blocks ||
+	    bdev_io->u.bdev.nvme_cdw12.raw != first->u.bdev.nvme_cdw12.raw ||
+	    bdev_io->u.bdev.nvme_cdw13.raw != first->u.bdev.nvme_cdw13.raw) {
+		return false;
+	}
+
+	if (num_blocks > ch->coalesce.max_blocks || iovcnt > SPDK_BDEV_IO_NUM_CHILD_IOV ||
+	    (bdev->max_rw_size != 0 && num_blocks > bdev->max_rw_size) ||
+	    (bdev->max_num_segments != 0 && iovcnt > bdev->max_num_segments)) {
+		return false;
+	}
+
+	/* Don't create an I/O that would have to be split again */
+	if (first->type == SPDK_BDEV_IO_TYPE_WRITE && bdev->split_on_write_unit) {
+		io_boundary = bdev->write_unit_size;
+	} else if (bdev->split_on_optimal_io_boundary) {
+		io_boundary = bdev->optimal_io_boundary;
+	} else {
+		io_boundary = 0;
+	}
+
+	return io_boundary == 0 || offset / io_boundary == (offset + num_blocks - 1) / io_boundary;
+}
+
+static void
+bdev_coalesce_flush(struct spdk_bdev_channel *ch)
+{
+	struct spdk_bdev_io *first, *merged, *bdev_io;
+	int iovcnt = 0;
+
+	first = TAILQ_FIRST(&ch->coalesce.ios);
+	if (first == NULL) {
+		return;
+	}
+
+	if (TAILQ_NEXT(first, internal.link) == NULL) {
+		TAILQ_REMOVE(&ch->coalesce.ios, first, internal.link);
+		bdev_io_do_submit(ch, first);
+		return;
+	}
+
+	merged = bdev_channel_get_io(ch);
+	if (spdk_unlikely(merged == NULL)) {
+		/* Submit the I/Os one by one instead */
+		while ((bdev_io = TAILQ_FIRST(&ch->coalesce.ios)) != NULL) {
+			TAILQ_REMOVE(&ch->coalesce.ios, bdev_io, internal.link);
+			bdev_io_do_submit(ch, bdev_io);
+		}
+		return;
+	}
+
+	TAILQ_INIT(&merged->internal.coalesce.ios);
+	TAILQ_SWAP(&merged->internal.coalesce.ios, &ch->coalesce.ios, spdk_bdev_io, internal.link);
+	TAILQ_FOREACH(bdev_io, &merged->internal.coalesce.ios, internal.link) {
+		memcpy(&merged->child_iov[iovcnt], bdev_io->u.bdev.iovs,
+		       bdev_io->u.bdev.iovcnt * sizeof(struct iovec));
+		iovcnt += bdev_io->u.bdev.iovcnt;
+	}
+
+	merged->internal.ch = ch;
+	merged->internal.desc = first->internal.desc;
+	merged->type = first->type;
+	merged->u.bdev.iovs = merged->child_iov;
+	merged->u.bdev.iovcnt = iovcnt;
+	merged->u.bdev.md_buf = NULL;
+	merged->u.bdev.offset_blocks = ch->coalesce.offset_blocks;
+	merged->u.bdev.num_blocks = ch->coalesce.num_blocks;
+	merged->u.bdev.dif_check_flags = first->u.bdev.dif_check_flags;
+	merged->u.bdev.nvme_cdw12 = first->u.bdev.nvme_cdw12;
+	merged->u.bdev.nvme_cdw13 = first->u.bdev.nvme_cdw13;
+	merged->u.bdev.memory_domain = NULL;
+	merged->u.bdev.memory_domain_ctx = NULL;
+	merged->u.bdev.accel_sequence = NULL;
+	bdev_io_init(merged, ch->bdev, NULL, NULL);
+	assert(!merged->internal.f.split);
+	merged->priority = first->priority;
+	merged->internal.f.coalesced = true;
+	merged->internal.submit_tsc = spdk_get_ticks();
+
+	/* The merged I/O isn't tracked in io_submitted, its children are. */
+	bdev_io_do_submit(ch, merged);
+}
+
+static void
+bdev_coalesce_io(struct spdk_bdev_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev_io *first = TAILQ_FIRST(&ch->coalesce.ios);
+
+	if (!bdev_io_can_coalesce(ch, bdev_io)) {
+		/* Don't let the I/O overtake the ones held back, e.g. a flush or an abort */
+		bdev_coalesce_flush(ch);
+		bdev_io_do_submit(ch, bdev_io);
+		return;
+	}
+
+	if (first != NULL && !bdev_coalesce_can_append(ch, first, bdev_io)) {
+		bdev_coalesce_flush(ch);
+		first = NULL;
+	}
+
+	if (first == NULL) {
+		ch->coalesce.offset_blocks = bdev_io->u.bdev.offset_blocks;
+		ch->coalesce.num_blocks = 0;
+		ch->coalesce.iovcnt = 0;
+	}
+
+	TAILQ_INSERT_TAIL(&ch->coalesce.ios, bdev_io, internal.link);
+	ch->coalesce.num_blocks += bdev_io->u.bdev.num_blocks;
+	ch->coalesce.iovcnt += bdev_io->u.bdev.iovcnt;
+
+	if (ch->coalesce.num_blocks == ch->coalesce.max_blocks) {
+		bdev_coalesce_flush(ch);
+	}
+}
+
+static void
+bdev_coalesce_io_done(struct spdk_bdev_io *merged)
+{
+	struct spdk_bdev_channel *ch = merged->internal.ch;
+	struct spdk_bdev_io *bdev_io;
+
+	while ((bdev_io = TAILQ_FIRST(&merged->internal.coalesce.ios)) != NULL) {
+		TAILQ_REMOVE(&merged->internal.coalesce.ios, bdev_io, internal.link);
+		bdev_io->internal.error = merged->internal.error;
+		/* Account for the decrement that spdk_bdev_io_complete() will do. */
+		bdev_io_increment_outstanding(ch, ch->shared_resource);
+		spdk_bdev_io_complete(bdev_io, merged->internal.status);
+	}
+
+	spdk_bdev_free_io(merged);
+}
+
+static int
+bdev_coalesce_poll(void *arg)
+{
+	struct spdk_bdev_channel *ch = arg;
+
+	if (TAILQ_EMPTY(&ch->coalesce.ios)) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	bdev_coalesce_flush(ch);
+
+	return SPDK_POLLER_BUSY;
+}
+
+static int
+bdev_channel_update_coalescing(struct spdk_bdev_channel *ch)
+{
+	struct spdk_bdev *bdev = ch->bdev;
+	uint64_t window_us = bdev->internal.coalesce_window_us;
+
+	spdk_poller_unregister(&ch->coalesce.poller);
+	bdev_coalesce_flush(ch);
+	ch->flags &= ~BDEV_CH_COALESCE_ENABLED;
+
+	if (window_us == 0) {
+		return 0;
+	}
+
+	ch->coalesce.poller = SPDK_POLLER_REGISTER(bdev_coalesce_poll, ch, window_us);
+	if (ch->coalesce.poller == NULL) {
+		return -ENOMEM;
+	}
+
+	ch->coalesce.max_blocks = (uint64_t)bdev->internal.coalesce_max_size_kb * 1024 / bdev->blocklen;
+	ch->flags |= BDEV_CH_COALESCE_ENABLED;
+
+	return 0;
+}
+
 static inline void
 _bdev_io_submit(struct spdk_bdev_io *bdev_io)
 {
@@ -3693,9 +4511,11 @@ _bdev_io_submit(struct spdk_bdev_io *bdev_io)
 		    bdev_abort_queued_io(&bdev_ch->qos_queued_io, bdev_io->u.abort.bio_to_abort)) {
 			_bdev_io_complete_in_submit(bdev_ch, bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
 		} else {
-			TAILQ_INSERT_TAIL(&bdev_ch->qos_queued_io, bdev_io, internal.link);
+			bdev_io_queue_by_priority(&bdev_ch->qos_queued_io, bdev_io);
 			bdev_qos_io_submit(bdev_ch, bdev->internal.qos);
 		}
+	} else if (bdev_ch->flags & BDEV_CH_COALESCE_ENABLED) {
+		bdev_coalesce_io(bdev_ch, bdev_io);
 	} else {
 		SPDK_ERRLOG("unknown bdev_ch flag %x found\n", bdev_ch->flags);
 		_bdev_io_complete_in_submit(bdev_ch, bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
@@ -3764,6 +4584,79 @@ bdev_io_range_is_locked(struct spdk_bdev_io *bdev_io, struct lba_range *range)
 	}
 }
 
+static bool
+bdev_io_is_locked(struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev_channel *ch = bdev_io->internal.ch;
+	struct lba_range *range, find = {};
+	uint64_t offset, end;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_NVME_IO:
+	case SPDK_BDEV_IO_TYPE_NVME_IO_MD:
+		return true;
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_ZCOPY:
+	case SPDK_BDEV_IO_TYPE_COPY:
+		break;
+	default:
+		return false;
+	}
+
+	offset = bdev_io->u.bdev.offset_blocks;
+	end = offset + bdev_io->u.bdev.num_blocks;
+
+	/* No range can overlap this I/O if it starts more than the longest locked
+	 * range before the I/O.  So only the ranges starting in
+	 * (offset - locked_range_max_length, end) need to be checked.
+	 */
+	if (offset < ch->locked_range_max_length) {
+		range = RB_MIN(bdev_lba_range_tree, &ch->locked_range_tree);
+	} else {
+		/* Ranges starting exactly at find.offset end at or before the I/O starts,
+		 * so it doesn't matter which of them are skipped by the tie break.
+		 */
+		find.offset = offset - ch->locked_range_max_length;
+		range = RB_NFIND(bdev_lba_range_tree, &ch->locked_range_tree, &find);
+	}
+
+	for (; range != NULL && range->offset < end;
+	     range = RB_NEXT(bdev_lba_range_tree, &ch->locked_range_tree, range)) {
+		if (bdev_io_range_is_locked(bdev_io, range)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void
+bdev_ch_insert_locked_range(struct spdk_bdev_channel *ch, struct lba_range *range)
+{
+	TAILQ_INSERT_TAIL(&ch->locked_ranges, range, tailq);
+	RB_INSERT(bdev_lba_range_tree, &ch->locked_range_tree, range);
+	ch->locked_range_max_length = spdk_max(ch->locked_range_max_length, range->length);
+}
+
+static void
+bdev_ch_remove_locked_range(struct spdk_bdev_channel *ch, struct lba_range *range)
+{
+	struct lba_range *tmp;
+
+	TAILQ_REMOVE(&ch->locked_ranges, range, tailq);
+	RB_REMOVE(bdev_lba_range_tree, &ch->locked_range_tree, range);
+
+	if (range->length == ch->locked_range_max_length) {
+		ch->locked_range_max_length = 0;
+		TAILQ_FOREACH(tmp, &ch->locked_ranges, tailq) {
+			ch->locked_range_max_length = spdk_max(ch->locked_range_max_length, tmp->length);
+		}
+	}
+}
+
 void
 bdev_io_submit(struct spdk_bdev_io *bdev_io)
 {
@@ -3771,24 +4664,19 @@ bdev_io_submit(struct spdk_bdev_io *bdev_io)
 
 	assert(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
 
-	if (!TAILQ_EMPTY(&ch->locked_ranges)) {
-		struct lba_range *range;
-
-		TAILQ_FOREACH(range, &ch->locked_ranges, tailq) {
-			if (bdev_io_range_is_locked(bdev_io, range)) {
-				TAILQ_INSERT_TAIL(&ch->io_locked, bdev_io, internal.ch_link);
-				return;
-			}
-		}
+	if (spdk_unlikely(!TAILQ_EMPTY(&ch->locked_ranges)) && bdev_io_is_locked(bdev_io)) {
+		TAILQ_INSERT_TAIL(&ch->io_locked, bdev_io, internal.ch_link);
+		return;
 	}
 
+	bdev_io->internal.submit_tsc = spdk_get_ticks();
 	bdev_ch_add_to_io_submitted(bdev_io);
 
-	bdev_io->internal.submit_tsc = spdk_get_ticks();
-	spdk_trace_record_tsc(bdev_io->internal.submit_tsc, TRACE_BDEV_IO_START,
-			      ch->trace_id, bdev_io->u.bdev.num_blocks,
-			      (uintptr_t)bdev_io, (uint64_t)bdev_io->type, bdev_io->internal.caller_ctx,
-			      bdev_io->u.bdev.offset_blocks, ch->queue_depth);
+	bdev_io->internal.f.trace_sampled = bdev_io_trace_sample(ch);
+	bdev_io_trace_record_tsc(bdev_io, bdev_io->internal.submit_tsc, TRACE_BDEV_IO_START,
+				 ch->trace_id, bdev_io->u.bdev.num_blocks,
+				 (uintptr_t)bdev_io, (uint64_t)bdev_io->type, bdev_io->internal.caller_ctx,
+				 bdev_io->u.bdev.offset_blocks, ch->queue_depth);
 
 	if (bdev_io->internal.f.split) {
 		bdev_io_split(bdev_io);
@@ -3881,6 +4769,77 @@ _bdev_io_ext_use_accel_buffer(struct spdk_bdev_io *bdev_io)
 			      bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
 }
 
+/* Instead of bouncing the data of an I/O to a bdev that doesn't support memory domains, try
+ * translating its buffers to the system memory domain, so that the bdev can access them directly.
+ * Only done for I/Os that otherwise go straight to the bdev: without metadata to insert or strip,
+ * accel sequence, separate metadata buffer or split.
+ */
+static bool
+bdev_io_translate_memory_domain(struct spdk_bdev_desc *desc, struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev_channel *ch = bdev_io->internal.ch;
+	struct spdk_memory_domain *domain = bdev_io->internal.memory_domain;
+	struct spdk_memory_domain_translation_result result;
+	struct iovec *iovs = bdev_io->u.bdev.iovs;
+	int i, iovcnt = bdev_io->u.bdev.iovcnt;
+	int rc;
+
+	if (ch->untranslatable_domain == domain || domain == spdk_accel_get_memory_domain() ||
+	    desc->memory_domains_supported || bdev_io_needs_metadata(desc, bdev_io) ||
+	    bdev_io_use_accel_sequence(bdev_io) || bdev_io->u.bdev.md_buf != NULL ||
+	    bdev_io->internal.f.split || iovcnt > SPDK_BDEV_IO_NUM_CHILD_IOV) {
+		return false;
+	}
+
+	for (i = 0; i < iovcnt; i++) {
+		result = (struct spdk_memory_domain_translation_result) {
+			.size = sizeof(result),
+		};
+		rc = spdk_memory_domain_translate_data(domain, bdev_io->internal.memory_domain_ctx,
+						       spdk_memory_domain_get_system_domain(), NULL,
+						       iovs[i].iov_base, iovs[i].iov_len, &result);
+		if (rc != 0 || result.iov_count != 1 || result.iov.iov_len != iovs[i].iov_len) {
+			if (rc == 0) {
+				spdk_memory_domain_invalidate_data(domain, bdev_io->internal.memory_domain_ctx,
+								   result.iov_count == 1 ? &result.iov : result.iovs,
+								   result.iov_count);
+			} else if (rc == -ENOTSUP) {
+				ch->untranslatable_domain = domain;
+			}
+			if (i > 0) {
+				spdk_memory_domain_invalidate_data(domain, bdev_io->internal.memory_domain_ctx,
+								   bdev_io->child_iov, i);
+			}
+			return false;
+		}
+		bdev_io->child_iov[i] = result.iov;
+	}
+
+	bdev_io->internal.f.translated = true;
+	bdev_io->internal.bounce_buf.orig_iovs = iovs;
+	bdev_io->internal.bounce_buf.orig_iovcnt = iovcnt;
+	bdev_io->u.bdev.iovs = bdev_io->child_iov;
+	bdev_io->u.bdev.memory_domain = NULL;
+	bdev_io->u.bdev.memory_domain_ctx = NULL;
+
+	return true;
+}
+
+static void
+bdev_io_release_translation(struct spdk_bdev_io *bdev_io)
+{
+	assert(bdev_io->internal.f.translated);
+
+	spdk_memory_domain_invalidate_data(bdev_io->internal.memory_domain,
+					   bdev_io->internal.memory_domain_ctx,
+					   bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt);
+	bdev_io->u.bdev.iovs = bdev_io->internal.bounce_buf.orig_iovs;
+	bdev_io->u.bdev.iovcnt = bdev_io->internal.bounce_buf.orig_iovcnt;
+	bdev_io->u.bdev.memory_domain = bdev_io->internal.memory_domain;
+	bdev_io->u.bdev.memory_domain_ctx = bdev_io->internal.memory_domain_ctx;
+	bdev_io->internal.f.translated = false;
+}
+
 /* We need to allocate bounce buffer
  * - if bdev doesn't support memory domains,
  * -  if it does support them, but we need to execute an accel sequence and the data buffer is
@@ -3943,7 +4902,8 @@ _bdev_io_submit_ext(struct spdk_bdev_desc *desc, struct spdk_bdev_io *bdev_io)
 		}
 	}
 
-	if (bdev_io_needs_bounce_buffer(desc, bdev_io)) {
+	if (bdev_io_needs_bounce_buffer(desc, bdev_io) &&
+	    !bdev_io_translate_memory_domain(desc, bdev_io)) {
 		_bdev_io_ext_use_bounce_buffer(bdev_io);
 		return;
 	}
@@ -3987,6 +4947,7 @@ bdev_io_init(struct spdk_bdev_io *bdev_io,
 	     spdk_bdev_io_completion_cb cb)
 {
 	bdev_io->bdev = bdev;
+	bdev_io->priority = SPDK_BDEV_IO_PRIORITY_DEFAULT;
 	bdev_io->internal.f.raw = 0;
 	bdev_io->internal.caller_ctx = cb_arg;
 	bdev_io->internal.cb = cb;
@@ -4113,6 +5074,8 @@ bdev_qos_update_max_quota_per_timeslice(struct spdk_bdev_qos *qos)
 
 		qos->rate_limits[i].max_per_timeslice = spdk_max(max_per_timeslice,
 							qos->rate_limits[i].min_per_timeslice);
+		qos->rate_limits[i].local_quota_batch = qos->rate_limits[i].max_per_timeslice /
+							SPDK_BDEV_QOS_LOCAL_QUOTA_DIVISOR;
 
 		__atomic_store_n(&qos->rate_limits[i].remaining_this_timeslice,
 				 qos->rate_limits[i].max_per_timeslice, __ATOMIC_RELEASE);
@@ -4122,18 +5085,92 @@ bdev_qos_update_max_quota_per_timeslice(struct spdk_bdev_qos *qos)
 }
 
 static void
-bdev_channel_submit_qos_io(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
-			   struct spdk_io_channel *io_ch, void *ctx)
+bdev_qos_update_fair_shares(struct spdk_bdev *bdev, struct spdk_bdev_qos *qos)
 {
-	struct spdk_bdev_channel *bdev_ch = __io_ch_to_bdev_ch(io_ch);
-	int status;
+	struct spdk_bdev_desc *desc;
+	struct bdev_desc_qos_limit *desc_limit;
+	uint64_t total_weight = 0, max_per_timeslice, share, reserved;
+	int64_t remaining;
+	bool fair_share = false;
+	int i;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	TAILQ_FOREACH(desc, &bdev->internal.open_descs, link) {
+		if (desc->qos.weight != 0) {
+			fair_share = true;
+		}
+
+		/* Idle descriptors do not get a share, so their bandwidth can be used by others. */
+		if (__atomic_exchange_n(&desc->qos.active, false, __ATOMIC_RELAXED)) {
+			desc->qos.active_weight = desc->qos.weight ? : SPDK_BDEV_QOS_DEFAULT_WEIGHT;
+		} else {
+			desc->qos.active_weight = 0;
+		}
+		total_weight += desc->qos.active_weight;
+	}
+
+	if (!fair_share) {
+		__atomic_store_n(&qos->fair_share, false, __ATOMIC_RELAXED);
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		return;
+	}
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		max_per_timeslice = qos->rate_limits[i].max_per_timeslice;
+		reserved = 0;
+
+		TAILQ_FOREACH(desc, &bdev->internal.open_descs, link) {
+			desc_limit = &desc->qos.limits[i];
+			share = 0;
+
+			if (max_per_timeslice != 0 && desc->qos.active_weight != 0) {
+				share = max_per_timeslice * desc->qos.active_weight / total_weight;
+				share = spdk_max(share, desc_limit->min * SPDK_BDEV_QOS_TIMESLICE_IN_USEC /
+						 SPDK_SEC_TO_USEC);
+				if (desc_limit->max_per_timeslice != 0) {
+					share = spdk_min(share, desc_limit->max_per_timeslice);
+				}
+			}
+			__atomic_store_n(&desc_limit->share_remaining, share, __ATOMIC_RELAXED);
+			reserved += share;
+
+			if (desc_limit->max_per_timeslice != 0) {
+				/* Carry over the overrun of the last timeslice, as for the bdev limits. */
+				remaining = __atomic_exchange_n(&desc_limit->max_remaining, 0, __ATOMIC_RELAXED);
+				__atomic_add_fetch(&desc_limit->max_remaining,
+						   spdk_min(remaining, 0) + desc_limit->max_per_timeslice,
+						   __ATOMIC_RELAXED);
+			}
+		}
 
-	bdev_qos_io_submit(bdev_ch, bdev->internal.qos);
+		__atomic_store_n(&qos->rate_limits[i].reserved_this_timeslice, reserved, __ATOMIC_RELAXED);
+	}
+
+	__atomic_store_n(&qos->fair_share, true, __ATOMIC_RELAXED);
+	spdk_spin_unlock(&bdev->internal.spinlock);
+}
+
+static void
+bdev_channel_submit_qos_io(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+			   struct spdk_io_channel *io_ch, void *ctx)
+{
+	struct spdk_bdev_channel *bdev_ch = __io_ch_to_bdev_ch(io_ch);
+	struct spdk_bdev_qos *qos = bdev->internal.qos;
+	int status;
+
+	bdev_qos_io_submit(bdev_ch, qos);
 
 	/* if all IOs were sent then continue the iteration, otherwise - stop it */
 	/* TODO: channels round robing */
 	status = TAILQ_EMPTY(&bdev_ch->qos_queued_io) ? 0 : 1;
 
+	/* In fair share mode the I/O queued here may belong to a descriptor which used up
+	 * its share, while the I/O queued on the other channels may still be allowed.
+	 */
+	if (__atomic_load_n(&qos->fair_share, __ATOMIC_RELAXED)) {
+		status = 0;
+	}
+
 	spdk_bdev_for_each_channel_continue(i, status);
 }
 
@@ -4194,6 +5231,8 @@ bdev_channel_poll_qos(void *arg)
 		}
 	}
 
+	bdev_qos_update_fair_shares(bdev, qos);
+
 	spdk_bdev_for_each_channel(bdev, bdev_channel_submit_qos_io, qos,
 				   bdev_channel_submit_qos_io_done);
 
@@ -4210,10 +5249,11 @@ bdev_channel_destroy_resource(struct spdk_bdev_channel *ch)
 #ifdef SPDK_CONFIG_VTUNE
 	bdev_free_io_stat(ch->prev_stat);
 #endif
+	spdk_poller_unregister(&ch->coalesce.poller);
 
 	while (!TAILQ_EMPTY(&ch->locked_ranges)) {
 		range = TAILQ_FIRST(&ch->locked_ranges);
-		TAILQ_REMOVE(&ch->locked_ranges, range, tailq);
+		bdev_ch_remove_locked_range(ch, range);
 		free(range);
 	}
 
@@ -4285,6 +5325,7 @@ bdev_enable_qos(struct spdk_bdev *bdev, struct spdk_bdev_channel *ch)
 							   SPDK_BDEV_QOS_TIMESLICE_IN_USEC);
 		}
 
+		memset(ch->qos_local_quota, 0, sizeof(ch->qos_local_quota));
 		ch->flags |= BDEV_CH_QOS_ENABLED;
 	}
 }
@@ -4322,6 +5363,32 @@ bdev_channel_poll_timeout_io_done(struct spdk_bdev *bdev, void *_ctx, int status
 	spdk_spin_unlock(&desc->spinlock);
 }
 
+/* Check whether any I/O submitted before now - timeout_ticks is still in the io_submitted list. */
+static bool
+bdev_channel_may_have_timed_out_io(struct spdk_bdev_channel *ch, uint64_t now,
+				   uint64_t timeout_ticks)
+{
+	uint64_t epoch;
+	uint32_t i;
+
+	if (now < timeout_ticks) {
+		return false;
+	}
+
+	if (ch->timeout.older != 0) {
+		return true;
+	}
+
+	epoch = (now - timeout_ticks) >> ch->timeout.shift;
+	for (i = 0; i < BDEV_TIMEOUT_BUCKETS; i++) {
+		if (ch->timeout.count[i] != 0 && ch->timeout.epoch[i] <= epoch) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static void
 bdev_channel_poll_timeout_io(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
 			     struct spdk_io_channel *io_ch, void *_ctx)
@@ -4330,7 +5397,7 @@ bdev_channel_poll_timeout_io(struct spdk_bdev_channel_iter *i, struct spdk_bdev
 	struct spdk_bdev_channel *bdev_ch = __io_ch_to_bdev_ch(io_ch);
 	struct spdk_bdev_desc *desc = ctx->desc;
 	struct spdk_bdev_io *bdev_io;
-	uint64_t now;
+	uint64_t now, timeout_ticks;
 
 	spdk_spin_lock(&desc->spinlock);
 	if (desc->closed == true) {
@@ -4341,6 +5408,11 @@ bdev_channel_poll_timeout_io(struct spdk_bdev_channel_iter *i, struct spdk_bdev
 	spdk_spin_unlock(&desc->spinlock);
 
 	now = spdk_get_ticks();
+	timeout_ticks = ctx->timeout_in_sec * spdk_get_ticks_hz();
+	if (!bdev_channel_may_have_timed_out_io(bdev_ch, now, timeout_ticks)) {
+		goto end;
+	}
+
 	TAILQ_FOREACH(bdev_io, &bdev_ch->io_submitted, internal.ch_link) {
 		/* Exclude any I/O that are generated via splitting. */
 		if (bdev_io->internal.cb == bdev_io_split_done) {
@@ -4350,8 +5422,7 @@ bdev_channel_poll_timeout_io(struct spdk_bdev_channel_iter *i, struct spdk_bdev
 		/* Once we find an I/O that has not timed out, we can immediately
 		 * exit the loop.
 		 */
-		if (now < (bdev_io->internal.submit_tsc +
-			   ctx->timeout_in_sec * spdk_get_ticks_hz())) {
+		if (now < (bdev_io->internal.submit_tsc + timeout_ticks)) {
 			goto end;
 		}
 
@@ -4421,6 +5492,83 @@ spdk_bdev_set_timeout(struct spdk_bdev_desc *desc, uint64_t timeout_in_sec,
 	return 0;
 }
 
+static struct spdk_bdev_heatmap *
+bdev_heatmap_alloc(uint32_t num_regions, uint64_t region_size)
+{
+	struct spdk_bdev_heatmap *heatmap;
+
+	heatmap = calloc(1, sizeof(*heatmap) + SPDK_BDEV_HEATMAP_NUM_COUNTS(num_regions) * sizeof(uint64_t));
+	if (heatmap == NULL) {
+		return NULL;
+	}
+
+	heatmap->num_regions = num_regions;
+	heatmap->region_size = region_size;
+
+	return heatmap;
+}
+
+static int
+bdev_heatmap_merge(struct spdk_bdev_heatmap *dst, const struct spdk_bdev_heatmap *src)
+{
+	size_t i;
+
+	/* The heatmap was enabled again with another layout while it was being merged. */
+	if (dst->num_regions != src->num_regions || dst->region_size != src->region_size) {
+		return -EAGAIN;
+	}
+
+	for (i = 0; i < SPDK_BDEV_HEATMAP_NUM_COUNTS(dst->num_regions); i++) {
+		dst->count[i] += src->count[i];
+	}
+
+	return 0;
+}
+
+static void
+bdev_heatmap_tally(struct spdk_bdev_heatmap *heatmap, struct spdk_bdev_io *bdev_io, uint64_t tsc_diff)
+{
+	uint64_t region, latency_us;
+	uint32_t size_bucket, latency_bucket;
+	uint8_t io_type = bdev_io->bdev->internal.heatmap_io_type;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_COMPARE:
+	case SPDK_BDEV_IO_TYPE_COMPARE_AND_WRITE:
+	case SPDK_BDEV_IO_TYPE_COPY:
+		break;
+	default:
+		return;
+	}
+
+	/* Tally all the I/O types above if the heatmap_io_type is set to 0. */
+	if (io_type != 0 && io_type != bdev_io->type) {
+		return;
+	}
+
+	region = spdk_min(bdev_io->u.bdev.offset_blocks / heatmap->region_size,
+			  (uint64_t)heatmap->num_regions - 1);
+
+	size_bucket = 0;
+	if (bdev_io->u.bdev.num_blocks != 0) {
+		size_bucket = spdk_min(spdk_u64log2(bdev_io->u.bdev.num_blocks),
+				       SPDK_BDEV_HEATMAP_NUM_SIZE_BUCKETS - 1);
+	}
+
+	latency_bucket = 0;
+	latency_us = tsc_diff * SPDK_SEC_TO_USEC / spdk_get_ticks_hz();
+	if (latency_us != 0) {
+		latency_bucket = spdk_min(spdk_u64log2(latency_us) + 1,
+					  SPDK_BDEV_HEATMAP_NUM_LATENCY_BUCKETS - 1);
+	}
+
+	heatmap->count[spdk_bdev_heatmap_get_index(region, size_bucket, latency_bucket)]++;
+}
+
 static int
 bdev_channel_create(void *io_device, void *ctx_buf)
 {
@@ -4454,6 +5602,15 @@ bdev_channel_create(void *io_device, void *ctx_buf)
 		}
 	}
 
+	assert(ch->heatmap == NULL);
+	if (bdev->internal.heatmap_enabled) {
+		ch->heatmap = bdev_heatmap_alloc(bdev->internal.heatmap_num_regions,
+						 bdev->internal.heatmap_region_size);
+		if (ch->heatmap == NULL) {
+			SPDK_ERRLOG("Could not allocate heatmap\n");
+		}
+	}
+
 	mgmt_io_ch = spdk_get_io_channel(&g_bdev_mgr);
 	if (!mgmt_io_ch) {
 		spdk_put_io_channel(ch->channel);
@@ -4481,6 +5638,9 @@ bdev_channel_create(void *io_device, void *ctx_buf)
 
 		shared_resource->mgmt_ch = mgmt_ch;
 		shared_resource->io_outstanding = 0;
+		if (bdev->fn_table->get_max_outstanding_io != NULL) {
+			shared_resource->max_outstanding = bdev->fn_table->get_max_outstanding_io(ch->channel);
+		}
 		TAILQ_INIT(&shared_resource->nomem_io);
 		shared_resource->nomem_threshold = 0;
 		shared_resource->shared_ch = ch->channel;
@@ -4490,15 +5650,27 @@ bdev_channel_create(void *io_device, void *ctx_buf)
 
 	ch->io_outstanding = 0;
 	TAILQ_INIT(&ch->locked_ranges);
+	RB_INIT(&ch->locked_range_tree);
+	ch->locked_range_max_length = 0;
 	TAILQ_INIT(&ch->qos_queued_io);
 	ch->flags = 0;
 	ch->trace_id = bdev->internal.trace_id;
 	ch->shared_resource = shared_resource;
+	ch->io_cache = bdev_module_uses_small_io_pool(bdev->module) ?
+		       &mgmt_ch->small_io_cache : &mgmt_ch->io_cache;
+	ch->untranslatable_domain = NULL;
 
 	TAILQ_INIT(&ch->io_submitted);
+	memset(&ch->timeout, 0, sizeof(ch->timeout));
+	ch->timeout.shift = spdk_u64log2(spdk_get_ticks_hz()) + 1;
 	TAILQ_INIT(&ch->io_locked);
 	TAILQ_INIT(&ch->io_accel_exec);
 	TAILQ_INIT(&ch->io_memory_domain);
+	TAILQ_INIT(&ch->coalesce.ios);
+	ch->coalesce.poller = NULL;
+	if (bdev->internal.coalesce_window_us != 0 && bdev_channel_update_coalescing(ch) != 0) {
+		SPDK_ERRLOG("Could not enable I/O coalescing\n");
+	}
 
 	ch->stat = bdev_alloc_io_stat(false);
 	if (ch->stat == NULL) {
@@ -4544,7 +5716,7 @@ bdev_channel_create(void *io_device, void *ctx_buf)
 		new_range->length = range->length;
 		new_range->offset = range->offset;
 		new_range->locked_ctx = range->locked_ctx;
-		TAILQ_INSERT_TAIL(&ch->locked_ranges, new_range, tailq);
+		bdev_ch_insert_locked_range(ch, new_range);
 	}
 
 	spdk_spin_unlock(&bdev->internal.spinlock);
@@ -4905,6 +6077,7 @@ bdev_channel_abort_queued_ios(struct spdk_bdev_channel *ch)
 
 	bdev_abort_all_nomem_io(ch);
 	bdev_abort_all_buf_io(mgmt_ch, ch);
+	bdev_abort_all_queued_io(&ch->coalesce.ios, ch);
 }
 
 static void
@@ -4921,6 +6094,9 @@ bdev_channel_destroy(void *io_device, void *ctx_buf)
 	/* This channel is going away, so add its statistics into the bdev so that they don't get lost. */
 	spdk_spin_lock(&ch->bdev->internal.spinlock);
 	spdk_bdev_add_io_stat(ch->bdev->internal.stat, ch->stat);
+	if (ch->heatmap != NULL && ch->bdev->internal.heatmap != NULL) {
+		bdev_heatmap_merge(ch->bdev->internal.heatmap, ch->heatmap);
+	}
 	spdk_spin_unlock(&ch->bdev->internal.spinlock);
 
 	bdev_channel_abort_queued_ios(ch);
@@ -4929,6 +6105,8 @@ bdev_channel_destroy(void *io_device, void *ctx_buf)
 		spdk_histogram_data_free(ch->histogram);
 	}
 
+	free(ch->heatmap);
+
 	bdev_channel_destroy_resource(ch);
 }
 
@@ -5828,7 +7006,7 @@ bdev_readv_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *c
 			  struct iovec *iov, int iovcnt, void *md_buf, uint64_t offset_blocks,
 			  uint64_t num_blocks, struct spdk_memory_domain *domain, void *domain_ctx,
 			  struct spdk_accel_sequence *seq, uint32_t dif_check_flags,
-			  spdk_bdev_io_completion_cb cb, void *cb_arg)
+			  uint8_t priority, spdk_bdev_io_completion_cb cb, void *cb_arg)
 {
 	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(desc);
 	struct spdk_bdev_io *bdev_io;
@@ -5868,6 +7046,7 @@ bdev_readv_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *c
 	bdev_io->u.bdev.memory_domain_ctx = domain_ctx;
 	bdev_io->u.bdev.accel_sequence = seq;
 	bdev_io->u.bdev.dif_check_flags = dif_check_flags;
+	bdev_io->priority = priority;
 
 	_bdev_io_submit_ext(desc, bdev_io);
 
@@ -5883,7 +7062,8 @@ spdk_bdev_readv_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(desc);
 
 	return bdev_readv_blocks_with_md(desc, ch, iov, iovcnt, NULL, offset_blocks,
-					 num_blocks, NULL, NULL, NULL, bdev->dif_check_flags, cb, cb_arg);
+					 num_blocks, NULL, NULL, NULL, bdev->dif_check_flags,
+					 SPDK_BDEV_IO_PRIORITY_DEFAULT, cb, cb_arg);
 }
 
 int
@@ -5903,7 +7083,8 @@ spdk_bdev_readv_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_chann
 	}
 
 	return bdev_readv_blocks_with_md(desc, ch, iov, iovcnt, md_buf, offset_blocks,
-					 num_blocks, NULL, NULL, NULL, bdev->dif_check_flags, cb, cb_arg);
+					 num_blocks, NULL, NULL, NULL, bdev->dif_check_flags,
+					 SPDK_BDEV_IO_PRIORITY_DEFAULT, cb, cb_arg);
 }
 
 static inline bool
@@ -5918,7 +7099,8 @@ _bdev_io_check_opts(struct spdk_bdev_ext_io_opts *opts, struct iovec *iov)
 	       sizeof(opts->metadata) &&
 	       opts->size <= sizeof(*opts) &&
 	       /* When memory domain is used, the user must provide data buffers */
-	       (!opts->memory_domain || (iov && iov[0].iov_base));
+	       (!opts->memory_domain || (iov && iov[0].iov_base)) &&
+	       bdev_get_ext_io_opt(opts, priority, 0) <= SPDK_BDEV_IO_PRIORITY_LOW;
 }
 
 int
@@ -5973,7 +7155,9 @@ spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *
 			   ~(bdev_get_ext_io_opt(opts, dif_check_flags_exclude_mask, 0));
 
 	return bdev_readv_blocks_with_md(desc, ch, iov, iovcnt, md, offset_blocks,
-					 num_blocks, domain, domain_ctx, seq, dif_check_flags, cb, cb_arg);
+					 num_blocks, domain, domain_ctx, seq, dif_check_flags,
+					 bdev_get_ext_io_opt(opts, priority, SPDK_BDEV_IO_PRIORITY_DEFAULT),
+					 cb, cb_arg);
 }
 
 static int
@@ -6068,7 +7252,7 @@ bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *
 			   uint64_t offset_blocks, uint64_t num_blocks,
 			   struct spdk_memory_domain *domain, void *domain_ctx,
 			   struct spdk_accel_sequence *seq, uint32_t dif_check_flags,
-			   uint32_t nvme_cdw12_raw, uint32_t nvme_cdw13_raw,
+			   uint32_t nvme_cdw12_raw, uint32_t nvme_cdw13_raw, uint8_t priority,
 			   spdk_bdev_io_completion_cb cb, void *cb_arg)
 {
 	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(desc);
@@ -6114,6 +7298,7 @@ bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *
 	bdev_io->u.bdev.dif_check_flags = dif_check_flags;
 	bdev_io->u.bdev.nvme_cdw12.raw = nvme_cdw12_raw;
 	bdev_io->u.bdev.nvme_cdw13.raw = nvme_cdw13_raw;
+	bdev_io->priority = priority;
 
 	_bdev_io_submit_ext(desc, bdev_io);
 
@@ -6145,7 +7330,7 @@ spdk_bdev_writev_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 
 	return bdev_writev_blocks_with_md(desc, ch, iov, iovcnt, NULL, offset_blocks,
 					  num_blocks, NULL, NULL, NULL, bdev->dif_check_flags, 0, 0,
-					  cb, cb_arg);
+					  SPDK_BDEV_IO_PRIORITY_DEFAULT, cb, cb_arg);
 }
 
 int
@@ -6166,7 +7351,7 @@ spdk_bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_chan
 
 	return bdev_writev_blocks_with_md(desc, ch, iov, iovcnt, md_buf, offset_blocks,
 					  num_blocks, NULL, NULL, NULL, bdev->dif_check_flags, 0, 0,
-					  cb, cb_arg);
+					  SPDK_BDEV_IO_PRIORITY_DEFAULT, cb, cb_arg);
 }
 
 int
@@ -6223,7 +7408,9 @@ spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel
 
 	return bdev_writev_blocks_with_md(desc, ch, iov, iovcnt, md, offset_blocks, num_blocks,
 					  domain, domain_ctx, seq, dif_check_flags,
-					  nvme_cdw12_raw, nvme_cdw13_raw, cb, cb_arg);
+					  nvme_cdw12_raw, nvme_cdw13_raw,
+					  bdev_get_ext_io_opt(opts, priority, SPDK_BDEV_IO_PRIORITY_DEFAULT),
+					  cb, cb_arg);
 }
 
 static void
@@ -6958,6 +8145,8 @@ bdev_reset_freeze_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bd
 		bdev_abort_all_queued_io(&channel->qos_queued_io, channel);
 	}
 
+	bdev_abort_all_queued_io(&channel->coalesce.ios, channel);
+
 	spdk_bdev_for_each_channel_continue(i, 0);
 }
 
@@ -7558,19 +8747,19 @@ spdk_bdev_queue_io_wait(struct spdk_bdev *bdev, struct spdk_io_channel *ch,
 			struct spdk_bdev_io_wait_entry *entry)
 {
 	struct spdk_bdev_channel *channel = __io_ch_to_bdev_ch(ch);
-	struct spdk_bdev_mgmt_channel *mgmt_ch = channel->shared_resource->mgmt_ch;
+	struct bdev_io_cache *io_cache = channel->io_cache;
 
 	if (bdev != entry->bdev) {
 		SPDK_ERRLOG("bdevs do not match\n");
 		return -EINVAL;
 	}
 
-	if (mgmt_ch->per_thread_cache_count > 0) {
+	if (io_cache->per_thread_cache_count > 0) {
 		SPDK_ERRLOG("Cannot queue io_wait if spdk_bdev_io available in per-thread cache\n");
 		return -EINVAL;
 	}
 
-	TAILQ_INSERT_TAIL(&mgmt_ch->io_wait_queue, entry, link);
+	TAILQ_INSERT_TAIL(&io_cache->io_wait_queue, entry, link);
 	return 0;
 }
 
@@ -7688,11 +8877,37 @@ bdev_io_update_io_stat(struct spdk_bdev_io *bdev_io, uint64_t tsc_diff)
 #endif
 }
 
+static void
+bdev_io_redirect_done(struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev_channel *ch = bdev_io->internal.redirect.ch;
+	enum spdk_bdev_io_status status = bdev_io->internal.status;
+
+	/* Move the I/O back to the bdev it was submitted to and complete it there. */
+	bdev_io->bdev = ch->bdev;
+	bdev_io->internal.ch = ch;
+	bdev_io->internal.desc = bdev_io->internal.redirect.desc;
+	bdev_io->internal.submit_tsc = bdev_io->internal.redirect.submit_tsc;
+	bdev_io->u.bdev.offset_blocks = bdev_io->internal.redirect.offset_blocks;
+	bdev_io->internal.f.redirected = false;
+	bdev_io->internal.status = SPDK_BDEV_IO_STATUS_PENDING;
+
+	/* The queue depth of the channel still accounts for the I/O */
+	TAILQ_INSERT_TAIL(&ch->io_submitted, bdev_io, internal.ch_link);
+
+	spdk_bdev_io_complete(bdev_io, status);
+}
+
 static inline void
 _bdev_io_complete(void *ctx)
 {
 	struct spdk_bdev_io *bdev_io = ctx;
 
+	if (spdk_unlikely(bdev_io->internal.f.redirected)) {
+		bdev_io_redirect_done(bdev_io);
+		return;
+	}
+
 	if (spdk_unlikely(bdev_io_use_accel_sequence(bdev_io))) {
 		assert(bdev_io->internal.status != SPDK_BDEV_IO_STATUS_SUCCESS);
 		spdk_accel_sequence_abort(bdev_io->internal.accel_sequence);
@@ -7705,6 +8920,63 @@ _bdev_io_complete(void *ctx)
 			     bdev_io->internal.caller_ctx);
 }
 
+static void
+bdev_mgmt_channel_flush_completions(void *ctx)
+{
+	struct spdk_bdev_mgmt_channel *mgmt_ch = ctx;
+	struct spdk_bdev_io *bdev_io, *next, *head = NULL;
+
+	bdev_io = __atomic_exchange_n(&mgmt_ch->pending_completions, NULL, __ATOMIC_ACQUIRE);
+	assert(bdev_io != NULL);
+
+	/* The chain was built in LIFO order, reverse it to keep the completion order. */
+	while (bdev_io != NULL) {
+		next = STAILQ_NEXT(bdev_io, internal.buf_link);
+		STAILQ_NEXT(bdev_io, internal.buf_link) = head;
+		head = bdev_io;
+		bdev_io = next;
+	}
+
+	/* mgmt_ch must not be accessed from now on, as completing the last I/O may release it. */
+	while (head != NULL) {
+		bdev_io = head;
+		head = STAILQ_NEXT(bdev_io, internal.buf_link);
+		STAILQ_NEXT(bdev_io, internal.buf_link) = NULL;
+
+		if (bdev_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING) {
+			/* Completion handed over by spdk_bdev_io_complete_remote() */
+			spdk_bdev_io_complete(bdev_io, bdev_io->internal.remote_status);
+		} else {
+			bdev_io_complete(bdev_io);
+		}
+	}
+}
+
+/*
+ * Queue a completion to be delivered on the thread the I/O was submitted on.  This
+ * can be called from any thread.  Only the caller that finds the chain empty sends
+ * a message, so the cost of a message is shared by all completions queued before it
+ * is delivered.  The queued I/O keeps its channel, and with it the mgmt_ch, alive
+ * until the message is handled.
+ */
+static void
+bdev_io_defer_completion(struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev_mgmt_channel *mgmt_ch = bdev_io->internal.ch->shared_resource->mgmt_ch;
+	struct spdk_thread *thread = spdk_bdev_io_get_thread(bdev_io);
+	struct spdk_bdev_io *head;
+
+	head = __atomic_load_n(&mgmt_ch->pending_completions, __ATOMIC_RELAXED);
+	do {
+		STAILQ_NEXT(bdev_io, internal.buf_link) = head;
+	} while (!__atomic_compare_exchange_n(&mgmt_ch->pending_completions, &head, bdev_io,
+					      true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	if (head == NULL) {
+		spdk_thread_send_msg(thread, bdev_mgmt_channel_flush_completions, mgmt_ch);
+	}
+}
+
 static inline void
 bdev_io_complete(void *ctx)
 {
@@ -7717,17 +8989,25 @@ bdev_io_complete(void *ctx)
 		 * Defer completion to avoid potential infinite recursion if the
 		 * user's completion callback issues a new I/O.
 		 */
-		spdk_thread_send_msg(spdk_bdev_io_get_thread(bdev_io),
-				     bdev_io_complete, bdev_io);
+		bdev_io_defer_completion(bdev_io);
+		return;
+	}
+
+	if (spdk_unlikely(bdev_io->internal.f.coalesced)) {
+		bdev_coalesce_io_done(bdev_io);
 		return;
 	}
 
+	if (spdk_unlikely(bdev_io->internal.f.translated)) {
+		bdev_io_release_translation(bdev_io);
+	}
+
 	tsc = spdk_get_ticks();
 	tsc_diff = tsc - bdev_io->internal.submit_tsc;
 
 	bdev_ch_remove_from_io_submitted(bdev_io);
-	spdk_trace_record_tsc(tsc, TRACE_BDEV_IO_DONE, bdev_ch->trace_id, 0, (uintptr_t)bdev_io,
-			      bdev_io->internal.caller_ctx, bdev_ch->queue_depth);
+	bdev_io_trace_record_tsc(bdev_io, tsc, TRACE_BDEV_IO_DONE, bdev_ch->trace_id, 0,
+				 (uintptr_t)bdev_io, bdev_io->internal.caller_ctx, bdev_ch->queue_depth);
 
 	if (bdev_ch->histogram) {
 		if (bdev_io->bdev->internal.histogram_io_type == 0 ||
@@ -7739,6 +9019,10 @@ bdev_io_complete(void *ctx)
 		}
 	}
 
+	if (spdk_unlikely(bdev_ch->heatmap != NULL)) {
+		bdev_heatmap_tally(bdev_ch->heatmap, bdev_io, tsc_diff);
+	}
+
 	bdev_io_update_io_stat(bdev_io, tsc_diff);
 	_bdev_io_complete(bdev_io);
 }
@@ -7879,6 +9163,21 @@ spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status sta
 	bdev_io_complete(bdev_io);
 }
 
+void
+spdk_bdev_io_complete_remote(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	if (spdk_unlikely(bdev_io->internal.status != SPDK_BDEV_IO_STATUS_PENDING)) {
+		SPDK_ERRLOG("Unexpected completion on IO from %s module, status was %s\n",
+			    spdk_bdev_get_module_name(bdev_io->bdev),
+			    bdev_io_status_get_string(bdev_io->internal.status));
+		assert(false);
+	}
+
+	assert(status != SPDK_BDEV_IO_STATUS_PENDING);
+	bdev_io->internal.remote_status = status;
+	bdev_io_defer_completion(bdev_io);
+}
+
 void
 spdk_bdev_io_complete_scsi_status(struct spdk_bdev_io *bdev_io, enum spdk_scsi_status sc,
 				  enum spdk_scsi_sense sk, uint8_t asc, uint8_t ascq)
@@ -8103,6 +9402,76 @@ spdk_bdev_io_complete_base_io_status(struct spdk_bdev_io *bdev_io,
 	}
 }
 
+int
+spdk_bdev_io_redirect(struct spdk_bdev_io *bdev_io, struct spdk_bdev_desc *desc,
+		      struct spdk_io_channel *ch, uint64_t offset_blocks)
+{
+	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(desc);
+	struct spdk_bdev_channel *channel = __io_ch_to_bdev_ch(ch);
+	struct spdk_bdev_channel *orig_ch = bdev_io->internal.ch;
+	uint64_t orig_offset_blocks = bdev_io->u.bdev.offset_blocks;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		if (spdk_unlikely(!desc->write)) {
+			return -EBADF;
+		}
+	/* fallthrough */
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	if (spdk_unlikely(!bdev_io_valid_blocks(bdev, offset_blocks, bdev_io->u.bdev.num_blocks))) {
+		return -EINVAL;
+	}
+
+	/* The I/O must reach the base bdev module as it is, without any of the work the bdev
+	 * layer does on behalf of modules, as that was already done for the original bdev.
+	 */
+	if (bdev_io->internal.f.split || bdev_io->internal.f.has_bounce_buf ||
+	    bdev_io_use_memory_domain(bdev_io) || bdev_io_use_accel_sequence(bdev_io) ||
+	    bdev_io_needs_metadata(desc, bdev_io) || !bdev_io_type_supported(bdev, bdev_io->type)) {
+		return -ENOTSUP;
+	}
+
+	/* A bdev_io from the small pool can't hold the I/O context of every base bdev module */
+	if (orig_ch->io_cache->pool != channel->io_cache->pool &&
+	    orig_ch->io_cache->pool == g_bdev_mgr.small_bdev_io_pool) {
+		return -ENOTSUP;
+	}
+
+	bdev_io->bdev = bdev;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	if (bdev_io_should_split(bdev_io)) {
+		bdev_io->bdev = orig_ch->bdev;
+		bdev_io->u.bdev.offset_blocks = orig_offset_blocks;
+		return -ENOTSUP;
+	}
+
+	bdev_io->internal.redirect.ch = orig_ch;
+	bdev_io->internal.redirect.desc = bdev_io->internal.desc;
+	bdev_io->internal.redirect.offset_blocks = orig_offset_blocks;
+	bdev_io->internal.redirect.submit_tsc = bdev_io->internal.submit_tsc;
+	bdev_io->internal.f.redirected = true;
+
+	/* The I/O is on the io_submitted list of the base bdev channel until it completes, but
+	 * it keeps counting towards the queue depth of the original channel.
+	 */
+	TAILQ_REMOVE(&orig_ch->io_submitted, bdev_io, internal.ch_link);
+
+	bdev_io->internal.ch = channel;
+	bdev_io->internal.desc = desc;
+	bdev_io->internal.error.nvme.cdw0 = 0;
+	bdev_io_submit(bdev_io);
+
+	return 0;
+}
+
 struct spdk_thread *
 spdk_bdev_io_get_thread(struct spdk_bdev_io *bdev_io)
 {
@@ -8269,6 +9638,7 @@ bdev_destroy_cb(void *io_device)
 	spdk_spin_destroy(&bdev->internal.spinlock);
 	free(bdev->internal.qos);
 	bdev_free_io_stat(bdev->internal.stat);
+	free(bdev->internal.heatmap);
 	spdk_trace_unregister_owner(bdev->internal.trace_id);
 
 	rc = bdev->fn_table->destruct(bdev->ctxt);
@@ -9851,6 +11221,97 @@ bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits)
 	}
 }
 
+static int
+bdev_qos_class_limit_to_per_sec(enum spdk_bdev_qos_rate_limit_type type, uint64_t limit,
+				uint64_t *limit_per_sec)
+{
+	if (bdev_qos_is_iops_rate_limit(type) == true) {
+		*limit_per_sec = limit;
+		return 0;
+	}
+
+	if (limit > SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC) {
+		return -EINVAL;
+	}
+
+	/* Change from megabyte to byte rate limit */
+	*limit_per_sec = limit * 1024 * 1024;
+	return 0;
+}
+
+int
+spdk_bdev_desc_set_qos_class(struct spdk_bdev_desc *desc, uint32_t weight,
+			     const uint64_t *min_limits, const uint64_t *max_limits)
+{
+	struct spdk_bdev *bdev = desc->bdev;
+	uint64_t min[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES] = {};
+	uint64_t max[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES] = {};
+	struct bdev_desc_qos_limit *desc_limit;
+	uint32_t max_per_timeslice, min_per_timeslice;
+	bool classified = weight != 0;
+	int i, rc;
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (min_limits != NULL && min_limits[i] != 0) {
+			rc = bdev_qos_class_limit_to_per_sec(i, min_limits[i], &min[i]);
+			if (rc != 0) {
+				SPDK_ERRLOG("Invalid minimum %s limit %" PRIu64 "\n",
+					    qos_rpc_type[i], min_limits[i]);
+				return rc;
+			}
+			classified = true;
+		}
+
+		if (max_limits != NULL && max_limits[i] != 0) {
+			rc = bdev_qos_class_limit_to_per_sec(i, max_limits[i], &max[i]);
+			if (rc != 0) {
+				SPDK_ERRLOG("Invalid maximum %s limit %" PRIu64 "\n",
+					    qos_rpc_type[i], max_limits[i]);
+				return rc;
+			}
+			classified = true;
+		}
+
+		if (min[i] != 0 && max[i] != 0 && min[i] > max[i]) {
+			SPDK_ERRLOG("Minimum %s limit %" PRIu64 " exceeds the maximum %" PRIu64 "\n",
+				    qos_rpc_type[i], min_limits[i], max_limits[i]);
+			return -EINVAL;
+		}
+	}
+
+	if (classified && weight == 0) {
+		weight = SPDK_BDEV_QOS_DEFAULT_WEIGHT;
+	}
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	desc->qos.weight = weight;
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		desc_limit = &desc->qos.limits[i];
+		desc_limit->min = min[i];
+		desc_limit->max = max[i];
+
+		max_per_timeslice = 0;
+		if (max[i] != 0) {
+			min_per_timeslice = bdev_qos_is_iops_rate_limit(i) ?
+					    SPDK_BDEV_QOS_MIN_IO_PER_TIMESLICE :
+					    SPDK_BDEV_QOS_MIN_BYTE_PER_TIMESLICE;
+			max_per_timeslice = spdk_max(max[i] * SPDK_BDEV_QOS_TIMESLICE_IN_USEC /
+						     SPDK_SEC_TO_USEC, min_per_timeslice);
+		}
+		desc_limit->max_per_timeslice = max_per_timeslice;
+		__atomic_store_n(&desc_limit->max_remaining, max_per_timeslice, __ATOMIC_RELAXED);
+	}
+
+	/* Start tracking the activity of the descriptors right away, the QoS poller
+	 * updates the mode and the shares at the start of the next timeslice. */
+	if (weight != 0 && bdev->internal.qos != NULL) {
+		__atomic_store_n(&bdev->internal.qos->fair_share, true, __ATOMIC_RELAXED);
+	}
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	return 0;
+}
+
 void
 spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 			      void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
@@ -9964,6 +11425,68 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 	spdk_spin_unlock(&bdev->internal.spinlock);
 }
 
+struct spdk_bdev_coalesce_ctx {
+	void (*cb_fn)(void *cb_arg, int status);
+	void *cb_arg;
+};
+
+static void
+bdev_set_coalescing_done(struct spdk_bdev *bdev, void *_ctx, int status)
+{
+	struct spdk_bdev_coalesce_ctx *ctx = _ctx;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	bdev->internal.coalesce_in_progress = false;
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	ctx->cb_fn(ctx->cb_arg, status);
+	free(ctx);
+}
+
+static void
+bdev_set_coalescing_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+			    struct spdk_io_channel *_ch, void *_ctx)
+{
+	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+
+	spdk_bdev_for_each_channel_continue(i, bdev_channel_update_coalescing(ch));
+}
+
+void
+spdk_bdev_set_coalescing(struct spdk_bdev *bdev, uint64_t window_us, uint32_t max_size_kb,
+			 void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	struct spdk_bdev_coalesce_ctx *ctx;
+
+	if (window_us != 0 && (uint64_t)max_size_kb * 1024 < 2 * (uint64_t)bdev->blocklen) {
+		cb_fn(cb_arg, -EINVAL);
+		return;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	if (bdev->internal.coalesce_in_progress) {
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		free(ctx);
+		cb_fn(cb_arg, -EAGAIN);
+		return;
+	}
+	bdev->internal.coalesce_in_progress = true;
+	bdev->internal.coalesce_window_us = window_us;
+	bdev->internal.coalesce_max_size_kb = window_us != 0 ? max_size_kb : 0;
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	spdk_bdev_for_each_channel(bdev, bdev_set_coalescing_channel, ctx, bdev_set_coalescing_done);
+}
+
 struct spdk_bdev_histogram_ctx {
 	spdk_bdev_histogram_status_cb cb_fn;
 	void *cb_arg;
@@ -10190,6 +11713,277 @@ spdk_bdev_channel_get_histogram(struct spdk_io_channel *ch, spdk_bdev_histogram_
 	cb_fn(cb_arg, status, bdev_ch->histogram);
 }
 
+void
+spdk_bdev_heatmap_opts_init(struct spdk_bdev_heatmap_opts *opts, size_t size)
+{
+	if (opts == NULL) {
+		SPDK_ERRLOG("opts should not be NULL\n");
+		assert(opts != NULL);
+		return;
+	}
+	if (size == 0) {
+		SPDK_ERRLOG("size should not be zero\n");
+		assert(size != 0);
+		return;
+	}
+
+	memset(opts, 0, size);
+	opts->size = size;
+
+#define FIELD_OK(field) \
+        offsetof(struct spdk_bdev_heatmap_opts, field) + sizeof(opts->field) <= size
+
+#define SET_FIELD(field, value) \
+        if (FIELD_OK(field)) { \
+                opts->field = value; \
+        } \
+
+	SET_FIELD(num_regions, SPDK_BDEV_HEATMAP_DEFAULT_NUM_REGIONS);
+	SET_FIELD(io_type, 0);
+
+	/* You should not remove this statement, but need to update the assert statement
+	 * if you add a new field, and also add a corresponding SET_FIELD statement */
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_heatmap_opts) == 13, "Incorrect size");
+
+#undef FIELD_OK
+#undef SET_FIELD
+}
+
+struct spdk_bdev_heatmap_ctx {
+	spdk_bdev_heatmap_status_cb cb_fn;
+	void *cb_arg;
+	struct spdk_bdev *bdev;
+	int status;
+};
+
+static void
+bdev_heatmap_disable_channel_cb(struct spdk_bdev *bdev, void *_ctx, int status)
+{
+	struct spdk_bdev_heatmap_ctx *ctx = _ctx;
+	struct spdk_bdev_heatmap *heatmap;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	heatmap = bdev->internal.heatmap;
+	bdev->internal.heatmap = NULL;
+	bdev->internal.heatmap_in_progress = false;
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	free(heatmap);
+	ctx->cb_fn(ctx->cb_arg, ctx->status);
+	free(ctx);
+}
+
+static void
+bdev_heatmap_disable_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+			     struct spdk_io_channel *_ch, void *_ctx)
+{
+	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+
+	free(ch->heatmap);
+	ch->heatmap = NULL;
+
+	spdk_bdev_for_each_channel_continue(i, 0);
+}
+
+static void
+bdev_heatmap_enable_channel_cb(struct spdk_bdev *bdev, void *_ctx, int status)
+{
+	struct spdk_bdev_heatmap_ctx *ctx = _ctx;
+
+	if (status != 0) {
+		ctx->status = status;
+		bdev->internal.heatmap_enabled = false;
+		spdk_bdev_for_each_channel(bdev, bdev_heatmap_disable_channel, ctx,
+					   bdev_heatmap_disable_channel_cb);
+	} else {
+		spdk_spin_lock(&bdev->internal.spinlock);
+		bdev->internal.heatmap_in_progress = false;
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		ctx->cb_fn(ctx->cb_arg, ctx->status);
+		free(ctx);
+	}
+}
+
+static void
+bdev_heatmap_enable_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+			    struct spdk_io_channel *_ch, void *_ctx)
+{
+	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+	int status = 0;
+
+	/* A channel created while enabling the heatmap has already allocated it. */
+	if (ch->heatmap == NULL || ch->heatmap->num_regions != bdev->internal.heatmap_num_regions ||
+	    ch->heatmap->region_size != bdev->internal.heatmap_region_size) {
+		free(ch->heatmap);
+		ch->heatmap = bdev_heatmap_alloc(bdev->internal.heatmap_num_regions,
+						 bdev->internal.heatmap_region_size);
+		if (ch->heatmap == NULL) {
+			status = -ENOMEM;
+		}
+	} else {
+		memset(ch->heatmap->count, 0,
+		       SPDK_BDEV_HEATMAP_NUM_COUNTS(ch->heatmap->num_regions) * sizeof(uint64_t));
+	}
+
+	spdk_bdev_for_each_channel_continue(i, status);
+}
+
+void
+spdk_bdev_heatmap_enable(struct spdk_bdev *bdev, spdk_bdev_heatmap_status_cb cb_fn,
+			 void *cb_arg, bool enable, const struct spdk_bdev_heatmap_opts *_opts)
+{
+	struct spdk_bdev_heatmap_ctx *ctx;
+	struct spdk_bdev_heatmap_opts opts;
+	struct spdk_bdev_heatmap *heatmap = NULL, *old_heatmap;
+	uint64_t region_size = 0;
+	uint32_t num_regions = 0;
+
+	spdk_bdev_heatmap_opts_init(&opts, sizeof(opts));
+	if (_opts != NULL) {
+		memcpy(&opts, _opts, spdk_min(sizeof(opts), _opts->size));
+	}
+
+	if (enable) {
+		if (opts.num_regions == 0 || opts.num_regions > SPDK_BDEV_HEATMAP_MAX_NUM_REGIONS ||
+		    opts.io_type >= SPDK_BDEV_NUM_IO_TYPES) {
+			cb_fn(cb_arg, -EINVAL);
+			return;
+		}
+
+		/* Don't create regions past the end of a bdev smaller than the number of regions. */
+		region_size = spdk_max(spdk_divide_round_up(bdev->blockcnt, opts.num_regions), 1);
+		num_regions = spdk_max(spdk_divide_round_up(bdev->blockcnt, region_size), 1);
+
+		heatmap = bdev_heatmap_alloc(num_regions, region_size);
+		if (heatmap == NULL) {
+			cb_fn(cb_arg, -ENOMEM);
+			return;
+		}
+	}
+
+	ctx = calloc(1, sizeof(struct spdk_bdev_heatmap_ctx));
+	if (ctx == NULL) {
+		free(heatmap);
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->bdev = bdev;
+	ctx->status = 0;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	if (bdev->internal.heatmap_in_progress) {
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		free(heatmap);
+		free(ctx);
+		cb_fn(cb_arg, -EAGAIN);
+		return;
+	}
+
+	bdev->internal.heatmap_in_progress = true;
+	old_heatmap = bdev->internal.heatmap;
+	bdev->internal.heatmap = heatmap;
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	free(old_heatmap);
+
+	if (enable) {
+		bdev->internal.heatmap_io_type = opts.io_type;
+		bdev->internal.heatmap_num_regions = num_regions;
+		bdev->internal.heatmap_region_size = region_size;
+	}
+	bdev->internal.heatmap_enabled = enable;
+
+	if (enable) {
+		/* Allocate heatmap for each channel */
+		spdk_bdev_for_each_channel(bdev, bdev_heatmap_enable_channel, ctx,
+					   bdev_heatmap_enable_channel_cb);
+	} else {
+		spdk_bdev_for_each_channel(bdev, bdev_heatmap_disable_channel, ctx,
+					   bdev_heatmap_disable_channel_cb);
+	}
+}
+
+struct spdk_bdev_heatmap_data_ctx {
+	spdk_bdev_heatmap_data_cb cb_fn;
+	void *cb_arg;
+	/** merged heatmap from all channels */
+	struct spdk_bdev_heatmap *heatmap;
+};
+
+static void
+bdev_heatmap_get_channel_cb(struct spdk_bdev *bdev, void *_ctx, int status)
+{
+	struct spdk_bdev_heatmap_data_ctx *ctx = _ctx;
+
+	ctx->cb_fn(ctx->cb_arg, status, ctx->heatmap);
+	free(ctx->heatmap);
+	free(ctx);
+}
+
+static void
+bdev_heatmap_get_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+			 struct spdk_io_channel *_ch, void *_ctx)
+{
+	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+	struct spdk_bdev_heatmap_data_ctx *ctx = _ctx;
+	int status;
+
+	if (ch->heatmap == NULL) {
+		status = -EFAULT;
+	} else {
+		status = bdev_heatmap_merge(ctx->heatmap, ch->heatmap);
+	}
+
+	spdk_bdev_for_each_channel_continue(i, status);
+}
+
+void
+spdk_bdev_heatmap_get(struct spdk_bdev *bdev, spdk_bdev_heatmap_data_cb cb_fn, void *cb_arg)
+{
+	struct spdk_bdev_heatmap_data_ctx *ctx;
+	int rc = 0;
+
+	if (!bdev->internal.heatmap_enabled) {
+		cb_fn(cb_arg, -EINVAL, NULL);
+		return;
+	}
+
+	ctx = calloc(1, sizeof(struct spdk_bdev_heatmap_data_ctx));
+	if (ctx == NULL) {
+		cb_fn(cb_arg, -ENOMEM, NULL);
+		return;
+	}
+
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	ctx->heatmap = bdev_heatmap_alloc(bdev->internal.heatmap_num_regions,
+					  bdev->internal.heatmap_region_size);
+	if (ctx->heatmap == NULL) {
+		free(ctx);
+		cb_fn(cb_arg, -ENOMEM, NULL);
+		return;
+	}
+
+	/* Start with the counts of the channels which were already deleted. */
+	spdk_spin_lock(&bdev->internal.spinlock);
+	if (bdev->internal.heatmap != NULL) {
+		rc = bdev_heatmap_merge(ctx->heatmap, bdev->internal.heatmap);
+	}
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	if (rc != 0) {
+		bdev_heatmap_get_channel_cb(bdev, ctx, rc);
+		return;
+	}
+
+	spdk_bdev_for_each_channel(bdev, bdev_heatmap_get_channel, ctx,
+				   bdev_heatmap_get_channel_cb);
+}
+
 size_t
 spdk_bdev_get_media_events(struct spdk_bdev_desc *desc, struct spdk_bdev_media_event *events,
 			   size_t max_events)
@@ -10397,7 +12191,7 @@ bdev_lock_lba_range_get_channel(struct spdk_bdev_channel_iter *i, struct spdk_bd
 		 */
 		ctx->owner_range = range;
 	}
-	TAILQ_INSERT_TAIL(&ch->locked_ranges, range, tailq);
+	bdev_ch_insert_locked_range(ch, range);
 	bdev_lock_lba_range_check_io(i);
 }
 
@@ -10532,7 +12326,7 @@ bdev_unlock_lba_range_get_channel(struct spdk_bdev_channel_iter *i, struct spdk_
 		if (ctx->range.offset == range->offset &&
 		    ctx->range.length == range->length &&
 		    ctx->range.locked_ctx == range->locked_ctx) {
-			TAILQ_REMOVE(&ch->locked_ranges, range, tailq);
+			bdev_ch_remove_locked_range(ch, range);
 			free(range);
 			break;
 		}
@@ -29,6 +29,11 @@ static const struct spdk_json_object_decoder rpc_set_bdev_opts_decoders[] = {
 	{"bdev_auto_examine", offsetof(struct spdk_bdev_opts, bdev_auto_examine), spdk_json_decode_bool, true},
 	{"iobuf_small_cache_size", offsetof(struct spdk_bdev_opts, iobuf_small_cache_size), spdk_json_decode_uint32, true},
 	{"iobuf_large_cache_size", offsetof(struct spdk_bdev_opts, iobuf_large_cache_size), spdk_json_decode_uint32, true},
+	{"copy_queue_depth", offsetof(struct spdk_bdev_opts, copy_queue_depth), spdk_json_decode_uint32, true},
+	{"trace_sample_rate", offsetof(struct spdk_bdev_opts, trace_sample_rate), spdk_json_decode_uint32, true},
+	{"bdev_io_small_pool_size", offsetof(struct spdk_bdev_opts, bdev_io_small_pool_size), spdk_json_decode_uint32, true},
+	{"bdev_io_small_ctx_size", offsetof(struct spdk_bdev_opts, bdev_io_small_ctx_size), spdk_json_decode_uint32, true},
+	{"bounce_accel_copy_threshold", offsetof(struct spdk_bdev_opts, bounce_accel_copy_threshold), spdk_json_decode_uint32, true},
 };
 
 static void
@@ -50,6 +55,19 @@ rpc_bdev_set_options(struct spdk_jsonrpc_request *request, const struct spdk_jso
 
 	rc = spdk_bdev_set_opts(&opts);
 	if (rc != 0) {
+		if (opts.copy_queue_depth == 0) {
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+							 "copy_queue_depth must be at least 1");
+			return;
+		}
+		if (opts.bdev_io_small_pool_size != 0) {
+			spdk_jsonrpc_send_error_response_fmt(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+							     "Pool sizes %" PRIu32 " and %" PRIu32
+							     " too small for cache size %" PRIu32,
+							     opts.bdev_io_pool_size, opts.bdev_io_small_pool_size,
+							     opts.bdev_io_cache_size);
+			return;
+		}
 		spdk_jsonrpc_send_error_response_fmt(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
 						     "Pool size %" PRIu32 " too small for cache size %" PRIu32,
 						     opts.bdev_io_pool_size, opts.bdev_io_cache_size);
@@ -1171,3 +1189,263 @@ cleanup:
 }
 
 SPDK_RPC_REGISTER("bdev_get_histogram", rpc_bdev_get_histogram, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_enable_heatmap_request {
+	char *name;
+	bool enable;
+	uint32_t num_regions;
+	char *opc;
+};
+
+static void
+free_rpc_bdev_enable_heatmap_request(struct rpc_bdev_enable_heatmap_request *r)
+{
+	free(r->name);
+	free(r->opc);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_enable_heatmap_request_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_enable_heatmap_request, name), spdk_json_decode_string},
+	{"enable", offsetof(struct rpc_bdev_enable_heatmap_request, enable), spdk_json_decode_bool},
+	{"num_regions", offsetof(struct rpc_bdev_enable_heatmap_request, num_regions), spdk_json_decode_uint32, true},
+	{"opc", offsetof(struct rpc_bdev_enable_heatmap_request, opc), spdk_json_decode_string, true},
+};
+
+static void
+bdev_heatmap_status_cb(void *cb_arg, int status)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (status == 0) {
+		spdk_jsonrpc_send_bool_response(request, true);
+	} else {
+		spdk_jsonrpc_send_error_response(request, status, spdk_strerror(-status));
+	}
+}
+
+static void
+rpc_bdev_enable_heatmap(struct spdk_jsonrpc_request *request,
+			const struct spdk_json_val *params)
+{
+	struct rpc_bdev_enable_heatmap_request req = {
+		.num_regions = SPDK_BDEV_HEATMAP_DEFAULT_NUM_REGIONS,
+	};
+	struct spdk_bdev_heatmap_opts opts;
+	struct spdk_bdev_desc *desc;
+	int io_type;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_enable_heatmap_request_decoders,
+				    SPDK_COUNTOF(rpc_bdev_enable_heatmap_request_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	spdk_bdev_heatmap_opts_init(&opts, sizeof(opts));
+	opts.num_regions = req.num_regions;
+
+	if (req.opc != NULL) {
+		io_type = spdk_bdev_get_io_type(req.opc);
+		if (io_type == -1) {
+			SPDK_ERRLOG("Invalid IO type\n");
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+							 "Invalid IO type");
+			goto cleanup;
+		}
+		opts.io_type = (uint8_t)io_type;
+	}
+
+	rc = spdk_bdev_open_ext(req.name, false, dummy_bdev_event_cb, NULL, &desc);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_bdev_heatmap_enable(spdk_bdev_desc_get_bdev(desc), bdev_heatmap_status_cb,
+				 request, req.enable, &opts);
+
+	spdk_bdev_close(desc);
+
+cleanup:
+	free_rpc_bdev_enable_heatmap_request(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_enable_heatmap", rpc_bdev_enable_heatmap, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_get_heatmap_request {
+	char *name;
+};
+
+static const struct spdk_json_object_decoder rpc_bdev_get_heatmap_request_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_get_heatmap_request, name), spdk_json_decode_string}
+};
+
+static void
+free_rpc_bdev_get_heatmap_request(struct rpc_bdev_get_heatmap_request *r)
+{
+	free(r->name);
+}
+
+static void
+rpc_bdev_write_heatmap_region(struct spdk_json_write_ctx *w, const struct spdk_bdev_heatmap *heatmap,
+			      uint32_t region)
+{
+	uint64_t count, total = 0;
+	uint32_t s, l;
+
+	for (s = 0; s < SPDK_BDEV_HEATMAP_NUM_SIZE_BUCKETS; s++) {
+		for (l = 0; l < SPDK_BDEV_HEATMAP_NUM_LATENCY_BUCKETS; l++) {
+			total += heatmap->count[spdk_bdev_heatmap_get_index(region, s, l)];
+		}
+	}
+
+	/* Only report the regions which saw some I/O. */
+	if (total == 0) {
+		return;
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_uint32(w, "region", region);
+	spdk_json_write_named_uint64(w, "offset_blocks", region * heatmap->region_size);
+	spdk_json_write_named_uint64(w, "io_count", total);
+	spdk_json_write_named_array_begin(w, "buckets");
+	for (s = 0; s < SPDK_BDEV_HEATMAP_NUM_SIZE_BUCKETS; s++) {
+		for (l = 0; l < SPDK_BDEV_HEATMAP_NUM_LATENCY_BUCKETS; l++) {
+			count = heatmap->count[spdk_bdev_heatmap_get_index(region, s, l)];
+			if (count == 0) {
+				continue;
+			}
+			spdk_json_write_object_begin(w);
+			spdk_json_write_named_uint32(w, "size_bucket", s);
+			spdk_json_write_named_uint32(w, "latency_bucket", l);
+			spdk_json_write_named_uint64(w, "count", count);
+			spdk_json_write_object_end(w);
+		}
+	}
+	spdk_json_write_array_end(w);
+	spdk_json_write_object_end(w);
+}
+
+static void
+rpc_bdev_heatmap_data_cb(void *cb_arg, int status, const struct spdk_bdev_heatmap *heatmap)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+	struct spdk_json_write_ctx *w;
+	uint32_t region;
+
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 spdk_strerror(-status));
+		return;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_uint32(w, "num_regions", heatmap->num_regions);
+	spdk_json_write_named_uint64(w, "region_size_blocks", heatmap->region_size);
+	spdk_json_write_named_uint32(w, "num_size_buckets", SPDK_BDEV_HEATMAP_NUM_SIZE_BUCKETS);
+	spdk_json_write_named_uint32(w, "num_latency_buckets", SPDK_BDEV_HEATMAP_NUM_LATENCY_BUCKETS);
+	spdk_json_write_named_array_begin(w, "regions");
+	for (region = 0; region < heatmap->num_regions; region++) {
+		rpc_bdev_write_heatmap_region(w, heatmap, region);
+	}
+	spdk_json_write_array_end(w);
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(request, w);
+}
+
+static void
+rpc_bdev_get_heatmap(struct spdk_jsonrpc_request *request,
+		     const struct spdk_json_val *params)
+{
+	struct rpc_bdev_get_heatmap_request req = {NULL};
+	struct spdk_bdev_desc *desc;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_get_heatmap_request_decoders,
+				    SPDK_COUNTOF(rpc_bdev_get_heatmap_request_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_open_ext(req.name, false, dummy_bdev_event_cb, NULL, &desc);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_bdev_heatmap_get(spdk_bdev_desc_get_bdev(desc), rpc_bdev_heatmap_data_cb, request);
+
+	spdk_bdev_close(desc);
+
+cleanup:
+	free_rpc_bdev_get_heatmap_request(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_get_heatmap", rpc_bdev_get_heatmap, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_set_coalescing_request {
+	char *name;
+	uint64_t window_us;
+	uint32_t max_size_kb;
+};
+
+static const struct spdk_json_object_decoder rpc_bdev_set_coalescing_request_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_set_coalescing_request, name), spdk_json_decode_string},
+	{"window_us", offsetof(struct rpc_bdev_set_coalescing_request, window_us), spdk_json_decode_uint64},
+	{"max_size_kb", offsetof(struct rpc_bdev_set_coalescing_request, max_size_kb), spdk_json_decode_uint32, true},
+};
+
+static void
+rpc_bdev_set_coalescing_cb(void *cb_arg, int status)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (status == 0) {
+		spdk_jsonrpc_send_bool_response(request, true);
+	} else {
+		spdk_jsonrpc_send_error_response(request, status, spdk_strerror(-status));
+	}
+}
+
+static void
+rpc_bdev_set_coalescing(struct spdk_jsonrpc_request *request,
+			const struct spdk_json_val *params)
+{
+	struct rpc_bdev_set_coalescing_request req = {
+		.max_size_kb = 128,
+	};
+	struct spdk_bdev_desc *desc;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_set_coalescing_request_decoders,
+				    SPDK_COUNTOF(rpc_bdev_set_coalescing_request_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_open_ext(req.name, false, dummy_bdev_event_cb, NULL, &desc);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_bdev_set_coalescing(spdk_bdev_desc_get_bdev(desc), req.window_us, req.max_size_kb,
+				 rpc_bdev_set_coalescing_cb, request);
+
+	spdk_bdev_close(desc);
+
+cleanup:
+	free(req.name);
+}
+
+SPDK_RPC_REGISTER("bdev_set_coalescing", rpc_bdev_set_coalescing, SPDK_RPC_RUNTIME)
@@ -287,6 +287,27 @@ bdev_part_init_ext_io_opts(struct spdk_bdev_io *bdev_io, struct spdk_bdev_ext_io
 	opts->dif_check_flags_exclude_mask = ~bdev_io->u.bdev.dif_check_flags;
 }
 
+static inline bool
+bdev_part_io_can_redirect(struct spdk_bdev_part *part, struct spdk_bdev_io *bdev_io)
+{
+	if (!part->internal.redirect_io) {
+		return false;
+	}
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		/* The reference tags have to be remapped in the data */
+		return !(bdev_io->u.bdev.dif_check_flags & SPDK_DIF_FLAGS_REFTAG_CHECK);
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		return true;
+	default:
+		return false;
+	}
+}
+
 int
 spdk_bdev_part_submit_request_ext(struct spdk_bdev_part_channel *ch, struct spdk_bdev_io *bdev_io,
 				  spdk_bdev_io_completion_cb cb)
@@ -298,14 +319,21 @@ spdk_bdev_part_submit_request_ext(struct spdk_bdev_part_channel *ch, struct spdk
 	uint64_t offset, remapped_offset, remapped_src_offset;
 	int rc = 0;
 
+	offset = bdev_io->u.bdev.offset_blocks;
+	remapped_offset = offset + part->internal.offset_blocks;
+
+	if (cb == NULL && bdev_part_io_can_redirect(part, bdev_io)) {
+		rc = spdk_bdev_io_redirect(bdev_io, base_desc, base_ch, remapped_offset);
+		if (rc != -ENOTSUP) {
+			return rc;
+		}
+	}
+
 	if (cb != NULL) {
 		bdev_io->internal.f.split = true;
 		bdev_io->internal.split.stored_user_cb = cb;
 	}
 
-	offset = bdev_io->u.bdev.offset_blocks;
-	remapped_offset = offset + part->internal.offset_blocks;
-
 	/* Modify the I/O to adjust for the offset within the base bdev. */
 	switch (bdev_io->type) {
 	case SPDK_BDEV_IO_TYPE_READ:
@@ -545,10 +573,11 @@ part_construct_opts_copy(const struct spdk_bdev_part_construct_opts *src,
         } \
 
 	SET_FIELD(uuid);
+	SET_FIELD(redirect_io);
 
 	/* You should not remove this statement, but need to update the assert statement
 	 * if you add a new field, and also add a corresponding SET_FIELD statement */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_part_construct_opts) == 24, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_part_construct_opts) == 32, "Incorrect size");
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -573,6 +602,7 @@ spdk_bdev_part_construct_ext(struct spdk_bdev_part *part, struct spdk_bdev_part_
 	part->internal.bdev.blocklen = base->bdev->blocklen;
 	part->internal.bdev.blockcnt = num_blocks;
 	part->internal.offset_blocks = offset_blocks;
+	part->internal.redirect_io = opts.redirect_io;
 
 	part->internal.bdev.write_cache = base->bdev->write_cache;
 	part->internal.bdev.required_alignment = base->bdev->required_alignment;
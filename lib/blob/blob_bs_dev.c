@@ -247,6 +247,16 @@ blob_bs_is_degraded(struct spdk_bs_dev *dev)
 	return spdk_blob_is_degraded(b->blob);
 }
 
+struct spdk_blob *
+bs_blob_bs_dev_get_blob(struct spdk_bs_dev *bs_dev)
+{
+	if (bs_dev == NULL || bs_dev->destroy != blob_bs_dev_destroy) {
+		return NULL;
+	}
+
+	return ((struct spdk_blob_bs_dev *)bs_dev)->blob;
+}
+
 struct spdk_bs_dev *
 bs_create_blob_bs_dev(struct spdk_blob *blob)
 {
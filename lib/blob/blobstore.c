@@ -26,14 +26,23 @@
 
 #define BLOB_CRC32C_INITIAL    0xffffffffUL
 
+/* Number of md pages read at once when the metadata region is scanned during recovery */
+#define BS_LOAD_REPLAY_READAHEAD_PAGES 256
+
+/* Number of extent pages read at once when a blob is loaded */
+#define BLOB_LOAD_EXTENT_PAGES_BATCH 32
+
+/* Initial and maximum number of buckets of the open blobs hash table */
+#define BS_OPEN_BLOBS_MIN_BUCKETS 64
+#define BS_OPEN_BLOBS_MAX_BUCKETS (1u << 20)
+
 static int bs_register_md_thread(struct spdk_blob_store *bs);
 static int bs_unregister_md_thread(struct spdk_blob_store *bs);
 static void blob_close_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno);
 static void blob_insert_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
-		uint64_t cluster, uint32_t extent, struct spdk_blob_md_page *page,
-		spdk_blob_op_complete cb_fn, void *cb_arg);
+		uint64_t cluster, uint32_t extent, spdk_blob_op_complete cb_fn, void *cb_arg);
 static void blob_free_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
-		uint32_t extent_page, struct spdk_blob_md_page *page, spdk_blob_op_complete cb_fn, void *cb_arg);
+		uint32_t extent_page, spdk_blob_op_complete cb_fn, void *cb_arg);
 
 static int blob_set_xattr(struct spdk_blob *blob, const char *name, const void *value,
 			  uint16_t value_len, bool internal);
@@ -42,8 +51,9 @@ static int blob_get_xattr_value(struct spdk_blob *blob, const char *name,
 static int blob_remove_xattr(struct spdk_blob *blob, const char *name, bool internal);
 
 static void blob_write_extent_page(struct spdk_blob *blob, uint32_t extent, uint64_t cluster_num,
-				   struct spdk_blob_md_page *page, spdk_blob_op_complete cb_fn, void *cb_arg);
+				   spdk_blob_op_complete cb_fn, void *cb_arg);
 static void blob_freeze_io(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_arg);
+static void bs_channel_submit_write_batch(struct spdk_bs_channel *ch);
 
 static void bs_shallow_copy_cluster_find_next(void *cb_arg);
 
@@ -73,14 +83,63 @@ blob_is_esnap_clone(const struct spdk_blob *blob)
 	return !!(blob->invalid_flags & SPDK_BLOB_EXTERNAL_SNAPSHOT);
 }
 
-static int
-blob_id_cmp(struct spdk_blob *blob1, struct spdk_blob *blob2)
+static inline uint32_t
+bs_open_blobs_bucket(uint32_t num_buckets, spdk_blob_id blobid)
+{
+	/* Blob ids are allocated densely from the md pages, so the md page alone spreads
+	 * them evenly across the buckets. */
+	return bs_blobid_to_page(blobid) & (num_buckets - 1);
+}
+
+static void
+bs_open_blobs_grow(struct spdk_blob_store *bs)
+{
+	struct spdk_blob_hash_bucket *buckets;
+	struct spdk_blob *blob;
+	uint32_t num_buckets = bs->num_open_blob_buckets * 2;
+	uint32_t i;
+
+	buckets = calloc(num_buckets, sizeof(*buckets));
+	if (!buckets) {
+		/* Lookups still work, the chains just get longer */
+		return;
+	}
+
+	for (i = 0; i < bs->num_open_blob_buckets; i++) {
+		while ((blob = LIST_FIRST(&bs->open_blobs[i])) != NULL) {
+			LIST_REMOVE(blob, link);
+			LIST_INSERT_HEAD(&buckets[bs_open_blobs_bucket(num_buckets, blob->id)], blob, link);
+		}
+	}
+
+	free(bs->open_blobs);
+	bs->open_blobs = buckets;
+	bs->num_open_blob_buckets = num_buckets;
+}
+
+static void
+bs_open_blobs_insert(struct spdk_blob_store *bs, struct spdk_blob *blob)
 {
-	assert(blob1 != NULL && blob2 != NULL);
-	return (blob1->id < blob2->id ? -1 : blob1->id > blob2->id);
+	if (bs->num_open_blobs >= bs->num_open_blob_buckets &&
+	    bs->num_open_blob_buckets < BS_OPEN_BLOBS_MAX_BUCKETS) {
+		bs_open_blobs_grow(bs);
+	}
+
+	LIST_INSERT_HEAD(&bs->open_blobs[bs_open_blobs_bucket(bs->num_open_blob_buckets, blob->id)],
+			 blob, link);
+	bs->num_open_blobs++;
+	spdk_bit_array_set(bs->open_blobids, blob->id);
 }
 
-RB_GENERATE_STATIC(spdk_blob_tree, spdk_blob, link, blob_id_cmp);
+static void
+bs_open_blobs_remove(struct spdk_blob_store *bs, struct spdk_blob *blob)
+{
+	assert(bs->num_open_blobs > 0);
+
+	spdk_bit_array_clear(bs->open_blobids, blob->id);
+	LIST_REMOVE(blob, link);
+	bs->num_open_blobs--;
+}
 
 static void
 blob_verify_md_op(struct spdk_blob *blob)
@@ -219,6 +278,167 @@ bs_allocate_cluster(struct spdk_blob *blob, uint32_t cluster_num,
 	return 0;
 }
 
+/* Channels only reserve clusters while the blobstore has plenty of free space left, so that
+ * the clusters parked on idle channels can't make the allocations on the other ones fail. */
+static inline bool
+bs_can_reserve_clusters(struct spdk_blob_store *bs)
+{
+	return bs->num_free_clusters > spdk_max(bs->total_data_clusters / 32,
+						4 * SPDK_BS_CHANNEL_RESERVED_CLUSTERS);
+}
+
+static void
+bs_channel_reserve_clusters(struct spdk_bs_channel *ch)
+{
+	struct spdk_blob_store *bs = ch->bs;
+	uint32_t cluster_num;
+
+	assert(ch->next_reserved_cluster == ch->num_reserved_clusters);
+
+	ch->num_reserved_clusters = 0;
+	ch->next_reserved_cluster = 0;
+
+	spdk_spin_lock(&bs->used_lock);
+	while (ch->num_reserved_clusters < SPDK_BS_CHANNEL_RESERVED_CLUSTERS &&
+	       bs_can_reserve_clusters(bs)) {
+		cluster_num = bs_claim_cluster(bs);
+		assert(cluster_num != UINT32_MAX);
+		ch->reserved_clusters[ch->num_reserved_clusters++] = cluster_num;
+	}
+	__atomic_fetch_add(&bs->num_reserved_clusters, ch->num_reserved_clusters, __ATOMIC_RELAXED);
+	spdk_spin_unlock(&bs->used_lock);
+
+	SPDK_DEBUGLOG(blob, "Reserved %" PRIu32 " clusters on channel %p\n",
+		      ch->num_reserved_clusters, ch);
+}
+
+static void
+bs_channel_release_reserved_clusters(struct spdk_bs_channel *ch)
+{
+	struct spdk_blob_store *bs = ch->bs;
+	uint32_t i;
+
+	if (ch->next_reserved_cluster == ch->num_reserved_clusters) {
+		return;
+	}
+
+	spdk_spin_lock(&bs->used_lock);
+	for (i = ch->next_reserved_cluster; i < ch->num_reserved_clusters; i++) {
+		bs_release_cluster(bs, ch->reserved_clusters[i]);
+	}
+	__atomic_fetch_sub(&bs->num_reserved_clusters,
+			   ch->num_reserved_clusters - ch->next_reserved_cluster, __ATOMIC_RELAXED);
+	spdk_spin_unlock(&bs->used_lock);
+
+	ch->num_reserved_clusters = 0;
+	ch->next_reserved_cluster = 0;
+}
+
+static bool
+bs_channel_claim_reserved_cluster(struct spdk_bs_channel *ch, uint64_t *cluster)
+{
+	if (ch->next_reserved_cluster == ch->num_reserved_clusters) {
+		if (!bs_can_reserve_clusters(ch->bs)) {
+			return false;
+		}
+		bs_channel_reserve_clusters(ch);
+		if (ch->num_reserved_clusters == 0) {
+			return false;
+		}
+	} else if (spdk_unlikely(!bs_can_reserve_clusters(ch->bs))) {
+		/* The blobstore is running out of space, hand the clusters back to the pool
+		 * so that they can be allocated from any channel. */
+		bs_channel_release_reserved_clusters(ch);
+		return false;
+	}
+
+	*cluster = ch->reserved_clusters[ch->next_reserved_cluster++];
+	__atomic_fetch_sub(&ch->bs->num_reserved_clusters, 1, __ATOMIC_RELAXED);
+
+	return true;
+}
+
+/*
+ * Allocate a cluster for the first write to a cluster of a thin provisioned blob from the I/O
+ * thread. The cluster is taken from the clusters reserved by the channel whenever possible, so
+ * that used_lock is only taken once per SPDK_BS_CHANNEL_RESERVED_CLUSTERS allocations. Clusters
+ * that also need a new extent page are always allocated from the pool as the md page has to be
+ * claimed under the lock anyway.
+ */
+static int
+bs_channel_allocate_cluster(struct spdk_bs_channel *ch, struct spdk_blob *blob,
+			    uint32_t cluster_num, uint64_t *cluster, uint32_t *lowest_free_md_page)
+{
+	int rc;
+
+	if (!blob->use_extent_table || *bs_cluster_to_extent_page(blob, cluster_num) != 0) {
+		if (bs_channel_claim_reserved_cluster(ch, cluster)) {
+			SPDK_DEBUGLOG(blob, "Claiming reserved cluster %" PRIu64 " for blob 0x%" PRIx64 "\n",
+				      *cluster, blob->id);
+			return 0;
+		}
+	}
+
+	spdk_spin_lock(&blob->bs->used_lock);
+	rc = bs_allocate_cluster(blob, cluster_num, cluster, lowest_free_md_page, false);
+	spdk_spin_unlock(&blob->bs->used_lock);
+
+	return rc;
+}
+
+/* Whether the md thread has to take the clusters reserved by the channels back before it can
+ * allocate num_clusters clusters. Reserved clusters are reported as free, so allocations up to
+ * spdk_bs_free_cluster_count() must not fail because of them. */
+static bool
+bs_reserved_clusters_needed(struct spdk_blob_store *bs, uint64_t num_clusters)
+{
+	return num_clusters > bs->num_free_clusters &&
+	       __atomic_load_n(&bs->num_reserved_clusters, __ATOMIC_RELAXED) != 0;
+}
+
+struct bs_release_reserved_clusters_ctx {
+	spdk_bs_op_complete	cb_fn;
+	void			*cb_arg;
+};
+
+static void
+bs_release_reserved_clusters_iter(struct spdk_io_channel_iter *i)
+{
+	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
+	struct spdk_bs_channel *ch = spdk_io_channel_get_ctx(_ch);
+
+	bs_channel_release_reserved_clusters(ch);
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+bs_release_reserved_clusters_cpl(struct spdk_io_channel_iter *i, int status)
+{
+	struct bs_release_reserved_clusters_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	ctx->cb_fn(ctx->cb_arg, status);
+	free(ctx);
+}
+
+/* Give the clusters reserved by all the channels back to the pool */
+static void
+bs_release_reserved_clusters(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_arg)
+{
+	struct bs_release_reserved_clusters_ctx *ctx;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+	spdk_for_each_channel(bs, bs_release_reserved_clusters_iter, ctx,
+			      bs_release_reserved_clusters_cpl);
+}
+
 static void
 blob_xattrs_init(struct spdk_blob_xattr_opts *xattrs)
 {
@@ -344,9 +564,16 @@ xattrs_free(struct spdk_xattr_tailq *xattrs)
 	}
 }
 
+static void
+bs_invalidate_chain_caches(struct spdk_blob_store *bs)
+{
+	__atomic_fetch_add(&bs->chain_gen, 1, __ATOMIC_RELEASE);
+}
+
 static void
 blob_unref_back_bs_dev(struct spdk_blob *blob)
 {
+	bs_invalidate_chain_caches(blob->bs);
 	blob->back_bs_dev->destroy(blob->back_bs_dev);
 	blob->back_bs_dev = NULL;
 }
@@ -414,6 +641,7 @@ blob_back_bs_destroy(struct spdk_blob *blob)
 	SPDK_DEBUGLOG(blob_esnap, "blob 0x%" PRIx64 ": preparing to destroy back_bs_dev\n",
 		      blob->id);
 
+	bs_invalidate_chain_caches(blob->bs);
 	blob_esnap_destroy_bs_dev_channels(blob, false, blob_back_bs_destroy_esnap_done,
 					   blob->back_bs_dev);
 	blob->back_bs_dev = NULL;
@@ -485,6 +713,14 @@ struct freeze_io_ctx {
 static void
 blob_io_sync(struct spdk_io_channel_iter *i)
 {
+	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
+	struct spdk_bs_channel *ch = spdk_io_channel_get_ctx(_ch);
+
+	/* Writes held back before the freeze reach the device before it completes */
+	if (ch->write_batch != NULL) {
+		bs_channel_submit_write_batch(ch);
+	}
+
 	spdk_for_each_channel_continue(i, 0);
 }
 
@@ -542,7 +778,10 @@ blob_freeze_io(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_arg
 	/* Freeze I/O on blob */
 	blob->frozen_refcnt++;
 
-	spdk_for_each_channel(blob->bs, blob_io_sync, ctx, blob_io_cpl);
+	/* The backing chain is only changed while I/O is frozen */
+	bs_invalidate_chain_caches(blob->bs);
+
+	spdk_for_each_channel_parallel(blob->bs, blob_io_sync, ctx, blob_io_cpl);
 }
 
 static void
@@ -567,7 +806,9 @@ blob_unfreeze_io(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_a
 
 	blob->frozen_refcnt--;
 
-	spdk_for_each_channel(blob->bs, blob_execute_queued_io, ctx, blob_io_cpl);
+	bs_invalidate_chain_caches(blob->bs);
+
+	spdk_for_each_channel_parallel(blob->bs, blob_execute_queued_io, ctx, blob_io_cpl);
 }
 
 static int
@@ -1424,6 +1665,7 @@ struct spdk_blob_load_ctx {
 	struct spdk_blob_md_page	*pages;
 	uint32_t			num_pages;
 	uint32_t			next_extent_page;
+	uint32_t			extent_pages_end;
 	spdk_bs_sequence_t	        *seq;
 
 	spdk_bs_sequence_cpl		cb_fn;
@@ -1572,17 +1814,74 @@ blob_load_backing_dev(spdk_bs_sequence_t *seq, void *cb_arg)
 	blob_load_final(ctx, 0);
 }
 
-static void
-blob_load_cpl_extents_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+static struct spdk_blob_md_page *
+blob_load_extent_page_buf(struct spdk_blob_load_ctx *ctx, uint32_t index)
+{
+	return (struct spdk_blob_md_page *)((uint8_t *)ctx->pages +
+					    (uint64_t)index * ctx->blob->bs->md_page_size);
+}
+
+/* Parse the extent pages of the current window in order, so that the cluster map is still
+ * built sequentially even though the pages were read in parallel. */
+static int
+blob_load_parse_extent_pages(struct spdk_blob_load_ctx *ctx)
 {
-	struct spdk_blob_load_ctx	*ctx = cb_arg;
 	struct spdk_blob		*blob = ctx->blob;
 	struct spdk_blob_md_page	*page;
+	uint32_t			num_pages = 0;
 	uint64_t			i;
-	uint32_t			crc;
-	uint64_t			lba;
 	void				*tmp;
 	uint64_t			sz;
+	int				rc;
+
+	for (i = ctx->next_extent_page; i < ctx->extent_pages_end; i++) {
+		if (blob->active.extent_pages[i] != 0) {
+			page = blob_load_extent_page_buf(ctx, num_pages++);
+			if (blob_md_page_calc_crc(page) != page->crc) {
+				return -EINVAL;
+			}
+
+			if (page->next != SPDK_INVALID_MD_PAGE) {
+				return -EINVAL;
+			}
+
+			rc = blob_parse_extent_page(page, blob);
+			if (rc) {
+				return rc;
+			}
+		} else {
+			/* Thin provisioned blobs can point to unallocated extent pages.
+			 * In this case blob size should be increased by up to the amount left in remaining_clusters_in_et. */
+
+			sz = spdk_min(blob->remaining_clusters_in_et, SPDK_EXTENTS_PER_EP);
+			blob->active.num_clusters += sz;
+			blob->remaining_clusters_in_et -= sz;
+
+			assert(spdk_blob_is_thin_provisioned(blob));
+			assert(i + 1 < blob->active.num_extent_pages || blob->remaining_clusters_in_et == 0);
+
+			tmp = realloc(blob->active.clusters, blob->active.num_clusters * sizeof(*blob->active.clusters));
+			if (tmp == NULL) {
+				return -ENOMEM;
+			}
+			memset(tmp + sizeof(*blob->active.clusters) * blob->active.cluster_array_size, 0,
+			       sizeof(*blob->active.clusters) * (blob->active.num_clusters - blob->active.cluster_array_size));
+			blob->active.clusters = tmp;
+			blob->active.cluster_array_size = blob->active.num_clusters;
+		}
+	}
+
+	ctx->next_extent_page = ctx->extent_pages_end;
+
+	return 0;
+}
+
+static void blob_load_extent_pages(spdk_bs_sequence_t *seq, struct spdk_blob_load_ctx *ctx);
+
+static void
+blob_load_cpl_extents_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_blob_load_ctx	*ctx = cb_arg;
 
 	if (bserrno) {
 		SPDK_ERRLOG("Extent page read failed: %d\n", bserrno);
@@ -1590,70 +1889,71 @@ blob_load_cpl_extents_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 		return;
 	}
 
+	bserrno = blob_load_parse_extent_pages(ctx);
+	if (bserrno) {
+		blob_load_final(ctx, bserrno);
+		return;
+	}
+
+	blob_load_extent_pages(seq, ctx);
+}
+
+/* Read the next window of up to BLOB_LOAD_EXTENT_PAGES_BATCH allocated extent pages at once */
+static void
+blob_load_extent_pages(spdk_bs_sequence_t *seq, struct spdk_blob_load_ctx *ctx)
+{
+	struct spdk_blob		*blob = ctx->blob;
+	struct spdk_blob_store		*bs = blob->bs;
+	spdk_bs_batch_t			*batch;
+	uint32_t			num_reads = 0;
+	uint64_t			i;
+	int				rc;
+
 	if (ctx->pages == NULL) {
-		/* First iteration of this function, allocate buffer for single EXTENT_PAGE */
-		ctx->pages = spdk_zmalloc(blob->bs->md_page_size, 0,
+		ctx->pages = spdk_zmalloc((uint64_t)BLOB_LOAD_EXTENT_PAGES_BATCH * bs->md_page_size, 0,
 					  NULL, SPDK_ENV_NUMA_ID_ANY, SPDK_MALLOC_DMA);
 		if (!ctx->pages) {
 			blob_load_final(ctx, -ENOMEM);
 			return;
 		}
-		ctx->num_pages = 1;
+		ctx->num_pages = BLOB_LOAD_EXTENT_PAGES_BATCH;
 		ctx->next_extent_page = 0;
-	} else {
-		page = &ctx->pages[0];
-		crc = blob_md_page_calc_crc(page);
-		if (crc != page->crc) {
-			blob_load_final(ctx, -EINVAL);
-			return;
-		}
-
-		if (page->next != SPDK_INVALID_MD_PAGE) {
-			blob_load_final(ctx, -EINVAL);
-			return;
-		}
-
-		bserrno = blob_parse_extent_page(page, blob);
-		if (bserrno) {
-			blob_load_final(ctx, bserrno);
-			return;
-		}
 	}
 
 	for (i = ctx->next_extent_page; i < blob->active.num_extent_pages; i++) {
 		if (blob->active.extent_pages[i] != 0) {
-			/* Extent page was allocated, read and parse it. */
-			lba = bs_md_page_to_lba(blob->bs, blob->active.extent_pages[i]);
-			ctx->next_extent_page = i + 1;
+			if (num_reads == BLOB_LOAD_EXTENT_PAGES_BATCH) {
+				break;
+			}
+			num_reads++;
+		}
+	}
+	ctx->extent_pages_end = i;
 
-			bs_sequence_read_dev(seq, &ctx->pages[0], lba,
-					     bs_byte_to_lba(blob->bs, blob->bs->md_page_size),
-					     blob_load_cpl_extents_cpl, ctx);
+	if (num_reads == 0) {
+		/* Only unallocated extent pages are left */
+		rc = blob_load_parse_extent_pages(ctx);
+		if (rc) {
+			blob_load_final(ctx, rc);
 			return;
-		} else {
-			/* Thin provisioned blobs can point to unallocated extent pages.
-			 * In this case blob size should be increased by up to the amount left in remaining_clusters_in_et. */
+		}
 
-			sz = spdk_min(blob->remaining_clusters_in_et, SPDK_EXTENTS_PER_EP);
-			blob->active.num_clusters += sz;
-			blob->remaining_clusters_in_et -= sz;
+		blob_load_backing_dev(seq, ctx);
+		return;
+	}
 
-			assert(spdk_blob_is_thin_provisioned(blob));
-			assert(i + 1 < blob->active.num_extent_pages || blob->remaining_clusters_in_et == 0);
+	batch = bs_sequence_to_batch(seq, blob_load_cpl_extents_cpl, ctx);
 
-			tmp = realloc(blob->active.clusters, blob->active.num_clusters * sizeof(*blob->active.clusters));
-			if (tmp == NULL) {
-				blob_load_final(ctx, -ENOMEM);
-				return;
-			}
-			memset(tmp + sizeof(*blob->active.clusters) * blob->active.cluster_array_size, 0,
-			       sizeof(*blob->active.clusters) * (blob->active.num_clusters - blob->active.cluster_array_size));
-			blob->active.clusters = tmp;
-			blob->active.cluster_array_size = blob->active.num_clusters;
+	num_reads = 0;
+	for (i = ctx->next_extent_page; i < ctx->extent_pages_end; i++) {
+		if (blob->active.extent_pages[i] != 0) {
+			bs_batch_read_dev(batch, blob_load_extent_page_buf(ctx, num_reads++),
+					  bs_md_page_to_lba(bs, blob->active.extent_pages[i]),
+					  bs_byte_to_lba(bs, bs->md_page_size));
 		}
 	}
 
-	blob_load_backing_dev(seq, ctx);
+	bs_batch_close(batch);
 }
 
 static void
@@ -1739,7 +2039,7 @@ blob_load_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	ctx->pages = NULL;
 
 	if (blob->extent_table_found) {
-		blob_load_cpl_extents_cpl(seq, ctx, 0);
+		blob_load_extent_pages(seq, ctx);
 	} else {
 		blob_load_backing_dev(seq, ctx);
 	}
@@ -1818,6 +2118,178 @@ bs_batch_clear_dev(struct spdk_blob *blob, spdk_bs_batch_t *batch, uint64_t lba,
 	}
 }
 
+/*
+ * Background reclamation of freed clusters. Instead of being cleared inline, the clusters
+ * truncated from blobs that clear with unmap stay allocated in used_clusters and are marked in
+ * reclaim_clusters. They are unmapped in the background, in contiguous runs of up to
+ * BS_RECLAIM_MAX_UNMAP_BYTES with at most reclaim_unmap_depth unmaps in flight, and only
+ * released once their unmap completed, so they can't be handed out to a new write in the
+ * meantime. Everything runs on the md thread.
+ */
+#define BS_RECLAIM_MAX_UNMAP_BYTES (1ull << 30)
+
+struct spdk_bs_reclaim_unmap {
+	struct spdk_blob_store	*bs;
+	uint32_t		first_cluster;
+	uint32_t		num_clusters;
+};
+
+static bool
+blob_clears_in_background(struct spdk_blob *blob)
+{
+	return blob->bs->reclaim_unmap_depth != 0 &&
+	       (blob->clear_method == BLOB_CLEAR_WITH_DEFAULT ||
+		blob->clear_method == BLOB_CLEAR_WITH_UNMAP);
+}
+
+static void
+bs_reclaim_release(struct spdk_blob_store *bs, uint32_t first_cluster, uint32_t num_clusters)
+{
+	uint32_t i;
+
+	spdk_spin_lock(&bs->used_lock);
+	for (i = 0; i < num_clusters; i++) {
+		bs_release_cluster(bs, first_cluster + i);
+	}
+	spdk_spin_unlock(&bs->used_lock);
+}
+
+static void
+bs_reclaim_check_idle(struct spdk_blob_store *bs)
+{
+	spdk_bs_op_complete cb_fn = bs->reclaim_idle_cb_fn;
+
+	if (cb_fn == NULL || bs->reclaim_unmaps_in_flight != 0 || bs->num_reclaim_clusters != 0 ||
+	    bs->reclaim_submit_pending) {
+		return;
+	}
+
+	bs->reclaim_idle_cb_fn = NULL;
+	cb_fn(bs->reclaim_idle_cb_arg, 0);
+}
+
+static void bs_reclaim_submit_unmaps(struct spdk_blob_store *bs);
+
+static void
+bs_reclaim_unmap_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_bs_reclaim_unmap	*unmap = cb_arg;
+	struct spdk_blob_store		*bs = unmap->bs;
+
+	if (bserrno != 0) {
+		/* Unmap is only a hint, the clusters are free either way */
+		SPDK_NOTICELOG("Unmap of %" PRIu32 " clusters at cluster %" PRIu32 " failed: %d\n",
+			       unmap->num_clusters, unmap->first_cluster, bserrno);
+	}
+
+	bs_reclaim_release(bs, unmap->first_cluster, unmap->num_clusters);
+	free(unmap);
+
+	bs_sequence_finish(seq, 0);
+
+	assert(bs->reclaim_unmaps_in_flight > 0);
+	bs->reclaim_unmaps_in_flight--;
+
+	bs_reclaim_submit_unmaps(bs);
+}
+
+static void
+bs_reclaim_submit_unmaps(struct spdk_blob_store *bs)
+{
+	struct spdk_bs_reclaim_unmap	*unmap;
+	struct spdk_bs_cpl		cpl;
+	spdk_bs_sequence_t		*seq;
+	spdk_bs_batch_t			*batch;
+	uint32_t			first, count, i, max_clusters;
+
+	max_clusters = spdk_max(1, BS_RECLAIM_MAX_UNMAP_BYTES / bs->cluster_sz);
+	cpl.type = SPDK_BS_CPL_TYPE_NONE;
+
+	while (bs->reclaim_unmaps_in_flight < bs->reclaim_unmap_depth && bs->num_reclaim_clusters != 0) {
+		first = spdk_bit_array_find_first_set(bs->reclaim_clusters, bs->reclaim_cursor);
+		if (first == UINT32_MAX) {
+			first = spdk_bit_array_find_first_set(bs->reclaim_clusters, 0);
+		}
+		assert(first != UINT32_MAX);
+
+		count = 1;
+		while (count < max_clusters && spdk_bit_array_get(bs->reclaim_clusters, first + count)) {
+			count++;
+		}
+
+		for (i = 0; i < count; i++) {
+			spdk_bit_array_clear(bs->reclaim_clusters, first + i);
+		}
+		bs->num_reclaim_clusters -= count;
+		bs->reclaim_cursor = first + count;
+
+		unmap = calloc(1, sizeof(*unmap));
+		seq = unmap != NULL ? bs_sequence_start_bs(bs->md_channel, &cpl) : NULL;
+		if (seq == NULL) {
+			/* Skip the unmap rather than holding on to the clusters */
+			free(unmap);
+			bs_reclaim_release(bs, first, count);
+			continue;
+		}
+
+		unmap->bs = bs;
+		unmap->first_cluster = first;
+		unmap->num_clusters = count;
+		bs->reclaim_unmaps_in_flight++;
+
+		batch = bs_sequence_to_batch(seq, bs_reclaim_unmap_cpl, unmap);
+		bs_batch_unmap_dev(batch, bs_cluster_to_lba(bs, first), bs_cluster_to_lba(bs, count));
+		bs_batch_close(batch);
+	}
+
+	bs_reclaim_check_idle(bs);
+}
+
+static void
+bs_reclaim_submit_msg(void *arg)
+{
+	struct spdk_blob_store *bs = arg;
+
+	bs->reclaim_submit_pending = false;
+	bs_reclaim_submit_unmaps(bs);
+}
+
+static void
+bs_reclaim_schedule(struct spdk_blob_store *bs)
+{
+	if (bs->reclaim_submit_pending || bs->num_reclaim_clusters == 0) {
+		return;
+	}
+
+	/* Let the operation that freed the clusters complete first */
+	bs->reclaim_submit_pending = true;
+	if (spdk_thread_send_msg(bs->md_thread, bs_reclaim_submit_msg, bs) != 0) {
+		bs_reclaim_submit_msg(bs);
+	}
+}
+
+static int
+bs_reclaim_prepare(struct spdk_blob_store *bs)
+{
+	if (bs->reclaim_clusters != NULL &&
+	    spdk_bit_array_capacity(bs->reclaim_clusters) >= bs->total_clusters) {
+		return 0;
+	}
+
+	return spdk_bit_array_resize(&bs->reclaim_clusters, bs->total_clusters);
+}
+
+/* Call cb_fn once all the clusters waiting for reclamation have been unmapped and released */
+static void
+bs_reclaim_wait_idle(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_arg)
+{
+	assert(bs->reclaim_idle_cb_fn == NULL);
+
+	bs->reclaim_idle_cb_fn = cb_fn;
+	bs->reclaim_idle_cb_arg = cb_arg;
+	bs_reclaim_check_idle(bs);
+}
+
 static int
 bs_super_validate(struct spdk_bs_super_block *super, struct spdk_blob_store *bs)
 {
@@ -1983,24 +2455,42 @@ blob_persist_clear_clusters_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserr
 	struct spdk_blob		*blob = ctx->blob;
 	struct spdk_blob_store		*bs = blob->bs;
 	size_t				i;
+	bool				reclaim;
 
 	if (bserrno != 0) {
 		blob_persist_complete(seq, ctx, bserrno);
 		return;
 	}
 
+	reclaim = blob_clears_in_background(blob);
+	if (reclaim && bs_reclaim_prepare(bs) != 0) {
+		/* Release the clusters right away, without unmapping them */
+		reclaim = false;
+	}
+
 	spdk_spin_lock(&bs->used_lock);
 	/* Release all clusters that were truncated */
 	for (i = blob->active.num_clusters; i < blob->active.cluster_array_size; i++) {
 		uint32_t cluster_num = bs_lba_to_cluster(bs, blob->active.clusters[i]);
 
 		/* Nothing to release if it was not allocated */
-		if (blob->active.clusters[i] != 0) {
+		if (blob->active.clusters[i] == 0) {
+			continue;
+		}
+
+		if (reclaim) {
+			/* Released once unmapped in the background */
+			assert(!spdk_bit_array_get(bs->reclaim_clusters, cluster_num));
+			spdk_bit_array_set(bs->reclaim_clusters, cluster_num);
+			bs->num_reclaim_clusters++;
+		} else {
 			bs_release_cluster(bs, cluster_num);
 		}
 	}
 	spdk_spin_unlock(&bs->used_lock);
 
+	bs_reclaim_schedule(bs);
+
 	if (blob->active.num_clusters == 0) {
 		free(blob->active.clusters);
 		blob->active.clusters = NULL;
@@ -2036,6 +2526,12 @@ blob_persist_clear_clusters(spdk_bs_sequence_t *seq, struct spdk_blob_persist_ct
 	 * at the end, but no changes ever occur in the middle of the list.
 	 */
 
+	if (blob_clears_in_background(blob)) {
+		/* The truncated clusters are unmapped later on, see bs_reclaim_submit_unmaps() */
+		blob_persist_clear_clusters_cpl(seq, ctx, 0);
+		return;
+	}
+
 	batch = bs_sequence_to_batch(seq, blob_persist_clear_clusters_cpl, ctx);
 
 	/* Clear all clusters that were truncated */
@@ -2627,13 +3123,15 @@ struct spdk_blob_copy_cluster_ctx {
 	uint64_t new_cluster;
 	uint32_t new_extent_page;
 	spdk_bs_sequence_t *seq;
-	struct spdk_blob_md_page *new_cluster_page;
+
+	/* Completion for copies not done on behalf of a user op */
+	spdk_blob_op_complete cb_fn;
+	void *cb_arg;
 };
 
 struct spdk_blob_free_cluster_ctx {
 	struct spdk_blob *blob;
 	uint64_t page;
-	struct spdk_blob_md_page *md_page;
 	uint64_t cluster_num;
 	uint32_t extent_page;
 	spdk_bs_sequence_t *seq;
@@ -2647,6 +3145,13 @@ blob_allocate_and_copy_cluster_cpl(void *cb_arg, int bserrno)
 	TAILQ_HEAD(, spdk_bs_request_set) requests;
 	spdk_bs_user_op_t *op;
 
+	if (ctx->cb_fn != NULL) {
+		ctx->cb_fn(ctx->cb_arg, bserrno);
+		spdk_free(ctx->buf);
+		free(ctx);
+		return;
+	}
+
 	TAILQ_INIT(&requests);
 	TAILQ_SWAP(&set->channel->need_cluster_alloc, &requests, spdk_bs_request_set, link);
 
@@ -2764,7 +3269,7 @@ blob_write_copy_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	cluster_number = bs_io_unit_to_cluster(ctx->blob->bs, ctx->io_unit);
 
 	blob_insert_cluster_on_md_thread(ctx->blob, cluster_number, ctx->new_cluster,
-					 ctx->new_extent_page, ctx->new_cluster_page, blob_insert_cluster_cpl, ctx);
+					 ctx->new_extent_page, blob_insert_cluster_cpl, ctx);
 }
 
 static void
@@ -2807,10 +3312,14 @@ blob_copy(struct spdk_blob_copy_cluster_ctx *ctx, spdk_bs_user_op_t *op, uint64_
 			     blob_write_copy_cpl, ctx);
 }
 
-static void
-bs_allocate_and_copy_cluster(struct spdk_blob *blob,
-			     struct spdk_io_channel *_ch,
-			     uint64_t io_unit, spdk_bs_user_op_t *op)
+/*
+ * Allocate the cluster holding io_unit and fill it from the backing device. The op, if any,
+ * is queued on need_cluster_alloc and re-executed once done. Otherwise cb_fn is called.
+ */
+static int
+blob_allocate_and_copy_cluster(struct spdk_blob *blob, struct spdk_io_channel *_ch,
+			       uint64_t io_unit, spdk_bs_user_op_t *op,
+			       spdk_blob_op_complete cb_fn, void *cb_arg)
 {
 	struct spdk_bs_cpl cpl;
 	struct spdk_bs_channel *ch;
@@ -2825,14 +3334,6 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 
 	ch = spdk_io_channel_get_ctx(_ch);
 
-	if (!TAILQ_EMPTY(&ch->need_cluster_alloc)) {
-		/* There are already operations pending. Queue this user op
-		 * and return because it will be re-executed when the outstanding
-		 * cluster allocation completes. */
-		TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
-		return;
-	}
-
 	/* Round the io_unit offset down to the first io_unit in the cluster */
 	cluster_start_io_unit = bs_io_unit_to_cluster_start(blob, io_unit);
 
@@ -2842,16 +3343,15 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 
 	ctx = calloc(1, sizeof(*ctx));
 	if (!ctx) {
-		bs_user_op_abort(op, -ENOMEM);
-		return;
+		return -ENOMEM;
 	}
 
 	assert(blob->bs->cluster_sz % blob->back_bs_dev->blocklen == 0);
 
 	ctx->blob = blob;
 	ctx->io_unit = cluster_start_io_unit;
-	ctx->new_cluster_page = ch->new_cluster_page;
-	memset(ctx->new_cluster_page, 0, blob->bs->md_page_size);
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
 
 	/* Check if the cluster that we intend to do CoW for is valid for
 	 * the backing dev. For zeroes backing dev, it'll be always valid.
@@ -2873,55 +3373,221 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 			SPDK_ERRLOG("DMA allocation for cluster of size = %" PRIu32 " failed.\n",
 				    blob->bs->cluster_sz);
 			free(ctx);
-			bs_user_op_abort(op, -ENOMEM);
-			return;
+			return -ENOMEM;
 		}
 	}
 
-	spdk_spin_lock(&blob->bs->used_lock);
-	rc = bs_allocate_cluster(blob, cluster_number, &ctx->new_cluster, &ctx->new_extent_page,
-				 false);
-	spdk_spin_unlock(&blob->bs->used_lock);
+	rc = bs_channel_allocate_cluster(ch, blob, cluster_number, &ctx->new_cluster,
+					 &ctx->new_extent_page);
 	if (rc != 0) {
 		spdk_free(ctx->buf);
 		free(ctx);
-		bs_user_op_abort(op, rc);
+		return rc;
+	}
+
+	cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
+	cpl.u.blob_basic.cb_fn = blob_allocate_and_copy_cluster_cpl;
+	cpl.u.blob_basic.cb_arg = ctx;
+
+	ctx->seq = bs_sequence_start_blob(_ch, &cpl, blob);
+	if (!ctx->seq) {
+		spdk_spin_lock(&blob->bs->used_lock);
+		bs_release_cluster(blob->bs, ctx->new_cluster);
+		spdk_spin_unlock(&blob->bs->used_lock);
+		spdk_free(ctx->buf);
+		free(ctx);
+		return -ENOMEM;
+	}
+
+	if (op != NULL) {
+		/* Queue the user op to block other incoming operations */
+		TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
+	}
+
+	if (blob->parent_id != SPDK_BLOBID_INVALID && !is_zeroes) {
+		if (can_copy) {
+			blob_copy(ctx, op, copy_src_lba);
+		} else {
+			/* Read cluster from backing device */
+			bs_sequence_read_bs_dev(ctx->seq, blob->back_bs_dev, ctx->buf,
+						bs_dev_io_unit_to_lba(blob, blob->back_bs_dev, cluster_start_io_unit),
+						bs_dev_byte_to_lba(blob->back_bs_dev, blob->bs->cluster_sz),
+						blob_write_copy, ctx);
+		}
+
+	} else {
+		blob_insert_cluster_on_md_thread(ctx->blob, cluster_number, ctx->new_cluster,
+						 ctx->new_extent_page, blob_insert_cluster_cpl, ctx);
+	}
+
+	return 0;
+}
+
+static void
+bs_allocate_and_copy_cluster(struct spdk_blob *blob,
+			     struct spdk_io_channel *_ch,
+			     uint64_t io_unit, spdk_bs_user_op_t *op)
+{
+	struct spdk_bs_channel *ch = spdk_io_channel_get_ctx(_ch);
+	int rc;
+
+	if (!TAILQ_EMPTY(&ch->need_cluster_alloc)) {
+		/* There are already operations pending. Queue this user op
+		 * and return because it will be re-executed when the outstanding
+		 * cluster allocation completes. */
+		TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
 		return;
 	}
 
-	cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
-	cpl.u.blob_basic.cb_fn = blob_allocate_and_copy_cluster_cpl;
-	cpl.u.blob_basic.cb_arg = ctx;
+	rc = blob_allocate_and_copy_cluster(blob, _ch, io_unit, op, NULL, NULL);
+	if (rc != 0) {
+		bs_user_op_abort(op, rc);
+	}
+}
+
+/* Copy of a cluster of an esnap clone on first read, shared by the reads of the cluster. */
+struct spdk_blob_esnap_cor {
+	struct spdk_blob		*blob;
+	struct spdk_bs_channel		*channel;
+	uint32_t			cluster;
+	TAILQ_HEAD(, spdk_bs_request_set) reads;
+	TAILQ_ENTRY(spdk_blob_esnap_cor) link;
+};
+
+/*
+ * Take one copy out of the copy-on-read rate of the blob. The blob may be read on any thread,
+ * hence the atomics. Up to a second worth of copies may be done at once after an idle period.
+ */
+static bool
+blob_esnap_cor_rate_allows(struct spdk_blob *blob)
+{
+	uint64_t now = spdk_get_ticks();
+	uint64_t hz = spdk_get_ticks_hz();
+	uint64_t interval, burst, next_tsc, new_next_tsc;
+	uint32_t rate;
+
+	rate = __atomic_load_n(&blob->esnap_cor_rate, __ATOMIC_RELAXED);
+	if (rate == 0) {
+		return false;
+	}
+
+	interval = spdk_max(hz / rate, 1);
+	burst = hz > interval ? hz - interval : 0;
+	next_tsc = __atomic_load_n(&blob->esnap_cor_next_tsc, __ATOMIC_RELAXED);
+	do {
+		if (next_tsc > now + burst) {
+			return false;
+		}
+		new_next_tsc = spdk_max(next_tsc, now) + interval;
+	} while (!__atomic_compare_exchange_n(&blob->esnap_cor_next_tsc, &next_tsc, new_next_tsc,
+					      false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	return true;
+}
+
+static void
+blob_esnap_cor_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_blob_esnap_cor *cor = cb_arg;
+	struct spdk_bs_channel *ch = cor->channel;
+	spdk_bs_user_op_t *op;
+
+	TAILQ_REMOVE(&ch->esnap_cors, cor, link);
+	ch->num_esnap_cors--;
+
+	if (bserrno != 0) {
+		SPDK_DEBUGLOG(blob_esnap, "blob 0x%" PRIx64 ": failed to copy cluster %" PRIu32
+			      " on read: %d\n", cor->blob->id, cor->cluster, bserrno);
+	}
+
+	/* Re-execute the reads. They are served by the copy or, if it failed, by the esnap. */
+	ch->esnap_cor_bypass = bserrno != 0;
+	while ((op = TAILQ_FIRST(&cor->reads)) != NULL) {
+		TAILQ_REMOVE(&cor->reads, op, link);
+		bs_user_op_execute(op);
+	}
+	ch->esnap_cor_bypass = false;
+
+	free(cor);
+}
+
+/*
+ * Get the copy-on-read of the cluster of an esnap clone holding io_unit, starting it if needed.
+ * Returns NULL if the read of io_unit is to be served by the esnap: copy-on-read is disabled, it
+ * is over its rate or the copies already in flight on this channel, or the copy can't start.
+ */
+static struct spdk_blob_esnap_cor *
+blob_esnap_cor_get(struct spdk_blob *blob, struct spdk_io_channel *_ch, uint64_t io_unit)
+{
+	struct spdk_bs_channel *ch = spdk_io_channel_get_ctx(_ch);
+	struct spdk_blob_esnap_cor *cor;
+	uint32_t cluster;
+
+	if (spdk_likely(blob->esnap_cor_rate == 0) || ch->esnap_cor_bypass ||
+	    !blob_is_esnap_clone(blob) || blob->data_ro) {
+		return NULL;
+	}
+
+	cluster = bs_io_unit_to_cluster_number(blob, io_unit);
+	TAILQ_FOREACH(cor, &ch->esnap_cors, link) {
+		if (cor->blob == blob && cor->cluster == cluster) {
+			return cor;
+		}
+	}
+
+	if (ch->num_esnap_cors >= ch->bs->max_cluster_copies || !blob_esnap_cor_rate_allows(blob)) {
+		return NULL;
+	}
+
+	cor = calloc(1, sizeof(*cor));
+	if (cor == NULL) {
+		return NULL;
+	}
+
+	cor->blob = blob;
+	cor->channel = ch;
+	cor->cluster = cluster;
+	TAILQ_INIT(&cor->reads);
 
-	ctx->seq = bs_sequence_start_blob(_ch, &cpl, blob);
-	if (!ctx->seq) {
-		spdk_spin_lock(&blob->bs->used_lock);
-		bs_release_cluster(blob->bs, ctx->new_cluster);
-		spdk_spin_unlock(&blob->bs->used_lock);
-		spdk_free(ctx->buf);
-		free(ctx);
-		bs_user_op_abort(op, -ENOMEM);
-		return;
+	/* A conflicting allocation, e.g. by a write, completes the copy without error */
+	if (blob_allocate_and_copy_cluster(blob, _ch, io_unit, NULL, blob_esnap_cor_cpl, cor) != 0) {
+		free(cor);
+		return NULL;
 	}
 
-	/* Queue the user op to block other incoming operations */
-	TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
+	TAILQ_INSERT_TAIL(&ch->esnap_cors, cor, link);
+	ch->num_esnap_cors++;
 
-	if (blob->parent_id != SPDK_BLOBID_INVALID && !is_zeroes) {
-		if (can_copy) {
-			blob_copy(ctx, op, copy_src_lba);
-		} else {
-			/* Read cluster from backing device */
-			bs_sequence_read_bs_dev(ctx->seq, blob->back_bs_dev, ctx->buf,
-						bs_dev_io_unit_to_lba(blob, blob->back_bs_dev, cluster_start_io_unit),
-						bs_dev_byte_to_lba(blob->back_bs_dev, blob->bs->cluster_sz),
-						blob_write_copy, ctx);
-		}
+	return cor;
+}
 
-	} else {
-		blob_insert_cluster_on_md_thread(ctx->blob, cluster_number, ctx->new_cluster,
-						 ctx->new_extent_page, ctx->new_cluster_page, blob_insert_cluster_cpl, ctx);
+/*
+ * Queue the read on the copy-on-read of its cluster, to be re-executed once the cluster is
+ * copied. Returns false if the read is to be served by the esnap right away.
+ */
+static bool
+blob_esnap_cor_read(struct spdk_blob *blob, struct spdk_io_channel *_ch, struct spdk_bs_cpl *cpl,
+		    enum spdk_blob_op_type op_type, void *payload, int iovcnt, uint64_t offset,
+		    uint64_t length, struct spdk_blob_ext_io_opts *ext_io_opts)
+{
+	struct spdk_blob_esnap_cor *cor;
+	spdk_bs_user_op_t *op;
+
+	cor = blob_esnap_cor_get(blob, _ch, offset);
+	if (cor == NULL) {
+		return false;
+	}
+
+	op = bs_user_op_alloc(_ch, cpl, op_type, blob, payload, iovcnt, offset, length);
+	if (op == NULL) {
+		cpl->u.blob_basic.cb_fn(cpl->u.blob_basic.cb_arg, -ENOMEM);
+		return true;
 	}
+
+	op->ext_io_opts = ext_io_opts;
+	TAILQ_INSERT_TAIL(&cor->reads, op, link);
+
+	return true;
 }
 
 static inline bool
@@ -2941,6 +3607,54 @@ blob_calculate_lba_and_lba_count(struct spdk_blob *blob, uint64_t io_unit, uint6
 	}
 }
 
+/*
+ * Find the blob a read of an unallocated cluster of a clone can be served from directly,
+ * instead of recursing through each snapshot of the chain: the closest ancestor that has
+ * the cluster allocated or, if none does, the last one before the end of the chain.
+ * The result is cached per channel until the backing chain of any blob may have changed.
+ * The I/O has to fit within a single cluster.
+ */
+static struct spdk_blob *
+blob_resolve_backing_blob(struct spdk_blob *blob, struct spdk_io_channel *_ch, uint64_t io_unit)
+{
+	struct spdk_bs_channel		*ch = spdk_io_channel_get_ctx(_ch);
+	struct spdk_bs_chain_cache_entry *entry;
+	struct spdk_blob		*cur, *next;
+	uint64_t			cluster, gen;
+
+	if (bs_blob_bs_dev_get_blob(blob->back_bs_dev) == NULL) {
+		return blob;
+	}
+
+	cluster = bs_io_unit_to_cluster_number(blob, io_unit);
+	gen = __atomic_load_n(&blob->bs->chain_gen, __ATOMIC_ACQUIRE);
+	entry = &ch->chain_cache[(blob->id * 31 + cluster) % SPDK_BS_CHANNEL_CHAIN_CACHE_SIZE];
+	if (entry->blob == blob && entry->cluster == cluster && entry->gen == gen) {
+		return entry->ancestor;
+	}
+
+	cur = blob;
+	while ((next = bs_blob_bs_dev_get_blob(cur->back_bs_dev)) != NULL &&
+	       cluster < next->active.num_clusters) {
+		if (bs_io_unit_is_allocated(next, io_unit)) {
+			cur = next;
+			break;
+		}
+		if (blob_is_esnap_clone(next)) {
+			/* Its back_bs_dev needs the esnap channel of that blob */
+			break;
+		}
+		cur = next;
+	}
+
+	entry->blob = blob;
+	entry->cluster = cluster;
+	entry->ancestor = cur;
+	entry->gen = gen;
+
+	return cur;
+}
+
 struct op_split_ctx {
 	struct spdk_blob *blob;
 	struct spdk_io_channel *channel;
@@ -3110,7 +3824,125 @@ spdk_free_cluster_unmap_complete(void *cb_arg, int bserrno)
 	}
 
 	blob_free_cluster_on_md_thread(ctx->blob, ctx->cluster_num,
-				       ctx->extent_page, ctx->md_page, blob_free_cluster_cpl, ctx);
+				       ctx->extent_page, blob_free_cluster_cpl, ctx);
+}
+
+static void
+bs_write_batch_complete(struct spdk_io_channel *channel, void *cb_arg, int bserrno)
+{
+	struct spdk_bs_write_batch *batch = cb_arg;
+	struct spdk_bs_channel *ch = batch->channel;
+	uint32_t i, num_writes = batch->num_writes;
+	struct spdk_bs_write_batch_cpl writes[SPDK_BS_WRITE_BATCH_MAX_WRITES];
+
+	/* Give the batch back first, so that the writes submitted from the completions
+	 * can be coalesced again */
+	memcpy(writes, batch->writes, num_writes * sizeof(writes[0]));
+	TAILQ_INSERT_HEAD(&ch->write_batches, batch, link);
+
+	for (i = 0; i < num_writes; i++) {
+		writes[i].cb_fn(writes[i].cb_arg, bserrno);
+	}
+}
+
+static void
+bs_channel_submit_write_batch(struct spdk_bs_channel *ch)
+{
+	struct spdk_bs_write_batch *batch = ch->write_batch;
+
+	assert(batch != NULL);
+	ch->write_batch = NULL;
+
+	batch->cb_args.cb_fn = bs_write_batch_complete;
+	batch->cb_args.cb_arg = batch;
+	batch->cb_args.channel = ch->dev_channel;
+
+	ch->dev->writev(ch->dev, ch->dev_channel, batch->iovs, batch->iovcnt, batch->lba,
+			batch->lba_count, &batch->cb_args);
+}
+
+static void
+bs_channel_flush_write_batch(void *ctx)
+{
+	struct spdk_bs_channel *ch = ctx;
+
+	/* The channel can't be destroyed before this runs, as the destruction is also a message
+	 * sent to this thread, after the held writes completed */
+	ch->write_batch_flush_pending = false;
+	if (ch->write_batch != NULL) {
+		bs_channel_submit_write_batch(ch);
+	}
+}
+
+/*
+ * Hold back a write to an allocated cluster continuing the previous write of the channel, so
+ *  that the writes of a sequential stream submitted in the same thread iteration go to the
+ *  device at once. The batches never cross a cluster boundary, nor the optimal I/O boundary of
+ *  the device. Returns false if the write has to be submitted by the caller.
+ */
+static bool
+bs_channel_write_batch_add(struct spdk_bs_channel *ch, struct iovec *iov, int iovcnt,
+			   uint64_t lba, uint64_t lba_count, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_bs_write_batch *batch = ch->write_batch;
+	uint64_t next_lba = ch->write_batch_next_lba;
+	uint64_t chunk_lbas = bs_cluster_to_lba(ch->bs, 1);
+	uint32_t boundary = ch->dev->optimal_io_boundary;
+
+	if (boundary != 0 && boundary < chunk_lbas) {
+		chunk_lbas = boundary;
+	}
+
+	ch->write_batch_next_lba = lba + lba_count;
+
+	if (batch != NULL) {
+		if (lba == batch->lba + batch->lba_count &&
+		    (lba + lba_count - 1) / chunk_lbas == batch->lba / chunk_lbas &&
+		    batch->iovcnt + iovcnt <= SPDK_BS_WRITE_BATCH_MAX_IOVS &&
+		    batch->num_writes < SPDK_BS_WRITE_BATCH_MAX_WRITES) {
+			memcpy(&batch->iovs[batch->iovcnt], iov, iovcnt * sizeof(*iov));
+			batch->iovcnt += iovcnt;
+			batch->lba_count += lba_count;
+			batch->writes[batch->num_writes].cb_fn = cb_fn;
+			batch->writes[batch->num_writes].cb_arg = cb_arg;
+			batch->num_writes++;
+
+			if ((lba + lba_count) % chunk_lbas == 0) {
+				bs_channel_submit_write_batch(ch);
+			}
+			return true;
+		}
+
+		bs_channel_submit_write_batch(ch);
+	}
+
+	/* Random writes, and writes reaching the end of the chunk on their own, go straight
+	 * to the device */
+	if (lba != next_lba || (lba + lba_count) / chunk_lbas != lba / chunk_lbas ||
+	    iovcnt > SPDK_BS_WRITE_BATCH_MAX_IOVS || TAILQ_EMPTY(&ch->write_batches)) {
+		return false;
+	}
+
+	if (!ch->write_batch_flush_pending) {
+		if (spdk_thread_send_msg(spdk_get_thread(), bs_channel_flush_write_batch, ch) != 0) {
+			return false;
+		}
+		ch->write_batch_flush_pending = true;
+	}
+
+	batch = TAILQ_FIRST(&ch->write_batches);
+	TAILQ_REMOVE(&ch->write_batches, batch, link);
+
+	memcpy(batch->iovs, iov, iovcnt * sizeof(*iov));
+	batch->iovcnt = iovcnt;
+	batch->lba = lba;
+	batch->lba_count = lba_count;
+	batch->writes[0].cb_fn = cb_fn;
+	batch->writes[0].cb_arg = cb_arg;
+	batch->num_writes = 1;
+	ch->write_batch = batch;
+
+	return true;
 }
 
 static void
@@ -3150,6 +3982,17 @@ blob_request_submit_op_single(struct spdk_io_channel *_ch, struct spdk_blob *blo
 	switch (op_type) {
 	case SPDK_BLOB_READ: {
 		spdk_bs_batch_t *batch;
+		struct spdk_blob *read_blob = blob;
+
+		if (!is_allocated) {
+			if (blob_esnap_cor_read(blob, _ch, &cpl, op_type, payload, 0, offset, length,
+						NULL)) {
+				return;
+			}
+			read_blob = blob_resolve_backing_blob(blob, _ch, offset);
+			is_allocated = blob_calculate_lba_and_lba_count(read_blob, offset, length,
+					&lba, &lba_count);
+		}
 
 		batch = bs_batch_open(_ch, &cpl, blob);
 		if (!batch) {
@@ -3162,7 +4005,7 @@ blob_request_submit_op_single(struct spdk_io_channel *_ch, struct spdk_blob *blo
 			bs_batch_read_dev(batch, payload, lba, lba_count);
 		} else {
 			/* Read from the backing block device */
-			bs_batch_read_bs_dev(batch, blob->back_bs_dev, payload, lba, lba_count);
+			bs_batch_read_bs_dev(batch, read_blob->back_bs_dev, payload, lba, lba_count);
 		}
 
 		bs_batch_close(batch);
@@ -3179,6 +4022,18 @@ blob_request_submit_op_single(struct spdk_io_channel *_ch, struct spdk_blob *blo
 				return;
 			}
 
+			if (op_type == SPDK_BLOB_WRITE) {
+				struct iovec iov = {
+					.iov_base = payload,
+					.iov_len = lba_count * blob->bs->dev->blocklen,
+				};
+
+				if (bs_channel_write_batch_add(spdk_io_channel_get_ctx(_ch), &iov, 1,
+							       lba, lba_count, cb_fn, cb_arg)) {
+					return;
+				}
+			}
+
 			batch = bs_batch_open(_ch, &cpl, blob);
 			if (!batch) {
 				cb_fn(cb_arg, -ENOMEM);
@@ -3214,7 +4069,6 @@ blob_request_submit_op_single(struct spdk_io_channel *_ch, struct spdk_blob *blo
 		if (spdk_blob_is_thin_provisioned(blob) && is_allocated &&
 		    blob_backed_with_zeroes_dev(blob) &&
 		    bs_io_units_per_cluster(blob) == length) {
-			struct spdk_bs_channel *bs_channel = spdk_io_channel_get_ctx(_ch);
 			uint64_t cluster_start_page;
 			uint32_t cluster_number;
 
@@ -3242,7 +4096,6 @@ blob_request_submit_op_single(struct spdk_io_channel *_ch, struct spdk_blob *blo
 			ctx->blob = blob;
 			ctx->page = cluster_start_page;
 			ctx->cluster_num = cluster_number;
-			ctx->md_page = bs_channel->new_cluster_page;
 			ctx->seq = bs_sequence_start_bs(_ch, &cpl);
 			if (!ctx->seq) {
 				free(ctx);
@@ -3472,6 +4325,17 @@ blob_request_submit_rw_iov(struct spdk_blob *blob, struct spdk_io_channel *_chan
 
 		if (read) {
 			spdk_bs_sequence_t *seq;
+			struct spdk_blob *read_blob = blob;
+
+			if (!is_allocated) {
+				if (blob_esnap_cor_read(blob, _channel, &cpl, SPDK_BLOB_READV, iov, iovcnt,
+							offset, length, ext_io_opts)) {
+					return;
+				}
+				read_blob = blob_resolve_backing_blob(blob, _channel, offset);
+				is_allocated = blob_calculate_lba_and_lba_count(read_blob, offset, length,
+						&lba, &lba_count);
+			}
 
 			seq = bs_sequence_start_blob(_channel, &cpl, blob);
 			if (!seq) {
@@ -3484,13 +4348,19 @@ blob_request_submit_rw_iov(struct spdk_blob *blob, struct spdk_io_channel *_chan
 			if (is_allocated) {
 				bs_sequence_readv_dev(seq, iov, iovcnt, lba, lba_count, rw_iov_done, NULL);
 			} else {
-				bs_sequence_readv_bs_dev(seq, blob->back_bs_dev, iov, iovcnt, lba, lba_count,
+				bs_sequence_readv_bs_dev(seq, read_blob->back_bs_dev, iov, iovcnt, lba, lba_count,
 							 rw_iov_done, NULL);
 			}
 		} else {
 			if (is_allocated) {
 				spdk_bs_sequence_t *seq;
 
+				if ((ext_io_opts == NULL || ext_io_opts->memory_domain == NULL) &&
+				    bs_channel_write_batch_add(spdk_io_channel_get_ctx(_channel), iov, iovcnt,
+							       lba, lba_count, cb_fn, cb_arg)) {
+					return;
+				}
+
 				seq = bs_sequence_start_blob(_channel, &cpl, blob);
 				if (!seq) {
 					cb_fn(cb_arg, -ENOMEM);
@@ -3544,14 +4414,20 @@ blob_request_submit_rw_iov(struct spdk_blob *blob, struct spdk_io_channel *_chan
 static struct spdk_blob *
 blob_lookup(struct spdk_blob_store *bs, spdk_blob_id blobid)
 {
-	struct spdk_blob find;
+	struct spdk_blob *blob;
 
 	if (spdk_bit_array_get(bs->open_blobids, blobid) == 0) {
 		return NULL;
 	}
 
-	find.id = blobid;
-	return RB_FIND(spdk_blob_tree, &bs->open_blobs, &find);
+	LIST_FOREACH(blob, &bs->open_blobs[bs_open_blobs_bucket(bs->num_open_blob_buckets, blobid)],
+		     link) {
+		if (blob->id == blobid) {
+			return blob;
+		}
+	}
+
+	return NULL;
 }
 
 static void
@@ -3615,18 +4491,25 @@ bs_channel_create(void *io_device, void *ctx_buf)
 		return -1;
 	}
 
-	channel->new_cluster_page = spdk_zmalloc(bs->md_page_size, 0, NULL, SPDK_ENV_NUMA_ID_ANY,
-				    SPDK_MALLOC_DMA);
-	if (!channel->new_cluster_page) {
-		SPDK_ERRLOG("Failed to allocate new cluster page\n");
+	TAILQ_INIT(&channel->need_cluster_alloc);
+	TAILQ_INIT(&channel->queued_io);
+	RB_INIT(&channel->esnap_channels);
+	TAILQ_INIT(&channel->esnap_cors);
+
+	channel->write_batch_mem = calloc(SPDK_BS_CHANNEL_WRITE_BATCHES,
+					  sizeof(struct spdk_bs_write_batch));
+	if (!channel->write_batch_mem) {
+		dev->destroy_channel(dev, channel->dev_channel);
 		free(channel->req_mem);
-		channel->dev->destroy_channel(channel->dev, channel->dev_channel);
 		return -1;
 	}
 
-	TAILQ_INIT(&channel->need_cluster_alloc);
-	TAILQ_INIT(&channel->queued_io);
-	RB_INIT(&channel->esnap_channels);
+	TAILQ_INIT(&channel->write_batches);
+	for (i = 0; i < SPDK_BS_CHANNEL_WRITE_BATCHES; i++) {
+		channel->write_batch_mem[i].channel = channel;
+		TAILQ_INSERT_TAIL(&channel->write_batches, &channel->write_batch_mem[i], link);
+	}
+	channel->write_batch_next_lba = UINT64_MAX;
 
 	return 0;
 }
@@ -3649,10 +4532,16 @@ bs_channel_destroy(void *io_device, void *ctx_buf)
 		bs_user_op_abort(op, -EIO);
 	}
 
+	/* Copies on read complete before the reads waiting for them */
+	assert(TAILQ_EMPTY(&channel->esnap_cors));
+	/* Held writes are submitted before the channel can be released */
+	assert(channel->write_batch == NULL);
+
 	blob_esnap_destroy_bs_channel(channel);
+	bs_channel_release_reserved_clusters(channel);
 
+	free(channel->write_batch_mem);
 	free(channel->req_mem);
-	spdk_free(channel->new_cluster_page);
 	channel->dev->destroy_channel(channel->dev, channel->dev_channel);
 }
 
@@ -3660,21 +4549,25 @@ static void
 bs_dev_destroy(void *io_device)
 {
 	struct spdk_blob_store *bs = io_device;
-	struct spdk_blob	*blob, *blob_tmp;
+	struct spdk_blob	*blob;
+	uint32_t		i;
 
 	bs->dev->destroy(bs->dev);
 
-	RB_FOREACH_SAFE(blob, spdk_blob_tree, &bs->open_blobs, blob_tmp) {
-		RB_REMOVE(spdk_blob_tree, &bs->open_blobs, blob);
-		spdk_bit_array_clear(bs->open_blobids, blob->id);
-		blob_free(blob);
+	for (i = 0; i < bs->num_open_blob_buckets; i++) {
+		while ((blob = LIST_FIRST(&bs->open_blobs[i])) != NULL) {
+			bs_open_blobs_remove(bs, blob);
+			blob_free(blob);
+		}
 	}
+	free(bs->open_blobs);
 
 	spdk_spin_destroy(&bs->used_lock);
 
 	spdk_bit_array_free(&bs->open_blobids);
 	spdk_bit_array_free(&bs->used_blobids);
 	spdk_bit_array_free(&bs->used_md_pages);
+	spdk_bit_array_free(&bs->reclaim_clusters);
 	spdk_bit_pool_free(&bs->used_clusters);
 	/*
 	 * If this function is called for any reason except a successful unload,
@@ -3775,6 +4668,9 @@ bs_blob_list_free(struct spdk_blob_store *bs)
 static void
 bs_free(struct spdk_blob_store *bs)
 {
+	assert(TAILQ_EMPTY(&bs->ep_updates));
+	assert(bs->reclaim_unmaps_in_flight == 0);
+
 	bs_blob_list_free(bs);
 
 	bs_unregister_md_thread(bs);
@@ -3821,6 +4717,8 @@ spdk_bs_opts_init(struct spdk_bs_opts *opts, size_t opts_size)
 	SET_FIELD(force_recover, false);
 	SET_FIELD(esnap_bs_dev_create, NULL);
 	SET_FIELD(esnap_ctx, NULL);
+	SET_FIELD(max_cluster_copies, SPDK_BLOB_OPTS_DEFAULT_MAX_CLUSTER_COPIES);
+	SET_FIELD(reclaim_unmap_depth, 0);
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -3830,7 +4728,7 @@ static int
 bs_opts_verify(struct spdk_bs_opts *opts)
 {
 	if (opts->cluster_sz == 0 || opts->num_md_pages == 0 || opts->max_md_ops == 0 ||
-	    opts->max_channel_ops == 0) {
+	    opts->max_channel_ops == 0 || opts->max_cluster_copies == 0) {
 		SPDK_ERRLOG("Blobstore options cannot be set to 0\n");
 		return -1;
 	}
@@ -3858,6 +4756,11 @@ struct spdk_bs_load_ctx {
 	uint32_t			cur_page;
 	struct spdk_blob_md_page	*page;
 
+	/* md pages read ahead while scanning the metadata region during recovery */
+	uint8_t				*md_readahead;
+	uint32_t			md_readahead_start;
+	uint32_t			md_readahead_len;
+
 	uint64_t			num_extent_pages;
 	uint32_t			*extent_page_num;
 	struct spdk_blob_md_page	*extent_pages;
@@ -3941,7 +4844,6 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 		return -ENOMEM;
 	}
 
-	RB_INIT(&bs->open_blobs);
 	TAILQ_INIT(&bs->snapshots);
 	bs->dev = dev;
 	bs->md_page_size = md_page_size;
@@ -3962,11 +4864,23 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 		return -ENOMEM;
 	}
 
+	bs->num_open_blob_buckets = BS_OPEN_BLOBS_MIN_BUCKETS;
+	bs->open_blobs = calloc(bs->num_open_blob_buckets, sizeof(*bs->open_blobs));
+	if (!bs->open_blobs) {
+		spdk_bit_array_free(&ctx->used_clusters);
+		spdk_free(ctx->super);
+		free(ctx);
+		free(bs);
+		return -ENOMEM;
+	}
+
 	bs->num_free_clusters = bs->total_clusters;
 	bs->io_unit_size = dev->blocklen;
 	bs_init_per_cluster_fields(bs);
 
 	bs->max_channel_ops = opts->max_channel_ops;
+	bs->max_cluster_copies = opts->max_cluster_copies;
+	bs->reclaim_unmap_depth = opts->reclaim_unmap_depth;
 	bs->super_blob = SPDK_BLOBID_INVALID;
 	memcpy(&bs->bstype, &opts->bstype, sizeof(opts->bstype));
 	bs->esnap_bs_dev_create = opts->esnap_bs_dev_create;
@@ -3978,6 +4892,7 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 	bs->open_blobids = spdk_bit_array_create(0);
 
 	spdk_spin_init(&bs->used_lock);
+	TAILQ_INIT(&bs->ep_updates);
 
 	spdk_io_device_register(bs, bs_channel_create, bs_channel_destroy,
 				sizeof(struct spdk_bs_channel), "blobstore");
@@ -3989,6 +4904,7 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 		spdk_bit_array_free(&bs->used_blobids);
 		spdk_bit_array_free(&bs->used_md_pages);
 		spdk_bit_array_free(&ctx->used_clusters);
+		free(bs->open_blobs);
 		spdk_free(ctx->super);
 		free(ctx);
 		free(bs);
@@ -4313,6 +5229,7 @@ bs_load_ctx_fail(struct spdk_bs_load_ctx *ctx, int bserrno)
 
 	spdk_free(ctx->mask);
 	spdk_free(ctx->super);
+	spdk_free(ctx->md_readahead);
 	bs_sequence_finish(ctx->seq, bserrno);
 	bs_free(ctx->bs);
 	spdk_bit_array_free(&ctx->used_clusters);
@@ -4752,6 +5669,8 @@ bs_load_replay_md_chain_cpl(struct spdk_bs_load_ctx *ctx)
 		}
 		ctx->bs->num_free_clusters -= num_md_clusters;
 		spdk_free(ctx->page);
+		spdk_free(ctx->md_readahead);
+		ctx->md_readahead = NULL;
 		bs_load_write_used_md(ctx);
 	}
 }
@@ -4865,15 +5784,52 @@ bs_load_replay_md_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	bs_load_replay_md_chain_cpl(ctx);
 }
 
+static void
+bs_load_replay_readahead_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_bs_load_ctx *ctx = cb_arg;
+
+	if (bserrno != 0) {
+		bs_load_ctx_fail(ctx, bserrno);
+		return;
+	}
+
+	bs_load_replay_cur_md_page(ctx);
+}
+
 static void
 bs_load_replay_cur_md_page(struct spdk_bs_load_ctx *ctx)
 {
+	struct spdk_blob_store *bs = ctx->bs;
 	uint64_t lba;
 
 	assert(ctx->cur_page < ctx->super->md_len);
-	lba = bs_md_page_to_lba(ctx->bs, ctx->cur_page);
+
+	if (ctx->md_readahead != NULL && ctx->cur_page >= ctx->md_readahead_start &&
+	    ctx->cur_page - ctx->md_readahead_start < ctx->md_readahead_len) {
+		memcpy(ctx->page, ctx->md_readahead +
+		       (uint64_t)(ctx->cur_page - ctx->md_readahead_start) * bs->md_page_size,
+		       bs->md_page_size);
+		bs_load_replay_md_cpl(ctx->seq, ctx, 0);
+		return;
+	}
+
+	lba = bs_md_page_to_lba(bs, ctx->cur_page);
+
+	/* Pages of a chain may be anywhere in the metadata region, so only the sequential
+	 * scan reads ahead. */
+	if (ctx->md_readahead != NULL && !ctx->in_page_chain) {
+		ctx->md_readahead_start = ctx->cur_page;
+		ctx->md_readahead_len = spdk_min(BS_LOAD_REPLAY_READAHEAD_PAGES,
+						 ctx->super->md_len - ctx->cur_page);
+		bs_sequence_read_dev(ctx->seq, ctx->md_readahead, lba,
+				     bs_byte_to_lba(bs, (uint64_t)ctx->md_readahead_len * bs->md_page_size),
+				     bs_load_replay_readahead_cpl, ctx);
+		return;
+	}
+
 	bs_sequence_read_dev(ctx->seq, ctx->page, lba,
-			     bs_byte_to_lba(ctx->bs, ctx->super->md_page_size),
+			     bs_byte_to_lba(bs, ctx->super->md_page_size),
 			     bs_load_replay_md_cpl, ctx);
 }
 
@@ -4888,6 +5844,13 @@ bs_load_replay_md(struct spdk_bs_load_ctx *ctx)
 		bs_load_ctx_fail(ctx, -ENOMEM);
 		return;
 	}
+
+	/* Reading the metadata region one page at a time makes the recovery of large
+	 * blobstores take very long. If the buffer can't be allocated, fall back to it. */
+	ctx->md_readahead = spdk_zmalloc((uint64_t)BS_LOAD_REPLAY_READAHEAD_PAGES * ctx->bs->md_page_size,
+					 0, NULL, SPDK_ENV_NUMA_ID_ANY, SPDK_MALLOC_DMA);
+	ctx->md_readahead_len = 0;
+
 	bs_load_replay_cur_md_page(ctx);
 }
 
@@ -5023,12 +5986,14 @@ bs_opts_copy(struct spdk_bs_opts *src, struct spdk_bs_opts *dst)
 	SET_FIELD(force_recover);
 	SET_FIELD(esnap_bs_dev_create);
 	SET_FIELD(esnap_ctx);
+	SET_FIELD(max_cluster_copies);
+	SET_FIELD(reclaim_unmap_depth);
 
 	dst->opts_size = src->opts_size;
 
 	/* You should not remove this statement, but need to update the assert statement
 	 * if you add a new field, and also add a corresponding SET_FIELD statement */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 88, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 96, "Incorrect size");
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -5064,7 +6029,7 @@ spdk_bs_load(struct spdk_bs_dev *dev, struct spdk_bs_opts *o,
 		}
 	}
 
-	if (opts.max_md_ops == 0 || opts.max_channel_ops == 0) {
+	if (opts.max_md_ops == 0 || opts.max_channel_ops == 0 || opts.max_cluster_copies == 0) {
 		dev->destroy(dev);
 		cb_fn(cb_arg, NULL, -EINVAL);
 		return;
@@ -5743,6 +6708,19 @@ bs_destroy_trim_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	bs_free(bs);
 }
 
+static void
+bs_destroy_write_super(void *cb_arg, int bserrno)
+{
+	struct spdk_bs_load_ctx *ctx = cb_arg;
+	struct spdk_blob_store *bs = ctx->bs;
+
+	/* Write zeroes to the super block */
+	bs_sequence_write_zeroes_dev(ctx->seq,
+				     bs_page_to_lba(bs, 0),
+				     bs_byte_to_lba(bs, sizeof(struct spdk_bs_super_block)),
+				     bs_destroy_trim_cpl, ctx);
+}
+
 void
 spdk_bs_destroy(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn,
 		void *cb_arg)
@@ -5753,7 +6731,7 @@ spdk_bs_destroy(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn,
 
 	SPDK_DEBUGLOG(blob, "Destroying blobstore\n");
 
-	if (!RB_EMPTY(&bs->open_blobs)) {
+	if (bs->num_open_blobs != 0) {
 		SPDK_ERRLOG("Blobstore still has open blobs\n");
 		cb_fn(cb_arg, -EBUSY);
 		return;
@@ -5777,12 +6755,10 @@ spdk_bs_destroy(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn,
 		cb_fn(cb_arg, -ENOMEM);
 		return;
 	}
+	ctx->seq = seq;
 
-	/* Write zeroes to the super block */
-	bs_sequence_write_zeroes_dev(seq,
-				     bs_page_to_lba(bs, 0),
-				     bs_byte_to_lba(bs, sizeof(struct spdk_bs_super_block)),
-				     bs_destroy_trim_cpl, ctx);
+	/* Background unmaps must be done before the blobstore is freed */
+	bs_reclaim_wait_idle(bs, bs_destroy_write_super, ctx);
 }
 
 /* END spdk_bs_destroy */
@@ -5893,6 +6869,30 @@ bs_unload_read_super_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	bs_write_used_md(seq, cb_arg, bs_unload_write_used_pages_cpl);
 }
 
+static void
+bs_unload_read_super(void *cb_arg, int bserrno)
+{
+	struct spdk_bs_load_ctx	*ctx = cb_arg;
+	struct spdk_blob_store	*bs = ctx->bs;
+
+	/* Read super block */
+	bs_sequence_read_dev(ctx->seq, ctx->super, bs_page_to_lba(bs, 0),
+			     bs_byte_to_lba(bs, sizeof(*ctx->super)),
+			     bs_unload_read_super_cpl, ctx);
+}
+
+static void
+bs_unload_release_clusters_cpl(struct spdk_io_channel_iter *i, int status)
+{
+	struct spdk_bs_load_ctx	*ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_blob_store	*bs = ctx->bs;
+
+	assert(bs->num_reserved_clusters == 0);
+
+	/* Wait for the freed clusters to be released, so that they are persisted as free */
+	bs_reclaim_wait_idle(bs, bs_unload_read_super, ctx);
+}
+
 void
 spdk_bs_unload(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_arg)
 {
@@ -5925,7 +6925,7 @@ spdk_bs_unload(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_a
 		bs->esnap_unload_cb_arg = NULL;
 	}
 
-	if (!RB_EMPTY(&bs->open_blobs)) {
+	if (bs->num_open_blobs != 0) {
 		SPDK_ERRLOG("Blobstore still has open blobs\n");
 		cb_fn(cb_arg, -EBUSY);
 		return;
@@ -5959,10 +6959,10 @@ spdk_bs_unload(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_a
 		return;
 	}
 
-	/* Read super block */
-	bs_sequence_read_dev(ctx->seq, ctx->super, bs_page_to_lba(bs, 0),
-			     bs_byte_to_lba(bs, sizeof(*ctx->super)),
-			     bs_unload_read_super_cpl, ctx);
+	/* Give the clusters reserved by the channels back before the used clusters mask is
+	 * written out. */
+	spdk_for_each_channel(bs, bs_release_reserved_clusters_iter, ctx,
+			      bs_unload_release_clusters_cpl);
 }
 
 /* END spdk_bs_unload */
@@ -6096,7 +7096,8 @@ spdk_bs_get_io_unit_size(struct spdk_blob_store *bs)
 uint64_t
 spdk_bs_free_cluster_count(struct spdk_blob_store *bs)
 {
-	return bs->num_free_clusters;
+	/* Clusters reserved by the channels are still free from the user's point of view */
+	return bs->num_free_clusters + __atomic_load_n(&bs->num_reserved_clusters, __ATOMIC_RELAXED);
 }
 
 uint64_t
@@ -6262,6 +7263,62 @@ blob_opts_copy(const struct spdk_blob_opts *src, struct spdk_blob_opts *dst)
 #undef SET_FIELD
 }
 
+struct bs_create_blob_ctx {
+	struct spdk_blob		*blob;
+	uint64_t			num_clusters;
+	spdk_blob_op_with_id_complete	cb_fn;
+	void				*cb_arg;
+};
+
+static void
+bs_create_blob_allocate(struct spdk_blob *blob, uint64_t num_clusters,
+			spdk_blob_op_with_id_complete cb_fn, void *cb_arg)
+{
+	struct spdk_blob_store	*bs = blob->bs;
+	uint32_t		page_idx = bs_blobid_to_page(blob->id);
+	struct spdk_bs_cpl	cpl;
+	spdk_bs_sequence_t	*seq;
+	int rc;
+
+	rc = blob_resize(blob, num_clusters);
+	if (rc < 0) {
+		goto error;
+	}
+	cpl.type = SPDK_BS_CPL_TYPE_BLOBID;
+	cpl.u.blobid.cb_fn = cb_fn;
+	cpl.u.blobid.cb_arg = cb_arg;
+	cpl.u.blobid.blobid = blob->id;
+
+	seq = bs_sequence_start_bs(bs->md_channel, &cpl);
+	if (!seq) {
+		rc = -ENOMEM;
+		goto error;
+	}
+
+	blob_persist(seq, blob, bs_create_blob_cpl, blob);
+	return;
+
+error:
+	SPDK_ERRLOG("Failed to create blob: %s, size in clusters/size: %lu (clusters)\n",
+		    spdk_strerror(rc), num_clusters);
+	blob_free(blob);
+	spdk_spin_lock(&bs->used_lock);
+	spdk_bit_array_clear(bs->used_blobids, page_idx);
+	bs_release_md_page(bs, page_idx);
+	spdk_spin_unlock(&bs->used_lock);
+	cb_fn(cb_arg, 0, rc);
+}
+
+static void
+bs_create_blob_release_cpl(void *cb_arg, int bserrno)
+{
+	struct bs_create_blob_ctx *ctx = cb_arg;
+
+	/* If the reserved clusters couldn't be released, the allocation fails with -ENOSPC */
+	bs_create_blob_allocate(ctx->blob, ctx->num_clusters, ctx->cb_fn, ctx->cb_arg);
+	free(ctx);
+}
+
 static void
 bs_create_blob(struct spdk_blob_store *bs,
 	       const struct spdk_blob_opts *opts,
@@ -6270,10 +7327,9 @@ bs_create_blob(struct spdk_blob_store *bs,
 {
 	struct spdk_blob	*blob;
 	uint32_t		page_idx;
-	struct spdk_bs_cpl	cpl;
 	struct spdk_blob_opts	opts_local;
 	struct spdk_blob_xattr_opts internal_xattrs_default;
-	spdk_bs_sequence_t	*seq;
+	struct bs_create_blob_ctx *ctx;
 	spdk_blob_id		id;
 	int rc;
 
@@ -6346,24 +7402,24 @@ bs_create_blob(struct spdk_blob_store *bs,
 		if (rc != 0) {
 			goto error;
 		}
-	}
-
-	rc = blob_resize(blob, opts_local.num_clusters);
-	if (rc < 0) {
-		goto error;
-	}
-	cpl.type = SPDK_BS_CPL_TYPE_BLOBID;
-	cpl.u.blobid.cb_fn = cb_fn;
-	cpl.u.blobid.cb_arg = cb_arg;
-	cpl.u.blobid.blobid = blob->id;
+	}
 
-	seq = bs_sequence_start_bs(bs->md_channel, &cpl);
-	if (!seq) {
-		rc = -ENOMEM;
-		goto error;
+	if (!spdk_blob_is_thin_provisioned(blob) &&
+	    bs_reserved_clusters_needed(bs, opts_local.num_clusters)) {
+		ctx = calloc(1, sizeof(*ctx));
+		if (!ctx) {
+			rc = -ENOMEM;
+			goto error;
+		}
+		ctx->blob = blob;
+		ctx->num_clusters = opts_local.num_clusters;
+		ctx->cb_fn = cb_fn;
+		ctx->cb_arg = cb_arg;
+		bs_release_reserved_clusters(bs, bs_create_blob_release_cpl, ctx);
+		return;
 	}
 
-	blob_persist(seq, blob, bs_create_blob_cpl, blob);
+	bs_create_blob_allocate(blob, opts_local.num_clusters, cb_fn, cb_arg);
 	return;
 
 error:
@@ -6404,9 +7460,18 @@ struct spdk_clone_snapshot_ctx {
 
 	struct spdk_io_channel *channel;
 
-	/* Current cluster for inflate operation */
+	/* Next cluster to look at for inflate operation */
 	uint64_t cluster;
 
+	/* Clusters the inflate operation has to allocate */
+	uint64_t clusters_needed;
+
+	/* Cluster copies in flight for inflate operation, the first error any of them hit, and
+	 * whether new copies are being submitted */
+	uint32_t copies_in_flight;
+	int copy_bserrno;
+	bool in_submit;
+
 	/* For inflation force allocation of all unallocated clusters and remove
 	 * thin-provisioning. Otherwise only decouple parent and keep clone thin. */
 	bool allocate_all;
@@ -7077,55 +8142,97 @@ bs_cluster_needs_allocation(struct spdk_blob *blob, uint64_t cluster, bool alloc
 	return (allocate_all || b->blob->active.clusters[cluster] != 0);
 }
 
+static void bs_inflate_blob_touch_next(struct spdk_clone_snapshot_ctx *ctx);
+
 static void
-bs_inflate_blob_touch_next(void *cb_arg, int bserrno)
+bs_inflate_blob_copy_cpl(void *cb_arg, int bserrno)
 {
 	struct spdk_clone_snapshot_ctx *ctx = (struct spdk_clone_snapshot_ctx *)cb_arg;
+
+	assert(ctx->copies_in_flight > 0);
+	ctx->copies_in_flight--;
+
+	if (bserrno != 0 && ctx->copy_bserrno == 0) {
+		ctx->copy_bserrno = bserrno;
+	}
+
+	bs_inflate_blob_touch_next(ctx);
+}
+
+/* Keep up to max_cluster_copies clusters being allocated and copied at once */
+static void
+bs_inflate_blob_touch_next(struct spdk_clone_snapshot_ctx *ctx)
+{
 	struct spdk_blob *_blob = ctx->original.blob;
-	struct spdk_bs_cpl cpl;
-	spdk_bs_user_op_t *op;
 	uint64_t offset;
+	int rc;
 
-	if (bserrno != 0) {
-		bs_clone_snapshot_origblob_cleanup(ctx, bserrno);
+	if (ctx->in_submit) {
+		/* The loop below picks up where this completion left off */
 		return;
 	}
 
-	for (; ctx->cluster < _blob->active.num_clusters; ctx->cluster++) {
-		if (bs_cluster_needs_allocation(_blob, ctx->cluster, ctx->allocate_all)) {
+	ctx->in_submit = true;
+	while (ctx->copy_bserrno == 0 && ctx->copies_in_flight < _blob->bs->max_cluster_copies) {
+		for (; ctx->cluster < _blob->active.num_clusters; ctx->cluster++) {
+			if (bs_cluster_needs_allocation(_blob, ctx->cluster, ctx->allocate_all)) {
+				break;
+			}
+		}
+
+		if (ctx->cluster == _blob->active.num_clusters) {
 			break;
 		}
-	}
 
-	if (ctx->cluster < _blob->active.num_clusters) {
 		offset = bs_cluster_to_lba(_blob->bs, ctx->cluster);
 
 		/* We may safely increment a cluster before copying */
 		ctx->cluster++;
 
-		/* Use a dummy 0B read as a context for cluster copy */
-		cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
-		cpl.u.blob_basic.cb_fn = bs_inflate_blob_touch_next;
-		cpl.u.blob_basic.cb_arg = ctx;
-
-		op = bs_user_op_alloc(ctx->channel, &cpl, SPDK_BLOB_READ, _blob,
-				      NULL, 0, offset, 0);
-		if (!op) {
-			bs_clone_snapshot_origblob_cleanup(ctx, -ENOMEM);
-			return;
+		/* Bypass need_cluster_alloc, which would serialize the copies. A conflicting
+		 * allocation by a user write is resolved when the cluster is inserted. */
+		ctx->copies_in_flight++;
+		rc = blob_allocate_and_copy_cluster(_blob, ctx->channel, offset, NULL,
+						    bs_inflate_blob_copy_cpl, ctx);
+		if (rc != 0) {
+			ctx->copies_in_flight--;
+			ctx->copy_bserrno = rc;
+			break;
 		}
+	}
+	ctx->in_submit = false;
+
+	if (ctx->copies_in_flight > 0) {
+		return;
+	}
 
-		bs_allocate_and_copy_cluster(_blob, ctx->channel, offset, op);
+	if (ctx->copy_bserrno != 0) {
+		bs_clone_snapshot_origblob_cleanup(ctx, ctx->copy_bserrno);
 	} else {
 		bs_inflate_blob_done(ctx);
 	}
 }
 
+static void
+bs_inflate_blob_allocate(void *cb_arg, int bserrno)
+{
+	struct spdk_clone_snapshot_ctx *ctx = (struct spdk_clone_snapshot_ctx *)cb_arg;
+
+	/* A failure to release the reserved clusters is reported as -ENOSPC */
+	if (ctx->clusters_needed > ctx->original.blob->bs->num_free_clusters) {
+		/* Not enough free clusters. Cannot satisfy the request. */
+		bs_clone_snapshot_origblob_cleanup(ctx, -ENOSPC);
+		return;
+	}
+
+	ctx->cluster = 0;
+	bs_inflate_blob_touch_next(ctx);
+}
+
 static void
 bs_inflate_blob_open_cpl(void *cb_arg, struct spdk_blob *_blob, int bserrno)
 {
 	struct spdk_clone_snapshot_ctx *ctx = (struct spdk_clone_snapshot_ctx *)cb_arg;
-	uint64_t clusters_needed;
 	uint64_t i;
 
 	if (bserrno != 0) {
@@ -7176,21 +8283,19 @@ bs_inflate_blob_open_cpl(void *cb_arg, struct spdk_blob *_blob, int bserrno)
 	/* Do two passes - one to verify that we can obtain enough clusters
 	 * and another to actually claim them.
 	 */
-	clusters_needed = 0;
+	ctx->clusters_needed = 0;
 	for (i = 0; i < _blob->active.num_clusters; i++) {
 		if (bs_cluster_needs_allocation(_blob, i, ctx->allocate_all)) {
-			clusters_needed++;
+			ctx->clusters_needed++;
 		}
 	}
 
-	if (clusters_needed > _blob->bs->num_free_clusters) {
-		/* Not enough free clusters. Cannot satisfy the request. */
-		bs_clone_snapshot_origblob_cleanup(ctx, -ENOSPC);
+	if (bs_reserved_clusters_needed(_blob->bs, ctx->clusters_needed)) {
+		bs_release_reserved_clusters(_blob->bs, bs_inflate_blob_allocate, ctx);
 		return;
 	}
 
-	ctx->cluster = 0;
-	bs_inflate_blob_touch_next(ctx, 0);
+	bs_inflate_blob_allocate(ctx, 0);
 }
 
 static void
@@ -7231,6 +8336,22 @@ spdk_bs_blob_decouple_parent(struct spdk_blob_store *bs, struct spdk_io_channel
 
 /* START spdk_bs_blob_shallow_copy */
 
+struct shallow_copy_ctx;
+
+/* One of the cluster copies kept in flight */
+struct shallow_copy_slot {
+	struct shallow_copy_ctx *ctx;
+
+	/* Cluster being copied */
+	uint64_t cluster;
+
+	/* Buffer for blob reading */
+	uint8_t *read_buff;
+
+	/* Struct for external device writing */
+	struct spdk_bs_dev_cb_args ext_args;
+};
+
 struct shallow_copy_ctx {
 	struct spdk_bs_cpl cpl;
 	int bserrno;
@@ -7245,14 +8366,17 @@ struct shallow_copy_ctx {
 	struct spdk_bs_dev *ext_dev;
 	struct spdk_io_channel *ext_channel;
 
-	/* Current cluster for copy operation */
+	/* Next cluster to look at for copy operation */
 	uint64_t cluster;
 
-	/* Buffer for blob reading */
+	/* Copies kept in flight, and the buffer backing their read_buff */
+	struct shallow_copy_slot *slots;
+	uint32_t num_slots;
+	uint32_t copies_in_flight;
 	uint8_t *read_buff;
 
-	/* Struct for external device writing */
-	struct spdk_bs_dev_cb_args ext_args;
+	/* Set while new copies are submitted, to not recurse on inline completions */
+	bool in_submit;
 
 	/* Actual number of copied clusters */
 	uint64_t copied_clusters_count;
@@ -7277,6 +8401,7 @@ bs_shallow_copy_cleanup_finish(void *cb_arg, int bserrno)
 
 	ctx->ext_dev->destroy_channel(ctx->ext_dev, ctx->ext_channel);
 	spdk_free(ctx->read_buff);
+	free(ctx->slots);
 
 	cpl->u.blob_basic.cb_fn(cpl->u.blob_basic.cb_arg, ctx->bserrno);
 
@@ -7284,21 +8409,19 @@ bs_shallow_copy_cleanup_finish(void *cb_arg, int bserrno)
 }
 
 static void
-bs_shallow_copy_bdev_write_cpl(struct spdk_io_channel *channel, void *cb_arg, int bserrno)
+bs_shallow_copy_slot_done(struct shallow_copy_slot *slot, int bserrno)
 {
-	struct shallow_copy_ctx *ctx = cb_arg;
-	struct spdk_blob *_blob = ctx->blob;
+	struct shallow_copy_ctx *ctx = slot->ctx;
 
-	if (bserrno != 0) {
-		SPDK_ERRLOG("blob 0x%" PRIx64 " shallow copy, ext dev write error %d\n", ctx->blob->id, bserrno);
-		ctx->bserrno = bserrno;
-		_blob->locked_operation_in_progress = false;
-		spdk_blob_close(_blob, bs_shallow_copy_cleanup_finish, ctx);
-		return;
-	}
+	assert(ctx->copies_in_flight > 0);
+	ctx->copies_in_flight--;
+	slot->ctx = NULL;
 
-	ctx->cluster++;
-	if (ctx->status_cb) {
+	if (bserrno != 0) {
+		if (ctx->bserrno == 0) {
+			ctx->bserrno = bserrno;
+		}
+	} else if (ctx->status_cb) {
 		ctx->copied_clusters_count++;
 		ctx->status_cb(ctx->copied_clusters_count, ctx->status_cb_arg);
 	}
@@ -7306,29 +8429,55 @@ bs_shallow_copy_bdev_write_cpl(struct spdk_io_channel *channel, void *cb_arg, in
 	bs_shallow_copy_cluster_find_next(ctx);
 }
 
+static void
+bs_shallow_copy_bdev_write_cpl(struct spdk_io_channel *channel, void *cb_arg, int bserrno)
+{
+	struct shallow_copy_slot *slot = cb_arg;
+
+	if (bserrno != 0) {
+		SPDK_ERRLOG("blob 0x%" PRIx64 " shallow copy, ext dev write error %d\n",
+			    slot->ctx->blob->id, bserrno);
+	}
+
+	bs_shallow_copy_slot_done(slot, bserrno);
+}
+
 static void
 bs_shallow_copy_blob_read_cpl(void *cb_arg, int bserrno)
 {
-	struct shallow_copy_ctx *ctx = cb_arg;
+	struct shallow_copy_slot *slot = cb_arg;
+	struct shallow_copy_ctx *ctx = slot->ctx;
 	struct spdk_bs_dev *ext_dev = ctx->ext_dev;
 	struct spdk_blob *_blob = ctx->blob;
 
 	if (bserrno != 0) {
 		SPDK_ERRLOG("blob 0x%" PRIx64 " shallow copy, blob read error %d\n", ctx->blob->id, bserrno);
-		ctx->bserrno = bserrno;
-		_blob->locked_operation_in_progress = false;
-		spdk_blob_close(_blob, bs_shallow_copy_cleanup_finish, ctx);
+		bs_shallow_copy_slot_done(slot, bserrno);
 		return;
 	}
 
-	ctx->ext_args.channel = ctx->ext_channel;
-	ctx->ext_args.cb_fn = bs_shallow_copy_bdev_write_cpl;
-	ctx->ext_args.cb_arg = ctx;
+	slot->ext_args.channel = ctx->ext_channel;
+	slot->ext_args.cb_fn = bs_shallow_copy_bdev_write_cpl;
+	slot->ext_args.cb_arg = slot;
 
-	ext_dev->write(ext_dev, ctx->ext_channel, ctx->read_buff,
-		       bs_cluster_to_lba(_blob->bs, ctx->cluster),
+	ext_dev->write(ext_dev, ctx->ext_channel, slot->read_buff,
+		       bs_cluster_to_lba(_blob->bs, slot->cluster),
 		       bs_dev_byte_to_lba(_blob->bs->dev, _blob->bs->cluster_sz),
-		       &ctx->ext_args);
+		       &slot->ext_args);
+}
+
+static struct shallow_copy_slot *
+bs_shallow_copy_get_slot(struct shallow_copy_ctx *ctx)
+{
+	uint32_t i;
+
+	for (i = 0; i < ctx->num_slots; i++) {
+		if (ctx->slots[i].ctx == NULL) {
+			return &ctx->slots[i];
+		}
+	}
+
+	return NULL;
 }
 
 static void
@@ -7336,21 +8485,39 @@ bs_shallow_copy_cluster_find_next(void *cb_arg)
 {
 	struct shallow_copy_ctx *ctx = cb_arg;
 	struct spdk_blob *_blob = ctx->blob;
+	struct shallow_copy_slot *slot;
+
+	if (ctx->in_submit) {
+		/* The loop below picks up where this completion left off */
+		return;
+	}
+
+	ctx->in_submit = true;
+	while (ctx->bserrno == 0 && (slot = bs_shallow_copy_get_slot(ctx)) != NULL) {
+		while (ctx->cluster < _blob->active.num_clusters) {
+			if (_blob->active.clusters[ctx->cluster] != 0) {
+				break;
+			}
 
-	while (ctx->cluster < _blob->active.num_clusters) {
-		if (_blob->active.clusters[ctx->cluster] != 0) {
+			ctx->cluster++;
+		}
+
+		if (ctx->cluster == _blob->active.num_clusters) {
 			break;
 		}
 
-		ctx->cluster++;
-	}
+		slot->ctx = ctx;
+		slot->cluster = ctx->cluster++;
+		ctx->copies_in_flight++;
 
-	if (ctx->cluster < _blob->active.num_clusters) {
-		blob_request_submit_op_single(ctx->blob_channel, _blob, ctx->read_buff,
-					      bs_cluster_to_lba(_blob->bs, ctx->cluster),
+		blob_request_submit_op_single(ctx->blob_channel, _blob, slot->read_buff,
+					      bs_cluster_to_lba(_blob->bs, slot->cluster),
 					      bs_dev_byte_to_lba(_blob->bs->dev, _blob->bs->cluster_sz),
-					      bs_shallow_copy_blob_read_cpl, ctx, SPDK_BLOB_READ);
-	} else {
+					      bs_shallow_copy_blob_read_cpl, slot, SPDK_BLOB_READ);
+	}
+	ctx->in_submit = false;
+
+	if (ctx->copies_in_flight == 0) {
 		_blob->locked_operation_in_progress = false;
 		spdk_blob_close(_blob, bs_shallow_copy_cleanup_finish, ctx);
 	}
@@ -7420,6 +8587,7 @@ spdk_bs_blob_shallow_copy(struct spdk_blob_store *bs, struct spdk_io_channel *ch
 {
 	struct shallow_copy_ctx *ctx;
 	struct spdk_io_channel *ext_channel;
+	uint32_t i;
 
 	ctx = calloc(1, sizeof(*ctx));
 	if (!ctx) {
@@ -7435,16 +8603,25 @@ spdk_bs_blob_shallow_copy(struct spdk_blob_store *bs, struct spdk_io_channel *ch
 	ctx->blob_channel = channel;
 	ctx->status_cb = status_cb_fn;
 	ctx->status_cb_arg = status_cb_arg;
-	ctx->read_buff = spdk_malloc(bs->cluster_sz, bs->dev->blocklen, NULL,
+	ctx->num_slots = bs->max_cluster_copies;
+	ctx->slots = calloc(ctx->num_slots, sizeof(*ctx->slots));
+	ctx->read_buff = spdk_malloc((uint64_t)ctx->num_slots * bs->cluster_sz, bs->dev->blocklen, NULL,
 				     SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
-	if (!ctx->read_buff) {
+	if (!ctx->slots || !ctx->read_buff) {
+		spdk_free(ctx->read_buff);
+		free(ctx->slots);
 		free(ctx);
 		return -ENOMEM;
 	}
 
+	for (i = 0; i < ctx->num_slots; i++) {
+		ctx->slots[i].read_buff = ctx->read_buff + (uint64_t)i * bs->cluster_sz;
+	}
+
 	ext_channel = ext_dev->create_channel(ext_dev);
 	if (!ext_channel) {
 		spdk_free(ctx->read_buff);
+		free(ctx->slots);
 		free(ctx);
 		return -ENOMEM;
 	}
@@ -7913,6 +9090,15 @@ bs_resize_freeze_cpl(void *cb_arg, int rc)
 	blob_unfreeze_io(ctx->blob, bs_resize_unfreeze_cpl, ctx);
 }
 
+static void
+bs_resize_release_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_bs_resize_ctx *ctx = (struct spdk_bs_resize_ctx *)cb_arg;
+
+	/* If the reserved clusters couldn't be released, the resize fails with -ENOSPC */
+	blob_freeze_io(ctx->blob, bs_resize_freeze_cpl, ctx);
+}
+
 void
 spdk_blob_resize(struct spdk_blob *blob, uint64_t sz, spdk_blob_op_complete cb_fn, void *cb_arg)
 {
@@ -7948,6 +9134,13 @@ spdk_blob_resize(struct spdk_blob *blob, uint64_t sz, spdk_blob_op_complete cb_f
 	ctx->cb_arg = cb_arg;
 	ctx->blob = blob;
 	ctx->sz = sz;
+
+	if (!spdk_blob_is_thin_provisioned(blob) && sz > blob->active.num_clusters &&
+	    bs_reserved_clusters_needed(blob->bs, sz - blob->active.num_clusters)) {
+		bs_release_reserved_clusters(blob->bs, bs_resize_release_cpl, ctx);
+		return;
+	}
+
 	blob_freeze_io(blob, bs_resize_freeze_cpl, ctx);
 }
 
@@ -7993,7 +9186,6 @@ bs_delete_persist_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 struct delete_snapshot_ctx {
 	struct spdk_blob_list *parent_snapshot_entry;
 	struct spdk_blob *snapshot;
-	struct spdk_blob_md_page *page;
 	bool snapshot_md_ro;
 	struct spdk_blob *clone;
 	bool clone_md_ro;
@@ -8019,7 +9211,6 @@ delete_blob_cleanup_finish(void *cb_arg, int bserrno)
 	}
 
 	ctx->cb_fn(ctx->cb_arg, ctx->snapshot, ctx->bserrno);
-	spdk_free(ctx->page);
 	free(ctx);
 }
 
@@ -8035,8 +9226,7 @@ delete_snapshot_cleanup_snapshot(void *cb_arg, int bserrno)
 
 	if (ctx->bserrno != 0) {
 		assert(blob_lookup(ctx->snapshot->bs, ctx->snapshot->id) == NULL);
-		RB_INSERT(spdk_blob_tree, &ctx->snapshot->bs->open_blobs, ctx->snapshot);
-		spdk_bit_array_set(ctx->snapshot->bs->open_blobids, ctx->snapshot->id);
+		bs_open_blobs_insert(ctx->snapshot->bs, ctx->snapshot);
 	}
 
 	ctx->snapshot->locked_operation_in_progress = false;
@@ -8248,9 +9438,8 @@ delete_snapshot_update_extent_pages(void *cb_arg, int bserrno)
 		/* Clone and snapshot both contain partially filled matching extent pages.
 		 * Update the clone extent page in place with cluster map containing the mix of both. */
 		ctx->next_extent_page = i + 1;
-		memset(ctx->page, 0, SPDK_BS_PAGE_SIZE);
 
-		blob_write_extent_page(ctx->clone, *extent_page, i * SPDK_EXTENTS_PER_EP, ctx->page,
+		blob_write_extent_page(ctx->clone, *extent_page, i * SPDK_EXTENTS_PER_EP,
 				       delete_snapshot_update_extent_pages, ctx);
 		return;
 	}
@@ -8515,17 +9704,9 @@ bs_delete_open_cpl(void *cb_arg, struct spdk_blob *blob, int bserrno)
 	 * Remove the blob from the blob_store list now, to ensure it does not
 	 *  get returned after this point by blob_lookup().
 	 */
-	spdk_bit_array_clear(blob->bs->open_blobids, blob->id);
-	RB_REMOVE(spdk_blob_tree, &blob->bs->open_blobs, blob);
+	bs_open_blobs_remove(blob->bs, blob);
 
 	if (update_clone) {
-		ctx->page = spdk_zmalloc(blob->bs->md_page_size, 0, NULL, SPDK_ENV_NUMA_ID_ANY,
-					 SPDK_MALLOC_DMA);
-		if (!ctx->page) {
-			ctx->bserrno = -ENOMEM;
-			spdk_blob_close(blob, delete_blob_cleanup_finish, ctx);
-			return;
-		}
 		/* This blob is a snapshot with active clone - update clone first */
 		update_clone_on_snapshot_deletion(blob, ctx);
 	} else {
@@ -8588,8 +9769,7 @@ bs_open_blob_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 
 	blob->open_ref++;
 
-	spdk_bit_array_set(blob->bs->open_blobids, blob->id);
-	RB_INSERT(spdk_blob_tree, &blob->bs->open_blobs, blob);
+	bs_open_blobs_insert(blob->bs, blob);
 
 	bs_sequence_finish(seq, bserrno);
 }
@@ -8764,7 +9944,6 @@ struct spdk_blob_cluster_op_ctx {
 	uint32_t		cluster_num;	/* cluster index in blob */
 	uint32_t		cluster;	/* cluster on disk */
 	uint32_t		extent_page;	/* extent page on disk */
-	struct spdk_blob_md_page *page; /* preallocated extent page */
 	int			rc;
 	spdk_blob_op_complete	cb_fn;
 	void			*cb_arg;
@@ -8800,13 +9979,6 @@ blob_insert_new_ep_cb(void *arg, int bserrno)
 	blob_sync_md(ctx->blob, blob_op_cluster_msg_cb, ctx);
 }
 
-struct spdk_blob_write_extent_page_ctx {
-	struct spdk_blob_store		*bs;
-
-	uint32_t			extent;
-	struct spdk_blob_md_page	*page;
-};
-
 static void
 blob_free_cluster_msg_cb(void *arg, int bserrno)
 {
@@ -8847,69 +10019,236 @@ blob_free_cluster_free_ep_cb(void *arg, int bserrno)
 	blob_sync_md(ctx->blob, blob_free_cluster_msg_cb, ctx);
 }
 
+/*
+ * Extent page writes are group committed. The updates requested while a batch of them is in
+ * flight are queued on the blobstore and all submitted together once it completes. Multiple
+ * updates of the same extent page are coalesced into a single write and the writes of adjacent
+ * md pages are merged. The extent pages are only serialized when the batch is submitted, so they
+ * always reflect the latest cluster map of the blob.
+ */
+struct spdk_blob_ep_update {
+	struct spdk_blob			*blob;
+	uint32_t				extent;
+	uint64_t				cluster_num;
+	spdk_blob_op_complete			cb_fn;
+	void					*cb_arg;
+	TAILQ_ENTRY(spdk_blob_ep_update)	link;
+};
+
+struct spdk_blob_ep_batch {
+	struct spdk_blob_store			*bs;
+	struct spdk_blob_ep_updates		updates;
+
+	/* One update per extent page written, sorted by the md page */
+	struct spdk_blob_ep_update		**pages;
+	uint32_t				num_pages;
+	uint8_t					*buf;
+};
+
+static void bs_ep_batch_submit(void *arg);
+
 static void
-blob_persist_extent_page_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+bs_ep_updates_complete(struct spdk_blob_store *bs, struct spdk_blob_ep_updates *updates,
+		       int bserrno)
 {
-	struct spdk_blob_write_extent_page_ctx *ctx = cb_arg;
+	struct spdk_blob_ep_update *update;
 
-	free(ctx);
+	while ((update = TAILQ_FIRST(updates)) != NULL) {
+		TAILQ_REMOVE(updates, update, link);
+		update->cb_fn(update->cb_arg, bserrno);
+		free(update);
+	}
+}
+
+static void
+bs_ep_batch_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_blob_ep_batch *batch = cb_arg;
+	struct spdk_blob_store *bs = batch->bs;
+
+	bs_ep_updates_complete(bs, &batch->updates, bserrno);
+	spdk_free(batch->buf);
+	free(batch->pages);
+	free(batch);
+
+	/* Everything queued while this batch was in flight makes up the next one */
+	if (!TAILQ_EMPTY(&bs->ep_updates)) {
+		bs_ep_batch_submit(bs);
+	} else {
+		bs->ep_batch_in_progress = false;
+	}
+}
+
+static void
+bs_ep_batch_write_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
 	bs_sequence_finish(seq, bserrno);
 }
 
 static void
-blob_write_extent_page_ready(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+bs_ep_batch_write(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 {
-	struct spdk_blob_write_extent_page_ctx *ctx = cb_arg;
+	struct spdk_blob_ep_batch *batch = cb_arg;
+	struct spdk_blob_store *bs = batch->bs;
+	spdk_bs_batch_t *bs_batch;
+	uint32_t start, i;
 
 	if (bserrno != 0) {
-		blob_persist_extent_page_cpl(seq, ctx, bserrno);
+		bs_sequence_finish(seq, bserrno);
 		return;
 	}
-	bs_sequence_write_dev(seq, ctx->page, bs_md_page_to_lba(ctx->bs, ctx->extent),
-			      bs_byte_to_lba(ctx->bs, ctx->bs->md_page_size),
-			      blob_persist_extent_page_cpl, ctx);
+
+	bs_batch = bs_sequence_to_batch(seq, bs_ep_batch_write_cpl, batch);
+
+	for (start = 0; start < batch->num_pages; start = i) {
+		/* Write the pages that are contiguous on disk with a single I/O */
+		for (i = start + 1; i < batch->num_pages; i++) {
+			if (batch->pages[i]->extent != batch->pages[i - 1]->extent + 1) {
+				break;
+			}
+		}
+		bs_batch_write_dev(bs_batch, batch->buf + (uint64_t)start * bs->md_page_size,
+				   bs_md_page_to_lba(bs, batch->pages[start]->extent),
+				   bs_byte_to_lba(bs, (uint64_t)(i - start) * bs->md_page_size));
+	}
+
+	bs_batch_close(bs_batch);
+}
+
+static int
+bs_ep_update_cmp(const void *a, const void *b)
+{
+	const struct spdk_blob_ep_update *update_a = *(struct spdk_blob_ep_update * const *)a;
+	const struct spdk_blob_ep_update *update_b = *(struct spdk_blob_ep_update * const *)b;
+
+	if (update_a->extent != update_b->extent) {
+		return update_a->extent < update_b->extent ? -1 : 1;
+	}
+
+	return 0;
 }
 
 static void
-blob_write_extent_page(struct spdk_blob *blob, uint32_t extent, uint64_t cluster_num,
-		       struct spdk_blob_md_page *page, spdk_blob_op_complete cb_fn, void *cb_arg)
+bs_ep_batch_submit(void *arg)
 {
-	struct spdk_blob_write_extent_page_ctx	*ctx;
-	spdk_bs_sequence_t			*seq;
-	struct spdk_bs_cpl			cpl;
+	struct spdk_blob_store *bs = arg;
+	struct spdk_blob_ep_batch *batch;
+	struct spdk_blob_ep_update *update;
+	struct spdk_blob_md_page *page;
+	spdk_bs_sequence_t *seq;
+	struct spdk_bs_cpl cpl;
+	uint32_t num_updates = 0, i;
 
-	ctx = calloc(1, sizeof(*ctx));
-	if (!ctx) {
-		cb_fn(cb_arg, -ENOMEM);
+	assert(bs->ep_batch_in_progress);
+	assert(!TAILQ_EMPTY(&bs->ep_updates));
+
+	batch = calloc(1, sizeof(*batch));
+	if (!batch) {
+		bs->ep_batch_in_progress = false;
+		bs_ep_updates_complete(bs, &bs->ep_updates, -ENOMEM);
 		return;
 	}
-	ctx->bs = blob->bs;
-	ctx->extent = extent;
-	ctx->page = page;
 
-	cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
-	cpl.u.blob_basic.cb_fn = cb_fn;
-	cpl.u.blob_basic.cb_arg = cb_arg;
+	batch->bs = bs;
+	TAILQ_INIT(&batch->updates);
+	TAILQ_SWAP(&batch->updates, &bs->ep_updates, spdk_blob_ep_update, link);
 
-	seq = bs_sequence_start_bs(blob->bs->md_channel, &cpl);
+	TAILQ_FOREACH(update, &batch->updates, link) {
+		num_updates++;
+	}
+
+	batch->pages = calloc(num_updates, sizeof(*batch->pages));
+	if (!batch->pages) {
+		bs_ep_batch_cpl(batch, -ENOMEM);
+		return;
+	}
+
+	i = 0;
+	TAILQ_FOREACH(update, &batch->updates, link) {
+		batch->pages[i++] = update;
+	}
+	qsort(batch->pages, num_updates, sizeof(*batch->pages), bs_ep_update_cmp);
+
+	/* Only the first update of each extent page is kept, the page is serialized from the
+	 * current state of the blob anyway. */
+	for (i = 0; i < num_updates; i++) {
+		if (batch->num_pages > 0 &&
+		    batch->pages[batch->num_pages - 1]->extent == batch->pages[i]->extent) {
+			assert(batch->pages[batch->num_pages - 1]->blob == batch->pages[i]->blob);
+			continue;
+		}
+		batch->pages[batch->num_pages++] = batch->pages[i];
+	}
+
+	batch->buf = spdk_zmalloc((uint64_t)batch->num_pages * bs->md_page_size, 0, NULL,
+				  SPDK_ENV_NUMA_ID_ANY, SPDK_MALLOC_DMA);
+	if (!batch->buf) {
+		bs_ep_batch_cpl(batch, -ENOMEM);
+		return;
+	}
+
+	for (i = 0; i < batch->num_pages; i++) {
+		update = batch->pages[i];
+		page = (struct spdk_blob_md_page *)(batch->buf + (uint64_t)i * bs->md_page_size);
+
+		page->next = SPDK_INVALID_MD_PAGE;
+		page->id = update->blob->id;
+		page->sequence_num = 0;
+
+		blob_serialize_extent_page(update->blob, update->cluster_num, page);
+
+		page->crc = blob_md_page_calc_crc(page);
+
+		assert(spdk_bit_array_get(bs->used_md_pages, update->extent) == true);
+	}
+
+	SPDK_DEBUGLOG(blob, "Writing %" PRIu32 " extent pages for %" PRIu32 " updates\n",
+		      batch->num_pages, num_updates);
+
+	cpl.type = SPDK_BS_CPL_TYPE_BS_BASIC;
+	cpl.u.bs_basic.cb_fn = bs_ep_batch_cpl;
+	cpl.u.bs_basic.cb_arg = batch;
+
+	seq = bs_sequence_start_bs(bs->md_channel, &cpl);
 	if (!seq) {
-		free(ctx);
-		cb_fn(cb_arg, -ENOMEM);
+		bs_ep_batch_cpl(batch, -ENOMEM);
 		return;
 	}
 
-	assert(page);
-	page->next = SPDK_INVALID_MD_PAGE;
-	page->id = blob->id;
-	page->sequence_num = 0;
+	bs_mark_dirty(seq, bs, bs_ep_batch_write, batch);
+}
+
+static void
+blob_write_extent_page(struct spdk_blob *blob, uint32_t extent, uint64_t cluster_num,
+		       spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_blob_store *bs = blob->bs;
+	struct spdk_blob_ep_update *update;
+
+	blob_verify_md_op(blob);
 
-	blob_serialize_extent_page(blob, cluster_num, page);
+	update = calloc(1, sizeof(*update));
+	if (!update) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
 
-	page->crc = blob_md_page_calc_crc(page);
+	update->blob = blob;
+	update->extent = extent;
+	update->cluster_num = cluster_num;
+	update->cb_fn = cb_fn;
+	update->cb_arg = cb_arg;
 
-	assert(spdk_bit_array_get(blob->bs->used_md_pages, extent) == true);
+	TAILQ_INSERT_TAIL(&bs->ep_updates, update, link);
 
-	bs_mark_dirty(seq, blob->bs, blob_write_extent_page_ready, ctx);
+	if (!bs->ep_batch_in_progress) {
+		/* Defer the submission, so that the updates requested by the messages already
+		 * queued on the md thread are written together with this one. */
+		bs->ep_batch_in_progress = true;
+		if (spdk_thread_send_msg(bs->md_thread, bs_ep_batch_submit, bs) != 0) {
+			bs_ep_batch_submit(bs);
+		}
+	}
 }
 
 static void
@@ -8937,7 +10276,7 @@ blob_insert_cluster_msg(void *arg)
 		 * It was already claimed in the used_md_pages map and placed in ctx. */
 		assert(ctx->extent_page != 0);
 		assert(spdk_bit_array_get(ctx->blob->bs->used_md_pages, ctx->extent_page) == true);
-		blob_write_extent_page(ctx->blob, ctx->extent_page, ctx->cluster_num, ctx->page,
+		blob_write_extent_page(ctx->blob, ctx->extent_page, ctx->cluster_num,
 				       blob_insert_new_ep_cb, ctx);
 	} else {
 		/* It is possible for original thread to allocate extent page for
@@ -8952,14 +10291,14 @@ blob_insert_cluster_msg(void *arg)
 		}
 		/* Extent page already allocated.
 		 * Every cluster allocation, requires just an update of single extent page. */
-		blob_write_extent_page(ctx->blob, *extent_page, ctx->cluster_num, ctx->page,
+		blob_write_extent_page(ctx->blob, *extent_page, ctx->cluster_num,
 				       blob_op_cluster_msg_cb, ctx);
 	}
 }
 
 static void
 blob_insert_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
-				 uint64_t cluster, uint32_t extent_page, struct spdk_blob_md_page *page,
+				 uint64_t cluster, uint32_t extent_page,
 				 spdk_blob_op_complete cb_fn, void *cb_arg)
 {
 	struct spdk_blob_cluster_op_ctx *ctx;
@@ -8975,7 +10314,6 @@ blob_insert_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
 	ctx->cluster_num = cluster_num;
 	ctx->cluster = cluster;
 	ctx->extent_page = extent_page;
-	ctx->page = page;
 	ctx->cb_fn = cb_fn;
 	ctx->cb_arg = cb_arg;
 
@@ -9031,10 +10369,10 @@ blob_free_cluster_msg(void *arg)
 		assert(ctx->extent_page != 0);
 		assert(spdk_bit_array_get(ctx->blob->bs->used_md_pages, ctx->extent_page) == true);
 		ctx->blob->active.extent_pages[bs_cluster_to_extent_table_id(ctx->cluster_num)] = 0;
-		blob_write_extent_page(ctx->blob, ctx->extent_page, ctx->cluster_num, ctx->page,
+		blob_write_extent_page(ctx->blob, ctx->extent_page, ctx->cluster_num,
 				       blob_free_cluster_free_ep_cb, ctx);
 	} else {
-		blob_write_extent_page(ctx->blob, *extent_page, ctx->cluster_num, ctx->page,
+		blob_write_extent_page(ctx->blob, *extent_page, ctx->cluster_num,
 				       blob_free_cluster_update_ep_cb, ctx);
 	}
 }
@@ -9042,7 +10380,7 @@ blob_free_cluster_msg(void *arg)
 
 static void
 blob_free_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num, uint32_t extent_page,
-			       struct spdk_blob_md_page *page, spdk_blob_op_complete cb_fn, void *cb_arg)
+			       spdk_blob_op_complete cb_fn, void *cb_arg)
 {
 	struct spdk_blob_cluster_op_ctx *ctx;
 
@@ -9056,7 +10394,6 @@ blob_free_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num, uin
 	ctx->blob = blob;
 	ctx->cluster_num = cluster_num;
 	ctx->extent_page = extent_page;
-	ctx->page = page;
 	ctx->cb_fn = cb_fn;
 	ctx->cb_arg = cb_arg;
 
@@ -9080,8 +10417,7 @@ blob_close_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 			 *  remove them again.
 			 */
 			if (blob->active.num_pages > 0) {
-				spdk_bit_array_clear(blob->bs->open_blobids, blob->id);
-				RB_REMOVE(spdk_blob_tree, &blob->bs->open_blobs, blob);
+				bs_open_blobs_remove(blob->bs, blob);
 			}
 			blob_free(blob);
 		}
@@ -10007,7 +11343,7 @@ spdk_bs_grow(struct spdk_bs_dev *dev, struct spdk_bs_opts *o,
 		}
 	}
 
-	if (opts.max_md_ops == 0 || opts.max_channel_ops == 0) {
+	if (opts.max_md_ops == 0 || opts.max_channel_ops == 0 || opts.max_cluster_copies == 0) {
 		dev->destroy(dev);
 		cb_fn(cb_arg, NULL, -EINVAL);
 		return;
@@ -10329,6 +11665,24 @@ spdk_blob_get_esnap_bs_dev(const struct spdk_blob *blob)
 	return blob->back_bs_dev;
 }
 
+int
+spdk_blob_set_esnap_copy_on_read(struct spdk_blob *blob, uint32_t clusters_per_sec)
+{
+	if (!blob_is_esnap_clone(blob)) {
+		SPDK_ERRLOG("blob 0x%" PRIx64 ": not an esnap clone\n", blob->id);
+		return -EINVAL;
+	}
+
+	if (clusters_per_sec != 0 && blob->data_ro) {
+		SPDK_ERRLOG("blob 0x%" PRIx64 ": read-only, can't copy on read\n", blob->id);
+		return -EPERM;
+	}
+
+	__atomic_store_n(&blob->esnap_cor_rate, clusters_per_sec, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
 bool
 spdk_blob_is_degraded(const struct spdk_blob *blob)
 {
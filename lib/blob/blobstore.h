@@ -25,8 +25,23 @@
 #define SPDK_BLOB_OPTS_NUM_MD_PAGES UINT32_MAX
 #define SPDK_BLOB_OPTS_MAX_MD_OPS 32
 #define SPDK_BLOB_OPTS_DEFAULT_CHANNEL_OPS 512
+#define SPDK_BLOB_OPTS_DEFAULT_MAX_CLUSTER_COPIES 4
 #define SPDK_BLOB_BLOBID_HIGH_BIT (1ULL << 32)
 
+/* Number of clusters each channel claims from the used_clusters pool at once
+ * to serve the first writes to clusters of thin provisioned blobs. */
+#define SPDK_BS_CHANNEL_RESERVED_CLUSTERS 16
+
+/* Number of entries in the per channel cache of the ancestors backing clone reads. */
+#define SPDK_BS_CHANNEL_CHAIN_CACHE_SIZE 256
+
+/* Number of batches of sequential writes each channel can have in flight. */
+#define SPDK_BS_CHANNEL_WRITE_BATCHES 4
+
+/* Largest number of writes and of iovs coalesced into a single device write. */
+#define SPDK_BS_WRITE_BATCH_MAX_WRITES 32
+#define SPDK_BS_WRITE_BATCH_MAX_IOVS 64
+
 struct spdk_xattr {
 	uint32_t	index;
 	uint16_t	value_len;
@@ -135,7 +150,7 @@ struct spdk_blob {
 	struct spdk_xattr_tailq xattrs;
 	struct spdk_xattr_tailq xattrs_internal;
 
-	RB_ENTRY(spdk_blob) link;
+	LIST_ENTRY(spdk_blob) link;
 
 	uint32_t frozen_refcnt;
 	bool locked_operation_in_progress;
@@ -151,8 +166,16 @@ struct spdk_blob {
 	/* Number of data clusters retrieved from extent table,
 	 * that many have to be read from extent pages. */
 	uint64_t	remaining_clusters_in_et;
+
+	/* Largest number of clusters of an esnap clone copied per second on first read, 0 if
+	 * copy-on-read is disabled, and when the next one may be copied. Not persisted. */
+	uint32_t	esnap_cor_rate;
+	uint64_t	esnap_cor_next_tsc;
 };
 
+TAILQ_HEAD(spdk_blob_ep_updates, spdk_blob_ep_update);
+LIST_HEAD(spdk_blob_hash_bucket, spdk_blob);
+
 struct spdk_blob_store {
 	uint64_t			md_start; /* Offset from beginning of disk, in pages */
 	uint32_t			md_len; /* Count, in pages */
@@ -160,6 +183,7 @@ struct spdk_blob_store {
 
 	struct spdk_io_channel		*md_channel;
 	uint32_t			max_channel_ops;
+	uint32_t			max_cluster_copies;
 
 	struct spdk_thread		*md_thread;
 
@@ -176,6 +200,10 @@ struct spdk_blob_store {
 	uint64_t			total_clusters;
 	uint64_t			total_data_clusters;
 	uint64_t			num_free_clusters;	/* Protected by used_lock */
+	/* Clusters claimed by the channels but not yet allocated to any blob. */
+	uint64_t			num_reserved_clusters;
+	/* Bumped each time a backing chain may change, invalidates the chain caches. */
+	uint64_t			chain_gen;
 	uint64_t			pages_per_cluster;
 	uint64_t			io_units_per_cluster;
 	uint8_t				pages_per_cluster_shift;
@@ -188,7 +216,11 @@ struct spdk_blob_store {
 	struct spdk_bs_cpl		unload_cpl;
 	int				unload_err;
 
-	RB_HEAD(spdk_blob_tree, spdk_blob) open_blobs;
+	/* Hash table of the open blobs, keyed by blob id */
+	struct spdk_blob_hash_bucket	*open_blobs;
+	uint32_t			num_open_blob_buckets;
+	uint32_t			num_open_blobs;
+
 	TAILQ_HEAD(, spdk_blob_list)	snapshots;
 
 	bool				clean;
@@ -203,6 +235,35 @@ struct spdk_blob_store {
 	uint32_t			esnap_channels_unloading;
 	spdk_bs_op_complete		esnap_unload_cb_fn;
 	void				*esnap_unload_cb_arg;
+
+	/* Extent page updates waiting for the next metadata write batch */
+	struct spdk_blob_ep_updates	ep_updates;
+	bool				ep_batch_in_progress;
+
+	/* Freed clusters waiting for a background unmap before being released */
+	struct spdk_bit_array		*reclaim_clusters;
+	uint64_t			num_reclaim_clusters;
+	uint32_t			reclaim_cursor;
+	uint32_t			reclaim_unmap_depth;
+	uint32_t			reclaim_unmaps_in_flight;
+	bool				reclaim_submit_pending;
+	spdk_bs_op_complete		reclaim_idle_cb_fn;
+	void				*reclaim_idle_cb_arg;
+};
+
+struct spdk_bs_write_batch {
+	struct spdk_bs_channel		*channel;
+	struct spdk_bs_dev_cb_args	cb_args;
+	uint64_t			lba;
+	uint64_t			lba_count;
+	uint32_t			num_writes;
+	int				iovcnt;
+	struct spdk_bs_write_batch_cpl {
+		spdk_blob_op_complete	cb_fn;
+		void			*cb_arg;
+	} writes[SPDK_BS_WRITE_BATCH_MAX_WRITES];
+	struct iovec			iovs[SPDK_BS_WRITE_BATCH_MAX_IOVS];
+	TAILQ_ENTRY(spdk_bs_write_batch) link;
 };
 
 struct spdk_bs_channel {
@@ -214,13 +275,39 @@ struct spdk_bs_channel {
 	struct spdk_bs_dev		*dev;
 	struct spdk_io_channel		*dev_channel;
 
-	/* This page is only used during insert of a new cluster. */
-	struct spdk_blob_md_page	*new_cluster_page;
-
 	TAILQ_HEAD(, spdk_bs_request_set) need_cluster_alloc;
 	TAILQ_HEAD(, spdk_bs_request_set) queued_io;
 
 	RB_HEAD(blob_esnap_channel_tree, blob_esnap_channel) esnap_channels;
+
+	/* Clusters of esnap clones being copied on read, with the reads waiting for them */
+	TAILQ_HEAD(, spdk_blob_esnap_cor) esnap_cors;
+	uint32_t			num_esnap_cors;
+	/* Set while reads are served from the external snapshot, without copying on read */
+	bool				esnap_cor_bypass;
+
+	/* Clusters claimed in bulk from the used_clusters pool, handed out without
+	 * taking used_lock. */
+	uint32_t			reserved_clusters[SPDK_BS_CHANNEL_RESERVED_CLUSTERS];
+	uint32_t			num_reserved_clusters;
+	uint32_t			next_reserved_cluster;
+
+	/* Ancestors that reads of unallocated clusters of clones were last resolved to */
+	struct spdk_bs_chain_cache_entry {
+		struct spdk_blob	*blob;
+		struct spdk_blob	*ancestor;
+		uint64_t		cluster;
+		uint64_t		gen;
+	} chain_cache[SPDK_BS_CHANNEL_CHAIN_CACHE_SIZE];
+
+	/* Sequential writes held back until the end of the current thread iteration, to be
+	 * submitted as a single device write */
+	struct spdk_bs_write_batch	*write_batch_mem;
+	TAILQ_HEAD(, spdk_bs_write_batch) write_batches;
+	struct spdk_bs_write_batch	*write_batch;
+	/* LBA right after the last write submitted on this channel */
+	uint64_t			write_batch_next_lba;
+	bool				write_batch_flush_pending;
 };
 
 /** operation type */
@@ -438,6 +525,7 @@ SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_super_block) == 0x1000, "Invalid super
 
 struct spdk_bs_dev *bs_create_zeroes_dev(void);
 struct spdk_bs_dev *bs_create_blob_bs_dev(struct spdk_blob *blob);
+struct spdk_blob *bs_blob_bs_dev_get_blob(struct spdk_bs_dev *bs_dev);
 struct spdk_io_channel *blob_esnap_get_io_channel(struct spdk_io_channel *ch,
 		struct spdk_blob *blob);
 bool blob_backed_with_zeroes_dev(struct spdk_blob *blob);
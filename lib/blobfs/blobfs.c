@@ -35,6 +35,10 @@ static TAILQ_HEAD(, spdk_file) g_caches = TAILQ_HEAD_INITIALIZER(g_caches);
 static struct spdk_poller *g_cache_pool_mgmt_poller;
 static struct spdk_thread *g_cache_pool_thread;
 #define BLOBFS_CACHE_POOL_POLL_PERIOD_IN_US 1000ULL
+/* Maximum number of cache buffers freed from one file at a time, so that reclaiming
+ * never drops the whole cache of a large file while it is still being read.
+ */
+#define BLOBFS_CACHE_RECLAIM_BATCH 64
 static int g_fs_count = 0;
 static pthread_mutex_t g_cache_init_lock = PTHREAD_MUTEX_INITIALIZER;
 
@@ -86,6 +90,11 @@ cache_buffer_free(struct cache_buffer *cache_buffer)
 }
 
 #define CACHE_READAHEAD_THRESHOLD	(128 * 1024)
+/* The readahead window grows with the length of the sequential stream, but is kept
+ * to the minimum while the cache pool is short on buffers.
+ */
+#define CACHE_READAHEAD_MIN_BUFFERS	2
+#define CACHE_READAHEAD_MAX_BUFFERS	16
 
 struct spdk_file {
 	struct spdk_filesystem	*fs;
@@ -100,6 +109,8 @@ struct spdk_file {
 	uint64_t		seq_byte_count;
 	uint64_t		next_seq_offset;
 	uint32_t		priority;
+	/* Set when the cache is read, cleared by the reclaim to give the file a second chance */
+	bool			cache_referenced;
 	TAILQ_ENTRY(spdk_file)	tailq;
 	spdk_blob_id		blobid;
 	uint32_t		ref_count;
@@ -1998,10 +2009,11 @@ spdk_fs_get_cache_size(void)
 
 static void __file_flush(void *ctx);
 
-/* Try to free some cache buffers from this file.
+/* Try to free some cache buffers from this file. With second_chance, a file
+ * whose cache was read since the last pass is skipped and moved to the end of the queue.
  */
 static int
-reclaim_cache_buffers(struct spdk_file *file)
+reclaim_cache_buffers(struct spdk_file *file, bool second_chance)
 {
 	int rc;
 
@@ -2020,7 +2032,16 @@ reclaim_cache_buffers(struct spdk_file *file)
 		pthread_spin_unlock(&file->lock);
 		return -1;
 	}
-	tree_free_buffers(file->tree);
+
+	if (second_chance && file->cache_referenced) {
+		file->cache_referenced = false;
+		TAILQ_REMOVE(&g_caches, file, cache_tailq);
+		TAILQ_INSERT_TAIL(&g_caches, file, cache_tailq);
+		pthread_spin_unlock(&file->lock);
+		return -1;
+	}
+
+	tree_free_buffers_limit(file->tree, BLOBFS_CACHE_RECLAIM_BATCH);
 
 	TAILQ_REMOVE(&g_caches, file, cache_tailq);
 	/* If not freed, put it in the end of the queue */
@@ -2054,7 +2075,7 @@ _blobfs_cache_pool_reclaim(void *arg)
 	TAILQ_FOREACH_SAFE(file, &g_caches, cache_tailq, tmp) {
 		if (!file->open_for_writing &&
 		    file->priority == SPDK_FILE_PRIORITY_LOW) {
-			rc = reclaim_cache_buffers(file);
+			rc = reclaim_cache_buffers(file, true);
 			if (rc < 0) {
 				continue;
 			}
@@ -2067,7 +2088,7 @@ _blobfs_cache_pool_reclaim(void *arg)
 
 	TAILQ_FOREACH_SAFE(file, &g_caches, cache_tailq, tmp) {
 		if (!file->open_for_writing) {
-			rc = reclaim_cache_buffers(file);
+			rc = reclaim_cache_buffers(file, true);
 			if (rc < 0) {
 				continue;
 			}
@@ -2079,7 +2100,7 @@ _blobfs_cache_pool_reclaim(void *arg)
 	}
 
 	TAILQ_FOREACH_SAFE(file, &g_caches, cache_tailq, tmp) {
-		rc = reclaim_cache_buffers(file);
+		rc = reclaim_cache_buffers(file, false);
 		if (rc < 0) {
 			continue;
 		}
@@ -2172,8 +2193,9 @@ static void
 __file_cache_finish_sync(void *ctx, int bserrno)
 {
 	struct spdk_file *file;
-	struct spdk_fs_request *sync_req = ctx;
+	struct spdk_fs_request *sync_req = ctx, *req, *tmp;
 	struct spdk_fs_cb_args *sync_args;
+	TAILQ_HEAD(, spdk_fs_request) completed = TAILQ_HEAD_INITIALIZER(completed);
 
 	sync_args = &sync_req->args;
 	file = sync_args->file;
@@ -2183,12 +2205,24 @@ __file_cache_finish_sync(void *ctx, int bserrno)
 	spdk_trace_record(TRACE_BLOBFS_XATTR_END, 0, sync_args->op.sync.offset,
 			  0, file->name);
 	BLOBFS_TRACE(file, "sync done offset=%jx\n", sync_args->op.sync.offset);
-	TAILQ_REMOVE(&file->sync_requests, sync_req, args.op.sync.tailq);
+	/*
+	 * The persisted length covers every sync request up to it, so complete them
+	 *  all with this one md sync instead of syncing the md again for each of them.
+	 */
+	TAILQ_FOREACH_SAFE(req, &file->sync_requests, args.op.sync.tailq, tmp) {
+		if (req == sync_req || (!req->args.op.sync.xattr_in_progress &&
+					req->args.op.sync.offset <= sync_args->op.sync.length)) {
+			TAILQ_REMOVE(&file->sync_requests, req, args.op.sync.tailq);
+			TAILQ_INSERT_TAIL(&completed, req, args.op.sync.tailq);
+		}
+	}
 	pthread_spin_unlock(&file->lock);
 
-	sync_args->fn.file_op(sync_args->arg, bserrno);
-
-	free_fs_request(sync_req);
+	TAILQ_FOREACH_SAFE(req, &completed, args.op.sync.tailq, tmp) {
+		TAILQ_REMOVE(&completed, req, args.op.sync.tailq);
+		req->args.fn.file_op(req->args.arg, bserrno);
+		free_fs_request(req);
+	}
 	__check_sync_reqs(file);
 }
 
@@ -2575,7 +2609,7 @@ __next_cache_buffer_offset(uint64_t offset)
 	return (offset + CACHE_BUFFER_SIZE) & ~(CACHE_TREE_LEVEL_MASK(0));
 }
 
-static void
+static int
 check_readahead(struct spdk_file *file, uint64_t offset,
 		struct spdk_fs_channel *channel)
 {
@@ -2583,13 +2617,16 @@ check_readahead(struct spdk_file *file, uint64_t offset,
 	struct spdk_fs_cb_args *args;
 
 	offset = __next_cache_buffer_offset(offset);
-	if (tree_find_buffer(file->tree, offset) != NULL || file->length <= offset) {
-		return;
+	if (file->length <= offset) {
+		return -ERANGE;
+	}
+	if (tree_find_buffer(file->tree, offset) != NULL) {
+		return 0;
 	}
 
 	req = alloc_fs_request(channel);
 	if (req == NULL) {
-		return;
+		return -ENOMEM;
 	}
 	args = &req->args;
 
@@ -2601,7 +2638,7 @@ check_readahead(struct spdk_file *file, uint64_t offset,
 	if (!args->op.readahead.cache_buffer) {
 		BLOBFS_TRACE(file, "Cannot allocate buf for offset=%jx\n", offset);
 		free_fs_request(req);
-		return;
+		return -ENOMEM;
 	}
 
 	args->op.readahead.cache_buffer->in_progress = true;
@@ -2611,6 +2648,29 @@ check_readahead(struct spdk_file *file, uint64_t offset,
 		args->op.readahead.length = CACHE_BUFFER_SIZE;
 	}
 	file->fs->send_request(__readahead, req);
+
+	return 0;
+}
+
+static void
+file_readahead(struct spdk_file *file, uint64_t offset, struct spdk_fs_channel *channel)
+{
+	uint64_t num_buffers;
+	uint32_t i;
+
+	num_buffers = file->seq_byte_count / CACHE_BUFFER_SIZE;
+	if (num_buffers > CACHE_READAHEAD_MAX_BUFFERS) {
+		num_buffers = CACHE_READAHEAD_MAX_BUFFERS;
+	}
+	if (num_buffers < CACHE_READAHEAD_MIN_BUFFERS || blobfs_cache_pool_need_reclaim()) {
+		num_buffers = CACHE_READAHEAD_MIN_BUFFERS;
+	}
+
+	for (i = 0; i < num_buffers; i++) {
+		if (check_readahead(file, offset + i * CACHE_BUFFER_SIZE, channel) != 0) {
+			break;
+		}
+	}
 }
 
 int64_t
@@ -2645,8 +2705,7 @@ spdk_file_read(struct spdk_file *file, struct spdk_fs_thread_ctx *ctx,
 	file->seq_byte_count += length;
 	file->next_seq_offset = offset + length;
 	if (file->seq_byte_count >= CACHE_READAHEAD_THRESHOLD) {
-		check_readahead(file, offset, channel);
-		check_readahead(file, offset + CACHE_BUFFER_SIZE, channel);
+		file_readahead(file, offset, channel);
 	}
 
 	arg.channel = channel;
@@ -2675,6 +2734,7 @@ spdk_file_read(struct spdk_file *file, struct spdk_fs_thread_ctx *ctx,
 			}
 			BLOBFS_TRACE(file, "read %p offset=%ju length=%ju\n", payload, offset, read_len);
 			memcpy(payload, &buf->buf[offset - buf->offset], read_len);
+			file->cache_referenced = true;
 			if ((offset + read_len) % CACHE_BUFFER_SIZE == 0) {
 				tree_remove_buffer(file->tree, buf);
 				if (file->tree->present_mask == 0) {
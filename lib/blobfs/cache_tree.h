@@ -40,6 +40,8 @@ void cache_buffer_free(struct cache_buffer *cache_buffer);
 
 struct cache_tree *tree_insert_buffer(struct cache_tree *root, struct cache_buffer *buffer);
 void tree_free_buffers(struct cache_tree *tree);
+/* Free at most max_buffers clean buffers, return the number of buffers freed. */
+uint32_t tree_free_buffers_limit(struct cache_tree *tree, uint32_t max_buffers);
 struct cache_buffer *tree_find_buffer(struct cache_tree *tree, uint64_t offset);
 struct cache_buffer *tree_find_filled_buffer(struct cache_tree *tree, uint64_t offset);
 void tree_remove_buffer(struct cache_tree *tree, struct cache_buffer *buffer);
@@ -112,32 +112,33 @@ tree_remove_buffer(struct cache_tree *tree, struct cache_buffer *buffer)
 	}
 }
 
-void
-tree_free_buffers(struct cache_tree *tree)
+uint32_t
+tree_free_buffers_limit(struct cache_tree *tree, uint32_t max_buffers)
 {
 	struct cache_buffer *buffer;
 	struct cache_tree *child;
-	uint32_t i;
+	uint32_t i, freed = 0;
 
 	if (tree->present_mask == 0) {
-		return;
+		return 0;
 	}
 
 	if (tree->level == 0) {
-		for (i = 0; i < CACHE_TREE_WIDTH; i++) {
+		for (i = 0; i < CACHE_TREE_WIDTH && freed < max_buffers; i++) {
 			buffer = tree->u.buffer[i];
 			if (buffer != NULL && buffer->in_progress == false &&
 			    buffer->bytes_filled == buffer->bytes_flushed) {
 				cache_buffer_free(buffer);
 				tree->u.buffer[i] = NULL;
 				tree->present_mask &= ~(1ULL << i);
+				freed++;
 			}
 		}
 	} else {
-		for (i = 0; i < CACHE_TREE_WIDTH; i++) {
+		for (i = 0; i < CACHE_TREE_WIDTH && freed < max_buffers; i++) {
 			child = tree->u.tree[i];
 			if (child != NULL) {
-				tree_free_buffers(child);
+				freed += tree_free_buffers_limit(child, max_buffers - freed);
 				if (child->present_mask == 0) {
 					free(child);
 					tree->u.tree[i] = NULL;
@@ -146,4 +147,12 @@ tree_free_buffers(struct cache_tree *tree)
 			}
 		}
 	}
+
+	return freed;
+}
+
+void
+tree_free_buffers(struct cache_tree *tree)
+{
+	tree_free_buffers_limit(tree, UINT32_MAX);
 }
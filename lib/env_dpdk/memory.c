@@ -101,11 +101,31 @@ struct spdk_mem_map {
 	struct map_256tb map_256tb;
 	pthread_mutex_t mutex;
 	uint64_t default_translation;
+	/* Changed on every update of the translations, see struct mem_map_tlb_entry */
+	uint64_t generation;
 	struct spdk_mem_map_ops ops;
 	void *cb_ctx;
 	TAILQ_ENTRY(spdk_mem_map) tailq;
 };
 
+/* Number of entries of the per-thread translation cache, must be a power of 2 */
+#define MEM_MAP_TLB_SIZE	64
+
+/* Per-thread, direct-mapped cache of 2MB page translations, shared by all maps.
+ * An entry is only valid as long as the generation of its map hasn't changed.
+ * The generations are taken from a global counter, so a map allocated at the
+ * address of a freed one can't hit the entries of the latter.
+ */
+struct mem_map_tlb_entry {
+	const struct spdk_mem_map *map;
+	uint64_t vfn_2mb;
+	uint64_t generation;
+	uint64_t translation;
+};
+
+static __thread struct mem_map_tlb_entry g_mem_map_tlb[MEM_MAP_TLB_SIZE];
+static uint64_t g_mem_map_generation;
+
 /* Registrations map. The 64 bit translations are bit fields with the
  * following layout (starting with the low bits):
  *    0 - 61 : reserved
@@ -270,6 +290,7 @@ spdk_mem_map_alloc(uint64_t default_translation, const struct spdk_mem_map_ops *
 	}
 
 	map->default_translation = default_translation;
+	map->generation = __atomic_add_fetch(&g_mem_map_generation, 1, __ATOMIC_RELAXED);
 	map->cb_ctx = cb_ctx;
 	if (ops) {
 		map->ops = *ops;
@@ -576,6 +597,21 @@ mem_map_get_map_1gb(struct spdk_mem_map *map, uint64_t vfn_2mb)
 	return map_1gb;
 }
 
+/* Invalidate the cached translations of a map on all threads. Must be called after
+ * the map was updated, the release ordering pairs with the acquire in spdk_mem_map_translate(). */
+static void
+mem_map_invalidate_tlb(struct spdk_mem_map *map)
+{
+	__atomic_store_n(&map->generation, __atomic_add_fetch(&g_mem_map_generation, 1, __ATOMIC_RELAXED),
+			 __ATOMIC_RELEASE);
+}
+
+static inline struct mem_map_tlb_entry *
+mem_map_get_tlb_entry(const struct spdk_mem_map *map, uint64_t vfn_2mb)
+{
+	return &g_mem_map_tlb[(vfn_2mb ^ ((uintptr_t)map >> 6)) & (MEM_MAP_TLB_SIZE - 1)];
+}
+
 int
 spdk_mem_map_set_translation(struct spdk_mem_map *map, uint64_t vaddr, uint64_t size,
 			     uint64_t translation)
@@ -603,6 +639,7 @@ spdk_mem_map_set_translation(struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 		map_1gb = mem_map_get_map_1gb(map, vfn_2mb);
 		if (!map_1gb) {
 			DEBUG_PRINT("could not get %p map\n", (void *)vaddr);
+			mem_map_invalidate_tlb(map);
 			return -ENOMEM;
 		}
 
@@ -614,6 +651,8 @@ spdk_mem_map_set_translation(struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 		vfn_2mb++;
 	}
 
+	mem_map_invalidate_tlb(map);
+
 	return 0;
 }
 
@@ -628,12 +667,14 @@ spdk_mem_map_translate(const struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 {
 	const struct map_1gb *map_1gb;
 	const struct map_2mb *map_2mb;
+	struct mem_map_tlb_entry *tlb;
 	uint64_t idx_256tb;
 	uint64_t idx_1gb;
 	uint64_t vfn_2mb;
 	uint64_t cur_size;
 	uint64_t prev_translation;
 	uint64_t orig_translation;
+	uint64_t generation;
 
 	if (spdk_unlikely(vaddr & ~MASK_256TB)) {
 		DEBUG_PRINT("invalid usermode virtual address %p\n", (void *)vaddr);
@@ -641,6 +682,23 @@ spdk_mem_map_translate(const struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 	}
 
 	vfn_2mb = vaddr >> SHIFT_2MB;
+	cur_size = VALUE_2MB - _2MB_OFFSET(vaddr);
+	generation = __atomic_load_n(&map->generation, __ATOMIC_ACQUIRE);
+	tlb = mem_map_get_tlb_entry(map, vfn_2mb);
+	if (spdk_likely(tlb->map == map && tlb->vfn_2mb == vfn_2mb && tlb->generation == generation)) {
+		orig_translation = tlb->translation;
+		if (size == NULL) {
+			return orig_translation;
+		}
+
+		/* Walking the following pages is only needed if the region spans them */
+		if (*size <= cur_size || map->ops.are_contiguous == NULL ||
+		    orig_translation == map->default_translation) {
+			*size = spdk_min(*size, cur_size);
+			return orig_translation;
+		}
+	}
+
 	idx_256tb = MAP_256TB_IDX(vfn_2mb);
 	idx_1gb = MAP_1GB_IDX(vfn_2mb);
 
@@ -649,17 +707,21 @@ spdk_mem_map_translate(const struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 		return map->default_translation;
 	}
 
-	cur_size = VALUE_2MB - _2MB_OFFSET(vaddr);
 	map_2mb = &map_1gb->map[idx_1gb];
+	orig_translation = map_2mb->translation_2mb;
+	tlb->map = map;
+	tlb->vfn_2mb = vfn_2mb;
+	tlb->generation = generation;
+	tlb->translation = orig_translation;
+
 	if (size == NULL || map->ops.are_contiguous == NULL ||
-	    map_2mb->translation_2mb == map->default_translation) {
+	    orig_translation == map->default_translation) {
 		if (size != NULL) {
 			*size = spdk_min(*size, cur_size);
 		}
-		return map_2mb->translation_2mb;
+		return orig_translation;
 	}
 
-	orig_translation = map_2mb->translation_2mb;
 	prev_translation = orig_translation;
 	while (cur_size < *size) {
 		vfn_2mb++;
@@ -1582,6 +1644,24 @@ spdk_vtophys(const void *buf, uint64_t *size)
 	}
 }
 
+int
+spdk_vtophys_iov(const struct iovec *iovs, int iovcnt, uint64_t *paddrs)
+{
+	uint64_t size;
+	int i;
+
+	for (i = 0; i < iovcnt; i++) {
+		size = iovs[i].iov_len;
+		paddrs[i] = spdk_vtophys(iovs[i].iov_base, &size);
+		if (spdk_unlikely(paddrs[i] == SPDK_VTOPHYS_ERROR || size < iovs[i].iov_len)) {
+			paddrs[i] = SPDK_VTOPHYS_ERROR;
+			break;
+		}
+	}
+
+	return i;
+}
+
 int32_t
 spdk_mem_get_numa_id(const void *buf, uint64_t *size)
 {
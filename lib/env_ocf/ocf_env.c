@@ -70,7 +70,7 @@ env_allocator_create_extended(uint32_t size, const char *name, int limit, bool z
 	allocator->mempool = spdk_mempool_create(qualified_name,
 			     GET_ELEMENTS_COUNT(limit), size,
 			     SPDK_MEMPOOL_DEFAULT_CACHE_SIZE,
-			     SPDK_ENV_NUMA_ID_ANY);
+			     env_numa_id());
 
 	if (!allocator->mempool) {
 		SPDK_ERRLOG("mempool creation failed\n");
@@ -115,12 +115,20 @@ env_crc32(uint32_t crc, uint8_t const *message, size_t len)
 /* EXECUTION CONTEXTS */
 pthread_mutex_t *exec_context_mutex;
 
+/* Number of online CPUs. There are twice as many execution contexts: the first half belongs to
+ * the reactors, one per core, the second half is shared by the other threads, one per CPU. */
+static unsigned g_exec_context_cpus;
+
 static void
 __attribute__((constructor)) init_execution_context(void)
 {
-	unsigned count = env_get_execution_context_count();
+	int num = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned count;
 	unsigned i;
 
+	g_exec_context_cpus = (num == -1) ? 0 : num;
+	count = env_get_execution_context_count();
+
 	ENV_BUG_ON(count == 0);
 	exec_context_mutex = malloc(count * sizeof(exec_context_mutex[0]));
 	ENV_BUG_ON(exec_context_mutex == NULL);
@@ -145,33 +153,40 @@ __attribute__((destructor)) deinit_execution_context(void)
 }
 
 /* get_execution_context must assure that after the call finishes, the caller
- * will not get preempted from current execution context. For userspace env
- * we simulate this behavior by acquiring per execution context mutex. As a
- * result the caller might actually get preempted, but no other thread will
+ * will not get preempted from current execution context. A reactor runs its
+ * SPDK threads cooperatively on its own core, so nothing else executes in the
+ * context of the core until the caller puts it and no lock is taken. For other
+ * threads we simulate this behavior by acquiring per execution context mutex.
+ * As a result the caller might actually get preempted, but no other thread will
  * execute in this context by the time the caller puts current execution ctx. */
 unsigned
 env_get_execution_context(void)
 {
-	unsigned cpu;
+	uint32_t core = spdk_env_get_current_core();
+	int cpu;
+
+	if (spdk_likely(core < g_exec_context_cpus)) {
+		return core;
+	}
 
 	cpu = sched_getcpu();
-	cpu = (cpu == -1) ?  0 : cpu;
+	cpu = (cpu == -1) ?  0 : cpu % g_exec_context_cpus;
 
-	ENV_BUG_ON(pthread_mutex_lock(&exec_context_mutex[cpu]));
+	ENV_BUG_ON(pthread_mutex_lock(&exec_context_mutex[g_exec_context_cpus + cpu]));
 
-	return cpu;
+	return g_exec_context_cpus + cpu;
 }
 
 void
 env_put_execution_context(unsigned ctx)
 {
-	pthread_mutex_unlock(&exec_context_mutex[ctx]);
+	if (ctx >= g_exec_context_cpus) {
+		pthread_mutex_unlock(&exec_context_mutex[ctx]);
+	}
 }
 
 unsigned
 env_get_execution_context_count(void)
 {
-	int num = sysconf(_SC_NPROCESSORS_ONLN);
-
-	return (num == -1) ? 0 : num;
+	return g_exec_context_cpus * 2;
 }
@@ -91,17 +91,31 @@ typedef uint64_t sector_t;
 
 #define container_of(ptr, type, member) SPDK_CONTAINEROF(ptr, type, member)
 
+/* NUMA node of the core the caller runs on. OCF allocates its metadata and request pools
+ * from the reactor setting up the cache, keep them on the memory local to that reactor. */
+static inline int32_t
+env_numa_id(void)
+{
+	uint32_t core = spdk_env_get_current_core();
+
+	if (core == SPDK_ENV_LCORE_ID_ANY) {
+		return SPDK_ENV_NUMA_ID_ANY;
+	}
+
+	return spdk_env_get_numa_id(core);
+}
+
 static inline void *
 env_malloc(size_t size, int flags)
 {
-	return spdk_malloc(size, 0, NULL, SPDK_ENV_LCORE_ID_ANY,
+	return spdk_malloc(size, 0, NULL, env_numa_id(),
 			   SPDK_MALLOC_DMA);
 }
 
 static inline void *
 env_zalloc(size_t size, int flags)
 {
-	return spdk_zmalloc(size, 0, NULL, SPDK_ENV_LCORE_ID_ANY,
+	return spdk_zmalloc(size, 0, NULL, env_numa_id(),
 			    SPDK_MALLOC_DMA);
 }
 
@@ -114,7 +128,7 @@ env_free(const void *ptr)
 static inline void *
 env_vmalloc(size_t size)
 {
-	return spdk_malloc(size, 0, NULL, SPDK_ENV_LCORE_ID_ANY,
+	return spdk_malloc(size, 0, NULL, env_numa_id(),
 			   SPDK_MALLOC_DMA);
 }
 
@@ -123,7 +137,7 @@ env_vzalloc(size_t size)
 {
 	/* TODO: raw_ram init can request huge amount of memory to store
 	 * hashtable in it. need to ensure that allocation succeeds */
-	return spdk_zmalloc(size, 0, NULL, SPDK_ENV_LCORE_ID_ANY,
+	return spdk_zmalloc(size, 0, NULL, env_numa_id(),
 			    SPDK_MALLOC_DMA);
 }
 
@@ -136,7 +150,7 @@ env_vzalloc_flags(size_t size, int flags)
 static inline void *
 env_secure_alloc(size_t size)
 {
-	return spdk_zmalloc(size, 0, NULL, SPDK_ENV_LCORE_ID_ANY,
+	return spdk_zmalloc(size, 0, NULL, env_numa_id(),
 			    SPDK_MALLOC_DMA);
 }
 
@@ -149,6 +149,8 @@ static const struct option g_cmdline_options[] = {
 	{"no-rpc-server",		no_argument,		NULL, NO_RPC_SERVER_OPT_IDX},
 #define ENFORCE_NUMA_OPT_IDX 274
 	{"enforce-numa",		no_argument,		NULL, ENFORCE_NUMA_OPT_IDX},
+#define LOG_ASYNC_OPT_IDX	275
+	{"log-async",			no_argument,		NULL, LOG_ASYNC_OPT_IDX},
 };
 
 static int
@@ -327,6 +329,7 @@ spdk_app_opts_init(struct spdk_app_opts *opts, size_t opts_size)
 	SET_FIELD(rpc_log_file, NULL);
 	SET_FIELD(rpc_log_level, SPDK_LOG_DISABLED);
 	SET_FIELD(disable_cpumask_locks, false);
+	SET_FIELD(log_async, false);
 #undef SET_FIELD
 }
 
@@ -691,10 +694,11 @@ app_copy_opts(struct spdk_app_opts *opts, struct spdk_app_opts *opts_user, size_
 	SET_FIELD(json_data);
 	SET_FIELD(json_data_size);
 	SET_FIELD(disable_cpumask_locks);
+	SET_FIELD(log_async);
 
 	/* You should not remove this statement, but need to update the assert statement
 	 * if you add a new field, and also add a corresponding SET_FIELD statement */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_app_opts) == 253, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_app_opts) == 254, "Incorrect size");
 
 #undef SET_FIELD
 }
@@ -901,6 +905,9 @@ spdk_app_start(struct spdk_app_opts *opts_user, spdk_msg_fn start_fn,
 	calculate_mempool_size(opts, opts_user);
 
 	spdk_log_open(opts->log);
+	if (opts->log_async && spdk_log_enable_async(true) != 0) {
+		SPDK_WARNLOG("Unable to enable asynchronous logging\n");
+	}
 
 	/* Initialize each lock to -1 to indicate "empty" status */
 	for (i = 0; i < SPDK_CONFIG_MAX_LCORES; i++) {
@@ -1136,6 +1143,7 @@ usage(void (*app_usage)(void))
 	printf("\nLog options:\n");
 	spdk_log_usage(stdout, "-L");
 	printf("     --silence-noticelog   disable notice level logging to stderr\n");
+	printf("     --log-async           write log messages from a separate thread, rate limited per call site\n");
 
 	printf("\nTrace options:\n");
 	printf("     --num-trace-entries <num>   number of trace entries for each core, must be power of 2,\n");
@@ -1294,6 +1302,9 @@ spdk_app_parse_args(int argc, char **argv, struct spdk_app_opts *opts,
 		case SILENCE_NOTICELOG_OPT_IDX:
 			opts->print_level = SPDK_LOG_WARN;
 			break;
+		case LOG_ASYNC_OPT_IDX:
+			opts->log_async = true;
+			break;
 		case RPC_SOCKET_OPT_IDX:
 			opts->rpc_addr = optarg;
 			break;
@@ -125,12 +125,58 @@ rpc_framework_monitor_context_switch(struct spdk_jsonrpc_request *request,
 SPDK_RPC_REGISTER("framework_monitor_context_switch", rpc_framework_monitor_context_switch,
 		  SPDK_RPC_RUNTIME)
 
+struct rpc_framework_interrupt_poll_window {
+	uint64_t window_us;
+};
+
+static const struct spdk_json_object_decoder rpc_framework_interrupt_poll_window_decoders[] = {
+	{"window_us", offsetof(struct rpc_framework_interrupt_poll_window, window_us), spdk_json_decode_uint64},
+};
+
+static void
+rpc_framework_interrupt_poll_window(struct spdk_jsonrpc_request *request,
+				    const struct spdk_json_val *params)
+{
+	struct rpc_framework_interrupt_poll_window req = {};
+	struct spdk_json_write_ctx *w;
+
+	if (params != NULL) {
+		if (spdk_json_decode_object(params, rpc_framework_interrupt_poll_window_decoders,
+					    SPDK_COUNTOF(rpc_framework_interrupt_poll_window_decoders),
+					    &req)) {
+			SPDK_DEBUGLOG(app_rpc, "spdk_json_decode_object failed\n");
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+			return;
+		}
+
+		spdk_framework_set_interrupt_poll_window(req.window_us);
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_object_begin(w);
+
+	spdk_json_write_named_uint64(w, "window_us", spdk_framework_get_interrupt_poll_window());
+
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(request, w);
+}
+
+SPDK_RPC_REGISTER("framework_interrupt_poll_window", rpc_framework_interrupt_poll_window,
+		  SPDK_RPC_STARTUP | SPDK_RPC_RUNTIME)
+
 struct rpc_get_stats_ctx {
 	struct spdk_jsonrpc_request *request;
 	struct spdk_json_write_ctx *w;
 	uint64_t now;
+	/* Stats generation of this report, 0 if it isn't tracked */
+	uint64_t generation;
+	/* Only report the pollers that changed since this generation, 0 to report all of them */
+	uint64_t since_generation;
 };
 
+/* Last stats generation handed out, only accessed from the RPC thread */
+static uint64_t g_stats_generation;
+
 static void
 rpc_thread_get_stats_done(void *arg)
 {
@@ -144,7 +190,8 @@ rpc_thread_get_stats_done(void *arg)
 }
 
 static void
-rpc_thread_get_stats_for_each(struct spdk_jsonrpc_request *request, spdk_msg_fn fn)
+rpc_thread_get_stats_for_each(struct spdk_jsonrpc_request *request, spdk_msg_fn fn,
+			      uint64_t generation, uint64_t since_generation)
 {
 	struct rpc_get_stats_ctx *ctx;
 
@@ -155,10 +202,15 @@ rpc_thread_get_stats_for_each(struct spdk_jsonrpc_request *request, spdk_msg_fn
 		return;
 	}
 	ctx->request = request;
+	ctx->generation = generation;
+	ctx->since_generation = since_generation;
 
 	ctx->w = spdk_jsonrpc_begin_result(ctx->request);
 	spdk_json_write_object_begin(ctx->w);
 	spdk_json_write_named_uint64(ctx->w, "tick_rate", spdk_get_ticks_hz());
+	if (generation != 0) {
+		spdk_json_write_named_uint64(ctx->w, "generation", generation);
+	}
 	spdk_json_write_named_array_begin(ctx->w, "threads");
 
 	spdk_for_each_thread(fn, ctx, rpc_thread_get_stats_done);
@@ -217,7 +269,7 @@ rpc_thread_get_stats(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
-	rpc_thread_get_stats_for_each(request, _rpc_thread_get_stats);
+	rpc_thread_get_stats_for_each(request, _rpc_thread_get_stats, 0, 0);
 }
 
 SPDK_RPC_REGISTER("thread_get_stats", rpc_thread_get_stats, SPDK_RPC_RUNTIME)
@@ -237,6 +289,9 @@ rpc_get_poller(struct spdk_poller *poller, struct spdk_json_write_ctx *w)
 	spdk_json_write_named_string(w, "state", spdk_poller_get_state_str(poller));
 	spdk_json_write_named_uint64(w, "run_count", stats.run_count);
 	spdk_json_write_named_uint64(w, "busy_count", stats.busy_count);
+	spdk_json_write_named_uint64(w, "busy_tsc", stats.busy_tsc);
+	spdk_json_write_named_uint64(w, "idle_tsc", stats.idle_tsc);
+	spdk_json_write_named_uint64(w, "max_run_tsc", stats.max_run_tsc);
 	if (period_ticks) {
 		spdk_json_write_named_uint64(w, "period_ticks", period_ticks);
 	}
@@ -249,46 +304,83 @@ _rpc_thread_get_pollers(void *arg)
 	struct rpc_get_stats_ctx *ctx = arg;
 	struct spdk_thread *thread = spdk_get_thread();
 	struct spdk_poller *poller;
+	bool delta;
+
+	/* Pollers can only be skipped if the thread's list of pollers is known to be unchanged */
+	delta = ctx->since_generation != 0 &&
+		!spdk_thread_pollers_changed(thread, ctx->since_generation);
 
 	spdk_json_write_object_begin(ctx->w);
 	spdk_json_write_named_string(ctx->w, "name", spdk_thread_get_name(thread));
 	spdk_json_write_named_uint64(ctx->w, "id", spdk_thread_get_id(thread));
+	if (ctx->since_generation != 0) {
+		spdk_json_write_named_bool(ctx->w, "delta", delta);
+	}
 
 	spdk_json_write_named_array_begin(ctx->w, "active_pollers");
 	for (poller = spdk_thread_get_first_active_poller(thread); poller != NULL;
 	     poller = spdk_thread_get_next_active_poller(poller)) {
-		rpc_get_poller(poller, ctx->w);
+		if (!delta || spdk_poller_stats_changed(poller, ctx->since_generation)) {
+			rpc_get_poller(poller, ctx->w);
+		}
 	}
 	spdk_json_write_array_end(ctx->w);
 
 	spdk_json_write_named_array_begin(ctx->w, "timed_pollers");
 	for (poller = spdk_thread_get_first_timed_poller(thread); poller != NULL;
 	     poller = spdk_thread_get_next_timed_poller(poller)) {
-		rpc_get_poller(poller, ctx->w);
+		if (!delta || spdk_poller_stats_changed(poller, ctx->since_generation)) {
+			rpc_get_poller(poller, ctx->w);
+		}
 	}
 	spdk_json_write_array_end(ctx->w);
 
 	spdk_json_write_named_array_begin(ctx->w, "paused_pollers");
 	for (poller = spdk_thread_get_first_paused_poller(thread); poller != NULL;
 	     poller = spdk_thread_get_next_paused_poller(poller)) {
-		rpc_get_poller(poller, ctx->w);
+		if (!delta || spdk_poller_stats_changed(poller, ctx->since_generation)) {
+			rpc_get_poller(poller, ctx->w);
+		}
 	}
 	spdk_json_write_array_end(ctx->w);
 
 	spdk_json_write_object_end(ctx->w);
+
+	spdk_thread_set_stats_generation(thread, ctx->generation);
 }
 
+struct rpc_thread_get_pollers {
+	uint64_t generation;
+};
+
+static const struct spdk_json_object_decoder rpc_thread_get_pollers_decoders[] = {
+	{"generation", offsetof(struct rpc_thread_get_pollers, generation), spdk_json_decode_uint64, true},
+};
+
 static void
 rpc_thread_get_pollers(struct spdk_jsonrpc_request *request,
 		       const struct spdk_json_val *params)
 {
-	if (params) {
-		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
-						 "'thread_get_pollers' requires no arguments");
-		return;
+	struct rpc_thread_get_pollers req = {};
+
+	if (params != NULL) {
+		if (spdk_json_decode_object(params, rpc_thread_get_pollers_decoders,
+					    SPDK_COUNTOF(rpc_thread_get_pollers_decoders), &req)) {
+			SPDK_DEBUGLOG(app_rpc, "spdk_json_decode_object failed\n");
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+							 "Invalid parameters");
+			return;
+		}
+
+		if (req.generation > g_stats_generation) {
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+							 "Unknown generation");
+			return;
+		}
 	}
 
-	rpc_thread_get_stats_for_each(request, _rpc_thread_get_pollers);
+	rpc_thread_get_stats_for_each(request, _rpc_thread_get_pollers, ++g_stats_generation,
+				      req.generation);
 }
 
 SPDK_RPC_REGISTER("thread_get_pollers", rpc_thread_get_pollers, SPDK_RPC_RUNTIME)
@@ -332,7 +424,7 @@ rpc_thread_get_io_channels(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
-	rpc_thread_get_stats_for_each(request, _rpc_thread_get_io_channels);
+	rpc_thread_get_stats_for_each(request, _rpc_thread_get_io_channels, 0, 0);
 }
 
 SPDK_RPC_REGISTER("thread_get_io_channels", rpc_thread_get_io_channels, SPDK_RPC_RUNTIME);
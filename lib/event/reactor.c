@@ -31,6 +31,8 @@
 #endif
 
 #define SPDK_EVENT_BATCH_SIZE		8
+#define SPDK_EVENT_BATCH_SIZE_MAX	64
+#define SPDK_EVENT_PRIORITY_RING_SIZE	4096
 
 static struct spdk_reactor *g_reactors;
 static uint32_t g_reactor_count;
@@ -39,6 +41,10 @@ static enum spdk_reactor_state	g_reactor_state = SPDK_REACTOR_STATE_UNINITIALIZE
 
 static bool g_framework_context_switch_monitor_enabled = true;
 
+/* How long a reactor in interrupt mode keeps checking for events after a wakeup */
+static uint64_t g_interrupt_poll_window_us;
+static uint64_t g_interrupt_poll_window_tsc;
+
 static struct spdk_mempool *g_spdk_event_mempool = NULL;
 
 TAILQ_HEAD(, spdk_scheduler) g_scheduler_list
@@ -219,6 +225,14 @@ reactor_construct(struct spdk_reactor *reactor, uint32_t lcore)
 		assert(false);
 	}
 
+	reactor->priority_events = spdk_ring_create(SPDK_RING_TYPE_MP_SC, SPDK_EVENT_PRIORITY_RING_SIZE,
+				   SPDK_ENV_NUMA_ID_ANY);
+	if (reactor->priority_events == NULL) {
+		SPDK_ERRLOG("Failed to allocate priority events ring\n");
+		assert(false);
+	}
+	reactor->event_batch_size = SPDK_EVENT_BATCH_SIZE;
+
 	/* Always initialize interrupt facilities for reactor */
 	if (reactor_interrupt_init(reactor) != 0) {
 		/* Reactor interrupt facilities are necessary if setting app to interrupt mode. */
@@ -356,6 +370,9 @@ spdk_reactors_fini(void)
 		if (reactor->events != NULL) {
 			spdk_ring_free(reactor->events);
 		}
+		if (reactor->priority_events != NULL) {
+			spdk_ring_free(reactor->priority_events);
+		}
 
 		reactor_interrupt_fini(reactor);
 
@@ -394,6 +411,16 @@ _event_call(uint32_t lcore, spdk_event_fn fn, void *arg1, void *arg2)
 	spdk_event_call(ev);
 }
 
+static void
+_event_call_priority(uint32_t lcore, spdk_event_fn fn, void *arg1, void *arg2)
+{
+	struct spdk_event *ev;
+
+	ev = spdk_event_allocate(lcore, fn, arg1, arg2);
+	assert(ev);
+	spdk_event_call_priority(ev);
+}
+
 static void
 _reactor_set_notify_cpuset_cpl(void *arg1, void *arg2)
 {
@@ -553,8 +580,8 @@ spdk_event_allocate(uint32_t lcore, spdk_event_fn fn, void *arg1, void *arg2)
 	return event;
 }
 
-void
-spdk_event_call(struct spdk_event *event)
+static void
+event_call(struct spdk_event *event, bool priority)
 {
 	int rc;
 	struct spdk_reactor *reactor;
@@ -565,8 +592,10 @@ spdk_event_call(struct spdk_event *event)
 
 	assert(reactor != NULL);
 	assert(reactor->events != NULL);
+	assert(reactor->priority_events != NULL);
 
-	rc = spdk_ring_enqueue(reactor->events, (void **)&event, 1, NULL);
+	rc = spdk_ring_enqueue(priority ? reactor->priority_events : reactor->events,
+			       (void **)&event, 1, NULL);
 	if (rc != 1) {
 		assert(false);
 	}
@@ -577,10 +606,12 @@ spdk_event_call(struct spdk_event *event)
 
 	/* If spdk_event_call isn't called on a reactor, always send a notification.
 	 * If it is called on a reactor, send a notification if the destination reactor
-	 * is indicated in interrupt mode state.
+	 * is indicated in interrupt mode state. Only the first event queued since the
+	 * destination reactor last looked at its queues needs to wake it up.
 	 */
-	if (spdk_unlikely(local_reactor == NULL) ||
-	    spdk_unlikely(spdk_cpuset_get_cpu(&local_reactor->notify_cpuset, event->lcore))) {
+	if ((spdk_unlikely(local_reactor == NULL) ||
+	     spdk_unlikely(spdk_cpuset_get_cpu(&local_reactor->notify_cpuset, event->lcore))) &&
+	    !__atomic_exchange_n(&reactor->events_notified, true, __ATOMIC_ACQ_REL)) {
 		uint64_t notify = 1;
 
 		rc = write(reactor->events_fd, &notify, sizeof(notify));
@@ -590,12 +621,47 @@ spdk_event_call(struct spdk_event *event)
 	}
 }
 
+void
+spdk_event_call(struct spdk_event *event)
+{
+	event_call(event, false);
+}
+
+void
+spdk_event_call_priority(struct spdk_event *event)
+{
+	event_call(event, true);
+}
+
+static inline size_t
+event_queue_dequeue(struct spdk_reactor *reactor, void **events)
+{
+	size_t count, batch_size = reactor->event_batch_size;
+
+	/* Priority events always go first and share the batch with the regular ones. */
+	count = spdk_ring_dequeue(reactor->priority_events, events, batch_size);
+	if (count < batch_size) {
+		count += spdk_ring_dequeue(reactor->events, &events[count], batch_size - count);
+	}
+
+	/* Grow the batch while a backlog keeps filling it up and shrink it back once
+	 * the queues drain, so bursts are caught up with without making every
+	 * iteration longer. */
+	if (count == batch_size && spdk_ring_count(reactor->events) != 0) {
+		reactor->event_batch_size = spdk_min(batch_size * 2, SPDK_EVENT_BATCH_SIZE_MAX);
+	} else if (count < batch_size / 2) {
+		reactor->event_batch_size = spdk_max(batch_size / 2, SPDK_EVENT_BATCH_SIZE);
+	}
+
+	return count;
+}
+
 static inline int
 event_queue_run_batch(void *arg)
 {
 	struct spdk_reactor *reactor = arg;
 	size_t count, i;
-	void *events[SPDK_EVENT_BATCH_SIZE];
+	void *events[SPDK_EVENT_BATCH_SIZE_MAX];
 
 #ifdef DEBUG
 	/*
@@ -606,14 +672,21 @@ event_queue_run_batch(void *arg)
 	memset(events, 0, sizeof(events));
 #endif
 
+	/* Let the next event queued from now on notify the reactor again. Taking the flag
+	 * with an atomic exchange makes the events queued before it was set visible here. */
+	if (__atomic_load_n(&reactor->events_notified, __ATOMIC_RELAXED)) {
+		(void)__atomic_exchange_n(&reactor->events_notified, false, __ATOMIC_ACQ_REL);
+	}
+
 	/* Operate event notification if this reactor currently runs in interrupt state */
 	if (spdk_unlikely(reactor->in_interrupt)) {
 		uint64_t notify = 1;
 		int rc;
 
-		count = spdk_ring_dequeue(reactor->events, events, SPDK_EVENT_BATCH_SIZE);
+		count = event_queue_dequeue(reactor, events);
 
-		if (spdk_ring_count(reactor->events) != 0) {
+		if (spdk_ring_count(reactor->events) != 0 ||
+		    spdk_ring_count(reactor->priority_events) != 0) {
 			/* Trigger new notification if there are still events in event-queue waiting for processing. */
 			rc = write(reactor->events_fd, &notify, sizeof(notify));
 			if (rc < 0) {
@@ -622,7 +695,7 @@ event_queue_run_batch(void *arg)
 			}
 		}
 	} else {
-		count = spdk_ring_dequeue(reactor->events, events, SPDK_EVENT_BATCH_SIZE);
+		count = event_queue_dequeue(reactor, events);
 	}
 
 	if (count == 0) {
@@ -683,6 +756,20 @@ spdk_framework_context_switch_monitor_enabled(void)
 	return g_framework_context_switch_monitor_enabled;
 }
 
+void
+spdk_framework_set_interrupt_poll_window(uint64_t window_us)
+{
+	/* Same as the context switch monitor, reactors may see the update a bit late. */
+	g_interrupt_poll_window_us = window_us;
+	g_interrupt_poll_window_tsc = window_us * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+}
+
+uint64_t
+spdk_framework_get_interrupt_poll_window(void)
+{
+	return g_interrupt_poll_window_us;
+}
+
 static void
 _set_thread_name(const char *thread_name)
 {
@@ -856,7 +943,8 @@ _reactors_scheduler_gather_metrics(void *arg1, void *arg2)
 			SPDK_ERRLOG("Failed to allocate memory when gathering metrics on %u\n", reactor->lcore);
 
 			/* Cancel this round of schedule work */
-			_event_call(spdk_scheduler_get_scheduling_lcore(), _reactors_scheduler_cancel, NULL, NULL);
+			_event_call_priority(spdk_scheduler_get_scheduling_lcore(), _reactors_scheduler_cancel, NULL,
+					     NULL);
 			return;
 		}
 
@@ -888,11 +976,11 @@ _reactors_scheduler_gather_metrics(void *arg1, void *arg2)
 	/* If we've looped back around to the scheduler thread, move to the next phase */
 	if (next_core == spdk_scheduler_get_scheduling_lcore()) {
 		/* Phase 2 of scheduling is rebalancing - deciding which threads to move where */
-		_event_call(next_core, _reactors_scheduler_balance, NULL, NULL);
+		_event_call_priority(next_core, _reactors_scheduler_balance, NULL, NULL);
 		return;
 	}
 
-	_event_call(next_core, _reactors_scheduler_gather_metrics, NULL, NULL);
+	_event_call_priority(next_core, _reactors_scheduler_gather_metrics, NULL, NULL);
 }
 
 static int _reactor_schedule_thread(struct spdk_thread *thread);
@@ -943,8 +1031,27 @@ static void
 reactor_interrupt_run(struct spdk_reactor *reactor)
 {
 	int block_timeout = -1; /* _EPOLL_WAIT_FOREVER */
+	uint64_t window_tsc = g_interrupt_poll_window_tsc;
+	uint64_t deadline;
+	int rc;
 
-	spdk_fd_group_wait(reactor->fgrp, block_timeout);
+	rc = spdk_fd_group_wait(reactor->fgrp, block_timeout);
+	if (rc <= 0 || window_tsc == 0) {
+		return;
+	}
+
+	/* Events tend to come in bursts, e.g. a completion followed by the next request. Keep
+	 * checking for them without blocking for a while, so that the ones arriving shortly after
+	 * the wakeup are handled without going back to sleep and together in a single epoll_wait(). */
+	deadline = spdk_get_ticks() + window_tsc;
+	while (reactor->in_interrupt && g_reactor_state == SPDK_REACTOR_STATE_RUNNING) {
+		rc = spdk_fd_group_wait(reactor->fgrp, 0);
+		if (rc > 0) {
+			deadline = spdk_get_ticks() + window_tsc;
+		} else if (rc < 0 || spdk_get_ticks() > deadline) {
+			break;
+		}
+	}
 }
 
 static void
@@ -1315,7 +1422,7 @@ _reactor_schedule_thread(struct spdk_thread *thread)
 
 	lw_thread->tsc_start = spdk_get_ticks();
 
-	spdk_event_call(evt);
+	spdk_event_call_priority(evt);
 
 	return 0;
 }
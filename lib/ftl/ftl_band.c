@@ -489,12 +489,12 @@ is_band_relocateable(struct ftl_band *band)
 
 static void
 get_band_phys_info(struct spdk_ftl_dev *dev, uint64_t phys_id,
-		   double *invalidity, double *wr_cnt)
+		   double *invalidity, double *wr_cnt, double *age)
 {
 	struct ftl_band *band;
 	uint64_t band_id = phys_id * dev->num_logical_bands_in_physical;
 
-	*wr_cnt = *invalidity = 0.0L;
+	*wr_cnt = *invalidity = *age = 0.0L;
 	for (; band_id < ftl_get_num_bands(dev); band_id++) {
 		band = &dev->bands[band_id];
 
@@ -509,10 +509,24 @@ get_band_phys_info(struct spdk_ftl_dev *dev, uint64_t phys_id,
 		}
 
 		*invalidity += ftl_band_invalidity(band);
+		*age += dev->sb->seq_id - spdk_min(band->md->close_seq_id, dev->sb->seq_id);
 	}
 
 	*invalidity /= dev->num_logical_bands_in_physical;
 	*wr_cnt /= dev->num_logical_bands_in_physical;
+	*age /= dev->num_logical_bands_in_physical;
+}
+
+/*
+ * Cost-benefit of relocating a band with a given invalidity (u is the fraction of valid blocks):
+ * free space gained (1 - u), weighted by the age of the data, over the cost of reading the band
+ * and writing back its valid blocks (1 + u). Old bands hold cold data which is unlikely to be
+ * invalidated any further, so they're worth relocating at a lower invalidity than young ones.
+ */
+static double
+band_cost_benefit(double invalidity, double age)
+{
+	return invalidity * age / (2.0L - invalidity);
 }
 
 static bool
@@ -551,6 +565,10 @@ band_start_gc(struct spdk_ftl_dev *dev, struct ftl_band *band)
 	TAILQ_REMOVE(&dev->shut_bands, band, queue_entry);
 	band->reloc = true;
 
+	dev->gc.bands_picked++;
+	dev->gc.valid_blocks += band->p2l_map.num_valid;
+	dev->gc.user_blocks += ftl_band_user_blocks(band);
+
 	FTL_DEBUGLOG(dev, "Band to GC, id %u\n", band->id);
 }
 
@@ -590,6 +608,8 @@ ftl_band_search_next_to_reloc(struct spdk_ftl_dev *dev)
 {
 	double invalidity, max_invalidity = 0.0L;
 	double wr_cnt, max_wr_cnt = 0.0L;
+	double age, score, max_score = 0.0L;
+	bool better;
 	uint64_t phys_id = FTL_BAND_PHYS_ID_INVALID;
 	struct ftl_band *band;
 	uint64_t i, band_count;
@@ -622,13 +642,22 @@ ftl_band_search_next_to_reloc(struct spdk_ftl_dev *dev)
 		band = &dev->bands[i];
 
 		/* Calculate entire band physical group invalidity */
-		get_band_phys_info(dev, band->phys_id, &invalidity, &wr_cnt);
+		get_band_phys_info(dev, band->phys_id, &invalidity, &wr_cnt, &age);
 
 		if (invalidity != 0.0L) {
-			if (phys_id == FTL_BAND_PHYS_ID_INVALID ||
-			    band_cmp(invalidity, wr_cnt, max_invalidity, max_wr_cnt,
-				     band->phys_id, phys_id)) {
+			score = band_cost_benefit(invalidity, age);
+			if (phys_id == FTL_BAND_PHYS_ID_INVALID) {
+				better = true;
+			} else if (dev->gc.cost_benefit && score != max_score) {
+				better = score > max_score;
+			} else {
+				better = band_cmp(invalidity, wr_cnt, max_invalidity, max_wr_cnt,
+						  band->phys_id, phys_id);
+			}
+
+			if (better) {
 				max_wr_cnt = wr_cnt;
+				max_score = score;
 				phys_id = band->phys_id;
 
 				if (invalidity > max_invalidity) {
@@ -122,6 +122,9 @@ struct ftl_band {
 		uint64_t cnt;
 	} owner;
 
+	/* FDP placement handle the band is written with, taken from its writer */
+	uint16_t			placement_handle;
+
 	/* P2L map */
 	struct ftl_p2l_map		p2l_map;
 
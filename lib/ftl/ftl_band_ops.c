@@ -7,6 +7,7 @@
 #include "spdk/stdinc.h"
 #include "spdk/queue.h"
 #include "spdk/bdev_module.h"
+#include "spdk/nvme_spec.h"
 
 #include "ftl_core.h"
 #include "ftl_band.h"
@@ -37,6 +38,29 @@ write_rq_end(struct spdk_bdev_io *bdev_io, bool success, void *arg)
 	}
 }
 
+static int
+ftl_band_bdev_write(struct ftl_band *band, struct iovec *iov, void *payload, ftl_addr addr,
+		    uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct spdk_ftl_dev *dev = band->dev;
+	struct spdk_bdev_ext_io_opts opts = {
+		.size = SPDK_SIZEOF(&opts, nvme_cdw13),
+	};
+
+	if (!dev->conf.fdp_placement_handles) {
+		return spdk_bdev_write_blocks(dev->base_bdev_desc, dev->base_ioch,
+					      payload, addr, num_blocks, cb, cb_arg);
+	}
+
+	iov->iov_base = payload;
+	iov->iov_len = num_blocks * FTL_BLOCK_SIZE;
+	opts.nvme_cdw12.write.dtype = SPDK_NVME_DIRECTIVE_TYPE_DATA_PLACEMENT;
+	opts.nvme_cdw13.write.dspec = band->placement_handle;
+
+	return spdk_bdev_writev_blocks_ext(dev->base_bdev_desc, dev->base_ioch, iov, 1,
+					   addr, num_blocks, cb, cb_arg, &opts);
+}
+
 static void
 ftl_band_rq_bdev_write(void *_rq)
 {
@@ -45,9 +69,8 @@ ftl_band_rq_bdev_write(void *_rq)
 	struct spdk_ftl_dev *dev = band->dev;
 	int rc;
 
-	rc = spdk_bdev_write_blocks(dev->base_bdev_desc, dev->base_ioch,
-				    rq->io_payload, rq->io.addr, rq->num_blocks,
-				    write_rq_end, rq);
+	rc = ftl_band_bdev_write(band, &rq->io.iov, rq->io_payload, rq->io.addr,
+				 rq->num_blocks, write_rq_end, rq);
 
 	if (spdk_unlikely(rc)) {
 		if (rc == -ENOMEM) {
@@ -177,9 +200,8 @@ ftl_band_brq_bdev_write(void *_brq)
 	struct spdk_ftl_dev *dev = brq->dev;
 	int rc;
 
-	rc = spdk_bdev_write_blocks(dev->base_bdev_desc, dev->base_ioch,
-				    brq->io_payload, brq->io.addr,
-				    brq->num_blocks, write_brq_end, brq);
+	rc = ftl_band_bdev_write(brq->io.band, &brq->io.iov, brq->io_payload, brq->io.addr,
+				 brq->num_blocks, write_brq_end, brq);
 
 	if (spdk_unlikely(rc)) {
 		if (rc == -ENOMEM) {
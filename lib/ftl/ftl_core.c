@@ -83,6 +83,11 @@ ftl_shutdown_complete(struct spdk_ftl_dev *dev)
 		return false;
 	}
 
+	if (!ftl_writer_is_halted(&dev->writer_user_cold)) {
+		ftl_writer_halt(&dev->writer_user_cold);
+		return false;
+	}
+
 	if (!ftl_reloc_is_halted(dev->reloc)) {
 		ftl_reloc_halt(dev->reloc);
 		return false;
@@ -753,6 +758,7 @@ ftl_core_poller(void *ctx)
 
 	ftl_process_io_queue(dev);
 	ftl_writer_run(&dev->writer_user);
+	ftl_writer_run(&dev->writer_user_cold);
 	ftl_writer_run(&dev->writer_gc);
 	ftl_reloc(dev->reloc);
 	ftl_nv_cache_process(dev);
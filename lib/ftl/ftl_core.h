@@ -100,6 +100,19 @@ struct spdk_ftl_dev {
 	/* Statistics */
 	struct ftl_stats		stats;
 
+	/* Garbage collection victim selection */
+	struct {
+		/* Pick bands by cost-benefit (age x invalidity) instead of invalidity only */
+		bool			cost_benefit;
+
+		/* Number of bands picked for relocation */
+		uint64_t		bands_picked;
+
+		/* Valid and total user blocks of the picked bands at the time they were picked */
+		uint64_t		valid_blocks;
+		uint64_t		user_blocks;
+	} gc;
+
 	/* Array of bands */
 	struct ftl_band			*bands;
 
@@ -178,6 +191,9 @@ struct spdk_ftl_dev {
 	/* Writer for user IOs */
 	struct ftl_writer		writer_user;
 
+	/* Writer for rarely updated user IOs, used when hot and cold data are separated */
+	struct ftl_writer		writer_user_cold;
+
 	/* Writer for GC IOs */
 	struct ftl_writer		writer_gc;
 
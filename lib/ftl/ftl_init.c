@@ -94,6 +94,7 @@ static struct spdk_ftl_dev *
 allocate_dev(const struct spdk_ftl_conf *conf, int *error)
 {
 	int rc;
+	uint16_t handle;
 	struct spdk_ftl_dev *dev = calloc(1, sizeof(*dev));
 
 	if (!dev) {
@@ -125,8 +126,37 @@ allocate_dev(const struct spdk_ftl_conf *conf, int *error)
 	TAILQ_INIT(&dev->trim_sq);
 	TAILQ_INIT(&dev->ioch_queue);
 
-	ftl_writer_init(dev, &dev->writer_user, SPDK_FTL_LIMIT_HIGH, FTL_BAND_TYPE_COMPACTION);
-	ftl_writer_init(dev, &dev->writer_gc, SPDK_FTL_LIMIT_CRIT, FTL_BAND_TYPE_GC);
+	/*
+	 * Half of the P2L checkpoint regions go to the GC writer, the other half is used by
+	 * the compaction writer or split between the hot and cold compaction writers.
+	 */
+	if (dev->conf.hot_cold_streams) {
+		ftl_writer_init(dev, &dev->writer_user, SPDK_FTL_LIMIT_HIGH, FTL_BAND_TYPE_COMPACTION,
+				FTL_LAYOUT_REGION_TYPE_P2L_COUNT / 4);
+		ftl_writer_init(dev, &dev->writer_user_cold, SPDK_FTL_LIMIT_HIGH, FTL_BAND_TYPE_COMPACTION,
+				FTL_LAYOUT_REGION_TYPE_P2L_COUNT / 4);
+	} else {
+		ftl_writer_init(dev, &dev->writer_user, SPDK_FTL_LIMIT_HIGH, FTL_BAND_TYPE_COMPACTION,
+				FTL_LAYOUT_REGION_TYPE_P2L_COUNT / 2);
+		ftl_writer_init(dev, &dev->writer_user_cold, SPDK_FTL_LIMIT_HIGH, FTL_BAND_TYPE_COMPACTION, 0);
+	}
+	ftl_writer_init(dev, &dev->writer_gc, SPDK_FTL_LIMIT_CRIT, FTL_BAND_TYPE_GC,
+			FTL_LAYOUT_REGION_TYPE_P2L_COUNT / 2);
+
+	/*
+	 * Each writer gets its own placement handle, as long as there are enough of them, so that
+	 * data with different lifetimes ends up in different reclaim units of the base device.
+	 */
+	if (dev->conf.fdp_placement_handles) {
+		handle = 0;
+		dev->writer_user.placement_handle = handle;
+		if (dev->conf.hot_cold_streams) {
+			handle = spdk_min(handle + 1, dev->conf.fdp_placement_handles - 1);
+			dev->writer_user_cold.placement_handle = handle;
+		}
+		handle = spdk_min(handle + 1, dev->conf.fdp_placement_handles - 1);
+		dev->writer_gc.placement_handle = handle;
+	}
 
 	return dev;
 error:
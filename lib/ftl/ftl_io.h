@@ -236,6 +236,9 @@ struct ftl_rq {
 		/* Band to which IO is issued */
 		struct ftl_band *band;
 
+		/* Payload of a write with a placement handle */
+		struct iovec iov;
+
 		struct spdk_bdev_io_wait_entry bdev_io_wait;
 	} io;
 
@@ -281,6 +284,9 @@ struct ftl_basic_rq {
 		/* Chunk to which IO is issued */
 		struct ftl_nv_cache_chunk *chunk;
 
+		/* Payload of a write with a placement handle */
+		struct iovec iov;
+
 		struct spdk_bdev_io_wait_entry bdev_io_wait;
 	} io;
 };
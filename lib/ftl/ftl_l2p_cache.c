@@ -46,6 +46,7 @@ struct ftl_l2p_page {
 	uint64_t pin_ref_cnt;
 	struct ftl_l2p_cache_page_io_ctx ctx;
 	bool on_lru_list;
+	bool frequent; /* Page is on the frequency list (scan resistant eviction only) */
 	void *page_buffer;
 	uint64_t ckpt_seq_id;
 	ftl_df_obj_id obj_id;
@@ -84,6 +85,33 @@ struct ftl_l2p_l1_map_entry {
 	ftl_df_obj_id page_obj_id;
 };
 
+/* Pages adjacent on the disk are read with a single IO */
+#define FTL_L2P_CACHE_PAGE_IN_BATCH_MAX		16
+#define FTL_L2P_CACHE_PAGE_IN_BATCH_POOL	128
+struct ftl_l2p_cache_page_in_batch {
+	struct ftl_l2p_cache *cache;
+	uint32_t count;
+	struct ftl_l2p_page *pages[FTL_L2P_CACHE_PAGE_IN_BATCH_MAX];
+	struct iovec iov[FTL_L2P_CACHE_PAGE_IN_BATCH_MAX];
+	struct spdk_bdev_io_wait_entry bdev_io_wait;
+};
+
+/*
+ * Number of sequential streams tracked, number of consecutive pins of adjacent pages needed
+ * to detect one, and number of pages read ahead of it.
+ */
+#define FTL_L2P_CACHE_PREFETCH_STREAMS	4
+#define FTL_L2P_CACHE_PREFETCH_TRIGGER	2
+#define FTL_L2P_CACHE_PREFETCH_PAGES	8
+
+struct ftl_l2p_cache_prefetch_stream {
+	/* Last page pinned by the stream */
+	uint64_t page_no;
+
+	/* Number of consecutive pins of adjacent pages */
+	uint32_t streak;
+};
+
 enum ftl_l2p_cache_state {
 	L2P_CACHE_INIT,
 	L2P_CACHE_RUNNING,
@@ -108,6 +136,17 @@ struct ftl_l2p_cache {
 	struct ftl_md *l1_md;
 
 	TAILQ_HEAD(l2p_lru_list, ftl_l2p_page) lru_list;
+
+	/*
+	 * Scan resistant eviction: pages referenced again while resident are moved from lru_list
+	 * to freq_list, which may hold up to freq_max pages. Eviction takes pages from lru_list and
+	 * the tail of freq_list ages out to its head.
+	 */
+	bool scan_resistant;
+	struct l2p_lru_list freq_list;
+	uint32_t freq_cnt;
+	uint32_t freq_max;
+
 	/* TODO: A lot of / and % operations are done on this value, consider adding a shift based field and calculactions instead */
 	uint64_t lbas_in_page;
 	uint64_t num_pages;		/* num pages to hold the entire L2P */
@@ -121,6 +160,20 @@ struct ftl_l2p_cache {
 	struct ftl_mempool *page_sets_pool;
 	TAILQ_HEAD(, ftl_l2p_page_set) deferred_page_set_list; /* for deferred page sets */
 
+	/* Batch of pages to page in, submitted at the end of ftl_l2p_cache_process() */
+	struct ftl_mempool *page_in_batch_pool;
+	struct ftl_l2p_cache_page_in_batch *page_in_batch;
+
+	/* Read ahead of sequential accesses */
+	struct {
+		struct ftl_l2p_cache_prefetch_stream streams[FTL_L2P_CACHE_PREFETCH_STREAMS];
+		uint32_t next_stream;
+
+		/* Range of pages still to be prefetched */
+		uint64_t next_page_no;
+		uint64_t end_page_no;
+	} prefetch;
+
 	/* Process trim in background */
 	struct {
 #define FTL_L2P_MAX_LAZY_TRIM_QD 1
@@ -187,7 +240,12 @@ ftl_l2p_cache_lru_remove_page(struct ftl_l2p_cache *cache, struct ftl_l2p_page *
 	assert(page);
 	assert(page->on_lru_list);
 
-	TAILQ_REMOVE(&cache->lru_list, page, list_entry);
+	if (page->frequent) {
+		TAILQ_REMOVE(&cache->freq_list, page, list_entry);
+		cache->freq_cnt--;
+	} else {
+		TAILQ_REMOVE(&cache->lru_list, page, list_entry);
+	}
 	page->on_lru_list = false;
 }
 
@@ -197,7 +255,12 @@ ftl_l2p_cache_lru_add_page(struct ftl_l2p_cache *cache, struct ftl_l2p_page *pag
 	assert(page);
 	assert(!page->on_lru_list);
 
-	TAILQ_INSERT_HEAD(&cache->lru_list, page, list_entry);
+	if (page->frequent) {
+		TAILQ_INSERT_HEAD(&cache->freq_list, page, list_entry);
+		cache->freq_cnt++;
+	} else {
+		TAILQ_INSERT_HEAD(&cache->lru_list, page, list_entry);
+	}
 
 	page->on_lru_list = true;
 }
@@ -239,7 +302,22 @@ ftl_l2p_cache_page_remove(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page
 static inline struct ftl_l2p_page *
 ftl_l2p_cache_get_coldest_page(struct ftl_l2p_cache *cache)
 {
-	return TAILQ_LAST(&cache->lru_list, l2p_lru_list);
+	struct ftl_l2p_page *page;
+
+	/* Age out the least recently used frequent pages, they get another chance on lru_list */
+	while (cache->freq_cnt > cache->freq_max) {
+		page = TAILQ_LAST(&cache->freq_list, l2p_lru_list);
+		ftl_l2p_cache_lru_remove_page(cache, page);
+		page->frequent = false;
+		ftl_l2p_cache_lru_add_page(cache, page);
+	}
+
+	page = TAILQ_LAST(&cache->lru_list, l2p_lru_list);
+	if (!page) {
+		page = TAILQ_LAST(&cache->freq_list, l2p_lru_list);
+	}
+
+	return page;
 }
 
 static inline struct ftl_l2p_page *
@@ -445,6 +523,13 @@ ftl_l2p_cache_init(struct spdk_ftl_dev *dev)
 		return -1;
 	}
 
+	cache->page_in_batch_pool = ftl_mempool_create(FTL_L2P_CACHE_PAGE_IN_BATCH_POOL,
+				    sizeof(struct ftl_l2p_cache_page_in_batch),
+				    64, SPDK_ENV_NUMA_ID_ANY);
+	if (!cache->page_in_batch_pool) {
+		return -1;
+	}
+
 	max_resident_size = dev->conf.l2p_dram_limit << 20;
 	max_resident_pgs = max_resident_size / ftl_l2p_cache_get_page_all_size();
 
@@ -460,6 +545,8 @@ ftl_l2p_cache_init(struct spdk_ftl_dev *dev)
 
 	TAILQ_INIT(&cache->deferred_page_set_list);
 	TAILQ_INIT(&cache->lru_list);
+	TAILQ_INIT(&cache->freq_list);
+	cache->scan_resistant = dev->conf.l2p_scan_resistant;
 
 	cache->l2_ctx_md = ftl_md_create(dev,
 					 spdk_divide_round_up(max_resident_pgs * SPDK_ALIGN_CEIL(sizeof(struct ftl_l2p_page), 64),
@@ -472,6 +559,7 @@ ftl_l2p_cache_init(struct spdk_ftl_dev *dev)
 	cache->l2_pgs_resident_max = max_resident_pgs;
 	cache->l2_pgs_avail = max_resident_pgs;
 	cache->l2_pgs_evicting = 0;
+	cache->freq_max = max_resident_pgs * 3 / 4;
 	cache->l2_ctx_pool = ftl_mempool_create_ext(ftl_md_get_buffer(cache->l2_ctx_md),
 			     max_resident_pgs, sizeof(struct ftl_l2p_page), 64);
 
@@ -521,6 +609,9 @@ ftl_l2p_cache_deinit_l2(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache)
 
 	ftl_mempool_destroy(cache->page_sets_pool);
 	cache->page_sets_pool = NULL;
+
+	ftl_mempool_destroy(cache->page_in_batch_pool);
+	cache->page_in_batch_pool = NULL;
 }
 
 static void
@@ -819,6 +910,7 @@ l2p_shm_restore_clean(struct spdk_ftl_dev *dev)
 
 		page->pin_ref_cnt = 0;
 		page->on_lru_list = 0;
+		page->frequent = false;
 		memset(&page->ctx, 0, sizeof(page->ctx));
 
 		ftl_l2p_cache_lru_add_page(cache, page);
@@ -867,6 +959,7 @@ l2p_shm_restore_dirty(struct spdk_ftl_dev *dev)
 
 		page->pin_ref_cnt = 0;
 		page->on_lru_list = 0;
+		page->frequent = false;
 		memset(&page->ctx, 0, sizeof(page->ctx));
 
 		ftl_l2p_cache_lru_add_page(cache, page);
@@ -996,6 +1089,53 @@ ftl_l2p_cache_page_is_pinnable(struct ftl_l2p_page *page)
 	return page->state != L2P_CACHE_PAGE_INIT;
 }
 
+/*
+ * Track the pinned pages range as a part of a sequential stream and arm the prefetch of the
+ * following pages once the stream is detected. Returns true if the pin continues a stream.
+ */
+static bool
+ftl_l2p_cache_prefetch_detect(struct ftl_l2p_cache *cache, uint64_t start, uint64_t end)
+{
+	struct ftl_l2p_cache_prefetch_stream *stream;
+	uint32_t i;
+
+	for (i = 0; i < FTL_L2P_CACHE_PREFETCH_STREAMS; i++) {
+		stream = &cache->prefetch.streams[i];
+
+		if (end == stream->page_no) {
+			/* Still within the last page of the stream */
+			return stream->streak > 0;
+		}
+
+		if (end > stream->page_no && (start == stream->page_no || start == stream->page_no + 1)) {
+			break;
+		}
+	}
+
+	if (i == FTL_L2P_CACHE_PREFETCH_STREAMS) {
+		/* Start tracking a new stream in place of the oldest one */
+		stream = &cache->prefetch.streams[cache->prefetch.next_stream];
+		cache->prefetch.next_stream = (cache->prefetch.next_stream + 1) % FTL_L2P_CACHE_PREFETCH_STREAMS;
+		stream->page_no = end;
+		stream->streak = 0;
+		return false;
+	}
+
+	stream->page_no = end;
+	stream->streak++;
+
+	if (stream->streak >= FTL_L2P_CACHE_PREFETCH_TRIGGER) {
+		if (cache->prefetch.next_page_no <= end ||
+		    cache->prefetch.next_page_no > end + FTL_L2P_CACHE_PREFETCH_PAGES) {
+			cache->prefetch.next_page_no = end + 1;
+		}
+		cache->prefetch.end_page_no = spdk_min(end + 1 + FTL_L2P_CACHE_PREFETCH_PAGES,
+						       cache->num_pages);
+	}
+
+	return true;
+}
+
 void
 ftl_l2p_cache_pin(struct spdk_ftl_dev *dev, struct ftl_l2p_pin_ctx *pin_ctx)
 {
@@ -1009,12 +1149,15 @@ ftl_l2p_cache_pin(struct spdk_ftl_dev *dev, struct ftl_l2p_pin_ctx *pin_ctx)
 	uint64_t end = (pin_ctx->lba + pin_ctx->count - 1) / cache->lbas_in_page;
 	uint64_t count = end - start + 1;
 	uint64_t i;
+	bool sequential;
 
 	if (spdk_unlikely(count > L2P_MAX_PAGES_TO_PIN)) {
 		ftl_l2p_pin_complete(dev, -E2BIG, pin_ctx);
 		return;
 	}
 
+	sequential = ftl_l2p_cache_prefetch_detect(cache, start, end);
+
 	/* Get and initialize page sets */
 	assert(ftl_l2p_cache_running(cache));
 	page_set = ftl_mempool_get(cache->page_sets_pool);
@@ -1043,6 +1186,11 @@ ftl_l2p_cache_pin(struct spdk_ftl_dev *dev, struct ftl_l2p_pin_ctx *pin_ctx)
 				entry->pg_pin_issued = true;
 				entry->pg_pin_completed = true;
 				ftl_l2p_cache_page_pin(cache, page);
+
+				/* Repeated hits of a sequential stream don't make a page frequently used */
+				if (cache->scan_resistant && !sequential) {
+					page->frequent = true;
+				}
 			} else {
 				/* The page is being loaded */
 				/* Queue the page pin entry to be executed on page in */
@@ -1229,6 +1377,9 @@ page_in_io_complete(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 	if (spdk_unlikely(!success)) {
 		ftl_bug(page->on_lru_list);
 		ftl_l2p_cache_page_remove(cache, page);
+	} else if (!page->pin_ref_cnt && !page->on_lru_list) {
+		/* Prefetched page nobody waited for, or already unpinned by the waiters */
+		ftl_l2p_cache_lru_add_page(cache, page);
 	}
 }
 
@@ -1288,6 +1439,105 @@ page_in_io_retry(void *arg)
 	page_in_io(dev, cache, page);
 }
 
+static void page_in_batch_submit(struct ftl_l2p_cache_page_in_batch *batch);
+
+static void
+page_in_batch_cb(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct ftl_l2p_cache_page_in_batch *batch = cb_arg;
+	struct ftl_l2p_cache *cache = batch->cache;
+	struct spdk_ftl_dev *dev = cache->dev;
+	uint32_t i;
+
+	ftl_stats_bdev_io_completed(dev, FTL_STATS_TYPE_L2P, bdev_io);
+	spdk_bdev_free_io(bdev_io);
+
+	for (i = 0; i < batch->count; i++) {
+		page_in_io_complete(dev, cache, batch->pages[i], success);
+	}
+
+	ftl_mempool_put(cache->page_in_batch_pool, batch);
+}
+
+static void
+page_in_batch_retry(void *arg)
+{
+	page_in_batch_submit(arg);
+}
+
+static void
+page_in_batch_submit(struct ftl_l2p_cache_page_in_batch *batch)
+{
+	struct ftl_l2p_cache *cache = batch->cache;
+	struct spdk_io_channel *ioch;
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_io_wait_entry *bdev_io_wait;
+	int rc;
+
+	rc = ftl_nv_cache_bdev_readv_blocks_with_md(cache->dev, ftl_l2p_cache_get_bdev_desc(cache),
+			ftl_l2p_cache_get_bdev_iochannel(cache),
+			batch->iov, batch->count, NULL,
+			ftl_l2p_cache_page_get_bdev_offset(cache, batch->pages[0]),
+			batch->count, page_in_batch_cb, batch);
+	if (spdk_likely(0 == rc)) {
+		return;
+	}
+
+	if (rc == -ENOMEM) {
+		ioch = ftl_l2p_cache_get_bdev_iochannel(cache);
+		bdev = spdk_bdev_desc_get_bdev(ftl_l2p_cache_get_bdev_desc(cache));
+		bdev_io_wait = &batch->bdev_io_wait;
+		bdev_io_wait->bdev = bdev;
+		bdev_io_wait->cb_fn = page_in_batch_retry;
+		bdev_io_wait->cb_arg = batch;
+
+		rc = spdk_bdev_queue_io_wait(bdev, ioch, bdev_io_wait);
+		ftl_bug(rc);
+	} else {
+		ftl_abort();
+	}
+}
+
+static void
+page_in_flush(struct ftl_l2p_cache *cache)
+{
+	struct ftl_l2p_cache_page_in_batch *batch = cache->page_in_batch;
+
+	if (batch) {
+		cache->page_in_batch = NULL;
+		page_in_batch_submit(batch);
+	}
+}
+
+/* Queue the page read, adding it to the current batch if it's adjacent to its last page */
+static void
+page_in_queue(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+{
+	struct ftl_l2p_cache_page_in_batch *batch = cache->page_in_batch;
+
+	if (!batch || batch->count == FTL_L2P_CACHE_PAGE_IN_BATCH_MAX ||
+	    batch->pages[batch->count - 1]->page_no + 1 != page->page_no) {
+		page_in_flush(cache);
+
+		batch = ftl_mempool_get(cache->page_in_batch_pool);
+		if (!batch) {
+			page_in_io(dev, cache, page);
+			return;
+		}
+
+		batch->cache = cache;
+		batch->count = 0;
+		cache->page_in_batch = batch;
+	}
+
+	page->ctx.cache = cache;
+	batch->pages[batch->count] = page;
+	batch->iov[batch->count].iov_base = page->page_buffer;
+	batch->iov[batch->count].iov_len = FTL_BLOCK_SIZE;
+	batch->count++;
+	cache->ios_in_flight++;
+}
+
 static void
 page_in(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 	struct ftl_l2p_page_set *page_set, struct ftl_l2p_page_wait_ctx *pentry)
@@ -1314,7 +1564,36 @@ page_in(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 	}
 
 	if (page_in) {
-		page_in_io(dev, cache, page);
+		page_in_queue(dev, cache, page);
+	}
+}
+
+static void
+ftl_l2p_cache_process_prefetch(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache)
+{
+	struct ftl_l2p_page *page;
+	uint64_t page_no;
+
+	while (cache->prefetch.next_page_no < cache->prefetch.end_page_no) {
+		/*
+		 * Prefetch only into the free pages kept by eviction, leaving enough of them
+		 * for the pins of the user IO
+		 */
+		if (cache->l2_pgs_avail <= spdk_max(cache->evict_keep / 2, L2P_MAX_PAGES_TO_PIN)) {
+			break;
+		}
+		if (cache->ios_in_flight > 512) {
+			break;
+		}
+
+		page_no = cache->prefetch.next_page_no++;
+		if (get_l2p_page_by_df_id(cache, page_no)) {
+			continue;
+		}
+
+		ftl_add_io_activity(dev);
+		page = page_allocate(cache, page_no);
+		page_in_queue(dev, cache, page);
 	}
 }
 
@@ -1582,6 +1861,9 @@ ftl_l2p_cache_process(struct spdk_ftl_dev *dev)
 		}
 	}
 
+	ftl_l2p_cache_process_prefetch(dev, cache);
+	page_in_flush(cache);
+
 	ftl_l2p_cache_process_eviction(dev, cache);
 	ftl_l2p_lazy_trim_process(dev);
 }
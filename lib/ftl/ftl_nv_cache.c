@@ -288,8 +288,12 @@ ftl_nv_cache_init(struct spdk_ftl_dev *dev)
 	assert(nv_cache->chunk_free_count + nv_cache->chunk_inactive_count == nv_cache->chunk_count);
 	assert(offset <= nvc_data_offset(nv_cache) + nvc_data_blocks(nv_cache));
 
+	nv_cache->chunk_comp_max = dev->conf.nv_cache_compaction_chunks ? :
+				   FTL_NV_CACHE_COMPACTION_CHUNKS_DEFAULT;
+	nv_cache->num_compactors = nv_cache->chunk_comp_max * FTL_NV_CACHE_COMPACTORS_PER_CHUNK;
+
 	TAILQ_INIT(&nv_cache->compactor_list);
-	for (i = 0; i < FTL_NV_CACHE_NUM_COMPACTORS; i++) {
+	for (i = 0; i < nv_cache->num_compactors; i++) {
 		compactor = compactor_alloc(dev);
 
 		if (!compactor) {
@@ -301,8 +305,7 @@ ftl_nv_cache_init(struct spdk_ftl_dev *dev)
 	}
 
 #define FTL_MAX_OPEN_CHUNKS 2
-#define FTL_MAX_COMPACTED_CHUNKS 2
-	nv_cache->p2l_pool = ftl_mempool_create(FTL_MAX_OPEN_CHUNKS + FTL_MAX_COMPACTED_CHUNKS,
+	nv_cache->p2l_pool = ftl_mempool_create(FTL_MAX_OPEN_CHUNKS + nv_cache->chunk_comp_max,
 						nv_cache_p2l_map_pool_elem_size(nv_cache),
 						FTL_BLOCK_SIZE,
 						SPDK_ENV_NUMA_ID_ANY);
@@ -311,7 +314,7 @@ ftl_nv_cache_init(struct spdk_ftl_dev *dev)
 	}
 
 	/* One entry per open chunk */
-	nv_cache->chunk_md_pool = ftl_mempool_create(FTL_MAX_OPEN_CHUNKS + FTL_MAX_COMPACTED_CHUNKS,
+	nv_cache->chunk_md_pool = ftl_mempool_create(FTL_MAX_OPEN_CHUNKS + nv_cache->chunk_comp_max,
 				  sizeof(struct ftl_nv_cache_chunk_md),
 				  FTL_BLOCK_SIZE,
 				  SPDK_ENV_NUMA_ID_ANY);
@@ -323,7 +326,7 @@ ftl_nv_cache_init(struct spdk_ftl_dev *dev)
 	 * plus one backup each for high invalidity chunks processing (if there's a backlog of chunks with extremely
 	 * small, even 0, validity then they can be processed by the compactors quickly and trigger a lot of updates
 	 * to free state at once) */
-	nv_cache->free_chunk_md_pool = ftl_mempool_create(2 * FTL_NV_CACHE_NUM_COMPACTORS,
+	nv_cache->free_chunk_md_pool = ftl_mempool_create(2 * nv_cache->num_compactors,
 				       sizeof(struct ftl_nv_cache_chunk_md),
 				       FTL_BLOCK_SIZE,
 				       SPDK_ENV_NUMA_ID_ANY);
@@ -341,6 +344,18 @@ ftl_nv_cache_init(struct spdk_ftl_dev *dev)
 				      dev->conf.nv_cache.chunk_free_target,
 				      100);
 
+	if (dev->conf.hot_cold_streams) {
+		nv_cache->heat.num_regions = spdk_divide_round_up(dev->num_lbas,
+					     1ULL << FTL_NV_CACHE_HEAT_REGION_SHIFT);
+		nv_cache->heat.counters = calloc(nv_cache->heat.num_regions,
+						 sizeof(*nv_cache->heat.counters));
+		if (!nv_cache->heat.counters) {
+			FTL_ERRLOG(dev, "Failed to allocate NV cache heat counters\n");
+			return -ENOMEM;
+		}
+		nv_cache->heat.decay_blocks = nv_cache->chunk_count * nv_cache->chunk_blocks;
+	}
+
 	if (nv_cache->nvc_type->ops.init) {
 		return nv_cache->nvc_type->ops.init(dev);
 	} else {
@@ -376,6 +391,9 @@ ftl_nv_cache_deinit(struct spdk_ftl_dev *dev)
 
 	free(nv_cache->chunks);
 	nv_cache->chunks = NULL;
+
+	free(nv_cache->heat.counters);
+	nv_cache->heat.counters = NULL;
 }
 
 static uint64_t
@@ -698,6 +716,16 @@ is_compaction_required_for_upgrade(struct ftl_nv_cache *nv_cache)
 	return false;
 }
 
+/*
+ * The cache is about to run out of free chunks, compact at full parallelism so that user
+ * writes don't have to wait for a free chunk
+ */
+static bool
+is_compaction_urgent(struct ftl_nv_cache *nv_cache)
+{
+	return nv_cache->chunk_free_count < nv_cache->chunk_free_target;
+}
+
 static bool
 is_compaction_required(struct ftl_nv_cache *nv_cache)
 {
@@ -709,6 +737,11 @@ is_compaction_required(struct ftl_nv_cache *nv_cache)
 		return true;
 	}
 
+	if (is_compaction_urgent(nv_cache) &&
+	    (nv_cache->chunk_full_count || !TAILQ_EMPTY(&nv_cache->chunk_comp_list))) {
+		return true;
+	}
+
 	return false;
 }
 
@@ -902,18 +935,19 @@ prepare_chunk_for_compaction(struct ftl_nv_cache *nv_cache)
 static struct ftl_nv_cache_chunk *
 get_chunk_for_compaction(struct ftl_nv_cache *nv_cache)
 {
-	struct ftl_nv_cache_chunk *chunk = NULL;
-
-	if (TAILQ_EMPTY(&nv_cache->chunk_comp_list)) {
-		return NULL;
-	}
+	struct ftl_nv_cache_chunk *chunk;
 
-	chunk = TAILQ_FIRST(&nv_cache->chunk_comp_list);
-	if (!is_chunk_to_read(chunk)) {
-		return NULL;
+	/*
+	 * Chunks which have been read entirely may still have writes in flight, move on to the next
+	 * one instead of waiting for them to finish
+	 */
+	TAILQ_FOREACH(chunk, &nv_cache->chunk_comp_list, entry) {
+		if (is_chunk_to_read(chunk)) {
+			return chunk;
+		}
 	}
 
-	return chunk;
+	return NULL;
 }
 
 static uint64_t
@@ -1083,28 +1117,119 @@ compaction_process(struct ftl_nv_cache *nv_cache)
 {
 	struct spdk_ftl_dev *dev = SPDK_CONTAINEROF(nv_cache, struct spdk_ftl_dev, nv_cache);
 	struct ftl_nv_cache_compactor *compactor;
+	bool urgent;
 
 	if (!is_compaction_required(nv_cache)) {
 		return;
 	}
 
-	if (nv_cache->chunk_comp_count < FTL_MAX_COMPACTED_CHUNKS) {
+	/* Normally the pipeline is ramped up by one chunk and compactor per call */
+	urgent = is_compaction_urgent(nv_cache);
+	do {
+		if (nv_cache->chunk_comp_count >= nv_cache->chunk_comp_max ||
+		    TAILQ_EMPTY(&nv_cache->chunk_full_list)) {
+			break;
+		}
 		prepare_chunk_for_compaction(nv_cache);
-	}
+	} while (urgent);
 
 	if (TAILQ_EMPTY(&nv_cache->chunk_comp_list)) {
 		return;
 	}
 
-	compactor = TAILQ_FIRST(&nv_cache->compactor_list);
-	if (!compactor) {
+	do {
+		compactor = TAILQ_FIRST(&nv_cache->compactor_list);
+		if (!compactor || !get_chunk_for_compaction(nv_cache)) {
+			break;
+		}
+
+		TAILQ_REMOVE(&nv_cache->compactor_list, compactor, entry);
+		compactor->nv_cache->compaction_active_count++;
+		compaction_process_start(compactor);
+		ftl_add_io_activity(dev);
+	} while (urgent);
+}
+
+static void
+heat_decay(struct ftl_nv_cache *nv_cache)
+{
+	uint64_t i;
+
+	nv_cache->heat.total = 0;
+	for (i = 0; i < nv_cache->heat.num_regions; i++) {
+		nv_cache->heat.counters[i] /= 2;
+		nv_cache->heat.total += nv_cache->heat.counters[i];
+	}
+	nv_cache->heat.blocks_written = 0;
+}
+
+static void
+heat_update(struct ftl_nv_cache *nv_cache, uint64_t lba, uint64_t num_blocks)
+{
+	uint64_t region, count, inc;
+	uint16_t *counter;
+
+	if (!nv_cache->heat.counters) {
 		return;
 	}
 
-	TAILQ_REMOVE(&nv_cache->compactor_list, compactor, entry);
-	compactor->nv_cache->compaction_active_count++;
-	compaction_process_start(compactor);
-	ftl_add_io_activity(dev);
+	nv_cache->heat.blocks_written += num_blocks;
+	if (spdk_unlikely(nv_cache->heat.blocks_written >= nv_cache->heat.decay_blocks)) {
+		heat_decay(nv_cache);
+	}
+
+	while (num_blocks) {
+		region = lba >> FTL_NV_CACHE_HEAT_REGION_SHIFT;
+		count = spdk_min(num_blocks, ((region + 1) << FTL_NV_CACHE_HEAT_REGION_SHIFT) - lba);
+
+		assert(region < nv_cache->heat.num_regions);
+		counter = &nv_cache->heat.counters[region];
+		inc = spdk_min(count, (uint64_t)(UINT16_MAX - *counter));
+		*counter += inc;
+		nv_cache->heat.total += inc;
+
+		lba += count;
+		num_blocks -= count;
+	}
+}
+
+static bool
+heat_lba_is_hot(struct ftl_nv_cache *nv_cache, uint64_t lba)
+{
+	uint64_t region = lba >> FTL_NV_CACHE_HEAT_REGION_SHIFT;
+
+	assert(region < nv_cache->heat.num_regions);
+
+	return nv_cache->heat.counters[region] * nv_cache->heat.num_regions >
+	       FTL_NV_CACHE_HEAT_HOT_FACTOR * nv_cache->heat.total;
+}
+
+/*
+ * Selects the writer for compacted data. The request goes to the hot writer if most of its
+ * blocks belong to frequently updated LBA regions, so such data ends up in the same bands and
+ * gets invalidated together, leaving less valid data for GC to move.
+ */
+static struct ftl_writer *
+compaction_writer(struct spdk_ftl_dev *dev, struct ftl_rq *rq)
+{
+	struct ftl_nv_cache *nv_cache = &dev->nv_cache;
+	struct ftl_rq_entry *entry;
+	uint64_t num_hot = 0, num_valid = 0;
+
+	if (!nv_cache->heat.counters) {
+		return &dev->writer_user;
+	}
+
+	FTL_RQ_ENTRY_LOOP(rq, entry, rq->iter.count) {
+		if (entry->lba == FTL_LBA_INVALID) {
+			continue;
+		}
+
+		num_valid++;
+		num_hot += heat_lba_is_hot(nv_cache, entry->lba);
+	}
+
+	return num_hot * 2 >= num_valid ? &dev->writer_user : &dev->writer_user_cold;
 }
 
 static void
@@ -1119,7 +1244,7 @@ compaction_process_ftl_done(struct ftl_rq *rq)
 	if (spdk_unlikely(false == rq->success)) {
 		/* IO error retry writing */
 #ifdef SPDK_FTL_RETRY_ON_ERROR
-		ftl_writer_queue_rq(&dev->writer_user, rq);
+		ftl_writer_queue_rq(compaction_writer(dev, rq), rq);
 		return;
 #else
 		ftl_abort();
@@ -1184,7 +1309,7 @@ compaction_process_finish_read(struct ftl_nv_cache_compactor *compactor)
 		/*
 		 * Request contains data to be placed on FTL, compact it
 		 */
-		ftl_writer_queue_rq(&dev->writer_user, rq);
+		ftl_writer_queue_rq(compaction_writer(dev, rq), rq);
 	} else {
 		compactor_deactivate(compactor);
 	}
@@ -1322,6 +1447,8 @@ ftl_nv_cache_write(struct ftl_io *io)
 
 	dev->nv_cache.throttle.blocks_submitted += io->num_blocks;
 
+	heat_update(&dev->nv_cache, io->lba, io->num_blocks);
+
 	return true;
 }
 
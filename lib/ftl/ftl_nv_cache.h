@@ -32,6 +32,11 @@
 
 #define FTL_NV_CACHE_NUM_COMPACTORS 8
 
+/* Default and maximum number of chunks compacted in parallel, each gets its own compactors */
+#define FTL_NV_CACHE_COMPACTION_CHUNKS_DEFAULT	2
+#define FTL_NV_CACHE_COMPACTION_CHUNKS_MAX	16
+#define FTL_NV_CACHE_COMPACTORS_PER_CHUNK	(FTL_NV_CACHE_NUM_COMPACTORS / FTL_NV_CACHE_COMPACTION_CHUNKS_DEFAULT)
+
 /*
  * Parameters controlling nv cache write throttling.
  *
@@ -50,6 +55,18 @@
 #define FTL_NV_CACHE_THROTTLE_MODIFIER_MIN	-0.8
 #define FTL_NV_CACHE_THROTTLE_MODIFIER_MAX	0.5
 
+/*
+ * Parameters of the update frequency tracking used to separate hot and cold data.
+ *
+ * User writes are counted per LBA region and the counters are halved each time the amount of
+ * data written reaches the size of the cache. During compaction data of regions updated more
+ * than FTL_NV_CACHE_HEAT_HOT_FACTOR times as often as the average goes to the hot writer.
+ */
+
+/* Number of LBAs in a region, as a power of two */
+#define FTL_NV_CACHE_HEAT_REGION_SHIFT	8
+#define FTL_NV_CACHE_HEAT_HOT_FACTOR	2
+
 struct ftl_nvcache_restore;
 typedef void (*ftl_nv_cache_restore_fn)(struct ftl_nvcache_restore *, int, void *cb_arg);
 
@@ -212,6 +229,10 @@ struct ftl_nv_cache {
 	uint64_t compaction_active_count;
 	uint64_t chunk_compaction_threshold;
 
+	/* Maximum number of chunks being compacted and number of compactors */
+	uint64_t chunk_comp_max;
+	uint64_t num_compactors;
+
 	struct ftl_nv_cache_chunk *chunks;
 
 	uint64_t last_seq_id;
@@ -236,6 +257,17 @@ struct ftl_nv_cache {
 		uint64_t blocks_submitted;
 		uint64_t blocks_submitted_limit;
 	} throttle;
+
+	/* Update frequency of LBA regions, only tracked when hot and cold data are separated */
+	struct {
+		uint16_t *counters;
+		uint64_t num_regions;
+		/* Sum of all counters */
+		uint64_t total;
+		/* Blocks written since the counters were last halved */
+		uint64_t blocks_written;
+		uint64_t decay_blocks;
+	} heat;
 };
 
 typedef void (*nvc_scrub_cb)(struct spdk_ftl_dev *dev, void *cb_ctx, int status);
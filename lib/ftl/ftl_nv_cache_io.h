@@ -27,6 +27,23 @@ ftl_nv_cache_bdev_read_blocks_with_md(struct spdk_ftl_dev *dev,
 	}
 }
 
+static inline int
+ftl_nv_cache_bdev_readv_blocks_with_md(struct spdk_ftl_dev *dev,
+				       struct spdk_bdev_desc *desc,
+				       struct spdk_io_channel *ch,
+				       struct iovec *iov, int iovcnt, void *md,
+				       uint64_t offset_blocks, uint64_t num_blocks,
+				       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	if (spdk_bdev_get_md_size(spdk_bdev_desc_get_bdev(desc))) {
+		return spdk_bdev_readv_blocks_with_md(desc, ch, iov, iovcnt, md ? : g_ftl_read_buf,
+						      offset_blocks, num_blocks, cb, cb_arg);
+	} else {
+		return spdk_bdev_readv_blocks(desc, ch, iov, iovcnt, offset_blocks, num_blocks,
+					      cb, cb_arg);
+	}
+}
+
 static inline int
 ftl_nv_cache_bdev_write_blocks_with_md(struct spdk_ftl_dev *dev,
 				       struct spdk_bdev_desc *desc,
@@ -10,7 +10,7 @@
 
 void
 ftl_writer_init(struct spdk_ftl_dev *dev, struct ftl_writer *writer,
-		uint64_t limit, enum ftl_band_type type)
+		uint64_t limit, enum ftl_band_type type, uint64_t max_bands)
 {
 	memset(writer, 0, sizeof(*writer));
 	writer->dev = dev;
@@ -19,6 +19,7 @@ ftl_writer_init(struct spdk_ftl_dev *dev, struct ftl_writer *writer,
 	writer->limit = limit;
 	writer->halt = true;
 	writer->writer_type = type;
+	writer->max_bands = max_bands;
 }
 
 static bool
@@ -100,9 +101,9 @@ get_band(struct ftl_writer *writer)
 			}
 		}
 
-		if (writer->num_bands >= FTL_LAYOUT_REGION_TYPE_P2L_COUNT / 2) {
+		if (writer->num_bands >= writer->max_bands) {
 			/* Maximum number of opened band exceed (we split this
-			 * value between and compaction and GC writer
+			 * value between and compaction and GC writers
 			 */
 			return NULL;
 		}
@@ -112,6 +113,7 @@ get_band(struct ftl_writer *writer)
 			writer->num_bands++;
 			ftl_band_set_owner(writer->band,
 					   ftl_writer_band_state_change, writer);
+			writer->band->placement_handle = writer->placement_handle;
 
 			if (ftl_band_write_prep(writer->band)) {
 				/*
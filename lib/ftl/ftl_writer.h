@@ -22,6 +22,9 @@ struct ftl_writer {
 	/* Number of bands associated with writer */
 	uint64_t num_bands;
 
+	/* Maximum number of bands associated with writer, limited by P2L checkpoint regions */
+	uint64_t max_bands;
+
 	/* Band next being written to */
 	struct ftl_band *next_band;
 
@@ -37,6 +40,9 @@ struct ftl_writer {
 	/* Which type of band the writer uses */
 	enum ftl_band_type writer_type;
 
+	/* FDP placement handle the bands of the writer are written with */
+	uint16_t placement_handle;
+
 	uint64_t last_seq_id;
 
 	/* FTL request to pad the current band */
@@ -46,7 +52,7 @@ struct ftl_writer {
 bool ftl_writer_is_halted(struct ftl_writer *writer);
 
 void ftl_writer_init(struct spdk_ftl_dev *dev, struct ftl_writer *writer,
-		     uint64_t limit, enum ftl_band_type type);
+		     uint64_t limit, enum ftl_band_type type, uint64_t max_bands);
 
 void ftl_writer_run(struct ftl_writer *writer);
 
@@ -248,6 +248,7 @@ ftl_recover_max_seq(struct spdk_ftl_dev *dev)
 	dev->nv_cache.last_seq_id = chunk_close_seq_id;
 	dev->writer_gc.last_seq_id = band_close_seq_id;
 	dev->writer_user.last_seq_id = band_close_seq_id;
+	dev->writer_user_cold.last_seq_id = band_close_seq_id;
 
 	max = spdk_max(max, band_open_seq_id);
 	max = spdk_max(max, band_close_seq_id);
@@ -345,6 +346,19 @@ ftl_property_dump_base_dev(struct spdk_ftl_dev *dev, const struct ftl_property *
 	spdk_json_write_array_end(w);
 }
 
+static void
+ftl_property_dump_gc(struct spdk_ftl_dev *dev, const struct ftl_property *property,
+		     struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_named_object_begin(w, "gc");
+	spdk_json_write_named_string(w, "policy", dev->gc.cost_benefit ? "cost_benefit" : "greedy");
+	spdk_json_write_named_uint64(w, "bands_picked", dev->gc.bands_picked);
+	spdk_json_write_named_uint64(w, "valid_blocks", dev->gc.valid_blocks);
+	spdk_json_write_named_double(w, "average_validity", dev->gc.user_blocks ?
+				     (double)dev->gc.valid_blocks / dev->gc.user_blocks : 0.0);
+	spdk_json_write_object_end(w);
+}
+
 void
 ftl_mngt_finalize_init_bands(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 {
@@ -357,6 +371,11 @@ ftl_mngt_finalize_init_bands(struct spdk_ftl_dev *dev, struct ftl_mngt_process *
 	ftl_recover_max_seq(dev);
 	ftl_property_register(dev, "base_device", NULL, 0, NULL, NULL, ftl_property_dump_base_dev, NULL,
 			      NULL, true);
+	ftl_property_register(dev, "gc_stats", NULL, 0, NULL, "Bands picked for relocation and their "
+			      "validity at the time they were picked", ftl_property_dump_gc, NULL, NULL, false);
+	ftl_property_register_bool_rw(dev, "gc_cost_benefit", &dev->gc.cost_benefit, "",
+				      "Pick bands for relocation by their age multiplied by invalidity, "
+				      "instead of invalidity only", false);
 
 	TAILQ_FOREACH_SAFE(band, &dev->free_bands, queue_entry, temp_band) {
 		band->md->df_p2l_map = FTL_DF_OBJ_ID_INVALID;
@@ -391,6 +410,10 @@ ftl_mngt_finalize_init_bands(struct spdk_ftl_dev *dev, struct ftl_mngt_process *
 
 		if (band->md->type == FTL_BAND_TYPE_COMPACTION) {
 			writer = &dev->writer_user;
+			if (writer->num_bands >= writer->max_bands &&
+			    dev->writer_user_cold.num_bands < dev->writer_user_cold.max_bands) {
+				writer = &dev->writer_user_cold;
+			}
 		} else if (band->md->type == FTL_BAND_TYPE_GC) {
 			writer = &dev->writer_gc;
 		} else {
@@ -409,6 +432,7 @@ ftl_mngt_finalize_init_bands(struct spdk_ftl_dev *dev, struct ftl_mngt_process *
 
 		writer->num_bands++;
 		ftl_band_set_owner(band, ftl_writer_band_state_change, writer);
+		band->placement_handle = writer->placement_handle;
 
 		if (fast_startup) {
 			FTL_NOTICELOG(dev, "SHM: band open P2L map df_id 0x%"PRIx64"\n", band->md->df_p2l_map);
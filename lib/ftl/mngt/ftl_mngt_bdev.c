@@ -120,6 +120,12 @@ ftl_mngt_open_base_bdev(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 		goto error;
 	}
 
+	if (dev->conf.fdp_placement_handles && !spdk_bdev_get_nvme_ctratt(bdev).bits.fdps) {
+		FTL_ERRLOG(dev, "Bdev %s doesn't support flexible data placement\n",
+			   spdk_bdev_get_name(bdev));
+		goto error;
+	}
+
 	dev->base_layout_tracker = ftl_layout_tracker_bdev_init(spdk_bdev_get_num_blocks(bdev));
 	if (!dev->base_layout_tracker) {
 		FTL_ERRLOG(dev, "Failed to instantiate layout tracker for base device\n");
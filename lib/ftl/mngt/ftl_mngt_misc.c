@@ -196,6 +196,7 @@ ftl_mngt_finalize_startup(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mng
 	ftl_l2p_resume(dev);
 	ftl_reloc_resume(dev->reloc);
 	ftl_writer_resume(&dev->writer_user);
+	ftl_writer_resume(&dev->writer_user_cold);
 	ftl_writer_resume(&dev->writer_gc);
 	ftl_nv_cache_resume(&dev->nv_cache);
 
@@ -34,6 +34,16 @@ struct ftl_mngt_recovery_ctx {
 		uint64_t lba_last;
 		uint32_t i;
 	} iter;
+	/*
+	 * Recovery iterations each band holds LBAs of, gathered in the first iteration, so that
+	 * the following ones read the P2L maps of the bands they need only. Bit n of the mask is
+	 * set if the band has LBAs in any of iterations [n * iters_per_bit, (n + 1) * iters_per_bit).
+	 */
+	struct {
+		uint64_t *mask;
+		uint64_t iters_per_bit;
+		bool ready;
+	} band_iters;
 	uint64_t p2l_ckpt_seq_id[FTL_LAYOUT_REGION_TYPE_P2L_COUNT];
 };
 
@@ -41,6 +51,22 @@ static const struct ftl_mngt_process_desc g_desc_recovery_iteration;
 static const struct ftl_mngt_process_desc g_desc_recovery;
 static const struct ftl_mngt_process_desc g_desc_recovery_shm;
 
+static inline uint64_t
+recovery_band_iters_bit(struct ftl_mngt_recovery_ctx *ctx, uint64_t lba)
+{
+	return 1ULL << (lba / ctx->l2p_snippet.count / ctx->band_iters.iters_per_bit);
+}
+
+static bool
+recovery_band_in_iter(struct ftl_mngt_recovery_ctx *ctx, struct ftl_band *band)
+{
+	if (!ctx->band_iters.ready) {
+		return true;
+	}
+
+	return ctx->band_iters.mask[band->id] & recovery_band_iters_bit(ctx, ctx->iter.lba_first);
+}
+
 static bool
 recovery_iter_done(struct spdk_ftl_dev *dev, struct ftl_mngt_recovery_ctx *ctx)
 {
@@ -120,6 +146,13 @@ ftl_mngt_recovery_init(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 	FTL_NOTICELOG(dev, "Recovery iterations: %"PRIu64"\n", iterations);
 	dev->sb->ckpt_seq_id = 0;
 
+	ctx->band_iters.iters_per_bit = spdk_divide_round_up(iterations, 64);
+	ctx->band_iters.mask = calloc(ftl_get_num_bands(dev), sizeof(*ctx->band_iters.mask));
+	if (!ctx->band_iters.mask) {
+		ftl_mngt_fail_step(mngt);
+		return;
+	}
+
 	/* Initialize region */
 	ctx->l2p_snippet.region = *ftl_layout_region_get(dev, FTL_LAYOUT_REGION_TYPE_L2P);
 	/* Limit blocks in region, it will be needed for ftl_md_set_region */
@@ -164,6 +197,9 @@ ftl_mngt_recovery_deinit(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt
 	ctx->l2p_snippet.md = NULL;
 	ctx->l2p_snippet.seq_id = NULL;
 
+	free(ctx->band_iters.mask);
+	ctx->band_iters.mask = NULL;
+
 	ftl_mngt_next_step(mngt);
 }
 
@@ -172,6 +208,8 @@ recovery_iteration_cb(struct spdk_ftl_dev *dev, void *_ctx, int status)
 {
 	struct ftl_mngt_recovery_ctx *ctx = _ctx;
 
+	/* The first iteration walked all the bands, the following ones may skip some */
+	ctx->band_iters.ready = true;
 	recovery_iter_advance(dev, ctx);
 
 	if (status) {
@@ -252,6 +290,7 @@ struct band_md_ctx {
 	int status;
 	uint64_t qd;
 	uint64_t id;
+	uint64_t skipped;
 };
 
 static void
@@ -259,6 +298,7 @@ ftl_mngt_recovery_walk_band_tail_md(struct spdk_ftl_dev *dev, struct ftl_mngt_pr
 				    ftl_band_md_cb cb)
 {
 	struct band_md_ctx *sctx = ftl_mngt_get_step_ctx(mngt);
+	struct ftl_mngt_recovery_ctx *pctx = ftl_mngt_get_caller_ctx(mngt);
 	uint64_t num_bands = ftl_get_num_bands(dev);
 
 	/*
@@ -266,6 +306,11 @@ ftl_mngt_recovery_walk_band_tail_md(struct spdk_ftl_dev *dev, struct ftl_mngt_pr
 	 * are processed before returning an error (if any were found) or continuing on.
 	 */
 	if (0 == sctx->qd && sctx->id == num_bands) {
+		if (sctx->skipped) {
+			FTL_NOTICELOG(dev, "Skipped %"PRIu64" bands without LBAs in the iteration\n",
+				      sctx->skipped);
+		}
+
 		if (sctx->status) {
 			ftl_mngt_fail_step(mngt);
 		} else {
@@ -282,6 +327,12 @@ ftl_mngt_recovery_walk_band_tail_md(struct spdk_ftl_dev *dev, struct ftl_mngt_pr
 			continue;
 		}
 
+		if (!recovery_band_in_iter(pctx, band)) {
+			sctx->id++;
+			sctx->skipped++;
+			continue;
+		}
+
 		if (FTL_BAND_STATE_OPEN == band->md->state || FTL_BAND_STATE_FULL == band->md->state) {
 			/* This band is already open and has valid P2L map */
 			sctx->id++;
@@ -401,6 +452,7 @@ restore_band_l2p_cb(struct ftl_band *band, void *cntx, enum ftl_md_status status
 	struct spdk_ftl_dev *dev = band->dev;
 	ftl_addr addr, curr_addr;
 	uint64_t i, lba, seq_id, num_blks_in_band;
+	uint64_t iters_mask = 0;
 	uint32_t band_map_crc;
 	int rc = 0;
 
@@ -435,6 +487,9 @@ restore_band_l2p_cb(struct ftl_band *band, void *cntx, enum ftl_md_status status
 			rc = -EINVAL;
 			break;
 		}
+		if (!pctx->band_iters.ready) {
+			iters_mask |= recovery_band_iters_bit(pctx, lba);
+		}
 		if (lba < pctx->iter.lba_first || lba >= pctx->iter.lba_last) {
 			continue;
 		}
@@ -473,6 +528,9 @@ restore_band_l2p_cb(struct ftl_band *band, void *cntx, enum ftl_md_status status
 		pctx->l2p_snippet.seq_id[lba_off] = seq_id;
 	}
 
+	if (!pctx->band_iters.ready) {
+		pctx->band_iters.mask[band->id] = iters_mask;
+	}
 
 cleanup:
 	ftl_band_release_p2l_map(band);
@@ -29,6 +29,7 @@ static const struct spdk_ftl_conf g_default_conf = {
 		.chunk_free_target = 5,
 	},
 	.fast_shutdown = true,
+	.nv_cache_compaction_chunks = FTL_NV_CACHE_COMPACTION_CHUNKS_DEFAULT,
 };
 
 void
@@ -172,6 +173,10 @@ ftl_conf_is_valid(const struct spdk_ftl_conf *conf)
 		return false;
 	}
 
+	if (conf->nv_cache_compaction_chunks > FTL_NV_CACHE_COMPACTION_CHUNKS_MAX) {
+		return false;
+	}
+
 	if (conf->l2p_dram_limit == 0) {
 		return false;
 	}
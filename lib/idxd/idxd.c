@@ -36,6 +36,11 @@
 static STAILQ_HEAD(, spdk_idxd_impl) g_idxd_impls = STAILQ_HEAD_INITIALIZER(g_idxd_impls);
 static struct spdk_idxd_impl *g_idxd_impl;
 
+/* Number of descriptors after which an open batch is submitted right away */
+static uint16_t g_idxd_batch_flush = IDXD_MIN_BATCH_FLUSH;
+/* How long an open batch may be held across polls, 0 means it's submitted on each poll */
+static uint64_t g_idxd_batch_latency_ticks;
+
 uint32_t
 spdk_idxd_get_socket(struct spdk_idxd_device *idxd)
 {
@@ -375,6 +380,20 @@ spdk_idxd_set_config(bool kernel_mode)
 	return 0;
 }
 
+int
+spdk_idxd_set_batch_opts(uint16_t max_batch_size, uint32_t max_latency_us)
+{
+	if (max_batch_size == 0) {
+		SPDK_ERRLOG("Batch size must be greater than 0\n");
+		return -EINVAL;
+	}
+
+	g_idxd_batch_flush = max_batch_size;
+	g_idxd_batch_latency_ticks = (uint64_t)max_latency_us * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+
+	return 0;
+}
+
 static void
 idxd_device_destruct(struct spdk_idxd_device *idxd)
 {
@@ -488,6 +507,7 @@ idxd_batch_create(struct spdk_idxd_io_channel *chan)
 		batch = TAILQ_FIRST(&chan->batch_pool);
 		batch->index = 0;
 		batch->chan = chan;
+		batch->open_tsc = g_idxd_batch_latency_ticks != 0 ? spdk_get_ticks() : 0;
 		chan->batch = batch;
 		TAILQ_REMOVE(&chan->batch_pool, batch, link);
 	} else {
@@ -599,11 +619,27 @@ idxd_batch_submit(struct spdk_idxd_io_channel *chan,
 	return 0;
 }
 
+static inline bool
+_idxd_batch_expired(struct idxd_batch *batch)
+{
+	return g_idxd_batch_latency_ticks == 0 ||
+	       spdk_get_ticks() - batch->open_tsc >= g_idxd_batch_latency_ticks;
+}
+
 static int
 _idxd_setup_batch(struct spdk_idxd_io_channel *chan)
 {
 	struct idxd_batch *batch;
 
+	/*
+	 * A batch held across polls is closed out here once it's been open for too long, so
+	 * a slow poller doesn't stretch the latency of the operations already sitting in it.
+	 */
+	if (chan->batch != NULL && g_idxd_batch_latency_ticks != 0 &&
+	    _idxd_batch_expired(chan->batch)) {
+		idxd_batch_submit(chan, NULL, NULL);
+	}
+
 	if (chan->batch == NULL) {
 		batch = idxd_batch_create(chan);
 		if (batch == NULL) {
@@ -620,7 +656,7 @@ _idxd_flush_batch(struct spdk_idxd_io_channel *chan)
 	struct idxd_batch *batch = chan->batch;
 	int rc;
 
-	if (batch != NULL && batch->index >= IDXD_MIN_BATCH_FLUSH) {
+	if (batch != NULL && batch->index >= spdk_min(g_idxd_batch_flush, batch->size)) {
 		/* Close out the full batch */
 		rc = idxd_batch_submit(chan, NULL, NULL);
 		if (rc) {
@@ -2198,8 +2234,8 @@ spdk_idxd_process_events(struct spdk_idxd_io_channel *chan)
 		}
 	}
 
-	/* Submit any built-up batch */
-	if (chan->batch) {
+	/* Submit any built-up batch, unless it's still allowed to accumulate more descriptors */
+	if (chan->batch && _idxd_batch_expired(chan->batch)) {
 		rc2 = idxd_batch_submit(chan, NULL, NULL);
 		if (rc2) {
 			assert(rc2 == -EBUSY);
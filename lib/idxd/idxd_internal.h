@@ -52,6 +52,8 @@ struct idxd_batch {
 	uint16_t			index;
 	uint16_t			refcnt;
 	uint16_t			size;
+	/* Tick count at which the batch was opened, only set when batches may be held */
+	uint64_t			open_tsc;
 	struct spdk_idxd_io_channel	*chan;
 	TAILQ_ENTRY(idxd_batch)		link;
 };
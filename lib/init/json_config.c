@@ -42,10 +42,6 @@
  *
  */
 
-struct load_json_config_ctx;
-typedef void (*client_resp_handler)(struct load_json_config_ctx *,
-				    struct spdk_jsonrpc_client_response *);
-
 #define RPC_SOCKET_PATH_MAX SPDK_SIZEOF_MEMBER(struct sockaddr_un, sun_path)
 
 /* 1s connections timeout */
@@ -57,6 +53,26 @@ typedef void (*client_resp_handler)(struct load_json_config_ctx *,
  * So just print WARNLOG every 10s. */
 #define RPC_CLIENT_REQUEST_TIMEOUT_US (10U * 1000 * 1000)
 
+/*
+ * Number of times the private RPC server and the client are polled back to back on each
+ * poller tick. Sending a request, handling it and sending back the response each need one
+ * pass, so a method that completes synchronously is applied within a single tick.
+ */
+#define RPC_CLIENT_POLL_ROUNDS 4
+
+/*
+ * Number of connections to the private RPC server. A JSON-RPC client carries a single request
+ * at a time, so this is the number of configuration entries that can be applied concurrently.
+ */
+#define RPC_CLIENT_MAX_CONNS 16
+
+struct json_config_client {
+	struct spdk_jsonrpc_client *conn;
+	/* "nqn" parameter of the entry being applied, NULL if the entry has none. */
+	struct spdk_json_val *key;
+	bool busy;
+};
+
 struct load_json_config_ctx {
 	/* Thread used during configuration. */
 	struct spdk_thread *thread;
@@ -87,10 +103,16 @@ struct load_json_config_ctx {
 
 	char rpc_socket_path_temp[RPC_SOCKET_PATH_MAX + 1];
 
-	struct spdk_jsonrpc_client *client_conn;
+	/* Private RPC server serving the configuration requests, polled by the client pollers. */
+	struct spdk_rpc_server *rpc_server;
+
+	struct json_config_client clients[RPC_CLIENT_MAX_CONNS];
 	struct spdk_poller *client_conn_poller;
 
-	client_resp_handler client_resp_cb;
+	/* Number of requests sent and not yet responded to. */
+	uint32_t num_outstanding;
+	/* Error ending the configuration once all outstanding requests are responded to. */
+	int status;
 
 	/* Timeout for current RPC client action. */
 	uint64_t timeout;
@@ -104,12 +126,18 @@ static void app_json_config_load_subsystem(void *_ctx);
 static void
 app_json_config_load_done(struct load_json_config_ctx *ctx, int rc)
 {
+	uint32_t i;
+
 	spdk_poller_unregister(&ctx->client_conn_poller);
-	if (ctx->client_conn != NULL) {
-		spdk_jsonrpc_client_close(ctx->client_conn);
+	for (i = 0; i < SPDK_COUNTOF(ctx->clients); i++) {
+		if (ctx->clients[i].conn != NULL) {
+			spdk_jsonrpc_client_close(ctx->clients[i].conn);
+		}
 	}
 
-	spdk_rpc_server_finish(ctx->rpc_socket_path_temp);
+	if (ctx->rpc_server != NULL) {
+		spdk_rpc_server_close(ctx->rpc_server);
+	}
 
 	SPDK_DEBUG_APP_CFG("Config load finished with rc %d\n", rc);
 	ctx->cb_fn(rc, ctx->cb_arg);
@@ -119,6 +147,20 @@ app_json_config_load_done(struct load_json_config_ctx *ctx, int rc)
 	free(ctx);
 }
 
+static void
+app_json_config_load_fail(struct load_json_config_ctx *ctx, int rc)
+{
+	if (ctx->num_outstanding > 0) {
+		/* Requests still in flight reference the connections, finish once they are done. */
+		if (ctx->status == 0) {
+			ctx->status = rc;
+		}
+		return;
+	}
+
+	app_json_config_load_done(ctx, rc);
+}
+
 static void
 rpc_client_set_timeout(struct load_json_config_ctx *ctx, uint64_t timeout_us)
 {
@@ -155,34 +197,14 @@ json_write_stdout(void *cb_ctx, const void *data, size_t size)
 	return rc == size ? 0 : -1;
 }
 
-static int
-rpc_client_poller(void *arg)
+static void app_json_config_load_subsystem_config_entry(void *_ctx);
+
+static void
+rpc_client_handle_response(struct load_json_config_ctx *ctx, struct json_config_client *client)
 {
-	struct load_json_config_ctx *ctx = arg;
 	struct spdk_jsonrpc_client_response *resp;
-	client_resp_handler cb;
-	int rc;
-
-	assert(spdk_get_thread() == ctx->thread);
 
-	rc = spdk_jsonrpc_client_poll(ctx->client_conn, 0);
-	if (rc == 0) {
-		rc = rpc_client_check_timeout(ctx);
-		if (rc == -ETIMEDOUT) {
-			rpc_client_set_timeout(ctx, RPC_CLIENT_REQUEST_TIMEOUT_US);
-			rc = 0;
-		}
-	}
-
-	if (rc == 0) {
-		/* No response yet */
-		return SPDK_POLLER_BUSY;
-	} else if (rc < 0) {
-		app_json_config_load_done(ctx, rc);
-		return SPDK_POLLER_BUSY;
-	}
-
-	resp = spdk_jsonrpc_client_get_response(ctx->client_conn);
+	resp = spdk_jsonrpc_client_get_response(client->conn);
 	assert(resp);
 
 	if (resp->error) {
@@ -197,21 +219,72 @@ rpc_client_poller(void *arg)
 			spdk_json_write_end(w);
 			SPDK_ERRLOG("error response: \n%s\n", buf.data);
 		}
+
+		if (ctx->stop_on_error && ctx->status == 0) {
+			ctx->status = -EINVAL;
+		}
 	}
 
-	if (resp->error && ctx->stop_on_error) {
-		spdk_jsonrpc_client_free_response(resp);
-		app_json_config_load_done(ctx, -EINVAL);
-	} else {
-		/* We have response so we must have callback for it. */
-		cb = ctx->client_resp_cb;
-		assert(cb != NULL);
+	/* Don't care about the response otherwise */
+	spdk_jsonrpc_client_free_response(resp);
+
+	client->busy = false;
+	client->key = NULL;
+	assert(ctx->num_outstanding > 0);
+	ctx->num_outstanding--;
+}
+
+static int
+rpc_client_poller(void *arg)
+{
+	struct load_json_config_ctx *ctx = arg;
+	struct json_config_client *client;
+	uint32_t c, completed = 0;
+	int i, rc;
+
+	assert(spdk_get_thread() == ctx->thread);
+
+	/* Drive the private server directly rather than waiting for the RPC subsystem poller,
+	 * so each configuration entry costs one poller tick instead of a RPC_SELECT_INTERVAL. */
+	for (i = 0; i < RPC_CLIENT_POLL_ROUNDS && completed == 0; i++) {
+		spdk_rpc_server_accept(ctx->rpc_server);
+		for (c = 0; c < SPDK_COUNTOF(ctx->clients); c++) {
+			client = &ctx->clients[c];
+			if (!client->busy) {
+				continue;
+			}
+
+			rc = spdk_jsonrpc_client_poll(client->conn, 0);
+			if (rc < 0) {
+				ctx->num_outstanding = 0;
+				app_json_config_load_done(ctx, rc);
+				return SPDK_POLLER_BUSY;
+			} else if (rc > 0) {
+				rpc_client_handle_response(ctx, client);
+				completed++;
+			}
+		}
+	}
+
+	if (completed == 0) {
+		/* No response yet */
+		if (ctx->num_outstanding > 0 && rpc_client_check_timeout(ctx) == -ETIMEDOUT) {
+			rpc_client_set_timeout(ctx, RPC_CLIENT_REQUEST_TIMEOUT_US);
+		}
+		return SPDK_POLLER_BUSY;
+	}
+
+	rpc_client_set_timeout(ctx, RPC_CLIENT_REQUEST_TIMEOUT_US);
 
-		/* Mark we are done with this handler. */
-		ctx->client_resp_cb = NULL;
-		cb(ctx, resp);
+	if (ctx->status != 0) {
+		if (ctx->num_outstanding == 0) {
+			app_json_config_load_done(ctx, ctx->status);
+		}
+		return SPDK_POLLER_BUSY;
 	}
 
+	/* Send the entries that were waiting for the completed ones */
+	app_json_config_load_subsystem_config_entry(ctx);
 
 	return SPDK_POLLER_BUSY;
 }
@@ -220,10 +293,18 @@ static int
 rpc_client_connect_poller(void *_ctx)
 {
 	struct load_json_config_ctx *ctx = _ctx;
+	bool connected = true;
+	uint32_t i;
 	int rc;
 
-	rc = spdk_jsonrpc_client_poll(ctx->client_conn, 0);
-	if (rc != -ENOTCONN) {
+	spdk_rpc_server_accept(ctx->rpc_server);
+	for (i = 0; i < SPDK_COUNTOF(ctx->clients); i++) {
+		if (spdk_jsonrpc_client_poll(ctx->clients[i].conn, 0) == -ENOTCONN) {
+			connected = false;
+		}
+	}
+
+	if (connected) {
 		/* We are connected. Start regular poller and issue first request */
 		spdk_poller_unregister(&ctx->client_conn_poller);
 		ctx->client_conn_poller = SPDK_POLLER_REGISTER(rpc_client_poller, ctx, 100);
@@ -240,17 +321,47 @@ rpc_client_connect_poller(void *_ctx)
 	return SPDK_POLLER_BUSY;
 }
 
+/*
+ * Get a connection for an entry with the given "nqn" parameter. Entries of different NVMe-oF
+ * subsystems don't depend on each other, so they are applied concurrently, while entries of
+ * the same subsystem keep their order. Any entry without "nqn" may depend on everything sent
+ * before it (and the other way around), so it waits for all outstanding requests and is
+ * applied alone. Returns NULL if the entry has to wait.
+ */
+static struct json_config_client *
+json_config_get_client(struct load_json_config_ctx *ctx, const struct spdk_json_val *key)
+{
+	struct json_config_client *client, *free_client = NULL;
+	uint32_t i;
+
+	for (i = 0; i < SPDK_COUNTOF(ctx->clients); i++) {
+		client = &ctx->clients[i];
+		if (!client->busy) {
+			if (free_client == NULL) {
+				free_client = client;
+			}
+			continue;
+		}
+
+		if (key == NULL || client->key == NULL ||
+		    (key->len == client->key->len && memcmp(key->start, client->key->start, key->len) == 0)) {
+			return NULL;
+		}
+	}
+
+	return free_client;
+}
+
 static int
-client_send_request(struct load_json_config_ctx *ctx, struct spdk_jsonrpc_client_request *request,
-		    client_resp_handler client_resp_cb)
+client_send_request(struct load_json_config_ctx *ctx, struct json_config_client *client,
+		    struct spdk_jsonrpc_client_request *request)
 {
 	int rc;
 
 	assert(spdk_get_thread() == ctx->thread);
 
-	ctx->client_resp_cb = client_resp_cb;
 	rpc_client_set_timeout(ctx, RPC_CLIENT_REQUEST_TIMEOUT_US);
-	rc = spdk_jsonrpc_client_send_request(ctx->client_conn, request);
+	rc = spdk_jsonrpc_client_send_request(client->conn, request);
 
 	if (rc) {
 		SPDK_DEBUG_APP_CFG("Sending request to client failed (%d)\n", rc);
@@ -309,54 +420,33 @@ static struct spdk_json_object_decoder jsonrpc_cmd_decoders[] = {
 	{"params", offsetof(struct config_entry, params), cap_object, true}
 };
 
-static void app_json_config_load_subsystem_config_entry(void *_ctx);
-
-static void
-app_json_config_load_subsystem_config_entry_next(struct load_json_config_ctx *ctx,
-		struct spdk_jsonrpc_client_response *resp)
-{
-	/* Don't care about the response */
-	spdk_jsonrpc_client_free_response(resp);
-
-	ctx->config_it = spdk_json_next(ctx->config_it);
-	app_json_config_load_subsystem_config_entry(ctx);
-}
-
-/* Load "config" entry */
-static void
-app_json_config_load_subsystem_config_entry(void *_ctx)
+/*
+ * Apply the "config" entry pointed by ctx->config_it. Returns 0 if the request has been sent or
+ * the entry is skipped, -EAGAIN if the entry has to wait for outstanding requests.
+ */
+static int
+app_json_config_apply_config_entry(struct load_json_config_ctx *ctx)
 {
-	struct load_json_config_ctx *ctx = _ctx;
+	struct json_config_client *client;
 	struct spdk_jsonrpc_client_request *rpc_request;
 	struct spdk_json_write_ctx *w;
 	struct config_entry cfg = {};
-	struct spdk_json_val *params_end;
+	struct spdk_json_val *params_end, *key = NULL;
 	size_t params_len = 0;
 	uint32_t state_mask = 0, cur_state_mask, startup_runtime = SPDK_RPC_STARTUP | SPDK_RPC_RUNTIME;
 	int rc;
 
-	if (ctx->config_it == NULL) {
-		SPDK_DEBUG_APP_CFG("Subsystem '%.*s': configuration done.\n", ctx->subsystem_name->len,
-				   (char *)ctx->subsystem_name->start);
-		ctx->subsystems_it = spdk_json_next(ctx->subsystems_it);
-		/* Invoke later to avoid recursion */
-		spdk_thread_send_msg(ctx->thread, app_json_config_load_subsystem, ctx);
-		return;
-	}
-
 	if (spdk_json_decode_object(ctx->config_it, jsonrpc_cmd_decoders,
 				    SPDK_COUNTOF(jsonrpc_cmd_decoders), &cfg)) {
 		SPDK_ERRLOG("Failed to decode config entry\n");
-		app_json_config_load_done(ctx, -EINVAL);
+		rc = -EINVAL;
 		goto out;
 	}
 
 	rc = spdk_rpc_get_method_state_mask(cfg.method, &state_mask);
 	if (rc == -ENOENT) {
 		if (!ctx->stop_on_error) {
-			/* Invoke later to avoid recursion */
-			ctx->config_it = spdk_json_next(ctx->config_it);
-			spdk_thread_send_msg(ctx->thread, app_json_config_load_subsystem_config_entry, ctx);
+			rc = 0;
 		} else if (!spdk_subsystem_exists(ctx->subsystem_name_str)) {
 			/* If the subsystem does not exist, just skip it, even
 			 * if we are supposed to stop_on_error. Users may generate
@@ -371,30 +461,31 @@ app_json_config_load_subsystem_config_entry(void *_ctx)
 			SPDK_NOTICELOG("Skipping method '%s' because its subsystem '%s' "
 				       "is not linked into this application.\n",
 				       cfg.method, ctx->subsystem_name_str);
-			/* Invoke later to avoid recursion */
-			ctx->config_it = spdk_json_next(ctx->config_it);
-			spdk_thread_send_msg(ctx->thread, app_json_config_load_subsystem_config_entry, ctx);
+			rc = 0;
 		} else {
 			SPDK_ERRLOG("Method '%s' was not found\n", cfg.method);
-			app_json_config_load_done(ctx, rc);
 		}
 		goto out;
 	}
 	cur_state_mask = spdk_rpc_get_state();
 	if ((state_mask & cur_state_mask) != cur_state_mask) {
 		SPDK_DEBUG_APP_CFG("Method '%s' not allowed -> skipping\n", cfg.method);
-		/* Invoke later to avoid recursion */
-		ctx->config_it = spdk_json_next(ctx->config_it);
-		spdk_thread_send_msg(ctx->thread, app_json_config_load_subsystem_config_entry, ctx);
 		goto out;
 	}
 	if ((state_mask & startup_runtime) == startup_runtime && cur_state_mask == SPDK_RPC_RUNTIME) {
 		/* Some methods are allowed to be run in both STARTUP and RUNTIME states.
 		 * We should not call such methods twice, so ignore the second attempt in RUNTIME state */
 		SPDK_DEBUG_APP_CFG("Method '%s' has already been run in STARTUP state\n", cfg.method);
-		/* Invoke later to avoid recursion */
-		ctx->config_it = spdk_json_next(ctx->config_it);
-		spdk_thread_send_msg(ctx->thread, app_json_config_load_subsystem_config_entry, ctx);
+		goto out;
+	}
+
+	if (cfg.params && spdk_json_find_string(cfg.params, "nqn", NULL, &key) != 0) {
+		key = NULL;
+	}
+
+	client = json_config_get_client(ctx, key);
+	if (client == NULL) {
+		rc = -EAGAIN;
 		goto out;
 	}
 
@@ -412,14 +503,14 @@ app_json_config_load_subsystem_config_entry(void *_ctx)
 
 	rpc_request = spdk_jsonrpc_client_create_request();
 	if (!rpc_request) {
-		app_json_config_load_done(ctx, -errno);
+		rc = -errno;
 		goto out;
 	}
 
 	w = spdk_jsonrpc_begin_request(rpc_request, ctx->rpc_request_id, NULL);
 	if (!w) {
 		spdk_jsonrpc_client_free_request(rpc_request);
-		app_json_config_load_done(ctx, -ENOMEM);
+		rc = -ENOMEM;
 		goto out;
 	}
 
@@ -434,13 +525,50 @@ app_json_config_load_subsystem_config_entry(void *_ctx)
 
 	spdk_jsonrpc_end_request(rpc_request, w);
 
-	rc = client_send_request(ctx, rpc_request, app_json_config_load_subsystem_config_entry_next);
+	rc = client_send_request(ctx, client, rpc_request);
 	if (rc != 0) {
-		app_json_config_load_done(ctx, -rc);
+		rc = -rc;
 		goto out;
 	}
+
+	client->busy = true;
+	client->key = key;
+	ctx->num_outstanding++;
 out:
 	free(cfg.method);
+	return rc;
+}
+
+/* Load "config" entries */
+static void
+app_json_config_load_subsystem_config_entry(void *_ctx)
+{
+	struct load_json_config_ctx *ctx = _ctx;
+	int rc;
+
+	while (ctx->config_it != NULL) {
+		rc = app_json_config_apply_config_entry(ctx);
+		if (rc == -EAGAIN) {
+			/* Resumed by the client poller once a response arrives */
+			return;
+		} else if (rc != 0) {
+			app_json_config_load_fail(ctx, rc);
+			return;
+		}
+
+		ctx->config_it = spdk_json_next(ctx->config_it);
+	}
+
+	if (ctx->num_outstanding > 0) {
+		/* The next subsystem may depend on any entry of this one */
+		return;
+	}
+
+	SPDK_DEBUG_APP_CFG("Subsystem '%.*s': configuration done.\n", ctx->subsystem_name->len,
+			   (char *)ctx->subsystem_name->start);
+	ctx->subsystems_it = spdk_json_next(ctx->subsystems_it);
+	/* Invoke later to avoid recursion */
+	spdk_thread_send_msg(ctx->thread, app_json_config_load_subsystem, ctx);
 }
 
 static void
@@ -576,6 +704,7 @@ json_config_prepare_ctx(spdk_subsystem_init_fn cb_fn, void *cb_arg, bool stop_on
 			ssize_t json_size, bool initalize_subsystems)
 {
 	struct load_json_config_ctx *ctx = calloc(1, sizeof(*ctx));
+	uint32_t i;
 	int rc;
 
 	if (!ctx) {
@@ -626,17 +755,26 @@ json_config_prepare_ctx(spdk_subsystem_init_fn cb_fn, void *cb_arg, bool stop_on
 		goto fail;
 	}
 
-	rc = spdk_rpc_initialize(ctx->rpc_socket_path_temp, NULL);
-	if (rc) {
+	if (!spdk_rpc_verify_methods()) {
 		goto fail;
 	}
 
-	ctx->client_conn = spdk_jsonrpc_client_connect(ctx->rpc_socket_path_temp, AF_UNIX);
-	if (ctx->client_conn == NULL) {
-		SPDK_ERRLOG("Failed to connect to '%s'\n", ctx->rpc_socket_path_temp);
+	/* The server is not registered with spdk_rpc_initialize(), the client pollers poll
+	 * it themselves. */
+	ctx->rpc_server = spdk_rpc_server_listen(ctx->rpc_socket_path_temp);
+	if (ctx->rpc_server == NULL) {
+		SPDK_ERRLOG("Unable to start RPC service at %s\n", ctx->rpc_socket_path_temp);
 		goto fail;
 	}
 
+	for (i = 0; i < SPDK_COUNTOF(ctx->clients); i++) {
+		ctx->clients[i].conn = spdk_jsonrpc_client_connect(ctx->rpc_socket_path_temp, AF_UNIX);
+		if (ctx->clients[i].conn == NULL) {
+			SPDK_ERRLOG("Failed to connect to '%s'\n", ctx->rpc_socket_path_temp);
+			goto fail;
+		}
+	}
+
 	rpc_client_set_timeout(ctx, RPC_CLIENT_CONNECT_TIMEOUT_US);
 	ctx->client_conn_poller = SPDK_POLLER_REGISTER(rpc_client_connect_poller, ctx, 100);
 	return;
@@ -6,6 +6,8 @@
 
 #include "spdk/stdinc.h"
 
+#include "spdk/accel.h"
+#include "spdk/crc32.h"
 #include "spdk/endian.h"
 #include "spdk/env.h"
 #include "spdk/likely.h"
@@ -314,11 +316,15 @@ iscsi_conn_free_tasks(struct spdk_iscsi_conn *conn)
 	 *  have to ensure there is no associated task in conn->queued_datain_tasks.
 	 */
 	TAILQ_FOREACH_SAFE(pdu, &conn->write_pdu_list, tailq, tmp_pdu) {
+		if (spdk_unlikely(pdu->data_digest_pending)) {
+			/* accel still uses the PDU, free it after the digest is done. */
+			continue;
+		}
 		TAILQ_REMOVE(&conn->write_pdu_list, pdu, tailq);
 		iscsi_conn_free_pdu(conn, pdu);
 	}
 
-	if (conn->pending_task_cnt) {
+	if (conn->pending_task_cnt || conn->data_digest_cnt) {
 		return -1;
 	}
 
@@ -585,6 +591,7 @@ iscsi_conn_stop(struct spdk_iscsi_conn *conn)
 		pthread_mutex_lock(&g_iscsi.mutex);
 		pthread_mutex_lock(&target->mutex);
 		if (conn->scheduled != 0) {
+			conn->pg->num_active_conns--;
 			target->num_active_conns--;
 			if (target->num_active_conns == 0) {
 				assert(target->pg != NULL);
@@ -1438,12 +1445,106 @@ iscsi_conn_pdu_generic_complete(void *cb_arg)
 {
 }
 
+static void
+iscsi_conn_pdu_submit(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
+{
+	pdu->sock_req.iovcnt = iscsi_build_iovs(conn, pdu->iov, SPDK_COUNTOF(pdu->iov), pdu,
+						&pdu->mapped_length);
+	pdu->sock_req.cb_fn = _iscsi_conn_pdu_write_done;
+	pdu->sock_req.cb_arg = pdu;
+
+	spdk_sock_writev_async(conn->sock, &pdu->sock_req);
+}
+
+/* Hand the PDUs held back behind pending data digests to the socket, keeping their order. */
+static void
+iscsi_conn_flush_deferred_pdus(struct spdk_iscsi_conn *conn)
+{
+	struct spdk_iscsi_pdu *pdu, *tmp;
+
+	TAILQ_FOREACH_SAFE(pdu, &conn->write_pdu_list, tailq, tmp) {
+		if (conn->deferred_pdu_cnt == 0 || conn->state >= ISCSI_CONN_STATE_EXITING) {
+			break;
+		}
+		if (!pdu->write_deferred) {
+			continue;
+		}
+		if (pdu->data_digest_pending) {
+			break;
+		}
+
+		pdu->write_deferred = false;
+		conn->deferred_pdu_cnt--;
+		iscsi_conn_pdu_submit(conn, pdu);
+	}
+}
+
+static void
+iscsi_conn_data_digest_done(void *cb_arg, int status)
+{
+	struct spdk_iscsi_pdu *pdu = cb_arg;
+	struct spdk_iscsi_conn *conn = pdu->conn;
+	uint32_t crc32c;
+
+	assert(conn->data_digest_cnt > 0);
+	pdu->data_digest_pending = false;
+	conn->data_digest_cnt--;
+
+	if (spdk_unlikely(conn->state >= ISCSI_CONN_STATE_EXITING)) {
+		/* The PDU is freed by iscsi_conn_free_tasks() */
+		return;
+	}
+
+	if (spdk_likely(status == 0)) {
+		crc32c = pdu->crc32c ^ SPDK_CRC32C_XOR;
+	} else {
+		crc32c = iscsi_pdu_calc_data_digest(pdu);
+	}
+	MAKE_DIGEST_WORD(pdu->data_digest, crc32c);
+
+	iscsi_conn_flush_deferred_pdus(conn);
+}
+
+/*
+ * Calculate the data digest of a PDU by accel. The accel operation completes asynchronously,
+ * so the PDU, and all PDUs written after it, are held back until the digest is done.
+ */
+static bool
+iscsi_conn_pdu_calc_data_digest_async(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
+{
+	uint32_t data_len = DGET24(pdu->bhs.data_segment_len);
+	int rc;
+
+	/* Padding would need another buffer, leave unaligned segments to the inline path */
+	if (pdu->dif_insert_or_strip || (data_len % ISCSI_ALIGNMENT) != 0 ||
+	    conn->pg == NULL || conn->pg->accel_ch == NULL) {
+		return false;
+	}
+
+	/* The iovec isn't built for the socket until the digest is done */
+	pdu->iov[0].iov_base = pdu->data;
+	pdu->iov[0].iov_len = data_len;
+	pdu->data_digest_pending = true;
+	conn->data_digest_cnt++;
+
+	rc = spdk_accel_submit_crc32cv(conn->pg->accel_ch, &pdu->crc32c, pdu->iov, 1, 0,
+				       iscsi_conn_data_digest_done, pdu);
+	if (spdk_unlikely(rc != 0)) {
+		pdu->data_digest_pending = false;
+		conn->data_digest_cnt--;
+		return false;
+	}
+
+	return true;
+}
+
 void
 iscsi_conn_write_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu,
 		     iscsi_conn_xfer_complete_cb cb_fn,
 		     void *cb_arg)
 {
 	uint32_t crc32c;
+	bool data_digest = false;
 	ssize_t rc;
 
 	if (spdk_unlikely(pdu->dif_insert_or_strip)) {
@@ -1462,11 +1563,7 @@ iscsi_conn_write_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu,
 			MAKE_DIGEST_WORD(pdu->header_digest, crc32c);
 		}
 
-		/* Data Digest */
-		if (conn->data_digest && DGET24(pdu->bhs.data_segment_len) != 0) {
-			crc32c = iscsi_pdu_calc_data_digest(pdu);
-			MAKE_DIGEST_WORD(pdu->data_digest, crc32c);
-		}
+		data_digest = conn->data_digest && DGET24(pdu->bhs.data_segment_len) != 0;
 	}
 
 	pdu->cb_fn = cb_fn;
@@ -1476,12 +1573,30 @@ iscsi_conn_write_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu,
 	if (spdk_unlikely(conn->state >= ISCSI_CONN_STATE_EXITING)) {
 		return;
 	}
-	pdu->sock_req.iovcnt = iscsi_build_iovs(conn, pdu->iov, SPDK_COUNTOF(pdu->iov), pdu,
-						&pdu->mapped_length);
-	pdu->sock_req.cb_fn = _iscsi_conn_pdu_write_done;
-	pdu->sock_req.cb_arg = pdu;
 
-	spdk_sock_writev_async(conn->sock, &pdu->sock_req);
+	/* Data Digest */
+	if (data_digest) {
+		/* Mark the PDU deferred first, the digest may complete before the submit returns */
+		pdu->write_deferred = true;
+		conn->deferred_pdu_cnt++;
+		if (iscsi_conn_pdu_calc_data_digest_async(conn, pdu)) {
+			return;
+		}
+		pdu->write_deferred = false;
+		conn->deferred_pdu_cnt--;
+
+		crc32c = iscsi_pdu_calc_data_digest(pdu);
+		MAKE_DIGEST_WORD(pdu->data_digest, crc32c);
+	}
+
+	if (spdk_unlikely(conn->deferred_pdu_cnt > 0)) {
+		/* Keep the order of PDUs written after one waiting for its data digest */
+		pdu->write_deferred = true;
+		conn->deferred_pdu_cnt++;
+		return;
+	}
+
+	iscsi_conn_pdu_submit(conn, pdu);
 }
 
 static void
@@ -1550,10 +1665,55 @@ iscsi_get_idlest_poll_group(void)
 	return idle_pg;
 }
 
+static bool
+iscsi_sess_uses_poll_group(struct spdk_iscsi_sess *sess, struct spdk_iscsi_poll_group *pg)
+{
+	uint32_t i;
+
+	for (i = 0; i < sess->connections; i++) {
+		if (sess->conns[i]->scheduled && sess->conns[i]->pg == pg) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Pick the poll group for a connection when connections are spread. Poll groups that
+ * no other connection of the session is scheduled to are preferred, so that multiple
+ * connections of a session run on different cores. Among those, the group whose
+ * connections started the fewest tasks in the last second wins, then the group with
+ * the fewest connections.
+ */
+static struct spdk_iscsi_poll_group *
+iscsi_get_least_loaded_poll_group(struct spdk_iscsi_sess *sess)
+{
+	struct spdk_iscsi_poll_group *pg, *best_pg = NULL;
+	bool used, best_used = true;
+
+	pthread_mutex_lock(&g_conns_mutex);
+	TAILQ_FOREACH(pg, &g_iscsi.poll_group_head, link) {
+		used = iscsi_sess_uses_poll_group(sess, pg);
+		if (best_pg == NULL || (best_used && !used)) {
+			best_pg = pg;
+			best_used = used;
+		} else if (used == best_used &&
+			   (pg->load < best_pg->load ||
+			    (pg->load == best_pg->load &&
+			     pg->num_active_conns < best_pg->num_active_conns))) {
+			best_pg = pg;
+		}
+	}
+	pthread_mutex_unlock(&g_conns_mutex);
+
+	return best_pg;
+}
+
 void
 iscsi_conn_schedule(struct spdk_iscsi_conn *conn)
 {
-	struct spdk_iscsi_poll_group	*pg;
+	struct spdk_iscsi_poll_group	*pg, *prev_pg;
 	struct spdk_iscsi_tgt_node	*target;
 
 	if (conn->sess->session_type != SESSION_TYPE_NORMAL) {
@@ -1585,17 +1745,27 @@ iscsi_conn_schedule(struct spdk_iscsi_conn *conn)
 		pg = target->pg;
 	}
 
+	if (g_iscsi.spread_connections) {
+		pg = iscsi_get_least_loaded_poll_group(conn->sess);
+		assert(pg != NULL);
+	}
+
+	/* Update the poll group while holding the lock, the placement
+	 * of the other connections of the session depends on it.
+	 */
+	prev_pg = conn->pg;
+	conn->pg = pg;
+	conn->scheduled = 1;
+	pg->num_active_conns++;
+
 	pthread_mutex_unlock(&target->mutex);
 	pthread_mutex_unlock(&g_iscsi.mutex);
 
-	assert(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(conn->pg)) ==
+	assert(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(prev_pg)) ==
 	       spdk_get_thread());
 
 	/* Remove this connection from the previous poll group */
-	iscsi_poll_group_remove_conn(conn->pg, conn);
-
-	conn->pg = pg;
-	conn->scheduled = 1;
+	iscsi_poll_group_remove_conn(prev_pg, conn);
 
 	spdk_thread_send_msg(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(pg)),
 			     iscsi_conn_full_feature_migrate, conn);
@@ -103,8 +103,15 @@ struct spdk_iscsi_conn {
 
 	TAILQ_HEAD(, spdk_iscsi_pdu) write_pdu_list;
 	TAILQ_HEAD(, spdk_iscsi_pdu) snack_pdu_list;
+	/* PDUs in write_pdu_list held back until the data digests ahead of them are done */
+	uint32_t deferred_pdu_cnt;
+	/* Data digests being calculated by accel */
+	uint32_t data_digest_cnt;
 
 	uint32_t pending_r2t;
+	/* Averages of the time from an R2T to its first Data-OUT and of a burst duration */
+	uint64_t r2t_rtt_ticks;
+	uint64_t r2t_burst_ticks;
 
 	uint16_t cid;
 
@@ -142,6 +149,8 @@ struct spdk_iscsi_conn {
 	bool mutual_chap;
 	int32_t chap_group;
 	uint32_t pending_task_cnt;
+	/* Tasks started since the last load update of the poll group */
+	uint32_t period_task_cnt;
 	uint32_t data_out_cnt;
 	uint32_t data_in_cnt;
 
@@ -530,7 +530,7 @@ create_iscsi_sess(struct spdk_iscsi_conn *conn,
 	pthread_mutex_lock(&g_iscsi.mutex);
 
 	sess->MaxConnections = g_iscsi.MaxConnectionsPerSession;
-	sess->MaxOutstandingR2T = DEFAULT_MAXOUTSTANDINGR2T;
+	sess->MaxOutstandingR2T = g_iscsi.MaxOutstandingR2T;
 
 	sess->DefaultTime2Wait = g_iscsi.DefaultTime2Wait;
 	sess->DefaultTime2Retain = g_iscsi.DefaultTime2Retain;
@@ -2632,11 +2632,16 @@ iscsi_send_r2t(struct spdk_iscsi_conn *conn,
 	to_be32(&rsph->r2t_sn, *R2TSN);
 	*R2TSN += 1;
 
-	task->r2t_datasn = 0; /* next expected datasn to ack */
-
 	to_be32(&rsph->buffer_offset, (uint32_t)offset);
 	to_be32(&rsph->desired_xfer_len, (uint32_t)len);
-	task->desired_data_transfer_length = (size_t)len;
+
+	/* With several R2Ts outstanding, only the one for the burst to be received next
+	 * sets what the following Data-OUT PDUs are checked against.
+	 */
+	if ((uint32_t)offset == task->next_expected_r2t_offset) {
+		task->r2t_datasn = 0; /* next expected datasn to ack */
+		task->desired_data_transfer_length = (size_t)len;
+	}
 
 	/* we need to hold onto this task/cmd because until the PDU has been
 	 * written out */
@@ -2720,6 +2725,44 @@ iscsi_send_r2t_recovery(struct spdk_iscsi_conn *conn,
 	return 0;
 }
 
+/*
+ * Number of R2Ts to keep outstanding for a task. Enough bursts are requested to cover the
+ * time from sending an R2T to receiving its first Data-OUT, as observed on the connection,
+ * limited by the negotiated MaxOutstandingR2T and by the free Data-OUT buffers.
+ */
+static uint32_t
+iscsi_conn_r2t_window(struct spdk_iscsi_conn *conn)
+{
+	uint32_t max_r2t = conn->sess->MaxOutstandingR2T;
+	uint32_t bufs_per_burst, free_bufs;
+	uint64_t window;
+
+	if (max_r2t <= 1) {
+		return 1;
+	}
+
+	if (conn->r2t_burst_ticks == 0) {
+		/* Nothing observed yet */
+		window = max_r2t;
+	} else {
+		window = 1 + conn->r2t_rtt_ticks / conn->r2t_burst_ticks;
+		window = spdk_min(window, max_r2t);
+	}
+
+	bufs_per_burst = spdk_divide_round_up(conn->sess->MaxBurstLength,
+					      SPDK_ISCSI_MAX_RECV_DATA_SEGMENT_LENGTH);
+	free_bufs = spdk_mempool_count(g_iscsi.pdu_data_out_pool);
+	window = spdk_min(window, spdk_max(free_bufs / bufs_per_burst, 1));
+
+	return window;
+}
+
+static void
+iscsi_conn_r2t_sample(uint64_t *avg, uint64_t sample)
+{
+	*avg = *avg == 0 ? sample : (*avg * 7 + sample) / 8;
+}
+
 static int
 add_transfer_task(struct spdk_iscsi_conn *conn, struct spdk_iscsi_task *task)
 {
@@ -2727,6 +2770,7 @@ add_transfer_task(struct spdk_iscsi_conn *conn, struct spdk_iscsi_task *task)
 	size_t max_burst_len;
 	size_t segment_len;
 	size_t data_len;
+	uint32_t window;
 	int len;
 	int rc;
 	int data_out_req;
@@ -2761,6 +2805,9 @@ add_transfer_task(struct spdk_iscsi_conn *conn, struct spdk_iscsi_task *task)
 		conn->ttt = 0;
 	}
 	task->ttt = conn->ttt;
+	/* Sample the R2T round trip and the burst duration on the first R2T */
+	task->r2t_tsc = spdk_get_ticks();
+	window = iscsi_conn_r2t_window(conn);
 
 	while (data_len != transfer_len) {
 		len = spdk_min(max_burst_len, (transfer_len - data_len));
@@ -2773,7 +2820,7 @@ add_transfer_task(struct spdk_iscsi_conn *conn, struct spdk_iscsi_task *task)
 		data_len += len;
 		task->next_r2t_offset = data_len;
 		task->outstanding_r2t++;
-		if (conn->sess->MaxOutstandingR2T == task->outstanding_r2t) {
+		if (task->outstanding_r2t >= window) {
 			break;
 		}
 	}
@@ -4197,6 +4244,8 @@ iscsi_pdu_hdr_op_data(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 	uint32_t buffer_offset;
 	uint32_t len;
 	uint32_t current_desired_data_transfer_length;
+	uint32_t window;
+	uint64_t now;
 	int F_bit;
 	int rc;
 
@@ -4253,6 +4302,21 @@ iscsi_pdu_hdr_op_data(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 	}
 
 	transfer_len = task->scsi.transfer_len;
+
+	if (spdk_unlikely(task->r2t_tsc != 0 && task->acked_r2tsn == 0)) {
+		now = spdk_get_ticks();
+		if (task->current_r2t_length == 0) {
+			/* First Data-OUT of the first burst, the R2T round trip is done */
+			iscsi_conn_r2t_sample(&conn->r2t_rtt_ticks, now - task->r2t_tsc);
+			task->r2t_tsc = now;
+		}
+		if (F_bit) {
+			iscsi_conn_r2t_sample(&conn->r2t_burst_ticks,
+					      spdk_max(now - task->r2t_tsc, 1));
+			task->r2t_tsc = 0;
+		}
+	}
+
 	task->current_r2t_length += pdu->data_segment_len;
 	task->next_expected_r2t_offset += pdu->data_segment_len;
 	task->r2t_datasn++;
@@ -4266,24 +4330,34 @@ iscsi_pdu_hdr_op_data(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 
 	if (F_bit) {
 		/*
-		 * This R2T burst is done. Clear the length before we
-		 *  receive a PDU for the next R2t burst.
+		 * This R2T burst is done. Clear the length and DataSN before we
+		 *  receive a PDU for the next R2t burst, which may already be
+		 *  outstanding. All but the last burst are MaxBurstLength.
 		 */
 		task->current_r2t_length = 0;
+		task->r2t_datasn = 0;
+		task->desired_data_transfer_length = spdk_min(conn->sess->MaxBurstLength,
+						     transfer_len - task->next_expected_r2t_offset);
 	}
 
 	if (task->next_expected_r2t_offset == transfer_len) {
 		task->acked_r2tsn++;
-	} else if (F_bit && (task->next_r2t_offset < transfer_len)) {
+	} else if (F_bit) {
 		task->acked_r2tsn++;
-		len = spdk_min(conn->sess->MaxBurstLength,
-			       (transfer_len - task->next_r2t_offset));
-		rc = iscsi_send_r2t(conn, task, task->next_r2t_offset, len,
-				    task->ttt, &task->R2TSN);
-		if (rc < 0) {
-			SPDK_ERRLOG("iscsi_send_r2t() failed\n");
+		/* Top up the outstanding R2Ts to the current window. */
+		window = iscsi_conn_r2t_window(conn);
+		while (task->next_r2t_offset < transfer_len &&
+		       task->R2TSN - task->acked_r2tsn < window) {
+			len = spdk_min(conn->sess->MaxBurstLength,
+				       (transfer_len - task->next_r2t_offset));
+			rc = iscsi_send_r2t(conn, task, task->next_r2t_offset, len,
+					    task->ttt, &task->R2TSN);
+			if (rc < 0) {
+				SPDK_ERRLOG("iscsi_send_r2t() failed\n");
+				break;
+			}
+			task->next_r2t_offset += len;
 		}
-		task->next_r2t_offset += len;
 	}
 
 	if (lun_dev == NULL) {
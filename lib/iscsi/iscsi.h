@@ -164,6 +164,10 @@ struct spdk_iscsi_pdu {
 	uint32_t data_offset;
 	uint32_t crc32c;
 	bool dif_insert_or_strip;
+	/* Data digest is being calculated by accel */
+	bool data_digest_pending;
+	/* Queued to the connection, but not yet handed to the socket */
+	bool write_deferred;
 	struct spdk_dif_ctx dif_ctx;
 	struct spdk_iscsi_conn *conn;
 
@@ -288,7 +292,12 @@ struct spdk_iscsi_poll_group {
 	STAILQ_HEAD(connections, spdk_iscsi_conn)	connections;
 	struct spdk_sock_group				*sock_group;
 	TAILQ_ENTRY(spdk_iscsi_poll_group)		link;
+	struct spdk_io_channel				*accel_ch;
 	uint32_t					num_active_targets;
+	/* Connections in full feature phase scheduled to this poll group */
+	uint32_t					num_active_conns;
+	/* Tasks started by the connections of this poll group in the last second */
+	uint32_t					load;
 };
 
 struct spdk_iscsi_opts {
@@ -307,6 +316,7 @@ struct spdk_iscsi_opts {
 	uint32_t DefaultTime2Wait;
 	uint32_t DefaultTime2Retain;
 	uint32_t FirstBurstLength;
+	uint32_t MaxOutstandingR2T;
 	bool ImmediateData;
 	uint32_t ErrorRecoveryLevel;
 	bool AllowDuplicateIsid;
@@ -315,6 +325,7 @@ struct spdk_iscsi_opts {
 	uint32_t pdu_pool_size;
 	uint32_t immediate_data_pool_size;
 	uint32_t data_out_pool_size;
+	bool spread_connections;
 };
 
 struct spdk_iscsi_globals {
@@ -343,6 +354,7 @@ struct spdk_iscsi_globals {
 	uint32_t DefaultTime2Wait;
 	uint32_t DefaultTime2Retain;
 	uint32_t FirstBurstLength;
+	uint32_t MaxOutstandingR2T;
 	bool ImmediateData;
 	uint32_t ErrorRecoveryLevel;
 	bool AllowDuplicateIsid;
@@ -351,6 +363,7 @@ struct spdk_iscsi_globals {
 	uint32_t pdu_pool_size;
 	uint32_t immediate_data_pool_size;
 	uint32_t data_out_pool_size;
+	bool spread_connections;
 
 	struct spdk_mempool *pdu_pool;
 	struct spdk_mempool *pdu_immediate_data_pool;
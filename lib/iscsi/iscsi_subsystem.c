@@ -4,6 +4,7 @@
  *   All rights reserved.
  */
 
+#include "spdk/accel.h"
 #include "spdk/string.h"
 #include "spdk/likely.h"
 
@@ -254,6 +255,8 @@ iscsi_log_globals(void)
 		      g_iscsi.DefaultTime2Retain);
 	SPDK_DEBUGLOG(iscsi, "FirstBurstLength %d\n",
 		      g_iscsi.FirstBurstLength);
+	SPDK_DEBUGLOG(iscsi, "MaxOutstandingR2T %d\n",
+		      g_iscsi.MaxOutstandingR2T);
 	SPDK_DEBUGLOG(iscsi, "ImmediateData %s\n",
 		      g_iscsi.ImmediateData ? "Yes" : "No");
 	SPDK_DEBUGLOG(iscsi, "AllowDuplicateIsid %s\n",
@@ -308,8 +311,10 @@ iscsi_opts_init(struct spdk_iscsi_opts *opts)
 	opts->DefaultTime2Wait = DEFAULT_DEFAULTTIME2WAIT;
 	opts->DefaultTime2Retain = DEFAULT_DEFAULTTIME2RETAIN;
 	opts->FirstBurstLength = SPDK_ISCSI_FIRST_BURST_LENGTH;
+	opts->MaxOutstandingR2T = DEFAULT_MAXOUTSTANDINGR2T;
 	opts->ImmediateData = DEFAULT_IMMEDIATEDATA;
 	opts->AllowDuplicateIsid = false;
+	opts->spread_connections = false;
 	opts->ErrorRecoveryLevel = DEFAULT_ERRORRECOVERYLEVEL;
 	opts->timeout = DEFAULT_TIMEOUT;
 	opts->nopininterval = DEFAULT_NOPININTERVAL;
@@ -387,8 +392,10 @@ iscsi_opts_copy(struct spdk_iscsi_opts *src)
 	dst->DefaultTime2Wait = src->DefaultTime2Wait;
 	dst->DefaultTime2Retain = src->DefaultTime2Retain;
 	dst->FirstBurstLength = src->FirstBurstLength;
+	dst->MaxOutstandingR2T = src->MaxOutstandingR2T;
 	dst->ImmediateData = src->ImmediateData;
 	dst->AllowDuplicateIsid = src->AllowDuplicateIsid;
+	dst->spread_connections = src->spread_connections;
 	dst->ErrorRecoveryLevel = src->ErrorRecoveryLevel;
 	dst->timeout = src->timeout;
 	dst->nopininterval = src->nopininterval;
@@ -490,6 +497,12 @@ iscsi_opts_verify(struct spdk_iscsi_opts *opts)
 		return -EINVAL;
 	}
 
+	if (opts->MaxOutstandingR2T == 0 || opts->MaxOutstandingR2T > 65535) {
+		SPDK_ERRLOG("%d is invalid. MaxOutstandingR2T must be within 1 to 65535\n",
+			    opts->MaxOutstandingR2T);
+		return -EINVAL;
+	}
+
 	if (opts->pdu_pool_size == 0) {
 		SPDK_ERRLOG("0 is invalid. pdu_pool_size must be more than 0\n");
 		return -EINVAL;
@@ -539,8 +552,10 @@ iscsi_set_global_params(struct spdk_iscsi_opts *opts)
 	g_iscsi.DefaultTime2Wait = opts->DefaultTime2Wait;
 	g_iscsi.DefaultTime2Retain = opts->DefaultTime2Retain;
 	g_iscsi.FirstBurstLength = opts->FirstBurstLength;
+	g_iscsi.MaxOutstandingR2T = opts->MaxOutstandingR2T;
 	g_iscsi.ImmediateData = opts->ImmediateData;
 	g_iscsi.AllowDuplicateIsid = opts->AllowDuplicateIsid;
+	g_iscsi.spread_connections = opts->spread_connections;
 	g_iscsi.ErrorRecoveryLevel = opts->ErrorRecoveryLevel;
 	g_iscsi.timeout = opts->timeout;
 	g_iscsi.nopininterval = opts->nopininterval;
@@ -979,11 +994,17 @@ iscsi_poll_group_handle_nop(void *ctx)
 {
 	struct spdk_iscsi_poll_group *group = ctx;
 	struct spdk_iscsi_conn *conn, *tmp;
+	uint32_t load = 0;
 
 	STAILQ_FOREACH_SAFE(conn, &group->connections, pg_link, tmp) {
+		load += conn->period_task_cnt;
+		conn->period_task_cnt = 0;
 		iscsi_conn_handle_nop(conn);
 	}
 
+	/* The nop poller runs once a second, use it to sample the load of the group too. */
+	group->load = load;
+
 	return SPDK_POLLER_BUSY;
 }
 
@@ -1000,6 +1021,12 @@ iscsi_poll_group_create(void *io_device, void *ctx_buf)
 	/* set the period to 1 sec */
 	pg->nop_poller = SPDK_POLLER_REGISTER(iscsi_poll_group_handle_nop, pg, 1000000);
 
+	/* Used to offload data digests, digests are calculated inline without it */
+	pg->accel_ch = spdk_accel_get_io_channel();
+	if (pg->accel_ch == NULL) {
+		SPDK_NOTICELOG("Cannot get accel channel, data digests are calculated inline\n");
+	}
+
 	return 0;
 }
 
@@ -1016,6 +1043,9 @@ iscsi_poll_group_destroy(void *io_device, void *ctx_buf)
 	spdk_sock_group_close(&pg->sock_group);
 	spdk_poller_unregister(&pg->poller);
 	spdk_poller_unregister(&pg->nop_poller);
+	if (pg->accel_ch != NULL) {
+		spdk_put_io_channel(pg->accel_ch);
+	}
 
 	ch = spdk_io_channel_from_ctx(pg);
 	thread = spdk_io_channel_get_thread(ch);
@@ -1236,11 +1266,14 @@ iscsi_opts_info_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "default_time2retain", g_iscsi.DefaultTime2Retain);
 
 	spdk_json_write_named_uint32(w, "first_burst_length", g_iscsi.FirstBurstLength);
+	spdk_json_write_named_uint32(w, "max_outstanding_r2t", g_iscsi.MaxOutstandingR2T);
 
 	spdk_json_write_named_bool(w, "immediate_data", g_iscsi.ImmediateData);
 
 	spdk_json_write_named_bool(w, "allow_duplicated_isid", g_iscsi.AllowDuplicateIsid);
 
+	spdk_json_write_named_bool(w, "spread_connections", g_iscsi.spread_connections);
+
 	spdk_json_write_named_uint32(w, "error_recovery_level", g_iscsi.ErrorRecoveryLevel);
 
 	spdk_json_write_named_int32(w, "nop_timeout", g_iscsi.timeout);
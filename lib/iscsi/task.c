@@ -59,6 +59,7 @@ iscsi_task_get(struct spdk_iscsi_conn *conn, struct spdk_iscsi_task *parent,
 	task->conn = conn;
 	assert(conn->pending_task_cnt < UINT32_MAX);
 	conn->pending_task_cnt++;
+	conn->period_task_cnt++;
 	spdk_scsi_task_construct(&task->scsi,
 				 cpl_fn,
 				 iscsi_task_free);
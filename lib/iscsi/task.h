@@ -20,6 +20,8 @@ struct spdk_iscsi_task {
 	struct spdk_iscsi_pdu *pdu;
 	struct spdk_mobj *mobj;
 	uint64_t start_tsc;
+	/* Send time of the first R2T, then the arrival of its first Data-OUT */
+	uint64_t r2t_tsc;
 	uint32_t outstanding_r2t;
 
 	uint32_t desired_data_transfer_length;
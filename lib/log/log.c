@@ -26,6 +26,48 @@ static struct spdk_log_opts g_log_opts = {
 };
 static bool g_log_timestamps = true;
 
+/* Number of messages queued for the writer thread, must be a power of 2 */
+#define LOG_ASYNC_RING_SIZE	1024
+/* Number of rate limited call sites, call sites sharing a slot share its budget */
+#define LOG_ASYNC_NUM_SITES	256
+/* Messages written per call site and second, the rest is suppressed */
+#define LOG_ASYNC_SITE_BURST	100
+/* How long the writer thread sleeps when there is nothing to write */
+#define LOG_ASYNC_IDLE_US	1000
+
+struct log_async_msg {
+	/* Ring position the slot is ready for, see log_async_get_slot() */
+	uint64_t		seq;
+	enum spdk_log_level	level;
+	int			line;
+	const char		*file;
+	const char		*func;
+	struct timespec		ts;
+	/* Number of messages of the same call site suppressed before this one */
+	uint32_t		suppressed;
+	char			buf[MAX_TMPBUF];
+};
+
+struct log_async_site {
+	uint64_t	second;
+	uint32_t	count;
+	uint32_t	suppressed;
+};
+
+static struct {
+	bool			enabled;
+	bool			stop;
+	pthread_t		thread;
+	struct log_async_msg	*ring;
+	/* Next position claimed by a producer */
+	uint64_t		head;
+	/* Next position written by the writer thread */
+	uint64_t		tail;
+	/* Number of messages dropped since the last report because the ring was full */
+	uint64_t		dropped;
+	struct log_async_site	sites[LOG_ASYNC_NUM_SITES];
+} g_log_async;
+
 enum spdk_log_level g_spdk_log_level;
 enum spdk_log_level g_spdk_log_print_level;
 
@@ -102,6 +144,7 @@ out:
 void
 spdk_log_close(void)
 {
+	spdk_log_enable_async(false);
 	if (g_log_opts.close) {
 		g_log_opts.close(g_log_opts.user_ctx);
 	}
@@ -115,11 +158,10 @@ spdk_log_enable_timestamps(bool value)
 }
 
 static void
-get_timestamp_prefix(char *buf, int buf_size)
+format_timestamp_prefix(char *buf, int buf_size, const struct timespec *ts)
 {
 	struct tm *info;
 	char date[24];
-	struct timespec ts;
 	long usec;
 
 	if (!g_log_timestamps) {
@@ -127,9 +169,8 @@ get_timestamp_prefix(char *buf, int buf_size)
 		return;
 	}
 
-	clock_gettime(CLOCK_REALTIME, &ts);
-	info = localtime(&ts.tv_sec);
-	usec = ts.tv_nsec / 1000;
+	info = localtime(&ts->tv_sec);
+	usec = ts->tv_nsec / 1000;
 	if (info == NULL) {
 		snprintf(buf, buf_size, "[%s.%06ld] ", "unknown date", usec);
 		return;
@@ -139,6 +180,15 @@ get_timestamp_prefix(char *buf, int buf_size)
 	snprintf(buf, buf_size, "[%s.%06ld] ", date, usec);
 }
 
+static void
+get_timestamp_prefix(char *buf, int buf_size)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	format_timestamp_prefix(buf, buf_size, &ts);
+}
+
 void
 spdk_log(enum spdk_log_level level, const char *file, const int line, const char *func,
 	 const char *format, ...)
@@ -172,13 +222,243 @@ spdk_log_to_syslog_level(enum spdk_log_level level)
 	return LOG_INFO;
 }
 
+static void
+log_write(enum spdk_log_level level, const char *file, const int line, const char *func,
+	  const char *buf, const struct timespec *ts)
+{
+	char timestamp[64];
+
+	if (level <= g_spdk_log_print_level) {
+		format_timestamp_prefix(timestamp, sizeof(timestamp), ts);
+		if (file) {
+			fprintf(stderr, "%s%s:%4d:%s: *%s*: %s", timestamp, file, line, func, spdk_level_names[level], buf);
+		} else {
+			fprintf(stderr, "%s%s", timestamp, buf);
+		}
+	}
+
+	if (level <= g_spdk_log_level) {
+		if (file) {
+			syslog(spdk_log_to_syslog_level(level), "%s:%4d:%s: *%s*: %s", file, line, func,
+			       spdk_level_names[level], buf);
+		} else {
+			syslog(spdk_log_to_syslog_level(level), "%s", buf);
+		}
+	}
+}
+
+/*
+ * Asynchronous logging. Callers format their messages straight into a slot of a bounded
+ * multi-producer ring, and a dedicated writer thread, which isn't a reactor, writes them to
+ * stderr and syslog. A slot's seq tells whose turn it is: it equals the ring position when the
+ * slot is free for the producer claiming that position, and the position + 1 once the message
+ * is ready for the writer. Nothing blocks, a message that finds the ring full is dropped.
+ */
+static bool
+log_async_rate_limit(const char *format, int line, const struct timespec *ts, uint32_t *suppressed)
+{
+	struct log_async_site *site;
+	uint64_t second;
+
+	/* The format string literal identifies the call site. Races between threads may let a
+	 * few more messages through, it is only meant to keep a storm from a single site in check. */
+	site = &g_log_async.sites[((uintptr_t)format ^ line) % LOG_ASYNC_NUM_SITES];
+	second = __atomic_load_n(&site->second, __ATOMIC_RELAXED);
+	if (second != (uint64_t)ts->tv_sec &&
+	    __atomic_compare_exchange_n(&site->second, &second, ts->tv_sec, false,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&site->count, 0, __ATOMIC_RELAXED);
+		*suppressed = __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+	}
+
+	if (__atomic_fetch_add(&site->count, 1, __ATOMIC_RELAXED) >= LOG_ASYNC_SITE_BURST) {
+		__atomic_fetch_add(&site->suppressed, 1, __ATOMIC_RELAXED);
+		return false;
+	}
+
+	return true;
+}
+
+static struct log_async_msg *
+log_async_get_slot(void)
+{
+	struct log_async_msg *msg;
+	uint64_t pos, seq;
+
+	pos = __atomic_load_n(&g_log_async.head, __ATOMIC_RELAXED);
+	for (;;) {
+		msg = &g_log_async.ring[pos & (LOG_ASYNC_RING_SIZE - 1)];
+		seq = __atomic_load_n(&msg->seq, __ATOMIC_ACQUIRE);
+		if (seq == pos) {
+			if (__atomic_compare_exchange_n(&g_log_async.head, &pos, pos + 1, true,
+							__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				return msg;
+			}
+		} else if ((int64_t)(seq - pos) < 0) {
+			/* The writer hasn't caught up with this slot yet, the ring is full */
+			return NULL;
+		} else {
+			pos = __atomic_load_n(&g_log_async.head, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+static void
+log_async_put(enum spdk_log_level level, const char *file, const int line, const char *func,
+	      const char *format, va_list ap)
+{
+	struct log_async_msg *msg;
+	struct timespec ts;
+	uint32_t suppressed = 0;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	if (!log_async_rate_limit(format, line, &ts, &suppressed)) {
+		return;
+	}
+
+	msg = log_async_get_slot();
+	if (msg == NULL) {
+		__atomic_fetch_add(&g_log_async.dropped, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	msg->level = level;
+	msg->file = file;
+	msg->line = line;
+	msg->func = func;
+	msg->ts = ts;
+	msg->suppressed = suppressed;
+	/* Messages longer than MAX_TMPBUF are truncated */
+	vsnprintf(msg->buf, sizeof(msg->buf), format, ap);
+
+	__atomic_store_n(&msg->seq, msg->seq + 1, __ATOMIC_RELEASE);
+}
+
+static uint32_t
+log_async_drain(void)
+{
+	struct log_async_msg *msg;
+	uint64_t dropped, pos = g_log_async.tail;
+	struct timespec ts;
+	char buf[128];
+	uint32_t count = 0;
+
+	for (;;) {
+		msg = &g_log_async.ring[pos & (LOG_ASYNC_RING_SIZE - 1)];
+		if (__atomic_load_n(&msg->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+			break;
+		}
+
+		if (msg->suppressed > 0) {
+			snprintf(buf, sizeof(buf), "%" PRIu32 " previous messages suppressed\n", msg->suppressed);
+			log_write(SPDK_LOG_WARN, msg->file, msg->line, msg->func, buf, &msg->ts);
+		}
+		log_write(msg->level, msg->file, msg->line, msg->func, msg->buf, &msg->ts);
+
+		/* Hand the slot over to the producer of the next round */
+		__atomic_store_n(&msg->seq, pos + LOG_ASYNC_RING_SIZE, __ATOMIC_RELEASE);
+		pos++;
+		count++;
+	}
+	g_log_async.tail = pos;
+
+	dropped = __atomic_exchange_n(&g_log_async.dropped, 0, __ATOMIC_RELAXED);
+	if (dropped > 0) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		snprintf(buf, sizeof(buf), "%" PRIu64 " log messages dropped, the log ring was full\n", dropped);
+		log_write(SPDK_LOG_WARN, NULL, -1, NULL, buf, &ts);
+	}
+
+	return count;
+}
+
+static void *
+log_async_writer(void *arg)
+{
+	struct log_async_site *site;
+	uint32_t suppressed, i;
+	char buf[128];
+	struct timespec ts;
+	cpu_set_t cpuset;
+	long num_cpus;
+
+	/* Don't compete with the reactor of the core the thread was created on */
+	CPU_ZERO(&cpuset);
+	num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+	for (i = 0; i < num_cpus && i < CPU_SETSIZE; i++) {
+		CPU_SET(i, &cpuset);
+	}
+	sched_setaffinity(0, sizeof(cpuset), &cpuset);
+
+	while (!__atomic_load_n(&g_log_async.stop, __ATOMIC_ACQUIRE)) {
+		if (log_async_drain() == 0) {
+			usleep(LOG_ASYNC_IDLE_US);
+		}
+	}
+
+	/* Write whatever was queued until asynchronous logging was disabled */
+	log_async_drain();
+
+	for (i = 0; i < LOG_ASYNC_NUM_SITES; i++) {
+		site = &g_log_async.sites[i];
+		suppressed = __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+		if (suppressed > 0) {
+			clock_gettime(CLOCK_REALTIME, &ts);
+			snprintf(buf, sizeof(buf), "%" PRIu32 " log messages suppressed\n", suppressed);
+			log_write(SPDK_LOG_WARN, NULL, -1, NULL, buf, &ts);
+		}
+	}
+
+	return NULL;
+}
+
+int
+spdk_log_enable_async(bool enable)
+{
+	uint64_t i;
+	int rc;
+
+	if (enable == g_log_async.enabled) {
+		return 0;
+	}
+
+	if (!enable) {
+		__atomic_store_n(&g_log_async.enabled, false, __ATOMIC_RELEASE);
+		__atomic_store_n(&g_log_async.stop, true, __ATOMIC_RELEASE);
+		pthread_join(g_log_async.thread, NULL);
+		free(g_log_async.ring);
+		memset(&g_log_async, 0, sizeof(g_log_async));
+		return 0;
+	}
+
+	g_log_async.ring = calloc(LOG_ASYNC_RING_SIZE, sizeof(*g_log_async.ring));
+	if (g_log_async.ring == NULL) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < LOG_ASYNC_RING_SIZE; i++) {
+		g_log_async.ring[i].seq = i;
+	}
+
+	rc = pthread_create(&g_log_async.thread, NULL, log_async_writer, NULL);
+	if (rc != 0) {
+		free(g_log_async.ring);
+		g_log_async.ring = NULL;
+		return -rc;
+	}
+	pthread_setname_np(g_log_async.thread, "spdk_log");
+
+	__atomic_store_n(&g_log_async.enabled, true, __ATOMIC_RELEASE);
+	return 0;
+}
+
 void
 spdk_vlog(enum spdk_log_level level, const char *file, const int line, const char *func,
 	  const char *format, va_list ap)
 {
 	int severity = LOG_INFO;
 	char *buf, _buf[MAX_TMPBUF], *ext_buf = NULL;
-	char timestamp[64];
+	struct timespec ts;
 	va_list ap_copy;
 	int rc;
 
@@ -196,6 +476,11 @@ spdk_vlog(enum spdk_log_level level, const char *file, const int line, const cha
 		return;
 	}
 
+	if (__atomic_load_n(&g_log_async.enabled, __ATOMIC_ACQUIRE)) {
+		log_async_put(level, file, line, func, format, ap);
+		return;
+	}
+
 	buf = _buf;
 
 	va_copy(ap_copy, ap);
@@ -213,22 +498,8 @@ spdk_vlog(enum spdk_log_level level, const char *file, const int line, const cha
 	}
 	va_end(ap_copy);
 
-	if (level <= g_spdk_log_print_level) {
-		get_timestamp_prefix(timestamp, sizeof(timestamp));
-		if (file) {
-			fprintf(stderr, "%s%s:%4d:%s: *%s*: %s", timestamp, file, line, func, spdk_level_names[level], buf);
-		} else {
-			fprintf(stderr, "%s%s", timestamp, buf);
-		}
-	}
-
-	if (level <= g_spdk_log_level) {
-		if (file) {
-			syslog(severity, "%s:%4d:%s: *%s*: %s", file, line, func, spdk_level_names[level], buf);
-		} else {
-			syslog(severity, "%s", buf);
-		}
-	}
+	clock_gettime(CLOCK_REALTIME, &ts);
+	log_write(level, file, line, func, buf, &ts);
 
 	free(ext_buf);
 }
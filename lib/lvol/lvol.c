@@ -2428,3 +2428,22 @@ spdk_lvol_set_external_parent(struct spdk_lvol *lvol, const void *esnap_id, uint
 	spdk_bs_blob_set_external_parent(lvol->lvol_store->blobstore, blob_id, bs_dev, esnap_id,
 					 esnap_id_len, lvol_set_external_parent_cb, req);
 }
+
+int
+spdk_lvol_set_esnap_copy_on_read(struct spdk_lvol *lvol, uint32_t clusters_per_sec)
+{
+	int rc;
+
+	if (lvol->blob == NULL) {
+		SPDK_ERRLOG("lvol %s is degraded\n", lvol->unique_id);
+		return -ENODEV;
+	}
+
+	rc = spdk_blob_set_esnap_copy_on_read(lvol->blob, clusters_per_sec);
+	if (rc != 0) {
+		SPDK_ERRLOG("Cannot set copy-on-read of lvol %s: %s\n", lvol->unique_id,
+			    spdk_strerror(-rc));
+	}
+
+	return rc;
+}
@@ -17,6 +17,7 @@
 #define MLX5_UMR_POOL_VALID_FLAGS_MASK (~(SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO | SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE))
 #define MLX5_CRYPTO_BSF_P_TYPE_CRYPTO (0x1)
 #define MLX5_CRYPTO_BSF_SIZE_64B (0x2)
+#define MLX5_CRYPTO_BSF_SIZE_WITH_SIG (0x3)
 
 #define MLX5_SIG_BSF_SIZE_32B (0x1)
 /* Transaction Format Selector */
@@ -276,6 +277,7 @@ mlx5_set_mkey_in_pool(struct spdk_mempool *mp, void *cb_arg, void *_mkey, unsign
 static const char *g_mkey_pool_names[] = {
 	[SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO] = "crypto",
 	[SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE] = "signature",
+	[SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO | SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE] = "sig_crypto",
 };
 
 static void
@@ -395,11 +397,6 @@ spdk_mlx5_mkey_pool_init(struct spdk_mlx5_mkey_pool_param *params, struct ibv_pd
 		SPDK_ERRLOG("Invalid flags %x\n", params->flags);
 		return -EINVAL;
 	}
-	if ((params->flags & (SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO | SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE)) ==
-	    (SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO | SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE)) {
-		SPDK_ERRLOG("Both crypto and signature capabilities are not supported\n");
-		return -EINVAL;
-	}
 	if (params->cache_per_thread > params->mkey_count || !params->cache_per_thread) {
 		params->cache_per_thread = params->mkey_count * 3 / 4 / spdk_env_get_core_count();
 	}
@@ -1000,6 +997,192 @@ spdk_mlx5_umr_configure_sig(struct spdk_mlx5_qp *qp, struct spdk_mlx5_umr_attr *
 	return 0;
 }
 
+static inline void
+mlx5_umr_configure_with_wrap_around_sig_crypto(struct spdk_mlx5_qp *dv_qp,
+		struct spdk_mlx5_umr_attr *umr_attr, struct spdk_mlx5_umr_sig_attr *sig_attr,
+		struct spdk_mlx5_umr_crypto_attr *crypto_attr, uint64_t wr_id, uint32_t flags,
+		uint32_t wqe_size, uint32_t umr_wqe_n_bb, uint32_t mtt_size)
+{
+	struct mlx5_hw_qp *hw = &dv_qp->hw;
+	struct mlx5_wqe_ctrl_seg *ctrl;
+	struct mlx5_wqe_ctrl_seg *gen_ctrl;
+	struct mlx5_wqe_umr_ctrl_seg *umr_ctrl;
+	struct mlx5_wqe_mkey_context_seg *mkey;
+	struct mlx5_wqe_umr_klm_seg *klm;
+	struct mlx5_sig_bsf_seg *sig_bsf;
+	struct mlx5_crypto_bsf_seg *crypto_bsf;
+	uint8_t fm_ce_se;
+	uint32_t pi, to_end;
+
+	fm_ce_se = mlx5_qp_fm_ce_se_update(dv_qp, (uint8_t)flags);
+
+	ctrl = (struct mlx5_wqe_ctrl_seg *)mlx5_qp_get_wqe_bb(hw);
+	pi = hw->sq_pi & (hw->sq_wqe_cnt - 1);
+	to_end = (hw->sq_wqe_cnt - pi) * MLX5_SEND_WQE_BB;
+
+	/*
+	 * sizeof(gen_ctrl) + sizeof(umr_ctrl) == MLX5_SEND_WQE_BB,
+	 * so do not need to worry about wqe buffer wrap around.
+	 *
+	 * build genenal ctrl segment
+	 */
+	gen_ctrl = ctrl;
+	mlx5_set_ctrl_seg(gen_ctrl, hw->sq_pi, MLX5_OPCODE_UMR, 0,
+			  hw->qp_num, fm_ce_se,
+			  SPDK_CEIL_DIV(wqe_size, 16), 0,
+			  htobe32(umr_attr->mkey));
+
+	/* build umr ctrl segment */
+	umr_ctrl = (struct mlx5_wqe_umr_ctrl_seg *)(gen_ctrl + 1);
+	memset(umr_ctrl, 0, sizeof(*umr_ctrl));
+	mlx5_set_umr_ctrl_seg_mtt_sig(umr_ctrl, mtt_size);
+	mlx5_set_umr_ctrl_seg_bsf_size(umr_ctrl, sizeof(struct mlx5_sig_bsf_seg) +
+				       sizeof(struct mlx5_crypto_bsf_seg));
+
+	/* build mkey context segment */
+	mkey = mlx5_qp_get_next_wqebb(hw, &to_end, ctrl);
+	mlx5_set_umr_mkey_seg(mkey, umr_attr);
+	mlx5_set_umr_mkey_seg_sig(mkey, sig_attr);
+
+	klm = mlx5_qp_get_next_wqebb(hw, &to_end, mkey);
+	sig_bsf = mlx5_build_inline_mtt(hw, &to_end, klm, umr_attr);
+	mlx5_set_umr_sig_bsf_seg(sig_bsf, sig_attr);
+
+	/* sizeof(*sig_bsf) == MLX5_SEND_WQE_BB, the crypto bsf starts in the next wqebb */
+	crypto_bsf = mlx5_qp_get_next_wqebb(hw, &to_end, sig_bsf);
+	mlx5_set_umr_crypto_bsf_seg(crypto_bsf, crypto_attr, umr_attr->umr_len,
+				    MLX5_CRYPTO_BSF_SIZE_WITH_SIG);
+
+	mlx5_qp_wqe_submit(dv_qp, ctrl, umr_wqe_n_bb, pi);
+
+	mlx5_qp_set_comp(dv_qp, pi, wr_id, fm_ce_se, umr_wqe_n_bb);
+	assert(dv_qp->tx_available >= umr_wqe_n_bb);
+	dv_qp->tx_available -= umr_wqe_n_bb;
+}
+
+static inline void
+mlx5_umr_configure_full_sig_crypto(struct spdk_mlx5_qp *dv_qp, struct spdk_mlx5_umr_attr *umr_attr,
+				   struct spdk_mlx5_umr_sig_attr *sig_attr,
+				   struct spdk_mlx5_umr_crypto_attr *crypto_attr, uint64_t wr_id,
+				   uint32_t flags, uint32_t wqe_size, uint32_t umr_wqe_n_bb,
+				   uint32_t mtt_size)
+{
+	struct mlx5_hw_qp *hw = &dv_qp->hw;
+	struct mlx5_wqe_ctrl_seg *ctrl;
+	struct mlx5_wqe_ctrl_seg *gen_ctrl;
+	struct mlx5_wqe_umr_ctrl_seg *umr_ctrl;
+	struct mlx5_wqe_mkey_context_seg *mkey;
+	struct mlx5_wqe_umr_klm_seg *klm;
+	struct mlx5_sig_bsf_seg *sig_bsf;
+	struct mlx5_crypto_bsf_seg *crypto_bsf;
+	uint8_t fm_ce_se;
+	uint32_t pi;
+	uint32_t i;
+
+	fm_ce_se = mlx5_qp_fm_ce_se_update(dv_qp, (uint8_t)flags);
+
+	ctrl = (struct mlx5_wqe_ctrl_seg *)mlx5_qp_get_wqe_bb(hw);
+	pi = hw->sq_pi & (hw->sq_wqe_cnt - 1);
+	gen_ctrl = ctrl;
+	mlx5_set_ctrl_seg(gen_ctrl, hw->sq_pi, MLX5_OPCODE_UMR, 0,
+			  hw->qp_num, fm_ce_se,
+			  SPDK_CEIL_DIV(wqe_size, 16), 0,
+			  htobe32(umr_attr->mkey));
+
+	/* build umr ctrl segment */
+	umr_ctrl = (struct mlx5_wqe_umr_ctrl_seg *)(gen_ctrl + 1);
+	memset(umr_ctrl, 0, sizeof(*umr_ctrl));
+	mlx5_set_umr_ctrl_seg_mtt_sig(umr_ctrl, mtt_size);
+	mlx5_set_umr_ctrl_seg_bsf_size(umr_ctrl, sizeof(struct mlx5_sig_bsf_seg) +
+				       sizeof(struct mlx5_crypto_bsf_seg));
+
+	/* build mkey context segment */
+	mkey = (struct mlx5_wqe_mkey_context_seg *)(umr_ctrl + 1);
+	memset(mkey, 0, sizeof(*mkey));
+	mlx5_set_umr_mkey_seg_mtt(mkey, umr_attr);
+	mlx5_set_umr_mkey_seg_sig(mkey, sig_attr);
+
+	klm = (struct mlx5_wqe_umr_klm_seg *)(mkey + 1);
+	for (i = 0; i < umr_attr->sge_count; i++) {
+		mlx5_set_umr_inline_klm_seg(klm, &umr_attr->sge[i]);
+		/* sizeof(*klm) * 4 == MLX5_SEND_WQE_BB */
+		klm = klm + 1;
+	}
+	/* fill PAD if existing */
+	/* PAD entries is to make whole mtt aligned to 64B(MLX5_SEND_WQE_BB),
+	 * So it will not happen warp around during fill PAD entries. */
+	for (; i < mtt_size; i++) {
+		memset(klm, 0, sizeof(*klm));
+		klm = klm + 1;
+	}
+
+	sig_bsf = (struct mlx5_sig_bsf_seg *)klm;
+	mlx5_set_umr_sig_bsf_seg(sig_bsf, sig_attr);
+
+	crypto_bsf = (struct mlx5_crypto_bsf_seg *)(sig_bsf + 1);
+	mlx5_set_umr_crypto_bsf_seg(crypto_bsf, crypto_attr, umr_attr->umr_len,
+				    MLX5_CRYPTO_BSF_SIZE_WITH_SIG);
+
+	mlx5_qp_wqe_submit(dv_qp, ctrl, umr_wqe_n_bb, pi);
+
+	mlx5_qp_set_comp(dv_qp, pi, wr_id, fm_ce_se, umr_wqe_n_bb);
+	assert(dv_qp->tx_available >= umr_wqe_n_bb);
+	dv_qp->tx_available -= umr_wqe_n_bb;
+}
+
+int
+spdk_mlx5_umr_configure_sig_crypto(struct spdk_mlx5_qp *qp, struct spdk_mlx5_umr_attr *umr_attr,
+				   struct spdk_mlx5_umr_sig_attr *sig_attr,
+				   struct spdk_mlx5_umr_crypto_attr *crypto_attr, uint64_t wr_id, uint32_t flags)
+{
+	struct mlx5_hw_qp *hw = &qp->hw;
+	uint32_t pi, to_end, umr_wqe_n_bb;
+	uint32_t wqe_size, mtt_size;
+	uint32_t inline_klm_size;
+
+	if (!spdk_unlikely(umr_attr->sge_count)) {
+		return -EINVAL;
+	}
+
+	pi = hw->sq_pi & (hw->sq_wqe_cnt - 1);
+	to_end = (hw->sq_wqe_cnt - pi) * MLX5_SEND_WQE_BB;
+
+	/*
+	 * UMR WQE LAYOUT:
+	 * -------------------------------------------------------------------------------------------
+	 * | gen_ctrl | umr_ctrl | mkey_ctx | inline klm mtt | inline sig bsf | inline crypto bsf |
+	 * -------------------------------------------------------------------------------------------
+	 *   16bytes    48bytes    64bytes   sge_count*16 bytes      64 bytes          64 bytes
+	 *
+	 * Note: size of inline klm mtt should be aligned to 64 bytes.
+	 */
+	wqe_size = sizeof(struct mlx5_wqe_ctrl_seg) + sizeof(struct mlx5_wqe_umr_ctrl_seg) +
+		   sizeof(struct mlx5_wqe_mkey_context_seg);
+	mtt_size = SPDK_ALIGN_CEIL(umr_attr->sge_count, 4);
+	inline_klm_size = mtt_size * sizeof(struct mlx5_wqe_umr_klm_seg);
+	wqe_size += inline_klm_size;
+	wqe_size += sizeof(struct mlx5_sig_bsf_seg);
+	wqe_size += sizeof(struct mlx5_crypto_bsf_seg);
+
+	umr_wqe_n_bb = SPDK_CEIL_DIV(wqe_size, MLX5_SEND_WQE_BB);
+	if (spdk_unlikely(umr_wqe_n_bb > qp->tx_available)) {
+		return -ENOMEM;
+	}
+	if (spdk_unlikely(umr_attr->sge_count > qp->max_send_sge)) {
+		return -E2BIG;
+	}
+
+	if (spdk_unlikely(to_end < wqe_size)) {
+		mlx5_umr_configure_with_wrap_around_sig_crypto(qp, umr_attr, sig_attr, crypto_attr, wr_id,
+				flags, wqe_size, umr_wqe_n_bb, mtt_size);
+	} else {
+		mlx5_umr_configure_full_sig_crypto(qp, umr_attr, sig_attr, crypto_attr, wr_id, flags,
+						   wqe_size, umr_wqe_n_bb, mtt_size);
+	}
+
+	return 0;
+}
+
 static inline void
 mlx5_umr_configure_full(struct spdk_mlx5_qp *dv_qp, struct spdk_mlx5_umr_attr *umr_attr,
 			uint64_t wr_id, uint32_t flags, uint32_t wqe_size, uint32_t umr_wqe_n_bb,
@@ -25,6 +25,7 @@
 #define NBD_STOP_BUSY_WAITING_MS	10000
 #define NBD_BUSY_POLLING_INTERVAL_US	20000
 #define NBD_IO_TIMEOUT_S		60
+#define NBD_MAX_CONNECTIONS		64
 
 enum nbd_io_state_t {
 	/* Receiving or ready to receive nbd request header */
@@ -38,7 +39,7 @@ enum nbd_io_state_t {
 };
 
 struct nbd_io {
-	struct spdk_nbd_disk	*nbd;
+	struct nbd_conn		*conn;
 	enum nbd_io_state_t	state;
 
 	void			*payload;
@@ -59,33 +60,61 @@ struct nbd_io {
 	TAILQ_ENTRY(nbd_io)	tailq;
 };
 
-struct spdk_nbd_disk {
-	struct spdk_bdev	*bdev;
-	struct spdk_bdev_desc	*bdev_desc;
+/*
+ * Connection between the kernel and the nbd disk. Each connection is served by its own
+ * SPDK thread and only touched from it once started.
+ */
+struct nbd_conn {
+	struct spdk_nbd_disk	*nbd;
+	uint32_t		idx;
+	struct spdk_thread	*thread;
 	struct spdk_io_channel	*ch;
-	int			dev_fd;
-	char			*nbd_path;
 	int			kernel_sp_fd;
 	int			spdk_sp_fd;
 	struct spdk_poller	*nbd_poller;
 	struct spdk_interrupt	*intr;
 	bool			interrupt_mode;
+
+	struct nbd_io		*io_in_recv;
+	TAILQ_HEAD(, nbd_io)	received_io_list;
+	TAILQ_HEAD(, nbd_io)	executed_io_list;
+	TAILQ_HEAD(, nbd_io)	processing_io_list;
+
+	bool			is_closing;
+	/* The socket failed, executed nbd_io are dropped instead of transmitted */
+	bool			is_broken;
+	/* The nbd thread was asked to stop the disk */
+	bool			stop_requested;
+	/* The nbd thread stops this connection, it's released once its nbd_io are done */
+	bool			is_stopping;
+	/* count of nbd_io in nbd_conn */
+	int			io_count;
+};
+
+struct spdk_nbd_disk {
+	struct spdk_bdev	*bdev;
+	struct spdk_bdev_desc	*bdev_desc;
+	int			dev_fd;
+	char			*nbd_path;
 	uint32_t		buf_align;
+	/* Thread the disk was started on, serving the first connection */
+	struct spdk_thread	*thread;
+
+	struct nbd_conn		*conns;
+	uint32_t		num_conns;
+	/* Connections whose socket was handed to the kernel */
+	uint32_t		num_conns_set;
+	/* Connections started and not stopped yet */
+	uint32_t		num_conns_active;
 
 	struct spdk_poller	*retry_poller;
 	int			retry_count;
 	/* Synchronize nbd_start_kernel pthread and nbd_stop */
 	bool			has_nbd_pthread;
 
-	struct nbd_io		*io_in_recv;
-	TAILQ_HEAD(, nbd_io)	received_io_list;
-	TAILQ_HEAD(, nbd_io)	executed_io_list;
-	TAILQ_HEAD(, nbd_io)	processing_io_list;
-
 	bool			is_started;
 	bool			is_closing;
-	/* count of nbd_io in spdk_nbd_disk */
-	int			io_count;
+	bool			conns_stopping;
 
 	TAILQ_ENTRY(spdk_nbd_disk)	tailq;
 };
@@ -100,8 +129,9 @@ static void *g_fini_cb_arg;
 
 static void _nbd_fini(void *arg1);
 
-static int nbd_submit_bdev_io(struct spdk_nbd_disk *nbd, struct nbd_io *io);
-static int nbd_io_recv_internal(struct spdk_nbd_disk *nbd);
+static int nbd_submit_bdev_io(struct nbd_conn *conn, struct nbd_io *io);
+static int nbd_io_recv_internal(struct nbd_conn *conn);
+static void nbd_io_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg);
 
 int
 spdk_nbd_init(void)
@@ -210,6 +240,12 @@ nbd_disk_get_bdev_name(struct spdk_nbd_disk *nbd)
 	return spdk_bdev_get_name(nbd->bdev);
 }
 
+uint32_t
+nbd_disk_get_num_connections(struct spdk_nbd_disk *nbd)
+{
+	return nbd->num_conns;
+}
+
 void
 spdk_nbd_write_config_json(struct spdk_json_write_ctx *w)
 {
@@ -225,6 +261,9 @@ spdk_nbd_write_config_json(struct spdk_json_write_ctx *w)
 		spdk_json_write_named_object_begin(w, "params");
 		spdk_json_write_named_string(w, "nbd_device",  nbd_disk_get_nbd_path(nbd));
 		spdk_json_write_named_string(w, "bdev_name", nbd_disk_get_bdev_name(nbd));
+		if (nbd->num_conns > 1) {
+			spdk_json_write_named_uint32(w, "num_connections", nbd->num_conns);
+		}
 		spdk_json_write_object_end(w);
 
 		spdk_json_write_object_end(w);
@@ -245,7 +284,7 @@ nbd_disconnect(struct spdk_nbd_disk *nbd)
 }
 
 static struct nbd_io *
-nbd_get_io(struct spdk_nbd_disk *nbd)
+nbd_get_io(struct nbd_conn *conn)
 {
 	struct nbd_io *io;
 
@@ -254,23 +293,23 @@ nbd_get_io(struct spdk_nbd_disk *nbd)
 		return NULL;
 	}
 
-	io->nbd = nbd;
+	io->conn = conn;
 	to_be32(&io->resp.magic, NBD_REPLY_MAGIC);
 
-	nbd->io_count++;
+	conn->io_count++;
 
 	return io;
 }
 
 static void
-nbd_put_io(struct spdk_nbd_disk *nbd, struct nbd_io *io)
+nbd_put_io(struct nbd_conn *conn, struct nbd_io *io)
 {
 	if (io->payload) {
 		spdk_free(io->payload);
 	}
 	free(io);
 
-	nbd->io_count--;
+	conn->io_count--;
 }
 
 /*
@@ -281,49 +320,69 @@ nbd_put_io(struct spdk_nbd_disk *nbd, struct nbd_io *io)
  *         0 all nbd_io gotten are freed.
  */
 static int
-nbd_cleanup_io(struct spdk_nbd_disk *nbd)
+nbd_cleanup_io(struct nbd_conn *conn)
 {
+	struct nbd_io *io, *io_tmp;
+
 	/* Try to read the remaining nbd commands in the socket */
-	while (nbd_io_recv_internal(nbd) > 0);
+	while (!conn->is_broken && nbd_io_recv_internal(conn) > 0);
 
 	/* free io_in_recv */
-	if (nbd->io_in_recv != NULL) {
-		nbd_put_io(nbd, nbd->io_in_recv);
-		nbd->io_in_recv = NULL;
+	if (conn->io_in_recv != NULL) {
+		nbd_put_io(conn, conn->io_in_recv);
+		conn->io_in_recv = NULL;
+	}
+
+	/* The responses can't be transmitted over a failed socket anymore */
+	if (conn->is_broken) {
+		TAILQ_FOREACH_SAFE(io, &conn->executed_io_list, tailq, io_tmp) {
+			TAILQ_REMOVE(&conn->executed_io_list, io, tailq);
+			nbd_put_io(conn, io);
+		}
 	}
 
 	/*
 	 * Some nbd_io may be under executing in bdev.
 	 * Wait for their done operation.
 	 */
-	if (nbd->io_count != 0) {
+	if (conn->io_count != 0) {
 		return 1;
 	}
 
 	return 0;
 }
 
+static void
+nbd_conn_thread_exit(void *arg)
+{
+	spdk_thread_exit(spdk_get_thread());
+}
+
 static int
 _nbd_stop(void *arg)
 {
 	struct spdk_nbd_disk *nbd = arg;
+	struct nbd_conn *conn;
+	uint32_t i;
 
-	if (nbd->nbd_poller) {
-		spdk_poller_unregister(&nbd->nbd_poller);
-	}
+	for (i = 0; nbd->conns != NULL && i < nbd->num_conns; i++) {
+		conn = &nbd->conns[i];
 
-	if (nbd->intr) {
-		spdk_interrupt_unregister(&nbd->intr);
-	}
+		/* Threads of connections that were never started */
+		if (conn->thread != NULL && conn->thread != nbd->thread) {
+			spdk_thread_send_msg(conn->thread, nbd_conn_thread_exit, NULL);
+		}
+		conn->thread = NULL;
 
-	if (nbd->spdk_sp_fd >= 0) {
-		close(nbd->spdk_sp_fd);
-		nbd->spdk_sp_fd = -1;
-	}
+		if (conn->spdk_sp_fd >= 0) {
+			close(conn->spdk_sp_fd);
+			conn->spdk_sp_fd = -1;
+		}
 
-	if (nbd->kernel_sp_fd >= 0) {
-		close(nbd->kernel_sp_fd);
-		nbd->kernel_sp_fd = -1;
+		if (conn->kernel_sp_fd >= 0) {
+			close(conn->kernel_sp_fd);
+			conn->kernel_sp_fd = -1;
+		}
 	}
 
 	/* Continue the stop procedure after the exit of nbd_start_kernel pthread */
@@ -359,11 +418,6 @@ _nbd_stop(void *arg)
 		free(nbd->nbd_path);
 	}
 
-	if (nbd->ch) {
-		spdk_put_io_channel(nbd->ch);
-		nbd->ch = NULL;
-	}
-
 	if (nbd->bdev_desc) {
 		spdk_bdev_close(nbd->bdev_desc);
 		nbd->bdev_desc = NULL;
@@ -371,18 +425,84 @@ _nbd_stop(void *arg)
 
 	nbd_disk_unregister(nbd);
 
+	free(nbd->conns);
 	free(nbd);
 
 	return 0;
 }
 
+static void
+nbd_conn_stopped(void *arg)
+{
+	struct spdk_nbd_disk *nbd = arg;
+
+	assert(nbd->num_conns_active > 0);
+	if (--nbd->num_conns_active == 0) {
+		_nbd_stop(nbd);
+	}
+}
+
+/* Release the resources of a connection, on its thread, once all its nbd_io are done. */
+static void
+nbd_conn_fini(struct nbd_conn *conn)
+{
+	struct spdk_nbd_disk *nbd = conn->nbd;
+	struct spdk_thread *thread = conn->thread;
+
+	spdk_poller_unregister(&conn->nbd_poller);
+
+	if (conn->intr) {
+		spdk_interrupt_unregister(&conn->intr);
+	}
+
+	/* Closing the socket lets the kernel know this connection is gone */
+	if (conn->spdk_sp_fd >= 0) {
+		close(conn->spdk_sp_fd);
+		conn->spdk_sp_fd = -1;
+	}
+
+	if (conn->ch) {
+		spdk_put_io_channel(conn->ch);
+		conn->ch = NULL;
+	}
+
+	conn->thread = NULL;
+	spdk_thread_send_msg(nbd->thread, nbd_conn_stopped, nbd);
+
+	if (thread != nbd->thread) {
+		spdk_thread_exit(thread);
+	}
+}
+
+static void
+nbd_conn_stop(void *arg)
+{
+	struct nbd_conn *conn = arg;
+	struct nbd_io *io, *io_tmp;
+
+	conn->is_closing = true;
+	conn->stop_requested = true;
+	conn->is_stopping = true;
+
+	/* The bdev may be gone, fail the nbd_io not submitted yet */
+	TAILQ_FOREACH_SAFE(io, &conn->received_io_list, tailq, io_tmp) {
+		TAILQ_REMOVE(&conn->received_io_list, io, tailq);
+		TAILQ_INSERT_TAIL(&conn->processing_io_list, io, tailq);
+		nbd_io_done(NULL, false, io);
+	}
+
+	if (nbd_cleanup_io(conn) == 0) {
+		nbd_conn_fini(conn);
+	}
+}
+
 int
 spdk_nbd_stop(struct spdk_nbd_disk *nbd)
 {
-	int rc = 0;
+	uint32_t i;
 
 	if (nbd == NULL) {
-		return rc;
+		return 0;
 	}
 
 	nbd->is_closing = true;
@@ -393,15 +513,25 @@ spdk_nbd_stop(struct spdk_nbd_disk *nbd)
 	}
 
 	/*
-	 * Stop action should be called only after all nbd_io are executed.
+	 * Stop action should be called only after all nbd_io are executed,
+	 * each connection waits for its own ones on its thread.
 	 */
-
-	rc = nbd_cleanup_io(nbd);
-	if (!rc) {
-		_nbd_stop(nbd);
+	if (!nbd->conns_stopping) {
+		nbd->conns_stopping = true;
+		for (i = 0; i < nbd->num_conns; i++) {
+			spdk_thread_send_msg(nbd->conns[i].thread, nbd_conn_stop, &nbd->conns[i]);
+		}
 	}
 
-	return rc;
+	return 1;
+}
+
+static void
+nbd_stop_msg(void *arg)
+{
+	struct spdk_nbd_disk *nbd = arg;
+
+	spdk_nbd_stop(nbd);
 }
 
 static int64_t
@@ -431,7 +561,7 @@ static void
 nbd_io_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
 	struct nbd_io	*io = cb_arg;
-	struct spdk_nbd_disk *nbd = io->nbd;
+	struct nbd_conn *conn = io->conn;
 
 	if (success) {
 		io->resp.error = 0;
@@ -444,12 +574,12 @@ nbd_io_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 	/* When there begins to have executed_io, enable socket writable notice in order to
 	 * get it processed in nbd_io_xmit
 	 */
-	if (nbd->interrupt_mode && TAILQ_EMPTY(&nbd->executed_io_list)) {
-		spdk_interrupt_set_event_types(nbd->intr, SPDK_INTERRUPT_EVENT_IN | SPDK_INTERRUPT_EVENT_OUT);
+	if (conn->interrupt_mode && TAILQ_EMPTY(&conn->executed_io_list)) {
+		spdk_interrupt_set_event_types(conn->intr, SPDK_INTERRUPT_EVENT_IN | SPDK_INTERRUPT_EVENT_OUT);
 	}
 
-	TAILQ_REMOVE(&nbd->processing_io_list, io, tailq);
-	TAILQ_INSERT_TAIL(&nbd->executed_io_list, io, tailq);
+	TAILQ_REMOVE(&conn->processing_io_list, io, tailq);
+	TAILQ_INSERT_TAIL(&conn->executed_io_list, io, tailq);
 
 	if (bdev_io != NULL) {
 		spdk_bdev_free_io(bdev_io);
@@ -460,13 +590,13 @@ static void
 nbd_resubmit_io(void *arg)
 {
 	struct nbd_io *io = (struct nbd_io *)arg;
-	struct spdk_nbd_disk *nbd = io->nbd;
+	struct nbd_conn *conn = io->conn;
 	int rc = 0;
 
-	rc = nbd_submit_bdev_io(nbd, io);
+	rc = nbd_submit_bdev_io(conn, io);
 	if (rc) {
 		SPDK_INFOLOG(nbd, "nbd: io resubmit for dev %s , io_type %d, returned %d.\n",
-			     nbd_disk_get_bdev_name(nbd), from_be32(&io->req.type), rc);
+			     nbd_disk_get_bdev_name(conn->nbd), from_be32(&io->req.type), rc);
 	}
 }
 
@@ -474,13 +604,13 @@ static void
 nbd_queue_io(struct nbd_io *io)
 {
 	int rc;
-	struct spdk_bdev *bdev = io->nbd->bdev;
+	struct spdk_bdev *bdev = io->conn->nbd->bdev;
 
 	io->bdev_io_wait.bdev = bdev;
 	io->bdev_io_wait.cb_fn = nbd_resubmit_io;
 	io->bdev_io_wait.cb_arg = io;
 
-	rc = spdk_bdev_queue_io_wait(bdev, io->nbd->ch, &io->bdev_io_wait);
+	rc = spdk_bdev_queue_io_wait(bdev, io->conn->ch, &io->bdev_io_wait);
 	if (rc != 0) {
 		SPDK_ERRLOG("Queue io failed in nbd_queue_io, rc=%d.\n", rc);
 		nbd_io_done(NULL, false, io);
@@ -488,10 +618,11 @@ nbd_queue_io(struct nbd_io *io)
 }
 
 static int
-nbd_submit_bdev_io(struct spdk_nbd_disk *nbd, struct nbd_io *io)
+nbd_submit_bdev_io(struct nbd_conn *conn, struct nbd_io *io)
 {
+	struct spdk_nbd_disk *nbd = conn->nbd;
 	struct spdk_bdev_desc *desc = nbd->bdev_desc;
-	struct spdk_io_channel *ch = nbd->ch;
+	struct spdk_io_channel *ch = conn->ch;
 	int rc = 0;
 
 	switch (from_be32(&io->req.type)) {
@@ -534,16 +665,16 @@ nbd_submit_bdev_io(struct spdk_nbd_disk *nbd, struct nbd_io *io)
 }
 
 static int
-nbd_io_exec(struct spdk_nbd_disk *nbd)
+nbd_io_exec(struct nbd_conn *conn)
 {
 	struct nbd_io *io, *io_tmp;
 	int io_count = 0;
 	int ret = 0;
 
-	TAILQ_FOREACH_SAFE(io, &nbd->received_io_list, tailq, io_tmp) {
-		TAILQ_REMOVE(&nbd->received_io_list, io, tailq);
-		TAILQ_INSERT_TAIL(&nbd->processing_io_list, io, tailq);
-		ret = nbd_submit_bdev_io(nbd, io);
+	TAILQ_FOREACH_SAFE(io, &conn->received_io_list, tailq, io_tmp) {
+		TAILQ_REMOVE(&conn->received_io_list, io, tailq);
+		TAILQ_INSERT_TAIL(&conn->processing_io_list, io, tailq);
+		ret = nbd_submit_bdev_io(conn, io);
 		if (ret < 0) {
 			return ret;
 		}
@@ -555,27 +686,28 @@ nbd_io_exec(struct spdk_nbd_disk *nbd)
 }
 
 static int
-nbd_io_recv_internal(struct spdk_nbd_disk *nbd)
+nbd_io_recv_internal(struct nbd_conn *conn)
 {
+	struct spdk_nbd_disk *nbd = conn->nbd;
 	struct nbd_io *io;
 	int ret = 0;
 	int received = 0;
 
-	if (nbd->io_in_recv == NULL) {
-		nbd->io_in_recv = nbd_get_io(nbd);
-		if (!nbd->io_in_recv) {
+	if (conn->io_in_recv == NULL) {
+		conn->io_in_recv = nbd_get_io(conn);
+		if (!conn->io_in_recv) {
 			return -ENOMEM;
 		}
 	}
 
-	io = nbd->io_in_recv;
+	io = conn->io_in_recv;
 
 	if (io->state == NBD_IO_RECV_REQ) {
-		ret = nbd_socket_rw(nbd->spdk_sp_fd, (char *)&io->req + io->offset,
+		ret = nbd_socket_rw(conn->spdk_sp_fd, (char *)&io->req + io->offset,
 				    sizeof(io->req) - io->offset, true);
 		if (ret < 0) {
-			nbd_put_io(nbd, io);
-			nbd->io_in_recv = NULL;
+			nbd_put_io(conn, io);
+			conn->io_in_recv = NULL;
 			return ret;
 		}
 
@@ -589,18 +721,18 @@ nbd_io_recv_internal(struct spdk_nbd_disk *nbd)
 			/* req magic check */
 			if (from_be32(&io->req.magic) != NBD_REQUEST_MAGIC) {
 				SPDK_ERRLOG("invalid request magic\n");
-				nbd_put_io(nbd, io);
-				nbd->io_in_recv = NULL;
+				nbd_put_io(conn, io);
+				conn->io_in_recv = NULL;
 				return -EINVAL;
 			}
 
 			if (from_be32(&io->req.type) == NBD_CMD_DISC) {
-				nbd->is_closing = true;
-				nbd->io_in_recv = NULL;
-				if (nbd->interrupt_mode && TAILQ_EMPTY(&nbd->executed_io_list)) {
-					spdk_interrupt_set_event_types(nbd->intr, SPDK_INTERRUPT_EVENT_IN | SPDK_INTERRUPT_EVENT_OUT);
+				conn->is_closing = true;
+				conn->io_in_recv = NULL;
+				if (conn->interrupt_mode && TAILQ_EMPTY(&conn->executed_io_list)) {
+					spdk_interrupt_set_event_types(conn->intr, SPDK_INTERRUPT_EVENT_IN | SPDK_INTERRUPT_EVENT_OUT);
 				}
-				nbd_put_io(nbd, io);
+				nbd_put_io(conn, io);
 				/* After receiving NBD_CMD_DISC, nbd will not receive any new commands */
 				return received;
 			}
@@ -619,8 +751,8 @@ nbd_io_recv_internal(struct spdk_nbd_disk *nbd)
 							  SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
 				if (io->payload == NULL) {
 					SPDK_ERRLOG("could not allocate io->payload of size %d\n", io->payload_size);
-					nbd_put_io(nbd, io);
-					nbd->io_in_recv = NULL;
+					nbd_put_io(conn, io);
+					conn->io_in_recv = NULL;
 					return -ENOMEM;
 				}
 			} else {
@@ -632,22 +764,23 @@ nbd_io_recv_internal(struct spdk_nbd_disk *nbd)
 				io->state = NBD_IO_RECV_PAYLOAD;
 			} else {
 				io->state = NBD_IO_XMIT_RESP;
-				if (spdk_likely((!nbd->is_closing) && nbd->is_started)) {
-					TAILQ_INSERT_TAIL(&nbd->received_io_list, io, tailq);
+				if (spdk_likely((!conn->is_closing) && nbd->is_started)) {
+					TAILQ_INSERT_TAIL(&conn->received_io_list, io, tailq);
 				} else {
-					TAILQ_INSERT_TAIL(&nbd->processing_io_list, io, tailq);
+					TAILQ_INSERT_TAIL(&conn->processing_io_list, io, tailq);
 					nbd_io_done(NULL, false, io);
 				}
-				nbd->io_in_recv = NULL;
+				conn->io_in_recv = NULL;
 			}
 		}
 	}
 
 	if (io->state == NBD_IO_RECV_PAYLOAD) {
-		ret = nbd_socket_rw(nbd->spdk_sp_fd, io->payload + io->offset, io->payload_size - io->offset, true);
+		ret = nbd_socket_rw(conn->spdk_sp_fd, io->payload + io->offset, io->payload_size - io->offset,
+				    true);
 		if (ret < 0) {
-			nbd_put_io(nbd, io);
-			nbd->io_in_recv = NULL;
+			nbd_put_io(conn, io);
+			conn->io_in_recv = NULL;
 			return ret;
 		}
 
@@ -658,13 +791,13 @@ nbd_io_recv_internal(struct spdk_nbd_disk *nbd)
 		if (io->offset == io->payload_size) {
 			io->offset = 0;
 			io->state = NBD_IO_XMIT_RESP;
-			if (spdk_likely((!nbd->is_closing) && nbd->is_started)) {
-				TAILQ_INSERT_TAIL(&nbd->received_io_list, io, tailq);
+			if (spdk_likely((!conn->is_closing) && nbd->is_started)) {
+				TAILQ_INSERT_TAIL(&conn->received_io_list, io, tailq);
 			} else {
-				TAILQ_INSERT_TAIL(&nbd->processing_io_list, io, tailq);
+				TAILQ_INSERT_TAIL(&conn->processing_io_list, io, tailq);
 				nbd_io_done(NULL, false, io);
 			}
-			nbd->io_in_recv = NULL;
+			conn->io_in_recv = NULL;
 		}
 
 	}
@@ -673,24 +806,24 @@ nbd_io_recv_internal(struct spdk_nbd_disk *nbd)
 }
 
 static int
-nbd_io_recv(struct spdk_nbd_disk *nbd)
+nbd_io_recv(struct nbd_conn *conn)
 {
 	int i, rc, ret = 0;
 
 	/*
 	 * nbd server should not accept request after closing command
 	 */
-	if (nbd->is_closing) {
+	if (conn->is_closing) {
 		return 0;
 	}
 
 	for (i = 0; i < GET_IO_LOOP_COUNT; i++) {
-		rc = nbd_io_recv_internal(nbd);
+		rc = nbd_io_recv_internal(conn);
 		if (rc < 0) {
 			return rc;
 		}
 		ret += rc;
-		if (nbd->is_closing) {
+		if (conn->is_closing) {
 			break;
 		}
 	}
@@ -699,13 +832,13 @@ nbd_io_recv(struct spdk_nbd_disk *nbd)
 }
 
 static int
-nbd_io_xmit_internal(struct spdk_nbd_disk *nbd)
+nbd_io_xmit_internal(struct nbd_conn *conn)
 {
 	struct nbd_io *io;
 	int ret = 0;
 	int sent = 0;
 
-	io = TAILQ_FIRST(&nbd->executed_io_list);
+	io = TAILQ_FIRST(&conn->executed_io_list);
 	if (io == NULL) {
 		return 0;
 	}
@@ -714,12 +847,12 @@ nbd_io_xmit_internal(struct spdk_nbd_disk *nbd)
 	 *  back to the head if it cannot be completed.  This approach is specifically
 	 *  taken to work around a scan-build use-after-free mischaracterization.
 	 */
-	TAILQ_REMOVE(&nbd->executed_io_list, io, tailq);
+	TAILQ_REMOVE(&conn->executed_io_list, io, tailq);
 
 	/* resp error and handler are already set in io_done */
 
 	if (io->state == NBD_IO_XMIT_RESP) {
-		ret = nbd_socket_rw(nbd->spdk_sp_fd, (char *)&io->resp + io->offset,
+		ret = nbd_socket_rw(conn->spdk_sp_fd, (char *)&io->resp + io->offset,
 				    sizeof(io->resp) - io->offset, false);
 		if (ret <= 0) {
 			goto reinsert;
@@ -734,7 +867,7 @@ nbd_io_xmit_internal(struct spdk_nbd_disk *nbd)
 
 			/* transmit payload only when NBD_CMD_READ with no resp error */
 			if (from_be32(&io->req.type) != NBD_CMD_READ || io->resp.error != 0) {
-				nbd_put_io(nbd, io);
+				nbd_put_io(conn, io);
 				return 0;
 			} else {
 				io->state = NBD_IO_XMIT_PAYLOAD;
@@ -743,7 +876,7 @@ nbd_io_xmit_internal(struct spdk_nbd_disk *nbd)
 	}
 
 	if (io->state == NBD_IO_XMIT_PAYLOAD) {
-		ret = nbd_socket_rw(nbd->spdk_sp_fd, io->payload + io->offset, io->payload_size - io->offset,
+		ret = nbd_socket_rw(conn->spdk_sp_fd, io->payload + io->offset, io->payload_size - io->offset,
 				    false);
 		if (ret <= 0) {
 			goto reinsert;
@@ -754,24 +887,24 @@ nbd_io_xmit_internal(struct spdk_nbd_disk *nbd)
 
 		/* read payload is fully transmitted */
 		if (io->offset == io->payload_size) {
-			nbd_put_io(nbd, io);
+			nbd_put_io(conn, io);
 			return sent;
 		}
 	}
 
 reinsert:
-	TAILQ_INSERT_HEAD(&nbd->executed_io_list, io, tailq);
+	TAILQ_INSERT_HEAD(&conn->executed_io_list, io, tailq);
 	return ret < 0 ? ret : sent;
 }
 
 static int
-nbd_io_xmit(struct spdk_nbd_disk *nbd)
+nbd_io_xmit(struct nbd_conn *conn)
 {
 	int ret = 0;
 	int rc;
 
-	while (!TAILQ_EMPTY(&nbd->executed_io_list)) {
-		rc = nbd_io_xmit_internal(nbd);
+	while (!TAILQ_EMPTY(&conn->executed_io_list)) {
+		rc = nbd_io_xmit_internal(conn);
 		if (rc < 0) {
 			return rc;
 		}
@@ -780,35 +913,35 @@ nbd_io_xmit(struct spdk_nbd_disk *nbd)
 	}
 
 	/* When there begins to have no executed_io, disable socket writable notice */
-	if (nbd->interrupt_mode) {
-		spdk_interrupt_set_event_types(nbd->intr, SPDK_INTERRUPT_EVENT_IN);
+	if (conn->interrupt_mode) {
+		spdk_interrupt_set_event_types(conn->intr, SPDK_INTERRUPT_EVENT_IN);
 	}
 
 	return ret;
 }
 
 /**
- * Poll an NBD instance.
+ * Poll an NBD connection.
  *
  * \return 0 on success or negated errno values on error (e.g. connection closed).
  */
 static int
-_nbd_poll(struct spdk_nbd_disk *nbd)
+_nbd_poll(struct nbd_conn *conn)
 {
 	int received, sent, executed;
 
 	/* transmit executed io first */
-	sent = nbd_io_xmit(nbd);
+	sent = nbd_io_xmit(conn);
 	if (sent < 0) {
 		return sent;
 	}
 
-	received = nbd_io_recv(nbd);
+	received = nbd_io_recv(conn);
 	if (received < 0) {
 		return received;
 	}
 
-	executed = nbd_io_exec(nbd);
+	executed = nbd_io_exec(conn);
 	if (executed < 0) {
 		return executed;
 	}
@@ -819,21 +952,33 @@ _nbd_poll(struct spdk_nbd_disk *nbd)
 static int
 nbd_poll(void *arg)
 {
-	struct spdk_nbd_disk *nbd = arg;
-	int rc;
+	struct nbd_conn *conn = arg;
+	int rc = 0;
 
-	rc = _nbd_poll(nbd);
-	if (rc < 0) {
-		SPDK_INFOLOG(nbd, "nbd_poll() returned %s (%d); closing connection\n",
-			     spdk_strerror(-rc), rc);
-		_nbd_stop(nbd);
-		return SPDK_POLLER_IDLE;
+	if (!conn->is_broken) {
+		rc = _nbd_poll(conn);
+		if (rc < 0) {
+			SPDK_INFOLOG(nbd, "nbd_poll() returned %s (%d); closing connection %u\n",
+				     spdk_strerror(-rc), rc, conn->idx);
+			conn->is_broken = true;
+			conn->is_closing = true;
+		}
 	}
-	if (nbd->is_closing && nbd->io_count == 0) {
-		spdk_nbd_stop(nbd);
+
+	if (conn->is_closing) {
+		/* One connection going away takes the whole disk down */
+		if (!conn->stop_requested) {
+			conn->stop_requested = true;
+			spdk_thread_send_msg(conn->nbd->thread, nbd_stop_msg, conn->nbd);
+		}
+
+		if (conn->is_stopping && nbd_cleanup_io(conn) == 0) {
+			nbd_conn_fini(conn);
+			return SPDK_POLLER_BUSY;
+		}
 	}
 
-	return rc == 0 ? SPDK_POLLER_IDLE : SPDK_POLLER_BUSY;
+	return rc <= 0 ? SPDK_POLLER_IDLE : SPDK_POLLER_BUSY;
 }
 
 struct spdk_nbd_start_ctx {
@@ -847,13 +992,17 @@ static void
 nbd_start_complete(void *arg)
 {
 	struct spdk_nbd_start_ctx *ctx = arg;
+	struct spdk_nbd_disk *nbd = ctx->nbd;
 
 	if (ctx->cb_fn) {
-		ctx->cb_fn(ctx->cb_arg, ctx->nbd, 0);
+		ctx->cb_fn(ctx->cb_arg, nbd, 0);
 	}
 
 	/* nbd will possibly receive stop command while initing */
-	ctx->nbd->is_started = true;
+	nbd->is_started = true;
+	if (nbd->is_closing) {
+		spdk_nbd_stop(nbd);
+	}
 
 	free(ctx);
 }
@@ -872,7 +1021,7 @@ nbd_start_kernel(void *arg)
 	 */
 	spdk_thread_send_msg(ctx->thread, nbd_start_complete, ctx);
 
-	/* This will block in the kernel until we close the spdk_sp_fd. */
+	/* This will block in the kernel until we close all the spdk_sp_fd. */
 	ioctl(nbd->dev_fd, NBD_DO_IT);
 
 	nbd->has_nbd_pthread = false;
@@ -880,27 +1029,13 @@ nbd_start_kernel(void *arg)
 	pthread_exit(NULL);
 }
 
-static void
-nbd_bdev_hot_remove(struct spdk_nbd_disk *nbd)
-{
-	struct nbd_io *io, *io_tmp;
-
-	nbd->is_closing = true;
-	nbd_cleanup_io(nbd);
-
-	TAILQ_FOREACH_SAFE(io, &nbd->received_io_list, tailq, io_tmp) {
-		TAILQ_REMOVE(&nbd->received_io_list, io, tailq);
-		nbd_io_done(NULL, false, io);
-	}
-}
-
 static void
 nbd_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
 		  void *event_ctx)
 {
 	switch (type) {
 	case SPDK_BDEV_EVENT_REMOVE:
-		nbd_bdev_hot_remove(event_ctx);
+		spdk_nbd_stop(event_ctx);
 		break;
 	default:
 		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
@@ -911,26 +1046,75 @@ nbd_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
 static void
 nbd_poller_set_interrupt_mode(struct spdk_poller *poller, void *cb_arg, bool interrupt_mode)
 {
-	struct spdk_nbd_disk *nbd = cb_arg;
+	struct nbd_conn *conn = cb_arg;
 
-	nbd->interrupt_mode = interrupt_mode;
+	conn->interrupt_mode = interrupt_mode;
+}
+
+/* Start serving a connection, on its own thread. */
+static void
+nbd_conn_start(void *arg)
+{
+	struct nbd_conn *conn = arg;
+	struct spdk_nbd_disk *nbd = conn->nbd;
+
+	conn->ch = spdk_bdev_get_io_channel(nbd->bdev_desc);
+	if (conn->ch == NULL) {
+		SPDK_ERRLOG("%s: could not get bdev io channel for connection %u\n",
+			    nbd->nbd_path, conn->idx);
+		conn->is_broken = true;
+		conn->is_closing = true;
+	}
+
+	if (spdk_interrupt_mode_is_enabled()) {
+		conn->intr = SPDK_INTERRUPT_REGISTER(conn->spdk_sp_fd, nbd_poll, conn);
+	}
+
+	conn->nbd_poller = SPDK_POLLER_REGISTER(nbd_poll, conn, 0);
+	spdk_poller_register_interrupt(conn->nbd_poller, nbd_poller_set_interrupt_mode, conn);
+}
+
+static int
+nbd_create_conn_threads(struct spdk_nbd_disk *nbd)
+{
+	char thread_name[32];
+	const char *dev_name;
+	uint32_t i;
+
+	nbd->conns[0].thread = nbd->thread;
+
+	dev_name = strrchr(nbd->nbd_path, '/');
+	dev_name = dev_name ? dev_name + 1 : nbd->nbd_path;
+
+	for (i = 1; i < nbd->num_conns; i++) {
+		snprintf(thread_name, sizeof(thread_name), "%s_conn%u", dev_name, i);
+		nbd->conns[i].thread = spdk_thread_create(thread_name, NULL);
+		if (nbd->conns[i].thread == NULL) {
+			SPDK_ERRLOG("could not create thread %s\n", thread_name);
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
 }
 
 static void
 nbd_start_continue(struct spdk_nbd_start_ctx *ctx)
 {
+	struct spdk_nbd_disk *nbd = ctx->nbd;
 	int		rc;
 	pthread_t	tid;
 	unsigned long	nbd_flags = 0;
+	uint32_t	i;
 
-	rc = ioctl(ctx->nbd->dev_fd, NBD_SET_BLKSIZE, spdk_bdev_get_block_size(ctx->nbd->bdev));
+	rc = ioctl(nbd->dev_fd, NBD_SET_BLKSIZE, spdk_bdev_get_block_size(nbd->bdev));
 	if (rc == -1) {
 		SPDK_ERRLOG("ioctl(NBD_SET_BLKSIZE) failed: %s\n", spdk_strerror(errno));
 		rc = -errno;
 		goto err;
 	}
 
-	rc = ioctl(ctx->nbd->dev_fd, NBD_SET_SIZE_BLOCKS, spdk_bdev_get_num_blocks(ctx->nbd->bdev));
+	rc = ioctl(nbd->dev_fd, NBD_SET_SIZE_BLOCKS, spdk_bdev_get_num_blocks(nbd->bdev));
 	if (rc == -1) {
 		SPDK_ERRLOG("ioctl(NBD_SET_SIZE_BLOCKS) failed: %s\n", spdk_strerror(errno));
 		rc = -errno;
@@ -938,7 +1122,7 @@ nbd_start_continue(struct spdk_nbd_start_ctx *ctx)
 	}
 
 #ifdef NBD_SET_TIMEOUT
-	rc = ioctl(ctx->nbd->dev_fd, NBD_SET_TIMEOUT, NBD_IO_TIMEOUT_S);
+	rc = ioctl(nbd->dev_fd, NBD_SET_TIMEOUT, NBD_IO_TIMEOUT_S);
 	if (rc == -1) {
 		SPDK_ERRLOG("ioctl(NBD_SET_TIMEOUT) failed: %s\n", spdk_strerror(errno));
 		rc = -errno;
@@ -949,18 +1133,26 @@ nbd_start_continue(struct spdk_nbd_start_ctx *ctx)
 #endif
 
 #ifdef NBD_FLAG_SEND_FLUSH
-	if (spdk_bdev_io_type_supported(ctx->nbd->bdev, SPDK_BDEV_IO_TYPE_FLUSH)) {
+	if (spdk_bdev_io_type_supported(nbd->bdev, SPDK_BDEV_IO_TYPE_FLUSH)) {
 		nbd_flags |= NBD_FLAG_SEND_FLUSH;
 	}
 #endif
 #ifdef NBD_FLAG_SEND_TRIM
-	if (spdk_bdev_io_type_supported(ctx->nbd->bdev, SPDK_BDEV_IO_TYPE_UNMAP)) {
+	if (spdk_bdev_io_type_supported(nbd->bdev, SPDK_BDEV_IO_TYPE_UNMAP)) {
 		nbd_flags |= NBD_FLAG_SEND_TRIM;
 	}
 #endif
+#ifdef NBD_FLAG_CAN_MULTI_CONN
+	/* Each connection completes its own requests, a flush on one of them only covers the
+	 * writes completed before it was received, which is what the kernel expects.
+	 */
+	if (nbd->num_conns > 1) {
+		nbd_flags |= NBD_FLAG_CAN_MULTI_CONN;
+	}
+#endif
 
 	if (nbd_flags) {
-		rc = ioctl(ctx->nbd->dev_fd, NBD_SET_FLAGS, nbd_flags);
+		rc = ioctl(nbd->dev_fd, NBD_SET_FLAGS, nbd_flags);
 		if (rc == -1) {
 			SPDK_ERRLOG("ioctl(NBD_SET_FLAGS, 0x%lx) failed: %s\n", nbd_flags, spdk_strerror(errno));
 			rc = -errno;
@@ -968,10 +1160,15 @@ nbd_start_continue(struct spdk_nbd_start_ctx *ctx)
 		}
 	}
 
-	ctx->nbd->has_nbd_pthread = true;
+	rc = nbd_create_conn_threads(nbd);
+	if (rc != 0) {
+		goto err;
+	}
+
+	nbd->has_nbd_pthread = true;
 	rc = pthread_create(&tid, NULL, nbd_start_kernel, ctx);
 	if (rc != 0) {
-		ctx->nbd->has_nbd_pthread = false;
+		nbd->has_nbd_pthread = false;
 		SPDK_ERRLOG("could not create thread: %s\n", spdk_strerror(rc));
 		rc = -rc;
 		goto err;
@@ -984,16 +1181,15 @@ nbd_start_continue(struct spdk_nbd_start_ctx *ctx)
 		goto err;
 	}
 
-	if (spdk_interrupt_mode_is_enabled()) {
-		ctx->nbd->intr = SPDK_INTERRUPT_REGISTER(ctx->nbd->spdk_sp_fd, nbd_poll, ctx->nbd);
+	nbd->num_conns_active = nbd->num_conns;
+	nbd_conn_start(&nbd->conns[0]);
+	for (i = 1; i < nbd->num_conns; i++) {
+		spdk_thread_send_msg(nbd->conns[i].thread, nbd_conn_start, &nbd->conns[i]);
 	}
-
-	ctx->nbd->nbd_poller = SPDK_POLLER_REGISTER(nbd_poll, ctx->nbd, 0);
-	spdk_poller_register_interrupt(ctx->nbd->nbd_poller, nbd_poller_set_interrupt_mode, ctx->nbd);
 	return;
 
 err:
-	_nbd_stop(ctx->nbd);
+	_nbd_stop(nbd);
 	if (ctx->cb_fn) {
 		ctx->cb_fn(ctx->cb_arg, NULL, rc);
 	}
@@ -1004,44 +1200,50 @@ static int
 nbd_enable_kernel(void *arg)
 {
 	struct spdk_nbd_start_ctx *ctx = arg;
+	struct spdk_nbd_disk *nbd = ctx->nbd;
 	int rc;
 
-	/* Declare device setup by this process */
-	rc = ioctl(ctx->nbd->dev_fd, NBD_SET_SOCK, ctx->nbd->kernel_sp_fd);
+	/* Declare device setup by this process, handing the kernel one socket per connection */
+	while (nbd->num_conns_set < nbd->num_conns) {
+		rc = ioctl(nbd->dev_fd, NBD_SET_SOCK, nbd->conns[nbd->num_conns_set].kernel_sp_fd);
+		if (rc == 0) {
+			nbd->num_conns_set++;
+			continue;
+		}
 
-	if (rc) {
 		if (errno == EBUSY) {
-			if (ctx->nbd->retry_poller == NULL) {
-				ctx->nbd->retry_count = NBD_START_BUSY_WAITING_MS * 1000ULL / NBD_BUSY_POLLING_INTERVAL_US;
-				ctx->nbd->retry_poller = SPDK_POLLER_REGISTER(nbd_enable_kernel, ctx,
-							 NBD_BUSY_POLLING_INTERVAL_US);
+			if (nbd->retry_poller == NULL) {
+				nbd->retry_count = NBD_START_BUSY_WAITING_MS * 1000ULL / NBD_BUSY_POLLING_INTERVAL_US;
+				nbd->retry_poller = SPDK_POLLER_REGISTER(nbd_enable_kernel, ctx,
+						    NBD_BUSY_POLLING_INTERVAL_US);
 				return SPDK_POLLER_BUSY;
-			} else if (ctx->nbd->retry_count-- > 0) {
+			} else if (nbd->retry_count-- > 0) {
 				/* Repeatedly unregister and register retry poller to avoid scan-build error */
-				spdk_poller_unregister(&ctx->nbd->retry_poller);
-				ctx->nbd->retry_poller = SPDK_POLLER_REGISTER(nbd_enable_kernel, ctx,
-							 NBD_BUSY_POLLING_INTERVAL_US);
+				spdk_poller_unregister(&nbd->retry_poller);
+				nbd->retry_poller = SPDK_POLLER_REGISTER(nbd_enable_kernel, ctx,
+						    NBD_BUSY_POLLING_INTERVAL_US);
 				return SPDK_POLLER_BUSY;
 			}
 		}
 
+		rc = -errno;
 		SPDK_ERRLOG("ioctl(NBD_SET_SOCK) failed: %s\n", spdk_strerror(errno));
-		if (ctx->nbd->retry_poller) {
-			spdk_poller_unregister(&ctx->nbd->retry_poller);
+		if (nbd->retry_poller) {
+			spdk_poller_unregister(&nbd->retry_poller);
 		}
 
-		_nbd_stop(ctx->nbd);
+		_nbd_stop(nbd);
 
 		if (ctx->cb_fn) {
-			ctx->cb_fn(ctx->cb_arg, NULL, -errno);
+			ctx->cb_fn(ctx->cb_arg, NULL, rc);
 		}
 
 		free(ctx);
 		return SPDK_POLLER_BUSY;
 	}
 
-	if (ctx->nbd->retry_poller) {
-		spdk_poller_unregister(&ctx->nbd->retry_poller);
+	if (nbd->retry_poller) {
+		spdk_poller_unregister(&nbd->retry_poller);
 	}
 
 	nbd_start_continue(ctx);
@@ -1050,14 +1252,77 @@ nbd_enable_kernel(void *arg)
 }
 
 void
-spdk_nbd_start(const char *bdev_name, const char *nbd_path,
-	       spdk_nbd_start_cb cb_fn, void *cb_arg)
+spdk_nbd_start_opts_init(struct spdk_nbd_start_opts *opts, size_t opts_size)
 {
+	if (!opts) {
+		SPDK_ERRLOG("opts should not be NULL\n");
+		return;
+	}
+
+	if (!opts_size) {
+		SPDK_ERRLOG("opts_size should not be zero\n");
+		return;
+	}
+
+	memset(opts, 0, opts_size);
+	opts->size = opts_size;
+
+#define FIELD_OK(field) \
+	offsetof(struct spdk_nbd_start_opts, field) + sizeof(opts->field) <= opts_size
+
+#define SET_FIELD(field, value) \
+	if (FIELD_OK(field)) { \
+		opts->field = value; \
+	} \
+
+	SET_FIELD(num_connections, 1);
+
+#undef FIELD_OK
+#undef SET_FIELD
+}
+
+static void
+nbd_start_opts_copy(struct spdk_nbd_start_opts *opts, const struct spdk_nbd_start_opts *opts_src)
+{
+	spdk_nbd_start_opts_init(opts, sizeof(*opts));
+	if (opts_src == NULL) {
+		return;
+	}
+
+#define FIELD_OK(field) \
+	offsetof(struct spdk_nbd_start_opts, field) + sizeof(opts->field) <= opts_src->size
+
+#define SET_FIELD(field) \
+	if (FIELD_OK(field)) { \
+		opts->field = opts_src->field; \
+	} \
+
+	SET_FIELD(num_connections);
+
+#undef FIELD_OK
+#undef SET_FIELD
+}
+
+void
+spdk_nbd_start_ext(const char *bdev_name, const char *nbd_path,
+		   const struct spdk_nbd_start_opts *user_opts,
+		   spdk_nbd_start_cb cb_fn, void *cb_arg)
+{
+	struct spdk_nbd_start_opts	opts;
 	struct spdk_nbd_start_ctx	*ctx = NULL;
 	struct spdk_nbd_disk		*nbd = NULL;
+	struct nbd_conn			*conn;
 	struct spdk_bdev		*bdev;
 	int				rc;
 	int				sp[2];
+	uint32_t			i;
+
+	nbd_start_opts_copy(&opts, user_opts);
+	if (opts.num_connections == 0 || opts.num_connections > NBD_MAX_CONNECTIONS) {
+		SPDK_ERRLOG("num_connections must be between 1 and %u\n", NBD_MAX_CONNECTIONS);
+		rc = -EINVAL;
+		goto err;
+	}
 
 	nbd = calloc(1, sizeof(*nbd));
 	if (nbd == NULL) {
@@ -1066,8 +1331,25 @@ spdk_nbd_start(const char *bdev_name, const char *nbd_path,
 	}
 
 	nbd->dev_fd = -1;
-	nbd->spdk_sp_fd = -1;
-	nbd->kernel_sp_fd = -1;
+	nbd->thread = spdk_get_thread();
+
+	nbd->conns = calloc(opts.num_connections, sizeof(*nbd->conns));
+	if (nbd->conns == NULL) {
+		rc = -ENOMEM;
+		goto err;
+	}
+
+	nbd->num_conns = opts.num_connections;
+	for (i = 0; i < nbd->num_conns; i++) {
+		conn = &nbd->conns[i];
+		conn->nbd = nbd;
+		conn->idx = i;
+		conn->spdk_sp_fd = -1;
+		conn->kernel_sp_fd = -1;
+		TAILQ_INIT(&conn->received_io_list);
+		TAILQ_INIT(&conn->executed_io_list);
+		TAILQ_INIT(&conn->processing_io_list);
+	}
 
 	ctx = calloc(1, sizeof(*ctx));
 	if (ctx == NULL) {
@@ -1089,18 +1371,20 @@ spdk_nbd_start(const char *bdev_name, const char *nbd_path,
 	bdev = spdk_bdev_desc_get_bdev(nbd->bdev_desc);
 	nbd->bdev = bdev;
 
-	nbd->ch = spdk_bdev_get_io_channel(nbd->bdev_desc);
 	nbd->buf_align = spdk_max(spdk_bdev_get_buf_align(bdev), 64);
 
-	rc = socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sp);
-	if (rc != 0) {
-		SPDK_ERRLOG("socketpair failed\n");
-		rc = -errno;
-		goto err;
+	for (i = 0; i < nbd->num_conns; i++) {
+		rc = socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sp);
+		if (rc != 0) {
+			SPDK_ERRLOG("socketpair failed\n");
+			rc = -errno;
+			goto err;
+		}
+
+		nbd->conns[i].spdk_sp_fd = sp[0];
+		nbd->conns[i].kernel_sp_fd = sp[1];
 	}
 
-	nbd->spdk_sp_fd = sp[0];
-	nbd->kernel_sp_fd = sp[1];
 	nbd->nbd_path = strdup(nbd_path);
 	if (!nbd->nbd_path) {
 		SPDK_ERRLOG("strdup allocation failure\n");
@@ -1108,10 +1392,6 @@ spdk_nbd_start(const char *bdev_name, const char *nbd_path,
 		goto err;
 	}
 
-	TAILQ_INIT(&nbd->received_io_list);
-	TAILQ_INIT(&nbd->executed_io_list);
-	TAILQ_INIT(&nbd->processing_io_list);
-
 	/* Add nbd_disk to the end of disk list */
 	rc = nbd_disk_register(ctx->nbd);
 	if (rc != 0) {
@@ -1125,8 +1405,8 @@ spdk_nbd_start(const char *bdev_name, const char *nbd_path,
 		goto err;
 	}
 
-	SPDK_INFOLOG(nbd, "Enabling kernel access to bdev %s via %s\n",
-		     bdev_name, nbd_path);
+	SPDK_INFOLOG(nbd, "Enabling kernel access to bdev %s via %s over %u connection(s)\n",
+		     bdev_name, nbd_path, nbd->num_conns);
 
 	nbd_enable_kernel(ctx);
 	return;
@@ -1142,6 +1422,13 @@ err:
 	}
 }
 
+void
+spdk_nbd_start(const char *bdev_name, const char *nbd_path,
+	       spdk_nbd_start_cb cb_fn, void *cb_arg)
+{
+	spdk_nbd_start_ext(bdev_name, nbd_path, NULL, cb_fn, cb_arg);
+}
+
 const char *
 spdk_nbd_get_path(struct spdk_nbd_disk *nbd)
 {
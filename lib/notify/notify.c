@@ -20,8 +20,21 @@ struct spdk_notify_type {
 	TAILQ_ENTRY(spdk_notify_type) tailq;
 };
 
-static pthread_mutex_t g_events_lock = PTHREAD_MUTEX_INITIALIZER;
-static struct spdk_notify_event g_events[SPDK_NOTIFY_MAX_EVENTS];
+/*
+ * Events are sent without taking a lock. The sender claims an index by bumping g_events_head and
+ *  publishes the event by setting the sequence of its slot to NOTIFY_EVENT_SEQ(idx). The sequence
+ *  is odd while the slot is being written, so readers copy the event out and check the sequence
+ *  again to detect an event overwritten in the meantime.
+ */
+#define NOTIFY_EVENT_SEQ(idx) (2 * ((idx) + 1))
+
+struct notify_event_slot {
+	uint64_t		seq;
+	struct spdk_notify_event event;
+};
+
+static pthread_mutex_t g_types_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct notify_event_slot g_events[SPDK_NOTIFY_MAX_EVENTS];
 static uint64_t g_events_head;
 
 static TAILQ_HEAD(, spdk_notify_type) g_notify_types = TAILQ_HEAD_INITIALIZER(g_notify_types);
@@ -39,7 +52,7 @@ spdk_notify_type_register(const char *type)
 		return NULL;
 	}
 
-	pthread_mutex_lock(&g_events_lock);
+	pthread_mutex_lock(&g_types_lock);
 	TAILQ_FOREACH(it, &g_notify_types, tailq) {
 		if (strcmp(type, it->name) == 0) {
 			SPDK_NOTICELOG("Notification type '%s' already registered.\n", type);
@@ -56,7 +69,7 @@ spdk_notify_type_register(const char *type)
 	TAILQ_INSERT_TAIL(&g_notify_types, it, tailq);
 
 out:
-	pthread_mutex_unlock(&g_events_lock);
+	pthread_mutex_unlock(&g_types_lock);
 	return it;
 }
 
@@ -72,51 +85,78 @@ spdk_notify_foreach_type(spdk_notify_foreach_type_cb cb, void *ctx)
 {
 	struct spdk_notify_type *it;
 
-	pthread_mutex_lock(&g_events_lock);
+	pthread_mutex_lock(&g_types_lock);
 	TAILQ_FOREACH(it, &g_notify_types, tailq) {
 		if (cb(it, ctx)) {
 			break;
 		}
 	}
-	pthread_mutex_unlock(&g_events_lock);
+	pthread_mutex_unlock(&g_types_lock);
 }
 
 uint64_t
 spdk_notify_send(const char *type, const char *ctx)
 {
 	uint64_t head;
-	struct spdk_notify_event *ev;
+	struct notify_event_slot *slot;
 
-	pthread_mutex_lock(&g_events_lock);
-	head = g_events_head;
-	g_events_head++;
+	head = __atomic_fetch_add(&g_events_head, 1, __ATOMIC_RELAXED);
+	slot = &g_events[head % SPDK_NOTIFY_MAX_EVENTS];
 
-	ev = &g_events[head % SPDK_NOTIFY_MAX_EVENTS];
-	spdk_strcpy_pad(ev->type, type, sizeof(ev->type), '\0');
-	spdk_strcpy_pad(ev->ctx, ctx, sizeof(ev->ctx), '\0');
-	pthread_mutex_unlock(&g_events_lock);
+	__atomic_store_n(&slot->seq, NOTIFY_EVENT_SEQ(head) - 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	spdk_strcpy_pad(slot->event.type, type, sizeof(slot->event.type), '\0');
+	spdk_strcpy_pad(slot->event.ctx, ctx, sizeof(slot->event.ctx), '\0');
+
+	__atomic_store_n(&slot->seq, NOTIFY_EVENT_SEQ(head), __ATOMIC_RELEASE);
 
 	return head;
 }
 
+uint64_t
+spdk_notify_get_event_count(void)
+{
+	return __atomic_load_n(&g_events_head, __ATOMIC_ACQUIRE);
+}
+
 uint64_t
 spdk_notify_foreach_event(uint64_t start_idx, uint64_t max,
 			  spdk_notify_foreach_event_cb cb_fn, void *ctx)
 {
-	uint64_t i;
+	struct notify_event_slot *slot;
+	struct spdk_notify_event event;
+	uint64_t head, seq, i = 0;
 
-	pthread_mutex_lock(&g_events_lock);
+	head = __atomic_load_n(&g_events_head, __ATOMIC_ACQUIRE);
 
-	if (g_events_head > SPDK_NOTIFY_MAX_EVENTS && start_idx < g_events_head - SPDK_NOTIFY_MAX_EVENTS) {
-		start_idx = g_events_head - SPDK_NOTIFY_MAX_EVENTS;
+	if (head > SPDK_NOTIFY_MAX_EVENTS && start_idx < head - SPDK_NOTIFY_MAX_EVENTS) {
+		start_idx = head - SPDK_NOTIFY_MAX_EVENTS;
 	}
 
-	for (i = 0; start_idx < g_events_head && i < max; start_idx++, i++) {
-		if (cb_fn(start_idx, &g_events[start_idx % SPDK_NOTIFY_MAX_EVENTS], ctx)) {
+	for (; start_idx < head && i < max; start_idx++) {
+		slot = &g_events[start_idx % SPDK_NOTIFY_MAX_EVENTS];
+
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		if (seq < NOTIFY_EVENT_SEQ(start_idx)) {
+			/* Not published yet, the events after it can't be returned in order */
+			break;
+		} else if (seq != NOTIFY_EVENT_SEQ(start_idx)) {
+			/* Already overwritten by a newer event */
+			continue;
+		}
+
+		memcpy(&event, &slot->event, sizeof(event));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) {
+			continue;
+		}
+
+		if (cb_fn(start_idx, &event, ctx)) {
 			break;
 		}
+		i++;
 	}
-	pthread_mutex_unlock(&g_events_lock);
 
 	return i;
 }
@@ -8,6 +8,7 @@
 #include "spdk/string.h"
 #include "spdk/notify.h"
 #include "spdk/env.h"
+#include "spdk/thread.h"
 #include "spdk/util.h"
 
 #include "spdk/log.h"
@@ -40,56 +41,207 @@ rpc_notify_get_types(struct spdk_jsonrpc_request *request,
 }
 SPDK_RPC_REGISTER("notify_get_types", rpc_notify_get_types, SPDK_RPC_RUNTIME)
 
+#define RPC_NOTIFY_MAX_TYPES		32
+#define RPC_NOTIFY_POLL_PERIOD_US	1000
+
+struct rpc_notify_types {
+	size_t num_types;
+	char *types[RPC_NOTIFY_MAX_TYPES];
+};
+
 struct rpc_notify_get_notifications {
 	uint64_t id;
 	uint64_t max;
+	struct rpc_notify_types types;
+	uint64_t timeout_ms;
 
+	struct spdk_jsonrpc_request *request;
 	struct spdk_json_write_ctx *w;
+	uint64_t count;
+	bool found;
+	uint64_t deadline;
+	TAILQ_ENTRY(rpc_notify_get_notifications) link;
 };
 
+/* Requests waiting for notifications, all of them handled on the RPC thread */
+static TAILQ_HEAD(, rpc_notify_get_notifications) g_pending_requests =
+	TAILQ_HEAD_INITIALIZER(g_pending_requests);
+static struct spdk_poller *g_pending_requests_poller;
+
+static int
+decode_rpc_notify_types(const struct spdk_json_val *val, void *out)
+{
+	struct rpc_notify_types *types = out;
+
+	return spdk_json_decode_array(val, spdk_json_decode_string, types->types,
+				      RPC_NOTIFY_MAX_TYPES, &types->num_types, sizeof(char *));
+}
+
 static const struct spdk_json_object_decoder rpc_notify_get_notifications_decoders[] = {
 	{"id", offsetof(struct rpc_notify_get_notifications, id), spdk_json_decode_uint64, true},
 	{"max", offsetof(struct rpc_notify_get_notifications, max), spdk_json_decode_uint64, true},
+	{"types", offsetof(struct rpc_notify_get_notifications, types), decode_rpc_notify_types, true},
+	{
+		"timeout_ms", offsetof(struct rpc_notify_get_notifications, timeout_ms),
+		spdk_json_decode_uint64, true
+	},
 };
 
+static void
+free_rpc_notify_get_notifications(struct rpc_notify_get_notifications *req)
+{
+	size_t i;
+
+	for (i = 0; i < req->types.num_types; i++) {
+		free(req->types.types[i]);
+	}
+	free(req);
+}
+
+static bool
+notify_type_subscribed(struct rpc_notify_get_notifications *req, const char *type)
+{
+	size_t i;
+
+	if (req->types.num_types == 0) {
+		return true;
+	}
+
+	for (i = 0; i < req->types.num_types; i++) {
+		if (strcmp(req->types.types[i], type) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
 
 static int
 notify_get_notifications_cb(uint64_t id, const struct spdk_notify_event *ev, void *ctx)
 {
 	struct rpc_notify_get_notifications *req = ctx;
 
+	if (req->count == req->max) {
+		return 1;
+	}
+
+	if (!notify_type_subscribed(req, ev->type)) {
+		return 0;
+	}
+
 	spdk_json_write_object_begin(req->w);
 	spdk_json_write_named_string(req->w, "type", ev->type);
 	spdk_json_write_named_string(req->w, "ctx", ev->ctx);
 	spdk_json_write_named_uint64(req->w, "id", id);
 	spdk_json_write_object_end(req->w);
+	req->count++;
+
+	return 0;
+}
+
+static void
+rpc_notify_send_notifications(struct rpc_notify_get_notifications *req)
+{
+	req->w = spdk_jsonrpc_begin_result(req->request);
+
+	spdk_json_write_array_begin(req->w);
+	spdk_notify_foreach_event(req->id, UINT64_MAX, notify_get_notifications_cb, req);
+	spdk_json_write_array_end(req->w);
+
+	spdk_jsonrpc_end_result(req->request, req->w);
+	free_rpc_notify_get_notifications(req);
+}
+
+static int
+notify_find_cb(uint64_t id, const struct spdk_notify_event *ev, void *ctx)
+{
+	struct rpc_notify_get_notifications *req = ctx;
+
+	if (notify_type_subscribed(req, ev->type)) {
+		req->found = true;
+		return 1;
+	}
+
+	/* Don't look at the events not subscribed to again */
+	req->id = id + 1;
 	return 0;
 }
 
+static bool
+rpc_notify_has_notifications(struct rpc_notify_get_notifications *req)
+{
+	req->found = false;
+	spdk_notify_foreach_event(req->id, UINT64_MAX, notify_find_cb, req);
+
+	return req->found;
+}
+
+static int
+rpc_notify_poll_pending_requests(void *ctx)
+{
+	struct rpc_notify_get_notifications *req, *tmp;
+	uint64_t now = spdk_get_ticks();
+	int rc = SPDK_POLLER_IDLE;
+
+	TAILQ_FOREACH_SAFE(req, &g_pending_requests, link, tmp) {
+		if (rpc_notify_has_notifications(req) || now >= req->deadline) {
+			TAILQ_REMOVE(&g_pending_requests, req, link);
+			rpc_notify_send_notifications(req);
+			rc = SPDK_POLLER_BUSY;
+		}
+	}
+
+	if (TAILQ_EMPTY(&g_pending_requests)) {
+		spdk_poller_unregister(&g_pending_requests_poller);
+	}
+
+	return rc;
+}
+
 static void
 rpc_notify_get_notifications(struct spdk_jsonrpc_request *request,
 			     const struct spdk_json_val *params)
 {
-	struct rpc_notify_get_notifications req = {0, UINT64_MAX};
+	struct rpc_notify_get_notifications *req;
+
+	req = calloc(1, sizeof(*req));
+	if (req == NULL) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 spdk_strerror(ENOMEM));
+		return;
+	}
+
+	req->max = UINT64_MAX;
+	req->request = request;
 
 	if (params &&
 	    spdk_json_decode_object(params, rpc_notify_get_notifications_decoders,
-				    SPDK_COUNTOF(rpc_notify_get_notifications_decoders), &req)) {
+				    SPDK_COUNTOF(rpc_notify_get_notifications_decoders), req)) {
 		SPDK_DEBUGLOG(notify_rpc, "spdk_json_decode_object failed\n");
 
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
 						 spdk_strerror(EINVAL));
+		free_rpc_notify_get_notifications(req);
 		return;
 	}
 
+	if (req->timeout_ms == 0 || req->max == 0 || rpc_notify_has_notifications(req)) {
+		rpc_notify_send_notifications(req);
+		return;
+	}
 
-	req.w = spdk_jsonrpc_begin_result(request);
-
-	spdk_json_write_array_begin(req.w);
-	spdk_notify_foreach_event(req.id, req.max, notify_get_notifications_cb, &req);
-	spdk_json_write_array_end(req.w);
+	/* Wait for a notification of a subscribed type, or for the timeout */
+	if (g_pending_requests_poller == NULL) {
+		g_pending_requests_poller = SPDK_POLLER_REGISTER(rpc_notify_poll_pending_requests, NULL,
+					    RPC_NOTIFY_POLL_PERIOD_US);
+		if (g_pending_requests_poller == NULL) {
+			rpc_notify_send_notifications(req);
+			return;
+		}
+	}
 
-	spdk_jsonrpc_end_result(request, req.w);
+	req->deadline = spdk_get_ticks() + req->timeout_ms * spdk_get_ticks_hz() / SPDK_SEC_TO_MSEC;
+	TAILQ_INSERT_TAIL(&g_pending_requests, req, link);
 }
 SPDK_RPC_REGISTER("notify_get_notifications", rpc_notify_get_notifications, SPDK_RPC_RUNTIME)
 
@@ -307,6 +307,7 @@ spdk_nvme_ctrlr_get_default_io_qpair_opts(struct spdk_nvme_ctrlr *ctrlr,
 	SET_FIELD(create_only, false);
 	SET_FIELD(async_mode, false);
 	SET_FIELD(disable_pcie_sgl_merge, false);
+	SET_FIELD(io_queue_child_requests, 0);
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -342,12 +343,13 @@ nvme_ctrlr_io_qpair_opts_copy(struct spdk_nvme_io_qpair_opts *dst,
 	SET_FIELD(create_only);
 	SET_FIELD(async_mode);
 	SET_FIELD(disable_pcie_sgl_merge);
+	SET_FIELD(io_queue_child_requests);
 
 	dst->opts_size = opts_size_src;
 
 	/* You should not remove this statement, but need to update the assert statement
 	 * if you add a new field, and also add a corresponding SET_FIELD statement */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_io_qpair_opts) == 80, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_io_qpair_opts) == 88, "Incorrect size");
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -397,6 +399,14 @@ nvme_ctrlr_create_io_qpair(struct spdk_nvme_ctrlr *ctrlr,
 		return NULL;
 	}
 
+	if (opts->io_queue_child_requests != 0 &&
+	    nvme_qpair_init_child_requests(qpair, opts->io_queue_child_requests) != 0) {
+		nvme_transport_ctrlr_delete_io_qpair(ctrlr, qpair);
+		spdk_nvme_ctrlr_free_qid(ctrlr, qid);
+		nvme_ctrlr_unlock(ctrlr);
+		return NULL;
+	}
+
 	TAILQ_INSERT_TAIL(&ctrlr->active_io_qpairs, qpair, tailq);
 
 	nvme_ctrlr_proc_add_io_qpair(qpair);
@@ -2608,14 +2618,54 @@ nvme_ctrlr_identify_active_ns(struct spdk_nvme_ctrlr *ctrlr)
 	return 0;
 }
 
+/*
+ * Submit identify namespace commands for the next active namespaces, keeping
+ * up to NVME_MAX_IDENTIFY_NS_OUTSTANDING of them outstanding, but no more than
+ * a quarter of the admin queue.
+ */
+static int
+nvme_ctrlr_identify_namespaces_submit(struct spdk_nvme_ctrlr *ctrlr)
+{
+	uint32_t max_outstanding, nsid;
+	struct spdk_nvme_ns *ns;
+	int rc;
+
+	max_outstanding = spdk_min(NVME_MAX_IDENTIFY_NS_OUTSTANDING, ctrlr->opts.admin_queue_size / 4);
+	max_outstanding = spdk_max(max_outstanding, 1);
+
+	while (ctrlr->identify_ns_next != 0 && ctrlr->identify_ns_outstanding < max_outstanding) {
+		nsid = ctrlr->identify_ns_next;
+		ns = spdk_nvme_ctrlr_get_ns(ctrlr, nsid);
+		if (ns == NULL) {
+			ctrlr->identify_ns_next = 0;
+			break;
+		}
+		ns->ctrlr = ctrlr;
+		ns->id = nsid;
+
+		ctrlr->identify_ns_next = spdk_nvme_ctrlr_get_next_active_ns(ctrlr, nsid);
+		/* The completion may be called before the submission returns */
+		ctrlr->identify_ns_outstanding++;
+		rc = nvme_ctrlr_identify_ns_async(ns);
+		if (rc) {
+			ctrlr->identify_ns_outstanding--;
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
 static void
 nvme_ctrlr_identify_ns_async_done(void *arg, const struct spdk_nvme_cpl *cpl)
 {
 	struct spdk_nvme_ns *ns = (struct spdk_nvme_ns *)arg;
 	struct spdk_nvme_ctrlr *ctrlr = ns->ctrlr;
-	uint32_t nsid;
 	int rc;
 
+	assert(ctrlr->identify_ns_outstanding > 0);
+	ctrlr->identify_ns_outstanding--;
+
 	if (spdk_nvme_cpl_is_error(cpl)) {
 		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
 		return;
@@ -2623,20 +2673,21 @@ nvme_ctrlr_identify_ns_async_done(void *arg, const struct spdk_nvme_cpl *cpl)
 
 	nvme_ns_set_identify_data(ns);
 
-	/* move on to the next active NS */
-	nsid = spdk_nvme_ctrlr_get_next_active_ns(ctrlr, ns->id);
-	ns = spdk_nvme_ctrlr_get_ns(ctrlr, nsid);
-	if (ns == NULL) {
-		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_IDENTIFY_ID_DESCS,
-				     ctrlr->opts.admin_timeout_ms);
+	/* Another identify namespace command already failed */
+	if (ctrlr->state == NVME_CTRLR_STATE_ERROR) {
 		return;
 	}
-	ns->ctrlr = ctrlr;
-	ns->id = nsid;
 
-	rc = nvme_ctrlr_identify_ns_async(ns);
+	/* move on to the next active NS */
+	rc = nvme_ctrlr_identify_namespaces_submit(ctrlr);
 	if (rc) {
 		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
+		return;
+	}
+
+	if (ctrlr->identify_ns_outstanding == 0 && ctrlr->identify_ns_next == 0) {
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_IDENTIFY_ID_DESCS,
+				     ctrlr->opts.admin_timeout_ms);
 	}
 }
 
@@ -2658,23 +2709,18 @@ nvme_ctrlr_identify_ns_async(struct spdk_nvme_ns *ns)
 static int
 nvme_ctrlr_identify_namespaces(struct spdk_nvme_ctrlr *ctrlr)
 {
-	uint32_t nsid;
-	struct spdk_nvme_ns *ns;
 	int rc;
 
-	nsid = spdk_nvme_ctrlr_get_first_active_ns(ctrlr);
-	ns = spdk_nvme_ctrlr_get_ns(ctrlr, nsid);
-	if (ns == NULL) {
+	ctrlr->identify_ns_next = spdk_nvme_ctrlr_get_first_active_ns(ctrlr);
+	ctrlr->identify_ns_outstanding = 0;
+	if (spdk_nvme_ctrlr_get_ns(ctrlr, ctrlr->identify_ns_next) == NULL) {
 		/* No active NS, move on to the next state */
 		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_IDENTIFY_ID_DESCS,
 				     ctrlr->opts.admin_timeout_ms);
 		return 0;
 	}
 
-	ns->ctrlr = ctrlr;
-	ns->id = nsid;
-
-	rc = nvme_ctrlr_identify_ns_async(ns);
+	rc = nvme_ctrlr_identify_namespaces_submit(ctrlr);
 	if (rc) {
 		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
 	}
@@ -157,6 +157,12 @@ extern struct spdk_nvme_transport_opts g_spdk_nvme_transport_opts;
 /* Maximum log page size to fetch for AERs. */
 #define NVME_MAX_AER_LOG_SIZE		(4096)
 
+/*
+ * Maximum number of identify namespace commands outstanding at once during
+ * controller initialization.
+ */
+#define NVME_MAX_IDENTIFY_NS_OUTSTANDING	(8)
+
 /*
  * NVME_MAX_IO_QUEUES in nvme_spec.h defines the 64K spec-limit, but this
  *  define specifies the maximum number of queues this driver will actually
@@ -485,6 +491,9 @@ struct spdk_nvme_qpair {
 	/* The user is destroying qpair */
 	uint8_t					destroy_in_progress: 1;
 
+	/* Submissions are batched until spdk_nvme_qpair_submit_batch_end() is called. */
+	uint8_t					in_submit_batch: 1;
+
 	/* Number of IO outstanding at transport level */
 	uint16_t				queue_depth;
 
@@ -528,6 +537,14 @@ struct spdk_nvme_qpair {
 
 	void					*req_buf;
 
+	/* Pool of the child requests of split I/O, see io_queue_child_requests */
+	STAILQ_HEAD(, nvme_request)		free_child_req;
+	void					*child_req_buf;
+	size_t					child_req_buf_size;
+
+	/* Number of request allocations that failed because the pool was empty */
+	uint64_t				num_req_alloc_failures;
+
 	/* In-band authentication state */
 	struct nvme_auth			auth;
 };
@@ -545,6 +562,14 @@ struct spdk_nvme_poll_group {
 		spdk_nvme_poll_group_interrupt_cb	cb_fn;
 		void					*cb_ctx;
 	} interrupt;
+	struct {
+		/* Level triggered while the poll group is polled instead of waiting for interrupts. */
+		int					fd;
+		uint32_t				idle_polls;
+		uint32_t				idle_count;
+		int64_t					num_completions;
+		bool					polling;
+	} adaptive;
 };
 
 struct spdk_nvme_transport_poll_group {
@@ -1100,6 +1125,10 @@ struct spdk_nvme_ctrlr {
 	/* scratchpad pointer that can be used to send data between two NVME_CTRLR_STATEs */
 	void				*tmp_ptr;
 
+	/* Next namespace to identify in NVME_CTRLR_STATE_IDENTIFY_NS, 0 when all are submitted */
+	uint32_t			identify_ns_next;
+	uint32_t			identify_ns_outstanding;
+
 	/* maximum zone append size in bytes */
 	uint32_t			max_zone_append_size;
 
@@ -1337,6 +1366,7 @@ int nvme_qpair_init(struct spdk_nvme_qpair *qpair, uint16_t id,
 		    struct spdk_nvme_ctrlr *ctrlr,
 		    enum spdk_nvme_qprio qprio,
 		    uint32_t num_requests, bool async);
+int	nvme_qpair_init_child_requests(struct spdk_nvme_qpair *qpair, uint32_t num_requests);
 void	nvme_qpair_deinit(struct spdk_nvme_qpair *qpair);
 void	nvme_qpair_complete_error_reqs(struct spdk_nvme_qpair *qpair);
 int	nvme_qpair_submit_request(struct spdk_nvme_qpair *qpair,
@@ -1432,6 +1462,7 @@ nvme_allocate_request(struct spdk_nvme_qpair *qpair,
 
 	req = STAILQ_FIRST(&qpair->free_req);
 	if (req == NULL) {
+		qpair->num_req_alloc_failures++;
 		return req;
 	}
 
@@ -1443,6 +1474,33 @@ nvme_allocate_request(struct spdk_nvme_qpair *qpair,
 	return req;
 }
 
+static inline struct nvme_request *
+nvme_allocate_child_request(struct spdk_nvme_qpair *qpair,
+			    const struct nvme_payload *payload, uint32_t payload_size, uint32_t md_size,
+			    spdk_nvme_cmd_cb cb_fn, void *cb_arg)
+{
+	struct nvme_request *req;
+
+	req = STAILQ_FIRST(&qpair->free_child_req);
+	if (req == NULL) {
+		return nvme_allocate_request(qpair, payload, payload_size, md_size, cb_fn, cb_arg);
+	}
+
+	STAILQ_REMOVE_HEAD(&qpair->free_child_req, stailq);
+	qpair->num_outstanding_reqs++;
+
+	NVME_INIT_REQUEST(req, cb_fn, cb_arg, *payload, payload_size, md_size);
+
+	return req;
+}
+
+static inline bool
+nvme_request_is_child_pool(struct spdk_nvme_qpair *qpair, struct nvme_request *req)
+{
+	/* Also false if the qpair has no child pool, child_req_buf_size is 0 then. */
+	return (uintptr_t)req - (uintptr_t)qpair->child_req_buf < qpair->child_req_buf_size;
+}
+
 static inline struct nvme_request *
 nvme_allocate_request_contig(struct spdk_nvme_qpair *qpair,
 			     void *buffer, uint32_t payload_size,
@@ -1476,7 +1534,11 @@ _nvme_free_request(struct nvme_request *req, struct spdk_nvme_qpair *qpair)
 	 * saved only for use with a FABRICS/CONNECT command.
 	 */
 	if (spdk_likely(qpair->reserved_req != req)) {
-		STAILQ_INSERT_HEAD(&qpair->free_req, req, stailq);
+		if (spdk_unlikely(nvme_request_is_child_pool(qpair, req))) {
+			STAILQ_INSERT_HEAD(&qpair->free_child_req, req, stailq);
+		} else {
+			STAILQ_INSERT_HEAD(&qpair->free_req, req, stailq);
+		}
 
 		assert(qpair->num_outstanding_reqs > 0);
 		qpair->num_outstanding_reqs--;
@@ -1711,6 +1773,7 @@ int nvme_transport_ctrlr_get_memory_domains(const struct spdk_nvme_ctrlr *ctrlr,
 void nvme_transport_qpair_abort_reqs(struct spdk_nvme_qpair *qpair);
 int nvme_transport_qpair_reset(struct spdk_nvme_qpair *qpair);
 int nvme_transport_qpair_submit_request(struct spdk_nvme_qpair *qpair, struct nvme_request *req);
+void nvme_transport_qpair_submit_batch_end(struct spdk_nvme_qpair *qpair);
 int nvme_transport_qpair_get_fd(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_qpair *qpair,
 				struct spdk_event_handler_opts *opts);
 int32_t nvme_transport_qpair_process_completions(struct spdk_nvme_qpair *qpair,
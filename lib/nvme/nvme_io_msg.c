@@ -7,50 +7,77 @@
 #include "nvme_io_msg.h"
 
 #define SPDK_NVME_MSG_IO_PROCESS_SIZE 8
+/* Maximum number of messages handled by a single nvme_io_msg_process() call */
+#define SPDK_NVME_MSG_IO_PROCESS_MAX 128
 
 /**
- * Send message to IO queue.
+ * Send messages to IO queue.
  */
 int
-nvme_io_msg_send(struct spdk_nvme_ctrlr *ctrlr, uint32_t nsid, spdk_nvme_io_msg_fn fn,
-		 void *arg)
+nvme_io_msg_send_batch(struct spdk_nvme_ctrlr *ctrlr, uint32_t nsid, spdk_nvme_io_msg_fn fn,
+		       void **args, uint32_t count)
 {
+	struct spdk_nvme_io_msg *ios[SPDK_NVME_MSG_IO_SEND_BATCH_MAX];
+	uint32_t i;
 	int rc;
-	struct spdk_nvme_io_msg *io;
 
-	/* Protect requests ring against preemptive producers */
-	pthread_mutex_lock(&ctrlr->external_io_msgs_lock);
+	if (count == 0 || count > SPDK_NVME_MSG_IO_SEND_BATCH_MAX) {
+		return -EINVAL;
+	}
 
-	io = (struct spdk_nvme_io_msg *)calloc(1, sizeof(struct spdk_nvme_io_msg));
-	if (!io) {
-		SPDK_ERRLOG("IO msg allocation failed.");
-		pthread_mutex_unlock(&ctrlr->external_io_msgs_lock);
-		return -ENOMEM;
+	for (i = 0; i < count; i++) {
+		ios[i] = (struct spdk_nvme_io_msg *)calloc(1, sizeof(struct spdk_nvme_io_msg));
+		if (!ios[i]) {
+			SPDK_ERRLOG("IO msg allocation failed.");
+			rc = -ENOMEM;
+			goto error;
+		}
+
+		ios[i]->ctrlr = ctrlr;
+		ios[i]->nsid = nsid;
+		ios[i]->fn = fn;
+		ios[i]->arg = args[i];
 	}
 
-	io->ctrlr = ctrlr;
-	io->nsid = nsid;
-	io->fn = fn;
-	io->arg = arg;
+	/* Protect requests ring against preemptive producers. The messages are enqueued
+	 * all at once, so that they are handled in order and by as few consumer polls as possible.
+	 */
+	pthread_mutex_lock(&ctrlr->external_io_msgs_lock);
 
-	rc = spdk_ring_enqueue(ctrlr->external_io_msgs, (void **)&io, 1, NULL);
-	if (rc != 1) {
+	rc = spdk_ring_enqueue(ctrlr->external_io_msgs, (void **)ios, count, NULL);
+	if (rc != (int)count) {
 		assert(false);
-		free(io);
 		pthread_mutex_unlock(&ctrlr->external_io_msgs_lock);
-		return -ENOMEM;
+		rc = -ENOMEM;
+		goto error;
 	}
 
 	pthread_mutex_unlock(&ctrlr->external_io_msgs_lock);
 
 	return 0;
+
+error:
+	while (i > 0) {
+		free(ios[--i]);
+	}
+	return rc;
+}
+
+/**
+ * Send message to IO queue.
+ */
+int
+nvme_io_msg_send(struct spdk_nvme_ctrlr *ctrlr, uint32_t nsid, spdk_nvme_io_msg_fn fn,
+		 void *arg)
+{
+	return nvme_io_msg_send_batch(ctrlr, nsid, fn, &arg, 1);
 }
 
 int
 nvme_io_msg_process(struct spdk_nvme_ctrlr *ctrlr)
 {
 	int i;
-	int count;
+	int count, total = 0;
 	struct spdk_nvme_io_msg *io;
 	void *requests[SPDK_NVME_MSG_IO_PROCESS_SIZE];
 
@@ -70,22 +97,27 @@ nvme_io_msg_process(struct spdk_nvme_ctrlr *ctrlr)
 
 	spdk_nvme_qpair_process_completions(ctrlr->external_io_msgs_qpair, 0);
 
-	count = spdk_ring_dequeue(ctrlr->external_io_msgs, requests,
-				  SPDK_NVME_MSG_IO_PROCESS_SIZE);
-	if (count == 0) {
-		return 0;
-	}
+	/* The admin queue may be polled rarely, so drain the ring rather than handling a
+	 * single chunk of messages per call. The budget keeps a burst of messages from
+	 * delaying the admin completions and keep alive for too long.
+	 */
+	do {
+		count = spdk_ring_dequeue(ctrlr->external_io_msgs, requests,
+					  SPDK_NVME_MSG_IO_PROCESS_SIZE);
 
-	for (i = 0; i < count; i++) {
-		io = requests[i];
+		for (i = 0; i < count; i++) {
+			io = requests[i];
 
-		assert(io != NULL);
+			assert(io != NULL);
 
-		io->fn(io->ctrlr, io->nsid, io->arg);
-		free(io);
-	}
+			io->fn(io->ctrlr, io->nsid, io->arg);
+			free(io);
+		}
+
+		total += count;
+	} while (count == SPDK_NVME_MSG_IO_PROCESS_SIZE && total < SPDK_NVME_MSG_IO_PROCESS_MAX);
 
-	return count;
+	return total;
 }
 
 static bool
@@ -29,9 +29,31 @@ struct nvme_io_msg_producer {
 	STAILQ_ENTRY(nvme_io_msg_producer) link;
 };
 
+/* Maximum number of messages sent by a single nvme_io_msg_send_batch() call */
+#define SPDK_NVME_MSG_IO_SEND_BATCH_MAX 64
+
 int nvme_io_msg_send(struct spdk_nvme_ctrlr *ctrlr, uint32_t nsid, spdk_nvme_io_msg_fn fn,
 		     void *arg);
 
+/**
+ * Send several messages for the same namespace to the thread processing IO messages of the
+ * controller.
+ *
+ * The messages are enqueued at once, i.e. either all of them or none are sent, and they are
+ * executed in order. Allocation and locking costs are paid once per batch, which is meant for
+ * producers issuing a burst of commands, e.g. a log page read for each namespace.
+ *
+ * \param ctrlr Opaque handle to NVMe controller.
+ * \param nsid Namespace ID passed to each message function.
+ * \param fn Message function, called once per element of args.
+ * \param args Array of count arguments.
+ * \param count Number of messages, at most SPDK_NVME_MSG_IO_SEND_BATCH_MAX.
+ *
+ * \return 0 on success, -EINVAL if count is out of range, or -ENOMEM.
+ */
+int nvme_io_msg_send_batch(struct spdk_nvme_ctrlr *ctrlr, uint32_t nsid, spdk_nvme_io_msg_fn fn,
+			   void **args, uint32_t count);
+
 /**
  * Process IO message sent to controller from external module.
  *
@@ -8,8 +8,8 @@
 
 #include "nvme_internal.h"
 
-static inline struct nvme_request *_nvme_ns_cmd_rw(struct spdk_nvme_ns *ns,
-		struct spdk_nvme_qpair *qpair,
+static inline struct nvme_request *_nvme_ns_cmd_rw_req(struct spdk_nvme_ns *ns,
+		struct spdk_nvme_qpair *qpair, struct nvme_request *req,
 		const struct nvme_payload *payload, uint32_t payload_offset, uint32_t md_offset,
 		uint64_t lba, uint32_t lba_count, spdk_nvme_cmd_cb cb_fn,
 		void *cb_arg, uint32_t opc, uint32_t io_flags,
@@ -80,10 +80,19 @@ _nvme_add_child_request(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
 			uint32_t io_flags, uint16_t apptag_mask, uint16_t apptag, uint32_t cdw13,
 			struct nvme_request *parent, bool check_sgl, int *rc)
 {
+	uint32_t		sector_size = _nvme_get_host_buffer_sector_size(ns, io_flags);
 	struct nvme_request	*child;
 
-	child = _nvme_ns_cmd_rw(ns, qpair, payload, payload_offset, md_offset, lba, lba_count, cb_fn,
-				cb_arg, opc, io_flags, apptag_mask, apptag, cdw13, check_sgl, NULL, rc);
+	/* Children come from their own pool first, so that splitting doesn't starve new I/O. */
+	child = nvme_allocate_child_request(qpair, payload, lba_count * sector_size,
+					    lba_count * ns->md_size, cb_fn, cb_arg);
+	if (child == NULL) {
+		*rc = -ENOMEM;
+	} else {
+		child = _nvme_ns_cmd_rw_req(ns, qpair, child, payload, payload_offset, md_offset, lba,
+					    lba_count, cb_fn, cb_arg, opc, io_flags, apptag_mask, apptag,
+					    cdw13, check_sgl, NULL, rc);
+	}
 	if (child == NULL) {
 		nvme_request_free_children(parent);
 		nvme_free_request(parent);
@@ -430,27 +439,16 @@ _nvme_ns_cmd_split_request_sgl(struct spdk_nvme_ns *ns,
 }
 
 static inline struct nvme_request *
-_nvme_ns_cmd_rw(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
-		const struct nvme_payload *payload, uint32_t payload_offset, uint32_t md_offset,
-		uint64_t lba, uint32_t lba_count, spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t opc,
-		uint32_t io_flags, uint16_t apptag_mask, uint16_t apptag, uint32_t cdw13, bool check_sgl,
-		void *accel_sequence, int *rc)
+_nvme_ns_cmd_rw_req(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		    struct nvme_request *req,
+		    const struct nvme_payload *payload, uint32_t payload_offset, uint32_t md_offset,
+		    uint64_t lba, uint32_t lba_count, spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t opc,
+		    uint32_t io_flags, uint16_t apptag_mask, uint16_t apptag, uint32_t cdw13,
+		    bool check_sgl, void *accel_sequence, int *rc)
 {
-	struct nvme_request	*req;
-	uint32_t		sector_size = _nvme_get_host_buffer_sector_size(ns, io_flags);
 	uint32_t		sectors_per_max_io = _nvme_get_sectors_per_max_io(ns, io_flags);
 	uint32_t		sectors_per_stripe = ns->sectors_per_stripe;
 
-	assert(rc != NULL);
-	assert(*rc == 0);
-
-	req = nvme_allocate_request(qpair, payload, lba_count * sector_size, lba_count * ns->md_size,
-				    cb_fn, cb_arg);
-	if (req == NULL) {
-		*rc = -ENOMEM;
-		return NULL;
-	}
-
 	req->payload_offset = payload_offset;
 	req->md_offset = md_offset;
 	req->accel_sequence = accel_sequence;
@@ -503,6 +501,31 @@ _nvme_ns_cmd_rw(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
 	return req;
 }
 
+static inline struct nvme_request *
+_nvme_ns_cmd_rw(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		const struct nvme_payload *payload, uint32_t payload_offset, uint32_t md_offset,
+		uint64_t lba, uint32_t lba_count, spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t opc,
+		uint32_t io_flags, uint16_t apptag_mask, uint16_t apptag, uint32_t cdw13, bool check_sgl,
+		void *accel_sequence, int *rc)
+{
+	struct nvme_request	*req;
+	uint32_t		sector_size = _nvme_get_host_buffer_sector_size(ns, io_flags);
+
+	assert(rc != NULL);
+	assert(*rc == 0);
+
+	req = nvme_allocate_request(qpair, payload, lba_count * sector_size, lba_count * ns->md_size,
+				    cb_fn, cb_arg);
+	if (req == NULL) {
+		*rc = -ENOMEM;
+		return NULL;
+	}
+
+	return _nvme_ns_cmd_rw_req(ns, qpair, req, payload, payload_offset, md_offset, lba, lba_count,
+				   cb_fn, cb_arg, opc, io_flags, apptag_mask, apptag, cdw13, check_sgl,
+				   accel_sequence, rc);
+}
+
 int
 spdk_nvme_ns_cmd_compare(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair, void *buffer,
 			 uint64_t lba,
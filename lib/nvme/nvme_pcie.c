@@ -1143,6 +1143,7 @@ const struct spdk_nvme_transport_ops pcie_ops = {
 	.qpair_abort_reqs = nvme_pcie_qpair_abort_reqs,
 	.qpair_reset = nvme_pcie_qpair_reset,
 	.qpair_submit_request = nvme_pcie_qpair_submit_request,
+	.qpair_submit_batch_end = nvme_pcie_qpair_submit_batch_end,
 	.qpair_process_completions = nvme_pcie_qpair_process_completions,
 	.qpair_iterate_requests = nvme_pcie_qpair_iterate_requests,
 	.qpair_get_fd = nvme_pcie_qpair_get_fd,
@@ -85,9 +85,11 @@ nvme_pcie_qpair_get_fd(struct spdk_nvme_qpair *qpair, struct spdk_event_handler_
 }
 
 static void
-nvme_qpair_construct_tracker(struct nvme_tracker *tr, uint16_t cid, uint64_t phys_addr)
+nvme_qpair_construct_tracker(struct nvme_tracker *tr, uint16_t cid,
+			     struct nvme_tracker_prp_sgl *prp_sgl, uint64_t phys_addr)
 {
-	tr->prp_sgl_bus_addr = phys_addr + offsetof(struct nvme_tracker, u.prp);
+	tr->prp_sgl = prp_sgl;
+	tr->prp_sgl_bus_addr = phys_addr + offsetof(struct nvme_tracker_prp_sgl, u.prp);
 	tr->cid = cid;
 	tr->req = NULL;
 }
@@ -231,9 +233,8 @@ nvme_pcie_qpair_construct(struct spdk_nvme_qpair *qpair,
 
 	/*
 	 * Reserve space for all of the trackers in a single allocation.
-	 *   struct nvme_tracker must be padded so that its size is already a power of 2.
-	 *   This ensures the PRP list embedded in the nvme_tracker object will not span a
-	 *   4KB boundary, while allowing access to trackers in tr[] via normal array indexing.
+	 *   struct nvme_tracker is exactly one cache line, so the trackers touched on
+	 *   completion are densely packed.
 	 */
 	pqpair->tr = spdk_zmalloc(num_trackers * sizeof(*tr), sizeof(*tr), NULL,
 				  SPDK_ENV_NUMA_ID_ANY, SPDK_MALLOC_SHARE);
@@ -242,13 +243,26 @@ nvme_pcie_qpair_construct(struct spdk_nvme_qpair *qpair,
 		return -ENOMEM;
 	}
 
+	/*
+	 * Reserve space for the PRP lists and SGL segments of all trackers in a separate
+	 *   allocation. struct nvme_tracker_prp_sgl is padded to 4KB, which ensures the
+	 *   PRP list will not span a 4KB boundary.
+	 */
+	pqpair->prp_sgl = spdk_zmalloc(num_trackers * sizeof(*pqpair->prp_sgl), sizeof(*pqpair->prp_sgl),
+				       NULL, SPDK_ENV_NUMA_ID_ANY, SPDK_MALLOC_SHARE);
+	if (pqpair->prp_sgl == NULL) {
+		SPDK_ERRLOG("nvme_tr prp_sgl failed\n");
+		return -ENOMEM;
+	}
+
 	TAILQ_INIT(&pqpair->free_tr);
 	TAILQ_INIT(&pqpair->outstanding_tr);
 	pqpair->qpair.queue_depth = 0;
 
 	for (i = 0; i < num_trackers; i++) {
 		tr = &pqpair->tr[i];
-		nvme_qpair_construct_tracker(tr, i, nvme_pcie_vtophys(ctrlr, tr, NULL));
+		nvme_qpair_construct_tracker(tr, i, &pqpair->prp_sgl[i],
+					     nvme_pcie_vtophys(ctrlr, &pqpair->prp_sgl[i], NULL));
 		TAILQ_INSERT_HEAD(&pqpair->free_tr, tr, tq_list);
 	}
 
@@ -696,7 +710,17 @@ nvme_pcie_qpair_submit_tracker(struct spdk_nvme_qpair *qpair, struct nvme_tracke
 		SPDK_ERRLOG("sq_tail is passing sq_head!\n");
 	}
 
-	if (!pqpair->flags.delay_cmd_submit) {
+	if (!pqpair->flags.delay_cmd_submit && !qpair->in_submit_batch) {
+		nvme_pcie_qpair_ring_sq_doorbell(qpair);
+	}
+}
+
+void
+nvme_pcie_qpair_submit_batch_end(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_pcie_qpair	*pqpair = nvme_pcie_qpair(qpair);
+
+	if (pqpair->last_sq_tail != pqpair->sq_tail) {
 		nvme_pcie_qpair_ring_sq_doorbell(qpair);
 	}
 }
@@ -984,7 +1008,6 @@ nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_
 	if (pqpair->flags.delay_cmd_submit) {
 		if (pqpair->last_sq_tail != pqpair->sq_tail) {
 			nvme_pcie_qpair_ring_sq_doorbell(qpair);
-			pqpair->last_sq_tail = pqpair->sq_tail;
 		}
 	}
 
@@ -1049,6 +1072,9 @@ nvme_pcie_qpair_destroy(struct spdk_nvme_qpair *qpair)
 	if (pqpair->tr) {
 		spdk_free(pqpair->tr);
 	}
+	if (pqpair->prp_sgl) {
+		spdk_free(pqpair->prp_sgl);
+	}
 
 	nvme_qpair_deinit(qpair);
 
@@ -1232,7 +1258,8 @@ nvme_pcie_prp_list_append(struct spdk_nvme_ctrlr *ctrlr, struct nvme_tracker *tr
 {
 	struct spdk_nvme_cmd *cmd = &tr->req->cmd;
 	uintptr_t page_mask = page_size - 1;
-	uint64_t phys_addr;
+	uint64_t phys_addr = 0;
+	uint64_t mapping_len = 0;
 	uint32_t i;
 
 	SPDK_DEBUGLOG(nvme, "prp_index:%u virt_addr:%p len:%u\n",
@@ -1251,15 +1278,19 @@ nvme_pcie_prp_list_append(struct spdk_nvme_ctrlr *ctrlr, struct nvme_tracker *tr
 		 * prp_index 0 is stored in prp1, and the rest are stored in the prp[] array,
 		 * so prp_index == count is valid.
 		 */
-		if (spdk_unlikely(i > SPDK_COUNTOF(tr->u.prp))) {
+		if (spdk_unlikely(i > SPDK_COUNTOF(tr->prp_sgl->u.prp))) {
 			SPDK_ERRLOG("out of PRP entries\n");
 			return -EFAULT;
 		}
 
-		phys_addr = nvme_pcie_vtophys(ctrlr, virt_addr, NULL);
-		if (spdk_unlikely(phys_addr == SPDK_VTOPHYS_ERROR)) {
-			SPDK_ERRLOG("vtophys(%p) failed\n", virt_addr);
-			return -EFAULT;
+		/* Translate the whole physically contiguous region at once, instead of each page */
+		if (mapping_len == 0) {
+			mapping_len = len;
+			phys_addr = nvme_pcie_vtophys(ctrlr, virt_addr, &mapping_len);
+			if (spdk_unlikely(phys_addr == SPDK_VTOPHYS_ERROR)) {
+				SPDK_ERRLOG("vtophys(%p) failed\n", virt_addr);
+				return -EFAULT;
+			}
 		}
 
 		if (i == 0) {
@@ -1273,12 +1304,14 @@ nvme_pcie_prp_list_append(struct spdk_nvme_ctrlr *ctrlr, struct nvme_tracker *tr
 			}
 
 			SPDK_DEBUGLOG(nvme, "prp[%u] = %p\n", i - 1, (void *)phys_addr);
-			tr->u.prp[i - 1] = phys_addr;
+			tr->prp_sgl->u.prp[i - 1] = phys_addr;
 			seg_len = page_size;
 		}
 
 		seg_len = spdk_min(seg_len, len);
 		virt_addr = (uint8_t *)virt_addr + seg_len;
+		phys_addr += seg_len;
+		mapping_len -= spdk_min(seg_len, mapping_len);
 		len -= seg_len;
 		i++;
 	}
@@ -1287,7 +1320,7 @@ nvme_pcie_prp_list_append(struct spdk_nvme_ctrlr *ctrlr, struct nvme_tracker *tr
 	if (i <= 1) {
 		cmd->dptr.prp.prp2 = 0;
 	} else if (i == 2) {
-		cmd->dptr.prp.prp2 = tr->u.prp[0];
+		cmd->dptr.prp.prp2 = tr->prp_sgl->u.prp[0];
 		SPDK_DEBUGLOG(nvme, "prp2 = %p\n", (void *)cmd->dptr.prp.prp2);
 	} else {
 		cmd->dptr.prp.prp2 = tr->prp_sgl_bus_addr;
@@ -1348,7 +1381,7 @@ nvme_pcie_qpair_build_contig_hw_sgl_request(struct spdk_nvme_qpair *qpair, struc
 	assert(req->payload_size != 0);
 	assert(nvme_payload_type(&req->payload) == NVME_PAYLOAD_TYPE_CONTIG);
 
-	sgl = tr->u.sgl;
+	sgl = tr->prp_sgl->u.sgl;
 	req->cmd.psdt = SPDK_NVME_PSDT_SGL_MPTR_CONTIG;
 	req->cmd.dptr.sgl1.unkeyed.subtype = 0;
 
@@ -1398,8 +1431,8 @@ nvme_pcie_qpair_build_contig_hw_sgl_request(struct spdk_nvme_qpair *qpair, struc
 		 *  SGL element into SGL1.
 		 */
 		req->cmd.dptr.sgl1.unkeyed.type = SPDK_NVME_SGL_TYPE_DATA_BLOCK;
-		req->cmd.dptr.sgl1.address = tr->u.sgl[0].address;
-		req->cmd.dptr.sgl1.unkeyed.length = tr->u.sgl[0].unkeyed.length;
+		req->cmd.dptr.sgl1.address = tr->prp_sgl->u.sgl[0].address;
+		req->cmd.dptr.sgl1.unkeyed.length = tr->prp_sgl->u.sgl[0].unkeyed.length;
 	} else {
 		/* SPDK NVMe driver supports only 1 SGL segment for now, it is enough because
 		 *  NVME_MAX_SGL_DESCRIPTORS * 16 is less than one page.
@@ -1437,7 +1470,7 @@ nvme_pcie_qpair_build_hw_sgl_request(struct spdk_nvme_qpair *qpair, struct nvme_
 	assert(req->payload.next_sge_fn != NULL);
 	req->payload.reset_sgl_fn(req->payload.contig_or_cb_arg, req->payload_offset);
 
-	sgl = tr->u.sgl;
+	sgl = tr->prp_sgl->u.sgl;
 	req->cmd.psdt = SPDK_NVME_PSDT_SGL_MPTR_CONTIG;
 	req->cmd.dptr.sgl1.unkeyed.subtype = 0;
 
@@ -1530,8 +1563,8 @@ nvme_pcie_qpair_build_hw_sgl_request(struct spdk_nvme_qpair *qpair, struct nvme_
 		 *  SGL element into SGL1.
 		 */
 		req->cmd.dptr.sgl1.unkeyed.type = SPDK_NVME_SGL_TYPE_DATA_BLOCK;
-		req->cmd.dptr.sgl1.address = tr->u.sgl[0].address;
-		req->cmd.dptr.sgl1.unkeyed.length = tr->u.sgl[0].unkeyed.length;
+		req->cmd.dptr.sgl1.address = tr->prp_sgl->u.sgl[0].address;
+		req->cmd.dptr.sgl1.unkeyed.length = tr->prp_sgl->u.sgl[0].unkeyed.length;
 	} else {
 		/* SPDK NVMe driver supports only 1 SGL segment for now, it is enough because
 		 *  NVME_MAX_SGL_DESCRIPTORS * 16 is less than one page.
@@ -1640,13 +1673,13 @@ nvme_pcie_qpair_build_metadata(struct spdk_nvme_qpair *qpair, struct nvme_tracke
 			assert(req->cmd.psdt == SPDK_NVME_PSDT_SGL_MPTR_CONTIG);
 			req->cmd.psdt = SPDK_NVME_PSDT_SGL_MPTR_SGL;
 
-			tr->meta_sgl.address = nvme_pcie_vtophys(qpair->ctrlr, md_payload, &mapping_length);
-			if (tr->meta_sgl.address == SPDK_VTOPHYS_ERROR || mapping_length != req->md_size) {
+			tr->prp_sgl->meta_sgl.address = nvme_pcie_vtophys(qpair->ctrlr, md_payload, &mapping_length);
+			if (tr->prp_sgl->meta_sgl.address == SPDK_VTOPHYS_ERROR || mapping_length != req->md_size) {
 				goto exit;
 			}
-			tr->meta_sgl.unkeyed.type = SPDK_NVME_SGL_TYPE_DATA_BLOCK;
-			tr->meta_sgl.unkeyed.length = req->md_size;
-			tr->meta_sgl.unkeyed.subtype = 0;
+			tr->prp_sgl->meta_sgl.unkeyed.type = SPDK_NVME_SGL_TYPE_DATA_BLOCK;
+			tr->prp_sgl->meta_sgl.unkeyed.length = req->md_size;
+			tr->prp_sgl->meta_sgl.unkeyed.subtype = 0;
 			req->cmd.mptr = tr->prp_sgl_bus_addr - sizeof(struct spdk_nvme_sgl_descriptor);
 		} else {
 			req->cmd.mptr = nvme_pcie_vtophys(qpair->ctrlr, md_payload, &mapping_length);
@@ -79,6 +79,30 @@ struct nvme_pcie_ctrlr {
 
 extern __thread struct nvme_pcie_ctrlr *g_thread_mmio_ctrlr;
 
+/*
+ * PRP list or SGL segment of a tracker. These are only touched when building a request
+ * and are kept out of struct nvme_tracker, so that the trackers accessed on completion
+ * are densely packed instead of each occupying its own 4K page.
+ */
+struct nvme_tracker_prp_sgl {
+	/* Don't move, metadata SGL is always contiguous with Data Block SGL */
+	struct spdk_nvme_sgl_descriptor		meta_sgl;
+	union {
+		uint64_t			prp[NVME_MAX_PRP_LIST_ENTRIES];
+		struct spdk_nvme_sgl_descriptor	sgl[NVME_MAX_SGL_DESCRIPTORS];
+	} u;
+	uint8_t					reserved[56];
+};
+/*
+ * struct nvme_tracker_prp_sgl must be exactly 4K so that the prp[] array does not cross a page
+ * boundary and so that there is no padding required to meet alignment requirements.
+ */
+SPDK_STATIC_ASSERT(sizeof(struct nvme_tracker_prp_sgl) == 4096, "nvme_tracker_prp_sgl is not 4K");
+SPDK_STATIC_ASSERT((offsetof(struct nvme_tracker_prp_sgl, u.sgl) & 7) == 0,
+		   "SGL must be Qword aligned");
+SPDK_STATIC_ASSERT((offsetof(struct nvme_tracker_prp_sgl, meta_sgl) & 7) == 0,
+		   "SGL must be Qword aligned");
+
 struct nvme_tracker {
 	TAILQ_ENTRY(nvme_tracker)       tq_list;
 
@@ -93,21 +117,10 @@ struct nvme_tracker {
 	void				*cb_arg;
 
 	uint64_t			prp_sgl_bus_addr;
-
-	/* Don't move, metadata SGL is always contiguous with Data Block SGL */
-	struct spdk_nvme_sgl_descriptor		meta_sgl;
-	union {
-		uint64_t			prp[NVME_MAX_PRP_LIST_ENTRIES];
-		struct spdk_nvme_sgl_descriptor	sgl[NVME_MAX_SGL_DESCRIPTORS];
-	} u;
+	struct nvme_tracker_prp_sgl	*prp_sgl;
 };
-/*
- * struct nvme_tracker must be exactly 4K so that the prp[] array does not cross a page boundary
- * and so that there is no padding required to meet alignment requirements.
- */
-SPDK_STATIC_ASSERT(sizeof(struct nvme_tracker) == 4096, "nvme_tracker is not 4K");
-SPDK_STATIC_ASSERT((offsetof(struct nvme_tracker, u.sgl) & 7) == 0, "SGL must be Qword aligned");
-SPDK_STATIC_ASSERT((offsetof(struct nvme_tracker, meta_sgl) & 7) == 0, "SGL must be Qword aligned");
+/* struct nvme_tracker must be exactly one cache line so that a completion touches only one. */
+SPDK_STATIC_ASSERT(sizeof(struct nvme_tracker) == SPDK_CACHE_LINE_SIZE, "nvme_tracker is not one cache line");
 
 struct nvme_pcie_poll_group {
 	struct spdk_nvme_transport_poll_group group;
@@ -195,6 +208,9 @@ struct nvme_pcie_qpair {
 	bool sq_in_cmb;
 	bool shared_stats;
 
+	/* Array of PRP lists and SGL segments of the trackers, indexed by command ID. */
+	struct nvme_tracker_prp_sgl *prp_sgl;
+
 	uint64_t cmd_bus_addr;
 	uint64_t cpl_bus_addr;
 
@@ -257,6 +273,8 @@ nvme_pcie_qpair_ring_sq_doorbell(struct spdk_nvme_qpair *qpair)
 		return;
 	}
 
+	pqpair->last_sq_tail = pqpair->sq_tail;
+
 	if (spdk_unlikely(pqpair->flags.has_shadow_doorbell)) {
 		pqpair->stat->sq_shadow_doorbell_updates++;
 		need_mmio = nvme_pcie_qpair_update_mmio_required(
@@ -323,6 +341,7 @@ void nvme_pcie_qpair_manual_complete_tracker(struct spdk_nvme_qpair *qpair,
 void nvme_pcie_qpair_complete_tracker(struct spdk_nvme_qpair *qpair, struct nvme_tracker *tr,
 				      struct spdk_nvme_cpl *cpl, bool print_on_error);
 void nvme_pcie_qpair_submit_tracker(struct spdk_nvme_qpair *qpair, struct nvme_tracker *tr);
+void nvme_pcie_qpair_submit_batch_end(struct spdk_nvme_qpair *qpair);
 void nvme_pcie_admin_qpair_abort_aers(struct spdk_nvme_qpair *qpair);
 void nvme_pcie_admin_qpair_destroy(struct spdk_nvme_qpair *qpair);
 void nvme_pcie_qpair_abort_reqs(struct spdk_nvme_qpair *qpair, uint32_t dnr);
@@ -71,6 +71,7 @@ spdk_nvme_poll_group_create(void *ctx, struct spdk_nvme_accel_fn_table *table)
 	}
 
 	group->disconnect_qpair_fd = -1;
+	group->adaptive.fd = -1;
 	group->ctx = ctx;
 	STAILQ_INIT(&group->tgroups);
 
@@ -177,6 +178,79 @@ nvme_poll_group_add_disconnect_qpair_fd(struct spdk_nvme_poll_group *group)
 				     group, &opts);
 }
 
+static int
+nvme_poll_group_adaptive_poll(void *arg)
+{
+	struct spdk_nvme_poll_group *group = arg;
+	uint64_t notify;
+	int rc __attribute__((unused));
+
+	assert(group->interrupt.cb_fn != NULL);
+
+	group->adaptive.num_completions = 0;
+	group->interrupt.cb_fn(group, group->interrupt.cb_ctx);
+
+	if (group->adaptive.num_completions > 0) {
+		group->adaptive.idle_count = 0;
+		return 0;
+	}
+
+	if (++group->adaptive.idle_count >= group->adaptive.idle_polls) {
+		/* Read on eventfd will clear its level triggering. */
+		rc = read(group->adaptive.fd, &notify, sizeof(notify));
+		group->adaptive.polling = false;
+	}
+
+	return 0;
+}
+
+static void
+nvme_poll_group_start_adaptive_polling(struct spdk_nvme_poll_group *group)
+{
+	uint64_t notify = 1;
+
+	if (group->adaptive.idle_polls == 0 || group->adaptive.polling) {
+		return;
+	}
+
+	assert(group->adaptive.fd >= 0);
+
+	/* Write without read on eventfd will get it repeatedly triggered. */
+	if (write(group->adaptive.fd, &notify, sizeof(notify)) < 0) {
+		SPDK_ERRLOG("failed to write the adaptive polling fd: %s.\n", strerror(errno));
+		return;
+	}
+
+	group->adaptive.polling = true;
+	group->adaptive.idle_count = 0;
+}
+
+static int
+nvme_poll_group_add_adaptive_poll_fd(struct spdk_nvme_poll_group *group)
+{
+	int fd, rc;
+
+	if (group->adaptive.idle_polls == 0 || group->adaptive.fd >= 0) {
+		return 0;
+	}
+
+	fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (fd < 0) {
+		return -errno;
+	}
+
+	/* The default fd type is used so that the event is not cleared before the callback. */
+	rc = SPDK_FD_GROUP_ADD(group->fgrp, fd, nvme_poll_group_adaptive_poll, group);
+	if (rc != 0) {
+		close(fd);
+		return rc;
+	}
+
+	group->adaptive.fd = fd;
+
+	return 0;
+}
+
 #else
 
 void
@@ -190,8 +264,40 @@ nvme_poll_group_add_disconnect_qpair_fd(struct spdk_nvme_poll_group *group)
 	return -ENOTSUP;
 }
 
+static void
+nvme_poll_group_start_adaptive_polling(struct spdk_nvme_poll_group *group)
+{
+}
+
+static int
+nvme_poll_group_add_adaptive_poll_fd(struct spdk_nvme_poll_group *group)
+{
+	return -ENOTSUP;
+}
+
 #endif
 
+int
+spdk_nvme_poll_group_set_adaptive_polling(struct spdk_nvme_poll_group *group, uint32_t idle_polls)
+{
+	if (idle_polls != 0 && group->interrupt.cb_fn == NULL) {
+		return -EINVAL;
+	}
+
+	group->adaptive.idle_polls = idle_polls;
+	if (idle_polls == 0) {
+		/* Leave it to the next poll to stop polling. */
+		return 0;
+	}
+
+	/* If interrupts are not known to be enabled yet, the fd is added with the first qpair. */
+	if (group->enable_interrupts) {
+		return nvme_poll_group_add_adaptive_poll_fd(group);
+	}
+
+	return 0;
+}
+
 int
 spdk_nvme_poll_group_add(struct spdk_nvme_poll_group *group, struct spdk_nvme_qpair *qpair)
 {
@@ -211,6 +317,11 @@ spdk_nvme_poll_group_add(struct spdk_nvme_poll_group *group, struct spdk_nvme_qp
 			if (rc != 0) {
 				return rc;
 			}
+
+			rc = nvme_poll_group_add_adaptive_poll_fd(group);
+			if (rc != 0) {
+				return rc;
+			}
 		}
 	} else if (qpair->ctrlr->opts.enable_interrupts != group->enable_interrupts) {
 		SPDK_ERRLOG("Queue pair %s interrupts cannot be added to poll group\n",
@@ -262,8 +373,14 @@ static int
 nvme_qpair_process_completion_wrapper(void *arg)
 {
 	struct spdk_nvme_qpair *qpair = arg;
+	int32_t rc;
 
-	return spdk_nvme_qpair_process_completions(qpair, 0);
+	rc = spdk_nvme_qpair_process_completions(qpair, 0);
+	if (rc > 0) {
+		nvme_poll_group_start_adaptive_polling(qpair->poll_group->group);
+	}
+
+	return rc;
 }
 
 static int
@@ -386,6 +503,7 @@ spdk_nvme_poll_group_process_completions(struct spdk_nvme_poll_group *group,
 		}
 	}
 	group->in_process_completions = false;
+	group->adaptive.num_completions += num_completions;
 
 	return error_reason ? error_reason : num_completions;
 }
@@ -446,6 +564,10 @@ spdk_nvme_poll_group_destroy(struct spdk_nvme_poll_group *group)
 			spdk_fd_group_remove(fgrp, group->disconnect_qpair_fd);
 			close(group->disconnect_qpair_fd);
 		}
+		if (group->adaptive.fd >= 0) {
+			spdk_fd_group_remove(fgrp, group->adaptive.fd);
+			close(group->adaptive.fd);
+		}
 		spdk_fd_group_destroy(fgrp);
 	}
 
@@ -883,6 +883,7 @@ nvme_qpair_init(struct spdk_nvme_qpair *qpair, uint16_t id,
 	qpair->num_outstanding_reqs = 0;
 
 	STAILQ_INIT(&qpair->free_req);
+	STAILQ_INIT(&qpair->free_child_req);
 	STAILQ_INIT(&qpair->queued_req);
 	STAILQ_INIT(&qpair->aborting_queued_req);
 	TAILQ_INIT(&qpair->err_cmd_head);
@@ -915,6 +916,35 @@ nvme_qpair_init(struct spdk_nvme_qpair *qpair, uint16_t id,
 	return 0;
 }
 
+int
+nvme_qpair_init_child_requests(struct spdk_nvme_qpair *qpair, uint32_t num_requests)
+{
+	struct nvme_request *req;
+	size_t req_size_padded;
+	uint32_t i;
+
+	req_size_padded = (sizeof(struct nvme_request) + 63) & ~(size_t)63;
+
+	qpair->child_req_buf = spdk_zmalloc(req_size_padded * num_requests, 64, NULL,
+					    SPDK_ENV_NUMA_ID_ANY, SPDK_MALLOC_SHARE);
+	if (qpair->child_req_buf == NULL) {
+		SPDK_ERRLOG("no memory to allocate qpair(cntlid:0x%x sqid:%d) child_req_buf with %d request\n",
+			    qpair->ctrlr->cntlid, qpair->id, num_requests);
+		return -ENOMEM;
+	}
+
+	qpair->child_req_buf_size = req_size_padded * num_requests;
+
+	for (i = 0; i < num_requests; i++) {
+		req = (void *)((uintptr_t)qpair->child_req_buf + i * req_size_padded);
+
+		req->qpair = qpair;
+		STAILQ_INSERT_HEAD(&qpair->free_child_req, req, stailq);
+	}
+
+	return 0;
+}
+
 void
 nvme_qpair_complete_error_reqs(struct spdk_nvme_qpair *qpair)
 {
@@ -945,6 +975,7 @@ nvme_qpair_deinit(struct spdk_nvme_qpair *qpair)
 	}
 
 	spdk_free(qpair->req_buf);
+	spdk_free(qpair->child_req_buf);
 }
 
 static inline int
@@ -1237,3 +1268,38 @@ spdk_nvme_qpair_get_num_outstanding_reqs(struct spdk_nvme_qpair *qpair)
 {
 	return qpair->num_outstanding_reqs;
 }
+
+uint64_t
+spdk_nvme_qpair_get_num_req_alloc_failures(struct spdk_nvme_qpair *qpair)
+{
+	return qpair->num_req_alloc_failures;
+}
+
+int
+spdk_nvme_qpair_submit_batch_begin(struct spdk_nvme_qpair *qpair)
+{
+	if (nvme_qpair_is_admin_queue(qpair)) {
+		return -EINVAL;
+	}
+
+	if (qpair->in_submit_batch) {
+		return -EBUSY;
+	}
+
+	qpair->in_submit_batch = 1;
+
+	return 0;
+}
+
+int
+spdk_nvme_qpair_submit_batch_end(struct spdk_nvme_qpair *qpair)
+{
+	if (!qpair->in_submit_batch) {
+		return -EINVAL;
+	}
+
+	qpair->in_submit_batch = 0;
+	nvme_transport_qpair_submit_batch_end(qpair);
+
+	return 0;
+}
@@ -73,6 +73,13 @@
 
 #define WC_PER_QPAIR(queue_depth)	(queue_depth * 2)
 
+/*
+ * Interval in microseconds at which a poll group checks all of its connected qpairs for
+ * failures set outside of the transport, e.g. when the controller is failed. A poll group
+ * checks them on its next poll once any of them has received a CM event.
+ */
+#define NVME_RDMA_POLL_GROUP_CHECK_QPAIRS_US	1000
+
 #define NVME_RDMA_POLL_GROUP_CHECK_QPN(_rqpair, qpn)				\
 	((_rqpair)->rdma_qp && (_rqpair)->rdma_qp->qp->qp_num == (qpn))	\
 
@@ -148,6 +155,8 @@ struct nvme_rdma_poll_group {
 	uint32_t					num_pollers;
 	TAILQ_HEAD(, nvme_rdma_qpair)			connecting_qpairs;
 	TAILQ_HEAD(, nvme_rdma_qpair)			active_qpairs;
+	bool						check_qpairs;
+	uint64_t					next_check_qpairs_tsc;
 };
 
 enum nvme_rdma_qpair_state {
@@ -216,6 +225,14 @@ struct nvme_rdma_qpair {
 	 */
 	struct spdk_nvmf_cmd			*cmds;
 
+	/*
+	 * Array of num_entries buffers of inline_copy_size bytes, registered as RDMA message
+	 * buffers. Small write payloads are copied there and sent in capsule. Indexed by
+	 * rdma_req->id.
+	 */
+	uint8_t					*inline_bufs;
+	uint32_t				inline_copy_size;
+
 	struct spdk_rdma_utils_mem_map		*mr_map;
 
 	TAILQ_HEAD(, spdk_nvme_rdma_req)	free_reqs;
@@ -266,6 +283,9 @@ struct spdk_nvme_rdma_req {
 
 	struct ibv_sge				send_sgl[NVME_RDMA_DEFAULT_TX_SGE];
 
+	/* lkey of the inline copy buffer of this request */
+	uint32_t				inline_buf_lkey;
+
 	TAILQ_ENTRY(spdk_nvme_rdma_req)		link;
 
 	/* Fields below are not used in regular IO path, keep them last */
@@ -340,6 +360,14 @@ nvme_rdma_poll_group(struct spdk_nvme_transport_poll_group *group)
 	return (SPDK_CONTAINEROF(group, struct nvme_rdma_poll_group, group));
 }
 
+static inline void
+nvme_rdma_poll_group_check_qpairs(struct nvme_rdma_qpair *rqpair)
+{
+	if (rqpair->qpair.poll_group != NULL) {
+		nvme_rdma_poll_group(rqpair->qpair.poll_group)->check_qpairs = true;
+	}
+}
+
 static inline struct nvme_rdma_ctrlr *
 nvme_rdma_ctrlr(struct spdk_nvme_ctrlr *ctrlr)
 {
@@ -507,6 +535,7 @@ nvme_rdma_poll_events(struct nvme_rdma_ctrlr *rctrlr)
 		event_qpair = entry->evt->id->context;
 		if (event_qpair->evt == NULL) {
 			event_qpair->evt = entry->evt;
+			nvme_rdma_poll_group_check_qpairs(event_qpair);
 			STAILQ_REMOVE(&rctrlr->pending_cm_events, entry, nvme_rdma_cm_event_entry, link);
 			STAILQ_INSERT_HEAD(&rctrlr->free_cm_events, entry, link);
 		}
@@ -516,6 +545,7 @@ nvme_rdma_poll_events(struct nvme_rdma_ctrlr *rctrlr)
 		event_qpair = event->id->context;
 		if (event_qpair->evt == NULL) {
 			event_qpair->evt = event;
+			nvme_rdma_poll_group_check_qpairs(event_qpair);
 		} else {
 			assert(rctrlr == nvme_rdma_ctrlr(event_qpair->qpair.ctrlr));
 			entry = STAILQ_FIRST(&rctrlr->free_cm_events);
@@ -937,6 +967,9 @@ nvme_rdma_free_reqs(struct nvme_rdma_qpair *rqpair)
 	spdk_free(rqpair->cmds);
 	rqpair->cmds = NULL;
 
+	spdk_free(rqpair->inline_bufs);
+	rqpair->inline_bufs = NULL;
+
 	spdk_free(rqpair->rdma_reqs);
 	rqpair->rdma_reqs = NULL;
 }
@@ -964,6 +997,23 @@ nvme_rdma_create_reqs(struct nvme_rdma_qpair *rqpair)
 		goto fail;
 	}
 
+	/* The in-capsule data size is only known for I/O qpairs */
+	rqpair->inline_copy_size = 0;
+	if (!nvme_qpair_is_admin_queue(&rqpair->qpair)) {
+		rqpair->inline_copy_size = spdk_min(g_spdk_nvme_transport_opts.rdma_inline_copy_size,
+						    rqpair->qpair.ctrlr->ioccsz_bytes);
+	}
+
+	if (rqpair->inline_copy_size != 0) {
+		assert(!rqpair->inline_bufs);
+		rqpair->inline_bufs = spdk_zmalloc((size_t)rqpair->num_entries * rqpair->inline_copy_size,
+						   0x1000, NULL, SPDK_ENV_NUMA_ID_ANY, SPDK_MALLOC_DMA);
+		if (!rqpair->inline_bufs) {
+			SPDK_ERRLOG("Failed to allocate RDMA inline copy buffers\n");
+			goto fail;
+		}
+	}
+
 	TAILQ_INIT(&rqpair->free_reqs);
 	TAILQ_INIT(&rqpair->outstanding_reqs);
 	for (i = 0; i < rqpair->num_entries; i++) {
@@ -982,6 +1032,16 @@ nvme_rdma_create_reqs(struct nvme_rdma_qpair *rqpair)
 		}
 		rdma_req->send_sgl[0].lkey = spdk_rdma_utils_memory_translation_get_lkey(&translation);
 
+		if (rqpair->inline_bufs) {
+			rc = spdk_rdma_utils_get_translation(rqpair->mr_map,
+							     rqpair->inline_bufs + (size_t)i * rqpair->inline_copy_size,
+							     rqpair->inline_copy_size, &translation);
+			if (rc) {
+				goto fail;
+			}
+			rdma_req->inline_buf_lkey = spdk_rdma_utils_memory_translation_get_lkey(&translation);
+		}
+
 		/* The first RDMA sgl element will always point
 		 * at this data structure. Depending on whether
 		 * an NVMe-oF SGL is required, the length of
@@ -1520,6 +1580,54 @@ nvme_rdma_build_contig_inline_request(struct nvme_rdma_qpair *rqpair,
 	return 0;
 }
 
+/*
+ * Build inline SGL describing the payload copied into the inline buffer of the request,
+ * which saves the memory translation of small payloads.
+ */
+static inline int
+nvme_rdma_build_inline_copy_request(struct nvme_rdma_qpair *rqpair,
+				    struct spdk_nvme_rdma_req *rdma_req)
+{
+	struct nvme_request *req = rdma_req->req;
+	struct nvme_rdma_memory_translation_ctx ctx = {
+		.addr = rqpair->inline_bufs + (size_t)rdma_req->id * rqpair->inline_copy_size,
+		.length = req->payload_size,
+		.lkey = rdma_req->inline_buf_lkey,
+	};
+	uint8_t *buf = ctx.addr;
+	uint32_t remaining = req->payload_size;
+	uint32_t length;
+	void *addr;
+	int rc;
+
+	assert(req->payload_size != 0);
+	assert(req->payload_size <= rqpair->inline_copy_size);
+
+	if (nvme_payload_type(&req->payload) == NVME_PAYLOAD_TYPE_CONTIG) {
+		memcpy(buf, (uint8_t *)req->payload.contig_or_cb_arg + req->payload_offset, remaining);
+	} else {
+		assert(req->payload.reset_sgl_fn != NULL);
+		assert(req->payload.next_sge_fn != NULL);
+		req->payload.reset_sgl_fn(req->payload.contig_or_cb_arg, req->payload_offset);
+
+		while (remaining > 0) {
+			rc = req->payload.next_sge_fn(req->payload.contig_or_cb_arg, &addr, &length);
+			if (spdk_unlikely(rc || length == 0)) {
+				return -1;
+			}
+
+			length = spdk_min(length, remaining);
+			memcpy(buf, addr, length);
+			buf += length;
+			remaining -= length;
+		}
+	}
+
+	nvme_rdma_configure_contig_inline_request(rdma_req, req, &ctx);
+
+	return 0;
+}
+
 static inline void
 nvme_rdma_configure_contig_request(struct spdk_nvme_rdma_req *rdma_req, struct nvme_request *req,
 				   struct nvme_rdma_memory_translation_ctx *ctx)
@@ -1958,6 +2066,10 @@ nvme_rdma_req_init(struct nvme_rdma_qpair *rqpair, struct spdk_nvme_rdma_req *rd
 
 	if (spdk_unlikely(req->payload_size == 0)) {
 		rc = nvme_rdma_build_null_request(rdma_req);
+	} else if (icd_supported && req->payload_size <= rqpair->inline_copy_size &&
+		   !(req->payload.opts && req->payload.opts->memory_domain)) {
+		/* The payload of a memory domain may not be accessible by the CPU */
+		rc = nvme_rdma_build_inline_copy_request(rqpair, rdma_req);
 	} else if (payload_type == NVME_PAYLOAD_TYPE_CONTIG) {
 		if (icd_supported) {
 			rc = nvme_rdma_build_contig_inline_request(rqpair, rdma_req);
@@ -3351,6 +3463,7 @@ nvme_rdma_poll_group_create(void)
 static int
 nvme_rdma_poll_group_connect_qpair(struct spdk_nvme_qpair *qpair)
 {
+	nvme_rdma_poll_group_check_qpairs(nvme_rdma_qpair(qpair));
 	return 0;
 }
 
@@ -3450,7 +3563,8 @@ nvme_rdma_poll_group_process_completions(struct spdk_nvme_transport_poll_group *
 	uint64_t				completions_allowed = 0;
 	uint64_t				completions_per_poller = 0;
 	uint64_t				poller_completions = 0;
-	uint64_t				rdma_completions;
+	uint64_t				rdma_completions, polled_wcs;
+	uint64_t				now;
 
 	if (completions_per_qpair == 0) {
 		completions_per_qpair = MAX_COMPLETIONS_PER_POLL;
@@ -3486,16 +3600,25 @@ nvme_rdma_poll_group_process_completions(struct spdk_nvme_transport_poll_group *
 		}
 	}
 
-	STAILQ_FOREACH_SAFE(qpair, &tgroup->connected_qpairs, poll_group_stailq, tmp_qpair) {
-		rqpair = nvme_rdma_qpair(qpair);
+	/* Walking all the connected qpairs on each poll is costly with many of them, so it is
+	 * done only once some qpair has received a CM event, and periodically otherwise. */
+	now = spdk_get_ticks();
+	if (group->check_qpairs || now >= group->next_check_qpairs_tsc) {
+		group->check_qpairs = false;
+		group->next_check_qpairs_tsc = now + NVME_RDMA_POLL_GROUP_CHECK_QPAIRS_US *
+					       spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
 
-		if (spdk_likely(nvme_qpair_get_state(qpair) != NVME_QPAIR_CONNECTING)) {
-			nvme_rdma_qpair_process_cm_event(rqpair);
-		}
+		STAILQ_FOREACH_SAFE(qpair, &tgroup->connected_qpairs, poll_group_stailq, tmp_qpair) {
+			rqpair = nvme_rdma_qpair(qpair);
 
-		if (spdk_unlikely(qpair->transport_failure_reason != SPDK_NVME_QPAIR_FAILURE_NONE)) {
-			rc2 = -ENXIO;
-			nvme_rdma_fail_qpair(qpair, 0);
+			if (spdk_likely(nvme_qpair_get_state(qpair) != NVME_QPAIR_CONNECTING)) {
+				nvme_rdma_qpair_process_cm_event(rqpair);
+			}
+
+			if (spdk_unlikely(qpair->transport_failure_reason != SPDK_NVME_QPAIR_FAILURE_NONE)) {
+				rc2 = -ENXIO;
+				nvme_rdma_fail_qpair(qpair, 0);
+			}
 		}
 	}
 
@@ -3510,6 +3633,7 @@ nvme_rdma_poll_group_process_completions(struct spdk_nvme_transport_poll_group *
 		do {
 			poller->stats.polls++;
 			batch_size = spdk_min((completions_per_poller - poller_completions), MAX_COMPLETIONS_PER_POLL);
+			polled_wcs = rdma_completions;
 			rc = nvme_rdma_cq_process_completions(poller->cq, batch_size, poller, NULL, &rdma_completions);
 			if (rc <= 0) {
 				if (rc == -ECANCELED) {
@@ -3521,6 +3645,11 @@ nvme_rdma_poll_group_process_completions(struct spdk_nvme_transport_poll_group *
 			}
 
 			poller_completions += rc;
+
+			/* The CQ has been drained, don't poll it once more just to find it empty */
+			if (rdma_completions - polled_wcs < (uint64_t)batch_size) {
+				break;
+			}
 		} while (poller_completions < completions_per_poller);
 		total_completions += poller_completions;
 		poller->stats.completions += rdma_completions;
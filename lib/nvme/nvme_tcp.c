@@ -35,6 +35,7 @@
 #define NVME_TCP_HPDA_DEFAULT			0
 #define NVME_TCP_MAX_R2T_DEFAULT		1
 #define NVME_TCP_PDU_H2C_MIN_DATA_SIZE		4096
+#define NVME_TCP_RECV_BUF_SIZE_MIN		4096
 
 /*
  * Maximum value of transport_ack_timeout used by TCP controller
@@ -69,6 +70,10 @@ struct nvme_tcp_poll_group {
 
 	TAILQ_HEAD(, nvme_tcp_qpair) needs_poll;
 	struct spdk_nvme_tcp_stat stats;
+
+	/* Buffers provided to sock_group for spdk_sock_recv_next() */
+	uint8_t *recv_bufs;
+	uint32_t recv_buf_size;
 };
 
 /* NVMe TCP qpair extensions for spdk_nvme_qpair */
@@ -95,9 +100,17 @@ struct nvme_tcp_qpair {
 		uint16_t host_ddgst_enable: 1;
 		uint16_t icreq_send_ack: 1;
 		uint16_t in_connect_poll: 1;
-		uint16_t reserved: 12;
+		uint16_t recv_next: 1;
+		uint16_t reserved: 11;
 	} flags;
 
+	/* Unconsumed part of the last buffer returned by spdk_sock_recv_next() */
+	struct {
+		uint8_t				*buf;
+		void				*ctx;
+		uint32_t			len;
+	} recv_buf;
+
 	/** Specifies the maximum number of PDU-Data bytes per H2C Data Transfer PDU */
 	uint32_t				maxh2cdata;
 
@@ -1462,6 +1475,13 @@ nvme_tcp_send_icreq_complete(void *cb_arg)
 	}
 }
 
+static inline bool
+nvme_tcp_qpair_recv_next_supported(struct nvme_tcp_qpair *tqpair)
+{
+	return tqpair->qpair.poll_group != NULL &&
+	       nvme_tcp_poll_group(tqpair->qpair.poll_group)->recv_bufs != NULL;
+}
+
 static void
 nvme_tcp_icresp_handle(struct nvme_tcp_qpair *tqpair,
 		       struct nvme_tcp_pdu *pdu)
@@ -1521,6 +1541,17 @@ nvme_tcp_icresp_handle(struct nvme_tcp_qpair *tqpair,
 		/* Not fatal. */
 	}
 
+	if (nvme_tcp_qpair_recv_next_supported(tqpair)) {
+		/* spdk_sock_recv_next() requires the receive pipe of the socket to be disabled. No data
+		 * can be queued in the pipe at this point, as the target doesn't send anything after the
+		 * ICResp before it receives a capsule. */
+		if (spdk_sock_set_recvbuf(tqpair->sock, 0) == 0) {
+			tqpair->flags.recv_next = 1;
+		} else {
+			SPDK_WARNLOG("Unable to disable receive pipe on tqpair=%p\n", tqpair);
+		}
+	}
+
 	nvme_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY);
 
 	if (!tqpair->flags.icreq_send_ack) {
@@ -1914,6 +1945,122 @@ nvme_tcp_pdu_psh_handle(struct nvme_tcp_qpair *tqpair, uint32_t *reaped)
 
 }
 
+static void
+nvme_tcp_qpair_put_recv_buf(struct nvme_tcp_qpair *tqpair)
+{
+	struct nvme_tcp_poll_group *group;
+
+	if (tqpair->recv_buf.ctx == NULL) {
+		return;
+	}
+
+	group = nvme_tcp_poll_group(tqpair->qpair.poll_group);
+	spdk_sock_group_provide_buf(group->sock_group, tqpair->recv_buf.ctx, group->recv_buf_size,
+				    tqpair->recv_buf.ctx);
+
+	tqpair->recv_buf.buf = NULL;
+	tqpair->recv_buf.ctx = NULL;
+	tqpair->recv_buf.len = 0;
+}
+
+/* Copy the next portion of the stream from the buffers returned by spdk_sock_recv_next()
+ * into iov. A buffer is handed back to the sock group as soon as it has been consumed. */
+static int
+nvme_tcp_qpair_recv_next(struct nvme_tcp_qpair *tqpair, struct iovec *iov, int iovcnt)
+{
+	struct spdk_iov_xfer ix;
+	size_t len, total = 0, iov_len = 0;
+	void *buf, *ctx;
+	int rc = 0, i;
+
+	for (i = 0; i < iovcnt; i++) {
+		iov_len += iov[i].iov_len;
+	}
+
+	spdk_iov_xfer_init(&ix, iov, iovcnt);
+
+	while (total < iov_len) {
+		if (tqpair->recv_buf.len == 0) {
+			rc = spdk_sock_recv_next(tqpair->sock, &buf, &ctx);
+			if (rc <= 0) {
+				break;
+			}
+
+			tqpair->recv_buf.buf = buf;
+			tqpair->recv_buf.ctx = ctx;
+			tqpair->recv_buf.len = rc;
+		}
+
+		len = spdk_iov_xfer_from_buf(&ix, tqpair->recv_buf.buf, tqpair->recv_buf.len);
+		tqpair->recv_buf.buf += len;
+		tqpair->recv_buf.len -= len;
+		total += len;
+
+		if (tqpair->recv_buf.len == 0) {
+			nvme_tcp_qpair_put_recv_buf(tqpair);
+		}
+	}
+
+	if (total > 0 || iov_len == 0) {
+		return total;
+	}
+
+	if (rc < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			return 0;
+		}
+
+		if (errno == ENOBUFS) {
+			/* All provided buffers are in use, read from the socket directly. */
+			return nvme_tcp_readv_data(tqpair->sock, iov, iovcnt);
+		}
+
+		/* For connect reset issue, do not output error log */
+		if (errno != ECONNRESET) {
+			SPDK_ERRLOG("spdk_sock_recv_next() failed, errno %d: %s\n",
+				    errno, spdk_strerror(errno));
+		}
+	}
+
+	/* connection closed */
+	return NVME_TCP_CONNECTION_FATAL;
+}
+
+static int
+nvme_tcp_qpair_read_data(struct nvme_tcp_qpair *tqpair, int bytes, void *buf)
+{
+	struct iovec iov;
+
+	if (!tqpair->flags.recv_next) {
+		return nvme_tcp_read_data(tqpair->sock, bytes, buf);
+	}
+
+	iov.iov_base = buf;
+	iov.iov_len = bytes;
+
+	return nvme_tcp_qpair_recv_next(tqpair, &iov, 1);
+}
+
+static int
+nvme_tcp_qpair_read_payload_data(struct nvme_tcp_qpair *tqpair, struct nvme_tcp_pdu *pdu)
+{
+	struct iovec iov[NVME_TCP_MAX_SGL_DESCRIPTORS + 1];
+	int iovcnt;
+
+	if (!tqpair->flags.recv_next) {
+		return nvme_tcp_read_payload_data(tqpair->sock, pdu);
+	}
+
+	iovcnt = nvme_tcp_build_payload_iovs(iov, NVME_TCP_MAX_SGL_DESCRIPTORS + 1, pdu,
+					     pdu->ddgst_enable, NULL);
+	assert(iovcnt >= 0);
+	if (iovcnt == 0) {
+		return 0;
+	}
+
+	return nvme_tcp_qpair_recv_next(tqpair, iov, iovcnt);
+}
+
 static int
 nvme_tcp_read_pdu(struct nvme_tcp_qpair *tqpair, uint32_t *reaped, uint32_t max_completions)
 {
@@ -1942,9 +2089,9 @@ nvme_tcp_read_pdu(struct nvme_tcp_qpair *tqpair, uint32_t *reaped, uint32_t max_
 		/* Wait for the pdu common header */
 		case NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_CH:
 			assert(pdu->ch_valid_bytes < sizeof(struct spdk_nvme_tcp_common_pdu_hdr));
-			rc = nvme_tcp_read_data(tqpair->sock,
-						sizeof(struct spdk_nvme_tcp_common_pdu_hdr) - pdu->ch_valid_bytes,
-						(uint8_t *)&pdu->hdr.common + pdu->ch_valid_bytes);
+			rc = nvme_tcp_qpair_read_data(tqpair,
+						      sizeof(struct spdk_nvme_tcp_common_pdu_hdr) - pdu->ch_valid_bytes,
+						      (uint8_t *)&pdu->hdr.common + pdu->ch_valid_bytes);
 			if (rc < 0) {
 				nvme_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_QUIESCING);
 				break;
@@ -1960,9 +2107,9 @@ nvme_tcp_read_pdu(struct nvme_tcp_qpair *tqpair, uint32_t *reaped, uint32_t max_
 		/* Wait for the pdu specific header  */
 		case NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PSH:
 			assert(pdu->psh_valid_bytes < pdu->psh_len);
-			rc = nvme_tcp_read_data(tqpair->sock,
-						pdu->psh_len - pdu->psh_valid_bytes,
-						(uint8_t *)&pdu->hdr.raw + sizeof(struct spdk_nvme_tcp_common_pdu_hdr) + pdu->psh_valid_bytes);
+			rc = nvme_tcp_qpair_read_data(tqpair,
+						      pdu->psh_len - pdu->psh_valid_bytes,
+						      (uint8_t *)&pdu->hdr.raw + sizeof(struct spdk_nvme_tcp_common_pdu_hdr) + pdu->psh_valid_bytes);
 			if (rc < 0) {
 				nvme_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_QUIESCING);
 				break;
@@ -1990,7 +2137,7 @@ nvme_tcp_read_pdu(struct nvme_tcp_qpair *tqpair, uint32_t *reaped, uint32_t max_
 				pdu->ddgst_enable = true;
 			}
 
-			rc = nvme_tcp_read_payload_data(tqpair->sock, pdu);
+			rc = nvme_tcp_qpair_read_payload_data(tqpair, pdu);
 			if (rc < 0) {
 				nvme_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_QUIESCING);
 				break;
@@ -2214,7 +2361,7 @@ nvme_tcp_qpair_connect_sock(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_qpai
 	struct nvme_tcp_qpair *tqpair;
 	int family;
 	long int port, src_port = 0;
-	char *sock_impl_name;
+	const char *sock_impl_name;
 	struct spdk_sock_impl_opts impl_opts = {};
 	size_t impl_opts_size = sizeof(impl_opts);
 	struct spdk_sock_opts opts;
@@ -2269,6 +2416,19 @@ nvme_tcp_qpair_connect_sock(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_qpai
 		impl_opts.psk_key = tcp_ctrlr->psk;
 		impl_opts.psk_key_size = tcp_ctrlr->psk_size;
 		impl_opts.tls_cipher_suites = tcp_ctrlr->tls_cipher_suite;
+	} else if (g_spdk_nvme_transport_opts.tcp_zcopy_threshold != 0 &&
+		   !nvme_qpair_is_admin_queue(qpair)) {
+		/* Zero-copy send is disabled for client sockets by default, so turn it on for this
+		 * socket, but only for the flushes large enough to make up for the completion
+		 * notifications read from the error queue. */
+		sock_impl_name = spdk_sock_get_default_impl();
+		if (sock_impl_name != NULL &&
+		    spdk_sock_impl_get_opts(sock_impl_name, &impl_opts, &impl_opts_size) == 0) {
+			impl_opts.enable_zerocopy_send_client = true;
+			impl_opts.zerocopy_threshold = g_spdk_nvme_transport_opts.tcp_zcopy_threshold;
+		} else {
+			sock_impl_name = NULL;
+		}
 	}
 	opts.opts_size = sizeof(opts);
 	spdk_sock_get_default_opts(&opts);
@@ -2705,10 +2865,32 @@ nvme_tcp_admin_qpair_abort_aers(struct spdk_nvme_qpair *qpair)
 	}
 }
 
+static int
+nvme_tcp_poll_group_provide_recv_bufs(struct nvme_tcp_poll_group *group)
+{
+	uint32_t i, count = g_spdk_nvme_transport_opts.tcp_recv_buf_count;
+	uint8_t *buf;
+
+	group->recv_buf_size = spdk_max(g_spdk_nvme_transport_opts.tcp_recv_buf_size,
+					NVME_TCP_RECV_BUF_SIZE_MIN);
+	group->recv_bufs = calloc(count, group->recv_buf_size);
+	if (group->recv_bufs == NULL) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < count; i++) {
+		buf = group->recv_bufs + (size_t)i * group->recv_buf_size;
+		spdk_sock_group_provide_buf(group->sock_group, buf, group->recv_buf_size, buf);
+	}
+
+	return 0;
+}
+
 static struct spdk_nvme_transport_poll_group *
 nvme_tcp_poll_group_create(void)
 {
 	struct nvme_tcp_poll_group *group = calloc(1, sizeof(*group));
+	int rc;
 
 	if (group == NULL) {
 		SPDK_ERRLOG("Unable to allocate poll group.\n");
@@ -2724,6 +2906,16 @@ nvme_tcp_poll_group_create(void)
 		return NULL;
 	}
 
+	if (g_spdk_nvme_transport_opts.tcp_recv_buf_count != 0) {
+		rc = nvme_tcp_poll_group_provide_recv_bufs(group);
+		if (rc != 0) {
+			SPDK_ERRLOG("Unable to allocate receive buffers.\n");
+			spdk_sock_group_close(&group->sock_group);
+			free(group);
+			return NULL;
+		}
+	}
+
 	return &group->group;
 }
 
@@ -2765,6 +2957,10 @@ nvme_tcp_poll_group_disconnect_qpair(struct spdk_nvme_qpair *qpair)
 		tqpair->needs_poll = false;
 	}
 
+	/* The rest of the stream is dropped along with the socket. */
+	nvme_tcp_qpair_put_recv_buf(tqpair);
+	tqpair->flags.recv_next = 0;
+
 	if (tqpair->sock && group->sock_group) {
 		if (spdk_sock_group_remove_sock(group->sock_group, tqpair->sock)) {
 			return -EPROTO;
@@ -2884,6 +3080,7 @@ nvme_tcp_poll_group_destroy(struct spdk_nvme_transport_poll_group *tgroup)
 		assert(false);
 	}
 
+	free(group->recv_bufs);
 	free(tgroup);
 
 	return 0;
@@ -30,6 +30,10 @@ struct spdk_nvme_transport_opts g_spdk_nvme_transport_opts = {
 	.rdma_max_cq_size = 0,
 	.rdma_cm_event_timeout_ms = 1000,
 	.rdma_umr_per_io = false,
+	.tcp_recv_buf_count = 0,
+	.tcp_recv_buf_size = 0x10000,
+	.tcp_zcopy_threshold = 0,
+	.rdma_inline_copy_size = 0,
 };
 
 const struct spdk_nvme_transport *
@@ -655,6 +659,16 @@ nvme_transport_qpair_submit_request(struct spdk_nvme_qpair *qpair, struct nvme_r
 	return transport->ops.qpair_submit_request(qpair, req);
 }
 
+void
+nvme_transport_qpair_submit_batch_end(struct spdk_nvme_qpair *qpair)
+{
+	assert(!nvme_qpair_is_admin_queue(qpair));
+
+	if (qpair->transport->ops.qpair_submit_batch_end != NULL) {
+		qpair->transport->ops.qpair_submit_batch_end(qpair);
+	}
+}
+
 int32_t
 nvme_transport_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_completions)
 {
@@ -901,10 +915,14 @@ spdk_nvme_transport_get_opts(struct spdk_nvme_transport_opts *opts, size_t opts_
 	SET_FIELD(rdma_max_cq_size);
 	SET_FIELD(rdma_cm_event_timeout_ms);
 	SET_FIELD(rdma_umr_per_io);
+	SET_FIELD(tcp_recv_buf_count);
+	SET_FIELD(tcp_recv_buf_size);
+	SET_FIELD(tcp_zcopy_threshold);
+	SET_FIELD(rdma_inline_copy_size);
 
 	/* Do not remove this statement, you should always update this statement when you adding a new field,
 	 * and do not forget to add the SET_FIELD statement for your added field. */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_transport_opts) == 24, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_transport_opts) == 40, "Incorrect size");
 
 #undef SET_FIELD
 }
@@ -931,6 +949,10 @@ spdk_nvme_transport_set_opts(const struct spdk_nvme_transport_opts *opts, size_t
 	SET_FIELD(rdma_max_cq_size);
 	SET_FIELD(rdma_cm_event_timeout_ms);
 	SET_FIELD(rdma_umr_per_io);
+	SET_FIELD(tcp_recv_buf_count);
+	SET_FIELD(tcp_recv_buf_size);
+	SET_FIELD(tcp_zcopy_threshold);
+	SET_FIELD(rdma_inline_copy_size);
 
 	g_spdk_nvme_transport_opts.opts_size = opts->opts_size;
 
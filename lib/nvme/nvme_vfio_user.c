@@ -345,6 +345,7 @@ const struct spdk_nvme_transport_ops vfio_ops = {
 	.qpair_reset = nvme_pcie_qpair_reset,
 	.qpair_abort_reqs = nvme_pcie_qpair_abort_reqs,
 	.qpair_submit_request = nvme_pcie_qpair_submit_request,
+	.qpair_submit_batch_end = nvme_pcie_qpair_submit_batch_end,
 	.qpair_process_completions = nvme_pcie_qpair_process_completions,
 
 	.poll_group_create = nvme_pcie_poll_group_create,
@@ -44,6 +44,9 @@
 
 #define NVMF_ABORT_COMMAND_LIMIT 3
 
+/* Resolution of the keep alive timers of the controllers of a poll group */
+#define NVMF_KEEP_ALIVE_TIMER_PERIOD_US (100 * 1000)
+
 /*
  * Support for custom admin command handlers
  */
@@ -74,6 +77,19 @@ nvmf_invalid_connect_response(struct spdk_nvmf_fabric_connect_rsp *rsp,
 	nvmf_invalid_connect_response(rsp, 1, offsetof(struct spdk_nvmf_fabric_connect_data, field))
 
 
+static void
+nvmf_ctrlr_remove_keep_alive_timer(struct spdk_nvmf_ctrlr *ctrlr)
+{
+	struct spdk_nvmf_poll_group *group = ctrlr->keep_alive_group;
+
+	TAILQ_REMOVE(&group->keep_alive_ctrlrs, ctrlr, keep_alive_link);
+	ctrlr->keep_alive_group = NULL;
+
+	if (TAILQ_EMPTY(&group->keep_alive_ctrlrs)) {
+		spdk_poller_unregister(&group->keep_alive_poller);
+	}
+}
+
 static void
 nvmf_ctrlr_stop_keep_alive_timer(struct spdk_nvmf_ctrlr *ctrlr)
 {
@@ -82,12 +98,22 @@ nvmf_ctrlr_stop_keep_alive_timer(struct spdk_nvmf_ctrlr *ctrlr)
 		return;
 	}
 
-	if (ctrlr->keep_alive_poller == NULL) {
+	if (ctrlr->keep_alive_group == NULL) {
 		return;
 	}
 
-	SPDK_DEBUGLOG(nvmf, "Stop keep alive poller\n");
-	spdk_poller_unregister(&ctrlr->keep_alive_poller);
+	SPDK_DEBUGLOG(nvmf, "Stop keep alive timer\n");
+	nvmf_ctrlr_remove_keep_alive_timer(ctrlr);
+}
+
+void
+nvmf_poll_group_stop_keep_alive_timers(struct spdk_nvmf_poll_group *group)
+{
+	struct spdk_nvmf_ctrlr *ctrlr, *tmp;
+
+	TAILQ_FOREACH_SAFE(ctrlr, &group->keep_alive_ctrlrs, keep_alive_link, tmp) {
+		nvmf_ctrlr_remove_keep_alive_timer(ctrlr);
+	}
 }
 
 static void
@@ -159,49 +185,95 @@ nvmf_ctrlr_disconnect_io_qpairs_on_pg(struct spdk_io_channel_iter *i)
 	spdk_for_each_channel_continue(i, _nvmf_ctrlr_disconnect_qpairs_on_pg(i, false));
 }
 
+static void
+nvmf_ctrlr_expire_keep_alive_timer(struct spdk_nvmf_ctrlr *ctrlr)
+{
+	SPDK_NOTICELOG("Disconnecting host %s from subsystem %s due to keep alive timeout.\n",
+		       ctrlr->hostnqn, ctrlr->subsys->subnqn);
+	/* set the Controller Fatal Status bit to '1' */
+	if (ctrlr->vcprop.csts.bits.cfs == 0) {
+		nvmf_ctrlr_set_fatal_status(ctrlr);
+
+		/*
+		 * disconnect qpairs, terminate Transport connection
+		 * destroy ctrlr, break the host to controller association
+		 * disconnect qpairs with qpair->ctrlr == ctrlr
+		 */
+		spdk_for_each_channel(ctrlr->subsys->tgt,
+				      nvmf_ctrlr_disconnect_qpairs_on_pg,
+				      ctrlr,
+				      nvmf_ctrlr_disconnect_qpairs_done);
+	}
+}
+
+static void
+nvmf_ctrlr_insert_keep_alive_timer(struct spdk_nvmf_ctrlr *ctrlr, struct spdk_nvmf_poll_group *group)
+{
+	struct spdk_nvmf_ctrlr *prev;
+
+	ctrlr->keep_alive_deadline_tick = ctrlr->last_keep_alive_tick +
+					  ctrlr->feat.keep_alive_timer.bits.kato * spdk_get_ticks_hz() / UINT64_C(1000);
+	ctrlr->keep_alive_group = group;
+
+	/* Controllers usually share the same timeout, so the new deadline is almost always
+	 * the latest one and searching from the tail keeps the insertion O(1).
+	 */
+	TAILQ_FOREACH_REVERSE(prev, &group->keep_alive_ctrlrs, spdk_nvmf_keep_alive_ctrlrs, keep_alive_link) {
+		if (prev->keep_alive_deadline_tick <= ctrlr->keep_alive_deadline_tick) {
+			TAILQ_INSERT_AFTER(&group->keep_alive_ctrlrs, prev, ctrlr, keep_alive_link);
+			return;
+		}
+	}
+	TAILQ_INSERT_HEAD(&group->keep_alive_ctrlrs, ctrlr, keep_alive_link);
+}
+
+/*
+ * A single poller per poll group checks the keep alive timers of all its controllers. They are
+ * sorted by deadline, computed from the last keep alive when they were inserted, so each poll
+ * only looks at the controllers whose deadline passed. A Keep Alive command only updates
+ * last_keep_alive_tick, and the controller is moved to its new deadline once the old one passes.
+ */
 static int
-nvmf_ctrlr_keep_alive_poll(void *ctx)
+nvmf_poll_group_keep_alive_poll(void *ctx)
 {
-	uint64_t keep_alive_timeout_tick;
+	struct spdk_nvmf_poll_group *group = ctx;
+	struct spdk_nvmf_ctrlr *ctrlr;
 	uint64_t now = spdk_get_ticks();
-	struct spdk_nvmf_ctrlr *ctrlr = ctx;
+	int busy = SPDK_POLLER_IDLE;
 
-	if (ctrlr->in_destruct) {
-		nvmf_ctrlr_stop_keep_alive_timer(ctrlr);
-		return SPDK_POLLER_IDLE;
-	}
+	SPDK_DEBUGLOG(nvmf, "Polling keep alive timeouts\n");
 
-	SPDK_DEBUGLOG(nvmf, "Polling ctrlr keep alive timeout\n");
+	while ((ctrlr = TAILQ_FIRST(&group->keep_alive_ctrlrs)) != NULL &&
+	       ctrlr->keep_alive_deadline_tick < now) {
+		TAILQ_REMOVE(&group->keep_alive_ctrlrs, ctrlr, keep_alive_link);
+		ctrlr->keep_alive_group = NULL;
 
-	/* If the Keep alive feature is in use and the timer expires */
-	keep_alive_timeout_tick = ctrlr->last_keep_alive_tick +
-				  ctrlr->feat.keep_alive_timer.bits.kato * spdk_get_ticks_hz() / UINT64_C(1000);
-	if (now > keep_alive_timeout_tick) {
-		SPDK_NOTICELOG("Disconnecting host %s from subsystem %s due to keep alive timeout.\n",
-			       ctrlr->hostnqn, ctrlr->subsys->subnqn);
-		/* set the Controller Fatal Status bit to '1' */
-		if (ctrlr->vcprop.csts.bits.cfs == 0) {
-			nvmf_ctrlr_set_fatal_status(ctrlr);
+		if (ctrlr->in_destruct) {
+			continue;
+		}
 
-			/*
-			 * disconnect qpairs, terminate Transport connection
-			 * destroy ctrlr, break the host to controller association
-			 * disconnect qpairs with qpair->ctrlr == ctrlr
-			 */
-			spdk_for_each_channel(ctrlr->subsys->tgt,
-					      nvmf_ctrlr_disconnect_qpairs_on_pg,
-					      ctrlr,
-					      nvmf_ctrlr_disconnect_qpairs_done);
-			return SPDK_POLLER_BUSY;
+		/* If the Keep alive feature is in use and the timer expires */
+		nvmf_ctrlr_insert_keep_alive_timer(ctrlr, group);
+		if (ctrlr->keep_alive_deadline_tick < now) {
+			TAILQ_REMOVE(&group->keep_alive_ctrlrs, ctrlr, keep_alive_link);
+			ctrlr->keep_alive_group = NULL;
+			nvmf_ctrlr_expire_keep_alive_timer(ctrlr);
+			busy = SPDK_POLLER_BUSY;
 		}
 	}
 
-	return SPDK_POLLER_IDLE;
+	if (TAILQ_EMPTY(&group->keep_alive_ctrlrs)) {
+		spdk_poller_unregister(&group->keep_alive_poller);
+	}
+
+	return busy;
 }
 
 static void
 nvmf_ctrlr_start_keep_alive_timer(struct spdk_nvmf_ctrlr *ctrlr)
 {
+	struct spdk_nvmf_poll_group *group;
+
 	if (!ctrlr) {
 		SPDK_ERRLOG("Controller is NULL\n");
 		return;
@@ -212,9 +284,13 @@ nvmf_ctrlr_start_keep_alive_timer(struct spdk_nvmf_ctrlr *ctrlr)
 
 		ctrlr->last_keep_alive_tick = spdk_get_ticks();
 
-		SPDK_DEBUGLOG(nvmf, "Ctrlr add keep alive poller\n");
-		ctrlr->keep_alive_poller = SPDK_POLLER_REGISTER(nvmf_ctrlr_keep_alive_poll, ctrlr,
-					   ctrlr->feat.keep_alive_timer.bits.kato * 1000);
+		SPDK_DEBUGLOG(nvmf, "Ctrlr add keep alive timer\n");
+		group = ctrlr->admin_qpair->group;
+		nvmf_ctrlr_insert_keep_alive_timer(ctrlr, group);
+		if (group->keep_alive_poller == NULL) {
+			group->keep_alive_poller = SPDK_POLLER_REGISTER(nvmf_poll_group_keep_alive_poll, group,
+						   NVMF_KEEP_ALIVE_TIMER_PERIOD_US);
+		}
 	}
 }
 
@@ -359,6 +435,8 @@ _nvmf_subsystem_add_ctrlr(void *ctx)
 	if (nvmf_subsystem_add_ctrlr(ctrlr->subsys, ctrlr)) {
 		SPDK_ERRLOG("Unable to add controller to subsystem\n");
 		spdk_bit_array_free(&ctrlr->qpair_mask);
+		spdk_bit_array_free(&ctrlr->visible_ns);
+		free(ctrlr->ns_resv_role);
 		free(ctrlr);
 		qpair->ctrlr = NULL;
 		rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
@@ -530,6 +608,14 @@ nvmf_ctrlr_create(struct spdk_nvmf_subsystem *subsystem,
 	spdk_uuid_copy(&ctrlr->hostid, (struct spdk_uuid *)connect_data->hostid);
 	memcpy(ctrlr->hostnqn, connect_data->hostnqn, SPDK_NVMF_NQN_MAX_LEN);
 
+	if (transport->opts.host_io_stats) {
+		ctrlr->host_stats = nvmf_transport_get_host_stats(transport, ctrlr->hostnqn);
+	}
+
+	if (transport->opts.host_max_iops) {
+		ctrlr->host_admission = nvmf_transport_get_host_admission(transport, ctrlr->hostnqn);
+	}
+
 	ctrlr->visible_ns = spdk_bit_array_create(subsystem->max_nsid);
 	if (!ctrlr->visible_ns) {
 		SPDK_ERRLOG("Failed to allocate visible namespace array\n");
@@ -537,6 +623,15 @@ nvmf_ctrlr_create(struct spdk_nvmf_subsystem *subsystem,
 	}
 	nvmf_ctrlr_init_visible_ns(ctrlr);
 
+	if (subsystem->max_nsid > 0) {
+		/* Filled in by the subsystem thread once the ctrlr is added to the subsystem */
+		ctrlr->ns_resv_role = calloc(subsystem->max_nsid, sizeof(*ctrlr->ns_resv_role));
+		if (!ctrlr->ns_resv_role) {
+			SPDK_ERRLOG("Failed to allocate namespace reservation role array\n");
+			goto err_ns_resv_role;
+		}
+	}
+
 	ctrlr->vcprop.cap.raw = 0;
 	ctrlr->vcprop.cap.bits.cqr = 1; /* NVMe-oF specification required */
 	ctrlr->vcprop.cap.bits.mqes = transport->opts.max_queue_depth -
@@ -596,6 +691,8 @@ nvmf_ctrlr_create(struct spdk_nvmf_subsystem *subsystem,
 
 	return ctrlr;
 err_listener:
+	free(ctrlr->ns_resv_role);
+err_ns_resv_role:
 	spdk_bit_array_free(&ctrlr->visible_ns);
 err_visible_ns:
 	spdk_bit_array_free(&ctrlr->qpair_mask);
@@ -637,6 +734,7 @@ _nvmf_ctrlr_destruct(void *ctx)
 		free(event);
 	}
 	spdk_bit_array_free(&ctrlr->visible_ns);
+	free(ctrlr->ns_resv_role);
 	free(ctrlr);
 }
 
@@ -2037,11 +2135,8 @@ nvmf_ctrlr_set_features_keep_alive_timer(struct spdk_nvmf_request *req)
 	 * update the keep alive poller.
 	 */
 	if (cmd->cdw11_bits.feat_keep_alive_timer.bits.kato != 0) {
-		if (ctrlr->keep_alive_poller != NULL) {
-			spdk_poller_unregister(&ctrlr->keep_alive_poller);
-		}
-		ctrlr->keep_alive_poller = SPDK_POLLER_REGISTER(nvmf_ctrlr_keep_alive_poll, ctrlr,
-					   ctrlr->feat.keep_alive_timer.bits.kato * 1000);
+		nvmf_ctrlr_stop_keep_alive_timer(ctrlr);
+		nvmf_ctrlr_start_keep_alive_timer(ctrlr);
 	}
 
 	SPDK_DEBUGLOG(nvmf, "Set Features - Keep Alive Timer set to %u ms\n",
@@ -2083,7 +2178,7 @@ nvmf_ctrlr_set_features_number_of_queues(struct spdk_nvmf_request *req)
 	return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 }
 
-SPDK_STATIC_ASSERT(sizeof(struct spdk_nvmf_ctrlr) == 4928,
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvmf_ctrlr) == 4976,
 		   "Please check migration fields that need to be added or not");
 
 static void
@@ -4263,22 +4358,6 @@ nvmf_ctrlr_reservation_notice_log(struct spdk_nvmf_ctrlr *ctrlr,
 	spdk_thread_send_msg(ctrlr->thread, _nvmf_ctrlr_add_reservation_log, log);
 }
 
-/* Check from subsystem poll group's namespace information data structure */
-static bool
-nvmf_ns_info_ctrlr_is_registrant(struct spdk_nvmf_subsystem_pg_ns_info *ns_info,
-				 struct spdk_nvmf_ctrlr *ctrlr)
-{
-	uint32_t i;
-
-	for (i = 0; i < SPDK_NVMF_MAX_NUM_REGISTRANTS; i++) {
-		if (!spdk_uuid_compare(&ns_info->reg_hostid[i], &ctrlr->hostid)) {
-			return true;
-		}
-	}
-
-	return false;
-}
-
 /*
  * Check the NVMe command is permitted or not for current controller(Host).
  */
@@ -4290,7 +4369,7 @@ nvmf_ns_reservation_request_check(struct spdk_nvmf_subsystem_pg_ns_info *ns_info
 	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
 	enum spdk_nvme_reservation_type rtype = ns_info->rtype;
 	uint8_t status = SPDK_NVME_SC_SUCCESS;
-	uint8_t racqa;
+	uint8_t racqa, role;
 	bool is_registrant;
 
 	/* No valid reservation */
@@ -4298,12 +4377,13 @@ nvmf_ns_reservation_request_check(struct spdk_nvmf_subsystem_pg_ns_info *ns_info
 		return 0;
 	}
 
-	is_registrant = nvmf_ns_info_ctrlr_is_registrant(ns_info, ctrlr);
+	role = ctrlr->ns_resv_role[cmd->nsid - 1];
+	is_registrant = role & NVMF_NS_RESV_ROLE_REGISTRANT;
 	/* All registrants type and current ctrlr is a valid registrant */
 	if ((rtype == SPDK_NVME_RESERVE_WRITE_EXCLUSIVE_ALL_REGS ||
 	     rtype == SPDK_NVME_RESERVE_EXCLUSIVE_ACCESS_ALL_REGS) && is_registrant) {
 		return 0;
-	} else if (!spdk_uuid_compare(&ns_info->holder_id, &ctrlr->hostid)) {
+	} else if (role & NVMF_NS_RESV_ROLE_HOLDER) {
 		return 0;
 	}
 
@@ -4548,6 +4628,11 @@ nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 	}
 
+	if (spdk_unlikely(ctrlr->host_stats != NULL) &&
+	    req->xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER && req->length > 0) {
+		nvmf_transport_host_stats_record(ctrlr->host_stats, req->length);
+	}
+
 	if (spdk_likely(ctrlr->listener != NULL)) {
 		SPDK_DTRACE_PROBE3_TICKS(nvmf_request_io_exec_path, req,
 					 ctrlr->listener->trid->traddr,
@@ -4557,7 +4642,8 @@ nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 	/* scan-build falsely reporting dereference of null pointer */
 	assert(group != NULL && group->sgroups != NULL);
 	ns_info = &group->sgroups[ctrlr->subsys->id].ns_info[nsid - 1];
-	if (nvmf_ns_reservation_request_check(ns_info, ctrlr, req)) {
+	if (spdk_unlikely(ns_info->rtype != 0) &&
+	    nvmf_ns_reservation_request_check(ns_info, ctrlr, req)) {
 		SPDK_DEBUGLOG(nvmf, "Reservation Conflict for nsid %u, opcode %u\n",
 			      cmd->nsid, cmd->opc);
 		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
@@ -4675,6 +4761,13 @@ spdk_nvmf_request_free(struct spdk_nvmf_request *req)
 	return 0;
 }
 
+static inline bool
+nvmf_request_is_keep_alive(struct spdk_nvmf_request *req)
+{
+	return nvmf_qpair_is_admin_queue(req->qpair) &&
+	       req->cmd->nvme_cmd.opc == SPDK_NVME_OPC_KEEP_ALIVE;
+}
+
 static void
 _nvmf_request_complete(void *ctx)
 {
@@ -4684,6 +4777,7 @@ _nvmf_request_complete(void *ctx)
 	struct spdk_nvmf_subsystem_poll_group *sgroup = NULL;
 	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
 	bool is_aer = false;
+	bool is_keep_alive = false;
 	uint32_t nsid;
 	bool paused;
 	uint8_t opcode;
@@ -4699,6 +4793,7 @@ _nvmf_request_complete(void *ctx)
 		sgroup = &qpair->group->sgroups[qpair->ctrlr->subsys->id];
 		assert(sgroup != NULL);
 		is_aer = req->cmd->nvme_cmd.opc == SPDK_NVME_OPC_ASYNC_EVENT_REQUEST;
+		is_keep_alive = nvmf_request_is_keep_alive(req);
 		if (spdk_likely(qpair->qid != 0)) {
 			qpair->group->stat.completed_nvme_io++;
 		}
@@ -4748,8 +4843,8 @@ _nvmf_request_complete(void *ctx)
 		SPDK_ERRLOG("Transport request completion error!\n");
 	}
 
-	/* AER cmd is an exception */
-	if (spdk_likely(sgroup && !is_aer)) {
+	/* AER and Keep Alive cmds are exceptions */
+	if (spdk_likely(sgroup && !is_aer && !is_keep_alive)) {
 		if (spdk_unlikely(opcode == SPDK_NVME_OPC_FABRIC ||
 				  nvmf_qpair_is_admin_queue(qpair))) {
 			assert(sgroup->mgmt_io_outstanding > 0);
@@ -4825,6 +4920,13 @@ nvmf_check_subsystem_active(struct spdk_nvmf_request *req)
 
 	if (spdk_unlikely(req->cmd->nvmf_cmd.opcode == SPDK_NVME_OPC_FABRIC ||
 			  nvmf_qpair_is_admin_queue(qpair))) {
+		if (nvmf_request_is_keep_alive(req)) {
+			/* Keep Alive doesn't depend on the subsystem, so it isn't held while the
+			 * subsystem is paused, e.g. to change one of its namespaces.  Otherwise a
+			 * long pause could time out the controller along with the I/O to all of
+			 * its other namespaces. */
+			return true;
+		}
 		if (sgroup->state != SPDK_NVMF_SUBSYSTEM_ACTIVE) {
 			/* The subsystem is not currently active. Queue this request. */
 			TAILQ_INSERT_TAIL(&sgroup->queued, req, link);
@@ -20,6 +20,24 @@
 
 #include "spdk/log.h"
 
+/* Maximum number of generated discovery log pages kept by a target */
+#define NVMF_DISCOVERY_LOG_CACHE_SIZE 64
+
+/*
+ * A discovery log page generated for a host. It is valid as long as the generation counter of
+ * the target doesn't change, and it is reused for the hosts with the same NQN connected through
+ * a listener that matches the discovery filter in the same way.
+ */
+struct nvmf_discovery_log_cache_entry {
+	char					hostnqn[SPDK_NVMF_NQN_MAX_LEN + 1];
+	struct spdk_nvme_transport_id		cmd_source_trid;
+	uint32_t				filter;
+	uint64_t				genctr;
+	size_t					log_page_size;
+	struct spdk_nvmf_discovery_log_page	*log_page;
+	TAILQ_ENTRY(nvmf_discovery_log_cache_entry) link;
+};
+
 void
 spdk_nvmf_send_discovery_log_notice(struct spdk_nvmf_tgt *tgt, const char *hostnqn)
 {
@@ -202,6 +220,104 @@ nvmf_generate_discovery_log(struct spdk_nvmf_tgt *tgt, const char *hostnqn, size
 	return disc_log;
 }
 
+static void
+nvmf_discovery_log_cache_entry_free(struct nvmf_discovery_log_cache_entry *entry)
+{
+	free(entry->log_page);
+	free(entry);
+}
+
+void
+nvmf_tgt_free_discovery_log_cache(struct spdk_nvmf_tgt *tgt)
+{
+	struct nvmf_discovery_log_cache_entry *entry;
+
+	while ((entry = TAILQ_FIRST(&tgt->discovery_log_cache))) {
+		TAILQ_REMOVE(&tgt->discovery_log_cache, entry, link);
+		nvmf_discovery_log_cache_entry_free(entry);
+	}
+	tgt->num_discovery_log_cache_entries = 0;
+}
+
+/* Must be called with the tgt->mutex held */
+static struct nvmf_discovery_log_cache_entry *
+nvmf_discovery_log_cache_find(struct spdk_nvmf_tgt *tgt, const char *hostnqn,
+			      const struct spdk_nvme_transport_id *cmd_source_trid)
+{
+	struct nvmf_discovery_log_cache_entry *entry;
+
+	TAILQ_FOREACH(entry, &tgt->discovery_log_cache, link) {
+		if (entry->filter == tgt->discovery_filter &&
+		    strcmp(entry->hostnqn, hostnqn) == 0 &&
+		    nvmf_discovery_compare_trid(entry->filter, &entry->cmd_source_trid, cmd_source_trid)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Get the discovery log page of a host, from the cache if it's still current. Returns with the
+ * tgt->mutex held if the entry was found or generated, so that it can't be freed while copied.
+ */
+static struct nvmf_discovery_log_cache_entry *
+nvmf_discovery_log_cache_get(struct spdk_nvmf_tgt *tgt, const char *hostnqn,
+			     struct spdk_nvme_transport_id *cmd_source_trid)
+{
+	struct nvmf_discovery_log_cache_entry *entry;
+	struct spdk_nvmf_discovery_log_page *log_page;
+	size_t log_page_size = 0;
+	uint64_t genctr;
+
+	pthread_mutex_lock(&tgt->mutex);
+	entry = nvmf_discovery_log_cache_find(tgt, hostnqn, cmd_source_trid);
+	if (entry != NULL && entry->genctr == tgt->discovery_genctr) {
+		/* Keep the recently used entries at the head, the tail is evicted first */
+		TAILQ_REMOVE(&tgt->discovery_log_cache, entry, link);
+		TAILQ_INSERT_HEAD(&tgt->discovery_log_cache, entry, link);
+		return entry;
+	}
+	pthread_mutex_unlock(&tgt->mutex);
+
+	/* The log page is generated without the lock, as it takes the subsystem locks. */
+	genctr = tgt->discovery_genctr;
+	log_page = nvmf_generate_discovery_log(tgt, hostnqn, &log_page_size, cmd_source_trid);
+	if (log_page == NULL) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&tgt->mutex);
+	entry = nvmf_discovery_log_cache_find(tgt, hostnqn, cmd_source_trid);
+	if (entry != NULL) {
+		TAILQ_REMOVE(&tgt->discovery_log_cache, entry, link);
+		free(entry->log_page);
+	} else if (tgt->num_discovery_log_cache_entries < NVMF_DISCOVERY_LOG_CACHE_SIZE) {
+		entry = calloc(1, sizeof(*entry));
+		if (entry == NULL) {
+			pthread_mutex_unlock(&tgt->mutex);
+			SPDK_ERRLOG("Discovery log cache memory allocation error\n");
+			free(log_page);
+			return NULL;
+		}
+		tgt->num_discovery_log_cache_entries++;
+	} else {
+		entry = TAILQ_LAST(&tgt->discovery_log_cache, nvmf_discovery_log_cache);
+		TAILQ_REMOVE(&tgt->discovery_log_cache, entry, link);
+		free(entry->log_page);
+	}
+
+	snprintf(entry->hostnqn, sizeof(entry->hostnqn), "%s", hostnqn);
+	entry->cmd_source_trid = *cmd_source_trid;
+	entry->filter = tgt->discovery_filter;
+	entry->genctr = genctr;
+	entry->log_page = log_page;
+	entry->log_page_size = log_page_size;
+	TAILQ_INSERT_HEAD(&tgt->discovery_log_cache, entry, link);
+
+	return entry;
+}
+
 void
 nvmf_get_discovery_log_page(struct spdk_nvmf_tgt *tgt, const char *hostnqn, struct iovec *iov,
 			    uint32_t iovcnt, uint64_t offset, uint32_t length,
@@ -212,11 +328,15 @@ nvmf_get_discovery_log_page(struct spdk_nvmf_tgt *tgt, const char *hostnqn, stru
 	struct iovec *tmp;
 	size_t log_page_size = 0;
 	struct spdk_nvmf_discovery_log_page *discovery_log_page;
+	struct nvmf_discovery_log_cache_entry *entry;
 
-	discovery_log_page = nvmf_generate_discovery_log(tgt, hostnqn, &log_page_size, cmd_source_trid);
+	entry = nvmf_discovery_log_cache_get(tgt, hostnqn, cmd_source_trid);
 
 	/* Copy the valid part of the discovery log page, if any */
-	if (discovery_log_page) {
+	if (entry) {
+		discovery_log_page = entry->log_page;
+		log_page_size = entry->log_page_size;
+
 		for (tmp = iov; tmp < iov + iovcnt; tmp++) {
 			copy_len = spdk_min(tmp->iov_len, length);
 			copy_len = spdk_min(log_page_size - offset, copy_len);
@@ -239,6 +359,6 @@ nvmf_get_discovery_log_page(struct spdk_nvmf_tgt *tgt, const char *hostnqn, stru
 			memset((char *)tmp->iov_base, 0, tmp->iov_len);
 		}
 
-		free(discovery_log_page);
+		pthread_mutex_unlock(&tgt->mutex);
 	}
 }
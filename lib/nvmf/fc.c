@@ -19,6 +19,7 @@
 #include "spdk/endian.h"
 #include "spdk/log.h"
 #include "spdk/thread.h"
+#include "spdk/json.h"
 
 #include "nvmf_fc.h"
 #include "fc_lld.h"
@@ -1527,6 +1528,7 @@ nvmf_fc_hwqp_handle_request(struct spdk_nvmf_fc_hwqp *hwqp, struct spdk_nvmf_fc_
 	if (fc_req == NULL) {
 		return -ENOMEM;
 	}
+	hwqp->num_reqs++;
 
 	fc_req->req.length = from_be32(&cmd_iu->data_len);
 	fc_req->req.qpair = &fc_conn->qpair;
@@ -2335,6 +2337,34 @@ nvmf_fc_qpair_abort_request(struct spdk_nvmf_qpair *qpair,
 	spdk_nvmf_request_complete(req);
 }
 
+static void
+nvmf_fc_poll_group_dump_stat(struct spdk_nvmf_transport_poll_group *group,
+			     struct spdk_json_write_ctx *w)
+{
+	struct spdk_nvmf_fc_poll_group *fgroup;
+	struct spdk_nvmf_fc_hwqp *hwqp;
+
+	fgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_fc_poll_group, group);
+
+	spdk_json_write_named_array_begin(w, "hwqps");
+
+	TAILQ_FOREACH(hwqp, &fgroup->hwqp_list, link) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_uint32(w, "port_hdl", hwqp->fc_port->port_hdl);
+		spdk_json_write_named_uint32(w, "hwqp_id", hwqp->hwqp_id);
+		spdk_json_write_named_uint32(w, "lcore", hwqp->lcore_id);
+		spdk_json_write_named_uint32(w, "num_conns", hwqp->num_conns);
+		spdk_json_write_named_uint64(w, "requests", hwqp->num_reqs);
+		spdk_json_write_named_uint32(w, "aborted", hwqp->counters.num_aborted);
+		spdk_json_write_named_uint32(w, "abts_sent", hwqp->counters.num_abts_sent);
+		spdk_json_write_named_uint32(w, "no_xchg", hwqp->counters.no_xchg);
+		spdk_json_write_named_uint32(w, "buf_alloc_err", hwqp->counters.buf_alloc_err);
+		spdk_json_write_object_end(w);
+	}
+
+	spdk_json_write_array_end(w);
+}
+
 const struct spdk_nvmf_transport_ops spdk_nvmf_transport_fc = {
 	.name = "FC",
 	.type = (enum spdk_nvme_transport_type) SPDK_NVMF_TRTYPE_FC,
@@ -2351,6 +2381,7 @@ const struct spdk_nvmf_transport_ops spdk_nvmf_transport_fc = {
 	.poll_group_destroy = nvmf_fc_poll_group_destroy,
 	.poll_group_add = nvmf_fc_poll_group_add,
 	.poll_group_poll = nvmf_fc_poll_group_poll,
+	.poll_group_dump_stat = nvmf_fc_poll_group_dump_stat,
 
 	.req_complete = nvmf_fc_request_complete,
 	.req_free = nvmf_fc_request_free,
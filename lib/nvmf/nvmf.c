@@ -156,6 +156,8 @@ nvmf_tgt_cleanup_poll_group(struct spdk_nvmf_poll_group *group)
 	struct spdk_nvmf_subsystem_poll_group *sgroup;
 	uint32_t sid, nsid;
 
+	nvmf_poll_group_stop_keep_alive_timers(group);
+
 	TAILQ_FOREACH_SAFE(tgroup, &group->tgroups, link, tmp) {
 		TAILQ_REMOVE(&group->tgroups, tgroup, link);
 		nvmf_transport_poll_group_destroy(tgroup);
@@ -242,6 +244,7 @@ nvmf_tgt_create_poll_group(void *io_device, void *ctx_buf)
 	group->tgt = tgt;
 	TAILQ_INIT(&group->tgroups);
 	TAILQ_INIT(&group->qpairs);
+	TAILQ_INIT(&group->keep_alive_ctrlrs);
 	group->thread = thread;
 	pthread_mutex_init(&group->mutex, NULL);
 
@@ -373,6 +376,7 @@ spdk_nvmf_tgt_create(struct spdk_nvmf_target_opts *_opts)
 	TAILQ_INIT(&tgt->transports);
 	TAILQ_INIT(&tgt->poll_groups);
 	TAILQ_INIT(&tgt->referrals);
+	TAILQ_INIT(&tgt->discovery_log_cache);
 	tgt->num_poll_groups = 0;
 
 	tgt->subsystem_ids = spdk_bit_array_create(tgt->max_subsystems);
@@ -412,6 +416,7 @@ _nvmf_tgt_destroy_next_transport(void *ctx)
 		spdk_nvmf_tgt_destroy_done_fn *destroy_cb_fn = tgt->destroy_cb_fn;
 		void *destroy_cb_arg = tgt->destroy_cb_arg;
 
+		nvmf_tgt_free_discovery_log_cache(tgt);
 		pthread_mutex_destroy(&tgt->mutex);
 		free(tgt);
 
@@ -1464,9 +1469,8 @@ poll_group_update_subsystem(struct spdk_nvmf_poll_group *group,
 			    struct spdk_nvmf_subsystem *subsystem)
 {
 	struct spdk_nvmf_subsystem_poll_group *sgroup;
-	uint32_t i, j;
+	uint32_t i;
 	struct spdk_nvmf_ns *ns;
-	struct spdk_nvmf_registrant *reg, *tmp;
 	struct spdk_io_channel *ch;
 	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
 	struct spdk_nvmf_ctrlr *ctrlr;
@@ -1555,19 +1559,6 @@ poll_group_update_subsystem(struct spdk_nvmf_poll_group *group,
 			ns_info->anagrpid = ns->anagrpid;
 			ns_info->crkey = ns->crkey;
 			ns_info->rtype = ns->rtype;
-			if (ns->holder) {
-				ns_info->holder_id = ns->holder->hostid;
-			}
-
-			memset(&ns_info->reg_hostid, 0, SPDK_NVMF_MAX_NUM_REGISTRANTS * sizeof(struct spdk_uuid));
-			j = 0;
-			TAILQ_FOREACH_SAFE(reg, &ns->registrants, link, tmp) {
-				if (j >= SPDK_NVMF_MAX_NUM_REGISTRANTS) {
-					SPDK_ERRLOG("Maximum %u registrants can support.\n", SPDK_NVMF_MAX_NUM_REGISTRANTS);
-					return -EINVAL;
-				}
-				ns_info->reg_hostid[j++] = reg->hostid;
-			}
 		}
 	}
 
@@ -1900,6 +1891,7 @@ spdk_nvmf_poll_group_dump_stat(struct spdk_nvmf_poll_group *group, struct spdk_j
 	spdk_json_write_named_uint32(w, "current_io_qpairs", group->stat.current_io_qpairs);
 	spdk_json_write_named_uint64(w, "pending_bdev_io", group->stat.pending_bdev_io);
 	spdk_json_write_named_uint64(w, "completed_nvme_io", group->stat.completed_nvme_io);
+	spdk_json_write_named_uint64(w, "rejected_nvme_io", group->stat.rejected_nvme_io);
 
 	spdk_json_write_named_array_begin(w, "transports");
 
@@ -303,6 +303,7 @@ struct spdk_nvmf_fc_hwqp {
 	TAILQ_HEAD(, spdk_nvmf_fc_request) in_use_reqs;
 
 	struct spdk_nvmf_fc_errors counters;
+	uint64_t num_reqs;	/* number of NVMe commands received on the queue */
 
 	/* Pending LS request waiting for FC resource */
 	TAILQ_HEAD(, spdk_nvmf_fc_ls_rqst) ls_pending_queue;
@@ -69,6 +69,10 @@ struct spdk_nvmf_tgt {
 	TAILQ_HEAD(, spdk_nvmf_poll_group)	poll_groups;
 	TAILQ_HEAD(, spdk_nvmf_referral)	referrals;
 
+	/* Discovery log pages generated for hosts, protected by mutex */
+	TAILQ_HEAD(nvmf_discovery_log_cache, nvmf_discovery_log_cache_entry) discovery_log_cache;
+	uint32_t				num_discovery_log_cache_entries;
+
 	/* Used for round-robin assignment of connections to poll groups */
 	struct spdk_nvmf_poll_group		*next_poll_group;
 
@@ -114,23 +118,21 @@ struct spdk_nvmf_referral {
 };
 
 struct spdk_nvmf_subsystem_pg_ns_info {
+	/* The fields accessed for each I/O are kept together in the first cache line */
 	struct spdk_io_channel		*channel;
-	struct spdk_uuid		uuid;
-	/* current reservation key, no reservation if the value is 0 */
-	uint64_t			crkey;
-	/* reservation type */
-	enum spdk_nvme_reservation_type	rtype;
-	/* Host ID which holds the reservation */
-	struct spdk_uuid		holder_id;
-	/* Host ID for the registrants with the namespace */
-	struct spdk_uuid		reg_hostid[SPDK_NVMF_MAX_NUM_REGISTRANTS];
-	uint64_t			num_blocks;
-	uint32_t			anagrpid;
-
 	/* I/O outstanding to this namespace */
 	uint64_t			io_outstanding;
 	enum spdk_nvmf_subsystem_state	state;
+	/* reservation type */
+	enum spdk_nvme_reservation_type	rtype;
+	uint32_t			anagrpid;
+	uint64_t			num_blocks;
+	struct spdk_uuid		uuid;
+	/* current reservation key, no reservation if the value is 0 */
+	uint64_t			crkey;
 };
+SPDK_STATIC_ASSERT(offsetof(struct spdk_nvmf_subsystem_pg_ns_info, rtype) < 64,
+		   "Incorrect pg_ns_info layout");
 
 typedef void(*spdk_nvmf_poll_group_mod_done)(void *cb_arg, int status);
 
@@ -207,6 +209,9 @@ struct spdk_nvmf_async_event_completion {
 	STAILQ_ENTRY(spdk_nvmf_async_event_completion)	link;
 };
 
+#define NVMF_NS_RESV_ROLE_REGISTRANT	(1u << 0)
+#define NVMF_NS_RESV_ROLE_HOLDER	(1u << 1)
+
 /*
  * This structure represents an NVMe-oF controller,
  * which is like a "session" in networking terms.
@@ -216,6 +221,9 @@ struct spdk_nvmf_ctrlr {
 	char				hostnqn[SPDK_NVMF_NQN_MAX_LEN + 1];
 	struct spdk_nvmf_subsystem	*subsys;
 	struct spdk_bit_array		*visible_ns;
+	/* Reservation role (NVMF_NS_RESV_ROLE_*) of the host on each namespace, indexed by
+	 * nsid - 1.  Kept up to date by the subsystem thread on each reservation change. */
+	uint8_t				*ns_resv_role;
 
 	struct spdk_nvmf_ctrlr_data	cdata;
 
@@ -229,6 +237,12 @@ struct spdk_nvmf_ctrlr {
 
 	const struct spdk_nvmf_subsystem_listener	*listener;
 
+	/* Set if the transport tracks the I/O sizes of each host */
+	struct nvmf_transport_host_stats	*host_stats;
+
+	/* Set if the transport limits the I/O commands of each host */
+	struct nvmf_transport_host_admission	*host_admission;
+
 	struct spdk_nvmf_request *aer_req[SPDK_NVMF_MAX_ASYNC_EVENTS];
 	STAILQ_HEAD(, spdk_nvmf_async_event_completion) async_events;
 	uint64_t notice_aen_mask;
@@ -244,7 +258,10 @@ struct spdk_nvmf_ctrlr {
 
 	/* Time to trigger keep-alive--poller_time = now_tick + period */
 	uint64_t			last_keep_alive_tick;
-	struct spdk_poller		*keep_alive_poller;
+	/* Poll group checking the keep alive timer, NULL if it isn't running */
+	struct spdk_nvmf_poll_group	*keep_alive_group;
+	uint64_t			keep_alive_deadline_tick;
+	TAILQ_ENTRY(spdk_nvmf_ctrlr)	keep_alive_link;
 
 	struct spdk_poller		*association_timer;
 
@@ -379,8 +396,10 @@ void nvmf_poll_group_resume_subsystem(struct spdk_nvmf_poll_group *group,
 void nvmf_get_discovery_log_page(struct spdk_nvmf_tgt *tgt, const char *hostnqn, struct iovec *iov,
 				 uint32_t iovcnt, uint64_t offset, uint32_t length,
 				 struct spdk_nvme_transport_id *cmd_source_trid);
+void nvmf_tgt_free_discovery_log_cache(struct spdk_nvmf_tgt *tgt);
 
 void nvmf_ctrlr_destruct(struct spdk_nvmf_ctrlr *ctrlr);
+void nvmf_poll_group_stop_keep_alive_timers(struct spdk_nvmf_poll_group *group);
 int nvmf_ctrlr_process_admin_cmd(struct spdk_nvmf_request *req);
 int nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req);
 bool nvmf_ctrlr_dsm_supported(struct spdk_nvmf_ctrlr *ctrlr);
@@ -439,6 +458,8 @@ struct spdk_nvmf_listener *nvmf_transport_find_listener(
 	const struct spdk_nvme_transport_id *trid);
 void nvmf_transport_dump_opts(struct spdk_nvmf_transport *transport, struct spdk_json_write_ctx *w,
 			      bool named);
+void nvmf_transport_dump_host_stats(struct spdk_nvmf_transport *transport,
+				    struct spdk_json_write_ctx *w);
 void nvmf_transport_listen_dump_trid(const struct spdk_nvme_transport_id *trid,
 				     struct spdk_json_write_ctx *w);
 
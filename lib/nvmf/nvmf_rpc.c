@@ -1489,29 +1489,37 @@ nvmf_rpc_ns_resumed(struct spdk_nvmf_subsystem *subsystem,
 }
 
 static void
-nvmf_rpc_ns_paused(struct spdk_nvmf_subsystem *subsystem,
-		   void *cb_arg, int status)
+nvmf_rpc_ns_params_to_opts(const struct nvmf_rpc_ns_params *ns_params,
+			   const struct spdk_json_val *params,
+			   struct spdk_nvmf_ns_opts *ns_opts)
 {
-	struct nvmf_rpc_ns_ctx *ctx = cb_arg;
-	struct spdk_nvmf_ns_opts ns_opts;
+	spdk_nvmf_ns_opts_get_defaults(ns_opts, sizeof(*ns_opts));
+	ns_opts->nsid = ns_params->nsid;
+	ns_opts->transport_specific = params;
 
-	spdk_nvmf_ns_opts_get_defaults(&ns_opts, sizeof(ns_opts));
-	ns_opts.nsid = ctx->ns_params.nsid;
-	ns_opts.transport_specific = ctx->params;
+	SPDK_STATIC_ASSERT(sizeof(ns_opts->nguid) == sizeof(ns_params->nguid), "size mismatch");
+	memcpy(ns_opts->nguid, ns_params->nguid, sizeof(ns_opts->nguid));
 
-	SPDK_STATIC_ASSERT(sizeof(ns_opts.nguid) == sizeof(ctx->ns_params.nguid), "size mismatch");
-	memcpy(ns_opts.nguid, ctx->ns_params.nguid, sizeof(ns_opts.nguid));
+	SPDK_STATIC_ASSERT(sizeof(ns_opts->eui64) == sizeof(ns_params->eui64), "size mismatch");
+	memcpy(ns_opts->eui64, ns_params->eui64, sizeof(ns_opts->eui64));
 
-	SPDK_STATIC_ASSERT(sizeof(ns_opts.eui64) == sizeof(ctx->ns_params.eui64), "size mismatch");
-	memcpy(ns_opts.eui64, ctx->ns_params.eui64, sizeof(ns_opts.eui64));
-
-	if (!spdk_uuid_is_null(&ctx->ns_params.uuid)) {
-		ns_opts.uuid = ctx->ns_params.uuid;
+	if (!spdk_uuid_is_null(&ns_params->uuid)) {
+		ns_opts->uuid = ns_params->uuid;
 	}
 
-	ns_opts.anagrpid = ctx->ns_params.anagrpid;
-	ns_opts.no_auto_visible = ctx->ns_params.no_auto_visible;
-	ns_opts.hide_metadata = ctx->ns_params.hide_metadata;
+	ns_opts->anagrpid = ns_params->anagrpid;
+	ns_opts->no_auto_visible = ns_params->no_auto_visible;
+	ns_opts->hide_metadata = ns_params->hide_metadata;
+}
+
+static void
+nvmf_rpc_ns_paused(struct spdk_nvmf_subsystem *subsystem,
+		   void *cb_arg, int status)
+{
+	struct nvmf_rpc_ns_ctx *ctx = cb_arg;
+	struct spdk_nvmf_ns_opts ns_opts;
+
+	nvmf_rpc_ns_params_to_opts(&ctx->ns_params, ctx->params, &ns_opts);
 
 	ctx->ns_params.nsid = spdk_nvmf_subsystem_add_ns_ext(subsystem, ctx->ns_params.bdev_name,
 			      &ns_opts, sizeof(ns_opts),
@@ -1583,6 +1591,234 @@ rpc_nvmf_subsystem_add_ns(struct spdk_jsonrpc_request *request,
 }
 SPDK_RPC_REGISTER("nvmf_subsystem_add_ns", rpc_nvmf_subsystem_add_ns, SPDK_RPC_RUNTIME)
 
+#define NVMF_RPC_ADD_NS_BULK_MAX 256
+
+struct nvmf_rpc_ns_params_list {
+	size_t num_namespaces;
+	struct nvmf_rpc_ns_params namespaces[NVMF_RPC_ADD_NS_BULK_MAX];
+};
+
+struct nvmf_rpc_ns_bulk_ctx {
+	char *nqn;
+	char *tgt_name;
+	struct nvmf_rpc_ns_params_list ns_list;
+
+	struct spdk_jsonrpc_request *request;
+	const struct spdk_json_val *params;
+	/* Number of namespaces added so far, in the order of ns_list. */
+	size_t num_added;
+	bool response_sent;
+};
+
+static int
+decode_rpc_ns_params_list(const struct spdk_json_val *val, void *out)
+{
+	struct nvmf_rpc_ns_params_list *ns_list = out;
+
+	return spdk_json_decode_array(val, decode_rpc_ns_params, ns_list->namespaces,
+				      NVMF_RPC_ADD_NS_BULK_MAX, &ns_list->num_namespaces,
+				      sizeof(struct nvmf_rpc_ns_params));
+}
+
+static const struct spdk_json_object_decoder nvmf_rpc_subsystem_ns_bulk_decoder[] = {
+	{"nqn", offsetof(struct nvmf_rpc_ns_bulk_ctx, nqn), spdk_json_decode_string},
+	{"namespaces", offsetof(struct nvmf_rpc_ns_bulk_ctx, ns_list), decode_rpc_ns_params_list},
+	{"tgt_name", offsetof(struct nvmf_rpc_ns_bulk_ctx, tgt_name), spdk_json_decode_string, true},
+};
+
+static void
+nvmf_rpc_ns_bulk_ctx_free(struct nvmf_rpc_ns_bulk_ctx *ctx)
+{
+	size_t i;
+
+	for (i = 0; i < ctx->ns_list.num_namespaces; i++) {
+		free(ctx->ns_list.namespaces[i].bdev_name);
+		free(ctx->ns_list.namespaces[i].ptpl_file);
+	}
+
+	free(ctx->nqn);
+	free(ctx->tgt_name);
+	free(ctx);
+}
+
+/* Must be called with the subsystem paused. */
+static int
+nvmf_rpc_ns_bulk_remove_added(struct spdk_nvmf_subsystem *subsystem,
+			      struct nvmf_rpc_ns_bulk_ctx *ctx)
+{
+	int rc;
+
+	while (ctx->num_added > 0) {
+		rc = spdk_nvmf_subsystem_remove_ns(subsystem,
+						   ctx->ns_list.namespaces[ctx->num_added - 1].nsid);
+		if (rc != 0) {
+			return rc;
+		}
+		ctx->num_added--;
+	}
+
+	return 0;
+}
+
+static void
+nvmf_rpc_ns_bulk_failback_resumed(struct spdk_nvmf_subsystem *subsystem,
+				  void *cb_arg, int status)
+{
+	struct nvmf_rpc_ns_bulk_ctx *ctx = cb_arg;
+	struct spdk_jsonrpc_request *request = ctx->request;
+
+	if (status) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Unable to add namespaces, subsystem in invalid state");
+	} else {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Unable to add namespaces, subsystem in active state");
+	}
+
+	nvmf_rpc_ns_bulk_ctx_free(ctx);
+}
+
+static void
+nvmf_rpc_ns_bulk_resumed(struct spdk_nvmf_subsystem *subsystem,
+			 void *cb_arg, int status)
+{
+	struct nvmf_rpc_ns_bulk_ctx *ctx = cb_arg;
+	struct spdk_jsonrpc_request *request = ctx->request;
+	struct spdk_json_write_ctx *w;
+	size_t i;
+
+	/* The namespaces were added, but the subsystem couldn't be resumed. */
+	if (status && !ctx->response_sent) {
+		if (nvmf_rpc_ns_bulk_remove_added(subsystem, ctx) != 0) {
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+							 "Unable to add namespaces, subsystem in invalid state");
+			nvmf_rpc_ns_bulk_ctx_free(ctx);
+			return;
+		}
+
+		if (spdk_nvmf_subsystem_resume(subsystem, nvmf_rpc_ns_bulk_failback_resumed, ctx)) {
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
+			nvmf_rpc_ns_bulk_ctx_free(ctx);
+		}
+
+		return;
+	}
+
+	if (!ctx->response_sent) {
+		w = spdk_jsonrpc_begin_result(request);
+		spdk_json_write_array_begin(w);
+		for (i = 0; i < ctx->num_added; i++) {
+			spdk_json_write_uint32(w, ctx->ns_list.namespaces[i].nsid);
+		}
+		spdk_json_write_array_end(w);
+		spdk_jsonrpc_end_result(request, w);
+	}
+
+	nvmf_rpc_ns_bulk_ctx_free(ctx);
+}
+
+static void
+nvmf_rpc_ns_bulk_paused(struct spdk_nvmf_subsystem *subsystem,
+			void *cb_arg, int status)
+{
+	struct nvmf_rpc_ns_bulk_ctx *ctx = cb_arg;
+	struct nvmf_rpc_ns_params *ns_params;
+	struct spdk_nvmf_ns_opts ns_opts;
+	uint32_t nsid;
+
+	if (status) {
+		spdk_jsonrpc_send_error_response(ctx->request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Unable to pause subsystem");
+		nvmf_rpc_ns_bulk_ctx_free(ctx);
+		return;
+	}
+
+	/* All namespaces are added under a single pause of the subsystem. Either all of them
+	 * are added, or none is. */
+	while (ctx->num_added < ctx->ns_list.num_namespaces) {
+		ns_params = &ctx->ns_list.namespaces[ctx->num_added];
+		nvmf_rpc_ns_params_to_opts(ns_params, ctx->params, &ns_opts);
+
+		nsid = spdk_nvmf_subsystem_add_ns_ext(subsystem, ns_params->bdev_name,
+						      &ns_opts, sizeof(ns_opts), ns_params->ptpl_file);
+		if (nsid == 0) {
+			SPDK_ERRLOG("Unable to add namespace %zu (bdev %s)\n", ctx->num_added,
+				    ns_params->bdev_name);
+			spdk_jsonrpc_send_error_response_fmt(ctx->request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+							     "Unable to add namespace %zu (bdev %s)",
+							     ctx->num_added, ns_params->bdev_name);
+			ctx->response_sent = true;
+			break;
+		}
+
+		ns_params->nsid = nsid;
+		ctx->num_added++;
+	}
+
+	if (ctx->response_sent && nvmf_rpc_ns_bulk_remove_added(subsystem, ctx) != 0) {
+		SPDK_ERRLOG("Unable to remove the namespaces added by a failed request\n");
+	}
+
+	if (spdk_nvmf_subsystem_resume(subsystem, nvmf_rpc_ns_bulk_resumed, ctx)) {
+		if (!ctx->response_sent) {
+			spdk_jsonrpc_send_error_response(ctx->request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+							 "Internal error");
+		}
+		nvmf_rpc_ns_bulk_ctx_free(ctx);
+	}
+}
+
+static void
+rpc_nvmf_subsystem_add_ns_bulk(struct spdk_jsonrpc_request *request,
+			       const struct spdk_json_val *params)
+{
+	struct nvmf_rpc_ns_bulk_ctx *ctx;
+	struct spdk_nvmf_subsystem *subsystem;
+	struct spdk_nvmf_tgt *tgt;
+	int rc;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Out of memory");
+		return;
+	}
+
+	if (spdk_json_decode_object_relaxed(params, nvmf_rpc_subsystem_ns_bulk_decoder,
+					    SPDK_COUNTOF(nvmf_rpc_subsystem_ns_bulk_decoder), ctx)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		nvmf_rpc_ns_bulk_ctx_free(ctx);
+		return;
+	}
+
+	ctx->request = request;
+	ctx->params = params;
+
+	tgt = spdk_nvmf_get_tgt(ctx->tgt_name);
+	if (!tgt) {
+		SPDK_ERRLOG("Unable to find a target object.\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Unable to find a target.");
+		nvmf_rpc_ns_bulk_ctx_free(ctx);
+		return;
+	}
+
+	subsystem = spdk_nvmf_tgt_find_subsystem(tgt, ctx->nqn);
+	if (!subsystem) {
+		SPDK_ERRLOG("Unable to find subsystem with NQN %s\n", ctx->nqn);
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		nvmf_rpc_ns_bulk_ctx_free(ctx);
+		return;
+	}
+
+	rc = spdk_nvmf_subsystem_pause(subsystem, 0, nvmf_rpc_ns_bulk_paused, ctx);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
+		nvmf_rpc_ns_bulk_ctx_free(ctx);
+	}
+}
+SPDK_RPC_REGISTER("nvmf_subsystem_add_ns_bulk", rpc_nvmf_subsystem_add_ns_bulk, SPDK_RPC_RUNTIME)
+
 struct nvmf_rpc_ana_group_ctx {
 	char *nqn;
 	char *tgt_name;
@@ -2510,6 +2746,10 @@ static const struct spdk_json_object_decoder nvmf_rpc_create_transport_decoder[]
 		"zcopy", offsetof(struct nvmf_rpc_create_transport_ctx, opts.zcopy),
 		spdk_json_decode_bool, true
 	},
+	{
+		"host_io_stats", offsetof(struct nvmf_rpc_create_transport_ctx, opts.host_io_stats),
+		spdk_json_decode_bool, true
+	},
 	{
 		"tgt_name", offsetof(struct nvmf_rpc_create_transport_ctx, tgt_name),
 		spdk_json_decode_string, true
@@ -2526,6 +2766,14 @@ static const struct spdk_json_object_decoder nvmf_rpc_create_transport_decoder[]
 		"data_wr_pool_size", offsetof(struct nvmf_rpc_create_transport_ctx, opts.data_wr_pool_size),
 		spdk_json_decode_uint32, true
 	},
+	{
+		"host_max_iops", offsetof(struct nvmf_rpc_create_transport_ctx, opts.host_max_iops),
+		spdk_json_decode_uint32, true
+	},
+	{
+		"host_max_burst", offsetof(struct nvmf_rpc_create_transport_ctx, opts.host_max_burst),
+		spdk_json_decode_uint32, true
+	},
 	{
 		"disable_command_passthru", offsetof(struct nvmf_rpc_create_transport_ctx, opts.disable_command_passthru),
 		spdk_json_decode_bool, true
@@ -2731,6 +2979,66 @@ rpc_nvmf_get_transports(struct spdk_jsonrpc_request *request,
 }
 SPDK_RPC_REGISTER("nvmf_get_transports", rpc_nvmf_get_transports, SPDK_RPC_RUNTIME)
 
+static void
+rpc_nvmf_get_host_io_stats(struct spdk_jsonrpc_request *request,
+			   const struct spdk_json_val *params)
+{
+	struct rpc_get_transport req = { 0 };
+	struct spdk_json_write_ctx *w;
+	struct spdk_nvmf_transport *transport = NULL;
+	struct spdk_nvmf_tgt *tgt;
+
+	if (params) {
+		if (spdk_json_decode_object(params, rpc_get_transport_decoders,
+					    SPDK_COUNTOF(rpc_get_transport_decoders),
+					    &req)) {
+			SPDK_ERRLOG("spdk_json_decode_object failed\n");
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+			return;
+		}
+	}
+
+	tgt = spdk_nvmf_get_tgt(req.tgt_name);
+	if (!tgt) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Unable to find a target.");
+		free(req.trtype);
+		free(req.tgt_name);
+		return;
+	}
+
+	if (req.trtype) {
+		transport = spdk_nvmf_tgt_get_transport(tgt, req.trtype);
+		if (transport == NULL) {
+			SPDK_ERRLOG("transport '%s' does not exist\n", req.trtype);
+			spdk_jsonrpc_send_error_response(request, -ENODEV, spdk_strerror(ENODEV));
+			free(req.trtype);
+			free(req.tgt_name);
+			return;
+		}
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_array_begin(w);
+
+	if (transport) {
+		nvmf_transport_dump_host_stats(transport, w);
+	} else {
+		for (transport = spdk_nvmf_transport_get_first(tgt); transport != NULL;
+		     transport = spdk_nvmf_transport_get_next(transport)) {
+			if (transport->opts.host_io_stats) {
+				nvmf_transport_dump_host_stats(transport, w);
+			}
+		}
+	}
+
+	spdk_json_write_array_end(w);
+	spdk_jsonrpc_end_result(request, w);
+	free(req.trtype);
+	free(req.tgt_name);
+}
+SPDK_RPC_REGISTER("nvmf_get_host_io_stats", rpc_nvmf_get_host_io_stats, SPDK_RPC_RUNTIME)
+
 struct rpc_nvmf_get_stats_ctx {
 	char *tgt_name;
 	struct spdk_nvmf_tgt *tgt;
@@ -6,6 +6,7 @@
 
 #include "spdk/stdinc.h"
 
+#include "spdk/accel.h"
 #include "spdk/config.h"
 #include "spdk/thread.h"
 #include "spdk/likely.h"
@@ -66,12 +67,18 @@ enum spdk_nvmf_rdma_request_state {
 	/* The request is ready to execute at the block device */
 	RDMA_REQUEST_STATE_READY_TO_EXECUTE,
 
+	/* The request is waiting for the accel framework to generate DIF for the write data */
+	RDMA_REQUEST_STATE_GENERATING_DIF,
+
 	/* The request is currently executing at the block device */
 	RDMA_REQUEST_STATE_EXECUTING,
 
 	/* The request finished executing at the block device */
 	RDMA_REQUEST_STATE_EXECUTED,
 
+	/* The request is waiting for the accel framework to verify DIF of the read data */
+	RDMA_REQUEST_STATE_VERIFYING_DIF,
+
 	/* The request is waiting on RDMA queue depth availability
 	 * to transfer data from the controller to the host.
 	 */
@@ -144,6 +151,10 @@ nvmf_trace(void)
 					TRACE_RDMA_REQUEST_STATE_READY_TO_EXECUTE,
 					OWNER_TYPE_NONE, OBJECT_NVMF_RDMA_IO, 0,
 					SPDK_TRACE_ARG_TYPE_PTR, "qpair");
+	spdk_trace_register_description("RDMA_REQ_GENERATING_DIF",
+					TRACE_RDMA_REQUEST_STATE_GENERATING_DIF,
+					OWNER_TYPE_NONE, OBJECT_NVMF_RDMA_IO, 0,
+					SPDK_TRACE_ARG_TYPE_PTR, "qpair");
 	spdk_trace_register_description("RDMA_REQ_EXECUTING",
 					TRACE_RDMA_REQUEST_STATE_EXECUTING,
 					OWNER_TYPE_NONE, OBJECT_NVMF_RDMA_IO, 0,
@@ -152,6 +163,10 @@ nvmf_trace(void)
 					TRACE_RDMA_REQUEST_STATE_EXECUTED,
 					OWNER_TYPE_NONE, OBJECT_NVMF_RDMA_IO, 0,
 					SPDK_TRACE_ARG_TYPE_PTR, "qpair");
+	spdk_trace_register_description("RDMA_REQ_VERIFYING_DIF",
+					TRACE_RDMA_REQUEST_STATE_VERIFYING_DIF,
+					OWNER_TYPE_NONE, OBJECT_NVMF_RDMA_IO, 0,
+					SPDK_TRACE_ARG_TYPE_PTR, "qpair");
 	spdk_trace_register_description("RDMA_REQ_RDY2COMPL_PEND",
 					TRACE_RDMA_REQUEST_STATE_READY_TO_COMPLETE_PENDING,
 					OWNER_TYPE_NONE, OBJECT_NVMF_RDMA_IO, 0,
@@ -259,6 +274,8 @@ struct spdk_nvmf_rdma_request {
 	struct ibv_send_wr			*remaining_tranfer_in_wrs;
 	struct ibv_send_wr			*transfer_wr;
 	struct spdk_nvmf_rdma_request_data	data;
+	/* Filled by the accel framework when DIF verification of read data fails */
+	struct spdk_dif_error			dif_error;
 };
 
 struct spdk_nvmf_rdma_resource_opts {
@@ -442,6 +459,10 @@ struct spdk_nvmf_rdma_poll_group {
 	struct spdk_nvmf_rdma_poll_group_stat		stat;
 	TAILQ_HEAD(, spdk_nvmf_rdma_poller)		pollers;
 	TAILQ_ENTRY(spdk_nvmf_rdma_poll_group)		link;
+	/* Used to offload DIF insert/strip when dif_insert_or_strip is enabled */
+	struct spdk_io_channel				*accel_channel;
+	/* True if the DIF operations are assigned to a hardware accel module */
+	bool						accel_dif;
 };
 
 struct spdk_nvmf_rdma_conn_sched {
@@ -478,6 +499,7 @@ struct rdma_transport_opts {
 	bool		no_srq;
 	bool		no_wr_batching;
 	int		acceptor_backlog;
+	bool		srq_lazy_alloc;
 };
 
 struct spdk_nvmf_rdma_transport {
@@ -535,6 +557,10 @@ static const struct spdk_json_object_decoder rdma_transport_opts_decoder[] = {
 		"acceptor_backlog", offsetof(struct rdma_transport_opts, acceptor_backlog),
 		spdk_json_decode_int32, true
 	},
+	{
+		"srq_lazy_alloc", offsetof(struct rdma_transport_opts, srq_lazy_alloc),
+		spdk_json_decode_bool, true
+	},
 };
 
 static int
@@ -2085,6 +2111,82 @@ nvmf_rdma_poll_group_insert_need_buffer_req(struct spdk_nvmf_rdma_poll_group *rg
 	}
 }
 
+static void
+nvmf_rdma_dif_generate_done(void *cb_arg, int status)
+{
+	struct spdk_nvmf_rdma_request *rdma_req = cb_arg;
+	struct spdk_nvmf_rdma_qpair *rqpair;
+	struct spdk_nvmf_rdma_transport *rtransport;
+
+	rqpair = SPDK_CONTAINEROF(rdma_req->req.qpair, struct spdk_nvmf_rdma_qpair, qpair);
+	rtransport = SPDK_CONTAINEROF(rqpair->qpair.transport, struct spdk_nvmf_rdma_transport, transport);
+
+	assert(rdma_req->state == RDMA_REQUEST_STATE_GENERATING_DIF);
+	if (spdk_unlikely(status != 0)) {
+		SPDK_ERRLOG("DIF generation failed\n");
+		rdma_req->state = RDMA_REQUEST_STATE_COMPLETED;
+		spdk_nvmf_qpair_disconnect(&rqpair->qpair);
+	} else {
+		/* The extended length tells READY_TO_EXECUTE that DIF is already generated */
+		rdma_req->req.length = rdma_req->req.dif.elba_length;
+		rdma_req->state = RDMA_REQUEST_STATE_READY_TO_EXECUTE;
+	}
+
+	nvmf_rdma_request_process(rtransport, rdma_req);
+}
+
+static void
+nvmf_rdma_dif_verify_done(void *cb_arg, int status)
+{
+	struct spdk_nvmf_rdma_request *rdma_req = cb_arg;
+	struct spdk_nvme_cpl *rsp = &rdma_req->req.rsp->nvme_cpl;
+	struct spdk_nvmf_rdma_qpair *rqpair;
+	struct spdk_nvmf_rdma_transport *rtransport;
+
+	rqpair = SPDK_CONTAINEROF(rdma_req->req.qpair, struct spdk_nvmf_rdma_qpair, qpair);
+	rtransport = SPDK_CONTAINEROF(rqpair->qpair.transport, struct spdk_nvmf_rdma_transport, transport);
+
+	assert(rdma_req->state == RDMA_REQUEST_STATE_VERIFYING_DIF);
+	if (spdk_likely(status == 0)) {
+		STAILQ_INSERT_TAIL(&rqpair->pending_rdma_write_queue, rdma_req, state_link);
+		rdma_req->state = RDMA_REQUEST_STATE_DATA_TRANSFER_TO_HOST_PENDING;
+	} else {
+		if (status == -EIO) {
+			SPDK_ERRLOG("DIF error detected. type=%d, offset=%" PRIu32 "\n",
+				    rdma_req->dif_error.err_type, rdma_req->dif_error.err_offset);
+			rsp->status.sct = SPDK_NVME_SCT_MEDIA_ERROR;
+			rsp->status.sc = nvmf_rdma_dif_error_to_compl_status(rdma_req->dif_error.err_type);
+		} else {
+			SPDK_ERRLOG("DIF verification failed: %d\n", status);
+			rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+			rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+		}
+		STAILQ_INSERT_TAIL(&rqpair->pending_rdma_send_queue, rdma_req, state_link);
+		rdma_req->state = RDMA_REQUEST_STATE_READY_TO_COMPLETE_PENDING;
+	}
+
+	nvmf_rdma_request_process(rtransport, rdma_req);
+}
+
+static int
+nvmf_rdma_request_verify_dif_accel(struct spdk_nvmf_rdma_poll_group *rgroup,
+				   struct spdk_nvmf_rdma_request *rdma_req, uint32_t num_blocks)
+{
+	struct spdk_nvmf_request *req = &rdma_req->req;
+
+	memset(&rdma_req->dif_error, 0, sizeof(rdma_req->dif_error));
+	if (!req->stripped_data) {
+		return spdk_accel_submit_dif_verify(rgroup->accel_channel, req->iov, req->iovcnt,
+						    num_blocks, &req->dif.dif_ctx, &rdma_req->dif_error,
+						    nvmf_rdma_dif_verify_done, rdma_req);
+	}
+
+	return spdk_accel_submit_dif_verify_copy(rgroup->accel_channel, req->stripped_data->iov,
+			req->stripped_data->iovcnt, req->iov, req->iovcnt,
+			num_blocks, &req->dif.dif_ctx, &rdma_req->dif_error,
+			nvmf_rdma_dif_verify_done, rdma_req);
+}
+
 bool
 nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 			  struct spdk_nvmf_rdma_request *rdma_req)
@@ -2185,6 +2287,12 @@ nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 				break;
 			}
 
+			if (spdk_unlikely(!nvmf_transport_req_admit(&rdma_req->req))) {
+				STAILQ_INSERT_TAIL(&rqpair->pending_rdma_send_queue, rdma_req, state_link);
+				rdma_req->state = RDMA_REQUEST_STATE_READY_TO_COMPLETE_PENDING;
+				break;
+			}
+
 			/* If no data to transfer, ready to execute. */
 			if (rdma_req->req.xfer == SPDK_NVME_DATA_NONE) {
 				rdma_req->state = RDMA_REQUEST_STATE_READY_TO_EXECUTE;
@@ -2277,12 +2385,29 @@ nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 			spdk_trace_record(TRACE_RDMA_REQUEST_STATE_READY_TO_EXECUTE, 0, 0,
 					  (uintptr_t)rdma_req, (uintptr_t)rqpair);
 
-			if (spdk_unlikely(rdma_req->req.dif_enabled)) {
+			/* The extended length is set once DIF is generated, so a request coming back
+			 * to this state (e.g. from the accel framework) doesn't generate it twice.
+			 */
+			if (spdk_unlikely(rdma_req->req.dif_enabled &&
+					  rdma_req->req.length != rdma_req->req.dif.elba_length)) {
 				if (rdma_req->req.xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER) {
 					/* generate DIF for write operation */
 					num_blocks = SPDK_CEIL_DIV(rdma_req->req.dif.elba_length, rdma_req->req.dif.dif_ctx.block_size);
 					assert(num_blocks > 0);
 
+					if (rgroup->accel_dif) {
+						rdma_req->state = RDMA_REQUEST_STATE_GENERATING_DIF;
+						rc = spdk_accel_submit_dif_generate(rgroup->accel_channel, rdma_req->req.iov,
+										    rdma_req->req.iovcnt, num_blocks,
+										    &rdma_req->req.dif.dif_ctx,
+										    nvmf_rdma_dif_generate_done, rdma_req);
+						if (spdk_likely(rc == 0)) {
+							break;
+						}
+						/* Fall back to generating DIF in software */
+						rdma_req->state = RDMA_REQUEST_STATE_READY_TO_EXECUTE;
+					}
+
 					rc = spdk_dif_generate(rdma_req->req.iov, rdma_req->req.iovcnt,
 							       num_blocks, &rdma_req->req.dif.dif_ctx);
 					if (rc != 0) {
@@ -2348,6 +2473,12 @@ nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 				rdma_req->fused_pair = NULL;
 			}
 			break;
+		case RDMA_REQUEST_STATE_GENERATING_DIF:
+			spdk_trace_record(TRACE_RDMA_REQUEST_STATE_GENERATING_DIF, 0, 0,
+					  (uintptr_t)rdma_req, (uintptr_t)rqpair);
+			/* The accel framework completion callback must kick a request into
+			 * RDMA_REQUEST_STATE_READY_TO_EXECUTE to escape this state. */
+			break;
 		case RDMA_REQUEST_STATE_EXECUTING:
 			spdk_trace_record(TRACE_RDMA_REQUEST_STATE_EXECUTING, 0, 0,
 					  (uintptr_t)rdma_req, (uintptr_t)rqpair);
@@ -2357,6 +2488,21 @@ nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 		case RDMA_REQUEST_STATE_EXECUTED:
 			spdk_trace_record(TRACE_RDMA_REQUEST_STATE_EXECUTED, 0, 0,
 					  (uintptr_t)rdma_req, (uintptr_t)rqpair);
+			if (spdk_unlikely(rdma_req->req.dif_enabled && rgroup->accel_dif &&
+					  rsp->status.sc == SPDK_NVME_SC_SUCCESS &&
+					  rdma_req->req.xfer == SPDK_NVME_DATA_CONTROLLER_TO_HOST)) {
+				/* restore the original length */
+				rdma_req->req.length = rdma_req->req.dif.orig_length;
+
+				num_blocks = SPDK_CEIL_DIV(rdma_req->req.dif.elba_length, rdma_req->req.dif.dif_ctx.block_size);
+				rdma_req->state = RDMA_REQUEST_STATE_VERIFYING_DIF;
+				rc = nvmf_rdma_request_verify_dif_accel(rgroup, rdma_req, num_blocks);
+				if (spdk_likely(rc == 0)) {
+					break;
+				}
+				/* Fall back to verifying DIF in software */
+				rdma_req->state = RDMA_REQUEST_STATE_EXECUTED;
+			}
 			if (rsp->status.sc == SPDK_NVME_SC_SUCCESS &&
 			    rdma_req->req.xfer == SPDK_NVME_DATA_CONTROLLER_TO_HOST) {
 				STAILQ_INSERT_TAIL(&rqpair->pending_rdma_write_queue, rdma_req, state_link);
@@ -2396,6 +2542,13 @@ nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 				}
 			}
 			break;
+		case RDMA_REQUEST_STATE_VERIFYING_DIF:
+			spdk_trace_record(TRACE_RDMA_REQUEST_STATE_VERIFYING_DIF, 0, 0,
+					  (uintptr_t)rdma_req, (uintptr_t)rqpair);
+			/* The accel framework completion callback must kick a request into
+			 * RDMA_REQUEST_STATE_DATA_TRANSFER_TO_HOST_PENDING or
+			 * RDMA_REQUEST_STATE_READY_TO_COMPLETE_PENDING to escape this state. */
+			break;
 		case RDMA_REQUEST_STATE_DATA_TRANSFER_TO_HOST_PENDING:
 			spdk_trace_record(TRACE_RDMA_REQUEST_STATE_DATA_TRANSFER_TO_HOST_PENDING, 0, 0,
 					  (uintptr_t)rdma_req, (uintptr_t)rqpair);
@@ -2506,6 +2659,7 @@ nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 #define SPDK_NVMF_RDMA_ACCEPTOR_BACKLOG 100
 #define SPDK_NVMF_RDMA_DEFAULT_ABORT_TIMEOUT_SEC 1
 #define SPDK_NVMF_RDMA_DEFAULT_NO_WR_BATCHING false
+#define SPDK_NVMF_RDMA_DEFAULT_SRQ_LAZY_ALLOC false
 #define SPDK_NVMF_RDMA_DEFAULT_DATA_WR_POOL_SIZE 4095
 
 static void
@@ -2700,6 +2854,7 @@ nvmf_rdma_create(struct spdk_nvmf_transport_opts *opts)
 	rtransport->rdma_opts.no_srq = SPDK_NVMF_RDMA_DEFAULT_NO_SRQ;
 	rtransport->rdma_opts.acceptor_backlog = SPDK_NVMF_RDMA_ACCEPTOR_BACKLOG;
 	rtransport->rdma_opts.no_wr_batching = SPDK_NVMF_RDMA_DEFAULT_NO_WR_BATCHING;
+	rtransport->rdma_opts.srq_lazy_alloc = SPDK_NVMF_RDMA_DEFAULT_SRQ_LAZY_ALLOC;
 	if (opts->transport_specific != NULL &&
 	    spdk_json_decode_object_relaxed(opts->transport_specific, rdma_transport_opts_decoder,
 					    SPDK_COUNTOF(rdma_transport_opts_decoder),
@@ -2714,7 +2869,8 @@ nvmf_rdma_create(struct spdk_nvmf_transport_opts *opts)
 		     "  max_io_qpairs_per_ctrlr=%d, io_unit_size=%d,\n"
 		     "  in_capsule_data_size=%d, max_aq_depth=%d,\n"
 		     "  num_shared_buffers=%d, num_cqe=%d, max_srq_depth=%d, no_srq=%d,"
-		     "  acceptor_backlog=%d, no_wr_batching=%d abort_timeout_sec=%d\n",
+		     "  acceptor_backlog=%d, no_wr_batching=%d abort_timeout_sec=%d,\n"
+		     "  srq_lazy_alloc=%d\n",
 		     opts->max_queue_depth,
 		     opts->max_io_size,
 		     opts->max_qpairs_per_ctrlr - 1,
@@ -2727,7 +2883,8 @@ nvmf_rdma_create(struct spdk_nvmf_transport_opts *opts)
 		     rtransport->rdma_opts.no_srq,
 		     rtransport->rdma_opts.acceptor_backlog,
 		     rtransport->rdma_opts.no_wr_batching,
-		     opts->abort_timeout_sec);
+		     opts->abort_timeout_sec,
+		     rtransport->rdma_opts.srq_lazy_alloc);
 
 	/* I/O unit size cannot be larger than max I/O size */
 	if (opts->io_unit_size > opts->max_io_size) {
@@ -2893,6 +3050,7 @@ nvmf_rdma_dump_opts(struct spdk_nvmf_transport *transport, struct spdk_json_writ
 	}
 	spdk_json_write_named_int32(w, "acceptor_backlog", rtransport->rdma_opts.acceptor_backlog);
 	spdk_json_write_named_bool(w, "no_wr_batching", rtransport->rdma_opts.no_wr_batching);
+	spdk_json_write_named_bool(w, "srq_lazy_alloc", rtransport->rdma_opts.srq_lazy_alloc);
 }
 
 static int
@@ -4029,6 +4187,31 @@ nvmf_rdma_discover(struct spdk_nvmf_transport *transport,
 	entry->tsas.rdma.rdma_cms = SPDK_NVMF_RDMA_CMS_RDMA_CM;
 }
 
+static int
+nvmf_rdma_poller_create_srq_resources(struct spdk_nvmf_rdma_transport *rtransport,
+				      struct spdk_nvmf_rdma_poller *poller)
+{
+	struct spdk_nvmf_rdma_resource_opts	opts;
+
+	assert(poller->srq != NULL);
+	assert(poller->resources == NULL);
+
+	opts.qp = poller->srq;
+	opts.map = poller->device->map;
+	opts.qpair = NULL;
+	opts.shared = true;
+	opts.max_queue_depth = poller->max_srq_depth;
+	opts.in_capsule_data_size = rtransport->transport.opts.in_capsule_data_size;
+
+	poller->resources = nvmf_rdma_resources_create(&opts);
+	if (!poller->resources) {
+		SPDK_ERRLOG("Unable to allocate resources for shared receive queue.\n");
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 nvmf_rdma_poller_create(struct spdk_nvmf_rdma_transport *rtransport,
 			struct spdk_nvmf_rdma_poll_group *rgroup, struct spdk_nvmf_rdma_device *device,
@@ -4036,7 +4219,6 @@ nvmf_rdma_poller_create(struct spdk_nvmf_rdma_transport *rtransport,
 {
 	struct spdk_nvmf_rdma_poller		*poller;
 	struct spdk_rdma_provider_srq_init_attr	srq_init_attr;
-	struct spdk_nvmf_rdma_resource_opts	opts;
 	int					num_cqe;
 
 	poller = calloc(1, sizeof(*poller));
@@ -4074,16 +4256,9 @@ nvmf_rdma_poller_create(struct spdk_nvmf_rdma_transport *rtransport,
 			return -1;
 		}
 
-		opts.qp = poller->srq;
-		opts.map = device->map;
-		opts.qpair = NULL;
-		opts.shared = true;
-		opts.max_queue_depth = poller->max_srq_depth;
-		opts.in_capsule_data_size = rtransport->transport.opts.in_capsule_data_size;
-
-		poller->resources = nvmf_rdma_resources_create(&opts);
-		if (!poller->resources) {
-			SPDK_ERRLOG("Unable to allocate resources for shared receive queue.\n");
+		/* With srq_lazy_alloc, the resources are allocated when the first qpair is added */
+		if (!rtransport->rdma_opts.srq_lazy_alloc &&
+		    nvmf_rdma_poller_create_srq_resources(rtransport, poller) != 0) {
 			return -1;
 		}
 	}
@@ -4130,6 +4305,30 @@ _nvmf_rdma_register_poller_in_group(void *c)
 
 static void nvmf_rdma_poll_group_destroy(struct spdk_nvmf_transport_poll_group *group);
 
+/* Software DIF in the accel framework would only add a hop compared to calling
+ * spdk_dif_* inline, so use it only when a hardware module handles all the operations.
+ */
+static bool
+nvmf_rdma_accel_dif_offloaded(void)
+{
+	const enum spdk_accel_opcode opcodes[] = {
+		SPDK_ACCEL_OPC_DIF_GENERATE,
+		SPDK_ACCEL_OPC_DIF_VERIFY,
+		SPDK_ACCEL_OPC_DIF_VERIFY_COPY,
+	};
+	const char *module_name;
+	size_t i;
+
+	for (i = 0; i < SPDK_COUNTOF(opcodes); i++) {
+		if (spdk_accel_get_opc_module_name(opcodes[i], &module_name) != 0 ||
+		    strcmp(module_name, "software") == 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 static struct spdk_nvmf_transport_poll_group *
 nvmf_rdma_poll_group_create(struct spdk_nvmf_transport *transport,
 			    struct spdk_nvmf_poll_group *group)
@@ -4154,6 +4353,16 @@ nvmf_rdma_poll_group_create(struct spdk_nvmf_transport *transport,
 
 	TAILQ_INIT(&rgroup->pollers);
 
+	if (transport->opts.dif_insert_or_strip) {
+		rgroup->accel_channel = spdk_accel_get_io_channel();
+		if (!rgroup->accel_channel) {
+			SPDK_ERRLOG("Cannot create accel_channel for rgroup=%p\n", rgroup);
+			nvmf_rdma_poll_group_destroy(&rgroup->group);
+			return NULL;
+		}
+		rgroup->accel_dif = nvmf_rdma_accel_dif_offloaded();
+	}
+
 	TAILQ_FOREACH(device, &rtransport->devices, link) {
 		rc = nvmf_rdma_poller_create(rtransport, rgroup, device, &poller);
 		if (rc < 0) {
@@ -4295,6 +4504,10 @@ nvmf_rdma_poll_group_destroy(struct spdk_nvmf_transport_poll_group *group)
 		nvmf_rdma_poller_destroy(poller);
 	}
 
+	if (rgroup->accel_channel) {
+		spdk_put_io_channel(rgroup->accel_channel);
+	}
+
 	if (rgroup->group.transport == NULL) {
 		/* Transport can be NULL when nvmf_rdma_poll_group_create()
 		 * calls this function directly in a failure path. */
@@ -4331,6 +4544,7 @@ static int
 nvmf_rdma_poll_group_add(struct spdk_nvmf_transport_poll_group *group,
 			 struct spdk_nvmf_qpair *qpair)
 {
+	struct spdk_nvmf_rdma_transport		*rtransport;
 	struct spdk_nvmf_rdma_poll_group	*rgroup;
 	struct spdk_nvmf_rdma_qpair		*rqpair;
 	struct spdk_nvmf_rdma_device		*device;
@@ -4358,6 +4572,15 @@ nvmf_rdma_poll_group_add(struct spdk_nvmf_transport_poll_group *group,
 		return -1;
 	}
 
+	if (poller->srq != NULL && poller->resources == NULL) {
+		rtransport = SPDK_CONTAINEROF(group->transport, struct spdk_nvmf_rdma_transport, transport);
+		if (nvmf_rdma_poller_create_srq_resources(rtransport, poller) != 0) {
+			return -1;
+		}
+		/* Post the receives before the connection is accepted */
+		_poller_submit_recvs(rtransport, poller);
+	}
+
 	rqpair->poller = poller;
 	rqpair->srq = rqpair->poller->srq;
 
@@ -583,6 +583,14 @@ nvmf_subsystem_set_state(struct spdk_nvmf_subsystem *subsystem,
 					    __ATOMIC_RELAXED, __ATOMIC_RELAXED);
 	}
 	assert(actual_old_state == expected_old_state);
+
+	/* The listeners of the subsystem appear in or disappear from the discovery log */
+	if (actual_old_state == expected_old_state &&
+	    (state == SPDK_NVMF_SUBSYSTEM_ACTIVATING || state == SPDK_NVMF_SUBSYSTEM_DEACTIVATING) &&
+	    !TAILQ_EMPTY(&subsystem->listeners)) {
+		spdk_nvmf_send_discovery_log_notice(subsystem->tgt, NULL);
+	}
+
 	return actual_old_state - expected_old_state;
 }
 
@@ -1750,6 +1758,8 @@ nvmf_subsystem_ns_changed(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid)
 }
 
 static uint32_t nvmf_ns_reservation_clear_all_registrants(struct spdk_nvmf_ns *ns);
+static void nvmf_ns_reservation_update_roles(struct spdk_nvmf_ns *ns);
+static void nvmf_ctrlr_update_ns_resv_role(struct spdk_nvmf_ctrlr *ctrlr, struct spdk_nvmf_ns *ns);
 
 int
 spdk_nvmf_subsystem_remove_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid)
@@ -2273,6 +2283,8 @@ spdk_nvmf_subsystem_add_ns_ext(struct spdk_nvmf_subsystem *subsystem, const char
 		}
 	}
 
+	nvmf_ns_reservation_update_roles(ns);
+
 	for (transport = spdk_nvmf_transport_get_first(subsystem->tgt); transport;
 	     transport = spdk_nvmf_transport_get_next(transport)) {
 		if (transport->ops->subsystem_add_ns) {
@@ -2554,6 +2566,7 @@ nvmf_subsystem_gen_cntlid(struct spdk_nvmf_subsystem *subsystem)
 int
 nvmf_subsystem_add_ctrlr(struct spdk_nvmf_subsystem *subsystem, struct spdk_nvmf_ctrlr *ctrlr)
 {
+	struct spdk_nvmf_ns *ns;
 
 	if (ctrlr->dynamic_ctrlr) {
 		ctrlr->cntlid = nvmf_subsystem_gen_cntlid(subsystem);
@@ -2569,6 +2582,11 @@ nvmf_subsystem_add_ctrlr(struct spdk_nvmf_subsystem *subsystem, struct spdk_nvmf
 
 	TAILQ_INSERT_TAIL(&subsystem->ctrlrs, ctrlr, link);
 
+	for (ns = spdk_nvmf_subsystem_get_first_ns(subsystem); ns != NULL;
+	     ns = spdk_nvmf_subsystem_get_next_ns(subsystem, ns)) {
+		nvmf_ctrlr_update_ns_resv_role(ctrlr, ns);
+	}
+
 	SPDK_DTRACE_PROBE3(nvmf_subsystem_add_ctrlr, subsystem->subnqn, ctrlr, ctrlr->hostnqn);
 
 	return 0;
@@ -2933,6 +2951,37 @@ nvmf_ns_reservation_get_registrant(struct spdk_nvmf_ns *ns,
 	return NULL;
 }
 
+static void
+nvmf_ctrlr_update_ns_resv_role(struct spdk_nvmf_ctrlr *ctrlr, struct spdk_nvmf_ns *ns)
+{
+	uint8_t role = 0;
+
+	if (ctrlr->ns_resv_role == NULL) {
+		return;
+	}
+
+	if (nvmf_ns_reservation_get_registrant(ns, &ctrlr->hostid) != NULL) {
+		role |= NVMF_NS_RESV_ROLE_REGISTRANT;
+	}
+	if (ns->holder != NULL && !spdk_uuid_compare(&ns->holder->hostid, &ctrlr->hostid)) {
+		role |= NVMF_NS_RESV_ROLE_HOLDER;
+	}
+
+	ctrlr->ns_resv_role[ns->nsid - 1] = role;
+}
+
+/* Cache the reservation role of each controller's host, so that the I/O path doesn't
+ * need to look the host up in the registrants */
+static void
+nvmf_ns_reservation_update_roles(struct spdk_nvmf_ns *ns)
+{
+	struct spdk_nvmf_ctrlr *ctrlr;
+
+	TAILQ_FOREACH(ctrlr, &ns->subsystem->ctrlrs, link) {
+		nvmf_ctrlr_update_ns_resv_role(ctrlr, ns);
+	}
+}
+
 /* Generate reservation notice log to registered HostID controllers */
 static void
 nvmf_subsystem_gen_ctrlr_notification(struct spdk_nvmf_subsystem *subsystem,
@@ -3695,6 +3744,7 @@ nvmf_ns_reservation_request(void *ctx)
 
 	/* update reservation information to subsystem's poll group */
 	if (update_sgroup) {
+		nvmf_ns_reservation_update_roles(ns);
 		if (ns->ptpl_activated || cmd->opc == SPDK_NVME_OPC_RESERVATION_REGISTER) {
 			if (nvmf_ns_update_reservation_info(ns) != 0) {
 				req->rsp->nvme_cpl.status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
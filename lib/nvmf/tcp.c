@@ -31,6 +31,11 @@
 #define SPDK_NVMF_TCP_DEFAULT_SOCK_PRIORITY 0
 #define SPDK_NVMF_TCP_DEFAULT_CONTROL_MSG_NUM 32
 #define SPDK_NVMF_TCP_DEFAULT_SUCCESS_OPTIMIZATION true
+#define SPDK_NVMF_TCP_DEFAULT_POLL_GROUP_LOAD_BALANCE false
+
+/* Period and weight of the request rate average used to place new qpairs on poll groups */
+#define NVMF_TCP_LOAD_PERIOD_MS 100
+#define NVMF_TCP_LOAD_EWMA_SHIFT 2
 
 #define SPDK_NVMF_TCP_MIN_IO_QUEUE_DEPTH 2
 #define SPDK_NVMF_TCP_MAX_IO_QUEUE_DEPTH 65535
@@ -237,6 +242,12 @@ struct spdk_nvmf_tcp_req  {
 
 	struct spdk_nvmf_tcp_req		*fused_pair;
 
+	/* Capsule response sent in the same socket request as the last C2H data PDU */
+	struct {
+		struct spdk_nvme_tcp_rsp	hdr;
+		uint8_t				hdgst[SPDK_NVME_TCP_DIGEST_LEN];
+	} c2h_capsule_resp;
+
 	/*
 	 * The PDU for a request may be used multiple times in serial over
 	 * the request's lifetime. For example, first to send an R2T, then
@@ -349,6 +360,17 @@ struct spdk_nvmf_tcp_poll_group {
 	struct spdk_io_channel			*accel_channel;
 	struct spdk_nvmf_tcp_control_msg_list	*control_msg_list;
 
+	/* Compute the data digest of payloads received in several reads as they arrive */
+	bool					ddgst_stream;
+
+	/* Number of received commands, averaged per NVMF_TCP_LOAD_PERIOD_MS in rate.
+	 * rate is read by the acceptor thread. */
+	struct {
+		uint64_t			period_start_tsc;
+		uint64_t			num_reqs;
+		uint64_t			rate;
+	} load;
+
 	TAILQ_ENTRY(spdk_nvmf_tcp_poll_group)	link;
 };
 
@@ -361,6 +383,7 @@ struct spdk_nvmf_tcp_port {
 
 struct tcp_transport_opts {
 	bool		c2h_success;
+	bool		poll_group_load_balance;
 	uint16_t	control_msg_num;
 	uint32_t	sock_priority;
 };
@@ -380,6 +403,7 @@ struct spdk_nvmf_tcp_transport {
 	struct spdk_nvmf_transport		transport;
 	struct tcp_transport_opts               tcp_opts;
 	uint32_t				ack_timeout;
+	uint64_t				load_period_ticks;
 
 	struct spdk_nvmf_tcp_poll_group		*next_pg;
 
@@ -405,6 +429,10 @@ static const struct spdk_json_object_decoder tcp_transport_opts_decoder[] = {
 		"sock_priority", offsetof(struct tcp_transport_opts, sock_priority),
 		spdk_json_decode_uint32, true
 	},
+	{
+		"poll_group_load_balance", offsetof(struct tcp_transport_opts, poll_group_load_balance),
+		spdk_json_decode_bool, true
+	},
 };
 
 static bool nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
@@ -677,6 +705,7 @@ nvmf_tcp_dump_opts(struct spdk_nvmf_transport *transport, struct spdk_json_write
 	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_tcp_transport, transport);
 	spdk_json_write_named_bool(w, "c2h_success", ttransport->tcp_opts.c2h_success);
 	spdk_json_write_named_uint32(w, "sock_priority", ttransport->tcp_opts.sock_priority);
+	spdk_json_write_named_bool(w, "poll_group_load_balance", ttransport->tcp_opts.poll_group_load_balance);
 }
 
 static void
@@ -744,6 +773,7 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 	ttransport->tcp_opts.c2h_success = SPDK_NVMF_TCP_DEFAULT_SUCCESS_OPTIMIZATION;
 	ttransport->tcp_opts.sock_priority = SPDK_NVMF_TCP_DEFAULT_SOCK_PRIORITY;
 	ttransport->tcp_opts.control_msg_num = SPDK_NVMF_TCP_DEFAULT_CONTROL_MSG_NUM;
+	ttransport->tcp_opts.poll_group_load_balance = SPDK_NVMF_TCP_DEFAULT_POLL_GROUP_LOAD_BALANCE;
 	if (opts->transport_specific != NULL &&
 	    spdk_json_decode_object_relaxed(opts->transport_specific, tcp_transport_opts_decoder,
 					    SPDK_COUNTOF(tcp_transport_opts_decoder),
@@ -762,7 +792,7 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		     "  num_shared_buffers=%d, c2h_success=%d,\n"
 		     "  dif_insert_or_strip=%d, sock_priority=%d\n"
 		     "  abort_timeout_sec=%d, control_msg_num=%hu\n"
-		     "  ack_timeout=%d\n",
+		     "  ack_timeout=%d, poll_group_load_balance=%d\n",
 		     opts->max_queue_depth,
 		     opts->max_io_size,
 		     opts->max_qpairs_per_ctrlr - 1,
@@ -775,7 +805,8 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		     ttransport->tcp_opts.sock_priority,
 		     opts->abort_timeout_sec,
 		     ttransport->tcp_opts.control_msg_num,
-		     opts->ack_timeout);
+		     opts->ack_timeout,
+		     ttransport->tcp_opts.poll_group_load_balance);
 
 	if (ttransport->tcp_opts.sock_priority > SPDK_NVMF_TCP_DEFAULT_MAX_SOCK_PRIORITY) {
 		SPDK_ERRLOG("Unsupported socket_priority=%d, the current range is: 0 to %d\n"
@@ -792,6 +823,8 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		ttransport->tcp_opts.control_msg_num = SPDK_NVMF_TCP_DEFAULT_CONTROL_MSG_NUM;
 	}
 
+	ttransport->load_period_ticks = spdk_get_ticks_hz() * NVMF_TCP_LOAD_PERIOD_MS / SPDK_SEC_TO_MSEC;
+
 	/* I/O unit size cannot be larger than max I/O size */
 	if (opts->io_unit_size > opts->max_io_size) {
 		SPDK_WARNLOG("TCP param io_unit_size %u can't be larger than max_io_size %u. Using max_io_size as io_unit_size\n",
@@ -1224,6 +1257,17 @@ _tcp_write_pdu(struct nvme_tcp_pdu *pdu)
 
 	pdu->sock_req.iovcnt = nvme_tcp_build_iovs(pdu->iov, SPDK_COUNTOF(pdu->iov), pdu,
 			       tqpair->host_hdgst_enable, tqpair->host_ddgst_enable, &mapped_length);
+
+	/* A C2H data PDU tied to a request carries that request's capsule response */
+	if (pdu->req != NULL) {
+		struct spdk_nvmf_tcp_req *tcp_req = pdu->req;
+
+		assert(pdu->sock_req.iovcnt < (int)SPDK_COUNTOF(pdu->iov));
+		pdu->iov[pdu->sock_req.iovcnt].iov_base = &tcp_req->c2h_capsule_resp;
+		pdu->iov[pdu->sock_req.iovcnt].iov_len = tcp_req->c2h_capsule_resp.hdr.common.plen;
+		pdu->sock_req.iovcnt++;
+	}
+
 	spdk_sock_writev_async(tqpair->sock, &pdu->sock_req);
 
 	if (pdu->hdr.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_IC_RESP ||
@@ -1654,6 +1698,7 @@ nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport,
 {
 	struct spdk_nvmf_tcp_transport	*ttransport;
 	struct spdk_nvmf_tcp_poll_group *tgroup;
+	const char *crc32c_module;
 	int rc;
 
 	tgroup = calloc(1, sizeof(*tgroup));
@@ -1686,6 +1731,13 @@ nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport,
 		goto cleanup;
 	}
 
+	/* If crc32c isn't offloaded, it's cheaper to compute it on each received segment while
+	 * the data is still in the cache than to go over the whole payload once it's complete. */
+	if (spdk_accel_get_opc_module_name(SPDK_ACCEL_OPC_CRC32C, &crc32c_module) == 0 &&
+	    strcmp(crc32c_module, "software") == 0) {
+		tgroup->ddgst_stream = true;
+	}
+
 	TAILQ_INSERT_TAIL(&ttransport->poll_groups, tgroup, link);
 	if (ttransport->next_pg == NULL) {
 		ttransport->next_pg = tgroup;
@@ -1707,6 +1759,74 @@ cleanup:
 	return NULL;
 }
 
+static void
+nvmf_tcp_poll_group_update_load(struct spdk_nvmf_tcp_poll_group *tgroup, uint64_t period_ticks)
+{
+	uint64_t now, rate;
+
+	now = spdk_get_ticks();
+	if (now - tgroup->load.period_start_tsc < period_ticks) {
+		return;
+	}
+
+	rate = tgroup->load.rate;
+	rate = (rate * ((1 << NVMF_TCP_LOAD_EWMA_SHIFT) - 1) + tgroup->load.num_reqs) >>
+	       NVMF_TCP_LOAD_EWMA_SHIFT;
+	__atomic_store_n(&tgroup->load.rate, rate, __ATOMIC_RELAXED);
+
+	tgroup->load.num_reqs = 0;
+	tgroup->load.period_start_tsc = now;
+}
+
+static void
+nvmf_tcp_poll_group_get_qpair_count(struct spdk_nvmf_tcp_poll_group *tgroup, uint32_t *current,
+				    uint32_t *unassociated)
+{
+	struct spdk_nvmf_poll_group *pg = tgroup->group.group;
+
+	pthread_mutex_lock(&pg->mutex);
+	*current = pg->stat.current_admin_qpairs + pg->stat.current_io_qpairs;
+	*unassociated = pg->current_unassociated_qpairs;
+	pthread_mutex_unlock(&pg->mutex);
+}
+
+/* Pick the poll group with the lowest estimated load, starting from next_pg so that poll
+ * groups with equal load are still used in turn. A poll group's load is its recent rate of
+ * commands, plus the average rate of a qpair for each qpair that was sent to it but hasn't
+ * been associated yet, so a burst of connections doesn't land on the same poll group. */
+static struct spdk_nvmf_tcp_poll_group *
+nvmf_tcp_get_least_loaded_poll_group(struct spdk_nvmf_tcp_transport *ttransport)
+{
+	struct spdk_nvmf_tcp_poll_group *tgroup, *min_tgroup;
+	uint64_t total_rate = 0, total_qpairs = 0, qpair_rate, load, min_load = UINT64_MAX;
+	uint32_t current, unassociated;
+
+	TAILQ_FOREACH(tgroup, &ttransport->poll_groups, link) {
+		nvmf_tcp_poll_group_get_qpair_count(tgroup, &current, &unassociated);
+		total_rate += __atomic_load_n(&tgroup->load.rate, __ATOMIC_RELAXED);
+		total_qpairs += current;
+	}
+
+	qpair_rate = spdk_max(total_rate / spdk_max(total_qpairs, 1), 1);
+
+	min_tgroup = tgroup = ttransport->next_pg;
+	do {
+		nvmf_tcp_poll_group_get_qpair_count(tgroup, &current, &unassociated);
+		load = __atomic_load_n(&tgroup->load.rate, __ATOMIC_RELAXED) + unassociated * qpair_rate;
+		if (load < min_load) {
+			min_load = load;
+			min_tgroup = tgroup;
+		}
+
+		tgroup = TAILQ_NEXT(tgroup, link);
+		if (tgroup == NULL) {
+			tgroup = TAILQ_FIRST(&ttransport->poll_groups);
+		}
+	} while (tgroup != ttransport->next_pg);
+
+	return min_tgroup;
+}
+
 static struct spdk_nvmf_transport_poll_group *
 nvmf_tcp_get_optimal_poll_group(struct spdk_nvmf_qpair *qpair)
 {
@@ -1724,6 +1844,9 @@ nvmf_tcp_get_optimal_poll_group(struct spdk_nvmf_qpair *qpair)
 
 	pg = &ttransport->next_pg;
 	assert(*pg != NULL);
+	if (ttransport->tcp_opts.poll_group_load_balance) {
+		*pg = nvmf_tcp_get_least_loaded_poll_group(ttransport);
+	}
 	hint = (*pg)->sock_group;
 
 	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_tcp_qpair, qpair);
@@ -1900,6 +2023,7 @@ nvmf_tcp_capsule_cmd_hdr_handle(struct spdk_nvmf_tcp_transport *ttransport,
 
 	pdu->req = tcp_req;
 	assert(tcp_req->state == TCP_REQUEST_STATE_NEW);
+	tqpair->group->load.num_reqs++;
 	nvmf_tcp_req_process(ttransport, tcp_req);
 }
 
@@ -1918,9 +2042,6 @@ nvmf_tcp_capsule_cmd_payload_handle(struct spdk_nvmf_tcp_transport *ttransport,
 	tcp_req = pdu->req;
 	assert(tcp_req != NULL);
 
-	/* Zero-copy requests don't support ICD */
-	assert(!spdk_nvmf_request_using_zcopy(&tcp_req->req));
-
 	if (capsule_cmd->common.pdo > SPDK_NVME_TCP_PDU_PDO_MAX_OFFSET) {
 		SPDK_ERRLOG("Expected ICReq capsule_cmd pdu offset <= %d, got %c\n",
 			    SPDK_NVME_TCP_PDU_PDO_MAX_OFFSET, capsule_cmd->common.pdo);
@@ -1930,7 +2051,8 @@ nvmf_tcp_capsule_cmd_payload_handle(struct spdk_nvmf_tcp_transport *ttransport,
 	}
 
 	rsp = &tcp_req->req.rsp->nvme_cpl;
-	if (spdk_unlikely(rsp->status.sc == SPDK_NVME_SC_COMMAND_TRANSIENT_TRANSPORT_ERROR)) {
+	if (spdk_unlikely(rsp->status.sc == SPDK_NVME_SC_COMMAND_TRANSIENT_TRANSPORT_ERROR ||
+			  (spdk_nvmf_request_using_zcopy(&tcp_req->req) && spdk_nvme_cpl_is_error(rsp)))) {
 		nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_COMPLETE);
 	} else {
 		nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_EXECUTE);
@@ -2246,6 +2368,22 @@ data_crc32_calc_done(void *cb_arg, int status)
 	_nvmf_tcp_pdu_payload_handle(tqpair, pdu);
 }
 
+static void
+nvmf_tcp_pdu_stream_data_digest(struct nvme_tcp_pdu *pdu)
+{
+	uint32_t end = spdk_min(pdu->rw_offset, pdu->data_len);
+
+	if (pdu->ddgst_offset == 0) {
+		pdu->data_digest_crc32 = SPDK_CRC32C_XOR;
+	}
+
+	if (end > pdu->ddgst_offset) {
+		pdu->data_digest_crc32 = nvme_tcp_pdu_update_data_digest(pdu, pdu->ddgst_offset,
+					 end - pdu->ddgst_offset, pdu->data_digest_crc32);
+		pdu->ddgst_offset = end;
+	}
+}
+
 static void
 nvmf_tcp_pdu_payload_handle(struct spdk_nvmf_tcp_qpair *tqpair, struct nvme_tcp_pdu *pdu)
 {
@@ -2256,8 +2394,11 @@ nvmf_tcp_pdu_payload_handle(struct spdk_nvmf_tcp_qpair *tqpair, struct nvme_tcp_
 	SPDK_DEBUGLOG(nvmf_tcp, "enter\n");
 	/* check data digest if need */
 	if (pdu->ddgst_enable) {
-		if (tqpair->qpair.qid != 0 && !pdu->dif_ctx && tqpair->group &&
-		    (pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT == 0)) {
+		if (pdu->ddgst_offset == pdu->data_len) {
+			/* Already computed while the payload was received */
+			pdu->data_digest_crc32 = nvme_tcp_pdu_pad_data_digest(pdu, pdu->data_digest_crc32);
+		} else if (tqpair->qpair.qid != 0 && !pdu->dif_ctx && tqpair->group &&
+			   (pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT == 0)) {
 			rc = spdk_accel_submit_crc32cv(tqpair->group->accel_channel, &pdu->data_digest_crc32, pdu->data_iov,
 						       pdu->data_iovcnt, 0, data_crc32_calc_done, pdu);
 			if (spdk_likely(rc == 0)) {
@@ -2607,6 +2748,12 @@ nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 			}
 			pdu->rw_offset += rc;
 
+			/* Once a payload doesn't arrive in a single read, digest the data as it comes */
+			if (pdu->ddgst_enable && tqpair->group != NULL && tqpair->group->ddgst_stream &&
+			    pdu->dif_ctx == NULL && (pdu->rw_offset < data_len || pdu->ddgst_offset != 0)) {
+				nvmf_tcp_pdu_stream_data_digest(pdu);
+			}
+
 			if (pdu->rw_offset < data_len) {
 				return NVME_TCP_PDU_IN_PROGRESS;
 			}
@@ -2773,6 +2920,18 @@ nvmf_tcp_req_parse_sgl(struct spdk_nvmf_tcp_req *tcp_req,
 			goto fatal_err;
 		}
 
+		if (length <= max_len && !req->dif_enabled && nvmf_ctrlr_use_zcopy(req)) {
+			/* The payload is left in the socket until zcopy_start provides the buffers
+			 * it can be received into. */
+			SPDK_DEBUGLOG(nvmf_tcp, "Using zero-copy to receive in-capsule data of request %p\n",
+				      tcp_req);
+			req->length = length;
+			req->data_from_pool = false;
+			nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_BUF);
+			nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_HAVE_BUFFER);
+			return;
+		}
+
 		if (spdk_unlikely(length > max_len)) {
 			/* According to the SPEC we should support ICD up to 8192 bytes for admin and fabric commands */
 			if (length <= SPDK_NVME_TCP_IN_CAPSULE_DATA_MAX_SIZE &&
@@ -2846,6 +3005,25 @@ nvmf_tcp_dif_error_to_compl_status(uint8_t err_type) {
 	return result;
 }
 
+static void
+nvmf_tcp_req_build_c2h_capsule_resp(struct spdk_nvmf_tcp_qpair *tqpair,
+				    struct spdk_nvmf_tcp_req *tcp_req)
+{
+	struct spdk_nvme_tcp_rsp *capsule_resp = &tcp_req->c2h_capsule_resp.hdr;
+	uint32_t crc32c;
+
+	memset(capsule_resp, 0, sizeof(*capsule_resp));
+	capsule_resp->common.pdu_type = SPDK_NVME_TCP_PDU_TYPE_CAPSULE_RESP;
+	capsule_resp->common.plen = capsule_resp->common.hlen = sizeof(*capsule_resp);
+	capsule_resp->rccqe = tcp_req->req.rsp->nvme_cpl;
+	if (tqpair->host_hdgst_enable) {
+		capsule_resp->common.flags |= SPDK_NVME_TCP_CH_FLAGS_HDGSTF;
+		capsule_resp->common.plen += SPDK_NVME_TCP_DIGEST_LEN;
+		crc32c = spdk_crc32c_update(capsule_resp, capsule_resp->common.hlen, ~0) ^ SPDK_CRC32C_XOR;
+		MAKE_DIGEST_WORD(tcp_req->c2h_capsule_resp.hdgst, crc32c);
+	}
+}
+
 static void
 _nvmf_tcp_send_c2h_data(struct spdk_nvmf_tcp_qpair *tqpair,
 			struct spdk_nvmf_tcp_req *tcp_req)
@@ -2963,6 +3141,17 @@ _nvmf_tcp_send_c2h_data(struct spdk_nvmf_tcp_qpair *tqpair,
 	}
 
 	rsp_pdu->rw_offset += c2h_data->datal;
+
+	/* If a capsule response has to follow the data, queue it together with the last C2H
+	 * data PDU instead of waiting for that PDU to be written out first. */
+	if ((c2h_data->common.flags & SPDK_NVME_TCP_C2H_DATA_FLAGS_LAST_PDU) &&
+	    !(c2h_data->common.flags & SPDK_NVME_TCP_C2H_DATA_FLAGS_SUCCESS)) {
+		nvmf_tcp_req_build_c2h_capsule_resp(tqpair, tcp_req);
+		rsp_pdu->req = tcp_req;
+		nvmf_tcp_qpair_write_req_pdu(tqpair, tcp_req, nvmf_tcp_request_free, tcp_req);
+		return;
+	}
+
 	nvmf_tcp_qpair_write_req_pdu(tqpair, tcp_req, nvmf_tcp_pdu_c2h_data_complete, tcp_req);
 }
 
@@ -3125,6 +3314,10 @@ nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
 			if (tcp_req->req.xfer == SPDK_NVME_DATA_NONE) {
 				/* Reset the tqpair receiving pdu state */
 				nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY);
+				if (spdk_unlikely(!nvmf_transport_req_admit(&tcp_req->req))) {
+					nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_COMPLETE);
+					break;
+				}
 				nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_EXECUTE);
 				break;
 			}
@@ -3139,6 +3332,12 @@ nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
 			} else {
 				/* Data is transmitted by C2H PDUs */
 				nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY);
+				/* In-capsule data is still to be received into the request, so only the
+				 * commands without it can be rejected here */
+				if (spdk_unlikely(!nvmf_transport_req_admit(&tcp_req->req))) {
+					nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_COMPLETE);
+					break;
+				}
 			}
 
 			nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_NEED_BUFFER);
@@ -3204,10 +3403,25 @@ nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
 			if (spdk_unlikely(spdk_nvme_cpl_is_error(&tcp_req->req.rsp->nvme_cpl))) {
 				SPDK_DEBUGLOG(nvmf_tcp, "Zero-copy start failed for tcp_req(%p) on tqpair=%p\n",
 					      tcp_req, tqpair);
-				nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_COMPLETE);
-				break;
+				if (!tcp_req->has_in_capsule_data) {
+					nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_COMPLETE);
+					break;
+				}
+				/* The in-capsule data still needs to be drained from the socket, so
+				 * receive it into the request's own buffer and complete it afterwards. */
+				tcp_req->req.iov[0].iov_base = tcp_req->buf;
+				tcp_req->req.iov[0].iov_len = tcp_req->req.length;
+				tcp_req->req.iovcnt = 1;
 			}
-			if (tcp_req->req.xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER) {
+			if (tcp_req->has_in_capsule_data) {
+				pdu = tqpair->pdu_in_progress;
+				SPDK_DEBUGLOG(nvmf_tcp, "Receiving in-capsule data for tcp_req(%p) on tqpair=%p\n",
+					      tcp_req, tqpair);
+				nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER);
+				nvme_tcp_pdu_set_data_buf(pdu, tcp_req->req.iov, tcp_req->req.iovcnt,
+							  0, tcp_req->req.length);
+				nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PAYLOAD);
+			} else if (tcp_req->req.xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER) {
 				SPDK_DEBUGLOG(nvmf_tcp, "Sending R2T for tcp_req(%p) on tqpair=%p\n", tcp_req, tqpair);
 				nvmf_tcp_send_r2t_pdu(tqpair, tcp_req);
 			} else {
@@ -3551,10 +3765,17 @@ nvmf_tcp_close_qpair(struct spdk_nvmf_qpair *qpair,
 static int
 nvmf_tcp_poll_group_poll(struct spdk_nvmf_transport_poll_group *group)
 {
+	struct spdk_nvmf_tcp_transport *ttransport;
 	struct spdk_nvmf_tcp_poll_group *tgroup;
 	int num_events;
 
 	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+	ttransport = SPDK_CONTAINEROF(group->transport, struct spdk_nvmf_tcp_transport, transport);
+
+	/* Update the load even while idle, so that it decays once all qpairs are gone */
+	if (ttransport->tcp_opts.poll_group_load_balance) {
+		nvmf_tcp_poll_group_update_load(tgroup, ttransport->load_period_ticks);
+	}
 
 	if (spdk_unlikely(TAILQ_EMPTY(&tgroup->qpairs))) {
 		return 0;
@@ -87,6 +87,7 @@ nvmf_transport_dump_opts(struct spdk_nvmf_transport *transport, struct spdk_json
 	spdk_json_write_named_uint32(w, "buf_cache_size", opts->buf_cache_size);
 	spdk_json_write_named_bool(w, "dif_insert_or_strip", opts->dif_insert_or_strip);
 	spdk_json_write_named_bool(w, "zcopy", opts->zcopy);
+	spdk_json_write_named_bool(w, "host_io_stats", opts->host_io_stats);
 
 	if (transport->ops->dump_opts) {
 		transport->ops->dump_opts(transport, w);
@@ -95,6 +96,8 @@ nvmf_transport_dump_opts(struct spdk_nvmf_transport *transport, struct spdk_json
 	spdk_json_write_named_uint32(w, "abort_timeout_sec", opts->abort_timeout_sec);
 	spdk_json_write_named_uint32(w, "ack_timeout", opts->ack_timeout);
 	spdk_json_write_named_uint32(w, "data_wr_pool_size", opts->data_wr_pool_size);
+	spdk_json_write_named_uint32(w, "host_max_iops", opts->host_max_iops);
+	spdk_json_write_named_uint32(w, "host_max_burst", opts->host_max_burst);
 	spdk_json_write_object_end(w);
 }
 
@@ -151,12 +154,15 @@ nvmf_transport_opts_copy(struct spdk_nvmf_transport_opts *opts,
 	SET_FIELD(transport_specific);
 	SET_FIELD(acceptor_poll_rate);
 	SET_FIELD(zcopy);
+	SET_FIELD(host_io_stats);
 	SET_FIELD(ack_timeout);
 	SET_FIELD(data_wr_pool_size);
+	SET_FIELD(host_max_iops);
+	SET_FIELD(host_max_burst);
 
 	/* Do not remove this statement, you should always update this statement when you adding a new field,
 	 * and do not forget to add the SET_FIELD statement for your added field. */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_nvmf_transport_opts) == 72, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_nvmf_transport_opts) == 80, "Incorrect size");
 
 #undef SET_FIELD
 #undef FILED_CHECK
@@ -188,6 +194,8 @@ nvmf_transport_create_async_done(void *cb_arg, struct spdk_nvmf_transport *trans
 
 	pthread_mutex_init(&transport->mutex, NULL);
 	TAILQ_INIT(&transport->listeners);
+	TAILQ_INIT(&transport->host_stats);
+	TAILQ_INIT(&transport->host_admission);
 	transport->ops = ctx->ops;
 	transport->opts = ctx->opts;
 	chars_written = snprintf(transport->iobuf_name, MAX_MEMPOOL_NAME_LENGTH, "%s_%s", "nvmf",
@@ -365,6 +373,8 @@ spdk_nvmf_transport_destroy(struct spdk_nvmf_transport *transport,
 			    spdk_nvmf_transport_destroy_done_cb cb_fn, void *cb_arg)
 {
 	struct spdk_nvmf_listener *listener, *listener_tmp;
+	struct nvmf_transport_host_stats *stats, *stats_tmp;
+	struct nvmf_transport_host_admission *admission, *admission_tmp;
 
 	TAILQ_FOREACH_SAFE(listener, &transport->listeners, link, listener_tmp) {
 		TAILQ_REMOVE(&transport->listeners, listener, link);
@@ -372,6 +382,16 @@ spdk_nvmf_transport_destroy(struct spdk_nvmf_transport *transport,
 		free(listener);
 	}
 
+	TAILQ_FOREACH_SAFE(stats, &transport->host_stats, link, stats_tmp) {
+		TAILQ_REMOVE(&transport->host_stats, stats, link);
+		free(stats);
+	}
+
+	TAILQ_FOREACH_SAFE(admission, &transport->host_admission, link, admission_tmp) {
+		TAILQ_REMOVE(&transport->host_admission, admission, link);
+		free(admission);
+	}
+
 	if (nvmf_transport_use_iobuf(transport)) {
 		spdk_iobuf_unregister_module(transport->iobuf_name);
 	}
@@ -380,6 +400,158 @@ spdk_nvmf_transport_destroy(struct spdk_nvmf_transport *transport,
 	return transport->ops->destroy(transport, cb_fn, cb_arg);
 }
 
+struct nvmf_transport_host_stats *
+nvmf_transport_get_host_stats(struct spdk_nvmf_transport *transport, const char *hostnqn)
+{
+	struct nvmf_transport_host_stats *stats;
+
+	pthread_mutex_lock(&transport->mutex);
+	TAILQ_FOREACH(stats, &transport->host_stats, link) {
+		if (strcmp(stats->hostnqn, hostnqn) == 0) {
+			break;
+		}
+	}
+
+	if (stats == NULL) {
+		stats = calloc(1, sizeof(*stats));
+		if (stats != NULL) {
+			snprintf(stats->hostnqn, sizeof(stats->hostnqn), "%s", hostnqn);
+			TAILQ_INSERT_TAIL(&transport->host_stats, stats, link);
+		} else {
+			SPDK_ERRLOG("Unable to allocate I/O stats for host %s\n", hostnqn);
+		}
+	}
+	pthread_mutex_unlock(&transport->mutex);
+
+	return stats;
+}
+
+struct nvmf_transport_host_admission *
+nvmf_transport_get_host_admission(struct spdk_nvmf_transport *transport, const char *hostnqn)
+{
+	struct nvmf_transport_host_admission *admission;
+	uint64_t burst;
+
+	pthread_mutex_lock(&transport->mutex);
+	TAILQ_FOREACH(admission, &transport->host_admission, link) {
+		if (strcmp(admission->hostnqn, hostnqn) == 0) {
+			break;
+		}
+	}
+
+	if (admission == NULL) {
+		admission = calloc(1, sizeof(*admission));
+		if (admission != NULL) {
+			snprintf(admission->hostnqn, sizeof(admission->hostnqn), "%s", hostnqn);
+			burst = transport->opts.host_max_burst;
+			if (burst == 0) {
+				burst = spdk_max(transport->opts.host_max_iops / 10, 1);
+			}
+			admission->interval = spdk_max(spdk_get_ticks_hz() / transport->opts.host_max_iops, 1);
+			/* A full bucket lets burst commands in at once */
+			admission->tolerance = admission->interval * burst;
+			TAILQ_INSERT_TAIL(&transport->host_admission, admission, link);
+		} else {
+			SPDK_ERRLOG("Unable to allocate admission control for host %s\n", hostnqn);
+		}
+	}
+	pthread_mutex_unlock(&transport->mutex);
+
+	return admission;
+}
+
+bool
+nvmf_transport_req_admit(struct spdk_nvmf_request *req)
+{
+	struct spdk_nvmf_qpair *qpair = req->qpair;
+	struct spdk_nvmf_ctrlr *ctrlr = qpair->ctrlr;
+	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
+
+	/* Fused commands are let in, rejecting only one half would break the pair */
+	if (spdk_likely(ctrlr == NULL || ctrlr->host_admission == NULL) || qpair->qid == 0 ||
+	    req->cmd->nvme_cmd.fuse != SPDK_NVME_CMD_FUSE_NONE) {
+		return true;
+	}
+
+	if (spdk_likely(nvmf_transport_host_admit(ctrlr->host_admission, spdk_get_ticks()))) {
+		return true;
+	}
+
+	/* Ask the host to retry, after the delay of the first CRDT if ACRE is enabled */
+	rsp->cid = req->cmd->nvme_cmd.cid;
+	rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+	rsp->status.sc = SPDK_NVME_SC_NAMESPACE_NOT_READY;
+	rsp->status.dnr = 0;
+	rsp->status.crd = ctrlr->acre_enabled ? 1 : 0;
+	qpair->group->stat.rejected_nvme_io++;
+
+	return false;
+}
+
+/* The smallest in-capsule data size that would have fit 90% of the transfers, or 0 if that's
+ * more than the largest bucket */
+static uint32_t
+nvmf_transport_host_stats_get_icd(uint64_t *hist)
+{
+	uint64_t total = 0, count = 0;
+	uint32_t i;
+
+	for (i = 0; i < NVMF_HOST_IO_STATS_NUM_BUCKETS; i++) {
+		total += hist[i];
+	}
+
+	for (i = 0; i < NVMF_HOST_IO_STATS_NUM_BUCKETS - 1 && total > 0; i++) {
+		count += hist[i];
+		if (count * 10 >= total * 9) {
+			return 1U << (NVMF_HOST_IO_STATS_MIN_SIZE_SHIFT + i);
+		}
+	}
+
+	return 0;
+}
+
+void
+nvmf_transport_dump_host_stats(struct spdk_nvmf_transport *transport,
+			       struct spdk_json_write_ctx *w)
+{
+	struct nvmf_transport_host_stats *stats;
+	uint64_t hist[NVMF_HOST_IO_STATS_NUM_BUCKETS];
+	uint32_t i;
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "trtype", spdk_nvmf_get_transport_name(transport));
+	spdk_json_write_named_array_begin(w, "hosts");
+
+	pthread_mutex_lock(&transport->mutex);
+	TAILQ_FOREACH(stats, &transport->host_stats, link) {
+		for (i = 0; i < NVMF_HOST_IO_STATS_NUM_BUCKETS; i++) {
+			hist[i] = __atomic_load_n(&stats->write_size_hist[i], __ATOMIC_RELAXED);
+		}
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "hostnqn", stats->hostnqn);
+		spdk_json_write_named_array_begin(w, "write_size_histogram");
+		for (i = 0; i < NVMF_HOST_IO_STATS_NUM_BUCKETS; i++) {
+			spdk_json_write_object_begin(w);
+			if (i < NVMF_HOST_IO_STATS_NUM_BUCKETS - 1) {
+				spdk_json_write_named_uint32(w, "max_size", 1U << (NVMF_HOST_IO_STATS_MIN_SIZE_SHIFT + i));
+			} else {
+				spdk_json_write_named_null(w, "max_size");
+			}
+			spdk_json_write_named_uint64(w, "count", hist[i]);
+			spdk_json_write_object_end(w);
+		}
+		spdk_json_write_array_end(w);
+		spdk_json_write_named_uint32(w, "recommended_in_capsule_data_size",
+					     nvmf_transport_host_stats_get_icd(hist));
+		spdk_json_write_object_end(w);
+	}
+	pthread_mutex_unlock(&transport->mutex);
+
+	spdk_json_write_array_end(w);
+	spdk_json_write_object_end(w);
+}
+
 struct spdk_nvmf_listener *
 nvmf_transport_find_listener(struct spdk_nvmf_transport *transport,
 			     const struct spdk_nvme_transport_id *trid)
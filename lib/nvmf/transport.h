@@ -11,6 +11,7 @@
 #include "spdk/nvme.h"
 #include "spdk/nvmf.h"
 #include "spdk/nvmf_transport.h"
+#include "spdk/util.h"
 
 void nvmf_transport_listener_discover(struct spdk_nvmf_transport *transport,
 				      struct spdk_nvme_transport_id *trid,
@@ -64,4 +65,72 @@ int nvmf_request_get_stripped_buffers(struct spdk_nvmf_request *req,
 
 bool nvmf_request_get_buffers_abort(struct spdk_nvmf_request *req);
 
+/* Host to controller transfers are counted in buckets of up to 512 B, 1 KiB, ... 64 KiB,
+ * and a last bucket for anything larger. */
+#define NVMF_HOST_IO_STATS_MIN_SIZE_SHIFT	9
+#define NVMF_HOST_IO_STATS_NUM_BUCKETS		9
+
+struct nvmf_transport_host_stats {
+	char					hostnqn[SPDK_NVMF_NQN_MAX_LEN + 1];
+	uint64_t				write_size_hist[NVMF_HOST_IO_STATS_NUM_BUCKETS];
+	TAILQ_ENTRY(nvmf_transport_host_stats)	link;
+};
+
+struct nvmf_transport_host_stats *nvmf_transport_get_host_stats(struct spdk_nvmf_transport *transport,
+		const char *hostnqn);
+
+static inline void
+nvmf_transport_host_stats_record(struct nvmf_transport_host_stats *stats, uint32_t length)
+{
+	uint32_t bucket = 0;
+
+	assert(length > 0);
+	length = (length - 1) >> NVMF_HOST_IO_STATS_MIN_SIZE_SHIFT;
+	if (length != 0) {
+		bucket = spdk_min(spdk_u32log2(length) + 1, NVMF_HOST_IO_STATS_NUM_BUCKETS - 1);
+	}
+
+	/* Shared by all the qpairs of the host, which can be on different threads */
+	__atomic_fetch_add(&stats->write_size_hist[bucket], 1, __ATOMIC_RELAXED);
+}
+
+/* Rate limit of the I/O commands of a host, as a token bucket kept in the form of the
+ * theoretical arrival time of the next command (GCRA). */
+struct nvmf_transport_host_admission {
+	char					hostnqn[SPDK_NVMF_NQN_MAX_LEN + 1];
+	/* In ticks */
+	uint64_t				tat;
+	uint64_t				interval;
+	uint64_t				tolerance;
+	TAILQ_ENTRY(nvmf_transport_host_admission)	link;
+};
+
+struct nvmf_transport_host_admission *nvmf_transport_get_host_admission(
+	struct spdk_nvmf_transport *transport, const char *hostnqn);
+
+static inline bool
+nvmf_transport_host_admit(struct nvmf_transport_host_admission *admission, uint64_t now)
+{
+	uint64_t tat, next_tat;
+
+	/* Shared by all the qpairs of the host, which can be on different threads */
+	tat = __atomic_load_n(&admission->tat, __ATOMIC_RELAXED);
+	do {
+		next_tat = spdk_max(tat, now) + admission->interval;
+		if (next_tat - now > admission->tolerance) {
+			return false;
+		}
+	} while (!__atomic_compare_exchange_n(&admission->tat, &tat, next_tat, true,
+					      __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	return true;
+}
+
+/*
+ * Charge an I/O command to the rate limit of its host, before any buffer is allocated for it.
+ * Returns false, with the completion filled in, if the host is over its limit and the command
+ * has to be completed right away without being executed.
+ */
+bool nvmf_transport_req_admit(struct spdk_nvmf_request *req);
+
 #endif /* SPDK_NVMF_TRANSPORT_H */
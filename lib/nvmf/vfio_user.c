@@ -505,6 +505,11 @@ struct nvmf_vfio_user_endpoint {
 
 	int					migr_fd;
 	void					*migr_data;
+	/*
+	 * Number of bytes of migr_data used by the saved or received migration
+	 * data, only that much is transferred by the vfio-user client.
+	 */
+	uint64_t				migr_data_len;
 
 	struct spdk_nvme_transport_id		trid;
 	struct spdk_nvmf_subsystem		*subsystem;
@@ -3489,19 +3494,70 @@ vfio_user_ctrlr_dump_migr_data(const char *name,
 }
 
 /* Read region 9 content and restore it to migration data structures */
+/*
+ * The source only transfers the part of the migration region its data uses, check that the first
+ * len bytes of the region hold everything the header points to.
+ */
+static int
+vfio_user_migr_data_check(struct nvmf_vfio_user_endpoint *endpoint, uint64_t len)
+{
+	const struct vfio_user_nvme_migr_header *hdr = endpoint->migr_data;
+	const struct {
+		uint64_t offset;
+		uint64_t len;
+		uint64_t max_len;
+	} parts[] = {
+		{ hdr->nvmf_data_offset, hdr->nvmf_data_len, sizeof(struct spdk_nvmf_ctrlr_migr_data) },
+		{ hdr->qp_offset, hdr->qp_len, sizeof(((struct vfio_user_nvme_migr_state *)0)->qps) },
+		{
+			hdr->bar_offset[VFU_PCI_DEV_BAR0_REGION_IDX],
+			hdr->bar_len[VFU_PCI_DEV_BAR0_REGION_IDX], NVMF_VFIO_USER_DOORBELLS_SIZE
+		},
+		{
+			hdr->bar_offset[VFU_PCI_DEV_CFG_REGION_IDX],
+			hdr->bar_len[VFU_PCI_DEV_CFG_REGION_IDX], NVME_REG_CFG_SIZE
+		},
+	};
+	size_t i;
+
+	if (len < sizeof(*hdr) || len > vfio_user_migr_data_len()) {
+		SPDK_ERRLOG("%s: bad migration data length %#"PRIx64"\n", endpoint_id(endpoint), len);
+		return -EINVAL;
+	}
+
+	/* TODO: version check */
+	if (hdr->magic != VFIO_USER_NVME_MIGR_MAGIC) {
+		SPDK_ERRLOG("%s: bad magic number %x\n", endpoint_id(endpoint), hdr->magic);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < SPDK_COUNTOF(parts); i++) {
+		if (parts[i].len > parts[i].max_len || parts[i].offset < sizeof(*hdr) ||
+		    parts[i].offset > len || parts[i].len > len - parts[i].offset) {
+			SPDK_ERRLOG("%s: migration data part %zu at %#"PRIx64" of %#"PRIx64
+				    " bytes is out of the %#"PRIx64" bytes received\n",
+				    endpoint_id(endpoint), i, parts[i].offset, parts[i].len, len);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
 static int
 vfio_user_migr_stream_to_data(struct nvmf_vfio_user_endpoint *endpoint,
 			      struct vfio_user_nvme_migr_state *migr_state)
 {
 	void *data_ptr = endpoint->migr_data;
+	int rc;
+
+	rc = vfio_user_migr_data_check(endpoint, endpoint->migr_data_len);
+	if (rc != 0) {
+		return rc;
+	}
 
 	/* Load vfio_user_nvme_migr_header first */
 	memcpy(&migr_state->ctrlr_header, data_ptr, sizeof(struct vfio_user_nvme_migr_header));
-	/* TODO: version check */
-	if (migr_state->ctrlr_header.magic != VFIO_USER_NVME_MIGR_MAGIC) {
-		SPDK_ERRLOG("%s: bad magic number %x\n", endpoint_id(endpoint), migr_state->ctrlr_header.magic);
-		return -EINVAL;
-	}
 
 	/* Load nvmf controller data */
 	data_ptr = endpoint->migr_data + migr_state->ctrlr_header.nvmf_data_offset;
@@ -3618,6 +3674,8 @@ vfio_user_migr_ctrlr_save_data(struct nvmf_vfio_user_ctrlr *vu_ctrlr)
 	migr_state.ctrlr_header.bar_offset[VFU_PCI_DEV_CFG_REGION_IDX] = data_offset;
 	migr_state.ctrlr_header.bar_len[VFU_PCI_DEV_CFG_REGION_IDX] = NVME_REG_CFG_SIZE;
 	memcpy(data_ptr, &migr_state.cfg, NVME_REG_CFG_SIZE);
+	endpoint->migr_data_len = data_offset + NVME_REG_CFG_SIZE;
+	assert(endpoint->migr_data_len <= vfio_user_migr_data_len());
 
 	/* copy shadow doorbells */
 	if (vu_ctrlr->sdbl != NULL) {
@@ -4040,6 +4098,9 @@ vfio_user_migration_get_pending_bytes(vfu_ctx_t *vfu_ctx)
 	if (ctrlr->migr_data_prepared) {
 		assert(ctrlr->state == VFIO_USER_CTRLR_MIGRATING);
 		pending_bytes = 0;
+	} else if (ctrlr->in_source_vm) {
+		/* Saved when entering stop-and-copy */
+		pending_bytes = endpoint->migr_data_len;
 	} else {
 		pending_bytes = vfio_user_migr_data_len();
 	}
@@ -4071,8 +4132,13 @@ vfio_user_migration_prepare_data(vfu_ctx_t *vfu_ctx, uint64_t *offset, uint64_t
 
 	if (ctrlr->in_source_vm) { /* migration source */
 		assert(size != NULL);
-		*size = vfio_user_migr_data_len();
-		vfio_user_migr_ctrlr_save_data(ctrlr);
+		/*
+		 * The data was saved when entering stop-and-copy and the
+		 * controller can't change since, so just hand it out. Only the
+		 * used part of the region is transferred, which for controllers
+		 * with few queues is a fraction of the region size.
+		 */
+		*size = endpoint->migr_data_len;
 	} else { /* migration destination */
 		assert(size == NULL);
 		assert(!ctrlr->migr_data_prepared);
@@ -4110,17 +4176,18 @@ vfio_user_migration_write_data(vfu_ctx_t *vfu_ctx __attribute__((unused)),
 }
 
 static int
-vfio_user_migration_data_written(vfu_ctx_t *vfu_ctx __attribute__((unused)),
-				 uint64_t count)
+vfio_user_migration_data_written(vfu_ctx_t *vfu_ctx, uint64_t count)
 {
+	struct nvmf_vfio_user_endpoint *endpoint = vfu_get_private(vfu_ctx);
+
 	SPDK_DEBUGLOG(nvmf_vfio, "write 0x%"PRIx64"\n", (uint64_t)count);
 
-	if (count != vfio_user_migr_data_len()) {
-		SPDK_DEBUGLOG(nvmf_vfio, "%s bad count %#lx\n",
-			      endpoint_id(vfu_get_private(vfu_ctx)), count);
+	/* The source only sends the used part of the region, see vfio_user_migr_ctrlr_save_data() */
+	if (vfio_user_migr_data_check(endpoint, count) != 0) {
 		errno = EINVAL;
 		return -1;
 	}
+	endpoint->migr_data_len = count;
 
 	return 0;
 }
@@ -5691,6 +5758,19 @@ handle_suppressed_irq(struct nvmf_vfio_user_ctrlr *ctrlr,
 	cq->last_head = cq_head;
 }
 
+/*
+ * Cheap check whether the doorbell of an SQ moved. An invalid doorbell value
+ * is reported as new commands, so that nvmf_vfio_user_sq_poll() handles it.
+ */
+static inline bool
+sq_has_new_cmds(struct nvmf_vfio_user_sq *sq)
+{
+	/* See nvmf_vfio_user_sq_poll() for why the cache is invalidated. */
+	spdk_ivdt_dcache(sq_dbl_tailp(sq));
+
+	return (*sq_dbl_tailp(sq) & 0xffffu) != *sq_headp(sq);
+}
+
 /* Returns the number of commands processed, or a negative value on error. */
 static int
 nvmf_vfio_user_sq_poll(struct nvmf_vfio_user_sq *sq)
@@ -5796,6 +5876,16 @@ nvmf_vfio_user_poll_group_poll(struct spdk_nvmf_transport_poll_group *group)
 			continue;
 		}
 
+		/*
+		 * Most SQs of a group are usually idle, so skip the full poll of
+		 * those as soon as the doorbell shows no new commands. SQs of
+		 * controllers with adaptive IRQs still need to be polled, as that
+		 * is where suppressed IRQs get fired.
+		 */
+		if (!sq_has_new_cmds(sq) && !sq->ctrlr->adaptive_irqs_enabled) {
+			continue;
+		}
+
 		ret = nvmf_vfio_user_sq_poll(sq);
 
 		if (spdk_unlikely(ret < 0)) {
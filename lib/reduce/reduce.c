@@ -16,6 +16,7 @@
 #include "spdk/log.h"
 #include "spdk/memory.h"
 #include "spdk/tree.h"
+#include "spdk/thread.h"
 
 #include "libpmem.h"
 
@@ -61,9 +62,16 @@ struct spdk_reduce_pm_file {
 #define REDUCE_IO_WRITEV	2
 #define	REDUCE_IO_UNMAP		3
 
+/*
+ * Set in the tail field of a chunk map when the last io unit of the chunk is shared with
+ *  other chunks.  The remaining bits hold the offset, in backing device blocks, of the
+ *  chunk's data in that io unit.
+ */
+#define REDUCE_CHUNK_TAIL_PACKED	(1U << 31)
+
 struct spdk_reduce_chunk_map {
 	uint32_t		compressed_size;
-	uint32_t		reserved;
+	uint32_t		tail;
 	uint64_t		io_unit_index[0];
 };
 
@@ -108,8 +116,12 @@ struct spdk_reduce_vol_request {
 	bool					copy_after_decompress;
 	uint64_t				offset;
 	uint64_t				logical_map_index;
+	/* Orders the executing requests of a chunk, so several reads can execute together. */
+	uint64_t				overlap_seq;
 	uint64_t				length;
 	uint64_t				chunk_map_index;
+	/* Chunk map replaced by this write, released once the logical map is persisted */
+	uint64_t				old_chunk_map_index;
 	struct spdk_reduce_chunk_map		*chunk;
 	spdk_reduce_vol_op_complete		cb_fn;
 	void					*cb_arg;
@@ -118,6 +130,15 @@ struct spdk_reduce_vol_request {
 	struct spdk_reduce_vol_cb_args		backing_cb_args;
 };
 
+/* Decompressed copy of a chunk, kept to serve later reads of the chunk without decompressing it. */
+struct reduce_cache_entry {
+	uint64_t				logical_map_index;
+	uint8_t					*buf;
+	bool					valid;
+	RB_ENTRY(reduce_cache_entry)		rbnode;
+	TAILQ_ENTRY(reduce_cache_entry)		lru;
+};
+
 struct spdk_reduce_vol {
 	struct spdk_reduce_vol_params		params;
 	struct spdk_reduce_vol_info		info;
@@ -141,17 +162,39 @@ struct spdk_reduce_vol {
 	uint64_t				find_block_offset;
 	/* Cache free blocks for backing bdev to speed up lookup of free backing blocks. */
 	struct reduce_queue			free_backing_blocks_queue;
+	/* Number of chunk tails packed in each backing io unit, only used with pack_chunks. */
+	uint16_t				*io_unit_tails;
+	/* Backing io unit chunk tails are currently packed in, and its next free block. */
+	uint64_t				pack_io_unit;
+	uint32_t				pack_next_block;
 
 	struct spdk_reduce_vol_request		*request_mem;
 	TAILQ_HEAD(, spdk_reduce_vol_request)	free_requests;
 	RB_HEAD(executing_req_tree, spdk_reduce_vol_request) executing_requests;
+	uint64_t				overlap_seq;
 	TAILQ_HEAD(, spdk_reduce_vol_request)	queued_requests;
+	/*
+	 * Writes waiting for their map updates to be persisted.  When the pm file is not on
+	 *  persistent memory, each persist is an msync(), so the updates of all the writes
+	 *  completing together are persisted in one batch.
+	 */
+	TAILQ_HEAD(, spdk_reduce_vol_request)	persist_requests;
+	bool					persist_scheduled;
 
 	/* Single contiguous buffer used for all request buffers for this volume. */
 	uint8_t					*buf_mem;
 	struct iovec				*buf_iov_mem;
 	/* Single contiguous buffer used for backing io buffers for this volume. */
 	uint8_t					*buf_backing_io_mem;
+
+	/* Read cache of decompressed chunks, the most recently used entry is at the head. */
+	struct {
+		struct reduce_cache_entry			*entries;
+		uint32_t					num_entries;
+		uint8_t						*buf;
+		RB_HEAD(reduce_cache_tree, reduce_cache_entry)	tree;
+		TAILQ_HEAD(reduce_cache_lru, reduce_cache_entry)	lru;
+	} cache;
 };
 
 static void _start_readv_request(struct spdk_reduce_vol_request *req);
@@ -235,6 +278,15 @@ _reduce_vol_get_chunk_map(struct spdk_reduce_vol *vol, uint64_t chunk_map_index)
 	return (struct spdk_reduce_chunk_map *)chunk_map_addr;
 }
 
+/* Return true if io unit i of the chunk is shared with the tails of other chunks. */
+static inline bool
+_reduce_vol_chunk_tail_packed(struct spdk_reduce_vol *vol, struct spdk_reduce_chunk_map *chunk,
+			      uint32_t i)
+{
+	return vol->params.pack_chunks && (chunk->tail & REDUCE_CHUNK_TAIL_PACKED) &&
+	       i + 1 == spdk_divide_round_up(chunk->compressed_size, vol->params.backing_io_unit_size);
+}
+
 static int
 _validate_vol_params(struct spdk_reduce_vol_params *params)
 {
@@ -470,6 +522,137 @@ spdk_reduce_vol_get_info(const struct spdk_reduce_vol *vol)
 	return &vol->info;
 }
 
+static int
+reduce_cache_cmp(struct reduce_cache_entry *entry1, struct reduce_cache_entry *entry2)
+{
+	if (entry1->logical_map_index < entry2->logical_map_index) {
+		return -1;
+	}
+
+	return entry1->logical_map_index > entry2->logical_map_index;
+}
+
+RB_GENERATE_STATIC(reduce_cache_tree, reduce_cache_entry, rbnode, reduce_cache_cmp);
+
+static void
+_reduce_cache_free(struct spdk_reduce_vol *vol)
+{
+	free(vol->cache.entries);
+	free(vol->cache.buf);
+	memset(&vol->cache, 0, sizeof(vol->cache));
+}
+
+static struct reduce_cache_entry *
+_reduce_cache_lookup(struct spdk_reduce_vol *vol, uint64_t logical_map_index)
+{
+	struct reduce_cache_entry key;
+
+	if (vol->cache.num_entries == 0) {
+		return NULL;
+	}
+
+	key.logical_map_index = logical_map_index;
+	return RB_FIND(reduce_cache_tree, &vol->cache.tree, &key);
+}
+
+static void
+_reduce_cache_invalidate(struct spdk_reduce_vol *vol, uint64_t logical_map_index)
+{
+	struct reduce_cache_entry *entry;
+
+	entry = _reduce_cache_lookup(vol, logical_map_index);
+	if (entry != NULL) {
+		RB_REMOVE(reduce_cache_tree, &vol->cache.tree, entry);
+		entry->valid = false;
+		/* Reuse the invalidated entry first */
+		TAILQ_REMOVE(&vol->cache.lru, entry, lru);
+		TAILQ_INSERT_TAIL(&vol->cache.lru, entry, lru);
+	}
+}
+
+static void
+_reduce_cache_insert(struct spdk_reduce_vol *vol, uint64_t logical_map_index, const void *chunk)
+{
+	struct reduce_cache_entry *entry;
+
+	if (vol->cache.num_entries == 0) {
+		return;
+	}
+
+	entry = _reduce_cache_lookup(vol, logical_map_index);
+	if (entry == NULL) {
+		entry = TAILQ_LAST(&vol->cache.lru, reduce_cache_lru);
+		if (entry->valid) {
+			RB_REMOVE(reduce_cache_tree, &vol->cache.tree, entry);
+		}
+		entry->logical_map_index = logical_map_index;
+		entry->valid = true;
+		RB_INSERT(reduce_cache_tree, &vol->cache.tree, entry);
+	}
+
+	memcpy(entry->buf, chunk, vol->params.chunk_size);
+	TAILQ_REMOVE(&vol->cache.lru, entry, lru);
+	TAILQ_INSERT_HEAD(&vol->cache.lru, entry, lru);
+}
+
+/* Copy the requested blocks out of the cached chunk, returns false on a cache miss. */
+static bool
+_reduce_cache_read(struct spdk_reduce_vol *vol, struct iovec *iov, int iovcnt, uint64_t offset)
+{
+	struct reduce_cache_entry *entry;
+	uint8_t *buf;
+	int i;
+
+	entry = _reduce_cache_lookup(vol, offset / vol->logical_blocks_per_chunk);
+	if (entry == NULL) {
+		return false;
+	}
+
+	buf = entry->buf + (offset % vol->logical_blocks_per_chunk) * vol->params.logical_block_size;
+	for (i = 0; i < iovcnt; i++) {
+		memcpy(iov[i].iov_base, buf, iov[i].iov_len);
+		buf += iov[i].iov_len;
+	}
+
+	TAILQ_REMOVE(&vol->cache.lru, entry, lru);
+	TAILQ_INSERT_HEAD(&vol->cache.lru, entry, lru);
+
+	return true;
+}
+
+int
+spdk_reduce_vol_set_read_cache_size(struct spdk_reduce_vol *vol, uint64_t cache_size)
+{
+	uint64_t num_entries = cache_size / vol->params.chunk_size;
+	uint32_t i;
+
+	if (num_entries > UINT32_MAX) {
+		return -EINVAL;
+	}
+
+	_reduce_cache_free(vol);
+	if (num_entries == 0) {
+		return 0;
+	}
+
+	vol->cache.entries = calloc(num_entries, sizeof(*vol->cache.entries));
+	vol->cache.buf = malloc(num_entries * vol->params.chunk_size);
+	if (vol->cache.entries == NULL || vol->cache.buf == NULL) {
+		_reduce_cache_free(vol);
+		return -ENOMEM;
+	}
+
+	vol->cache.num_entries = num_entries;
+	RB_INIT(&vol->cache.tree);
+	TAILQ_INIT(&vol->cache.lru);
+	for (i = 0; i < num_entries; i++) {
+		vol->cache.entries[i].buf = vol->cache.buf + i * vol->params.chunk_size;
+		TAILQ_INSERT_TAIL(&vol->cache.lru, &vol->cache.entries[i], lru);
+	}
+
+	return 0;
+}
+
 static void
 _init_load_cleanup(struct spdk_reduce_vol *vol, struct reduce_init_load_ctx *ctx)
 {
@@ -487,10 +670,12 @@ _init_load_cleanup(struct spdk_reduce_vol *vol, struct reduce_init_load_ctx *ctx
 		spdk_free(vol->backing_super);
 		spdk_bit_array_free(&vol->allocated_chunk_maps);
 		spdk_bit_array_free(&vol->allocated_backing_io_units);
+		free(vol->io_unit_tails);
 		free(vol->request_mem);
 		free(vol->buf_backing_io_mem);
 		free(vol->buf_iov_mem);
 		spdk_free(vol->buf_mem);
+		_reduce_cache_free(vol);
 		free(vol);
 	}
 }
@@ -599,6 +784,14 @@ _allocate_bit_arrays(struct spdk_reduce_vol *vol)
 		return -ENOMEM;
 	}
 
+	vol->pack_io_unit = REDUCE_EMPTY_MAP_ENTRY;
+	if (vol->params.pack_chunks) {
+		vol->io_unit_tails = calloc(total_backing_io_units, sizeof(*vol->io_unit_tails));
+		if (vol->io_unit_tails == NULL) {
+			return -ENOMEM;
+		}
+	}
+
 	/* Set backing io unit bits associated with metadata. */
 	num_metadata_io_units = (sizeof(*vol->backing_super) + REDUCE_PATH_MAX) /
 				vol->params.backing_io_unit_size;
@@ -613,8 +806,11 @@ _allocate_bit_arrays(struct spdk_reduce_vol *vol)
 static int
 overlap_cmp(struct spdk_reduce_vol_request *req1, struct spdk_reduce_vol_request *req2)
 {
-	return (req1->logical_map_index < req2->logical_map_index ? -1 : req1->logical_map_index >
-		req2->logical_map_index);
+	if (req1->logical_map_index != req2->logical_map_index) {
+		return req1->logical_map_index < req2->logical_map_index ? -1 : 1;
+	}
+
+	return (req1->overlap_seq < req2->overlap_seq ? -1 : req1->overlap_seq > req2->overlap_seq);
 }
 RB_GENERATE_STATIC(executing_req_tree, spdk_reduce_vol_request, rbnode, overlap_cmp);
 
@@ -679,6 +875,7 @@ spdk_reduce_vol_init(struct spdk_reduce_vol_params *params,
 	TAILQ_INIT(&vol->free_requests);
 	RB_INIT(&vol->executing_requests);
 	TAILQ_INIT(&vol->queued_requests);
+	TAILQ_INIT(&vol->persist_requests);
 	queue_init(&vol->free_chunks_queue);
 	queue_init(&vol->free_backing_blocks_queue);
 
@@ -887,10 +1084,16 @@ _load_read_super_and_path_cpl(void *cb_arg, int reduce_errno)
 		spdk_bit_array_set(vol->allocated_chunk_maps, logical_map_index);
 		chunk = _reduce_vol_get_chunk_map(vol, logical_map_index);
 		for (j = 0; j < vol->backing_io_units_per_chunk; j++) {
-			if (chunk->io_unit_index[j] != REDUCE_EMPTY_MAP_ENTRY) {
-				spdk_bit_array_set(vol->allocated_backing_io_units, chunk->io_unit_index[j]);
-				vol->info.allocated_io_units++;
+			if (chunk->io_unit_index[j] == REDUCE_EMPTY_MAP_ENTRY) {
+				continue;
 			}
+			if (_reduce_vol_chunk_tail_packed(vol, chunk, j) &&
+			    vol->io_unit_tails[chunk->io_unit_index[j]]++ > 0) {
+				/* The io unit is shared with chunks that were already accounted. */
+				continue;
+			}
+			spdk_bit_array_set(vol->allocated_backing_io_units, chunk->io_unit_index[j]);
+			vol->info.allocated_io_units++;
 		}
 	}
 
@@ -929,6 +1132,7 @@ spdk_reduce_vol_load(struct spdk_reduce_backing_dev *backing_dev,
 	TAILQ_INIT(&vol->free_requests);
 	RB_INIT(&vol->executing_requests);
 	TAILQ_INIT(&vol->queued_requests);
+	TAILQ_INIT(&vol->persist_requests);
 	queue_init(&vol->free_chunks_queue);
 	queue_init(&vol->free_backing_blocks_queue);
 
@@ -1131,6 +1335,49 @@ _request_spans_chunk_boundary(struct spdk_reduce_vol *vol, uint64_t offset, uint
 typedef void (*reduce_request_fn)(void *_req, int reduce_errno);
 static void _start_unmap_request_full_chunk(void *ctx);
 
+static void
+_insert_executing_request(struct spdk_reduce_vol_request *req)
+{
+	req->overlap_seq = ++req->vol->overlap_seq;
+	RB_INSERT(executing_req_tree, &req->vol->executing_requests, req);
+}
+
+/*
+ * Return true if a request of the given type must wait for the requests executing on the
+ *  chunk.  Reads only conflict with writes and unmaps, so reads of a chunk execute together.
+ */
+static bool
+_check_executing_overlap(struct spdk_reduce_vol *vol, uint64_t logical_map_index, int type)
+{
+	struct spdk_reduce_vol_request key, *req;
+
+	key.logical_map_index = logical_map_index;
+	key.overlap_seq = 0;
+	req = RB_NFIND(executing_req_tree, &vol->executing_requests, &key);
+	for (; req != NULL && req->logical_map_index == logical_map_index;
+	     req = RB_NEXT(executing_req_tree, &vol->executing_requests, req)) {
+		if (type != REDUCE_IO_READV || req->type != REDUCE_IO_READV) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static struct spdk_reduce_vol_request *
+_get_queued_request(struct spdk_reduce_vol *vol, uint64_t logical_map_index)
+{
+	struct spdk_reduce_vol_request *req;
+
+	TAILQ_FOREACH(req, &vol->queued_requests, tailq) {
+		if (req->logical_map_index == logical_map_index) {
+			return req;
+		}
+	}
+
+	return NULL;
+}
+
 static void
 _reduce_vol_complete_req(struct spdk_reduce_vol_request *req, int reduce_errno)
 {
@@ -1140,24 +1387,88 @@ _reduce_vol_complete_req(struct spdk_reduce_vol_request *req, int reduce_errno)
 	req->cb_fn(req->cb_arg, reduce_errno);
 	RB_REMOVE(executing_req_tree, &vol->executing_requests, req);
 
-	TAILQ_FOREACH(next_req, &vol->queued_requests, tailq) {
-		if (next_req->logical_map_index == req->logical_map_index) {
-			TAILQ_REMOVE(&vol->queued_requests, next_req, tailq);
-			if (next_req->type == REDUCE_IO_READV) {
-				_start_readv_request(next_req);
-			} else if (next_req->type == REDUCE_IO_WRITEV) {
-				_start_writev_request(next_req);
-			} else {
-				assert(next_req->type == REDUCE_IO_UNMAP);
-				_start_unmap_request_full_chunk(next_req);
-			}
-			break;
+	/* Start the queued requests of the chunk, in order, as long as they do not conflict. */
+	while ((next_req = _get_queued_request(vol, req->logical_map_index)) != NULL &&
+	       !_check_executing_overlap(vol, req->logical_map_index, next_req->type)) {
+		TAILQ_REMOVE(&vol->queued_requests, next_req, tailq);
+		if (next_req->type == REDUCE_IO_READV) {
+			_start_readv_request(next_req);
+		} else if (next_req->type == REDUCE_IO_WRITEV) {
+			_start_writev_request(next_req);
+		} else {
+			assert(next_req->type == REDUCE_IO_UNMAP);
+			_start_unmap_request_full_chunk(next_req);
 		}
 	}
 
 	TAILQ_INSERT_HEAD(&vol->free_requests, req, tailq);
 }
 
+/* Number of backing device blocks holding the data of a chunk past its last full io unit. */
+static uint32_t
+_reduce_vol_get_tail_blocks(struct spdk_reduce_vol *vol, uint32_t compressed_size)
+{
+	return spdk_divide_round_up(compressed_size % vol->params.backing_io_unit_size,
+				    vol->backing_dev->blocklen);
+}
+
+static uint64_t
+_reduce_vol_alloc_io_unit(struct spdk_reduce_vol *vol)
+{
+	uint64_t index;
+	bool success;
+
+	success = queue_dequeue(&vol->free_backing_blocks_queue, &index);
+	if (!success) {
+		index = spdk_bit_array_find_first_clear(vol->allocated_backing_io_units,
+							vol->find_block_offset);
+		vol->find_block_offset = index + 1;
+	}
+	/* TODO: fail if no backing block found - but really this should also not
+	 * happen (see comment in _reduce_vol_write_chunk()).
+	 */
+	assert(index != REDUCE_EMPTY_MAP_ENTRY);
+	spdk_bit_array_set(vol->allocated_backing_io_units, index);
+	vol->info.allocated_io_units++;
+
+	return index;
+}
+
+static void
+_reduce_vol_free_io_unit(struct spdk_reduce_vol *vol, uint64_t index)
+{
+	bool success;
+
+	assert(spdk_bit_array_get(vol->allocated_backing_io_units, index) == true);
+	spdk_bit_array_clear(vol->allocated_backing_io_units, index);
+	vol->info.allocated_io_units--;
+	success = queue_enqueue(&vol->free_backing_blocks_queue, index);
+	if (!success && index < vol->find_block_offset) {
+		vol->find_block_offset = index;
+	}
+}
+
+/* Allocate num_blocks backing blocks for a chunk tail, in the io unit tails are packed in. */
+static uint64_t
+_reduce_vol_pack_tail(struct spdk_reduce_vol *vol, uint32_t num_blocks, uint32_t *block_offset)
+{
+	if (vol->pack_io_unit == REDUCE_EMPTY_MAP_ENTRY ||
+	    vol->pack_next_block + num_blocks > vol->backing_lba_per_io_unit) {
+		if (vol->pack_io_unit != REDUCE_EMPTY_MAP_ENTRY &&
+		    vol->io_unit_tails[vol->pack_io_unit] == 0) {
+			_reduce_vol_free_io_unit(vol, vol->pack_io_unit);
+		}
+		vol->pack_io_unit = _reduce_vol_alloc_io_unit(vol);
+		vol->pack_next_block = 0;
+	}
+
+	*block_offset = vol->pack_next_block;
+	vol->pack_next_block += num_blocks;
+	vol->io_unit_tails[vol->pack_io_unit]++;
+
+	return vol->pack_io_unit;
+}
+
 static void
 _reduce_vol_reset_chunk(struct spdk_reduce_vol *vol, uint64_t chunk_map_index)
 {
@@ -1172,16 +1483,20 @@ _reduce_vol_reset_chunk(struct spdk_reduce_vol *vol, uint64_t chunk_map_index)
 		if (index == REDUCE_EMPTY_MAP_ENTRY) {
 			break;
 		}
-		assert(spdk_bit_array_get(vol->allocated_backing_io_units,
-					  index) == true);
-		spdk_bit_array_clear(vol->allocated_backing_io_units, index);
-		vol->info.allocated_io_units--;
-		success = queue_enqueue(&vol->free_backing_blocks_queue, index);
-		if (!success && index < vol->find_block_offset) {
-			vol->find_block_offset = index;
+		if (_reduce_vol_chunk_tail_packed(vol, chunk, i)) {
+			/* Free a shared io unit once the last tail in it is gone, unless tails are
+			 *  still being packed in it.
+			 */
+			assert(vol->io_unit_tails[index] > 0);
+			if (--vol->io_unit_tails[index] == 0 && index != vol->pack_io_unit) {
+				_reduce_vol_free_io_unit(vol, index);
+			}
+		} else {
+			_reduce_vol_free_io_unit(vol, index);
 		}
 		chunk->io_unit_index[i] = REDUCE_EMPTY_MAP_ENTRY;
 	}
+	chunk->tail = 0;
 	success = queue_enqueue(&vol->free_chunks_queue, chunk_map_index);
 	if (!success && chunk_map_index < vol->find_chunk_offset) {
 		vol->find_chunk_offset = chunk_map_index;
@@ -1189,6 +1504,45 @@ _reduce_vol_reset_chunk(struct spdk_reduce_vol *vol, uint64_t chunk_map_index)
 	spdk_bit_array_clear(vol->allocated_chunk_maps, chunk_map_index);
 }
 
+static void
+_reduce_vol_persist_writes(void *ctx)
+{
+	struct spdk_reduce_vol *vol = ctx;
+	struct spdk_reduce_vol_request *req, *tmp;
+	TAILQ_HEAD(, spdk_reduce_vol_request) requests = TAILQ_HEAD_INITIALIZER(requests);
+
+	vol->persist_scheduled = false;
+	TAILQ_SWAP(&requests, &vol->persist_requests, spdk_reduce_vol_request, tailq);
+
+	/* Persist all the new chunk maps before any of the logical map entries pointing to them. */
+	TAILQ_FOREACH(req, &requests, tailq) {
+		_reduce_persist(vol, req->chunk,
+				_reduce_vol_get_chunk_struct_size(vol->backing_io_units_per_chunk));
+	}
+
+	/*
+	 * Overlapping requests are serialized, so each logical map entry is updated by at most
+	 *  one request of the batch.
+	 */
+	TAILQ_FOREACH(req, &requests, tailq) {
+		req->old_chunk_map_index = vol->pm_logical_map[req->logical_map_index];
+		vol->pm_logical_map[req->logical_map_index] = req->chunk_map_index;
+		_reduce_persist(vol, &vol->pm_logical_map[req->logical_map_index], sizeof(uint64_t));
+	}
+
+	/*
+	 * The old chunk maps are only released now, so that their backing io units cannot be
+	 *  reused while a persisted logical map entry may still point to them.
+	 */
+	TAILQ_FOREACH_SAFE(req, &requests, tailq, tmp) {
+		TAILQ_REMOVE(&requests, req, tailq);
+		if (req->old_chunk_map_index != REDUCE_EMPTY_MAP_ENTRY) {
+			_reduce_vol_reset_chunk(vol, req->old_chunk_map_index);
+		}
+		_reduce_vol_complete_req(req, 0);
+	}
+}
+
 static void
 _write_write_done(void *_req, int reduce_errno)
 {
@@ -1211,6 +1565,15 @@ _write_write_done(void *_req, int reduce_errno)
 		return;
 	}
 
+	if (!vol->pm_file.pm_is_pmem) {
+		TAILQ_INSERT_TAIL(&vol->persist_requests, req, tailq);
+		if (!vol->persist_scheduled) {
+			vol->persist_scheduled = true;
+			spdk_thread_send_msg(spdk_get_thread(), _reduce_vol_persist_writes, vol);
+		}
+		return;
+	}
+
 	old_chunk_map_index = vol->pm_logical_map[req->logical_map_index];
 	if (old_chunk_map_index != REDUCE_EMPTY_MAP_ENTRY) {
 		_reduce_vol_reset_chunk(vol, old_chunk_map_index);
@@ -1280,6 +1643,12 @@ _issue_backing_ops_without_merge(struct spdk_reduce_vol_request *req, struct spd
 		backing_io->iovcnt = 1;
 		backing_io->lba = req->chunk->io_unit_index[i] * vol->backing_lba_per_io_unit;
 		backing_io->lba_count = vol->backing_lba_per_io_unit;
+		if (_reduce_vol_chunk_tail_packed(vol, req->chunk, i)) {
+			/* Only the blocks holding the tail of this chunk are read or written. */
+			backing_io->lba += req->chunk->tail & ~REDUCE_CHUNK_TAIL_PACKED;
+			backing_io->lba_count = _reduce_vol_get_tail_blocks(vol, req->chunk->compressed_size);
+			iov[i].iov_len = (size_t)backing_io->lba_count * vol->backing_dev->blocklen;
+		}
 		backing_io->backing_cb_args = &req->backing_cb_args;
 		if (is_write) {
 			backing_io->backing_io_type = SPDK_REDUCE_BACKING_IO_WRITE;
@@ -1308,7 +1677,8 @@ _issue_backing_ops(struct spdk_reduce_vol_request *req, struct spdk_reduce_vol *
 	 * and the chunk size must be four times the maximum of the io unit.
 	 * if chunk size is too big, don't merge IO.
 	 */
-	if (vol->backing_io_units_per_chunk > 4) {
+	if (vol->backing_io_units_per_chunk > 4 ||
+	    _reduce_vol_chunk_tail_packed(vol, req->chunk, req->num_io_units - 1)) {
 		_issue_backing_ops_without_merge(req, vol, next_fn, is_write);
 		return;
 	}
@@ -1371,7 +1741,7 @@ _reduce_vol_write_chunk(struct spdk_reduce_vol_request *req, reduce_request_fn n
 			uint32_t compressed_size)
 {
 	struct spdk_reduce_vol *vol = req->vol;
-	uint32_t i;
+	uint32_t i, num_io_units, tail_blocks, tail_offset;
 	uint64_t chunk_offset, remainder, free_index, total_len = 0;
 	uint8_t *buf;
 	bool success;
@@ -1427,21 +1797,21 @@ _reduce_vol_write_chunk(struct spdk_reduce_vol_request *req, reduce_request_fn n
 		assert(total_len == vol->params.chunk_size);
 	}
 
-	for (i = 0; i < req->num_io_units; i++) {
-		success = queue_dequeue(&vol->free_backing_blocks_queue, &free_index);
-		if (success) {
-			req->chunk->io_unit_index[i] = free_index;
-		} else {
-			req->chunk->io_unit_index[i] = spdk_bit_array_find_first_clear(vol->allocated_backing_io_units,
-						       vol->find_block_offset);
-			vol->find_block_offset = req->chunk->io_unit_index[i] + 1;
+	num_io_units = req->num_io_units;
+	req->chunk->tail = 0;
+	if (vol->params.pack_chunks && req->chunk_is_compressed &&
+	    (compressed_size % vol->params.backing_io_unit_size) != 0) {
+		tail_blocks = _reduce_vol_get_tail_blocks(vol, compressed_size);
+		if (tail_blocks < vol->backing_lba_per_io_unit) {
+			num_io_units--;
+			req->chunk->io_unit_index[num_io_units] = _reduce_vol_pack_tail(vol, tail_blocks,
+					&tail_offset);
+			req->chunk->tail = REDUCE_CHUNK_TAIL_PACKED | tail_offset;
 		}
-		/* TODO: fail if no backing block found - but really this should also not
-		 * happen (see comment above).
-		 */
-		assert(req->chunk->io_unit_index[i] != REDUCE_EMPTY_MAP_ENTRY);
-		spdk_bit_array_set(vol->allocated_backing_io_units, req->chunk->io_unit_index[i]);
-		vol->info.allocated_io_units++;
+	}
+
+	for (i = 0; i < num_io_units; i++) {
+		req->chunk->io_unit_index[i] = _reduce_vol_alloc_io_unit(vol);
 	}
 
 	_issue_backing_ops(req, vol, next_fn, true /* write */);
@@ -1516,6 +1886,8 @@ _reduce_vol_decompress_chunk(struct spdk_reduce_vol_request *req, reduce_request
 	req->copy_after_decompress = !vol->backing_dev->sgl_out && (req->iovcnt > 1 ||
 				     req->iov[0].iov_len < vol->params.chunk_size ||
 				     _addr_crosses_huge_page(req->iov[0].iov_base, &iov_len));
+	/* The whole chunk is needed in the scratch buffer to be cached */
+	req->copy_after_decompress |= vol->cache.num_entries != 0;
 	if (req->copy_after_decompress) {
 		req->decomp_iov[0].iov_base = req->decomp_buf;
 		req->decomp_iov[0].iov_len = vol->params.chunk_size;
@@ -1735,6 +2107,8 @@ _read_decompress_done(void *_req, int reduce_errno)
 		char *decomp_buffer = (char *)req->decomp_buf + chunk_offset * vol->params.logical_block_size;
 		int i;
 
+		_reduce_cache_insert(vol, req->logical_map_index, req->decomp_buf);
+
 		for (i = 0; i < req->iovcnt; i++) {
 			memcpy(req->iov[i].iov_base, decomp_buffer, req->iov[i].iov_len);
 			decomp_buffer += req->iov[i].iov_len;
@@ -1814,19 +2188,22 @@ _iov_array_is_valid(struct spdk_reduce_vol *vol, struct iovec *iov, int iovcnt,
 }
 
 static bool
-_check_overlap(struct spdk_reduce_vol *vol, uint64_t logical_map_index)
+_check_overlap(struct spdk_reduce_vol *vol, uint64_t logical_map_index, int type)
 {
-	struct spdk_reduce_vol_request req;
-
-	req.logical_map_index = logical_map_index;
-
-	return (NULL != RB_FIND(executing_req_tree, &vol->executing_requests, &req));
+	/* Requests queued on the chunk keep their order, even reads behind a queued write. */
+	return _check_executing_overlap(vol, logical_map_index, type) ||
+	       _get_queued_request(vol, logical_map_index) != NULL;
 }
 
 static void
 _start_readv_request(struct spdk_reduce_vol_request *req)
 {
-	RB_INSERT(executing_req_tree, &req->vol->executing_requests, req);
+	_insert_executing_request(req);
+	if (_reduce_cache_read(req->vol, req->iov, req->iovcnt, req->offset)) {
+		_reduce_vol_complete_req(req, 0);
+		return;
+	}
+
 	_reduce_vol_read_chunk(req, _read_read_done);
 }
 
@@ -1856,7 +2233,7 @@ spdk_reduce_vol_readv(struct spdk_reduce_vol *vol,
 	}
 
 	logical_map_index = offset / vol->logical_blocks_per_chunk;
-	overlapped = _check_overlap(vol, logical_map_index);
+	overlapped = _check_overlap(vol, logical_map_index, REDUCE_IO_READV);
 
 	if (!overlapped && vol->pm_logical_map[logical_map_index] == REDUCE_EMPTY_MAP_ENTRY) {
 		/*
@@ -1871,6 +2248,11 @@ spdk_reduce_vol_readv(struct spdk_reduce_vol *vol,
 		return;
 	}
 
+	if (!overlapped && _reduce_cache_read(vol, iov, iovcnt, offset)) {
+		cb_fn(cb_arg, 0);
+		return;
+	}
+
 	req = TAILQ_FIRST(&vol->free_requests);
 	if (req == NULL) {
 		cb_fn(cb_arg, -ENOMEM);
@@ -1902,7 +2284,8 @@ _start_writev_request(struct spdk_reduce_vol_request *req)
 {
 	struct spdk_reduce_vol *vol = req->vol;
 
-	RB_INSERT(executing_req_tree, &req->vol->executing_requests, req);
+	_insert_executing_request(req);
+	_reduce_cache_invalidate(vol, req->logical_map_index);
 	if (vol->pm_logical_map[req->logical_map_index] != REDUCE_EMPTY_MAP_ENTRY) {
 		if ((req->length * vol->params.logical_block_size) < vol->params.chunk_size) {
 			/* Read old chunk, then overwrite with data from this write
@@ -1945,7 +2328,7 @@ spdk_reduce_vol_writev(struct spdk_reduce_vol *vol,
 	}
 
 	logical_map_index = offset / vol->logical_blocks_per_chunk;
-	overlapped = _check_overlap(vol, logical_map_index);
+	overlapped = _check_overlap(vol, logical_map_index, REDUCE_IO_WRITEV);
 
 	req = TAILQ_FIRST(&vol->free_requests);
 	if (req == NULL) {
@@ -1980,7 +2363,8 @@ _start_unmap_request_full_chunk(void *ctx)
 	struct spdk_reduce_vol *vol = req->vol;
 	uint64_t chunk_map_index;
 
-	RB_INSERT(executing_req_tree, &req->vol->executing_requests, req);
+	_insert_executing_request(req);
+	_reduce_cache_invalidate(vol, req->logical_map_index);
 
 	chunk_map_index = vol->pm_logical_map[req->logical_map_index];
 	if (chunk_map_index != REDUCE_EMPTY_MAP_ENTRY) {
@@ -2006,7 +2390,7 @@ _reduce_vol_unmap_full_chunk(struct spdk_reduce_vol *vol,
 	}
 
 	logical_map_index = offset / vol->logical_blocks_per_chunk;
-	overlapped = _check_overlap(vol, logical_map_index);
+	overlapped = _check_overlap(vol, logical_map_index, REDUCE_IO_UNMAP);
 
 	if (!overlapped && vol->pm_logical_map[logical_map_index] == REDUCE_EMPTY_MAP_ENTRY) {
 		/*
@@ -1348,10 +1348,16 @@ check_condition:
 	return SPDK_SCSI_TASK_COMPLETE;
 }
 
+/* Range to unmap, built from one or more overlapping or adjacent UNMAP block descriptors */
+struct spdk_bdev_scsi_unmap_range {
+	uint64_t	offset_blocks;
+	uint64_t	num_blocks;
+};
+
 struct spdk_bdev_scsi_split_ctx {
 	struct spdk_scsi_task		*task;
 	union {
-		struct spdk_scsi_unmap_bdesc	desc[DEFAULT_MAX_UNMAP_BLOCK_DESCRIPTOR_COUNT];
+		struct spdk_bdev_scsi_unmap_range	*ranges;	/* used by unmap */
 		uint64_t			start_offset_blocks;	/* used by writesame */
 	};
 	uint16_t			remaining_count;
@@ -1453,24 +1459,74 @@ bdev_scsi_task_complete_split_cmd(struct spdk_bdev_io *bdev_io, bool success,
 }
 
 static int
-__copy_desc(struct spdk_bdev_scsi_split_ctx *ctx, uint8_t *data, size_t data_len)
+bdev_scsi_unmap_range_cmp(const void *_a, const void *_b)
 {
-	uint16_t	desc_data_len;
-	uint16_t	desc_count;
+	const struct spdk_bdev_scsi_unmap_range *a = _a, *b = _b;
 
-	if (!data) {
-		return -EINVAL;
+	if (a->offset_blocks != b->offset_blocks) {
+		return a->offset_blocks < b->offset_blocks ? -1 : 1;
+	}
+
+	return 0;
+}
+
+/* Add a range to the end of the list, merging it into the last one if they touch */
+static int
+bdev_scsi_unmap_range_append(struct spdk_bdev_scsi_unmap_range *ranges, int count,
+			     uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct spdk_bdev_scsi_unmap_range *last;
+
+	if (count > 0) {
+		last = &ranges[count - 1];
+		if (offset_blocks >= last->offset_blocks &&
+		    offset_blocks <= last->offset_blocks + last->num_blocks) {
+			last->num_blocks = spdk_max(last->num_blocks,
+						    offset_blocks + num_blocks - last->offset_blocks);
+			return count;
+		}
+	}
+
+	ranges[count].offset_blocks = offset_blocks;
+	ranges[count].num_blocks = num_blocks;
+
+	return count + 1;
+}
+
+/*
+ * Decode the UNMAP parameter list straight from the task's iovecs into ranges sorted by LBA,
+ * with overlapping and adjacent descriptors merged and empty ones dropped, so that a discard
+ * storm of neighbouring descriptors turns into as few bdev I/Os as possible.
+ * Returns the number of ranges or -EINVAL if the parameter list is invalid.
+ */
+static int
+bdev_scsi_unmap_parse(struct spdk_scsi_task *task, struct spdk_bdev_scsi_unmap_range *ranges)
+{
+	struct spdk_scsi_unmap_bdesc desc;
+	struct spdk_iov_xfer ix;
+	uint8_t header[8];
+	size_t data_len = 0;
+	uint64_t offset_blocks, num_blocks;
+	uint16_t desc_data_len, desc_count, i;
+	bool sorted = true;
+	int count = 0, j;
+
+	for (j = 0; j < task->iovcnt; j++) {
+		data_len += task->iovs[j].iov_len;
 	}
 
-	if (data_len < 8) {
+	if (data_len < sizeof(header)) {
 		/* We can't even get the reported length, so fail. */
 		return -EINVAL;
 	}
 
-	desc_data_len = from_be16(&data[2]);
-	desc_count = desc_data_len / 16;
+	spdk_iov_xfer_init(&ix, task->iovs, task->iovcnt);
+	spdk_iov_xfer_to_buf(&ix, header, sizeof(header));
+
+	desc_data_len = from_be16(&header[2]);
+	desc_count = desc_data_len / sizeof(desc);
 
-	if (desc_data_len > (data_len - 8)) {
+	if (desc_data_len > (data_len - sizeof(header))) {
 		SPDK_ERRLOG("Error - desc_data_len (%u) > data_len (%zu) - 8\n",
 			    desc_data_len, data_len);
 		return -EINVAL;
@@ -1482,8 +1538,41 @@ __copy_desc(struct spdk_bdev_scsi_split_ctx *ctx, uint8_t *data, size_t data_len
 		return -EINVAL;
 	}
 
-	memcpy(ctx->desc, &data[8], desc_data_len);
-	return desc_count;
+	for (i = 0; i < desc_count; i++) {
+		spdk_iov_xfer_to_buf(&ix, &desc, sizeof(desc));
+
+		offset_blocks = from_be64(&desc.lba);
+		num_blocks = from_be32(&desc.block_count);
+		if (num_blocks == 0) {
+			continue;
+		}
+
+		if (spdk_unlikely(offset_blocks + num_blocks < offset_blocks)) {
+			SPDK_ERRLOG("Unmap descriptor lba %"PRIu64" count %"PRIu64" overflows\n",
+				    offset_blocks, num_blocks);
+			return -EINVAL;
+		}
+
+		if (count > 0 && offset_blocks < ranges[count - 1].offset_blocks) {
+			sorted = false;
+		}
+
+		count = bdev_scsi_unmap_range_append(ranges, count, offset_blocks, num_blocks);
+	}
+
+	if (sorted || count < 2) {
+		return count;
+	}
+
+	qsort(ranges, count, sizeof(*ranges), bdev_scsi_unmap_range_cmp);
+
+	j = 1;
+	for (i = 1; i < count; i++) {
+		j = bdev_scsi_unmap_range_append(ranges, j, ranges[i].offset_blocks,
+						 ranges[i].num_blocks);
+	}
+
+	return j;
 }
 
 static int
@@ -1491,72 +1580,91 @@ _bdev_scsi_unmap(struct spdk_bdev_scsi_split_ctx *ctx)
 {
 	struct spdk_scsi_task *task = ctx->task;
 	struct spdk_scsi_lun *lun = task->lun;
-	struct spdk_scsi_unmap_bdesc	*desc;
-	uint64_t offset_blocks;
-	uint64_t num_blocks;
+	struct spdk_bdev_scsi_unmap_range *range;
 
-	desc = &ctx->desc[ctx->current_count];
-
-	offset_blocks = from_be64(&desc->lba);
-	num_blocks = from_be32(&desc->block_count);
+	range = &ctx->ranges[ctx->current_count];
 
 	return spdk_bdev_unmap_blocks(lun->bdev_desc,
 				      lun->io_channel,
-				      offset_blocks,
-				      num_blocks,
+				      range->offset_blocks,
+				      range->num_blocks,
 				      bdev_scsi_task_complete_split_cmd,
 				      ctx);
 }
 
+static int bdev_scsi_unmap(struct spdk_bdev *bdev, struct spdk_scsi_task *task);
+
+static void
+bdev_scsi_unmap_resubmit(void *arg)
+{
+	struct spdk_scsi_task *task = arg;
+
+	if (bdev_scsi_unmap(task->lun->bdev, task) == SPDK_SCSI_TASK_COMPLETE) {
+		scsi_lun_complete_task(task->lun, task);
+	}
+}
+
 static int
 bdev_scsi_unmap(struct spdk_bdev *bdev, struct spdk_scsi_task *task)
 {
-	struct spdk_bdev_scsi_split_ctx	*ctx;
-	uint8_t				*data;
-	int				desc_count = -1;
-	int				data_len;
+	struct spdk_bdev_scsi_unmap_range	ranges[DEFAULT_MAX_UNMAP_BLOCK_DESCRIPTOR_COUNT];
+	struct spdk_scsi_lun			*lun = task->lun;
+	struct spdk_bdev_scsi_split_ctx		*ctx;
+	int					count, rc;
 
 	assert(task->status == SPDK_SCSI_STATUS_GOOD);
 
-	ctx = calloc(1, sizeof(*ctx));
-	if (!ctx) {
+	count = bdev_scsi_unmap_parse(task, ranges);
+	if (count < 0) {
 		spdk_scsi_task_set_status(task, SPDK_SCSI_STATUS_CHECK_CONDITION,
-					  SPDK_SCSI_SENSE_NO_SENSE,
-					  SPDK_SCSI_ASC_NO_ADDITIONAL_SENSE,
+					  SPDK_SCSI_SENSE_ILLEGAL_REQUEST,
+					  SPDK_SCSI_ASC_INVALID_FIELD_IN_CDB,
 					  SPDK_SCSI_ASCQ_CAUSE_NOT_REPORTABLE);
 		return SPDK_SCSI_TASK_COMPLETE;
 	}
 
-	ctx->task = task;
-	ctx->current_count = 0;
-	ctx->outstanding_count = 0;
-	ctx->fn = _bdev_scsi_unmap;
+	if (count == 0) {
+		return SPDK_SCSI_TASK_COMPLETE;
+	}
 
-	if (task->iovcnt == 1) {
-		data = (uint8_t *)task->iovs[0].iov_base;
-		data_len = task->iovs[0].iov_len;
-		desc_count = __copy_desc(ctx, data, data_len);
-	} else {
-		data = spdk_scsi_task_gather_data(task, &data_len);
-		if (data) {
-			desc_count = __copy_desc(ctx, data, data_len);
-			free(data);
+	/* A single range needs no splitting context */
+	if (count == 1) {
+		rc = spdk_bdev_unmap_blocks(lun->bdev_desc, lun->io_channel,
+					    ranges[0].offset_blocks, ranges[0].num_blocks,
+					    bdev_scsi_task_complete_cmd, task);
+		if (rc == 0) {
+			return SPDK_SCSI_TASK_PENDING;
 		}
-	}
 
-	if (desc_count > 0) {
-		ctx->remaining_count = desc_count;
-		return bdev_scsi_split(ctx);
+		if (rc == -ENOMEM) {
+			bdev_scsi_queue_io(task, bdev_scsi_unmap_resubmit, task);
+			return SPDK_SCSI_TASK_PENDING;
+		}
+
+		SPDK_ERRLOG("SCSI %s failed\n", spdk_scsi_sbc_opcode_string(task->cdb[0], 0));
+		goto check_condition;
 	}
 
-	if (desc_count < 0) {
-		spdk_scsi_task_set_status(task, SPDK_SCSI_STATUS_CHECK_CONDITION,
-					  SPDK_SCSI_SENSE_ILLEGAL_REQUEST,
-					  SPDK_SCSI_ASC_INVALID_FIELD_IN_CDB,
-					  SPDK_SCSI_ASCQ_CAUSE_NOT_REPORTABLE);
+	ctx = calloc(1, sizeof(*ctx) + count * sizeof(*ranges));
+	if (!ctx) {
+		goto check_condition;
 	}
 
-	free(ctx);
+	ctx->task = task;
+	ctx->ranges = (struct spdk_bdev_scsi_unmap_range *)(ctx + 1);
+	memcpy(ctx->ranges, ranges, count * sizeof(*ranges));
+	ctx->current_count = 0;
+	ctx->outstanding_count = 0;
+	ctx->remaining_count = count;
+	ctx->fn = _bdev_scsi_unmap;
+
+	return bdev_scsi_split(ctx);
+
+check_condition:
+	spdk_scsi_task_set_status(task, SPDK_SCSI_STATUS_CHECK_CONDITION,
+				  SPDK_SCSI_SENSE_NO_SENSE,
+				  SPDK_SCSI_ASC_NO_ADDITIONAL_SENSE,
+				  SPDK_SCSI_ASCQ_CAUSE_NOT_REPORTABLE);
 	return SPDK_SCSI_TASK_COMPLETE;
 }
 
@@ -1572,6 +1680,20 @@ _bdev_scsi_write_same(struct spdk_bdev_scsi_split_ctx *ctx)
 				       offset_blocks, 1, bdev_scsi_task_complete_split_cmd, ctx);
 }
 
+static bool
+bdev_scsi_task_data_is_zero(struct spdk_scsi_task *task)
+{
+	int i;
+
+	for (i = 0; i < task->iovcnt; i++) {
+		if (!spdk_mem_all_zero(task->iovs[i].iov_base, task->iovs[i].iov_len)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 static int
 bdev_scsi_write_same(struct spdk_bdev *bdev, struct spdk_bdev_desc *bdev_desc,
 		     struct spdk_io_channel *bdev_ch, struct spdk_scsi_task *task,
@@ -1581,6 +1703,7 @@ bdev_scsi_write_same(struct spdk_bdev *bdev, struct spdk_bdev_desc *bdev_desc,
 	uint64_t bdev_num_blocks, offset_blocks, num_blocks;
 	uint32_t max_xfer_len, block_size;
 	int sk = SPDK_SCSI_SENSE_NO_SENSE, asc = SPDK_SCSI_ASC_NO_ADDITIONAL_SENSE;
+	int rc;
 
 	task->data_transferred = 0;
 
@@ -1631,6 +1754,30 @@ bdev_scsi_write_same(struct spdk_bdev *bdev, struct spdk_bdev_desc *bdev_desc,
 	SPDK_DEBUGLOG(scsi, "Writesame: lba=%"PRIu64", len=%"PRIu64"\n",
 		      offset_blocks, num_blocks);
 
+	/*
+	 * Writing the same zeroed block over a range is what the guest uses to zero or discard
+	 * it, so issue a single WRITE ZEROES instead of one write per block.  The bdev layer
+	 * emulates it with writes if the bdev has no native support.
+	 */
+	if (bdev_scsi_task_data_is_zero(task)) {
+		rc = spdk_bdev_write_zeroes_blocks(bdev_desc, bdev_ch, offset_blocks, xfer_len,
+						   bdev_scsi_task_complete_cmd, task);
+		if (rc == 0) {
+			task->data_transferred = task->length;
+			return SPDK_SCSI_TASK_PENDING;
+		}
+
+		if (rc == -ENOMEM) {
+			bdev_scsi_queue_io(task, bdev_scsi_process_block_resubmit, task);
+			return SPDK_SCSI_TASK_PENDING;
+		}
+
+		if (rc != -ENOTSUP) {
+			SPDK_ERRLOG("SCSI WRITE SAME failed to write zeroes: %d\n", rc);
+			goto check_condition;
+		}
+	}
+
 	ctx = calloc(1, sizeof(*ctx));
 	if (!ctx) {
 		SPDK_ERRLOG("No enough memory on SCSI WRITE SAME\n");
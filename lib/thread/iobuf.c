@@ -11,6 +11,7 @@
 
 #define IOBUF_MIN_SMALL_POOL_SIZE	64
 #define IOBUF_MIN_LARGE_POOL_SIZE	8
+#define IOBUF_MIN_CLASS_POOL_SIZE	8
 #define IOBUF_DEFAULT_SMALL_POOL_SIZE	8192
 #define IOBUF_DEFAULT_LARGE_POOL_SIZE	1024
 #define IOBUF_ALIGNMENT			4096
@@ -23,6 +24,12 @@
  * for the default. */
 #define IOBUF_DEFAULT_LARGE_BUFSIZE	(132 * 1024)
 #define IOBUF_MAX_CHANNELS		64
+/* Pools of a node: small, large and the additional size classes */
+#define IOBUF_POOL_SMALL		0
+#define IOBUF_POOL_LARGE		1
+#define IOBUF_NUM_POOLS			(2 + SPDK_IOBUF_MAX_CLASSES)
+/* Minimum interval between two reclaims of the cached buffers of a pool */
+#define IOBUF_RECLAIM_INTERVAL_US	1000
 
 SPDK_STATIC_ASSERT(sizeof(struct spdk_iobuf_buffer) <= IOBUF_MIN_SMALL_BUFSIZE,
 		   "Invalid data offset");
@@ -32,6 +39,7 @@ static bool g_iobuf_is_initialized = false;
 struct iobuf_channel_node {
 	spdk_iobuf_entry_stailq_t	small_queue;
 	spdk_iobuf_entry_stailq_t	large_queue;
+	spdk_iobuf_entry_stailq_t	class_queue[SPDK_IOBUF_MAX_CLASSES];
 };
 
 struct iobuf_channel {
@@ -49,6 +57,11 @@ struct iobuf_node {
 	struct spdk_ring		*large_pool;
 	void				*small_pool_base;
 	void				*large_pool_base;
+	struct spdk_ring		*class_pool[SPDK_IOBUF_MAX_CLASSES];
+	void				*class_pool_base[SPDK_IOBUF_MAX_CLASSES];
+	/* Cached buffers of the whole node are being reclaimed for a starving channel */
+	bool				reclaim_in_progress[IOBUF_NUM_POOLS];
+	uint64_t			last_reclaim_tsc[IOBUF_NUM_POOLS];
 };
 
 struct iobuf {
@@ -75,6 +88,13 @@ static struct iobuf g_iobuf = {
 	},
 };
 
+struct iobuf_reclaim_ctx {
+	/* iobuf channel of the thread waiting for the buffers */
+	struct spdk_io_channel		*ioch;
+	int32_t				numa_id;
+	uint32_t			pool_idx;
+};
+
 struct iobuf_get_stats_ctx {
 	struct spdk_iobuf_module_stats	*modules;
 	uint32_t			num_modules;
@@ -89,10 +109,15 @@ iobuf_channel_create_cb(void *io_device, void *ctx)
 	struct iobuf_channel_node *node;
 	int32_t i;
 
+	uint8_t c;
+
 	IOBUF_FOREACH_NUMA_ID(i) {
 		node = &ch->node[i];
 		STAILQ_INIT(&node->small_queue);
 		STAILQ_INIT(&node->large_queue);
+		for (c = 0; c < SPDK_IOBUF_MAX_CLASSES; c++) {
+			STAILQ_INIT(&node->class_queue[c]);
+		}
 	}
 
 	return 0;
@@ -105,106 +130,123 @@ iobuf_channel_destroy_cb(void *io_device, void *ctx)
 	struct iobuf_channel_node *node __attribute__((unused));
 	int32_t i;
 
+	uint8_t c __attribute__((unused));
+
 	IOBUF_FOREACH_NUMA_ID(i) {
 		node = &ch->node[i];
 		assert(STAILQ_EMPTY(&node->small_queue));
 		assert(STAILQ_EMPTY(&node->large_queue));
+		for (c = 0; c < SPDK_IOBUF_MAX_CLASSES; c++) {
+			assert(STAILQ_EMPTY(&node->class_queue[c]));
+		}
 	}
 }
 
 static int
-iobuf_node_initialize(struct iobuf_node *node, uint32_t numa_id)
+iobuf_pool_initialize(struct spdk_ring **pool, void **pool_base, uint64_t count, uint32_t bufsize,
+		      int32_t numa_id, const char *name)
 {
-	struct spdk_iobuf_opts *opts = &g_iobuf.opts;
 	struct spdk_iobuf_buffer *buf;
 	uint64_t i;
-	int rc;
 
-	if (!g_iobuf.opts.enable_numa) {
-		numa_id = SPDK_ENV_NUMA_ID_ANY;
-	}
-
-	node->small_pool = spdk_ring_create(SPDK_RING_TYPE_MP_MC, opts->small_pool_count,
-					    numa_id);
-	if (!node->small_pool) {
-		SPDK_ERRLOG("Failed to create small iobuf pool\n");
-		rc = -ENOMEM;
-		goto error;
-	}
-
-	node->small_pool_base = spdk_malloc(opts->small_bufsize * opts->small_pool_count, IOBUF_ALIGNMENT,
-					    NULL, numa_id, SPDK_MALLOC_DMA);
-	if (node->small_pool_base == NULL) {
-		SPDK_ERRLOG("Unable to allocate requested small iobuf pool size\n");
-		rc = -ENOMEM;
-		goto error;
-	}
-
-	node->large_pool = spdk_ring_create(SPDK_RING_TYPE_MP_MC, opts->large_pool_count,
-					    numa_id);
-	if (!node->large_pool) {
-		SPDK_ERRLOG("Failed to create large iobuf pool\n");
-		rc = -ENOMEM;
-		goto error;
-	}
-
-	node->large_pool_base = spdk_malloc(opts->large_bufsize * opts->large_pool_count, IOBUF_ALIGNMENT,
-					    NULL, numa_id, SPDK_MALLOC_DMA);
-	if (node->large_pool_base == NULL) {
-		SPDK_ERRLOG("Unable to allocate requested large iobuf pool size\n");
-		rc = -ENOMEM;
-		goto error;
+	*pool = spdk_ring_create(SPDK_RING_TYPE_MP_MC, count, numa_id);
+	if (!*pool) {
+		SPDK_ERRLOG("Failed to create %s iobuf pool\n", name);
+		return -ENOMEM;
 	}
 
-	for (i = 0; i < opts->small_pool_count; i++) {
-		buf = node->small_pool_base + i * opts->small_bufsize;
-		spdk_ring_enqueue(node->small_pool, (void **)&buf, 1, NULL);
+	*pool_base = spdk_malloc(bufsize * count, IOBUF_ALIGNMENT, NULL, numa_id, SPDK_MALLOC_DMA);
+	if (*pool_base == NULL) {
+		SPDK_ERRLOG("Unable to allocate requested %s iobuf pool size\n", name);
+		return -ENOMEM;
 	}
 
-	for (i = 0; i < opts->large_pool_count; i++) {
-		buf = node->large_pool_base + i * opts->large_bufsize;
-		spdk_ring_enqueue(node->large_pool, (void **)&buf, 1, NULL);
+	for (i = 0; i < count; i++) {
+		buf = *pool_base + i * bufsize;
+		spdk_ring_enqueue(*pool, (void **)&buf, 1, NULL);
 	}
 
 	return 0;
+}
 
-error:
-	spdk_free(node->small_pool_base);
-	spdk_ring_free(node->small_pool);
-	spdk_free(node->large_pool_base);
-	spdk_ring_free(node->large_pool);
-	memset(node, 0, sizeof(*node));
+static void
+iobuf_pool_free(struct spdk_ring **pool, void **pool_base, uint64_t count, const char *name)
+{
+	if (*pool != NULL && spdk_ring_count(*pool) != count) {
+		SPDK_ERRLOG("%s iobuf pool count is %zu, expected %"PRIu64"\n",
+			    name, spdk_ring_count(*pool), count);
+	}
 
-	return rc;
+	spdk_free(*pool_base);
+	*pool_base = NULL;
+	spdk_ring_free(*pool);
+	*pool = NULL;
 }
 
 static void
 iobuf_node_free(struct iobuf_node *node)
 {
+	struct spdk_iobuf_opts *opts = &g_iobuf.opts;
+	uint8_t c;
+
 	if (node->small_pool == NULL) {
 		/* This node didn't get allocated, so just return immediately. */
 		return;
 	}
 
-	if (spdk_ring_count(node->small_pool) != g_iobuf.opts.small_pool_count) {
-		SPDK_ERRLOG("small iobuf pool count is %zu, expected %"PRIu64"\n",
-			    spdk_ring_count(node->small_pool), g_iobuf.opts.small_pool_count);
+	iobuf_pool_free(&node->small_pool, &node->small_pool_base, opts->small_pool_count, "small");
+	iobuf_pool_free(&node->large_pool, &node->large_pool_base, opts->large_pool_count, "large");
+	for (c = 0; c < opts->num_classes; c++) {
+		iobuf_pool_free(&node->class_pool[c], &node->class_pool_base[c],
+				opts->class_pool_count[c], "class");
 	}
+}
 
-	if (spdk_ring_count(node->large_pool) != g_iobuf.opts.large_pool_count) {
-		SPDK_ERRLOG("large iobuf pool count is %zu, expected %"PRIu64"\n",
-			    spdk_ring_count(node->large_pool), g_iobuf.opts.large_pool_count);
+static int
+iobuf_node_initialize(struct iobuf_node *node, uint32_t numa_id)
+{
+	struct spdk_iobuf_opts *opts = &g_iobuf.opts;
+	uint8_t c;
+	int rc;
+
+	if (!g_iobuf.opts.enable_numa) {
+		numa_id = SPDK_ENV_NUMA_ID_ANY;
+	}
+
+	rc = iobuf_pool_initialize(&node->small_pool, &node->small_pool_base, opts->small_pool_count,
+				   opts->small_bufsize, numa_id, "small");
+	if (rc) {
+		goto error;
+	}
+
+	rc = iobuf_pool_initialize(&node->large_pool, &node->large_pool_base, opts->large_pool_count,
+				   opts->large_bufsize, numa_id, "large");
+	if (rc) {
+		goto error;
+	}
+
+	for (c = 0; c < opts->num_classes; c++) {
+		rc = iobuf_pool_initialize(&node->class_pool[c], &node->class_pool_base[c],
+					   opts->class_pool_count[c], opts->class_bufsize[c], numa_id, "class");
+		if (rc) {
+			goto error;
+		}
 	}
 
+	return 0;
+
+error:
 	spdk_free(node->small_pool_base);
-	node->small_pool_base = NULL;
 	spdk_ring_free(node->small_pool);
-	node->small_pool = NULL;
-
 	spdk_free(node->large_pool_base);
-	node->large_pool_base = NULL;
 	spdk_ring_free(node->large_pool);
-	node->large_pool = NULL;
+	for (c = 0; c < opts->num_classes; c++) {
+		spdk_free(node->class_pool_base[c]);
+		spdk_ring_free(node->class_pool[c]);
+	}
+	memset(node, 0, sizeof(*node));
+
+	return rc;
 }
 
 int
@@ -218,6 +260,9 @@ spdk_iobuf_initialize(void)
 	/* Round up to the nearest alignment so that each element remains aligned */
 	opts->small_bufsize = SPDK_ALIGN_CEIL(opts->small_bufsize, IOBUF_ALIGNMENT);
 	opts->large_bufsize = SPDK_ALIGN_CEIL(opts->large_bufsize, IOBUF_ALIGNMENT);
+	for (i = 0; i < opts->num_classes; i++) {
+		opts->class_bufsize[i] = SPDK_ALIGN_CEIL(opts->class_bufsize[i], IOBUF_ALIGNMENT);
+	}
 
 	IOBUF_FOREACH_NUMA_ID(i) {
 		node = &g_iobuf.node[i];
@@ -280,9 +325,50 @@ spdk_iobuf_finish(spdk_iobuf_finish_cb cb_fn, void *cb_arg)
 	spdk_io_device_unregister(&g_iobuf, iobuf_unregister_cb);
 }
 
+static int
+iobuf_check_classes(const struct spdk_iobuf_opts *opts)
+{
+	uint32_t bufsize, prev_bufsize;
+	uint8_t c;
+
+	if (offsetof(struct spdk_iobuf_opts, class_pool_count) + sizeof(opts->class_pool_count) >
+	    opts->opts_size) {
+		return 0;
+	}
+
+	if (opts->num_classes > SPDK_IOBUF_MAX_CLASSES) {
+		SPDK_ERRLOG("num_classes must be at most %" PRIu32 "\n", SPDK_IOBUF_MAX_CLASSES);
+		return -EINVAL;
+	}
+
+	/* Buffer sizes are rounded up to the alignment, so compare the rounded sizes */
+	prev_bufsize = SPDK_ALIGN_CEIL(opts->small_bufsize, IOBUF_ALIGNMENT);
+	for (c = 0; c < opts->num_classes; c++) {
+		bufsize = SPDK_ALIGN_CEIL(opts->class_bufsize[c], IOBUF_ALIGNMENT);
+		if (bufsize <= prev_bufsize ||
+		    bufsize >= SPDK_ALIGN_CEIL(opts->large_bufsize, IOBUF_ALIGNMENT)) {
+			SPDK_ERRLOG("class_bufsize must be ascending, between small_bufsize and "
+				    "large_bufsize once aligned to %" PRIu32 "\n", IOBUF_ALIGNMENT);
+			return -EINVAL;
+		}
+
+		if (opts->class_pool_count[c] < IOBUF_MIN_CLASS_POOL_SIZE) {
+			SPDK_ERRLOG("class_pool_count must be at least %" PRIu32 "\n",
+				    IOBUF_MIN_CLASS_POOL_SIZE);
+			return -EINVAL;
+		}
+
+		prev_bufsize = bufsize;
+	}
+
+	return 0;
+}
+
 int
 spdk_iobuf_set_opts(const struct spdk_iobuf_opts *opts)
 {
+	int rc;
+
 	if (!opts) {
 		SPDK_ERRLOG("opts cannot be NULL\n");
 		return -1;
@@ -326,6 +412,11 @@ spdk_iobuf_set_opts(const struct spdk_iobuf_opts *opts)
 		return -EINVAL;
 	}
 
+	rc = iobuf_check_classes(opts);
+	if (rc != 0) {
+		return rc;
+	}
+
 #define SET_FIELD(field) \
         if (offsetof(struct spdk_iobuf_opts, field) + sizeof(opts->field) <= opts->opts_size) { \
                 g_iobuf.opts.field = opts->field; \
@@ -337,6 +428,17 @@ spdk_iobuf_set_opts(const struct spdk_iobuf_opts *opts)
 	SET_FIELD(large_bufsize);
 	SET_FIELD(enable_numa);
 
+	/* The size classes are only valid together */
+	if (offsetof(struct spdk_iobuf_opts, class_pool_count) + sizeof(opts->class_pool_count) <=
+	    opts->opts_size) {
+		g_iobuf.opts.num_classes = opts->num_classes;
+		memcpy(g_iobuf.opts.class_bufsize, opts->class_bufsize, sizeof(opts->class_bufsize));
+		memcpy(g_iobuf.opts.class_pool_count, opts->class_pool_count,
+		       sizeof(opts->class_pool_count));
+	}
+
+	SET_FIELD(enable_steal);
+
 	g_iobuf.opts.opts_size = opts->opts_size;
 
 #undef SET_FIELD
@@ -369,12 +471,37 @@ spdk_iobuf_get_opts(struct spdk_iobuf_opts *opts, size_t opts_size)
 	SET_FIELD(small_bufsize);
 	SET_FIELD(large_bufsize);
 	SET_FIELD(enable_numa);
+	SET_FIELD(num_classes);
+	SET_FIELD(enable_steal);
 
 #undef SET_FIELD
 
+#define SET_ARRAY_FIELD(field) \
+	if (offsetof(struct spdk_iobuf_opts, field) + sizeof(opts->field) <= opts_size) { \
+		memcpy(opts->field, g_iobuf.opts.field, sizeof(opts->field)); \
+	} \
+
+	SET_ARRAY_FIELD(class_bufsize);
+	SET_ARRAY_FIELD(class_pool_count);
+
+#undef SET_ARRAY_FIELD
+
 	/* Do not remove this statement, you should always update this statement when you adding a new field,
 	 * and do not forget to add the SET_FIELD statement for your added field. */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_iobuf_opts) == 40, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_iobuf_opts) == 96, "Incorrect size");
+}
+
+static void
+iobuf_pool_cache_init(struct spdk_iobuf_pool_cache *cache, spdk_iobuf_entry_stailq_t *queue,
+		      struct spdk_ring *pool, uint32_t bufsize, uint32_t cache_size)
+{
+	cache->queue = queue;
+	cache->pool = pool;
+	cache->bufsize = bufsize;
+	cache->cache_size = cache_size;
+	cache->cache_count = 0;
+
+	STAILQ_INIT(&cache->cache);
 }
 
 static void
@@ -384,55 +511,64 @@ iobuf_channel_node_init(struct spdk_iobuf_channel *ch, struct iobuf_channel *iob
 	struct iobuf_node *node = &g_iobuf.node[numa_id];
 	struct spdk_iobuf_node_cache *cache = &ch->cache[numa_id];
 	struct iobuf_channel_node *ch_node = &iobuf_ch->node[numa_id];
-
-	cache->small.queue = &ch_node->small_queue;
-	cache->large.queue = &ch_node->large_queue;
-	cache->small.pool = node->small_pool;
-	cache->large.pool = node->large_pool;
-	cache->small.bufsize = g_iobuf.opts.small_bufsize;
-	cache->large.bufsize = g_iobuf.opts.large_bufsize;
-	cache->small.cache_size = small_cache_size;
-	cache->large.cache_size = large_cache_size;
-	cache->small.cache_count = 0;
-	cache->large.cache_count = 0;
-
-	STAILQ_INIT(&cache->small.cache);
-	STAILQ_INIT(&cache->large.cache);
+	uint8_t c;
+
+	iobuf_pool_cache_init(&cache->small, &ch_node->small_queue, node->small_pool,
+			      g_iobuf.opts.small_bufsize, small_cache_size);
+	iobuf_pool_cache_init(&cache->large, &ch_node->large_queue, node->large_pool,
+			      g_iobuf.opts.large_bufsize, large_cache_size);
+	for (c = 0; c < g_iobuf.opts.num_classes; c++) {
+		iobuf_pool_cache_init(&cache->classes[c], &ch_node->class_queue[c], node->class_pool[c],
+				      g_iobuf.opts.class_bufsize[c], large_cache_size);
+	}
 }
 
 static int
-iobuf_channel_node_populate(struct spdk_iobuf_channel *ch, const char *name, int32_t numa_id)
+iobuf_pool_cache_populate(struct spdk_iobuf_pool_cache *cache, const char *name,
+			  const char *pool_name, uint64_t pool_count)
 {
-	struct iobuf_node *node = &g_iobuf.node[numa_id];
-	struct spdk_iobuf_node_cache *cache = &ch->cache[numa_id];
-	uint32_t small_cache_size = cache->small.cache_size;
-	uint32_t large_cache_size = cache->large.cache_size;
 	struct spdk_iobuf_buffer *buf;
 	uint32_t i;
 
-	for (i = 0; i < small_cache_size; ++i) {
-		if (spdk_ring_dequeue(node->small_pool, (void **)&buf, 1) == 0) {
-			SPDK_ERRLOG("Failed to populate '%s' iobuf small buffer cache at %d/%d entries. "
-				    "You may need to increase spdk_iobuf_opts.small_pool_count (%"PRIu64")\n",
-				    name, i, small_cache_size, g_iobuf.opts.small_pool_count);
+	for (i = 0; i < cache->cache_size; ++i) {
+		if (spdk_ring_dequeue(cache->pool, (void **)&buf, 1) == 0) {
+			SPDK_ERRLOG("Failed to populate '%s' iobuf %s buffer cache at %d/%d entries. "
+				    "You may need to increase spdk_iobuf_opts.%s_pool_count (%"PRIu64")\n",
+				    name, pool_name, i, cache->cache_size, pool_name, pool_count);
 			SPDK_ERRLOG("See scripts/calc-iobuf.py for guidance on how to calculate "
 				    "this value.\n");
 			return -ENOMEM;
 		}
-		STAILQ_INSERT_TAIL(&cache->small.cache, buf, stailq);
-		cache->small.cache_count++;
+		STAILQ_INSERT_TAIL(&cache->cache, buf, stailq);
+		cache->cache_count++;
 	}
-	for (i = 0; i < large_cache_size; ++i) {
-		if (spdk_ring_dequeue(node->large_pool, (void **)&buf, 1) == 0) {
-			SPDK_ERRLOG("Failed to populate '%s' iobuf large buffer cache at %d/%d entries. "
-				    "You may need to increase spdk_iobuf_opts.large_pool_count (%"PRIu64")\n",
-				    name, i, large_cache_size, g_iobuf.opts.large_pool_count);
-			SPDK_ERRLOG("See scripts/calc-iobuf.py for guidance on how to calculate "
-				    "this value.\n");
-			return -ENOMEM;
+
+	return 0;
+}
+
+static int
+iobuf_channel_node_populate(struct spdk_iobuf_channel *ch, const char *name, int32_t numa_id)
+{
+	struct spdk_iobuf_node_cache *cache = &ch->cache[numa_id];
+	uint8_t c;
+	int rc;
+
+	rc = iobuf_pool_cache_populate(&cache->small, name, "small", g_iobuf.opts.small_pool_count);
+	if (rc != 0) {
+		return rc;
+	}
+
+	rc = iobuf_pool_cache_populate(&cache->large, name, "large", g_iobuf.opts.large_pool_count);
+	if (rc != 0) {
+		return rc;
+	}
+
+	for (c = 0; c < g_iobuf.opts.num_classes; c++) {
+		rc = iobuf_pool_cache_populate(&cache->classes[c], name, "class",
+					       g_iobuf.opts.class_pool_count[c]);
+		if (rc != 0) {
+			return rc;
 		}
-		STAILQ_INSERT_TAIL(&cache->large.cache, buf, stailq);
-		cache->large.cache_count++;
 	}
 
 	return 0;
@@ -504,37 +640,38 @@ error:
 }
 
 static void
-iobuf_channel_node_fini(struct spdk_iobuf_channel *ch, int32_t numa_id)
+iobuf_pool_cache_fini(struct spdk_iobuf_channel *ch, struct spdk_iobuf_pool_cache *cache)
 {
-	struct spdk_iobuf_node_cache *cache = &ch->cache[numa_id];
-	struct iobuf_node *node = &g_iobuf.node[numa_id];
 	struct spdk_iobuf_entry *entry __attribute__((unused));
 	struct spdk_iobuf_buffer *buf;
 
 	/* Make sure none of the wait queue entries are coming from this module */
-	STAILQ_FOREACH(entry, cache->small.queue, stailq) {
-		assert(entry->module != ch->module);
-	}
-	STAILQ_FOREACH(entry, cache->large.queue, stailq) {
+	STAILQ_FOREACH(entry, cache->queue, stailq) {
 		assert(entry->module != ch->module);
 	}
 
 	/* Release cached buffers back to the pool */
-	while (!STAILQ_EMPTY(&cache->small.cache)) {
-		buf = STAILQ_FIRST(&cache->small.cache);
-		STAILQ_REMOVE_HEAD(&cache->small.cache, stailq);
-		spdk_ring_enqueue(node->small_pool, (void **)&buf, 1, NULL);
-		cache->small.cache_count--;
-	}
-	while (!STAILQ_EMPTY(&cache->large.cache)) {
-		buf = STAILQ_FIRST(&cache->large.cache);
-		STAILQ_REMOVE_HEAD(&cache->large.cache, stailq);
-		spdk_ring_enqueue(node->large_pool, (void **)&buf, 1, NULL);
-		cache->large.cache_count--;
+	while (!STAILQ_EMPTY(&cache->cache)) {
+		buf = STAILQ_FIRST(&cache->cache);
+		STAILQ_REMOVE_HEAD(&cache->cache, stailq);
+		spdk_ring_enqueue(cache->pool, (void **)&buf, 1, NULL);
+		cache->cache_count--;
 	}
 
-	assert(cache->small.cache_count == 0);
-	assert(cache->large.cache_count == 0);
+	assert(cache->cache_count == 0);
+}
+
+static void
+iobuf_channel_node_fini(struct spdk_iobuf_channel *ch, int32_t numa_id)
+{
+	struct spdk_iobuf_node_cache *cache = &ch->cache[numa_id];
+	uint8_t c;
+
+	iobuf_pool_cache_fini(ch, &cache->small);
+	iobuf_pool_cache_fini(ch, &cache->large);
+	for (c = 0; c < g_iobuf.opts.num_classes; c++) {
+		iobuf_pool_cache_fini(ch, &cache->classes[c]);
+	}
 }
 
 void
@@ -631,6 +768,7 @@ spdk_iobuf_for_each_entry(struct spdk_iobuf_channel *ch,
 {
 	struct spdk_iobuf_node_cache *cache;
 	uint32_t i;
+	uint8_t c;
 	int rc;
 
 	IOBUF_FOREACH_NUMA_ID(i) {
@@ -644,11 +782,36 @@ spdk_iobuf_for_each_entry(struct spdk_iobuf_channel *ch,
 		if (rc != 0) {
 			return rc;
 		}
+		for (c = 0; c < g_iobuf.opts.num_classes; c++) {
+			rc = iobuf_pool_for_each_entry(ch, &cache->classes[c], cb_fn, cb_ctx);
+			if (rc != 0) {
+				return rc;
+			}
+		}
 	}
 
 	return 0;
 }
 
+static inline struct spdk_iobuf_pool_cache *
+iobuf_get_pool_cache(struct spdk_iobuf_node_cache *cache, uint64_t len)
+{
+	uint8_t c;
+
+	if (len <= cache->small.bufsize) {
+		return &cache->small;
+	}
+
+	for (c = 0; c < g_iobuf.opts.num_classes; c++) {
+		if (len <= cache->classes[c].bufsize) {
+			return &cache->classes[c];
+		}
+	}
+
+	assert(len <= cache->large.bufsize);
+	return &cache->large;
+}
+
 static bool
 iobuf_entry_abort_node(struct spdk_iobuf_channel *ch, int32_t numa_id,
 		       struct spdk_iobuf_entry *entry, uint64_t len)
@@ -658,13 +821,7 @@ iobuf_entry_abort_node(struct spdk_iobuf_channel *ch, int32_t numa_id,
 	struct spdk_iobuf_entry *e;
 
 	cache = &ch->cache[numa_id];
-
-	if (len <= cache->small.bufsize) {
-		pool = &cache->small;
-	} else {
-		assert(len <= cache->large.bufsize);
-		pool = &cache->large;
-	}
+	pool = iobuf_get_pool_cache(cache, len);
 
 	STAILQ_FOREACH(e, pool->queue, stailq) {
 		if (e == entry) {
@@ -689,6 +846,241 @@ spdk_iobuf_entry_abort(struct spdk_iobuf_channel *ch, struct spdk_iobuf_entry *e
 
 #define IOBUF_BATCH_SIZE 32
 
+static inline struct spdk_iobuf_pool_cache *
+iobuf_node_cache_get_pool(struct spdk_iobuf_node_cache *cache, uint32_t pool_idx)
+{
+	switch (pool_idx) {
+	case IOBUF_POOL_SMALL:
+		return &cache->small;
+	case IOBUF_POOL_LARGE:
+		return &cache->large;
+	default:
+		return &cache->classes[pool_idx - IOBUF_POOL_LARGE - 1];
+	}
+}
+
+static inline uint32_t
+iobuf_node_cache_get_pool_idx(struct spdk_iobuf_node_cache *cache,
+			      struct spdk_iobuf_pool_cache *pool)
+{
+	if (pool == &cache->small) {
+		return IOBUF_POOL_SMALL;
+	} else if (pool == &cache->large) {
+		return IOBUF_POOL_LARGE;
+	}
+
+	return IOBUF_POOL_LARGE + 1 + (pool - cache->classes);
+}
+
+static inline struct spdk_ring *
+iobuf_node_get_pool(struct iobuf_node *node, uint32_t pool_idx)
+{
+	switch (pool_idx) {
+	case IOBUF_POOL_SMALL:
+		return node->small_pool;
+	case IOBUF_POOL_LARGE:
+		return node->large_pool;
+	default:
+		return node->class_pool[pool_idx - IOBUF_POOL_LARGE - 1];
+	}
+}
+
+static inline spdk_iobuf_entry_stailq_t *
+iobuf_channel_node_get_queue(struct iobuf_channel_node *node, uint32_t pool_idx)
+{
+	switch (pool_idx) {
+	case IOBUF_POOL_SMALL:
+		return &node->small_queue;
+	case IOBUF_POOL_LARGE:
+		return &node->large_queue;
+	default:
+		return &node->class_queue[pool_idx - IOBUF_POOL_LARGE - 1];
+	}
+}
+
+static size_t
+iobuf_pool_cache_take(struct spdk_iobuf_pool_cache *pool, struct spdk_iobuf_buffer **bufs,
+		      size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count && !STAILQ_EMPTY(&pool->cache); i++) {
+		bufs[i] = STAILQ_FIRST(&pool->cache);
+		STAILQ_REMOVE_HEAD(&pool->cache, stailq);
+		assert(pool->cache_count > 0);
+		pool->cache_count--;
+	}
+
+	return i;
+}
+
+/* Half of a cache, up to a batch, can be taken away from its channel */
+static inline size_t
+iobuf_pool_cache_spare(struct spdk_iobuf_pool_cache *pool)
+{
+	return spdk_min(IOBUF_BATCH_SIZE, (pool->cache_count + 1) / 2);
+}
+
+/* Take buffers from the caches of the other channels of the current thread, no
+ * synchronization is needed for those. */
+static void *
+iobuf_steal_local(struct spdk_iobuf_channel *ch, int32_t numa_id, uint32_t pool_idx,
+		  struct spdk_iobuf_pool_cache *pool)
+{
+	struct iobuf_channel *iobuf_ch = spdk_io_channel_get_ctx(ch->parent);
+	struct spdk_iobuf_pool_cache *victim = NULL, *other;
+	struct spdk_iobuf_buffer *bufs[IOBUF_BATCH_SIZE];
+	size_t sz, i;
+
+	for (i = 0; i < IOBUF_MAX_CHANNELS; i++) {
+		if (iobuf_ch->channels[i] == NULL || iobuf_ch->channels[i] == ch) {
+			continue;
+		}
+
+		other = iobuf_node_cache_get_pool(&iobuf_ch->channels[i]->cache[numa_id], pool_idx);
+		if (other->cache_count > 0 && (victim == NULL || other->cache_count > victim->cache_count)) {
+			victim = other;
+		}
+	}
+
+	if (victim == NULL) {
+		return NULL;
+	}
+
+	sz = iobuf_pool_cache_take(victim, bufs, iobuf_pool_cache_spare(victim));
+	assert(sz > 0);
+
+	pool->stats.steal += sz;
+	for (i = 0; i < (sz - 1); i++) {
+		STAILQ_INSERT_HEAD(&pool->cache, bufs[i], stailq);
+		pool->cache_count++;
+	}
+
+	return bufs[i];
+}
+
+static struct spdk_iobuf_pool_cache *
+iobuf_channel_get_module_pool(struct iobuf_channel *iobuf_ch, const void *module, int32_t numa_id,
+			      uint32_t pool_idx)
+{
+	uint32_t i;
+
+	for (i = 0; i < IOBUF_MAX_CHANNELS; i++) {
+		if (iobuf_ch->channels[i] != NULL && iobuf_ch->channels[i]->module == module) {
+			return iobuf_node_cache_get_pool(&iobuf_ch->channels[i]->cache[numa_id], pool_idx);
+		}
+	}
+
+	return NULL;
+}
+
+static void
+iobuf_reclaim_channel(struct spdk_io_channel_iter *iter)
+{
+	struct iobuf_reclaim_ctx *ctx = spdk_io_channel_iter_get_ctx(iter);
+	struct spdk_io_channel *ioch = spdk_io_channel_iter_get_channel(iter);
+	struct iobuf_channel *iobuf_ch = spdk_io_channel_get_ctx(ioch);
+	struct spdk_iobuf_buffer *bufs[IOBUF_BATCH_SIZE];
+	struct spdk_iobuf_pool_cache *pool;
+	size_t sz;
+	uint32_t i;
+
+	/* Don't take anything from a thread that is waiting for buffers itself */
+	if (!STAILQ_EMPTY(iobuf_channel_node_get_queue(&iobuf_ch->node[ctx->numa_id], ctx->pool_idx))) {
+		spdk_for_each_channel_continue(iter, 0);
+		return;
+	}
+
+	for (i = 0; i < IOBUF_MAX_CHANNELS; i++) {
+		if (iobuf_ch->channels[i] == NULL) {
+			continue;
+		}
+
+		pool = iobuf_node_cache_get_pool(&iobuf_ch->channels[i]->cache[ctx->numa_id], ctx->pool_idx);
+		sz = iobuf_pool_cache_take(pool, bufs, iobuf_pool_cache_spare(pool));
+		if (sz > 0) {
+			spdk_ring_enqueue(pool->pool, (void **)bufs, sz, NULL);
+		}
+	}
+
+	spdk_for_each_channel_continue(iter, 0);
+}
+
+static void
+iobuf_reclaim_done(struct spdk_io_channel_iter *iter, int status)
+{
+	struct iobuf_reclaim_ctx *ctx = spdk_io_channel_iter_get_ctx(iter);
+	struct iobuf_channel *iobuf_ch = spdk_io_channel_get_ctx(ctx->ioch);
+	struct iobuf_node *node = &g_iobuf.node[ctx->numa_id];
+	struct spdk_iobuf_pool_cache *pool;
+	spdk_iobuf_entry_stailq_t *queue;
+	struct spdk_iobuf_entry *entry;
+	struct spdk_iobuf_buffer *buf;
+	struct spdk_ring *ring;
+
+	queue = iobuf_channel_node_get_queue(&iobuf_ch->node[ctx->numa_id], ctx->pool_idx);
+	ring = iobuf_node_get_pool(node, ctx->pool_idx);
+
+	/* Hand the reclaimed buffers over to the waiting entries */
+	while (!STAILQ_EMPTY(queue)) {
+		if (spdk_ring_dequeue(ring, (void **)&buf, 1) == 0) {
+			break;
+		}
+
+		entry = STAILQ_FIRST(queue);
+		STAILQ_REMOVE_HEAD(queue, stailq);
+		pool = iobuf_channel_get_module_pool(iobuf_ch, entry->module, ctx->numa_id, ctx->pool_idx);
+		if (pool != NULL) {
+			pool->stats.steal++;
+		}
+		entry->cb_fn(entry, buf);
+	}
+
+	__atomic_store_n(&node->reclaim_in_progress[ctx->pool_idx], false, __ATOMIC_RELEASE);
+	spdk_put_io_channel(ctx->ioch);
+	free(ctx);
+}
+
+/* Ask the other threads to give the spare buffers in their caches back to the pool */
+static void
+iobuf_start_reclaim(int32_t numa_id, uint32_t pool_idx)
+{
+	struct iobuf_node *node = &g_iobuf.node[numa_id];
+	struct iobuf_reclaim_ctx *ctx;
+	uint64_t now = spdk_get_ticks();
+
+	if (now - __atomic_load_n(&node->last_reclaim_tsc[pool_idx], __ATOMIC_RELAXED) <
+	    spdk_get_ticks_hz() * IOBUF_RECLAIM_INTERVAL_US / SPDK_SEC_TO_USEC) {
+		return;
+	}
+
+	if (__atomic_exchange_n(&node->reclaim_in_progress[pool_idx], true, __ATOMIC_ACQUIRE)) {
+		return;
+	}
+
+	__atomic_store_n(&node->last_reclaim_tsc[pool_idx], now, __ATOMIC_RELAXED);
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		goto error;
+	}
+
+	/* Keep the iobuf channel of this thread, where the entries wait, until the reclaim is done */
+	ctx->ioch = spdk_get_io_channel(&g_iobuf);
+	if (ctx->ioch == NULL) {
+		free(ctx);
+		goto error;
+	}
+
+	ctx->numa_id = numa_id;
+	ctx->pool_idx = pool_idx;
+	spdk_for_each_channel(&g_iobuf, iobuf_reclaim_channel, ctx, iobuf_reclaim_done);
+
+	return;
+error:
+	__atomic_store_n(&node->reclaim_in_progress[pool_idx], false, __ATOMIC_RELEASE);
+}
+
 void *
 spdk_iobuf_get(struct spdk_iobuf_channel *ch, uint64_t len,
 	       struct spdk_iobuf_entry *entry, spdk_iobuf_get_cb cb_fn)
@@ -700,12 +1092,7 @@ spdk_iobuf_get(struct spdk_iobuf_channel *ch, uint64_t len,
 	cache = &ch->cache[0];
 
 	assert(spdk_io_channel_get_thread(ch->parent) == spdk_get_thread());
-	if (len <= cache->small.bufsize) {
-		pool = &cache->small;
-	} else {
-		assert(len <= cache->large.bufsize);
-		pool = &cache->large;
-	}
+	pool = iobuf_get_pool_cache(cache, len);
 
 	buf = (void *)STAILQ_FIRST(&pool->cache);
 	if (buf) {
@@ -721,11 +1108,22 @@ spdk_iobuf_get(struct spdk_iobuf_channel *ch, uint64_t len,
 		sz = spdk_ring_dequeue(pool->pool, (void **)bufs, spdk_min(IOBUF_BATCH_SIZE,
 				       spdk_max(pool->cache_size, 1)));
 		if (sz == 0) {
+			if (g_iobuf.opts.enable_steal) {
+				buf = iobuf_steal_local(ch, 0, iobuf_node_cache_get_pool_idx(cache, pool), pool);
+				if (buf != NULL) {
+					return buf;
+				}
+			}
+
 			if (entry) {
 				STAILQ_INSERT_TAIL(pool->queue, entry, stailq);
 				entry->module = ch->module;
 				entry->cb_fn = cb_fn;
 				pool->stats.retry++;
+
+				if (g_iobuf.opts.enable_steal) {
+					iobuf_start_reclaim(0, iobuf_node_cache_get_pool_idx(cache, pool));
+				}
 			}
 
 			return NULL;
@@ -763,11 +1161,7 @@ spdk_iobuf_put(struct spdk_iobuf_channel *ch, void *buf, uint64_t len)
 	cache = &ch->cache[numa_id];
 
 	assert(spdk_io_channel_get_thread(ch->parent) == spdk_get_thread());
-	if (len <= cache->small.bufsize) {
-		pool = &cache->small;
-	} else {
-		pool = &cache->large;
-	}
+	pool = iobuf_get_pool_cache(cache, len);
 
 	if (STAILQ_EMPTY(pool->queue)) {
 		if (pool->cache_size == 0) {
@@ -808,6 +1202,102 @@ spdk_iobuf_put(struct spdk_iobuf_channel *ch, void *buf, uint64_t len)
 	}
 }
 
+static void iobuf_get_iov_cb(struct spdk_iobuf_entry *iobuf, void *buf);
+
+/* Gather the remaining buffers of a scatter-gather request.  Returns the number of iovecs once
+ * the request is complete, 0 if it got queued and -ENOMEM if it's missing buffers and can't wait. */
+static int
+iobuf_get_iov_continue(struct spdk_iobuf_iov_entry *entry)
+{
+	struct spdk_iobuf_channel *ch = entry->ch;
+	uint64_t len;
+	void *buf;
+
+	while (entry->len > 0) {
+		len = spdk_min(entry->len, ch->cache[0].large.bufsize);
+		buf = spdk_iobuf_get(ch, len, entry->cb_fn != NULL ? &entry->iobuf : NULL,
+				     iobuf_get_iov_cb);
+		if (buf == NULL) {
+			return entry->cb_fn != NULL ? 0 : -ENOMEM;
+		}
+
+		entry->iovs[entry->iovcnt].iov_base = buf;
+		entry->iovs[entry->iovcnt].iov_len = len;
+		entry->iovcnt++;
+		entry->len -= len;
+	}
+
+	return entry->iovcnt;
+}
+
+static void
+iobuf_get_iov_cb(struct spdk_iobuf_entry *iobuf, void *buf)
+{
+	struct spdk_iobuf_iov_entry *entry = SPDK_CONTAINEROF(iobuf, struct spdk_iobuf_iov_entry, iobuf);
+	uint64_t len = spdk_min(entry->len, entry->ch->cache[0].large.bufsize);
+
+	entry->iovs[entry->iovcnt].iov_base = buf;
+	entry->iovs[entry->iovcnt].iov_len = len;
+	entry->iovcnt++;
+	entry->len -= len;
+
+	if (iobuf_get_iov_continue(entry) > 0) {
+		entry->cb_fn(entry, entry->iovs, entry->iovcnt);
+	}
+}
+
+int
+spdk_iobuf_get_iov(struct spdk_iobuf_channel *ch, uint64_t len, struct iovec *iovs, int iovcnt,
+		   struct spdk_iobuf_iov_entry *entry, spdk_iobuf_get_iov_cb cb_fn)
+{
+	struct spdk_iobuf_iov_entry local = {};
+	int rc;
+
+	if (len == 0 || spdk_divide_round_up(len, ch->cache[0].large.bufsize) > (uint64_t)iovcnt) {
+		return -EINVAL;
+	}
+
+	if (entry == NULL) {
+		entry = &local;
+		cb_fn = NULL;
+	}
+
+	assert(entry == &local || cb_fn != NULL);
+	entry->ch = ch;
+	entry->iovs = iovs;
+	entry->iovcnt = 0;
+	entry->len = len;
+	entry->cb_fn = cb_fn;
+
+	rc = iobuf_get_iov_continue(entry);
+	if (rc < 0) {
+		spdk_iobuf_put_iov(ch, iovs, entry->iovcnt);
+	}
+
+	return rc;
+}
+
+void
+spdk_iobuf_put_iov(struct spdk_iobuf_channel *ch, struct iovec *iovs, int iovcnt)
+{
+	int i;
+
+	for (i = 0; i < iovcnt; i++) {
+		spdk_iobuf_put(ch, iovs[i].iov_base, iovs[i].iov_len);
+	}
+}
+
+void
+spdk_iobuf_iov_entry_abort(struct spdk_iobuf_iov_entry *entry)
+{
+	struct spdk_iobuf_channel *ch = entry->ch;
+
+	assert(entry->len > 0);
+	spdk_iobuf_entry_abort(ch, &entry->iobuf, spdk_min(entry->len, ch->cache[0].large.bufsize));
+	spdk_iobuf_put_iov(ch, entry->iovs, entry->iovcnt);
+	entry->iovcnt = 0;
+}
+
 static void
 iobuf_get_channel_stats_done(struct spdk_io_channel_iter *iter, int status)
 {
@@ -841,17 +1331,28 @@ iobuf_get_channel_stats(struct spdk_io_channel_iter *iter)
 			if (strcmp(it->module, module->name) == 0) {
 				struct spdk_iobuf_pool_cache *cache;
 				uint32_t i;
+				uint8_t c;
 
 				IOBUF_FOREACH_NUMA_ID(i) {
 					cache = &channel->cache[i].small;
 					it->small_pool.cache += cache->stats.cache;
 					it->small_pool.main += cache->stats.main;
 					it->small_pool.retry += cache->stats.retry;
+					it->small_pool.steal += cache->stats.steal;
 
 					cache = &channel->cache[i].large;
 					it->large_pool.cache += cache->stats.cache;
 					it->large_pool.main += cache->stats.main;
 					it->large_pool.retry += cache->stats.retry;
+					it->large_pool.steal += cache->stats.steal;
+
+					for (c = 0; c < g_iobuf.opts.num_classes; c++) {
+						cache = &channel->cache[i].classes[c];
+						it->class_pool[c].cache += cache->stats.cache;
+						it->class_pool[c].main += cache->stats.main;
+						it->class_pool[c].retry += cache->stats.retry;
+						it->class_pool[c].steal += cache->stats.steal;
+					}
 				}
 				break;
 			}
@@ -896,3 +1397,46 @@ spdk_iobuf_get_stats(spdk_iobuf_get_stats_cb cb_fn, void *cb_arg)
 			      iobuf_get_channel_stats_done);
 	return 0;
 }
+
+static int
+iobuf_add_region(struct iovec *regions, int max_regions, int count, void *base, uint64_t len)
+{
+	if (base == NULL) {
+		return count;
+	}
+
+	if (count < max_regions) {
+		regions[count].iov_base = base;
+		regions[count].iov_len = len;
+	}
+
+	return count + 1;
+}
+
+int
+spdk_iobuf_get_regions(struct iovec *regions, int max_regions)
+{
+	struct spdk_iobuf_opts *opts = &g_iobuf.opts;
+	struct iobuf_node *node;
+	int32_t i;
+	int count = 0;
+	uint8_t c;
+
+	if (!g_iobuf_is_initialized) {
+		return 0;
+	}
+
+	IOBUF_FOREACH_NUMA_ID(i) {
+		node = &g_iobuf.node[i];
+		count = iobuf_add_region(regions, max_regions, count, node->small_pool_base,
+					 opts->small_pool_count * opts->small_bufsize);
+		count = iobuf_add_region(regions, max_regions, count, node->large_pool_base,
+					 opts->large_pool_count * opts->large_bufsize);
+		for (c = 0; c < opts->num_classes; c++) {
+			count = iobuf_add_region(regions, max_regions, count, node->class_pool_base[c],
+						 opts->class_pool_count[c] * opts->class_bufsize[c]);
+		}
+	}
+
+	return count;
+}
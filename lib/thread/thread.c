@@ -32,13 +32,43 @@
 #endif
 
 #define SPDK_MSG_BATCH_SIZE		8
+/* Number of target threads a thread can stage outgoing messages for during a single poll */
+#define SPDK_MSG_STAGE_TARGETS		4
 #define SPDK_MAX_DEVICE_NAME_LEN	256
 #define SPDK_THREAD_EXIT_TIMEOUT_SEC	5
 #define SPDK_MAX_POLLER_NAME_LEN	256
 #define SPDK_MAX_THREAD_NAME_LEN	256
 
+/*
+ * Timed pollers are kept in a hierarchical timer wheel. Each level has
+ * SPDK_POLLER_WHEEL_SLOTS slots and a slot of level N covers as many ticks as
+ * the whole level N - 1. Pollers expiring beyond the last level are kept on an
+ * overflow list.
+ */
+#define SPDK_POLLER_WHEEL_LEVEL_BITS	6
+#define SPDK_POLLER_WHEEL_SLOTS		(1U << SPDK_POLLER_WHEEL_LEVEL_BITS)
+#define SPDK_POLLER_WHEEL_SLOT_MASK	(SPDK_POLLER_WHEEL_SLOTS - 1)
+#define SPDK_POLLER_WHEEL_LEVELS	4
+
+/*
+ * Each thread can carve its pollers and io_channels out of large memory chunks
+ * instead of allocating them one by one.  Objects are rounded up to a power of two
+ * size class, starting with a cache line, and freed objects are kept on a per-class
+ * free list for reuse.  Objects larger than the last class are allocated separately.
+ */
+#define SPDK_THREAD_ARENA_MIN_SHIFT	6
+#define SPDK_THREAD_ARENA_CLASSES	9
+#define SPDK_THREAD_ARENA_MAX_OBJ_SIZE	(1U << (SPDK_THREAD_ARENA_MIN_SHIFT + SPDK_THREAD_ARENA_CLASSES - 1))
+#define SPDK_THREAD_ARENA_MIN_CHUNK_SIZE	(64 * 1024)
+
 static struct spdk_thread *g_app_thread;
 
+static struct spdk_thread_arena_opts g_thread_arena_opts = {
+	.opts_size = sizeof(g_thread_arena_opts),
+	.chunk_size = 0,
+	.hugepages = false,
+};
+
 struct spdk_interrupt {
 	int			efd;
 	struct spdk_fd_group	*fgrp;
@@ -71,7 +101,12 @@ enum spdk_poller_state {
 
 struct spdk_poller {
 	TAILQ_ENTRY(spdk_poller)	tailq;
-	RB_ENTRY(spdk_poller)		node;
+	TAILQ_ENTRY(spdk_poller)	wheel_tailq;
+	/* Position in the thread's timer wheel; level SPDK_POLLER_WHEEL_LEVELS is the overflow list. */
+	uint8_t				wheel_level;
+	uint8_t				wheel_slot;
+	/* The poller was allocated from its thread's arena. */
+	bool				arena;
 
 	/* Current state of the poller; should only be accessed from the poller's thread. */
 	enum spdk_poller_state		state;
@@ -80,6 +115,11 @@ struct spdk_poller {
 	uint64_t			next_run_tick;
 	uint64_t			run_count;
 	uint64_t			busy_count;
+	uint64_t			busy_tsc;
+	uint64_t			idle_tsc;
+	uint64_t			max_run_tsc;
+	/* Stats generation of the thread when the poller last ran. */
+	uint64_t			stats_gen;
 	uint64_t			id;
 	spdk_poller_fn			fn;
 	void				*arg;
@@ -91,6 +131,40 @@ struct spdk_poller {
 	char				name[SPDK_MAX_POLLER_NAME_LEN + 1];
 };
 
+TAILQ_HEAD(poller_wheel_slot, spdk_poller);
+
+struct poller_wheel {
+	/* Current time of the wheel, in level 0 slots. No poller expires before it. */
+	uint64_t			cursor;
+	/* Log2 of the number of ticks covered by a level 0 slot. */
+	uint32_t			shift;
+	/* Bitmaps of the non-empty slots of each level. */
+	uint64_t			occupied[SPDK_POLLER_WHEEL_LEVELS];
+	struct poller_wheel_slot	slots[SPDK_POLLER_WHEEL_LEVELS][SPDK_POLLER_WHEEL_SLOTS];
+	struct poller_wheel_slot	overflow;
+};
+
+struct thread_arena_chunk {
+	SLIST_ENTRY(thread_arena_chunk)	link;
+};
+
+struct thread_arena_obj {
+	SLIST_ENTRY(thread_arena_obj)	link;
+};
+
+struct thread_arena {
+	/* Size of the chunks, 0 if the arena is disabled. */
+	uint32_t				chunk_size;
+	bool					hugepages;
+	/* Free space left in the current chunk. */
+	uint8_t					*cur;
+	uint8_t					*end;
+	/* Number of objects handed out and not freed yet. */
+	uint64_t				outstanding;
+	SLIST_HEAD(, thread_arena_chunk)	chunks;
+	SLIST_HEAD(, thread_arena_obj)		free_objs[SPDK_THREAD_ARENA_CLASSES];
+};
+
 enum spdk_thread_state {
 	/* The thread is processing poller and message by spdk_thread_poll(). */
 	SPDK_THREAD_STATE_RUNNING,
@@ -111,6 +185,26 @@ struct spdk_thread_post_poller_handler {
 
 #define SPDK_THREAD_MAX_POST_POLLER_HANDLERS (4)
 
+struct spdk_msg {
+	spdk_msg_fn		fn;
+	void			*arg;
+
+	/* Next message in the target thread's message queue */
+	struct spdk_msg		*next;
+	SLIST_ENTRY(spdk_msg)	link;
+};
+
+/*
+ * Messages sent from a thread while it's being polled are staged per target thread and published
+ * with a single atomic operation once the poll is done.
+ */
+struct spdk_msg_stage {
+	struct spdk_thread	*target;
+	struct spdk_msg		*first;
+	struct spdk_msg		*last;
+	uint32_t		count;
+};
+
 struct spdk_thread {
 	uint64_t			tsc_last;
 	struct spdk_thread_stats	stats;
@@ -124,7 +218,7 @@ struct spdk_thread {
 	/**
 	 * Contains pollers running on this thread with a periodic timer.
 	 */
-	RB_HEAD(timed_pollers_tree, spdk_poller)	timed_pollers;
+	struct poller_wheel				timed_pollers;
 	struct spdk_poller				*first_timed_poller;
 	/*
 	 * Contains paused pollers.  Pollers on this queue are waiting until
@@ -133,7 +227,16 @@ struct spdk_thread {
 	 */
 	TAILQ_HEAD(paused_pollers_head, spdk_poller)	paused_pollers;
 	struct spdk_thread_post_poller_handler		pp_handlers[SPDK_THREAD_MAX_POST_POLLER_HANDLERS];
-	struct spdk_ring		*messages;
+	/*
+	 * Incoming messages form an intrusive multi-producer, single-consumer queue. The consumer
+	 * pops from msg_head, producers append a chain of messages by swapping msg_tail. The stub
+	 * message keeps the queue non-empty, so producers never touch msg_head.
+	 */
+	struct spdk_msg			*msg_head;
+	struct spdk_msg			msg_stub;
+	struct spdk_msg_stage		msg_stage[SPDK_MSG_STAGE_TARGETS];
+	uint8_t				num_msg_stages;
+	bool				msg_staging;
 	uint8_t				num_pp_handlers;
 	int				msg_fd;
 	SLIST_HEAD(, spdk_msg)		msg_cache;
@@ -141,6 +244,12 @@ struct spdk_thread {
 	spdk_msg_fn			critical_msg;
 	uint64_t			id;
 	uint64_t			next_poller_id;
+	/*
+	 * Generation of the last poller stats report, and of the last change to the set of pollers
+	 * or their states.  Both are only accessed from this thread.
+	 */
+	uint64_t			stats_gen;
+	uint64_t			pollers_gen;
 	enum spdk_thread_state		state;
 	int				pending_unregister_count;
 	uint32_t			for_each_count;
@@ -148,6 +257,8 @@ struct spdk_thread {
 	RB_HEAD(io_channel_tree, spdk_io_channel)	io_channels;
 	TAILQ_ENTRY(spdk_thread)			tailq;
 
+	struct thread_arena		arena;
+
 	char				name[SPDK_MAX_THREAD_NAME_LEN + 1];
 	struct spdk_cpuset		cpumask;
 	uint64_t			exit_timeout_tsc;
@@ -166,6 +277,11 @@ struct spdk_thread {
 
 	uint8_t				reserved[6];
 
+	/* Written by every thread sending a message, so keep it away from the consumer's fields */
+	struct spdk_msg			*msg_tail __attribute__((aligned(SPDK_CACHE_LINE_SIZE)));
+	/* Number of threads that staged messages for this thread and haven't published them yet */
+	uint32_t			num_staged;
+
 	/* User context allocated at the end */
 	uint8_t				ctx[0];
 };
@@ -292,12 +408,6 @@ io_channel_cmp(struct spdk_io_channel *ch1, struct spdk_io_channel *ch2)
 
 RB_GENERATE_STATIC(io_channel_tree, spdk_io_channel, node, io_channel_cmp);
 
-struct spdk_msg {
-	spdk_msg_fn		fn;
-	void			*arg;
-
-	SLIST_ENTRY(spdk_msg)	link;
-};
 
 static struct spdk_mempool *g_spdk_msg_mempool = NULL;
 
@@ -327,28 +437,239 @@ thread_trace(void)
 }
 SPDK_TRACE_REGISTER_FN(thread_trace, "thread", TRACE_GROUP_THREAD)
 
+SPDK_STATIC_ASSERT(SPDK_POLLER_WHEEL_SLOTS == 64, "occupied bitmaps hold 64 slots");
+
+static void
+poller_wheel_init(struct poller_wheel *wheel)
+{
+	uint64_t ticks_per_us = spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+	uint32_t level, slot;
+
+	/* Level 0 slots cover about a microsecond. */
+	wheel->shift = ticks_per_us > 1 ? spdk_u64log2(ticks_per_us) : 0;
+	wheel->cursor = spdk_get_ticks() >> wheel->shift;
+
+	for (level = 0; level < SPDK_POLLER_WHEEL_LEVELS; level++) {
+		wheel->occupied[level] = 0;
+		for (slot = 0; slot < SPDK_POLLER_WHEEL_SLOTS; slot++) {
+			TAILQ_INIT(&wheel->slots[level][slot]);
+		}
+	}
+	TAILQ_INIT(&wheel->overflow);
+}
+
+static void
+poller_wheel_place(struct poller_wheel *wheel, struct spdk_poller *poller)
+{
+	struct poller_wheel_slot *slot;
+	struct spdk_poller *prev;
+	uint64_t expiry;
+	uint32_t level, shift = 0;
+
+	/* A poller armed in the past simply expires in the current slot. */
+	expiry = spdk_max(poller->next_run_tick >> wheel->shift, wheel->cursor);
+
+	if (expiry - wheel->cursor < SPDK_POLLER_WHEEL_SLOTS) {
+		level = 0;
+		slot = &wheel->slots[0][expiry & SPDK_POLLER_WHEEL_SLOT_MASK];
+
+		/* Level 0 slots are kept sorted, pollers with the same next_run_tick
+		 * run in the order they were armed.  A slot covers only a few ticks,
+		 * so the scan from the tail is short.
+		 */
+		prev = TAILQ_LAST(slot, poller_wheel_slot);
+		while (prev != NULL && prev->next_run_tick > poller->next_run_tick) {
+			prev = TAILQ_PREV(prev, poller_wheel_slot, wheel_tailq);
+		}
+		if (prev != NULL) {
+			TAILQ_INSERT_AFTER(slot, prev, poller, wheel_tailq);
+		} else {
+			TAILQ_INSERT_HEAD(slot, poller, wheel_tailq);
+		}
+	} else {
+		for (level = 1; level < SPDK_POLLER_WHEEL_LEVELS; level++) {
+			shift = level * SPDK_POLLER_WHEEL_LEVEL_BITS;
+			if ((expiry >> shift) - (wheel->cursor >> shift) < SPDK_POLLER_WHEEL_SLOTS) {
+				break;
+			}
+		}
+
+		if (level == SPDK_POLLER_WHEEL_LEVELS) {
+			TAILQ_INSERT_TAIL(&wheel->overflow, poller, wheel_tailq);
+			poller->wheel_level = level;
+			poller->wheel_slot = 0;
+			return;
+		}
+
+		TAILQ_INSERT_TAIL(&wheel->slots[level][(expiry >> shift) & SPDK_POLLER_WHEEL_SLOT_MASK],
+				  poller, wheel_tailq);
+		expiry >>= shift;
+	}
+
+	poller->wheel_level = level;
+	poller->wheel_slot = expiry & SPDK_POLLER_WHEEL_SLOT_MASK;
+	wheel->occupied[level] |= 1ULL << poller->wheel_slot;
+}
+
+static void
+poller_wheel_unlink(struct poller_wheel *wheel, struct spdk_poller *poller)
+{
+	struct poller_wheel_slot *slot;
+
+	if (poller->wheel_level == SPDK_POLLER_WHEEL_LEVELS) {
+		TAILQ_REMOVE(&wheel->overflow, poller, wheel_tailq);
+		return;
+	}
+
+	slot = &wheel->slots[poller->wheel_level][poller->wheel_slot];
+	TAILQ_REMOVE(slot, poller, wheel_tailq);
+	if (TAILQ_EMPTY(slot)) {
+		wheel->occupied[poller->wheel_level] &= ~(1ULL << poller->wheel_slot);
+	}
+}
+
+static void
+poller_wheel_replace_slot(struct poller_wheel *wheel, struct poller_wheel_slot *slot)
+{
+	struct poller_wheel_slot pollers;
+	struct spdk_poller *poller;
+
+	TAILQ_INIT(&pollers);
+	TAILQ_SWAP(slot, &pollers, spdk_poller, wheel_tailq);
+
+	while ((poller = TAILQ_FIRST(&pollers)) != NULL) {
+		TAILQ_REMOVE(&pollers, poller, wheel_tailq);
+		poller_wheel_place(wheel, poller);
+	}
+}
+
 /*
- * If this compare function returns zero when two next_run_ticks are equal,
- * the macro RB_INSERT() returns a pointer to the element with the same
- * next_run_tick.
- *
- * Fortunately, the macro RB_REMOVE() takes not a key but a pointer to the element
- * to remove as a parameter.
- *
- * Hence we allow RB_INSERT() to insert elements with the same keys on the right
- * side by returning 1 when two next_run_ticks are equal.
+ * Move the wheel forward to cursor.  No poller may expire before the new cursor,
+ * so at each upper level only the slot the cursor enters can hold pollers.  Those
+ * are spread over the lower levels.
  */
-static inline int
-timed_poller_compare(struct spdk_poller *poller1, struct spdk_poller *poller2)
+static void
+poller_wheel_advance(struct poller_wheel *wheel, uint64_t cursor)
 {
-	if (poller1->next_run_tick < poller2->next_run_tick) {
-		return -1;
-	} else {
-		return 1;
+	uint64_t old_cursor = wheel->cursor;
+	uint32_t level, shift, slot;
+
+	assert(cursor >= old_cursor);
+	wheel->cursor = cursor;
+
+	shift = (SPDK_POLLER_WHEEL_LEVELS - 1) * SPDK_POLLER_WHEEL_LEVEL_BITS;
+	if ((cursor >> shift) != (old_cursor >> shift) && !TAILQ_EMPTY(&wheel->overflow)) {
+		poller_wheel_replace_slot(wheel, &wheel->overflow);
+	}
+
+	for (level = SPDK_POLLER_WHEEL_LEVELS - 1; level > 0; level--) {
+		shift = level * SPDK_POLLER_WHEEL_LEVEL_BITS;
+		slot = (cursor >> shift) & SPDK_POLLER_WHEEL_SLOT_MASK;
+		if ((cursor >> shift) == (old_cursor >> shift) ||
+		    !(wheel->occupied[level] & (1ULL << slot))) {
+			continue;
+		}
+
+		wheel->occupied[level] &= ~(1ULL << slot);
+		poller_wheel_replace_slot(wheel, &wheel->slots[level][slot]);
+	}
+}
+
+/*
+ * Return the poller expiring first.  The wheel is moved forward to it, so only the
+ * upper level slots holding the earliest pollers are ever spread again.
+ */
+static struct spdk_poller *
+poller_wheel_first(struct poller_wheel *wheel)
+{
+	struct spdk_poller *poller;
+	uint64_t occupied, base, start, first;
+	uint32_t level, shift, rot;
+	int first_level;
+
+	while (true) {
+		first = UINT64_MAX;
+		first_level = -1;
+
+		for (level = 0; level < SPDK_POLLER_WHEEL_LEVELS; level++) {
+			occupied = wheel->occupied[level];
+			if (occupied == 0) {
+				continue;
+			}
+
+			/* Look for the first non-empty slot starting at the cursor. */
+			shift = level * SPDK_POLLER_WHEEL_LEVEL_BITS;
+			base = wheel->cursor >> shift;
+			rot = base & SPDK_POLLER_WHEEL_SLOT_MASK;
+			if (rot != 0) {
+				occupied = (occupied >> rot) | (occupied << (SPDK_POLLER_WHEEL_SLOTS - rot));
+			}
+			start = (base + __builtin_ctzll(occupied)) << shift;
+			if (start < first) {
+				first = start;
+				first_level = level;
+			}
+		}
+
+		if (first_level == 0) {
+			poller_wheel_advance(wheel, first);
+			return TAILQ_FIRST(&wheel->slots[0][first & SPDK_POLLER_WHEEL_SLOT_MASK]);
+		}
+
+		if (first_level < 0) {
+			if (TAILQ_EMPTY(&wheel->overflow)) {
+				return NULL;
+			}
+
+			/* Only far away pollers are left, jump to the earliest of them. */
+			TAILQ_FOREACH(poller, &wheel->overflow, wheel_tailq) {
+				first = spdk_min(first, poller->next_run_tick >> wheel->shift);
+			}
+			first = spdk_max(first, wheel->cursor);
+		}
+
+		poller_wheel_advance(wheel, first);
+	}
+}
+
+static struct spdk_poller *
+poller_wheel_first_from(struct poller_wheel *wheel, uint32_t level, uint32_t slot)
+{
+	uint64_t occupied;
+
+	if (slot == SPDK_POLLER_WHEEL_SLOTS) {
+		level++;
+		slot = 0;
+	}
+
+	for (; level < SPDK_POLLER_WHEEL_LEVELS; level++, slot = 0) {
+		occupied = wheel->occupied[level] & (UINT64_MAX << slot);
+		if (occupied != 0) {
+			return TAILQ_FIRST(&wheel->slots[level][__builtin_ctzll(occupied)]);
+		}
 	}
+
+	return TAILQ_FIRST(&wheel->overflow);
+}
+
+/* Iterate over all the pollers of the wheel, in no particular order. */
+static struct spdk_poller *
+poller_wheel_next(struct poller_wheel *wheel, struct spdk_poller *prev)
+{
+	struct spdk_poller *poller;
+
+	poller = TAILQ_NEXT(prev, wheel_tailq);
+	if (poller != NULL || prev->wheel_level == SPDK_POLLER_WHEEL_LEVELS) {
+		return poller;
+	}
+
+	return poller_wheel_first_from(wheel, prev->wheel_level, prev->wheel_slot + 1u);
 }
 
-RB_GENERATE_STATIC(timed_pollers_tree, spdk_poller, node, timed_poller_compare);
+#define POLLER_WHEEL_FOREACH_SAFE(poller, wheel, tmp)					\
+	for ((poller) = poller_wheel_first_from((wheel), 0, 0);				\
+	     (poller) != NULL && ((tmp) = poller_wheel_next((wheel), (poller)), true);	\
+	     (poller) = (tmp))
 
 static inline struct spdk_thread *
 _get_thread(void)
@@ -380,6 +701,155 @@ _thread_lib_init(size_t ctx_sz, size_t msg_mempool_sz)
 	return 0;
 }
 
+static void
+thread_arena_init(struct thread_arena *arena)
+{
+	uint32_t i;
+
+	arena->chunk_size = g_thread_arena_opts.chunk_size;
+	arena->hugepages = g_thread_arena_opts.hugepages;
+	arena->cur = NULL;
+	arena->end = NULL;
+	arena->outstanding = 0;
+	SLIST_INIT(&arena->chunks);
+	for (i = 0; i < SPDK_THREAD_ARENA_CLASSES; i++) {
+		SLIST_INIT(&arena->free_objs[i]);
+	}
+}
+
+static void
+thread_arena_fini(struct spdk_thread *thread)
+{
+	struct thread_arena *arena = &thread->arena;
+	struct thread_arena_chunk *chunk;
+
+	if (arena->outstanding != 0) {
+		/* Something still points into the chunks, e.g. a leaked io_channel. */
+		SPDK_ERRLOG("thread %s still has %" PRIu64 " objects allocated from its arena\n",
+			    thread->name, arena->outstanding);
+		return;
+	}
+
+	while ((chunk = SLIST_FIRST(&arena->chunks)) != NULL) {
+		SLIST_REMOVE_HEAD(&arena->chunks, link);
+		if (arena->hugepages) {
+			spdk_free(chunk);
+		} else {
+			free(chunk);
+		}
+	}
+}
+
+static inline int
+thread_arena_get_class(size_t size)
+{
+	if (size <= (1U << SPDK_THREAD_ARENA_MIN_SHIFT)) {
+		return 0;
+	}
+
+	return spdk_u64log2(size - 1) + 1 - SPDK_THREAD_ARENA_MIN_SHIFT;
+}
+
+static int
+thread_arena_add_chunk(struct thread_arena *arena)
+{
+	struct thread_arena_chunk *chunk;
+	int32_t numa_id;
+
+	if (arena->hugepages) {
+		/* Chunks are added from the thread itself, so take the memory from the node
+		 * the thread is running on. */
+		numa_id = spdk_env_get_numa_id(spdk_env_get_current_core());
+		chunk = spdk_zmalloc(arena->chunk_size, SPDK_CACHE_LINE_SIZE, NULL, numa_id, SPDK_MALLOC_DMA);
+	} else if (posix_memalign((void **)&chunk, SPDK_CACHE_LINE_SIZE, arena->chunk_size) == 0) {
+		memset(chunk, 0, arena->chunk_size);
+	} else {
+		chunk = NULL;
+	}
+
+	if (chunk == NULL) {
+		return -ENOMEM;
+	}
+
+	SLIST_INSERT_HEAD(&arena->chunks, chunk, link);
+	/* Keep the objects cache line aligned. */
+	arena->cur = (uint8_t *)chunk + SPDK_CACHE_LINE_SIZE;
+	arena->end = (uint8_t *)chunk + arena->chunk_size;
+
+	return 0;
+}
+
+/* Allocate zeroed memory for an object of the given thread.  Falls back to calloc()
+ * if the arena is disabled or can't hold the object, *arena_obj tells which one
+ * was used and has to be passed on to thread_arena_free(). */
+static void *
+thread_arena_calloc(struct spdk_thread *thread, size_t size, bool *arena_obj)
+{
+	struct thread_arena *arena = &thread->arena;
+	struct thread_arena_obj *obj;
+	size_t obj_size;
+	int cls;
+
+	*arena_obj = false;
+	if (arena->chunk_size == 0 || size > SPDK_THREAD_ARENA_MAX_OBJ_SIZE) {
+		return calloc(1, size);
+	}
+
+	cls = thread_arena_get_class(size);
+	obj_size = 1ULL << (cls + SPDK_THREAD_ARENA_MIN_SHIFT);
+
+	obj = SLIST_FIRST(&arena->free_objs[cls]);
+	if (obj != NULL) {
+		SLIST_REMOVE_HEAD(&arena->free_objs[cls], link);
+		memset(obj, 0, size);
+	} else {
+		if ((size_t)(arena->end - arena->cur) < obj_size &&
+		    thread_arena_add_chunk(arena) != 0) {
+			return calloc(1, size);
+		}
+
+		/* Chunks are zeroed when allocated. */
+		obj = (struct thread_arena_obj *)arena->cur;
+		arena->cur += obj_size;
+	}
+
+	arena->outstanding++;
+	*arena_obj = true;
+
+	return obj;
+}
+
+static void
+thread_arena_free(struct spdk_thread *thread, void *buf, size_t size, bool arena_obj)
+{
+	struct thread_arena *arena = &thread->arena;
+	struct thread_arena_obj *obj = buf;
+
+	if (!arena_obj) {
+		free(buf);
+		return;
+	}
+
+	assert(arena->outstanding > 0);
+	arena->outstanding--;
+	SLIST_INSERT_HEAD(&arena->free_objs[thread_arena_get_class(size)], obj, link);
+}
+
+static inline void
+thread_pollers_changed(struct spdk_thread *thread)
+{
+	if (thread->pollers_gen != UINT64_MAX) {
+		thread->pollers_gen = thread->stats_gen;
+	}
+}
+
+static inline void
+poller_free(struct spdk_poller *poller)
+{
+	thread_pollers_changed(poller->thread);
+	thread_arena_free(poller->thread, poller, sizeof(*poller), poller->arena);
+}
+
 static void thread_interrupt_destroy(struct spdk_thread *thread);
 static int thread_interrupt_create(struct spdk_thread *thread);
 
@@ -401,22 +871,22 @@ _free_thread(struct spdk_thread *thread)
 				     poller->name);
 		}
 		TAILQ_REMOVE(&thread->active_pollers, poller, tailq);
-		free(poller);
+		poller_free(poller);
 	}
 
-	RB_FOREACH_SAFE(poller, timed_pollers_tree, &thread->timed_pollers, ptmp) {
+	POLLER_WHEEL_FOREACH_SAFE(poller, &thread->timed_pollers, ptmp) {
 		if (poller->state != SPDK_POLLER_STATE_UNREGISTERED) {
 			SPDK_WARNLOG("timed_poller %s still registered at thread exit\n",
 				     poller->name);
 		}
-		RB_REMOVE(timed_pollers_tree, &thread->timed_pollers, poller);
-		free(poller);
+		poller_wheel_unlink(&thread->timed_pollers, poller);
+		poller_free(poller);
 	}
 
 	TAILQ_FOREACH_SAFE(poller, &thread->paused_pollers, tailq, ptmp) {
 		SPDK_WARNLOG("paused_poller %s still registered at thread exit\n", poller->name);
 		TAILQ_REMOVE(&thread->paused_pollers, poller, tailq);
-		free(poller);
+		poller_free(poller);
 	}
 
 	pthread_mutex_lock(&g_devlist_mutex);
@@ -437,12 +907,13 @@ _free_thread(struct spdk_thread *thread)
 	}
 
 	assert(thread->msg_cache_count == 0);
+	assert(thread->num_msg_stages == 0);
 
 	if (spdk_interrupt_mode_is_enabled()) {
 		thread_interrupt_destroy(thread);
 	}
 
-	spdk_ring_free(thread->messages);
+	thread_arena_fini(thread);
 	free(thread);
 }
 
@@ -509,6 +980,57 @@ spdk_thread_lib_fini(void)
 	}
 }
 
+int
+spdk_thread_arena_set_opts(const struct spdk_thread_arena_opts *opts)
+{
+	if (opts == NULL || opts->opts_size == 0) {
+		SPDK_ERRLOG("opts and opts_size cannot be zero value\n");
+		return -EINVAL;
+	}
+
+#define GET_FIELD(field, defval) \
+	(offsetof(struct spdk_thread_arena_opts, field) + sizeof(opts->field) <= opts->opts_size ? \
+	 opts->field : (defval))
+
+	if (GET_FIELD(chunk_size, 0) != 0 &&
+	    GET_FIELD(chunk_size, 0) < SPDK_THREAD_ARENA_MIN_CHUNK_SIZE) {
+		SPDK_ERRLOG("chunk_size must be 0 or at least %u\n", SPDK_THREAD_ARENA_MIN_CHUNK_SIZE);
+		return -EINVAL;
+	}
+
+	g_thread_arena_opts.chunk_size = GET_FIELD(chunk_size, 0);
+	g_thread_arena_opts.hugepages = GET_FIELD(hugepages, false);
+
+#undef GET_FIELD
+
+	return 0;
+}
+
+void
+spdk_thread_arena_get_opts(struct spdk_thread_arena_opts *opts, size_t opts_size)
+{
+	if (opts == NULL || opts_size == 0) {
+		SPDK_ERRLOG("opts and opts_size cannot be zero value\n");
+		return;
+	}
+
+	opts->opts_size = opts_size;
+
+#define SET_FIELD(field) \
+	if (offsetof(struct spdk_thread_arena_opts, field) + sizeof(opts->field) <= opts_size) { \
+		opts->field = g_thread_arena_opts.field; \
+	} \
+
+	SET_FIELD(chunk_size);
+	SET_FIELD(hugepages);
+
+#undef SET_FIELD
+
+	/* Do not remove this statement, you should always update this statement when you adding a new field,
+	 * and do not forget to add the SET_FIELD statement for your added field. */
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_thread_arena_opts) == 13, "Incorrect size");
+}
+
 struct spdk_thread *
 spdk_thread_create(const char *name, const struct spdk_cpuset *cpumask)
 {
@@ -533,8 +1055,9 @@ spdk_thread_create(const char *name, const struct spdk_cpuset *cpumask)
 	}
 
 	RB_INIT(&thread->io_channels);
+	thread_arena_init(&thread->arena);
 	TAILQ_INIT(&thread->active_pollers);
-	RB_INIT(&thread->timed_pollers);
+	poller_wheel_init(&thread->timed_pollers);
 	TAILQ_INIT(&thread->paused_pollers);
 	SLIST_INIT(&thread->msg_cache);
 	thread->msg_cache_count = 0;
@@ -545,13 +1068,12 @@ spdk_thread_create(const char *name, const struct spdk_cpuset *cpumask)
 	 * ID exceeds UINT64_MAX a warning message is logged
 	 */
 	thread->next_poller_id = 1;
+	/* The thread's pollers haven't been reported yet */
+	thread->pollers_gen = UINT64_MAX;
 
-	thread->messages = spdk_ring_create(SPDK_RING_TYPE_MP_SC, 65536, SPDK_ENV_NUMA_ID_ANY);
-	if (!thread->messages) {
-		SPDK_ERRLOG("Unable to allocate memory for message ring\n");
-		free(thread);
-		return NULL;
-	}
+	thread->msg_stub.next = NULL;
+	thread->msg_head = &thread->msg_stub;
+	thread->msg_tail = &thread->msg_stub;
 
 	/* Fill the local message pool cache. */
 	rc = spdk_mempool_get_bulk(g_spdk_msg_mempool, (void **)msgs, SPDK_MSG_MEMPOOL_CACHE_SIZE);
@@ -654,10 +1176,63 @@ spdk_set_thread(struct spdk_thread *thread)
 	tls_thread = thread;
 }
 
+static inline void
+msg_queue_push(struct spdk_thread *thread, struct spdk_msg *first, struct spdk_msg *last)
+{
+	struct spdk_msg *prev;
+
+	__atomic_store_n(&last->next, NULL, __ATOMIC_RELAXED);
+	prev = __atomic_exchange_n(&thread->msg_tail, last, __ATOMIC_ACQ_REL);
+	/* Until this store, the consumer sees the queue as ending at prev */
+	__atomic_store_n(&prev->next, first, __ATOMIC_RELEASE);
+}
+
+static inline struct spdk_msg *
+msg_queue_pop(struct spdk_thread *thread)
+{
+	struct spdk_msg *head = thread->msg_head;
+	struct spdk_msg *next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+
+	if (head == &thread->msg_stub) {
+		if (next == NULL) {
+			return NULL;
+		}
+		thread->msg_head = head = next;
+		next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+	}
+
+	if (next != NULL) {
+		thread->msg_head = next;
+		return head;
+	}
+
+	if (head != __atomic_load_n(&thread->msg_tail, __ATOMIC_ACQUIRE)) {
+		/* A producer has swapped the tail, but hasn't linked its messages yet */
+		return NULL;
+	}
+
+	/* head is the last message, put the stub behind it, so it can be removed */
+	msg_queue_push(thread, &thread->msg_stub, &thread->msg_stub);
+	next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+	if (next != NULL) {
+		thread->msg_head = next;
+		return head;
+	}
+
+	return NULL;
+}
+
+static inline bool
+msg_queue_is_empty(const struct spdk_thread *thread)
+{
+	return __atomic_load_n(&thread->msg_head, __ATOMIC_RELAXED) == &thread->msg_stub &&
+	       __atomic_load_n(&thread->msg_tail, __ATOMIC_ACQUIRE) == &thread->msg_stub;
+}
+
 static void
 thread_exit(struct spdk_thread *thread, uint64_t now)
 {
-	struct spdk_poller *poller;
+	struct spdk_poller *poller, *ptmp;
 	struct spdk_io_channel *ch;
 
 	if (now >= thread->exit_timeout_tsc) {
@@ -666,7 +1241,9 @@ thread_exit(struct spdk_thread *thread, uint64_t now)
 		goto exited;
 	}
 
-	if (spdk_ring_count(thread->messages) > 0) {
+	/* Check the staged messages first, they're counted until they are in the queue */
+	if (__atomic_load_n(&thread->num_staged, __ATOMIC_ACQUIRE) > 0 ||
+	    !msg_queue_is_empty(thread)) {
 		SPDK_INFOLOG(thread, "thread %s still has messages\n", thread->name);
 		return;
 	}
@@ -686,7 +1263,7 @@ thread_exit(struct spdk_thread *thread, uint64_t now)
 		}
 	}
 
-	RB_FOREACH(poller, timed_pollers_tree, &thread->timed_pollers) {
+	POLLER_WHEEL_FOREACH_SAFE(poller, &thread->timed_pollers, ptmp) {
 		if (poller->state != SPDK_POLLER_STATE_UNREGISTERED) {
 			SPDK_INFOLOG(thread,
 				     "thread %s still has active timed poller %s\n",
@@ -841,42 +1418,23 @@ spdk_thread_get_from_ctx(void *ctx)
 static inline uint32_t
 msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 {
-	unsigned count, i;
-	void *messages[SPDK_MSG_BATCH_SIZE];
+	unsigned count;
+	struct spdk_msg *msg;
 	uint64_t notify = 1;
 	int rc;
 
-#ifdef DEBUG
-	/*
-	 * spdk_ring_dequeue() fills messages and returns how many entries it wrote,
-	 * so we will never actually read uninitialized data from events, but just to be sure
-	 * (and to silence a static analyzer false positive), initialize the array to NULL pointers.
-	 */
-	memset(messages, 0, sizeof(messages));
-#endif
-
 	if (max_msgs > 0) {
 		max_msgs = spdk_min(max_msgs, SPDK_MSG_BATCH_SIZE);
 	} else {
 		max_msgs = SPDK_MSG_BATCH_SIZE;
 	}
 
-	count = spdk_ring_dequeue(thread->messages, messages, max_msgs);
-	if (spdk_unlikely(thread->in_interrupt) &&
-	    spdk_ring_count(thread->messages) != 0) {
-		rc = write(thread->msg_fd, &notify, sizeof(notify));
-		if (rc < 0) {
-			SPDK_ERRLOG("failed to notify msg_queue: %s.\n", spdk_strerror(errno));
+	/* Messages the handlers send to this thread are staged, so they aren't picked up here */
+	for (count = 0; count < max_msgs; count++) {
+		msg = msg_queue_pop(thread);
+		if (msg == NULL) {
+			break;
 		}
-	}
-	if (count == 0) {
-		return 0;
-	}
-
-	for (i = 0; i < count; i++) {
-		struct spdk_msg *msg = messages[i];
-
-		assert(msg != NULL);
 
 		SPDK_DTRACE_PROBE2(msg_exec, msg->fn, msg->arg);
 
@@ -894,26 +1452,25 @@ msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 		}
 	}
 
+	if (spdk_unlikely(thread->in_interrupt) && !msg_queue_is_empty(thread)) {
+		rc = write(thread->msg_fd, &notify, sizeof(notify));
+		if (rc < 0) {
+			SPDK_ERRLOG("failed to notify msg_queue: %s.\n", spdk_strerror(errno));
+		}
+	}
+
 	return count;
 }
 
 static void
 poller_insert_timer(struct spdk_thread *thread, struct spdk_poller *poller, uint64_t now)
 {
-	struct spdk_poller *tmp __attribute__((unused));
-
 	poller->next_run_tick = now + poller->period_ticks;
 
-	/*
-	 * Insert poller in the thread's timed_pollers tree by next scheduled run time
-	 * as its key.
-	 */
-	tmp = RB_INSERT(timed_pollers_tree, &thread->timed_pollers, poller);
-	assert(tmp == NULL);
+	poller_wheel_place(&thread->timed_pollers, poller);
 
 	/* Update the cache only if it is empty or the inserted poller is earlier than it.
-	 * RB_MIN() is not necessary here because all pollers, which has exactly the same
-	 * next_run_tick as the existing poller, are inserted on the right side.
+	 * Pollers with exactly the same next_run_tick as the cached one run after it.
 	 */
 	if (thread->first_timed_poller == NULL ||
 	    poller->next_run_tick < thread->first_timed_poller->next_run_tick) {
@@ -924,16 +1481,10 @@ poller_insert_timer(struct spdk_thread *thread, struct spdk_poller *poller, uint
 static inline void
 poller_remove_timer(struct spdk_thread *thread, struct spdk_poller *poller)
 {
-	struct spdk_poller *tmp __attribute__((unused));
-
-	tmp = RB_REMOVE(timed_pollers_tree, &thread->timed_pollers, poller);
-	assert(tmp != NULL);
+	poller_wheel_unlink(&thread->timed_pollers, poller);
 
-	/* This function is not used in any case that is performance critical.
-	 * Update the cache simply by RB_MIN() if it needs to be changed.
-	 */
 	if (thread->first_timed_poller == poller) {
-		thread->first_timed_poller = RB_MIN(timed_pollers_tree, &thread->timed_pollers);
+		thread->first_timed_poller = poller_wheel_first(&thread->timed_pollers);
 	}
 }
 
@@ -962,20 +1513,39 @@ thread_update_stats(struct spdk_thread *thread, uint64_t end,
 	thread->tsc_last = end;
 }
 
+static inline void
+poller_update_stats(struct spdk_thread *thread, struct spdk_poller *poller, int rc, uint64_t tsc)
+{
+	poller->stats_gen = thread->stats_gen;
+	poller->run_count++;
+	if (rc > 0) {
+		poller->busy_count++;
+		poller->busy_tsc += tsc;
+	} else {
+		poller->idle_tsc += tsc;
+	}
+
+	if (tsc > poller->max_run_tsc) {
+		poller->max_run_tsc = tsc;
+	}
+}
+
 static inline int
 thread_execute_poller(struct spdk_thread *thread, struct spdk_poller *poller)
 {
+	uint64_t start;
 	int rc;
 
 	switch (poller->state) {
 	case SPDK_POLLER_STATE_UNREGISTERED:
 		TAILQ_REMOVE(&thread->active_pollers, poller, tailq);
-		free(poller);
+		poller_free(poller);
 		return 0;
 	case SPDK_POLLER_STATE_PAUSING:
 		TAILQ_REMOVE(&thread->active_pollers, poller, tailq);
 		TAILQ_INSERT_TAIL(&thread->paused_pollers, poller, tailq);
 		poller->state = SPDK_POLLER_STATE_PAUSED;
+		thread_pollers_changed(thread);
 		return 0;
 	case SPDK_POLLER_STATE_WAITING:
 		break;
@@ -985,15 +1555,12 @@ thread_execute_poller(struct spdk_thread *thread, struct spdk_poller *poller)
 	}
 
 	poller->state = SPDK_POLLER_STATE_RUNNING;
+	start = spdk_get_ticks();
 	rc = poller->fn(poller->arg);
+	poller_update_stats(thread, poller, rc, spdk_get_ticks() - start);
 
 	SPIN_ASSERT(thread->lock_count == 0, SPIN_ERR_HOLD_DURING_SWITCH);
 
-	poller->run_count++;
-	if (rc > 0) {
-		poller->busy_count++;
-	}
-
 #ifdef DEBUG
 	if (rc == -1) {
 		SPDK_DEBUGLOG(thread, "Poller %s returned -1\n", poller->name);
@@ -1003,7 +1570,7 @@ thread_execute_poller(struct spdk_thread *thread, struct spdk_poller *poller)
 	switch (poller->state) {
 	case SPDK_POLLER_STATE_UNREGISTERED:
 		TAILQ_REMOVE(&thread->active_pollers, poller, tailq);
-		free(poller);
+		poller_free(poller);
 		break;
 	case SPDK_POLLER_STATE_PAUSING:
 		TAILQ_REMOVE(&thread->active_pollers, poller, tailq);
@@ -1028,15 +1595,17 @@ static inline int
 thread_execute_timed_poller(struct spdk_thread *thread, struct spdk_poller *poller,
 			    uint64_t now)
 {
+	uint64_t start;
 	int rc;
 
 	switch (poller->state) {
 	case SPDK_POLLER_STATE_UNREGISTERED:
-		free(poller);
+		poller_free(poller);
 		return 0;
 	case SPDK_POLLER_STATE_PAUSING:
 		TAILQ_INSERT_TAIL(&thread->paused_pollers, poller, tailq);
 		poller->state = SPDK_POLLER_STATE_PAUSED;
+		thread_pollers_changed(thread);
 		return 0;
 	case SPDK_POLLER_STATE_WAITING:
 		break;
@@ -1046,15 +1615,12 @@ thread_execute_timed_poller(struct spdk_thread *thread, struct spdk_poller *poll
 	}
 
 	poller->state = SPDK_POLLER_STATE_RUNNING;
+	start = spdk_get_ticks();
 	rc = poller->fn(poller->arg);
+	poller_update_stats(thread, poller, rc, spdk_get_ticks() - start);
 
 	SPIN_ASSERT(thread->lock_count == 0, SPIN_ERR_HOLD_DURING_SWITCH);
 
-	poller->run_count++;
-	if (rc > 0) {
-		poller->busy_count++;
-	}
-
 #ifdef DEBUG
 	if (rc == -1) {
 		SPDK_DEBUGLOG(thread, "Timed poller %s returned -1\n", poller->name);
@@ -1063,7 +1629,7 @@ thread_execute_timed_poller(struct spdk_thread *thread, struct spdk_poller *poll
 
 	switch (poller->state) {
 	case SPDK_POLLER_STATE_UNREGISTERED:
-		free(poller);
+		poller_free(poller);
 		break;
 	case SPDK_POLLER_STATE_PAUSING:
 		TAILQ_INSERT_TAIL(&thread->paused_pollers, poller, tailq);
@@ -1101,16 +1667,26 @@ thread_run_pp_handlers(struct spdk_thread *thread)
 	thread->num_pp_handlers = 0;
 }
 
+static void thread_flush_msgs(struct spdk_thread *thread);
+
 static int
 thread_poll(struct spdk_thread *thread, uint32_t max_msgs, uint64_t now)
 {
 	uint32_t msg_count;
 	struct spdk_poller *poller, *tmp;
 	spdk_msg_fn critical_msg;
+	bool msg_staging;
 	int rc = 0;
 
 	thread->tsc_last = now;
 
+	/* The thread may be polled from one of its own messages or pollers.  Publish what the
+	 * outer poll has staged so far, the nested poll may be waiting for it.
+	 */
+	msg_staging = thread->msg_staging;
+	thread_flush_msgs(thread);
+	thread->msg_staging = true;
+
 	critical_msg = thread->critical_msg;
 	if (spdk_unlikely(critical_msg != NULL)) {
 		critical_msg(NULL);
@@ -1136,33 +1712,27 @@ thread_poll(struct spdk_thread *thread, uint32_t max_msgs, uint64_t now)
 		}
 	}
 
-	poller = thread->first_timed_poller;
-	while (poller != NULL) {
+	while ((poller = thread->first_timed_poller) != NULL) {
 		int timer_rc = 0;
 
 		if (now < poller->next_run_tick) {
 			break;
 		}
 
-		tmp = RB_NEXT(timed_pollers_tree, &thread->timed_pollers, poller);
-		RB_REMOVE(timed_pollers_tree, &thread->timed_pollers, poller);
-
-		/* Update the cache to the next timed poller in the list
-		 * only if the current poller is still the closest, otherwise,
-		 * do nothing because the cache has been already updated.
+		/* Re-arming after the execution only hashes the poller into its slot,
+		 * the cache moves on to the next expiring poller here.
 		 */
-		if (thread->first_timed_poller == poller) {
-			thread->first_timed_poller = tmp;
-		}
+		poller_remove_timer(thread, poller);
 
 		timer_rc = thread_execute_timed_poller(thread, poller, now);
 		if (timer_rc > rc) {
 			rc = timer_rc;
 		}
-
-		poller = tmp;
 	}
 
+	thread_flush_msgs(thread);
+	thread->msg_staging = msg_staging;
+
 	return rc;
 }
 
@@ -1176,16 +1746,20 @@ _thread_remove_pollers(void *ctx)
 				   active_pollers_head, tailq, tmp) {
 		if (poller->state == SPDK_POLLER_STATE_UNREGISTERED) {
 			TAILQ_REMOVE(&thread->active_pollers, poller, tailq);
-			free(poller);
+			poller_free(poller);
 		}
 	}
 
-	RB_FOREACH_SAFE(poller, timed_pollers_tree, &thread->timed_pollers, tmp) {
+	/* Only unlink here.  Looking up the first timed poller moves the wheel and
+	 * respreads upper level slots, which would break the iteration.
+	 */
+	POLLER_WHEEL_FOREACH_SAFE(poller, &thread->timed_pollers, tmp) {
 		if (poller->state == SPDK_POLLER_STATE_UNREGISTERED) {
-			poller_remove_timer(thread, poller);
-			free(poller);
+			poller_wheel_unlink(&thread->timed_pollers, poller);
+			poller_free(poller);
 		}
 	}
+	thread->first_timed_poller = poller_wheel_first(&thread->timed_pollers);
 
 	thread->poller_unregistered = false;
 }
@@ -1265,7 +1839,7 @@ static bool
 thread_has_unpaused_pollers(struct spdk_thread *thread)
 {
 	if (TAILQ_EMPTY(&thread->active_pollers) &&
-	    RB_EMPTY(&thread->timed_pollers)) {
+	    thread->first_timed_poller == NULL) {
 		return false;
 	}
 
@@ -1286,7 +1860,7 @@ spdk_thread_has_pollers(struct spdk_thread *thread)
 bool
 spdk_thread_is_idle(struct spdk_thread *thread)
 {
-	if (spdk_ring_count(thread->messages) ||
+	if (!msg_queue_is_empty(thread) ||
 	    thread_has_unpaused_pollers(thread) ||
 	    thread->critical_msg != NULL) {
 		return false;
@@ -1399,12 +1973,70 @@ thread_send_msg_notification(const struct spdk_thread *target_thread)
 	return 0;
 }
 
+static void
+thread_publish_msgs(struct spdk_msg_stage *stage)
+{
+	msg_queue_push(stage->target, stage->first, stage->last);
+	thread_send_msg_notification(stage->target);
+	__atomic_fetch_sub(&stage->target->num_staged, 1, __ATOMIC_RELEASE);
+}
+
+static void
+thread_flush_msgs(struct spdk_thread *thread)
+{
+	uint8_t i;
+
+	for (i = 0; i < thread->num_msg_stages; i++) {
+		thread_publish_msgs(&thread->msg_stage[i]);
+	}
+
+	thread->num_msg_stages = 0;
+}
+
+/* Returns false if the message couldn't be staged and has to be published right away. */
+static bool
+thread_stage_msg(struct spdk_thread *local_thread, struct spdk_thread *target, struct spdk_msg *msg)
+{
+	struct spdk_msg_stage *stage;
+	uint8_t i;
+
+	for (i = 0; i < local_thread->num_msg_stages; i++) {
+		stage = &local_thread->msg_stage[i];
+		if (stage->target != target) {
+			continue;
+		}
+
+		stage->last->next = msg;
+		stage->last = msg;
+		if (++stage->count == SPDK_MSG_BATCH_SIZE) {
+			/* The target runs at most that many messages per poll anyway */
+			thread_publish_msgs(stage);
+			*stage = local_thread->msg_stage[--local_thread->num_msg_stages];
+		}
+
+		return true;
+	}
+
+	if (local_thread->num_msg_stages == SPDK_MSG_STAGE_TARGETS) {
+		/* No other message for this target is staged, so it doesn't overtake any */
+		return false;
+	}
+
+	/* Keep the target from exiting until the stage is published */
+	__atomic_fetch_add(&target->num_staged, 1, __ATOMIC_RELAXED);
+	stage = &local_thread->msg_stage[local_thread->num_msg_stages++];
+	stage->target = target;
+	stage->first = stage->last = msg;
+	stage->count = 1;
+
+	return true;
+}
+
 int
 spdk_thread_send_msg(const struct spdk_thread *thread, spdk_msg_fn fn, void *ctx)
 {
 	struct spdk_thread *local_thread;
 	struct spdk_msg *msg;
-	int rc;
 
 	assert(thread != NULL);
 
@@ -1436,13 +2068,17 @@ spdk_thread_send_msg(const struct spdk_thread *thread, spdk_msg_fn fn, void *ctx
 	msg->fn = fn;
 	msg->arg = ctx;
 
-	rc = spdk_ring_enqueue(thread->messages, (void **)&msg, 1, NULL);
-	if (rc != 1) {
-		SPDK_ERRLOG("msg could not be enqueued\n");
-		spdk_mempool_put(g_spdk_msg_mempool, msg);
-		return -EIO;
+	/*
+	 * While a thread is being polled, messages it sends are batched and published once the poll
+	 * is done. Otherwise, or if there's no room to stage it, the message is published directly.
+	 */
+	if (local_thread != NULL && local_thread->msg_staging &&
+	    thread_stage_msg(local_thread, (struct spdk_thread *)thread, msg)) {
+		return 0;
 	}
 
+	msg_queue_push((struct spdk_thread *)thread, msg, msg);
+
 	return thread_send_msg_notification(thread);
 }
 
@@ -1695,6 +2331,7 @@ poller_register(spdk_poller_fn fn,
 {
 	struct spdk_thread *thread;
 	struct spdk_poller *poller;
+	bool arena_obj;
 
 	thread = spdk_get_thread();
 	if (!thread) {
@@ -1707,11 +2344,12 @@ poller_register(spdk_poller_fn fn,
 		return NULL;
 	}
 
-	poller = calloc(1, sizeof(*poller));
+	poller = thread_arena_calloc(thread, sizeof(*poller), &arena_obj);
 	if (poller == NULL) {
 		SPDK_ERRLOG("Poller memory allocation failed\n");
 		return NULL;
 	}
+	poller->arena = arena_obj;
 
 	if (name) {
 		snprintf(poller->name, sizeof(poller->name), "%s", name);
@@ -1739,7 +2377,7 @@ poller_register(spdk_poller_fn fn,
 			rc = period_poller_interrupt_init(poller);
 			if (rc < 0) {
 				SPDK_ERRLOG("Failed to register interruptfd for periodic poller: %s\n", spdk_strerror(-rc));
-				free(poller);
+				poller_free(poller);
 				return NULL;
 			}
 
@@ -1753,7 +2391,7 @@ poller_register(spdk_poller_fn fn,
 			rc = busy_poller_interrupt_init(poller);
 			if (rc > 0) {
 				SPDK_ERRLOG("Failed to register interruptfd for busy poller: %s\n", spdk_strerror(-rc));
-				free(poller);
+				poller_free(poller);
 				return NULL;
 			}
 
@@ -1768,6 +2406,7 @@ poller_register(spdk_poller_fn fn,
 	}
 
 	thread_insert_poller(thread, poller);
+	thread_pollers_changed(thread);
 
 	return poller;
 }
@@ -1854,6 +2493,7 @@ spdk_poller_unregister(struct spdk_poller **ppoller)
 	 * in a subsequent call to spdk_thread_poll().
 	 */
 	poller->state = SPDK_POLLER_STATE_UNREGISTERED;
+	thread_pollers_changed(thread);
 }
 
 void
@@ -1885,6 +2525,7 @@ spdk_poller_pause(struct spdk_poller *poller)
 	case SPDK_POLLER_STATE_RUNNING:
 	case SPDK_POLLER_STATE_WAITING:
 		poller->state = SPDK_POLLER_STATE_PAUSING;
+		thread_pollers_changed(thread);
 		break;
 	default:
 		assert(false);
@@ -1921,6 +2562,7 @@ spdk_poller_resume(struct spdk_poller *poller)
 	/* fallthrough */
 	case SPDK_POLLER_STATE_PAUSING:
 		poller->state = SPDK_POLLER_STATE_WAITING;
+		thread_pollers_changed(thread);
 		break;
 	case SPDK_POLLER_STATE_RUNNING:
 	case SPDK_POLLER_STATE_WAITING:
@@ -1973,6 +2615,33 @@ spdk_poller_get_stats(struct spdk_poller *poller, struct spdk_poller_stats *stat
 {
 	stats->run_count = poller->run_count;
 	stats->busy_count = poller->busy_count;
+	stats->busy_tsc = poller->busy_tsc;
+	stats->idle_tsc = poller->idle_tsc;
+	stats->max_run_tsc = poller->max_run_tsc;
+}
+
+bool
+spdk_poller_stats_changed(struct spdk_poller *poller, uint64_t generation)
+{
+	return poller->stats_gen >= generation;
+}
+
+void
+spdk_thread_set_stats_generation(struct spdk_thread *thread, uint64_t generation)
+{
+	/* Concurrent reports may visit the threads in a different order, never go back */
+	thread->stats_gen = spdk_max(thread->stats_gen, generation);
+
+	/* Reports older than this one haven't seen the thread at all */
+	if (thread->pollers_gen == UINT64_MAX) {
+		thread->pollers_gen = generation;
+	}
+}
+
+bool
+spdk_thread_pollers_changed(struct spdk_thread *thread, uint64_t generation)
+{
+	return thread->pollers_gen >= generation;
 }
 
 struct spdk_poller *
@@ -1990,13 +2659,13 @@ spdk_thread_get_next_active_poller(struct spdk_poller *prev)
 struct spdk_poller *
 spdk_thread_get_first_timed_poller(struct spdk_thread *thread)
 {
-	return RB_MIN(timed_pollers_tree, &thread->timed_pollers);
+	return poller_wheel_first_from(&thread->timed_pollers, 0, 0);
 }
 
 struct spdk_poller *
 spdk_thread_get_next_timed_poller(struct spdk_poller *prev)
 {
-	return RB_NEXT(timed_pollers_tree, &thread->timed_pollers, prev);
+	return poller_wheel_next(&prev->thread->timed_pollers, prev);
 }
 
 struct spdk_poller *
@@ -2150,7 +2819,7 @@ spdk_thread_set_interrupt_mode(bool enable_interrupt)
 	}
 
 	/* Set pollers to expected mode */
-	RB_FOREACH_SAFE(poller, timed_pollers_tree, &thread->timed_pollers, tmp) {
+	POLLER_WHEEL_FOREACH_SAFE(poller, &thread->timed_pollers, tmp) {
 		poller_set_interrupt_mode(poller, enable_interrupt);
 	}
 	TAILQ_FOREACH_SAFE(poller, &thread->active_pollers, tailq, tmp) {
@@ -2348,6 +3017,7 @@ spdk_get_io_channel(void *io_device)
 	struct spdk_io_channel *ch;
 	struct spdk_thread *thread;
 	struct io_device *dev;
+	bool arena_obj;
 	int rc;
 
 	pthread_mutex_lock(&g_devlist_mutex);
@@ -2388,12 +3058,13 @@ spdk_get_io_channel(void *io_device)
 		return ch;
 	}
 
-	ch = calloc(1, sizeof(*ch) + dev->ctx_size);
+	ch = thread_arena_calloc(thread, sizeof(*ch) + dev->ctx_size, &arena_obj);
 	if (ch == NULL) {
 		SPDK_ERRLOG("could not calloc spdk_io_channel\n");
 		pthread_mutex_unlock(&g_devlist_mutex);
 		return NULL;
 	}
+	ch->arena = arena_obj;
 
 	ch->dev = dev;
 	ch->destroy_cb = dev->destroy_cb;
@@ -2414,7 +3085,7 @@ spdk_get_io_channel(void *io_device)
 		pthread_mutex_lock(&g_devlist_mutex);
 		RB_REMOVE(io_channel_tree, &ch->thread->io_channels, ch);
 		dev->refcnt--;
-		free(ch);
+		thread_arena_free(thread, ch, sizeof(*ch) + dev->ctx_size, ch->arena);
 		SPDK_ERRLOG("could not create io_channel for io_device %s (%p): %s (rc=%d)\n",
 			    dev->name, io_device, spdk_strerror(-rc), rc);
 		pthread_mutex_unlock(&g_devlist_mutex);
@@ -2429,6 +3100,7 @@ static void
 put_io_channel(void *arg)
 {
 	struct spdk_io_channel *ch = arg;
+	struct io_device *dev = ch->dev;
 	bool do_remove_dev = true;
 	struct spdk_thread *thread;
 
@@ -2476,10 +3148,11 @@ put_io_channel(void *arg)
 
 	pthread_mutex_unlock(&g_devlist_mutex);
 
+	thread_arena_free(thread, ch, sizeof(*ch) + dev->ctx_size, ch->arena);
+
 	if (do_remove_dev) {
-		io_device_free(ch->dev);
+		io_device_free(dev);
 	}
-	free(ch);
 }
 
 void
@@ -2558,6 +3231,11 @@ struct spdk_io_channel_iter {
 
 	struct spdk_thread *orig_thread;
 	spdk_channel_for_each_cpl cpl;
+
+	/* Set for the per-channel iterators of spdk_for_each_channel_parallel() */
+	struct spdk_io_channel_iter *parent;
+	/* Number of per-channel iterators not yet continued, plus one while sending them */
+	uint32_t outstanding;
 };
 
 void *
@@ -2686,6 +3364,126 @@ __pending_unregister(void *arg)
 	spdk_io_device_unregister(dev->io_device, dev->unregister_cb);
 }
 
+static void
+for_each_channel_parallel_put(struct spdk_io_channel_iter *i)
+{
+	struct io_device *dev = i->dev;
+	int rc __attribute__((unused));
+
+	if (__atomic_sub_fetch(&i->outstanding, 1, __ATOMIC_ACQ_REL) != 0) {
+		return;
+	}
+
+	pthread_mutex_lock(&g_devlist_mutex);
+	dev->for_each_count--;
+	if (dev->pending_unregister && dev->for_each_count == 0) {
+		rc = spdk_thread_send_msg(dev->unregister_thread, __pending_unregister, dev);
+		assert(rc == 0);
+	}
+	pthread_mutex_unlock(&g_devlist_mutex);
+
+	rc = spdk_thread_send_msg(i->orig_thread, _call_completion, i);
+	assert(rc == 0);
+}
+
+void
+spdk_for_each_channel_parallel(void *io_device, spdk_channel_msg fn, void *ctx,
+			       spdk_channel_for_each_cpl cpl)
+{
+	struct spdk_thread *thread;
+	struct spdk_io_channel *ch;
+	struct spdk_io_channel_iter *i, *child;
+	int rc __attribute__((unused));
+
+	i = calloc(1, sizeof(*i));
+	if (!i) {
+		SPDK_ERRLOG("Unable to allocate iterator\n");
+		assert(false);
+		return;
+	}
+
+	i->io_device = io_device;
+	i->fn = fn;
+	i->ctx = ctx;
+	i->cpl = cpl;
+	i->orig_thread = _get_thread();
+
+	i->orig_thread->for_each_count++;
+
+	pthread_mutex_lock(&g_devlist_mutex);
+	i->dev = io_device_get(io_device);
+	if (i->dev == NULL) {
+		SPDK_ERRLOG("could not find io_device %p\n", io_device);
+		assert(false);
+		i->status = -ENODEV;
+		goto end;
+	}
+
+	if (i->dev->pending_unregister) {
+		SPDK_ERRLOG("io_device %p has a pending unregister\n", io_device);
+		i->status = -ENODEV;
+		goto end;
+	}
+
+	/* The reference held while sending keeps the channels that are done early from
+	 * completing the whole operation. */
+	i->dev->for_each_count++;
+	i->outstanding = 1;
+
+	TAILQ_FOREACH(thread, &g_threads, tailq) {
+		ch = thread_get_io_channel(thread, i->dev);
+		if (ch == NULL) {
+			continue;
+		}
+
+		child = calloc(1, sizeof(*child));
+		if (child == NULL) {
+			SPDK_ERRLOG("Unable to allocate iterator\n");
+			i->status = -ENOMEM;
+			break;
+		}
+
+		child->io_device = io_device;
+		child->dev = i->dev;
+		child->fn = fn;
+		child->ctx = ctx;
+		child->ch = ch;
+		child->cur_thread = thread;
+		child->orig_thread = i->orig_thread;
+		child->parent = i;
+
+		__atomic_fetch_add(&i->outstanding, 1, __ATOMIC_RELAXED);
+		rc = spdk_thread_send_msg(thread, _call_channel, child);
+		assert(rc == 0);
+	}
+	pthread_mutex_unlock(&g_devlist_mutex);
+
+	for_each_channel_parallel_put(i);
+	return;
+
+end:
+	pthread_mutex_unlock(&g_devlist_mutex);
+
+	rc = spdk_thread_send_msg(i->orig_thread, _call_completion, i);
+	assert(rc == 0);
+}
+
+static void
+for_each_channel_parallel_continue(struct spdk_io_channel_iter *i, int status)
+{
+	struct spdk_io_channel_iter *parent = i->parent;
+	int expected = 0;
+
+	/* Report the first failure, the other channels are visited anyway */
+	if (status != 0) {
+		__atomic_compare_exchange_n(&parent->status, &expected, status, false,
+					    __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+	}
+
+	free(i);
+	for_each_channel_parallel_put(parent);
+}
+
 void
 spdk_for_each_channel_continue(struct spdk_io_channel_iter *i, int status)
 {
@@ -2696,6 +3494,11 @@ spdk_for_each_channel_continue(struct spdk_io_channel_iter *i, int status)
 
 	assert(i->cur_thread == spdk_get_thread());
 
+	if (i->parent != NULL) {
+		for_each_channel_parallel_continue(i, status);
+		return;
+	}
+
 	i->status = status;
 
 	pthread_mutex_lock(&g_devlist_mutex);
@@ -2761,6 +3564,7 @@ thread_interrupt_msg_process(void *arg)
 	struct spdk_thread *orig_thread;
 	uint32_t msg_count;
 	spdk_msg_fn critical_msg;
+	bool msg_staging;
 	int rc = 0;
 	uint64_t notify = 1;
 
@@ -2776,10 +3580,15 @@ thread_interrupt_msg_process(void *arg)
 		rc = 1;
 	}
 
+	msg_staging = thread->msg_staging;
+	thread_flush_msgs(thread);
+	thread->msg_staging = true;
 	msg_count = msg_queue_run_batch(thread, 0);
 	if (msg_count) {
 		rc = 1;
 	}
+	thread_flush_msgs(thread);
+	thread->msg_staging = msg_staging;
 
 	SPIN_ASSERT(thread->lock_count == 0, SPIN_ERR_HOLD_DURING_SWITCH);
 	if (spdk_unlikely(!thread->in_interrupt)) {
@@ -24,8 +24,10 @@ struct spdk_io_channel {
 	uint32_t			destroy_ref;
 	RB_ENTRY(spdk_io_channel)	node;
 	spdk_io_channel_destroy_cb	destroy_cb;
+	/* The channel was allocated from its thread's arena. */
+	bool				arena;
 
-	uint8_t				_padding[40];
+	uint8_t				_padding[39];
 	/*
 	 * Modules will allocate extra memory off the end of this structure
 	 *  to store references to hardware-specific references (i.e. NVMe queue
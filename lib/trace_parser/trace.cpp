@@ -10,30 +10,47 @@
 #include "spdk/util.h"
 #include "spdk/env.h"
 
+#include <algorithm>
 #include <exception>
-#include <map>
 #include <new>
+#include <queue>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/* Entries recorded on a single core, sorted by their tsc */
+struct lcore_entries {
+	lcore_entries(uint16_t _lcore) : lcore(_lcore), pos(0), first_tsc(0) {}
+	uint16_t			lcore;
+	size_t				pos;
+	uint64_t			first_tsc;
+	std::vector<spdk_trace_entry *>	entries;
+};
 
-struct entry_key {
-	entry_key(uint16_t _lcore, uint64_t _tsc) : lcore(_lcore), tsc(_tsc) {}
-	uint16_t lcore;
-	uint64_t tsc;
+/* Next entry of a core in the k-way merge of all cores */
+struct merge_head {
+	merge_head(uint64_t _tsc, uint16_t _lcore, size_t _run) : tsc(_tsc), lcore(_lcore), run(_run) {}
+	uint64_t	tsc;
+	uint16_t	lcore;
+	size_t		run;
 };
 
-class compare_entry_key
+class compare_merge_head
 {
 public:
-	bool operator()(const entry_key &first, const entry_key &second) const
+	/* Entries are ordered by tsc first and lcore second, the top of the heap is the lowest */
+	bool operator()(const merge_head &first, const merge_head &second) const
 	{
 		if (first.tsc == second.tsc) {
-			return first.lcore < second.lcore;
+			return first.lcore > second.lcore;
 		} else {
-			return first.tsc < second.tsc;
+			return first.tsc > second.tsc;
 		}
 	}
 };
 
-typedef std::map<entry_key, spdk_trace_entry *, compare_entry_key> entry_map;
+typedef std::priority_queue<merge_head, std::vector<merge_head>, compare_merge_head> merge_queue;
 
 struct argument_context {
 	spdk_trace_entry	*entry;
@@ -54,10 +71,14 @@ struct argument_context {
 	}
 };
 
+struct object_info {
+	uint64_t	index;
+	uint64_t	start;
+};
+
 struct object_stats {
-	std::map<uint64_t, uint64_t>	index;
-	std::map<uint64_t, uint64_t>	start;
-	uint64_t			counter;
+	std::unordered_map<uint64_t, object_info>	objects;
+	uint64_t					counter;
 
 	object_stats() : counter(0) {}
 };
@@ -71,23 +92,36 @@ struct spdk_trace_parser {
 	uint64_t tsc_offset() const { return _tsc_offset; }
 	bool next_entry(spdk_trace_parser_entry *entry);
 	uint64_t entry_count(uint16_t lcore) const;
+	const spdk_trace_parser_tpoint_stats *tpoint_stats(uint16_t tpoint_id) const;
 private:
 	spdk_trace_entry_buffer *get_next_buffer(spdk_trace_entry_buffer *buf, uint16_t lcore);
 	bool build_arg(argument_context *argctx, const spdk_trace_argument *arg, int argid,
 		       spdk_trace_parser_entry *pe);
-	void populate_events(spdk_trace_history *history, int num_entries, bool overflowed);
+	static void populate_events(spdk_trace_history *history, lcore_entries *run);
+	void populate_all_events(bool overflowed);
 	bool init(const spdk_trace_parser_opts *opts);
 	void cleanup();
 
-	spdk_trace_file		*_trace_file;
-	size_t			_map_size;
-	int			_fd;
-	uint64_t		_tsc_offset;
-	entry_map		_entries;
-	entry_map::iterator	_iter;
-	object_stats		_stats[SPDK_TRACE_MAX_OBJECT];
+	spdk_trace_file			*_trace_file;
+	size_t				_map_size;
+	int				_fd;
+	uint64_t			_tsc_offset;
+	std::vector<lcore_entries>	_runs;
+	merge_queue			_queue;
+	object_stats			_stats[SPDK_TRACE_MAX_OBJECT];
+	spdk_trace_parser_tpoint_stats	_tpoint_stats[SPDK_TRACE_MAX_TPOINT_ID];
 };
 
+const spdk_trace_parser_tpoint_stats *
+spdk_trace_parser::tpoint_stats(uint16_t tpoint_id) const
+{
+	if (tpoint_id >= SPDK_TRACE_MAX_TPOINT_ID) {
+		return NULL;
+	}
+
+	return &_tpoint_stats[tpoint_id];
+}
+
 uint64_t
 spdk_trace_parser::entry_count(uint16_t lcore) const
 {
@@ -162,15 +196,25 @@ spdk_trace_parser::next_entry(spdk_trace_parser_entry *pe)
 {
 	spdk_trace_tpoint *tpoint;
 	spdk_trace_entry *entry;
+	spdk_trace_parser_tpoint_stats *tpstats;
 	object_stats *stats;
-	std::map<uint64_t, uint64_t>::iterator related_kv;
+	lcore_entries *run;
+	std::unordered_map<uint64_t, object_info>::iterator object_kv;
+	uint64_t latency;
 
-	if (_iter == _entries.end()) {
+	if (_queue.empty()) {
 		return false;
 	}
 
-	pe->entry = entry = _iter->second;
-	pe->lcore = _iter->first.lcore;
+	run = &_runs[_queue.top().run];
+	_queue.pop();
+
+	pe->entry = entry = run->entries[run->pos++];
+	pe->lcore = run->lcore;
+	if (run->pos < run->entries.size()) {
+		_queue.emplace(run->entries[run->pos]->tsc, run->lcore, run - &_runs[0]);
+	}
+
 	/* Set related index to the max value to indicate "empty" state */
 	pe->related_index = UINT64_MAX;
 	pe->related_type = OBJECT_NONE;
@@ -178,14 +222,23 @@ spdk_trace_parser::next_entry(spdk_trace_parser_entry *pe)
 	stats = &_stats[tpoint->object_type];
 
 	if (tpoint->new_object) {
-		stats->index[entry->object_id] = stats->counter++;
-		stats->start[entry->object_id] = entry->tsc;
+		stats->objects[entry->object_id] = { stats->counter++, entry->tsc };
 	}
 
 	if (tpoint->object_type != OBJECT_NONE) {
-		if (spdk_likely(stats->start.find(entry->object_id) != stats->start.end())) {
-			pe->object_index = stats->index[entry->object_id];
-			pe->object_start = stats->start[entry->object_id];
+		object_kv = stats->objects.find(entry->object_id);
+		if (spdk_likely(object_kv != stats->objects.end())) {
+			pe->object_index = object_kv->second.index;
+			pe->object_start = object_kv->second.start;
+
+			if (!tpoint->new_object) {
+				tpstats = &_tpoint_stats[entry->tpoint_id];
+				latency = entry->tsc - pe->object_start;
+				tpstats->min_tsc = tpstats->count == 0 ? latency : spdk_min(tpstats->min_tsc, latency);
+				tpstats->max_tsc = spdk_max(tpstats->max_tsc, latency);
+				tpstats->total_tsc += latency;
+				tpstats->count++;
+			}
 		} else {
 			pe->object_index = UINT64_MAX;
 			pe->object_start = UINT64_MAX;
@@ -207,30 +260,29 @@ spdk_trace_parser::next_entry(spdk_trace_parser_entry *pe)
 			break;
 		}
 		stats = &_stats[tpoint->related_objects[i].object_type];
-		related_kv = stats->index.find(reinterpret_cast<uint64_t>
-					       (pe->args[tpoint->related_objects[i].arg_index].u.pointer));
+		object_kv = stats->objects.find(reinterpret_cast<uint64_t>
+						(pe->args[tpoint->related_objects[i].arg_index].u.pointer));
 		/* To avoid parsing the whole array, object index and type are stored
 		 * directly inside spdk_trace_parser_entry. */
-		if (related_kv != stats->index.end()) {
-			pe->related_index = related_kv->second;
+		if (object_kv != stats->objects.end()) {
+			pe->related_index = object_kv->second.index;
 			pe->related_type = tpoint->related_objects[i].object_type;
 			pe->args[tpoint->related_objects[i].arg_index].is_related = true;
 			break;
 		}
 	}
 
-	_iter++;
 	return true;
 }
 
 void
-spdk_trace_parser::populate_events(spdk_trace_history *history, int num_entries, bool overflowed)
+spdk_trace_parser::populate_events(spdk_trace_history *history, lcore_entries *run)
 {
-	int i, num_entries_filled;
+	int i, num_entries, num_entries_filled;
 	spdk_trace_entry *e;
-	int first, last, lcore;
+	int first, last;
 
-	lcore = history->lcore;
+	num_entries = history->num_entries;
 	e = history->entries;
 
 	num_entries_filled = num_entries;
@@ -253,21 +305,13 @@ spdk_trace_parser::populate_events(spdk_trace_history *history, int num_entries,
 		last = num_entries_filled - 1;
 	}
 
-	/*
-	 * We keep track of the highest first TSC out of all reactors iff. any
-	 * have overflowed their circular buffer.
-	 *  We will ignore any events that occurred before this TSC on any
-	 *  other reactors.  This will ensure we only print data for the
-	 *  subset of time where we have data across all reactors.
-	 */
-	if (e[first].tsc > _tsc_offset && overflowed) {
-		_tsc_offset = e[first].tsc;
-	}
+	run->first_tsc = e[first].tsc;
+	run->entries.reserve(num_entries_filled);
 
 	i = first;
 	while (1) {
 		if (e[i].tpoint_id != SPDK_TRACE_MAX_TPOINT_ID) {
-			_entries[entry_key(lcore, e[i].tsc)] = &e[i];
+			run->entries.push_back(&e[i]);
 		}
 		if (i == last) {
 			break;
@@ -277,6 +321,62 @@ spdk_trace_parser::populate_events(spdk_trace_history *history, int num_entries,
 			i = 0;
 		}
 	}
+
+	/* A core records its entries in order, unless they were given an explicit tsc */
+	auto tsc_less = [](const spdk_trace_entry * a, const spdk_trace_entry * b) {
+		return a->tsc < b->tsc;
+	};
+	if (!std::is_sorted(run->entries.begin(), run->entries.end(), tsc_less)) {
+		std::stable_sort(run->entries.begin(), run->entries.end(), tsc_less);
+	}
+}
+
+void
+spdk_trace_parser::populate_all_events(bool overflowed)
+{
+	std::vector<std::thread> threads;
+	size_t num_threads, i;
+
+	/* Each core's history is decoded independently, spread them over the available CPUs */
+	num_threads = spdk_min(std::max(std::thread::hardware_concurrency(), 1u), _runs.size());
+	try {
+		for (i = 1; i < num_threads; i++) {
+			threads.emplace_back([this, i, num_threads]() {
+				for (size_t j = i; j < _runs.size(); j += num_threads) {
+					populate_events(spdk_get_per_lcore_history(_trace_file, _runs[j].lcore),
+							&_runs[j]);
+				}
+			});
+		}
+	} catch (const std::system_error &) {
+		/* Decode whatever the threads that failed to start would have on this one */
+		num_threads = threads.size() + 1;
+	}
+
+	for (i = 0; i < _runs.size(); i += num_threads) {
+		populate_events(spdk_get_per_lcore_history(_trace_file, _runs[i].lcore), &_runs[i]);
+	}
+
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	for (i = 0; i < _runs.size(); i++) {
+		/*
+		 * We keep track of the highest first TSC out of all reactors iff. any
+		 * have overflowed their circular buffer.
+		 *  We will ignore any events that occurred before this TSC on any
+		 *  other reactors.  This will ensure we only print data for the
+		 *  subset of time where we have data across all reactors.
+		 */
+		if (_runs[i].first_tsc > _tsc_offset && overflowed) {
+			_tsc_offset = _runs[i].first_tsc;
+		}
+
+		if (!_runs[i].entries.empty()) {
+			_queue.emplace(_runs[i].entries[0]->tsc, _runs[i].lcore, i);
+		}
+	}
 }
 
 bool
@@ -367,7 +467,7 @@ spdk_trace_parser::init(const spdk_trace_parser_opts *opts)
 			if (history == NULL || history->num_entries == 0 || history->entries[0].tsc == 0) {
 				continue;
 			}
-			populate_events(history, history->num_entries, overflowed);
+			_runs.emplace_back(i);
 		}
 	} else {
 		history = spdk_get_per_lcore_history(_trace_file, opts->lcore);
@@ -377,11 +477,13 @@ spdk_trace_parser::init(const spdk_trace_parser_opts *opts)
 			return false;
 		}
 		if (history->num_entries > 0 && history->entries[0].tsc != 0) {
-			populate_events(history, history->num_entries, false);
+			_runs.emplace_back(opts->lcore);
 		}
+		overflowed = false;
 	}
 
-	_iter = _entries.begin();
+	populate_all_events(overflowed);
+
 	return true;
 }
 
@@ -403,6 +505,8 @@ spdk_trace_parser::spdk_trace_parser(const spdk_trace_parser_opts *opts) :
 	_fd(-1),
 	_tsc_offset(0)
 {
+	memset(_tpoint_stats, 0, sizeof(_tpoint_stats));
+
 	if (!init(opts)) {
 		cleanup();
 		throw std::exception();
@@ -454,3 +558,19 @@ spdk_trace_parser_get_entry_count(const struct spdk_trace_parser *parser, uint16
 {
 	return parser->entry_count(lcore);
 }
+
+int
+spdk_trace_parser_get_tpoint_stats(const struct spdk_trace_parser *parser, uint16_t tpoint_id,
+				   struct spdk_trace_parser_tpoint_stats *stats)
+{
+	const spdk_trace_parser_tpoint_stats *tpstats;
+
+	tpstats = parser->tpoint_stats(tpoint_id);
+	if (tpstats == NULL) {
+		return -EINVAL;
+	}
+
+	*stats = *tpstats;
+
+	return 0;
+}
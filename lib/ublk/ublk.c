@@ -28,7 +28,6 @@
 #define UBLK_IO_MAX_BYTES				SPDK_BDEV_LARGE_BUF_MAX_SIZE
 #define UBLK_DEV_MAX_QUEUES				32
 #define UBLK_DEV_MAX_QUEUE_DEPTH			1024
-#define UBLK_QUEUE_REQUEST				32
 #define UBLK_STOP_BUSY_WAITING_MS			10000
 #define UBLK_BUSY_POLLING_INTERVAL_US			20000
 #define UBLK_DEFAULT_CTRL_URING_POLLING_INTERVAL_US	1000
@@ -51,6 +50,7 @@ struct ublk_queue;
 struct ublk_poll_group;
 struct ublk_io;
 static void _ublk_submit_bdev_io(struct ublk_queue *q, struct ublk_io *io);
+static inline void ublksrv_queue_io_cmd(struct ublk_queue *q, struct ublk_io *io, unsigned tag);
 static void ublk_dev_queue_fini(struct ublk_queue *q);
 static int ublk_poll(void *arg);
 
@@ -81,6 +81,8 @@ struct ublk_io {
 	void			*mpool_entry;
 	bool			need_data;
 	bool			user_copy;
+	/* COMMIT_AND_FETCH is linked to the user copy of READ data */
+	bool			commit_linked;
 	uint16_t		tag;
 	uint64_t		payload_size;
 	uint32_t		cmd_op;
@@ -1154,13 +1156,24 @@ ublk_queue_user_copy(struct ublk_io *io, bool is_write)
 
 	if (is_write) {
 		io_uring_prep_read(sqe, 0, io->payload, nbytes, pos);
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
 	} else {
 		io_uring_prep_write(sqe, 0, io->payload, nbytes, pos);
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE | IOSQE_IO_LINK);
 	}
-	io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
 	io_uring_sqe_set_data64(sqe, build_user_data(io->tag, 0));
 
 	io->user_copy = true;
+	if (!is_write) {
+		/*
+		 * Commit the READ right behind the copy of its data, so that it doesn't have
+		 * to wait for the copy completion and another submission. If the copy fails,
+		 * the kernel cancels the commit and it is sent again with an error.
+		 */
+		ublk_mark_io_done(io, nbytes);
+		ublksrv_queue_io_cmd(q, io, io->tag);
+		io->commit_linked = true;
+	}
 	TAILQ_REMOVE(&q->inflight_io_list, io, tailq);
 	TAILQ_INSERT_TAIL(&q->completed_io_list, io, tailq);
 }
@@ -1402,6 +1415,8 @@ ublk_io_xmit(struct ublk_queue *q)
 				TAILQ_INSERT_TAIL(&buffer_free_list, io, tailq);
 			}
 			ublksrv_queue_io_cmd(q, io, io->tag);
+		} else if (io->commit_linked) {
+			count++;
 		}
 		count++;
 	}
@@ -1479,6 +1494,9 @@ ublk_io_recv(struct ublk_queue *q)
 				ublk_submit_bdev_io(q, io);
 			} else if (cqe->res == UBLK_IO_RES_NEED_GET_DATA) {
 				ublk_io_get_buffer(io, iobuf_ch, write_get_buffer_done);
+			} else if (cqe->res == -ECANCELED && fetch) {
+				/* User copy of the READ data failed, commit the error instead */
+				ublk_io_done(NULL, false, io);
 			} else {
 				if (cqe->res != UBLK_IO_RES_ABORT) {
 					SPDK_ERRLOG("ublk received error io: res %d qid %d tag %u cmd_op %u\n",
@@ -1493,7 +1511,12 @@ ublk_io_recv(struct ublk_queue *q)
 
 			assert((ublksrv_get_op(io->iod) == UBLK_IO_OP_READ) ||
 			       (ublksrv_get_op(io->iod) == UBLK_IO_OP_WRITE));
-			if (cqe->res != io->result) {
+			if (io->commit_linked) {
+				/* The commit is already in flight, the data buffer isn't needed anymore */
+				io->commit_linked = false;
+				TAILQ_REMOVE(&q->inflight_io_list, io, tailq);
+				ublk_io_put_buffer(io, iobuf_ch);
+			} else if (cqe->res != io->result) {
 				/* EIO */
 				ublk_io_done(NULL, false, io);
 			} else {
@@ -1506,7 +1529,7 @@ ublk_io_recv(struct ublk_queue *q)
 			}
 		}
 		count += 1;
-		if (count == UBLK_QUEUE_REQUEST) {
+		if ((uint32_t)count == q->q_depth) {
 			break;
 		}
 	}
@@ -1523,8 +1546,13 @@ ublk_poll(void *arg)
 	int sent, received, count = 0;
 
 	TAILQ_FOREACH_SAFE(q, &poll_group->queue_list, tailq, q_tmp) {
-		sent = ublk_io_xmit(q);
+		/*
+		 * Reap the CQEs first, so that the commits and fetches completed while handling
+		 * them go out in the same io_uring_submit() as the ones completed since the last
+		 * poll.
+		 */
 		received = ublk_io_recv(q);
+		sent = ublk_io_xmit(q);
 		if (spdk_unlikely(q->is_stopping)) {
 			ublk_try_close_queue(q);
 		}
@@ -1599,7 +1627,9 @@ ublk_dev_queue_init(struct ublk_queue *q)
 		q->ios[j].iod = &q->io_cmd_buf[j];
 	}
 
-	rc = ublk_setup_ring(q->q_depth, &q->ring, IORING_SETUP_SQE128);
+	/* With user copy, a READ can have both the copy and the linked commit in flight */
+	rc = ublk_setup_ring(g_ublk_tgt.user_copy ? q->q_depth * 2 : q->q_depth, &q->ring,
+			     IORING_SETUP_SQE128);
 	if (rc < 0) {
 		SPDK_ERRLOG("Failed at setup uring: %s\n", spdk_strerror(-rc));
 		munmap(q->io_cmd_buf, ublk_queue_cmd_buf_sz(q->q_depth));
@@ -16,6 +16,10 @@
 #endif
 #endif
 
+#ifdef __x86_64__
+#include "base64_x86.c"
+#endif
+
 
 #define BASE64_ENC_BITMASK 0x3FUL
 #define BASE64_PADDING_CHAR '='
@@ -87,6 +91,12 @@ base64_encode(char *dst, const char *enc_table, const void *src, size_t src_len)
 #endif
 #endif
 
+#ifdef __x86_64__
+	if (g_base64_encode_x86 != NULL) {
+		g_base64_encode_x86(&dst, enc_table, &src, &src_len);
+	}
+#endif
+
 
 	while (src_len >= 4) {
 		raw_u32 = from_be32(src);
@@ -193,6 +203,12 @@ base64_decode(void *dst, size_t *_dst_len, const uint8_t *dec_table, const char
 	}
 #endif
 
+#ifdef __x86_64__
+	if (g_base64_decode_x86 != NULL) {
+		g_base64_decode_x86(&dst, dec_table, &src_in, &src_strlen);
+	}
+#endif
+
 
 	/* space of dst can be used by to_be32 */
 	while (src_strlen > 4) {
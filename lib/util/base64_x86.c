@@ -0,0 +1,216 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#ifndef __x86_64__
+#error Unsupported hardware
+#endif
+
+#include "spdk/stdinc.h"
+#include <x86intrin.h>
+
+/*
+ * Vectorized kernels based on the algorithms of Wojciech Mula and Daniel Lemire. They only process
+ * whole blocks of input and leave the rest, including any invalid input, to the generic code.
+ *
+ * Encoding
+ * The bytes of every input triplet are arranged as [b1 b0 b2 b1], so that each of the four
+ * sextets can be moved to its own byte with shifts and multiplies (AVX2) or a single
+ * vpmultishiftqb (AVX-512 VBMI). The sextets are then translated to the alphabet either with
+ * a 16-entry table of offsets indexed by range (AVX2) or a 64-byte vpermb lookup (AVX-512 VBMI).
+ *
+ * Decoding
+ * AVX2 translates the characters by range comparisons, which also validates them. AVX-512 VBMI
+ * looks up the lower 128 entries of the scalar decoding table with vpermi2b, so any character
+ * that maps to 255 or is not ASCII sets the top bit of the result. The sextets of each dword are
+ * then merged with multiply-adds and packed to three bytes.
+ */
+
+static void (*g_base64_encode_x86)(char **dst, const char *enc_table, const void **src,
+				   size_t *src_len);
+static void (*g_base64_decode_x86)(void **dst, const uint8_t *dec_table, const uint8_t **src,
+				   size_t *src_len);
+
+__attribute__((target("avx2"))) static inline __m256i
+base64_avx2_enc_sextets(__m256i in)
+{
+	__m256i t0, t1, t2, t3;
+
+	/* Every 32-bit lane holds [b1 b0 b2 b1], extract the four sextets */
+	in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+			1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+	t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+	t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+	t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+	t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+
+	return _mm256_or_si256(t1, t3);
+}
+
+__attribute__((target("avx2"))) static void
+base64_encode_avx2(char **dst, const char *enc_table, const void **src, size_t *src_len)
+{
+	/*
+	 * Offsets from the sextet to its character, indexed by range: 0 for 'a'..'z', 1..10 for the
+	 * digits, 11 and 12 for the last two characters of the alphabet and 13 for 'A'..'Z'.
+	 */
+	const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+				'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+				enc_table[62] - 62, enc_table[63] - 63, 'A', 0, 0,
+				'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+				'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+				enc_table[62] - 62, enc_table[63] - 63, 'A', 0, 0);
+	__m128i lo, hi;
+	__m256i in, sextets, range;
+
+	/* Each iteration loads 16 bytes at offset 12 */
+	while (*src_len >= 28) {
+		lo = _mm_loadu_si128((const __m128i *)*src);
+		hi = _mm_loadu_si128((const __m128i *)((const uint8_t *)*src + 12));
+		in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+		sextets = base64_avx2_enc_sextets(in);
+
+		range = _mm256_subs_epu8(sextets, _mm256_set1_epi8(51));
+		range = _mm256_or_si256(range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), sextets),
+					_mm256_set1_epi8(13)));
+		_mm256_storeu_si256((__m256i *)*dst,
+				    _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), sextets));
+
+		*src = (const uint8_t *)*src + 24;
+		*dst += 32;
+		*src_len -= 24;
+	}
+}
+
+__attribute__((target("avx2"))) static inline __m256i
+base64_avx2_in_range(__m256i str, char first, char last)
+{
+	return _mm256_and_si256(_mm256_cmpgt_epi8(str, _mm256_set1_epi8(first - 1)),
+				_mm256_cmpgt_epi8(_mm256_set1_epi8(last + 1), str));
+}
+
+__attribute__((target("avx2"))) static void
+base64_decode_avx2(void **dst, const uint8_t *dec_table, const uint8_t **src, size_t *src_len)
+{
+	/* The two alphabets only differ in the characters of 62 and 63 */
+	const char c62 = dec_table['+'] == 62 ? '+' : '-';
+	const char c63 = dec_table['/'] == 63 ? '/' : '_';
+	__m256i str, upper, lower, digit, is62, is63, valid, shift, merged;
+
+	/* Leave at least the last two characters to the generic code, it handles the tail */
+	while (*src_len > 32) {
+		str = _mm256_loadu_si256((const __m256i *)*src);
+
+		/* Characters above 127 are negative and can't be in any of the ranges */
+		upper = base64_avx2_in_range(str, 'A', 'Z');
+		lower = base64_avx2_in_range(str, 'a', 'z');
+		digit = base64_avx2_in_range(str, '0', '9');
+		is62 = _mm256_cmpeq_epi8(str, _mm256_set1_epi8(c62));
+		is63 = _mm256_cmpeq_epi8(str, _mm256_set1_epi8(c63));
+
+		valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+					_mm256_or_si256(digit, _mm256_or_si256(is62, is63)));
+		if (_mm256_movemask_epi8(valid) != -1) {
+			/* Let the generic code report the invalid character */
+			break;
+		}
+
+		shift = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+		shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+		shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+		shift = _mm256_or_si256(shift, _mm256_and_si256(is62, _mm256_set1_epi8(62 - c62)));
+		shift = _mm256_or_si256(shift, _mm256_and_si256(is63, _mm256_set1_epi8(63 - c63)));
+		str = _mm256_add_epi8(str, shift);
+
+		/* Merge the four sextets of each dword into 24 bits, big-endian */
+		merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+		merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+		merged = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+					     -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+		_mm_storeu_si128((__m128i *)*dst, _mm256_castsi256_si128(merged));
+		_mm_storel_epi64((__m128i *)((uint8_t *)*dst + 16), _mm256_extracti128_si256(merged, 1));
+
+		*src += 32;
+		*dst = (uint8_t *)*dst + 24;
+		*src_len -= 32;
+	}
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vbmi"))) static void
+base64_encode_avx512vbmi(char **dst, const char *enc_table, const void **src, size_t *src_len)
+{
+	/* Arrange the bytes of every input triplet as [b1 b0 b2 b1] */
+	const __m512i shuffle = _mm512_setr_epi32(0x01020001, 0x04050304, 0x07080607, 0x0a0b090a,
+				0x0d0e0c0d, 0x10110f10, 0x13141213, 0x16171516,
+				0x191a1819, 0x1c1d1b1c, 0x1f201e1f, 0x22232122,
+				0x25262425, 0x28292728, 0x2b2c2a2b, 0x2e2f2d2e);
+	/* Bit offsets of the four sextets in every 32-bit lane */
+	const __m512i shifts = _mm512_set1_epi64(0x3036242a1016040aULL);
+	const __m512i lookup = _mm512_loadu_si512(enc_table);
+	__m512i in;
+
+	/* Each iteration loads 64 bytes and encodes 48 of them */
+	while (*src_len >= 64) {
+		in = _mm512_permutexvar_epi8(shuffle, _mm512_loadu_si512(*src));
+		in = _mm512_multishift_epi64_epi8(shifts, in);
+		_mm512_storeu_si512(*dst, _mm512_permutexvar_epi8(in, lookup));
+
+		*src = (const uint8_t *)*src + 48;
+		*dst += 64;
+		*src_len -= 48;
+	}
+
+	base64_encode_avx2(dst, enc_table, src, src_len);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vbmi"))) static void
+base64_decode_avx512vbmi(void **dst, const uint8_t *dec_table, const uint8_t **src,
+			 size_t *src_len)
+{
+	const __m512i lookup_lo = _mm512_loadu_si512(dec_table);
+	const __m512i lookup_hi = _mm512_loadu_si512(dec_table + 64);
+	/* Bytes 2, 1 and 0 of every dword, in this order */
+	const __m512i pack = _mm512_setr_epi32(0x06000102, 0x090a0405, 0x0c0d0e08, 0x16101112,
+					       0x191a1415, 0x1c1d1e18, 0x26202122, 0x292a2425,
+					       0x2c2d2e28, 0x36303132, 0x393a3435, 0x3c3d3e38,
+					       0, 0, 0, 0);
+	__m512i str, sextets, merged;
+
+	/* Leave at least the last two characters to the generic code, it handles the tail */
+	while (*src_len > 64) {
+		str = _mm512_loadu_si512(*src);
+
+		sextets = _mm512_permutex2var_epi8(lookup_lo, str, lookup_hi);
+		if (_mm512_movepi8_mask(_mm512_or_si512(sextets, str)) != 0) {
+			/* Let the generic code report the invalid character */
+			break;
+		}
+
+		merged = _mm512_maddubs_epi16(sextets, _mm512_set1_epi32(0x01400140));
+		merged = _mm512_madd_epi16(merged, _mm512_set1_epi32(0x00011000));
+		_mm512_mask_storeu_epi8(*dst, 0x0000ffffffffffffULL, _mm512_permutexvar_epi8(pack, merged));
+
+		*src += 64;
+		*dst = (uint8_t *)*dst + 48;
+		*src_len -= 64;
+	}
+
+	base64_decode_avx2(dst, dec_table, src, src_len);
+}
+
+__attribute__((constructor)) static void
+base64_x86_init(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512vbmi") && __builtin_cpu_supports("avx512bw")) {
+		g_base64_encode_x86 = base64_encode_avx512vbmi;
+		g_base64_decode_x86 = base64_decode_avx512vbmi;
+	} else if (__builtin_cpu_supports("avx2")) {
+		g_base64_encode_x86 = base64_encode_avx2;
+		g_base64_decode_x86 = base64_decode_avx2;
+	}
+}
@@ -26,6 +26,68 @@ struct spdk_bit_array {
 	spdk_bit_array_word words[];
 };
 
+/*
+ * Return the index of the first word in [word_index, word_count) that differs from xor_mask,
+ * or the index of a word close to the end of that range if none does. Callers finish the
+ * search word by word, so the kernels only need to skip whole blocks of matching words.
+ */
+static uint32_t
+bit_array_skip_words_basic(const spdk_bit_array_word *words, uint32_t word_index,
+			   uint32_t word_count, spdk_bit_array_word xor_mask)
+{
+	/* No early exit within a block, so that the compiler can vectorize it */
+	while (word_index + 4 <= word_count) {
+		if (((words[word_index] ^ xor_mask) | (words[word_index + 1] ^ xor_mask) |
+		     (words[word_index + 2] ^ xor_mask) | (words[word_index + 3] ^ xor_mask)) != 0) {
+			break;
+		}
+		word_index += 4;
+	}
+
+	return word_index;
+}
+
+#ifdef __x86_64__
+#include <x86intrin.h>
+
+__attribute__((target("avx2"))) static uint32_t
+bit_array_skip_words_avx2(const spdk_bit_array_word *words, uint32_t word_index,
+			  uint32_t word_count, spdk_bit_array_word xor_mask)
+{
+	const __m256i mask = _mm256_set1_epi64x((long long)xor_mask);
+	__m256i w0, w1;
+
+	/* 512 bits per iteration */
+	while (word_index + 8 <= word_count) {
+		w0 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)&words[word_index]), mask);
+		w1 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)&words[word_index + 4]), mask);
+		w0 = _mm256_or_si256(w0, w1);
+		if (!_mm256_testz_si256(w0, w0)) {
+			break;
+		}
+		word_index += 8;
+	}
+
+	return bit_array_skip_words_basic(words, word_index, word_count, xor_mask);
+}
+
+static uint32_t(*g_bit_array_skip_words_fn)(const spdk_bit_array_word *words, uint32_t word_index,
+		uint32_t word_count, spdk_bit_array_word xor_mask) = bit_array_skip_words_basic;
+
+__attribute__((constructor)) static void
+bit_array_init(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		g_bit_array_skip_words_fn = bit_array_skip_words_avx2;
+	}
+}
+
+#define bit_array_skip_words	g_bit_array_skip_words_fn
+#else
+#define bit_array_skip_words	bit_array_skip_words_basic
+#endif
+
 struct spdk_bit_array *
 spdk_bit_array_create(uint32_t num_bits)
 {
@@ -212,6 +274,13 @@ bit_array_find_first(const struct spdk_bit_array *ba, uint32_t start_bit_index,
 	first_word_mask = bit_array_word_mask(first_word_bit_index);
 
 	word = (*cur_word ^ xor_mask) & ~first_word_mask;
+	if (word == 0) {
+		/* Skip long runs of words that don't match in blocks */
+		word_index = bit_array_skip_words(words, word_index + 1, bit_array_word_count(ba->bit_count),
+						  xor_mask);
+		cur_word = &words[word_index];
+		word = *cur_word ^ xor_mask;
+	}
 
 	/*
 	 * spdk_bit_array_resize() guarantees that an extra word with a 1 and a 0 will always be
@@ -261,6 +330,47 @@ spdk_bit_array_find_first_clear(const struct spdk_bit_array *ba, uint32_t start_
 	return bit_index;
 }
 
+static uint32_t
+bit_array_find_first_clear_run(const struct spdk_bit_array *ba, uint32_t start_bit_index,
+			       uint32_t num_bits,
+			       uint32_t (*find_first_clear)(const void *ctx, uint32_t start_bit_index),
+			       const void *ctx)
+{
+	uint32_t first, end;
+
+	if (num_bits == 0) {
+		return UINT32_MAX;
+	}
+
+	while (true) {
+		first = find_first_clear(ctx, start_bit_index);
+		if (first == UINT32_MAX || ba->bit_count - first < num_bits) {
+			return UINT32_MAX;
+		}
+
+		end = spdk_min(bit_array_find_first(ba, first, 0), ba->bit_count);
+		if (end - first >= num_bits) {
+			return first;
+		}
+
+		start_bit_index = end;
+	}
+}
+
+static uint32_t
+bit_array_find_first_clear_cb(const void *ctx, uint32_t start_bit_index)
+{
+	return spdk_bit_array_find_first_clear(ctx, start_bit_index);
+}
+
+uint32_t
+spdk_bit_array_find_first_clear_run(const struct spdk_bit_array *ba, uint32_t start_bit_index,
+				    uint32_t num_bits)
+{
+	return bit_array_find_first_clear_run(ba, start_bit_index, num_bits,
+					      bit_array_find_first_clear_cb, ba);
+}
+
 uint32_t
 spdk_bit_array_count_set(const struct spdk_bit_array *ba)
 {
@@ -337,10 +447,71 @@ spdk_bit_array_clear_mask(struct spdk_bit_array *ba)
 
 struct spdk_bit_pool {
 	struct spdk_bit_array	*array;
+	/*
+	 * One bit per word of array, set when all bits of that word are allocated. It lets the
+	 * searches for free bits skip 64 words of a fully allocated region at a time. Its capacity
+	 * is never smaller than the number of words of array.
+	 */
+	struct spdk_bit_array	*full_words;
 	uint32_t		lowest_free_bit;
 	uint32_t		free_count;
 };
 
+static inline void
+bit_pool_update_full_word(struct spdk_bit_pool *pool, uint32_t word_index)
+{
+	if (pool->array->words[word_index] == ~SPDK_BIT_ARRAY_WORD_C(0)) {
+		spdk_bit_array_set(pool->full_words, word_index);
+	} else {
+		spdk_bit_array_clear(pool->full_words, word_index);
+	}
+}
+
+static void
+bit_pool_init_full_words(struct spdk_bit_pool *pool)
+{
+	uint32_t word_count = bit_array_word_count(pool->array->bit_count);
+	uint32_t i;
+
+	spdk_bit_array_clear_mask(pool->full_words);
+	for (i = 0; i < word_count; i++) {
+		bit_pool_update_full_word(pool, i);
+	}
+}
+
+static uint32_t
+bit_pool_find_first_free(const struct spdk_bit_pool *pool, uint32_t start_bit_index)
+{
+	const struct spdk_bit_array *ba = pool->array;
+	uint32_t word_index, bit_index;
+	spdk_bit_array_word word;
+
+	if (spdk_unlikely(start_bit_index >= ba->bit_count)) {
+		return UINT32_MAX;
+	}
+
+	word_index = start_bit_index >> SPDK_BIT_ARRAY_WORD_INDEX_SHIFT;
+	word = ~ba->words[word_index] &
+	       ~bit_array_word_mask(start_bit_index & SPDK_BIT_ARRAY_WORD_INDEX_MASK);
+	if (word == 0) {
+		word_index = spdk_bit_array_find_first_clear(pool->full_words, word_index + 1);
+		if (word_index >= bit_array_word_count(ba->bit_count)) {
+			return UINT32_MAX;
+		}
+		word = ~ba->words[word_index];
+	}
+
+	bit_index = (word_index << SPDK_BIT_ARRAY_WORD_INDEX_SHIFT) + SPDK_BIT_ARRAY_WORD_TZCNT(word);
+
+	return bit_index < ba->bit_count ? bit_index : UINT32_MAX;
+}
+
+static uint32_t
+bit_pool_find_first_free_cb(const void *ctx, uint32_t start_bit_index)
+{
+	return bit_pool_find_first_free(ctx, start_bit_index);
+}
+
 struct spdk_bit_pool *
 spdk_bit_pool_create(uint32_t num_bits)
 {
@@ -358,6 +529,13 @@ spdk_bit_pool_create(uint32_t num_bits)
 		return NULL;
 	}
 
+	pool->full_words = spdk_bit_array_create(bit_array_word_count(num_bits));
+	if (pool->full_words == NULL) {
+		spdk_bit_array_free(&array);
+		free(pool);
+		return NULL;
+	}
+
 	pool->array = array;
 	pool->lowest_free_bit = 0;
 	pool->free_count = num_bits;
@@ -375,7 +553,14 @@ spdk_bit_pool_create_from_array(struct spdk_bit_array *array)
 		return NULL;
 	}
 
+	pool->full_words = spdk_bit_array_create(bit_array_word_count(array->bit_count));
+	if (pool->full_words == NULL) {
+		free(pool);
+		return NULL;
+	}
+
 	pool->array = array;
+	bit_pool_init_full_words(pool);
 	pool->lowest_free_bit = spdk_bit_array_find_first_clear(array, 0);
 	pool->free_count = spdk_bit_array_count_clear(array);
 
@@ -395,6 +580,7 @@ spdk_bit_pool_free(struct spdk_bit_pool **ppool)
 	*ppool = NULL;
 	if (pool != NULL) {
 		spdk_bit_array_free(&pool->array);
+		spdk_bit_array_free(&pool->full_words);
 		free(pool);
 	}
 }
@@ -403,16 +589,35 @@ int
 spdk_bit_pool_resize(struct spdk_bit_pool **ppool, uint32_t num_bits)
 {
 	struct spdk_bit_pool *pool;
+	uint32_t new_word_count;
 	int rc;
 
 	assert(ppool != NULL);
 
 	pool = *ppool;
+	new_word_count = bit_array_word_count(num_bits);
+
+	/* Keep full_words at least as large as array, even if one of the resizes fails */
+	if (new_word_count > spdk_bit_array_capacity(pool->full_words)) {
+		rc = spdk_bit_array_resize(&pool->full_words, new_word_count);
+		if (rc) {
+			return rc;
+		}
+	}
+
 	rc = spdk_bit_array_resize(&pool->array, num_bits);
 	if (rc) {
 		return rc;
 	}
 
+	if (new_word_count < spdk_bit_array_capacity(pool->full_words)) {
+		rc = spdk_bit_array_resize(&pool->full_words, new_word_count);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	bit_pool_init_full_words(pool);
 	pool->lowest_free_bit = spdk_bit_array_find_first_clear(pool->array, 0);
 	pool->free_count = spdk_bit_array_count_clear(pool->array);
 
@@ -441,17 +646,51 @@ spdk_bit_pool_allocate_bit(struct spdk_bit_pool *pool)
 	}
 
 	spdk_bit_array_set(pool->array, bit_index);
-	pool->lowest_free_bit = spdk_bit_array_find_first_clear(pool->array, bit_index);
+	bit_pool_update_full_word(pool, bit_index >> SPDK_BIT_ARRAY_WORD_INDEX_SHIFT);
+	pool->lowest_free_bit = bit_pool_find_first_free(pool, bit_index);
 	pool->free_count--;
 	return bit_index;
 }
 
+uint32_t
+spdk_bit_pool_allocate_contig_bits(struct spdk_bit_pool *pool, uint32_t num_bits)
+{
+	uint32_t first, i;
+
+	if (num_bits > pool->free_count) {
+		return UINT32_MAX;
+	}
+
+	first = bit_array_find_first_clear_run(pool->array, pool->lowest_free_bit, num_bits,
+					       bit_pool_find_first_free_cb, pool);
+	if (first == UINT32_MAX) {
+		return UINT32_MAX;
+	}
+
+	for (i = first; i < first + num_bits; i++) {
+		spdk_bit_array_set(pool->array, i);
+	}
+
+	for (i = first >> SPDK_BIT_ARRAY_WORD_INDEX_SHIFT;
+	     i <= (first + num_bits - 1) >> SPDK_BIT_ARRAY_WORD_INDEX_SHIFT; i++) {
+		bit_pool_update_full_word(pool, i);
+	}
+
+	if (first == pool->lowest_free_bit) {
+		pool->lowest_free_bit = bit_pool_find_first_free(pool, first + num_bits);
+	}
+	pool->free_count -= num_bits;
+
+	return first;
+}
+
 void
 spdk_bit_pool_free_bit(struct spdk_bit_pool *pool, uint32_t bit_index)
 {
 	assert(spdk_bit_array_get(pool->array, bit_index) == true);
 
 	spdk_bit_array_clear(pool->array, bit_index);
+	spdk_bit_array_clear(pool->full_words, bit_index >> SPDK_BIT_ARRAY_WORD_INDEX_SHIFT);
 	if (pool->lowest_free_bit > bit_index) {
 		pool->lowest_free_bit = bit_index;
 	}
@@ -480,6 +719,7 @@ void
 spdk_bit_pool_load_mask(struct spdk_bit_pool *pool, const void *mask)
 {
 	spdk_bit_array_load_mask(pool->array, mask);
+	bit_pool_init_full_words(pool);
 	pool->lowest_free_bit = spdk_bit_array_find_first_clear(pool->array, 0);
 	pool->free_count = spdk_bit_array_count_clear(pool->array);
 }
@@ -488,6 +728,7 @@ void
 spdk_bit_pool_free_all_bits(struct spdk_bit_pool *pool)
 {
 	spdk_bit_array_clear_mask(pool->array);
+	spdk_bit_array_clear_mask(pool->full_words);
 	pool->lowest_free_bit = 0;
 	pool->free_count = spdk_bit_array_capacity(pool->array);
 }
@@ -6,6 +6,7 @@
 #include "util_internal.h"
 #include "crc_internal.h"
 #include "spdk/crc32.h"
+#include "spdk/endian.h"
 
 void
 crc32_table_init(struct spdk_crc32_table *table, uint32_t polynomial_reflect)
@@ -22,7 +23,15 @@ crc32_table_init(struct spdk_crc32_table *table, uint32_t polynomial_reflect)
 				val = (val >> 1);
 			}
 		}
-		table->table[i] = val;
+		table->table[0][i] = val;
+	}
+
+	for (i = 0; i < 256; i++) {
+		val = table->table[0][i];
+		for (j = 1; j < SPDK_CRC32_TABLE_SLICES; j++) {
+			val = (val >> 8) ^ table->table[0][val & 0xff];
+			table->table[j][i] = val;
+		}
 	}
 }
 
@@ -67,10 +76,26 @@ uint32_t
 crc32_update(const struct spdk_crc32_table *table, const void *buf, size_t len, uint32_t crc)
 {
 	const uint8_t *buf_u8 = buf;
-	size_t i;
+	uint32_t lo, hi;
+
+	/* Slicing-by-8: fold 8 bytes per iteration using the precomputed shifted tables */
+	while (len >= SPDK_CRC32_TABLE_SLICES) {
+		lo = crc ^ from_le32(buf_u8);
+		hi = from_le32(buf_u8 + 4);
+		crc = table->table[7][lo & 0xff] ^
+		      table->table[6][(lo >> 8) & 0xff] ^
+		      table->table[5][(lo >> 16) & 0xff] ^
+		      table->table[4][lo >> 24] ^
+		      table->table[3][hi & 0xff] ^
+		      table->table[2][(hi >> 8) & 0xff] ^
+		      table->table[1][(hi >> 16) & 0xff] ^
+		      table->table[0][hi >> 24];
+		buf_u8 += SPDK_CRC32_TABLE_SLICES;
+		len -= SPDK_CRC32_TABLE_SLICES;
+	}
 
-	for (i = 0; i < len; i++) {
-		crc = (crc >> 8) ^ table->table[(crc ^ buf_u8[i]) & 0xff];
+	while (len--) {
+		crc = (crc >> 8) ^ table->table[0][(crc ^ *buf_u8++) & 0xff];
 	}
 
 	return crc;
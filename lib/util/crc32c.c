@@ -6,6 +6,7 @@
 #include "util_internal.h"
 #include "crc_internal.h"
 #include "spdk/crc32.h"
+#include "spdk/util.h"
 
 #ifdef SPDK_HAVE_ISAL
 
@@ -15,21 +16,42 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 	return crc32_iscsi((unsigned char *)buf, len, crc);
 }
 
-#elif defined(SPDK_HAVE_SSE4_2)
+#elif defined(SPDK_HAVE_SSE4_2) || defined(SPDK_HAVE_SSE4_2_DISPATCH)
 
-uint32_t
-spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
+/*
+ * Buffers of at least three lanes are checksummed as three independent streams, so that the
+ * CRC32 instruction latency is hidden.  The lane CRCs are then combined by shifting them
+ * over the lane length with a precomputed table.
+ */
+#define CRC32C_LANE_SIZE	1024
+#define CRC32C_LANE_WORDS	(CRC32C_LANE_SIZE / sizeof(uint64_t))
+
+static struct spdk_crc32_table g_crc32c_table;
+static uint32_t g_crc32c_lane_shift[4][256];
+
+static inline uint32_t
+crc32c_lane_shift(uint32_t crc)
 {
-	size_t count_pre, count_post, count_mid;
+	return g_crc32c_lane_shift[0][crc & 0xff] ^
+	       g_crc32c_lane_shift[1][(crc >> 8) & 0xff] ^
+	       g_crc32c_lane_shift[2][(crc >> 16) & 0xff] ^
+	       g_crc32c_lane_shift[3][crc >> 24];
+}
+
+__attribute__((target("sse4.2"))) static uint32_t
+crc32c_update_sse4_2(const void *buf, size_t len, uint32_t crc)
+{
+	size_t count_pre, count_post, count_mid, i;
 	const uint64_t *dword_buf;
-	uint64_t crc_tmp64;
+	uint64_t crc_tmp64, crc1, crc2;
 
 	/* process the head and tail bytes separately to make the buf address
 	 * passed to _mm_crc32_u64 is 8 byte aligned. This can avoid unaligned loads.
 	 */
 	count_pre = ((uint64_t)buf & 7) == 0 ? 0 : 8 - ((uint64_t)buf & 7);
-	count_post = (uint64_t)((uintptr_t)buf + len) & 7;
-	count_mid = (len - count_pre - count_post) / 8;
+	count_pre = spdk_min(count_pre, len);
+	count_mid = (len - count_pre) / 8;
+	count_post = (len - count_pre) & 7;
 
 	while (count_pre--) {
 		crc = _mm_crc32_u8(crc, *(const uint8_t *)buf);
@@ -40,6 +62,20 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 	crc_tmp64 = crc;
 	dword_buf = (const uint64_t *)buf;
 
+	while (count_mid >= 3 * CRC32C_LANE_WORDS) {
+		crc1 = 0;
+		crc2 = 0;
+		for (i = 0; i < CRC32C_LANE_WORDS; i++) {
+			crc_tmp64 = _mm_crc32_u64(crc_tmp64, dword_buf[i]);
+			crc1 = _mm_crc32_u64(crc1, dword_buf[i + CRC32C_LANE_WORDS]);
+			crc2 = _mm_crc32_u64(crc2, dword_buf[i + 2 * CRC32C_LANE_WORDS]);
+		}
+		crc_tmp64 = crc32c_lane_shift((uint32_t)crc_tmp64) ^ (uint32_t)crc1;
+		crc_tmp64 = crc32c_lane_shift((uint32_t)crc_tmp64) ^ (uint32_t)crc2;
+		dword_buf += 3 * CRC32C_LANE_WORDS;
+		count_mid -= 3 * CRC32C_LANE_WORDS;
+	}
+
 	while (count_mid--) {
 		crc_tmp64 = _mm_crc32_u64(crc_tmp64, *dword_buf);
 		dword_buf++;
@@ -55,6 +91,60 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 	return crc;
 }
 
+#ifdef SPDK_HAVE_SSE4_2_DISPATCH
+static uint32_t
+crc32c_update_table(const void *buf, size_t len, uint32_t crc)
+{
+	return crc32_update(&g_crc32c_table, buf, len, crc);
+}
+
+static uint32_t (*g_crc32c_update_fn)(const void *buf, size_t len,
+				      uint32_t crc) = crc32c_update_table;
+#endif
+
+__attribute__((constructor)) static void
+crc32c_init(void)
+{
+	uint8_t zeroes[CRC32C_LANE_SIZE] = {};
+	uint32_t basis[32];
+	int i, j, k;
+
+	crc32_table_init(&g_crc32c_table, SPDK_CRC32C_POLYNOMIAL_REFLECT);
+
+	/* Advancing a CRC over a run of zeroes is linear, build the shift table from its basis */
+	for (i = 0; i < 32; i++) {
+		basis[i] = crc32_update(&g_crc32c_table, zeroes, sizeof(zeroes), 1U << i);
+	}
+
+	for (i = 0; i < 4; i++) {
+		for (j = 0; j < 256; j++) {
+			g_crc32c_lane_shift[i][j] = 0;
+			for (k = 0; k < 8; k++) {
+				if (j & (1 << k)) {
+					g_crc32c_lane_shift[i][j] ^= basis[i * 8 + k];
+				}
+			}
+		}
+	}
+
+#ifdef SPDK_HAVE_SSE4_2_DISPATCH
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse4.2")) {
+		g_crc32c_update_fn = crc32c_update_sse4_2;
+	}
+#endif
+}
+
+uint32_t
+spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
+{
+#ifdef SPDK_HAVE_SSE4_2_DISPATCH
+	return g_crc32c_update_fn(buf, len, crc);
+#else
+	return crc32c_update_sse4_2(buf, len, crc);
+#endif
+}
+
 #elif defined(SPDK_HAVE_ARM_CRC)
 
 uint32_t
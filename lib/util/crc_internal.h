@@ -17,6 +17,10 @@
 #elif defined(__x86_64__) && defined(__SSE4_2__)
 #define SPDK_HAVE_SSE4_2
 #include <x86intrin.h>
+#elif defined(__x86_64__)
+/* Not built for SSE 4.2, but the CRC32 instruction can still be used if the CPU has it */
+#define SPDK_HAVE_SSE4_2_DISPATCH
+#include <x86intrin.h>
 #endif
 
 #endif /* SPDK_CRC_INTERNAL_H */
@@ -717,13 +717,69 @@ _dif_generate(void *_dif, uint64_t guard, uint32_t offset_blocks,
 	}
 }
 
+/*
+ * DIF fields that stay the same for all the blocks of a request, prepared once so that
+ * the per block work of generate and verify is computing the guard and, for type 1 and 2,
+ * the reference tag. Verify compares the whole DIF with expected one word at a time and
+ * only goes through the field by field checks, which also report the error, on a mismatch.
+ */
+struct _dif_tmpl {
+	/* Expected DIF, with the guard and the reference tag of the first block */
+	struct spdk_dif	dif;
+	/* Bits of the DIF that are checked */
+	struct spdk_dif	mask;
+	/* The reference tag increments with the block */
+	bool		inc_ref_tag;
+};
+
+static void
+_dif_tmpl_init_generate(struct _dif_tmpl *tmpl, const struct spdk_dif_ctx *ctx)
+{
+	memset(tmpl, 0, sizeof(*tmpl));
+
+	/* The guard isn't known yet, and the reference tag is handled the same way as in
+	 * _dif_generate().
+	 */
+	_dif_generate(&tmpl->dif, 0, 0, ctx);
+
+	tmpl->inc_ref_tag = (ctx->dif_flags & SPDK_DIF_FLAGS_REFTAG_CHECK) &&
+			    ctx->dif_type != SPDK_DIF_TYPE3 &&
+			    ctx->init_ref_tag != SPDK_DIF_REFTAG_IGNORE;
+}
+
+static inline void
+_dif_tmpl_generate(void *_dif, const struct _dif_tmpl *tmpl, uint64_t guard,
+		   uint32_t offset_blocks, const struct spdk_dif_ctx *ctx)
+{
+	struct spdk_dif dif = tmpl->dif;
+	uint8_t reftag_offset = _dif_reftag_offset(ctx->dif_pi_format);
+
+	if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
+		_dif_set_guard(&dif, guard, ctx->dif_pi_format);
+	}
+	if (tmpl->inc_ref_tag) {
+		_dif_set_reftag(&dif, ctx->init_ref_tag + ctx->ref_tag_offset + offset_blocks,
+				ctx->dif_pi_format);
+	}
+
+	/* Leave the storage tag space before the reference tag of the 32b guard format alone,
+	 * as _dif_generate() does.
+	 */
+	memcpy(_dif, &dif, _dif_apptag_offset(ctx->dif_pi_format) + _dif_apptag_size());
+	memcpy((uint8_t *)_dif + reftag_offset, (uint8_t *)&dif + reftag_offset,
+	       _dif_reftag_size(ctx->dif_pi_format));
+}
+
 static void
 dif_generate(struct _dif_sgl *sgl, uint32_t num_blocks, const struct spdk_dif_ctx *ctx)
 {
+	struct _dif_tmpl tmpl;
 	uint32_t offset_blocks;
 	uint8_t *buf;
 	uint64_t guard = 0;
 
+	_dif_tmpl_init_generate(&tmpl, ctx);
+
 	for (offset_blocks = 0; offset_blocks < num_blocks; offset_blocks++) {
 		_dif_sgl_get_buf(sgl, &buf, NULL);
 
@@ -731,7 +787,7 @@ dif_generate(struct _dif_sgl *sgl, uint32_t num_blocks, const struct spdk_dif_ct
 			guard = _dif_generate_guard(ctx->guard_seed, buf, ctx->guard_interval, ctx->dif_pi_format);
 		}
 
-		_dif_generate(buf + ctx->guard_interval, guard, offset_blocks, ctx);
+		_dif_tmpl_generate(buf + ctx->guard_interval, &tmpl, guard, offset_blocks, ctx);
 
 		_dif_sgl_advance(sgl, ctx->block_size);
 	}
@@ -948,15 +1004,74 @@ _dif_verify(void *_dif, uint64_t guard, uint32_t offset_blocks,
 	return 0;
 }
 
+static void
+_dif_tmpl_init_verify(struct _dif_tmpl *tmpl, const struct spdk_dif_ctx *ctx)
+{
+	memset(tmpl, 0, sizeof(*tmpl));
+
+	if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
+		_dif_set_guard(&tmpl->mask, UINT64_MAX, ctx->dif_pi_format);
+	}
+
+	if (ctx->dif_flags & SPDK_DIF_FLAGS_APPTAG_CHECK) {
+		_dif_set_apptag(&tmpl->mask, ctx->apptag_mask, ctx->dif_pi_format);
+		_dif_set_apptag(&tmpl->dif, ctx->app_tag & ctx->apptag_mask, ctx->dif_pi_format);
+	}
+
+	/* Same as _dif_reftag_check(), truncated to the reference tag of the PI format */
+	if ((ctx->dif_flags & SPDK_DIF_FLAGS_REFTAG_CHECK) &&
+	    (ctx->dif_type == SPDK_DIF_TYPE1 || ctx->dif_type == SPDK_DIF_TYPE2)) {
+		_dif_set_reftag(&tmpl->mask, UINT64_MAX, ctx->dif_pi_format);
+		tmpl->inc_ref_tag = true;
+	}
+}
+
+static inline int
+_dif_tmpl_verify(void *_dif, const struct _dif_tmpl *tmpl, uint64_t guard,
+		 uint32_t offset_blocks, const struct spdk_dif_ctx *ctx,
+		 struct spdk_dif_error *err_blk)
+{
+	struct spdk_dif expected = tmpl->dif;
+	uint64_t words[2], mask[2], exp[2];
+	size_t size = _dif_size(ctx->dif_pi_format);
+
+	SPDK_STATIC_ASSERT(sizeof(words) == sizeof(struct spdk_dif), "Incorrect size");
+
+	if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
+		_dif_set_guard(&expected, guard, ctx->dif_pi_format);
+	}
+	if (tmpl->inc_ref_tag) {
+		_dif_set_reftag(&expected, ctx->init_ref_tag + ctx->ref_tag_offset + offset_blocks,
+				ctx->dif_pi_format);
+	}
+
+	memcpy(mask, &tmpl->mask, sizeof(mask));
+	memcpy(exp, &expected, sizeof(exp));
+	memcpy(words, _dif, size);
+	if (size == sizeof(uint64_t)) {
+		words[1] = exp[1] = 0;
+	}
+
+	if ((words[0] & mask[0]) == exp[0] && (words[1] & mask[1]) == exp[1]) {
+		return 0;
+	}
+
+	/* Blocks with the checks disabled by the tags, or an error to be reported */
+	return _dif_verify(_dif, guard, offset_blocks, ctx, err_blk);
+}
+
 static int
 dif_verify(struct _dif_sgl *sgl, uint32_t num_blocks,
 	   const struct spdk_dif_ctx *ctx, struct spdk_dif_error *err_blk)
 {
+	struct _dif_tmpl tmpl;
 	uint32_t offset_blocks;
 	int rc;
 	uint8_t *buf;
 	uint64_t guard = 0;
 
+	_dif_tmpl_init_verify(&tmpl, ctx);
+
 	for (offset_blocks = 0; offset_blocks < num_blocks; offset_blocks++) {
 		_dif_sgl_get_buf(sgl, &buf, NULL);
 
@@ -964,7 +1079,8 @@ dif_verify(struct _dif_sgl *sgl, uint32_t num_blocks,
 			guard = _dif_generate_guard(ctx->guard_seed, buf, ctx->guard_interval, ctx->dif_pi_format);
 		}
 
-		rc = _dif_verify(buf + ctx->guard_interval, guard, offset_blocks, ctx, err_blk);
+		rc = _dif_tmpl_verify(buf + ctx->guard_interval, &tmpl, guard, offset_blocks, ctx,
+				      err_blk);
 		if (rc != 0) {
 			return rc;
 		}
@@ -1859,10 +1975,13 @@ static void
 dix_generate(struct _dif_sgl *data_sgl, struct _dif_sgl *md_sgl,
 	     uint32_t num_blocks, const struct spdk_dif_ctx *ctx)
 {
+	struct _dif_tmpl tmpl;
 	uint32_t offset_blocks = 0;
 	uint8_t *data_buf, *md_buf;
 	uint64_t guard;
 
+	_dif_tmpl_init_generate(&tmpl, ctx);
+
 	while (offset_blocks < num_blocks) {
 		_dif_sgl_get_buf(data_sgl, &data_buf, NULL);
 		_dif_sgl_get_buf(md_sgl, &md_buf, NULL);
@@ -1875,7 +1994,7 @@ dix_generate(struct _dif_sgl *data_sgl, struct _dif_sgl *md_sgl,
 						    ctx->dif_pi_format);
 		}
 
-		_dif_generate(md_buf + ctx->guard_interval, guard, offset_blocks, ctx);
+		_dif_tmpl_generate(md_buf + ctx->guard_interval, &tmpl, guard, offset_blocks, ctx);
 
 		_dif_sgl_advance(data_sgl, ctx->block_size);
 		_dif_sgl_advance(md_sgl, ctx->md_size);
@@ -1965,11 +2084,14 @@ dix_verify(struct _dif_sgl *data_sgl, struct _dif_sgl *md_sgl,
 	   uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
 	   struct spdk_dif_error *err_blk)
 {
+	struct _dif_tmpl tmpl;
 	uint32_t offset_blocks = 0;
 	uint8_t *data_buf, *md_buf;
 	uint64_t guard;
 	int rc;
 
+	_dif_tmpl_init_verify(&tmpl, ctx);
+
 	while (offset_blocks < num_blocks) {
 		_dif_sgl_get_buf(data_sgl, &data_buf, NULL);
 		_dif_sgl_get_buf(md_sgl, &md_buf, NULL);
@@ -1982,7 +2104,8 @@ dix_verify(struct _dif_sgl *data_sgl, struct _dif_sgl *md_sgl,
 						    ctx->dif_pi_format);
 		}
 
-		rc = _dif_verify(md_buf + ctx->guard_interval, guard, offset_blocks, ctx, err_blk);
+		rc = _dif_tmpl_verify(md_buf + ctx->guard_interval, &tmpl, guard, offset_blocks,
+				      ctx, err_blk);
 		if (rc != 0) {
 			return rc;
 		}
@@ -0,0 +1,219 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/gf.h"
+#include "spdk/config.h"
+#include "spdk/util.h"
+
+/* maximum number of source buffers */
+#define SPDK_GF_MAX_SRC	256
+
+/* x^8 + x^4 + x^3 + x^2 + 1 */
+#define GF_POLY		0x11d
+
+static uint8_t g_gf_exp[2 * 255];
+static uint8_t g_gf_log[256];
+
+__attribute__((constructor)) static void
+gf_init_tables(void)
+{
+	uint32_t x = 1;
+	uint32_t i;
+
+	for (i = 0; i < 255; i++) {
+		g_gf_exp[i] = x;
+		g_gf_exp[i + 255] = x;
+		g_gf_log[x] = i;
+		x <<= 1;
+		if (x & 0x100) {
+			x ^= GF_POLY;
+		}
+	}
+}
+
+uint8_t
+spdk_gf_mul(uint8_t a, uint8_t b)
+{
+	if (a == 0 || b == 0) {
+		return 0;
+	}
+
+	return g_gf_exp[g_gf_log[a] + g_gf_log[b]];
+}
+
+uint8_t
+spdk_gf_inv(uint8_t a)
+{
+	if (a == 0) {
+		return 0;
+	}
+
+	return g_gf_exp[255 - g_gf_log[a]];
+}
+
+uint8_t
+spdk_gf_pow2(uint32_t n)
+{
+	return g_gf_exp[n % 255];
+}
+
+#ifdef SPDK_CONFIG_ISAL
+#include "isa-l/include/erasure_code.h"
+
+static int
+do_gf_dot_prod(void **dests, uint32_t ndests, void **sources, uint32_t n,
+	       const uint8_t *coefs, uint32_t len)
+{
+	uint8_t gftbls[SPDK_GF_DOT_PROD_MAX_DESTS * SPDK_GF_MAX_SRC * 32];
+
+	if (len > INT_MAX) {
+		return -EINVAL;
+	}
+
+	ec_init_tables(n, ndests, (uint8_t *)coefs, gftbls);
+	ec_encode_data(len, n, ndests, gftbls, (uint8_t **)sources, (uint8_t **)dests);
+
+	return 0;
+}
+
+#else
+
+/*
+ * Multiplication by a constant split into lookups of the low and high nibble of the
+ * multiplicand, so that the table fits into a vector register.
+ */
+struct gf_nibble_tbl {
+	uint8_t lo[16];
+	uint8_t hi[16];
+};
+
+static void
+gf_nibble_tbl_init(struct gf_nibble_tbl *tbl, uint8_t c)
+{
+	uint8_t i;
+
+	for (i = 0; i < 16; i++) {
+		tbl->lo[i] = spdk_gf_mul(c, i);
+		tbl->hi[i] = spdk_gf_mul(c, i << 4);
+	}
+}
+
+static void
+gf_dot_prod_basic(void **dests, uint32_t ndests, void **sources, uint32_t n,
+		  const struct gf_nibble_tbl *tbls, uint32_t len)
+{
+	uint32_t i, j, b;
+
+	for (i = 0; i < ndests; i++) {
+		const struct gf_nibble_tbl *row = &tbls[i * n];
+		uint8_t *dest = dests[i];
+
+		for (b = 0; b < len; b++) {
+			uint8_t v = 0;
+
+			for (j = 0; j < n; j++) {
+				uint8_t s = ((uint8_t *)sources[j])[b];
+
+				v ^= row[j].lo[s & 0x0f] ^ row[j].hi[s >> 4];
+			}
+			dest[b] = v;
+		}
+	}
+}
+
+#ifdef __x86_64__
+#include <x86intrin.h>
+
+__attribute__((target("avx2"))) static void
+gf_dot_prod_avx2(void **dests, uint32_t ndests, void **sources, uint32_t n,
+		 const struct gf_nibble_tbl *tbls, uint32_t len)
+{
+	const __m256i mask = _mm256_set1_epi8(0x0f);
+	uint32_t off, i, j, done;
+
+	done = SPDK_ALIGN_FLOOR(len, sizeof(__m256i));
+
+	for (off = 0; off < done; off += sizeof(__m256i)) {
+		for (i = 0; i < ndests; i++) {
+			const struct gf_nibble_tbl *row = &tbls[i * n];
+			__m256i w = _mm256_setzero_si256();
+
+			for (j = 0; j < n; j++) {
+				__m256i s, lo, hi;
+
+				s = _mm256_loadu_si256((const __m256i *)((uint8_t *)sources[j] + off));
+				lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)row[j].lo));
+				hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)row[j].hi));
+				lo = _mm256_shuffle_epi8(lo, _mm256_and_si256(s, mask));
+				hi = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(s, 4), mask));
+				w = _mm256_xor_si256(w, _mm256_xor_si256(lo, hi));
+			}
+			_mm256_storeu_si256((__m256i *)((uint8_t *)dests[i] + off), w);
+		}
+	}
+
+	if (done < len) {
+		void *sources2[SPDK_GF_MAX_SRC];
+		void *dests2[SPDK_GF_DOT_PROD_MAX_DESTS];
+
+		for (j = 0; j < n; j++) {
+			sources2[j] = (uint8_t *)sources[j] + done;
+		}
+		for (i = 0; i < ndests; i++) {
+			dests2[i] = (uint8_t *)dests[i] + done;
+		}
+
+		gf_dot_prod_basic(dests2, ndests, sources2, n, tbls, len - done);
+	}
+}
+
+static void (*g_gf_dot_prod_fn)(void **dests, uint32_t ndests, void **sources, uint32_t n,
+				const struct gf_nibble_tbl *tbls, uint32_t len) = gf_dot_prod_basic;
+
+__attribute__((constructor)) static void
+gf_init(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		g_gf_dot_prod_fn = gf_dot_prod_avx2;
+	}
+}
+
+#define gf_dot_prod_fn g_gf_dot_prod_fn
+
+#else
+
+#define gf_dot_prod_fn gf_dot_prod_basic
+
+#endif
+
+static int
+do_gf_dot_prod(void **dests, uint32_t ndests, void **sources, uint32_t n,
+	       const uint8_t *coefs, uint32_t len)
+{
+	struct gf_nibble_tbl tbls[SPDK_GF_DOT_PROD_MAX_DESTS * SPDK_GF_MAX_SRC];
+	uint32_t i;
+
+	for (i = 0; i < ndests * n; i++) {
+		gf_nibble_tbl_init(&tbls[i], coefs[i]);
+	}
+
+	gf_dot_prod_fn(dests, ndests, sources, n, tbls, len);
+
+	return 0;
+}
+
+#endif
+
+int
+spdk_gf_dot_prod(void **dests, uint32_t ndests, void **sources, uint32_t n,
+		 const uint8_t *coefs, uint32_t len)
+{
+	if (ndests == 0 || ndests > SPDK_GF_DOT_PROD_MAX_DESTS || n == 0 || n > SPDK_GF_MAX_SRC) {
+		return -EINVAL;
+	}
+
+	return do_gf_dot_prod(dests, ndests, sources, n, coefs, len);
+}
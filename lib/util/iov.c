@@ -6,6 +6,92 @@
 #include "spdk/util.h"
 #include "spdk/log.h"
 
+/*
+ * Transfers at least this large are copied with non-temporal stores. The destination of such
+ * copies is typically a bounce buffer handed to a device or the network stack, so caching it
+ * would only evict the data of other requests.
+ */
+#define IOV_NT_COPY_THRESHOLD	(256 * 1024)
+/* Segments smaller than this are not worth the setup and the store fence */
+#define IOV_NT_COPY_MIN_LEN	4096
+
+#ifdef __x86_64__
+#include <x86intrin.h>
+
+static void
+iov_copy_nt(void *dst, const void *src, size_t len)
+{
+	uint8_t *d = dst;
+	const uint8_t *s = src;
+	size_t head;
+
+	/* Streaming stores need an aligned destination */
+	head = (size_t)(-(uintptr_t)d & (sizeof(__m128i) - 1));
+	memcpy(d, s, head);
+	d += head;
+	s += head;
+	len -= head;
+
+	while (len >= 4 * sizeof(__m128i)) {
+		__m128i w0, w1, w2, w3;
+
+		w0 = _mm_loadu_si128((const __m128i *)s);
+		w1 = _mm_loadu_si128((const __m128i *)s + 1);
+		w2 = _mm_loadu_si128((const __m128i *)s + 2);
+		w3 = _mm_loadu_si128((const __m128i *)s + 3);
+		_mm_stream_si128((__m128i *)d, w0);
+		_mm_stream_si128((__m128i *)d + 1, w1);
+		_mm_stream_si128((__m128i *)d + 2, w2);
+		_mm_stream_si128((__m128i *)d + 3, w3);
+
+		d += 4 * sizeof(__m128i);
+		s += 4 * sizeof(__m128i);
+		len -= 4 * sizeof(__m128i);
+	}
+
+	memcpy(d, s, len);
+}
+
+static inline void
+iov_copy_nt_done(void)
+{
+	_mm_sfence();
+}
+#else
+static void
+iov_copy_nt(void *dst, const void *src, size_t len)
+{
+	memcpy(dst, src, len);
+}
+
+static inline void
+iov_copy_nt_done(void)
+{
+}
+#endif
+
+static size_t
+iov_length(const struct iovec *iovs, size_t iovcnt)
+{
+	size_t i, len = 0;
+
+	for (i = 0; i < iovcnt; i++) {
+		len += iovs[i].iov_len;
+	}
+
+	return len;
+}
+
+static inline void
+iov_copy(void *dst, const void *src, size_t len, bool nt)
+{
+	if (nt && len >= IOV_NT_COPY_MIN_LEN) {
+		iov_copy_nt(dst, src, len);
+	} else {
+		memcpy(dst, src, len);
+	}
+}
+
 void
 spdk_iov_memset(struct iovec *iovs, int iovcnt, int c)
 {
@@ -132,17 +218,31 @@ size_t
 spdk_iovcpy(struct iovec *siov, size_t siovcnt, struct iovec *diov, size_t diovcnt)
 {
 	struct spdk_ioviter iter;
+	struct spdk_single_ioviter *sit = &iter.iters[0], *dit = &iter.iters[1];
 	size_t len, total_sz;
 	void *src, *dst;
+	bool nt;
+
+	nt = iov_length(siov, siovcnt) >= IOV_NT_COPY_THRESHOLD;
 
 	total_sz = 0;
 	for (len = spdk_ioviter_first(&iter, siov, siovcnt, diov, diovcnt, &src, &dst);
 	     len != 0;
 	     len = spdk_ioviter_next(&iter, &src, &dst)) {
-		memcpy(dst, src, len);
+		/* The iterator already points at the next segments, start loading them */
+		if (sit->idx < sit->iovcnt && dit->idx < dit->iovcnt) {
+			__builtin_prefetch(sit->iov_base, 0);
+			__builtin_prefetch(dit->iov_base, 1);
+		}
+
+		iov_copy(dst, src, len, nt);
 		total_sz += len;
 	}
 
+	if (nt) {
+		iov_copy_nt_done();
+	}
+
 	return total_sz;
 }
 
@@ -178,11 +278,14 @@ iov_xfer(struct spdk_iov_xfer *ix, const void *buf, size_t buf_len, bool to_buf)
 {
 	size_t len, iov_remain_len, copied_len = 0;
 	struct iovec *iov;
+	bool nt;
 
 	if (buf_len == 0) {
 		return 0;
 	}
 
+	nt = buf_len >= IOV_NT_COPY_THRESHOLD;
+
 	while (ix->cur_iov_idx < ix->iovcnt) {
 		iov = &ix->iovs[ix->cur_iov_idx];
 		iov_remain_len = iov->iov_len - ix->cur_iov_offset;
@@ -194,21 +297,29 @@ iov_xfer(struct spdk_iov_xfer *ix, const void *buf, size_t buf_len, bool to_buf)
 
 		len = spdk_min(iov_remain_len, buf_len - copied_len);
 
+		if (ix->cur_iov_idx + 1 < ix->iovcnt) {
+			__builtin_prefetch(ix->iovs[ix->cur_iov_idx + 1].iov_base);
+		}
+
 		if (to_buf) {
-			memcpy((char *)buf + copied_len,
-			       (char *)iov->iov_base + ix->cur_iov_offset, len);
+			iov_copy((char *)buf + copied_len,
+				 (char *)iov->iov_base + ix->cur_iov_offset, len, nt);
 		} else {
-			memcpy((char *)iov->iov_base + ix->cur_iov_offset,
-			       (const char *)buf + copied_len, len);
+			iov_copy((char *)iov->iov_base + ix->cur_iov_offset,
+				 (const char *)buf + copied_len, len, nt);
 		}
 		copied_len += len;
 		ix->cur_iov_offset += len;
 
 		if (buf_len == copied_len) {
-			return copied_len;
+			break;
 		}
 	}
 
+	if (nt) {
+		iov_copy_nt_done();
+	}
+
 	return copied_len;
 }
 
@@ -19,8 +19,12 @@
  */
 #define SPDK_CRC32C_POLYNOMIAL_REFLECT 0x82f63b78UL
 
+/* Number of bytes consumed per iteration by the table-driven CRC-32 (slicing-by-8) */
+#define SPDK_CRC32_TABLE_SLICES 8
+
 struct spdk_crc32_table {
-	uint32_t table[256];
+	/* table[0] is the classic byte-at-a-time table, table[n] advances a byte n extra bytes */
+	uint32_t table[SPDK_CRC32_TABLE_SLICES][256];
 };
 
 /**
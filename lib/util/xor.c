@@ -48,12 +48,15 @@ xor_gen_unaligned(void *dest, void **sources, uint32_t n, uint32_t len)
 	}
 }
 
+/* number of 64-bit words xored per source in one pass, i.e. one cache line */
+#define XOR_BLOCK_WORDS	(SPDK_CACHE_LINE_SIZE / sizeof(uint64_t))
+
 static void
 xor_gen_basic(void *dest, void **sources, uint32_t n, uint32_t len)
 {
 	uint32_t shift;
 	uint32_t len_div, len_rem;
-	uint32_t i, j;
+	uint32_t i, j, k;
 
 	if (!buffers_aligned(dest, sources, n, sizeof(uint64_t))) {
 		xor_gen_unaligned(dest, sources, n, len);
@@ -64,7 +67,23 @@ xor_gen_basic(void *dest, void **sources, uint32_t n, uint32_t len)
 	len_div = len >> shift;
 	len_rem = len_div << shift;
 
-	for (i = 0; i < len_div; i++) {
+	/* Accumulate a whole cache line of every source before storing it to dest, so the
+	 * compiler can keep it in (vector) registers and dest is written exactly once.
+	 */
+	for (i = 0; i + XOR_BLOCK_WORDS <= len_div; i += XOR_BLOCK_WORDS) {
+		uint64_t w[XOR_BLOCK_WORDS] = {};
+
+		for (j = 0; j < n; j++) {
+			const uint64_t *src = (const uint64_t *)sources[j] + i;
+
+			for (k = 0; k < XOR_BLOCK_WORDS; k++) {
+				w[k] ^= src[k];
+			}
+		}
+		memcpy((uint64_t *)dest + i, w, sizeof(w));
+	}
+
+	for (; i < len_div; i++) {
 		uint64_t w = 0;
 
 		for (j = 0; j < n; j++) {
@@ -116,6 +135,87 @@ do_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
 
 #define SPDK_XOR_BUF_ALIGN sizeof(uint64_t)
 
+#ifdef __x86_64__
+#include <x86intrin.h>
+
+/* Stripes at least this large bypass the cache when the parity is stored */
+#define XOR_NT_STORE_THRESHOLD	(128 * 1024)
+
+__attribute__((target("avx2"))) static void
+xor_gen_avx2(void *dest, void **sources, uint32_t n, uint32_t len)
+{
+	uint32_t off, j, done;
+	bool nt;
+
+	nt = len >= XOR_NT_STORE_THRESHOLD && is_aligned(dest, sizeof(__m256i));
+	done = SPDK_ALIGN_FLOOR(len, 4 * sizeof(__m256i));
+
+	for (off = 0; off < done; off += 4 * sizeof(__m256i)) {
+		const __m256i *src = (const __m256i *)((uint8_t *)sources[0] + off);
+		__m256i *dst = (__m256i *)((uint8_t *)dest + off);
+		__m256i w0, w1, w2, w3;
+
+		w0 = _mm256_loadu_si256(&src[0]);
+		w1 = _mm256_loadu_si256(&src[1]);
+		w2 = _mm256_loadu_si256(&src[2]);
+		w3 = _mm256_loadu_si256(&src[3]);
+
+		for (j = 1; j < n; j++) {
+			src = (const __m256i *)((uint8_t *)sources[j] + off);
+			w0 = _mm256_xor_si256(w0, _mm256_loadu_si256(&src[0]));
+			w1 = _mm256_xor_si256(w1, _mm256_loadu_si256(&src[1]));
+			w2 = _mm256_xor_si256(w2, _mm256_loadu_si256(&src[2]));
+			w3 = _mm256_xor_si256(w3, _mm256_loadu_si256(&src[3]));
+		}
+
+		if (nt) {
+			_mm256_stream_si256(&dst[0], w0);
+			_mm256_stream_si256(&dst[1], w1);
+			_mm256_stream_si256(&dst[2], w2);
+			_mm256_stream_si256(&dst[3], w3);
+		} else {
+			_mm256_storeu_si256(&dst[0], w0);
+			_mm256_storeu_si256(&dst[1], w1);
+			_mm256_storeu_si256(&dst[2], w2);
+			_mm256_storeu_si256(&dst[3], w3);
+		}
+	}
+
+	if (nt) {
+		_mm_sfence();
+	}
+
+	if (done < len) {
+		void *sources2[SPDK_XOR_MAX_SRC];
+
+		for (j = 0; j < n; j++) {
+			sources2[j] = (uint8_t *)sources[j] + done;
+		}
+
+		xor_gen_basic((uint8_t *)dest + done, sources2, n, len - done);
+	}
+}
+
+static void (*g_xor_gen_fn)(void *dest, void **sources, uint32_t n, uint32_t len) = xor_gen_basic;
+
+__attribute__((constructor)) static void
+xor_init(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		g_xor_gen_fn = xor_gen_avx2;
+	}
+}
+
+static inline int
+do_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
+{
+	g_xor_gen_fn(dest, sources, n, len);
+	return 0;
+}
+
+#else
+
 static inline int
 do_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
 {
@@ -125,6 +225,8 @@ do_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
 
 #endif
 
+#endif
+
 int
 spdk_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
 {
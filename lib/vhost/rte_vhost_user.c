@@ -132,6 +132,27 @@ vhost_log_used_vring_idx(struct spdk_vhost_session *vsession,
 	rte_vhost_log_used_vring(vsession->vid, vq_idx, offset, len);
 }
 
+/*
+ * Ask the guest to kick us for the next request past last_avail_idx.
+ * Only used for split rings with VIRTIO_RING_F_EVENT_IDX in interrupt mode.
+ */
+static void
+vhost_vq_avail_event_update(struct spdk_vhost_virtqueue *virtqueue)
+{
+	struct spdk_vhost_session *vsession = virtqueue->vsession;
+	struct rte_vhost_vring *vring = &virtqueue->vring;
+
+	*(volatile uint16_t *)&vring->used->ring[vring->size] = virtqueue->last_avail_idx;
+
+	if (spdk_unlikely(vhost_dev_has_feature(vsession, VHOST_F_LOG_ALL))) {
+		rte_vhost_log_used_vring(vsession->vid, virtqueue->vring_idx,
+					 offsetof(struct vring_used, ring[vring->size]), sizeof(uint16_t));
+	}
+
+	/* Make sure the guest sees the new avail event before we check avail->idx again. */
+	spdk_smp_mb();
+}
+
 /*
  * Get available requests from avail ring.
  */
@@ -160,7 +181,19 @@ vhost_vq_avail_ring_get(struct spdk_vhost_virtqueue *virtqueue, uint16_t *reqs,
 
 	count = avail_idx - last_idx;
 	if (spdk_likely(count == 0)) {
-		return 0;
+		if (!virtqueue->vsession || spdk_likely(!spdk_interrupt_mode_is_enabled()) ||
+		    !vhost_dev_has_feature(virtqueue->vsession, VIRTIO_RING_F_EVENT_IDX)) {
+			return 0;
+		}
+
+		/* Re-arm the kick and pick up anything the guest added before seeing it. */
+		vhost_vq_avail_event_update(virtqueue);
+		avail_idx = *(volatile uint16_t *)&avail->idx;
+		count = avail_idx - last_idx;
+		if (count == 0) {
+			return 0;
+		}
+		spdk_smp_rmb();
 	}
 
 	if (spdk_unlikely(count > vring->size)) {
@@ -175,6 +208,10 @@ vhost_vq_avail_ring_get(struct spdk_vhost_virtqueue *virtqueue, uint16_t *reqs,
 	virtqueue->last_avail_idx += count;
 	/* Check whether there are unprocessed reqs in vq, then kick vq manually */
 	if (virtqueue->vsession && spdk_unlikely(spdk_interrupt_mode_is_enabled())) {
+		if (vhost_dev_has_feature(virtqueue->vsession, VIRTIO_RING_F_EVENT_IDX)) {
+			vhost_vq_avail_event_update(virtqueue);
+		}
+
 		/* If avail_idx is larger than virtqueue's last_avail_idx, then there is unprocessed reqs.
 		 * avail_idx should get updated here from memory, in case of race condition with guest.
 		 */
@@ -371,23 +408,37 @@ static void
 check_session_vq_io_stats(struct spdk_vhost_session *vsession,
 			  struct spdk_vhost_virtqueue *virtqueue, uint64_t now)
 {
-	if (now < vsession->next_stats_check_time) {
+	if (now < virtqueue->next_stats_check_time) {
 		return;
 	}
 
-	vsession->next_stats_check_time = now + vsession->stats_check_interval;
+	virtqueue->next_stats_check_time = now + vsession->stats_check_interval;
 	session_vq_io_stats_update(vsession, virtqueue, now);
 }
 
 static inline bool
 vhost_vq_event_is_suppressed(struct spdk_vhost_virtqueue *vq)
 {
+	uint16_t used_event, used_idx;
+
 	spdk_smp_mb();
 
 	if (spdk_unlikely(vq->packed.packed_ring)) {
+		/* With VRING_PACKED_EVENT_FLAG_DESC the guest is always signalled */
 		if (vq->vring.driver_event->flags & VRING_PACKED_EVENT_FLAG_DISABLE) {
 			return true;
 		}
+	} else if (vhost_dev_has_feature(vq->vsession, VIRTIO_RING_F_EVENT_IDX)) {
+		/*
+		 * The guest asks to be signalled only once the used index moves past
+		 * used_event. Everything completed since the last signal is accounted
+		 * in used_req_cnt, so the index of the last signal can be derived from it.
+		 */
+		used_event = *(volatile uint16_t *)&vq->vring.avail->ring[vq->vring.size];
+		used_idx = vq->last_used_idx;
+		if (!vring_need_event(used_event, used_idx, used_idx - vq->used_req_cnt)) {
+			return true;
+		}
 	} else {
 		if (vq->vring.avail->flags & VRING_AVAIL_F_NO_INTERRUPT) {
 			return true;
@@ -956,7 +1007,6 @@ new_connection(int vid)
 
 	vsession->started = false;
 	vsession->starting = false;
-	vsession->next_stats_check_time = 0;
 	vsession->stats_check_interval = SPDK_VHOST_STATS_CHECK_INTERVAL_MS *
 					 spdk_get_ticks_hz() / 1000UL;
 	TAILQ_INSERT_TAIL(&user_dev->vsessions, vsession, tailq);
@@ -1109,6 +1159,9 @@ enable_device_vq(struct spdk_vhost_session *vsession, uint16_t qid)
 		} else {
 			/* Enable I/O submission notifications, we'll be interrupting. */
 			q->vring.used->flags = 0;
+			if (vhost_dev_has_feature(vsession, VIRTIO_RING_F_EVENT_IDX)) {
+				vhost_vq_avail_event_update(q);
+			}
 		}
 	}
 
@@ -37,11 +37,41 @@
 
 #define VIRTIO_BLK_DEFAULT_TRANSPORT "vhost_user_blk"
 
+/* Maximum number of threads virtqueues of a controller can be spread across */
+#define SPDK_VHOST_BLK_MAX_VQ_THREADS 16
+
+/*
+ * Virtqueues of a session processed by one of the additional threads of the controller.
+ * Virtqueue qid belongs to group (qid % num_vq_threads) - 1, the ones with
+ * qid % num_vq_threads == 0 are processed by the controller thread itself.
+ */
+struct spdk_vhost_blk_vq_group {
+	struct spdk_vhost_blk_session *bvsession;
+	struct spdk_thread *thread;
+	struct spdk_poller *poller;
+	struct spdk_io_channel *io_channel;
+
+	/* Tasks in flight on the virtqueues of this group */
+	int task_cnt;
+
+	/* Index of the first virtqueue, the following ones are num_vq_threads apart */
+	uint16_t first_vq;
+
+	/* Set on the controller thread between session start and stop */
+	bool started;
+
+	/* Set on the group thread once the stop was requested */
+	bool stopping;
+} __attribute((aligned(SPDK_CACHE_LINE_SIZE)));
+
 struct spdk_vhost_user_blk_task {
 	struct spdk_vhost_blk_task blk_task;
 	struct spdk_vhost_blk_session *bvsession;
 	struct spdk_vhost_virtqueue *vq;
 
+	/* NULL if the virtqueue is processed by the controller thread */
+	struct spdk_vhost_blk_vq_group *vq_group;
+
 	uint16_t req_idx;
 	uint16_t num_descs;
 	uint16_t buffer_id;
@@ -58,6 +88,14 @@ struct spdk_vhost_blk_dev {
 	const struct spdk_virtio_blk_transport_ops *ops;
 
 	bool readonly;
+	bool event_idx;
+
+	/* Number of threads the virtqueues are spread across, including vdev.thread */
+	uint16_t num_vq_threads;
+	struct spdk_thread *vq_threads[SPDK_VHOST_BLK_MAX_VQ_THREADS - 1];
+
+	/* Messages sent to the vq threads that may still use bdev_desc */
+	uint32_t vq_threads_pending;
 };
 
 struct spdk_vhost_blk_session {
@@ -67,6 +105,10 @@ struct spdk_vhost_blk_session {
 	struct spdk_poller *requestq_poller;
 	struct spdk_io_channel *io_channel;
 	struct spdk_poller *stop_poller;
+
+	struct spdk_vhost_blk_vq_group vq_groups[SPDK_VHOST_BLK_MAX_VQ_THREADS - 1];
+	/* Groups which have not finished stopping on their thread yet */
+	uint32_t vq_groups_running;
 };
 
 /* forward declaration */
@@ -80,8 +122,11 @@ vhost_user_process_blk_request(struct spdk_vhost_user_blk_task *user_task)
 {
 	struct spdk_vhost_blk_session *bvsession = user_task->bvsession;
 	struct spdk_vhost_dev *vdev = &bvsession->bvdev->vdev;
+	struct spdk_io_channel *ch;
+
+	ch = user_task->vq_group ? user_task->vq_group->io_channel : bvsession->io_channel;
 
-	return virtio_blk_process_request(vdev, bvsession->io_channel, &user_task->blk_task,
+	return virtio_blk_process_request(vdev, ch, &user_task->blk_task,
 					  vhost_user_blk_request_finish, NULL);
 }
 
@@ -120,12 +165,23 @@ to_blk_session(struct spdk_vhost_session *vsession)
 static inline void
 blk_task_inc_task_cnt(struct spdk_vhost_user_blk_task *task)
 {
+	if (spdk_unlikely(task->vq_group != NULL)) {
+		task->vq_group->task_cnt++;
+		return;
+	}
+
 	task->bvsession->vsession.task_cnt++;
 }
 
 static inline void
 blk_task_dec_task_cnt(struct spdk_vhost_user_blk_task *task)
 {
+	if (spdk_unlikely(task->vq_group != NULL)) {
+		assert(task->vq_group->task_cnt > 0);
+		task->vq_group->task_cnt--;
+		return;
+	}
+
 	assert(task->bvsession->vsession.task_cnt > 0);
 	task->bvsession->vsession.task_cnt--;
 }
@@ -948,7 +1004,24 @@ vdev_worker(void *arg)
 	uint16_t q_idx;
 	int rc = 0;
 
-	for (q_idx = 0; q_idx < vsession->max_queues; q_idx++) {
+	for (q_idx = 0; q_idx < vsession->max_queues; q_idx += bvsession->bvdev->num_vq_threads) {
+		rc += _vdev_vq_worker(&vsession->virtqueue[q_idx]);
+	}
+
+	return rc > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+static int
+vdev_vq_group_worker(void *arg)
+{
+	struct spdk_vhost_blk_vq_group *group = arg;
+	struct spdk_vhost_blk_session *bvsession = group->bvsession;
+	struct spdk_vhost_session *vsession = &bvsession->vsession;
+	uint16_t q_idx;
+	int rc = 0;
+
+	for (q_idx = group->first_vq; q_idx < vsession->max_queues;
+	     q_idx += bvsession->bvdev->num_vq_threads) {
 		rc += _vdev_vq_worker(&vsession->virtqueue[q_idx]);
 	}
 
@@ -1019,21 +1092,27 @@ no_bdev_process_packed_vq(struct spdk_vhost_blk_session *bvsession, struct spdk_
 				     task->inflight_head);
 }
 
-static int
-_no_bdev_vdev_vq_worker(struct spdk_vhost_virtqueue *vq)
+static void
+no_bdev_vdev_vq_process(struct spdk_vhost_virtqueue *vq)
 {
-	struct spdk_vhost_session *vsession = vq->vsession;
-	struct spdk_vhost_blk_session *bvsession = to_blk_session(vsession);
-	bool packed_ring;
+	struct spdk_vhost_blk_session *bvsession = to_blk_session(vq->vsession);
 
-	packed_ring = vq->packed.packed_ring;
-	if (packed_ring) {
+	if (vq->packed.packed_ring) {
 		no_bdev_process_packed_vq(bvsession, vq);
 	} else {
 		no_bdev_process_vq(bvsession, vq);
 	}
 
 	vhost_session_vq_used_signal(vq);
+}
+
+static int
+_no_bdev_vdev_vq_worker(struct spdk_vhost_virtqueue *vq)
+{
+	struct spdk_vhost_session *vsession = vq->vsession;
+	struct spdk_vhost_blk_session *bvsession = to_blk_session(vsession);
+
+	no_bdev_vdev_vq_process(vq);
 
 	if (vsession->task_cnt == 0 && bvsession->io_channel) {
 		vhost_blk_put_io_channel(bvsession->io_channel);
@@ -1058,13 +1137,34 @@ no_bdev_vdev_worker(void *arg)
 	struct spdk_vhost_session *vsession = &bvsession->vsession;
 	uint16_t q_idx;
 
-	for (q_idx = 0; q_idx < vsession->max_queues; q_idx++) {
+	for (q_idx = 0; q_idx < vsession->max_queues; q_idx += bvsession->bvdev->num_vq_threads) {
 		_no_bdev_vdev_vq_worker(&vsession->virtqueue[q_idx]);
 	}
 
 	return SPDK_POLLER_BUSY;
 }
 
+static int
+no_bdev_vdev_vq_group_worker(void *arg)
+{
+	struct spdk_vhost_blk_vq_group *group = arg;
+	struct spdk_vhost_blk_session *bvsession = group->bvsession;
+	struct spdk_vhost_session *vsession = &bvsession->vsession;
+	uint16_t q_idx;
+
+	for (q_idx = group->first_vq; q_idx < vsession->max_queues;
+	     q_idx += bvsession->bvdev->num_vq_threads) {
+		no_bdev_vdev_vq_process(&vsession->virtqueue[q_idx]);
+	}
+
+	if (group->task_cnt == 0 && group->io_channel) {
+		vhost_blk_put_io_channel(group->io_channel);
+		group->io_channel = NULL;
+	}
+
+	return SPDK_POLLER_BUSY;
+}
+
 static void
 vhost_blk_session_unregister_interrupts(struct spdk_vhost_blk_session *bvsession)
 {
@@ -1152,6 +1252,22 @@ vhost_blk_poller_set_interrupt_mode(struct spdk_poller *poller, void *cb_arg, bo
 	vhost_user_session_set_interrupt_mode(&bvsession->vsession, interrupt_mode);
 }
 
+static void
+vhost_blk_bdev_close(void *arg)
+{
+	struct spdk_vhost_blk_dev *bvdev = arg;
+
+	/* Wait until the vq threads stopped submitting I/O to the bdev */
+	if (__atomic_load_n(&bvdev->vq_threads_pending, __ATOMIC_SEQ_CST) > 0) {
+		spdk_thread_send_msg(spdk_get_thread(), vhost_blk_bdev_close, bvdev);
+		return;
+	}
+
+	spdk_bdev_close(bvdev->bdev_desc);
+	bvdev->bdev_desc = NULL;
+	bvdev->bdev = NULL;
+}
+
 static void
 bdev_event_cpl_cb(struct spdk_vhost_dev *vdev, void *ctx)
 {
@@ -1162,9 +1278,7 @@ bdev_event_cpl_cb(struct spdk_vhost_dev *vdev, void *ctx)
 		/* All sessions have been notified, time to close the bdev */
 		bvdev = to_blk_dev(vdev);
 		assert(bvdev != NULL);
-		spdk_bdev_close(bvdev->bdev_desc);
-		bvdev->bdev_desc = NULL;
-		bvdev->bdev = NULL;
+		vhost_blk_bdev_close(bvdev);
 	}
 }
 
@@ -1190,15 +1304,40 @@ vhost_user_blk_resize_cb(struct spdk_vhost_dev *vdev, bdev_event_cb_complete cb,
 				       cb, cb_arg);
 }
 
+static void
+vhost_blk_vq_group_bdev_remove(void *arg)
+{
+	struct spdk_vhost_blk_vq_group *group = arg;
+	struct spdk_vhost_blk_dev *bvdev = group->bvsession->bvdev;
+
+	if (!group->stopping) {
+		spdk_poller_unregister(&group->poller);
+		group->poller = SPDK_POLLER_REGISTER(no_bdev_vdev_vq_group_worker, group, 0);
+	}
+
+	__atomic_fetch_sub(&bvdev->vq_threads_pending, 1, __ATOMIC_SEQ_CST);
+}
+
 static int
 vhost_user_session_bdev_remove_cb(struct spdk_vhost_dev *vdev,
 				  struct spdk_vhost_session *vsession,
 				  void *ctx)
 {
+	struct spdk_vhost_blk_dev *bvdev = to_blk_dev(vdev);
 	struct spdk_vhost_blk_session *bvsession;
+	struct spdk_vhost_blk_vq_group *group;
+	uint16_t i;
 	int rc;
 
 	bvsession = to_blk_session(vsession);
+	for (i = 0; i + 1 < bvdev->num_vq_threads; i++) {
+		group = &bvsession->vq_groups[i];
+		if (group->started) {
+			__atomic_fetch_add(&bvdev->vq_threads_pending, 1, __ATOMIC_SEQ_CST);
+			spdk_thread_send_msg(group->thread, vhost_blk_vq_group_bdev_remove, group);
+		}
+	}
+
 	if (bvsession->requestq_poller) {
 		spdk_poller_unregister(&bvsession->requestq_poller);
 		if (spdk_interrupt_mode_is_enabled()) {
@@ -1291,6 +1430,8 @@ static int
 alloc_vq_task_pool(struct spdk_vhost_session *vsession, uint16_t qid)
 {
 	struct spdk_vhost_blk_session *bvsession = to_blk_session(vsession);
+	struct spdk_vhost_blk_dev *bvdev = to_blk_dev(vsession->vdev);
+	struct spdk_vhost_blk_vq_group *vq_group = NULL;
 	struct spdk_vhost_virtqueue *vq;
 	struct spdk_vhost_user_blk_task *task;
 	uint32_t task_cnt;
@@ -1321,16 +1462,127 @@ alloc_vq_task_pool(struct spdk_vhost_session *vsession, uint16_t qid)
 		return -1;
 	}
 
+	if (qid % bvdev->num_vq_threads != 0) {
+		vq_group = &bvsession->vq_groups[qid % bvdev->num_vq_threads - 1];
+	}
+
 	for (j = 0; j < task_cnt; j++) {
 		task = &((struct spdk_vhost_user_blk_task *)vq->tasks)[j];
 		task->bvsession = bvsession;
 		task->req_idx = j;
 		task->vq = vq;
+		task->vq_group = vq_group;
 	}
 
 	return 0;
 }
 
+static void
+vhost_blk_vq_group_start(void *arg)
+{
+	struct spdk_vhost_blk_vq_group *group = arg;
+	struct spdk_vhost_blk_dev *bvdev = group->bvsession->bvdev;
+
+	if (bvdev->bdev) {
+		group->io_channel = vhost_blk_get_io_channel(&bvdev->vdev);
+		if (!group->io_channel) {
+			SPDK_ERRLOG("%s: I/O channel allocation failed, failing requests of queue %"PRIu16"\n",
+				    group->bvsession->vsession.name, group->first_vq);
+		}
+	}
+
+	if (group->io_channel) {
+		group->poller = SPDK_POLLER_REGISTER(vdev_vq_group_worker, group, 0);
+	} else {
+		group->poller = SPDK_POLLER_REGISTER(no_bdev_vdev_vq_group_worker, group, 0);
+	}
+	SPDK_INFOLOG(vhost, "%s: started queue %"PRIu16" poller on lcore %d\n",
+		     group->bvsession->vsession.name, group->first_vq, spdk_env_get_current_core());
+
+	__atomic_fetch_sub(&bvdev->vq_threads_pending, 1, __ATOMIC_SEQ_CST);
+}
+
+static int
+vhost_blk_vq_group_stop_poller_cb(void *arg)
+{
+	struct spdk_vhost_blk_vq_group *group = arg;
+	struct spdk_vhost_blk_session *bvsession = group->bvsession;
+	struct spdk_vhost_session *vsession = &bvsession->vsession;
+	uint16_t q_idx;
+
+	if (group->task_cnt > 0) {
+		return SPDK_POLLER_BUSY;
+	}
+
+	for (q_idx = group->first_vq; q_idx < vsession->max_queues;
+	     q_idx += bvsession->bvdev->num_vq_threads) {
+		vsession->virtqueue[q_idx].next_event_time = 0;
+		vhost_vq_used_signal(vsession, &vsession->virtqueue[q_idx]);
+	}
+
+	if (group->io_channel) {
+		vhost_blk_put_io_channel(group->io_channel);
+		group->io_channel = NULL;
+	}
+
+	spdk_poller_unregister(&group->poller);
+	__atomic_fetch_sub(&bvsession->vq_groups_running, 1, __ATOMIC_SEQ_CST);
+
+	return SPDK_POLLER_BUSY;
+}
+
+static void
+vhost_blk_vq_group_stop(void *arg)
+{
+	struct spdk_vhost_blk_vq_group *group = arg;
+
+	group->stopping = true;
+	spdk_poller_unregister(&group->poller);
+	group->poller = SPDK_POLLER_REGISTER(vhost_blk_vq_group_stop_poller_cb, group,
+					     SPDK_VHOST_SESSION_STOP_RETRY_PERIOD_IN_US);
+}
+
+static void
+vhost_blk_session_start_vq_groups(struct spdk_vhost_blk_session *bvsession)
+{
+	struct spdk_vhost_blk_dev *bvdev = bvsession->bvdev;
+	struct spdk_vhost_blk_vq_group *group;
+	uint16_t i;
+
+	for (i = 0; i + 1 < bvdev->num_vq_threads; i++) {
+		group = &bvsession->vq_groups[i];
+		group->first_vq = i + 1;
+		if (group->first_vq >= bvsession->vsession.max_queues) {
+			break;
+		}
+
+		assert(group->task_cnt == 0);
+		group->bvsession = bvsession;
+		group->thread = bvdev->vq_threads[i];
+		group->started = true;
+		group->stopping = false;
+
+		__atomic_fetch_add(&bvsession->vq_groups_running, 1, __ATOMIC_SEQ_CST);
+		__atomic_fetch_add(&bvdev->vq_threads_pending, 1, __ATOMIC_SEQ_CST);
+		spdk_thread_send_msg(group->thread, vhost_blk_vq_group_start, group);
+	}
+}
+
+static void
+vhost_blk_session_stop_vq_groups(struct spdk_vhost_blk_session *bvsession)
+{
+	struct spdk_vhost_blk_vq_group *group;
+	uint16_t i;
+
+	for (i = 0; i + 1 < bvsession->bvdev->num_vq_threads; i++) {
+		group = &bvsession->vq_groups[i];
+		if (group->started) {
+			group->started = false;
+			spdk_thread_send_msg(group->thread, vhost_blk_vq_group_stop, group);
+		}
+	}
+}
+
 static int
 vhost_blk_start(struct spdk_vhost_dev *vdev,
 		struct spdk_vhost_session *vsession, void *unused)
@@ -1380,6 +1632,8 @@ vhost_blk_start(struct spdk_vhost_dev *vdev,
 	spdk_poller_register_interrupt(bvsession->requestq_poller, vhost_blk_poller_set_interrupt_mode,
 				       bvsession);
 
+	vhost_blk_session_start_vq_groups(bvsession);
+
 	return 0;
 }
 
@@ -1391,7 +1645,9 @@ destroy_session_poller_cb(void *arg)
 	struct spdk_vhost_user_dev *user_dev = to_user_dev(vsession->vdev);
 	int i;
 
-	if (vsession->task_cnt > 0 || (pthread_mutex_trylock(&user_dev->lock) != 0)) {
+	if (vsession->task_cnt > 0 ||
+	    __atomic_load_n(&bvsession->vq_groups_running, __ATOMIC_SEQ_CST) > 0 ||
+	    (pthread_mutex_trylock(&user_dev->lock) != 0)) {
 		assert(vsession->stop_retry_count > 0);
 		vsession->stop_retry_count--;
 		if (vsession->stop_retry_count == 0) {
@@ -1438,6 +1694,7 @@ vhost_blk_stop(struct spdk_vhost_dev *vdev,
 
 	spdk_poller_unregister(&bvsession->requestq_poller);
 	vhost_blk_session_unregister_interrupts(bvsession);
+	vhost_blk_session_stop_vq_groups(bvsession);
 
 	bvsession->vsession.stop_retry_count = (SPDK_VHOST_SESSION_STOP_RETRY_TIMEOUT_IN_SEC * 1000 *
 						1000) / SPDK_VHOST_SESSION_STOP_RETRY_PERIOD_IN_US;
@@ -1490,6 +1747,12 @@ vhost_blk_write_config_json(struct spdk_vhost_dev *vdev, struct spdk_json_write_
 	spdk_json_write_named_string(w, "cpumask",
 				     spdk_cpuset_fmt(spdk_thread_get_cpumask(vdev->thread)));
 	spdk_json_write_named_bool(w, "readonly", bvdev->readonly);
+	if (bvdev->event_idx) {
+		spdk_json_write_named_bool(w, "event_idx", true);
+	}
+	if (bvdev->num_vq_threads > 1) {
+		spdk_json_write_named_uint32(w, "vq_threads", bvdev->num_vq_threads);
+	}
 	spdk_json_write_named_string(w, "transport", bvdev->ops->name);
 	spdk_json_write_object_end(w);
 
@@ -1665,6 +1928,7 @@ spdk_vhost_blk_construct(const char *name, const char *cpumask, const char *dev_
 
 	bvdev->bdev = bdev;
 	bvdev->readonly = false;
+	bvdev->num_vq_threads = 1;
 	ret = vhost_dev_register(vdev, name, cpumask, params, &vhost_blk_device_backend,
 				 &vhost_blk_user_device_backend, false);
 	if (ret != 0) {
@@ -1698,6 +1962,11 @@ vhost_blk_destroy(struct spdk_vhost_dev *vdev)
 
 	assert(bvdev != NULL);
 
+	/* A hot-remove is still waiting for the vq threads */
+	if (__atomic_load_n(&bvdev->vq_threads_pending, __ATOMIC_SEQ_CST) > 0) {
+		return -EBUSY;
+	}
+
 	rc = vhost_dev_unregister(&bvdev->vdev);
 	if (rc != 0) {
 		return rc;
@@ -1761,19 +2030,65 @@ vhost_user_blk_destroy(struct spdk_virtio_blk_transport *transport,
 struct rpc_vhost_blk {
 	bool readonly;
 	bool packed_ring;
+	bool event_idx;
+	uint16_t vq_threads;
 };
 
 static const struct spdk_json_object_decoder rpc_construct_vhost_blk[] = {
 	{"readonly", offsetof(struct rpc_vhost_blk, readonly), spdk_json_decode_bool, true},
 	{"packed_ring", offsetof(struct rpc_vhost_blk, packed_ring), spdk_json_decode_bool, true},
+	{"event_idx", offsetof(struct rpc_vhost_blk, event_idx), spdk_json_decode_bool, true},
+	{"vq_threads", offsetof(struct rpc_vhost_blk, vq_threads), spdk_json_decode_uint16, true},
 };
 
+static void
+vhost_blk_vq_thread_exit(void *arg)
+{
+	spdk_thread_exit(spdk_get_thread());
+}
+
+static void
+vhost_user_blk_destroy_vq_threads(struct spdk_vhost_blk_dev *bvdev)
+{
+	uint16_t i;
+
+	for (i = 0; i + 1 < bvdev->num_vq_threads; i++) {
+		spdk_thread_send_msg(bvdev->vq_threads[i], vhost_blk_vq_thread_exit, NULL);
+		bvdev->vq_threads[i] = NULL;
+	}
+	bvdev->num_vq_threads = 1;
+}
+
+static int
+vhost_user_blk_create_vq_threads(struct spdk_vhost_blk_dev *bvdev, struct spdk_cpuset *cpumask,
+				 uint16_t num_threads)
+{
+	char name[64];
+	uint16_t i;
+
+	bvdev->num_vq_threads = 1;
+	for (i = 0; i + 1 < num_threads; i++) {
+		snprintf(name, sizeof(name), "%s.vq%"PRIu16, bvdev->vdev.name, i + 1);
+		bvdev->vq_threads[i] = spdk_thread_create(name, cpumask);
+		if (bvdev->vq_threads[i] == NULL) {
+			SPDK_ERRLOG("%s: failed to create virtqueue thread %"PRIu16"\n",
+				    bvdev->vdev.name, i + 1);
+			vhost_user_blk_destroy_vq_threads(bvdev);
+			return -EIO;
+		}
+		bvdev->num_vq_threads++;
+	}
+
+	return 0;
+}
+
 static int
 vhost_user_blk_create_ctrlr(struct spdk_vhost_dev *vdev, struct spdk_cpuset *cpumask,
 			    const char *address, const struct spdk_json_val *params, void *custom_opts)
 {
 	struct rpc_vhost_blk req = {0};
 	struct spdk_vhost_blk_dev *bvdev = to_blk_dev(vdev);
+	int rc;
 
 	assert(bvdev != NULL);
 
@@ -1791,14 +2106,52 @@ vhost_user_blk_create_ctrlr(struct spdk_vhost_dev *vdev, struct spdk_cpuset *cpu
 		vdev->virtio_features |= (1ULL << VIRTIO_BLK_F_RO);
 		bvdev->readonly = req.readonly;
 	}
+	if (req.event_idx) {
+		/* Let the guest use used_event/avail_event instead of the ring flags */
+		vdev->disabled_features &= ~(1ULL << VIRTIO_RING_F_EVENT_IDX);
+		bvdev->event_idx = true;
+	}
+
+	if (req.vq_threads == 0) {
+		req.vq_threads = 1;
+	}
+	if (req.vq_threads > SPDK_VHOST_BLK_MAX_VQ_THREADS) {
+		SPDK_ERRLOG("%s: vq_threads %"PRIu16" exceeds the maximum of %d\n",
+			    vdev->name, req.vq_threads, SPDK_VHOST_BLK_MAX_VQ_THREADS);
+		return -EINVAL;
+	}
+	if (req.vq_threads > 1 && spdk_interrupt_mode_is_enabled()) {
+		SPDK_ERRLOG("%s: vq_threads is not supported in interrupt mode\n", vdev->name);
+		return -ENOTSUP;
+	}
 
-	return vhost_user_dev_create(vdev, address, cpumask, custom_opts, false);
+	rc = vhost_user_blk_create_vq_threads(bvdev, cpumask, req.vq_threads);
+	if (rc != 0) {
+		return rc;
+	}
+
+	rc = vhost_user_dev_create(vdev, address, cpumask, custom_opts, false);
+	if (rc != 0) {
+		vhost_user_blk_destroy_vq_threads(bvdev);
+	}
+
+	return rc;
 }
 
 static int
 vhost_user_blk_destroy_ctrlr(struct spdk_vhost_dev *vdev)
 {
-	return vhost_user_dev_unregister(vdev);
+	struct spdk_vhost_blk_dev *bvdev = to_blk_dev(vdev);
+	int rc;
+
+	assert(bvdev != NULL);
+
+	rc = vhost_user_dev_unregister(vdev);
+	if (rc == 0) {
+		vhost_user_blk_destroy_vq_threads(bvdev);
+	}
+
+	return rc;
 }
 
 static void
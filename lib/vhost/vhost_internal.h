@@ -108,6 +108,9 @@ struct spdk_vhost_virtqueue {
 	/* Next time when we need to send event */
 	uint64_t next_event_time;
 
+	/* Next time when stats for event coalescing will be checked. */
+	uint64_t next_stats_check_time;
+
 	/* Associated vhost_virtqueue in the virtio device's virtqueue list */
 	uint32_t vring_idx;
 
@@ -145,9 +148,6 @@ struct spdk_vhost_session {
 	uint32_t coalescing_delay_time_base;
 	uint32_t coalescing_io_rate_threshold;
 
-	/* Next time when stats for event coalescing will be checked. */
-	uint64_t next_stats_check_time;
-
 	/* Interval used for event coalescing checking. */
 	uint64_t stats_check_interval;
 
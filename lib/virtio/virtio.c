@@ -19,6 +19,9 @@
 #define virtio_rmb()	spdk_smp_rmb()
 #define virtio_wmb()	spdk_smp_wmb()
 
+#define VQ_PACKED_DESC_F_AVAIL	(1 << VRING_PACKED_DESC_F_AVAIL)
+#define VQ_PACKED_DESC_F_USED	(1 << VRING_PACKED_DESC_F_USED)
+
 /* Chain all the descriptors in the ring with an END */
 static inline void
 vring_desc_init(struct vring_desc *dp, uint16_t n)
@@ -31,6 +34,31 @@ vring_desc_init(struct vring_desc *dp, uint16_t n)
 	dp[i].next = VQ_RING_DESC_CHAIN_END;
 }
 
+static void
+virtio_init_packed_vring(struct virtqueue *vq)
+{
+	uint8_t *ring_mem = vq->vq_ring_virt_mem;
+	uint16_t i;
+
+	vq->vq_packed_ring.desc = (struct vring_packed_desc *)ring_mem;
+	vq->vq_packed_ring.driver = (struct vring_packed_desc_event *)(ring_mem + vq->vq_avail_offset);
+	vq->vq_packed_ring.device = (struct vring_packed_desc_event *)(ring_mem + vq->vq_used_offset);
+	vq->vq_packed_ring.avail_flags = VQ_PACKED_DESC_F_AVAIL;
+	vq->vq_packed_ring.num_added = 0;
+	vq->vq_packed_ring.used_wrap_counter = true;
+
+	/* Buffer ids are handed out from a free list, as the device may
+	 * complete requests out of order.
+	 */
+	for (i = 0; i < vq->vq_nentries - 1; i++) {
+		vq->vq_descx[i].next = i + 1;
+	}
+	vq->vq_descx[i].next = VQ_RING_DESC_CHAIN_END;
+
+	/* Tell the backend not to interrupt us, we always poll. */
+	vq->vq_packed_ring.driver->flags = VRING_PACKED_EVENT_FLAG_DISABLE;
+}
+
 static void
 virtio_init_vring(struct virtqueue *vq)
 {
@@ -42,7 +70,6 @@ virtio_init_vring(struct virtqueue *vq)
 	 * Reinitialise since virtio port might have been stopped and restarted
 	 */
 	memset(ring_mem, 0, vq->vq_ring_size);
-	vring_init(vr, size, ring_mem, VIRTIO_PCI_VRING_ALIGN);
 	vq->vq_used_cons_idx = 0;
 	vq->vq_desc_head_idx = 0;
 	vq->vq_avail_idx = 0;
@@ -53,6 +80,12 @@ virtio_init_vring(struct virtqueue *vq)
 	vq->reqs_finished = 0;
 	memset(vq->vq_descx, 0, sizeof(struct vq_desc_extra) * vq->vq_nentries);
 
+	if (vq->vq_packed) {
+		virtio_init_packed_vring(vq);
+		return;
+	}
+
+	vring_init(vr, size, ring_mem, VIRTIO_PCI_VRING_ALIGN);
 	vring_desc_init(vr->desc, size);
 
 	/* Tell the backend not to interrupt us.
@@ -105,11 +138,25 @@ virtio_init_queue(struct virtio_dev *dev, uint16_t vtpci_queue_idx)
 	vq->vdev = dev;
 	vq->vq_queue_index = vtpci_queue_idx;
 	vq->vq_nentries = vq_size;
+	vq->vq_packed = dev->negotiated_features & (1ULL << VIRTIO_F_RING_PACKED);
 
 	/*
 	 * Reserve a memzone for vring elements
 	 */
-	size = vring_size(vq_size, VIRTIO_PCI_VRING_ALIGN);
+	if (vq->vq_packed) {
+		/* The driver and device event areas are kept on separate cache lines */
+		vq->vq_avail_offset = vq_size * sizeof(struct vring_packed_desc);
+		vq->vq_used_offset = SPDK_ALIGN_CEIL(vq->vq_avail_offset +
+						     sizeof(struct vring_packed_desc_event),
+						     SPDK_CACHE_LINE_SIZE);
+		size = vq->vq_used_offset + sizeof(struct vring_packed_desc_event);
+	} else {
+		vq->vq_avail_offset = vq_size * sizeof(struct vring_desc);
+		vq->vq_used_offset = SPDK_ALIGN_CEIL(vq->vq_avail_offset +
+						     offsetof(struct vring_avail, ring[vq_size]) +
+						     sizeof(uint16_t), VIRTIO_PCI_VRING_ALIGN);
+		size = vring_size(vq_size, VIRTIO_PCI_VRING_ALIGN);
+	}
 	vq->vq_ring_size = SPDK_ALIGN_CEIL(size, VIRTIO_PCI_VRING_ALIGN);
 	SPDK_DEBUGLOG(virtio_dev, "vring_size: %u, rounded_vring_size: %u\n",
 		      size, vq->vq_ring_size);
@@ -365,12 +412,96 @@ virtqueue_dequeue_burst_rx(struct virtqueue *vq, void **rx_pkts,
 	return i;
 }
 
+static inline void
+vq_packed_free_id(struct virtqueue *vq, uint16_t id)
+{
+	struct vq_desc_extra *dxp = &vq->vq_descx[id];
+
+	vq->vq_free_cnt = (uint16_t)(vq->vq_free_cnt + dxp->ndescs);
+	dxp->cookie = NULL;
+	dxp->ndescs = 0;
+	dxp->next = vq->vq_desc_head_idx;
+	vq->vq_desc_head_idx = id;
+}
+
+static uint16_t
+vq_packed_recv_pkts(struct virtqueue *vq, void **rx_pkts, uint32_t *len, uint16_t num)
+{
+	struct vring_packed_desc *desc;
+	struct vq_desc_extra *dxp;
+	uint16_t i, id, flags, used_flags;
+
+	for (i = 0; i < num; i++) {
+		desc = &vq->vq_packed_ring.desc[vq->vq_used_cons_idx];
+		flags = desc->flags;
+		used_flags = vq->vq_packed_ring.used_wrap_counter ?
+			     VQ_PACKED_DESC_F_AVAIL | VQ_PACKED_DESC_F_USED : 0;
+		if ((flags & (VQ_PACKED_DESC_F_AVAIL | VQ_PACKED_DESC_F_USED)) != used_flags) {
+			break;
+		}
+
+		/* Read the rest of the descriptor only after its flags */
+		virtio_rmb();
+
+		id = desc->id;
+		dxp = &vq->vq_descx[id];
+		if (spdk_unlikely(dxp->cookie == NULL)) {
+			SPDK_WARNLOG("vring descriptor with no mbuf cookie at %"PRIu16"\n",
+				     vq->vq_used_cons_idx);
+			break;
+		}
+
+		__builtin_prefetch(dxp->cookie);
+
+		rx_pkts[i] = dxp->cookie;
+		len[i] = desc->len;
+
+		/* The device writes a single used descriptor per chain */
+		vq->vq_used_cons_idx += dxp->ndescs;
+		if (vq->vq_used_cons_idx >= vq->vq_nentries) {
+			vq->vq_used_cons_idx -= vq->vq_nentries;
+			vq->vq_packed_ring.used_wrap_counter = !vq->vq_packed_ring.used_wrap_counter;
+		}
+
+		vq_packed_free_id(vq, id);
+	}
+
+	return i;
+}
+
+static void
+vq_packed_finish_req(struct virtqueue *vq)
+{
+	uint16_t head_flags = vq->vq_packed_ring.req_head_flags;
+
+	if (vq->req_end == vq->req_start) {
+		head_flags &= ~VRING_DESC_F_NEXT;
+	} else {
+		vq->vq_packed_ring.desc[vq->req_end].flags &= ~VRING_DESC_F_NEXT;
+	}
+
+	/*
+	 * The device may start processing the chain as soon as it sees the
+	 * head descriptor available, so its flags have to be written last.
+	 */
+	virtio_wmb();
+	vq->vq_packed_ring.desc[vq->req_start].flags = head_flags;
+	vq->req_start = VQ_RING_DESC_CHAIN_END;
+	vq->req_end = VQ_RING_DESC_CHAIN_END;
+	vq->reqs_finished++;
+}
+
 static void
 finish_req(struct virtqueue *vq)
 {
 	struct vring_desc *desc;
 	uint16_t avail_idx;
 
+	if (vq->vq_packed) {
+		vq_packed_finish_req(vq);
+		return;
+	}
+
 	desc = &vq->vq_ring.desc[vq->req_end];
 	desc->flags &= ~VRING_DESC_F_NEXT;
 
@@ -390,6 +521,33 @@ finish_req(struct virtqueue *vq)
 	vq->reqs_finished++;
 }
 
+static int
+vq_packed_req_start(struct virtqueue *vq, void *cookie)
+{
+	struct vq_desc_extra *dxp;
+	uint16_t id;
+
+	if (vq->req_start != VQ_RING_DESC_CHAIN_END) {
+		/* The previous request is empty, reuse its buffer id */
+		id = vq->vq_packed_ring.req_id;
+	} else {
+		id = vq->vq_desc_head_idx;
+		if (spdk_unlikely(id == VQ_RING_DESC_CHAIN_END)) {
+			return -ENOMEM;
+		}
+		vq->vq_desc_head_idx = vq->vq_descx[id].next;
+	}
+
+	vq->req_start = vq->vq_avail_idx;
+	vq->vq_packed_ring.req_id = id;
+	vq->vq_packed_ring.req_avail_flags = vq->vq_packed_ring.avail_flags;
+	dxp = &vq->vq_descx[id];
+	dxp->cookie = cookie;
+	dxp->ndescs = 0;
+
+	return 0;
+}
+
 int
 virtqueue_req_start(struct virtqueue *vq, void *cookie, int iovcnt)
 {
@@ -404,6 +562,10 @@ virtqueue_req_start(struct virtqueue *vq, void *cookie, int iovcnt)
 		finish_req(vq);
 	}
 
+	if (vq->vq_packed) {
+		return vq_packed_req_start(vq, cookie);
+	}
+
 	vq->req_start = vq->vq_desc_head_idx;
 	dxp = &vq->vq_descx[vq->req_start];
 	dxp->cookie = cookie;
@@ -412,6 +574,33 @@ virtqueue_req_start(struct virtqueue *vq, void *cookie, int iovcnt)
 	return 0;
 }
 
+static bool
+vq_packed_need_notify(struct virtqueue *vq)
+{
+	struct vring_packed_desc_event *event = vq->vq_packed_ring.device;
+	uint16_t flags, off_wrap, event_idx, new_idx, old_idx;
+	bool avail_wrap_counter;
+
+	new_idx = vq->vq_avail_idx;
+	old_idx = new_idx - vq->vq_packed_ring.num_added;
+	vq->vq_packed_ring.num_added = 0;
+
+	flags = event->flags;
+	if (flags != VRING_PACKED_EVENT_FLAG_DESC) {
+		return flags != VRING_PACKED_EVENT_FLAG_DISABLE;
+	}
+
+	/* VRING_PACKED_EVENT_FLAG_DESC can be only used with F_EVENT_IDX */
+	off_wrap = event->off_wrap;
+	event_idx = off_wrap & ~(1 << VRING_PACKED_EVENT_F_WRAP_CTR);
+	avail_wrap_counter = vq->vq_packed_ring.avail_flags & VQ_PACKED_DESC_F_AVAIL;
+	if ((off_wrap >> VRING_PACKED_EVENT_F_WRAP_CTR) != avail_wrap_counter) {
+		event_idx -= vq->vq_nentries;
+	}
+
+	return vring_need_event(event_idx, new_idx, old_idx);
+}
+
 void
 virtqueue_req_flush(struct virtqueue *vq)
 {
@@ -428,7 +617,11 @@ virtqueue_req_flush(struct virtqueue *vq)
 	reqs_finished = vq->reqs_finished;
 	vq->reqs_finished = 0;
 
-	if (vq->vdev->negotiated_features & (1ULL << VIRTIO_RING_F_EVENT_IDX)) {
+	if (vq->vq_packed) {
+		if (!vq_packed_need_notify(vq)) {
+			return;
+		}
+	} else if (vq->vdev->negotiated_features & (1ULL << VIRTIO_RING_F_EVENT_IDX)) {
 		/* Set used event idx to a value the device will never reach.
 		 * This effectively disables interrupts.
 		 */
@@ -447,6 +640,32 @@ virtqueue_req_flush(struct virtqueue *vq)
 	SPDK_DEBUGLOG(virtio_dev, "Notified backend after xmit\n");
 }
 
+static void
+vq_packed_req_abort(struct virtqueue *vq)
+{
+	struct vq_desc_extra *dxp = &vq->vq_descx[vq->vq_packed_ring.req_id];
+	uint16_t idx = vq->req_start;
+
+	/*
+	 * The head descriptor was never made available, but the following ones
+	 * were. Flip them back, so that a shorter request placed at the same
+	 * position doesn't expose them to the device.
+	 */
+	if (vq->req_end != VQ_RING_DESC_CHAIN_END) {
+		while (idx != vq->req_end) {
+			idx = idx + 1 == vq->vq_nentries ? 0 : idx + 1;
+			vq->vq_packed_ring.desc[idx].flags ^= VQ_PACKED_DESC_F_AVAIL;
+		}
+	}
+
+	vq->vq_avail_idx = vq->req_start;
+	vq->vq_packed_ring.avail_flags = vq->vq_packed_ring.req_avail_flags;
+	vq->vq_packed_ring.num_added -= dxp->ndescs;
+	vq_packed_free_id(vq, vq->vq_packed_ring.req_id);
+	vq->req_start = VQ_RING_DESC_CHAIN_END;
+	vq->req_end = VQ_RING_DESC_CHAIN_END;
+}
+
 void
 virtqueue_req_abort(struct virtqueue *vq)
 {
@@ -457,6 +676,11 @@ virtqueue_req_abort(struct virtqueue *vq)
 		return;
 	}
 
+	if (vq->vq_packed) {
+		vq_packed_req_abort(vq);
+		return;
+	}
+
 	desc = &vq->vq_ring.desc[vq->req_end];
 	desc->flags &= ~VRING_DESC_F_NEXT;
 
@@ -464,6 +688,61 @@ virtqueue_req_abort(struct virtqueue *vq)
 	vq->req_start = VQ_RING_DESC_CHAIN_END;
 }
 
+static void
+vq_packed_req_add_iovs(struct virtqueue *vq, struct iovec *iovs, uint16_t iovcnt,
+		       enum spdk_virtio_desc_type desc_type)
+{
+	struct vring_packed_desc *desc;
+	uint16_t i, flags, id = vq->vq_packed_ring.req_id;
+	uint64_t processed_length, iovec_length, current_length;
+	void *current_base;
+	uint16_t used_desc_count = 0;
+
+	for (i = 0; i < iovcnt; ++i) {
+		processed_length = 0;
+		iovec_length = iovs[i].iov_len;
+		current_base = iovs[i].iov_base;
+
+		while (processed_length < iovec_length) {
+			desc = &vq->vq_packed_ring.desc[vq->vq_avail_idx];
+			current_length = iovec_length - processed_length;
+
+			if (!vq->vdev->is_hw) {
+				desc->addr  = (uintptr_t)current_base;
+			} else {
+				desc->addr = spdk_vtophys(current_base, &current_length);
+			}
+
+			desc->len = current_length;
+			desc->id = id;
+			/* always set NEXT flag. unset it on the last descriptor
+			 * in the request-ending function.
+			 */
+			flags = desc_type | VRING_DESC_F_NEXT | vq->vq_packed_ring.avail_flags;
+			if (vq->req_end == VQ_RING_DESC_CHAIN_END) {
+				/* the head descriptor is made available in finish_req() */
+				vq->vq_packed_ring.req_head_flags = flags;
+			} else {
+				desc->flags = flags;
+			}
+
+			vq->req_end = vq->vq_avail_idx;
+			if (++vq->vq_avail_idx == vq->vq_nentries) {
+				vq->vq_avail_idx = 0;
+				vq->vq_packed_ring.avail_flags ^= VQ_PACKED_DESC_F_AVAIL | VQ_PACKED_DESC_F_USED;
+			}
+			used_desc_count++;
+
+			processed_length += current_length;
+			current_base += current_length;
+		}
+	}
+
+	vq->vq_descx[id].ndescs += used_desc_count;
+	vq->vq_packed_ring.num_added += used_desc_count;
+	vq->vq_free_cnt = (uint16_t)(vq->vq_free_cnt - used_desc_count);
+}
+
 void
 virtqueue_req_add_iovs(struct virtqueue *vq, struct iovec *iovs, uint16_t iovcnt,
 		       enum spdk_virtio_desc_type desc_type)
@@ -478,6 +757,11 @@ virtqueue_req_add_iovs(struct virtqueue *vq, struct iovec *iovs, uint16_t iovcnt
 	assert(vq->req_start != VQ_RING_DESC_CHAIN_END);
 	assert(iovcnt <= vq->vq_free_cnt);
 
+	if (vq->vq_packed) {
+		vq_packed_req_add_iovs(vq, iovs, iovcnt, desc_type);
+		return;
+	}
+
 	/* TODO use indirect descriptors if iovcnt is high enough
 	 * or the caller specifies SPDK_VIRTIO_DESC_F_INDIRECT
 	 */
@@ -532,6 +816,10 @@ virtio_recv_pkts(struct virtqueue *vq, void **io, uint32_t *len, uint16_t nb_pkt
 {
 	uint16_t nb_used, num;
 
+	if (vq->vq_packed) {
+		return vq_packed_recv_pkts(vq, io, len, nb_pkts);
+	}
+
 	nb_used = vq->vq_ring.used->idx - vq->vq_used_cons_idx;
 	virtio_rmb();
 
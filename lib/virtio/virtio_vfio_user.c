@@ -245,9 +245,8 @@ virtio_vfio_user_setup_queue(struct virtio_dev *vdev, struct virtqueue *vq)
 	vq->vq_ring_virt_mem = queue_mem;
 
 	desc_addr = vq->vq_ring_mem;
-	avail_addr = desc_addr + vq->vq_nentries * sizeof(struct vring_desc);
-	used_addr = (avail_addr + offsetof(struct vring_avail, ring[vq->vq_nentries])
-		     + VIRTIO_PCI_VRING_ALIGN - 1) & ~(VIRTIO_PCI_VRING_ALIGN - 1);
+	avail_addr = desc_addr + vq->vq_avail_offset;
+	used_addr = desc_addr + vq->vq_used_offset;
 
 	offset = dev->pci_cap_common_cfg_offset + VIRTIO_PCI_COMMON_Q_SELECT;
 	rc = spdk_vfio_user_pci_bar_access(dev->ctx, dev->pci_cap_region,
@@ -531,6 +531,10 @@ virtio_user_kick_queue(struct virtio_dev *vdev, uint32_t queue_sel)
 
 	state.index = queue_sel;
 	state.num = 0; /* no reservation */
+	if (virtio_dev_has_feature(vdev, VIRTIO_F_RING_PACKED)) {
+		/* Packed rings also pass the initial avail wrap counter in bit 15 */
+		state.num |= 1 << 15;
+	}
 	rc = vhost_user_sock(dev, VHOST_USER_SET_VRING_BASE, &state);
 	if (rc < 0) {
 		return rc;
@@ -920,10 +924,8 @@ virtio_user_setup_queue(struct virtio_dev *vdev, struct virtqueue *vq)
 	dev->kickfds[queue_idx] = kickfd;
 
 	desc_addr = (uintptr_t)vq->vq_ring_virt_mem;
-	avail_addr = desc_addr + vq->vq_nentries * sizeof(struct vring_desc);
-	used_addr = SPDK_ALIGN_CEIL(avail_addr + offsetof(struct vring_avail,
-				    ring[vq->vq_nentries]),
-				    VIRTIO_PCI_VRING_ALIGN);
+	avail_addr = desc_addr + vq->vq_avail_offset;
+	used_addr = desc_addr + vq->vq_used_offset;
 
 	dev->vrings[queue_idx].num = vq->vq_nentries;
 	dev->vrings[queue_idx].desc = (void *)(uintptr_t)desc_addr;
@@ -9,6 +9,9 @@
 #include "spdk/string.h"
 #include "spdk/likely.h"
 
+/* How long a hot inserted device is looked for after its link went up */
+#define VMD_HOTPLUG_SCAN_TIMEOUT_US	4000000ULL
+
 static unsigned char *device_type[] = {
 	"PCI Express Endpoint",
 	"Legacy PCI Express Endpoint",
@@ -562,6 +565,8 @@ vmd_init_hotplug(struct vmd_pci_device *dev, struct vmd_pci_bus *bus)
 		TAILQ_INSERT_TAIL(&hp->unused_mem_queue, &hp->mem[mem_id], tailq);
 	}
 
+	TAILQ_INSERT_TAIL(&vmd->hp_bus_list, bus, hp_tailq);
+
 	SPDK_INFOLOG(vmd, "%s: mem_base:mem_limit = %x : %x\n", __func__,
 		     bus->self->header->one.mem_base, bus->self->header->one.mem_limit);
 }
@@ -1306,6 +1311,7 @@ vmd_enum_cb(void *ctx, struct spdk_pci_device *pci_dev)
 	vmd->vmd_index = vmd_c->count;
 	vmd->domain = (pci_dev->addr.bus << 16) | (pci_dev->addr.dev << 8) | pci_dev->addr.func;
 	TAILQ_INIT(&vmd->bus_list);
+	TAILQ_INIT(&vmd->hp_bus_list);
 
 	if (vmd_domain_map_bars(vmd) != 0) {
 		return -1;
@@ -1359,8 +1365,8 @@ vmd_clear_hotplug_status(struct vmd_pci_bus *bus)
 	struct vmd_pci_device *device = bus->self;
 	uint16_t status __attribute__((unused));
 
-	status = device->pcie_cap->slot_status.as_uint16_t;
-	device->pcie_cap->slot_status.as_uint16_t = status;
+	/* Clear the changes reported by the status cached by spdk_vmd_hotplug_monitor() only */
+	device->pcie_cap->slot_status.as_uint16_t = device->hp.slot_status.as_uint16_t;
 	status = device->pcie_cap->slot_status.as_uint16_t;
 
 	status = device->pcie_cap->link_status.as_uint16_t;
@@ -1368,23 +1374,27 @@ vmd_clear_hotplug_status(struct vmd_pci_bus *bus)
 	status = device->pcie_cap->link_status.as_uint16_t;
 }
 
+/*
+ * Look for a hot inserted device. The device may take a while to show up after its link went
+ * up, instead of spinning on the caller's thread, the scan is retried by the next calls to
+ * spdk_vmd_hotplug_monitor() until the deadline.
+ */
 static void
 vmd_bus_handle_hotplug(struct vmd_pci_bus *bus)
 {
-	uint8_t num_devices, sleep_count;
+	uint64_t now = spdk_get_ticks();
 
-	for (sleep_count = 0; sleep_count < 20; ++sleep_count) {
-		/* Scan until a new device is found */
-		num_devices = vmd_scan_single_bus(bus, bus->self, true);
-		if (num_devices > 0) {
-			break;
-		}
-
-		spdk_delay_us(200000);
+	if (vmd_scan_single_bus(bus, bus->self, true) > 0) {
+		bus->hp_scan_deadline = 0;
+		return;
 	}
 
-	if (num_devices == 0) {
+	if (bus->hp_scan_deadline == 0) {
+		bus->hp_scan_deadline = now + VMD_HOTPLUG_SCAN_TIMEOUT_US * spdk_get_ticks_hz() /
+					SPDK_SEC_TO_USEC;
+	} else if (now >= bus->hp_scan_deadline) {
 		SPDK_ERRLOG("Timed out while scanning for hotplugged devices\n");
+		bus->hp_scan_deadline = 0;
 	}
 }
 
@@ -1420,13 +1430,20 @@ spdk_vmd_hotplug_monitor(void)
 	uint32_t i;
 
 	for (i = 0; i < g_vmd_container.count; ++i) {
-		TAILQ_FOREACH(bus, &g_vmd_container.vmd[i].bus_list, tailq) {
+		TAILQ_FOREACH(bus, &g_vmd_container.vmd[i].hp_bus_list, hp_tailq) {
 			device = bus->self;
-			if (device == NULL || !device->hotplug_capable) {
-				continue;
+			assert(device != NULL && device->hotplug_capable);
+
+			if (spdk_unlikely(bus->hp_scan_deadline != 0)) {
+				vmd_bus_handle_hotplug(bus);
+				num_hotplugs++;
 			}
 
-			if (device->pcie_cap->slot_status.bit_field.datalink_state_changed != 1) {
+			/* Each register read is an uncached MMIO access, only the slot status is read
+			 * unless it reports a change.
+			 */
+			device->hp.slot_status.as_uint16_t = device->pcie_cap->slot_status.as_uint16_t;
+			if (spdk_likely(device->hp.slot_status.bit_field.datalink_state_changed != 1)) {
 				continue;
 			}
 
@@ -41,8 +41,12 @@ struct vmd_pci_bus {
 	uint32_t  bus_start       : 8;
 	uint32_t  config_bus_number : 8;
 
+	/* Ticks until which a hot inserted device is looked for, 0 if none is expected */
+	uint64_t  hp_scan_deadline;
+
 	TAILQ_HEAD(, vmd_pci_device) dev_list;	/* list of pci end device attached to this bus */
 	TAILQ_ENTRY(vmd_pci_bus) tailq;		/* link for all buses found during scan */
+	TAILQ_ENTRY(vmd_pci_bus) hp_tailq;	/* link for buses below a hotplug capable slot */
 };
 
 /*
@@ -140,6 +144,8 @@ struct vmd_adapter {
 	struct vmd_pci_bus vmd_bus;
 
 	TAILQ_HEAD(, vmd_pci_bus) bus_list;
+	/* Subset of bus_list whose slots are monitored for hotplug */
+	TAILQ_HEAD(, vmd_pci_bus) hp_bus_list;
 
 	struct event_fifo *hp_queue;
 };
@@ -40,7 +40,7 @@ DEPDIRS-rdma_provider := log util rdma_utils
 ifeq ($(CONFIG_RDMA_PROV),mlx5_dv)
 DEPDIRS-rdma_provider += dma mlx5
 endif
-DEPDIRS-reduce := log util
+DEPDIRS-reduce := log util thread
 DEPDIRS-thread := log util trace
 DEPDIRS-keyring := log util $(JSON_LIBS)
 
@@ -61,7 +61,7 @@ DEPDIRS-lvol := log util blob thread
 DEPDIRS-rpc := log util json jsonrpc
 
 DEPDIRS-net := log util $(JSON_LIBS)
-DEPDIRS-notify := log util $(JSON_LIBS)
+DEPDIRS-notify := log util thread $(JSON_LIBS)
 DEPDIRS-trace := log util $(JSON_LIBS)
 
 DEPDIRS-bdev := accel log util thread $(JSON_LIBS) notify trace dma
@@ -85,7 +85,7 @@ DEPDIRS-mlx5 = log rdma_utils util
 endif
 DEPDIRS-scsi := log util thread $(JSON_LIBS) trace bdev
 
-DEPDIRS-iscsi := log sock util conf thread $(JSON_LIBS) trace scsi
+DEPDIRS-iscsi := accel log sock util conf thread $(JSON_LIBS) trace scsi
 DEPDIRS-vhost = log util thread $(JSON_LIBS) bdev scsi
 
 DEPDIRS-fsdev := log thread util $(JSON_LIBS) notify
@@ -148,6 +148,7 @@ DEPDIRS-bdev_split := $(BDEV_DEPS)
 DEPDIRS-bdev_aio := $(BDEV_DEPS_THREAD)
 DEPDIRS-bdev_compress := $(BDEV_DEPS_THREAD) reduce accel
 DEPDIRS-bdev_crypto := $(BDEV_DEPS_THREAD) accel
+DEPDIRS-bdev_dedup := $(BDEV_DEPS_THREAD) accel
 DEPDIRS-bdev_delay := $(BDEV_DEPS_THREAD)
 DEPDIRS-bdev_error := $(BDEV_DEPS_THREAD)
 DEPDIRS-bdev_iscsi := $(BDEV_DEPS_THREAD)
@@ -157,12 +158,16 @@ DEPDIRS-bdev_nvme = $(BDEV_DEPS_THREAD) accel keyring nvme trace
 DEPDIRS-bdev_ocf := $(BDEV_DEPS_THREAD)
 DEPDIRS-bdev_passthru := $(BDEV_DEPS_THREAD)
 DEPDIRS-bdev_raid := $(BDEV_DEPS_THREAD) trace
-ifeq ($(CONFIG_RAID5F),y)
+ifneq ($(filter y,$(CONFIG_RAID5F) $(CONFIG_RAID6F)),)
 DEPDIRS-bdev_raid += accel
 endif
 DEPDIRS-bdev_rbd := $(BDEV_DEPS_THREAD)
+DEPDIRS-bdev_readahead := $(BDEV_DEPS_THREAD)
+DEPDIRS-bdev_replica := $(BDEV_DEPS_THREAD) accel
+DEPDIRS-bdev_tier := $(BDEV_DEPS_THREAD)
 DEPDIRS-bdev_uring := $(BDEV_DEPS_THREAD)
 DEPDIRS-bdev_virtio := $(BDEV_DEPS_THREAD) virtio
+DEPDIRS-bdev_wbcache := $(BDEV_DEPS_THREAD)
 DEPDIRS-bdev_zone_block := $(BDEV_DEPS_THREAD)
 DEPDIRS-bdev_xnvme := $(BDEV_DEPS_THREAD)
 
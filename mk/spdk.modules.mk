@@ -6,7 +6,9 @@
 
 BLOCKDEV_MODULES_LIST = bdev_malloc bdev_null bdev_nvme bdev_passthru bdev_lvol
 BLOCKDEV_MODULES_LIST += bdev_raid bdev_error bdev_gpt bdev_split bdev_delay
-BLOCKDEV_MODULES_LIST += bdev_zone_block
+BLOCKDEV_MODULES_LIST += bdev_zone_block bdev_readahead bdev_wbcache bdev_tier
+BLOCKDEV_MODULES_LIST += bdev_dedup
+BLOCKDEV_MODULES_LIST += bdev_replica
 BLOCKDEV_MODULES_LIST += blobfs blobfs_bdev blob_bdev blob lvol vmd nvme
 
 # Some bdev modules don't have pollers, so they can directly run in interrupt mode
@@ -27,6 +27,8 @@
 
 static bool g_dsa_enable = false;
 static bool g_kernel_mode = false;
+static uint16_t g_max_batch_size = ACCEL_DSA_DEFAULT_MAX_BATCH_SIZE;
+static uint32_t g_batch_latency_us = ACCEL_DSA_DEFAULT_BATCH_LATENCY_US;
 
 enum channel_state {
 	IDXD_CHANNEL_ACTIVE,
@@ -574,7 +576,7 @@ attach_cb(void *cb_ctx, struct spdk_idxd_device *idxd)
 }
 
 int
-accel_dsa_enable_probe(bool kernel_mode)
+accel_dsa_enable_probe(bool kernel_mode, uint16_t max_batch_size, uint32_t batch_latency_us)
 {
 	int rc;
 
@@ -587,8 +589,15 @@ accel_dsa_enable_probe(bool kernel_mode)
 		return rc;
 	}
 
+	rc = spdk_idxd_set_batch_opts(max_batch_size, batch_latency_us);
+	if (rc != 0) {
+		return rc;
+	}
+
 	spdk_accel_module_list_add(&g_dsa_module);
 	g_kernel_mode = kernel_mode;
+	g_max_batch_size = max_batch_size;
+	g_batch_latency_us = batch_latency_us;
 	g_dsa_enable = true;
 
 	return 0;
@@ -662,6 +671,8 @@ accel_dsa_write_config_json(struct spdk_json_write_ctx *w)
 		spdk_json_write_named_string(w, "method", "dsa_scan_accel_module");
 		spdk_json_write_named_object_begin(w, "params");
 		spdk_json_write_named_bool(w, "config_kernel_mode", g_kernel_mode);
+		spdk_json_write_named_uint16(w, "max_batch_size", g_max_batch_size);
+		spdk_json_write_named_uint32(w, "batch_latency_us", g_batch_latency_us);
 		spdk_json_write_object_end(w);
 		spdk_json_write_object_end(w);
 	}
@@ -8,6 +8,11 @@
 
 #include "spdk/stdinc.h"
 
-int accel_dsa_enable_probe(bool kernel_mode);
+/* Number of descriptors after which a batch is submitted to the device */
+#define ACCEL_DSA_DEFAULT_MAX_BATCH_SIZE	32
+/* By default, the batch is submitted on every poll */
+#define ACCEL_DSA_DEFAULT_BATCH_LATENCY_US	0
+
+int accel_dsa_enable_probe(bool kernel_mode, uint16_t max_batch_size, uint32_t batch_latency_us);
 
 #endif /* SPDK_ACCEL_ENGINE_DSA_H */
@@ -14,17 +14,24 @@
 
 struct rpc_dsa_scan_accel_module {
 	bool config_kernel_mode;
+	uint16_t max_batch_size;
+	uint32_t batch_latency_us;
 };
 
 static const struct spdk_json_object_decoder rpc_dsa_scan_accel_module_decoder[] = {
 	{"config_kernel_mode", offsetof(struct rpc_dsa_scan_accel_module, config_kernel_mode), spdk_json_decode_bool, true},
+	{"max_batch_size", offsetof(struct rpc_dsa_scan_accel_module, max_batch_size), spdk_json_decode_uint16, true},
+	{"batch_latency_us", offsetof(struct rpc_dsa_scan_accel_module, batch_latency_us), spdk_json_decode_uint32, true},
 };
 
 static void
 rpc_dsa_scan_accel_module(struct spdk_jsonrpc_request *request,
 			  const struct spdk_json_val *params)
 {
-	struct rpc_dsa_scan_accel_module req = {};
+	struct rpc_dsa_scan_accel_module req = {
+		.max_batch_size = ACCEL_DSA_DEFAULT_MAX_BATCH_SIZE,
+		.batch_latency_us = ACCEL_DSA_DEFAULT_BATCH_LATENCY_US,
+	};
 	int rc;
 
 	if (params != NULL) {
@@ -38,7 +45,7 @@ rpc_dsa_scan_accel_module(struct spdk_jsonrpc_request *request,
 		}
 	}
 
-	rc = accel_dsa_enable_probe(req.config_kernel_mode);
+	rc = accel_dsa_enable_probe(req.config_kernel_mode, req.max_batch_size, req.batch_latency_us);
 	if (rc != 0) {
 		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
 		return;
@@ -65,6 +65,7 @@ struct accel_mlx5_dev_ctx {
 	bool mkeys;
 	bool crypto_mkeys;
 	bool sig_mkeys;
+	bool sig_crypto_mkeys;
 	bool crypto_multi_block;
 };
 
@@ -74,6 +75,7 @@ enum accel_mlx5_opcode {
 	ACCEL_MLX5_OPC_CRC32C,
 	ACCEL_MLX5_OPC_CRYPTO_MKEY,
 	ACCEL_MLX5_OPC_MKEY,
+	ACCEL_MLX5_OPC_ENCRYPT_AND_CRC32C,
 	ACCEL_MLX5_OPC_LAST
 };
 
@@ -83,6 +85,7 @@ SPDK_STATIC_ASSERT(ACCEL_MLX5_OPC_LAST <= 0xf,
 struct accel_mlx5_stats {
 	uint64_t crypto_umrs;
 	uint64_t sig_umrs;
+	uint64_t sig_crypto_umrs;
 	uint64_t umrs;
 	uint64_t rdma_reads;
 	uint64_t rdma_writes;
@@ -194,6 +197,7 @@ struct accel_mlx5_dev {
 	struct spdk_mlx5_mkey_pool *mkeys;
 	struct spdk_mlx5_mkey_pool *crypto_mkeys;
 	struct spdk_mlx5_mkey_pool *sig_mkeys;
+	struct spdk_mlx5_mkey_pool *sig_crypto_mkeys;
 	struct spdk_rdma_utils_mem_map *mmap;
 	struct accel_mlx5_dev_ctx *dev_ctx;
 	struct spdk_io_channel *ch;
@@ -330,7 +334,7 @@ static inline void
 accel_mlx5_task_fail(struct accel_mlx5_task *task, int rc)
 {
 	struct accel_mlx5_dev *dev = task->qp->dev;
-	struct spdk_accel_task *next;
+	struct spdk_accel_task *next, *merged = NULL;
 	struct spdk_accel_sequence *seq;
 	bool driver_seq;
 
@@ -348,14 +352,26 @@ accel_mlx5_task_fail(struct accel_mlx5_task *task, int rc)
 		if (task->mlx5_opcode == ACCEL_MLX5_OPC_MKEY) {
 			spdk_mlx5_mkey_pool_put_bulk(dev->mkeys, task->mkeys, task->num_ops);
 		}
+		if (task->mlx5_opcode == ACCEL_MLX5_OPC_ENCRYPT_AND_CRC32C) {
+			spdk_mlx5_mkey_pool_put_bulk(dev->sig_crypto_mkeys, task->mkeys, task->num_ops);
+			spdk_mempool_put(dev->dev_ctx->psv_pool, task->psv);
+		}
 	}
 	next = spdk_accel_sequence_next_task(&task->base);
+	if (task->mlx5_opcode == ACCEL_MLX5_OPC_ENCRYPT_AND_CRC32C) {
+		/* The crc32c task was merged into this one and fails with it */
+		merged = next;
+		next = spdk_accel_sequence_next_task(merged);
+	}
 	seq = task->base.seq;
 	driver_seq = task->driver_seq;
 
 	assert(task->num_reqs == task->num_completed_reqs);
 	SPDK_DEBUGLOG(accel_mlx5, "Fail task %p, opc %d, rc %d\n", task, task->mlx5_opcode, rc);
 	spdk_accel_task_complete(&task->base, rc);
+	if (merged) {
+		spdk_accel_task_complete(merged, rc);
+	}
 
 	if (driver_seq) {
 		struct spdk_io_channel *ch = task->qp->dev->ch;
@@ -1508,12 +1524,13 @@ accel_mlx5_crc_task_process(struct accel_mlx5_task *mlx5_task)
 }
 
 static inline int
-accel_mlx5_task_alloc_crc_ctx(struct accel_mlx5_task *task, uint32_t qp_slot)
+accel_mlx5_task_alloc_crc_ctx(struct accel_mlx5_task *task, struct spdk_mlx5_mkey_pool *pool,
+			      uint32_t qp_slot)
 {
 	struct accel_mlx5_qp *qp = task->qp;
 	struct accel_mlx5_dev *dev = qp->dev;
 
-	if (spdk_unlikely(!accel_mlx5_task_alloc_mkeys(task, dev->sig_mkeys))) {
+	if (spdk_unlikely(!accel_mlx5_task_alloc_mkeys(task, pool))) {
 		SPDK_DEBUGLOG(accel_mlx5, "no mkeys in signature mkey pool, dev %s\n",
 			      dev->dev_ctx->context->device->name);
 		dev->stats.nomem_mkey++;
@@ -1522,7 +1539,7 @@ accel_mlx5_task_alloc_crc_ctx(struct accel_mlx5_task *task, uint32_t qp_slot)
 	task->psv = spdk_mempool_get(dev->dev_ctx->psv_pool);
 	if (spdk_unlikely(!task->psv)) {
 		SPDK_DEBUGLOG(accel_mlx5, "no reqs in psv pool, dev %s\n", dev->dev_ctx->context->device->name);
-		spdk_mlx5_mkey_pool_put_bulk(dev->sig_mkeys, task->mkeys, task->num_ops);
+		spdk_mlx5_mkey_pool_put_bulk(pool, task->mkeys, task->num_ops);
 		task->num_ops = 0;
 		dev->stats.nomem_mkey++;
 		return -ENOMEM;
@@ -1533,7 +1550,7 @@ accel_mlx5_task_alloc_crc_ctx(struct accel_mlx5_task *task, uint32_t qp_slot)
 
 		if (qp_slot < n_slots) {
 			spdk_mempool_put(dev->dev_ctx->psv_pool, task->psv);
-			spdk_mlx5_mkey_pool_put_bulk(dev->sig_mkeys, task->mkeys, task->num_ops);
+			spdk_mlx5_mkey_pool_put_bulk(pool, task->mkeys, task->num_ops);
 			dev->stats.nomem_qdepth++;
 			task->num_ops = 0;
 			return -ENOMEM;
@@ -1554,7 +1571,7 @@ accel_mlx5_crc_task_continue(struct accel_mlx5_task *task)
 	assert(task->num_reqs > task->num_completed_reqs);
 	if (task->num_ops == 0) {
 		/* No mkeys allocated, try to allocate now. */
-		rc = accel_mlx5_task_alloc_crc_ctx(task, qp_slot);
+		rc = accel_mlx5_task_alloc_crc_ctx(task, dev->sig_mkeys, qp_slot);
 		if (spdk_unlikely(rc)) {
 			STAILQ_INSERT_TAIL(&dev->nomem, task, link);
 			return -ENOMEM;
@@ -1682,7 +1699,7 @@ accel_mlx5_crc_task_init(struct accel_mlx5_task *mlx5_task)
 				      mlx5_task->dst.iov, mlx5_task->dst.iovcnt);
 	}
 
-	rc = accel_mlx5_task_alloc_crc_ctx(mlx5_task, qp_slot);
+	rc = accel_mlx5_task_alloc_crc_ctx(mlx5_task, qp->dev->sig_mkeys, qp_slot);
 	if (spdk_unlikely(rc)) {
 		return rc;
 	}
@@ -1697,6 +1714,205 @@ accel_mlx5_crc_task_init(struct accel_mlx5_task *mlx5_task)
 	return 0;
 }
 
+static inline void
+accel_mlx5_encrypt_crc_task_complete(struct accel_mlx5_task *mlx5_task)
+{
+	struct accel_mlx5_dev *dev = mlx5_task->qp->dev;
+	struct spdk_accel_task *crc_task = spdk_accel_sequence_next_task(&mlx5_task->base);
+
+	assert(crc_task && crc_task->op_code == SPDK_ACCEL_OPC_CRC32C);
+	*crc_task->crc_dst = mlx5_task->psv->crc ^ UINT32_MAX;
+	/* Normal task completion without allocated mkeys is not possible */
+	assert(mlx5_task->num_ops);
+	spdk_mlx5_mkey_pool_put_bulk(dev->sig_crypto_mkeys, mlx5_task->mkeys, mlx5_task->num_ops);
+	spdk_mempool_put(dev->dev_ctx->psv_pool, mlx5_task->psv);
+	spdk_accel_task_complete(&mlx5_task->base, 0);
+	spdk_accel_task_complete(crc_task, 0);
+}
+
+static inline int
+accel_mlx5_encrypt_crc_task_process(struct accel_mlx5_task *mlx5_task)
+{
+	struct spdk_accel_task *task = &mlx5_task->base;
+	struct spdk_accel_task *crc_task = spdk_accel_sequence_next_task(task);
+	struct accel_mlx5_qp *qp = mlx5_task->qp;
+	struct accel_mlx5_dev *dev = qp->dev;
+	struct spdk_mlx5_crypto_dek_data dek_data;
+	struct spdk_mlx5_umr_crypto_attr cattr;
+	struct spdk_mlx5_umr_sig_attr sattr;
+	struct spdk_mlx5_umr_attr umr_attr;
+	struct accel_mlx5_sge sges;
+	uint16_t qp_slot = accel_mlx5_dev_get_available_slots(dev, qp);
+	struct ibv_sge *sge;
+	uint16_t sge_count;
+	int rc;
+
+	assert(crc_task && crc_task->op_code == SPDK_ACCEL_OPC_CRC32C);
+	assert(mlx5_task->num_reqs == 1);
+	if (spdk_unlikely(qp_slot < 2)) {
+		return -EINVAL;
+	}
+
+	rc = spdk_mlx5_crypto_get_dek_data(task->crypto_key->priv, dev->dev_ctx->pd, &dek_data);
+	if (spdk_unlikely(rc)) {
+		return rc;
+	}
+
+	mlx5_task->num_wrs = 0;
+	rc = accel_mlx5_crc_task_fill_sge(mlx5_task, &sges);
+	if (spdk_unlikely(rc)) {
+		return rc;
+	}
+
+	cattr.xts_iv = task->iv;
+	cattr.keytag = 0;
+	cattr.dek_obj_id = dek_data.dek_obj_id;
+	cattr.tweak_mode = dek_data.tweak_mode;
+	cattr.enc_order = mlx5_task->enc_order;
+	cattr.bs_selector = bs_to_bs_selector(task->block_size);
+	if (spdk_unlikely(cattr.bs_selector == SPDK_MLX5_BLOCK_SIZE_SELECTOR_RESERVED)) {
+		SPDK_ERRLOG("unsupported block size %u\n", task->block_size);
+		return -EINVAL;
+	}
+	sattr.seed = crc_task->seed ^ UINT32_MAX;
+	sattr.psv_index = mlx5_task->psv->psv_index;
+	sattr.domain = SPDK_MLX5_UMR_SIG_DOMAIN_WIRE;
+	sattr.sigerr_count = mlx5_task->mkeys[0]->sig.sigerr_count;
+	sattr.raw_data_size = task->nbytes;
+	sattr.init = true;
+	sattr.check_gen = true;
+	umr_attr.mkey = mlx5_task->mkeys[0]->mkey;
+	umr_attr.umr_len = task->nbytes;
+	umr_attr.sge_count = sges.src_sge_count;
+	umr_attr.sge = sges.src_sge;
+
+	SPDK_DEBUGLOG(accel_mlx5, "task %p: bs %u, iv %"PRIu64", len %"PRIu64", seed %x, mkey %x\n",
+		      mlx5_task, task->block_size, cattr.xts_iv, task->nbytes, crc_task->seed, umr_attr.mkey);
+
+	rc = spdk_mlx5_umr_configure_sig_crypto(qp->qp, &umr_attr, &sattr, &cattr, 0, 0);
+	if (spdk_unlikely(rc)) {
+		SPDK_ERRLOG("UMR configure failed with %d\n", rc);
+		return rc;
+	}
+	ACCEL_MLX5_UPDATE_ON_WR_SUBMITTED(qp, mlx5_task);
+	dev->stats.sig_crypto_umrs++;
+
+	if (mlx5_task->inplace) {
+		sge = sges.src_sge;
+		sge_count = sges.src_sge_count;
+	} else {
+		sge = sges.dst_sge;
+		sge_count = sges.dst_sge_count;
+	}
+
+	/*
+	 * Add the crc destination to the end of sges. A free entry must be available for CRC
+	 * because the sequence was merged only if the destination has one.
+	 */
+	assert(sge_count < ACCEL_MLX5_MAX_SGE);
+	sge[sge_count].lkey = mlx5_task->psv->crc_lkey;
+	sge[sge_count].addr = (uintptr_t)&mlx5_task->psv->crc;
+	sge[sge_count++].length = sizeof(uint32_t);
+
+	if (spdk_unlikely(mlx5_task->psv->bits.error)) {
+		rc = spdk_mlx5_qp_set_psv(qp->qp, mlx5_task->psv->psv_index, *crc_task->crc_dst, 0, 0);
+		if (spdk_unlikely(rc)) {
+			SPDK_ERRLOG("SET_PSV failed with %d\n", rc);
+			return rc;
+		}
+		ACCEL_MLX5_UPDATE_ON_WR_SUBMITTED(qp, mlx5_task);
+	}
+
+	/* UMR is used as a source of RDMA_READ, the encrypted data and its CRC land in sge */
+	rc = spdk_mlx5_qp_rdma_read(qp->qp, sge, sge_count, 0, mlx5_task->mkeys[0]->mkey,
+				    (uint64_t)mlx5_task, SPDK_MLX5_WQE_CTRL_STRONG_ORDERING | SPDK_MLX5_WQE_CTRL_CE_CQ_UPDATE);
+	if (spdk_unlikely(rc)) {
+		SPDK_ERRLOG("RDMA READ/WRITE failed with %d\n", rc);
+		return rc;
+	}
+	mlx5_task->num_submitted_reqs++;
+	ACCEL_MLX5_UPDATE_ON_WR_SUBMITTED_SIGNALED(dev, qp, mlx5_task);
+	dev->stats.rdma_reads++;
+	STAILQ_INSERT_TAIL(&qp->in_hw, mlx5_task, link);
+
+	return 0;
+}
+
+static inline int
+accel_mlx5_encrypt_crc_task_continue(struct accel_mlx5_task *task)
+{
+	struct accel_mlx5_qp *qp = task->qp;
+	struct accel_mlx5_dev *dev = qp->dev;
+	uint16_t qp_slot = accel_mlx5_dev_get_available_slots(dev, qp);
+	int rc;
+
+	assert(task->num_reqs > task->num_completed_reqs);
+	if (task->num_ops == 0) {
+		/* No mkeys allocated, try to allocate now. */
+		rc = accel_mlx5_task_alloc_crc_ctx(task, dev->sig_crypto_mkeys, qp_slot);
+		if (spdk_unlikely(rc)) {
+			STAILQ_INSERT_TAIL(&dev->nomem, task, link);
+			return -ENOMEM;
+		}
+	}
+	/* We need to post at least 1 UMR and 1 RDMA operation */
+	if (spdk_unlikely(qp_slot < 2)) {
+		STAILQ_INSERT_TAIL(&dev->nomem, task, link);
+		dev->stats.nomem_qdepth++;
+		return -ENOMEM;
+	}
+
+	return accel_mlx5_encrypt_crc_task_process(task);
+}
+
+static inline int
+accel_mlx5_encrypt_crc_task_init(struct accel_mlx5_task *mlx5_task)
+{
+	struct spdk_accel_task *task = &mlx5_task->base;
+	struct accel_mlx5_qp *qp = mlx5_task->qp;
+	uint32_t qp_slot = accel_mlx5_dev_get_available_slots(qp->dev, qp);
+	bool crypto_key_ok;
+	int rc;
+
+	crypto_key_ok = (task->crypto_key && task->crypto_key->module_if == &g_accel_mlx5.module &&
+			 task->crypto_key->priv);
+	if (spdk_unlikely((task->nbytes % task->block_size != 0) || !crypto_key_ok)) {
+		if (crypto_key_ok) {
+			SPDK_ERRLOG("src length %"PRIu64" is not a multiple of the block size %u\n", task->nbytes,
+				    task->block_size);
+		} else {
+			SPDK_ERRLOG("Wrong crypto key provided\n");
+		}
+		return -EINVAL;
+	}
+
+	accel_mlx5_iov_sgl_init(&mlx5_task->src, task->s.iovs, task->s.iovcnt);
+	if (task->d.iovcnt == 0 || (task->d.iovcnt == task->s.iovcnt &&
+				    accel_mlx5_compare_iovs(task->d.iovs, task->s.iovs, task->s.iovcnt))) {
+		mlx5_task->inplace = 1;
+	} else {
+		mlx5_task->inplace = 0;
+		accel_mlx5_iov_sgl_init(&mlx5_task->dst, task->d.iovs, task->d.iovcnt);
+	}
+	/* The sequence is merged only if the whole payload and the CRC fit into a single request */
+	mlx5_task->num_reqs = 1;
+
+	rc = accel_mlx5_task_alloc_crc_ctx(mlx5_task, qp->dev->sig_crypto_mkeys, qp_slot);
+	if (spdk_unlikely(rc)) {
+		return rc;
+	}
+
+	if (spdk_unlikely(qp_slot < 2)) {
+		/* Queue is full, queue this task */
+		SPDK_DEBUGLOG(accel_mlx5, "dev %s qp %p is full\n", qp->dev->dev_ctx->context->device->name,
+			      mlx5_task->qp);
+		qp->dev->stats.nomem_qdepth++;
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
 static inline int
 accel_mlx5_crypto_mkey_task_init(struct accel_mlx5_task *mlx5_task)
 {
@@ -2028,6 +2244,12 @@ static struct accel_mlx5_task_operations g_accel_mlx5_tasks_ops[] = {
 		.cont = accel_mlx5_mkey_task_continue,
 		.complete = accel_mlx5_mkey_task_complete,
 	},
+	[ACCEL_MLX5_OPC_ENCRYPT_AND_CRC32C] = {
+		.init = accel_mlx5_encrypt_crc_task_init,
+		.process = accel_mlx5_encrypt_crc_task_process,
+		.cont = accel_mlx5_encrypt_crc_task_continue,
+		.complete = accel_mlx5_encrypt_crc_task_complete,
+	},
 	[ACCEL_MLX5_OPC_LAST] = {
 		.init = accel_mlx5_task_op_not_supported,
 		.process = accel_mlx5_task_op_not_implemented,
@@ -2094,6 +2316,10 @@ accel_mlx5_task_complete(struct accel_mlx5_task *task)
 	}
 
 	next = spdk_accel_sequence_next_task(&task->base);
+	if (task->mlx5_opcode == ACCEL_MLX5_OPC_ENCRYPT_AND_CRC32C) {
+		/* The crc32c task was merged into this one and is completed with it */
+		next = spdk_accel_sequence_next_task(next);
+	}
 	driver_seq = task->driver_seq;
 
 	assert(task->num_reqs == task->num_completed_reqs);
@@ -2502,6 +2728,7 @@ accel_mlx5_add_stats(struct accel_mlx5_stats *stats, const struct accel_mlx5_sta
 
 	stats->crypto_umrs += to_add->crypto_umrs;
 	stats->sig_umrs += to_add->sig_umrs;
+	stats->sig_crypto_umrs += to_add->sig_crypto_umrs;
 	stats->umrs += to_add->umrs;
 	stats->rdma_reads += to_add->rdma_reads;
 	stats->rdma_writes += to_add->rdma_writes;
@@ -2539,6 +2766,9 @@ accel_mlx5_destroy_cb(void *io_device, void *ctx_buf)
 		if (dev->sig_mkeys) {
 			spdk_mlx5_mkey_pool_put_ref(dev->sig_mkeys);
 		}
+		if (dev->sig_crypto_mkeys) {
+			spdk_mlx5_mkey_pool_put_ref(dev->sig_crypto_mkeys);
+		}
 		spdk_rdma_utils_free_mem_map(&dev->mmap);
 		spdk_spin_lock(&g_accel_mlx5.lock);
 		accel_mlx5_add_stats(&g_accel_mlx5.stats, &dev->stats);
@@ -2598,6 +2828,18 @@ accel_mlx5_create_cb(void *io_device, void *ctx_buf)
 				goto err_out;
 			}
 		}
+		if (dev_ctx->sig_crypto_mkeys) {
+			dev->sig_crypto_mkeys = spdk_mlx5_mkey_pool_get_ref(dev_ctx->pd, SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO |
+						SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE);
+			if (!dev->sig_crypto_mkeys) {
+				SPDK_ERRLOG("Failed to get sig_crypto mkey pool channel, dev %s\n",
+					    dev_ctx->context->device->name);
+				/* Should not happen since mkey pool is created on accel_mlx5 initialization.
+				 * We should not be here if pool creation failed */
+				assert(0);
+				goto err_out;
+			}
+		}
 
 		memset(&cq_attr, 0, sizeof(cq_attr));
 		cq_attr.cqe_cnt = g_accel_mlx5.attr.qp_size;
@@ -2812,6 +3054,10 @@ accel_mlx5_free_resources(void)
 			if (dev_ctx->sig_mkeys) {
 				spdk_mlx5_mkey_pool_destroy(SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE, dev_ctx->pd);
 			}
+			if (dev_ctx->sig_crypto_mkeys) {
+				spdk_mlx5_mkey_pool_destroy(SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO | SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE,
+							    dev_ctx->pd);
+			}
 			spdk_rdma_utils_put_pd(dev_ctx->pd);
 		}
 		if (dev_ctx->domain) {
@@ -2992,6 +3238,16 @@ accel_mlx5_dev_ctx_init(struct accel_mlx5_dev_ctx *dev_ctx, struct ibv_context *
 			return rc;
 		}
 	}
+	if (g_accel_mlx5.crypto_supported && g_accel_mlx5.crc32c_supported) {
+		/* Used to encrypt data and calculate crc32c of the result in a single UMR */
+		rc = accel_mlx5_mkeys_create(pd, g_accel_mlx5.attr.num_requests,
+					     SPDK_MLX5_MKEY_POOL_FLAG_CRYPTO | SPDK_MLX5_MKEY_POOL_FLAG_SIGNATURE);
+		if (rc) {
+			SPDK_ERRLOG("Failed to create sig_crypto mkeys pool, rc %d, dev %s\n", rc, dev->device->name);
+			return rc;
+		}
+		dev_ctx->sig_crypto_mkeys = true;
+	}
 
 	return 0;
 }
@@ -3275,8 +3531,10 @@ accel_mlx5_dump_stats_json(struct spdk_json_write_ctx *w, const char *header,
 	spdk_json_write_named_object_begin(w, "umrs");
 	spdk_json_write_named_uint64(w, "crypto_umrs", stats->crypto_umrs);
 	spdk_json_write_named_uint64(w, "sig_umrs", stats->sig_umrs);
+	spdk_json_write_named_uint64(w, "sig_crypto_umrs", stats->sig_crypto_umrs);
 	spdk_json_write_named_uint64(w, "umrs", stats->umrs);
-	spdk_json_write_named_uint64(w, "total", stats->crypto_umrs + stats->sig_umrs + stats->umrs);
+	spdk_json_write_named_uint64(w, "total", stats->crypto_umrs + stats->sig_umrs +
+				     stats->sig_crypto_umrs + stats->umrs);
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_named_object_begin(w, "rdma");
@@ -3301,6 +3559,7 @@ accel_mlx5_dump_stats_json(struct spdk_json_write_ctx *w, const char *header,
 	spdk_json_write_named_uint64(w, "crypto_mkey", stats->opcodes[ACCEL_MLX5_OPC_CRYPTO_MKEY]);
 	spdk_json_write_named_uint64(w, "crc32c", stats->opcodes[ACCEL_MLX5_OPC_CRC32C]);
 	spdk_json_write_named_uint64(w, "mkey", stats->opcodes[ACCEL_MLX5_OPC_MKEY]);
+	spdk_json_write_named_uint64(w, "encrypt_crc32c", stats->opcodes[ACCEL_MLX5_OPC_ENCRYPT_AND_CRC32C]);
 	spdk_json_write_named_uint64(w, "total", total_tasks);
 	spdk_json_write_object_end(w);
 
@@ -3489,6 +3748,36 @@ accel_mlx5_task_assign_qp_by_domain_pd(struct accel_mlx5_task *task,
 	return 0;
 }
 
+static inline bool
+accel_mlx5_encrypt_crc_can_merge(struct spdk_accel_task *encrypt, struct spdk_accel_task *crc)
+{
+	struct spdk_memory_domain *dst_domain;
+	struct iovec *dst_iovs;
+	void *dst_domain_ctx;
+	uint32_t dst_iovcnt;
+
+	if (encrypt->d.iovcnt == 0) {
+		dst_iovs = encrypt->s.iovs;
+		dst_iovcnt = encrypt->s.iovcnt;
+		dst_domain = encrypt->src_domain;
+		dst_domain_ctx = encrypt->src_domain_ctx;
+	} else {
+		dst_iovs = encrypt->d.iovs;
+		dst_iovcnt = encrypt->d.iovcnt;
+		dst_domain = encrypt->dst_domain;
+		dst_domain_ctx = encrypt->dst_domain_ctx;
+	}
+
+	/* crc32c must be calculated over the encrypted data */
+	if (crc->s.iovcnt != dst_iovcnt || !accel_mlx5_compare_iovs(crc->s.iovs, dst_iovs, dst_iovcnt) ||
+	    crc->src_domain != dst_domain || crc->src_domain_ctx != dst_domain_ctx) {
+		return false;
+	}
+
+	/* Both tasks must fit into a single UMR, one destination sge is reserved for CRC */
+	return encrypt->s.iovcnt <= ACCEL_MLX5_MAX_SGE && dst_iovcnt + 1 <= ACCEL_MLX5_MAX_SGE;
+}
+
 static inline int
 accel_mlx5_driver_examine_sequence(struct spdk_accel_sequence *seq,
 				   struct accel_mlx5_io_channel *accel_ch)
@@ -3563,6 +3852,21 @@ accel_mlx5_driver_examine_sequence(struct spdk_accel_sequence *seq,
 				spdk_accel_task_complete(next_base, 0);
 				return 0;
 			}
+			if (next_base->op_code == SPDK_ACCEL_OPC_CRC32C && TAILQ_NEXT(next_base, seq_link) == NULL &&
+			    accel_mlx5_encrypt_crc_can_merge(first_base, next_base)) {
+				accel_mlx5_task_assign_qp(first, accel_ch);
+				if (first->qp->dev->sig_crypto_mkeys && first->qp->dev->crypto_multi_block) {
+					/* Encrypt and calculate crc32c of the encrypted data in one UMR, crc32c task
+					 * is completed together with the encrypt one */
+					SPDK_DEBUGLOG(accel_mlx5, "Merge encrypt task (%p) and crc32c (%p)\n", first,
+						      SPDK_CONTAINEROF(next_base, struct accel_mlx5_task, base));
+					first->mlx5_opcode = ACCEL_MLX5_OPC_ENCRYPT_AND_CRC32C;
+					first->enc_order = SPDK_MLX5_ENCRYPTION_ORDER_ENCRYPTED_WIRE_SIGNATURE;
+				} else {
+					accel_mlx5_task_init_opcode(first);
+				}
+				return 0;
+			}
 			break;
 
 		default:
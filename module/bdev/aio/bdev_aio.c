@@ -27,12 +27,18 @@
 #include <libaio.h>
 #endif
 
+#define SPDK_AIO_QUEUE_DEPTH 128
+#define MAX_EVENTS_PER_POLL 32
+
 struct bdev_aio_io_channel {
 	uint64_t				io_inflight;
 #ifdef __FreeBSD__
 	int					kqfd;
 #else
 	io_context_t				io_ctx;
+	/* Requests prepared since the last group poll, submitted there with a single io_submit() */
+	struct iocb				*pending_iocbs[SPDK_AIO_QUEUE_DEPTH];
+	uint32_t				num_pending;
 #endif
 	struct bdev_aio_group_channel		*group_ch;
 	TAILQ_ENTRY(bdev_aio_io_channel)	link;
@@ -93,9 +99,6 @@ static void bdev_aio_fini(void);
 static void aio_free_disk(struct file_disk *fdisk);
 static TAILQ_HEAD(, file_disk) g_aio_disk_head = TAILQ_HEAD_INITIALIZER(g_aio_disk_head);
 
-#define SPDK_AIO_QUEUE_DEPTH 128
-#define MAX_EVENTS_PER_POLL 32
-
 static int
 bdev_aio_get_ctx_size(void)
 {
@@ -220,7 +223,58 @@ bdev_aio_submit_io(enum spdk_bdev_io_type type, struct file_disk *fdisk,
 	aio_task->len = nbytes;
 	aio_task->ch = aio_ch;
 
-	return io_submit(aio_ch->io_ctx, 1, &iocb);
+	if (aio_ch->group_ch->efd >= 0) {
+		/* There is no group poll to submit it in interrupt mode */
+		return io_submit(aio_ch->io_ctx, 1, &iocb);
+	}
+
+	aio_ch->pending_iocbs[aio_ch->num_pending++] = iocb;
+
+	return 0;
+}
+
+static int
+bdev_aio_io_channel_submit_pending(struct bdev_aio_io_channel *aio_ch)
+{
+	struct iocb *iocbs[SPDK_AIO_QUEUE_DEPTH];
+	struct bdev_aio_task *aio_task;
+	uint32_t num_iocbs = aio_ch->num_pending;
+	uint32_t i = 0;
+	int rc;
+
+	if (num_iocbs == 0) {
+		return 0;
+	}
+
+	/* Failed requests are completed from here and their callbacks may submit new requests */
+	memcpy(iocbs, aio_ch->pending_iocbs, num_iocbs * sizeof(iocbs[0]));
+	aio_ch->num_pending = 0;
+
+	while (i < num_iocbs) {
+		rc = io_submit(aio_ch->io_ctx, num_iocbs - i, &iocbs[i]);
+		if (spdk_likely(rc > 0)) {
+			i += rc;
+			continue;
+		}
+
+		if (rc == -EAGAIN || rc == 0) {
+			/* The context is full, let the bdev layer retry all the remaining requests */
+			for (; i < num_iocbs; i++) {
+				aio_task = iocbs[i]->data;
+				aio_ch->io_inflight--;
+				spdk_bdev_io_complete(spdk_bdev_io_from_ctx(aio_task), SPDK_BDEV_IO_STATUS_NOMEM);
+			}
+			break;
+		}
+
+		/* io_submit() stops at the first request it cannot submit */
+		aio_task = iocbs[i++]->data;
+		aio_ch->io_inflight--;
+		spdk_bdev_io_complete_aio_status(spdk_bdev_io_from_ctx(aio_task), rc);
+		SPDK_ERRLOG("%s: io_submit returned %d\n", __func__, rc);
+	}
+
+	return num_iocbs;
 }
 #endif
 
@@ -250,6 +304,11 @@ bdev_aio_rw(enum spdk_bdev_io_type type, struct file_disk *fdisk,
 		}
 	} else {
 		aio_ch->io_inflight++;
+#ifndef __FreeBSD__
+		if (aio_ch->num_pending == SPDK_AIO_QUEUE_DEPTH) {
+			bdev_aio_io_channel_submit_pending(aio_ch);
+		}
+#endif
 	}
 }
 
@@ -496,6 +555,9 @@ bdev_aio_group_poll(void *arg)
 	int nr = 0;
 
 	TAILQ_FOREACH(io_ch, &group_ch->io_ch_head, link) {
+#ifndef __FreeBSD__
+		nr += bdev_aio_io_channel_submit_pending(io_ch);
+#endif
 		nr += bdev_aio_io_channel_poll(io_ch);
 	}
 
@@ -764,6 +826,13 @@ bdev_aio_get_io_channel(void *ctx)
 	return spdk_get_io_channel(fdisk);
 }
 
+static uint32_t
+bdev_aio_get_max_outstanding_io(struct spdk_io_channel *ch)
+{
+	/* Each channel has its own context, which can't take more I/O than that */
+	return SPDK_AIO_QUEUE_DEPTH;
+}
+
 
 static int
 bdev_aio_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
@@ -818,6 +887,7 @@ static const struct spdk_bdev_fn_table aio_fn_table = {
 	.get_io_channel		= bdev_aio_get_io_channel,
 	.dump_info_json		= bdev_aio_dump_info_json,
 	.write_config_json	= bdev_aio_write_json_config,
+	.get_max_outstanding_io	= bdev_aio_get_max_outstanding_io,
 };
 
 static void
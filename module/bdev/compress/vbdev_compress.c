@@ -63,6 +63,10 @@ struct vbdev_compress {
 };
 static TAILQ_HEAD(, vbdev_compress) g_vbdev_comp = TAILQ_HEAD_INITIALIZER(g_vbdev_comp);
 
+static struct bdev_compress_opts g_opts = {
+	.read_cache_size_mb = 0,
+};
+
 /* The comp vbdev channel struct. It is allocated and freed on my behalf by the io channel code.
  */
 struct comp_io_channel {
@@ -683,10 +687,31 @@ vbdev_compress_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 	return 0;
 }
 
+void
+bdev_compress_get_opts(struct bdev_compress_opts *opts)
+{
+	*opts = g_opts;
+}
+
+void
+bdev_compress_set_opts(const struct bdev_compress_opts *opts)
+{
+	g_opts = *opts;
+}
+
 static int
 vbdev_compress_config_json(struct spdk_json_write_ctx *w)
 {
-	/* Nothing to dump as compress bdev configuration is saved on physical device. */
+	/* The compress bdev configuration is saved on the physical device, only the module
+	 * options need to be dumped.
+	 */
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "method", "bdev_compress_set_options");
+	spdk_json_write_named_object_begin(w, "params");
+	spdk_json_write_named_uint32(w, "read_cache_size_mb", g_opts.read_cache_size_mb);
+	spdk_json_write_object_end(w);
+	spdk_json_write_object_end(w);
+
 	return 0;
 }
 
@@ -1088,6 +1113,7 @@ static int
 comp_bdev_ch_create_cb(void *io_device, void *ctx_buf)
 {
 	struct vbdev_compress *comp_bdev = io_device;
+	int rc;
 
 	/* Now set the reduce channel if it's not already set. */
 	pthread_mutex_lock(&comp_bdev->reduce_lock);
@@ -1101,6 +1127,16 @@ comp_bdev_ch_create_cb(void *io_device, void *ctx_buf)
 		comp_bdev->base_ch = spdk_bdev_get_io_channel(comp_bdev->base_desc);
 		comp_bdev->reduce_thread = spdk_get_thread();
 		comp_bdev->accel_channel = spdk_accel_get_io_channel();
+
+		/* The volume is only accessed from the reduce thread, so the cache is reset
+		 * each time it changes.
+		 */
+		rc = spdk_reduce_vol_set_read_cache_size(comp_bdev->vol,
+				(uint64_t)g_opts.read_cache_size_mb * 1024 * 1024);
+		if (rc != 0) {
+			SPDK_WARNLOG("%s: failed to allocate the read cache: %s\n",
+				     comp_bdev->comp_bdev.name, spdk_strerror(-rc));
+		}
 	}
 	comp_bdev->ch_count++;
 	pthread_mutex_unlock(&comp_bdev->reduce_lock);
@@ -16,6 +16,11 @@
 
 typedef void (*bdev_compress_create_cb)(void *ctx, int status);
 
+struct bdev_compress_opts {
+	/* Size of the cache of decompressed chunks of each compress bdev, 0 disables it */
+	uint32_t read_cache_size_mb;
+};
+
 /**
  * Get the first compression bdev.
  *
@@ -75,4 +80,19 @@ int create_compress_bdev(const char *bdev_name, const char *pm_path, uint32_t lb
 void bdev_compress_delete(const char *bdev_name, spdk_delete_compress_complete cb_fn,
 			  void *cb_arg);
 
+/**
+ * Get the options of the compress bdev module.
+ *
+ * \param opts Output parameter for the options.
+ */
+void bdev_compress_get_opts(struct bdev_compress_opts *opts);
+
+/**
+ * Set the options of the compress bdev module.  They apply to the compress bdevs whose I/O
+ * channel is created afterwards.
+ *
+ * \param opts Options to set.
+ */
+void bdev_compress_set_opts(const struct bdev_compress_opts *opts);
+
 #endif /* SPDK_VBDEV_COMPRESS_H */
@@ -10,6 +10,32 @@
 #include "spdk/string.h"
 #include "spdk/log.h"
 
+static const struct spdk_json_object_decoder rpc_bdev_compress_options_decoders[] = {
+	{"read_cache_size_mb", offsetof(struct bdev_compress_opts, read_cache_size_mb), spdk_json_decode_uint32, true},
+};
+
+static void
+rpc_bdev_compress_set_options(struct spdk_jsonrpc_request *request,
+			      const struct spdk_json_val *params)
+{
+	struct bdev_compress_opts opts;
+
+	bdev_compress_get_opts(&opts);
+	if (params && spdk_json_decode_object(params, rpc_bdev_compress_options_decoders,
+					      SPDK_COUNTOF(rpc_bdev_compress_options_decoders),
+					      &opts)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		return;
+	}
+
+	bdev_compress_set_opts(&opts);
+	spdk_jsonrpc_send_bool_response(request, true);
+}
+SPDK_RPC_REGISTER("bdev_compress_set_options", rpc_bdev_compress_set_options,
+		  SPDK_RPC_STARTUP | SPDK_RPC_RUNTIME)
+
 struct rpc_bdev_compress_get_orphans {
 	char *name;
 };
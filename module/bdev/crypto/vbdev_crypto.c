@@ -95,6 +95,33 @@ crypto_io_fail(struct crypto_bdev_io *crypto_io)
 	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
 }
 
+/* Returns the key of the LBA range the I/O falls into. The bdev layer splits the I/Os on the range
+ * boundaries, so an I/O never spans two ranges.
+ */
+static struct spdk_accel_crypto_key *
+crypto_get_key(struct crypto_io_channel *crypto_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct crypto_bdev_io *crypto_io = (struct crypto_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_crypto_opts *opts = crypto_io->crypto_bdev->opts;
+	struct vbdev_crypto_key_range *range;
+	uint64_t offset_blocks = bdev_io->u.bdev.offset_blocks;
+	uint32_t lo = 0, hi = opts->num_key_ranges, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		range = &opts->key_ranges[mid];
+		if (offset_blocks < range->offset_blocks) {
+			hi = mid;
+		} else if (offset_blocks >= range->offset_blocks + range->num_blocks) {
+			lo = mid + 1;
+		} else {
+			return range->key;
+		}
+	}
+
+	return crypto_ch->crypto_key;
+}
+
 static void
 crypto_write(struct crypto_io_channel *crypto_ch, struct spdk_bdev_io *bdev_io)
 {
@@ -150,7 +177,7 @@ crypto_encrypt(struct crypto_io_channel *crypto_ch, struct spdk_bdev_io *bdev_io
 	crypto_io->aux_num_blocks = bdev_io->u.bdev.num_blocks;
 
 	rc = spdk_accel_append_encrypt(&crypto_io->seq, crypto_ch->accel_channel,
-				       crypto_ch->crypto_key, &crypto_io->aux_buf_iov, 1,
+				       crypto_get_key(crypto_ch, bdev_io), &crypto_io->aux_buf_iov, 1,
 				       crypto_io->aux_domain, crypto_io->aux_domain_ctx,
 				       bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
 				       bdev_io->u.bdev.memory_domain,
@@ -277,7 +304,7 @@ crypto_read_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
 	}
 
 	rc = spdk_accel_append_decrypt(&crypto_io->seq, crypto_ch->accel_channel,
-				       crypto_ch->crypto_key,
+				       crypto_get_key(crypto_ch, bdev_io),
 				       bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
 				       bdev_io->u.bdev.memory_domain,
 				       bdev_io->u.bdev.memory_domain_ctx,
@@ -469,6 +496,28 @@ vbdev_crypto_get_io_channel(void *ctx)
 	return spdk_get_io_channel(crypto_bdev);
 }
 
+static void
+vbdev_crypto_write_key_ranges(struct spdk_json_write_ctx *w, struct vbdev_crypto_opts *opts)
+{
+	struct vbdev_crypto_key_range *range;
+	uint32_t i;
+
+	if (opts->num_key_ranges == 0) {
+		return;
+	}
+
+	spdk_json_write_named_array_begin(w, "key_ranges");
+	for (i = 0; i < opts->num_key_ranges; i++) {
+		range = &opts->key_ranges[i];
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "key_name", range->key->param.key_name);
+		spdk_json_write_named_uint64(w, "offset_blocks", range->offset_blocks);
+		spdk_json_write_named_uint64(w, "num_blocks", range->num_blocks);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+}
+
 /* This is the output for bdev_get_bdevs() for this vbdev */
 static int
 vbdev_crypto_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
@@ -480,6 +529,7 @@ vbdev_crypto_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 	spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(crypto_bdev->base_bdev));
 	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&crypto_bdev->crypto_bdev));
 	spdk_json_write_named_string(w, "key_name", crypto_bdev->opts->key->param.key_name);
+	vbdev_crypto_write_key_ranges(w, crypto_bdev->opts);
 	spdk_json_write_object_end(w);
 
 	return 0;
@@ -497,6 +547,7 @@ vbdev_crypto_config_json(struct spdk_json_write_ctx *w)
 		spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(crypto_bdev->base_bdev));
 		spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&crypto_bdev->crypto_bdev));
 		spdk_json_write_named_string(w, "key_name", crypto_bdev->opts->key->param.key_name);
+		vbdev_crypto_write_key_ranges(w, crypto_bdev->opts);
 		spdk_json_write_object_end(w);
 		spdk_json_write_object_end(w);
 	}
@@ -583,6 +634,7 @@ free_crypto_opts(struct vbdev_crypto_opts *opts)
 {
 	free(opts->bdev_name);
 	free(opts->vbdev_name);
+	free(opts->key_ranges);
 	free(opts);
 }
 
@@ -762,6 +814,42 @@ static struct spdk_bdev_module crypto_if = {
 
 SPDK_BDEV_MODULE_REGISTER(crypto, &crypto_if)
 
+static uint64_t
+vbdev_crypto_gcd(uint64_t a, uint64_t b)
+{
+	uint64_t t;
+
+	while (b != 0) {
+		t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+/* Returns a boundary that all the key ranges start and end on */
+static uint32_t
+vbdev_crypto_key_ranges_boundary(struct vbdev_crypto_opts *opts, uint32_t base_boundary)
+{
+	struct vbdev_crypto_key_range *range;
+	uint64_t boundary = base_boundary;
+	uint32_t i;
+
+	for (i = 0; i < opts->num_key_ranges; i++) {
+		range = &opts->key_ranges[i];
+		boundary = vbdev_crypto_gcd(boundary, range->offset_blocks);
+		boundary = vbdev_crypto_gcd(boundary, range->offset_blocks + range->num_blocks);
+	}
+
+	if (boundary > UINT32_MAX) {
+		/* Fall back to the largest power of two dividing it that fits */
+		boundary = spdk_min(boundary & -boundary, 1ULL << 31);
+	}
+
+	return (uint32_t)boundary;
+}
+
 static int
 vbdev_crypto_claim(const char *bdev_name)
 {
@@ -814,8 +902,27 @@ vbdev_crypto_claim(const char *bdev_name)
 		bdev = spdk_bdev_desc_get_bdev(vbdev->base_desc);
 		vbdev->base_bdev = bdev;
 
+		/* Interleaved protection information would be encrypted along with the data and
+		 * fail the checks of the base bdev. Separate metadata is left to the base bdev.
+		 */
+		if (spdk_bdev_get_dif_type(bdev) != SPDK_DIF_DISABLE &&
+		    spdk_bdev_is_md_interleaved(bdev)) {
+			SPDK_ERRLOG("Base bdev %s is formatted with interleaved protection information, "
+				    "which is not supported\n", bdev_name);
+			rc = -ENOTSUP;
+			goto error_dif;
+		}
+
 		vbdev->crypto_bdev.write_cache = bdev->write_cache;
 		vbdev->crypto_bdev.optimal_io_boundary = bdev->optimal_io_boundary;
+		if (name->opts->num_key_ranges != 0) {
+			/* Have the bdev layer split the I/Os, so that each one is encrypted with
+			 * a single key.
+			 */
+			vbdev->crypto_bdev.optimal_io_boundary =
+				vbdev_crypto_key_ranges_boundary(name->opts, bdev->optimal_io_boundary);
+			vbdev->crypto_bdev.split_on_optimal_io_boundary = true;
+		}
 		vbdev->crypto_bdev.max_rw_size = spdk_min(
 				bdev->max_rw_size ? bdev->max_rw_size : UINT32_MAX,
 				iobuf_opts.large_bufsize / bdev->blocklen);
@@ -883,6 +990,7 @@ error_claim:
 	TAILQ_REMOVE(&g_vbdev_crypto, vbdev, link);
 	spdk_io_device_unregister(vbdev, NULL);
 error_uuid:
+error_dif:
 	spdk_bdev_close(vbdev->base_desc);
 error_open:
 	free(vbdev->crypto_bdev.name);
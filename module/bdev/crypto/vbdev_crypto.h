@@ -19,12 +19,24 @@
 
 #define BDEV_CRYPTO_DEFAULT_CIPHER "AES_CBC" /* QAT and AESNI_MB */
 
+/* Maximum number of LBA ranges with their own key on a single crypto bdev */
+#define VBDEV_CRYPTO_MAX_KEY_RANGES 256
+
+/* LBA range encrypted with a key other than the default one of the crypto bdev */
+struct vbdev_crypto_key_range {
+	uint64_t			offset_blocks;
+	uint64_t			num_blocks;
+	struct spdk_accel_crypto_key	*key;
+};
+
 /* Structure to hold crypto options */
 struct vbdev_crypto_opts {
 	char				*vbdev_name;	/* name of the vbdev to create */
 	char				*bdev_name;	/* base bdev name */
 	struct spdk_accel_crypto_key	*key;		/* crypto key */
 	bool				key_owner;	/* If wet to true then the key was created by RPC and needs to be destroyed */
+	struct vbdev_crypto_key_range	*key_ranges;	/* sorted by offset, not overlapping */
+	uint32_t			num_key_ranges;
 };
 
 typedef void (*spdk_delete_crypto_complete)(void *cb_arg, int bdeverrno);
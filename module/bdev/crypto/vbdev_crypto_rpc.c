@@ -12,18 +12,32 @@
 /* Reasonable bdev name length + cipher's name len */
 #define MAX_KEY_NAME_LEN 128
 
+struct rpc_crypto_key_range {
+	char *key_name;
+	uint64_t offset_blocks;
+	uint64_t num_blocks;
+};
+
+struct rpc_crypto_key_ranges {
+	size_t num_ranges;
+	struct rpc_crypto_key_range ranges[VBDEV_CRYPTO_MAX_KEY_RANGES];
+};
+
 /* Structure to hold the parameters for this RPC method. */
 struct rpc_construct_crypto {
 	char *base_bdev_name;
 	char *name;
 	char *crypto_pmd;
 	struct spdk_accel_crypto_key_create_param param;
+	struct rpc_crypto_key_ranges key_ranges;
 };
 
 /* Free the allocated memory resource after the RPC handling. */
 static void
 free_rpc_construct_crypto(struct rpc_construct_crypto *r)
 {
+	size_t i;
+
 	free(r->base_bdev_name);
 	free(r->name);
 	free(r->crypto_pmd);
@@ -37,6 +51,32 @@ free_rpc_construct_crypto(struct rpc_construct_crypto *r)
 		free(r->param.hex_key2);
 	}
 	free(r->param.key_name);
+	for (i = 0; i < r->key_ranges.num_ranges; i++) {
+		free(r->key_ranges.ranges[i].key_name);
+	}
+}
+
+static const struct spdk_json_object_decoder rpc_crypto_key_range_decoders[] = {
+	{"key_name", offsetof(struct rpc_crypto_key_range, key_name), spdk_json_decode_string},
+	{"offset_blocks", offsetof(struct rpc_crypto_key_range, offset_blocks), spdk_json_decode_uint64},
+	{"num_blocks", offsetof(struct rpc_crypto_key_range, num_blocks), spdk_json_decode_uint64},
+};
+
+static int
+decode_crypto_key_range(const struct spdk_json_val *val, void *out)
+{
+	return spdk_json_decode_object(val, rpc_crypto_key_range_decoders,
+				       SPDK_COUNTOF(rpc_crypto_key_range_decoders), out);
+}
+
+static int
+decode_crypto_key_ranges(const struct spdk_json_val *val, void *out)
+{
+	struct rpc_crypto_key_ranges *key_ranges = out;
+
+	return spdk_json_decode_array(val, decode_crypto_key_range, key_ranges->ranges,
+				      VBDEV_CRYPTO_MAX_KEY_RANGES, &key_ranges->num_ranges,
+				      sizeof(struct rpc_crypto_key_range));
 }
 
 /* Structure to decode the input parameters for this RPC method. */
@@ -48,8 +88,68 @@ static const struct spdk_json_object_decoder rpc_construct_crypto_decoders[] = {
 	{"cipher", offsetof(struct rpc_construct_crypto, param.cipher), spdk_json_decode_string, true},
 	{"key2", offsetof(struct rpc_construct_crypto, param.hex_key2), spdk_json_decode_string, true},
 	{"key_name", offsetof(struct rpc_construct_crypto, param.key_name), spdk_json_decode_string, true},
+	{"key_ranges", offsetof(struct rpc_construct_crypto, key_ranges), decode_crypto_key_ranges, true},
 };
 
+static int
+key_range_cmp(const void *a, const void *b)
+{
+	const struct vbdev_crypto_key_range *ra = a, *rb = b;
+
+	if (ra->offset_blocks < rb->offset_blocks) {
+		return -1;
+	}
+
+	return ra->offset_blocks > rb->offset_blocks;
+}
+
+static int
+crypto_opts_set_key_ranges(struct vbdev_crypto_opts *opts, struct rpc_crypto_key_ranges *rpc)
+{
+	struct vbdev_crypto_key_range *range;
+	size_t i;
+
+	if (rpc->num_ranges == 0) {
+		return 0;
+	}
+
+	opts->key_ranges = calloc(rpc->num_ranges, sizeof(*opts->key_ranges));
+	if (!opts->key_ranges) {
+		return -ENOMEM;
+	}
+	opts->num_key_ranges = rpc->num_ranges;
+
+	for (i = 0; i < rpc->num_ranges; i++) {
+		range = &opts->key_ranges[i];
+		range->offset_blocks = rpc->ranges[i].offset_blocks;
+		range->num_blocks = rpc->ranges[i].num_blocks;
+		if (range->num_blocks == 0 ||
+		    range->offset_blocks + range->num_blocks < range->offset_blocks) {
+			SPDK_ERRLOG("Invalid key range offset %" PRIu64 " num_blocks %" PRIu64 "\n",
+				    range->offset_blocks, range->num_blocks);
+			return -EINVAL;
+		}
+
+		range->key = spdk_accel_crypto_key_get(rpc->ranges[i].key_name);
+		if (!range->key) {
+			SPDK_ERRLOG("Key \"%s\" was not found\n", rpc->ranges[i].key_name);
+			return -ENOENT;
+		}
+	}
+
+	qsort(opts->key_ranges, opts->num_key_ranges, sizeof(*opts->key_ranges), key_range_cmp);
+	for (i = 1; i < opts->num_key_ranges; i++) {
+		range = &opts->key_ranges[i];
+		if (range->offset_blocks < range[-1].offset_blocks + range[-1].num_blocks) {
+			SPDK_ERRLOG("Key ranges at offsets %" PRIu64 " and %" PRIu64 " overlap\n",
+				    range[-1].offset_blocks, range->offset_blocks);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
 static struct vbdev_crypto_opts *
 create_crypto_opts(struct rpc_construct_crypto *rpc, struct spdk_accel_crypto_key *key,
 		   bool key_owner)
@@ -173,6 +273,14 @@ rpc_bdev_crypto_create(struct spdk_jsonrpc_request *request,
 		goto cleanup;
 	}
 
+	rc = crypto_opts_set_key_ranges(crypto_opts, &req.key_ranges);
+	if (rc) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "Invalid key ranges");
+		free_crypto_opts(crypto_opts);
+		goto cleanup;
+	}
+
 	rc = create_crypto_disk(crypto_opts);
 	if (rc) {
 		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
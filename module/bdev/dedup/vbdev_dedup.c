@@ -0,0 +1,1917 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+/*
+ * A virtual block device module deduplicating the data written to it.
+ *
+ * The address space of the bdev is split into fixed size logical chunks, and the space of the
+ * base bdev past its metadata into physical chunks of the same size. A map with one 32-bit entry
+ * per logical chunk points at the physical chunk holding its content, logical chunks with the
+ * same content sharing one physical chunk. Unmapped chunks and chunks written with zeroes don't
+ * use a physical chunk and read as zeroes. I/Os are split on the chunk boundaries by the bdev
+ * layer.
+ *
+ * A write is copied to a chunk buffer, merged with the current content of the chunk if it
+ * doesn't cover all of it, and its CRC-32C is computed by the accel framework. The CRC-32C looks
+ * up a physical chunk possibly holding the same data in an in-memory index. That candidate is
+ * read back and compared with the new data, so a CRC collision never aliases different data. If
+ * they match, the logical chunk is pointed at the candidate, otherwise the data is written to a
+ * free physical chunk. Physical chunks are never written while referenced.
+ *
+ * The index, the reference counts and the free physical chunks are owned by the thread that
+ * created the bdev, the I/O threads send it messages. The map is only written there too, but
+ * read by all threads, which pin the physical chunk they read from until they are done with it.
+ * A map update is persisted before the physical chunk it replaces is released, and a released
+ * chunk is only reused once the base bdev is flushed and the reads pinning it are done, so the
+ * map found on the base bdev after a crash never points at reused data. The reference counts
+ * are rebuilt from the map when the bdev is loaded.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "vbdev_dedup.h"
+#include "spdk/accel.h"
+#include "spdk/rpc.h"
+#include "spdk/endian.h"
+#include "spdk/env.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+
+#include "spdk/bdev_module.h"
+#include "spdk/log.h"
+
+/* This namespace UUID was generated using uuid_generate() method. */
+#define BDEV_DEDUP_NAMESPACE_UUID "098b76e1-b93c-4f54-9644-8215c246506a"
+
+#define VBDEV_DEDUP_MD_MAGIC		"SPDKDDUP"
+#define VBDEV_DEDUP_MD_VERSION		1
+/* Largest I/O used to load and format the metadata, in bytes. */
+#define VBDEV_DEDUP_MD_IO_SIZE		(1024 * 1024)
+/* Period of the poller reusing the released physical chunks. */
+#define VBDEV_DEDUP_POLL_US		100
+/* Delay between two flushes of the base bdev making released chunks reusable, unless no
+ * chunk is free.
+ */
+#define VBDEV_DEDUP_FLUSH_INTERVAL_US	(100 * 1000)
+
+static int vbdev_dedup_init(void);
+static int vbdev_dedup_get_ctx_size(void);
+static void vbdev_dedup_examine(struct spdk_bdev *bdev);
+static void vbdev_dedup_finish(void);
+static int vbdev_dedup_config_json(struct spdk_json_write_ctx *w);
+
+static struct spdk_bdev_module dedup_if = {
+	.name = "dedup",
+	.module_init = vbdev_dedup_init,
+	.get_ctx_size = vbdev_dedup_get_ctx_size,
+	.examine_config = vbdev_dedup_examine,
+	.module_fini = vbdev_dedup_finish,
+	.config_json = vbdev_dedup_config_json
+};
+
+SPDK_BDEV_MODULE_REGISTER(dedup, &dedup_if)
+
+/* List of dedup bdev names and their base bdevs via configuration file.
+ * Used so we can parse the conf once at init and use this list in examine().
+ */
+struct bdev_names {
+	char			*vbdev_name;
+	char			*base_bdev_name;
+	struct spdk_uuid	uuid;
+	uint32_t		chunk_size;
+	uint64_t		num_blocks;
+	TAILQ_ENTRY(bdev_names)	link;
+};
+static TAILQ_HEAD(, bdev_names) g_bdev_names = TAILQ_HEAD_INITIALIZER(g_bdev_names);
+
+/* Header of the metadata, in the first block of the base bdev. It is followed by the map,
+ * starting on the next block, with one 32-bit entry per logical chunk, then by the CRC-32C of
+ * each physical chunk, starting on a new block. All little-endian.
+ */
+struct dedup_md_header {
+	char			magic[8];
+	uint32_t		version;
+	uint32_t		blocklen;
+	uint64_t		chunk_blocks;
+	uint64_t		num_lchunks;
+	uint64_t		num_pchunks;
+};
+SPDK_STATIC_ASSERT(sizeof(struct dedup_md_header) == 40, "Incorrect size");
+
+struct dedup_bdev_io;
+
+/* A block of the metadata region being written. */
+struct dedup_md_write {
+	struct vbdev_dedup			*node;
+	uint64_t				block;
+	/* The block changed again after the write was submitted */
+	bool					again;
+	/* Writes waiting for this write of the block, and for the next one */
+	TAILQ_HEAD(, dedup_bdev_io)		waiters;
+	TAILQ_HEAD(, dedup_bdev_io)		next_waiters;
+	TAILQ_ENTRY(dedup_md_write)		link;
+};
+
+/* List of virtual bdevs and associated info for each. */
+struct vbdev_dedup {
+	struct spdk_bdev		*base_bdev;	/* the bdev storing the chunks */
+	struct spdk_bdev_desc		*base_desc;
+	struct spdk_bdev		dedup_bdev;	/* the dedup virtual bdev */
+	uint32_t			chunk_size;
+	uint64_t			chunk_blocks;
+	uint64_t			num_lchunks;
+	uint64_t			num_pchunks;
+	/* Offset of the first physical chunk on the base bdev */
+	uint64_t			data_offset_blocks;
+	/* Copy of the metadata region at the beginning of the base bdev */
+	void				*md_buf;
+	uint64_t			md_blocks;
+	/* For each logical chunk, the physical chunk holding it plus one, or 0 if it reads as
+	 * zeroes. Points into md_buf, only changed on the thread of the node.
+	 */
+	uint32_t			*map;
+	/* For each physical chunk, the CRC-32C of its content. Points into md_buf. */
+	uint32_t			*crcs;
+	uint64_t			crc_offset_blocks;
+	/* For each physical chunk, the number of map entries and writes referencing it */
+	uint32_t			*refcnt;
+	/* For each physical chunk, the number of I/Os pinning it */
+	uint32_t			*readers;
+	/* Index of the referenced physical chunks by CRC-32C: chained hash table of physical
+	 * chunks plus one.
+	 */
+	uint32_t			*buckets;
+	uint32_t			*next;
+	uint64_t			bucket_mask;
+	/* Stack of the physical chunks ready to be written */
+	uint32_t			*free_chunks;
+	uint64_t			num_free;
+	/* Ring of the physical chunks released. The ones before released_flushed are reused
+	 * once their readers are done.
+	 */
+	uint32_t			*released;
+	uint64_t			released_head;
+	uint64_t			released_flushed;
+	uint64_t			released_tail;
+	/* The base bdev has a volatile cache, flush it before reusing released chunks */
+	bool				flush_released;
+	bool				flushing;
+	uint64_t			flush_mark;
+	uint64_t			next_flush_tsc;
+	/* Writes waiting for a released chunk to be reusable */
+	TAILQ_HEAD(, dedup_bdev_io)	alloc_waiters;
+	/* Blocks of the metadata region being written */
+	TAILQ_HEAD(, dedup_md_write)	md_writes;
+	struct spdk_io_channel		*md_ch;
+	struct spdk_poller		*poller;
+	uint64_t			num_unique_writes;
+	uint64_t			num_dedup_writes;
+	uint64_t			num_zero_writes;
+	uint64_t			num_miscompares;
+	/* Metadata loading, the bdev is registered once it is done */
+	bool				loading;
+	bool				formatting;
+	uint64_t			md_cursor;
+	bdev_dedup_create_cb		create_cb;
+	void				*create_cb_arg;
+	/* The bdev is being destructed, clean up once the metadata writes are done */
+	bool				deleting;
+	/* The base bdev was hot removed */
+	bool				removed;
+	TAILQ_ENTRY(vbdev_dedup)	link;
+	struct spdk_thread		*thread;	/* thread owning the chunks */
+};
+static TAILQ_HEAD(, vbdev_dedup) g_dedup_nodes = TAILQ_HEAD_INITIALIZER(g_dedup_nodes);
+
+struct dedup_io_channel {
+	struct spdk_io_channel		*base_ch;	/* IO channel of base device */
+	struct spdk_io_channel		*accel_ch;
+	struct spdk_iobuf_channel	iobuf;
+	struct vbdev_dedup		*node;
+};
+
+struct dedup_bdev_io {
+	/* bdev related */
+	struct spdk_io_channel *ch;
+
+	/* logical chunk accessed */
+	uint64_t lchunk;
+
+	/* for reads and partial writes, the physical chunk pinned plus one, 0 if none */
+	uint32_t pinned;
+
+	/* for writes, the new content of the chunk and the one of the candidate */
+	void *buf;
+	void *cmp_buf;
+	struct spdk_iobuf_entry iobuf;
+	uint32_t crc;
+
+	/* physical chunk the logical chunk is pointed at plus one, 0 for zeroes */
+	uint32_t pchunk;
+
+	/* pchunk was allocated by this write rather than found in the index */
+	bool allocated;
+
+	/* physical chunk the logical chunk pointed at before the update plus one */
+	uint32_t replaced;
+
+	/* for unmaps, the end of the range of chunks unmapped */
+	uint64_t unmap_end;
+
+	int status;
+
+	/* for waiting for a free chunk or a metadata write */
+	TAILQ_ENTRY(dedup_bdev_io) link;
+};
+
+static void vbdev_dedup_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io);
+static void dedup_write_fill(struct spdk_bdev_io *bdev_io);
+static void _dedup_unmap(void *ctx);
+
+static void
+vbdev_dedup_free(struct vbdev_dedup *node)
+{
+	spdk_dma_free(node->md_buf);
+	free(node->refcnt);
+	free(node->readers);
+	free(node->buckets);
+	free(node->next);
+	free(node->free_chunks);
+	free(node->released);
+	free(node->dedup_bdev.name);
+	free(node);
+}
+
+/* Callback for unregistering the IO device. */
+static void
+_device_unregister_cb(void *io_device)
+{
+	struct vbdev_dedup *node = io_device;
+
+	spdk_bdev_destruct_done(&node->dedup_bdev, 0);
+
+	/* Done with this node. */
+	vbdev_dedup_free(node);
+}
+
+static void
+_vbdev_dedup_destruct(void *ctx)
+{
+	struct vbdev_dedup *node = ctx;
+
+	/* The poller cleans up once the metadata writes in flight are done. */
+	node->deleting = true;
+}
+
+/* Called after we've unregistered following a hot remove callback or a delete RPC. */
+static int
+vbdev_dedup_destruct(void *ctx)
+{
+	struct vbdev_dedup *node = (struct vbdev_dedup *)ctx;
+
+	TAILQ_REMOVE(&g_dedup_nodes, node, link);
+
+	if (node->thread != spdk_get_thread()) {
+		spdk_thread_send_msg(node->thread, _vbdev_dedup_destruct, node);
+	} else {
+		_vbdev_dedup_destruct(node);
+	}
+
+	/* Completed asynchronously with spdk_bdev_destruct_done(). */
+	return 1;
+}
+
+static inline uint64_t
+dedup_chunk_offset(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	return node->data_offset_blocks + pchunk * node->chunk_blocks;
+}
+
+/* Block of the metadata region holding the map entry of a logical chunk. */
+static inline uint64_t
+dedup_map_block(struct vbdev_dedup *node, uint64_t lchunk)
+{
+	return 1 + lchunk * sizeof(uint32_t) / node->dedup_bdev.blocklen;
+}
+
+/* Block of the metadata region holding the CRC-32C of a physical chunk. */
+static inline uint64_t
+dedup_crc_block(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	return node->crc_offset_blocks + (uint64_t)pchunk * sizeof(uint32_t) /
+	       node->dedup_bdev.blocklen;
+}
+
+static inline uint32_t
+dedup_map_get(struct vbdev_dedup *node, uint64_t lchunk)
+{
+	uint32_t entry = __atomic_load_n(&node->map[lchunk], __ATOMIC_SEQ_CST);
+
+	return from_le32(&entry);
+}
+
+static inline void
+dedup_map_set(struct vbdev_dedup *node, uint64_t lchunk, uint32_t pchunk)
+{
+	uint32_t entry;
+
+	to_le32(&entry, pchunk);
+	__atomic_store_n(&node->map[lchunk], entry, __ATOMIC_SEQ_CST);
+}
+
+/* Look up the physical chunk of a logical chunk and keep it from being reused until unpinned.
+ * Returns the physical chunk plus one, 0 if the logical chunk reads as zeroes.
+ */
+static uint32_t
+dedup_chunk_pin(struct vbdev_dedup *node, uint64_t lchunk)
+{
+	uint32_t pchunk;
+
+	while (true) {
+		pchunk = dedup_map_get(node, lchunk);
+		if (pchunk == 0) {
+			return 0;
+		}
+
+		__atomic_add_fetch(&node->readers[pchunk - 1], 1, __ATOMIC_SEQ_CST);
+		if (spdk_likely(dedup_map_get(node, lchunk) == pchunk)) {
+			return pchunk;
+		}
+
+		/* Remapped in the meantime, the physical chunk may be released already. */
+		__atomic_sub_fetch(&node->readers[pchunk - 1], 1, __ATOMIC_RELEASE);
+	}
+}
+
+static inline void
+dedup_chunk_unpin(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	__atomic_sub_fetch(&node->readers[pchunk - 1], 1, __ATOMIC_RELEASE);
+}
+
+static void
+dedup_index_insert(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	uint32_t *bucket = &node->buckets[from_le32(&node->crcs[pchunk]) & node->bucket_mask];
+
+	node->next[pchunk] = *bucket;
+	*bucket = pchunk + 1;
+}
+
+static void
+dedup_index_remove(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	uint32_t *prev = &node->buckets[from_le32(&node->crcs[pchunk]) & node->bucket_mask];
+
+	/* Chunks allocated by a write that didn't complete were never inserted. */
+	while (*prev != 0) {
+		if (*prev == pchunk + 1) {
+			*prev = node->next[pchunk];
+			break;
+		}
+		prev = &node->next[*prev - 1];
+	}
+	node->next[pchunk] = 0;
+}
+
+/* Drop a reference on a physical chunk. Once unreferenced, it is removed from the index and
+ * reused after the next flush of the base bdev.
+ */
+static void
+dedup_chunk_put(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	assert(node->refcnt[pchunk] > 0);
+	if (--node->refcnt[pchunk] > 0) {
+		return;
+	}
+
+	dedup_index_remove(node, pchunk);
+	node->released[node->released_tail++ % node->num_pchunks] = pchunk;
+	if (!node->flush_released) {
+		node->released_flushed = node->released_tail;
+	}
+}
+
+static inline bool
+dedup_write_is_partial(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io)
+{
+	return bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE &&
+	       bdev_io->u.bdev.num_blocks != node->chunk_blocks;
+}
+
+/* Continue an I/O on the thread of the node. */
+static inline void
+dedup_io_send_md(struct spdk_bdev_io *bdev_io, spdk_msg_fn fn)
+{
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+
+	spdk_thread_send_msg(node->thread, fn, bdev_io);
+}
+
+/* Continue an I/O on the thread it was submitted on. */
+static inline void
+dedup_io_send_back(struct spdk_bdev_io *bdev_io, spdk_msg_fn fn)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+
+	spdk_thread_send_msg(spdk_io_channel_get_thread(io_ctx->ch), fn, bdev_io);
+}
+
+static void
+dedup_io_finish(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct dedup_io_channel *dedup_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	struct vbdev_dedup *node = dedup_ch->node;
+
+	if (io_ctx->pinned != 0) {
+		dedup_chunk_unpin(node, io_ctx->pinned);
+		io_ctx->pinned = 0;
+	}
+	if (io_ctx->buf != NULL) {
+		spdk_iobuf_put(&dedup_ch->iobuf, io_ctx->buf, node->chunk_size);
+	}
+	if (io_ctx->cmp_buf != NULL) {
+		spdk_iobuf_put(&dedup_ch->iobuf, io_ctx->cmp_buf, node->chunk_size);
+	}
+
+	if (io_ctx->status == 0) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+	} else if (io_ctx->status == -ENOMEM) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+	} else {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void
+dedup_read_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)orig_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(orig_io->bdev, struct vbdev_dedup, dedup_bdev);
+
+	spdk_bdev_free_io(bdev_io);
+
+	dedup_chunk_unpin(node, io_ctx->pinned);
+	io_ctx->pinned = 0;
+	spdk_bdev_io_complete(orig_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void
+dedup_read_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io, bool success)
+{
+	struct dedup_io_channel *dedup_ch = spdk_io_channel_get_ctx(ch);
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = dedup_ch->node;
+	uint64_t offset_blocks = bdev_io->u.bdev.offset_blocks;
+	int rc;
+
+	if (!success) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	io_ctx->pinned = dedup_chunk_pin(node, io_ctx->lchunk);
+	if (io_ctx->pinned == 0) {
+		spdk_iov_memset(bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt, 0);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+		return;
+	}
+
+	offset_blocks = dedup_chunk_offset(node, io_ctx->pinned - 1) + offset_blocks % node->chunk_blocks;
+	rc = spdk_bdev_readv_blocks(node->base_desc, dedup_ch->base_ch, bdev_io->u.bdev.iovs,
+				    bdev_io->u.bdev.iovcnt, offset_blocks, bdev_io->u.bdev.num_blocks,
+				    dedup_read_done, bdev_io);
+	if (rc != 0) {
+		dedup_chunk_unpin(node, io_ctx->pinned);
+		io_ctx->pinned = 0;
+		if (rc == -ENOMEM) {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		} else {
+			SPDK_ERRLOG("ERROR on bdev_io submission!\n");
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		}
+	}
+}
+
+/* The steps below run on the thread of the node. */
+
+static void
+dedup_commit_done(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io, int rc)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+
+	if (rc != 0) {
+		/* The base bdev may still point at the replaced chunk, keep it until the bdev is
+		 * loaded again.
+		 */
+		SPDK_ERRLOG("%s: failed to persist the map of chunk %" PRIu64 ": %s\n",
+			    node->dedup_bdev.name, io_ctx->lchunk, spdk_strerror(-rc));
+		io_ctx->status = rc;
+	} else if (io_ctx->replaced != 0) {
+		dedup_chunk_put(node, io_ctx->replaced - 1);
+	}
+	io_ctx->replaced = 0;
+
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_UNMAP && rc == 0) {
+		io_ctx->lchunk++;
+		_dedup_unmap(bdev_io);
+		return;
+	}
+
+	dedup_io_send_back(bdev_io, dedup_io_finish);
+}
+
+static void dedup_md_write_submit(struct dedup_md_write *mdw);
+
+static void
+dedup_md_write_complete(struct dedup_md_write *mdw, int rc)
+{
+	struct vbdev_dedup *node = mdw->node;
+	struct dedup_bdev_io *io_ctx;
+
+	while ((io_ctx = TAILQ_FIRST(&mdw->waiters)) != NULL) {
+		TAILQ_REMOVE(&mdw->waiters, io_ctx, link);
+		dedup_commit_done(node, spdk_bdev_io_from_ctx(io_ctx), rc);
+	}
+
+	if (mdw->again) {
+		mdw->again = false;
+		TAILQ_SWAP(&mdw->waiters, &mdw->next_waiters, dedup_bdev_io, link);
+		dedup_md_write_submit(mdw);
+		return;
+	}
+
+	TAILQ_REMOVE(&node->md_writes, mdw, link);
+	free(mdw);
+}
+
+static void
+dedup_md_write_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct dedup_md_write *mdw = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	dedup_md_write_complete(mdw, success ? 0 : -EIO);
+}
+
+static void
+dedup_md_write_submit(struct dedup_md_write *mdw)
+{
+	struct vbdev_dedup *node = mdw->node;
+	int rc;
+
+	rc = spdk_bdev_write_blocks(node->base_desc, node->md_ch,
+				    (uint8_t *)node->md_buf + mdw->block * node->dedup_bdev.blocklen,
+				    mdw->block, 1, dedup_md_write_done, mdw);
+	if (rc != 0) {
+		dedup_md_write_complete(mdw, rc);
+	}
+}
+
+/* Persist a block of the metadata region. A block already being written is written again
+ * once that write is done, since it may not include the latest change, so that the writes of
+ * a block never overtake each other. The write waiting for the update, if any, is completed
+ * once it is persisted.
+ */
+static void
+dedup_md_write(struct vbdev_dedup *node, uint64_t block, struct spdk_bdev_io *waiter)
+{
+	struct dedup_bdev_io *io_ctx = waiter ? (struct dedup_bdev_io *)waiter->driver_ctx : NULL;
+	struct dedup_md_write *mdw;
+
+	TAILQ_FOREACH(mdw, &node->md_writes, link) {
+		if (mdw->block == block) {
+			mdw->again = true;
+			if (io_ctx != NULL) {
+				TAILQ_INSERT_TAIL(&mdw->next_waiters, io_ctx, link);
+			}
+			return;
+		}
+	}
+
+	mdw = calloc(1, sizeof(*mdw));
+	if (mdw == NULL) {
+		if (waiter != NULL) {
+			dedup_commit_done(node, waiter, -ENOMEM);
+		}
+		return;
+	}
+
+	mdw->node = node;
+	mdw->block = block;
+	TAILQ_INIT(&mdw->waiters);
+	TAILQ_INIT(&mdw->next_waiters);
+	if (io_ctx != NULL) {
+		TAILQ_INSERT_TAIL(&mdw->waiters, io_ctx, link);
+	}
+	TAILQ_INSERT_TAIL(&node->md_writes, mdw, link);
+
+	dedup_md_write_submit(mdw);
+}
+
+/* Point the logical chunk at its new physical chunk and persist the map. */
+static void
+_dedup_commit(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+	uint32_t cur = dedup_map_get(node, io_ctx->lchunk);
+
+	if (dedup_write_is_partial(node, bdev_io) && cur != io_ctx->pinned) {
+		/* Another write changed the chunk since its content was merged, start over. */
+		if (io_ctx->pchunk != 0) {
+			dedup_chunk_put(node, io_ctx->pchunk - 1);
+			io_ctx->pchunk = 0;
+		}
+		dedup_io_send_back(bdev_io, (spdk_msg_fn)dedup_write_fill);
+		return;
+	}
+
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+		if (io_ctx->allocated) {
+			node->num_unique_writes++;
+		} else if (io_ctx->pchunk != 0) {
+			node->num_dedup_writes++;
+		} else {
+			node->num_zero_writes++;
+		}
+	}
+
+	if (cur == io_ctx->pchunk) {
+		/* Same content as before, drop the reference taken by the lookup. */
+		if (io_ctx->pchunk != 0) {
+			dedup_chunk_put(node, io_ctx->pchunk - 1);
+		}
+		dedup_commit_done(node, bdev_io, 0);
+		return;
+	}
+
+	if (io_ctx->allocated) {
+		/* The CRC-32C is only a hint, nothing waits for it to be persisted. */
+		to_le32(&node->crcs[io_ctx->pchunk - 1], io_ctx->crc);
+		dedup_index_insert(node, io_ctx->pchunk - 1);
+		dedup_md_write(node, dedup_crc_block(node, io_ctx->pchunk - 1), NULL);
+	}
+
+	/* The reference taken by the lookup or the allocation now belongs to the map entry. */
+	io_ctx->replaced = cur;
+	dedup_map_set(node, io_ctx->lchunk, io_ctx->pchunk);
+	dedup_md_write(node, dedup_map_block(node, io_ctx->lchunk), bdev_io);
+}
+
+/* The write failed before its commit, drop its reference on the physical chunk. */
+static void
+_dedup_write_abort(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+
+	dedup_chunk_put(node, io_ctx->pchunk - 1);
+	io_ctx->pchunk = 0;
+
+	dedup_io_send_back(bdev_io, dedup_io_finish);
+}
+
+static void dedup_write_data(void *ctx);
+
+/* Allocate a physical chunk for data not found in the index. */
+static void
+dedup_alloc(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	uint32_t pchunk;
+
+	if (node->num_free == 0) {
+		if (node->released_head != node->released_tail && !node->removed) {
+			/* Retried by the poller once a released chunk can be reused. */
+			TAILQ_INSERT_TAIL(&node->alloc_waiters, io_ctx, link);
+			return;
+		}
+
+		SPDK_DEBUGLOG(vbdev_dedup, "%s: no free chunk left\n", node->dedup_bdev.name);
+		io_ctx->status = node->removed ? -ENODEV : -ENOSPC;
+		dedup_io_send_back(bdev_io, dedup_io_finish);
+		return;
+	}
+
+	pchunk = node->free_chunks[--node->num_free];
+	assert(node->refcnt[pchunk] == 0);
+	node->refcnt[pchunk] = 1;
+	io_ctx->pchunk = pchunk + 1;
+	io_ctx->allocated = true;
+
+	dedup_io_send_back(bdev_io, dedup_write_data);
+}
+
+static void dedup_write_verify(void *ctx);
+
+/* Look up a physical chunk with the CRC-32C of the new content, starting from a given entry of
+ * its bucket, and take a reference on it.
+ */
+static void
+dedup_lookup(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io, uint32_t pchunk)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+
+	for (; pchunk != 0; pchunk = node->next[pchunk - 1]) {
+		if (from_le32(&node->crcs[pchunk - 1]) == io_ctx->crc) {
+			break;
+		}
+	}
+
+	if (pchunk == 0) {
+		dedup_alloc(node, bdev_io);
+		return;
+	}
+
+	/* Only referenced chunks are indexed. */
+	assert(node->refcnt[pchunk - 1] > 0);
+	node->refcnt[pchunk - 1]++;
+	io_ctx->pchunk = pchunk;
+	io_ctx->allocated = false;
+
+	dedup_io_send_back(bdev_io, dedup_write_verify);
+}
+
+static void
+_dedup_lookup(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+
+	dedup_lookup(node, bdev_io, node->buckets[io_ctx->crc & node->bucket_mask]);
+}
+
+/* The candidate has the same CRC-32C but not the same content, try the next ones. */
+static void
+_dedup_miscompare(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+	uint32_t next;
+
+	node->num_miscompares++;
+	/* Still indexed, the reference taken by the lookup is only dropped below. */
+	next = node->next[io_ctx->pchunk - 1];
+	dedup_chunk_put(node, io_ctx->pchunk - 1);
+	io_ctx->pchunk = 0;
+
+	dedup_lookup(node, bdev_io, next);
+}
+
+/* Go through the fully unmapped chunks still pointing at a physical chunk. */
+static void
+_dedup_unmap(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+
+	while (io_ctx->lchunk < io_ctx->unmap_end && dedup_map_get(node, io_ctx->lchunk) == 0) {
+		io_ctx->lchunk++;
+	}
+
+	if (io_ctx->lchunk == io_ctx->unmap_end) {
+		dedup_io_send_back(bdev_io, dedup_io_finish);
+		return;
+	}
+
+	io_ctx->pchunk = 0;
+	_dedup_commit(bdev_io);
+}
+
+/* The steps below run on the thread of the I/O. */
+
+static void
+dedup_write_data_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)orig_io->driver_ctx;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		io_ctx->status = -EIO;
+		dedup_io_send_md(orig_io, _dedup_write_abort);
+		return;
+	}
+
+	dedup_io_send_md(orig_io, _dedup_commit);
+}
+
+/* Write the new content to the physical chunk allocated for it. */
+static void
+dedup_write_data(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct dedup_io_channel *dedup_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	struct vbdev_dedup *node = dedup_ch->node;
+	int rc;
+
+	rc = spdk_bdev_write_blocks(node->base_desc, dedup_ch->base_ch, io_ctx->buf,
+				    dedup_chunk_offset(node, io_ctx->pchunk - 1), node->chunk_blocks,
+				    dedup_write_data_done, bdev_io);
+	if (rc != 0) {
+		io_ctx->status = rc;
+		dedup_io_send_md(bdev_io, _dedup_write_abort);
+	}
+}
+
+static void
+dedup_verify_compare_done(void *cb_arg, int status)
+{
+	struct spdk_bdev_io *bdev_io = cb_arg;
+
+	/* Anything but a match, including a failed compare, stores the data separately. */
+	dedup_io_send_md(bdev_io, status == 0 ? _dedup_commit : _dedup_miscompare);
+}
+
+static void
+dedup_verify_read_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)orig_io->driver_ctx;
+	struct dedup_io_channel *dedup_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	int rc;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		io_ctx->status = -EIO;
+		dedup_io_send_md(orig_io, _dedup_write_abort);
+		return;
+	}
+
+	rc = spdk_accel_submit_compare(dedup_ch->accel_ch, io_ctx->buf, io_ctx->cmp_buf,
+				       dedup_ch->node->chunk_size, dedup_verify_compare_done, orig_io);
+	if (rc != 0) {
+		io_ctx->status = rc;
+		dedup_io_send_md(orig_io, _dedup_write_abort);
+	}
+}
+
+static void
+dedup_verify_read(struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct dedup_io_channel *dedup_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	struct vbdev_dedup *node = dedup_ch->node;
+	int rc;
+
+	rc = spdk_bdev_read_blocks(node->base_desc, dedup_ch->base_ch, io_ctx->cmp_buf,
+				   dedup_chunk_offset(node, io_ctx->pchunk - 1), node->chunk_blocks,
+				   dedup_verify_read_done, bdev_io);
+	if (rc != 0) {
+		io_ctx->status = rc;
+		dedup_io_send_md(bdev_io, _dedup_write_abort);
+	}
+}
+
+static void
+dedup_verify_get_buf_cb(struct spdk_iobuf_entry *entry, void *buf)
+{
+	struct dedup_bdev_io *io_ctx = SPDK_CONTAINEROF(entry, struct dedup_bdev_io, iobuf);
+
+	io_ctx->cmp_buf = buf;
+	dedup_verify_read(spdk_bdev_io_from_ctx(io_ctx));
+}
+
+/* Read the candidate found in the index back to compare it with the new content. */
+static void
+dedup_write_verify(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct dedup_io_channel *dedup_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+
+	if (io_ctx->cmp_buf == NULL) {
+		io_ctx->cmp_buf = spdk_iobuf_get(&dedup_ch->iobuf, dedup_ch->node->chunk_size,
+						 &io_ctx->iobuf, dedup_verify_get_buf_cb);
+		if (io_ctx->cmp_buf == NULL) {
+			return;
+		}
+	}
+
+	dedup_verify_read(bdev_io);
+}
+
+static void
+dedup_write_crc_done(void *cb_arg, int status)
+{
+	struct spdk_bdev_io *bdev_io = cb_arg;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+
+	if (status != 0) {
+		io_ctx->status = status;
+		dedup_io_finish(bdev_io);
+		return;
+	}
+
+	io_ctx->pchunk = 0;
+	io_ctx->allocated = false;
+	if (spdk_mem_all_zero(io_ctx->buf, node->chunk_size)) {
+		/* Zeroes don't need a physical chunk. */
+		dedup_io_send_md(bdev_io, _dedup_commit);
+	} else {
+		dedup_io_send_md(bdev_io, _dedup_lookup);
+	}
+}
+
+static void
+dedup_write_merge(struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct dedup_io_channel *dedup_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	struct vbdev_dedup *node = dedup_ch->node;
+	uint32_t blocklen = node->dedup_bdev.blocklen;
+	uint64_t offset = bdev_io->u.bdev.offset_blocks % node->chunk_blocks * blocklen;
+	int rc;
+
+	spdk_copy_iovs_to_buf((uint8_t *)io_ctx->buf + offset, bdev_io->u.bdev.num_blocks * blocklen,
+			      bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt);
+
+	rc = spdk_accel_submit_crc32c(dedup_ch->accel_ch, &io_ctx->crc, io_ctx->buf, 0,
+				      node->chunk_size, dedup_write_crc_done, bdev_io);
+	if (rc != 0) {
+		io_ctx->status = rc;
+		dedup_io_finish(bdev_io);
+	}
+}
+
+static void
+dedup_write_read_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)orig_io->driver_ctx;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		io_ctx->status = -EIO;
+		dedup_io_finish(orig_io);
+		return;
+	}
+
+	dedup_write_merge(orig_io);
+}
+
+/* Build the new content of the chunk in the buffer and compute its CRC-32C. */
+static void
+dedup_write_fill(struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct dedup_io_channel *dedup_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	struct vbdev_dedup *node = dedup_ch->node;
+	int rc;
+
+	if (!dedup_write_is_partial(node, bdev_io)) {
+		rc = spdk_accel_submit_copy_crc32cv(dedup_ch->accel_ch, io_ctx->buf, bdev_io->u.bdev.iovs,
+						    bdev_io->u.bdev.iovcnt, &io_ctx->crc, 0,
+						    dedup_write_crc_done, bdev_io);
+		if (rc != 0) {
+			io_ctx->status = rc;
+			dedup_io_finish(bdev_io);
+		}
+		return;
+	}
+
+	/* A partial write is merged with the current content of the chunk. That physical chunk
+	 * stays pinned until the commit checks that it is still the current one, so that it
+	 * can't be reused with other data in the meantime.
+	 */
+	if (io_ctx->pinned != 0) {
+		/* Started over after losing a race with another write. */
+		dedup_chunk_unpin(node, io_ctx->pinned);
+	}
+	io_ctx->pinned = dedup_chunk_pin(node, io_ctx->lchunk);
+	if (io_ctx->pinned == 0) {
+		memset(io_ctx->buf, 0, node->chunk_size);
+		dedup_write_merge(bdev_io);
+		return;
+	}
+
+	rc = spdk_bdev_read_blocks(node->base_desc, dedup_ch->base_ch, io_ctx->buf,
+				   dedup_chunk_offset(node, io_ctx->pinned - 1), node->chunk_blocks,
+				   dedup_write_read_done, bdev_io);
+	if (rc != 0) {
+		io_ctx->status = rc;
+		dedup_io_finish(bdev_io);
+	}
+}
+
+static void
+dedup_write_get_buf_cb(struct spdk_iobuf_entry *entry, void *buf)
+{
+	struct dedup_bdev_io *io_ctx = SPDK_CONTAINEROF(entry, struct dedup_bdev_io, iobuf);
+
+	io_ctx->buf = buf;
+	dedup_write_fill(spdk_bdev_io_from_ctx(io_ctx));
+}
+
+static void
+dedup_submit_write(struct dedup_io_channel *dedup_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+
+	io_ctx->buf = spdk_iobuf_get(&dedup_ch->iobuf, dedup_ch->node->chunk_size, &io_ctx->iobuf,
+				     dedup_write_get_buf_cb);
+	if (io_ctx->buf != NULL) {
+		dedup_write_fill(bdev_io);
+	}
+}
+
+/* Only the chunks fully covered by an unmap are unmapped, the rest is left as is. */
+static void
+dedup_submit_unmap(struct dedup_io_channel *dedup_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = dedup_ch->node;
+	uint64_t offset_blocks = bdev_io->u.bdev.offset_blocks;
+
+	io_ctx->lchunk = SPDK_CEIL_DIV(offset_blocks, node->chunk_blocks);
+	io_ctx->unmap_end = (offset_blocks + bdev_io->u.bdev.num_blocks) / node->chunk_blocks;
+	if (io_ctx->lchunk >= io_ctx->unmap_end) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+		return;
+	}
+
+	dedup_io_send_md(bdev_io, _dedup_unmap);
+}
+
+static void
+dedup_passthru_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	spdk_bdev_io_complete(orig_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void
+dedup_submit_passthru(struct dedup_io_channel *dedup_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct vbdev_dedup *node = dedup_ch->node;
+	int rc;
+
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_FLUSH) {
+		/* The map writes completed before the flush are covered too. */
+		rc = spdk_bdev_flush_blocks(node->base_desc, dedup_ch->base_ch, 0,
+					    node->base_bdev->blockcnt, dedup_passthru_done, bdev_io);
+	} else {
+		rc = spdk_bdev_reset(node->base_desc, dedup_ch->base_ch, dedup_passthru_done, bdev_io);
+	}
+	if (rc != 0) {
+		if (rc == -ENOMEM) {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		} else {
+			SPDK_ERRLOG("ERROR on bdev_io submission!\n");
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		}
+	}
+}
+
+static void
+vbdev_dedup_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_io_channel *dedup_ch = spdk_io_channel_get_ctx(ch);
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+
+	memset(io_ctx, 0, sizeof(*io_ctx));
+	io_ctx->ch = ch;
+	io_ctx->lchunk = bdev_io->u.bdev.offset_blocks / dedup_ch->node->chunk_blocks;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		spdk_bdev_io_get_buf(bdev_io, dedup_read_get_buf_cb,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		dedup_submit_write(dedup_ch, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		dedup_submit_unmap(dedup_ch, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_RESET:
+		dedup_submit_passthru(dedup_ch, bdev_io);
+		break;
+	default:
+		SPDK_ERRLOG("dedup: unknown I/O type %d\n", bdev_io->type);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		break;
+	}
+}
+
+static bool
+vbdev_dedup_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+{
+	struct vbdev_dedup *node = (struct vbdev_dedup *)ctx;
+
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		return true;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_RESET:
+		return spdk_bdev_io_type_supported(node->base_bdev, io_type);
+	default:
+		/* Write zeroes is emulated with regular writes by the bdev layer, which don't use
+		 * any physical chunk.
+		 */
+		return false;
+	}
+}
+
+static struct spdk_io_channel *
+vbdev_dedup_get_io_channel(void *ctx)
+{
+	struct vbdev_dedup *node = (struct vbdev_dedup *)ctx;
+
+	return spdk_get_io_channel(node);
+}
+
+static uint64_t
+dedup_num_free_chunks(struct vbdev_dedup *node)
+{
+	return node->num_free + node->released_tail - node->released_head;
+}
+
+/* This is the output for bdev_get_bdevs() for this vbdev */
+static int
+vbdev_dedup_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+{
+	struct vbdev_dedup *node = (struct vbdev_dedup *)ctx;
+
+	spdk_json_write_name(w, "dedup");
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&node->dedup_bdev));
+	spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(node->base_bdev));
+	spdk_json_write_named_uint32(w, "chunk_size", node->chunk_size);
+	spdk_json_write_named_uint64(w, "num_chunks", node->num_pchunks);
+	spdk_json_write_named_uint64(w, "num_free_chunks", dedup_num_free_chunks(node));
+	spdk_json_write_named_uint64(w, "num_unique_writes", node->num_unique_writes);
+	spdk_json_write_named_uint64(w, "num_dedup_writes", node->num_dedup_writes);
+	spdk_json_write_named_uint64(w, "num_zero_writes", node->num_zero_writes);
+	spdk_json_write_named_uint64(w, "num_miscompares", node->num_miscompares);
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
+/* This is used to generate JSON that can configure this module to its current state. */
+static int
+vbdev_dedup_config_json(struct spdk_json_write_ctx *w)
+{
+	struct vbdev_dedup *node;
+
+	TAILQ_FOREACH(node, &g_dedup_nodes, link) {
+		const struct spdk_uuid *uuid = spdk_bdev_get_uuid(&node->dedup_bdev);
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_dedup_create");
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&node->dedup_bdev));
+		spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(node->base_bdev));
+		if (!spdk_uuid_is_null(uuid)) {
+			spdk_json_write_named_uuid(w, "uuid", uuid);
+		}
+		spdk_json_write_named_uint32(w, "chunk_size", node->chunk_size);
+		spdk_json_write_named_uint64(w, "num_blocks", node->dedup_bdev.blockcnt);
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+	return 0;
+}
+
+static int
+dedup_bdev_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	struct dedup_io_channel *dedup_ch = ctx_buf;
+	struct vbdev_dedup *node = io_device;
+	int rc;
+
+	rc = spdk_iobuf_channel_init(&dedup_ch->iobuf, "dedup", 0, 0);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to create iobuf channel: %s\n", spdk_strerror(-rc));
+		return rc;
+	}
+
+	dedup_ch->base_ch = spdk_bdev_get_io_channel(node->base_desc);
+	if (dedup_ch->base_ch == NULL) {
+		goto err;
+	}
+
+	dedup_ch->accel_ch = spdk_accel_get_io_channel();
+	if (dedup_ch->accel_ch == NULL) {
+		goto err;
+	}
+
+	dedup_ch->node = node;
+
+	return 0;
+err:
+	if (dedup_ch->base_ch != NULL) {
+		spdk_put_io_channel(dedup_ch->base_ch);
+	}
+	spdk_iobuf_channel_fini(&dedup_ch->iobuf);
+	return -ENOMEM;
+}
+
+static void
+dedup_bdev_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct dedup_io_channel *dedup_ch = ctx_buf;
+
+	spdk_put_io_channel(dedup_ch->accel_ch);
+	spdk_put_io_channel(dedup_ch->base_ch);
+	spdk_iobuf_channel_fini(&dedup_ch->iobuf);
+}
+
+static void
+dedup_close_bdev(struct vbdev_dedup *node)
+{
+	spdk_put_io_channel(node->md_ch);
+
+	/* Unclaim the underlying bdev. */
+	spdk_bdev_module_release_bdev(node->base_bdev);
+
+	spdk_bdev_close(node->base_desc);
+}
+
+static void
+dedup_flush_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_dedup *node = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	node->flushing = false;
+	if (success) {
+		node->released_flushed = node->flush_mark;
+	}
+	node->next_flush_tsc = spdk_get_ticks() +
+			       VBDEV_DEDUP_FLUSH_INTERVAL_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+}
+
+/* Flush the base bdev so that the map updates releasing the chunks are persisted before the
+ * chunks are written again.
+ */
+static void
+dedup_flush_released_chunks(struct vbdev_dedup *node)
+{
+	int rc;
+
+	node->flushing = true;
+	node->flush_mark = node->released_tail;
+	rc = spdk_bdev_flush_blocks(node->base_desc, node->md_ch, 0, node->base_bdev->blockcnt,
+				    dedup_flush_done, node);
+	if (rc != 0) {
+		/* Tried again on the next poll. */
+		node->flushing = false;
+	}
+}
+
+static int
+dedup_poll(void *arg)
+{
+	struct vbdev_dedup *node = arg;
+	struct dedup_bdev_io *io_ctx;
+	uint32_t pchunk;
+	int count = 0;
+
+	if (node->deleting) {
+		if (node->flushing || !TAILQ_EMPTY(&node->md_writes)) {
+			return SPDK_POLLER_IDLE;
+		}
+
+		/* Nothing in flight anymore, finish the destruction. */
+		spdk_poller_unregister(&node->poller);
+		dedup_close_bdev(node);
+		spdk_io_device_unregister(node, _device_unregister_cb);
+		return SPDK_POLLER_BUSY;
+	}
+
+	/* Reuse the released chunks covered by a flush once the I/Os pinning them are done. */
+	while (node->released_head != node->released_flushed) {
+		pchunk = node->released[node->released_head % node->num_pchunks];
+		if (__atomic_load_n(&node->readers[pchunk], __ATOMIC_SEQ_CST) != 0) {
+			break;
+		}
+		node->free_chunks[node->num_free++] = pchunk;
+		node->released_head++;
+		count++;
+	}
+
+	while (node->num_free > 0 && (io_ctx = TAILQ_FIRST(&node->alloc_waiters)) != NULL) {
+		TAILQ_REMOVE(&node->alloc_waiters, io_ctx, link);
+		dedup_alloc(node, spdk_bdev_io_from_ctx(io_ctx));
+		count++;
+	}
+
+	if (node->removed) {
+		/* Nothing gets reusable anymore. */
+		while ((io_ctx = TAILQ_FIRST(&node->alloc_waiters)) != NULL) {
+			TAILQ_REMOVE(&node->alloc_waiters, io_ctx, link);
+			dedup_alloc(node, spdk_bdev_io_from_ctx(io_ctx));
+			count++;
+		}
+		return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+	}
+
+	if (!node->flushing && node->released_flushed != node->released_tail &&
+	    (node->num_free == 0 || spdk_get_ticks() >= node->next_flush_tsc)) {
+		dedup_flush_released_chunks(node);
+		count++;
+	}
+
+	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+/* Create the dedup association from the bdev names and insert on the global list. */
+static int
+vbdev_dedup_insert_name(const char *vbdev_name, const char *base_bdev_name,
+			const struct spdk_uuid *uuid, uint32_t chunk_size, uint64_t num_blocks,
+			struct bdev_names **_name)
+{
+	struct bdev_names *name;
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(vbdev_name, name->vbdev_name) == 0) {
+			SPDK_ERRLOG("dedup bdev %s already exists\n", vbdev_name);
+			return -EEXIST;
+		}
+	}
+
+	name = calloc(1, sizeof(struct bdev_names));
+	if (!name) {
+		SPDK_ERRLOG("could not allocate bdev_names\n");
+		return -ENOMEM;
+	}
+
+	name->vbdev_name = strdup(vbdev_name);
+	name->base_bdev_name = strdup(base_bdev_name);
+	if (!name->vbdev_name || !name->base_bdev_name) {
+		SPDK_ERRLOG("could not allocate bdev names\n");
+		free(name->vbdev_name);
+		free(name->base_bdev_name);
+		free(name);
+		return -ENOMEM;
+	}
+
+	spdk_uuid_copy(&name->uuid, uuid);
+	name->chunk_size = chunk_size;
+	name->num_blocks = num_blocks;
+	TAILQ_INSERT_TAIL(&g_bdev_names, name, link);
+	*_name = name;
+
+	return 0;
+}
+
+static void
+vbdev_dedup_free_name(struct bdev_names *name)
+{
+	free(name->vbdev_name);
+	free(name->base_bdev_name);
+	free(name);
+}
+
+static void
+vbdev_dedup_remove_name(const char *vbdev_name)
+{
+	struct bdev_names *name;
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(name->vbdev_name, vbdev_name) == 0) {
+			TAILQ_REMOVE(&g_bdev_names, name, link);
+			vbdev_dedup_free_name(name);
+			break;
+		}
+	}
+}
+
+static int
+vbdev_dedup_init(void)
+{
+	return spdk_iobuf_register_module("dedup");
+}
+
+/* Called when the entire module is being torn down. */
+static void
+vbdev_dedup_finish(void)
+{
+	struct bdev_names *name;
+
+	while ((name = TAILQ_FIRST(&g_bdev_names))) {
+		TAILQ_REMOVE(&g_bdev_names, name, link);
+		vbdev_dedup_free_name(name);
+	}
+}
+
+static int
+vbdev_dedup_get_ctx_size(void)
+{
+	return sizeof(struct dedup_bdev_io);
+}
+
+static void
+vbdev_dedup_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	/* No config per bdev needed */
+}
+
+/* When we register our bdev this is how we specify our entry points. */
+static const struct spdk_bdev_fn_table vbdev_dedup_fn_table = {
+	.destruct		= vbdev_dedup_destruct,
+	.submit_request		= vbdev_dedup_submit_request,
+	.io_type_supported	= vbdev_dedup_io_type_supported,
+	.get_io_channel		= vbdev_dedup_get_io_channel,
+	.dump_info_json		= vbdev_dedup_dump_info_json,
+	.write_config_json	= vbdev_dedup_write_config_json,
+};
+
+static void
+vbdev_dedup_base_bdev_hotremove_cb(struct spdk_bdev *bdev_find)
+{
+	struct vbdev_dedup *node, *tmp;
+
+	TAILQ_FOREACH_SAFE(node, &g_dedup_nodes, link, tmp) {
+		if (bdev_find == node->base_bdev) {
+			node->removed = true;
+			/* A bdev still loading its metadata is cleaned up once that is done. */
+			if (!node->loading) {
+				spdk_bdev_unregister(&node->dedup_bdev, NULL, NULL);
+			}
+		}
+	}
+}
+
+/* Called when the underlying bdev triggers asynchronous event such as bdev removal. */
+static void
+vbdev_dedup_base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+			       void *event_ctx)
+{
+	switch (type) {
+	case SPDK_BDEV_EVENT_REMOVE:
+		vbdev_dedup_base_bdev_hotremove_cb(bdev);
+		break;
+	default:
+		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
+		break;
+	}
+}
+
+/* Check the geometry of the base bdev and lay it out. */
+static int
+vbdev_dedup_init_node(struct vbdev_dedup *node, uint32_t chunk_size, uint64_t num_blocks)
+{
+	struct spdk_bdev *base = node->base_bdev;
+	struct spdk_iobuf_opts iobuf_opts;
+	uint64_t map_blocks, crc_blocks, num_pchunks;
+
+	if (base->md_len != 0) {
+		SPDK_ERRLOG("bdevs with metadata are not supported\n");
+		return -EINVAL;
+	}
+
+	/* The chunks are built in iobuf buffers. */
+	spdk_iobuf_get_opts(&iobuf_opts, sizeof(iobuf_opts));
+	if (!spdk_u32_is_pow2(chunk_size) || chunk_size < base->blocklen ||
+	    chunk_size > spdk_min(VBDEV_DEDUP_MAX_CHUNK_SIZE, iobuf_opts.large_bufsize)) {
+		SPDK_ERRLOG("chunk size %" PRIu32 " must be a power of two between the block size %"
+			    PRIu32 " and %" PRIu32 "\n", chunk_size, base->blocklen,
+			    spdk_min(VBDEV_DEDUP_MAX_CHUNK_SIZE, iobuf_opts.large_bufsize));
+		return -EINVAL;
+	}
+
+	node->chunk_size = chunk_size;
+	node->chunk_blocks = chunk_size / base->blocklen;
+	node->num_lchunks = (num_blocks != 0 ? num_blocks : base->blockcnt) / node->chunk_blocks;
+	if (node->num_lchunks == 0 || node->num_lchunks >= UINT32_MAX) {
+		SPDK_ERRLOG("dedup bdev can't have %" PRIu64 " chunks of %" PRIu32 " bytes\n",
+			    node->num_lchunks, chunk_size);
+		return -EINVAL;
+	}
+
+	/* The header block, the map, the CRC-32C table, then the physical chunks aligned to the
+	 * chunk size. Start from the number of chunks fitting without the alignment.
+	 */
+	map_blocks = SPDK_CEIL_DIV(node->num_lchunks * sizeof(uint32_t), base->blocklen);
+	if (base->blockcnt <= 1 + map_blocks) {
+		SPDK_ERRLOG("base bdev %s is too small to hold any chunk\n", base->name);
+		return -EINVAL;
+	}
+	num_pchunks = (base->blockcnt - 1 - map_blocks) * base->blocklen /
+		      (chunk_size + sizeof(uint32_t));
+	for (; num_pchunks > 0; num_pchunks--) {
+		crc_blocks = SPDK_CEIL_DIV(num_pchunks * sizeof(uint32_t), base->blocklen);
+		node->md_blocks = 1 + map_blocks + crc_blocks;
+		node->data_offset_blocks = SPDK_CEIL_DIV(node->md_blocks, node->chunk_blocks) *
+					   node->chunk_blocks;
+		if (node->data_offset_blocks + num_pchunks * node->chunk_blocks <= base->blockcnt) {
+			break;
+		}
+	}
+	if (num_pchunks == 0) {
+		SPDK_ERRLOG("base bdev %s is too small to hold any chunk\n", base->name);
+		return -EINVAL;
+	}
+	if (num_pchunks >= UINT32_MAX) {
+		SPDK_ERRLOG("base bdev %s has too many chunks of %" PRIu32 " bytes\n", base->name,
+			    chunk_size);
+		return -EINVAL;
+	}
+	node->num_pchunks = num_pchunks;
+	node->crc_offset_blocks = 1 + map_blocks;
+	node->bucket_mask = spdk_align64pow2(num_pchunks) - 1;
+
+	node->md_buf = spdk_dma_zmalloc(node->md_blocks * base->blocklen, 0x1000, NULL);
+	node->refcnt = calloc(num_pchunks, sizeof(uint32_t));
+	node->readers = calloc(num_pchunks, sizeof(uint32_t));
+	node->buckets = calloc(node->bucket_mask + 1, sizeof(uint32_t));
+	node->next = calloc(num_pchunks, sizeof(uint32_t));
+	node->free_chunks = calloc(num_pchunks, sizeof(uint32_t));
+	node->released = calloc(num_pchunks, sizeof(uint32_t));
+	if (!node->md_buf || !node->refcnt || !node->readers || !node->buckets || !node->next ||
+	    !node->free_chunks || !node->released) {
+		SPDK_ERRLOG("could not allocate dedup metadata\n");
+		return -ENOMEM;
+	}
+	node->map = (uint32_t *)((uint8_t *)node->md_buf + base->blocklen);
+	node->crcs = (uint32_t *)((uint8_t *)node->md_buf + node->crc_offset_blocks * base->blocklen);
+
+	return 0;
+}
+
+/* The metadata is loaded, register the bdev. */
+static void
+dedup_load_done(struct vbdev_dedup *node, int rc)
+{
+	bdev_dedup_create_cb cb_fn = node->create_cb;
+	void *cb_arg = node->create_cb_arg;
+
+	node->loading = false;
+	if (rc == 0 && node->removed) {
+		rc = -ENODEV;
+	}
+
+	if (rc == 0) {
+		node->next_flush_tsc = spdk_get_ticks() +
+				       VBDEV_DEDUP_FLUSH_INTERVAL_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+		node->poller = SPDK_POLLER_REGISTER(dedup_poll, node, VBDEV_DEDUP_POLL_US);
+		if (node->poller == NULL) {
+			rc = -ENOMEM;
+		}
+	}
+
+	if (rc == 0) {
+		spdk_io_device_register(node, dedup_bdev_ch_create_cb, dedup_bdev_ch_destroy_cb,
+					sizeof(struct dedup_io_channel), node->dedup_bdev.name);
+		SPDK_NOTICELOG("io_device created at: 0x%p\n", node);
+
+		rc = spdk_bdev_register(&node->dedup_bdev);
+		if (rc) {
+			SPDK_ERRLOG("could not register dedup_bdev\n");
+			spdk_io_device_unregister(node, NULL);
+			spdk_poller_unregister(&node->poller);
+		}
+	}
+
+	if (rc == 0) {
+		SPDK_NOTICELOG("created dedup_bdev for: %s\n", node->dedup_bdev.name);
+	} else {
+		SPDK_ERRLOG("could not create dedup bdev %s: %s\n", node->dedup_bdev.name,
+			    spdk_strerror(-rc));
+		TAILQ_REMOVE(&g_dedup_nodes, node, link);
+		vbdev_dedup_remove_name(node->dedup_bdev.name);
+		dedup_close_bdev(node);
+		vbdev_dedup_free(node);
+	}
+
+	if (cb_fn != NULL) {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+/* Check the metadata read from the base bdev, rebuild the reference counts, the index and the
+ * free chunks from the map.
+ */
+static int
+dedup_md_parse(struct vbdev_dedup *node)
+{
+	struct dedup_md_header *hdr = node->md_buf;
+	uint64_t lchunk;
+	uint32_t pchunk;
+
+	if (from_le32(&hdr->version) != VBDEV_DEDUP_MD_VERSION ||
+	    from_le32(&hdr->blocklen) != node->dedup_bdev.blocklen ||
+	    from_le64(&hdr->chunk_blocks) != node->chunk_blocks ||
+	    from_le64(&hdr->num_lchunks) != node->num_lchunks ||
+	    from_le64(&hdr->num_pchunks) != node->num_pchunks) {
+		SPDK_ERRLOG("metadata on base bdev %s doesn't match the chunk size or bdev size\n",
+			    node->base_bdev->name);
+		return -EINVAL;
+	}
+
+	for (lchunk = 0; lchunk < node->num_lchunks; lchunk++) {
+		pchunk = from_le32(&node->map[lchunk]);
+		if (pchunk == 0) {
+			continue;
+		}
+		if (pchunk > node->num_pchunks) {
+			SPDK_ERRLOG("metadata on base bdev %s is corrupted\n", node->base_bdev->name);
+			return -EILSEQ;
+		}
+		if (node->refcnt[pchunk - 1]++ == 0) {
+			dedup_index_insert(node, pchunk - 1);
+		}
+	}
+
+	/* The lowest chunks are used first. */
+	for (pchunk = node->num_pchunks; pchunk-- > 0;) {
+		if (node->refcnt[pchunk] == 0) {
+			node->free_chunks[node->num_free++] = pchunk;
+		}
+	}
+
+	return 0;
+}
+
+static void dedup_md_rw_next(struct vbdev_dedup *node);
+
+static void
+dedup_md_rw_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_dedup *node = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		dedup_load_done(node, -EIO);
+		return;
+	}
+
+	dedup_md_rw_next(node);
+}
+
+/* Initialize the metadata of a base bdev not used for deduplication yet, with all the chunks
+ * reading as zeroes.
+ */
+static void
+dedup_md_format(struct vbdev_dedup *node)
+{
+	struct dedup_md_header *hdr = node->md_buf;
+	uint32_t pchunk;
+
+	SPDK_NOTICELOG("formatting base bdev %s for dedup bdev %s\n", node->base_bdev->name,
+		       node->dedup_bdev.name);
+
+	memset(node->md_buf, 0, node->md_blocks * node->dedup_bdev.blocklen);
+	memcpy(hdr->magic, VBDEV_DEDUP_MD_MAGIC, sizeof(hdr->magic));
+	to_le32(&hdr->version, VBDEV_DEDUP_MD_VERSION);
+	to_le32(&hdr->blocklen, node->dedup_bdev.blocklen);
+	to_le64(&hdr->chunk_blocks, node->chunk_blocks);
+	to_le64(&hdr->num_lchunks, node->num_lchunks);
+	to_le64(&hdr->num_pchunks, node->num_pchunks);
+
+	for (pchunk = node->num_pchunks; pchunk-- > 0;) {
+		node->free_chunks[node->num_free++] = pchunk;
+	}
+
+	node->formatting = true;
+	node->md_cursor = 0;
+	dedup_md_rw_next(node);
+}
+
+/* Read or write the next chunk of the metadata region. */
+static void
+dedup_md_rw_next(struct vbdev_dedup *node)
+{
+	struct dedup_md_header *hdr = node->md_buf;
+	uint32_t blocklen = node->dedup_bdev.blocklen;
+	uint64_t offset_blocks = node->md_cursor, num_blocks;
+	void *buf;
+	int rc;
+
+	if (offset_blocks == node->md_blocks) {
+		if (node->formatting) {
+			dedup_load_done(node, 0);
+		} else if (memcmp(hdr->magic, VBDEV_DEDUP_MD_MAGIC, sizeof(hdr->magic)) != 0) {
+			dedup_md_format(node);
+		} else {
+			dedup_load_done(node, dedup_md_parse(node));
+		}
+		return;
+	}
+
+	num_blocks = spdk_min(node->md_blocks - offset_blocks,
+			      spdk_max(VBDEV_DEDUP_MD_IO_SIZE / blocklen, 1));
+	buf = (uint8_t *)node->md_buf + offset_blocks * blocklen;
+	node->md_cursor += num_blocks;
+	if (node->formatting) {
+		rc = spdk_bdev_write_blocks(node->base_desc, node->md_ch, buf, offset_blocks, num_blocks,
+					    dedup_md_rw_done, node);
+	} else {
+		rc = spdk_bdev_read_blocks(node->base_desc, node->md_ch, buf, offset_blocks, num_blocks,
+					   dedup_md_rw_done, node);
+	}
+	if (rc != 0) {
+		dedup_load_done(node, rc);
+	}
+}
+
+/* Create the dedup vbdev from the bdev names if its base bdev is present. The bdev is
+ * registered once its metadata is loaded. This can be called either by the examine path or
+ * RPC method.
+ */
+static int
+vbdev_dedup_register(struct bdev_names *name, bdev_dedup_create_cb cb_fn, void *cb_arg)
+{
+	struct vbdev_dedup *node;
+	struct spdk_uuid ns_uuid;
+	int rc = 0;
+
+	spdk_uuid_parse(&ns_uuid, BDEV_DEDUP_NAMESPACE_UUID);
+
+	node = calloc(1, sizeof(struct vbdev_dedup));
+	if (!node) {
+		SPDK_ERRLOG("could not allocate dedup node\n");
+		return -ENOMEM;
+	}
+	TAILQ_INIT(&node->alloc_waiters);
+	TAILQ_INIT(&node->md_writes);
+
+	node->dedup_bdev.name = strdup(name->vbdev_name);
+	if (!node->dedup_bdev.name) {
+		SPDK_ERRLOG("could not allocate dedup_bdev name\n");
+		vbdev_dedup_free(node);
+		return -ENOMEM;
+	}
+	node->dedup_bdev.product_name = "dedup";
+
+	rc = spdk_bdev_open_ext(name->base_bdev_name, true, vbdev_dedup_base_bdev_event_cb,
+				NULL, &node->base_desc);
+	if (rc) {
+		if (rc != -ENODEV) {
+			SPDK_ERRLOG("could not open bdev %s\n", name->base_bdev_name);
+		}
+		vbdev_dedup_free(node);
+		return rc;
+	}
+	SPDK_NOTICELOG("base bdev opened\n");
+
+	node->base_bdev = spdk_bdev_desc_get_bdev(node->base_desc);
+	node->dedup_bdev.blocklen = node->base_bdev->blocklen;
+
+	rc = vbdev_dedup_init_node(node, name->chunk_size, name->num_blocks);
+	if (rc) {
+		goto err_close;
+	}
+	node->dedup_bdev.blockcnt = node->num_lchunks * node->chunk_blocks;
+
+	if (!spdk_uuid_is_null(&name->uuid)) {
+		/* Use the configured UUID */
+		spdk_uuid_copy(&node->dedup_bdev.uuid, &name->uuid);
+	} else {
+		/* Generate UUID based on namespace UUID + base bdev UUID. */
+		rc = spdk_uuid_generate_sha1(&node->dedup_bdev.uuid, &ns_uuid,
+					     (const char *)&node->base_bdev->uuid,
+					     sizeof(struct spdk_uuid));
+		if (rc) {
+			SPDK_ERRLOG("Unable to generate new UUID for dedup bdev\n");
+			goto err_close;
+		}
+	}
+
+	node->dedup_bdev.write_cache = node->base_bdev->write_cache;
+	node->dedup_bdev.required_alignment = node->base_bdev->required_alignment;
+	/* Each read and write accesses a single chunk. */
+	node->dedup_bdev.optimal_io_boundary = node->chunk_blocks;
+	node->dedup_bdev.split_on_optimal_io_boundary = true;
+	node->flush_released = node->base_bdev->write_cache &&
+			       spdk_bdev_io_type_supported(node->base_bdev, SPDK_BDEV_IO_TYPE_FLUSH);
+
+	node->dedup_bdev.ctxt = node;
+	node->dedup_bdev.fn_table = &vbdev_dedup_fn_table;
+	node->dedup_bdev.module = &dedup_if;
+
+	/* Save the thread where the base device is opened, it owns the chunks. */
+	node->thread = spdk_get_thread();
+
+	rc = spdk_bdev_module_claim_bdev(node->base_bdev, node->base_desc, node->dedup_bdev.module);
+	if (rc) {
+		SPDK_ERRLOG("could not claim bdev %s\n", name->base_bdev_name);
+		goto err_close;
+	}
+	SPDK_NOTICELOG("bdev claimed\n");
+
+	node->md_ch = spdk_bdev_get_io_channel(node->base_desc);
+	if (!node->md_ch) {
+		SPDK_ERRLOG("could not get I/O channel\n");
+		rc = -ENOMEM;
+		goto err_release;
+	}
+
+	node->loading = true;
+	node->create_cb = cb_fn;
+	node->create_cb_arg = cb_arg;
+	TAILQ_INSERT_TAIL(&g_dedup_nodes, node, link);
+
+	/* Completed by dedup_load_done(), which calls cb_fn. */
+	dedup_md_rw_next(node);
+
+	return 0;
+
+err_release:
+	spdk_bdev_module_release_bdev(node->base_bdev);
+err_close:
+	spdk_bdev_close(node->base_desc);
+	vbdev_dedup_free(node);
+
+	return rc;
+}
+
+/* Create the dedup disk from the given bdev name. */
+int
+bdev_dedup_create_disk(const char *vbdev_name, const char *base_bdev_name,
+		       const struct spdk_uuid *uuid, uint32_t chunk_size, uint64_t num_blocks,
+		       bdev_dedup_create_cb cb_fn, void *cb_arg)
+{
+	struct bdev_names *name;
+	int rc;
+
+	/* Insert the bdev name into our global name list even if it doesn't exist yet,
+	 * it may show up soon...
+	 */
+	rc = vbdev_dedup_insert_name(vbdev_name, base_bdev_name, uuid, chunk_size, num_blocks,
+				     &name);
+	if (rc) {
+		return rc;
+	}
+
+	rc = vbdev_dedup_register(name, cb_fn, cb_arg);
+	if (rc == -ENODEV) {
+		/* This is not an error, we tracked the name above and it still
+		 * may show up later.
+		 */
+		SPDK_NOTICELOG("vbdev creation deferred pending base bdev arrival\n");
+		cb_fn(cb_arg, 0);
+		rc = 0;
+	} else if (rc != 0) {
+		vbdev_dedup_remove_name(vbdev_name);
+	}
+
+	return rc;
+}
+
+void
+bdev_dedup_delete_disk(const char *vbdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	int rc;
+
+	/* Some cleanup happens in the destruct callback. */
+	rc = spdk_bdev_unregister_by_name(vbdev_name, &dedup_if, cb_fn, cb_arg);
+	if (rc == 0) {
+		/* Remove the association from g_bdev_names. This is required so that the vbdev
+		 * does not get re-created if the same bdev is constructed at some other time,
+		 * unless the underlying bdev was hot-removed.
+		 */
+		vbdev_dedup_remove_name(vbdev_name);
+	} else {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static void
+vbdev_dedup_examine(struct spdk_bdev *bdev)
+{
+	struct bdev_names *name, *tmp;
+
+	/* A failed creation removes its name. */
+	TAILQ_FOREACH_SAFE(name, &g_bdev_names, link, tmp) {
+		if (strcmp(name->base_bdev_name, bdev->name) == 0) {
+			SPDK_NOTICELOG("Match on %s\n", bdev->name);
+			vbdev_dedup_register(name, NULL, NULL);
+		}
+	}
+
+	spdk_bdev_module_examine_done(&dedup_if);
+}
+
+SPDK_LOG_REGISTER_COMPONENT(vbdev_dedup)
@@ -0,0 +1,57 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#ifndef SPDK_VBDEV_DEDUP_H
+#define SPDK_VBDEV_DEDUP_H
+
+#include "spdk/stdinc.h"
+
+#include "spdk/bdev.h"
+#include "spdk/bdev_module.h"
+
+/* Default size of a chunk, the unit data is deduplicated in, in bytes. */
+#define VBDEV_DEDUP_DEFAULT_CHUNK_SIZE	4096
+/* Largest supported chunk size, in bytes. */
+#define VBDEV_DEDUP_MAX_CHUNK_SIZE	(64 * 1024)
+
+typedef void (*bdev_dedup_create_cb)(void *cb_arg, int rc);
+
+/**
+ * Create new deduplicating bdev.
+ *
+ * The data written to the deduplicating bdev is split into chunks. A chunk with the same
+ * content as one already stored on the base bdev is only referenced again, the others are
+ * written to a free chunk of the base bdev. The chunk map is persisted at the beginning of
+ * the base bdev, which is formatted if it doesn't hold the metadata of a deduplicating bdev
+ * yet.
+ *
+ * \param vbdev_name Name of the deduplicating bdev.
+ * \param base_bdev_name Bdev storing the chunks and the metadata.
+ * \param uuid Optional UUID to assign to the deduplicating bdev.
+ * \param chunk_size Size of a chunk in bytes. It must be a power of two, a multiple of the
+ * block size and at most VBDEV_DEDUP_MAX_CHUNK_SIZE.
+ * \param num_blocks Size of the deduplicating bdev in blocks, rounded down to a multiple of the
+ * chunk size. 0 for the size of the base bdev.
+ * \param cb_fn Function to call once the metadata is loaded and the bdev registered, or right
+ * away if the creation is deferred until the base bdev shows up. Not called if this function
+ * returns an error.
+ * \param cb_arg Argument to pass to cb_fn.
+ * \return 0 on success, other on failure.
+ */
+int bdev_dedup_create_disk(const char *vbdev_name, const char *base_bdev_name,
+			   const struct spdk_uuid *uuid, uint32_t chunk_size, uint64_t num_blocks,
+			   bdev_dedup_create_cb cb_fn, void *cb_arg);
+
+/**
+ * Delete deduplicating bdev. Its content stays on the base bdev, re-creating the bdev on it
+ * brings it back.
+ *
+ * \param vbdev_name Name of the deduplicating bdev.
+ * \param cb_fn Function to call after deletion.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void bdev_dedup_delete_disk(const char *vbdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg);
+
+#endif /* SPDK_VBDEV_DEDUP_H */
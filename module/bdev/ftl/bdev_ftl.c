@@ -234,6 +234,14 @@ bdev_ftl_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w
 
 	spdk_json_write_named_bool(w, "fast_shutdown", conf.fast_shutdown);
 
+	spdk_json_write_named_bool(w, "hot_cold_streams", conf.hot_cold_streams);
+
+	spdk_json_write_named_bool(w, "l2p_scan_resistant", conf.l2p_scan_resistant);
+
+	spdk_json_write_named_uint32(w, "nv_cache_compaction_chunks", conf.nv_cache_compaction_chunks);
+
+	spdk_json_write_named_uint32(w, "fdp_placement_handles", conf.fdp_placement_handles);
+
 	spdk_json_write_named_string(w, "base_bdev", conf.base_bdev);
 
 	if (conf.cache_bdev) {
@@ -54,6 +54,22 @@ static const struct spdk_json_object_decoder rpc_bdev_ftl_create_decoders[] = {
 		"fast_shutdown", offsetof(struct spdk_ftl_conf, fast_shutdown),
 		spdk_json_decode_bool, true
 	},
+	{
+		"hot_cold_streams", offsetof(struct spdk_ftl_conf, hot_cold_streams),
+		spdk_json_decode_bool, true
+	},
+	{
+		"l2p_scan_resistant", offsetof(struct spdk_ftl_conf, l2p_scan_resistant),
+		spdk_json_decode_bool, true
+	},
+	{
+		"nv_cache_compaction_chunks", offsetof(struct spdk_ftl_conf, nv_cache_compaction_chunks),
+		spdk_json_decode_uint8, true
+	},
+	{
+		"fdp_placement_handles", offsetof(struct spdk_ftl_conf, fdp_placement_handles),
+		spdk_json_decode_uint8, true
+	},
 };
 
 static void
@@ -960,6 +960,71 @@ cleanup:
 
 SPDK_RPC_REGISTER("bdev_lvol_set_read_only", rpc_bdev_lvol_set_read_only, SPDK_RPC_RUNTIME)
 
+struct rpc_bdev_lvol_set_esnap_copy_on_read {
+	char *name;
+	uint32_t clusters_per_sec;
+};
+
+static void
+free_rpc_bdev_lvol_set_esnap_copy_on_read(struct rpc_bdev_lvol_set_esnap_copy_on_read *req)
+{
+	free(req->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_lvol_set_esnap_copy_on_read_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_lvol_set_esnap_copy_on_read, name), spdk_json_decode_string},
+	{"clusters_per_sec", offsetof(struct rpc_bdev_lvol_set_esnap_copy_on_read, clusters_per_sec),
+	 spdk_json_decode_uint32},
+};
+
+static void
+rpc_bdev_lvol_set_esnap_copy_on_read(struct spdk_jsonrpc_request *request,
+				     const struct spdk_json_val *params)
+{
+	struct rpc_bdev_lvol_set_esnap_copy_on_read req = {};
+	struct spdk_bdev *bdev;
+	struct spdk_lvol *lvol;
+	int rc;
+
+	SPDK_INFOLOG(lvol_rpc, "Setting esnap copy-on-read of lvol\n");
+
+	if (spdk_json_decode_object(params, rpc_bdev_lvol_set_esnap_copy_on_read_decoders,
+				    SPDK_COUNTOF(rpc_bdev_lvol_set_esnap_copy_on_read_decoders),
+				    &req)) {
+		SPDK_INFOLOG(lvol_rpc, "spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	bdev = spdk_bdev_get_by_name(req.name);
+	if (bdev == NULL) {
+		SPDK_ERRLOG("no bdev for provided name %s\n", req.name);
+		spdk_jsonrpc_send_error_response(request, -ENODEV, spdk_strerror(ENODEV));
+		goto cleanup;
+	}
+
+	lvol = vbdev_lvol_get_from_bdev(bdev);
+	if (lvol == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENODEV, spdk_strerror(ENODEV));
+		goto cleanup;
+	}
+
+	rc = spdk_lvol_set_esnap_copy_on_read(lvol, req.clusters_per_sec);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+
+cleanup:
+	free_rpc_bdev_lvol_set_esnap_copy_on_read(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_lvol_set_esnap_copy_on_read", rpc_bdev_lvol_set_esnap_copy_on_read,
+		  SPDK_RPC_RUNTIME)
+
 struct rpc_bdev_lvol_delete {
 	char *name;
 };
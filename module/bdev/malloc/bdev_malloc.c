@@ -20,6 +20,9 @@ struct malloc_disk {
 	struct spdk_bdev		disk;
 	void				*malloc_buf;
 	void				*malloc_md_buf;
+	/* Copies of malloc_buf indexed by NUMA node ID, NULL unless numa_replicas was set */
+	void				**replicas;
+	uint32_t			num_replicas;
 	TAILQ_ENTRY(malloc_disk)	link;
 };
 
@@ -34,6 +37,7 @@ struct malloc_channel {
 	struct spdk_io_channel		*accel_channel;
 	struct spdk_poller		*completion_poller;
 	TAILQ_HEAD(, malloc_task)	completed_tasks;
+	int32_t				numa_id;
 };
 
 static int
@@ -186,11 +190,24 @@ malloc_unmap_write_zeroes_generate_pi(struct spdk_bdev_io *bdev_io)
 	return rc;
 }
 
+static void
+malloc_sync_replicas(struct malloc_disk *mdisk, uint64_t offset, uint64_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < mdisk->num_replicas; i++) {
+		if (mdisk->replicas[i] != NULL && mdisk->replicas[i] != mdisk->malloc_buf) {
+			memcpy((char *)mdisk->replicas[i] + offset, (char *)mdisk->malloc_buf + offset, len);
+		}
+	}
+}
+
 static void
 malloc_done(void *ref, int status)
 {
 	struct malloc_task *task = (struct malloc_task *)ref;
 	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(task);
+	struct malloc_disk *mdisk = bdev_io->bdev->ctxt;
 	int rc;
 
 	if (status != 0) {
@@ -238,6 +255,20 @@ malloc_done(void *ref, int status)
 		}
 	}
 
+	if (mdisk->replicas != NULL && task->status == SPDK_BDEV_IO_STATUS_SUCCESS) {
+		switch (bdev_io->type) {
+		case SPDK_BDEV_IO_TYPE_WRITE:
+		case SPDK_BDEV_IO_TYPE_UNMAP:
+		case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+			/* Only the data is replicated, the separate metadata buffer is shared */
+			malloc_sync_replicas(mdisk, bdev_io->u.bdev.offset_blocks * bdev_io->bdev->blocklen,
+					     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+			break;
+		default:
+			break;
+		}
+	}
+
 	assert(!bdev_io->u.bdev.accel_sequence || task->status == SPDK_BDEV_IO_STATUS_NOMEM);
 	spdk_bdev_io_complete(spdk_bdev_io_from_ctx(task), task->status);
 }
@@ -276,12 +307,22 @@ SPDK_BDEV_MODULE_REGISTER(malloc, &malloc_if)
 static void
 malloc_disk_free(struct malloc_disk *malloc_disk)
 {
+	uint32_t i;
+
 	if (!malloc_disk) {
 		return;
 	}
 
 	free(malloc_disk->disk.name);
-	spdk_free(malloc_disk->malloc_buf);
+	if (malloc_disk->replicas != NULL) {
+		/* malloc_buf is one of the replicas */
+		for (i = 0; i < malloc_disk->num_replicas; i++) {
+			spdk_free(malloc_disk->replicas[i]);
+		}
+		free(malloc_disk->replicas);
+	} else {
+		spdk_free(malloc_disk->malloc_buf);
+	}
 	spdk_free(malloc_disk->malloc_md_buf);
 	free(malloc_disk);
 }
@@ -334,6 +375,18 @@ malloc_get_md_buf(struct spdk_bdev_io *bdev_io)
 	return (char *)mdisk->malloc_md_buf + malloc_get_md_offset(bdev_io);
 }
 
+static void *
+malloc_get_local_buf(struct malloc_disk *mdisk, struct malloc_channel *mch)
+{
+	if (mdisk->replicas != NULL && mch->numa_id >= 0 &&
+	    (uint32_t)mch->numa_id < mdisk->num_replicas &&
+	    mdisk->replicas[mch->numa_id] != NULL) {
+		return mdisk->replicas[mch->numa_id];
+	}
+
+	return mdisk->malloc_buf;
+}
+
 static void
 malloc_sequence_fail(struct malloc_task *task, int status)
 {
@@ -360,7 +413,7 @@ malloc_sequence_done(void *ctx, int status)
 }
 
 static void
-bdev_malloc_readv(struct malloc_disk *mdisk, struct spdk_io_channel *ch,
+bdev_malloc_readv(void *buf, struct spdk_io_channel *ch,
 		  struct malloc_task *task, struct spdk_bdev_io *bdev_io)
 {
 	uint64_t len, offset;
@@ -377,7 +430,7 @@ bdev_malloc_readv(struct malloc_disk *mdisk, struct spdk_io_channel *ch,
 
 	task->status = SPDK_BDEV_IO_STATUS_SUCCESS;
 	task->num_outstanding = 0;
-	task->iov.iov_base = mdisk->malloc_buf + offset;
+	task->iov.iov_base = (char *)buf + offset;
 	task->iov.iov_len = len;
 
 	SPDK_DEBUGLOG(bdev_malloc, "read %zu bytes from offset %#" PRIx64 ", iovcnt=%d\n",
@@ -511,8 +564,8 @@ _bdev_malloc_submit_request(struct malloc_channel *mch, struct spdk_bdev_io *bde
 		if (bdev_io->u.bdev.iovs[0].iov_base == NULL) {
 			assert(bdev_io->u.bdev.iovcnt == 1);
 			assert(bdev_io->u.bdev.memory_domain == NULL);
-			bdev_io->u.bdev.iovs[0].iov_base =
-				disk->malloc_buf + bdev_io->u.bdev.offset_blocks * block_size;
+			bdev_io->u.bdev.iovs[0].iov_base = (char *)malloc_get_local_buf(disk, mch) +
+							   bdev_io->u.bdev.offset_blocks * block_size;
 			bdev_io->u.bdev.iovs[0].iov_len = bdev_io->u.bdev.num_blocks * block_size;
 			if (spdk_bdev_is_md_separate(bdev_io->bdev)) {
 				spdk_bdev_io_set_md_buf(bdev_io, malloc_get_md_buf(bdev_io),
@@ -531,7 +584,7 @@ _bdev_malloc_submit_request(struct malloc_channel *mch, struct spdk_bdev_io *bde
 			}
 		}
 
-		bdev_malloc_readv(disk, mch->accel_channel, task, bdev_io);
+		bdev_malloc_readv(malloc_get_local_buf(disk, mch), mch->accel_channel, task, bdev_io);
 		return 0;
 
 	case SPDK_BDEV_IO_TYPE_WRITE:
@@ -611,6 +664,8 @@ bdev_malloc_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev
 static bool
 bdev_malloc_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 {
+	struct malloc_disk *mdisk = ctx;
+
 	switch (io_type) {
 	case SPDK_BDEV_IO_TYPE_READ:
 	case SPDK_BDEV_IO_TYPE_WRITE:
@@ -618,11 +673,16 @@ bdev_malloc_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 	case SPDK_BDEV_IO_TYPE_RESET:
 	case SPDK_BDEV_IO_TYPE_UNMAP:
 	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
-	case SPDK_BDEV_IO_TYPE_ZCOPY:
 	case SPDK_BDEV_IO_TYPE_ABORT:
-	case SPDK_BDEV_IO_TYPE_COPY:
 		return true;
 
+	case SPDK_BDEV_IO_TYPE_ZCOPY:
+	case SPDK_BDEV_IO_TYPE_COPY:
+		/* Both write to malloc_buf without going through malloc_done(), which keeps the
+		 * replicas in sync.
+		 */
+		return mdisk->replicas == NULL;
+
 	default:
 		return false;
 	}
@@ -637,6 +697,8 @@ bdev_malloc_get_io_channel(void *ctx)
 static void
 bdev_malloc_write_json_config(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
 {
+	struct malloc_disk *mdisk = bdev->ctxt;
+
 	spdk_json_write_object_begin(w);
 
 	spdk_json_write_named_string(w, "method", "bdev_malloc_create");
@@ -652,6 +714,7 @@ bdev_malloc_write_json_config(struct spdk_bdev *bdev, struct spdk_json_write_ctx
 	spdk_json_write_named_uint32(w, "dif_type", bdev->dif_type);
 	spdk_json_write_named_bool(w, "dif_is_head_of_md", bdev->dif_is_head_of_md);
 	spdk_json_write_named_uint32(w, "dif_pi_format", bdev->dif_pi_format);
+	spdk_json_write_named_bool(w, "numa_replicas", mdisk->replicas != NULL);
 
 	spdk_json_write_object_end(w);
 
@@ -752,6 +815,33 @@ malloc_disk_setup_pi(struct malloc_disk *mdisk)
 	return rc;
 }
 
+static int
+malloc_disk_alloc_replicas(struct malloc_disk *mdisk, size_t size)
+{
+	int32_t numa_id;
+
+	mdisk->num_replicas = spdk_env_get_last_numa_id() + 1;
+	mdisk->replicas = calloc(mdisk->num_replicas, sizeof(*mdisk->replicas));
+	if (!mdisk->replicas) {
+		SPDK_ERRLOG("replicas calloc() failed\n");
+		return -ENOMEM;
+	}
+
+	SPDK_ENV_FOREACH_NUMA_ID(numa_id) {
+		mdisk->replicas[numa_id] = spdk_zmalloc(size, 2 * 1024 * 1024, NULL, numa_id,
+							SPDK_MALLOC_DMA);
+		if (!mdisk->replicas[numa_id]) {
+			SPDK_ERRLOG("replica spdk_zmalloc() on NUMA node %d failed\n", numa_id);
+			return -ENOMEM;
+		}
+	}
+
+	/* Writes go to the copy on the first node and are then propagated to the others */
+	mdisk->malloc_buf = mdisk->replicas[spdk_env_get_first_numa_id()];
+
+	return 0;
+}
+
 int
 create_malloc_disk(struct spdk_bdev **bdev, const struct malloc_bdev_opts *opts)
 {
@@ -801,18 +891,30 @@ create_malloc_disk(struct spdk_bdev **bdev, const struct malloc_bdev_opts *opts)
 		return -ENOMEM;
 	}
 
-	/*
-	 * Allocate the large backend memory buffer from pinned memory.
-	 *
-	 * TODO: need to pass a hint so we know which socket to allocate
-	 *  from on multi-socket systems.
-	 */
-	mdisk->malloc_buf = spdk_zmalloc(opts->num_blocks * block_size, 2 * 1024 * 1024, NULL,
-					 SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
-	if (!mdisk->malloc_buf) {
-		SPDK_ERRLOG("malloc_buf spdk_zmalloc() failed\n");
-		malloc_disk_free(mdisk);
-		return -ENOMEM;
+	if (opts->numa_replicas) {
+		/*
+		 * Keep a copy of the data on each NUMA node, so that reads are served from
+		 * memory local to the reading core.
+		 */
+		rc = malloc_disk_alloc_replicas(mdisk, opts->num_blocks * block_size);
+		if (rc) {
+			malloc_disk_free(mdisk);
+			return rc;
+		}
+	} else {
+		/*
+		 * Allocate the large backend memory buffer from pinned memory.
+		 *
+		 * TODO: need to pass a hint so we know which socket to allocate
+		 *  from on multi-socket systems.
+		 */
+		mdisk->malloc_buf = spdk_zmalloc(opts->num_blocks * block_size, 2 * 1024 * 1024, NULL,
+						 SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+		if (!mdisk->malloc_buf) {
+			SPDK_ERRLOG("malloc_buf spdk_zmalloc() failed\n");
+			malloc_disk_free(mdisk);
+			return -ENOMEM;
+		}
 	}
 
 	if (!opts->md_interleave && opts->md_size != 0) {
@@ -871,6 +973,8 @@ create_malloc_disk(struct spdk_bdev **bdev, const struct malloc_bdev_opts *opts)
 			malloc_disk_free(mdisk);
 			return rc;
 		}
+
+		malloc_sync_replicas(mdisk, 0, opts->num_blocks * block_size);
 	}
 
 	if (opts->optimal_io_boundary) {
@@ -950,6 +1054,7 @@ malloc_create_channel_cb(void *io_device, void *ctx)
 	}
 
 	TAILQ_INIT(&ch->completed_tasks);
+	ch->numa_id = spdk_env_get_numa_id(spdk_env_get_current_core());
 
 	return 0;
 }
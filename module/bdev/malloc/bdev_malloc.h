@@ -25,6 +25,7 @@ struct malloc_bdev_opts {
 	enum spdk_dif_type dif_type;
 	bool dif_is_head_of_md;
 	enum spdk_dif_pi_format dif_pi_format;
+	bool numa_replicas;
 };
 
 int create_malloc_disk(struct spdk_bdev **bdev, const struct malloc_bdev_opts *opts);
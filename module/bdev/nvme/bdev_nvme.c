@@ -139,6 +139,15 @@ struct nvme_bdev_io {
 
 	/* Used to put nvme_bdev_io into the list */
 	TAILQ_ENTRY(nvme_bdev_io) retry_link;
+
+	/** Keeps track if this is the write in flight to its zone of a zoned namespace */
+	bool zone_write_plugged;
+
+	/* Used to put the write in flight to a zone into the list of its channel */
+	TAILQ_ENTRY(nvme_bdev_io) zone_write_link;
+
+	/** Writes to the same zone waiting for this one to complete, linked by retry_link */
+	TAILQ_HEAD(, nvme_bdev_io) zone_write_waiters;
 };
 
 struct nvme_probe_skip_entry {
@@ -188,6 +197,16 @@ static struct spdk_bdev_nvme_opts g_opts = {
 	.dhchap_digests = BDEV_NVME_DEFAULT_DIGESTS,
 	.dhchap_dhgroups = BDEV_NVME_DEFAULT_DHGROUPS,
 	.rdma_umr_per_io = false,
+	.numa_affinity_qd_threshold = 0,
+	.intr_adaptive_idle_polls = 0,
+	.intr_coalescing_threshold = 0,
+	.intr_coalescing_time_us = 0,
+	.tcp_recv_buf_count = 0,
+	.tcp_recv_buf_size = 0,
+	.tcp_zcopy_threshold = 0,
+	.rdma_inline_copy_size = 0,
+	.io_qpair_idle_timeout_ms = 0,
+	.multipath_stripe_size = 0,
 };
 
 #define NVME_HOTPLUG_POLL_PERIOD_MAX			10000000ULL
@@ -253,6 +272,7 @@ static int bdev_nvme_reset_ctrlr(struct nvme_ctrlr *nvme_ctrlr);
 static int bdev_nvme_failover_ctrlr(struct nvme_ctrlr *nvme_ctrlr);
 static void remove_cb(void *cb_ctx, struct spdk_nvme_ctrlr *ctrlr);
 static int nvme_ctrlr_read_ana_log_page(struct nvme_ctrlr *nvme_ctrlr);
+static void nvme_ctrlr_set_interrupt_coalescing(struct nvme_ctrlr *nvme_ctrlr);
 
 static struct nvme_ns *nvme_ns_alloc(void);
 static void nvme_ns_free(struct nvme_ns *ns);
@@ -832,6 +852,19 @@ nvme_io_path_free(struct nvme_io_path *io_path)
 	free(io_path);
 }
 
+static bool
+nvme_ctrlr_is_numa_local(struct nvme_ctrlr *nvme_ctrlr)
+{
+	int32_t ctrlr_numa_id, core_numa_id;
+
+	ctrlr_numa_id = spdk_nvme_ctrlr_get_numa_id(nvme_ctrlr->ctrlr);
+	core_numa_id = spdk_env_get_numa_id(spdk_env_get_current_core());
+
+	/* Unknown locality is treated as local so that such paths are not penalized. */
+	return ctrlr_numa_id == SPDK_ENV_NUMA_ID_ANY || core_numa_id == SPDK_ENV_NUMA_ID_ANY ||
+	       ctrlr_numa_id == core_numa_id;
+}
+
 static int
 _bdev_nvme_add_io_path(struct nvme_bdev_channel *nbdev_ch, struct nvme_ns *nvme_ns)
 {
@@ -846,6 +879,7 @@ _bdev_nvme_add_io_path(struct nvme_bdev_channel *nbdev_ch, struct nvme_ns *nvme_
 	}
 
 	io_path->nvme_ns = nvme_ns;
+	io_path->numa_local = nvme_ctrlr_is_numa_local(nvme_ns->ctrlr);
 
 	ch = spdk_get_io_channel(nvme_ns->ctrlr);
 	if (ch == NULL) {
@@ -942,6 +976,7 @@ bdev_nvme_create_bdev_channel_cb(void *io_device, void *ctx_buf)
 
 	STAILQ_INIT(&nbdev_ch->io_path_list);
 	TAILQ_INIT(&nbdev_ch->retry_io_list);
+	TAILQ_INIT(&nbdev_ch->zone_write_list);
 
 	pthread_mutex_lock(&nbdev->mutex);
 
@@ -963,6 +998,68 @@ bdev_nvme_create_bdev_channel_cb(void *io_device, void *ctx_buf)
 	return 0;
 }
 
+static inline uint64_t
+bdev_nvme_get_zslba(struct spdk_bdev_io *bdev_io)
+{
+	uint64_t offset_blocks = bdev_io->u.bdev.offset_blocks;
+
+	return offset_blocks - offset_blocks % bdev_io->bdev->zone_size;
+}
+
+/* A zone accepts regular writes only at its write pointer, and the NVMe spec does not
+ * guarantee that commands are executed in submission order. Hence only one write per zone
+ * is submitted at a time, and the writes following it are held until it completes.
+ *
+ * Return true if the write was held, or false if it may be submitted now.
+ */
+static bool
+bdev_nvme_zone_write_plug(struct nvme_bdev_channel *nbdev_ch, struct nvme_bdev_io *bio)
+{
+	uint64_t zslba = bdev_nvme_get_zslba(spdk_bdev_io_from_ctx(bio));
+	struct nvme_bdev_io *plugged_bio;
+
+	TAILQ_FOREACH(plugged_bio, &nbdev_ch->zone_write_list, zone_write_link) {
+		if (bdev_nvme_get_zslba(spdk_bdev_io_from_ctx(plugged_bio)) == zslba) {
+			TAILQ_INSERT_TAIL(&plugged_bio->zone_write_waiters, bio, retry_link);
+			return true;
+		}
+	}
+
+	bio->zone_write_plugged = true;
+	TAILQ_INIT(&bio->zone_write_waiters);
+	TAILQ_INSERT_TAIL(&nbdev_ch->zone_write_list, bio, zone_write_link);
+
+	return false;
+}
+
+/* Pass the zone of the completed write to the next write waiting for it, if any, and
+ * return that write.
+ */
+static struct nvme_bdev_io *
+bdev_nvme_zone_write_unplug(struct nvme_bdev_channel *nbdev_ch, struct nvme_bdev_io *bio)
+{
+	struct nvme_bdev_io *next_bio;
+
+	bio->zone_write_plugged = false;
+	TAILQ_REMOVE(&nbdev_ch->zone_write_list, bio, zone_write_link);
+
+	next_bio = TAILQ_FIRST(&bio->zone_write_waiters);
+	if (next_bio == NULL) {
+		return NULL;
+	}
+
+	TAILQ_REMOVE(&bio->zone_write_waiters, next_bio, retry_link);
+
+	next_bio->zone_write_plugged = true;
+	TAILQ_INIT(&next_bio->zone_write_waiters);
+	TAILQ_CONCAT(&next_bio->zone_write_waiters, &bio->zone_write_waiters, retry_link);
+	TAILQ_INSERT_TAIL(&nbdev_ch->zone_write_list, next_bio, zone_write_link);
+
+	return next_bio;
+}
+
+static void bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io);
+
 /* If cpl != NULL, complete the bdev_io with nvme status based on 'cpl'.
  * If cpl == NULL, complete the bdev_io with bdev status based on 'status'.
  */
@@ -970,13 +1067,26 @@ static inline void
 __bdev_nvme_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status,
 			const struct spdk_nvme_cpl *cpl)
 {
-	spdk_trace_record(TRACE_BDEV_NVME_IO_DONE, 0, 0, (uintptr_t)bdev_io->driver_ctx,
-			  (uintptr_t)bdev_io);
+	struct nvme_bdev_io *bio = (struct nvme_bdev_io *)bdev_io->driver_ctx;
+	struct spdk_io_channel *ch = NULL;
+	struct nvme_bdev_io *next_bio = NULL;
+
+	if (spdk_bdev_io_trace_sampled(bdev_io)) {
+		spdk_trace_record(TRACE_BDEV_NVME_IO_DONE, 0, 0, (uintptr_t)bdev_io->driver_ctx,
+				  (uintptr_t)bdev_io);
+	}
+	if (spdk_unlikely(bio->zone_write_plugged)) {
+		ch = spdk_bdev_io_get_io_channel(bdev_io);
+		next_bio = bdev_nvme_zone_write_unplug(spdk_io_channel_get_ctx(ch), bio);
+	}
 	if (cpl) {
 		spdk_bdev_io_complete_nvme_status(bdev_io, cpl->cdw0, cpl->status.sct, cpl->status.sc);
 	} else {
 		spdk_bdev_io_complete(bdev_io, status);
 	}
+	if (next_bio != NULL) {
+		bdev_nvme_submit_request(ch, spdk_bdev_io_from_ctx(next_bio));
+	}
 }
 
 static void bdev_nvme_abort_retry_ios(struct nvme_bdev_channel *nbdev_ch);
@@ -1049,7 +1159,8 @@ nvme_qpair_is_connected(struct nvme_qpair *nvme_qpair)
 		return false;
 	}
 
-	if (spdk_unlikely(nvme_qpair->ctrlr_ch->reset_iter != NULL)) {
+	if (spdk_unlikely(nvme_qpair->ctrlr_ch->reset_iter != NULL ||
+			  nvme_qpair->ctrlr_ch->connect_poller != NULL)) {
 		return false;
 	}
 
@@ -1224,9 +1335,136 @@ _bdev_nvme_find_io_path_min_qd(struct nvme_bdev_channel *nbdev_ch)
 	return non_optimized;
 }
 
+/* Expected time to serve one more I/O on the path: the average latency of the
+ * path multiplied by the number of I/Os that would be outstanding on it. A path
+ * without a latency sample yet costs nothing, so it is probed first.
+ */
+static inline uint64_t
+nvme_io_path_predicted_latency(struct nvme_io_path *io_path)
+{
+	uint32_t num_outstanding_reqs;
+
+	num_outstanding_reqs = spdk_nvme_qpair_get_num_outstanding_reqs(io_path->qpair->qpair);
+
+	return io_path->qpair->ewma_latency_ticks * (num_outstanding_reqs + 1);
+}
+
+static struct nvme_io_path *
+_bdev_nvme_find_io_path_min_latency(struct nvme_bdev_channel *nbdev_ch)
+{
+	struct nvme_io_path *io_path;
+	struct nvme_io_path *optimized = NULL, *non_optimized = NULL;
+	uint64_t opt_min_lat = UINT64_MAX, non_opt_min_lat = UINT64_MAX;
+	uint64_t latency;
+
+	STAILQ_FOREACH(io_path, &nbdev_ch->io_path_list, stailq) {
+		if (spdk_unlikely(!nvme_qpair_is_connected(io_path->qpair))) {
+			/* The device is currently resetting. */
+			continue;
+		}
+
+		if (spdk_unlikely(!nvme_ns_is_active(io_path->nvme_ns))) {
+			continue;
+		}
+
+		latency = nvme_io_path_predicted_latency(io_path);
+		switch (io_path->nvme_ns->ana_state) {
+		case SPDK_NVME_ANA_OPTIMIZED_STATE:
+			if (latency < opt_min_lat) {
+				opt_min_lat = latency;
+				optimized = io_path;
+			}
+			break;
+		case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
+			if (latency < non_opt_min_lat) {
+				non_opt_min_lat = latency;
+				non_optimized = io_path;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	/* don't cache io path for BDEV_NVME_MP_SELECTOR_LATENCY selector */
+	if (optimized != NULL) {
+		return optimized;
+	}
+
+	return non_optimized;
+}
+
+/* Return the NUMA local io_path with the minimum queue depth if it is below
+ * numa_affinity_qd_threshold. ANA optimized paths are preferred, and a local
+ * non-optimized path is used only if there is no optimized path at all.
+ */
+static struct nvme_io_path *
+_bdev_nvme_find_numa_local_io_path(struct nvme_bdev_channel *nbdev_ch)
+{
+	struct nvme_io_path *io_path;
+	struct nvme_io_path *optimized = NULL, *non_optimized = NULL;
+	uint32_t opt_min_qd = g_opts.numa_affinity_qd_threshold;
+	uint32_t non_opt_min_qd = g_opts.numa_affinity_qd_threshold;
+	uint32_t num_outstanding_reqs;
+	bool any_optimized = false;
+
+	STAILQ_FOREACH(io_path, &nbdev_ch->io_path_list, stailq) {
+		if (spdk_unlikely(!nvme_qpair_is_connected(io_path->qpair))) {
+			/* The device is currently resetting. */
+			continue;
+		}
+
+		if (spdk_unlikely(!nvme_ns_is_active(io_path->nvme_ns))) {
+			continue;
+		}
+
+		switch (io_path->nvme_ns->ana_state) {
+		case SPDK_NVME_ANA_OPTIMIZED_STATE:
+			any_optimized = true;
+			if (!io_path->numa_local) {
+				break;
+			}
+			num_outstanding_reqs = spdk_nvme_qpair_get_num_outstanding_reqs(io_path->qpair->qpair);
+			if (num_outstanding_reqs < opt_min_qd) {
+				opt_min_qd = num_outstanding_reqs;
+				optimized = io_path;
+			}
+			break;
+		case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
+			if (!io_path->numa_local) {
+				break;
+			}
+			num_outstanding_reqs = spdk_nvme_qpair_get_num_outstanding_reqs(io_path->qpair->qpair);
+			if (num_outstanding_reqs < non_opt_min_qd) {
+				non_opt_min_qd = num_outstanding_reqs;
+				non_optimized = io_path;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (optimized != NULL) {
+		return optimized;
+	}
+
+	return any_optimized ? NULL : non_optimized;
+}
+
 static inline struct nvme_io_path *
 bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 {
+	struct nvme_io_path *io_path;
+
+	if (spdk_unlikely(g_opts.numa_affinity_qd_threshold != 0) &&
+	    nbdev_ch->mp_policy == BDEV_NVME_MP_POLICY_ACTIVE_ACTIVE) {
+		io_path = _bdev_nvme_find_numa_local_io_path(nbdev_ch);
+		if (io_path != NULL) {
+			return io_path;
+		}
+	}
+
 	if (spdk_likely(nbdev_ch->current_io_path != NULL)) {
 		if (nbdev_ch->mp_policy == BDEV_NVME_MP_POLICY_ACTIVE_PASSIVE) {
 			return nbdev_ch->current_io_path;
@@ -1241,8 +1479,10 @@ bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 	if (nbdev_ch->mp_policy == BDEV_NVME_MP_POLICY_ACTIVE_PASSIVE ||
 	    nbdev_ch->mp_selector == BDEV_NVME_MP_SELECTOR_ROUND_ROBIN) {
 		return _bdev_nvme_find_io_path(nbdev_ch);
-	} else {
+	} else if (nbdev_ch->mp_selector == BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH) {
 		return _bdev_nvme_find_io_path_min_qd(nbdev_ch);
+	} else {
+		return _bdev_nvme_find_io_path_min_latency(nbdev_ch);
 	}
 }
 
@@ -1381,6 +1621,25 @@ bdev_nvme_abort_retry_io(struct nvme_bdev_channel *nbdev_ch,
 	return -ENOENT;
 }
 
+static int
+bdev_nvme_abort_zone_write(struct nvme_bdev_channel *nbdev_ch,
+			   struct nvme_bdev_io *bio_to_abort)
+{
+	struct nvme_bdev_io *plugged_bio, *bio;
+
+	TAILQ_FOREACH(plugged_bio, &nbdev_ch->zone_write_list, zone_write_link) {
+		TAILQ_FOREACH(bio, &plugged_bio->zone_write_waiters, retry_link) {
+			if (bio == bio_to_abort) {
+				TAILQ_REMOVE(&plugged_bio->zone_write_waiters, bio, retry_link);
+				__bdev_nvme_io_complete(spdk_bdev_io_from_ctx(bio), SPDK_BDEV_IO_STATUS_ABORTED, NULL);
+				return 0;
+			}
+		}
+	}
+
+	return -ENOENT;
+}
+
 static void
 bdev_nvme_update_nvme_error_stat(struct spdk_bdev_io *bdev_io, const struct spdk_nvme_cpl *cpl)
 {
@@ -1548,6 +1807,37 @@ bdev_nvme_check_retry_io(struct nvme_bdev_io *bio,
 	return true;
 }
 
+/* Weight of a new sample in the latency moving average, as a power of two. */
+#define NVME_QPAIR_LATENCY_EWMA_SHIFT	3
+
+static inline void
+bdev_nvme_update_io_path_latency(struct nvme_bdev_io *bio)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
+	struct nvme_bdev_channel *nbdev_ch;
+	struct nvme_qpair *nvme_qpair = bio->io_path->qpair;
+	int64_t delta;
+	uint64_t tsc_diff;
+
+	nbdev_ch = spdk_io_channel_get_ctx(spdk_bdev_io_get_io_channel(bdev_io));
+	if (nbdev_ch->mp_selector != BDEV_NVME_MP_SELECTOR_LATENCY) {
+		return;
+	}
+
+	tsc_diff = spdk_get_ticks() - bio->submit_tsc;
+	if (spdk_unlikely(nvme_qpair->ewma_latency_ticks == 0)) {
+		/* Seed the average with the first sample. */
+		nvme_qpair->ewma_latency_ticks = spdk_max(tsc_diff, 1);
+		return;
+	}
+
+	delta = (int64_t)(tsc_diff - nvme_qpair->ewma_latency_ticks);
+	nvme_qpair->ewma_latency_ticks += delta / (1 << NVME_QPAIR_LATENCY_EWMA_SHIFT);
+	if (nvme_qpair->ewma_latency_ticks == 0) {
+		nvme_qpair->ewma_latency_ticks = 1;
+	}
+}
+
 static inline void
 bdev_nvme_io_complete_nvme_status(struct nvme_bdev_io *bio,
 				  const struct spdk_nvme_cpl *cpl)
@@ -1560,6 +1850,7 @@ bdev_nvme_io_complete_nvme_status(struct nvme_bdev_io *bio,
 
 	if (spdk_likely(spdk_nvme_cpl_is_success(cpl))) {
 		bdev_nvme_update_io_path_stat(bio);
+		bdev_nvme_update_io_path_latency(bio);
 		goto complete;
 	}
 
@@ -1607,6 +1898,14 @@ bdev_nvme_io_complete(struct nvme_bdev_io *bio, int rc)
 		io_status = SPDK_BDEV_IO_STATUS_SUCCESS;
 		break;
 	case -ENOMEM:
+		if (spdk_unlikely(bio->zone_write_plugged)) {
+			/* The bdev layer would resubmit the write after the ones waiting for
+			 * its zone. Retry it here instead to keep them in order.
+			 */
+			nbdev_ch = spdk_io_channel_get_ctx(spdk_bdev_io_get_io_channel(bdev_io));
+			bdev_nvme_queue_retry_io(nbdev_ch, bio, 1ULL);
+			return;
+		}
 		io_status = SPDK_BDEV_IO_STATUS_NOMEM;
 		break;
 	case -ENXIO:
@@ -1745,7 +2044,6 @@ bdev_nvme_disconnected_qpair_cb(struct spdk_nvme_qpair *qpair, void *poll_group_
 	struct nvme_qpair *nvme_qpair;
 	struct nvme_ctrlr *nvme_ctrlr;
 	struct nvme_ctrlr_channel *ctrlr_ch;
-	int status;
 
 	nvme_qpair = nvme_poll_group_get_qpair(group, qpair);
 	if (nvme_qpair == NULL) {
@@ -1763,24 +2061,33 @@ bdev_nvme_disconnected_qpair_cb(struct spdk_nvme_qpair *qpair, void *poll_group_
 	ctrlr_ch = nvme_qpair->ctrlr_ch;
 
 	if (ctrlr_ch != NULL) {
-		if (ctrlr_ch->reset_iter != NULL) {
-			/* We are in a full reset sequence. */
-			if (ctrlr_ch->connect_poller != NULL) {
-				/* qpair was failed to connect. Abort the reset sequence. */
-				NVME_CTRLR_INFOLOG(nvme_ctrlr,
-						   "qpair %p was failed to connect. abort the reset ctrlr sequence.\n",
-						   qpair);
-				spdk_poller_unregister(&ctrlr_ch->connect_poller);
-				status = -1;
-			} else {
-				/* qpair was completed to disconnect. Just move to the next ctrlr_channel. */
-				NVME_CTRLR_INFOLOG(nvme_ctrlr,
-						   "qpair %p was disconnected and freed in a reset ctrlr sequence.\n",
-						   qpair);
-				status = 0;
+		if (ctrlr_ch->connect_poller != NULL) {
+			/* We are in a full reset sequence and qpair was failed to connect.
+			 * Abort the reset sequence. If the sequence doesn't wait for this
+			 * ctrlr_channel yet, it will find the qpair missing when it does.
+			 */
+			NVME_CTRLR_INFOLOG(nvme_ctrlr,
+					   "qpair %p was failed to connect. abort the reset ctrlr sequence.\n",
+					   qpair);
+			spdk_poller_unregister(&ctrlr_ch->connect_poller);
+			if (ctrlr_ch->reset_iter != NULL) {
+				nvme_ctrlr_for_each_channel_continue(ctrlr_ch->reset_iter, -1);
+				ctrlr_ch->reset_iter = NULL;
 			}
-			nvme_ctrlr_for_each_channel_continue(ctrlr_ch->reset_iter, status);
+		} else if (ctrlr_ch->reset_iter != NULL) {
+			/* qpair was completed to disconnect in a full reset sequence.
+			 * Just move to the next ctrlr_channel.
+			 */
+			NVME_CTRLR_INFOLOG(nvme_ctrlr,
+					   "qpair %p was disconnected and freed in a reset ctrlr sequence.\n",
+					   qpair);
+			nvme_ctrlr_for_each_channel_continue(ctrlr_ch->reset_iter, 0);
 			ctrlr_ch->reset_iter = NULL;
+		} else if (nvme_qpair->idle) {
+			/* qpair was disconnected because it was idle. It is connected again by
+			 * the next I/O submitted on this ctrlr_channel.
+			 */
+			NVME_CTRLR_INFOLOG(nvme_ctrlr, "idle qpair %p was disconnected and freed.\n", qpair);
 		} else {
 			/* qpair was disconnected unexpectedly. Reset controller for recovery. */
 			NVME_CTRLR_INFOLOG(nvme_ctrlr, "qpair %p was disconnected and freed. reset controller.\n",
@@ -1958,6 +2265,10 @@ bdev_nvme_create_qpair(struct nvme_qpair *nvme_qpair)
 	}
 	opts.io_queue_requests = spdk_max(g_opts.io_queue_requests, opts.io_queue_requests);
 	g_opts.io_queue_requests = opts.io_queue_requests;
+	/* Keep enough child requests to split a full queue of I/O without taking requests
+	 * away from new I/O.
+	 */
+	opts.io_queue_child_requests = opts.io_queue_size;
 
 	qpair = spdk_nvme_ctrlr_alloc_io_qpair(nvme_ctrlr->ctrlr, &opts, sizeof(opts));
 	if (qpair == NULL) {
@@ -2342,6 +2653,9 @@ bdev_nvme_reset_destroy_qpair(struct nvme_ctrlr_channel_iter *i,
 
 	_bdev_nvme_clear_io_path_cache(nvme_qpair);
 
+	/* qpair may still be connecting if recreating qpairs failed on another ctrlr_channel. */
+	spdk_poller_unregister(&ctrlr_ch->connect_poller);
+
 	qpair = nvme_qpair->qpair;
 	if (qpair != NULL) {
 		NVME_CTRLR_INFOLOG(nvme_ctrlr, "Start disconnecting qpair %p:%u.\n",
@@ -2387,16 +2701,6 @@ bdev_nvme_reset_check_qpair_connected(void *ctx)
 	struct nvme_qpair *nvme_qpair = ctrlr_ch->qpair;
 	struct spdk_nvme_qpair *qpair;
 
-	if (ctrlr_ch->reset_iter == NULL) {
-		/* qpair was already failed to connect and the reset sequence is being aborted. */
-		assert(ctrlr_ch->connect_poller == NULL);
-		assert(nvme_qpair->qpair == NULL);
-
-		NVME_CTRLR_INFOLOG(nvme_qpair->ctrlr,
-				   "qpair was already failed to connect. reset is being aborted.\n");
-		return SPDK_POLLER_BUSY;
-	}
-
 	qpair = nvme_qpair->qpair;
 	assert(qpair != NULL);
 
@@ -2409,9 +2713,18 @@ bdev_nvme_reset_check_qpair_connected(void *ctx)
 
 	spdk_poller_unregister(&ctrlr_ch->connect_poller);
 
-	/* qpair was completed to connect. Move to the next ctrlr_channel */
-	nvme_ctrlr_for_each_channel_continue(ctrlr_ch->reset_iter, 0);
-	ctrlr_ch->reset_iter = NULL;
+	pthread_mutex_lock(&nvme_qpair->ctrlr->mutex);
+	assert(nvme_qpair->ctrlr->connecting_qpairs > 0);
+	nvme_qpair->ctrlr->connecting_qpairs--;
+	pthread_mutex_unlock(&nvme_qpair->ctrlr->mutex);
+
+	/* qpair was completed to connect. If the reset sequence waits for this
+	 * ctrlr_channel, move to the next one.
+	 */
+	if (ctrlr_ch->reset_iter != NULL) {
+		nvme_ctrlr_for_each_channel_continue(ctrlr_ch->reset_iter, 0);
+		ctrlr_ch->reset_iter = NULL;
+	}
 
 	if (!g_opts.disable_auto_failback) {
 		_bdev_nvme_clear_io_path_cache(nvme_qpair);
@@ -2420,6 +2733,12 @@ bdev_nvme_reset_check_qpair_connected(void *ctx)
 	return SPDK_POLLER_BUSY;
 }
 
+/*
+ * Recreating qpairs after a reset is done in two passes over the ctrlr_channels.
+ * The first one starts connecting the qpairs of all ctrlr_channels without waiting,
+ * so that the qpairs are connected in parallel. The second one waits for each qpair
+ * to be connected, and is skipped if all of them were already seen connected.
+ */
 static void
 bdev_nvme_reset_create_qpair(struct nvme_ctrlr_channel_iter *i,
 			     struct nvme_ctrlr *nvme_ctrlr,
@@ -2430,10 +2749,21 @@ bdev_nvme_reset_create_qpair(struct nvme_ctrlr_channel_iter *i,
 	struct spdk_nvme_qpair *qpair;
 	int rc = 0;
 
+	if (nvme_qpair->idle) {
+		/* Leave it to the next I/O to connect the qpair. */
+		nvme_ctrlr_for_each_channel_continue(i, 0);
+		return;
+	}
+
 	if (nvme_qpair->qpair == NULL) {
 		rc = bdev_nvme_create_qpair(nvme_qpair);
 	}
 	if (rc == 0) {
+		pthread_mutex_lock(&nvme_ctrlr->mutex);
+		nvme_ctrlr->connecting_qpairs++;
+		pthread_mutex_unlock(&nvme_ctrlr->mutex);
+
+		assert(ctrlr_ch->connect_poller == NULL);
 		ctrlr_ch->connect_poller = SPDK_POLLER_REGISTER(bdev_nvme_reset_check_qpair_connected,
 					   ctrlr_ch, 0);
 
@@ -2441,15 +2771,49 @@ bdev_nvme_reset_create_qpair(struct nvme_ctrlr_channel_iter *i,
 
 		NVME_CTRLR_INFOLOG(nvme_ctrlr, "Start checking qpair %p:%u to be connected.\n",
 				   qpair, spdk_nvme_qpair_get_id(qpair));
+	}
 
-		/* The current full reset sequence will move to the next
-		 * ctrlr_channel after the qpair is actually connected.
-		 */
-		assert(ctrlr_ch->reset_iter == NULL);
-		ctrlr_ch->reset_iter = i;
-	} else {
-		nvme_ctrlr_for_each_channel_continue(i, rc);
+	nvme_ctrlr_for_each_channel_continue(i, rc);
+}
+
+static void
+bdev_nvme_reset_wait_qpair_connected(struct nvme_ctrlr_channel_iter *i,
+				     struct nvme_ctrlr *nvme_ctrlr,
+				     struct nvme_ctrlr_channel *ctrlr_ch,
+				     void *ctx)
+{
+	if (ctrlr_ch->connect_poller == NULL) {
+		/* qpair was already connected, failed to connect, or is idle. */
+		nvme_ctrlr_for_each_channel_continue(i, ctrlr_ch->qpair->qpair != NULL ||
+						     ctrlr_ch->qpair->idle ? 0 : -1);
+		return;
 	}
+
+	/* The current full reset sequence will move to the next
+	 * ctrlr_channel after the qpair is actually connected.
+	 */
+	assert(ctrlr_ch->reset_iter == NULL);
+	ctrlr_ch->reset_iter = i;
+}
+
+static void
+bdev_nvme_reset_create_qpairs_started(struct nvme_ctrlr *nvme_ctrlr, void *ctx, int status)
+{
+	uint32_t connecting_qpairs;
+
+	pthread_mutex_lock(&nvme_ctrlr->mutex);
+	connecting_qpairs = nvme_ctrlr->connecting_qpairs;
+	pthread_mutex_unlock(&nvme_ctrlr->mutex);
+
+	if (status != 0 || connecting_qpairs == 0) {
+		bdev_nvme_reset_create_qpairs_done(nvme_ctrlr, ctx, status);
+		return;
+	}
+
+	nvme_ctrlr_for_each_channel(nvme_ctrlr,
+				    bdev_nvme_reset_wait_qpair_connected,
+				    NULL,
+				    bdev_nvme_reset_create_qpairs_done);
 }
 
 static void
@@ -2502,12 +2866,17 @@ bdev_nvme_reconnect_ctrlr_poll(void *arg)
 		}
 
 		nvme_ctrlr_check_namespaces(nvme_ctrlr);
+		nvme_ctrlr_set_interrupt_coalescing(nvme_ctrlr);
 
 		/* Recreate all of the I/O queue pairs */
+		pthread_mutex_lock(&nvme_ctrlr->mutex);
+		nvme_ctrlr->connecting_qpairs = 0;
+		pthread_mutex_unlock(&nvme_ctrlr->mutex);
+
 		nvme_ctrlr_for_each_channel(nvme_ctrlr,
 					    bdev_nvme_reset_create_qpair,
 					    NULL,
-					    bdev_nvme_reset_create_qpairs_done);
+					    bdev_nvme_reset_create_qpairs_started);
 	} else {
 		NVME_CTRLR_INFOLOG(nvme_ctrlr, "ctrlr could not be connected.\n");
 
@@ -3419,6 +3788,39 @@ _bdev_nvme_submit_request(struct nvme_bdev_channel *nbdev_ch, struct spdk_bdev_i
 	}
 }
 
+/* Start connecting the idle qpairs of the nbdev_ch. Return true if it has any. */
+static bool
+bdev_nvme_wake_idle_qpairs(struct nvme_bdev_channel *nbdev_ch)
+{
+	struct nvme_io_path *io_path;
+	struct nvme_qpair *nvme_qpair;
+	bool found = false;
+
+	STAILQ_FOREACH(io_path, &nbdev_ch->io_path_list, stailq) {
+		nvme_qpair = io_path->qpair;
+		if (spdk_likely(!nvme_qpair->idle)) {
+			continue;
+		}
+
+		found = true;
+
+		/* The qpair may still be disconnecting, and the reset sequence
+		 * recreates the qpairs itself once the ctrlr is enabled.
+		 */
+		if (nvme_qpair->qpair != NULL || nvme_qpair->ctrlr->resetting ||
+		    nvme_qpair->ctrlr->disabled) {
+			continue;
+		}
+
+		if (bdev_nvme_create_qpair(nvme_qpair) == 0) {
+			nvme_qpair->idle = false;
+			_bdev_nvme_clear_io_path_cache(nvme_qpair);
+		}
+	}
+
+	return found;
+}
+
 static void
 bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
 {
@@ -3434,12 +3836,31 @@ bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 		nbdev_io->submit_tsc = spdk_get_ticks();
 	}
 
-	spdk_trace_record(TRACE_BDEV_NVME_IO_START, 0, 0, (uintptr_t)nbdev_io, (uintptr_t)bdev_io);
+	if (spdk_bdev_io_trace_sampled(bdev_io)) {
+		spdk_trace_record(TRACE_BDEV_NVME_IO_START, 0, 0, (uintptr_t)nbdev_io, (uintptr_t)bdev_io);
+	}
+
+	if (spdk_unlikely(bdev_io->bdev->zoned) && bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE &&
+	    !nbdev_io->zone_write_plugged) {
+		if (bdev_nvme_zone_write_plug(nbdev_ch, nbdev_io)) {
+			return;
+		}
+	}
+
 	nbdev_io->io_path = bdev_nvme_find_io_path(nbdev_ch);
 	if (spdk_unlikely(!nbdev_io->io_path)) {
 		if (!bdev_nvme_io_type_is_admin(bdev_io->type)) {
-			bdev_nvme_io_complete(nbdev_io, -ENXIO);
-			return;
+			if (bdev_nvme_wake_idle_qpairs(nbdev_ch)) {
+				nbdev_io->io_path = bdev_nvme_find_io_path(nbdev_ch);
+				if (nbdev_io->io_path == NULL) {
+					/* Wait for the idle qpair to be disconnected first. */
+					bdev_nvme_queue_retry_io(nbdev_ch, nbdev_io, 1ULL);
+					return;
+				}
+			} else {
+				bdev_nvme_io_complete(nbdev_io, -ENXIO);
+				return;
+			}
 		}
 
 		/* Admin commands do not use the optimal I/O path.
@@ -3447,6 +3868,10 @@ bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 		 */
 	}
 
+	if (nbdev_io->io_path != NULL) {
+		nbdev_io->io_path->qpair->submitted = true;
+	}
+
 	_bdev_nvme_submit_request(nbdev_ch, bdev_io);
 }
 
@@ -3543,6 +3968,31 @@ bdev_nvme_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 	}
 }
 
+static int
+bdev_nvme_idle_qpair_poll(void *arg)
+{
+	struct nvme_qpair *nvme_qpair = arg;
+
+	if (nvme_qpair->submitted) {
+		nvme_qpair->submitted = false;
+		return SPDK_POLLER_IDLE;
+	}
+
+	if (nvme_qpair->idle || !nvme_qpair_is_connected(nvme_qpair) ||
+	    spdk_nvme_qpair_get_num_outstanding_reqs(nvme_qpair->qpair) != 0) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	NVME_CTRLR_INFOLOG(nvme_qpair->ctrlr, "Disconnecting idle qpair %p:%u.\n",
+			   nvme_qpair->qpair, spdk_nvme_qpair_get_id(nvme_qpair->qpair));
+
+	nvme_qpair->idle = true;
+	_bdev_nvme_clear_io_path_cache(nvme_qpair);
+	spdk_nvme_ctrlr_disconnect_io_qpair(nvme_qpair->qpair);
+
+	return SPDK_POLLER_BUSY;
+}
+
 static int
 nvme_qpair_create(struct nvme_ctrlr *nvme_ctrlr, struct nvme_ctrlr_channel *ctrlr_ch)
 {
@@ -3575,7 +4025,12 @@ nvme_qpair_create(struct nvme_ctrlr *nvme_ctrlr, struct nvme_ctrlr_channel *ctrl
 	nvme_qpair->group->collect_spin_stat = false;
 #endif
 
-	if (!nvme_ctrlr->disabled) {
+	if (g_opts.io_qpair_idle_timeout_ms != 0) {
+		/* The qpair is created by the first I/O submitted on this thread. */
+		nvme_qpair->idle = true;
+		nvme_qpair->idle_poller = SPDK_POLLER_REGISTER(bdev_nvme_idle_qpair_poll, nvme_qpair,
+					  g_opts.io_qpair_idle_timeout_ms * 1000ULL);
+	} else if (!nvme_ctrlr->disabled) {
 		/* If a nvme_ctrlr is disabled, don't try to create qpair for it. Qpair will
 		 * be created when it's enabled.
 		 */
@@ -3646,6 +4101,9 @@ bdev_nvme_destroy_ctrlr_channel_cb(void *io_device, void *ctx_buf)
 
 	_bdev_nvme_clear_io_path_cache(nvme_qpair);
 
+	spdk_poller_unregister(&ctrlr_ch->connect_poller);
+	spdk_poller_unregister(&nvme_qpair->idle_poller);
+
 	if (nvme_qpair->qpair != NULL) {
 		/* Always try to disconnect the qpair, even if a reset is in progress.
 		 * The qpair may have been created after the reset process started.
@@ -3796,6 +4254,13 @@ bdev_nvme_create_poll_group_cb(void *io_device, void *ctx_buf)
 			return -1;
 		}
 
+		rc = spdk_nvme_poll_group_set_adaptive_polling(group->group,
+				g_opts.intr_adaptive_idle_polls);
+		if (rc != 0) {
+			spdk_nvme_poll_group_destroy(group->group);
+			return -1;
+		}
+
 		group->intr = spdk_interrupt_register_fd_group(fgrp, "bdev_nvme_interrupt");
 		if (!group->intr) {
 			spdk_nvme_poll_group_destroy(group->group);
@@ -4121,6 +4586,8 @@ nvme_bdev_get_mp_selector_str(struct nvme_bdev *nbdev)
 		return "round_robin";
 	case BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH:
 		return "queue_depth";
+	case BDEV_NVME_MP_SELECTOR_LATENCY:
+		return "latency";
 	default:
 		assert(false);
 		return "invalid";
@@ -4534,6 +5001,12 @@ nbdev_create(struct spdk_bdev *disk, const char *base_name,
 		}
 	}
 	disk->optimal_io_boundary = spdk_nvme_ns_get_optimal_io_boundary(ns);
+	if (g_opts.multipath_stripe_size != 0) {
+		/* A single large I/O goes to a single io path. Let the bdev layer split it,
+		 * so that the children are spread over the io paths like any other I/O.
+		 */
+		disk->max_rw_size = spdk_max(g_opts.multipath_stripe_size / disk->blocklen, 1);
+	}
 
 	nsdata = spdk_nvme_ns_get_data(ns);
 	bs = spdk_nvme_ns_get_sector_size(ns);
@@ -5529,6 +6002,7 @@ spdk_bdev_nvme_set_multipath_policy(const char *name, enum spdk_bdev_nvme_multip
 			}
 			break;
 		case BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH:
+		case BDEV_NVME_MP_SELECTOR_LATENCY:
 			break;
 		default:
 			rc = -EINVAL;
@@ -5653,6 +6127,44 @@ bdev_nvme_remove_poller(void *ctx)
 	return SPDK_POLLER_BUSY;
 }
 
+static void
+nvme_ctrlr_set_interrupt_coalescing_done(void *ctx, const struct spdk_nvme_cpl *cpl)
+{
+	if (spdk_nvme_cpl_is_error(cpl)) {
+		SPDK_WARNLOG("Failed to set interrupt coalescing, sc %#x, sct %#x\n",
+			     cpl->status.sc, cpl->status.sct);
+	}
+}
+
+/* Interrupt coalescing settings do not persist across a controller reset, so this is
+ * called both when the controller is created and when it is reconnected.
+ */
+static void
+nvme_ctrlr_set_interrupt_coalescing(struct nvme_ctrlr *nvme_ctrlr)
+{
+	union spdk_nvme_feat_interrupt_coalescing coalescing = {};
+	int rc;
+
+	if (!spdk_interrupt_mode_is_enabled() ||
+	    nvme_ctrlr->active_path_id->trid.trtype != SPDK_NVME_TRANSPORT_PCIE ||
+	    (g_opts.intr_coalescing_threshold == 0 && g_opts.intr_coalescing_time_us == 0)) {
+		return;
+	}
+
+	/* The aggregation threshold is 0's based and the aggregation time is in 100 microseconds. */
+	if (g_opts.intr_coalescing_threshold != 0) {
+		coalescing.bits.thr = g_opts.intr_coalescing_threshold - 1;
+	}
+	coalescing.bits.time = SPDK_CEIL_DIV(g_opts.intr_coalescing_time_us, 100);
+
+	rc = spdk_nvme_ctrlr_cmd_set_feature(nvme_ctrlr->ctrlr, SPDK_NVME_FEAT_INTERRUPT_COALESCING,
+					     coalescing.raw, 0, NULL, 0,
+					     nvme_ctrlr_set_interrupt_coalescing_done, NULL);
+	if (rc != 0) {
+		NVME_CTRLR_WARNLOG(nvme_ctrlr, "Failed to set interrupt coalescing: %s\n", spdk_strerror(-rc));
+	}
+}
+
 static void
 nvme_ctrlr_create_done(struct nvme_ctrlr *nvme_ctrlr,
 		       struct nvme_async_probe_ctx *ctx)
@@ -5672,6 +6184,8 @@ nvme_ctrlr_create_done(struct nvme_ctrlr *nvme_ctrlr,
 				sizeof(struct nvme_ctrlr_channel),
 				nvme_ctrlr->nbdev_ctrlr->name);
 
+	nvme_ctrlr_set_interrupt_coalescing(nvme_ctrlr);
+
 	nvme_ctrlr_populate_namespaces(nvme_ctrlr, ctx);
 
 	if (g_hotplug_poller == NULL) {
@@ -6185,12 +6699,22 @@ spdk_bdev_nvme_get_opts(struct spdk_bdev_nvme_opts *opts, size_t opts_size)
 	SET_FIELD(dhchap_digests, 0);
 	SET_FIELD(dhchap_dhgroups, 0);
 	SET_FIELD(rdma_umr_per_io, false);
+	SET_FIELD(numa_affinity_qd_threshold, 0);
+	SET_FIELD(intr_adaptive_idle_polls, 0);
+	SET_FIELD(intr_coalescing_threshold, 0);
+	SET_FIELD(intr_coalescing_time_us, 0);
+	SET_FIELD(tcp_recv_buf_count, 0);
+	SET_FIELD(tcp_recv_buf_size, 0);
+	SET_FIELD(tcp_zcopy_threshold, 0);
+	SET_FIELD(rdma_inline_copy_size, 0);
+	SET_FIELD(io_qpair_idle_timeout_ms, 0);
+	SET_FIELD(multipath_stripe_size, 0);
 
 #undef SET_FIELD
 
 	/* Do not remove this statement, you should always update this statement when you adding a new field,
 	 * and do not forget to add the SET_FIELD statement for your added field. */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_nvme_opts) == 128, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_nvme_opts) == 160, "Incorrect size");
 }
 
 static bool bdev_nvme_check_io_error_resiliency_params(int32_t ctrlr_loss_timeout_sec,
@@ -6217,6 +6741,16 @@ bdev_nvme_validate_opts(const struct spdk_bdev_nvme_opts *opts)
 		return -EINVAL;
 	}
 
+	if (SPDK_GET_FIELD(opts, intr_coalescing_threshold, 0, opts->opts_size) > 256) {
+		SPDK_WARNLOG("Invalid option: intr_coalescing_threshold can't be more than 256.\n");
+		return -EINVAL;
+	}
+
+	if (SPDK_GET_FIELD(opts, intr_coalescing_time_us, 0, opts->opts_size) > 25500) {
+		SPDK_WARNLOG("Invalid option: intr_coalescing_time_us can't be more than 25500.\n");
+		return -EINVAL;
+	}
+
 	return 0;
 }
 
@@ -6261,6 +6795,18 @@ spdk_bdev_nvme_set_opts(const struct spdk_bdev_nvme_opts *opts)
 	if (drv_opts.rdma_umr_per_io != opts->rdma_umr_per_io) {
 		drv_opts.rdma_umr_per_io = opts->rdma_umr_per_io;
 	}
+	if (SPDK_GET_FIELD(opts, tcp_recv_buf_count, 0, opts->opts_size) != 0) {
+		drv_opts.tcp_recv_buf_count = opts->tcp_recv_buf_count;
+	}
+	if (SPDK_GET_FIELD(opts, tcp_recv_buf_size, 0, opts->opts_size) != 0) {
+		drv_opts.tcp_recv_buf_size = opts->tcp_recv_buf_size;
+	}
+	if (SPDK_GET_FIELD(opts, tcp_zcopy_threshold, 0, opts->opts_size) != 0) {
+		drv_opts.tcp_zcopy_threshold = opts->tcp_zcopy_threshold;
+	}
+	if (SPDK_GET_FIELD(opts, rdma_inline_copy_size, 0, opts->opts_size) != 0) {
+		drv_opts.rdma_inline_copy_size = opts->rdma_inline_copy_size;
+	}
 	ret = spdk_nvme_transport_set_opts(&drv_opts, sizeof(drv_opts));
 	if (ret) {
 		SPDK_ERRLOG("Failed to set NVMe transport opts.\n");
@@ -6299,6 +6845,16 @@ spdk_bdev_nvme_set_opts(const struct spdk_bdev_nvme_opts *opts)
 	SET_FIELD(rdma_cm_event_timeout_ms, 0);
 	SET_FIELD(dhchap_digests, 0);
 	SET_FIELD(dhchap_dhgroups, 0);
+	SET_FIELD(numa_affinity_qd_threshold, 0);
+	SET_FIELD(intr_adaptive_idle_polls, 0);
+	SET_FIELD(intr_coalescing_threshold, 0);
+	SET_FIELD(intr_coalescing_time_us, 0);
+	SET_FIELD(tcp_recv_buf_count, 0);
+	SET_FIELD(tcp_recv_buf_size, 0);
+	SET_FIELD(tcp_zcopy_threshold, 0);
+	SET_FIELD(rdma_inline_copy_size, 0);
+	SET_FIELD(io_qpair_idle_timeout_ms, 0);
+	SET_FIELD(multipath_stripe_size, 0);
 
 	g_opts.opts_size = opts->opts_size;
 
@@ -8371,7 +8927,8 @@ bdev_nvme_writev(struct nvme_bdev_io *bio, struct iovec *iov, int iovcnt,
 	bio->iovpos = 0;
 	bio->iov_offset = 0;
 
-	if (domain != NULL || seq != NULL) {
+	/* Only the extended API passes the directive, e.g. an FDP placement handle. */
+	if (domain != NULL || seq != NULL || cdw12.write.dtype != 0) {
 		bio->ext_opts.size = SPDK_SIZEOF(&bio->ext_opts, accel_sequence);
 		bio->ext_opts.memory_domain = domain;
 		bio->ext_opts.memory_domain_ctx = domain_ctx;
@@ -8793,6 +9350,12 @@ bdev_nvme_abort(struct nvme_bdev_channel *nbdev_ch, struct nvme_bdev_io *bio,
 		return;
 	}
 
+	rc = bdev_nvme_abort_zone_write(nbdev_ch, bio_to_abort);
+	if (rc == 0) {
+		bdev_nvme_admin_complete(bio, 0);
+		return;
+	}
+
 	io_path = bio_to_abort->io_path;
 	if (io_path != NULL) {
 		rc = spdk_nvme_ctrlr_cmd_abort_ext(io_path->qpair->ctrlr->ctrlr,
@@ -8897,6 +9460,16 @@ bdev_nvme_opts_config_json(struct spdk_json_write_ctx *w)
 
 	spdk_json_write_array_end(w);
 	spdk_json_write_named_bool(w, "rdma_umr_per_io", g_opts.rdma_umr_per_io);
+	spdk_json_write_named_uint32(w, "numa_affinity_qd_threshold", g_opts.numa_affinity_qd_threshold);
+	spdk_json_write_named_uint32(w, "intr_adaptive_idle_polls", g_opts.intr_adaptive_idle_polls);
+	spdk_json_write_named_uint32(w, "intr_coalescing_threshold", g_opts.intr_coalescing_threshold);
+	spdk_json_write_named_uint32(w, "intr_coalescing_time_us", g_opts.intr_coalescing_time_us);
+	spdk_json_write_named_uint32(w, "tcp_recv_buf_count", g_opts.tcp_recv_buf_count);
+	spdk_json_write_named_uint32(w, "tcp_recv_buf_size", g_opts.tcp_recv_buf_size);
+	spdk_json_write_named_uint32(w, "tcp_zcopy_threshold", g_opts.tcp_zcopy_threshold);
+	spdk_json_write_named_uint32(w, "rdma_inline_copy_size", g_opts.rdma_inline_copy_size);
+	spdk_json_write_named_uint32(w, "io_qpair_idle_timeout_ms", g_opts.io_qpair_idle_timeout_ms);
+	spdk_json_write_named_uint32(w, "multipath_stripe_size", g_opts.multipath_stripe_size);
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_object_end(w);
@@ -8957,7 +9530,8 @@ nvme_ctrlr_cuse_config_json(struct spdk_json_write_ctx *w,
 static void
 nvme_ctrlr_config_json(struct spdk_json_write_ctx *w,
 		       struct nvme_ctrlr *nvme_ctrlr,
-		       struct nvme_path_id *path_id)
+		       struct nvme_path_id *path_id,
+		       bool wait_for_attach)
 {
 	struct spdk_nvme_transport_id	*trid;
 	const struct spdk_nvme_ctrlr_opts *opts;
@@ -9012,6 +9586,9 @@ nvme_ctrlr_config_json(struct spdk_json_write_ctx *w,
 	if (nvme_ctrlr->opts.multipath) {
 		spdk_json_write_named_string(w, "multipath", "multipath");
 	}
+	if (!wait_for_attach) {
+		spdk_json_write_named_bool(w, "wait_for_attach", false);
+	}
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_object_end(w);
@@ -9038,20 +9615,41 @@ bdev_nvme_config_json(struct spdk_json_write_ctx *w)
 	struct nvme_ctrlr	*nvme_ctrlr;
 	struct discovery_ctx	*ctx;
 	struct nvme_path_id	*path_id;
+	bool			attach_pending = false;
 
 	bdev_nvme_opts_config_json(w);
 
 	pthread_mutex_lock(&g_bdev_nvme_mutex);
 
+	/* Attach the first path of each controller without waiting, so that all of them are
+	 * initialized in parallel, and wait for them before adding the other paths, which
+	 * need the first one to be attached.
+	 */
+	TAILQ_FOREACH(nbdev_ctrlr, &g_nvme_bdev_ctrlrs, tailq) {
+		nvme_ctrlr = TAILQ_FIRST(&nbdev_ctrlr->ctrlrs);
+		if (nvme_ctrlr != NULL && !nvme_ctrlr->opts.from_discovery_service) {
+			nvme_ctrlr_config_json(w, nvme_ctrlr, nvme_ctrlr->active_path_id, false);
+			attach_pending = true;
+		}
+	}
+
+	if (attach_pending) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_nvme_wait_for_attach");
+		spdk_json_write_object_end(w);
+	}
+
 	TAILQ_FOREACH(nbdev_ctrlr, &g_nvme_bdev_ctrlrs, tailq) {
 		TAILQ_FOREACH(nvme_ctrlr, &nbdev_ctrlr->ctrlrs, tailq) {
 			path_id = nvme_ctrlr->active_path_id;
 			assert(path_id == TAILQ_FIRST(&nvme_ctrlr->trids));
-			nvme_ctrlr_config_json(w, nvme_ctrlr, path_id);
+			if (nvme_ctrlr != TAILQ_FIRST(&nbdev_ctrlr->ctrlrs)) {
+				nvme_ctrlr_config_json(w, nvme_ctrlr, path_id, true);
+			}
 
 			path_id = TAILQ_NEXT(path_id, link);
 			while (path_id != NULL) {
-				nvme_ctrlr_config_json(w, nvme_ctrlr, path_id);
+				nvme_ctrlr_config_json(w, nvme_ctrlr, path_id, true);
 				path_id = TAILQ_NEXT(path_id, link);
 			}
 
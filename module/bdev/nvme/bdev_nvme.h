@@ -124,6 +124,8 @@ struct nvme_ctrlr {
 
 	uint64_t				reset_start_tsc;
 	struct spdk_poller			*reconnect_delay_timer;
+	/* Number of qpairs recreated after a reset that weren't seen connected yet */
+	uint32_t				connecting_qpairs;
 
 	nvme_ctrlr_disconnected_cb		disconnected_cb;
 
@@ -183,6 +185,16 @@ struct nvme_qpair {
 	/* The following is used to update io_path cache of nvme_bdev_channels. */
 	TAILQ_HEAD(, nvme_io_path)	io_path_list;
 
+	/* Moving average of the completion latency, used by the latency selector. */
+	uint64_t			ewma_latency_ticks;
+
+	/* Used if io_qpair_idle_timeout_ms is set. The qpair is disconnected, or being
+	 * disconnected, because no I/O was submitted on it for that long.
+	 */
+	bool				idle;
+	bool				submitted;
+	struct spdk_poller		*idle_poller;
+
 	TAILQ_ENTRY(nvme_qpair)		tailq;
 };
 
@@ -204,6 +216,9 @@ struct nvme_io_path {
 
 	/* allocation of stat is decided by option io_path_stat of RPC bdev_nvme_set_options */
 	struct spdk_bdev_io_stat	*stat;
+
+	/* The controller is on the NUMA node of the core which created the nvme_bdev_channel. */
+	bool				numa_local;
 };
 
 struct nvme_bdev_channel {
@@ -215,6 +230,7 @@ struct nvme_bdev_channel {
 	STAILQ_HEAD(, nvme_io_path)		io_path_list;
 	TAILQ_HEAD(retry_io_head, nvme_bdev_io)	retry_io_list;
 	struct spdk_poller			*retry_io_poller;
+	TAILQ_HEAD(, nvme_bdev_io)		zone_write_list;
 	bool					resetting;
 };
 
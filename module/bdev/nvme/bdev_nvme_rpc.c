@@ -139,6 +139,16 @@ static const struct spdk_json_object_decoder rpc_bdev_nvme_options_decoders[] =
 	{"dhchap_digests", offsetof(struct spdk_bdev_nvme_opts, dhchap_digests), rpc_decode_digest_array, true},
 	{"dhchap_dhgroups", offsetof(struct spdk_bdev_nvme_opts, dhchap_dhgroups), rpc_decode_dhgroup_array, true},
 	{"rdma_umr_per_io", offsetof(struct spdk_bdev_nvme_opts, rdma_umr_per_io), spdk_json_decode_bool, true},
+	{"numa_affinity_qd_threshold", offsetof(struct spdk_bdev_nvme_opts, numa_affinity_qd_threshold), spdk_json_decode_uint32, true},
+	{"intr_adaptive_idle_polls", offsetof(struct spdk_bdev_nvme_opts, intr_adaptive_idle_polls), spdk_json_decode_uint32, true},
+	{"intr_coalescing_threshold", offsetof(struct spdk_bdev_nvme_opts, intr_coalescing_threshold), spdk_json_decode_uint16, true},
+	{"intr_coalescing_time_us", offsetof(struct spdk_bdev_nvme_opts, intr_coalescing_time_us), spdk_json_decode_uint16, true},
+	{"tcp_recv_buf_count", offsetof(struct spdk_bdev_nvme_opts, tcp_recv_buf_count), spdk_json_decode_uint32, true},
+	{"tcp_recv_buf_size", offsetof(struct spdk_bdev_nvme_opts, tcp_recv_buf_size), spdk_json_decode_uint32, true},
+	{"tcp_zcopy_threshold", offsetof(struct spdk_bdev_nvme_opts, tcp_zcopy_threshold), spdk_json_decode_uint32, true},
+	{"rdma_inline_copy_size", offsetof(struct spdk_bdev_nvme_opts, rdma_inline_copy_size), spdk_json_decode_uint32, true},
+	{"io_qpair_idle_timeout_ms", offsetof(struct spdk_bdev_nvme_opts, io_qpair_idle_timeout_ms), spdk_json_decode_uint32, true},
+	{"multipath_stripe_size", offsetof(struct spdk_bdev_nvme_opts, multipath_stripe_size), spdk_json_decode_uint32, true},
 };
 
 static void
@@ -241,6 +251,7 @@ struct rpc_bdev_nvme_attach_controller {
 	struct spdk_bdev_nvme_ctrlr_opts bdev_opts;
 	struct spdk_nvme_ctrlr_opts drv_opts;
 	uint32_t max_bdevs;
+	bool wait_for_attach;
 };
 
 static void
@@ -339,6 +350,7 @@ static const struct spdk_json_object_decoder rpc_bdev_nvme_attach_controller_dec
 	{"dhchap_key", offsetof(struct rpc_bdev_nvme_attach_controller, dhchap_key), spdk_json_decode_string, true},
 	{"dhchap_ctrlr_key", offsetof(struct rpc_bdev_nvme_attach_controller, dhchap_ctrlr_key), spdk_json_decode_string, true},
 	{"allow_unrecognized_csi", offsetof(struct rpc_bdev_nvme_attach_controller, bdev_opts.allow_unrecognized_csi), spdk_json_decode_bool, true},
+	{"wait_for_attach", offsetof(struct rpc_bdev_nvme_attach_controller, wait_for_attach), spdk_json_decode_bool, true},
 };
 
 #define DEFAULT_MAX_BDEVS_PER_RPC 128
@@ -348,8 +360,23 @@ struct rpc_bdev_nvme_attach_controller_ctx {
 	size_t bdev_count;
 	const char **names;
 	struct spdk_jsonrpc_request *request;
+	TAILQ_ENTRY(rpc_bdev_nvme_attach_controller_ctx) tailq;
 };
 
+struct rpc_bdev_nvme_wait_for_attach_ctx {
+	struct spdk_jsonrpc_request *request;
+	uint32_t failed;
+	TAILQ_ENTRY(rpc_bdev_nvme_wait_for_attach_ctx) tailq;
+};
+
+/* Controllers attached without waiting, and the bdev_nvme_wait_for_attach requests waiting
+ * for them. All of the RPCs are executed on the same thread, so no locking is needed. */
+static TAILQ_HEAD(, rpc_bdev_nvme_attach_controller_ctx) g_rpc_attach_pending =
+	TAILQ_HEAD_INITIALIZER(g_rpc_attach_pending);
+static TAILQ_HEAD(, rpc_bdev_nvme_wait_for_attach_ctx) g_rpc_attach_waiters =
+	TAILQ_HEAD_INITIALIZER(g_rpc_attach_waiters);
+static uint32_t g_rpc_attach_failed;
+
 static void
 free_rpc_bdev_nvme_attach_controller_ctx(struct rpc_bdev_nvme_attach_controller_ctx *ctx)
 {
@@ -377,12 +404,69 @@ rpc_bdev_nvme_attach_controller_examined(void *cb_ctx)
 	free_rpc_bdev_nvme_attach_controller_ctx(ctx);
 }
 
+static void
+rpc_bdev_nvme_wait_for_attach_examined(void *cb_ctx)
+{
+	struct rpc_bdev_nvme_wait_for_attach_ctx *ctx = cb_ctx;
+
+	if (ctx->failed > 0) {
+		spdk_jsonrpc_send_error_response_fmt(ctx->request, -ENXIO,
+						     "%" PRIu32 " controller(s) failed to attach", ctx->failed);
+	} else {
+		spdk_jsonrpc_send_bool_response(ctx->request, true);
+	}
+
+	free(ctx);
+}
+
+static void
+rpc_bdev_nvme_wait_for_attach_complete(void)
+{
+	struct rpc_bdev_nvme_wait_for_attach_ctx *ctx, *tmp;
+	int rc;
+
+	if (!TAILQ_EMPTY(&g_rpc_attach_pending)) {
+		return;
+	}
+
+	TAILQ_FOREACH_SAFE(ctx, &g_rpc_attach_waiters, tailq, tmp) {
+		TAILQ_REMOVE(&g_rpc_attach_waiters, ctx, tailq);
+		ctx->failed = g_rpc_attach_failed;
+		rc = spdk_bdev_wait_for_examine(rpc_bdev_nvme_wait_for_attach_examined, ctx);
+		if (rc != 0) {
+			spdk_jsonrpc_send_error_response(ctx->request, rc, spdk_strerror(-rc));
+			free(ctx);
+		}
+	}
+
+	g_rpc_attach_failed = 0;
+}
+
+static void
+rpc_bdev_nvme_attach_controller_deferred_done(struct rpc_bdev_nvme_attach_controller_ctx *ctx,
+		int rc)
+{
+	if (rc < 0) {
+		SPDK_ERRLOG("Failed to attach controller %s: %s\n", ctx->req.name, spdk_strerror(-rc));
+		g_rpc_attach_failed++;
+	}
+
+	TAILQ_REMOVE(&g_rpc_attach_pending, ctx, tailq);
+	free_rpc_bdev_nvme_attach_controller_ctx(ctx);
+	rpc_bdev_nvme_wait_for_attach_complete();
+}
+
 static void
 rpc_bdev_nvme_attach_controller_done(void *cb_ctx, size_t bdev_count, int rc)
 {
 	struct rpc_bdev_nvme_attach_controller_ctx *ctx = cb_ctx;
 	struct spdk_jsonrpc_request *request = ctx->request;
 
+	if (!ctx->req.wait_for_attach) {
+		rpc_bdev_nvme_attach_controller_deferred_done(ctx, rc);
+		return;
+	}
+
 	if (rc < 0) {
 		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
 		free_rpc_bdev_nvme_attach_controller_ctx(ctx);
@@ -397,7 +481,7 @@ static void
 rpc_bdev_nvme_attach_controller(struct spdk_jsonrpc_request *request,
 				const struct spdk_json_val *params)
 {
-	struct rpc_bdev_nvme_attach_controller_ctx *ctx;
+	struct rpc_bdev_nvme_attach_controller_ctx *ctx, *pending;
 	struct spdk_nvme_transport_id trid = {};
 	const struct spdk_nvme_ctrlr_opts *drv_opts;
 	const struct spdk_nvme_transport_id *ctrlr_trid;
@@ -415,6 +499,7 @@ rpc_bdev_nvme_attach_controller(struct spdk_jsonrpc_request *request,
 	spdk_bdev_nvme_get_default_ctrlr_opts(&ctx->req.bdev_opts);
 	ctx->req.multipath = BDEV_NVME_MP_MODE_MULTIPATH;
 	ctx->req.max_bdevs = DEFAULT_MAX_BDEVS_PER_RPC;
+	ctx->req.wait_for_attach = true;
 
 	if (spdk_json_decode_object(params, rpc_bdev_nvme_attach_controller_decoders,
 				    SPDK_COUNTOF(rpc_bdev_nvme_attach_controller_decoders),
@@ -539,6 +624,16 @@ rpc_bdev_nvme_attach_controller(struct spdk_jsonrpc_request *request,
 		snprintf(ctx->req.drv_opts.src_svcid, maxlen, "%s", ctx->req.hostsvcid);
 	}
 
+	TAILQ_FOREACH(pending, &g_rpc_attach_pending, tailq) {
+		if (strcmp(pending->req.name, ctx->req.name) == 0) {
+			/* The checks below need the first path to be attached */
+			spdk_jsonrpc_send_error_response_fmt(request, -EBUSY,
+							     "A controller named %s is being attached",
+							     ctx->req.name);
+			goto cleanup;
+		}
+	}
+
 	ctrlr = nvme_ctrlr_get_by_name(ctx->req.name);
 
 	if (ctrlr) {
@@ -614,14 +709,27 @@ rpc_bdev_nvme_attach_controller(struct spdk_jsonrpc_request *request,
 	ctx->req.bdev_opts.psk = ctx->req.psk;
 	ctx->req.bdev_opts.dhchap_key = ctx->req.dhchap_key;
 	ctx->req.bdev_opts.dhchap_ctrlr_key = ctx->req.dhchap_ctrlr_key;
+	if (!ctx->req.wait_for_attach) {
+		ctx->request = NULL;
+		TAILQ_INSERT_TAIL(&g_rpc_attach_pending, ctx, tailq);
+	}
+
 	rc = spdk_bdev_nvme_create(&trid, ctx->req.name, ctx->names, ctx->req.max_bdevs,
 				   rpc_bdev_nvme_attach_controller_done, ctx, &ctx->req.drv_opts,
 				   &ctx->req.bdev_opts);
 	if (rc) {
+		if (!ctx->req.wait_for_attach) {
+			TAILQ_REMOVE(&g_rpc_attach_pending, ctx, tailq);
+		}
 		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
 		goto cleanup;
 	}
 
+	if (!ctx->req.wait_for_attach) {
+		/* The attachment is tracked by bdev_nvme_wait_for_attach from now on */
+		spdk_jsonrpc_send_bool_response(request, true);
+	}
+
 	return;
 
 cleanup:
@@ -630,6 +738,30 @@ cleanup:
 SPDK_RPC_REGISTER("bdev_nvme_attach_controller", rpc_bdev_nvme_attach_controller,
 		  SPDK_RPC_RUNTIME)
 
+static void
+rpc_bdev_nvme_wait_for_attach(struct spdk_jsonrpc_request *request,
+			      const struct spdk_json_val *params)
+{
+	struct rpc_bdev_nvme_wait_for_attach_ctx *ctx;
+
+	if (params != NULL) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "bdev_nvme_wait_for_attach requires no parameters");
+		return;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		return;
+	}
+
+	ctx->request = request;
+	TAILQ_INSERT_TAIL(&g_rpc_attach_waiters, ctx, tailq);
+	rpc_bdev_nvme_wait_for_attach_complete();
+}
+SPDK_RPC_REGISTER("bdev_nvme_wait_for_attach", rpc_bdev_nvme_wait_for_attach, SPDK_RPC_RUNTIME)
+
 static void
 rpc_dump_nvme_bdev_controller_info(struct nvme_bdev_ctrlr *nbdev_ctrlr, void *ctx)
 {
@@ -2322,6 +2454,8 @@ rpc_decode_mp_selector(const struct spdk_json_val *val, void *out)
 		*selector = BDEV_NVME_MP_SELECTOR_ROUND_ROBIN;
 	} else if (spdk_json_strequal(val, "queue_depth") == true) {
 		*selector = BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH;
+	} else if (spdk_json_strequal(val, "latency") == true) {
+		*selector = BDEV_NVME_MP_SELECTOR_LATENCY;
 	} else {
 		SPDK_NOTICELOG("Invalid parameter value: selector\n");
 		return -EINVAL;
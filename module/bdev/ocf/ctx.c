@@ -367,8 +367,10 @@ vbdev_ocf_ctx_cleaner_kick(ocf_cleaner_t cleaner)
 	}
 
 	/* We start cleaner poller at the same thread where cache was created
-	 * TODO: allow user to specify core at which cleaner should run */
-	priv->poller = SPDK_POLLER_REGISTER(cleaner_poll, cleaner, 0);
+	 * TODO: allow user to specify core at which cleaner should run
+	 * Cleaning intervals are given in milliseconds, checking every millisecond is
+	 * enough and leaves the reactor to the queues of the thread meanwhile. */
+	priv->poller = SPDK_POLLER_REGISTER(cleaner_poll, cleaner, 1000);
 }
 
 /* This function is main way by which OCF communicates with user
@@ -20,6 +20,21 @@
 
 #define RAID_BDEV_PROCESS_WINDOW_SIZE_KB_DEFAULT	1024
 #define RAID_BDEV_PROCESS_MAX_BANDWIDTH_MB_SEC_DEFAULT	0
+#define RAID_BDEV_PROCESS_MAX_LATENCY_US_DEFAULT	0
+#define RAID_BDEV_WRITE_INTENT_REGION_SIZE_KB_DEFAULT	(64 * 1024)
+
+/* Period of cleaning the write intent bitmap while all base bdevs are in sync */
+#define RAID_BDEV_WRITE_INTENT_CLEAN_PERIOD_US	(1000 * 1000)
+
+/* Foreground latency histogram: 4 buckets per power of 2 of the latency in ticks */
+#define RAID_PROCESS_LATENCY_SUB_BUCKETS_SHIFT	2
+#define RAID_PROCESS_LATENCY_NUM_BUCKETS	(64 << RAID_PROCESS_LATENCY_SUB_BUCKETS_SHIFT)
+
+/* Minimum number of foreground I/Os to evaluate the latency */
+#define RAID_PROCESS_THROTTLE_MIN_SAMPLES	32
+/* Range of the delay between process windows when throttled */
+#define RAID_PROCESS_THROTTLE_DELAY_MIN_US	1000
+#define RAID_PROCESS_THROTTLE_DELAY_MAX_US	(1000 * 1000)
 
 static bool g_shutdown_started = false;
 
@@ -44,9 +59,35 @@ struct raid_bdev_io_channel {
 		uint64_t offset;
 		struct spdk_io_channel *target_ch;
 		struct raid_bdev_io_channel *ch_processed;
+		/* Foreground latency histogram, only when the process is throttled by latency */
+		struct raid_process_latency *latency;
 	} process;
 };
 
+struct raid_process_latency {
+	uint32_t buckets[RAID_PROCESS_LATENCY_NUM_BUCKETS];
+};
+
+/*
+ * Write intent bitmap. A region is marked dirty before a write to it is submitted and it is
+ * cleaned only when there are no writes to it outstanding and all base bdevs are in sync. So
+ * when a removed base bdev comes back, only the dirty regions have to be rebuilt on it. The
+ * bitmap is kept in memory only, after a restart the whole base bdev is rebuilt.
+ */
+struct raid_bdev_write_intent {
+	/* Region size in blocks as a power of 2 */
+	uint32_t region_shift;
+	uint64_t num_regions;
+	uint64_t *dirty;
+	/* Per-region counters of outstanding writes */
+	uint32_t *writes_outstanding;
+	/* Set when a write was not tracked, e.g. after a resize */
+	bool incomplete;
+	/* Per-slot UUIDs of removed base bdevs that were in sync except for the dirty regions */
+	struct spdk_uuid *departed_uuid;
+	struct spdk_poller *clean_poller;
+};
+
 enum raid_bdev_process_state {
 	RAID_PROCESS_STATE_INIT,
 	RAID_PROCESS_STATE_RUNNING,
@@ -80,6 +121,19 @@ struct raid_bdev_process {
 	int				status;
 	TAILQ_HEAD(, raid_process_finish_action) finish_actions;
 	struct raid_process_qos		qos;
+	/* Length of the locked range, may be more than max_window_size for clean ranges */
+	uint64_t			window_range_size;
+	/* The window range has not been written since the target was removed */
+	bool				window_clean;
+	/* Only rebuild the regions dirty in the write intent bitmap */
+	bool				resync_dirty_only;
+	struct {
+		/* Foreground latency target in ticks, 0 if disabled */
+		uint64_t		max_latency_ticks;
+		uint64_t		delay_ticks;
+		uint64_t		next_window_tsc;
+		struct raid_process_latency latency;
+	} throttle;
 };
 
 struct raid_process_finish_action {
@@ -91,6 +145,8 @@ struct raid_process_finish_action {
 static struct spdk_raid_bdev_opts g_opts = {
 	.process_window_size_kb = RAID_BDEV_PROCESS_WINDOW_SIZE_KB_DEFAULT,
 	.process_max_bandwidth_mb_sec = RAID_BDEV_PROCESS_MAX_BANDWIDTH_MB_SEC_DEFAULT,
+	.process_max_latency_us = RAID_BDEV_PROCESS_MAX_LATENCY_US_DEFAULT,
+	.write_intent_region_size_kb = RAID_BDEV_WRITE_INTENT_REGION_SIZE_KB_DEFAULT,
 };
 
 void
@@ -191,6 +247,9 @@ raid_bdev_ch_process_cleanup(struct raid_bdev_io_channel *raid_ch)
 		free(raid_ch->process.ch_processed);
 		raid_ch->process.ch_processed = NULL;
 	}
+
+	free(raid_ch->process.latency);
+	raid_ch->process.latency = NULL;
 }
 
 static int
@@ -237,6 +296,15 @@ raid_bdev_ch_process_setup(struct raid_bdev_io_channel *raid_ch, struct raid_bde
 	raid_ch_processed->module_channel = raid_ch->module_channel;
 	raid_ch_processed->process.offset = RAID_OFFSET_BLOCKS_INVALID;
 
+	if (process->throttle.max_latency_ticks != 0) {
+		raid_ch->process.latency = calloc(1, sizeof(*raid_ch->process.latency));
+		if (raid_ch->process.latency == NULL) {
+			goto err;
+		}
+		/* I/Os in the processed range account their latency to the same histogram */
+		raid_ch_processed->process.latency = raid_ch->process.latency;
+	}
+
 	return 0;
 err:
 	raid_bdev_ch_process_cleanup(raid_ch);
@@ -483,6 +551,8 @@ raid_bdev_module_stop_done(struct raid_bdev *raid_bdev)
 	}
 }
 
+static void raid_bdev_write_intent_free(struct raid_bdev *raid_bdev);
+
 static void
 _raid_bdev_destruct(void *ctxt)
 {
@@ -493,6 +563,8 @@ _raid_bdev_destruct(void *ctxt)
 
 	assert(raid_bdev->process == NULL);
 
+	raid_bdev_write_intent_free(raid_bdev);
+
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
 		/*
 		 * Close all base bdev descriptors for which call has come from below
@@ -602,13 +674,365 @@ raid_bdev_verify_dix_reftag(struct iovec *iovs, int iovcnt, void *md_buf,
 	return rc;
 }
 
+static bool
+raid_bdev_is_in_sync(struct raid_bdev *raid_bdev)
+{
+	struct raid_base_bdev_info *base_info;
+
+	if (raid_bdev->process != NULL) {
+		return false;
+	}
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		if (!base_info->is_configured || base_info->remove_scheduled ||
+		    __atomic_load_n(&base_info->is_failed, __ATOMIC_SEQ_CST)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int
+raid_bdev_write_intent_clean_poll(void *arg)
+{
+	struct raid_bdev *raid_bdev = arg;
+	struct raid_bdev_write_intent *wi = raid_bdev->write_intent;
+	uint64_t i, bits, mask, region;
+	uint64_t cleaned = 0;
+	uint8_t slot;
+
+	if (!raid_bdev_is_in_sync(raid_bdev)) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	/* All base bdevs are in sync, so the removed ones can't be re-added without a full rebuild */
+	for (slot = 0; slot < raid_bdev->num_base_bdevs; slot++) {
+		spdk_uuid_set_null(&wi->departed_uuid[slot]);
+	}
+
+	for (i = 0; i < spdk_divide_round_up(wi->num_regions, 64); i++) {
+		bits = __atomic_load_n(&wi->dirty[i], __ATOMIC_SEQ_CST);
+		while (bits != 0) {
+			mask = bits & -bits;
+			bits &= ~mask;
+			region = i * 64 + __builtin_ctzll(mask);
+
+			/*
+			 * Clear the bit before checking the counter. A write that increments the
+			 * counter after the check finds the bit cleared and sets it again.
+			 */
+			__atomic_fetch_and(&wi->dirty[i], ~mask, __ATOMIC_SEQ_CST);
+			if (__atomic_load_n(&wi->writes_outstanding[region], __ATOMIC_SEQ_CST) != 0 ||
+			    !raid_bdev_is_in_sync(raid_bdev)) {
+				__atomic_fetch_or(&wi->dirty[i], mask, __ATOMIC_SEQ_CST);
+			} else {
+				cleaned++;
+			}
+		}
+	}
+
+	return cleaned > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+static void
+raid_bdev_write_intent_free(struct raid_bdev *raid_bdev)
+{
+	struct raid_bdev_write_intent *wi = raid_bdev->write_intent;
+
+	if (wi == NULL) {
+		return;
+	}
+
+	spdk_poller_unregister(&wi->clean_poller);
+	free(wi->dirty);
+	free(wi->writes_outstanding);
+	free(wi->departed_uuid);
+	free(wi);
+	raid_bdev->write_intent = NULL;
+}
+
+static void
+raid_bdev_write_intent_alloc(struct raid_bdev *raid_bdev)
+{
+	struct raid_bdev_write_intent *wi;
+	uint64_t region_size;
+
+	assert(raid_bdev->write_intent == NULL);
+
+	if (g_opts.write_intent_region_size_kb == 0 || !raid_bdev->superblock_enabled ||
+	    raid_bdev->min_base_bdevs_operational == raid_bdev->num_base_bdevs) {
+		return;
+	}
+
+	wi = calloc(1, sizeof(*wi));
+	if (wi == NULL) {
+		goto err;
+	}
+	raid_bdev->write_intent = wi;
+
+	region_size = spdk_divide_round_up(g_opts.write_intent_region_size_kb * 1024ULL,
+					   spdk_bdev_get_data_block_size(&raid_bdev->bdev));
+	wi->region_shift = region_size > 1 ? spdk_u64log2(spdk_align64pow2(region_size)) : 0;
+	wi->num_regions = spdk_divide_round_up(raid_bdev->bdev.blockcnt, 1ULL << wi->region_shift);
+	wi->dirty = calloc(spdk_divide_round_up(wi->num_regions, 64), sizeof(*wi->dirty));
+	wi->writes_outstanding = calloc(wi->num_regions, sizeof(*wi->writes_outstanding));
+	wi->departed_uuid = calloc(raid_bdev->num_base_bdevs, sizeof(*wi->departed_uuid));
+	if (wi->dirty == NULL || wi->writes_outstanding == NULL || wi->departed_uuid == NULL) {
+		goto err;
+	}
+
+	wi->clean_poller = SPDK_POLLER_REGISTER(raid_bdev_write_intent_clean_poll, raid_bdev,
+						RAID_BDEV_WRITE_INTENT_CLEAN_PERIOD_US);
+	if (wi->clean_poller == NULL) {
+		goto err;
+	}
+
+	return;
+err:
+	SPDK_WARNLOG("Failed to allocate write intent bitmap of raid bdev %s, removed base bdevs will be fully rebuilt\n",
+		     raid_bdev->bdev.name);
+	raid_bdev_write_intent_free(raid_bdev);
+}
+
+static void
+raid_bdev_write_intent_start(struct raid_bdev *raid_bdev, uint64_t offset_blocks,
+			     uint64_t num_blocks)
+{
+	struct raid_bdev_write_intent *wi = raid_bdev->write_intent;
+	uint64_t region, last, mask;
+	uint64_t *word;
+
+	if (wi == NULL || num_blocks == 0) {
+		return;
+	}
+
+	region = offset_blocks >> wi->region_shift;
+	last = (offset_blocks + num_blocks - 1) >> wi->region_shift;
+	if (spdk_unlikely(last >= wi->num_regions)) {
+		__atomic_store_n(&wi->incomplete, true, __ATOMIC_SEQ_CST);
+		last = wi->num_regions - 1;
+	}
+
+	for (; region <= last; region++) {
+		/* The counter has to be incremented first, see raid_bdev_write_intent_clean_poll() */
+		__atomic_fetch_add(&wi->writes_outstanding[region], 1, __ATOMIC_SEQ_CST);
+
+		word = &wi->dirty[region / 64];
+		mask = 1ULL << (region % 64);
+		if ((__atomic_load_n(word, __ATOMIC_SEQ_CST) & mask) == 0) {
+			__atomic_fetch_or(word, mask, __ATOMIC_SEQ_CST);
+		}
+	}
+}
+
+static void
+raid_bdev_write_intent_end(struct raid_bdev *raid_bdev, uint64_t offset_blocks,
+			   uint64_t num_blocks)
+{
+	struct raid_bdev_write_intent *wi = raid_bdev->write_intent;
+	uint64_t region, last;
+
+	if (wi == NULL || num_blocks == 0) {
+		return;
+	}
+
+	region = offset_blocks >> wi->region_shift;
+	last = spdk_min((offset_blocks + num_blocks - 1) >> wi->region_shift, wi->num_regions - 1);
+
+	for (; region <= last; region++) {
+		assert(wi->writes_outstanding[region] > 0);
+		__atomic_fetch_sub(&wi->writes_outstanding[region], 1, __ATOMIC_SEQ_CST);
+	}
+}
+
+/*
+ * Gets the offset of the first region at or after offset_blocks which is dirty (or clean if
+ * dirty is false), or blockcnt if there is none. The offset is aligned to the write unit, so
+ * that the dirty ranges are expanded rather than shrunk.
+ */
+static uint64_t
+raid_bdev_write_intent_next(struct raid_bdev *raid_bdev, uint64_t offset_blocks, bool dirty)
+{
+	struct raid_bdev_write_intent *wi = raid_bdev->write_intent;
+	const uint64_t write_unit_size = spdk_max(raid_bdev->bdev.write_unit_size, 1);
+	uint64_t region = offset_blocks >> wi->region_shift;
+	uint64_t bits, offset;
+
+	while (region < wi->num_regions) {
+		bits = __atomic_load_n(&wi->dirty[region / 64], __ATOMIC_SEQ_CST);
+		if (!dirty) {
+			bits = ~bits;
+		}
+		bits >>= region % 64;
+		if (bits != 0) {
+			region += __builtin_ctzll(bits);
+			break;
+		}
+		region = (region / 64 + 1) * 64;
+	}
+
+	if (region >= wi->num_regions) {
+		return raid_bdev->bdev.blockcnt;
+	}
+
+	offset = spdk_max(region << wi->region_shift, offset_blocks);
+	if (dirty) {
+		offset = offset / write_unit_size * write_unit_size;
+	} else {
+		offset = spdk_divide_round_up(offset, write_unit_size) * write_unit_size;
+	}
+
+	return spdk_min(offset, raid_bdev->bdev.blockcnt);
+}
+
+static inline uint64_t
+raid_bdev_write_intent_next_dirty(struct raid_bdev *raid_bdev, uint64_t offset_blocks)
+{
+	return raid_bdev_write_intent_next(raid_bdev, offset_blocks, true);
+}
+
+static inline uint64_t
+raid_bdev_write_intent_next_clean(struct raid_bdev *raid_bdev, uint64_t offset_blocks)
+{
+	return raid_bdev_write_intent_next(raid_bdev, offset_blocks, false);
+}
+
+static void
+raid_bdev_write_intent_base_bdev_removed(struct raid_base_bdev_info *base_info)
+{
+	struct raid_bdev_write_intent *wi = base_info->raid_bdev->write_intent;
+
+	/* A process target was not in sync, it will be fully rebuilt when it comes back */
+	if (wi == NULL || base_info->is_process_target) {
+		return;
+	}
+
+	spdk_uuid_copy(&wi->departed_uuid[raid_bdev_base_bdev_slot(base_info)], &base_info->uuid);
+}
+
+/*
+ * Checks if the base bdev is the same one that was removed from its slot and nothing but the
+ * dirty regions has to be rebuilt on it.
+ */
+static bool
+raid_bdev_write_intent_base_bdev_returned(struct raid_base_bdev_info *base_info)
+{
+	struct raid_bdev_write_intent *wi = base_info->raid_bdev->write_intent;
+	uint8_t slot = raid_bdev_base_bdev_slot(base_info);
+	bool ret;
+
+	if (wi == NULL) {
+		return false;
+	}
+
+	ret = !spdk_uuid_is_null(&wi->departed_uuid[slot]) &&
+	      spdk_uuid_compare(&wi->departed_uuid[slot], &base_info->uuid) == 0 &&
+	      !__atomic_load_n(&wi->incomplete, __ATOMIC_SEQ_CST);
+	spdk_uuid_set_null(&wi->departed_uuid[slot]);
+
+	return ret;
+}
+
+/* Forgets a removed base bdev, e.g. when it comes back without a superblock */
+static void
+raid_bdev_write_intent_forget(struct raid_bdev *raid_bdev, const struct spdk_uuid *uuid)
+{
+	struct raid_bdev_write_intent *wi = raid_bdev->write_intent;
+	uint8_t slot;
+
+	if (wi == NULL) {
+		return;
+	}
+
+	for (slot = 0; slot < raid_bdev->num_base_bdevs; slot++) {
+		if (spdk_uuid_compare(&wi->departed_uuid[slot], uuid) == 0) {
+			spdk_uuid_set_null(&wi->departed_uuid[slot]);
+		}
+	}
+}
+
+static inline uint32_t
+raid_process_latency_bucket(uint64_t ticks)
+{
+	uint32_t shift;
+
+	if (ticks < (1 << RAID_PROCESS_LATENCY_SUB_BUCKETS_SHIFT)) {
+		return ticks;
+	}
+
+	shift = spdk_u64log2(ticks) - RAID_PROCESS_LATENCY_SUB_BUCKETS_SHIFT;
+
+	return ((shift + 1) << RAID_PROCESS_LATENCY_SUB_BUCKETS_SHIFT) |
+	       ((ticks >> shift) & ((1 << RAID_PROCESS_LATENCY_SUB_BUCKETS_SHIFT) - 1));
+}
+
+/* Gets the highest latency in ticks accounted to a bucket */
+static uint64_t
+raid_process_latency_bucket_max(uint32_t bucket)
+{
+	uint32_t shift;
+	uint64_t sub;
+
+	if (bucket < (1 << RAID_PROCESS_LATENCY_SUB_BUCKETS_SHIFT)) {
+		return bucket;
+	}
+
+	shift = (bucket >> RAID_PROCESS_LATENCY_SUB_BUCKETS_SHIFT) - 1;
+	sub = bucket & ((1 << RAID_PROCESS_LATENCY_SUB_BUCKETS_SHIFT) - 1);
+
+	return ((sub | (1 << RAID_PROCESS_LATENCY_SUB_BUCKETS_SHIFT)) << shift) + ((1ULL << shift) - 1);
+}
+
+static uint64_t
+raid_process_latency_p99(const struct raid_process_latency *latency, uint64_t *num_samples)
+{
+	uint64_t total = 0, sum = 0, threshold;
+	uint32_t i;
+
+	for (i = 0; i < RAID_PROCESS_LATENCY_NUM_BUCKETS; i++) {
+		total += latency->buckets[i];
+	}
+
+	*num_samples = total;
+	if (total == 0) {
+		return 0;
+	}
+
+	threshold = total - total / 100;
+	for (i = 0; i < RAID_PROCESS_LATENCY_NUM_BUCKETS; i++) {
+		sum += latency->buckets[i];
+		if (sum >= threshold) {
+			break;
+		}
+	}
+
+	return raid_process_latency_bucket_max(i);
+}
+
+static inline void
+raid_bdev_io_record_latency(struct raid_bdev_io *raid_io, struct spdk_bdev_io *bdev_io)
+{
+	struct raid_process_latency *latency = raid_io->raid_ch->process.latency;
+
+	if (spdk_likely(latency == NULL)) {
+		return;
+	}
+
+	latency->buckets[raid_process_latency_bucket(spdk_get_ticks() -
+					       spdk_bdev_io_get_submit_tsc(bdev_io))]++;
+}
+
 void
 raid_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
 {
 	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
 	int rc;
 
-	spdk_trace_record(TRACE_BDEV_RAID_IO_DONE, 0, 0, (uintptr_t)raid_io, (uintptr_t)bdev_io);
+	/* I/Os with a completion_cb are internal to raid and not embedded in a bdev_io */
+	if (raid_io->completion_cb != NULL || spdk_bdev_io_trace_sampled(bdev_io)) {
+		spdk_trace_record(TRACE_BDEV_RAID_IO_DONE, 0, 0, (uintptr_t)raid_io, (uintptr_t)bdev_io);
+	}
 
 	if (raid_io->split.offset != RAID_OFFSET_BLOCKS_INVALID) {
 		struct iovec *split_iov = raid_io->split.iov;
@@ -652,6 +1076,12 @@ raid_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status sta
 	if (spdk_unlikely(raid_io->completion_cb != NULL)) {
 		raid_io->completion_cb(raid_io, status);
 	} else {
+		if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE || bdev_io->type == SPDK_BDEV_IO_TYPE_UNMAP) {
+			raid_bdev_write_intent_end(raid_io->raid_bdev, bdev_io->u.bdev.offset_blocks,
+						   bdev_io->u.bdev.num_blocks);
+		}
+		raid_bdev_io_record_latency(raid_io, bdev_io);
+
 		if (spdk_unlikely(bdev_io->type == SPDK_BDEV_IO_TYPE_READ &&
 				  spdk_bdev_get_dif_type(bdev_io->bdev) != SPDK_DIF_DISABLE &&
 				  bdev_io->bdev->dif_check_flags & SPDK_DIF_FLAGS_REFTAG_CHECK &&
@@ -914,6 +1344,7 @@ raid_bdev_io_init(struct raid_bdev_io *raid_io, struct raid_bdev_io_channel *rai
 	raid_io->memory_domain = memory_domain;
 	raid_io->memory_domain_ctx = memory_domain_ctx;
 	raid_io->md_buf = md_buf;
+	raid_io->priority = SPDK_BDEV_IO_PRIORITY_DEFAULT;
 
 	raid_io->raid_bdev = raid_bdev;
 	raid_io->raid_ch = raid_ch;
@@ -945,8 +1376,11 @@ raid_bdev_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 			  bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks,
 			  bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt, bdev_io->u.bdev.md_buf,
 			  bdev_io->u.bdev.memory_domain, bdev_io->u.bdev.memory_domain_ctx);
+	raid_io->priority = bdev_io->priority;
 
-	spdk_trace_record(TRACE_BDEV_RAID_IO_START, 0, 0, (uintptr_t)raid_io, (uintptr_t)bdev_io);
+	if (spdk_bdev_io_trace_sampled(bdev_io)) {
+		spdk_trace_record(TRACE_BDEV_RAID_IO_START, 0, 0, (uintptr_t)raid_io, (uintptr_t)bdev_io);
+	}
 
 	switch (bdev_io->type) {
 	case SPDK_BDEV_IO_TYPE_READ:
@@ -954,6 +1388,7 @@ raid_bdev_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
 		break;
 	case SPDK_BDEV_IO_TYPE_WRITE:
+		raid_bdev_write_intent_start(raid_io->raid_bdev, raid_io->offset_blocks, raid_io->num_blocks);
 		raid_bdev_submit_rw_request(raid_io);
 		break;
 
@@ -961,8 +1396,10 @@ raid_bdev_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 		raid_bdev_submit_reset_request(raid_io);
 		break;
 
-	case SPDK_BDEV_IO_TYPE_FLUSH:
 	case SPDK_BDEV_IO_TYPE_UNMAP:
+		raid_bdev_write_intent_start(raid_io->raid_bdev, raid_io->offset_blocks, raid_io->num_blocks);
+	/* fallthrough */
+	case SPDK_BDEV_IO_TYPE_FLUSH:
 		if (raid_io->raid_bdev->process != NULL) {
 			/* TODO: rebuild support */
 			raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
@@ -1280,8 +1717,12 @@ static struct {
 	{ "0", RAID0 },
 	{ "raid1", RAID1 },
 	{ "1", RAID1 },
+	{ "raid10", RAID10 },
+	{ "10", RAID10 },
 	{ "raid5f", RAID5F },
 	{ "5f", RAID5F },
+	{ "raid6f", RAID6F },
+	{ "6f", RAID6F },
 	{ "concat", CONCAT },
 	{ }
 };
@@ -1428,6 +1869,9 @@ raid_bdev_opts_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "process_window_size_kb", g_opts.process_window_size_kb);
 	spdk_json_write_named_uint32(w, "process_max_bandwidth_mb_sec",
 				     g_opts.process_max_bandwidth_mb_sec);
+	spdk_json_write_named_uint32(w, "process_max_latency_us", g_opts.process_max_latency_us);
+	spdk_json_write_named_uint32(w, "write_intent_region_size_kb",
+				     g_opts.write_intent_region_size_kb);
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_object_end(w);
@@ -1731,6 +2175,7 @@ raid_bdev_configure_cont(struct raid_bdev *raid_bdev)
 	int rc;
 
 	raid_bdev->state = RAID_BDEV_STATE_ONLINE;
+	raid_bdev_write_intent_alloc(raid_bdev);
 	SPDK_DEBUGLOG(bdev_raid, "io device register %p\n", raid_bdev);
 	SPDK_DEBUGLOG(bdev_raid, "blockcnt %" PRIu64 ", blocklen %u\n",
 		      raid_bdev_gen->blockcnt, raid_bdev_gen->blocklen);
@@ -1770,6 +2215,7 @@ out:
 			raid_bdev->module->stop(raid_bdev);
 		}
 		spdk_io_device_unregister(raid_bdev, NULL);
+		raid_bdev_write_intent_free(raid_bdev);
 		raid_bdev->state = RAID_BDEV_STATE_CONFIGURING;
 	}
 
@@ -2000,6 +2446,7 @@ raid_bdev_channels_remove_base_bdev_done(struct spdk_io_channel_iter *i, int sta
 static void
 raid_bdev_remove_base_bdev_cont(struct raid_base_bdev_info *base_info)
 {
+	raid_bdev_write_intent_base_bdev_removed(base_info);
 	raid_bdev_deconfigure_base_bdev(base_info);
 
 	spdk_for_each_channel(base_info->raid_bdev, raid_bdev_channel_remove_base_bdev, base_info,
@@ -2693,18 +3140,56 @@ raid_bdev_process_unlock_window_range(struct raid_bdev_process *process)
 	assert(process->window_range_locked == true);
 
 	rc = spdk_bdev_unquiesce_range(&process->raid_bdev->bdev, &g_raid_if,
-				       process->window_offset, process->max_window_size,
+				       process->window_offset, process->window_range_size,
 				       raid_bdev_process_window_range_unlocked, process);
 	if (rc != 0) {
 		raid_bdev_process_window_range_unlocked(process, rc);
 	}
 }
 
+/*
+ * Adjusts the delay between windows so that the foreground I/O latency stays below the
+ * target. The delay is doubled while the 99th percentile exceeds the target and is halved
+ * otherwise, so the process runs at full speed when there is no contention.
+ */
+static void
+raid_bdev_process_throttle_update(struct raid_bdev_process *process)
+{
+	uint64_t p99, num_samples;
+
+	if (process->throttle.max_latency_ticks == 0) {
+		return;
+	}
+
+	p99 = raid_process_latency_p99(&process->throttle.latency, &num_samples);
+	if (num_samples == 0 || num_samples >= RAID_PROCESS_THROTTLE_MIN_SAMPLES) {
+		const uint64_t delay_min = RAID_PROCESS_THROTTLE_DELAY_MIN_US * spdk_get_ticks_hz() /
+					   SPDK_SEC_TO_USEC;
+		const uint64_t delay_max = RAID_PROCESS_THROTTLE_DELAY_MAX_US * spdk_get_ticks_hz() /
+					   SPDK_SEC_TO_USEC;
+
+		if (p99 > process->throttle.max_latency_ticks) {
+			process->throttle.delay_ticks = spdk_min(spdk_max(process->throttle.delay_ticks * 2,
+							delay_min), delay_max);
+		} else {
+			process->throttle.delay_ticks /= 2;
+			if (process->throttle.delay_ticks < delay_min) {
+				process->throttle.delay_ticks = 0;
+			}
+		}
+
+		memset(&process->throttle.latency, 0, sizeof(process->throttle.latency));
+	}
+
+	process->throttle.next_window_tsc = spdk_get_ticks() + process->throttle.delay_ticks;
+}
+
 static void
 raid_bdev_process_channels_update_done(struct spdk_io_channel_iter *i, int status)
 {
 	struct raid_bdev_process *process = spdk_io_channel_iter_get_ctx(i);
 
+	raid_bdev_process_throttle_update(process);
 	raid_bdev_process_unlock_window_range(process);
 }
 
@@ -2714,9 +3199,18 @@ raid_bdev_process_channel_update(struct spdk_io_channel_iter *i)
 	struct raid_bdev_process *process = spdk_io_channel_iter_get_ctx(i);
 	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
 	struct raid_bdev_io_channel *raid_ch = spdk_io_channel_get_ctx(ch);
+	struct raid_process_latency *latency = raid_ch->process.latency;
+	uint32_t j;
 
 	raid_ch->process.offset = process->window_offset + process->window_size;
 
+	if (latency != NULL) {
+		for (j = 0; j < RAID_PROCESS_LATENCY_NUM_BUCKETS; j++) {
+			process->throttle.latency.buckets[j] += latency->buckets[j];
+		}
+		memset(latency, 0, sizeof(*latency));
+	}
+
 	spdk_for_each_channel_continue(i, 0);
 }
 
@@ -2787,9 +3281,24 @@ _raid_bdev_process_thread_run(struct raid_bdev_process *process)
 {
 	struct raid_bdev *raid_bdev = process->raid_bdev;
 	uint64_t offset = process->window_offset;
-	const uint64_t offset_end = spdk_min(offset + process->max_window_size, raid_bdev->bdev.blockcnt);
+	uint64_t offset_end;
 	int ret;
 
+	if (process->window_clean) {
+		/* Writes may have hit the range before it was locked */
+		offset_end = spdk_min(raid_bdev_write_intent_next_dirty(raid_bdev, offset),
+				      offset + process->window_range_size);
+		if (offset_end > offset) {
+			process->window_size = offset_end - offset;
+			spdk_for_each_channel(process->raid_bdev, raid_bdev_process_channel_update, process,
+					      raid_bdev_process_channels_update_done);
+			return;
+		}
+	}
+
+	offset_end = spdk_min(offset + spdk_min(process->max_window_size, process->window_range_size),
+			      raid_bdev->bdev.blockcnt);
+
 	while (offset < offset_end) {
 		ret = raid_bdev_submit_process_request(process, offset, offset_end - offset);
 		if (ret <= 0) {
@@ -2845,6 +3354,20 @@ raid_bdev_process_consume_token(struct raid_bdev_process *process)
 	return false;
 }
 
+static bool
+raid_bdev_process_window_allowed(struct raid_bdev_process *process)
+{
+	if (process->throttle.delay_ticks != 0 && spdk_get_ticks() < process->throttle.next_window_tsc) {
+		return false;
+	}
+
+	if (process->qos.enable_qos && !raid_bdev_process_consume_token(process)) {
+		return false;
+	}
+
+	return true;
+}
+
 static bool
 raid_bdev_process_lock_window_range(struct raid_bdev_process *process)
 {
@@ -2853,8 +3376,8 @@ raid_bdev_process_lock_window_range(struct raid_bdev_process *process)
 
 	assert(process->window_range_locked == false);
 
-	if (process->qos.enable_qos) {
-		if (raid_bdev_process_consume_token(process)) {
+	if (process->qos.process_continue_poller != NULL) {
+		if (raid_bdev_process_window_allowed(process)) {
 			spdk_poller_pause(process->qos.process_continue_poller);
 		} else {
 			spdk_poller_resume(process->qos.process_continue_poller);
@@ -2863,7 +3386,7 @@ raid_bdev_process_lock_window_range(struct raid_bdev_process *process)
 	}
 
 	rc = spdk_bdev_quiesce_range(&raid_bdev->bdev, &g_raid_if,
-				     process->window_offset, process->max_window_size,
+				     process->window_offset, process->window_range_size,
 				     raid_bdev_process_window_range_locked, process);
 	if (rc != 0) {
 		raid_bdev_process_window_range_locked(process, rc);
@@ -2904,6 +3427,22 @@ raid_bdev_process_thread_run(struct raid_bdev_process *process)
 
 	process->max_window_size = spdk_min(raid_bdev->bdev.blockcnt - process->window_offset,
 					    process->max_window_size);
+	process->window_range_size = process->max_window_size;
+	process->window_clean = false;
+
+	if (process->resync_dirty_only) {
+		uint64_t dirty_offset = raid_bdev_write_intent_next_dirty(raid_bdev, process->window_offset);
+
+		if (dirty_offset > process->window_offset) {
+			/* Skip the clean range at once, it only has to be locked to update the channels */
+			process->window_range_size = dirty_offset - process->window_offset;
+			process->window_clean = true;
+		} else {
+			process->window_range_size = spdk_min(process->max_window_size,
+							      raid_bdev_write_intent_next_clean(raid_bdev, dirty_offset) - dirty_offset);
+		}
+	}
+
 	raid_bdev_process_lock_window_range(process);
 }
 
@@ -2926,7 +3465,7 @@ raid_bdev_process_thread_init(void *ctx)
 	process->raid_ch = spdk_io_channel_get_ctx(ch);
 	process->state = RAID_PROCESS_STATE_RUNNING;
 
-	if (process->qos.enable_qos) {
+	if (process->qos.enable_qos || process->throttle.max_latency_ticks != 0) {
 		process->qos.process_continue_poller = SPDK_POLLER_REGISTER(raid_bdev_process_continue_poll,
 						       process, 0);
 		spdk_poller_pause(process->qos.process_continue_poller);
@@ -3107,6 +3646,11 @@ raid_bdev_process_alloc(struct raid_bdev *raid_bdev, enum raid_process_type type
 		process->qos.bytes_available = 0.0;
 	}
 
+	if (g_opts.process_max_latency_us != 0) {
+		process->throttle.max_latency_ticks = spdk_max(1, g_opts.process_max_latency_us *
+						      spdk_get_ticks_hz() / SPDK_SEC_TO_USEC);
+	}
+
 	for (i = 0; i < RAID_BDEV_PROCESS_MAX_QD; i++) {
 		process_req = raid_bdev_process_alloc_request(process);
 		if (process_req == NULL) {
@@ -3132,6 +3676,12 @@ raid_bdev_start_rebuild(struct raid_base_bdev_info *target)
 		return -ENOMEM;
 	}
 
+	if (raid_bdev_write_intent_base_bdev_returned(target)) {
+		SPDK_NOTICELOG("Base bdev %s returned to raid bdev %s, only dirty regions will be rebuilt\n",
+			       target->name, target->raid_bdev->bdev.name);
+		process->resync_dirty_only = true;
+	}
+
 	raid_bdev_process_start(process);
 
 	return 0;
@@ -3236,6 +3786,7 @@ raid_bdev_configure_base_bdev_check_sb_cb(const struct raid_bdev_superblock *sb,
 		break;
 	case -EINVAL:
 		/* no valid superblock */
+		raid_bdev_write_intent_forget(base_info->raid_bdev, &base_info->uuid);
 		raid_bdev_configure_base_bdev_cont(base_info);
 		return;
 	default:
@@ -15,8 +15,10 @@ enum raid_level {
 	INVALID_RAID_LEVEL	= -1,
 	RAID0			= 0,
 	RAID1			= 1,
+	RAID10			= 10,
 	RAID5F			= 95, /* 0x5f */
 	CONCAT			= 99,
+	RAID6F			= 111, /* 0x6f */
 };
 
 /*
@@ -133,6 +135,8 @@ struct raid_bdev_io {
 	struct spdk_memory_domain *memory_domain;
 	void *memory_domain_ctx;
 	void *md_buf;
+	/* Priority of the base bdev I/Os, see enum spdk_bdev_io_priority */
+	uint8_t priority;
 
 	/* WaitQ entry, used only in waitq logic */
 	struct spdk_bdev_io_wait_entry	waitq_entry;
@@ -150,6 +154,9 @@ struct raid_bdev_io {
 	/* Private data for the raid module */
 	void				*module_private;
 
+	/* Submission time of the base bdev io, for modules tracking the latency */
+	uint64_t			submit_tsc;
+
 	/* Custom completion callback. Overrides bdev_io completion if set. */
 	raid_bdev_io_completion_cb	completion_cb;
 
@@ -245,6 +252,9 @@ struct raid_bdev {
 	/* Raid bdev background process, e.g. rebuild */
 	struct raid_bdev_process	*process;
 
+	/* Regions written while a base bdev may be missing */
+	struct raid_bdev_write_intent	*write_intent;
+
 	/* Callback and context for raid_bdev configuration */
 	raid_bdev_configure_cb		configure_cb;
 	void				*configure_cb_ctx;
@@ -561,6 +571,13 @@ struct spdk_raid_bdev_opts {
 	uint32_t process_window_size_kb;
 	/* Maximum bandwidth in MiB to process per second */
 	uint32_t process_max_bandwidth_mb_sec;
+	/*
+	 * Foreground I/O latency (99th percentile) in microseconds above which a background
+	 * process is slowed down, 0 to disable
+	 */
+	uint32_t process_max_latency_us;
+	/* Size of a write intent bitmap region in KiB, 0 to disable the bitmap */
+	uint32_t write_intent_region_size_kb;
 };
 
 void raid_bdev_get_opts(struct spdk_raid_bdev_opts *opts);
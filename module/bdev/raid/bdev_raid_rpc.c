@@ -608,6 +608,8 @@ SPDK_RPC_REGISTER("bdev_raid_remove_base_bdev", rpc_bdev_raid_remove_base_bdev,
 static const struct spdk_json_object_decoder rpc_bdev_raid_options_decoders[] = {
 	{"process_window_size_kb", offsetof(struct spdk_raid_bdev_opts, process_window_size_kb), spdk_json_decode_uint32, true},
 	{"process_max_bandwidth_mb_sec", offsetof(struct spdk_raid_bdev_opts, process_max_bandwidth_mb_sec), spdk_json_decode_uint32, true},
+	{"process_max_latency_us", offsetof(struct spdk_raid_bdev_opts, process_max_latency_us), spdk_json_decode_uint32, true},
+	{"write_intent_region_size_kb", offsetof(struct spdk_raid_bdev_opts, write_intent_region_size_kb), spdk_json_decode_uint32, true},
 };
 
 static void
@@ -106,6 +106,7 @@ concat_submit_rw_request(struct raid_bdev_io *raid_io)
 	io_opts.memory_domain = raid_io->memory_domain;
 	io_opts.memory_domain_ctx = raid_io->memory_domain_ctx;
 	io_opts.metadata = raid_io->md_buf;
+	io_opts.priority = raid_io->priority;
 
 	if (raid_io->type == SPDK_BDEV_IO_TYPE_READ) {
 		ret = raid_bdev_readv_blocks_ext(base_info, base_ch,
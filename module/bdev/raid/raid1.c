@@ -5,27 +5,93 @@
 
 #include "bdev_raid.h"
 
+#include "spdk/env.h"
 #include "spdk/likely.h"
 #include "spdk/log.h"
 
+/* Number of copies of each strip in raid10 */
+#define RAID10_MIRROR_COPIES 2
+
+/* Weight of a new sample in the moving average of the read latency, as a power of 2 */
+#define RAID1_READ_LATENCY_EWMA_SHIFT 4
+
+/* Every this many reads, a read is sent to the next mirror regardless of its latency */
+#define RAID1_READ_LATENCY_PROBE_INTERVAL 1024
+
 struct raid1_info {
 	/* The parent raid bdev */
 	struct raid_bdev *raid_bdev;
+
+	/* Number of base bdevs holding a copy of each block */
+	uint8_t mirror_copies;
+
+	/* Number of mirror sets the data is striped over, 1 for raid1 */
+	uint8_t num_mirror_sets;
 };
 
 struct raid1_io_channel {
-	/* Array of per-base_bdev counters of outstanding read blocks on this channel */
-	uint64_t read_blocks_outstanding[0];
+	/* Number of reads submitted on this channel */
+	uint64_t num_reads;
+
+	/* Array of per-base_bdev read statistics of this channel */
+	struct {
+		/* Counter of outstanding read blocks */
+		uint64_t read_blocks_outstanding;
+
+		/* Moving average of the read latency per block in ticks, 0 without a sample */
+		uint64_t ewma_read_ticks_per_block;
+	} base[0];
 };
 
+/* Gets the first base bdev slot holding the data of a raid_io */
+static inline uint8_t
+raid1_io_mirror_first(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid1_info *r1info = raid_bdev->module_private;
+
+	if (r1info->num_mirror_sets == 1) {
+		return 0;
+	}
+
+	return ((raid_io->offset_blocks >> raid_bdev->strip_size_shift) % r1info->num_mirror_sets) *
+	       r1info->mirror_copies;
+}
+
+static inline uint8_t
+raid1_io_mirror_copies(struct raid_bdev_io *raid_io)
+{
+	struct raid1_info *r1info = raid_io->raid_bdev->module_private;
+
+	return r1info->mirror_copies;
+}
+
+/* Gets the offset of the data of a raid_io on the base bdevs */
+static inline uint64_t
+raid1_io_base_offset(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid1_info *r1info = raid_bdev->module_private;
+	uint64_t strip;
+
+	if (r1info->num_mirror_sets == 1) {
+		return raid_io->offset_blocks;
+	}
+
+	strip = raid_io->offset_blocks >> raid_bdev->strip_size_shift;
+
+	return ((strip / r1info->num_mirror_sets) << raid_bdev->strip_size_shift) +
+	       (raid_io->offset_blocks & (raid_bdev->strip_size - 1));
+}
+
 static void
 raid1_channel_inc_read_counters(struct raid_bdev_io_channel *raid_ch, uint8_t idx,
 				uint64_t num_blocks)
 {
 	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
 
-	assert(raid1_ch->read_blocks_outstanding[idx] <= UINT64_MAX - num_blocks);
-	raid1_ch->read_blocks_outstanding[idx] += num_blocks;
+	assert(raid1_ch->base[idx].read_blocks_outstanding <= UINT64_MAX - num_blocks);
+	raid1_ch->base[idx].read_blocks_outstanding += num_blocks;
 }
 
 static void
@@ -34,8 +100,30 @@ raid1_channel_dec_read_counters(struct raid_bdev_io_channel *raid_ch, uint8_t id
 {
 	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
 
-	assert(raid1_ch->read_blocks_outstanding[idx] >= num_blocks);
-	raid1_ch->read_blocks_outstanding[idx] -= num_blocks;
+	assert(raid1_ch->base[idx].read_blocks_outstanding >= num_blocks);
+	raid1_ch->base[idx].read_blocks_outstanding -= num_blocks;
+}
+
+static void
+raid1_channel_update_read_latency(struct raid_bdev_io *raid_io, uint8_t idx)
+{
+	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_io->raid_ch);
+	uint64_t *ewma = &raid1_ch->base[idx].ewma_read_ticks_per_block;
+	uint64_t ticks;
+	int64_t delta;
+
+	ticks = (spdk_get_ticks() - raid_io->submit_tsc) / spdk_max(raid_io->num_blocks, 1);
+	if (spdk_unlikely(*ewma == 0)) {
+		/* Seed the average with the first sample. */
+		*ewma = spdk_max(ticks, 1);
+		return;
+	}
+
+	delta = (int64_t)(ticks - *ewma);
+	*ewma += delta / (1 << RAID1_READ_LATENCY_EWMA_SHIFT);
+	if (*ewma == 0) {
+		*ewma = 1;
+	}
 }
 
 static void
@@ -46,6 +134,7 @@ raid1_init_ext_io_opts(struct spdk_bdev_ext_io_opts *opts, struct raid_bdev_io *
 	opts->memory_domain = raid_io->memory_domain;
 	opts->memory_domain_ctx = raid_io->memory_domain_ctx;
 	opts->metadata = raid_io->md_buf;
+	opts->priority = raid_io->priority;
 }
 
 static void
@@ -112,7 +201,7 @@ raid1_correct_read_error(void *_raid_io)
 
 	raid1_init_ext_io_opts(&io_opts, raid_io);
 	ret = raid_bdev_writev_blocks_ext(base_info, base_ch, raid_io->iovs, raid_io->iovcnt,
-					  raid_io->offset_blocks, raid_io->num_blocks,
+					  raid1_io_base_offset(raid_io), raid_io->num_blocks,
 					  raid1_correct_read_error_completion, raid_io, &io_opts);
 	if (spdk_unlikely(ret != 0)) {
 		if (ret == -ENOMEM) {
@@ -150,14 +239,15 @@ raid1_read_other_base_bdev(void *_raid_io)
 {
 	struct raid_bdev_io *raid_io = _raid_io;
 	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	uint8_t first = raid1_io_mirror_first(raid_io);
+	uint8_t end = first + raid1_io_mirror_copies(raid_io);
 	struct spdk_bdev_ext_io_opts io_opts;
 	struct raid_base_bdev_info *base_info;
 	struct spdk_io_channel *base_ch;
 	uint8_t i;
 	int ret;
 
-	for (i = raid_bdev->num_base_bdevs - raid_io->base_bdev_io_remaining; i < raid_bdev->num_base_bdevs;
-	     i++) {
+	for (i = end - raid_io->base_bdev_io_remaining; i < end; i++) {
 		base_info = &raid_bdev->base_bdev_info[i];
 		base_ch = raid_bdev_channel_get_base_channel(raid_io->raid_ch, i);
 
@@ -168,7 +258,7 @@ raid1_read_other_base_bdev(void *_raid_io)
 
 		raid1_init_ext_io_opts(&io_opts, raid_io);
 		ret = raid_bdev_readv_blocks_ext(base_info, base_ch, raid_io->iovs, raid_io->iovcnt,
-						 raid_io->offset_blocks, raid_io->num_blocks,
+						 raid1_io_base_offset(raid_io), raid_io->num_blocks,
 						 raid1_read_other_completion, raid_io, &io_opts);
 		if (spdk_unlikely(ret != 0)) {
 			if (ret == -ENOMEM) {
@@ -198,11 +288,13 @@ raid1_read_bdev_io_completion(struct spdk_bdev_io *bdev_io, bool success, void *
 					raid_io->num_blocks);
 
 	if (!success) {
-		raid_io->base_bdev_io_remaining = raid_io->raid_bdev->num_base_bdevs;
+		raid_io->base_bdev_io_remaining = raid1_io_mirror_copies(raid_io);
 		raid1_read_other_base_bdev(raid_io);
 		return;
 	}
 
+	raid1_channel_update_read_latency(raid_io, raid_io->base_bdev_io_submitted);
+
 	raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_SUCCESS);
 }
 
@@ -216,18 +308,54 @@ _raid1_submit_rw_request(void *_raid_io)
 	raid1_submit_rw_request(raid_io);
 }
 
+/*
+ * Picks the mirror expected to complete the read first: the one with the least outstanding
+ * read blocks, weighted by its average read latency per block. A mirror without a latency
+ * sample is assumed to be as fast as the fastest one, so with equal latencies the reads are
+ * balanced by the outstanding blocks only. Latencies change, so an occasional read is sent
+ * to each mirror in turn to refresh its average.
+ */
 static uint8_t
-raid1_channel_next_read_base_bdev(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+raid1_channel_next_read_base_bdev(struct raid_bdev_io *raid_io)
 {
+	struct raid_bdev_io_channel *raid_ch = raid_io->raid_ch;
 	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
-	uint64_t read_blocks_min = UINT64_MAX;
+	uint8_t first = raid1_io_mirror_first(raid_io);
+	uint8_t copies = raid1_io_mirror_copies(raid_io);
+	uint64_t ticks_min = UINT64_MAX;
+	uint64_t cost_min = UINT64_MAX;
+	uint64_t ticks, cost;
 	uint8_t idx = UINT8_MAX;
 	uint8_t i;
 
-	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
-		if (raid_bdev_channel_get_base_channel(raid_ch, i) != NULL &&
-		    raid1_ch->read_blocks_outstanding[i] < read_blocks_min) {
-			read_blocks_min = raid1_ch->read_blocks_outstanding[i];
+	raid1_ch->num_reads++;
+	if (spdk_unlikely(raid1_ch->num_reads % RAID1_READ_LATENCY_PROBE_INTERVAL == 0)) {
+		i = first + (raid1_ch->num_reads / RAID1_READ_LATENCY_PROBE_INTERVAL) % copies;
+		if (raid_bdev_channel_get_base_channel(raid_ch, i) != NULL) {
+			return i;
+		}
+	}
+
+	for (i = first; i < first + copies; i++) {
+		ticks = raid1_ch->base[i].ewma_read_ticks_per_block;
+		if (ticks != 0 && raid_bdev_channel_get_base_channel(raid_ch, i) != NULL) {
+			ticks_min = spdk_min(ticks_min, ticks);
+		}
+	}
+	if (ticks_min == UINT64_MAX) {
+		ticks_min = 1;
+	}
+
+	for (i = first; i < first + copies; i++) {
+		if (raid_bdev_channel_get_base_channel(raid_ch, i) == NULL) {
+			continue;
+		}
+
+		ticks = raid1_ch->base[i].ewma_read_ticks_per_block;
+		cost = (raid1_ch->base[i].read_blocks_outstanding + raid_io->num_blocks) *
+		       (ticks != 0 ? ticks : ticks_min);
+		if (cost < cost_min) {
+			cost_min = cost;
 			idx = i;
 		}
 	}
@@ -246,7 +374,7 @@ raid1_submit_read_request(struct raid_bdev_io *raid_io)
 	uint8_t idx;
 	int ret;
 
-	idx = raid1_channel_next_read_base_bdev(raid_bdev, raid_ch);
+	idx = raid1_channel_next_read_base_bdev(raid_io);
 	if (spdk_unlikely(idx == UINT8_MAX)) {
 		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
 		return 0;
@@ -257,12 +385,13 @@ raid1_submit_read_request(struct raid_bdev_io *raid_io)
 
 	raid1_init_ext_io_opts(&io_opts, raid_io);
 	ret = raid_bdev_readv_blocks_ext(base_info, base_ch, raid_io->iovs, raid_io->iovcnt,
-					 raid_io->offset_blocks, raid_io->num_blocks,
+					 raid1_io_base_offset(raid_io), raid_io->num_blocks,
 					 raid1_read_bdev_io_completion, raid_io, &io_opts);
 
 	if (spdk_likely(ret == 0)) {
 		raid1_channel_inc_read_counters(raid_ch, idx, raid_io->num_blocks);
 		raid_io->base_bdev_io_submitted = idx;
+		raid_io->submit_tsc = spdk_get_ticks();
 	} else if (spdk_unlikely(ret == -ENOMEM)) {
 		raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
 					base_ch, _raid1_submit_rw_request);
@@ -276,6 +405,8 @@ static int
 raid1_submit_write_request(struct raid_bdev_io *raid_io)
 {
 	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	uint8_t first = raid1_io_mirror_first(raid_io);
+	uint8_t copies = raid1_io_mirror_copies(raid_io);
 	struct spdk_bdev_ext_io_opts io_opts;
 	struct raid_base_bdev_info *base_info;
 	struct spdk_io_channel *base_ch;
@@ -284,12 +415,12 @@ raid1_submit_write_request(struct raid_bdev_io *raid_io)
 	int ret = 0;
 
 	if (raid_io->base_bdev_io_submitted == 0) {
-		raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
+		raid_io->base_bdev_io_remaining = copies;
 		raid_bdev_io_set_default_status(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
 	}
 
 	raid1_init_ext_io_opts(&io_opts, raid_io);
-	for (idx = raid_io->base_bdev_io_submitted; idx < raid_bdev->num_base_bdevs; idx++) {
+	for (idx = first + raid_io->base_bdev_io_submitted; idx < first + copies; idx++) {
 		base_info = &raid_bdev->base_bdev_info[idx];
 		base_ch = raid_bdev_channel_get_base_channel(raid_io->raid_ch, idx);
 
@@ -301,7 +432,7 @@ raid1_submit_write_request(struct raid_bdev_io *raid_io)
 		}
 
 		ret = raid_bdev_writev_blocks_ext(base_info, base_ch, raid_io->iovs, raid_io->iovcnt,
-						  raid_io->offset_blocks, raid_io->num_blocks,
+						  raid1_io_base_offset(raid_io), raid_io->num_blocks,
 						  raid1_write_bdev_io_completion, raid_io, &io_opts);
 		if (spdk_unlikely(ret != 0)) {
 			if (spdk_unlikely(ret == -ENOMEM)) {
@@ -310,8 +441,7 @@ raid1_submit_write_request(struct raid_bdev_io *raid_io)
 				return 0;
 			}
 
-			base_bdev_io_not_submitted = raid_bdev->num_base_bdevs -
-						     raid_io->base_bdev_io_submitted;
+			base_bdev_io_not_submitted = copies - raid_io->base_bdev_io_submitted;
 			raid_bdev_io_complete_part(raid_io, base_bdev_io_not_submitted,
 						   SPDK_BDEV_IO_STATUS_FAILED);
 			return 0;
@@ -371,11 +501,12 @@ raid1_io_device_unregister_done(void *io_device)
 }
 
 static int
-raid1_start(struct raid_bdev *raid_bdev)
+_raid1_start(struct raid_bdev *raid_bdev, uint8_t mirror_copies)
 {
 	uint64_t min_blockcnt = UINT64_MAX;
 	struct raid_base_bdev_info *base_info;
 	struct raid1_info *r1info;
+	struct raid1_io_channel *raid1_ch;
 	char name[256];
 
 	r1info = calloc(1, sizeof(*r1info));
@@ -384,26 +515,55 @@ raid1_start(struct raid_bdev *raid_bdev)
 		return -ENOMEM;
 	}
 	r1info->raid_bdev = raid_bdev;
+	r1info->mirror_copies = mirror_copies;
+	r1info->num_mirror_sets = raid_bdev->num_base_bdevs / mirror_copies;
 
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
 		min_blockcnt = spdk_min(min_blockcnt, base_info->data_size);
 	}
 
+	if (r1info->num_mirror_sets > 1) {
+		/* The data is striped over the mirror sets */
+		min_blockcnt = (min_blockcnt >> raid_bdev->strip_size_shift) << raid_bdev->strip_size_shift;
+		raid_bdev->bdev.blockcnt = min_blockcnt * r1info->num_mirror_sets;
+		raid_bdev->bdev.optimal_io_boundary = raid_bdev->strip_size;
+		raid_bdev->bdev.split_on_optimal_io_boundary = true;
+	} else {
+		raid_bdev->bdev.blockcnt = min_blockcnt;
+	}
+
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
 		base_info->data_size = min_blockcnt;
 	}
 
-	raid_bdev->bdev.blockcnt = min_blockcnt;
 	raid_bdev->module_private = r1info;
 
-	snprintf(name, sizeof(name), "raid1_%s", raid_bdev->bdev.name);
+	snprintf(name, sizeof(name), "raid%s_%s", r1info->num_mirror_sets > 1 ? "10" : "1",
+		 raid_bdev->bdev.name);
 	spdk_io_device_register(r1info, raid1_ioch_create, raid1_ioch_destroy,
-				sizeof(struct raid1_io_channel) + raid_bdev->num_base_bdevs * sizeof(uint64_t),
+				sizeof(struct raid1_io_channel) + raid_bdev->num_base_bdevs * sizeof(raid1_ch->base[0]),
 				name);
 
 	return 0;
 }
 
+static int
+raid1_start(struct raid_bdev *raid_bdev)
+{
+	return _raid1_start(raid_bdev, raid_bdev->num_base_bdevs);
+}
+
+static int
+raid10_start(struct raid_bdev *raid_bdev)
+{
+	if (raid_bdev->num_base_bdevs % RAID10_MIRROR_COPIES != 0) {
+		SPDK_ERRLOG("raid10 requires a multiple of %u base bdevs\n", RAID10_MIRROR_COPIES);
+		return -EINVAL;
+	}
+
+	return _raid1_start(raid_bdev, RAID10_MIRROR_COPIES);
+}
+
 static bool
 raid1_stop(struct raid_bdev *raid_bdev)
 {
@@ -452,7 +612,7 @@ raid1_process_submit_write(struct raid_bdev_process_request *process_req)
 	raid1_init_ext_io_opts(&io_opts, raid_io);
 	ret = raid_bdev_writev_blocks_ext(process_req->target, process_req->target_ch,
 					  raid_io->iovs, raid_io->iovcnt,
-					  raid_io->offset_blocks, raid_io->num_blocks,
+					  raid1_io_base_offset(raid_io), raid_io->num_blocks,
 					  raid1_process_write_completed, process_req, &io_opts);
 	if (spdk_unlikely(ret != 0)) {
 		if (ret == -ENOMEM) {
@@ -488,6 +648,7 @@ raid1_submit_process_request(struct raid_bdev_process_request *process_req,
 	raid_bdev_io_init(raid_io, raid_ch, SPDK_BDEV_IO_TYPE_READ,
 			  process_req->offset_blocks, process_req->num_blocks,
 			  &process_req->iov, 1, process_req->md_buf, NULL, NULL);
+	raid_io->priority = SPDK_BDEV_IO_PRIORITY_LOW;
 	raid_io->completion_cb = raid1_process_read_completed;
 
 	ret = raid1_submit_read_request(raid_io);
@@ -500,6 +661,64 @@ raid1_submit_process_request(struct raid_bdev_process_request *process_req,
 	}
 }
 
+static void
+raid10_process_request_skip_done(void *ctx)
+{
+	struct raid_bdev_process_request *process_req = ctx;
+
+	raid_bdev_process_request_complete(process_req, 0);
+}
+
+/*
+ * Each row of strips holds one strip of the target's mirror set. A process request covers
+ * the raid bdev blocks up to the end of the next such strip and only that strip is rebuilt.
+ */
+static int
+raid10_submit_process_request(struct raid_bdev_process_request *process_req,
+			      struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid_bdev_io *raid_io = &process_req->raid_io;
+	struct raid_bdev *raid_bdev = process_req->target->raid_bdev;
+	struct raid1_info *r1info = raid_bdev->module_private;
+	uint64_t row_blocks, target_start, start, end;
+	uint8_t mirror_set;
+	int ret;
+
+	row_blocks = raid_bdev->strip_size * r1info->num_mirror_sets;
+	mirror_set = raid_bdev_base_bdev_slot(process_req->target) / r1info->mirror_copies;
+
+	target_start = process_req->offset_blocks - process_req->offset_blocks % row_blocks +
+		       mirror_set * raid_bdev->strip_size;
+	if (process_req->offset_blocks >= target_start + raid_bdev->strip_size) {
+		target_start += row_blocks;
+	}
+
+	start = spdk_max(process_req->offset_blocks, target_start);
+	end = spdk_min(target_start + raid_bdev->strip_size,
+		       process_req->offset_blocks + process_req->num_blocks);
+	if (start >= end) {
+		/* The window ends before the target's strip, there is nothing to rebuild */
+		spdk_thread_send_msg(spdk_get_thread(), raid10_process_request_skip_done, process_req);
+		return process_req->num_blocks;
+	}
+
+	process_req->iov.iov_len = (end - start) * raid_bdev->bdev.blocklen;
+
+	raid_bdev_io_init(raid_io, raid_ch, SPDK_BDEV_IO_TYPE_READ, start, end - start,
+			  &process_req->iov, 1, process_req->md_buf, NULL, NULL);
+	raid_io->priority = SPDK_BDEV_IO_PRIORITY_LOW;
+	raid_io->completion_cb = raid1_process_read_completed;
+
+	ret = raid1_submit_read_request(raid_io);
+	if (spdk_likely(ret == 0)) {
+		return end - process_req->offset_blocks;
+	} else if (ret < 0) {
+		return ret;
+	} else {
+		return -EINVAL;
+	}
+}
+
 static bool
 raid1_resize(struct raid_bdev *raid_bdev)
 {
@@ -547,4 +766,17 @@ static struct raid_bdev_module g_raid1_module = {
 };
 RAID_MODULE_REGISTER(&g_raid1_module)
 
+static struct raid_bdev_module g_raid10_module = {
+	.level = RAID10,
+	.base_bdevs_min = 4,
+	.base_bdevs_constraint = {CONSTRAINT_MAX_BASE_BDEVS_REMOVED, 1},
+	.memory_domains_supported = true,
+	.start = raid10_start,
+	.stop = raid1_stop,
+	.submit_rw_request = raid1_submit_rw_request,
+	.get_io_channel = raid1_get_io_channel,
+	.submit_process_request = raid10_submit_process_request,
+};
+RAID_MODULE_REGISTER(&g_raid10_module)
+
 SPDK_LOG_REGISTER_COMPONENT(bdev_raid1)
@@ -16,6 +16,12 @@
 /* Maximum concurrent full stripe writes per io channel */
 #define RAID5F_MAX_STRIPES 32
 
+/* Maximum concurrent partial stripe requests per io channel */
+#define RAID5F_MAX_PARTIAL_STRIPES 16
+
+/* Number of hash buckets used for serializing writes to the same stripe */
+#define RAID5F_STRIPE_LOCK_BUCKETS 256
+
 struct chunk {
 	/* Corresponds to base_bdev index */
 	uint8_t index;
@@ -31,6 +37,18 @@ struct chunk {
 
 	/* Pointer to buffer with I/O metadata */
 	void *md_buf;
+
+	/* Blocks of the chunk accessed by a partial stripe request, relative to the strip start */
+	uint64_t req_offset;
+	uint64_t req_blocks;
+
+	/* The part of iovs that maps the raid_io data for a partial stripe request */
+	int req_iov_idx;
+	int req_iovcnt;
+
+	/* Iovecs receiving the chunk's current data when a partial stripe request reads it */
+	struct iovec *read_iovs;
+	int read_iovcnt;
 };
 
 struct stripe_request;
@@ -40,6 +58,7 @@ struct stripe_request {
 	enum stripe_request_type {
 		STRIPE_REQ_WRITE,
 		STRIPE_REQ_RECONSTRUCT,
+		STRIPE_REQ_PARTIAL,
 	} type;
 
 	struct raid5f_io_channel *r5ch;
@@ -75,6 +94,53 @@ struct stripe_request {
 			/* Offset from chunk start */
 			uint64_t chunk_offset;
 		} reconstruct;
+
+		struct {
+			enum raid5f_partial_mode {
+				/* Read spanning multiple chunks */
+				STRIPE_PARTIAL_READ,
+				/* Read spanning multiple chunks, one of them reconstructed from parity */
+				STRIPE_PARTIAL_READ_DEGRADED,
+				/* Write without updating parity, the parity chunk is missing */
+				STRIPE_PARTIAL_WRITE_NO_PARITY,
+				/* Read-modify-write: read old data of the written chunks and old parity */
+				STRIPE_PARTIAL_WRITE_RMW,
+				/* Reconstruct-write: read the data not being written, recalculate parity */
+				STRIPE_PARTIAL_WRITE_RCW,
+				/* Reconstruct-write with a written chunk missing, rebuild its data first */
+				STRIPE_PARTIAL_WRITE_RCW_DEGRADED,
+			} mode;
+
+			/* Part of the strip covered by all of the accessed chunks' ranges */
+			uint64_t offset;
+			uint64_t blocks;
+
+			/* Set once the chunk reads are done and the chunk writes started */
+			bool writing;
+
+			/* Status of the chunk reads */
+			enum spdk_bdev_io_status read_status;
+
+			/* For STRIPE_PARTIAL_WRITE_RCW_DEGRADED, set once the missing data is rebuilt */
+			bool reconstructed;
+
+			/* Accessed chunk that is missing from the array, if any */
+			struct chunk *degraded_chunk;
+
+			/* Buffers for the new stripe parity */
+			void *parity_buf;
+			void *parity_md_buf;
+
+			/* Arrays of buffers for reading chunk data and metadata */
+			void **chunk_buffers;
+			void **chunk_md_buffers;
+
+			/* Array of buffers for building new chunk metadata */
+			void **chunk_new_md_buffers;
+
+			/* Array of iovecs describing chunk_buffers */
+			struct iovec *chunk_buffer_iovs;
+		} partial;
 	};
 
 	/* Array of iovec iterators for each chunk */
@@ -90,6 +156,7 @@ struct stripe_request {
 		size_t len;
 		size_t remaining;
 		size_t remaining_md;
+		uint16_t n_src;
 		int status;
 		stripe_req_xor_cb cb;
 	} xor;
@@ -115,6 +182,16 @@ struct raid5f_info {
 
 	/* block length bit shift for optimized calculation, only valid when no interleaved md */
 	uint32_t blocklen_shift;
+
+	/*
+	 * Writes to the same stripe are serialized with these to keep the parity consistent.
+	 * A stripe's lock is owned by its bucket and shared by all io channels.
+	 */
+	pthread_spinlock_t stripe_locks_lock;
+	struct raid5f_stripe_lock {
+		bool locked;
+		TAILQ_HEAD(, spdk_bdev_io_wait_entry) waiters;
+	} stripe_locks[RAID5F_STRIPE_LOCK_BUCKETS];
 };
 
 struct raid5f_io_channel {
@@ -122,6 +199,7 @@ struct raid5f_io_channel {
 	struct {
 		TAILQ_HEAD(, stripe_request) write;
 		TAILQ_HEAD(, stripe_request) reconstruct;
+		TAILQ_HEAD(, stripe_request) partial;
 	} free_stripe_requests;
 
 	/* accel_fw channel */
@@ -176,6 +254,13 @@ raid5f_stripe_parity_chunk_index(const struct raid_bdev *raid_bdev, uint64_t str
 	return raid5f_stripe_data_chunks_num(raid_bdev) - stripe_index % raid_bdev->num_base_bdevs;
 }
 
+/* Maximum number of xor sources, used by read-modify-write of all data chunks */
+static inline uint16_t
+raid5f_max_xor_src(const struct raid_bdev *raid_bdev)
+{
+	return 2 * raid5f_stripe_data_chunks_num(raid_bdev) + 1;
+}
+
 static inline void
 raid5f_stripe_request_release(struct stripe_request *stripe_req)
 {
@@ -183,11 +268,65 @@ raid5f_stripe_request_release(struct stripe_request *stripe_req)
 		TAILQ_INSERT_HEAD(&stripe_req->r5ch->free_stripe_requests.write, stripe_req, link);
 	} else if (stripe_req->type == STRIPE_REQ_RECONSTRUCT) {
 		TAILQ_INSERT_HEAD(&stripe_req->r5ch->free_stripe_requests.reconstruct, stripe_req, link);
+	} else if (stripe_req->type == STRIPE_REQ_PARTIAL) {
+		TAILQ_INSERT_HEAD(&stripe_req->r5ch->free_stripe_requests.partial, stripe_req, link);
 	} else {
 		assert(false);
 	}
 }
 
+static void raid5f_stripe_lock_acquired(void *_raid_io);
+
+static bool
+raid5f_stripe_lock(struct raid5f_info *r5f_info, struct raid_bdev_io *raid_io, uint64_t stripe_index)
+{
+	struct raid5f_stripe_lock *lock = &r5f_info->stripe_locks[stripe_index %
+					  RAID5F_STRIPE_LOCK_BUCKETS];
+	bool locked;
+
+	pthread_spin_lock(&r5f_info->stripe_locks_lock);
+	locked = !lock->locked;
+	if (locked) {
+		lock->locked = true;
+	} else {
+		raid_io->waitq_entry.cb_fn = raid5f_stripe_lock_acquired;
+		raid_io->waitq_entry.cb_arg = raid_io;
+		TAILQ_INSERT_TAIL(&lock->waiters, &raid_io->waitq_entry, link);
+	}
+	pthread_spin_unlock(&r5f_info->stripe_locks_lock);
+
+	return locked;
+}
+
+static void
+raid5f_stripe_unlock(struct raid5f_info *r5f_info, uint64_t stripe_index)
+{
+	struct raid5f_stripe_lock *lock = &r5f_info->stripe_locks[stripe_index %
+					  RAID5F_STRIPE_LOCK_BUCKETS];
+	struct spdk_bdev_io_wait_entry *waiter;
+	struct raid_bdev_io *raid_io;
+	int rc;
+
+	pthread_spin_lock(&r5f_info->stripe_locks_lock);
+	assert(lock->locked);
+	waiter = TAILQ_FIRST(&lock->waiters);
+	if (waiter != NULL) {
+		/* The lock is handed over to the first waiter */
+		TAILQ_REMOVE(&lock->waiters, waiter, link);
+	} else {
+		lock->locked = false;
+	}
+	pthread_spin_unlock(&r5f_info->stripe_locks_lock);
+
+	if (waiter != NULL) {
+		raid_io = SPDK_CONTAINEROF(waiter, struct raid_bdev_io, waitq_entry);
+		rc = spdk_thread_send_msg(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(raid_io->raid_ch)),
+					  waiter->cb_fn, waiter->cb_arg);
+		assert(rc == 0);
+		(void)rc;
+	}
+}
+
 static void raid5f_xor_stripe_retry(struct stripe_request *stripe_req);
 
 static void
@@ -252,10 +391,8 @@ static void
 raid5f_xor_stripe_continue(struct stripe_request *stripe_req)
 {
 	struct raid5f_io_channel *r5ch = stripe_req->r5ch;
-	struct raid_bdev_io *raid_io = stripe_req->raid_io;
-	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
-	uint8_t n_src = raid5f_stripe_data_chunks_num(raid_bdev);
-	uint8_t i;
+	uint16_t n_src = stripe_req->xor.n_src;
+	uint16_t i;
 	int ret;
 
 	assert(stripe_req->xor.len > 0);
@@ -277,6 +414,21 @@ raid5f_xor_stripe_continue(struct stripe_request *stripe_req)
 	}
 }
 
+static void
+raid5f_xor_add_src(struct stripe_request *stripe_req, uint16_t *n_src, struct iovec *iovs,
+		   int iovcnt, void *md_buf)
+{
+	struct raid5f_io_channel *r5ch = stripe_req->r5ch;
+
+	r5ch->chunk_xor_iovs[*n_src] = iovs;
+	r5ch->chunk_xor_iovcnt[*n_src] = iovcnt;
+	stripe_req->chunk_xor_md_buffers[*n_src] = md_buf;
+	(*n_src)++;
+}
+
+static void raid5f_partial_xor_prepare(struct stripe_request *stripe_req, uint16_t *n_src,
+				       void **dest_md_buf);
+
 static void
 raid5f_xor_stripe(struct stripe_request *stripe_req, stripe_req_xor_cb cb)
 {
@@ -285,8 +437,9 @@ raid5f_xor_stripe(struct stripe_request *stripe_req, stripe_req_xor_cb cb)
 	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
 	struct chunk *chunk;
 	struct chunk *dest_chunk = NULL;
+	void *dest_md_buf = NULL;
 	uint64_t num_blocks = 0;
-	uint8_t c;
+	uint16_t n_src = 0;
 
 	assert(cb != NULL);
 
@@ -296,47 +449,42 @@ raid5f_xor_stripe(struct stripe_request *stripe_req, stripe_req_xor_cb cb)
 	} else if (stripe_req->type == STRIPE_REQ_RECONSTRUCT) {
 		num_blocks = raid_io->num_blocks;
 		dest_chunk = stripe_req->reconstruct.chunk;
+	} else if (stripe_req->type == STRIPE_REQ_PARTIAL) {
+		num_blocks = stripe_req->partial.blocks;
 	} else {
 		assert(false);
 	}
 
-	c = 0;
-	FOR_EACH_CHUNK(stripe_req, chunk) {
-		if (chunk == dest_chunk) {
-			continue;
+	if (stripe_req->type == STRIPE_REQ_PARTIAL) {
+		raid5f_partial_xor_prepare(stripe_req, &n_src, &dest_md_buf);
+	} else {
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			if (chunk != dest_chunk) {
+				raid5f_xor_add_src(stripe_req, &n_src, chunk->iovs, chunk->iovcnt, chunk->md_buf);
+			}
 		}
-		r5ch->chunk_xor_iovs[c] = chunk->iovs;
-		r5ch->chunk_xor_iovcnt[c] = chunk->iovcnt;
-		c++;
+		r5ch->chunk_xor_iovs[n_src] = dest_chunk->iovs;
+		r5ch->chunk_xor_iovcnt[n_src] = dest_chunk->iovcnt;
+		dest_md_buf = dest_chunk->md_buf;
 	}
-	r5ch->chunk_xor_iovs[c] = dest_chunk->iovs;
-	r5ch->chunk_xor_iovcnt[c] = dest_chunk->iovcnt;
 
 	stripe_req->xor.len = spdk_ioviter_firstv(stripe_req->chunk_iov_iters,
-			      raid_bdev->num_base_bdevs,
+			      n_src + 1,
 			      r5ch->chunk_xor_iovs,
 			      r5ch->chunk_xor_iovcnt,
 			      r5ch->chunk_xor_buffers);
 	stripe_req->xor.remaining = num_blocks * raid_bdev->bdev.blocklen;
+	stripe_req->xor.n_src = n_src;
 	stripe_req->xor.status = 0;
 	stripe_req->xor.cb = cb;
 
 	if (raid_io->md_buf != NULL) {
-		uint8_t n_src = raid5f_stripe_data_chunks_num(raid_bdev);
 		uint64_t len = num_blocks * raid_bdev->bdev.md_len;
 		int ret;
 
 		stripe_req->xor.remaining_md = len;
 
-		c = 0;
-		FOR_EACH_CHUNK(stripe_req, chunk) {
-			if (chunk != dest_chunk) {
-				stripe_req->chunk_xor_md_buffers[c] = chunk->md_buf;
-				c++;
-			}
-		}
-
-		ret = spdk_accel_submit_xor(stripe_req->r5ch->accel_ch, dest_chunk->md_buf,
+		ret = spdk_accel_submit_xor(stripe_req->r5ch->accel_ch, dest_md_buf,
 					    stripe_req->chunk_xor_md_buffers, n_src, len,
 					    raid5f_xor_stripe_md_cb, stripe_req);
 		if (spdk_unlikely(ret)) {
@@ -364,14 +512,27 @@ raid5f_xor_stripe_retry(struct stripe_request *stripe_req)
 }
 
 static void
-raid5f_stripe_request_chunk_write_complete(struct stripe_request *stripe_req,
+raid5f_stripe_request_write_complete_part(struct stripe_request *stripe_req, uint64_t completed,
 		enum spdk_bdev_io_status status)
 {
-	if (raid_bdev_io_complete_part(stripe_req->raid_io, 1, status)) {
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+
+	if (raid_io->base_bdev_io_remaining == completed) {
+		raid5f_stripe_unlock(raid_io->raid_bdev->module_private, stripe_req->stripe_index);
+	}
+
+	if (raid_bdev_io_complete_part(raid_io, completed, status)) {
 		raid5f_stripe_request_release(stripe_req);
 	}
 }
 
+static void
+raid5f_stripe_request_chunk_write_complete(struct stripe_request *stripe_req,
+		enum spdk_bdev_io_status status)
+{
+	raid5f_stripe_request_write_complete_part(stripe_req, 1, status);
+}
+
 static void
 raid5f_stripe_request_chunk_read_complete(struct stripe_request *stripe_req,
 		enum spdk_bdev_io_status status)
@@ -381,6 +542,31 @@ raid5f_stripe_request_chunk_read_complete(struct stripe_request *stripe_req,
 	raid_bdev_io_complete_part(raid_io, 1, status);
 }
 
+static void raid5f_partial_reads_done(struct stripe_request *stripe_req);
+
+static void
+raid5f_stripe_request_partial_complete_part(struct stripe_request *stripe_req, uint64_t completed,
+		enum spdk_bdev_io_status status)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+
+	if (stripe_req->partial.writing) {
+		raid5f_stripe_request_write_complete_part(stripe_req, completed, status);
+		return;
+	}
+
+	assert(raid_io->base_bdev_io_remaining >= completed);
+	raid_io->base_bdev_io_remaining -= completed;
+
+	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		stripe_req->partial.read_status = status;
+	}
+
+	if (raid_io->base_bdev_io_remaining == 0) {
+		raid5f_partial_reads_done(stripe_req);
+	}
+}
+
 static void
 raid5f_chunk_complete_bdev_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
@@ -395,6 +581,8 @@ raid5f_chunk_complete_bdev_io(struct spdk_bdev_io *bdev_io, bool success, void *
 		raid5f_stripe_request_chunk_write_complete(stripe_req, status);
 	} else if (stripe_req->type == STRIPE_REQ_RECONSTRUCT) {
 		raid5f_stripe_request_chunk_read_complete(stripe_req, status);
+	} else if (stripe_req->type == STRIPE_REQ_PARTIAL) {
+		raid5f_stripe_request_partial_complete_part(stripe_req, 1, status);
 	} else {
 		assert(false);
 	}
@@ -419,6 +607,7 @@ raid5f_init_ext_io_opts(struct spdk_bdev_ext_io_opts *opts, struct raid_bdev_io
 	opts->memory_domain = raid_io->memory_domain;
 	opts->memory_domain_ctx = raid_io->memory_domain_ctx;
 	opts->metadata = raid_io->md_buf;
+	opts->priority = raid_io->priority;
 }
 
 static int
@@ -442,7 +631,7 @@ raid5f_chunk_submit(struct chunk *chunk)
 	switch (stripe_req->type) {
 	case STRIPE_REQ_WRITE:
 		if (base_ch == NULL) {
-			raid_bdev_io_complete_part(raid_io, 1, SPDK_BDEV_IO_STATUS_SUCCESS);
+			raid5f_stripe_request_write_complete_part(stripe_req, 1, SPDK_BDEV_IO_STATUS_SUCCESS);
 			return 0;
 		}
 
@@ -462,6 +651,32 @@ raid5f_chunk_submit(struct chunk *chunk)
 						 base_offset_blocks, raid_io->num_blocks,
 						 raid5f_chunk_complete_bdev_io, chunk, &io_opts);
 		break;
+	case STRIPE_REQ_PARTIAL:
+		if (base_ch == NULL || (stripe_req->partial.writing ? chunk->req_blocks == 0 :
+					chunk->read_iovcnt == 0)) {
+			raid5f_stripe_request_partial_complete_part(stripe_req, 1, SPDK_BDEV_IO_STATUS_SUCCESS);
+			return 0;
+		}
+
+		if (stripe_req->partial.writing) {
+			ret = raid_bdev_writev_blocks_ext(base_info, base_ch, &chunk->iovs[chunk->req_iov_idx],
+							  chunk->req_iovcnt, base_offset_blocks + chunk->req_offset,
+							  chunk->req_blocks, raid5f_chunk_complete_bdev_io, chunk,
+							  &io_opts);
+		} else if (stripe_req->partial.mode == STRIPE_PARTIAL_READ) {
+			ret = raid_bdev_readv_blocks_ext(base_info, base_ch, chunk->read_iovs, chunk->read_iovcnt,
+							 base_offset_blocks + chunk->req_offset, chunk->req_blocks,
+							 raid5f_chunk_complete_bdev_io, chunk, &io_opts);
+		} else {
+			if (raid_io->md_buf != NULL) {
+				io_opts.metadata = stripe_req->partial.chunk_md_buffers[chunk->index];
+			}
+			ret = raid_bdev_readv_blocks_ext(base_info, base_ch, chunk->read_iovs, chunk->read_iovcnt,
+							 base_offset_blocks + stripe_req->partial.offset,
+							 stripe_req->partial.blocks,
+							 raid5f_chunk_complete_bdev_io, chunk, &io_opts);
+		}
+		break;
 	default:
 		assert(false);
 		ret = -EINVAL;
@@ -481,7 +696,7 @@ raid5f_chunk_submit(struct chunk *chunk)
 			 */
 			uint64_t base_bdev_io_not_submitted;
 
-			if (stripe_req->type == STRIPE_REQ_WRITE) {
+			if (stripe_req->type != STRIPE_REQ_RECONSTRUCT) {
 				base_bdev_io_not_submitted = raid_bdev->num_base_bdevs -
 							     raid_io->base_bdev_io_submitted;
 			} else {
@@ -489,8 +704,14 @@ raid5f_chunk_submit(struct chunk *chunk)
 							     raid_io->base_bdev_io_submitted;
 			}
 
-			if (raid_bdev_io_complete_part(raid_io, base_bdev_io_not_submitted,
-						       SPDK_BDEV_IO_STATUS_FAILED)) {
+			if (stripe_req->type == STRIPE_REQ_WRITE) {
+				raid5f_stripe_request_write_complete_part(stripe_req, base_bdev_io_not_submitted,
+						SPDK_BDEV_IO_STATUS_FAILED);
+			} else if (stripe_req->type == STRIPE_REQ_PARTIAL) {
+				raid5f_stripe_request_partial_complete_part(stripe_req, base_bdev_io_not_submitted,
+						SPDK_BDEV_IO_STATUS_FAILED);
+			} else if (raid_bdev_io_complete_part(raid_io, base_bdev_io_not_submitted,
+							      SPDK_BDEV_IO_STATUS_FAILED)) {
 				raid5f_stripe_request_release(stripe_req);
 			}
 		}
@@ -614,6 +835,7 @@ raid5f_stripe_write_request_xor_done(struct stripe_request *stripe_req, int stat
 	struct raid_bdev_io *raid_io = stripe_req->raid_io;
 
 	if (status != 0) {
+		raid5f_stripe_unlock(raid_io->raid_bdev->module_private, stripe_req->stripe_index);
 		raid5f_stripe_request_release(stripe_req);
 		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
 	} else {
@@ -655,6 +877,472 @@ raid5f_submit_write_request(struct raid_bdev_io *raid_io, uint64_t stripe_index)
 	return 0;
 }
 
+static void
+raid5f_partial_request_done(struct stripe_request *stripe_req, enum spdk_bdev_io_status status)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+
+	if (raid_io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+		raid5f_stripe_unlock(raid_io->raid_bdev->module_private, stripe_req->stripe_index);
+	}
+
+	raid5f_stripe_request_release(stripe_req);
+
+	raid_bdev_io_complete(raid_io, status);
+}
+
+static void
+raid5f_partial_submit_writes(struct stripe_request *stripe_req)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+
+	stripe_req->partial.writing = true;
+
+	raid_io->base_bdev_io_remaining = raid_io->raid_bdev->num_base_bdevs;
+	raid_io->base_bdev_io_submitted = 0;
+
+	raid5f_stripe_request_submit_chunks(stripe_req);
+}
+
+static void
+raid5f_partial_copy_md(struct stripe_request *stripe_req)
+{
+	struct raid_bdev *raid_bdev = stripe_req->raid_io->raid_bdev;
+	uint32_t md_len = raid_bdev->bdev.md_len;
+	struct chunk *chunk;
+
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		if (chunk->req_blocks != 0) {
+			memcpy(chunk->md_buf, stripe_req->partial.chunk_md_buffers[chunk->index] +
+			       (chunk->req_offset - stripe_req->partial.offset) * md_len,
+			       chunk->req_blocks * md_len);
+		}
+	}
+}
+
+static void
+raid5f_partial_xor_done(struct stripe_request *stripe_req, int status)
+{
+	if (status != 0) {
+		raid5f_partial_request_done(stripe_req, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	switch (stripe_req->partial.mode) {
+	case STRIPE_PARTIAL_READ_DEGRADED:
+		if (stripe_req->raid_io->md_buf != NULL) {
+			raid5f_partial_copy_md(stripe_req);
+		}
+		raid5f_partial_request_done(stripe_req, SPDK_BDEV_IO_STATUS_SUCCESS);
+		break;
+	case STRIPE_PARTIAL_WRITE_RCW_DEGRADED:
+		if (!stripe_req->partial.reconstructed) {
+			/* The missing chunk's old data is rebuilt, now calculate the new parity */
+			stripe_req->partial.reconstructed = true;
+			raid5f_xor_stripe(stripe_req, raid5f_partial_xor_done);
+			break;
+		}
+	/* fallthrough */
+	case STRIPE_PARTIAL_WRITE_RMW:
+	case STRIPE_PARTIAL_WRITE_RCW:
+		raid5f_partial_submit_writes(stripe_req);
+		break;
+	default:
+		assert(false);
+		raid5f_partial_request_done(stripe_req, SPDK_BDEV_IO_STATUS_FAILED);
+		break;
+	}
+}
+
+static void
+raid5f_partial_reads_done(struct stripe_request *stripe_req)
+{
+	if (stripe_req->partial.read_status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		raid5f_partial_request_done(stripe_req, stripe_req->partial.read_status);
+		return;
+	}
+
+	if (stripe_req->partial.mode == STRIPE_PARTIAL_READ) {
+		raid5f_partial_request_done(stripe_req, SPDK_BDEV_IO_STATUS_SUCCESS);
+	} else {
+		raid5f_xor_stripe(stripe_req, raid5f_partial_xor_done);
+	}
+}
+
+/* Returns the chunk's buffer from an optional per-chunk array of buffers */
+static inline void *
+raid5f_chunk_buf(void **buffers, struct chunk *chunk)
+{
+	return buffers != NULL ? buffers[chunk->index] : NULL;
+}
+
+static void
+raid5f_partial_xor_prepare(struct stripe_request *stripe_req, uint16_t *n_src, void **dest_md_buf)
+{
+	struct raid5f_io_channel *r5ch = stripe_req->r5ch;
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	uint32_t md_len = raid_io->raid_bdev->bdev.md_len;
+	void **md_buffers = stripe_req->partial.chunk_md_buffers;
+	void **new_md_buffers = stripe_req->partial.chunk_new_md_buffers;
+	struct chunk *dest_chunk;
+	struct chunk *chunk;
+
+	if (stripe_req->partial.mode == STRIPE_PARTIAL_READ_DEGRADED ||
+	    (stripe_req->partial.mode == STRIPE_PARTIAL_WRITE_RCW_DEGRADED &&
+	     !stripe_req->partial.reconstructed)) {
+		/* Rebuild the missing chunk's data from all the other chunks */
+		dest_chunk = stripe_req->partial.degraded_chunk;
+
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			if (chunk != dest_chunk) {
+				raid5f_xor_add_src(stripe_req, n_src, chunk->read_iovs, chunk->read_iovcnt,
+						   raid5f_chunk_buf(md_buffers, chunk));
+			}
+		}
+
+		if (stripe_req->partial.mode == STRIPE_PARTIAL_READ_DEGRADED) {
+			r5ch->chunk_xor_iovs[*n_src] = dest_chunk->iovs;
+			r5ch->chunk_xor_iovcnt[*n_src] = dest_chunk->iovcnt;
+		} else {
+			r5ch->chunk_xor_iovs[*n_src] = &stripe_req->partial.chunk_buffer_iovs[dest_chunk->index];
+			r5ch->chunk_xor_iovcnt[*n_src] = 1;
+		}
+		*dest_md_buf = raid5f_chunk_buf(md_buffers, dest_chunk);
+		return;
+	}
+
+	if (raid_io->md_buf != NULL) {
+		/* Build the complete new metadata of the written chunks in the parity range */
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			if (chunk->req_blocks == 0) {
+				continue;
+			}
+			if (chunk->req_blocks != stripe_req->partial.blocks) {
+				memcpy(new_md_buffers[chunk->index], md_buffers[chunk->index],
+				       stripe_req->partial.blocks * md_len);
+			}
+			memcpy(new_md_buffers[chunk->index] +
+			       (chunk->req_offset - stripe_req->partial.offset) * md_len,
+			       chunk->md_buf, chunk->req_blocks * md_len);
+		}
+	}
+
+	if (stripe_req->partial.mode == STRIPE_PARTIAL_WRITE_RMW) {
+		/* new parity = old parity ^ old data ^ new data */
+		chunk = stripe_req->parity_chunk;
+		raid5f_xor_add_src(stripe_req, n_src, &stripe_req->partial.chunk_buffer_iovs[chunk->index], 1,
+				   raid5f_chunk_buf(md_buffers, chunk));
+
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			if (chunk->req_blocks != 0) {
+				raid5f_xor_add_src(stripe_req, n_src, chunk->read_iovs, chunk->read_iovcnt,
+						   raid5f_chunk_buf(md_buffers, chunk));
+				raid5f_xor_add_src(stripe_req, n_src, chunk->iovs, chunk->iovcnt,
+						   raid5f_chunk_buf(new_md_buffers, chunk));
+			}
+		}
+	} else {
+		/* new parity = new data ^ data not being written */
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			if (chunk->req_blocks != 0) {
+				raid5f_xor_add_src(stripe_req, n_src, chunk->iovs, chunk->iovcnt,
+						   raid5f_chunk_buf(new_md_buffers, chunk));
+			} else {
+				raid5f_xor_add_src(stripe_req, n_src, chunk->read_iovs, chunk->read_iovcnt,
+						   raid5f_chunk_buf(md_buffers, chunk));
+			}
+		}
+	}
+
+	dest_chunk = stripe_req->parity_chunk;
+	r5ch->chunk_xor_iovs[*n_src] = dest_chunk->iovs;
+	r5ch->chunk_xor_iovcnt[*n_src] = dest_chunk->iovcnt;
+	*dest_md_buf = stripe_req->partial.parity_md_buf;
+}
+
+/*
+ * Maps the raid_io data accessed in the chunk to chunk->iovs. If overlay is set, the rest of the
+ * request's range in the strip is mapped to the chunk's buffer, so that chunk->iovs describe the
+ * whole (new) content of the chunk in that range.
+ */
+static int
+raid5f_partial_map_chunk(struct stripe_request *stripe_req, struct chunk *chunk, bool overlay,
+			 int *raid_io_iov_idx, size_t *raid_io_iov_offset, size_t *raid_io_offset)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	uint32_t blocklen = raid_io->raid_bdev->bdev.blocklen;
+	void *buf = stripe_req->partial.chunk_buffers[chunk->index];
+	uint64_t len = chunk->req_blocks * blocklen;
+	size_t off = *raid_io_iov_offset;
+	size_t prefix = 0;
+	size_t suffix = 0;
+	int chunk_iovcnt = 0;
+	int iov_idx = 0;
+	int i;
+	int ret;
+
+	if (overlay) {
+		prefix = (chunk->req_offset - stripe_req->partial.offset) * blocklen;
+		suffix = (stripe_req->partial.offset + stripe_req->partial.blocks -
+			  chunk->req_offset - chunk->req_blocks) * blocklen;
+	}
+
+	for (i = *raid_io_iov_idx; i < raid_io->iovcnt; i++) {
+		chunk_iovcnt++;
+		off += raid_io->iovs[i].iov_len;
+		if (off >= *raid_io_offset + len) {
+			break;
+		}
+	}
+
+	ret = raid5f_chunk_set_iovcnt(chunk, chunk_iovcnt + (prefix != 0) + (suffix != 0));
+	if (ret) {
+		return ret;
+	}
+
+	if (prefix != 0) {
+		chunk->iovs[iov_idx].iov_base = buf;
+		chunk->iovs[iov_idx].iov_len = prefix;
+		iov_idx++;
+	}
+
+	chunk->req_iov_idx = iov_idx;
+	chunk->req_iovcnt = chunk_iovcnt;
+
+	for (i = 0; i < chunk_iovcnt; i++) {
+		struct iovec *chunk_iov = &chunk->iovs[iov_idx++];
+		const struct iovec *raid_io_iov = &raid_io->iovs[*raid_io_iov_idx];
+		size_t chunk_iov_offset = *raid_io_offset - *raid_io_iov_offset;
+
+		chunk_iov->iov_base = raid_io_iov->iov_base + chunk_iov_offset;
+		chunk_iov->iov_len = spdk_min(len, raid_io_iov->iov_len - chunk_iov_offset);
+		*raid_io_offset += chunk_iov->iov_len;
+		len -= chunk_iov->iov_len;
+
+		if (*raid_io_offset >= *raid_io_iov_offset + raid_io_iov->iov_len) {
+			(*raid_io_iov_idx)++;
+			*raid_io_iov_offset += raid_io_iov->iov_len;
+		}
+	}
+
+	if (spdk_unlikely(len > 0)) {
+		return -EINVAL;
+	}
+
+	if (suffix != 0) {
+		chunk->iovs[iov_idx].iov_base = buf + prefix + chunk->req_blocks * blocklen;
+		chunk->iovs[iov_idx].iov_len = suffix;
+	}
+
+	return 0;
+}
+
+static enum raid5f_partial_mode
+raid5f_partial_write_mode(struct stripe_request *stripe_req, struct chunk *missing_chunk)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	uint8_t num_written = 0;
+	uint8_t num_partially_written = 0;
+	uint8_t rmw_reads, rcw_reads;
+	struct chunk *chunk;
+
+	if (raid_bdev_channel_get_base_channel(raid_io->raid_ch, stripe_req->parity_chunk->index) == NULL) {
+		return STRIPE_PARTIAL_WRITE_NO_PARITY;
+	}
+
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		if (chunk->req_blocks != 0) {
+			num_written++;
+			if (chunk->req_blocks != stripe_req->partial.blocks) {
+				num_partially_written++;
+			}
+		}
+	}
+
+	if (missing_chunk != NULL) {
+		if (missing_chunk->req_blocks == 0) {
+			/* The missing chunk's data is not needed to update the parity */
+			return STRIPE_PARTIAL_WRITE_RMW;
+		} else if (missing_chunk->req_blocks == stripe_req->partial.blocks) {
+			/* The missing chunk's new data is all that is needed */
+			return STRIPE_PARTIAL_WRITE_RCW;
+		} else {
+			return STRIPE_PARTIAL_WRITE_RCW_DEGRADED;
+		}
+	}
+
+	/*
+	 * Choose the method requiring fewer chunk reads. Read-modify-write reads the written chunks
+	 * and the parity, reconstruct-write reads the chunks not being written and the written chunks
+	 * whose old data is needed to fill the range covered by the parity update. Reconstruct-write
+	 * also has fewer xor sources, so it is preferred when the number of reads is equal.
+	 */
+	rmw_reads = num_written + 1;
+	rcw_reads = raid5f_stripe_data_chunks_num(raid_bdev) - num_written + num_partially_written;
+
+	return rmw_reads < rcw_reads ? STRIPE_PARTIAL_WRITE_RMW : STRIPE_PARTIAL_WRITE_RCW;
+}
+
+static bool
+raid5f_partial_chunk_needs_read(struct stripe_request *stripe_req, struct chunk *chunk)
+{
+	bool is_parity = chunk == stripe_req->parity_chunk;
+	bool is_written = !is_parity && chunk->req_blocks != 0;
+
+	switch (stripe_req->partial.mode) {
+	case STRIPE_PARTIAL_READ:
+		return is_written;
+	case STRIPE_PARTIAL_READ_DEGRADED:
+	case STRIPE_PARTIAL_WRITE_RCW_DEGRADED:
+		return true;
+	case STRIPE_PARTIAL_WRITE_RMW:
+		return is_parity || is_written;
+	case STRIPE_PARTIAL_WRITE_RCW:
+		return !is_parity && (!is_written || chunk->req_blocks != stripe_req->partial.blocks);
+	default:
+		return false;
+	}
+}
+
+/*
+ * Submits a request accessing only a part of a stripe: a read spanning multiple chunks or a write
+ * that is not a full stripe write.
+ */
+static int
+raid5f_submit_partial_request(struct raid_bdev_io *raid_io, uint64_t stripe_index,
+			      uint64_t stripe_offset)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_io_channel *r5ch = raid_bdev_channel_get_module_ctx(raid_io->raid_ch);
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	uint64_t req_end = stripe_offset + raid_io->num_blocks;
+	uint64_t range_start = UINT64_MAX;
+	uint64_t range_end = 0;
+	uint64_t chunk_start = 0;
+	struct chunk *missing_chunk = NULL;
+	struct stripe_request *stripe_req;
+	struct chunk *chunk;
+	int raid_io_iov_idx = 0;
+	size_t raid_io_iov_offset = 0;
+	size_t raid_io_offset = 0;
+	int ret;
+
+	stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests.partial);
+	if (!stripe_req) {
+		return -ENOMEM;
+	}
+
+	raid5f_stripe_request_init(stripe_req, raid_io, stripe_index);
+
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		uint64_t start = spdk_max(stripe_offset, chunk_start);
+		uint64_t end = spdk_min(req_end, chunk_start + raid_bdev->strip_size);
+
+		if (start < end) {
+			chunk->req_offset = start - chunk_start;
+			chunk->req_blocks = end - start;
+			range_start = spdk_min(range_start, chunk->req_offset);
+			range_end = spdk_max(range_end, chunk->req_offset + chunk->req_blocks);
+		} else {
+			chunk->req_offset = 0;
+			chunk->req_blocks = 0;
+		}
+
+		if (raid_bdev_channel_get_base_channel(raid_io->raid_ch, chunk->index) == NULL) {
+			missing_chunk = chunk;
+		}
+
+		chunk_start += raid_bdev->strip_size;
+	}
+
+	stripe_req->partial.offset = range_start;
+	stripe_req->partial.blocks = range_end - range_start;
+	stripe_req->partial.writing = false;
+	stripe_req->partial.reconstructed = false;
+	stripe_req->partial.read_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+	stripe_req->partial.degraded_chunk = NULL;
+
+	if (raid_io->type == SPDK_BDEV_IO_TYPE_READ) {
+		if (missing_chunk != NULL && missing_chunk->req_blocks != 0) {
+			stripe_req->partial.mode = STRIPE_PARTIAL_READ_DEGRADED;
+		} else {
+			stripe_req->partial.mode = STRIPE_PARTIAL_READ;
+		}
+	} else {
+		stripe_req->partial.mode = raid5f_partial_write_mode(stripe_req, missing_chunk);
+	}
+
+	if (stripe_req->partial.mode == STRIPE_PARTIAL_READ_DEGRADED ||
+	    stripe_req->partial.mode == STRIPE_PARTIAL_WRITE_RCW_DEGRADED) {
+		stripe_req->partial.degraded_chunk = missing_chunk;
+	}
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		struct iovec *buf_iov = &stripe_req->partial.chunk_buffer_iovs[chunk->index];
+
+		buf_iov->iov_base = stripe_req->partial.chunk_buffers[chunk->index];
+		buf_iov->iov_len = stripe_req->partial.blocks * blocklen;
+
+		if (chunk == stripe_req->parity_chunk) {
+			chunk->iovs[0].iov_base = stripe_req->partial.parity_buf;
+			chunk->iovs[0].iov_len = stripe_req->partial.blocks * blocklen;
+			chunk->iovcnt = 1;
+			chunk->req_iov_idx = 0;
+			chunk->req_iovcnt = 1;
+			chunk->req_offset = stripe_req->partial.offset;
+			chunk->req_blocks = stripe_req->partial.blocks;
+			chunk->md_buf = stripe_req->partial.parity_md_buf;
+		} else if (chunk->req_blocks != 0) {
+			if (raid_io->md_buf != NULL) {
+				chunk->md_buf = raid_io->md_buf +
+						(raid_io_offset / blocklen) * raid_bdev->bdev.md_len;
+			} else {
+				chunk->md_buf = NULL;
+			}
+
+			ret = raid5f_partial_map_chunk(stripe_req, chunk,
+						       stripe_req->partial.mode != STRIPE_PARTIAL_READ,
+						       &raid_io_iov_idx, &raid_io_iov_offset, &raid_io_offset);
+			if (spdk_unlikely(ret)) {
+				return ret;
+			}
+		} else {
+			chunk->iovcnt = 0;
+			chunk->md_buf = NULL;
+		}
+
+		if (!raid5f_partial_chunk_needs_read(stripe_req, chunk)) {
+			chunk->read_iovs = NULL;
+			chunk->read_iovcnt = 0;
+		} else if (stripe_req->partial.mode == STRIPE_PARTIAL_READ) {
+			chunk->read_iovs = &chunk->iovs[chunk->req_iov_idx];
+			chunk->read_iovcnt = chunk->req_iovcnt;
+		} else if (stripe_req->partial.mode == STRIPE_PARTIAL_READ_DEGRADED &&
+			   chunk != stripe_req->parity_chunk && chunk->req_blocks != 0) {
+			/* Read the parts not requested to the chunk buffer, for rebuilding the missing data */
+			chunk->read_iovs = chunk->iovs;
+			chunk->read_iovcnt = chunk->iovcnt;
+		} else {
+			chunk->read_iovs = buf_iov;
+			chunk->read_iovcnt = 1;
+		}
+	}
+
+	TAILQ_REMOVE(&r5ch->free_stripe_requests.partial, stripe_req, link);
+
+	raid_io->module_private = stripe_req;
+	raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
+
+	if (stripe_req->partial.mode == STRIPE_PARTIAL_WRITE_NO_PARITY) {
+		raid5f_partial_submit_writes(stripe_req);
+	} else {
+		raid5f_stripe_request_submit_chunks(stripe_req);
+	}
+
+	return 0;
+}
+
 static void
 raid5f_chunk_read_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
@@ -801,6 +1489,36 @@ raid5f_submit_read_request(struct raid_bdev_io *raid_io, uint64_t stripe_index,
 	return ret;
 }
 
+static void
+raid5f_submit_write(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	uint64_t stripe_index = raid_io->offset_blocks / r5f_info->stripe_blocks;
+	uint64_t stripe_offset = raid_io->offset_blocks % r5f_info->stripe_blocks;
+	int ret;
+
+	if (stripe_offset == 0 && raid_io->num_blocks == r5f_info->stripe_blocks) {
+		ret = raid5f_submit_write_request(raid_io, stripe_index);
+	} else {
+		ret = raid5f_submit_partial_request(raid_io, stripe_index, stripe_offset);
+	}
+
+	if (spdk_unlikely(ret)) {
+		raid5f_stripe_unlock(r5f_info, stripe_index);
+		raid_bdev_io_complete(raid_io, ret == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+				      SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void
+raid5f_stripe_lock_acquired(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid5f_submit_write(raid_io);
+}
+
 static void
 raid5f_submit_rw_request(struct raid_bdev_io *raid_io)
 {
@@ -808,18 +1526,25 @@ raid5f_submit_rw_request(struct raid_bdev_io *raid_io)
 	struct raid5f_info *r5f_info = raid_bdev->module_private;
 	uint64_t stripe_index = raid_io->offset_blocks / r5f_info->stripe_blocks;
 	uint64_t stripe_offset = raid_io->offset_blocks % r5f_info->stripe_blocks;
+	uint64_t last_block = stripe_offset + raid_io->num_blocks - 1;
 	int ret;
 
+	assert(last_block < r5f_info->stripe_blocks);
+
 	switch (raid_io->type) {
 	case SPDK_BDEV_IO_TYPE_READ:
-		assert(raid_io->num_blocks <= raid_bdev->strip_size);
-		ret = raid5f_submit_read_request(raid_io, stripe_index, stripe_offset);
+		if ((stripe_offset >> raid_bdev->strip_size_shift) ==
+		    (last_block >> raid_bdev->strip_size_shift)) {
+			ret = raid5f_submit_read_request(raid_io, stripe_index, stripe_offset);
+		} else {
+			ret = raid5f_submit_partial_request(raid_io, stripe_index, stripe_offset);
+		}
 		break;
 	case SPDK_BDEV_IO_TYPE_WRITE:
-		assert(stripe_offset == 0);
-		assert(raid_io->num_blocks == r5f_info->stripe_blocks);
-		ret = raid5f_submit_write_request(raid_io, stripe_index);
-		break;
+		if (raid5f_stripe_lock(r5f_info, raid_io, stripe_index)) {
+			raid5f_submit_write(raid_io);
+		}
+		return;
 	default:
 		ret = -EINVAL;
 		break;
@@ -861,6 +1586,36 @@ raid5f_stripe_request_free(struct stripe_request *stripe_req)
 			}
 			free(stripe_req->reconstruct.chunk_md_buffers);
 		}
+	} else if (stripe_req->type == STRIPE_REQ_PARTIAL) {
+		struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(stripe_req->r5ch);
+		struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+		uint8_t i;
+
+		spdk_dma_free(stripe_req->partial.parity_buf);
+		spdk_dma_free(stripe_req->partial.parity_md_buf);
+
+		if (stripe_req->partial.chunk_buffers) {
+			for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+				spdk_dma_free(stripe_req->partial.chunk_buffers[i]);
+			}
+			free(stripe_req->partial.chunk_buffers);
+		}
+
+		if (stripe_req->partial.chunk_md_buffers) {
+			for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+				spdk_dma_free(stripe_req->partial.chunk_md_buffers[i]);
+			}
+			free(stripe_req->partial.chunk_md_buffers);
+		}
+
+		if (stripe_req->partial.chunk_new_md_buffers) {
+			for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+				spdk_dma_free(stripe_req->partial.chunk_new_md_buffers[i]);
+			}
+			free(stripe_req->partial.chunk_new_md_buffers);
+		}
+
+		free(stripe_req->partial.chunk_buffer_iovs);
 	} else {
 		assert(false);
 	}
@@ -881,6 +1636,7 @@ raid5f_stripe_request_alloc(struct raid5f_io_channel *r5ch, enum stripe_request_
 	struct stripe_request *stripe_req;
 	struct chunk *chunk;
 	size_t chunk_len;
+	uint16_t max_xor_src;
 
 	stripe_req = calloc(1, sizeof(*stripe_req) + sizeof(*chunk) * raid_bdev->num_base_bdevs);
 	if (!stripe_req) {
@@ -946,23 +1702,84 @@ raid5f_stripe_request_alloc(struct raid5f_io_channel *r5ch, enum stripe_request_
 				stripe_req->reconstruct.chunk_md_buffers[i] = buf;
 			}
 		}
+	} else if (type == STRIPE_REQ_PARTIAL) {
+		uint8_t n = raid_bdev->num_base_bdevs;
+		void *buf;
+		uint8_t i;
+
+		stripe_req->partial.parity_buf = spdk_dma_malloc(chunk_len, r5f_info->buf_alignment, NULL);
+		if (!stripe_req->partial.parity_buf) {
+			goto err;
+		}
+
+		stripe_req->partial.chunk_buffers = calloc(n, sizeof(void *));
+		if (!stripe_req->partial.chunk_buffers) {
+			goto err;
+		}
+
+		for (i = 0; i < n; i++) {
+			buf = spdk_dma_malloc(chunk_len, r5f_info->buf_alignment, NULL);
+			if (!buf) {
+				goto err;
+			}
+			stripe_req->partial.chunk_buffers[i] = buf;
+		}
+
+		stripe_req->partial.chunk_buffer_iovs = calloc(n, sizeof(struct iovec));
+		if (!stripe_req->partial.chunk_buffer_iovs) {
+			goto err;
+		}
+
+		if (raid_io_md_size != 0) {
+			stripe_req->partial.parity_md_buf = spdk_dma_malloc(raid_bdev->strip_size * raid_io_md_size,
+							    r5f_info->buf_alignment, NULL);
+			if (!stripe_req->partial.parity_md_buf) {
+				goto err;
+			}
+
+			stripe_req->partial.chunk_md_buffers = calloc(n, sizeof(void *));
+			if (!stripe_req->partial.chunk_md_buffers) {
+				goto err;
+			}
+
+			stripe_req->partial.chunk_new_md_buffers = calloc(n, sizeof(void *));
+			if (!stripe_req->partial.chunk_new_md_buffers) {
+				goto err;
+			}
+
+			for (i = 0; i < n; i++) {
+				buf = spdk_dma_malloc(raid_bdev->strip_size * raid_io_md_size, r5f_info->buf_alignment, NULL);
+				if (!buf) {
+					goto err;
+				}
+				stripe_req->partial.chunk_md_buffers[i] = buf;
+
+				buf = spdk_dma_malloc(raid_bdev->strip_size * raid_io_md_size, r5f_info->buf_alignment, NULL);
+				if (!buf) {
+					goto err;
+				}
+				stripe_req->partial.chunk_new_md_buffers[i] = buf;
+			}
+		}
 	} else {
 		assert(false);
 		return NULL;
 	}
 
-	stripe_req->chunk_iov_iters = malloc(SPDK_IOVITER_SIZE(raid_bdev->num_base_bdevs));
+	max_xor_src = type == STRIPE_REQ_PARTIAL ? raid5f_max_xor_src(raid_bdev) :
+		      raid5f_stripe_data_chunks_num(raid_bdev);
+
+	stripe_req->chunk_iov_iters = malloc(SPDK_IOVITER_SIZE(max_xor_src + 1));
 	if (!stripe_req->chunk_iov_iters) {
 		goto err;
 	}
 
-	stripe_req->chunk_xor_buffers = calloc(raid5f_stripe_data_chunks_num(raid_bdev),
-					       sizeof(stripe_req->chunk_xor_buffers[0]));
+	stripe_req->chunk_xor_buffers = calloc(max_xor_src, sizeof(stripe_req->chunk_xor_buffers[0]));
 	if (!stripe_req->chunk_xor_buffers) {
 		goto err;
 	}
 
-	stripe_req->chunk_xor_md_buffers = calloc(raid5f_stripe_data_chunks_num(raid_bdev),
+	stripe_req->chunk_xor_md_buffers = calloc(max_xor_src,
 					   sizeof(stripe_req->chunk_xor_md_buffers[0]));
 	if (!stripe_req->chunk_xor_md_buffers) {
 		goto err;
@@ -992,6 +1809,11 @@ raid5f_ioch_destroy(void *io_device, void *ctx_buf)
 		raid5f_stripe_request_free(stripe_req);
 	}
 
+	while ((stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests.partial))) {
+		TAILQ_REMOVE(&r5ch->free_stripe_requests.partial, stripe_req, link);
+		raid5f_stripe_request_free(stripe_req);
+	}
+
 	if (r5ch->accel_ch) {
 		spdk_put_io_channel(r5ch->accel_ch);
 	}
@@ -1012,6 +1834,7 @@ raid5f_ioch_create(void *io_device, void *ctx_buf)
 
 	TAILQ_INIT(&r5ch->free_stripe_requests.write);
 	TAILQ_INIT(&r5ch->free_stripe_requests.reconstruct);
+	TAILQ_INIT(&r5ch->free_stripe_requests.partial);
 	TAILQ_INIT(&r5ch->xor_retry_queue);
 
 	for (i = 0; i < RAID5F_MAX_STRIPES; i++) {
@@ -1032,23 +1855,34 @@ raid5f_ioch_create(void *io_device, void *ctx_buf)
 		TAILQ_INSERT_HEAD(&r5ch->free_stripe_requests.reconstruct, stripe_req, link);
 	}
 
+	for (i = 0; i < RAID5F_MAX_PARTIAL_STRIPES; i++) {
+		stripe_req = raid5f_stripe_request_alloc(r5ch, STRIPE_REQ_PARTIAL);
+		if (!stripe_req) {
+			goto err;
+		}
+
+		TAILQ_INSERT_HEAD(&r5ch->free_stripe_requests.partial, stripe_req, link);
+	}
+
 	r5ch->accel_ch = spdk_accel_get_io_channel();
 	if (!r5ch->accel_ch) {
 		SPDK_ERRLOG("Failed to get accel framework's IO channel\n");
 		goto err;
 	}
 
-	r5ch->chunk_xor_buffers = calloc(raid_bdev->num_base_bdevs, sizeof(*r5ch->chunk_xor_buffers));
+	r5ch->chunk_xor_buffers = calloc(raid5f_max_xor_src(raid_bdev) + 1,
+					 sizeof(*r5ch->chunk_xor_buffers));
 	if (!r5ch->chunk_xor_buffers) {
 		goto err;
 	}
 
-	r5ch->chunk_xor_iovs = calloc(raid_bdev->num_base_bdevs, sizeof(*r5ch->chunk_xor_iovs));
+	r5ch->chunk_xor_iovs = calloc(raid5f_max_xor_src(raid_bdev) + 1, sizeof(*r5ch->chunk_xor_iovs));
 	if (!r5ch->chunk_xor_iovs) {
 		goto err;
 	}
 
-	r5ch->chunk_xor_iovcnt = calloc(raid_bdev->num_base_bdevs, sizeof(*r5ch->chunk_xor_iovcnt));
+	r5ch->chunk_xor_iovcnt = calloc(raid5f_max_xor_src(raid_bdev) + 1,
+					sizeof(*r5ch->chunk_xor_iovcnt));
 	if (!r5ch->chunk_xor_iovcnt) {
 		goto err;
 	}
@@ -1069,6 +1903,7 @@ raid5f_start(struct raid_bdev *raid_bdev)
 	struct spdk_bdev *base_bdev;
 	struct raid5f_info *r5f_info;
 	size_t alignment = 0;
+	int i;
 
 	r5f_info = calloc(1, sizeof(*r5f_info));
 	if (!r5f_info) {
@@ -1077,6 +1912,11 @@ raid5f_start(struct raid_bdev *raid_bdev)
 	}
 	r5f_info->raid_bdev = raid_bdev;
 
+	pthread_spin_init(&r5f_info->stripe_locks_lock, PTHREAD_PROCESS_PRIVATE);
+	for (i = 0; i < RAID5F_STRIPE_LOCK_BUCKETS; i++) {
+		TAILQ_INIT(&r5f_info->stripe_locks[i].waiters);
+	}
+
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
 		min_blockcnt = spdk_min(min_blockcnt, base_info->data_size);
 		if (base_info->desc) {
@@ -1099,10 +1939,11 @@ raid5f_start(struct raid_bdev *raid_bdev)
 	}
 
 	raid_bdev->bdev.blockcnt = r5f_info->stripe_blocks * r5f_info->total_stripes;
-	raid_bdev->bdev.optimal_io_boundary = raid_bdev->strip_size;
+	raid_bdev->bdev.optimal_io_boundary = r5f_info->stripe_blocks;
 	raid_bdev->bdev.split_on_optimal_io_boundary = true;
+	/* Partial stripe writes are supported, full stripe writes are just more efficient */
 	raid_bdev->bdev.write_unit_size = r5f_info->stripe_blocks;
-	raid_bdev->bdev.split_on_write_unit = true;
+	raid_bdev->bdev.split_on_write_unit = false;
 
 	raid_bdev->module_private = r5f_info;
 
@@ -1119,6 +1960,7 @@ raid5f_io_device_unregister_done(void *io_device)
 
 	raid_bdev_module_stop_done(r5f_info->raid_bdev);
 
+	pthread_spin_destroy(&r5f_info->stripe_locks_lock);
 	free(r5f_info);
 }
 
@@ -1223,6 +2065,7 @@ raid5f_submit_process_request(struct raid_bdev_process_request *process_req,
 	raid_bdev_io_init(raid_io, raid_ch, SPDK_BDEV_IO_TYPE_READ,
 			  process_req->offset_blocks, raid_bdev->strip_size,
 			  &process_req->iov, 1, process_req->md_buf, NULL, NULL);
+	raid_io->priority = SPDK_BDEV_IO_PRIORITY_LOW;
 
 	ret = raid5f_submit_reconstruct_read(raid_io, stripe_index, chunk_idx, 0,
 					     raid5f_process_stripe_request_reconstruct_xor_done);
@@ -67,8 +67,22 @@ struct bdev_rbd_io_channel {
 	struct spdk_io_channel *group_ch;
 };
 
+/* Size of the per thread queue of I/Os completed by librbd */
+#define BDEV_RBD_COMPLETION_RING_SIZE 4096
+#define BDEV_RBD_MAX_COMPLETIONS_PER_POLL 64
+
+struct bdev_rbd_group_channel {
+	/* I/Os completed by librbd threads, to be completed on this thread */
+	struct spdk_ring	*completions;
+	/* eventfd signaled for the completions in interrupt mode, -1 in poll mode */
+	int			efd;
+	struct spdk_interrupt	*intr;
+	struct spdk_poller	*poller;
+};
+
 struct bdev_rbd_io {
 	struct			spdk_thread *submit_td;
+	struct			bdev_rbd_group_channel *group_ch;
 	enum			spdk_bdev_io_status status;
 	rbd_completion_t	comp;
 	size_t			total_len;
@@ -492,10 +506,21 @@ bdev_rbd_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status stat
 
 	rbd_io->status = status;
 	assert(rbd_io->submit_td != NULL);
-	if (rbd_io->submit_td != current_thread) {
-		spdk_thread_send_msg(rbd_io->submit_td, _bdev_rbd_io_complete, rbd_io);
-	} else {
+	if (rbd_io->submit_td == current_thread) {
 		_bdev_rbd_io_complete(rbd_io);
+		return;
+	}
+
+	/* Hand the I/O over to the poller of the submitting thread, which completes the
+	 * queued I/Os in batches. Fall back to a message if the queue is full. */
+	if (spdk_unlikely(spdk_ring_enqueue(rbd_io->group_ch->completions, (void **)&rbd_io, 1,
+					    NULL) != 1)) {
+		spdk_thread_send_msg(rbd_io->submit_td, _bdev_rbd_io_complete, rbd_io);
+		return;
+	}
+
+	if (rbd_io->group_ch->efd >= 0) {
+		eventfd_write(rbd_io->group_ch->efd, 1);
 	}
 }
 
@@ -761,9 +786,11 @@ static void
 bdev_rbd_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
 {
 	struct spdk_thread *submit_td = spdk_io_channel_get_thread(ch);
+	struct bdev_rbd_io_channel *rbd_ch = spdk_io_channel_get_ctx(ch);
 	struct bdev_rbd_io *rbd_io = (struct bdev_rbd_io *)bdev_io->driver_ctx;
 
 	rbd_io->submit_td = submit_td;
+	rbd_io->group_ch = spdk_io_channel_get_ctx(rbd_ch->group_ch);
 	switch (bdev_io->type) {
 	case SPDK_BDEV_IO_TYPE_READ:
 		spdk_bdev_io_get_buf(bdev_io, bdev_rbd_get_buf_cb,
@@ -1437,22 +1464,99 @@ exit:
 	return rc;
 }
 
+static int
+bdev_rbd_group_poll(void *arg)
+{
+	struct bdev_rbd_group_channel *group_ch = arg;
+	void *rbd_ios[BDEV_RBD_MAX_COMPLETIONS_PER_POLL];
+	size_t count, i;
+
+	count = spdk_ring_dequeue(group_ch->completions, rbd_ios, SPDK_COUNTOF(rbd_ios));
+	for (i = 0; i < count; i++) {
+		_bdev_rbd_io_complete(rbd_ios[i]);
+	}
+
+	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+static int
+bdev_rbd_group_interrupt(void *arg)
+{
+	struct bdev_rbd_group_channel *group_ch = arg;
+	eventfd_t num_events;
+	int rc;
+
+	rc = eventfd_read(group_ch->efd, &num_events);
+	if (rc < 0) {
+		SPDK_ERRLOG("failed to acknowledge rbd group: %s.\n", spdk_strerror(errno));
+		return -errno;
+	}
+
+	/* Drain the whole queue, the I/Os enqueued later signal the eventfd again */
+	while (bdev_rbd_group_poll(group_ch) == SPDK_POLLER_BUSY) {
+	}
+
+	return SPDK_POLLER_BUSY;
+}
+
 static int
 bdev_rbd_group_create_cb(void *io_device, void *ctx_buf)
 {
+	struct bdev_rbd_group_channel *ch = ctx_buf;
+	int rc;
+
+	ch->completions = spdk_ring_create(SPDK_RING_TYPE_MP_SC, BDEV_RBD_COMPLETION_RING_SIZE,
+					   SPDK_ENV_NUMA_ID_ANY);
+	if (!ch->completions) {
+		SPDK_ERRLOG("Failed to allocate the completion queue of the rbd group\n");
+		return -ENOMEM;
+	}
+
+	ch->efd = -1;
+	if (spdk_interrupt_mode_is_enabled()) {
+		ch->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (ch->efd < 0) {
+			rc = -errno;
+			SPDK_ERRLOG("Failed to create the eventfd of the rbd group\n");
+			spdk_ring_free(ch->completions);
+			return rc;
+		}
+
+		ch->intr = SPDK_INTERRUPT_REGISTER(ch->efd, bdev_rbd_group_interrupt, ch);
+		if (!ch->intr) {
+			SPDK_ERRLOG("Failed to register the interrupt of the rbd group\n");
+			close(ch->efd);
+			spdk_ring_free(ch->completions);
+			return -EINVAL;
+		}
+	}
+
+	ch->poller = SPDK_POLLER_REGISTER(bdev_rbd_group_poll, ch, 0);
+	spdk_poller_register_interrupt(ch->poller, NULL, NULL);
+
 	return 0;
 }
 
 static void
 bdev_rbd_group_destroy_cb(void *io_device, void *ctx_buf)
 {
+	struct bdev_rbd_group_channel *ch = ctx_buf;
+
+	assert(spdk_ring_count(ch->completions) == 0);
+
+	spdk_poller_unregister(&ch->poller);
+	if (ch->intr) {
+		spdk_interrupt_unregister(&ch->intr);
+		close(ch->efd);
+	}
+	spdk_ring_free(ch->completions);
 }
 
 static int
 bdev_rbd_library_init(void)
 {
 	spdk_io_device_register(&rbd_if, bdev_rbd_group_create_cb, bdev_rbd_group_destroy_cb,
-				0, "bdev_rbd_poll_groups");
+				sizeof(struct bdev_rbd_group_channel), "bdev_rbd_poll_groups");
 	return 0;
 }
 
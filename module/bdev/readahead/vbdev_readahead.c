@@ -0,0 +1,1063 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+/*
+ * A virtual block device module that detects sequential read streams on each
+ * channel and prefetches the data following them into iobuf buffers, so that
+ * the next reads of the stream complete from memory.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "vbdev_readahead.h"
+#include "spdk/rpc.h"
+#include "spdk/env.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+
+#include "spdk/bdev_module.h"
+#include "spdk/log.h"
+
+/* This namespace UUID was generated using uuid_generate() method. */
+#define BDEV_READAHEAD_NAMESPACE_UUID "3a9f7bd2-5e0c-4f4e-9b1d-7c2a86e51f03"
+
+/* Number of prefetch windows per channel, i.e. how far ahead of a stream we may read. */
+#define VBDEV_READAHEAD_NUM_WINDOWS	2
+/* Number of back to back sequential reads needed before a stream is prefetched. */
+#define VBDEV_READAHEAD_SEQ_THRESHOLD	2
+
+static int vbdev_readahead_init(void);
+static int vbdev_readahead_get_ctx_size(void);
+static void vbdev_readahead_examine(struct spdk_bdev *bdev);
+static void vbdev_readahead_finish(void);
+static int vbdev_readahead_config_json(struct spdk_json_write_ctx *w);
+
+static struct spdk_bdev_module readahead_if = {
+	.name = "readahead",
+	.module_init = vbdev_readahead_init,
+	.get_ctx_size = vbdev_readahead_get_ctx_size,
+	.examine_config = vbdev_readahead_examine,
+	.module_fini = vbdev_readahead_finish,
+	.config_json = vbdev_readahead_config_json
+};
+
+SPDK_BDEV_MODULE_REGISTER(readahead, &readahead_if)
+
+/* List of readahead bdev names and their base bdevs via configuration file.
+ * Used so we can parse the conf once at init and use this list in examine().
+ */
+struct bdev_names {
+	char			*vbdev_name;
+	char			*bdev_name;
+	struct spdk_uuid	uuid;
+	uint32_t		readahead_size;
+	TAILQ_ENTRY(bdev_names)	link;
+};
+static TAILQ_HEAD(, bdev_names) g_bdev_names = TAILQ_HEAD_INITIALIZER(g_bdev_names);
+
+/* List of virtual bdevs and associated info for each. */
+struct vbdev_readahead {
+	struct spdk_bdev		*base_bdev; /* the thing we're attaching to */
+	struct spdk_bdev_desc		*base_desc; /* its descriptor we get from open */
+	struct spdk_bdev		ra_bdev;    /* the readahead virtual bdev */
+	uint32_t			readahead_size;
+	uint64_t			window_blocks;
+	/* Bumped on submission and completion of every I/O modifying the data. Prefetched
+	 * data is only used if no such I/O was outstanding since the prefetch was issued.
+	 */
+	uint64_t			generation;
+	TAILQ_ENTRY(vbdev_readahead)	link;
+	struct spdk_thread		*thread;    /* thread where base device is opened */
+};
+static TAILQ_HEAD(, vbdev_readahead) g_ra_nodes = TAILQ_HEAD_INITIALIZER(g_ra_nodes);
+
+enum readahead_window_state {
+	READAHEAD_WINDOW_FREE,
+	READAHEAD_WINDOW_READING,
+	READAHEAD_WINDOW_VALID,
+};
+
+struct readahead_bdev_io;
+
+/* A contiguous range of blocks prefetched into a single iobuf buffer. */
+struct readahead_window {
+	enum readahead_window_state		state;
+	uint64_t				offset_blocks;
+	uint64_t				num_blocks;
+	uint64_t				generation;
+	void					*buf;
+	struct ra_io_channel			*ra_ch;
+	/* Reads waiting for the prefetch of this window to complete */
+	TAILQ_HEAD(, readahead_bdev_io)		waiters;
+};
+
+struct ra_io_channel {
+	struct spdk_io_channel		*base_ch; /* IO channel of base device */
+	struct vbdev_readahead		*ra_node;
+	struct spdk_iobuf_channel	iobuf;
+	/* Offset following the last read, used to detect sequential streams */
+	uint64_t			next_offset_blocks;
+	uint32_t			seq_count;
+	struct readahead_window		windows[VBDEV_READAHEAD_NUM_WINDOWS];
+};
+
+struct readahead_bdev_io {
+	/* bdev related */
+	struct spdk_io_channel *ch;
+
+	/* for bdev_io_wait */
+	struct spdk_bdev_io_wait_entry bdev_io_wait;
+
+	/* for waiting on a prefetch in progress */
+	TAILQ_ENTRY(readahead_bdev_io) link;
+};
+
+static void vbdev_readahead_submit_request(struct spdk_io_channel *ch,
+		struct spdk_bdev_io *bdev_io);
+
+/* Callback for unregistering the IO device. */
+static void
+_device_unregister_cb(void *io_device)
+{
+	struct vbdev_readahead *ra_node  = io_device;
+
+	/* Done with this ra_node. */
+	free(ra_node->ra_bdev.name);
+	free(ra_node);
+}
+
+/* Wrapper for the bdev close operation. */
+static void
+_vbdev_readahead_destruct(void *ctx)
+{
+	struct spdk_bdev_desc *desc = ctx;
+
+	spdk_bdev_close(desc);
+}
+
+/* Called after we've unregistered following a hot remove callback.
+ * Our finish entry point will be called next.
+ */
+static int
+vbdev_readahead_destruct(void *ctx)
+{
+	struct vbdev_readahead *ra_node = (struct vbdev_readahead *)ctx;
+
+	TAILQ_REMOVE(&g_ra_nodes, ra_node, link);
+
+	/* Unclaim the underlying bdev. */
+	spdk_bdev_module_release_bdev(ra_node->base_bdev);
+
+	/* Close the underlying bdev on its same opened thread. */
+	if (ra_node->thread && ra_node->thread != spdk_get_thread()) {
+		spdk_thread_send_msg(ra_node->thread, _vbdev_readahead_destruct, ra_node->base_desc);
+	} else {
+		spdk_bdev_close(ra_node->base_desc);
+	}
+
+	/* Unregister the io_device. */
+	spdk_io_device_unregister(ra_node, _device_unregister_cb);
+
+	return 0;
+}
+
+static inline uint64_t
+readahead_get_generation(struct vbdev_readahead *ra_node)
+{
+	return __atomic_load_n(&ra_node->generation, __ATOMIC_RELAXED);
+}
+
+static inline void
+readahead_bump_generation(struct vbdev_readahead *ra_node)
+{
+	__atomic_fetch_add(&ra_node->generation, 1, __ATOMIC_RELAXED);
+}
+
+static void
+readahead_window_release(struct readahead_window *win)
+{
+	struct ra_io_channel *ra_ch = win->ra_ch;
+	struct vbdev_readahead *ra_node = ra_ch->ra_node;
+
+	assert(win->state == READAHEAD_WINDOW_VALID);
+	assert(TAILQ_EMPTY(&win->waiters));
+
+	spdk_iobuf_put(&ra_ch->iobuf, win->buf, ra_node->window_blocks * ra_node->ra_bdev.blocklen);
+	win->buf = NULL;
+	win->state = READAHEAD_WINDOW_FREE;
+}
+
+/* Return the prefetched or being prefetched window containing the block at offset_blocks,
+ * if its data is still up to date.
+ */
+static struct readahead_window *
+readahead_find_window(struct ra_io_channel *ra_ch, uint64_t offset_blocks, uint64_t generation)
+{
+	struct readahead_window *win;
+	int i;
+
+	for (i = 0; i < VBDEV_READAHEAD_NUM_WINDOWS; i++) {
+		win = &ra_ch->windows[i];
+		if (win->state == READAHEAD_WINDOW_FREE || win->generation != generation) {
+			continue;
+		}
+		if (offset_blocks >= win->offset_blocks &&
+		    offset_blocks < win->offset_blocks + win->num_blocks) {
+			return win;
+		}
+	}
+
+	return NULL;
+}
+
+/* Try to satisfy a read from the prefetched data. Returns true if the read was either
+ * completed or queued behind a prefetch in progress, false if it has to be sent to the
+ * base bdev.
+ */
+static bool
+readahead_read_cached(struct ra_io_channel *ra_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct readahead_bdev_io *io_ctx = (struct readahead_bdev_io *)bdev_io->driver_ctx;
+	uint32_t blocklen = bdev_io->bdev->blocklen;
+	uint64_t offset_blocks = bdev_io->u.bdev.offset_blocks;
+	uint64_t end_blocks = offset_blocks + bdev_io->u.bdev.num_blocks;
+	uint64_t generation = readahead_get_generation(ra_ch->ra_node);
+	struct readahead_window *win;
+	struct spdk_iov_xfer ix;
+	uint64_t cursor, num_blocks;
+
+	for (cursor = offset_blocks; cursor < end_blocks;
+	     cursor = win->offset_blocks + win->num_blocks) {
+		win = readahead_find_window(ra_ch, cursor, generation);
+		if (win == NULL) {
+			return false;
+		}
+		if (win->state == READAHEAD_WINDOW_READING) {
+			TAILQ_INSERT_TAIL(&win->waiters, io_ctx, link);
+			return true;
+		}
+	}
+
+	spdk_iov_xfer_init(&ix, bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt);
+	for (cursor = offset_blocks; cursor < end_blocks; cursor += num_blocks) {
+		win = readahead_find_window(ra_ch, cursor, generation);
+		assert(win != NULL);
+		num_blocks = spdk_min(end_blocks, win->offset_blocks + win->num_blocks) - cursor;
+		spdk_iov_xfer_from_buf(&ix, (uint8_t *)win->buf + (cursor - win->offset_blocks) * blocklen,
+				       num_blocks * blocklen);
+	}
+
+	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	return true;
+}
+
+static void vbdev_readahead_forward_read(struct spdk_io_channel *ch,
+		struct spdk_bdev_io *bdev_io);
+
+static void
+readahead_prefetch_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct readahead_window *win = cb_arg;
+	struct ra_io_channel *ra_ch = win->ra_ch;
+	struct spdk_io_channel *ch = spdk_io_channel_from_ctx(ra_ch);
+	struct readahead_bdev_io *io_ctx;
+	struct spdk_bdev_io *orig_io;
+	TAILQ_HEAD(, readahead_bdev_io) waiters;
+
+	spdk_bdev_free_io(bdev_io);
+
+	TAILQ_INIT(&waiters);
+	TAILQ_SWAP(&waiters, &win->waiters, readahead_bdev_io, link);
+
+	win->state = READAHEAD_WINDOW_VALID;
+	if (!success) {
+		SPDK_DEBUGLOG(vbdev_readahead, "prefetch of %" PRIu64 "+%" PRIu64 " failed\n",
+			      win->offset_blocks, win->num_blocks);
+		readahead_window_release(win);
+	}
+
+	/* Anything that couldn't be served from the prefetched data, e.g. because it was
+	 * invalidated by a write in the meantime, is sent down to the base bdev.
+	 */
+	while ((io_ctx = TAILQ_FIRST(&waiters))) {
+		TAILQ_REMOVE(&waiters, io_ctx, link);
+		orig_io = spdk_bdev_io_from_ctx(io_ctx);
+		if (!readahead_read_cached(ra_ch, orig_io)) {
+			vbdev_readahead_forward_read(ch, orig_io);
+		}
+	}
+
+	if (win->state == READAHEAD_WINDOW_VALID && ra_ch->seq_count == 0) {
+		/* The stream was broken while we were reading ahead of it. */
+		readahead_window_release(win);
+	}
+
+	/* Drop the reference taken when the prefetch was submitted. */
+	spdk_put_io_channel(ch);
+}
+
+/* Make sure a window's worth of data starting at offset_blocks is prefetched or
+ * being prefetched.
+ */
+static void
+readahead_prefetch(struct ra_io_channel *ra_ch, uint64_t offset_blocks)
+{
+	struct vbdev_readahead *ra_node = ra_ch->ra_node;
+	uint64_t generation = readahead_get_generation(ra_node);
+	uint64_t end_blocks = spdk_min(offset_blocks + ra_node->window_blocks,
+				       ra_node->ra_bdev.blockcnt);
+	struct readahead_window *win;
+	uint64_t cursor;
+	void *buf;
+	int i, rc;
+
+	for (cursor = offset_blocks; cursor < end_blocks;
+	     cursor = win->offset_blocks + win->num_blocks) {
+		win = readahead_find_window(ra_ch, cursor, generation);
+		if (win == NULL) {
+			break;
+		}
+	}
+
+	if (cursor >= end_blocks) {
+		return;
+	}
+
+	for (i = 0; i < VBDEV_READAHEAD_NUM_WINDOWS; i++) {
+		win = &ra_ch->windows[i];
+		if (win->state == READAHEAD_WINDOW_VALID && win->generation != generation) {
+			readahead_window_release(win);
+		}
+		if (win->state == READAHEAD_WINDOW_FREE) {
+			break;
+		}
+	}
+
+	if (i == VBDEV_READAHEAD_NUM_WINDOWS) {
+		return;
+	}
+
+	/* Prefetching is best effort, so don't wait for a buffer if there are none. */
+	buf = spdk_iobuf_get(&ra_ch->iobuf, ra_node->window_blocks * ra_node->ra_bdev.blocklen,
+			     NULL, NULL);
+	if (buf == NULL) {
+		return;
+	}
+
+	win->offset_blocks = cursor;
+	win->num_blocks = spdk_min(ra_node->window_blocks, ra_node->ra_bdev.blockcnt - cursor);
+	win->generation = generation;
+	win->buf = buf;
+
+	rc = spdk_bdev_read_blocks(ra_node->base_desc, ra_ch->base_ch, buf, win->offset_blocks,
+				   win->num_blocks, readahead_prefetch_done, win);
+	if (rc != 0) {
+		spdk_iobuf_put(&ra_ch->iobuf, buf, ra_node->window_blocks * ra_node->ra_bdev.blocklen);
+		win->buf = NULL;
+		return;
+	}
+
+	win->state = READAHEAD_WINDOW_READING;
+
+	/* Hold a reference to our channel, so it isn't destroyed with the prefetch in flight. */
+	spdk_get_io_channel(ra_node);
+}
+
+/* Track the sequential stream formed by the reads on this channel and read ahead of it. */
+static void
+readahead_update_stream(struct ra_io_channel *ra_ch, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct readahead_window *win;
+	int i;
+
+	if (offset_blocks == ra_ch->next_offset_blocks) {
+		ra_ch->seq_count = spdk_min(ra_ch->seq_count + 1, VBDEV_READAHEAD_SEQ_THRESHOLD);
+	} else if (offset_blocks + num_blocks != ra_ch->next_offset_blocks) {
+		/* A read resubmitted after -ENOMEM doesn't break the stream. */
+		ra_ch->seq_count = 0;
+	}
+	ra_ch->next_offset_blocks = offset_blocks + num_blocks;
+
+	/* Release the windows the stream has already moved past, or all of them if the stream
+	 * was broken.
+	 */
+	for (i = 0; i < VBDEV_READAHEAD_NUM_WINDOWS; i++) {
+		win = &ra_ch->windows[i];
+		if (win->state == READAHEAD_WINDOW_VALID &&
+		    (ra_ch->seq_count == 0 || win->offset_blocks + win->num_blocks <= offset_blocks)) {
+			readahead_window_release(win);
+		}
+	}
+
+	if (ra_ch->seq_count == VBDEV_READAHEAD_SEQ_THRESHOLD &&
+	    ra_ch->next_offset_blocks < ra_ch->ra_node->ra_bdev.blockcnt) {
+		readahead_prefetch(ra_ch, ra_ch->next_offset_blocks);
+	}
+}
+
+/* Completion callback for IO that were issued from this bdev. The original bdev_io
+ * is passed in as an arg so we'll complete that one with the appropriate status
+ * and then free the one that this module issued.
+ */
+static void
+_ra_complete_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	int status = success ? SPDK_BDEV_IO_STATUS_SUCCESS : SPDK_BDEV_IO_STATUS_FAILED;
+
+	spdk_bdev_io_complete(orig_io, status);
+	spdk_bdev_free_io(bdev_io);
+}
+
+static void
+_ra_complete_write_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct vbdev_readahead *ra_node = SPDK_CONTAINEROF(orig_io->bdev, struct vbdev_readahead,
+					  ra_bdev);
+
+	readahead_bump_generation(ra_node);
+	_ra_complete_io(bdev_io, success, cb_arg);
+}
+
+static void
+vbdev_readahead_resubmit_io(void *arg)
+{
+	struct spdk_bdev_io *bdev_io = (struct spdk_bdev_io *)arg;
+	struct readahead_bdev_io *io_ctx = (struct readahead_bdev_io *)bdev_io->driver_ctx;
+
+	vbdev_readahead_submit_request(io_ctx->ch, bdev_io);
+}
+
+static void
+vbdev_readahead_queue_io(struct spdk_bdev_io *bdev_io)
+{
+	struct readahead_bdev_io *io_ctx = (struct readahead_bdev_io *)bdev_io->driver_ctx;
+	struct ra_io_channel *ra_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	int rc;
+
+	io_ctx->bdev_io_wait.bdev = bdev_io->bdev;
+	io_ctx->bdev_io_wait.cb_fn = vbdev_readahead_resubmit_io;
+	io_ctx->bdev_io_wait.cb_arg = bdev_io;
+
+	/* Queue the IO using the channel of the base device. */
+	rc = spdk_bdev_queue_io_wait(bdev_io->bdev, ra_ch->base_ch, &io_ctx->bdev_io_wait);
+	if (rc != 0) {
+		SPDK_ERRLOG("Queue io failed in vbdev_readahead_queue_io, rc=%d.\n", rc);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void
+vbdev_readahead_handle_submit_rc(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io, int rc)
+{
+	struct readahead_bdev_io *io_ctx = (struct readahead_bdev_io *)bdev_io->driver_ctx;
+
+	if (rc == -ENOMEM) {
+		SPDK_ERRLOG("No memory, start to queue io for readahead.\n");
+		io_ctx->ch = ch;
+		vbdev_readahead_queue_io(bdev_io);
+	} else {
+		SPDK_ERRLOG("ERROR on bdev_io submission!\n");
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void
+ra_init_ext_io_opts(struct spdk_bdev_io *bdev_io, struct spdk_bdev_ext_io_opts *opts)
+{
+	memset(opts, 0, sizeof(*opts));
+	opts->size = sizeof(*opts);
+	opts->memory_domain = bdev_io->u.bdev.memory_domain;
+	opts->memory_domain_ctx = bdev_io->u.bdev.memory_domain_ctx;
+	opts->metadata = bdev_io->u.bdev.md_buf;
+	opts->dif_check_flags_exclude_mask = ~bdev_io->u.bdev.dif_check_flags;
+}
+
+static void
+vbdev_readahead_forward_read(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct vbdev_readahead *ra_node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_readahead,
+					  ra_bdev);
+	struct ra_io_channel *ra_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_bdev_ext_io_opts io_opts;
+	int rc;
+
+	ra_init_ext_io_opts(bdev_io, &io_opts);
+	rc = spdk_bdev_readv_blocks_ext(ra_node->base_desc, ra_ch->base_ch, bdev_io->u.bdev.iovs,
+					bdev_io->u.bdev.iovcnt, bdev_io->u.bdev.offset_blocks,
+					bdev_io->u.bdev.num_blocks, _ra_complete_io,
+					bdev_io, &io_opts);
+	if (rc != 0) {
+		vbdev_readahead_handle_submit_rc(ch, bdev_io, rc);
+	}
+}
+
+/* Only plain reads that fit in the prefetch windows are served from them. Reads with
+ * separate metadata or to buffers in a memory domain go straight to the base bdev.
+ */
+static bool
+vbdev_readahead_io_cacheable(struct vbdev_readahead *ra_node, struct spdk_bdev_io *bdev_io)
+{
+	return bdev_io->u.bdev.md_buf == NULL &&
+	       bdev_io->u.bdev.memory_domain == NULL &&
+	       bdev_io->u.bdev.num_blocks <= ra_node->window_blocks;
+}
+
+static void
+ra_read_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io, bool success)
+{
+	struct vbdev_readahead *ra_node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_readahead,
+					  ra_bdev);
+	struct ra_io_channel *ra_ch = spdk_io_channel_get_ctx(ch);
+	bool handled;
+
+	if (!success) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	if (!vbdev_readahead_io_cacheable(ra_node, bdev_io)) {
+		vbdev_readahead_forward_read(ch, bdev_io);
+		return;
+	}
+
+	handled = readahead_read_cached(ra_ch, bdev_io);
+	readahead_update_stream(ra_ch, bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks);
+	if (!handled) {
+		vbdev_readahead_forward_read(ch, bdev_io);
+	}
+}
+
+/* Called when someone above submits IO to this readahead vbdev. Reads are looked up in
+ * the prefetched data first, everything else is passed on to the base bdev. I/O modifying
+ * the data invalidates whatever was prefetched on any channel.
+ */
+static void
+vbdev_readahead_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct vbdev_readahead *ra_node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_readahead,
+					  ra_bdev);
+	struct ra_io_channel *ra_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_bdev_ext_io_opts io_opts;
+	int rc = 0;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		spdk_bdev_io_get_buf(bdev_io, ra_read_get_buf_cb,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+		return;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		readahead_bump_generation(ra_node);
+		ra_init_ext_io_opts(bdev_io, &io_opts);
+		rc = spdk_bdev_writev_blocks_ext(ra_node->base_desc, ra_ch->base_ch, bdev_io->u.bdev.iovs,
+						 bdev_io->u.bdev.iovcnt, bdev_io->u.bdev.offset_blocks,
+						 bdev_io->u.bdev.num_blocks, _ra_complete_write_io,
+						 bdev_io, &io_opts);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		readahead_bump_generation(ra_node);
+		rc = spdk_bdev_write_zeroes_blocks(ra_node->base_desc, ra_ch->base_ch,
+						   bdev_io->u.bdev.offset_blocks,
+						   bdev_io->u.bdev.num_blocks,
+						   _ra_complete_write_io, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		readahead_bump_generation(ra_node);
+		rc = spdk_bdev_unmap_blocks(ra_node->base_desc, ra_ch->base_ch,
+					    bdev_io->u.bdev.offset_blocks,
+					    bdev_io->u.bdev.num_blocks,
+					    _ra_complete_write_io, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_COPY:
+		readahead_bump_generation(ra_node);
+		rc = spdk_bdev_copy_blocks(ra_node->base_desc, ra_ch->base_ch,
+					   bdev_io->u.bdev.offset_blocks,
+					   bdev_io->u.bdev.copy.src_offset_blocks,
+					   bdev_io->u.bdev.num_blocks,
+					   _ra_complete_write_io, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		rc = spdk_bdev_flush_blocks(ra_node->base_desc, ra_ch->base_ch,
+					    bdev_io->u.bdev.offset_blocks,
+					    bdev_io->u.bdev.num_blocks,
+					    _ra_complete_io, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_RESET:
+		rc = spdk_bdev_reset(ra_node->base_desc, ra_ch->base_ch,
+				     _ra_complete_io, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_ABORT:
+		rc = spdk_bdev_abort(ra_node->base_desc, ra_ch->base_ch, bdev_io->u.abort.bio_to_abort,
+				     _ra_complete_io, bdev_io);
+		break;
+	default:
+		SPDK_ERRLOG("readahead: unknown I/O type %d\n", bdev_io->type);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+	if (rc != 0) {
+		vbdev_readahead_handle_submit_rc(ch, bdev_io, rc);
+	}
+}
+
+static bool
+vbdev_readahead_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+{
+	struct vbdev_readahead *ra_node = (struct vbdev_readahead *)ctx;
+
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_COPY:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_RESET:
+	case SPDK_BDEV_IO_TYPE_ABORT:
+		return spdk_bdev_io_type_supported(ra_node->base_bdev, io_type);
+	default:
+		/* Zero copy reads would bypass the prefetched data. */
+		return false;
+	}
+}
+
+static struct spdk_io_channel *
+vbdev_readahead_get_io_channel(void *ctx)
+{
+	struct vbdev_readahead *ra_node = (struct vbdev_readahead *)ctx;
+
+	return spdk_get_io_channel(ra_node);
+}
+
+/* This is the output for bdev_get_bdevs() for this vbdev */
+static int
+vbdev_readahead_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+{
+	struct vbdev_readahead *ra_node = (struct vbdev_readahead *)ctx;
+
+	spdk_json_write_name(w, "readahead");
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&ra_node->ra_bdev));
+	spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(ra_node->base_bdev));
+	spdk_json_write_named_uint32(w, "readahead_size", ra_node->readahead_size);
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
+/* This is used to generate JSON that can configure this module to its current state. */
+static int
+vbdev_readahead_config_json(struct spdk_json_write_ctx *w)
+{
+	struct vbdev_readahead *ra_node;
+
+	TAILQ_FOREACH(ra_node, &g_ra_nodes, link) {
+		const struct spdk_uuid *uuid = spdk_bdev_get_uuid(&ra_node->ra_bdev);
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_readahead_create");
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(ra_node->base_bdev));
+		spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&ra_node->ra_bdev));
+		if (!spdk_uuid_is_null(uuid)) {
+			spdk_json_write_named_uuid(w, "uuid", uuid);
+		}
+		spdk_json_write_named_uint32(w, "readahead_size", ra_node->readahead_size);
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+	return 0;
+}
+
+static int
+ra_bdev_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	struct ra_io_channel *ra_ch = ctx_buf;
+	struct vbdev_readahead *ra_node = io_device;
+	int i, rc;
+
+	rc = spdk_iobuf_channel_init(&ra_ch->iobuf, "readahead", 0, 0);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to create iobuf channel: %s\n", spdk_strerror(-rc));
+		return rc;
+	}
+
+	ra_ch->base_ch = spdk_bdev_get_io_channel(ra_node->base_desc);
+	if (ra_ch->base_ch == NULL) {
+		spdk_iobuf_channel_fini(&ra_ch->iobuf);
+		return -ENOMEM;
+	}
+
+	ra_ch->ra_node = ra_node;
+	ra_ch->next_offset_blocks = UINT64_MAX;
+	for (i = 0; i < VBDEV_READAHEAD_NUM_WINDOWS; i++) {
+		ra_ch->windows[i].ra_ch = ra_ch;
+		TAILQ_INIT(&ra_ch->windows[i].waiters);
+	}
+
+	return 0;
+}
+
+static void
+ra_bdev_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct ra_io_channel *ra_ch = ctx_buf;
+	int i;
+
+	for (i = 0; i < VBDEV_READAHEAD_NUM_WINDOWS; i++) {
+		/* Prefetches in flight hold a reference to the channel. */
+		assert(ra_ch->windows[i].state != READAHEAD_WINDOW_READING);
+		if (ra_ch->windows[i].state == READAHEAD_WINDOW_VALID) {
+			readahead_window_release(&ra_ch->windows[i]);
+		}
+	}
+
+	spdk_iobuf_channel_fini(&ra_ch->iobuf);
+	spdk_put_io_channel(ra_ch->base_ch);
+}
+
+/* Create the readahead association from the bdev and vbdev name and insert
+ * on the global list. */
+static int
+vbdev_readahead_insert_name(const char *bdev_name, const char *vbdev_name,
+			    const struct spdk_uuid *uuid, uint32_t readahead_size)
+{
+	struct bdev_names *name;
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(vbdev_name, name->vbdev_name) == 0) {
+			SPDK_ERRLOG("readahead bdev %s already exists\n", vbdev_name);
+			return -EEXIST;
+		}
+	}
+
+	name = calloc(1, sizeof(struct bdev_names));
+	if (!name) {
+		SPDK_ERRLOG("could not allocate bdev_names\n");
+		return -ENOMEM;
+	}
+
+	name->bdev_name = strdup(bdev_name);
+	if (!name->bdev_name) {
+		SPDK_ERRLOG("could not allocate name->bdev_name\n");
+		free(name);
+		return -ENOMEM;
+	}
+
+	name->vbdev_name = strdup(vbdev_name);
+	if (!name->vbdev_name) {
+		SPDK_ERRLOG("could not allocate name->vbdev_name\n");
+		free(name->bdev_name);
+		free(name);
+		return -ENOMEM;
+	}
+
+	spdk_uuid_copy(&name->uuid, uuid);
+	name->readahead_size = readahead_size;
+	TAILQ_INSERT_TAIL(&g_bdev_names, name, link);
+
+	return 0;
+}
+
+static void
+vbdev_readahead_remove_name(const char *vbdev_name)
+{
+	struct bdev_names *name;
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(name->vbdev_name, vbdev_name) == 0) {
+			TAILQ_REMOVE(&g_bdev_names, name, link);
+			free(name->bdev_name);
+			free(name->vbdev_name);
+			free(name);
+			break;
+		}
+	}
+}
+
+static int
+vbdev_readahead_init(void)
+{
+	return spdk_iobuf_register_module("readahead");
+}
+
+/* Called when the entire module is being torn down. */
+static void
+vbdev_readahead_finish(void)
+{
+	struct bdev_names *name;
+
+	while ((name = TAILQ_FIRST(&g_bdev_names))) {
+		TAILQ_REMOVE(&g_bdev_names, name, link);
+		free(name->bdev_name);
+		free(name->vbdev_name);
+		free(name);
+	}
+}
+
+static int
+vbdev_readahead_get_ctx_size(void)
+{
+	return sizeof(struct readahead_bdev_io);
+}
+
+static void
+vbdev_readahead_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	/* No config per bdev needed */
+}
+
+static int
+vbdev_readahead_get_memory_domains(void *ctx, struct spdk_memory_domain **domains, int array_size)
+{
+	struct vbdev_readahead *ra_node = (struct vbdev_readahead *)ctx;
+
+	/* Reads to buffers in a memory domain are never served from the prefetched data, so
+	 * we support any memory domain used by base_bdev.
+	 */
+	return spdk_bdev_get_memory_domains(ra_node->base_bdev, domains, array_size);
+}
+
+/* When we register our bdev this is how we specify our entry points. */
+static const struct spdk_bdev_fn_table vbdev_readahead_fn_table = {
+	.destruct		= vbdev_readahead_destruct,
+	.submit_request		= vbdev_readahead_submit_request,
+	.io_type_supported	= vbdev_readahead_io_type_supported,
+	.get_io_channel		= vbdev_readahead_get_io_channel,
+	.dump_info_json		= vbdev_readahead_dump_info_json,
+	.write_config_json	= vbdev_readahead_write_config_json,
+	.get_memory_domains	= vbdev_readahead_get_memory_domains,
+};
+
+static void
+vbdev_readahead_base_bdev_hotremove_cb(struct spdk_bdev *bdev_find)
+{
+	struct vbdev_readahead *ra_node, *tmp;
+
+	TAILQ_FOREACH_SAFE(ra_node, &g_ra_nodes, link, tmp) {
+		if (bdev_find == ra_node->base_bdev) {
+			spdk_bdev_unregister(&ra_node->ra_bdev, NULL, NULL);
+		}
+	}
+}
+
+/* Called when the underlying base bdev triggers asynchronous event such as bdev removal. */
+static void
+vbdev_readahead_base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+				   void *event_ctx)
+{
+	switch (type) {
+	case SPDK_BDEV_EVENT_REMOVE:
+		vbdev_readahead_base_bdev_hotremove_cb(bdev);
+		break;
+	default:
+		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
+		break;
+	}
+}
+
+/* Create and register the readahead vbdev if we find it in our list of bdev names.
+ * This can be called either by the examine path or RPC method.
+ */
+static int
+vbdev_readahead_register(const char *bdev_name)
+{
+	struct bdev_names *name;
+	struct vbdev_readahead *ra_node;
+	struct spdk_bdev *bdev;
+	struct spdk_uuid ns_uuid;
+	int rc = 0;
+
+	spdk_uuid_parse(&ns_uuid, BDEV_READAHEAD_NAMESPACE_UUID);
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(name->bdev_name, bdev_name) != 0) {
+			continue;
+		}
+
+		SPDK_NOTICELOG("Match on %s\n", bdev_name);
+		ra_node = calloc(1, sizeof(struct vbdev_readahead));
+		if (!ra_node) {
+			rc = -ENOMEM;
+			SPDK_ERRLOG("could not allocate ra_node\n");
+			break;
+		}
+
+		ra_node->ra_bdev.name = strdup(name->vbdev_name);
+		if (!ra_node->ra_bdev.name) {
+			rc = -ENOMEM;
+			SPDK_ERRLOG("could not allocate ra_bdev name\n");
+			free(ra_node);
+			break;
+		}
+		ra_node->ra_bdev.product_name = "readahead";
+
+		/* The base bdev that we're attaching to. */
+		rc = spdk_bdev_open_ext(bdev_name, true, vbdev_readahead_base_bdev_event_cb,
+					NULL, &ra_node->base_desc);
+		if (rc) {
+			if (rc != -ENODEV) {
+				SPDK_ERRLOG("could not open bdev %s\n", bdev_name);
+			}
+			free(ra_node->ra_bdev.name);
+			free(ra_node);
+			break;
+		}
+		SPDK_NOTICELOG("base bdev opened\n");
+
+		bdev = spdk_bdev_desc_get_bdev(ra_node->base_desc);
+		ra_node->base_bdev = bdev;
+
+		ra_node->readahead_size = name->readahead_size;
+		ra_node->window_blocks = name->readahead_size / bdev->blocklen;
+		if (ra_node->window_blocks == 0) {
+			SPDK_ERRLOG("readahead size %" PRIu32 " is smaller than block size of bdev %s\n",
+				    name->readahead_size, bdev_name);
+			rc = -EINVAL;
+			spdk_bdev_close(ra_node->base_desc);
+			free(ra_node->ra_bdev.name);
+			free(ra_node);
+			break;
+		}
+
+		if (!spdk_uuid_is_null(&name->uuid)) {
+			/* Use the configured UUID */
+			spdk_uuid_copy(&ra_node->ra_bdev.uuid, &name->uuid);
+		} else {
+			/* Generate UUID based on namespace UUID + base bdev UUID. */
+			rc = spdk_uuid_generate_sha1(&ra_node->ra_bdev.uuid, &ns_uuid,
+						     (const char *)&ra_node->base_bdev->uuid, sizeof(struct spdk_uuid));
+			if (rc) {
+				SPDK_ERRLOG("Unable to generate new UUID for readahead bdev\n");
+				spdk_bdev_close(ra_node->base_desc);
+				free(ra_node->ra_bdev.name);
+				free(ra_node);
+				break;
+			}
+		}
+
+		/* Copy some properties from the underlying base bdev. */
+		ra_node->ra_bdev.write_cache = bdev->write_cache;
+		ra_node->ra_bdev.required_alignment = bdev->required_alignment;
+		ra_node->ra_bdev.optimal_io_boundary = bdev->optimal_io_boundary;
+		ra_node->ra_bdev.blocklen = bdev->blocklen;
+		ra_node->ra_bdev.blockcnt = bdev->blockcnt;
+
+		ra_node->ra_bdev.md_interleave = bdev->md_interleave;
+		ra_node->ra_bdev.md_len = bdev->md_len;
+		ra_node->ra_bdev.dif_type = bdev->dif_type;
+		ra_node->ra_bdev.dif_is_head_of_md = bdev->dif_is_head_of_md;
+		ra_node->ra_bdev.dif_check_flags = bdev->dif_check_flags;
+		ra_node->ra_bdev.dif_pi_format = bdev->dif_pi_format;
+
+		ra_node->ra_bdev.ctxt = ra_node;
+		ra_node->ra_bdev.fn_table = &vbdev_readahead_fn_table;
+		ra_node->ra_bdev.module = &readahead_if;
+		TAILQ_INSERT_TAIL(&g_ra_nodes, ra_node, link);
+
+		spdk_io_device_register(ra_node, ra_bdev_ch_create_cb, ra_bdev_ch_destroy_cb,
+					sizeof(struct ra_io_channel),
+					name->vbdev_name);
+		SPDK_NOTICELOG("io_device created at: 0x%p\n", ra_node);
+
+		/* Save the thread where the base device is opened */
+		ra_node->thread = spdk_get_thread();
+
+		rc = spdk_bdev_module_claim_bdev(bdev, ra_node->base_desc, ra_node->ra_bdev.module);
+		if (rc) {
+			SPDK_ERRLOG("could not claim bdev %s\n", bdev_name);
+			spdk_bdev_close(ra_node->base_desc);
+			TAILQ_REMOVE(&g_ra_nodes, ra_node, link);
+			spdk_io_device_unregister(ra_node, NULL);
+			free(ra_node->ra_bdev.name);
+			free(ra_node);
+			break;
+		}
+		SPDK_NOTICELOG("bdev claimed\n");
+
+		rc = spdk_bdev_register(&ra_node->ra_bdev);
+		if (rc) {
+			SPDK_ERRLOG("could not register ra_bdev\n");
+			spdk_bdev_module_release_bdev(&ra_node->ra_bdev);
+			spdk_bdev_close(ra_node->base_desc);
+			TAILQ_REMOVE(&g_ra_nodes, ra_node, link);
+			spdk_io_device_unregister(ra_node, NULL);
+			free(ra_node->ra_bdev.name);
+			free(ra_node);
+			break;
+		}
+		SPDK_NOTICELOG("created ra_bdev for: %s\n", name->vbdev_name);
+	}
+
+	return rc;
+}
+
+/* Create the readahead disk from the given bdev and vbdev name. */
+int
+bdev_readahead_create_disk(const char *bdev_name, const char *vbdev_name,
+			   const struct spdk_uuid *uuid, uint32_t readahead_size)
+{
+	struct spdk_iobuf_opts iobuf_opts;
+	int rc;
+
+	spdk_iobuf_get_opts(&iobuf_opts, sizeof(iobuf_opts));
+	if (readahead_size == 0 || readahead_size > iobuf_opts.large_bufsize) {
+		SPDK_ERRLOG("readahead size %" PRIu32 " must be between 1 and iobuf large buffer "
+			    "size %" PRIu32 "\n", readahead_size, iobuf_opts.large_bufsize);
+		return -EINVAL;
+	}
+
+	/* Insert the bdev name into our global name list even if it doesn't exist yet,
+	 * it may show up soon...
+	 */
+	rc = vbdev_readahead_insert_name(bdev_name, vbdev_name, uuid, readahead_size);
+	if (rc) {
+		return rc;
+	}
+
+	rc = vbdev_readahead_register(bdev_name);
+	if (rc == -ENODEV) {
+		/* This is not an error, we tracked the name above and it still
+		 * may show up later.
+		 */
+		SPDK_NOTICELOG("vbdev creation deferred pending base bdev arrival\n");
+		rc = 0;
+	} else if (rc != 0) {
+		vbdev_readahead_remove_name(vbdev_name);
+	}
+
+	return rc;
+}
+
+void
+bdev_readahead_delete_disk(const char *bdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	int rc;
+
+	/* Some cleanup happens in the destruct callback. */
+	rc = spdk_bdev_unregister_by_name(bdev_name, &readahead_if, cb_fn, cb_arg);
+	if (rc == 0) {
+		/* Remove the association (vbdev, bdev) from g_bdev_names. This is required so that the
+		 * vbdev does not get re-created if the same bdev is constructed at some other time,
+		 * unless the underlying bdev was hot-removed.
+		 */
+		vbdev_readahead_remove_name(bdev_name);
+	} else {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static void
+vbdev_readahead_examine(struct spdk_bdev *bdev)
+{
+	vbdev_readahead_register(bdev->name);
+
+	spdk_bdev_module_examine_done(&readahead_if);
+}
+
+SPDK_LOG_REGISTER_COMPONENT(vbdev_readahead)
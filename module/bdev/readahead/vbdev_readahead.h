@@ -0,0 +1,40 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#ifndef SPDK_VBDEV_READAHEAD_H
+#define SPDK_VBDEV_READAHEAD_H
+
+#include "spdk/stdinc.h"
+
+#include "spdk/bdev.h"
+#include "spdk/bdev_module.h"
+
+/* Default size of a single prefetch window, in bytes. */
+#define VBDEV_READAHEAD_DEFAULT_SIZE	(128 * 1024)
+
+/**
+ * Create new readahead bdev.
+ *
+ * \param bdev_name Bdev on which readahead vbdev will be created.
+ * \param vbdev_name Name of the readahead bdev.
+ * \param uuid Optional UUID to assign to the readahead bdev.
+ * \param readahead_size Number of bytes to prefetch ahead of a sequential stream. It is
+ * rounded down to a multiple of the block size and cannot exceed the iobuf large buffer size.
+ * \return 0 on success, other on failure.
+ */
+int bdev_readahead_create_disk(const char *bdev_name, const char *vbdev_name,
+			       const struct spdk_uuid *uuid, uint32_t readahead_size);
+
+/**
+ * Delete readahead bdev.
+ *
+ * \param bdev_name Name of the readahead bdev.
+ * \param cb_fn Function to call after deletion.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void bdev_readahead_delete_disk(const char *bdev_name, spdk_bdev_unregister_cb cb_fn,
+				void *cb_arg);
+
+#endif /* SPDK_VBDEV_READAHEAD_H */
@@ -0,0 +1,1819 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+/*
+ * A virtual block device module replicating the writes to a remote bdev asynchronously.
+ *
+ * Reads are served by the base bdev. Writes are first appended to a journal, a ring of records
+ * on a fast local bdev, each record being a header block followed by the data written. Once a
+ * write and all the writes journaled before it are in the journal, it is written to the base
+ * bdev and completed, without waiting for the remote bdev. So the local copy never holds a write
+ * the journal doesn't.
+ *
+ * The thread that created the bdev owns the journal. It allocates the records, in sequence, and
+ * ships them to the remote bdev in the background, in order, in batches of records contiguous in
+ * the journal read at once. Within a batch, a write fully covered by a later one isn't shipped,
+ * zeroes are shipped as write zeroes, and a write partially overlapping an earlier one starts the
+ * next batch so that the writes sent to the remote bdev at the same time never overlap. Once a
+ * batch is on the remote bdev, the position of the first record left to ship is persisted in the
+ * superblock of the journal and the space of the batch reused. A failed batch is retried later.
+ *
+ * When the bdev is created on a journal already in use, the records still to ship are found by
+ * their sequence number and checksums, written to the base bdev again, in order, and shipped.
+ * The recovery point is the age of the oldest write not shipped yet.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "vbdev_replica.h"
+#include "spdk/accel.h"
+#include "spdk/crc32.h"
+#include "spdk/rpc.h"
+#include "spdk/endian.h"
+#include "spdk/env.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+
+#include "spdk/bdev_module.h"
+#include "spdk/log.h"
+
+/* This namespace UUID was generated using uuid_generate() method. */
+#define BDEV_REPLICA_NAMESPACE_UUID "cfb618b5-45f6-4d51-bb41-6063689a09b5"
+
+#define VBDEV_REPLICA_SB_MAGIC		"SPDKREPL"
+#define VBDEV_REPLICA_RECORD_MAGIC	"SPDKRREC"
+#define VBDEV_REPLICA_SB_VERSION	1
+/* Period of the poller shipping the journal. */
+#define VBDEV_REPLICA_POLL_US		100
+/* Delay before shipping a batch again after a failure. */
+#define VBDEV_REPLICA_RETRY_US		(1000 * 1000)
+/* Largest number of records shipped at once. */
+#define VBDEV_REPLICA_MAX_BATCH_RECORDS	64
+
+static int vbdev_replica_init(void);
+static int vbdev_replica_get_ctx_size(void);
+static void vbdev_replica_examine(struct spdk_bdev *bdev);
+static void vbdev_replica_finish(void);
+static int vbdev_replica_config_json(struct spdk_json_write_ctx *w);
+
+static struct spdk_bdev_module replica_if = {
+	.name = "replica",
+	.module_init = vbdev_replica_init,
+	.get_ctx_size = vbdev_replica_get_ctx_size,
+	.examine_config = vbdev_replica_examine,
+	.module_fini = vbdev_replica_finish,
+	.config_json = vbdev_replica_config_json
+};
+
+SPDK_BDEV_MODULE_REGISTER(replica, &replica_if)
+
+/* The bdevs a replicated bdev is built on. */
+enum replica_role {
+	REPLICA_BASE,
+	REPLICA_JOURNAL,
+	REPLICA_REMOTE,
+	REPLICA_NUM_ROLES,
+};
+
+static const char *g_replica_roles[REPLICA_NUM_ROLES] = {"base", "journal", "remote"};
+
+/* List of replicated bdev names and their underlying bdevs via configuration file.
+ * Used so we can parse the conf once at init and use this list in examine().
+ */
+struct bdev_names {
+	char			*vbdev_name;
+	char			*bdev_names[REPLICA_NUM_ROLES];
+	struct spdk_uuid	uuid;
+	uint32_t		batch_size;
+	TAILQ_ENTRY(bdev_names)	link;
+};
+static TAILQ_HEAD(, bdev_names) g_bdev_names = TAILQ_HEAD_INITIALIZER(g_bdev_names);
+
+/* Superblock, in the first block of the journal bdev. The ring of records follows it. Positions
+ * in the ring only increase, the block of a position being 1 + position % ring_blocks. All
+ * little-endian.
+ */
+struct replica_sb {
+	char			magic[8];
+	uint32_t		version;
+	uint32_t		blocklen;
+	uint64_t		ring_blocks;
+	uint64_t		base_blockcnt;
+	/* First record left to ship */
+	uint64_t		head_lpos;
+	uint64_t		head_seq;
+};
+SPDK_STATIC_ASSERT(sizeof(struct replica_sb) == 48, "Incorrect size");
+
+/* Header of a record, in the block preceding its data. A record never wraps around the end of
+ * the ring, it starts at the beginning of the ring instead.
+ */
+struct replica_record_hdr {
+	char			magic[8];
+	/* CRC-32C of the header with this field zeroed */
+	uint32_t		hdr_crc;
+	/* CRC-32C of the data */
+	uint32_t		data_crc;
+	uint64_t		seq;
+	uint64_t		lpos;
+	uint64_t		offset_blocks;
+	uint32_t		num_blocks;
+	uint32_t		reserved;
+};
+SPDK_STATIC_ASSERT(sizeof(struct replica_record_hdr) == 48, "Incorrect size");
+
+enum replica_record_state {
+	/* Being written to the journal */
+	REPLICA_RECORD_JOURNALING,
+	REPLICA_RECORD_JOURNALED,
+	/* Couldn't be written to the journal, nothing to ship */
+	REPLICA_RECORD_FAILED,
+};
+
+/* A write in the journal, not shipped yet. */
+struct replica_record {
+	uint64_t			seq;
+	uint64_t			lpos;
+	uint64_t			offset_blocks;
+	uint32_t			num_blocks;
+	enum replica_record_state	state;
+	/* Covered by a later write of the batch being shipped */
+	bool				superseded;
+	/* When it was journaled, to track the recovery point */
+	uint64_t			tsc;
+	/* The write, until it is sent to the base bdev */
+	struct spdk_bdev_io		*bdev_io;
+	TAILQ_ENTRY(replica_record)	link;
+};
+
+struct replica_bdev_io;
+
+/* List of virtual bdevs and associated info for each. */
+struct vbdev_replica {
+	struct spdk_bdev		*bdevs[REPLICA_NUM_ROLES];
+	struct spdk_bdev_desc		*descs[REPLICA_NUM_ROLES];
+	struct spdk_bdev		replica_bdev;	/* the replicated virtual bdev */
+	uint32_t			batch_blocks;
+	uint64_t			ring_blocks;
+	/* Copy of the superblock */
+	struct replica_sb		*sb;
+	/* Records not shipped yet, in sequence */
+	TAILQ_HEAD(replica_record_list, replica_record)	records;
+	TAILQ_HEAD(, replica_record)	free_records;
+	/* First record whose write wasn't sent to the base bdev yet */
+	struct replica_record		*next_base;
+	/* Position and sequence number of the next record */
+	uint64_t			tail_lpos;
+	uint64_t			next_seq;
+	/* Writes waiting for space in the journal */
+	TAILQ_HEAD(, replica_bdev_io)	space_waiters;
+	/* Batch being shipped, from the first record to last */
+	bool				shipping;
+	struct replica_record		*ship_last;
+	uint32_t			ship_outstanding;
+	bool				ship_failed;
+	uint64_t			ship_retry_tsc;
+	void				*ship_buf;
+	/* The remote bdev has a volatile cache, flush it before moving the head */
+	bool				remote_flush;
+	bool				remote_write_zeroes;
+	/* Channels of the thread of the node */
+	struct spdk_io_channel		*chs[REPLICA_NUM_ROLES];
+	struct spdk_poller		*poller;
+	uint64_t			num_shipped_writes;
+	uint64_t			num_coalesced_writes;
+	uint64_t			num_zero_writes;
+	uint64_t			num_shipped_blocks;
+	uint64_t			num_batches;
+	uint64_t			num_ship_errors;
+	uint64_t			max_rpo_ticks;
+	/* Journal loading, the bdev is registered once it is done */
+	bool				loading;
+	uint64_t			load_lpos;
+	uint64_t			load_seq;
+	uint64_t			load_try_lpos;
+	bdev_replica_create_cb		create_cb;
+	void				*create_cb_arg;
+	/* The bdev is being destructed, clean up once the journal is idle */
+	bool				deleting;
+	/* One of the underlying bdevs was hot removed */
+	bool				removed;
+	TAILQ_ENTRY(vbdev_replica)	link;
+	struct spdk_thread		*thread;	/* thread owning the journal */
+};
+static TAILQ_HEAD(, vbdev_replica) g_replica_nodes = TAILQ_HEAD_INITIALIZER(g_replica_nodes);
+
+struct replica_io_channel {
+	struct spdk_io_channel		*base_ch;	/* IO channel of base device */
+	struct spdk_io_channel		*journal_ch;
+	struct spdk_io_channel		*accel_ch;
+	struct spdk_iobuf_channel	iobuf;
+	struct vbdev_replica		*node;
+};
+
+struct replica_bdev_io {
+	/* bdev related */
+	struct spdk_io_channel *ch;
+
+	/* for writes, the record in the journal, until it is written there */
+	struct replica_record *record;
+
+	/* header block of the record */
+	void *hdr_buf;
+	struct spdk_iobuf_entry iobuf;
+	uint32_t data_crc;
+
+	/* for writes, the I/O to the journal, for flushes the ones to the base and journal bdevs */
+	int outstanding;
+	bool failed;
+
+	/* for waiting for space in the journal */
+	TAILQ_ENTRY(replica_bdev_io) link;
+};
+
+static void vbdev_replica_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io);
+
+static void
+vbdev_replica_free(struct vbdev_replica *node)
+{
+	struct replica_record *record;
+
+	while ((record = TAILQ_FIRST(&node->records)) != NULL) {
+		TAILQ_REMOVE(&node->records, record, link);
+		free(record);
+	}
+	while ((record = TAILQ_FIRST(&node->free_records)) != NULL) {
+		TAILQ_REMOVE(&node->free_records, record, link);
+		free(record);
+	}
+	spdk_dma_free(node->sb);
+	spdk_dma_free(node->ship_buf);
+	free(node->replica_bdev.name);
+	free(node);
+}
+
+/* Callback for unregistering the IO device. */
+static void
+_device_unregister_cb(void *io_device)
+{
+	struct vbdev_replica *node = io_device;
+
+	spdk_bdev_destruct_done(&node->replica_bdev, 0);
+
+	/* Done with this node. */
+	vbdev_replica_free(node);
+}
+
+static void
+_vbdev_replica_destruct(void *ctx)
+{
+	struct vbdev_replica *node = ctx;
+
+	/* The poller cleans up once the batch in flight is done. */
+	node->deleting = true;
+}
+
+/* Called after we've unregistered following a hot remove callback or a delete RPC. */
+static int
+vbdev_replica_destruct(void *ctx)
+{
+	struct vbdev_replica *node = (struct vbdev_replica *)ctx;
+
+	TAILQ_REMOVE(&g_replica_nodes, node, link);
+
+	if (node->thread != spdk_get_thread()) {
+		spdk_thread_send_msg(node->thread, _vbdev_replica_destruct, node);
+	} else {
+		_vbdev_replica_destruct(node);
+	}
+
+	/* Completed asynchronously with spdk_bdev_destruct_done(). */
+	return 1;
+}
+
+/* Block of the journal bdev holding a position of the ring. */
+static inline uint64_t
+replica_ring_block(struct vbdev_replica *node, uint64_t lpos)
+{
+	return 1 + lpos % node->ring_blocks;
+}
+
+/* Position a record of the given size is put at, if it is the next one. */
+static inline uint64_t
+replica_record_lpos(struct vbdev_replica *node, uint64_t lpos, uint32_t num_blocks)
+{
+	if (lpos % node->ring_blocks + 1 + num_blocks > node->ring_blocks) {
+		/* Don't wrap around the end of the ring. */
+		lpos += node->ring_blocks - lpos % node->ring_blocks;
+	}
+
+	return lpos;
+}
+
+static inline uint64_t
+replica_head_lpos(struct vbdev_replica *node)
+{
+	struct replica_record *first = TAILQ_FIRST(&node->records);
+
+	return first != NULL ? first->lpos : node->tail_lpos;
+}
+
+static void
+replica_hdr_crc(struct replica_record_hdr *hdr)
+{
+	hdr->hdr_crc = 0;
+	to_le32(&hdr->hdr_crc, spdk_crc32c_update(hdr, sizeof(*hdr), ~0u));
+}
+
+static bool
+replica_hdr_valid(struct vbdev_replica *node, struct replica_record_hdr *hdr, uint64_t lpos,
+		  uint64_t seq)
+{
+	uint32_t crc = from_le32(&hdr->hdr_crc), num_blocks = from_le32(&hdr->num_blocks);
+
+	if (memcmp(hdr->magic, VBDEV_REPLICA_RECORD_MAGIC, sizeof(hdr->magic)) != 0 ||
+	    from_le64(&hdr->seq) != seq || from_le64(&hdr->lpos) != lpos) {
+		return false;
+	}
+
+	hdr->hdr_crc = 0;
+	if (spdk_crc32c_update(hdr, sizeof(*hdr), ~0u) != crc) {
+		return false;
+	}
+
+	return num_blocks > 0 && num_blocks < node->batch_blocks &&
+	       lpos % node->ring_blocks + 1 + num_blocks <= node->ring_blocks &&
+	       from_le64(&hdr->offset_blocks) + num_blocks <= node->replica_bdev.blockcnt;
+}
+
+static void
+replica_io_complete(struct spdk_bdev_io *bdev_io, int rc)
+{
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+	struct replica_io_channel *replica_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+
+	if (io_ctx->hdr_buf != NULL) {
+		spdk_iobuf_put(&replica_ch->iobuf, io_ctx->hdr_buf, replica_ch->node->replica_bdev.blocklen);
+		io_ctx->hdr_buf = NULL;
+	}
+
+	if (rc == 0) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+	} else if (rc == -ENOMEM) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+	} else {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void
+_replica_io_fail(void *ctx)
+{
+	replica_io_complete(ctx, -EIO);
+}
+
+/* Completion callback for the I/O passed through to a single bdev. */
+static void
+replica_passthru_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	replica_io_complete(orig_io, success ? 0 : -EIO);
+}
+
+static void
+replica_base_write(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+	struct replica_io_channel *replica_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	int rc;
+
+	rc = spdk_bdev_writev_blocks(replica_ch->node->descs[REPLICA_BASE], replica_ch->base_ch,
+				     bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+				     bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks,
+				     replica_passthru_done, bdev_io);
+	if (rc != 0) {
+		/* The write is journaled already, it is shipped anyway. */
+		SPDK_ERRLOG("ERROR on bdev_io submission!\n");
+		replica_io_complete(bdev_io, rc);
+	}
+}
+
+/* Send the writes journaled to the base bdev, in sequence. A write waits for the ones journaled
+ * before it, so that the base bdev only holds writes a recovery replays.
+ */
+static void
+replica_release_base_writes(struct vbdev_replica *node)
+{
+	struct replica_record *record;
+	struct spdk_bdev_io *bdev_io;
+	struct replica_bdev_io *io_ctx;
+
+	while ((record = node->next_base) != NULL && record->state != REPLICA_RECORD_JOURNALING) {
+		node->next_base = TAILQ_NEXT(record, link);
+		bdev_io = record->bdev_io;
+		record->bdev_io = NULL;
+		io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+		spdk_thread_send_msg(spdk_io_channel_get_thread(io_ctx->ch),
+				     record->state == REPLICA_RECORD_JOURNALED ? replica_base_write :
+				     _replica_io_fail, bdev_io);
+	}
+}
+
+static void
+_replica_journaled(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_replica *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_replica,
+				     replica_bdev);
+	struct replica_record *record = io_ctx->record;
+
+	io_ctx->record = NULL;
+	if (io_ctx->failed) {
+		SPDK_ERRLOG("%s: failed to journal write %" PRIu64 "\n", node->replica_bdev.name,
+			    record->seq);
+		record->state = REPLICA_RECORD_FAILED;
+	} else {
+		record->state = REPLICA_RECORD_JOURNALED;
+	}
+
+	replica_release_base_writes(node);
+}
+
+static void
+replica_journal_write_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)orig_io->driver_ctx;
+	struct vbdev_replica *node = SPDK_CONTAINEROF(orig_io->bdev, struct vbdev_replica,
+				     replica_bdev);
+
+	if (bdev_io != NULL) {
+		spdk_bdev_free_io(bdev_io);
+	}
+
+	io_ctx->failed |= !success;
+	if (--io_ctx->outstanding > 0) {
+		return;
+	}
+
+	spdk_thread_send_msg(node->thread, _replica_journaled, orig_io);
+}
+
+/* Write the header and the data of the record, the header making the record valid only if the
+ * data matches its CRC-32C.
+ */
+static void
+replica_journal_write(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+	struct replica_io_channel *replica_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	struct vbdev_replica *node = replica_ch->node;
+	struct replica_record *record = io_ctx->record;
+	struct replica_record_hdr *hdr = io_ctx->hdr_buf;
+	uint64_t block = replica_ring_block(node, record->lpos);
+	int rc;
+
+	memset(io_ctx->hdr_buf, 0, node->replica_bdev.blocklen);
+	memcpy(hdr->magic, VBDEV_REPLICA_RECORD_MAGIC, sizeof(hdr->magic));
+	to_le32(&hdr->data_crc, io_ctx->data_crc);
+	to_le64(&hdr->seq, record->seq);
+	to_le64(&hdr->lpos, record->lpos);
+	to_le64(&hdr->offset_blocks, record->offset_blocks);
+	to_le32(&hdr->num_blocks, record->num_blocks);
+	replica_hdr_crc(hdr);
+
+	io_ctx->outstanding = 2;
+	io_ctx->failed = false;
+	rc = spdk_bdev_write_blocks(node->descs[REPLICA_JOURNAL], replica_ch->journal_ch,
+				    io_ctx->hdr_buf, block, 1, replica_journal_write_done, bdev_io);
+	if (rc != 0) {
+		replica_journal_write_done(NULL, false, bdev_io);
+	}
+	rc = spdk_bdev_writev_blocks(node->descs[REPLICA_JOURNAL], replica_ch->journal_ch,
+				     bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt, block + 1,
+				     record->num_blocks, replica_journal_write_done, bdev_io);
+	if (rc != 0) {
+		replica_journal_write_done(NULL, false, bdev_io);
+	}
+}
+
+/* Allocate the next record of the journal for a write. Returns false if the journal is full. */
+static bool
+replica_record_alloc(struct vbdev_replica *node, struct spdk_bdev_io *bdev_io)
+{
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+	uint32_t num_blocks = bdev_io->u.bdev.num_blocks;
+	struct replica_record *record;
+	uint64_t lpos;
+
+	lpos = replica_record_lpos(node, node->tail_lpos, num_blocks);
+	if (lpos + 1 + num_blocks - replica_head_lpos(node) > node->ring_blocks) {
+		return false;
+	}
+
+	record = TAILQ_FIRST(&node->free_records);
+	if (record != NULL) {
+		TAILQ_REMOVE(&node->free_records, record, link);
+	} else {
+		record = malloc(sizeof(*record));
+		if (record == NULL) {
+			spdk_thread_send_msg(spdk_io_channel_get_thread(io_ctx->ch), _replica_io_fail,
+					     bdev_io);
+			return true;
+		}
+	}
+
+	record->seq = node->next_seq++;
+	record->lpos = lpos;
+	record->offset_blocks = bdev_io->u.bdev.offset_blocks;
+	record->num_blocks = num_blocks;
+	record->state = REPLICA_RECORD_JOURNALING;
+	record->superseded = false;
+	record->tsc = spdk_get_ticks();
+	record->bdev_io = bdev_io;
+	TAILQ_INSERT_TAIL(&node->records, record, link);
+	if (node->next_base == NULL) {
+		node->next_base = record;
+	}
+	node->tail_lpos = lpos + 1 + num_blocks;
+
+	io_ctx->record = record;
+	spdk_thread_send_msg(spdk_io_channel_get_thread(io_ctx->ch), replica_journal_write, bdev_io);
+
+	return true;
+}
+
+/* Allocate the records of the writes waiting for space, in order. */
+static void
+replica_resume_space_waiters(struct vbdev_replica *node)
+{
+	struct replica_bdev_io *io_ctx;
+
+	while ((io_ctx = TAILQ_FIRST(&node->space_waiters)) != NULL) {
+		if (!replica_record_alloc(node, spdk_bdev_io_from_ctx(io_ctx))) {
+			break;
+		}
+		TAILQ_REMOVE(&node->space_waiters, io_ctx, link);
+	}
+}
+
+static void
+_replica_alloc(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_replica *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_replica,
+				     replica_bdev);
+
+	/* Records are allocated in order, wait behind the writes already waiting. */
+	if (!TAILQ_EMPTY(&node->space_waiters) || !replica_record_alloc(node, bdev_io)) {
+		SPDK_DEBUGLOG(vbdev_replica, "%s: journal full\n", node->replica_bdev.name);
+		TAILQ_INSERT_TAIL(&node->space_waiters, io_ctx, link);
+	}
+}
+
+static void
+replica_write_crc_done(void *cb_arg, int status)
+{
+	struct spdk_bdev_io *bdev_io = cb_arg;
+	struct vbdev_replica *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_replica,
+				     replica_bdev);
+
+	if (status != 0) {
+		replica_io_complete(bdev_io, status);
+		return;
+	}
+
+	spdk_thread_send_msg(node->thread, _replica_alloc, bdev_io);
+}
+
+static void
+replica_write_start(struct spdk_bdev_io *bdev_io)
+{
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+	struct replica_io_channel *replica_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	int rc;
+
+	rc = spdk_accel_submit_crc32cv(replica_ch->accel_ch, &io_ctx->data_crc, bdev_io->u.bdev.iovs,
+				       bdev_io->u.bdev.iovcnt, 0, replica_write_crc_done, bdev_io);
+	if (rc != 0) {
+		replica_io_complete(bdev_io, rc);
+	}
+}
+
+static void
+replica_write_get_buf_cb(struct spdk_iobuf_entry *entry, void *buf)
+{
+	struct replica_bdev_io *io_ctx = SPDK_CONTAINEROF(entry, struct replica_bdev_io, iobuf);
+
+	io_ctx->hdr_buf = buf;
+	replica_write_start(spdk_bdev_io_from_ctx(io_ctx));
+}
+
+static void
+replica_submit_write(struct replica_io_channel *replica_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+
+	io_ctx->hdr_buf = spdk_iobuf_get(&replica_ch->iobuf, replica_ch->node->replica_bdev.blocklen,
+					 &io_ctx->iobuf, replica_write_get_buf_cb);
+	if (io_ctx->hdr_buf != NULL) {
+		replica_write_start(bdev_io);
+	}
+}
+
+static void
+replica_flush_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)orig_io->driver_ctx;
+
+	if (bdev_io != NULL) {
+		spdk_bdev_free_io(bdev_io);
+	}
+
+	io_ctx->failed |= !success;
+	if (--io_ctx->outstanding > 0) {
+		return;
+	}
+
+	replica_io_complete(orig_io, io_ctx->failed ? -EIO : 0);
+}
+
+/* Flush both the base bdev and the journal, which hold the writes not shipped yet. */
+static void
+replica_submit_flush(struct replica_io_channel *replica_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_replica *node = replica_ch->node;
+	int rc;
+
+	io_ctx->outstanding = 2;
+	io_ctx->failed = false;
+	rc = spdk_bdev_flush_blocks(node->descs[REPLICA_BASE], replica_ch->base_ch,
+				    bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks,
+				    replica_flush_done, bdev_io);
+	if (rc != 0) {
+		replica_flush_done(NULL, false, bdev_io);
+	}
+
+	if (!spdk_bdev_io_type_supported(node->bdevs[REPLICA_JOURNAL], SPDK_BDEV_IO_TYPE_FLUSH)) {
+		replica_flush_done(NULL, true, bdev_io);
+		return;
+	}
+	rc = spdk_bdev_flush_blocks(node->descs[REPLICA_JOURNAL], replica_ch->journal_ch, 0,
+				    node->bdevs[REPLICA_JOURNAL]->blockcnt, replica_flush_done, bdev_io);
+	if (rc != 0) {
+		replica_flush_done(NULL, false, bdev_io);
+	}
+}
+
+static void
+vbdev_replica_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct replica_io_channel *replica_ch = spdk_io_channel_get_ctx(ch);
+	struct replica_bdev_io *io_ctx = (struct replica_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_replica *node = replica_ch->node;
+	int rc = 0;
+
+	memset(io_ctx, 0, sizeof(*io_ctx));
+	io_ctx->ch = ch;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		rc = spdk_bdev_readv_blocks(node->descs[REPLICA_BASE], replica_ch->base_ch,
+					    bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+					    bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks,
+					    replica_passthru_done, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		replica_submit_write(replica_ch, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		replica_submit_flush(replica_ch, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_RESET:
+		rc = spdk_bdev_reset(node->descs[REPLICA_BASE], replica_ch->base_ch,
+				     replica_passthru_done, bdev_io);
+		break;
+	default:
+		SPDK_ERRLOG("replica: unknown I/O type %d\n", bdev_io->type);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+	if (rc != 0) {
+		if (rc != -ENOMEM) {
+			SPDK_ERRLOG("ERROR on bdev_io submission!\n");
+		}
+		replica_io_complete(bdev_io, rc);
+	}
+}
+
+static bool
+vbdev_replica_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+{
+	struct vbdev_replica *node = (struct vbdev_replica *)ctx;
+
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		return true;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_RESET:
+		return spdk_bdev_io_type_supported(node->bdevs[REPLICA_BASE], io_type);
+	default:
+		/* Write zeroes is emulated with regular writes by the bdev layer, which are
+		 * journaled and shipped as write zeroes.
+		 */
+		return false;
+	}
+}
+
+static struct spdk_io_channel *
+vbdev_replica_get_io_channel(void *ctx)
+{
+	struct vbdev_replica *node = (struct vbdev_replica *)ctx;
+
+	return spdk_get_io_channel(node);
+}
+
+/* Age of the oldest write not shipped yet, in ticks. */
+static uint64_t
+replica_rpo_ticks(struct vbdev_replica *node)
+{
+	struct replica_record *first = TAILQ_FIRST(&node->records);
+
+	return first != NULL ? spdk_get_ticks() - first->tsc : 0;
+}
+
+/* This is the output for bdev_get_bdevs() for this vbdev */
+static int
+vbdev_replica_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+{
+	struct vbdev_replica *node = (struct vbdev_replica *)ctx;
+	uint64_t ticks_hz = spdk_get_ticks_hz();
+	int i;
+
+	spdk_json_write_name(w, "replica");
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&node->replica_bdev));
+	for (i = 0; i < REPLICA_NUM_ROLES; i++) {
+		char key[32];
+
+		snprintf(key, sizeof(key), "%s_bdev_name", g_replica_roles[i]);
+		spdk_json_write_named_string(w, key, spdk_bdev_get_name(node->bdevs[i]));
+	}
+	spdk_json_write_named_uint32(w, "batch_size",
+				     node->batch_blocks * node->replica_bdev.blocklen);
+	spdk_json_write_named_uint64(w, "journal_blocks", node->ring_blocks);
+	spdk_json_write_named_uint64(w, "pending_blocks", node->tail_lpos - replica_head_lpos(node));
+	spdk_json_write_named_uint64(w, "rpo_us", replica_rpo_ticks(node) * SPDK_SEC_TO_USEC / ticks_hz);
+	spdk_json_write_named_uint64(w, "max_rpo_us", node->max_rpo_ticks * SPDK_SEC_TO_USEC / ticks_hz);
+	spdk_json_write_named_uint64(w, "num_shipped_writes", node->num_shipped_writes);
+	spdk_json_write_named_uint64(w, "num_coalesced_writes", node->num_coalesced_writes);
+	spdk_json_write_named_uint64(w, "num_zero_writes", node->num_zero_writes);
+	spdk_json_write_named_uint64(w, "num_shipped_blocks", node->num_shipped_blocks);
+	spdk_json_write_named_uint64(w, "num_batches", node->num_batches);
+	spdk_json_write_named_uint64(w, "num_ship_errors", node->num_ship_errors);
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
+/* This is used to generate JSON that can configure this module to its current state. */
+static int
+vbdev_replica_config_json(struct spdk_json_write_ctx *w)
+{
+	struct vbdev_replica *node;
+	int i;
+
+	TAILQ_FOREACH(node, &g_replica_nodes, link) {
+		const struct spdk_uuid *uuid = spdk_bdev_get_uuid(&node->replica_bdev);
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_replica_create");
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&node->replica_bdev));
+		for (i = 0; i < REPLICA_NUM_ROLES; i++) {
+			char key[32];
+
+			snprintf(key, sizeof(key), "%s_bdev_name", g_replica_roles[i]);
+			spdk_json_write_named_string(w, key, spdk_bdev_get_name(node->bdevs[i]));
+		}
+		if (!spdk_uuid_is_null(uuid)) {
+			spdk_json_write_named_uuid(w, "uuid", uuid);
+		}
+		spdk_json_write_named_uint32(w, "batch_size",
+					     node->batch_blocks * node->replica_bdev.blocklen);
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+	return 0;
+}
+
+static int
+replica_bdev_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	struct replica_io_channel *replica_ch = ctx_buf;
+	struct vbdev_replica *node = io_device;
+	int rc;
+
+	rc = spdk_iobuf_channel_init(&replica_ch->iobuf, "replica", 0, 0);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to create iobuf channel: %s\n", spdk_strerror(-rc));
+		return rc;
+	}
+
+	replica_ch->base_ch = spdk_bdev_get_io_channel(node->descs[REPLICA_BASE]);
+	replica_ch->journal_ch = spdk_bdev_get_io_channel(node->descs[REPLICA_JOURNAL]);
+	replica_ch->accel_ch = spdk_accel_get_io_channel();
+	if (!replica_ch->base_ch || !replica_ch->journal_ch || !replica_ch->accel_ch) {
+		if (replica_ch->accel_ch) {
+			spdk_put_io_channel(replica_ch->accel_ch);
+		}
+		if (replica_ch->journal_ch) {
+			spdk_put_io_channel(replica_ch->journal_ch);
+		}
+		if (replica_ch->base_ch) {
+			spdk_put_io_channel(replica_ch->base_ch);
+		}
+		spdk_iobuf_channel_fini(&replica_ch->iobuf);
+		return -ENOMEM;
+	}
+
+	replica_ch->node = node;
+
+	return 0;
+}
+
+static void
+replica_bdev_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct replica_io_channel *replica_ch = ctx_buf;
+
+	spdk_put_io_channel(replica_ch->accel_ch);
+	spdk_put_io_channel(replica_ch->journal_ch);
+	spdk_put_io_channel(replica_ch->base_ch);
+	spdk_iobuf_channel_fini(&replica_ch->iobuf);
+}
+
+static void
+replica_close_bdevs(struct vbdev_replica *node)
+{
+	int i;
+
+	for (i = REPLICA_NUM_ROLES - 1; i >= 0; i--) {
+		if (node->chs[i] != NULL) {
+			spdk_put_io_channel(node->chs[i]);
+		}
+		/* Unclaim the underlying bdev. */
+		spdk_bdev_module_release_bdev(node->bdevs[i]);
+		spdk_bdev_close(node->descs[i]);
+	}
+}
+
+/* The batch is on the remote bdev and the superblock updated, or it failed. */
+static void
+replica_ship_done(struct vbdev_replica *node, bool success)
+{
+	struct replica_record *record, *last = node->ship_last;
+
+	node->shipping = false;
+	node->ship_last = NULL;
+
+	if (!success) {
+		SPDK_ERRLOG("%s: failed to ship the journal, retrying later\n", node->replica_bdev.name);
+		node->num_ship_errors++;
+		node->ship_retry_tsc = spdk_get_ticks() +
+				       VBDEV_REPLICA_RETRY_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+		TAILQ_FOREACH(record, &node->records, link) {
+			record->superseded = false;
+			if (record == last) {
+				break;
+			}
+		}
+		return;
+	}
+
+	node->num_batches++;
+	do {
+		record = TAILQ_FIRST(&node->records);
+		TAILQ_REMOVE(&node->records, record, link);
+		TAILQ_INSERT_HEAD(&node->free_records, record, link);
+	} while (record != last);
+
+	/* The space of the batch can be reused. */
+	replica_resume_space_waiters(node);
+}
+
+static void
+replica_ship_sb_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_replica *node = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	replica_ship_done(node, success);
+}
+
+/* Move the head of the journal past the batch. */
+static void
+replica_ship_persist_head(struct vbdev_replica *node)
+{
+	struct replica_record *next = TAILQ_NEXT(node->ship_last, link);
+	int rc;
+
+	to_le64(&node->sb->head_lpos, next != NULL ? next->lpos : node->tail_lpos);
+	to_le64(&node->sb->head_seq, next != NULL ? next->seq : node->next_seq);
+	rc = spdk_bdev_write_blocks(node->descs[REPLICA_JOURNAL], node->chs[REPLICA_JOURNAL],
+				    node->sb, 0, 1, replica_ship_sb_done, node);
+	if (rc != 0) {
+		replica_ship_done(node, false);
+	}
+}
+
+static void
+replica_ship_flush_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_replica *node = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		replica_ship_done(node, false);
+		return;
+	}
+
+	replica_ship_persist_head(node);
+}
+
+static void
+replica_ship_write_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_replica *node = cb_arg;
+	int rc;
+
+	if (bdev_io != NULL) {
+		spdk_bdev_free_io(bdev_io);
+	}
+
+	node->ship_failed |= !success;
+	if (--node->ship_outstanding > 0) {
+		return;
+	}
+
+	if (node->ship_failed) {
+		replica_ship_done(node, false);
+		return;
+	}
+
+	if (!node->remote_flush) {
+		replica_ship_persist_head(node);
+		return;
+	}
+
+	/* The writes must be persistent on the remote bdev before they leave the journal. */
+	rc = spdk_bdev_flush_blocks(node->descs[REPLICA_REMOTE], node->chs[REPLICA_REMOTE], 0,
+				    node->bdevs[REPLICA_REMOTE]->blockcnt, replica_ship_flush_done, node);
+	if (rc != 0) {
+		replica_ship_done(node, false);
+	}
+}
+
+/* Send the writes of the batch read from the journal to the remote bdev. */
+static void
+replica_ship_read_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_replica *node = cb_arg;
+	struct replica_record *record, *first;
+	uint32_t blocklen = node->replica_bdev.blocklen;
+	uint8_t *data;
+	int rc;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		replica_ship_done(node, false);
+		return;
+	}
+
+	/* Hold a reference so that the batch doesn't complete while its writes are submitted. */
+	node->ship_outstanding = 1;
+	node->ship_failed = false;
+	first = TAILQ_FIRST(&node->records);
+	for (record = first; record != NULL; record = TAILQ_NEXT(record, link)) {
+		if (record->state == REPLICA_RECORD_JOURNALED && !record->superseded) {
+			data = (uint8_t *)node->ship_buf + (record->lpos - first->lpos + 1) * blocklen;
+			node->ship_outstanding++;
+			if (node->remote_write_zeroes &&
+			    spdk_mem_all_zero(data, (uint64_t)record->num_blocks * blocklen)) {
+				node->num_zero_writes++;
+				rc = spdk_bdev_write_zeroes_blocks(node->descs[REPLICA_REMOTE],
+								   node->chs[REPLICA_REMOTE],
+								   record->offset_blocks, record->num_blocks,
+								   replica_ship_write_done, node);
+			} else {
+				rc = spdk_bdev_write_blocks(node->descs[REPLICA_REMOTE],
+							    node->chs[REPLICA_REMOTE], data,
+							    record->offset_blocks, record->num_blocks,
+							    replica_ship_write_done, node);
+			}
+			if (rc != 0) {
+				replica_ship_write_done(NULL, false, node);
+			}
+			node->num_shipped_writes++;
+			node->num_shipped_blocks += record->num_blocks;
+		} else if (record->superseded) {
+			node->num_coalesced_writes++;
+		}
+		if (record == node->ship_last) {
+			break;
+		}
+	}
+
+	replica_ship_write_done(NULL, true, node);
+}
+
+/* Check whether a record can join the batch, marking the earlier writes it covers. A write
+ * partially overlapping an earlier one waits for the next batch, so that the writes sent at
+ * the same time never overlap.
+ */
+static bool
+replica_ship_add(struct vbdev_replica *node, struct replica_record *record)
+{
+	struct replica_record *prev;
+	uint64_t start = record->offset_blocks, end = start + record->num_blocks;
+	uint64_t prev_start, prev_end;
+
+	if (record->state == REPLICA_RECORD_FAILED) {
+		return true;
+	}
+
+	for (prev = TAILQ_FIRST(&node->records); prev != record; prev = TAILQ_NEXT(prev, link)) {
+		if (prev->state != REPLICA_RECORD_JOURNALED || prev->superseded) {
+			continue;
+		}
+		prev_start = prev->offset_blocks;
+		prev_end = prev_start + prev->num_blocks;
+		if (prev_start < end && start < prev_end && (prev_start < start || prev_end > end)) {
+			return false;
+		}
+	}
+
+	for (prev = TAILQ_FIRST(&node->records); prev != record; prev = TAILQ_NEXT(prev, link)) {
+		if (prev->state == REPLICA_RECORD_JOURNALED && prev->offset_blocks >= start &&
+		    prev->offset_blocks + prev->num_blocks <= end) {
+			prev->superseded = true;
+		}
+	}
+
+	return true;
+}
+
+/* Read the next batch of records from the journal. Returns false if there is nothing to ship. */
+static bool
+replica_ship_start(struct vbdev_replica *node)
+{
+	struct replica_record *first, *record;
+	uint64_t num_blocks = 0;
+	uint32_t num_records = 0;
+	int rc;
+
+	first = TAILQ_FIRST(&node->records);
+	if (first == NULL || first->state == REPLICA_RECORD_JOURNALING) {
+		return false;
+	}
+
+	/* The records of a batch are contiguous in the journal. */
+	for (record = first; record != NULL; record = TAILQ_NEXT(record, link)) {
+		if (record->state == REPLICA_RECORD_JOURNALING ||
+		    record->lpos != first->lpos + num_blocks ||
+		    num_blocks + 1 + record->num_blocks > node->batch_blocks ||
+		    num_records == VBDEV_REPLICA_MAX_BATCH_RECORDS ||
+		    !replica_ship_add(node, record)) {
+			break;
+		}
+		num_blocks += 1 + record->num_blocks;
+		num_records++;
+		node->ship_last = record;
+	}
+
+	node->shipping = true;
+	rc = spdk_bdev_read_blocks(node->descs[REPLICA_JOURNAL], node->chs[REPLICA_JOURNAL],
+				   node->ship_buf, replica_ring_block(node, first->lpos), num_blocks,
+				   replica_ship_read_done, node);
+	if (rc != 0) {
+		replica_ship_done(node, false);
+	}
+
+	return true;
+}
+
+static int
+replica_poll(void *arg)
+{
+	struct vbdev_replica *node = arg;
+	uint64_t rpo;
+
+	if (node->deleting) {
+		if (node->shipping) {
+			return SPDK_POLLER_IDLE;
+		}
+
+		/* Nothing in flight anymore, finish the destruction. */
+		spdk_poller_unregister(&node->poller);
+		replica_close_bdevs(node);
+		spdk_io_device_unregister(node, _device_unregister_cb);
+		return SPDK_POLLER_BUSY;
+	}
+
+	rpo = replica_rpo_ticks(node);
+	node->max_rpo_ticks = spdk_max(node->max_rpo_ticks, rpo);
+
+	if (node->removed || node->shipping || spdk_get_ticks() < node->ship_retry_tsc) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	return replica_ship_start(node) ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+/* Create the replica association from the bdev names and insert on the global list. */
+static int
+vbdev_replica_insert_name(const char *vbdev_name, const char *bdev_names[REPLICA_NUM_ROLES],
+			  const struct spdk_uuid *uuid, uint32_t batch_size,
+			  struct bdev_names **_name)
+{
+	struct bdev_names *name;
+	int i;
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(vbdev_name, name->vbdev_name) == 0) {
+			SPDK_ERRLOG("replica bdev %s already exists\n", vbdev_name);
+			return -EEXIST;
+		}
+	}
+
+	name = calloc(1, sizeof(struct bdev_names));
+	if (!name) {
+		SPDK_ERRLOG("could not allocate bdev_names\n");
+		return -ENOMEM;
+	}
+
+	name->vbdev_name = strdup(vbdev_name);
+	for (i = 0; i < REPLICA_NUM_ROLES; i++) {
+		name->bdev_names[i] = strdup(bdev_names[i]);
+	}
+	if (!name->vbdev_name || !name->bdev_names[REPLICA_BASE] ||
+	    !name->bdev_names[REPLICA_JOURNAL] || !name->bdev_names[REPLICA_REMOTE]) {
+		SPDK_ERRLOG("could not allocate bdev names\n");
+		free(name->vbdev_name);
+		for (i = 0; i < REPLICA_NUM_ROLES; i++) {
+			free(name->bdev_names[i]);
+		}
+		free(name);
+		return -ENOMEM;
+	}
+
+	spdk_uuid_copy(&name->uuid, uuid);
+	name->batch_size = batch_size;
+	TAILQ_INSERT_TAIL(&g_bdev_names, name, link);
+	*_name = name;
+
+	return 0;
+}
+
+static void
+vbdev_replica_free_name(struct bdev_names *name)
+{
+	int i;
+
+	free(name->vbdev_name);
+	for (i = 0; i < REPLICA_NUM_ROLES; i++) {
+		free(name->bdev_names[i]);
+	}
+	free(name);
+}
+
+static void
+vbdev_replica_remove_name(const char *vbdev_name)
+{
+	struct bdev_names *name;
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(name->vbdev_name, vbdev_name) == 0) {
+			TAILQ_REMOVE(&g_bdev_names, name, link);
+			vbdev_replica_free_name(name);
+			break;
+		}
+	}
+}
+
+static int
+vbdev_replica_init(void)
+{
+	return spdk_iobuf_register_module("replica");
+}
+
+/* Called when the entire module is being torn down. */
+static void
+vbdev_replica_finish(void)
+{
+	struct bdev_names *name;
+
+	while ((name = TAILQ_FIRST(&g_bdev_names))) {
+		TAILQ_REMOVE(&g_bdev_names, name, link);
+		vbdev_replica_free_name(name);
+	}
+}
+
+static int
+vbdev_replica_get_ctx_size(void)
+{
+	return sizeof(struct replica_bdev_io);
+}
+
+static void
+vbdev_replica_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	/* No config per bdev needed */
+}
+
+/* When we register our bdev this is how we specify our entry points. */
+static const struct spdk_bdev_fn_table vbdev_replica_fn_table = {
+	.destruct		= vbdev_replica_destruct,
+	.submit_request		= vbdev_replica_submit_request,
+	.io_type_supported	= vbdev_replica_io_type_supported,
+	.get_io_channel		= vbdev_replica_get_io_channel,
+	.dump_info_json		= vbdev_replica_dump_info_json,
+	.write_config_json	= vbdev_replica_write_config_json,
+};
+
+static void
+vbdev_replica_base_bdev_hotremove_cb(struct spdk_bdev *bdev_find)
+{
+	struct vbdev_replica *node, *tmp;
+	int i;
+
+	TAILQ_FOREACH_SAFE(node, &g_replica_nodes, link, tmp) {
+		for (i = 0; i < REPLICA_NUM_ROLES; i++) {
+			if (bdev_find != node->bdevs[i] || node->removed) {
+				continue;
+			}
+			node->removed = true;
+			/* A bdev still loading its journal is cleaned up once that is done. */
+			if (!node->loading) {
+				spdk_bdev_unregister(&node->replica_bdev, NULL, NULL);
+			}
+		}
+	}
+}
+
+/* Called when the underlying bdev triggers asynchronous event such as bdev removal. */
+static void
+vbdev_replica_base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+				 void *event_ctx)
+{
+	switch (type) {
+	case SPDK_BDEV_EVENT_REMOVE:
+		vbdev_replica_base_bdev_hotremove_cb(bdev);
+		break;
+	default:
+		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
+		break;
+	}
+}
+
+/* Check the geometry of the underlying bdevs and lay out the journal. */
+static int
+vbdev_replica_init_node(struct vbdev_replica *node, uint32_t batch_size)
+{
+	struct spdk_bdev *base = node->bdevs[REPLICA_BASE];
+	struct spdk_bdev *journal = node->bdevs[REPLICA_JOURNAL];
+	struct spdk_bdev *remote = node->bdevs[REPLICA_REMOTE];
+	int i;
+
+	for (i = 0; i < REPLICA_NUM_ROLES; i++) {
+		if (node->bdevs[i]->blocklen != base->blocklen || node->bdevs[i]->md_len != 0) {
+			SPDK_ERRLOG("base, journal and remote bdevs must have the same block size and "
+				    "no metadata\n");
+			return -EINVAL;
+		}
+	}
+
+	if (remote->blockcnt < base->blockcnt) {
+		SPDK_ERRLOG("remote bdev %s is smaller than base bdev %s\n", remote->name, base->name);
+		return -EINVAL;
+	}
+
+	/* A batch holds at least one record, a header block and a data block. */
+	if (batch_size % base->blocklen != 0 || batch_size / base->blocklen < 2) {
+		SPDK_ERRLOG("batch size %" PRIu32 " must be a multiple of the block size %" PRIu32
+			    " of at least two blocks\n", batch_size, base->blocklen);
+		return -EINVAL;
+	}
+	node->batch_blocks = batch_size / base->blocklen;
+
+	if (journal->blockcnt <= node->batch_blocks) {
+		SPDK_ERRLOG("journal bdev %s is smaller than a batch\n", journal->name);
+		return -EINVAL;
+	}
+	node->ring_blocks = journal->blockcnt - 1;
+
+	node->sb = spdk_dma_zmalloc(base->blocklen, 0x1000, NULL);
+	node->ship_buf = spdk_dma_zmalloc(batch_size, 0x1000, NULL);
+	if (!node->sb || !node->ship_buf) {
+		SPDK_ERRLOG("could not allocate replica buffers\n");
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/* The journal is loaded, register the bdev. */
+static void
+replica_load_done(struct vbdev_replica *node, int rc)
+{
+	bdev_replica_create_cb cb_fn = node->create_cb;
+	void *cb_arg = node->create_cb_arg;
+
+	node->loading = false;
+	if (rc == 0 && node->removed) {
+		rc = -ENODEV;
+	}
+
+	if (rc == 0) {
+		node->poller = SPDK_POLLER_REGISTER(replica_poll, node, VBDEV_REPLICA_POLL_US);
+		if (node->poller == NULL) {
+			rc = -ENOMEM;
+		}
+	}
+
+	if (rc == 0) {
+		spdk_io_device_register(node, replica_bdev_ch_create_cb, replica_bdev_ch_destroy_cb,
+					sizeof(struct replica_io_channel), node->replica_bdev.name);
+		SPDK_NOTICELOG("io_device created at: 0x%p\n", node);
+
+		rc = spdk_bdev_register(&node->replica_bdev);
+		if (rc) {
+			SPDK_ERRLOG("could not register replica_bdev\n");
+			spdk_io_device_unregister(node, NULL);
+			spdk_poller_unregister(&node->poller);
+		}
+	}
+
+	if (rc == 0) {
+		SPDK_NOTICELOG("created replica_bdev for: %s\n", node->replica_bdev.name);
+	} else {
+		SPDK_ERRLOG("could not create replica bdev %s: %s\n", node->replica_bdev.name,
+			    spdk_strerror(-rc));
+		TAILQ_REMOVE(&g_replica_nodes, node, link);
+		vbdev_replica_remove_name(node->replica_bdev.name);
+		replica_close_bdevs(node);
+		vbdev_replica_free(node);
+	}
+
+	if (cb_fn != NULL) {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static void
+replica_load_sb_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_replica *node = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	replica_load_done(node, success ? 0 : -EIO);
+}
+
+/* Initialize a journal not used for replication yet, empty. */
+static void
+replica_format(struct vbdev_replica *node)
+{
+	struct replica_sb *sb = node->sb;
+	int rc;
+
+	SPDK_NOTICELOG("formatting journal bdev %s for replica bdev %s\n",
+		       node->bdevs[REPLICA_JOURNAL]->name, node->replica_bdev.name);
+
+	memset(sb, 0, node->replica_bdev.blocklen);
+	memcpy(sb->magic, VBDEV_REPLICA_SB_MAGIC, sizeof(sb->magic));
+	to_le32(&sb->version, VBDEV_REPLICA_SB_VERSION);
+	to_le32(&sb->blocklen, node->replica_bdev.blocklen);
+	to_le64(&sb->ring_blocks, node->ring_blocks);
+	to_le64(&sb->base_blockcnt, node->replica_bdev.blockcnt);
+	to_le64(&sb->head_lpos, 0);
+	to_le64(&sb->head_seq, 1);
+	node->tail_lpos = 0;
+	node->next_seq = 1;
+
+	rc = spdk_bdev_write_blocks(node->descs[REPLICA_JOURNAL], node->chs[REPLICA_JOURNAL], sb, 0, 1,
+				    replica_load_sb_done, node);
+	if (rc != 0) {
+		replica_load_done(node, rc);
+	}
+}
+
+static void replica_load_next(struct vbdev_replica *node);
+
+/* The record is replayed on the base bdev, ship it. */
+static void
+replica_load_replay_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_replica *node = cb_arg;
+	struct replica_record_hdr *hdr = node->ship_buf;
+	struct replica_record *record;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		replica_load_done(node, -EIO);
+		return;
+	}
+
+	record = malloc(sizeof(*record));
+	if (record == NULL) {
+		replica_load_done(node, -ENOMEM);
+		return;
+	}
+	record->seq = node->load_seq;
+	record->lpos = node->load_try_lpos;
+	record->offset_blocks = from_le64(&hdr->offset_blocks);
+	record->num_blocks = from_le32(&hdr->num_blocks);
+	record->state = REPLICA_RECORD_JOURNALED;
+	record->superseded = false;
+	/* The time the write was journaled is lost. */
+	record->tsc = spdk_get_ticks();
+	record->bdev_io = NULL;
+	TAILQ_INSERT_TAIL(&node->records, record, link);
+
+	node->load_lpos = record->lpos + 1 + record->num_blocks;
+	node->load_seq++;
+	replica_load_next(node);
+}
+
+static void
+replica_load_data_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_replica *node = cb_arg;
+	struct replica_record_hdr *hdr = node->ship_buf;
+	uint32_t blocklen = node->replica_bdev.blocklen;
+	uint32_t num_blocks = from_le32(&hdr->num_blocks);
+	void *data = (uint8_t *)node->ship_buf + blocklen;
+	int rc;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		replica_load_done(node, -EIO);
+		return;
+	}
+
+	if (spdk_crc32c_update(data, (uint64_t)num_blocks * blocklen, ~0u) !=
+	    from_le32(&hdr->data_crc)) {
+		/* Torn record, the write wasn't completed. */
+		node->tail_lpos = node->load_lpos;
+		node->next_seq = node->load_seq;
+		replica_load_done(node, 0);
+		return;
+	}
+
+	/* The write may not have reached the base bdev, write it again. */
+	rc = spdk_bdev_write_blocks(node->descs[REPLICA_BASE], node->chs[REPLICA_BASE], data,
+				    from_le64(&hdr->offset_blocks), num_blocks, replica_load_replay_done,
+				    node);
+	if (rc != 0) {
+		replica_load_done(node, rc);
+	}
+}
+
+static void
+replica_load_hdr_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_replica *node = cb_arg;
+	struct replica_record_hdr *hdr = node->ship_buf;
+	uint32_t blocklen = node->replica_bdev.blocklen;
+	int rc;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		replica_load_done(node, -EIO);
+		return;
+	}
+
+	if (!replica_hdr_valid(node, hdr, node->load_try_lpos, node->load_seq)) {
+		if (node->load_try_lpos == node->load_lpos &&
+		    node->load_lpos % node->ring_blocks != 0) {
+			/* The record may have been put at the beginning of the ring. */
+			node->load_try_lpos = node->load_lpos + node->ring_blocks -
+					      node->load_lpos % node->ring_blocks;
+			rc = spdk_bdev_read_blocks(node->descs[REPLICA_JOURNAL], node->chs[REPLICA_JOURNAL],
+						   node->ship_buf, replica_ring_block(node, node->load_try_lpos),
+						   1, replica_load_hdr_done, node);
+			if (rc != 0) {
+				replica_load_done(node, rc);
+			}
+			return;
+		}
+
+		/* End of the journal. */
+		node->tail_lpos = node->load_lpos;
+		node->next_seq = node->load_seq;
+		SPDK_NOTICELOG("%s: %" PRIu64 " writes to ship in the journal\n",
+			       node->replica_bdev.name, node->next_seq - from_le64(&node->sb->head_seq));
+		replica_load_done(node, 0);
+		return;
+	}
+
+	rc = spdk_bdev_read_blocks(node->descs[REPLICA_JOURNAL], node->chs[REPLICA_JOURNAL],
+				   (uint8_t *)node->ship_buf + blocklen,
+				   replica_ring_block(node, node->load_try_lpos) + 1,
+				   from_le32(&hdr->num_blocks), replica_load_data_done, node);
+	if (rc != 0) {
+		replica_load_done(node, rc);
+	}
+}
+
+/* Read the header of the next record of the journal. */
+static void
+replica_load_next(struct vbdev_replica *node)
+{
+	int rc;
+
+	node->load_try_lpos = node->load_lpos;
+	rc = spdk_bdev_read_blocks(node->descs[REPLICA_JOURNAL], node->chs[REPLICA_JOURNAL],
+				   node->ship_buf, replica_ring_block(node, node->load_lpos), 1,
+				   replica_load_hdr_done, node);
+	if (rc != 0) {
+		replica_load_done(node, rc);
+	}
+}
+
+static void
+replica_load_sb_read_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_replica *node = cb_arg;
+	struct replica_sb *sb = node->sb;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		replica_load_done(node, -EIO);
+		return;
+	}
+
+	if (memcmp(sb->magic, VBDEV_REPLICA_SB_MAGIC, sizeof(sb->magic)) != 0) {
+		replica_format(node);
+		return;
+	}
+
+	if (from_le32(&sb->version) != VBDEV_REPLICA_SB_VERSION ||
+	    from_le32(&sb->blocklen) != node->replica_bdev.blocklen ||
+	    from_le64(&sb->ring_blocks) != node->ring_blocks ||
+	    from_le64(&sb->base_blockcnt) != node->replica_bdev.blockcnt) {
+		SPDK_ERRLOG("journal on bdev %s doesn't match the base bdev\n",
+			    node->bdevs[REPLICA_JOURNAL]->name);
+		replica_load_done(node, -EINVAL);
+		return;
+	}
+
+	node->load_lpos = from_le64(&sb->head_lpos);
+	node->load_seq = from_le64(&sb->head_seq);
+	replica_load_next(node);
+}
+
+/* Load the journal, replaying and shipping the writes it holds. */
+static void
+replica_load(struct vbdev_replica *node)
+{
+	int rc;
+
+	rc = spdk_bdev_read_blocks(node->descs[REPLICA_JOURNAL], node->chs[REPLICA_JOURNAL], node->sb,
+				   0, 1, replica_load_sb_read_done, node);
+	if (rc != 0) {
+		replica_load_done(node, rc);
+	}
+}
+
+/* Create the replica vbdev from the bdev names if all the underlying bdevs are present. The
+ * bdev is registered once its journal is loaded. This can be called either by the examine path
+ * or RPC method.
+ */
+static int
+vbdev_replica_register(struct bdev_names *name, bdev_replica_create_cb cb_fn, void *cb_arg)
+{
+	struct vbdev_replica *node;
+	struct spdk_uuid ns_uuid;
+	int rc = 0, i, opened, claimed = 0;
+
+	spdk_uuid_parse(&ns_uuid, BDEV_REPLICA_NAMESPACE_UUID);
+
+	node = calloc(1, sizeof(struct vbdev_replica));
+	if (!node) {
+		SPDK_ERRLOG("could not allocate replica node\n");
+		return -ENOMEM;
+	}
+	TAILQ_INIT(&node->records);
+	TAILQ_INIT(&node->free_records);
+	TAILQ_INIT(&node->space_waiters);
+
+	node->replica_bdev.name = strdup(name->vbdev_name);
+	if (!node->replica_bdev.name) {
+		SPDK_ERRLOG("could not allocate replica_bdev name\n");
+		vbdev_replica_free(node);
+		return -ENOMEM;
+	}
+	node->replica_bdev.product_name = "replica";
+
+	/* All the underlying bdevs must be present. */
+	for (opened = 0; opened < REPLICA_NUM_ROLES; opened++) {
+		rc = spdk_bdev_open_ext(name->bdev_names[opened], true, vbdev_replica_base_bdev_event_cb,
+					NULL, &node->descs[opened]);
+		if (rc) {
+			if (rc != -ENODEV) {
+				SPDK_ERRLOG("could not open bdev %s\n", name->bdev_names[opened]);
+			}
+			goto err_close;
+		}
+		node->bdevs[opened] = spdk_bdev_desc_get_bdev(node->descs[opened]);
+	}
+	SPDK_NOTICELOG("base, journal and remote bdevs opened\n");
+
+	node->replica_bdev.blocklen = node->bdevs[REPLICA_BASE]->blocklen;
+	node->replica_bdev.blockcnt = node->bdevs[REPLICA_BASE]->blockcnt;
+
+	rc = vbdev_replica_init_node(node, name->batch_size);
+	if (rc) {
+		goto err_close;
+	}
+
+	if (!spdk_uuid_is_null(&name->uuid)) {
+		/* Use the configured UUID */
+		spdk_uuid_copy(&node->replica_bdev.uuid, &name->uuid);
+	} else {
+		/* Generate UUID based on namespace UUID + base bdev UUID. */
+		rc = spdk_uuid_generate_sha1(&node->replica_bdev.uuid, &ns_uuid,
+					     (const char *)&node->bdevs[REPLICA_BASE]->uuid,
+					     sizeof(struct spdk_uuid));
+		if (rc) {
+			SPDK_ERRLOG("Unable to generate new UUID for replica bdev\n");
+			goto err_close;
+		}
+	}
+
+	node->replica_bdev.write_cache = node->bdevs[REPLICA_BASE]->write_cache ||
+					 node->bdevs[REPLICA_JOURNAL]->write_cache;
+	node->replica_bdev.required_alignment = node->bdevs[REPLICA_BASE]->required_alignment;
+	/* A write is a single record, which fits in a batch. */
+	node->replica_bdev.max_rw_size = node->batch_blocks - 1;
+	node->remote_flush = node->bdevs[REPLICA_REMOTE]->write_cache &&
+			     spdk_bdev_io_type_supported(node->bdevs[REPLICA_REMOTE],
+					     SPDK_BDEV_IO_TYPE_FLUSH);
+	node->remote_write_zeroes = spdk_bdev_io_type_supported(node->bdevs[REPLICA_REMOTE],
+				    SPDK_BDEV_IO_TYPE_WRITE_ZEROES);
+
+	node->replica_bdev.ctxt = node;
+	node->replica_bdev.fn_table = &vbdev_replica_fn_table;
+	node->replica_bdev.module = &replica_if;
+
+	/* Save the thread where the bdevs are opened, it owns the journal. */
+	node->thread = spdk_get_thread();
+
+	for (claimed = 0; claimed < REPLICA_NUM_ROLES; claimed++) {
+		rc = spdk_bdev_module_claim_bdev(node->bdevs[claimed], node->descs[claimed],
+						 node->replica_bdev.module);
+		if (rc) {
+			SPDK_ERRLOG("could not claim bdev %s\n", name->bdev_names[claimed]);
+			goto err_release;
+		}
+	}
+	SPDK_NOTICELOG("bdevs claimed\n");
+
+	for (i = 0; i < REPLICA_NUM_ROLES; i++) {
+		node->chs[i] = spdk_bdev_get_io_channel(node->descs[i]);
+		if (!node->chs[i]) {
+			SPDK_ERRLOG("could not get I/O channels\n");
+			rc = -ENOMEM;
+			goto err_release;
+		}
+	}
+
+	node->loading = true;
+	node->create_cb = cb_fn;
+	node->create_cb_arg = cb_arg;
+	TAILQ_INSERT_TAIL(&g_replica_nodes, node, link);
+
+	/* Completed by replica_load_done(), which calls cb_fn. */
+	replica_load(node);
+
+	return 0;
+
+err_release:
+	for (i = 0; i < REPLICA_NUM_ROLES; i++) {
+		if (node->chs[i]) {
+			spdk_put_io_channel(node->chs[i]);
+		}
+	}
+	while (claimed-- > 0) {
+		spdk_bdev_module_release_bdev(node->bdevs[claimed]);
+	}
+err_close:
+	while (opened-- > 0) {
+		spdk_bdev_close(node->descs[opened]);
+	}
+	vbdev_replica_free(node);
+
+	return rc;
+}
+
+/* Create the replica disk from the given bdev names. */
+int
+bdev_replica_create_disk(const char *vbdev_name, const char *base_bdev_name,
+			 const char *journal_bdev_name, const char *remote_bdev_name,
+			 const struct spdk_uuid *uuid, uint32_t batch_size,
+			 bdev_replica_create_cb cb_fn, void *cb_arg)
+{
+	const char *bdev_names[REPLICA_NUM_ROLES] = {base_bdev_name, journal_bdev_name, remote_bdev_name};
+	struct bdev_names *name;
+	int rc;
+
+	if (strcmp(base_bdev_name, journal_bdev_name) == 0 ||
+	    strcmp(base_bdev_name, remote_bdev_name) == 0 ||
+	    strcmp(journal_bdev_name, remote_bdev_name) == 0) {
+		SPDK_ERRLOG("base, journal and remote bdevs must be different\n");
+		return -EINVAL;
+	}
+
+	/* Insert the bdev names into our global name list even if they don't exist yet,
+	 * they may show up soon...
+	 */
+	rc = vbdev_replica_insert_name(vbdev_name, bdev_names, uuid, batch_size, &name);
+	if (rc) {
+		return rc;
+	}
+
+	rc = vbdev_replica_register(name, cb_fn, cb_arg);
+	if (rc == -ENODEV) {
+		/* This is not an error, we tracked the name above and it still
+		 * may show up later.
+		 */
+		SPDK_NOTICELOG("vbdev creation deferred pending base, journal or remote bdev arrival\n");
+		cb_fn(cb_arg, 0);
+		rc = 0;
+	} else if (rc != 0) {
+		vbdev_replica_remove_name(vbdev_name);
+	}
+
+	return rc;
+}
+
+void
+bdev_replica_delete_disk(const char *vbdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	int rc;
+
+	/* Some cleanup happens in the destruct callback. */
+	rc = spdk_bdev_unregister_by_name(vbdev_name, &replica_if, cb_fn, cb_arg);
+	if (rc == 0) {
+		/* Remove the association from g_bdev_names. This is required so that the vbdev
+		 * does not get re-created if the same bdevs are constructed at some other time,
+		 * unless one of the underlying bdevs was hot-removed.
+		 */
+		vbdev_replica_remove_name(vbdev_name);
+	} else {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static void
+vbdev_replica_examine(struct spdk_bdev *bdev)
+{
+	struct bdev_names *name, *tmp;
+	int i;
+
+	/* A failed creation removes its name. */
+	TAILQ_FOREACH_SAFE(name, &g_bdev_names, link, tmp) {
+		for (i = 0; i < REPLICA_NUM_ROLES; i++) {
+			if (strcmp(name->bdev_names[i], bdev->name) == 0) {
+				SPDK_NOTICELOG("Match on %s\n", bdev->name);
+				vbdev_replica_register(name, NULL, NULL);
+				break;
+			}
+		}
+	}
+
+	spdk_bdev_module_examine_done(&replica_if);
+}
+
+SPDK_LOG_REGISTER_COMPONENT(vbdev_replica)
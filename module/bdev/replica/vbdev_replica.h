@@ -0,0 +1,58 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#ifndef SPDK_VBDEV_REPLICA_H
+#define SPDK_VBDEV_REPLICA_H
+
+#include "spdk/stdinc.h"
+
+#include "spdk/bdev.h"
+#include "spdk/bdev_module.h"
+
+/* Default largest amount of journaled data shipped to the remote bdev at once, in bytes. */
+#define VBDEV_REPLICA_DEFAULT_BATCH_SIZE	(1024 * 1024)
+
+typedef void (*bdev_replica_create_cb)(void *cb_arg, int rc);
+
+/**
+ * Create new asynchronously replicated bdev.
+ *
+ * The replicated bdev has the size of the base bdev. Writes are appended to a journal on the
+ * journal bdev and then written to the base bdev, they complete without waiting for the remote
+ * bdev. The journal is shipped to the remote bdev in the background, in batches, in the order
+ * the writes were journaled. The journal is formatted if it doesn't hold the metadata of a
+ * replicated bdev yet, otherwise the writes it still holds are replayed on the base bdev and
+ * shipped.
+ *
+ * \param vbdev_name Name of the replicated bdev.
+ * \param base_bdev_name Bdev holding the local copy of the data.
+ * \param journal_bdev_name Bdev holding the journal, a fast local bdev.
+ * \param remote_bdev_name Bdev receiving the remote copy of the data, e.g. an NVMe-oF namespace.
+ * \param uuid Optional UUID to assign to the replicated bdev.
+ * \param batch_size Largest amount of data shipped at once in bytes. It must be a multiple of
+ * the block size of at least two blocks. It also limits the size of the writes.
+ * \param cb_fn Function to call once the journal is loaded and the bdev registered, or right
+ * away if the creation is deferred until all the bdevs show up. Not called if this function
+ * returns an error.
+ * \param cb_arg Argument to pass to cb_fn.
+ * \return 0 on success, other on failure.
+ */
+int bdev_replica_create_disk(const char *vbdev_name, const char *base_bdev_name,
+			     const char *journal_bdev_name, const char *remote_bdev_name,
+			     const struct spdk_uuid *uuid, uint32_t batch_size,
+			     bdev_replica_create_cb cb_fn, void *cb_arg);
+
+/**
+ * Delete replicated bdev. The writes not shipped yet stay in the journal, re-creating the bdev
+ * on the same bdevs ships them.
+ *
+ * \param vbdev_name Name of the replicated bdev.
+ * \param cb_fn Function to call after deletion.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void bdev_replica_delete_disk(const char *vbdev_name, spdk_bdev_unregister_cb cb_fn,
+			      void *cb_arg);
+
+#endif /* SPDK_VBDEV_REPLICA_H */
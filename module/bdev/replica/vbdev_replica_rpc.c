@@ -0,0 +1,145 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "vbdev_replica.h"
+#include "spdk/rpc.h"
+#include "spdk/util.h"
+#include "spdk/string.h"
+#include "spdk/log.h"
+
+/* Structure to hold the parameters for this RPC method. */
+struct rpc_bdev_replica_create {
+	char *name;
+	char *base_bdev_name;
+	char *journal_bdev_name;
+	char *remote_bdev_name;
+	struct spdk_uuid uuid;
+	uint32_t batch_size;
+	struct spdk_jsonrpc_request *request;
+};
+
+/* Free the allocated memory resource after the RPC handling. */
+static void
+free_rpc_bdev_replica_create(struct rpc_bdev_replica_create *r)
+{
+	free(r->name);
+	free(r->base_bdev_name);
+	free(r->journal_bdev_name);
+	free(r->remote_bdev_name);
+	free(r);
+}
+
+/* Structure to decode the input parameters for this RPC method. */
+static const struct spdk_json_object_decoder rpc_bdev_replica_create_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_replica_create, name), spdk_json_decode_string},
+	{"base_bdev_name", offsetof(struct rpc_bdev_replica_create, base_bdev_name), spdk_json_decode_string},
+	{"journal_bdev_name", offsetof(struct rpc_bdev_replica_create, journal_bdev_name), spdk_json_decode_string},
+	{"remote_bdev_name", offsetof(struct rpc_bdev_replica_create, remote_bdev_name), spdk_json_decode_string},
+	{"uuid", offsetof(struct rpc_bdev_replica_create, uuid), spdk_json_decode_uuid, true},
+	{"batch_size", offsetof(struct rpc_bdev_replica_create, batch_size), spdk_json_decode_uint32, true},
+};
+
+static void
+rpc_bdev_replica_create_cb(void *cb_arg, int rc)
+{
+	struct rpc_bdev_replica_create *req = cb_arg;
+	struct spdk_json_write_ctx *w;
+
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(req->request, rc, spdk_strerror(-rc));
+	} else {
+		w = spdk_jsonrpc_begin_result(req->request);
+		spdk_json_write_string(w, req->name);
+		spdk_jsonrpc_end_result(req->request, w);
+	}
+
+	free_rpc_bdev_replica_create(req);
+}
+
+/* Decode the parameters for this RPC method and properly construct the replicated
+ * device. Error status returned in the failed cases.
+ */
+static void
+rpc_bdev_replica_create(struct spdk_jsonrpc_request *request,
+			const struct spdk_json_val *params)
+{
+	struct rpc_bdev_replica_create *req;
+	int rc;
+
+	req = calloc(1, sizeof(*req));
+	if (req == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		return;
+	}
+
+	req->request = request;
+	req->batch_size = VBDEV_REPLICA_DEFAULT_BATCH_SIZE;
+
+	if (spdk_json_decode_object(params, rpc_bdev_replica_create_decoders,
+				    SPDK_COUNTOF(rpc_bdev_replica_create_decoders),
+				    req)) {
+		SPDK_DEBUGLOG(vbdev_replica, "spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		free_rpc_bdev_replica_create(req);
+		return;
+	}
+
+	rc = bdev_replica_create_disk(req->name, req->base_bdev_name, req->journal_bdev_name,
+				      req->remote_bdev_name, &req->uuid, req->batch_size,
+				      rpc_bdev_replica_create_cb, req);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		free_rpc_bdev_replica_create(req);
+	}
+}
+SPDK_RPC_REGISTER("bdev_replica_create", rpc_bdev_replica_create, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_replica_delete {
+	char *name;
+};
+
+static void
+free_rpc_bdev_replica_delete(struct rpc_bdev_replica_delete *req)
+{
+	free(req->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_replica_delete_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_replica_delete, name), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_replica_delete_cb(void *cb_arg, int bdeverrno)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (bdeverrno == 0) {
+		spdk_jsonrpc_send_bool_response(request, true);
+	} else {
+		spdk_jsonrpc_send_error_response(request, bdeverrno, spdk_strerror(-bdeverrno));
+	}
+}
+
+static void
+rpc_bdev_replica_delete(struct spdk_jsonrpc_request *request,
+			const struct spdk_json_val *params)
+{
+	struct rpc_bdev_replica_delete req = {NULL};
+
+	if (spdk_json_decode_object(params, rpc_bdev_replica_delete_decoders,
+				    SPDK_COUNTOF(rpc_bdev_replica_delete_decoders),
+				    &req)) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	bdev_replica_delete_disk(req.name, rpc_bdev_replica_delete_cb, request);
+
+cleanup:
+	free_rpc_bdev_replica_delete(&req);
+}
+SPDK_RPC_REGISTER("bdev_replica_delete", rpc_bdev_replica_delete, SPDK_RPC_RUNTIME)
@@ -23,6 +23,7 @@ struct spdk_vbdev_split_config {
 	char *base_bdev;
 	unsigned split_count;
 	uint64_t split_size_mb;
+	bool redirect_io;
 
 	SPDK_BDEV_PART_TAILQ splits;
 	struct spdk_bdev_part_base *split_base;
@@ -204,6 +205,7 @@ vbdev_split_create(struct spdk_vbdev_split_config *cfg)
 	char *name;
 	struct spdk_bdev *base_bdev;
 	struct bdev_part_tailq *split_base_tailq;
+	struct spdk_bdev_part_construct_opts opts;
 
 	assert(cfg->split_count > 0);
 
@@ -252,6 +254,9 @@ vbdev_split_create(struct spdk_vbdev_split_config *cfg)
 		      cfg->base_bdev, split_count, split_size_blocks);
 
 	offset_blocks = 0;
+	spdk_bdev_part_construct_opts_init(&opts, sizeof(opts));
+	opts.redirect_io = cfg->redirect_io;
+
 	for (i = 0; i < split_count; i++) {
 		struct spdk_bdev_part *d;
 
@@ -270,8 +275,8 @@ vbdev_split_create(struct spdk_vbdev_split_config *cfg)
 			goto err;
 		}
 
-		rc = spdk_bdev_part_construct(d, cfg->split_base, name, offset_blocks, split_size_blocks,
-					      "Split Disk");
+		rc = spdk_bdev_part_construct_ext(d, cfg->split_base, name, offset_blocks, split_size_blocks,
+						  "Split Disk", &opts);
 		free(name);
 		if (rc) {
 			SPDK_ERRLOG("could not construct bdev part\n");
@@ -339,7 +344,7 @@ vbdev_split_config_find_by_base_name(const char *base_bdev_name)
 
 static int
 vbdev_split_add_config(const char *base_bdev_name, unsigned split_count, uint64_t split_size,
-		       struct spdk_vbdev_split_config **config)
+		       bool redirect_io, struct spdk_vbdev_split_config **config)
 {
 	struct spdk_vbdev_split_config *cfg;
 	assert(base_bdev_name);
@@ -376,6 +381,7 @@ vbdev_split_add_config(const char *base_bdev_name, unsigned split_count, uint64_
 
 	cfg->split_count = split_count;
 	cfg->split_size_mb = split_size;
+	cfg->redirect_io = redirect_io;
 	TAILQ_INSERT_TAIL(&g_split_config, cfg, tailq);
 	if (config) {
 		*config = cfg;
@@ -425,6 +431,7 @@ vbdev_split_config_json(struct spdk_json_write_ctx *w)
 		spdk_json_write_named_string(w, "base_bdev", cfg->base_bdev);
 		spdk_json_write_named_uint32(w, "split_count", cfg->split_count);
 		spdk_json_write_named_uint64(w, "split_size_mb", cfg->split_size_mb);
+		spdk_json_write_named_bool(w, "redirect_io", cfg->redirect_io);
 		spdk_json_write_object_end(w);
 
 		spdk_json_write_object_end(w);
@@ -434,12 +441,13 @@ vbdev_split_config_json(struct spdk_json_write_ctx *w)
 }
 
 int
-create_vbdev_split(const char *base_bdev_name, unsigned split_count, uint64_t split_size_mb)
+create_vbdev_split(const char *base_bdev_name, unsigned split_count, uint64_t split_size_mb,
+		   bool redirect_io)
 {
 	int rc;
 	struct spdk_vbdev_split_config *cfg;
 
-	rc = vbdev_split_add_config(base_bdev_name, split_count, split_size_mb, &cfg);
+	rc = vbdev_split_add_config(base_bdev_name, split_count, split_size_mb, redirect_io, &cfg);
 	if (rc) {
 		return rc;
 	}
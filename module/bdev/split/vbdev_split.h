@@ -16,9 +16,12 @@
  * \param base_bdev_name Base bdev name
  * \param split_count number of splits to be created.
  * \param split_size_mb size of each bdev. If 0 use base bdev size / split_count
+ * \param redirect_io redirect the I/Os of the split bdevs to the base bdev when possible,
+ * see spdk_bdev_part_construct_opts.
  * \return value >= 0 - number of splits create. Negative errno code on error.
  */
-int create_vbdev_split(const char *base_bdev_name, unsigned split_count, uint64_t split_size_mb);
+int create_vbdev_split(const char *base_bdev_name, unsigned split_count, uint64_t split_size_mb,
+		       bool redirect_io);
 
 /**
  * Remove all created split bdevs and split config.
@@ -0,0 +1,1590 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+/*
+ * A virtual block device module placing data on a fast and a capacity bdev by access frequency.
+ *
+ * The address space of the capacity bdev is split into fixed size extents, and the space of
+ * the fast bdev past its metadata into slots of the same size. Each extent is stored either
+ * at its own offset on the capacity bdev or in one slot of the fast bdev. I/Os are split on
+ * the extent boundaries by the bdev layer, so each of them is forwarded to a single bdev.
+ *
+ * Every I/O bumps a per-extent heat counter. A migrator poller running on the thread that
+ * created the bdev sweeps the counters, halving them as it goes so that they reflect the
+ * recent accesses, and picks the hottest extents of the capacity bdev and the coldest ones
+ * of the fast bdev. The hot extents are promoted to the free slots and, once there are none
+ * left, a fast extent is demoted to make room only if it is clearly colder.
+ *
+ * Moving an extent blocks the new I/Os to it, which wait on their channel, and waits for the
+ * ones in flight to complete. The extent is then copied, its map entry updated on the fast
+ * bdev and the I/Os are released. The map is only written after the copy is on the
+ * destination, so the extent is found at one of its two valid locations after a crash.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "vbdev_tier.h"
+#include "spdk/rpc.h"
+#include "spdk/bit_array.h"
+#include "spdk/endian.h"
+#include "spdk/env.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+
+#include "spdk/bdev_module.h"
+#include "spdk/log.h"
+
+/* This namespace UUID was generated using uuid_generate() method. */
+#define BDEV_TIER_NAMESPACE_UUID "d0b4ea47-5707-400a-99a4-727e96b8328c"
+
+#define VBDEV_TIER_MD_MAGIC		"SPDKTIER"
+#define VBDEV_TIER_MD_VERSION		1
+/* Largest I/O used to load and format the metadata, in bytes. */
+#define VBDEV_TIER_MD_IO_SIZE		(1024 * 1024)
+/* Largest I/O used to copy an extent to the other bdev, in bytes. */
+#define VBDEV_TIER_COPY_SIZE		(1024 * 1024)
+/* Number of extents looked at on each run of the migrator poller. */
+#define VBDEV_TIER_SWEEP_EXTENTS	4096
+/* Delay between the start of two sweeps of the heat counters. */
+#define VBDEV_TIER_SWEEP_INTERVAL_US	(1000 * 1000)
+/* Largest number of extents promoted, and demoted, after each sweep. */
+#define VBDEV_TIER_MIGRATE_BATCH	8
+/* Heat an extent of the capacity bdev needs to be promoted. */
+#define VBDEV_TIER_PROMOTE_MIN_HEAT	8
+/* Period of the channel poller resubmitting the I/Os to extents being moved. */
+#define VBDEV_TIER_CH_POLL_US		100
+/* Set in the I/O state of an extent while it is moved to the other bdev. */
+#define VBDEV_TIER_EXTENT_MIGRATING	(1U << 31)
+
+static int vbdev_tier_init(void);
+static int vbdev_tier_get_ctx_size(void);
+static void vbdev_tier_examine(struct spdk_bdev *bdev);
+static void vbdev_tier_finish(void);
+static int vbdev_tier_config_json(struct spdk_json_write_ctx *w);
+
+static struct spdk_bdev_module tier_if = {
+	.name = "tier",
+	.module_init = vbdev_tier_init,
+	.get_ctx_size = vbdev_tier_get_ctx_size,
+	.examine_config = vbdev_tier_examine,
+	.module_fini = vbdev_tier_finish,
+	.config_json = vbdev_tier_config_json
+};
+
+SPDK_BDEV_MODULE_REGISTER(tier, &tier_if)
+
+/* List of tiering bdev names and their fast and capacity bdevs via configuration file.
+ * Used so we can parse the conf once at init and use this list in examine().
+ */
+struct bdev_names {
+	char			*vbdev_name;
+	char			*fast_bdev_name;
+	char			*capacity_bdev_name;
+	struct spdk_uuid	uuid;
+	uint32_t		extent_size;
+	TAILQ_ENTRY(bdev_names)	link;
+};
+static TAILQ_HEAD(, bdev_names) g_bdev_names = TAILQ_HEAD_INITIALIZER(g_bdev_names);
+
+/* Header of the metadata, in the first block of the fast bdev. It is followed by the map,
+ * starting on the next block, with one 32-bit entry per extent. All little-endian.
+ */
+struct tier_md_header {
+	char			magic[8];
+	uint32_t		version;
+	uint32_t		blocklen;
+	uint64_t		extent_blocks;
+	uint64_t		num_extents;
+	uint64_t		num_slots;
+	struct spdk_uuid	capacity_uuid;
+};
+SPDK_STATIC_ASSERT(sizeof(struct tier_md_header) == 56, "Incorrect size");
+
+struct tier_candidate {
+	uint64_t	extent;
+	uint32_t	heat;
+};
+
+struct tier_migrate_op {
+	uint64_t	extent;
+	bool		promote;
+};
+
+enum tier_migrate_state {
+	TIER_MIGRATE_IDLE,
+	/* Waiting for the I/Os to the extent to complete */
+	TIER_MIGRATE_DRAIN,
+	/* Copy, flush or map update in flight */
+	TIER_MIGRATE_BUSY,
+};
+
+struct tier_migrator {
+	struct spdk_io_channel		*fast_ch;
+	struct spdk_io_channel		*capacity_ch;
+	struct spdk_poller		*poller;
+	void				*buf;
+	uint64_t			buf_blocks;
+	/* Next extent to sweep */
+	uint64_t			cursor;
+	uint64_t			next_sweep_tsc;
+	/* Best candidates found by the sweep in progress */
+	struct tier_candidate		hot[VBDEV_TIER_MIGRATE_BATCH];
+	uint32_t			num_hot;
+	struct tier_candidate		cold[VBDEV_TIER_MIGRATE_BATCH];
+	uint32_t			num_cold;
+	/* Migrations planned by the last sweep */
+	struct tier_migrate_op		ops[VBDEV_TIER_MIGRATE_BATCH * 2];
+	uint32_t			num_ops;
+	uint32_t			next_op;
+	/* Migration in progress */
+	enum tier_migrate_state		state;
+	uint64_t			extent;
+	uint32_t			slot;
+	bool				promote;
+	uint64_t			copied;
+	uint64_t			chunk_blocks;
+};
+
+/* List of virtual bdevs and associated info for each. */
+struct vbdev_tier {
+	struct spdk_bdev		*fast_bdev;     /* the bdev hot extents are stored on */
+	struct spdk_bdev_desc		*fast_desc;
+	struct spdk_bdev		*capacity_bdev; /* the bdev cold extents are stored on */
+	struct spdk_bdev_desc		*capacity_desc;
+	struct spdk_bdev		tier_bdev;      /* the tiering virtual bdev */
+	uint32_t			extent_size;
+	uint64_t			extent_blocks;
+	uint64_t			num_extents;
+	uint64_t			num_slots;
+	/* Offset of the first slot on the fast bdev */
+	uint64_t			data_offset_blocks;
+	/* Copy of the metadata region at the beginning of the fast bdev */
+	void				*md_buf;
+	uint64_t			md_blocks;
+	/* For each extent, the slot of the fast bdev holding it plus one, or 0 if it is on
+	 * the capacity bdev. Points into md_buf and only changed while the extent is blocked.
+	 */
+	uint32_t			*map;
+	/* For each extent, the number of I/Os in flight plus VBDEV_TIER_EXTENT_MIGRATING */
+	uint32_t			*io_state;
+	/* For each extent, the number of I/Os submitted, halved on every sweep */
+	uint32_t			*heat;
+	/* Stack of the slots not holding any extent, migrator only */
+	uint32_t			*free_slots;
+	uint64_t			num_free_slots;
+	struct tier_migrator		migrator;
+	uint64_t			num_promotions;
+	uint64_t			num_demotions;
+	/* Metadata loading, the bdev is registered once it is done */
+	bool				loading;
+	bool				formatting;
+	uint64_t			md_cursor;
+	bdev_tier_create_cb		create_cb;
+	void				*create_cb_arg;
+	/* The bdev is being destructed, clean up once the migration in progress is done */
+	bool				deleting;
+	/* The fast or capacity bdev was hot removed */
+	bool				removed;
+	TAILQ_ENTRY(vbdev_tier)		link;
+	struct spdk_thread		*thread;        /* thread where the bdevs are opened */
+};
+static TAILQ_HEAD(, vbdev_tier) g_tier_nodes = TAILQ_HEAD_INITIALIZER(g_tier_nodes);
+
+struct tier_bdev_io;
+
+struct tier_io_channel {
+	struct spdk_io_channel		*fast_ch;     /* IO channel of fast device */
+	struct spdk_io_channel		*capacity_ch; /* IO channel of capacity device */
+	struct vbdev_tier		*node;
+	/* I/Os waiting for their extent to be moved */
+	TAILQ_HEAD(, tier_bdev_io)	pending;
+	struct spdk_poller		*poller;
+};
+
+struct tier_bdev_io {
+	/* bdev related */
+	struct spdk_io_channel *ch;
+
+	/* for reads and writes, the extent accessed */
+	uint64_t extent;
+
+	/* for flushes and resets sent to both bdevs */
+	uint32_t outstanding;
+	enum spdk_bdev_io_status status;
+
+	/* for waiting on the extent to be moved */
+	TAILQ_ENTRY(tier_bdev_io) link;
+};
+
+static void vbdev_tier_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io);
+static void tier_migrate_copy(struct vbdev_tier *node);
+
+static void
+vbdev_tier_free(struct vbdev_tier *node)
+{
+	spdk_dma_free(node->migrator.buf);
+	spdk_dma_free(node->md_buf);
+	free(node->io_state);
+	free(node->heat);
+	free(node->free_slots);
+	free(node->tier_bdev.name);
+	free(node);
+}
+
+/* Callback for unregistering the IO device. */
+static void
+_device_unregister_cb(void *io_device)
+{
+	struct vbdev_tier *node = io_device;
+
+	spdk_bdev_destruct_done(&node->tier_bdev, 0);
+
+	/* Done with this node. */
+	vbdev_tier_free(node);
+}
+
+static void
+_vbdev_tier_destruct(void *ctx)
+{
+	struct vbdev_tier *node = ctx;
+
+	/* The migrator cleans up once the migration in progress is done. */
+	node->deleting = true;
+}
+
+/* Called after we've unregistered following a hot remove callback or a delete RPC. */
+static int
+vbdev_tier_destruct(void *ctx)
+{
+	struct vbdev_tier *node = (struct vbdev_tier *)ctx;
+
+	TAILQ_REMOVE(&g_tier_nodes, node, link);
+
+	if (node->thread != spdk_get_thread()) {
+		spdk_thread_send_msg(node->thread, _vbdev_tier_destruct, node);
+	} else {
+		_vbdev_tier_destruct(node);
+	}
+
+	/* Completed asynchronously with spdk_bdev_destruct_done(). */
+	return 1;
+}
+
+/* Number of blocks of an extent, only the last one may be shorter. */
+static inline uint64_t
+tier_extent_blocks(struct vbdev_tier *node, uint64_t extent)
+{
+	return spdk_min(node->extent_blocks, node->tier_bdev.blockcnt - extent * node->extent_blocks);
+}
+
+static inline uint64_t
+tier_slot_offset(struct vbdev_tier *node, uint32_t slot)
+{
+	return node->data_offset_blocks + slot * node->extent_blocks;
+}
+
+/* Block of the metadata region holding the map entry of an extent. */
+static inline uint64_t
+tier_map_block(struct vbdev_tier *node, uint64_t extent)
+{
+	return 1 + extent * sizeof(uint32_t) / node->tier_bdev.blocklen;
+}
+
+/* Account an I/O to an extent. Returns false if the extent is being moved, in which case
+ * the I/O has to be retried later.
+ */
+static inline bool
+tier_extent_get(struct vbdev_tier *node, uint64_t extent)
+{
+	uint32_t state;
+
+	state = __atomic_add_fetch(&node->io_state[extent], 1, __ATOMIC_SEQ_CST);
+	if (spdk_unlikely(state & VBDEV_TIER_EXTENT_MIGRATING)) {
+		__atomic_sub_fetch(&node->io_state[extent], 1, __ATOMIC_SEQ_CST);
+		return false;
+	}
+
+	return true;
+}
+
+static inline void
+tier_extent_put(struct vbdev_tier *node, uint64_t extent)
+{
+	__atomic_sub_fetch(&node->io_state[extent], 1, __ATOMIC_RELEASE);
+}
+
+static void
+tier_rw_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct tier_bdev_io *io_ctx = (struct tier_bdev_io *)orig_io->driver_ctx;
+	struct vbdev_tier *node = SPDK_CONTAINEROF(orig_io->bdev, struct vbdev_tier, tier_bdev);
+
+	spdk_bdev_free_io(bdev_io);
+
+	tier_extent_put(node, io_ctx->extent);
+	spdk_bdev_io_complete(orig_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+/* Forward a read or write to the bdev holding its extent. Returns false if the extent is
+ * being moved.
+ */
+static bool
+tier_rw_submit(struct tier_io_channel *tier_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct tier_bdev_io *io_ctx = (struct tier_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_tier *node = tier_ch->node;
+	uint64_t offset_blocks = bdev_io->u.bdev.offset_blocks;
+	uint64_t extent = offset_blocks / node->extent_blocks;
+	struct spdk_bdev_desc *desc;
+	struct spdk_io_channel *ch;
+	uint32_t slot;
+	int rc;
+
+	if (!tier_extent_get(node, extent)) {
+		return false;
+	}
+
+	io_ctx->extent = extent;
+	__atomic_fetch_add(&node->heat[extent], 1, __ATOMIC_RELAXED);
+
+	slot = from_le32(&node->map[extent]);
+	if (slot == 0) {
+		desc = node->capacity_desc;
+		ch = tier_ch->capacity_ch;
+	} else {
+		desc = node->fast_desc;
+		ch = tier_ch->fast_ch;
+		offset_blocks = tier_slot_offset(node, slot - 1) + offset_blocks % node->extent_blocks;
+	}
+
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_READ) {
+		rc = spdk_bdev_readv_blocks(desc, ch, bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+					    offset_blocks, bdev_io->u.bdev.num_blocks, tier_rw_done,
+					    bdev_io);
+	} else {
+		rc = spdk_bdev_writev_blocks(desc, ch, bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+					     offset_blocks, bdev_io->u.bdev.num_blocks, tier_rw_done,
+					     bdev_io);
+	}
+	if (rc != 0) {
+		tier_extent_put(node, extent);
+		if (rc == -ENOMEM) {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		} else {
+			SPDK_ERRLOG("ERROR on bdev_io submission!\n");
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		}
+	}
+
+	return true;
+}
+
+static void
+tier_submit_rw(struct tier_io_channel *tier_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct tier_bdev_io *io_ctx = (struct tier_bdev_io *)bdev_io->driver_ctx;
+
+	if (!tier_rw_submit(tier_ch, bdev_io)) {
+		/* Resubmitted by the channel poller once the extent is moved. */
+		TAILQ_INSERT_TAIL(&tier_ch->pending, io_ctx, link);
+	}
+}
+
+static void
+tier_read_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io, bool success)
+{
+	if (!success) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	tier_submit_rw(spdk_io_channel_get_ctx(ch), bdev_io);
+}
+
+static void
+tier_both_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct tier_bdev_io *io_ctx = (struct tier_bdev_io *)orig_io->driver_ctx;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		io_ctx->status = SPDK_BDEV_IO_STATUS_FAILED;
+	}
+
+	assert(io_ctx->outstanding > 0);
+	if (--io_ctx->outstanding == 0) {
+		spdk_bdev_io_complete(orig_io, io_ctx->status);
+	}
+}
+
+/* Forward a flush or reset to the bdevs supporting it. */
+static void
+tier_submit_both(struct tier_io_channel *tier_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct tier_bdev_io *io_ctx = (struct tier_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_tier *node = tier_ch->node;
+	struct spdk_bdev_desc *desc;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev *bdev;
+	int i, rc;
+
+	io_ctx->outstanding = 1;
+	io_ctx->status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	for (i = 0; i < 2; i++) {
+		desc = i == 0 ? node->fast_desc : node->capacity_desc;
+		ch = i == 0 ? tier_ch->fast_ch : tier_ch->capacity_ch;
+		bdev = spdk_bdev_desc_get_bdev(desc);
+		if (!spdk_bdev_io_type_supported(bdev, bdev_io->type)) {
+			continue;
+		}
+
+		if (bdev_io->type == SPDK_BDEV_IO_TYPE_FLUSH) {
+			rc = spdk_bdev_flush_blocks(desc, ch, 0, bdev->blockcnt, tier_both_done, bdev_io);
+		} else {
+			rc = spdk_bdev_reset(desc, ch, tier_both_done, bdev_io);
+		}
+		if (rc != 0) {
+			io_ctx->status = rc == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+					 SPDK_BDEV_IO_STATUS_FAILED;
+			break;
+		}
+		io_ctx->outstanding++;
+	}
+
+	if (--io_ctx->outstanding == 0) {
+		spdk_bdev_io_complete(bdev_io, io_ctx->status);
+	}
+}
+
+static int
+tier_ch_poll(void *arg)
+{
+	struct tier_io_channel *tier_ch = arg;
+	struct tier_bdev_io *io_ctx, *tmp;
+	int count = 0;
+
+	TAILQ_FOREACH_SAFE(io_ctx, &tier_ch->pending, link, tmp) {
+		if (tier_rw_submit(tier_ch, spdk_bdev_io_from_ctx(io_ctx))) {
+			TAILQ_REMOVE(&tier_ch->pending, io_ctx, link);
+			count++;
+		}
+	}
+
+	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+static void
+vbdev_tier_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct tier_io_channel *tier_ch = spdk_io_channel_get_ctx(ch);
+	struct tier_bdev_io *io_ctx = (struct tier_bdev_io *)bdev_io->driver_ctx;
+
+	io_ctx->ch = ch;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		spdk_bdev_io_get_buf(bdev_io, tier_read_get_buf_cb,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		tier_submit_rw(tier_ch, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_RESET:
+		tier_submit_both(tier_ch, bdev_io);
+		break;
+	default:
+		SPDK_ERRLOG("tier: unknown I/O type %d\n", bdev_io->type);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		break;
+	}
+}
+
+static bool
+vbdev_tier_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+{
+	struct vbdev_tier *node = (struct vbdev_tier *)ctx;
+
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		return true;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_RESET:
+		return spdk_bdev_io_type_supported(node->fast_bdev, io_type) ||
+		       spdk_bdev_io_type_supported(node->capacity_bdev, io_type);
+	default:
+		/* Unmap would have to go to the bdev holding each extent, write zeroes is
+		 * emulated with regular writes by the bdev layer.
+		 */
+		return false;
+	}
+}
+
+static struct spdk_io_channel *
+vbdev_tier_get_io_channel(void *ctx)
+{
+	struct vbdev_tier *node = (struct vbdev_tier *)ctx;
+
+	return spdk_get_io_channel(node);
+}
+
+/* This is the output for bdev_get_bdevs() for this vbdev */
+static int
+vbdev_tier_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+{
+	struct vbdev_tier *node = (struct vbdev_tier *)ctx;
+
+	spdk_json_write_name(w, "tier");
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&node->tier_bdev));
+	spdk_json_write_named_string(w, "fast_bdev_name", spdk_bdev_get_name(node->fast_bdev));
+	spdk_json_write_named_string(w, "capacity_bdev_name", spdk_bdev_get_name(node->capacity_bdev));
+	spdk_json_write_named_uint32(w, "extent_size", node->extent_size);
+	spdk_json_write_named_uint64(w, "num_extents", node->num_extents);
+	spdk_json_write_named_uint64(w, "num_slots", node->num_slots);
+	spdk_json_write_named_uint64(w, "num_free_slots", node->num_free_slots);
+	spdk_json_write_named_uint64(w, "num_promotions", node->num_promotions);
+	spdk_json_write_named_uint64(w, "num_demotions", node->num_demotions);
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
+/* This is used to generate JSON that can configure this module to its current state. */
+static int
+vbdev_tier_config_json(struct spdk_json_write_ctx *w)
+{
+	struct vbdev_tier *node;
+
+	TAILQ_FOREACH(node, &g_tier_nodes, link) {
+		const struct spdk_uuid *uuid = spdk_bdev_get_uuid(&node->tier_bdev);
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_tier_create");
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&node->tier_bdev));
+		spdk_json_write_named_string(w, "fast_bdev_name", spdk_bdev_get_name(node->fast_bdev));
+		spdk_json_write_named_string(w, "capacity_bdev_name",
+					     spdk_bdev_get_name(node->capacity_bdev));
+		if (!spdk_uuid_is_null(uuid)) {
+			spdk_json_write_named_uuid(w, "uuid", uuid);
+		}
+		spdk_json_write_named_uint32(w, "extent_size", node->extent_size);
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+	return 0;
+}
+
+static int
+tier_bdev_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	struct tier_io_channel *tier_ch = ctx_buf;
+	struct vbdev_tier *node = io_device;
+
+	tier_ch->fast_ch = spdk_bdev_get_io_channel(node->fast_desc);
+	if (tier_ch->fast_ch == NULL) {
+		goto err;
+	}
+
+	tier_ch->capacity_ch = spdk_bdev_get_io_channel(node->capacity_desc);
+	if (tier_ch->capacity_ch == NULL) {
+		goto err;
+	}
+
+	tier_ch->poller = SPDK_POLLER_REGISTER(tier_ch_poll, tier_ch, VBDEV_TIER_CH_POLL_US);
+	if (tier_ch->poller == NULL) {
+		goto err;
+	}
+
+	tier_ch->node = node;
+	TAILQ_INIT(&tier_ch->pending);
+
+	return 0;
+err:
+	if (tier_ch->capacity_ch != NULL) {
+		spdk_put_io_channel(tier_ch->capacity_ch);
+	}
+	if (tier_ch->fast_ch != NULL) {
+		spdk_put_io_channel(tier_ch->fast_ch);
+	}
+	return -ENOMEM;
+}
+
+static void
+tier_bdev_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct tier_io_channel *tier_ch = ctx_buf;
+
+	assert(TAILQ_EMPTY(&tier_ch->pending));
+
+	spdk_poller_unregister(&tier_ch->poller);
+	spdk_put_io_channel(tier_ch->capacity_ch);
+	spdk_put_io_channel(tier_ch->fast_ch);
+}
+
+/* Keep the VBDEV_TIER_MIGRATE_BATCH hottest or coldest extents seen by the sweep. */
+static void
+tier_candidate_add(struct tier_candidate *list, uint32_t *num, uint64_t extent, uint32_t heat,
+		   bool hot)
+{
+	uint32_t i, worst = 0;
+
+	if (*num < VBDEV_TIER_MIGRATE_BATCH) {
+		list[*num].extent = extent;
+		list[*num].heat = heat;
+		(*num)++;
+		return;
+	}
+
+	for (i = 1; i < VBDEV_TIER_MIGRATE_BATCH; i++) {
+		if (hot ? list[i].heat < list[worst].heat : list[i].heat > list[worst].heat) {
+			worst = i;
+		}
+	}
+
+	if (hot ? heat > list[worst].heat : heat < list[worst].heat) {
+		list[worst].extent = extent;
+		list[worst].heat = heat;
+	}
+}
+
+static int
+tier_candidate_cmp(const void *a, const void *b)
+{
+	const struct tier_candidate *ca = a, *cb = b;
+
+	return ca->heat < cb->heat ? -1 : ca->heat > cb->heat;
+}
+
+/* Plan the migrations once a sweep is over: promote the hottest extents to the free slots
+ * and, when there are none left, demote the coldest fast extents to make room. An extent is
+ * only demoted for one that is clearly hotter, so that extents don't bounce between the
+ * bdevs.
+ */
+static void
+tier_migrate_plan(struct vbdev_tier *node)
+{
+	struct tier_migrator *m = &node->migrator;
+	uint64_t num_free = node->num_free_slots;
+	uint32_t i, cold = 0;
+
+	qsort(m->hot, m->num_hot, sizeof(m->hot[0]), tier_candidate_cmp);
+	qsort(m->cold, m->num_cold, sizeof(m->cold[0]), tier_candidate_cmp);
+
+	m->num_ops = 0;
+	m->next_op = 0;
+	for (i = m->num_hot; i-- > 0;) {
+		if (num_free == 0) {
+			if (cold == m->num_cold ||
+			    m->hot[i].heat <= (uint64_t)m->cold[cold].heat * 2 + VBDEV_TIER_PROMOTE_MIN_HEAT) {
+				break;
+			}
+			m->ops[m->num_ops].extent = m->cold[cold++].extent;
+			m->ops[m->num_ops++].promote = false;
+			num_free++;
+		}
+		m->ops[m->num_ops].extent = m->hot[i].extent;
+		m->ops[m->num_ops++].promote = true;
+		num_free--;
+	}
+
+	m->num_hot = 0;
+	m->num_cold = 0;
+}
+
+static void
+tier_sweep(struct vbdev_tier *node)
+{
+	struct tier_migrator *m = &node->migrator;
+	uint64_t extent, end = spdk_min(m->cursor + VBDEV_TIER_SWEEP_EXTENTS, node->num_extents);
+	uint32_t heat;
+
+	for (extent = m->cursor; extent < end; extent++) {
+		/* Lose half of the heat on every sweep, recent accesses weigh the most. */
+		heat = __atomic_load_n(&node->heat[extent], __ATOMIC_RELAXED);
+		if (heat != 0) {
+			__atomic_store_n(&node->heat[extent], heat >> 1, __ATOMIC_RELAXED);
+		}
+
+		if (from_le32(&node->map[extent]) != 0) {
+			tier_candidate_add(m->cold, &m->num_cold, extent, heat, false);
+		} else if (heat >= VBDEV_TIER_PROMOTE_MIN_HEAT) {
+			tier_candidate_add(m->hot, &m->num_hot, extent, heat, true);
+		}
+	}
+	m->cursor = end;
+
+	if (m->cursor == node->num_extents) {
+		tier_migrate_plan(node);
+		m->cursor = 0;
+		m->next_sweep_tsc = spdk_get_ticks() +
+				    VBDEV_TIER_SWEEP_INTERVAL_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+	}
+}
+
+/* Start moving an extent, unless the plan is stale. Returns true if started. */
+static bool
+tier_migrate_start(struct vbdev_tier *node, const struct tier_migrate_op *op)
+{
+	struct tier_migrator *m = &node->migrator;
+	uint32_t slot = from_le32(&node->map[op->extent]);
+
+	if (op->promote) {
+		if (slot != 0 || node->num_free_slots == 0) {
+			return false;
+		}
+		m->slot = node->free_slots[--node->num_free_slots];
+	} else {
+		if (slot == 0) {
+			return false;
+		}
+		m->slot = slot - 1;
+	}
+
+	m->extent = op->extent;
+	m->promote = op->promote;
+	m->copied = 0;
+	m->state = TIER_MIGRATE_DRAIN;
+
+	/* The new I/Os to the extent wait on their channel from now on. */
+	__atomic_fetch_or(&node->io_state[m->extent], VBDEV_TIER_EXTENT_MIGRATING, __ATOMIC_SEQ_CST);
+
+	return true;
+}
+
+static void
+tier_migrate_done(struct vbdev_tier *node, bool success)
+{
+	struct tier_migrator *m = &node->migrator;
+
+	if (success) {
+		if (m->promote) {
+			node->num_promotions++;
+		} else {
+			node->free_slots[node->num_free_slots++] = m->slot;
+			node->num_demotions++;
+		}
+	} else {
+		SPDK_ERRLOG("%s: failed to %s extent %" PRIu64 "\n", node->tier_bdev.name,
+			    m->promote ? "promote" : "demote", m->extent);
+		if (m->promote) {
+			node->free_slots[node->num_free_slots++] = m->slot;
+		}
+		/* Drop the rest of the plan, the next sweep tries again. */
+		m->next_op = m->num_ops;
+	}
+
+	m->state = TIER_MIGRATE_IDLE;
+	__atomic_fetch_and(&node->io_state[m->extent], ~VBDEV_TIER_EXTENT_MIGRATING,
+			   __ATOMIC_RELEASE);
+}
+
+static void
+tier_migrate_commit_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_tier *node = cb_arg;
+	struct tier_migrator *m = &node->migrator;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		to_le32(&node->map[m->extent], m->promote ? 0 : m->slot + 1);
+	}
+
+	tier_migrate_done(node, success);
+}
+
+/* Point the map entry of the extent at its new location and persist it. */
+static void
+tier_migrate_commit(struct vbdev_tier *node)
+{
+	struct tier_migrator *m = &node->migrator;
+	uint64_t md_block = tier_map_block(node, m->extent);
+	int rc;
+
+	to_le32(&node->map[m->extent], m->promote ? m->slot + 1 : 0);
+
+	rc = spdk_bdev_write_blocks(node->fast_desc, m->fast_ch,
+				    (uint8_t *)node->md_buf + md_block * node->tier_bdev.blocklen,
+				    md_block, 1, tier_migrate_commit_done, node);
+	if (rc != 0) {
+		to_le32(&node->map[m->extent], m->promote ? 0 : m->slot + 1);
+		tier_migrate_done(node, false);
+	}
+}
+
+static void
+tier_migrate_flush_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_tier *node = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		tier_migrate_done(node, false);
+		return;
+	}
+
+	tier_migrate_commit(node);
+}
+
+static void
+tier_migrate_write_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_tier *node = cb_arg;
+	struct tier_migrator *m = &node->migrator;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		tier_migrate_done(node, false);
+		return;
+	}
+
+	m->copied += m->chunk_blocks;
+	tier_migrate_copy(node);
+}
+
+static void
+tier_migrate_read_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_tier *node = cb_arg;
+	struct tier_migrator *m = &node->migrator;
+	uint64_t offset_blocks;
+	int rc;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		tier_migrate_done(node, false);
+		return;
+	}
+
+	if (m->promote) {
+		offset_blocks = tier_slot_offset(node, m->slot) + m->copied;
+		rc = spdk_bdev_write_blocks(node->fast_desc, m->fast_ch, m->buf, offset_blocks,
+					    m->chunk_blocks, tier_migrate_write_done, node);
+	} else {
+		offset_blocks = m->extent * node->extent_blocks + m->copied;
+		rc = spdk_bdev_write_blocks(node->capacity_desc, m->capacity_ch, m->buf, offset_blocks,
+					    m->chunk_blocks, tier_migrate_write_done, node);
+	}
+	if (rc != 0) {
+		/* Including -ENOMEM, the extent is moved again after the next sweep. */
+		tier_migrate_done(node, false);
+	}
+}
+
+/* Copy the next chunk of the extent, then make the copy durable before updating the map. */
+static void
+tier_migrate_copy(struct vbdev_tier *node)
+{
+	struct tier_migrator *m = &node->migrator;
+	uint64_t num_blocks = tier_extent_blocks(node, m->extent);
+	uint64_t offset_blocks;
+	struct spdk_bdev_desc *desc;
+	struct spdk_io_channel *ch;
+	int rc;
+
+	if (m->copied == num_blocks) {
+		desc = m->promote ? node->fast_desc : node->capacity_desc;
+		ch = m->promote ? m->fast_ch : m->capacity_ch;
+		if (!spdk_bdev_io_type_supported(spdk_bdev_desc_get_bdev(desc),
+						 SPDK_BDEV_IO_TYPE_FLUSH)) {
+			tier_migrate_commit(node);
+			return;
+		}
+
+		offset_blocks = m->promote ? tier_slot_offset(node, m->slot) :
+				m->extent * node->extent_blocks;
+		rc = spdk_bdev_flush_blocks(desc, ch, offset_blocks, num_blocks,
+					    tier_migrate_flush_done, node);
+		if (rc != 0) {
+			tier_migrate_done(node, false);
+		}
+		return;
+	}
+
+	m->chunk_blocks = spdk_min(num_blocks - m->copied, m->buf_blocks);
+	if (m->promote) {
+		offset_blocks = m->extent * node->extent_blocks + m->copied;
+		rc = spdk_bdev_read_blocks(node->capacity_desc, m->capacity_ch, m->buf, offset_blocks,
+					   m->chunk_blocks, tier_migrate_read_done, node);
+	} else {
+		offset_blocks = tier_slot_offset(node, m->slot) + m->copied;
+		rc = spdk_bdev_read_blocks(node->fast_desc, m->fast_ch, m->buf, offset_blocks,
+					   m->chunk_blocks, tier_migrate_read_done, node);
+	}
+	if (rc != 0) {
+		tier_migrate_done(node, false);
+	}
+}
+
+static void
+tier_close_bdevs(struct vbdev_tier *node)
+{
+	spdk_put_io_channel(node->migrator.capacity_ch);
+	spdk_put_io_channel(node->migrator.fast_ch);
+
+	/* Unclaim the underlying bdevs. */
+	spdk_bdev_module_release_bdev(node->capacity_bdev);
+	spdk_bdev_module_release_bdev(node->fast_bdev);
+
+	spdk_bdev_close(node->capacity_desc);
+	spdk_bdev_close(node->fast_desc);
+}
+
+static int
+tier_migrate_poll(void *arg)
+{
+	struct vbdev_tier *node = arg;
+	struct tier_migrator *m = &node->migrator;
+
+	switch (m->state) {
+	case TIER_MIGRATE_IDLE:
+		break;
+	case TIER_MIGRATE_DRAIN:
+		if ((__atomic_load_n(&node->io_state[m->extent], __ATOMIC_ACQUIRE) &
+		     ~VBDEV_TIER_EXTENT_MIGRATING) != 0) {
+			return SPDK_POLLER_IDLE;
+		}
+		m->state = TIER_MIGRATE_BUSY;
+		tier_migrate_copy(node);
+		return SPDK_POLLER_BUSY;
+	default:
+		return SPDK_POLLER_IDLE;
+	}
+
+	if (node->deleting) {
+		/* Nothing in flight anymore, finish the destruction. */
+		spdk_poller_unregister(&m->poller);
+		tier_close_bdevs(node);
+		spdk_io_device_unregister(node, _device_unregister_cb);
+		return SPDK_POLLER_BUSY;
+	}
+
+	if (node->removed) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	while (m->next_op < m->num_ops) {
+		if (tier_migrate_start(node, &m->ops[m->next_op++])) {
+			return SPDK_POLLER_BUSY;
+		}
+	}
+
+	if (spdk_get_ticks() < m->next_sweep_tsc) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	tier_sweep(node);
+
+	return SPDK_POLLER_BUSY;
+}
+
+/* Create the tiering association from the bdev names and insert on the global list. */
+static int
+vbdev_tier_insert_name(const char *vbdev_name, const char *fast_bdev_name,
+		       const char *capacity_bdev_name, const struct spdk_uuid *uuid,
+		       uint32_t extent_size, struct bdev_names **_name)
+{
+	struct bdev_names *name;
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(vbdev_name, name->vbdev_name) == 0) {
+			SPDK_ERRLOG("tier bdev %s already exists\n", vbdev_name);
+			return -EEXIST;
+		}
+	}
+
+	name = calloc(1, sizeof(struct bdev_names));
+	if (!name) {
+		SPDK_ERRLOG("could not allocate bdev_names\n");
+		return -ENOMEM;
+	}
+
+	name->vbdev_name = strdup(vbdev_name);
+	name->fast_bdev_name = strdup(fast_bdev_name);
+	name->capacity_bdev_name = strdup(capacity_bdev_name);
+	if (!name->vbdev_name || !name->fast_bdev_name || !name->capacity_bdev_name) {
+		SPDK_ERRLOG("could not allocate bdev names\n");
+		free(name->vbdev_name);
+		free(name->fast_bdev_name);
+		free(name->capacity_bdev_name);
+		free(name);
+		return -ENOMEM;
+	}
+
+	spdk_uuid_copy(&name->uuid, uuid);
+	name->extent_size = extent_size;
+	TAILQ_INSERT_TAIL(&g_bdev_names, name, link);
+	*_name = name;
+
+	return 0;
+}
+
+static void
+vbdev_tier_free_name(struct bdev_names *name)
+{
+	free(name->vbdev_name);
+	free(name->fast_bdev_name);
+	free(name->capacity_bdev_name);
+	free(name);
+}
+
+static void
+vbdev_tier_remove_name(const char *vbdev_name)
+{
+	struct bdev_names *name;
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(name->vbdev_name, vbdev_name) == 0) {
+			TAILQ_REMOVE(&g_bdev_names, name, link);
+			vbdev_tier_free_name(name);
+			break;
+		}
+	}
+}
+
+static int
+vbdev_tier_init(void)
+{
+	return 0;
+}
+
+/* Called when the entire module is being torn down. */
+static void
+vbdev_tier_finish(void)
+{
+	struct bdev_names *name;
+
+	while ((name = TAILQ_FIRST(&g_bdev_names))) {
+		TAILQ_REMOVE(&g_bdev_names, name, link);
+		vbdev_tier_free_name(name);
+	}
+}
+
+static int
+vbdev_tier_get_ctx_size(void)
+{
+	return sizeof(struct tier_bdev_io);
+}
+
+static void
+vbdev_tier_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	/* No config per bdev needed */
+}
+
+/* When we register our bdev this is how we specify our entry points. */
+static const struct spdk_bdev_fn_table vbdev_tier_fn_table = {
+	.destruct		= vbdev_tier_destruct,
+	.submit_request		= vbdev_tier_submit_request,
+	.io_type_supported	= vbdev_tier_io_type_supported,
+	.get_io_channel		= vbdev_tier_get_io_channel,
+	.dump_info_json		= vbdev_tier_dump_info_json,
+	.write_config_json	= vbdev_tier_write_config_json,
+};
+
+static void
+vbdev_tier_base_bdev_hotremove_cb(struct spdk_bdev *bdev_find)
+{
+	struct vbdev_tier *node, *tmp;
+
+	TAILQ_FOREACH_SAFE(node, &g_tier_nodes, link, tmp) {
+		if (bdev_find == node->fast_bdev || bdev_find == node->capacity_bdev) {
+			node->removed = true;
+			/* A bdev still loading its metadata is cleaned up once that is done. */
+			if (!node->loading) {
+				spdk_bdev_unregister(&node->tier_bdev, NULL, NULL);
+			}
+		}
+	}
+}
+
+/* Called when the underlying bdev triggers asynchronous event such as bdev removal. */
+static void
+vbdev_tier_base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+			      void *event_ctx)
+{
+	switch (type) {
+	case SPDK_BDEV_EVENT_REMOVE:
+		vbdev_tier_base_bdev_hotremove_cb(bdev);
+		break;
+	default:
+		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
+		break;
+	}
+}
+
+/* Check the geometry of the fast and capacity bdevs and lay out the fast bdev. */
+static int
+vbdev_tier_init_node(struct vbdev_tier *node, uint32_t extent_size)
+{
+	struct spdk_bdev *fast = node->fast_bdev, *capacity = node->capacity_bdev;
+	if (fast->blocklen != capacity->blocklen) {
+		SPDK_ERRLOG("block sizes of fast bdev %s (%" PRIu32 ") and capacity bdev %s (%" PRIu32
+			    ") differ\n", fast->name, fast->blocklen, capacity->name, capacity->blocklen);
+		return -EINVAL;
+	}
+
+	if (fast->md_len != 0 || capacity->md_len != 0) {
+		SPDK_ERRLOG("bdevs with metadata are not supported\n");
+		return -EINVAL;
+	}
+
+	if (extent_size == 0 || extent_size % fast->blocklen != 0) {
+		SPDK_ERRLOG("extent size %" PRIu32 " is not a multiple of block size %" PRIu32 "\n",
+			    extent_size, fast->blocklen);
+		return -EINVAL;
+	}
+
+	node->extent_size = extent_size;
+	node->extent_blocks = extent_size / fast->blocklen;
+	node->num_extents = SPDK_CEIL_DIV(capacity->blockcnt, node->extent_blocks);
+	if (node->num_extents >= UINT32_MAX) {
+		SPDK_ERRLOG("capacity bdev %s has too many extents of %" PRIu32 " bytes\n",
+			    capacity->name, extent_size);
+		return -EINVAL;
+	}
+
+	/* The header block, then the map, then the slots aligned to the extent size. */
+	node->md_blocks = 1 + SPDK_CEIL_DIV(node->num_extents * sizeof(uint32_t), fast->blocklen);
+	node->data_offset_blocks = SPDK_CEIL_DIV(node->md_blocks, node->extent_blocks) *
+				   node->extent_blocks;
+	if (fast->blockcnt < node->data_offset_blocks + node->extent_blocks) {
+		SPDK_ERRLOG("fast bdev %s is too small to hold any extent\n", fast->name);
+		return -EINVAL;
+	}
+	node->num_slots = (fast->blockcnt - node->data_offset_blocks) / node->extent_blocks;
+	if (node->num_slots >= UINT32_MAX) {
+		SPDK_ERRLOG("fast bdev %s has too many extents of %" PRIu32 " bytes\n",
+			    fast->name, extent_size);
+		return -EINVAL;
+	}
+
+	node->migrator.buf_blocks = spdk_min(node->extent_blocks,
+					     spdk_max(VBDEV_TIER_COPY_SIZE / fast->blocklen, 1));
+
+	node->md_buf = spdk_dma_zmalloc(node->md_blocks * fast->blocklen, 0x1000, NULL);
+	node->migrator.buf = spdk_dma_malloc(node->migrator.buf_blocks * fast->blocklen, 0x1000,
+					     NULL);
+	node->io_state = calloc(node->num_extents, sizeof(uint32_t));
+	node->heat = calloc(node->num_extents, sizeof(uint32_t));
+	node->free_slots = calloc(node->num_slots, sizeof(uint32_t));
+	if (!node->md_buf || !node->migrator.buf || !node->io_state || !node->heat ||
+	    !node->free_slots) {
+		SPDK_ERRLOG("could not allocate tier metadata\n");
+		return -ENOMEM;
+	}
+	node->map = (uint32_t *)((uint8_t *)node->md_buf + fast->blocklen);
+
+	return 0;
+}
+
+/* The metadata is loaded, register the bdev. */
+static void
+tier_load_done(struct vbdev_tier *node, int rc)
+{
+	bdev_tier_create_cb cb_fn = node->create_cb;
+	void *cb_arg = node->create_cb_arg;
+
+	node->loading = false;
+	if (rc == 0 && node->removed) {
+		rc = -ENODEV;
+	}
+
+	if (rc == 0) {
+		node->migrator.poller = SPDK_POLLER_REGISTER(tier_migrate_poll, node, 0);
+		if (node->migrator.poller == NULL) {
+			rc = -ENOMEM;
+		}
+	}
+
+	if (rc == 0) {
+		spdk_io_device_register(node, tier_bdev_ch_create_cb, tier_bdev_ch_destroy_cb,
+					sizeof(struct tier_io_channel), node->tier_bdev.name);
+		SPDK_NOTICELOG("io_device created at: 0x%p\n", node);
+
+		rc = spdk_bdev_register(&node->tier_bdev);
+		if (rc) {
+			SPDK_ERRLOG("could not register tier_bdev\n");
+			spdk_io_device_unregister(node, NULL);
+			spdk_poller_unregister(&node->migrator.poller);
+		}
+	}
+
+	if (rc == 0) {
+		SPDK_NOTICELOG("created tier_bdev for: %s\n", node->tier_bdev.name);
+	} else {
+		SPDK_ERRLOG("could not create tier bdev %s: %s\n", node->tier_bdev.name,
+			    spdk_strerror(-rc));
+		TAILQ_REMOVE(&g_tier_nodes, node, link);
+		vbdev_tier_remove_name(node->tier_bdev.name);
+		tier_close_bdevs(node);
+		vbdev_tier_free(node);
+	}
+
+	if (cb_fn != NULL) {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+/* Check the metadata read from the fast bdev and rebuild the free slots from the map. */
+static int
+tier_md_parse(struct vbdev_tier *node)
+{
+	struct tier_md_header *hdr = node->md_buf;
+	struct spdk_bit_array *used;
+	uint64_t extent;
+	uint32_t slot;
+	int rc = 0;
+
+	if (from_le32(&hdr->version) != VBDEV_TIER_MD_VERSION ||
+	    from_le32(&hdr->blocklen) != node->tier_bdev.blocklen ||
+	    from_le64(&hdr->extent_blocks) != node->extent_blocks ||
+	    from_le64(&hdr->num_extents) != node->num_extents ||
+	    from_le64(&hdr->num_slots) != node->num_slots ||
+	    spdk_uuid_compare(&hdr->capacity_uuid, &node->capacity_bdev->uuid) != 0) {
+		SPDK_ERRLOG("metadata on fast bdev %s doesn't match capacity bdev %s or extent size\n",
+			    node->fast_bdev->name, node->capacity_bdev->name);
+		return -EINVAL;
+	}
+
+	used = spdk_bit_array_create(node->num_slots);
+	if (used == NULL) {
+		return -ENOMEM;
+	}
+
+	for (extent = 0; extent < node->num_extents; extent++) {
+		slot = from_le32(&node->map[extent]);
+		if (slot == 0) {
+			continue;
+		}
+		if (slot > node->num_slots || spdk_bit_array_get(used, slot - 1)) {
+			SPDK_ERRLOG("metadata on fast bdev %s is corrupted\n", node->fast_bdev->name);
+			rc = -EILSEQ;
+			goto out;
+		}
+		spdk_bit_array_set(used, slot - 1);
+	}
+
+	/* The lowest slots are used first. */
+	for (slot = node->num_slots; slot-- > 0;) {
+		if (!spdk_bit_array_get(used, slot)) {
+			node->free_slots[node->num_free_slots++] = slot;
+		}
+	}
+out:
+	spdk_bit_array_free(&used);
+
+	return rc;
+}
+
+static void tier_md_rw_next(struct vbdev_tier *node);
+
+static void
+tier_md_rw_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct vbdev_tier *node = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		tier_load_done(node, -EIO);
+		return;
+	}
+
+	tier_md_rw_next(node);
+}
+
+/* Initialize the metadata of a fast bdev not used for this capacity bdev yet, with all the
+ * extents on the capacity bdev.
+ */
+static void
+tier_md_format(struct vbdev_tier *node)
+{
+	struct tier_md_header *hdr = node->md_buf;
+	uint64_t slot;
+
+	SPDK_NOTICELOG("formatting fast bdev %s for tier bdev %s\n", node->fast_bdev->name,
+		       node->tier_bdev.name);
+
+	memset(node->md_buf, 0, node->md_blocks * node->tier_bdev.blocklen);
+	memcpy(hdr->magic, VBDEV_TIER_MD_MAGIC, sizeof(hdr->magic));
+	to_le32(&hdr->version, VBDEV_TIER_MD_VERSION);
+	to_le32(&hdr->blocklen, node->tier_bdev.blocklen);
+	to_le64(&hdr->extent_blocks, node->extent_blocks);
+	to_le64(&hdr->num_extents, node->num_extents);
+	to_le64(&hdr->num_slots, node->num_slots);
+	spdk_uuid_copy(&hdr->capacity_uuid, &node->capacity_bdev->uuid);
+
+	for (slot = node->num_slots; slot-- > 0;) {
+		node->free_slots[node->num_free_slots++] = slot;
+	}
+
+	node->formatting = true;
+	node->md_cursor = 0;
+	tier_md_rw_next(node);
+}
+
+/* Read or write the next chunk of the metadata region. */
+static void
+tier_md_rw_next(struct vbdev_tier *node)
+{
+	struct tier_md_header *hdr = node->md_buf;
+	uint32_t blocklen = node->tier_bdev.blocklen;
+	uint64_t offset_blocks = node->md_cursor, num_blocks;
+	void *buf;
+	int rc;
+
+	if (offset_blocks == node->md_blocks) {
+		if (node->formatting) {
+			tier_load_done(node, 0);
+		} else if (memcmp(hdr->magic, VBDEV_TIER_MD_MAGIC, sizeof(hdr->magic)) != 0) {
+			tier_md_format(node);
+		} else {
+			tier_load_done(node, tier_md_parse(node));
+		}
+		return;
+	}
+
+	num_blocks = spdk_min(node->md_blocks - offset_blocks,
+			      spdk_max(VBDEV_TIER_MD_IO_SIZE / blocklen, 1));
+	buf = (uint8_t *)node->md_buf + offset_blocks * blocklen;
+	node->md_cursor += num_blocks;
+	if (node->formatting) {
+		rc = spdk_bdev_write_blocks(node->fast_desc, node->migrator.fast_ch, buf,
+					    offset_blocks, num_blocks, tier_md_rw_done, node);
+	} else {
+		rc = spdk_bdev_read_blocks(node->fast_desc, node->migrator.fast_ch, buf,
+					   offset_blocks, num_blocks, tier_md_rw_done, node);
+	}
+	if (rc != 0) {
+		tier_load_done(node, rc);
+	}
+}
+
+/* Create the tiering vbdev from the bdev names if both its fast and capacity bdevs are
+ * present. The bdev is registered once its metadata is loaded. This can be called either by
+ * the examine path or RPC method.
+ */
+static int
+vbdev_tier_register(struct bdev_names *name, bdev_tier_create_cb cb_fn, void *cb_arg)
+{
+	struct vbdev_tier *node;
+	struct spdk_uuid ns_uuid;
+	int rc = 0;
+
+	spdk_uuid_parse(&ns_uuid, BDEV_TIER_NAMESPACE_UUID);
+
+	node = calloc(1, sizeof(struct vbdev_tier));
+	if (!node) {
+		SPDK_ERRLOG("could not allocate tier node\n");
+		return -ENOMEM;
+	}
+
+	node->tier_bdev.name = strdup(name->vbdev_name);
+	if (!node->tier_bdev.name) {
+		SPDK_ERRLOG("could not allocate tier_bdev name\n");
+		vbdev_tier_free(node);
+		return -ENOMEM;
+	}
+	node->tier_bdev.product_name = "tier";
+
+	/* Both the fast and capacity bdevs must be present. */
+	rc = spdk_bdev_open_ext(name->fast_bdev_name, true, vbdev_tier_base_bdev_event_cb,
+				NULL, &node->fast_desc);
+	if (rc) {
+		if (rc != -ENODEV) {
+			SPDK_ERRLOG("could not open bdev %s\n", name->fast_bdev_name);
+		}
+		vbdev_tier_free(node);
+		return rc;
+	}
+
+	rc = spdk_bdev_open_ext(name->capacity_bdev_name, true, vbdev_tier_base_bdev_event_cb,
+				NULL, &node->capacity_desc);
+	if (rc) {
+		if (rc != -ENODEV) {
+			SPDK_ERRLOG("could not open bdev %s\n", name->capacity_bdev_name);
+		}
+		spdk_bdev_close(node->fast_desc);
+		vbdev_tier_free(node);
+		return rc;
+	}
+	SPDK_NOTICELOG("fast and capacity bdevs opened\n");
+
+	node->fast_bdev = spdk_bdev_desc_get_bdev(node->fast_desc);
+	node->capacity_bdev = spdk_bdev_desc_get_bdev(node->capacity_desc);
+	node->tier_bdev.blocklen = node->capacity_bdev->blocklen;
+	node->tier_bdev.blockcnt = node->capacity_bdev->blockcnt;
+
+	rc = vbdev_tier_init_node(node, name->extent_size);
+	if (rc) {
+		goto err_close;
+	}
+
+	if (!spdk_uuid_is_null(&name->uuid)) {
+		/* Use the configured UUID */
+		spdk_uuid_copy(&node->tier_bdev.uuid, &name->uuid);
+	} else {
+		/* Generate UUID based on namespace UUID + capacity bdev UUID. */
+		rc = spdk_uuid_generate_sha1(&node->tier_bdev.uuid, &ns_uuid,
+					     (const char *)&node->capacity_bdev->uuid,
+					     sizeof(struct spdk_uuid));
+		if (rc) {
+			SPDK_ERRLOG("Unable to generate new UUID for tier bdev\n");
+			goto err_close;
+		}
+	}
+
+	node->tier_bdev.write_cache = node->fast_bdev->write_cache ||
+				      node->capacity_bdev->write_cache;
+	node->tier_bdev.required_alignment = spdk_max(node->fast_bdev->required_alignment,
+					     node->capacity_bdev->required_alignment);
+	/* Each read and write is sent to the bdev holding its extent. */
+	node->tier_bdev.optimal_io_boundary = node->extent_blocks;
+	node->tier_bdev.split_on_optimal_io_boundary = true;
+
+	node->tier_bdev.ctxt = node;
+	node->tier_bdev.fn_table = &vbdev_tier_fn_table;
+	node->tier_bdev.module = &tier_if;
+
+	/* Save the thread where the bdevs are opened, the migrator runs on it. */
+	node->thread = spdk_get_thread();
+
+	rc = spdk_bdev_module_claim_bdev(node->fast_bdev, node->fast_desc, node->tier_bdev.module);
+	if (rc) {
+		SPDK_ERRLOG("could not claim bdev %s\n", name->fast_bdev_name);
+		goto err_close;
+	}
+
+	rc = spdk_bdev_module_claim_bdev(node->capacity_bdev, node->capacity_desc,
+					 node->tier_bdev.module);
+	if (rc) {
+		SPDK_ERRLOG("could not claim bdev %s\n", name->capacity_bdev_name);
+		goto err_release;
+	}
+	SPDK_NOTICELOG("bdevs claimed\n");
+
+	node->migrator.fast_ch = spdk_bdev_get_io_channel(node->fast_desc);
+	node->migrator.capacity_ch = spdk_bdev_get_io_channel(node->capacity_desc);
+	if (!node->migrator.fast_ch || !node->migrator.capacity_ch) {
+		SPDK_ERRLOG("could not get I/O channels\n");
+		rc = -ENOMEM;
+		goto err_channels;
+	}
+
+	node->loading = true;
+	node->create_cb = cb_fn;
+	node->create_cb_arg = cb_arg;
+	TAILQ_INSERT_TAIL(&g_tier_nodes, node, link);
+
+	/* Completed by tier_load_done(), which calls cb_fn. */
+	tier_md_rw_next(node);
+
+	return 0;
+
+err_channels:
+	if (node->migrator.capacity_ch) {
+		spdk_put_io_channel(node->migrator.capacity_ch);
+	}
+	if (node->migrator.fast_ch) {
+		spdk_put_io_channel(node->migrator.fast_ch);
+	}
+	spdk_bdev_module_release_bdev(node->capacity_bdev);
+err_release:
+	spdk_bdev_module_release_bdev(node->fast_bdev);
+err_close:
+	spdk_bdev_close(node->capacity_desc);
+	spdk_bdev_close(node->fast_desc);
+	vbdev_tier_free(node);
+
+	return rc;
+}
+
+/* Create the tiering disk from the given bdev names. */
+int
+bdev_tier_create_disk(const char *vbdev_name, const char *fast_bdev_name,
+		      const char *capacity_bdev_name, const struct spdk_uuid *uuid,
+		      uint32_t extent_size, bdev_tier_create_cb cb_fn, void *cb_arg)
+{
+	struct bdev_names *name;
+	int rc;
+
+	if (strcmp(fast_bdev_name, capacity_bdev_name) == 0) {
+		SPDK_ERRLOG("fast and capacity bdev must be different\n");
+		return -EINVAL;
+	}
+
+	/* Insert the bdev names into our global name list even if they don't exist yet,
+	 * they may show up soon...
+	 */
+	rc = vbdev_tier_insert_name(vbdev_name, fast_bdev_name, capacity_bdev_name, uuid,
+				    extent_size, &name);
+	if (rc) {
+		return rc;
+	}
+
+	rc = vbdev_tier_register(name, cb_fn, cb_arg);
+	if (rc == -ENODEV) {
+		/* This is not an error, we tracked the name above and it still
+		 * may show up later.
+		 */
+		SPDK_NOTICELOG("vbdev creation deferred pending fast or capacity bdev arrival\n");
+		cb_fn(cb_arg, 0);
+		rc = 0;
+	} else if (rc != 0) {
+		vbdev_tier_remove_name(vbdev_name);
+	}
+
+	return rc;
+}
+
+void
+bdev_tier_delete_disk(const char *vbdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	int rc;
+
+	/* Some cleanup happens in the destruct callback. */
+	rc = spdk_bdev_unregister_by_name(vbdev_name, &tier_if, cb_fn, cb_arg);
+	if (rc == 0) {
+		/* Remove the association from g_bdev_names. This is required so that the vbdev
+		 * does not get re-created if the same bdevs are constructed at some other time,
+		 * unless one of the underlying bdevs was hot-removed.
+		 */
+		vbdev_tier_remove_name(vbdev_name);
+	} else {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static void
+vbdev_tier_examine(struct spdk_bdev *bdev)
+{
+	struct bdev_names *name, *tmp;
+
+	/* A failed creation removes its name. */
+	TAILQ_FOREACH_SAFE(name, &g_bdev_names, link, tmp) {
+		if (strcmp(name->fast_bdev_name, bdev->name) == 0 ||
+		    strcmp(name->capacity_bdev_name, bdev->name) == 0) {
+			SPDK_NOTICELOG("Match on %s\n", bdev->name);
+			vbdev_tier_register(name, NULL, NULL);
+		}
+	}
+
+	spdk_bdev_module_examine_done(&tier_if);
+}
+
+SPDK_LOG_REGISTER_COMPONENT(vbdev_tier)
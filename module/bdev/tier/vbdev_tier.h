@@ -0,0 +1,52 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#ifndef SPDK_VBDEV_TIER_H
+#define SPDK_VBDEV_TIER_H
+
+#include "spdk/stdinc.h"
+
+#include "spdk/bdev.h"
+#include "spdk/bdev_module.h"
+
+/* Default size of an extent, the unit data is moved between the tiers in, in bytes. */
+#define VBDEV_TIER_DEFAULT_EXTENT_SIZE	(1024 * 1024)
+
+typedef void (*bdev_tier_create_cb)(void *cb_arg, int rc);
+
+/**
+ * Create new tiering bdev.
+ *
+ * The tiering bdev has the size of the capacity bdev. Its most frequently accessed extents are
+ * moved to the fast bdev in the background, the others are stored on the capacity bdev. The
+ * location of the extents is persisted at the beginning of the fast bdev, which is formatted
+ * if it doesn't hold the metadata of this capacity bdev yet.
+ *
+ * \param vbdev_name Name of the tiering bdev.
+ * \param fast_bdev_name Bdev serving the hot extents and holding the metadata.
+ * \param capacity_bdev_name Bdev holding the cold extents.
+ * \param uuid Optional UUID to assign to the tiering bdev.
+ * \param extent_size Size of an extent in bytes. It must be a multiple of the block size.
+ * \param cb_fn Function to call once the metadata is loaded and the bdev registered, or right
+ * away if the creation is deferred until both bdevs show up. Not called if this function
+ * returns an error.
+ * \param cb_arg Argument to pass to cb_fn.
+ * \return 0 on success, other on failure.
+ */
+int bdev_tier_create_disk(const char *vbdev_name, const char *fast_bdev_name,
+			  const char *capacity_bdev_name, const struct spdk_uuid *uuid,
+			  uint32_t extent_size, bdev_tier_create_cb cb_fn, void *cb_arg);
+
+/**
+ * Delete tiering bdev. The extents stay where they are, re-creating the bdev on the same
+ * bdevs brings back its content.
+ *
+ * \param vbdev_name Name of the tiering bdev.
+ * \param cb_fn Function to call after deletion.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void bdev_tier_delete_disk(const char *vbdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg);
+
+#endif /* SPDK_VBDEV_TIER_H */
@@ -64,6 +64,32 @@ static TAILQ_HEAD(, bdev_uring) g_uring_bdev_head = TAILQ_HEAD_INITIALIZER(g_uri
 
 #define SPDK_URING_QUEUE_DEPTH 512
 #define MAX_EVENTS_PER_POLL 32
+#define SPDK_URING_SQPOLL_IDLE_MS_DEFAULT 1000
+
+static struct bdev_uring_module_opts g_opts = {
+	.iopoll = false,
+	.sqpoll = false,
+	.sqpoll_idle_ms = SPDK_URING_SQPOLL_IDLE_MS_DEFAULT,
+};
+
+void
+bdev_uring_get_opts(struct bdev_uring_module_opts *opts)
+{
+	*opts = g_opts;
+}
+
+int
+bdev_uring_set_opts(const struct bdev_uring_module_opts *opts)
+{
+	/* The options apply to the rings shared by all uring bdevs */
+	if (!TAILQ_EMPTY(&g_uring_bdev_head)) {
+		return -EPERM;
+	}
+
+	g_opts = *opts;
+
+	return 0;
+}
 
 static int
 bdev_uring_get_ctx_size(void)
@@ -71,10 +97,28 @@ bdev_uring_get_ctx_size(void)
 	return sizeof(struct bdev_uring_task);
 }
 
+static int
+bdev_uring_config_json(struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_object_begin(w);
+
+	spdk_json_write_named_string(w, "method", "bdev_uring_set_options");
+
+	spdk_json_write_named_object_begin(w, "params");
+	spdk_json_write_named_bool(w, "iopoll", g_opts.iopoll);
+	spdk_json_write_named_bool(w, "sqpoll", g_opts.sqpoll);
+	spdk_json_write_named_uint32(w, "sqpoll_idle_ms", g_opts.sqpoll_idle_ms);
+	spdk_json_write_object_end(w);
+
+	spdk_json_write_object_end(w);
+	return 0;
+}
+
 static struct spdk_bdev_module uring_if = {
 	.name		= "uring",
 	.module_init	= bdev_uring_init,
 	.module_fini	= bdev_uring_fini,
+	.config_json	= bdev_uring_config_json,
 	.get_ctx_size	= bdev_uring_get_ctx_size,
 };
 
@@ -87,6 +131,14 @@ bdev_uring_open(struct bdev_uring *bdev)
 
 	fd = open(bdev->filename, O_RDWR | O_DIRECT | O_NOATIME);
 	if (fd < 0) {
+		if (g_opts.iopoll) {
+			/* Polled I/O is only supported with O_DIRECT */
+			SPDK_ERRLOG("open() with O_DIRECT failed (file:%s), errno %d: %s, "
+				    "it is required by iopoll\n", bdev->filename, errno, spdk_strerror(errno));
+			bdev->fd = -1;
+			return -1;
+		}
+
 		/* Try without O_DIRECT for non-disk files */
 		fd = open(bdev->filename, O_RDWR | O_NOATIME);
 		if (fd < 0) {
@@ -741,11 +793,28 @@ static int
 bdev_uring_group_create_cb(void *io_device, void *ctx_buf)
 {
 	struct bdev_uring_group_channel *ch = ctx_buf;
+	struct io_uring_params params = {};
+	int rc;
 
-	/* Do not use IORING_SETUP_IOPOLL until the Linux kernel can support not only
-	 * local devices but also devices attached from remote target */
-	if (io_uring_queue_init(SPDK_URING_QUEUE_DEPTH, &ch->uring, 0) < 0) {
-		SPDK_ERRLOG("uring I/O context setup failure\n");
+	/* IORING_SETUP_IOPOLL is opt-in, as not only local devices but also devices attached
+	 * from a remote target can be behind the uring bdevs, and only the former can be polled.
+	 * Completions are then reaped by io_uring_peek_cqe(), which polls the device. */
+	if (g_opts.iopoll) {
+		params.flags |= IORING_SETUP_IOPOLL;
+	}
+
+	/* With IORING_SETUP_SQPOLL, a kernel thread dedicated to the ring of this SPDK thread
+	 * picks up the submissions, so io_uring_submit() only needs a system call to wake
+	 * it up after it has been idle for sqpoll_idle_ms. */
+	if (g_opts.sqpoll) {
+		params.flags |= IORING_SETUP_SQPOLL;
+		params.sq_thread_idle = g_opts.sqpoll_idle_ms;
+	}
+
+	rc = io_uring_queue_init_params(SPDK_URING_QUEUE_DEPTH, &ch->uring, &params);
+	if (rc < 0) {
+		SPDK_ERRLOG("uring I/O context setup failure (flags %#x): %s\n", params.flags,
+			    spdk_strerror(-rc));
 		return -1;
 	}
 
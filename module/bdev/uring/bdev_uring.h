@@ -22,10 +22,22 @@ struct bdev_uring_opts {
 	struct spdk_uuid uuid;
 };
 
+struct bdev_uring_module_opts {
+	/* Poll the devices for completions, requires O_DIRECT */
+	bool iopoll;
+	/* Submit through a kernel thread polling the submission queue */
+	bool sqpoll;
+	/* Idle time in ms after which the kernel submission thread goes to sleep */
+	uint32_t sqpoll_idle_ms;
+};
+
 struct spdk_bdev *create_uring_bdev(const struct bdev_uring_opts *opts);
 
 void delete_uring_bdev(const char *name, spdk_delete_uring_complete cb_fn, void *cb_arg);
 
 int bdev_uring_rescan(const char *name);
 
+void bdev_uring_get_opts(struct bdev_uring_module_opts *opts);
+int bdev_uring_set_opts(const struct bdev_uring_module_opts *opts);
+
 #endif /* SPDK_BDEV_URING_H */
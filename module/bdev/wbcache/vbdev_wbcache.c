@@ -0,0 +1,1741 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+/*
+ * A virtual block device module caching writes on a fast cache bdev.
+ *
+ * The cache bdev is split into fixed size log segments. Each channel owns one open
+ * segment and appends the writes submitted on it to that segment, so writes never
+ * contend across threads. Full segments are handed over to a destager poller running
+ * on the thread that created the bdev, which copies their live blocks to the base
+ * bdev and returns the segments to the free pool.
+ *
+ * The location of the most recent copy of each cached block is kept in an index
+ * shared by all the channels and updated with atomic operations only. A segment is
+ * only reused after every channel has seen its blocks removed from the index, which is
+ * detected with a per-channel epoch counting the reads that may still refer to it.
+ *
+ * The index lives in memory only, so the content of the cache bdev does not survive a
+ * restart. The bdev reports a volatile write cache and a flush completes once all the
+ * data written before it has been destaged to the base bdev.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "vbdev_wbcache.h"
+#include "spdk/rpc.h"
+#include "spdk/env.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+
+#include "spdk/bdev_module.h"
+#include "spdk/log.h"
+
+/* This namespace UUID was generated using uuid_generate() method. */
+#define BDEV_WBCACHE_NAMESPACE_UUID "c1e6f3a4-2b7d-4a58-8e09-5d3f1b6c72a9"
+
+/* Each level-2 table of the index covers this many blocks of the base bdev. */
+#define VBDEV_WBCACHE_INDEX_LEAF_SHIFT	16
+#define VBDEV_WBCACHE_INDEX_LEAF_SIZE	(1ULL << VBDEV_WBCACHE_INDEX_LEAF_SHIFT)
+/* Number of destage I/Os kept in flight at once. */
+#define VBDEV_WBCACHE_DESTAGE_QD	4
+/* Delay before destaging a segment again after an I/O error. */
+#define VBDEV_WBCACHE_DESTAGE_RETRY_US	(1000 * 1000)
+/* Period of the channel poller resubmitting writes waiting for a free segment. */
+#define VBDEV_WBCACHE_CH_POLL_US	100
+
+static int vbdev_wbcache_init(void);
+static int vbdev_wbcache_get_ctx_size(void);
+static void vbdev_wbcache_examine(struct spdk_bdev *bdev);
+static void vbdev_wbcache_finish(void);
+static int vbdev_wbcache_config_json(struct spdk_json_write_ctx *w);
+
+static struct spdk_bdev_module wbcache_if = {
+	.name = "wbcache",
+	.module_init = vbdev_wbcache_init,
+	.get_ctx_size = vbdev_wbcache_get_ctx_size,
+	.examine_config = vbdev_wbcache_examine,
+	.module_fini = vbdev_wbcache_finish,
+	.config_json = vbdev_wbcache_config_json
+};
+
+SPDK_BDEV_MODULE_REGISTER(wbcache, &wbcache_if)
+
+/* List of write-back cache bdev names and their base and cache bdevs via configuration
+ * file. Used so we can parse the conf once at init and use this list in examine().
+ */
+struct bdev_names {
+	char			*vbdev_name;
+	char			*base_bdev_name;
+	char			*cache_bdev_name;
+	struct spdk_uuid	uuid;
+	uint32_t		segment_size;
+	TAILQ_ENTRY(bdev_names)	link;
+};
+static TAILQ_HEAD(, bdev_names) g_bdev_names = TAILQ_HEAD_INITIALIZER(g_bdev_names);
+
+enum wbcache_segment_state {
+	/* In the free pool */
+	WBCACHE_SEGMENT_FREE,
+	/* Owned by a channel, writes are appended to it */
+	WBCACHE_SEGMENT_OPEN,
+	/* Retired by its channel, waiting for the writes in flight to complete */
+	WBCACHE_SEGMENT_CLOSING,
+	/* Waiting to be destaged */
+	WBCACHE_SEGMENT_CLOSED,
+	/* Being destaged */
+	WBCACHE_SEGMENT_DESTAGING,
+};
+
+struct wbcache_segment {
+	enum wbcache_segment_state	state;
+	/* Offset of the segment on the cache bdev */
+	uint64_t			offset_blocks;
+	/* Number of blocks appended so far */
+	uint64_t			write_ptr;
+	/* Writes submitted to the segment and not completed yet, owner channel only */
+	uint32_t			writes_inflight;
+	/* Order in which segments were opened, used to complete flushes */
+	uint64_t			seq;
+	TAILQ_ENTRY(wbcache_segment)	link;
+};
+
+struct wbcache_destage_io {
+	struct vbdev_wbcache		*wbc_node;
+	void				*buf;
+	uint64_t			offset_blocks;
+	uint64_t			cache_offset_blocks;
+	uint64_t			num_blocks;
+	bool				busy;
+};
+
+struct wbcache_destager {
+	struct wbcache_segment		*seg;
+	/* Next block of the segment to look at */
+	uint64_t			cursor;
+	uint32_t			inflight;
+	bool				failed;
+	/* Waiting for the channels to stop using the segment */
+	bool				barrier;
+	uint64_t			retry_tsc;
+	struct spdk_io_channel		*base_ch;
+	struct spdk_io_channel		*cache_ch;
+	struct wbcache_destage_io	ios[VBDEV_WBCACHE_DESTAGE_QD];
+};
+
+/* List of virtual bdevs and associated info for each. */
+struct vbdev_wbcache {
+	struct spdk_bdev		*base_bdev;  /* the thing we're attaching to */
+	struct spdk_bdev_desc		*base_desc;  /* its descriptor we get from open */
+	struct spdk_bdev		*cache_bdev; /* the bdev writes are staged on */
+	struct spdk_bdev_desc		*cache_desc;
+	struct spdk_bdev		wbc_bdev;    /* the write-back cache virtual bdev */
+	uint32_t			segment_size;
+	uint64_t			segment_blocks;
+	uint32_t			num_segments;
+	struct wbcache_segment		*segments;
+	/* Block of the base bdev stored in each block of the cache bdev */
+	uint64_t			*rmap;
+	/* Two level table with, for each block of the base bdev, the block of the cache bdev
+	 * holding its most recent data plus one, or 0 if the block isn't cached. The second
+	 * level tables are allocated on first write.
+	 */
+	uint32_t			**index;
+	uint64_t			num_index_leaves;
+	/* Protects the segment lists, the state of the segments not owned by a channel and
+	 * next_seq.
+	 */
+	struct spdk_spinlock		lock;
+	TAILQ_HEAD(, wbcache_segment)	free_segments;
+	TAILQ_HEAD(, wbcache_segment)	closed_segments;
+	uint32_t			num_free_segments;
+	uint32_t			num_channels;
+	uint64_t			next_seq;
+	/* Sequence number of the oldest segment that has not been destaged yet */
+	uint64_t			min_dirty_seq;
+	bool				base_flush;
+	struct wbcache_destager		destager;
+	struct spdk_poller		*destage_poller;
+	/* The bdev is being destructed, destage everything and clean up */
+	bool				deleting;
+	/* The base or cache bdev was hot removed, the cached data can't be destaged */
+	bool				removed;
+	TAILQ_ENTRY(vbdev_wbcache)	link;
+	struct spdk_thread		*thread;     /* thread where base device is opened */
+};
+static TAILQ_HEAD(, vbdev_wbcache) g_wbc_nodes = TAILQ_HEAD_INITIALIZER(g_wbc_nodes);
+
+struct wbcache_bdev_io;
+
+struct wbc_io_channel {
+	struct spdk_io_channel		*base_ch;  /* IO channel of base device */
+	struct spdk_io_channel		*cache_ch; /* IO channel of cache device */
+	struct vbdev_wbcache		*wbc_node;
+	struct spdk_iobuf_channel	iobuf;
+	/* Segment the writes submitted on this channel are appended to */
+	struct wbcache_segment		*seg;
+	/* Writes waiting for a free segment */
+	TAILQ_HEAD(, wbcache_bdev_io)	pending_writes;
+	/* Flushes waiting for the data to be destaged */
+	TAILQ_HEAD(, wbcache_bdev_io)	pending_flushes;
+	struct spdk_poller		*poller;
+	/* Reads in flight started in each epoch. A segment is reused only once all the
+	 * reads that could have looked up its blocks in the index have completed.
+	 */
+	uint32_t			epoch;
+	uint64_t			epoch_reads[2];
+	struct spdk_io_channel_iter	*barrier_iter;
+};
+
+struct wbcache_bdev_io {
+	/* bdev related */
+	struct spdk_io_channel *ch;
+
+	/* for writes, the segment and location the data was appended to */
+	struct wbcache_segment *seg;
+	uint64_t cache_offset_blocks;
+
+	/* for reads, the epoch the read was started in */
+	uint32_t epoch;
+
+	/* for reads assembled in a bounce buffer from both the cache and base bdev */
+	void *buf;
+	uint64_t cursor;
+	uint32_t outstanding;
+	enum spdk_bdev_io_status status;
+	struct spdk_iobuf_entry iobuf;
+
+	/* for flushes, the first segment with data written after the flush */
+	uint64_t flush_seq;
+
+	/* for waiting on a free segment or destage */
+	TAILQ_ENTRY(wbcache_bdev_io) link;
+};
+
+static void vbdev_wbcache_submit_request(struct spdk_io_channel *ch,
+		struct spdk_bdev_io *bdev_io);
+static void wbcache_destage_finish(struct vbdev_wbcache *wbc_node);
+
+static void
+vbdev_wbcache_free(struct vbdev_wbcache *wbc_node)
+{
+	uint64_t i;
+	int j;
+
+	if (wbc_node->index != NULL) {
+		for (i = 0; i < wbc_node->num_index_leaves; i++) {
+			free(wbc_node->index[i]);
+		}
+	}
+	for (j = 0; j < VBDEV_WBCACHE_DESTAGE_QD; j++) {
+		spdk_dma_free(wbc_node->destager.ios[j].buf);
+	}
+	free(wbc_node->index);
+	free(wbc_node->rmap);
+	free(wbc_node->segments);
+	spdk_spin_destroy(&wbc_node->lock);
+	free(wbc_node->wbc_bdev.name);
+	free(wbc_node);
+}
+
+/* Callback for unregistering the IO device. */
+static void
+_device_unregister_cb(void *io_device)
+{
+	struct vbdev_wbcache *wbc_node = io_device;
+
+	spdk_bdev_destruct_done(&wbc_node->wbc_bdev, 0);
+
+	/* Done with this wbc_node. */
+	vbdev_wbcache_free(wbc_node);
+}
+
+static void
+_vbdev_wbcache_destruct(void *ctx)
+{
+	struct vbdev_wbcache *wbc_node = ctx;
+
+	/* The destager cleans up once everything is destaged. */
+	wbc_node->deleting = true;
+}
+
+/* Called after we've unregistered following a hot remove callback or a delete RPC.
+ * The data left on the cache bdev is destaged before the destruction completes.
+ */
+static int
+vbdev_wbcache_destruct(void *ctx)
+{
+	struct vbdev_wbcache *wbc_node = (struct vbdev_wbcache *)ctx;
+
+	TAILQ_REMOVE(&g_wbc_nodes, wbc_node, link);
+
+	if (wbc_node->thread != spdk_get_thread()) {
+		spdk_thread_send_msg(wbc_node->thread, _vbdev_wbcache_destruct, wbc_node);
+	} else {
+		_vbdev_wbcache_destruct(wbc_node);
+	}
+
+	/* Completed asynchronously with spdk_bdev_destruct_done(). */
+	return 1;
+}
+
+static uint32_t *
+wbcache_index_leaf(struct vbdev_wbcache *wbc_node, uint64_t offset_blocks)
+{
+	return __atomic_load_n(&wbc_node->index[offset_blocks >> VBDEV_WBCACHE_INDEX_LEAF_SHIFT],
+			       __ATOMIC_ACQUIRE);
+}
+
+/* Return the block of the cache bdev holding the block at offset_blocks plus one, or 0. */
+static inline uint32_t
+wbcache_index_get(struct vbdev_wbcache *wbc_node, uint64_t offset_blocks)
+{
+	uint32_t *leaf = wbcache_index_leaf(wbc_node, offset_blocks);
+
+	if (leaf == NULL) {
+		return 0;
+	}
+
+	return __atomic_load_n(&leaf[offset_blocks & (VBDEV_WBCACHE_INDEX_LEAF_SIZE - 1)],
+			       __ATOMIC_RELAXED);
+}
+
+static inline void
+wbcache_index_set(struct vbdev_wbcache *wbc_node, uint64_t offset_blocks, uint32_t value)
+{
+	uint32_t *leaf = wbcache_index_leaf(wbc_node, offset_blocks);
+
+	assert(leaf != NULL);
+	__atomic_store_n(&leaf[offset_blocks & (VBDEV_WBCACHE_INDEX_LEAF_SIZE - 1)], value,
+			 __ATOMIC_RELAXED);
+}
+
+/* Remove the block at offset_blocks from the index, unless it was rewritten since. */
+static inline void
+wbcache_index_clear(struct vbdev_wbcache *wbc_node, uint64_t offset_blocks, uint32_t expected)
+{
+	uint32_t *leaf = wbcache_index_leaf(wbc_node, offset_blocks);
+
+	assert(leaf != NULL);
+	__atomic_compare_exchange_n(&leaf[offset_blocks & (VBDEV_WBCACHE_INDEX_LEAF_SIZE - 1)],
+				    &expected, 0, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/* Make sure the index can hold the given range of blocks. */
+static int
+wbcache_index_reserve(struct vbdev_wbcache *wbc_node, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	uint64_t i, first = offset_blocks >> VBDEV_WBCACHE_INDEX_LEAF_SHIFT;
+	uint64_t last = (offset_blocks + num_blocks - 1) >> VBDEV_WBCACHE_INDEX_LEAF_SHIFT;
+	uint32_t *leaf, *expected;
+
+	for (i = first; i <= last; i++) {
+		if (__atomic_load_n(&wbc_node->index[i], __ATOMIC_ACQUIRE) != NULL) {
+			continue;
+		}
+
+		leaf = calloc(VBDEV_WBCACHE_INDEX_LEAF_SIZE, sizeof(uint32_t));
+		if (leaf == NULL) {
+			return -ENOMEM;
+		}
+
+		expected = NULL;
+		if (!__atomic_compare_exchange_n(&wbc_node->index[i], &expected, leaf, false,
+						 __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+			/* Another thread installed it first. */
+			free(leaf);
+		}
+	}
+
+	return 0;
+}
+
+/* Called with the lock held whenever a segment is returned to the free pool. */
+static void
+wbcache_update_min_dirty_seq(struct vbdev_wbcache *wbc_node)
+{
+	uint64_t min_seq = wbc_node->next_seq;
+	uint32_t i;
+
+	for (i = 0; i < wbc_node->num_segments; i++) {
+		if (wbc_node->segments[i].state != WBCACHE_SEGMENT_FREE) {
+			min_seq = spdk_min(min_seq, wbc_node->segments[i].seq);
+		}
+	}
+
+	__atomic_store_n(&wbc_node->min_dirty_seq, min_seq, __ATOMIC_RELEASE);
+}
+
+static void
+wbcache_segment_free_locked(struct vbdev_wbcache *wbc_node, struct wbcache_segment *seg)
+{
+	seg->state = WBCACHE_SEGMENT_FREE;
+	seg->write_ptr = 0;
+	TAILQ_INSERT_TAIL(&wbc_node->free_segments, seg, link);
+	wbc_node->num_free_segments++;
+	wbcache_update_min_dirty_seq(wbc_node);
+}
+
+/* Hand a segment with no writes in flight over to the destager. */
+static void
+wbcache_segment_close(struct vbdev_wbcache *wbc_node, struct wbcache_segment *seg)
+{
+	assert(seg->writes_inflight == 0);
+
+	spdk_spin_lock(&wbc_node->lock);
+	if (seg->write_ptr == 0) {
+		wbcache_segment_free_locked(wbc_node, seg);
+	} else {
+		seg->state = WBCACHE_SEGMENT_CLOSED;
+		TAILQ_INSERT_TAIL(&wbc_node->closed_segments, seg, link);
+	}
+	spdk_spin_unlock(&wbc_node->lock);
+}
+
+/* Stop appending writes to the channel's segment. */
+static void
+wbcache_ch_retire_segment(struct wbc_io_channel *wbc_ch)
+{
+	struct wbcache_segment *seg = wbc_ch->seg;
+
+	assert(seg != NULL);
+	wbc_ch->seg = NULL;
+
+	if (seg->writes_inflight == 0) {
+		wbcache_segment_close(wbc_ch->wbc_node, seg);
+	} else {
+		/* Closed when the last write completes. */
+		seg->state = WBCACHE_SEGMENT_CLOSING;
+	}
+}
+
+/* Return a segment with room for num_blocks blocks, or NULL if none is free. */
+static struct wbcache_segment *
+wbcache_ch_get_segment(struct wbc_io_channel *wbc_ch, uint64_t num_blocks)
+{
+	struct vbdev_wbcache *wbc_node = wbc_ch->wbc_node;
+	struct wbcache_segment *seg = wbc_ch->seg;
+
+	if (seg != NULL) {
+		if (seg->write_ptr + num_blocks <= wbc_node->segment_blocks) {
+			return seg;
+		}
+		wbcache_ch_retire_segment(wbc_ch);
+	}
+
+	spdk_spin_lock(&wbc_node->lock);
+	seg = TAILQ_FIRST(&wbc_node->free_segments);
+	if (seg != NULL) {
+		TAILQ_REMOVE(&wbc_node->free_segments, seg, link);
+		wbc_node->num_free_segments--;
+		seg->state = WBCACHE_SEGMENT_OPEN;
+		seg->write_ptr = 0;
+		seg->seq = wbc_node->next_seq++;
+	}
+	spdk_spin_unlock(&wbc_node->lock);
+
+	wbc_ch->seg = seg;
+
+	return seg;
+}
+
+static void
+wbcache_segment_write_done(struct vbdev_wbcache *wbc_node, struct wbcache_segment *seg)
+{
+	assert(seg->writes_inflight > 0);
+	seg->writes_inflight--;
+
+	if (seg->writes_inflight == 0 && seg->state == WBCACHE_SEGMENT_CLOSING) {
+		wbcache_segment_close(wbc_node, seg);
+	}
+}
+
+static void
+wbcache_write_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)orig_io->driver_ctx;
+	struct vbdev_wbcache *wbc_node = SPDK_CONTAINEROF(orig_io->bdev, struct vbdev_wbcache,
+					 wbc_bdev);
+	uint64_t i;
+
+	spdk_bdev_free_io(bdev_io);
+
+	/* Only point the index at the new data once it is on the cache bdev. A failed
+	 * write leaves the previous data in place.
+	 */
+	if (success) {
+		for (i = 0; i < orig_io->u.bdev.num_blocks; i++) {
+			wbcache_index_set(wbc_node, orig_io->u.bdev.offset_blocks + i,
+					  io_ctx->cache_offset_blocks + i + 1);
+		}
+	}
+
+	wbcache_segment_write_done(wbc_node, io_ctx->seg);
+
+	spdk_bdev_io_complete(orig_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+/* Append a write to the channel's segment. Returns false if there is no free segment
+ * at the moment, in which case the write has to be retried later.
+ */
+static bool
+wbcache_write_submit(struct wbc_io_channel *wbc_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_wbcache *wbc_node = wbc_ch->wbc_node;
+	uint64_t offset_blocks = bdev_io->u.bdev.offset_blocks;
+	uint64_t num_blocks = bdev_io->u.bdev.num_blocks;
+	struct wbcache_segment *seg;
+	uint64_t i;
+	int rc;
+
+	if (wbcache_index_reserve(wbc_node, offset_blocks, num_blocks) != 0) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		return true;
+	}
+
+	seg = wbcache_ch_get_segment(wbc_ch, num_blocks);
+	if (seg == NULL) {
+		return false;
+	}
+
+	io_ctx->seg = seg;
+	io_ctx->cache_offset_blocks = seg->offset_blocks + seg->write_ptr;
+	for (i = 0; i < num_blocks; i++) {
+		wbc_node->rmap[io_ctx->cache_offset_blocks + i] = offset_blocks + i;
+	}
+	seg->write_ptr += num_blocks;
+	seg->writes_inflight++;
+
+	rc = spdk_bdev_writev_blocks(wbc_node->cache_desc, wbc_ch->cache_ch, bdev_io->u.bdev.iovs,
+				     bdev_io->u.bdev.iovcnt, io_ctx->cache_offset_blocks, num_blocks,
+				     wbcache_write_done, bdev_io);
+	if (rc != 0) {
+		/* The space stays unused, the destager skips blocks the index doesn't point to. */
+		wbcache_segment_write_done(wbc_node, seg);
+		if (rc == -ENOMEM) {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		} else {
+			SPDK_ERRLOG("ERROR on bdev_io submission!\n");
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		}
+	}
+
+	return true;
+}
+
+static void
+wbcache_submit_write(struct wbc_io_channel *wbc_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)bdev_io->driver_ctx;
+
+	/* Keep the writes in order once some of them are waiting. */
+	if (!TAILQ_EMPTY(&wbc_ch->pending_writes) || !wbcache_write_submit(wbc_ch, bdev_io)) {
+		TAILQ_INSERT_TAIL(&wbc_ch->pending_writes, io_ctx, link);
+	}
+}
+
+static void
+wbcache_ch_put_epoch(struct wbc_io_channel *wbc_ch, uint32_t epoch)
+{
+	struct spdk_io_channel_iter *i;
+
+	assert(wbc_ch->epoch_reads[epoch] > 0);
+	wbc_ch->epoch_reads[epoch]--;
+
+	if (wbc_ch->epoch_reads[epoch] == 0 && epoch != wbc_ch->epoch &&
+	    wbc_ch->barrier_iter != NULL) {
+		i = wbc_ch->barrier_iter;
+		wbc_ch->barrier_iter = NULL;
+		spdk_for_each_channel_continue(i, 0);
+	}
+}
+
+/* Return the number of blocks starting at offset_blocks that are either all stored
+ * contiguously in one segment of the cache bdev, or all not cached. The cache location
+ * of the first block is returned in cache_offset_blocks, or UINT64_MAX if not cached.
+ */
+static uint64_t
+wbcache_get_run(struct vbdev_wbcache *wbc_node, uint64_t offset_blocks, uint64_t num_blocks,
+		uint64_t *cache_offset_blocks)
+{
+	uint32_t first = wbcache_index_get(wbc_node, offset_blocks), next;
+	uint64_t i;
+
+	for (i = 1; i < num_blocks; i++) {
+		next = wbcache_index_get(wbc_node, offset_blocks + i);
+		if (first == 0) {
+			if (next != 0) {
+				break;
+			}
+		} else if (next != first + i || (first - 1 + i) % wbc_node->segment_blocks == 0) {
+			break;
+		}
+	}
+
+	*cache_offset_blocks = first != 0 ? first - 1 : UINT64_MAX;
+
+	return i;
+}
+
+static void
+wbcache_read_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)orig_io->driver_ctx;
+
+	spdk_bdev_free_io(bdev_io);
+
+	wbcache_ch_put_epoch(spdk_io_channel_get_ctx(io_ctx->ch), io_ctx->epoch);
+	spdk_bdev_io_complete(orig_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void
+wbcache_read_bounce_complete(struct spdk_bdev_io *orig_io)
+{
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)orig_io->driver_ctx;
+	struct wbc_io_channel *wbc_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	uint64_t len = orig_io->u.bdev.num_blocks * orig_io->bdev->blocklen;
+
+	if (io_ctx->status == SPDK_BDEV_IO_STATUS_SUCCESS) {
+		spdk_copy_buf_to_iovs(orig_io->u.bdev.iovs, orig_io->u.bdev.iovcnt, io_ctx->buf, len);
+	}
+	spdk_iobuf_put(&wbc_ch->iobuf, io_ctx->buf, len);
+	io_ctx->buf = NULL;
+
+	wbcache_ch_put_epoch(wbc_ch, io_ctx->epoch);
+	spdk_bdev_io_complete(orig_io, io_ctx->status);
+}
+
+static void
+wbcache_read_child_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)orig_io->driver_ctx;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		io_ctx->status = SPDK_BDEV_IO_STATUS_FAILED;
+	}
+
+	assert(io_ctx->outstanding > 0);
+	if (--io_ctx->outstanding == 0) {
+		wbcache_read_bounce_complete(orig_io);
+	}
+}
+
+/* Read each run of cached and not cached blocks into its place in the bounce buffer. */
+static void
+wbcache_read_bounce(struct spdk_bdev_io *orig_io)
+{
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)orig_io->driver_ctx;
+	struct wbc_io_channel *wbc_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	struct vbdev_wbcache *wbc_node = wbc_ch->wbc_node;
+	uint64_t offset_blocks, num_blocks, cache_offset_blocks;
+	void *buf;
+	int rc;
+
+	io_ctx->outstanding = 1;
+	io_ctx->status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	for (io_ctx->cursor = 0; io_ctx->cursor < orig_io->u.bdev.num_blocks;
+	     io_ctx->cursor += num_blocks) {
+		offset_blocks = orig_io->u.bdev.offset_blocks + io_ctx->cursor;
+		num_blocks = wbcache_get_run(wbc_node, offset_blocks,
+					     orig_io->u.bdev.num_blocks - io_ctx->cursor,
+					     &cache_offset_blocks);
+		buf = (uint8_t *)io_ctx->buf + io_ctx->cursor * orig_io->bdev->blocklen;
+
+		if (cache_offset_blocks == UINT64_MAX) {
+			rc = spdk_bdev_read_blocks(wbc_node->base_desc, wbc_ch->base_ch, buf,
+						   offset_blocks, num_blocks,
+						   wbcache_read_child_done, orig_io);
+		} else {
+			rc = spdk_bdev_read_blocks(wbc_node->cache_desc, wbc_ch->cache_ch, buf,
+						   cache_offset_blocks, num_blocks,
+						   wbcache_read_child_done, orig_io);
+		}
+		if (rc != 0) {
+			/* The whole read is retried by the bdev layer on -ENOMEM. */
+			io_ctx->status = rc == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+					 SPDK_BDEV_IO_STATUS_FAILED;
+			break;
+		}
+		io_ctx->outstanding++;
+	}
+
+	if (--io_ctx->outstanding == 0) {
+		wbcache_read_bounce_complete(orig_io);
+	}
+}
+
+static void
+wbcache_read_get_buf_cb(struct spdk_iobuf_entry *entry, void *buf)
+{
+	struct wbcache_bdev_io *io_ctx = SPDK_CONTAINEROF(entry, struct wbcache_bdev_io, iobuf);
+
+	io_ctx->buf = buf;
+	wbcache_read_bounce(spdk_bdev_io_from_ctx(io_ctx));
+}
+
+static void
+wbcache_submit_read(struct wbc_io_channel *wbc_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_wbcache *wbc_node = wbc_ch->wbc_node;
+	uint64_t num_blocks, cache_offset_blocks;
+	int rc;
+
+	/* Everything looked up in the index from now on stays valid until the read is
+	 * done, the segments aren't reused before this epoch is over.
+	 */
+	io_ctx->epoch = wbc_ch->epoch;
+	wbc_ch->epoch_reads[io_ctx->epoch]++;
+
+	num_blocks = wbcache_get_run(wbc_node, bdev_io->u.bdev.offset_blocks,
+				     bdev_io->u.bdev.num_blocks, &cache_offset_blocks);
+	if (num_blocks < bdev_io->u.bdev.num_blocks) {
+		/* Partially cached, assemble the data in a bounce buffer. */
+		io_ctx->buf = spdk_iobuf_get(&wbc_ch->iobuf,
+					     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen,
+					     &io_ctx->iobuf, wbcache_read_get_buf_cb);
+		if (io_ctx->buf != NULL) {
+			wbcache_read_bounce(bdev_io);
+		}
+		return;
+	}
+
+	if (cache_offset_blocks == UINT64_MAX) {
+		rc = spdk_bdev_readv_blocks(wbc_node->base_desc, wbc_ch->base_ch, bdev_io->u.bdev.iovs,
+					    bdev_io->u.bdev.iovcnt, bdev_io->u.bdev.offset_blocks,
+					    bdev_io->u.bdev.num_blocks, wbcache_read_done, bdev_io);
+	} else {
+		rc = spdk_bdev_readv_blocks(wbc_node->cache_desc, wbc_ch->cache_ch, bdev_io->u.bdev.iovs,
+					    bdev_io->u.bdev.iovcnt, cache_offset_blocks,
+					    bdev_io->u.bdev.num_blocks, wbcache_read_done, bdev_io);
+	}
+	if (rc != 0) {
+		wbcache_ch_put_epoch(wbc_ch, io_ctx->epoch);
+		if (rc == -ENOMEM) {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		} else {
+			SPDK_ERRLOG("ERROR on bdev_io submission!\n");
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		}
+	}
+}
+
+/* Completion callback for the flushes and resets forwarded to the base bdev. */
+static void
+_wbc_complete_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+
+	spdk_bdev_io_complete(orig_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+	spdk_bdev_free_io(bdev_io);
+}
+
+/* Flush the base bdev once the data written before a flush is destaged to it. */
+static void
+wbcache_flush_base(struct wbc_io_channel *wbc_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct vbdev_wbcache *wbc_node = wbc_ch->wbc_node;
+	int rc;
+
+	if (!wbc_node->base_flush) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+		return;
+	}
+
+	rc = spdk_bdev_flush_blocks(wbc_node->base_desc, wbc_ch->base_ch, 0,
+				    wbc_node->base_bdev->blockcnt, _wbc_complete_io, bdev_io);
+	if (rc != 0) {
+		spdk_bdev_io_complete(bdev_io, rc == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+				      SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void
+wbcache_flush_close_segment(struct spdk_io_channel_iter *i)
+{
+	struct spdk_bdev_io *bdev_io = spdk_io_channel_iter_get_ctx(i);
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)bdev_io->driver_ctx;
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct wbc_io_channel *wbc_ch = spdk_io_channel_get_ctx(ch);
+
+	if (wbc_ch->seg != NULL && wbc_ch->seg->seq < io_ctx->flush_seq) {
+		wbcache_ch_retire_segment(wbc_ch);
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+wbcache_flush_close_segment_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct spdk_bdev_io *bdev_io = spdk_io_channel_iter_get_ctx(i);
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)bdev_io->driver_ctx;
+	struct wbc_io_channel *wbc_ch = spdk_io_channel_get_ctx(io_ctx->ch);
+
+	/* Completed by the channel poller once destaged. */
+	TAILQ_INSERT_TAIL(&wbc_ch->pending_flushes, io_ctx, link);
+}
+
+static void
+wbcache_submit_flush(struct wbc_io_channel *wbc_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_wbcache *wbc_node = wbc_ch->wbc_node;
+
+	/* Every write completed so far went to a segment opened before this point. Close
+	 * those segments on all the channels so that they get destaged.
+	 */
+	spdk_spin_lock(&wbc_node->lock);
+	io_ctx->flush_seq = wbc_node->next_seq;
+	spdk_spin_unlock(&wbc_node->lock);
+
+	spdk_for_each_channel(wbc_node, wbcache_flush_close_segment, bdev_io,
+			      wbcache_flush_close_segment_done);
+}
+
+static int
+wbcache_ch_poll(void *arg)
+{
+	struct wbc_io_channel *wbc_ch = arg;
+	struct vbdev_wbcache *wbc_node = wbc_ch->wbc_node;
+	struct wbcache_bdev_io *io_ctx, *tmp;
+	uint64_t min_dirty_seq;
+	int count = 0;
+
+	while ((io_ctx = TAILQ_FIRST(&wbc_ch->pending_writes))) {
+		TAILQ_REMOVE(&wbc_ch->pending_writes, io_ctx, link);
+		if (!wbcache_write_submit(wbc_ch, spdk_bdev_io_from_ctx(io_ctx))) {
+			TAILQ_INSERT_HEAD(&wbc_ch->pending_writes, io_ctx, link);
+			break;
+		}
+		count++;
+	}
+
+	min_dirty_seq = __atomic_load_n(&wbc_node->min_dirty_seq, __ATOMIC_ACQUIRE);
+	TAILQ_FOREACH_SAFE(io_ctx, &wbc_ch->pending_flushes, link, tmp) {
+		if (io_ctx->flush_seq <= min_dirty_seq) {
+			TAILQ_REMOVE(&wbc_ch->pending_flushes, io_ctx, link);
+			wbcache_flush_base(wbc_ch, spdk_bdev_io_from_ctx(io_ctx));
+			count++;
+		}
+	}
+
+	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+static void
+vbdev_wbcache_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct vbdev_wbcache *wbc_node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_wbcache,
+					 wbc_bdev);
+	struct wbc_io_channel *wbc_ch = spdk_io_channel_get_ctx(ch);
+	struct wbcache_bdev_io *io_ctx = (struct wbcache_bdev_io *)bdev_io->driver_ctx;
+	int rc;
+
+	io_ctx->ch = ch;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		wbcache_submit_read(wbc_ch, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		wbcache_submit_write(wbc_ch, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		wbcache_submit_flush(wbc_ch, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_RESET:
+		rc = spdk_bdev_reset(wbc_node->base_desc, wbc_ch->base_ch, _wbc_complete_io, bdev_io);
+		if (rc != 0) {
+			spdk_bdev_io_complete(bdev_io, rc == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+					      SPDK_BDEV_IO_STATUS_FAILED);
+		}
+		break;
+	default:
+		SPDK_ERRLOG("wbcache: unknown I/O type %d\n", bdev_io->type);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		break;
+	}
+}
+
+static bool
+vbdev_wbcache_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+{
+	struct vbdev_wbcache *wbc_node = (struct vbdev_wbcache *)ctx;
+
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		return true;
+	case SPDK_BDEV_IO_TYPE_RESET:
+		return spdk_bdev_io_type_supported(wbc_node->base_bdev, io_type);
+	default:
+		/* Unmap and write zeroes would have to invalidate the cached blocks, write
+		 * zeroes is emulated with regular writes by the bdev layer.
+		 */
+		return false;
+	}
+}
+
+static struct spdk_io_channel *
+vbdev_wbcache_get_io_channel(void *ctx)
+{
+	struct vbdev_wbcache *wbc_node = (struct vbdev_wbcache *)ctx;
+
+	return spdk_get_io_channel(wbc_node);
+}
+
+/* This is the output for bdev_get_bdevs() for this vbdev */
+static int
+vbdev_wbcache_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+{
+	struct vbdev_wbcache *wbc_node = (struct vbdev_wbcache *)ctx;
+	uint64_t dirty_blocks = 0;
+	uint32_t i, num_free_segments;
+
+	spdk_spin_lock(&wbc_node->lock);
+	num_free_segments = wbc_node->num_free_segments;
+	for (i = 0; i < wbc_node->num_segments; i++) {
+		if (wbc_node->segments[i].state != WBCACHE_SEGMENT_FREE) {
+			dirty_blocks += wbc_node->segments[i].write_ptr;
+		}
+	}
+	spdk_spin_unlock(&wbc_node->lock);
+
+	spdk_json_write_name(w, "wbcache");
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&wbc_node->wbc_bdev));
+	spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(wbc_node->base_bdev));
+	spdk_json_write_named_string(w, "cache_bdev_name", spdk_bdev_get_name(wbc_node->cache_bdev));
+	spdk_json_write_named_uint32(w, "segment_size", wbc_node->segment_size);
+	spdk_json_write_named_uint32(w, "num_segments", wbc_node->num_segments);
+	spdk_json_write_named_uint32(w, "num_free_segments", num_free_segments);
+	spdk_json_write_named_uint64(w, "dirty_blocks", dirty_blocks);
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
+/* This is used to generate JSON that can configure this module to its current state. */
+static int
+vbdev_wbcache_config_json(struct spdk_json_write_ctx *w)
+{
+	struct vbdev_wbcache *wbc_node;
+
+	TAILQ_FOREACH(wbc_node, &g_wbc_nodes, link) {
+		const struct spdk_uuid *uuid = spdk_bdev_get_uuid(&wbc_node->wbc_bdev);
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_wbcache_create");
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&wbc_node->wbc_bdev));
+		spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(wbc_node->base_bdev));
+		spdk_json_write_named_string(w, "cache_bdev_name", spdk_bdev_get_name(wbc_node->cache_bdev));
+		if (!spdk_uuid_is_null(uuid)) {
+			spdk_json_write_named_uuid(w, "uuid", uuid);
+		}
+		spdk_json_write_named_uint32(w, "segment_size", wbc_node->segment_size);
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+	return 0;
+}
+
+static int
+wbc_bdev_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	struct wbc_io_channel *wbc_ch = ctx_buf;
+	struct vbdev_wbcache *wbc_node = io_device;
+	int rc;
+
+	rc = spdk_iobuf_channel_init(&wbc_ch->iobuf, "wbcache", 0, 0);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to create iobuf channel: %s\n", spdk_strerror(-rc));
+		return rc;
+	}
+
+	wbc_ch->base_ch = spdk_bdev_get_io_channel(wbc_node->base_desc);
+	if (wbc_ch->base_ch == NULL) {
+		goto err;
+	}
+
+	wbc_ch->cache_ch = spdk_bdev_get_io_channel(wbc_node->cache_desc);
+	if (wbc_ch->cache_ch == NULL) {
+		goto err;
+	}
+
+	wbc_ch->poller = SPDK_POLLER_REGISTER(wbcache_ch_poll, wbc_ch, VBDEV_WBCACHE_CH_POLL_US);
+	if (wbc_ch->poller == NULL) {
+		goto err;
+	}
+
+	wbc_ch->wbc_node = wbc_node;
+	TAILQ_INIT(&wbc_ch->pending_writes);
+	TAILQ_INIT(&wbc_ch->pending_flushes);
+
+	spdk_spin_lock(&wbc_node->lock);
+	wbc_node->num_channels++;
+	spdk_spin_unlock(&wbc_node->lock);
+
+	return 0;
+err:
+	if (wbc_ch->cache_ch != NULL) {
+		spdk_put_io_channel(wbc_ch->cache_ch);
+	}
+	if (wbc_ch->base_ch != NULL) {
+		spdk_put_io_channel(wbc_ch->base_ch);
+	}
+	spdk_iobuf_channel_fini(&wbc_ch->iobuf);
+	return -ENOMEM;
+}
+
+static void
+wbc_bdev_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct wbc_io_channel *wbc_ch = ctx_buf;
+	struct vbdev_wbcache *wbc_node = io_device;
+
+	assert(TAILQ_EMPTY(&wbc_ch->pending_writes));
+	assert(TAILQ_EMPTY(&wbc_ch->pending_flushes));
+	assert(wbc_ch->epoch_reads[0] == 0 && wbc_ch->epoch_reads[1] == 0);
+
+	if (wbc_ch->seg != NULL) {
+		wbcache_ch_retire_segment(wbc_ch);
+	}
+
+	spdk_poller_unregister(&wbc_ch->poller);
+	spdk_iobuf_channel_fini(&wbc_ch->iobuf);
+	spdk_put_io_channel(wbc_ch->cache_ch);
+	spdk_put_io_channel(wbc_ch->base_ch);
+
+	spdk_spin_lock(&wbc_node->lock);
+	wbc_node->num_channels--;
+	spdk_spin_unlock(&wbc_node->lock);
+}
+
+static void
+wbcache_barrier_ch(struct spdk_io_channel_iter *i)
+{
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct wbc_io_channel *wbc_ch = spdk_io_channel_get_ctx(ch);
+	uint32_t epoch = wbc_ch->epoch;
+
+	/* Reads started from now on see the current index. Wait for the ones started
+	 * before.
+	 */
+	wbc_ch->epoch ^= 1;
+	if (wbc_ch->epoch_reads[epoch] == 0) {
+		spdk_for_each_channel_continue(i, 0);
+	} else {
+		assert(wbc_ch->barrier_iter == NULL);
+		wbc_ch->barrier_iter = i;
+	}
+}
+
+static void
+wbcache_barrier_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct vbdev_wbcache *wbc_node = spdk_io_channel_iter_get_io_device(i);
+	struct wbcache_destager *destager = &wbc_node->destager;
+
+	spdk_spin_lock(&wbc_node->lock);
+	wbcache_segment_free_locked(wbc_node, destager->seg);
+	spdk_spin_unlock(&wbc_node->lock);
+
+	destager->seg = NULL;
+	destager->barrier = false;
+}
+
+static void
+wbcache_destage_io_done(struct wbcache_destage_io *dio, bool success)
+{
+	struct vbdev_wbcache *wbc_node = dio->wbc_node;
+	struct wbcache_destager *destager = &wbc_node->destager;
+	uint64_t i;
+
+	if (success) {
+		for (i = 0; i < dio->num_blocks; i++) {
+			wbcache_index_clear(wbc_node, dio->offset_blocks + i,
+					    dio->cache_offset_blocks + i + 1);
+		}
+	} else {
+		destager->failed = true;
+	}
+
+	dio->busy = false;
+	assert(destager->inflight > 0);
+	destager->inflight--;
+}
+
+static void
+wbcache_destage_write_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct wbcache_destage_io *dio = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	wbcache_destage_io_done(dio, success);
+}
+
+static void
+wbcache_destage_read_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct wbcache_destage_io *dio = cb_arg;
+	struct vbdev_wbcache *wbc_node = dio->wbc_node;
+	int rc;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		wbcache_destage_io_done(dio, false);
+		return;
+	}
+
+	rc = spdk_bdev_write_blocks(wbc_node->base_desc, wbc_node->destager.base_ch, dio->buf,
+				    dio->offset_blocks, dio->num_blocks,
+				    wbcache_destage_write_done, dio);
+	if (rc != 0) {
+		wbcache_destage_io_done(dio, false);
+	}
+}
+
+static struct wbcache_destage_io *
+wbcache_destage_get_io(struct wbcache_destager *destager)
+{
+	int i;
+
+	for (i = 0; i < VBDEV_WBCACHE_DESTAGE_QD; i++) {
+		if (!destager->ios[i].busy) {
+			return &destager->ios[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Find the next run of blocks of the segment still pointed to by the index and
+ * contiguous on the base bdev. Returns its length, 0 if there is none.
+ */
+static uint64_t
+wbcache_destage_next_run(struct vbdev_wbcache *wbc_node, struct wbcache_destager *destager,
+			 uint64_t *offset_blocks, uint64_t *cache_offset_blocks)
+{
+	struct wbcache_segment *seg = destager->seg;
+	uint64_t max_blocks = wbc_node->wbc_bdev.max_rw_size;
+	uint64_t cache_block, num_blocks;
+
+	for (; destager->cursor < seg->write_ptr; destager->cursor++) {
+		cache_block = seg->offset_blocks + destager->cursor;
+		if (wbcache_index_get(wbc_node, wbc_node->rmap[cache_block]) == cache_block + 1) {
+			break;
+		}
+	}
+
+	if (destager->cursor == seg->write_ptr) {
+		return 0;
+	}
+
+	*cache_offset_blocks = seg->offset_blocks + destager->cursor;
+	*offset_blocks = wbc_node->rmap[*cache_offset_blocks];
+	for (num_blocks = 1; destager->cursor + num_blocks < seg->write_ptr &&
+	     num_blocks < max_blocks; num_blocks++) {
+		cache_block = *cache_offset_blocks + num_blocks;
+		if (wbc_node->rmap[cache_block] != *offset_blocks + num_blocks ||
+		    wbcache_index_get(wbc_node, *offset_blocks + num_blocks) != cache_block + 1) {
+			break;
+		}
+	}
+	destager->cursor += num_blocks;
+
+	return num_blocks;
+}
+
+static int
+wbcache_destage_poll(void *arg)
+{
+	struct vbdev_wbcache *wbc_node = arg;
+	struct wbcache_destager *destager = &wbc_node->destager;
+	struct wbcache_destage_io *dio;
+	uint64_t offset_blocks, cache_offset_blocks, num_blocks, i;
+	uint64_t start;
+	bool done;
+	int count = 0, rc;
+
+	if (destager->barrier) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	if (destager->seg == NULL) {
+		if (!wbc_node->removed && spdk_get_ticks() < destager->retry_tsc) {
+			return SPDK_POLLER_IDLE;
+		}
+
+		spdk_spin_lock(&wbc_node->lock);
+		destager->seg = TAILQ_FIRST(&wbc_node->closed_segments);
+		if (destager->seg != NULL) {
+			TAILQ_REMOVE(&wbc_node->closed_segments, destager->seg, link);
+			destager->seg->state = WBCACHE_SEGMENT_DESTAGING;
+		}
+		done = wbc_node->deleting && wbc_node->num_channels == 0 &&
+		       wbc_node->num_free_segments == wbc_node->num_segments;
+		spdk_spin_unlock(&wbc_node->lock);
+
+		if (destager->seg == NULL) {
+			if (done) {
+				wbcache_destage_finish(wbc_node);
+				return SPDK_POLLER_BUSY;
+			}
+			return SPDK_POLLER_IDLE;
+		}
+
+		destager->cursor = 0;
+		destager->failed = false;
+	}
+
+	while (destager->inflight < VBDEV_WBCACHE_DESTAGE_QD && !destager->failed) {
+		start = destager->cursor;
+		num_blocks = wbcache_destage_next_run(wbc_node, destager, &offset_blocks,
+						      &cache_offset_blocks);
+		if (num_blocks == 0) {
+			break;
+		}
+		count++;
+
+		if (wbc_node->removed) {
+			/* Nowhere to destage to, drop the data. */
+			SPDK_ERRLOG("%s: dropping %" PRIu64 " blocks at %" PRIu64 " not destaged\n",
+				    wbc_node->wbc_bdev.name, num_blocks, offset_blocks);
+			for (i = 0; i < num_blocks; i++) {
+				wbcache_index_clear(wbc_node, offset_blocks + i,
+						    cache_offset_blocks + i + 1);
+			}
+			continue;
+		}
+
+		dio = wbcache_destage_get_io(destager);
+		assert(dio != NULL);
+		dio->offset_blocks = offset_blocks;
+		dio->cache_offset_blocks = cache_offset_blocks;
+		dio->num_blocks = num_blocks;
+
+		rc = spdk_bdev_read_blocks(wbc_node->cache_desc, destager->cache_ch, dio->buf,
+					   cache_offset_blocks, num_blocks,
+					   wbcache_destage_read_done, dio);
+		if (rc != 0) {
+			/* Try again on the next poll. */
+			destager->cursor = start;
+			break;
+		}
+		dio->busy = true;
+		destager->inflight++;
+	}
+
+	if (destager->inflight > 0) {
+		return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+	}
+
+	if (destager->failed) {
+		if (wbc_node->removed) {
+			/* Rewalk the segment dropping what's left. */
+			destager->cursor = 0;
+			destager->failed = false;
+			return SPDK_POLLER_BUSY;
+		}
+
+		SPDK_ERRLOG("%s: failed to destage segment at %" PRIu64 ", retrying\n",
+			    wbc_node->wbc_bdev.name, destager->seg->offset_blocks);
+		spdk_spin_lock(&wbc_node->lock);
+		destager->seg->state = WBCACHE_SEGMENT_CLOSED;
+		TAILQ_INSERT_HEAD(&wbc_node->closed_segments, destager->seg, link);
+		spdk_spin_unlock(&wbc_node->lock);
+		destager->seg = NULL;
+		destager->retry_tsc = spdk_get_ticks() +
+				      VBDEV_WBCACHE_DESTAGE_RETRY_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+		return SPDK_POLLER_BUSY;
+	}
+
+	if (destager->cursor < destager->seg->write_ptr) {
+		/* A submission failed, resume on the next poll. */
+		return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+	}
+
+	/* The whole segment is on the base bdev, reuse it once no read refers to it. */
+	destager->barrier = true;
+	spdk_for_each_channel(wbc_node, wbcache_barrier_ch, wbc_node, wbcache_barrier_done);
+
+	return SPDK_POLLER_BUSY;
+}
+
+/* Everything is destaged and all the channels are gone, finish the destruction. */
+static void
+wbcache_destage_finish(struct vbdev_wbcache *wbc_node)
+{
+	spdk_poller_unregister(&wbc_node->destage_poller);
+	spdk_put_io_channel(wbc_node->destager.cache_ch);
+	spdk_put_io_channel(wbc_node->destager.base_ch);
+
+	/* Unclaim the underlying bdevs. */
+	spdk_bdev_module_release_bdev(wbc_node->base_bdev);
+	spdk_bdev_module_release_bdev(wbc_node->cache_bdev);
+
+	spdk_bdev_close(wbc_node->cache_desc);
+	spdk_bdev_close(wbc_node->base_desc);
+
+	/* Unregister the io_device. */
+	spdk_io_device_unregister(wbc_node, _device_unregister_cb);
+}
+
+/* Create the write-back cache association from the bdev names and insert on the
+ * global list. */
+static int
+vbdev_wbcache_insert_name(const char *vbdev_name, const char *base_bdev_name,
+			  const char *cache_bdev_name, const struct spdk_uuid *uuid,
+			  uint32_t segment_size)
+{
+	struct bdev_names *name;
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(vbdev_name, name->vbdev_name) == 0) {
+			SPDK_ERRLOG("wbcache bdev %s already exists\n", vbdev_name);
+			return -EEXIST;
+		}
+	}
+
+	name = calloc(1, sizeof(struct bdev_names));
+	if (!name) {
+		SPDK_ERRLOG("could not allocate bdev_names\n");
+		return -ENOMEM;
+	}
+
+	name->vbdev_name = strdup(vbdev_name);
+	name->base_bdev_name = strdup(base_bdev_name);
+	name->cache_bdev_name = strdup(cache_bdev_name);
+	if (!name->vbdev_name || !name->base_bdev_name || !name->cache_bdev_name) {
+		SPDK_ERRLOG("could not allocate bdev names\n");
+		free(name->vbdev_name);
+		free(name->base_bdev_name);
+		free(name->cache_bdev_name);
+		free(name);
+		return -ENOMEM;
+	}
+
+	spdk_uuid_copy(&name->uuid, uuid);
+	name->segment_size = segment_size;
+	TAILQ_INSERT_TAIL(&g_bdev_names, name, link);
+
+	return 0;
+}
+
+static void
+vbdev_wbcache_free_name(struct bdev_names *name)
+{
+	free(name->vbdev_name);
+	free(name->base_bdev_name);
+	free(name->cache_bdev_name);
+	free(name);
+}
+
+static void
+vbdev_wbcache_remove_name(const char *vbdev_name)
+{
+	struct bdev_names *name;
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(name->vbdev_name, vbdev_name) == 0) {
+			TAILQ_REMOVE(&g_bdev_names, name, link);
+			vbdev_wbcache_free_name(name);
+			break;
+		}
+	}
+}
+
+static int
+vbdev_wbcache_init(void)
+{
+	return spdk_iobuf_register_module("wbcache");
+}
+
+/* Called when the entire module is being torn down. */
+static void
+vbdev_wbcache_finish(void)
+{
+	struct bdev_names *name;
+
+	while ((name = TAILQ_FIRST(&g_bdev_names))) {
+		TAILQ_REMOVE(&g_bdev_names, name, link);
+		vbdev_wbcache_free_name(name);
+	}
+}
+
+static int
+vbdev_wbcache_get_ctx_size(void)
+{
+	return sizeof(struct wbcache_bdev_io);
+}
+
+static void
+vbdev_wbcache_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	/* No config per bdev needed */
+}
+
+/* When we register our bdev this is how we specify our entry points. */
+static const struct spdk_bdev_fn_table vbdev_wbcache_fn_table = {
+	.destruct		= vbdev_wbcache_destruct,
+	.submit_request		= vbdev_wbcache_submit_request,
+	.io_type_supported	= vbdev_wbcache_io_type_supported,
+	.get_io_channel		= vbdev_wbcache_get_io_channel,
+	.dump_info_json		= vbdev_wbcache_dump_info_json,
+	.write_config_json	= vbdev_wbcache_write_config_json,
+};
+
+static void
+vbdev_wbcache_base_bdev_hotremove_cb(struct spdk_bdev *bdev_find)
+{
+	struct vbdev_wbcache *wbc_node, *tmp;
+
+	TAILQ_FOREACH_SAFE(wbc_node, &g_wbc_nodes, link, tmp) {
+		if (bdev_find == wbc_node->base_bdev || bdev_find == wbc_node->cache_bdev) {
+			/* The data not destaged yet is lost. */
+			wbc_node->removed = true;
+			spdk_bdev_unregister(&wbc_node->wbc_bdev, NULL, NULL);
+		}
+	}
+}
+
+/* Called when the underlying base bdev triggers asynchronous event such as bdev removal. */
+static void
+vbdev_wbcache_base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+				 void *event_ctx)
+{
+	switch (type) {
+	case SPDK_BDEV_EVENT_REMOVE:
+		vbdev_wbcache_base_bdev_hotremove_cb(bdev);
+		break;
+	default:
+		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
+		break;
+	}
+}
+
+/* Check the geometry of the base and cache bdevs and set up the segments and index. */
+static int
+vbdev_wbcache_init_node(struct vbdev_wbcache *wbc_node, uint32_t segment_size)
+{
+	struct spdk_bdev *base = wbc_node->base_bdev, *cache = wbc_node->cache_bdev;
+	struct spdk_iobuf_opts iobuf_opts;
+	uint64_t max_rw_size;
+	uint32_t i;
+
+	if (base->blocklen != cache->blocklen) {
+		SPDK_ERRLOG("block sizes of base bdev %s (%" PRIu32 ") and cache bdev %s (%" PRIu32
+			    ") differ\n", base->name, base->blocklen, cache->name, cache->blocklen);
+		return -EINVAL;
+	}
+
+	if (base->md_len != 0 || cache->md_len != 0) {
+		SPDK_ERRLOG("bdevs with metadata are not supported\n");
+		return -EINVAL;
+	}
+
+	if (segment_size == 0 || segment_size % base->blocklen != 0) {
+		SPDK_ERRLOG("segment size %" PRIu32 " is not a multiple of block size %" PRIu32 "\n",
+			    segment_size, base->blocklen);
+		return -EINVAL;
+	}
+
+	/* The index stores cache block numbers plus one in 32 bits. */
+	if (cache->blockcnt >= UINT32_MAX) {
+		SPDK_ERRLOG("cache bdev %s is too large\n", cache->name);
+		return -EINVAL;
+	}
+
+	wbc_node->segment_size = segment_size;
+	wbc_node->segment_blocks = segment_size / base->blocklen;
+	wbc_node->num_segments = cache->blockcnt / wbc_node->segment_blocks;
+	if (wbc_node->num_segments < 2) {
+		SPDK_ERRLOG("cache bdev %s must hold at least two segments of %" PRIu32 " bytes\n",
+			    cache->name, segment_size);
+		return -EINVAL;
+	}
+
+	/* Reads are assembled in a single iobuf buffer and writes must fit in a segment. */
+	spdk_iobuf_get_opts(&iobuf_opts, sizeof(iobuf_opts));
+	max_rw_size = spdk_min(iobuf_opts.large_bufsize / base->blocklen, wbc_node->segment_blocks);
+	if (max_rw_size == 0) {
+		SPDK_ERRLOG("block size %" PRIu32 " exceeds iobuf large buffer size\n", base->blocklen);
+		return -EINVAL;
+	}
+	wbc_node->wbc_bdev.max_rw_size = max_rw_size;
+
+	wbc_node->segments = calloc(wbc_node->num_segments, sizeof(struct wbcache_segment));
+	wbc_node->rmap = calloc(cache->blockcnt, sizeof(uint64_t));
+	wbc_node->num_index_leaves = SPDK_CEIL_DIV(base->blockcnt, VBDEV_WBCACHE_INDEX_LEAF_SIZE);
+	wbc_node->index = calloc(wbc_node->num_index_leaves, sizeof(uint32_t *));
+	if (!wbc_node->segments || !wbc_node->rmap || !wbc_node->index) {
+		SPDK_ERRLOG("could not allocate cache metadata\n");
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < VBDEV_WBCACHE_DESTAGE_QD; i++) {
+		wbc_node->destager.ios[i].wbc_node = wbc_node;
+		wbc_node->destager.ios[i].buf = spdk_dma_malloc(max_rw_size * base->blocklen, 0x1000,
+						NULL);
+		if (wbc_node->destager.ios[i].buf == NULL) {
+			SPDK_ERRLOG("could not allocate destage buffer\n");
+			return -ENOMEM;
+		}
+	}
+
+	TAILQ_INIT(&wbc_node->free_segments);
+	TAILQ_INIT(&wbc_node->closed_segments);
+	for (i = 0; i < wbc_node->num_segments; i++) {
+		wbc_node->segments[i].offset_blocks = i * wbc_node->segment_blocks;
+		wbc_node->segments[i].state = WBCACHE_SEGMENT_FREE;
+		TAILQ_INSERT_TAIL(&wbc_node->free_segments, &wbc_node->segments[i], link);
+	}
+	wbc_node->num_free_segments = wbc_node->num_segments;
+
+	return 0;
+}
+
+/* Create and register the write-back cache vbdev if we find it in our list of bdev
+ * names and both its base and cache bdevs are present. This can be called either by
+ * the examine path or RPC method.
+ */
+static int
+vbdev_wbcache_register(const char *bdev_name)
+{
+	struct bdev_names *name;
+	struct vbdev_wbcache *wbc_node;
+	struct spdk_bdev *bdev;
+	struct spdk_uuid ns_uuid;
+	int rc = 0;
+
+	spdk_uuid_parse(&ns_uuid, BDEV_WBCACHE_NAMESPACE_UUID);
+
+	TAILQ_FOREACH(name, &g_bdev_names, link) {
+		if (strcmp(name->base_bdev_name, bdev_name) != 0 &&
+		    strcmp(name->cache_bdev_name, bdev_name) != 0) {
+			continue;
+		}
+
+		SPDK_NOTICELOG("Match on %s\n", bdev_name);
+		wbc_node = calloc(1, sizeof(struct vbdev_wbcache));
+		if (!wbc_node) {
+			rc = -ENOMEM;
+			SPDK_ERRLOG("could not allocate wbc_node\n");
+			break;
+		}
+		spdk_spin_init(&wbc_node->lock);
+
+		wbc_node->wbc_bdev.name = strdup(name->vbdev_name);
+		if (!wbc_node->wbc_bdev.name) {
+			rc = -ENOMEM;
+			SPDK_ERRLOG("could not allocate wbc_bdev name\n");
+			vbdev_wbcache_free(wbc_node);
+			break;
+		}
+		wbc_node->wbc_bdev.product_name = "wbcache";
+
+		/* Both the base and cache bdevs must be present. */
+		rc = spdk_bdev_open_ext(name->base_bdev_name, true, vbdev_wbcache_base_bdev_event_cb,
+					NULL, &wbc_node->base_desc);
+		if (rc) {
+			if (rc != -ENODEV) {
+				SPDK_ERRLOG("could not open bdev %s\n", name->base_bdev_name);
+			}
+			vbdev_wbcache_free(wbc_node);
+			break;
+		}
+
+		rc = spdk_bdev_open_ext(name->cache_bdev_name, true, vbdev_wbcache_base_bdev_event_cb,
+					NULL, &wbc_node->cache_desc);
+		if (rc) {
+			if (rc != -ENODEV) {
+				SPDK_ERRLOG("could not open bdev %s\n", name->cache_bdev_name);
+			}
+			spdk_bdev_close(wbc_node->base_desc);
+			vbdev_wbcache_free(wbc_node);
+			break;
+		}
+		SPDK_NOTICELOG("base and cache bdevs opened\n");
+
+		bdev = spdk_bdev_desc_get_bdev(wbc_node->base_desc);
+		wbc_node->base_bdev = bdev;
+		wbc_node->cache_bdev = spdk_bdev_desc_get_bdev(wbc_node->cache_desc);
+		wbc_node->base_flush = spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_FLUSH);
+
+		rc = vbdev_wbcache_init_node(wbc_node, name->segment_size);
+		if (rc) {
+			goto err_close;
+		}
+
+		if (!spdk_uuid_is_null(&name->uuid)) {
+			/* Use the configured UUID */
+			spdk_uuid_copy(&wbc_node->wbc_bdev.uuid, &name->uuid);
+		} else {
+			/* Generate UUID based on namespace UUID + base bdev UUID. */
+			rc = spdk_uuid_generate_sha1(&wbc_node->wbc_bdev.uuid, &ns_uuid,
+						     (const char *)&bdev->uuid, sizeof(struct spdk_uuid));
+			if (rc) {
+				SPDK_ERRLOG("Unable to generate new UUID for wbcache bdev\n");
+				goto err_close;
+			}
+		}
+
+		/* Writes complete once they are on the cache bdev, so the host has to flush
+		 * to make them durable.
+		 */
+		wbc_node->wbc_bdev.write_cache = true;
+		wbc_node->wbc_bdev.required_alignment = spdk_max(bdev->required_alignment,
+							wbc_node->cache_bdev->required_alignment);
+		wbc_node->wbc_bdev.optimal_io_boundary = bdev->optimal_io_boundary;
+		wbc_node->wbc_bdev.blocklen = bdev->blocklen;
+		wbc_node->wbc_bdev.blockcnt = bdev->blockcnt;
+
+		wbc_node->wbc_bdev.ctxt = wbc_node;
+		wbc_node->wbc_bdev.fn_table = &vbdev_wbcache_fn_table;
+		wbc_node->wbc_bdev.module = &wbcache_if;
+
+		/* Save the thread where the base device is opened, the destager runs on it. */
+		wbc_node->thread = spdk_get_thread();
+
+		rc = spdk_bdev_module_claim_bdev(bdev, wbc_node->base_desc, wbc_node->wbc_bdev.module);
+		if (rc) {
+			SPDK_ERRLOG("could not claim bdev %s\n", name->base_bdev_name);
+			goto err_close;
+		}
+
+		rc = spdk_bdev_module_claim_bdev(wbc_node->cache_bdev, wbc_node->cache_desc,
+						 wbc_node->wbc_bdev.module);
+		if (rc) {
+			SPDK_ERRLOG("could not claim bdev %s\n", name->cache_bdev_name);
+			goto err_release;
+		}
+		SPDK_NOTICELOG("bdevs claimed\n");
+
+		wbc_node->destager.base_ch = spdk_bdev_get_io_channel(wbc_node->base_desc);
+		wbc_node->destager.cache_ch = spdk_bdev_get_io_channel(wbc_node->cache_desc);
+		wbc_node->destage_poller = SPDK_POLLER_REGISTER(wbcache_destage_poll, wbc_node, 0);
+		if (!wbc_node->destager.base_ch || !wbc_node->destager.cache_ch ||
+		    !wbc_node->destage_poller) {
+			SPDK_ERRLOG("could not set up destager\n");
+			rc = -ENOMEM;
+			goto err_destager;
+		}
+
+		TAILQ_INSERT_TAIL(&g_wbc_nodes, wbc_node, link);
+		spdk_io_device_register(wbc_node, wbc_bdev_ch_create_cb, wbc_bdev_ch_destroy_cb,
+					sizeof(struct wbc_io_channel),
+					name->vbdev_name);
+		SPDK_NOTICELOG("io_device created at: 0x%p\n", wbc_node);
+
+		rc = spdk_bdev_register(&wbc_node->wbc_bdev);
+		if (rc) {
+			SPDK_ERRLOG("could not register wbc_bdev\n");
+			TAILQ_REMOVE(&g_wbc_nodes, wbc_node, link);
+			spdk_io_device_unregister(wbc_node, NULL);
+			goto err_destager;
+		}
+		SPDK_NOTICELOG("created wbc_bdev for: %s\n", name->vbdev_name);
+		continue;
+
+err_destager:
+		spdk_poller_unregister(&wbc_node->destage_poller);
+		if (wbc_node->destager.cache_ch) {
+			spdk_put_io_channel(wbc_node->destager.cache_ch);
+		}
+		if (wbc_node->destager.base_ch) {
+			spdk_put_io_channel(wbc_node->destager.base_ch);
+		}
+		spdk_bdev_module_release_bdev(wbc_node->cache_bdev);
+err_release:
+		spdk_bdev_module_release_bdev(bdev);
+err_close:
+		spdk_bdev_close(wbc_node->cache_desc);
+		spdk_bdev_close(wbc_node->base_desc);
+		vbdev_wbcache_free(wbc_node);
+		break;
+	}
+
+	return rc;
+}
+
+/* Create the write-back cache disk from the given bdev names. */
+int
+bdev_wbcache_create_disk(const char *vbdev_name, const char *base_bdev_name,
+			 const char *cache_bdev_name, const struct spdk_uuid *uuid,
+			 uint32_t segment_size)
+{
+	int rc;
+
+	if (strcmp(base_bdev_name, cache_bdev_name) == 0) {
+		SPDK_ERRLOG("base and cache bdev must be different\n");
+		return -EINVAL;
+	}
+
+	/* Insert the bdev names into our global name list even if they don't exist yet,
+	 * they may show up soon...
+	 */
+	rc = vbdev_wbcache_insert_name(vbdev_name, base_bdev_name, cache_bdev_name, uuid,
+				       segment_size);
+	if (rc) {
+		return rc;
+	}
+
+	rc = vbdev_wbcache_register(base_bdev_name);
+	if (rc == -ENODEV) {
+		/* This is not an error, we tracked the name above and it still
+		 * may show up later.
+		 */
+		SPDK_NOTICELOG("vbdev creation deferred pending base or cache bdev arrival\n");
+		rc = 0;
+	} else if (rc != 0) {
+		vbdev_wbcache_remove_name(vbdev_name);
+	}
+
+	return rc;
+}
+
+void
+bdev_wbcache_delete_disk(const char *vbdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	int rc;
+
+	/* Some cleanup happens in the destruct callback. */
+	rc = spdk_bdev_unregister_by_name(vbdev_name, &wbcache_if, cb_fn, cb_arg);
+	if (rc == 0) {
+		/* Remove the association from g_bdev_names. This is required so that the vbdev
+		 * does not get re-created if the same bdevs are constructed at some other time,
+		 * unless one of the underlying bdevs was hot-removed.
+		 */
+		vbdev_wbcache_remove_name(vbdev_name);
+	} else {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static void
+vbdev_wbcache_examine(struct spdk_bdev *bdev)
+{
+	vbdev_wbcache_register(bdev->name);
+
+	spdk_bdev_module_examine_done(&wbcache_if);
+}
+
+SPDK_LOG_REGISTER_COMPONENT(vbdev_wbcache)
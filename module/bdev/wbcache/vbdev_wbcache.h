@@ -0,0 +1,43 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#ifndef SPDK_VBDEV_WBCACHE_H
+#define SPDK_VBDEV_WBCACHE_H
+
+#include "spdk/stdinc.h"
+
+#include "spdk/bdev.h"
+#include "spdk/bdev_module.h"
+
+/* Default size of a cache log segment, in bytes. */
+#define VBDEV_WBCACHE_DEFAULT_SEGMENT_SIZE	(4 * 1024 * 1024)
+
+/**
+ * Create new write-back cache bdev.
+ *
+ * \param vbdev_name Name of the write-back cache bdev.
+ * \param base_bdev_name Bdev holding the data, the cached writes are destaged to it.
+ * \param cache_bdev_name Fast bdev the writes are staged on before they are destaged.
+ * \param uuid Optional UUID to assign to the write-back cache bdev.
+ * \param segment_size Size of a cache log segment in bytes. It must be a multiple of the
+ * block size and the cache bdev must hold at least two segments.
+ * \return 0 on success, other on failure.
+ */
+int bdev_wbcache_create_disk(const char *vbdev_name, const char *base_bdev_name,
+			     const char *cache_bdev_name, const struct spdk_uuid *uuid,
+			     uint32_t segment_size);
+
+/**
+ * Delete write-back cache bdev. All the data still staged on the cache bdev is destaged
+ * to the base bdev first.
+ *
+ * \param vbdev_name Name of the write-back cache bdev.
+ * \param cb_fn Function to call after deletion.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void bdev_wbcache_delete_disk(const char *vbdev_name, spdk_bdev_unregister_cb cb_fn,
+			      void *cb_arg);
+
+#endif /* SPDK_VBDEV_WBCACHE_H */
@@ -0,0 +1,122 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "vbdev_wbcache.h"
+#include "spdk/rpc.h"
+#include "spdk/util.h"
+#include "spdk/string.h"
+#include "spdk/log.h"
+
+/* Structure to hold the parameters for this RPC method. */
+struct rpc_bdev_wbcache_create {
+	char *name;
+	char *base_bdev_name;
+	char *cache_bdev_name;
+	struct spdk_uuid uuid;
+	uint32_t segment_size;
+};
+
+/* Free the allocated memory resource after the RPC handling. */
+static void
+free_rpc_bdev_wbcache_create(struct rpc_bdev_wbcache_create *r)
+{
+	free(r->name);
+	free(r->base_bdev_name);
+	free(r->cache_bdev_name);
+}
+
+/* Structure to decode the input parameters for this RPC method. */
+static const struct spdk_json_object_decoder rpc_bdev_wbcache_create_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_wbcache_create, name), spdk_json_decode_string},
+	{"base_bdev_name", offsetof(struct rpc_bdev_wbcache_create, base_bdev_name), spdk_json_decode_string},
+	{"cache_bdev_name", offsetof(struct rpc_bdev_wbcache_create, cache_bdev_name), spdk_json_decode_string},
+	{"uuid", offsetof(struct rpc_bdev_wbcache_create, uuid), spdk_json_decode_uuid, true},
+	{"segment_size", offsetof(struct rpc_bdev_wbcache_create, segment_size), spdk_json_decode_uint32, true},
+};
+
+/* Decode the parameters for this RPC method and properly construct the wbcache
+ * device. Error status returned in the failed cases.
+ */
+static void
+rpc_bdev_wbcache_create(struct spdk_jsonrpc_request *request,
+			  const struct spdk_json_val *params)
+{
+	struct rpc_bdev_wbcache_create req = {NULL};
+	struct spdk_json_write_ctx *w;
+	int rc;
+
+	req.segment_size = VBDEV_WBCACHE_DEFAULT_SEGMENT_SIZE;
+
+	if (spdk_json_decode_object(params, rpc_bdev_wbcache_create_decoders,
+				    SPDK_COUNTOF(rpc_bdev_wbcache_create_decoders),
+				    &req)) {
+		SPDK_DEBUGLOG(vbdev_wbcache, "spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = bdev_wbcache_create_disk(req.name, req.base_bdev_name, req.cache_bdev_name, &req.uuid,
+				      req.segment_size);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_string(w, req.name);
+	spdk_jsonrpc_end_result(request, w);
+
+cleanup:
+	free_rpc_bdev_wbcache_create(&req);
+}
+SPDK_RPC_REGISTER("bdev_wbcache_create", rpc_bdev_wbcache_create, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_wbcache_delete {
+	char *name;
+};
+
+static void
+free_rpc_bdev_wbcache_delete(struct rpc_bdev_wbcache_delete *req)
+{
+	free(req->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_wbcache_delete_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_wbcache_delete, name), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_wbcache_delete_cb(void *cb_arg, int bdeverrno)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (bdeverrno == 0) {
+		spdk_jsonrpc_send_bool_response(request, true);
+	} else {
+		spdk_jsonrpc_send_error_response(request, bdeverrno, spdk_strerror(-bdeverrno));
+	}
+}
+
+static void
+rpc_bdev_wbcache_delete(struct spdk_jsonrpc_request *request,
+			  const struct spdk_json_val *params)
+{
+	struct rpc_bdev_wbcache_delete req = {NULL};
+
+	if (spdk_json_decode_object(params, rpc_bdev_wbcache_delete_decoders,
+				    SPDK_COUNTOF(rpc_bdev_wbcache_delete_decoders),
+				    &req)) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	bdev_wbcache_delete_disk(req.name, rpc_bdev_wbcache_delete_cb, request);
+
+cleanup:
+	free_rpc_bdev_wbcache_delete(&req);
+}
+SPDK_RPC_REGISTER("bdev_wbcache_delete", rpc_bdev_wbcache_delete, SPDK_RPC_RUNTIME)
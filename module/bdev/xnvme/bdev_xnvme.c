@@ -22,6 +22,8 @@
 
 #include "spdk/log.h"
 
+#define BDEV_XNVME_DEFAULT_QUEUE_DEPTH	512
+
 struct bdev_xnvme_io_channel {
 	struct xnvme_queue	*queue;
 	struct spdk_poller	*poller;
@@ -39,6 +41,8 @@ struct bdev_xnvme {
 	struct xnvme_dev	*dev;
 	uint32_t		nsid;
 	bool			conserve_cpu;
+	uint32_t		queue_depth;
+	bool			sqpoll;
 
 	TAILQ_ENTRY(bdev_xnvme) link;
 };
@@ -69,6 +73,8 @@ bdev_xnvme_config_json(struct spdk_json_write_ctx *w)
 		spdk_json_write_named_string(w, "filename", xnvme->filename);
 		spdk_json_write_named_string(w, "io_mechanism", xnvme->io_mechanism);
 		spdk_json_write_named_bool(w, "conserve_cpu", xnvme->conserve_cpu);
+		spdk_json_write_named_uint32(w, "queue_depth", xnvme->queue_depth);
+		spdk_json_write_named_bool(w, "sqpoll", xnvme->sqpoll);
 		spdk_json_write_object_end(w);
 
 		spdk_json_write_object_end(w);
@@ -109,6 +115,9 @@ bdev_xnvme_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 		/* libaio and io_uring only supports read and write */
 		return !strcmp(xnvme->io_mechanism, "io_uring_cmd") &&
 		       xnvme_dev_get_csi(xnvme->dev) == XNVME_SPEC_CSI_NVM;
+	case SPDK_BDEV_IO_TYPE_NVME_IO:
+		/* Only the NVMe generic char device passes raw commands to the namespace */
+		return !strcmp(xnvme->io_mechanism, "io_uring_cmd");
 	default:
 		return false;
 	}
@@ -221,6 +230,13 @@ _xnvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
 			return;
 		}
 		break;
+	case SPDK_BDEV_IO_TYPE_NVME_IO:
+		/* The command is passed as is, only the namespace is forced to the bdev's one */
+		SPDK_STATIC_ASSERT(sizeof(ctx->cmd) == sizeof(bdev_io->u.nvme_passthru.cmd),
+				   "Incorrect NVMe command size");
+		memcpy(&ctx->cmd, &bdev_io->u.nvme_passthru.cmd, sizeof(ctx->cmd));
+		ctx->cmd.common.nsid = xnvme->nsid;
+		break;
 	default:
 		SPDK_ERRLOG("Wrong io type\n");
 
@@ -232,8 +248,13 @@ _xnvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
 	xnvme_task->ch = xnvme_ch;
 	ctx->async.cb_arg = xnvme_task;
 
-	err = xnvme_cmd_passv(ctx, bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
-			      bdev_io->u.bdev.num_blocks * xnvme->bdev.blocklen, NULL, 0, 0);
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_NVME_IO) {
+		err = xnvme_cmd_pass(ctx, bdev_io->u.nvme_passthru.buf, bdev_io->u.nvme_passthru.nbytes,
+				     bdev_io->u.nvme_passthru.md_buf, bdev_io->u.nvme_passthru.md_len);
+	} else {
+		err = xnvme_cmd_passv(ctx, bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+				      bdev_io->u.bdev.num_blocks * xnvme->bdev.blocklen, NULL, 0, 0);
+	}
 
 	switch (err) {
 	/* Submission success! */
@@ -295,6 +316,7 @@ bdev_xnvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 		spdk_bdev_io_get_buf(bdev_io, bdev_xnvme_get_buf_cb, 256 * 16);
 		break;
 	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_NVME_IO:
 		_xnvme_submit_request(ch, bdev_io);
 		break;
 
@@ -327,17 +349,26 @@ static void
 bdev_xnvme_cmd_cb(struct xnvme_cmd_ctx *ctx, void *cb_arg)
 {
 	struct bdev_xnvme_task *xnvme_task = ctx->async.cb_arg;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(xnvme_task);
 	enum spdk_bdev_io_status status = SPDK_BDEV_IO_STATUS_SUCCESS;
 
 	SPDK_DEBUGLOG(xnvme, "xnvme_task : %p\n", xnvme_task);
 
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_NVME_IO) {
+		/* Let the submitter of the passthrough command see the NVMe status */
+		spdk_bdev_io_complete_nvme_status(bdev_io, ctx->cpl.cdw0, ctx->cpl.status.sct,
+						  ctx->cpl.status.sc);
+		xnvme_queue_put_cmd_ctx(ctx->async.queue, ctx);
+		return;
+	}
+
 	if (xnvme_cmd_ctx_cpl_status(ctx)) {
 		SPDK_ERRLOG("xNVMe I/O Failed\n");
 		xnvme_cmd_ctx_pr(ctx, XNVME_PR_DEF);
 		status = SPDK_BDEV_IO_STATUS_FAILED;
 	}
 
-	spdk_bdev_io_complete(spdk_bdev_io_from_ctx(xnvme_task), status);
+	spdk_bdev_io_complete(bdev_io, status);
 
 	/* Completed: Put the command- context back in the queue */
 	xnvme_queue_put_cmd_ctx(ctx->async.queue, ctx);
@@ -364,9 +395,8 @@ bdev_xnvme_queue_create_cb(void *io_device, void *ctx_buf)
 	struct bdev_xnvme *xnvme = io_device;
 	struct bdev_xnvme_io_channel *ch = ctx_buf;
 	int rc;
-	int qd = 512;
 
-	rc = xnvme_queue_init(xnvme->dev, qd, 0, &ch->queue);
+	rc = xnvme_queue_init(xnvme->dev, xnvme->queue_depth, 0, &ch->queue);
 	if (rc) {
 		SPDK_ERRLOG("xnvme_queue_init failure: %d\n", rc);
 		return 1;
@@ -391,7 +421,7 @@ bdev_xnvme_queue_destroy_cb(void *io_device, void *ctx_buf)
 
 struct spdk_bdev *
 create_xnvme_bdev(const char *name, const char *filename, const char *io_mechanism,
-		  bool conserve_cpu)
+		  bool conserve_cpu, uint32_t queue_depth, bool sqpoll)
 {
 	struct bdev_xnvme *xnvme;
 	const struct xnvme_spec_nvm_idfy_ctrlr *ctrlr;
@@ -400,6 +430,20 @@ create_xnvme_bdev(const char *name, const char *filename, const char *io_mechani
 	int rc;
 	struct xnvme_opts opts = xnvme_opts_default();
 
+	if (queue_depth == 0) {
+		queue_depth = BDEV_XNVME_DEFAULT_QUEUE_DEPTH;
+	}
+
+	if (!spdk_u32_is_pow2(queue_depth)) {
+		SPDK_ERRLOG("Invalid queue depth %" PRIu32 " (must be a power of 2)\n", queue_depth);
+		return NULL;
+	}
+
+	if (sqpoll && strcmp(io_mechanism, "io_uring") && strcmp(io_mechanism, "io_uring_cmd")) {
+		SPDK_ERRLOG("sqpoll is only supported by the io_uring and io_uring_cmd I/O mechanisms\n");
+		return NULL;
+	}
+
 	xnvme = calloc(1, sizeof(*xnvme));
 	if (!xnvme) {
 		SPDK_ERRLOG("Unable to allocate enough memory for xNVMe backend\n");
@@ -427,6 +471,16 @@ create_xnvme_bdev(const char *name, const char *filename, const char *io_mechani
 		}
 	}
 
+	/* With a kernel submission queue polling thread, passing a command to xNVMe only
+	 * places it in the submission queue. The thread then picks up all the commands
+	 * queued since its last pass, without any io_uring_enter() system call.
+	 */
+	xnvme->sqpoll = sqpoll;
+	if (xnvme->sqpoll) {
+		opts.poll_sq = 1;
+	}
+	xnvme->queue_depth = queue_depth;
+
 	xnvme->filename = strdup(filename);
 	if (!xnvme->filename) {
 		goto error_return;
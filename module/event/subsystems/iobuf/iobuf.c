@@ -38,6 +38,7 @@ static void
 iobuf_write_config_json(struct spdk_json_write_ctx *w)
 {
 	struct spdk_iobuf_opts opts;
+	uint8_t c;
 
 	spdk_iobuf_get_opts(&opts, sizeof(opts));
 
@@ -52,6 +53,17 @@ iobuf_write_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "small_bufsize", opts.small_bufsize);
 	spdk_json_write_named_uint32(w, "large_bufsize", opts.large_bufsize);
 	spdk_json_write_named_bool(w, "enable_numa", opts.enable_numa);
+	spdk_json_write_named_bool(w, "enable_steal", opts.enable_steal);
+	if (opts.num_classes > 0) {
+		spdk_json_write_named_array_begin(w, "size_classes");
+		for (c = 0; c < opts.num_classes; c++) {
+			spdk_json_write_object_begin(w);
+			spdk_json_write_named_uint32(w, "bufsize", opts.class_bufsize[c]);
+			spdk_json_write_named_uint64(w, "pool_count", opts.class_pool_count[c]);
+			spdk_json_write_object_end(w);
+		}
+		spdk_json_write_array_end(w);
+	}
 	spdk_json_write_object_end(w);
 	spdk_json_write_object_end(w);
 
@@ -9,12 +9,54 @@
 #include "spdk/string.h"
 #include "spdk_internal/init.h"
 
+struct rpc_iobuf_size_class {
+	uint32_t bufsize;
+	uint64_t pool_count;
+};
+
+static const struct spdk_json_object_decoder rpc_iobuf_size_class_decoders[] = {
+	{"bufsize", offsetof(struct rpc_iobuf_size_class, bufsize), spdk_json_decode_uint32},
+	{"pool_count", offsetof(struct rpc_iobuf_size_class, pool_count), spdk_json_decode_uint64},
+};
+
+static int
+rpc_decode_iobuf_size_class(const struct spdk_json_val *val, void *out)
+{
+	return spdk_json_decode_object(val, rpc_iobuf_size_class_decoders,
+				       SPDK_COUNTOF(rpc_iobuf_size_class_decoders), out);
+}
+
+static int
+rpc_decode_iobuf_size_classes(const struct spdk_json_val *val, void *out)
+{
+	struct spdk_iobuf_opts *opts = SPDK_CONTAINEROF(out, struct spdk_iobuf_opts, num_classes);
+	struct rpc_iobuf_size_class classes[SPDK_IOBUF_MAX_CLASSES] = {};
+	size_t count, i;
+	int rc;
+
+	rc = spdk_json_decode_array(val, rpc_decode_iobuf_size_class, classes, SPDK_IOBUF_MAX_CLASSES,
+				    &count, sizeof(classes[0]));
+	if (rc != 0) {
+		return rc;
+	}
+
+	opts->num_classes = count;
+	for (i = 0; i < count; i++) {
+		opts->class_bufsize[i] = classes[i].bufsize;
+		opts->class_pool_count[i] = classes[i].pool_count;
+	}
+
+	return 0;
+}
+
 static const struct spdk_json_object_decoder rpc_iobuf_set_options_decoders[] = {
 	{"small_pool_count", offsetof(struct spdk_iobuf_opts, small_pool_count), spdk_json_decode_uint64, true},
 	{"large_pool_count", offsetof(struct spdk_iobuf_opts, large_pool_count), spdk_json_decode_uint64, true},
 	{"small_bufsize", offsetof(struct spdk_iobuf_opts, small_bufsize), spdk_json_decode_uint32, true},
 	{"large_bufsize", offsetof(struct spdk_iobuf_opts, large_bufsize), spdk_json_decode_uint32, true},
 	{"enable_numa", offsetof(struct spdk_iobuf_opts, enable_numa), spdk_json_decode_bool, true},
+	{"size_classes", offsetof(struct spdk_iobuf_opts, num_classes), rpc_decode_iobuf_size_classes, true},
+	{"enable_steal", offsetof(struct spdk_iobuf_opts, enable_steal), spdk_json_decode_bool, true},
 };
 
 static void
@@ -49,7 +91,11 @@ rpc_iobuf_get_stats_done(struct spdk_iobuf_module_stats *modules, uint32_t num_m
 	struct spdk_jsonrpc_request *request = cb_arg;
 	struct spdk_json_write_ctx *w;
 	struct spdk_iobuf_module_stats *it;
+	struct spdk_iobuf_opts opts;
 	uint32_t i;
+	uint8_t c;
+
+	spdk_iobuf_get_opts(&opts, sizeof(opts));
 
 	w = spdk_jsonrpc_begin_result(request);
 	spdk_json_write_array_begin(w);
@@ -64,14 +110,30 @@ rpc_iobuf_get_stats_done(struct spdk_iobuf_module_stats *modules, uint32_t num_m
 		spdk_json_write_named_uint64(w, "cache", it->small_pool.cache);
 		spdk_json_write_named_uint64(w, "main", it->small_pool.main);
 		spdk_json_write_named_uint64(w, "retry", it->small_pool.retry);
+		spdk_json_write_named_uint64(w, "steal", it->small_pool.steal);
 		spdk_json_write_object_end(w);
 
 		spdk_json_write_named_object_begin(w, "large_pool");
 		spdk_json_write_named_uint64(w, "cache", it->large_pool.cache);
 		spdk_json_write_named_uint64(w, "main", it->large_pool.main);
 		spdk_json_write_named_uint64(w, "retry", it->large_pool.retry);
+		spdk_json_write_named_uint64(w, "steal", it->large_pool.steal);
 		spdk_json_write_object_end(w);
 
+		if (opts.num_classes > 0) {
+			spdk_json_write_named_array_begin(w, "class_pools");
+			for (c = 0; c < opts.num_classes; c++) {
+				spdk_json_write_object_begin(w);
+				spdk_json_write_named_uint32(w, "bufsize", opts.class_bufsize[c]);
+				spdk_json_write_named_uint64(w, "cache", it->class_pool[c].cache);
+				spdk_json_write_named_uint64(w, "main", it->class_pool[c].main);
+				spdk_json_write_named_uint64(w, "retry", it->class_pool[c].retry);
+				spdk_json_write_named_uint64(w, "steal", it->class_pool[c].steal);
+				spdk_json_write_object_end(w);
+			}
+			spdk_json_write_array_end(w);
+		}
+
 		spdk_json_write_object_end(w);
 	}
 
@@ -25,7 +25,8 @@
 #define DEFAULT_MAX_WRITE 0x00020000
 #define DEFAULT_XATTR_ENABLED false
 #define DEFAULT_SKIP_RW false
-#define DEFAULT_TIMEOUT_MS 0 /* to prevent the attribute caching */
+#define DEFAULT_ATTR_VALID_MS 0 /* to prevent the attribute caching */
+#define DEFAULT_READAHEAD_SIZE 0
 
 #ifdef SPDK_CONFIG_HAVE_STRUCT_STAT_ST_ATIM
 /* Linux */
@@ -72,6 +73,12 @@ struct spdk_fsdev_file_handle {
 		struct dirent *entry;
 		off_t offset;
 	} dir;
+	struct {
+		/* Offset a sequential read is expected to start at */
+		uint64_t next_offs;
+		/* End of the range already requested to be read ahead */
+		uint64_t end;
+	} ra;
 	struct spdk_fsdev_file_object *fobject;
 	TAILQ_ENTRY(spdk_fsdev_file_handle) link;
 };
@@ -104,6 +111,8 @@ struct aio_fsdev {
 	TAILQ_ENTRY(aio_fsdev) tailq;
 	bool xattr_enabled;
 	bool skip_rw;
+	uint32_t attr_valid_ms;
+	uint32_t readahead_size;
 };
 
 struct aio_fsdev_io {
@@ -306,7 +315,8 @@ file_handle_delete(struct spdk_fsdev_file_handle *fhandle)
 }
 
 static int
-file_object_fill_attr(struct spdk_fsdev_file_object *fobject, struct spdk_fsdev_file_attr *attr)
+file_object_fill_attr(struct aio_fsdev *vfsdev, struct spdk_fsdev_file_object *fobject,
+		      struct spdk_fsdev_file_attr *attr)
 {
 	struct stat stbuf;
 	int res;
@@ -335,7 +345,7 @@ file_object_fill_attr(struct spdk_fsdev_file_object *fobject, struct spdk_fsdev_
 	attr->gid = stbuf.st_gid;
 	attr->rdev = stbuf.st_rdev;
 	attr->blksize = stbuf.st_blksize;
-	attr->valid_ms = DEFAULT_TIMEOUT_MS;
+	attr->valid_ms = vfsdev->attr_valid_ms;
 
 	return 0;
 }
@@ -405,7 +415,7 @@ lo_getattr(struct spdk_io_channel *ch, struct spdk_fsdev_io *fsdev_io)
 		return -EINVAL;
 	}
 
-	res = file_object_fill_attr(fobject, &fsdev_io->u_out.getattr.attr);
+	res = file_object_fill_attr(vfsdev, fobject, &fsdev_io->u_out.getattr.attr);
 	if (res) {
 		SPDK_ERRLOG("Cannot fill attr for " FOBJECT_FMT " (err=%d)\n", FOBJECT_ARGS(fobject), res);
 		return res;
@@ -604,7 +614,7 @@ lo_do_lookup(struct aio_fsdev *vfsdev, struct spdk_fsdev_file_object *parent_fob
 	}
 
 	if (attr) {
-		res = file_object_fill_attr(fobject, attr);
+		res = file_object_fill_attr(vfsdev, fobject, attr);
 		if (res) {
 			SPDK_ERRLOG("fill_attr(%s) failed with %d\n", name, res);
 			file_object_unref(fobject, 1);
@@ -631,7 +641,7 @@ lo_lookup(struct spdk_io_channel *ch, struct spdk_fsdev_io *fsdev_io)
 	char *name = fsdev_io->u_in.lookup.name;
 
 	if (!parent_fobject) {
-		err = file_object_fill_attr(vfsdev->root, &fsdev_io->u_out.lookup.attr);
+		err = file_object_fill_attr(vfsdev, vfsdev->root, &fsdev_io->u_out.lookup.attr);
 		if (err) {
 			SPDK_DEBUGLOG(fsdev_aio, "file_object_fill_attr(root) failed with err=%d\n", err);
 			return err;
@@ -1019,7 +1029,7 @@ lo_setattr(struct spdk_io_channel *ch, struct spdk_fsdev_io *fsdev_io)
 		}
 	}
 
-	res = file_object_fill_attr(fobject, &fsdev_io->u_out.setattr.attr);
+	res = file_object_fill_attr(vfsdev, fobject, &fsdev_io->u_out.setattr.attr);
 	if (res) {
 		SPDK_ERRLOG("file_object_fill_attr failed for " FOBJECT_FMT "\n",
 			    FOBJECT_ARGS(fobject));
@@ -1143,6 +1153,40 @@ lo_read_cb(void *ctx, uint32_t data_size, int error)
 	spdk_fsdev_io_complete(fsdev_io, error);
 }
 
+static void
+file_handle_readahead(struct aio_fsdev *vfsdev, struct spdk_fsdev_file_handle *fhandle,
+		      uint64_t offs, size_t size)
+{
+	uint64_t end = offs + size;
+	uint64_t start;
+	int res;
+
+	if (offs != fhandle->ra.next_offs) {
+		/* Not a sequential read, restart the detection from here */
+		fhandle->ra.next_offs = end;
+		fhandle->ra.end = end;
+		return;
+	}
+
+	fhandle->ra.next_offs = end;
+
+	/* Refill the window once half of it has been consumed */
+	if (fhandle->ra.end >= end + vfsdev->readahead_size / 2) {
+		return;
+	}
+
+	start = spdk_max(fhandle->ra.end, end);
+	fhandle->ra.end = end + vfsdev->readahead_size;
+
+	/* Let the host page cache start reading the next window in the background, so that the
+	 * following reads of the stream do not wait for the disk.
+	 */
+	res = posix_fadvise(fhandle->fd, start, fhandle->ra.end - start, POSIX_FADV_WILLNEED);
+	if (res) {
+		SPDK_DEBUGLOG(fsdev_aio, "posix_fadvise(WILLNEED) failed with %d\n", res);
+	}
+}
+
 static int
 lo_read(struct spdk_io_channel *_ch, struct spdk_fsdev_io *fsdev_io)
 {
@@ -1191,6 +1235,10 @@ lo_read(struct spdk_io_channel *_ch, struct spdk_fsdev_io *fsdev_io)
 		return IO_STATUS_ASYNC;
 	}
 
+	if (vfsdev->readahead_size) {
+		file_handle_readahead(vfsdev, fhandle, offs, size);
+	}
+
 	vfsdev_io->aio = spdk_aio_mgr_read(ch->mgr, lo_read_cb, fsdev_io, fhandle->fd, offs, size, outvec,
 					   outcnt);
 	if (vfsdev_io->aio) {
@@ -2303,6 +2351,8 @@ fsdev_aio_write_config_json(struct spdk_fsdev *fsdev, struct spdk_json_write_ctx
 				   !!vfsdev->mount_opts.writeback_cache_enabled);
 	spdk_json_write_named_uint32(w, "max_write", vfsdev->mount_opts.max_write);
 	spdk_json_write_named_bool(w, "skip_rw", vfsdev->skip_rw);
+	spdk_json_write_named_uint32(w, "attr_valid_ms", vfsdev->attr_valid_ms);
+	spdk_json_write_named_uint32(w, "readahead_size", vfsdev->readahead_size);
 	spdk_json_write_object_end(w); /* params */
 	spdk_json_write_object_end(w);
 }
@@ -2371,6 +2421,8 @@ spdk_fsdev_aio_get_default_opts(struct spdk_fsdev_aio_opts *opts)
 	opts->writeback_cache_enabled = DEFAULT_WRITEBACK_CACHE;
 	opts->max_write = DEFAULT_MAX_WRITE;
 	opts->skip_rw = DEFAULT_SKIP_RW;
+	opts->attr_valid_ms = DEFAULT_ATTR_VALID_MS;
+	opts->readahead_size = DEFAULT_READAHEAD_SIZE;
 }
 
 int
@@ -2439,13 +2491,17 @@ spdk_fsdev_aio_create(struct spdk_fsdev **fsdev, const char *name, const char *r
 	vfsdev->mount_opts.max_write = DEFAULT_MAX_WRITE;
 
 	vfsdev->skip_rw = opts->skip_rw;
+	vfsdev->attr_valid_ms = opts->attr_valid_ms;
+	vfsdev->readahead_size = opts->readahead_size;
 
 	*fsdev = &(vfsdev->fsdev);
 	TAILQ_INSERT_TAIL(&g_aio_fsdev_head, vfsdev, tailq);
 	SPDK_DEBUGLOG(fsdev_aio, "Created aio filesystem %s (xattr_enabled=%" PRIu8 " writeback_cache=%"
-		      PRIu8 " max_write=%" PRIu32 " skip_rw=%" PRIu8 ")\n",
+		      PRIu8 " max_write=%" PRIu32 " skip_rw=%" PRIu8 " attr_valid_ms=%" PRIu32
+		      " readahead_size=%" PRIu32 ")\n",
 		      vfsdev->fsdev.name, vfsdev->xattr_enabled, vfsdev->mount_opts.writeback_cache_enabled,
-		      vfsdev->mount_opts.max_write, vfsdev->skip_rw);
+		      vfsdev->mount_opts.max_write, vfsdev->skip_rw, vfsdev->attr_valid_ms,
+		      vfsdev->readahead_size);
 	return rc;
 }
 void
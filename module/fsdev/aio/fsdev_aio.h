@@ -17,6 +17,8 @@ struct spdk_fsdev_aio_opts {
 	bool writeback_cache_enabled;
 	uint32_t max_write;
 	bool skip_rw;
+	uint32_t attr_valid_ms;
+	uint32_t readahead_size;
 };
 
 typedef void (*spdk_delete_aio_fsdev_complete)(void *cb_arg, int fsdeverrno);
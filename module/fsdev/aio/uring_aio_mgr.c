@@ -0,0 +1,255 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ */
+#include "spdk/stdinc.h"
+#include "spdk/util.h"
+#include "spdk/log.h"
+#include "aio_mgr.h"
+#include <liburing.h>
+
+#define MAX_COMPLETIONS_PER_POLL 64
+
+struct spdk_aio_mgr_io {
+	struct spdk_aio_mgr *mgr;
+	TAILQ_ENTRY(spdk_aio_mgr_io) link;
+	fsdev_aio_done_cb clb;
+	void *ctx;
+};
+
+struct spdk_aio_mgr {
+	TAILQ_HEAD(, spdk_aio_mgr_io) in_flight;
+	struct io_uring ring;
+	struct {
+		struct spdk_aio_mgr_io *arr;
+		uint32_t size;
+		TAILQ_HEAD(, spdk_aio_mgr_io) pool;
+	} aios;
+	/* Number of SQEs prepared since the last io_uring_submit() */
+	uint32_t num_pending;
+};
+
+static struct spdk_aio_mgr_io *
+aio_mgr_get_aio(struct spdk_aio_mgr *mgr, fsdev_aio_done_cb clb, void *ctx)
+{
+	struct spdk_aio_mgr_io *aio = TAILQ_FIRST(&mgr->aios.pool);
+
+	if (aio) {
+		aio->mgr = mgr;
+		aio->clb = clb;
+		aio->ctx = ctx;
+		TAILQ_REMOVE(&mgr->aios.pool, aio, link);
+	}
+
+	return aio;
+}
+
+static inline void
+aio_mgr_put_aio(struct spdk_aio_mgr *mgr, struct spdk_aio_mgr_io *aio)
+{
+	TAILQ_INSERT_TAIL(&aio->mgr->aios.pool, aio, link);
+}
+
+static int
+aio_mgr_submit_pending(struct spdk_aio_mgr *mgr)
+{
+	int res;
+
+	if (!mgr->num_pending) {
+		return 0;
+	}
+
+	res = io_uring_submit(&mgr->ring);
+	if (res < 0) {
+		return res;
+	}
+
+	mgr->num_pending = 0;
+	return 0;
+}
+
+static struct io_uring_sqe *
+aio_mgr_get_sqe(struct spdk_aio_mgr *mgr)
+{
+	struct io_uring_sqe *sqe;
+
+	sqe = io_uring_get_sqe(&mgr->ring);
+	if (!sqe) {
+		/* The SQ is full of requests prepared in this poller iteration, flush them */
+		if (aio_mgr_submit_pending(mgr)) {
+			return NULL;
+		}
+		sqe = io_uring_get_sqe(&mgr->ring);
+	}
+
+	return sqe;
+}
+
+static struct spdk_aio_mgr_io *
+spdk_aio_mgr_submit_io(struct spdk_aio_mgr *mgr, fsdev_aio_done_cb clb, void *ctx, int fd,
+		       uint64_t offs, uint32_t size, struct iovec *iovs, uint32_t iovcnt, bool read)
+{
+	struct spdk_aio_mgr_io *aio;
+	struct io_uring_sqe *sqe;
+
+	SPDK_DEBUGLOG(spdk_aio_mgr_io, "%s: fd=%d offs=%" PRIu64 " size=%" PRIu32 " iovcnt=%" PRIu32 "\n",
+		      read ? "read" : "write", fd, offs, size, iovcnt);
+
+	aio = aio_mgr_get_aio(mgr, clb, ctx);
+	if (!aio) {
+		SPDK_ERRLOG("Cannot get aio\n");
+		clb(ctx, 0, EFAULT);
+		return NULL;
+	}
+
+	sqe = aio_mgr_get_sqe(mgr);
+	if (!sqe) {
+		SPDK_ERRLOG("Cannot get sqe\n");
+		aio_mgr_put_aio(mgr, aio);
+		clb(ctx, 0, EAGAIN);
+		return NULL;
+	}
+
+	if (read) {
+		io_uring_prep_readv(sqe, fd, iovs, iovcnt, offs);
+	} else {
+		io_uring_prep_writev(sqe, fd, iovs, iovcnt, offs);
+	}
+	io_uring_sqe_set_data(sqe, aio);
+
+	/* The request is submitted by the next spdk_aio_mgr_poll(), together with the other
+	 * requests prepared until then, with a single system call.
+	 */
+	mgr->num_pending++;
+	TAILQ_INSERT_TAIL(&mgr->in_flight, aio, link);
+
+	SPDK_DEBUGLOG(spdk_aio_mgr_io, "%s: aio=%p queued\n", read ? "read" : "write", aio);
+
+	return aio;
+}
+
+struct spdk_aio_mgr *
+spdk_aio_mgr_create(uint32_t max_aios)
+{
+	struct spdk_aio_mgr *mgr;
+	int res;
+	uint32_t i;
+
+	mgr = calloc(1, sizeof(*mgr));
+	if (!mgr) {
+		SPDK_ERRLOG("cannot alloc mgr of %zu bytes\n", sizeof(*mgr));
+		return NULL;
+	}
+
+	/* Each request may need an SQE for its cancellation too */
+	res = io_uring_queue_init(spdk_align32pow2(max_aios * 2), &mgr->ring, 0);
+	if (res) {
+		SPDK_ERRLOG("io_uring_queue_init(%" PRIu32 ") failed with %d\n", max_aios, res);
+		free(mgr);
+		return NULL;
+	}
+
+	mgr->aios.arr = calloc(max_aios, sizeof(mgr->aios.arr[0]));
+	if (!mgr->aios.arr) {
+		SPDK_ERRLOG("cannot alloc aios pool of %" PRIu32 "\n", max_aios);
+		io_uring_queue_exit(&mgr->ring);
+		free(mgr);
+		return NULL;
+	}
+
+	mgr->aios.size = max_aios;
+	TAILQ_INIT(&mgr->in_flight);
+	TAILQ_INIT(&mgr->aios.pool);
+
+	for (i = 0; i < max_aios; i++) {
+		TAILQ_INSERT_TAIL(&mgr->aios.pool, &mgr->aios.arr[i], link);
+	}
+
+	return mgr;
+}
+
+struct spdk_aio_mgr_io *
+spdk_aio_mgr_read(struct spdk_aio_mgr *mgr, fsdev_aio_done_cb clb, void *ctx,
+		  int fd, uint64_t offs, uint32_t size, struct iovec *iovs, uint32_t iovcnt)
+{
+	return spdk_aio_mgr_submit_io(mgr, clb, ctx, fd, offs, size, iovs, iovcnt, true);
+}
+
+struct spdk_aio_mgr_io *
+spdk_aio_mgr_write(struct spdk_aio_mgr *mgr, fsdev_aio_done_cb clb, void *ctx,
+		   int fd, uint64_t offs, uint32_t size, const struct iovec *iovs, uint32_t iovcnt)
+{
+	return spdk_aio_mgr_submit_io(mgr, clb, ctx, fd, offs, size, (struct iovec *)iovs, iovcnt, false);
+}
+
+void
+spdk_aio_mgr_cancel(struct spdk_aio_mgr *mgr, struct spdk_aio_mgr_io *aio)
+{
+	struct io_uring_sqe *sqe;
+
+	assert(mgr == aio->mgr);
+
+	/* The cancelled request completes through its own CQE, with -ECANCELED if the
+	 * cancellation succeeded. The CQE of the cancel request itself is ignored.
+	 */
+	sqe = aio_mgr_get_sqe(mgr);
+	if (!sqe) {
+		SPDK_WARNLOG("aio=%p cancellation failed, no sqe\n", aio);
+		return;
+	}
+
+	io_uring_prep_cancel(sqe, aio, 0);
+	io_uring_sqe_set_data(sqe, NULL);
+	mgr->num_pending++;
+
+	SPDK_DEBUGLOG(spdk_aio_mgr_io, "aio=%p cancellation queued\n", aio);
+}
+
+bool
+spdk_aio_mgr_poll(struct spdk_aio_mgr *mgr)
+{
+	struct io_uring_cqe *cqes[MAX_COMPLETIONS_PER_POLL];
+	struct spdk_aio_mgr_io *aio;
+	bool submitted = mgr->num_pending != 0;
+	uint32_t count, i;
+	int res;
+
+	res = aio_mgr_submit_pending(mgr);
+	if (res) {
+		SPDK_WARNLOG("submission failed with err=%d\n", res);
+	}
+
+	count = io_uring_peek_batch_cqe(&mgr->ring, cqes, SPDK_COUNTOF(cqes));
+	for (i = 0; i < count; i++) {
+		aio = io_uring_cqe_get_data(cqes[i]);
+		res = cqes[i]->res;
+
+		if (!aio) {
+			/* Completion of a cancel request */
+			continue;
+		}
+
+		TAILQ_REMOVE(&mgr->in_flight, aio, link);
+
+		if (res < 0) {
+			aio->clb(aio->ctx, 0, -res);
+		} else {
+			aio->clb(aio->ctx, res, 0);
+		}
+
+		aio_mgr_put_aio(mgr, aio);
+	}
+	io_uring_cq_advance(&mgr->ring, count);
+
+	return submitted || count;
+}
+
+void
+spdk_aio_mgr_delete(struct spdk_aio_mgr *mgr)
+{
+	assert(TAILQ_EMPTY(&mgr->in_flight));
+	free(mgr->aios.arr);
+	io_uring_queue_exit(&mgr->ring);
+	free(mgr);
+}
+
+SPDK_LOG_REGISTER_COMPONENT(spdk_aio_mgr_io)
@@ -81,6 +81,22 @@ _set_core_freq_min(uint32_t lcore_id)
 	return rte_power_freq_min(lcore_id);
 }
 
+static int
+_set_core_freq(uint32_t lcore_id, uint32_t freq)
+{
+	uint32_t freqs[SPDK_MAX_LCORE_FREQS];
+	uint32_t i, num_freqs;
+
+	num_freqs = rte_power_freqs(lcore_id, freqs, SPDK_MAX_LCORE_FREQS);
+	for (i = 0; i < num_freqs; i++) {
+		if (freqs[i] == freq) {
+			return rte_power_set_freq(lcore_id, i);
+		}
+	}
+
+	return -EINVAL;
+}
+
 static int
 _get_core_capabilities(uint32_t lcore_id, struct spdk_governor_capabilities *capabilities)
 {
@@ -236,6 +252,7 @@ static struct spdk_governor dpdk_governor = {
 	.core_freq_down = _core_freq_down,
 	.set_core_freq_max = _set_core_freq_max,
 	.set_core_freq_min = _set_core_freq_min,
+	.set_core_freq = _set_core_freq,
 	.get_core_capabilities = _get_core_capabilities,
 	.dump_info_json = _dump_info_json,
 	.init = _init,
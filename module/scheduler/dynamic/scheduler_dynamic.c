@@ -9,7 +9,9 @@
 #include "spdk/log.h"
 #include "spdk/env.h"
 
+#include "spdk/cpuset.h"
 #include "spdk/thread.h"
+#include "spdk/tree.h"
 #include "spdk_internal/event.h"
 #include "spdk/scheduler.h"
 #include "spdk_internal/usdt.h"
@@ -21,6 +23,47 @@ struct core_stats {
 	uint64_t idle;
 	uint32_t thread_count;
 	bool isolated;
+	int32_t numa_id;
+	/* SMT siblings of the core, including itself. Empty if SMT detection is not supported. */
+	struct spdk_cpuset smt_siblings;
+	/* Smoothed load of the core over the previous scheduling periods. */
+	uint64_t avg_busy;
+	uint64_t avg_idle;
+	bool avg_valid;
+};
+
+/* Load history of a thread, kept only when load smoothing or move interval are enabled. */
+struct thread_history {
+	uint64_t thread_id;
+	uint64_t avg_busy;
+	uint64_t avg_idle;
+	/* Scheduling period the thread was last moved in, and last seen in. */
+	uint64_t moved_period;
+	uint64_t seen_period;
+	RB_ENTRY(thread_history) node;
+};
+
+static int
+thread_history_cmp(struct thread_history *h1, struct thread_history *h2)
+{
+	return h1->thread_id < h2->thread_id ? -1 : h1->thread_id > h2->thread_id;
+}
+
+static RB_HEAD(thread_history_tree, thread_history) g_thread_history =
+	RB_INITIALIZER(g_thread_history);
+RB_GENERATE_STATIC(thread_history_tree, thread_history, node, thread_history_cmp);
+
+static uint64_t g_period;
+
+/*
+ * Active threads are placed in passes of decreasing locality. Leaving the NUMA node of the
+ * thread's current core, or sharing a physical core with another busy thread, is only
+ * considered when the current core is over the limit.
+ */
+enum core_locality {
+	CORE_LOCALITY_NODE_SMT_FREE,
+	CORE_LOCALITY_NODE,
+	CORE_LOCALITY_ANY,
 };
 
 static struct core_stats *g_cores;
@@ -28,6 +71,34 @@ static struct core_stats *g_cores;
 uint8_t g_scheduler_load_limit = 20;
 uint8_t g_scheduler_core_limit = 80;
 uint8_t g_scheduler_core_busy = 95;
+/* Weight in % of the history in the smoothed loads, 0 uses the last period only. */
+uint8_t g_scheduler_load_smoothing;
+/* Minimum number of scheduling periods between two moves of a thread. */
+uint32_t g_scheduler_move_interval;
+/* Extra load in % of the thread's busy time expected on the core it moves to. */
+uint8_t g_scheduler_migration_cost;
+
+static inline bool
+_history_enabled(void)
+{
+	return g_scheduler_load_smoothing != 0 || g_scheduler_move_interval != 0;
+}
+
+static uint64_t
+_smooth(uint64_t avg, uint64_t current)
+{
+	/* Split the multiplication to not overflow on large tsc values. */
+	return avg / 100 * g_scheduler_load_smoothing + current / 100 * (100 - g_scheduler_load_smoothing) +
+	       (avg % 100 * g_scheduler_load_smoothing + current % 100 * (100 - g_scheduler_load_smoothing)) / 100;
+}
+
+static struct thread_history *
+_get_thread_history(uint64_t thread_id)
+{
+	struct thread_history find = { .thread_id = thread_id };
+
+	return RB_FIND(thread_history_tree, &g_thread_history, &find);
+}
 
 static uint8_t
 _busy_pct(uint64_t busy, uint64_t idle)
@@ -108,6 +179,7 @@ _move_thread(struct spdk_scheduler_thread_info *thread_info, uint32_t dst_core)
 {
 	struct core_stats *dst = &g_cores[dst_core];
 	struct core_stats *src = &g_cores[thread_info->lcore];
+	struct thread_history *history;
 	uint64_t busy_tsc = thread_info->current_stats.busy_tsc;
 	uint8_t busy_pct = _busy_pct(src->busy, src->idle);
 	uint64_t tsc;
@@ -119,6 +191,13 @@ _move_thread(struct spdk_scheduler_thread_info *thread_info, uint32_t dst_core)
 		return;
 	}
 
+	if (_history_enabled()) {
+		history = _get_thread_history(thread_info->thread_id);
+		if (history != NULL) {
+			history->moved_period = g_period;
+		}
+	}
+
 	dst->busy += spdk_min(UINT64_MAX - dst->busy, busy_tsc);
 	dst->idle -= spdk_min(dst->idle, busy_tsc);
 	dst->thread_count++;
@@ -181,7 +260,7 @@ static bool
 _can_core_fit_thread(struct spdk_scheduler_thread_info *thread_info, uint32_t dst_core)
 {
 	struct core_stats *dst = &g_cores[dst_core];
-	uint64_t new_busy_tsc, new_idle_tsc;
+	uint64_t busy_tsc, new_busy_tsc, new_idle_tsc;
 
 	/* Thread can always fit on the core it's currently on. */
 	if (thread_info->lcore == dst_core) {
@@ -199,34 +278,91 @@ _can_core_fit_thread(struct spdk_scheduler_thread_info *thread_info, uint32_t ds
 		return true;
 	}
 
+	/* A moved thread runs cache cold for a while, account for it on the new core. */
+	busy_tsc = thread_info->current_stats.busy_tsc;
+	busy_tsc += busy_tsc / 100 * g_scheduler_migration_cost +
+		    busy_tsc % 100 * g_scheduler_migration_cost / 100;
+
 	/* Core doesn't have enough idle_tsc to take this thread. */
-	if (dst->idle < thread_info->current_stats.busy_tsc) {
+	if (dst->idle < busy_tsc) {
 		return false;
 	}
 
-	new_busy_tsc = dst->busy + thread_info->current_stats.busy_tsc;
-	new_idle_tsc = dst->idle - thread_info->current_stats.busy_tsc;
+	new_busy_tsc = dst->busy + busy_tsc;
+	new_idle_tsc = dst->idle - busy_tsc;
 
 	/* Core cannot fit this thread if it would put it over the
 	 * g_scheduler_core_limit. */
 	return _busy_pct(new_busy_tsc, new_idle_tsc) < g_scheduler_core_limit;
 }
 
+static bool
+_is_same_numa_node(uint32_t core1, uint32_t core2)
+{
+	int32_t numa_id1 = g_cores[core1].numa_id;
+	int32_t numa_id2 = g_cores[core2].numa_id;
+
+	return numa_id1 == numa_id2 || numa_id1 == SPDK_ENV_NUMA_ID_ANY ||
+	       numa_id2 == SPDK_ENV_NUMA_ID_ANY;
+}
+
+static bool
+_is_smt_sibling_busy(struct spdk_scheduler_thread_info *thread_info, uint32_t core_id)
+{
+	struct core_stats *sibling;
+	uint64_t busy, idle, busy_tsc;
+	uint32_t i, thread_count;
+
+	SPDK_ENV_FOREACH_CORE(i) {
+		if (i == core_id || !spdk_cpuset_get_cpu(&g_cores[core_id].smt_siblings, i)) {
+			continue;
+		}
+
+		sibling = &g_cores[i];
+		busy = sibling->busy;
+		idle = sibling->idle;
+		thread_count = sibling->thread_count;
+
+		/* Only the threads remaining on the current core compete with the moved one. */
+		if (i == thread_info->lcore) {
+			busy_tsc = spdk_min(busy, thread_info->current_stats.busy_tsc);
+			busy -= busy_tsc;
+			idle += busy_tsc;
+			thread_count -= spdk_min(thread_count, 1);
+		}
+
+		if (thread_count > 0 && _busy_pct(busy, idle) >= g_scheduler_load_limit) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool
+_is_core_local(struct spdk_scheduler_thread_info *thread_info, uint32_t core_id,
+	       enum core_locality locality)
+{
+	switch (locality) {
+	case CORE_LOCALITY_NODE_SMT_FREE:
+		if (_is_smt_sibling_busy(thread_info, core_id)) {
+			return false;
+		}
+	/* fallthrough */
+	case CORE_LOCALITY_NODE:
+		return _is_same_numa_node(core_id, thread_info->lcore);
+	case CORE_LOCALITY_ANY:
+	default:
+		return true;
+	}
+}
+
 static uint32_t
-_find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
+_find_local_core(struct spdk_scheduler_thread_info *thread_info, struct spdk_cpuset *cpumask,
+		 enum core_locality locality, bool core_at_limit)
 {
 	uint32_t i;
 	uint32_t current_lcore = thread_info->lcore;
-	uint32_t least_busy_lcore = thread_info->lcore;
-	struct spdk_thread *thread;
-	struct spdk_cpuset *cpumask;
-	bool core_at_limit = _is_core_at_limit(current_lcore);
-
-	thread = spdk_thread_get_by_id(thread_info->thread_id);
-	if (thread == NULL) {
-		return current_lcore;
-	}
-	cpumask = spdk_thread_get_cpumask(thread);
 
 	/* Find a core that can fit the thread. */
 	SPDK_ENV_FOREACH_CORE(i) {
@@ -240,13 +376,9 @@ _find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
 			continue;
 		}
 
-		/* Search for least busy core. */
-		if (g_cores[i].busy < g_cores[least_busy_lcore].busy) {
-			least_busy_lcore = i;
-		}
-
-		/* Skip cores that cannot fit the thread and current one. */
-		if (!_can_core_fit_thread(thread_info, i) || i == current_lcore) {
+		/* Skip cores that cannot fit the thread, too far away ones and current one. */
+		if (i == current_lcore || !_is_core_local(thread_info, i, locality) ||
+		    !_can_core_fit_thread(thread_info, i)) {
 			continue;
 		}
 		if (i == g_main_lcore) {
@@ -261,19 +393,73 @@ _find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
 		}
 	}
 
+	return current_lcore;
+}
+
+static uint32_t
+_find_least_busy_core(struct spdk_cpuset *cpumask, uint32_t current_lcore, bool any_node)
+{
+	uint32_t i;
+	uint32_t least_busy_lcore = current_lcore;
+
+	SPDK_ENV_FOREACH_CORE(i) {
+		if (!spdk_cpuset_get_cpu(cpumask, i) || g_cores[i].isolated) {
+			continue;
+		}
+
+		if (!any_node && !_is_same_numa_node(i, current_lcore)) {
+			continue;
+		}
+
+		if (g_cores[i].busy < g_cores[least_busy_lcore].busy) {
+			least_busy_lcore = i;
+		}
+	}
+
+	return least_busy_lcore;
+}
+
+static uint32_t
+_find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
+{
+	uint32_t current_lcore = thread_info->lcore;
+	uint32_t target_lcore;
+	struct spdk_thread *thread;
+	struct spdk_cpuset *cpumask;
+	bool core_at_limit = _is_core_at_limit(current_lcore);
+	enum core_locality locality;
+
+	thread = spdk_thread_get_by_id(thread_info->thread_id);
+	if (thread == NULL) {
+		return current_lcore;
+	}
+	cpumask = spdk_thread_get_cpumask(thread);
+
+	/* Consolidating threads is not worth moving them away from their NUMA node or next
+	 * to a busy SMT sibling, so only relax the locality when the current core is overloaded.
+	 */
+	for (locality = CORE_LOCALITY_NODE_SMT_FREE; locality <= CORE_LOCALITY_ANY; locality++) {
+		target_lcore = _find_local_core(thread_info, cpumask, locality, core_at_limit);
+		if (target_lcore != current_lcore || !core_at_limit) {
+			return target_lcore;
+		}
+	}
+
 	/* For cores over the limit, place the thread on least busy core
-	 * to balance threads. */
-	if (core_at_limit) {
-		return least_busy_lcore;
+	 * to balance threads, preferably on the same NUMA node. */
+	target_lcore = _find_least_busy_core(cpumask, current_lcore, false);
+	if (target_lcore == current_lcore) {
+		target_lcore = _find_least_busy_core(cpumask, current_lcore, true);
 	}
 
-	/* If no better core is found, remain on the same one. */
-	return current_lcore;
+	return target_lcore;
 }
 
 static int
 init(void)
 {
+	uint32_t i;
+
 	g_main_lcore = spdk_scheduler_get_scheduling_lcore();
 
 	if (spdk_governor_set("dpdk_governor") != 0) {
@@ -286,23 +472,93 @@ init(void)
 		return -ENOMEM;
 	}
 
+	SPDK_ENV_FOREACH_CORE(i) {
+		g_cores[i].numa_id = spdk_env_get_numa_id(i);
+		if (!spdk_env_core_get_smt_cpuset(&g_cores[i].smt_siblings, i)) {
+			spdk_cpuset_zero(&g_cores[i].smt_siblings);
+		}
+	}
+
 	return 0;
 }
 
+static void
+_free_thread_history(bool stale_only)
+{
+	struct thread_history *history, *tmp;
+
+	RB_FOREACH_SAFE(history, thread_history_tree, &g_thread_history, tmp) {
+		if (stale_only && history->seen_period == g_period) {
+			continue;
+		}
+		RB_REMOVE(thread_history_tree, &g_thread_history, history);
+		free(history);
+	}
+}
+
 static void
 deinit(void)
 {
+	_free_thread_history(false);
 	free(g_cores);
 	g_cores = NULL;
 	spdk_governor_set(NULL);
 }
 
+static void
+_update_thread_history(struct spdk_scheduler_thread_info *thread_info)
+{
+	struct thread_history *history;
+	struct spdk_thread_stats *stats = &thread_info->current_stats;
+
+	history = _get_thread_history(thread_info->thread_id);
+	if (history == NULL) {
+		history = calloc(1, sizeof(*history));
+		if (history == NULL) {
+			/* Without history the thread is scheduled on its last period only. */
+			return;
+		}
+		history->thread_id = thread_info->thread_id;
+		history->avg_busy = stats->busy_tsc;
+		history->avg_idle = stats->idle_tsc;
+		RB_INSERT(thread_history_tree, &g_thread_history, history);
+	} else {
+		history->avg_busy = _smooth(history->avg_busy, stats->busy_tsc);
+		history->avg_idle = _smooth(history->avg_idle, stats->idle_tsc);
+	}
+	history->seen_period = g_period;
+
+	/* The rest of the scheduling works on the smoothed load. */
+	stats->busy_tsc = history->avg_busy;
+	stats->idle_tsc = history->avg_idle;
+}
+
+static bool
+_is_thread_settled(struct spdk_scheduler_thread_info *thread_info)
+{
+	struct thread_history *history;
+
+	if (g_scheduler_move_interval == 0) {
+		return false;
+	}
+
+	history = _get_thread_history(thread_info->thread_id);
+
+	/* Periods are counted from 1, so a thread that was never moved has moved_period 0. */
+	return history != NULL && history->moved_period != 0 &&
+	       g_period - history->moved_period < g_scheduler_move_interval;
+}
+
 static void
 _balance_idle(struct spdk_scheduler_thread_info *thread_info)
 {
 	if (_get_thread_load(thread_info) >= g_scheduler_load_limit) {
 		return;
 	}
+	/* Don't bounce a thread that was moved recently. */
+	if (_is_thread_settled(thread_info)) {
+		return;
+	}
 	/* This thread is idle, move it to the main core. */
 	_move_thread(thread_info, g_main_lcore);
 }
@@ -316,6 +572,13 @@ _balance_active(struct spdk_scheduler_thread_info *thread_info)
 		return;
 	}
 
+	/* A recently moved thread stays, unless its core is overloaded. */
+	if (_is_thread_settled(thread_info) &&
+	    _busy_pct(g_cores[thread_info->lcore].busy,
+		      g_cores[thread_info->lcore].idle) < g_scheduler_core_busy) {
+		return;
+	}
+
 	/* This thread is active. */
 	target_lcore = _find_optimal_core(thread_info);
 	_move_thread(thread_info, target_lcore);
@@ -334,15 +597,31 @@ balance(struct spdk_scheduler_core_info *cores_info, uint32_t cores_count)
 
 	SPDK_DTRACE_PROBE1(dynsched_balance, cores_count);
 
+	g_period++;
+
 	SPDK_ENV_FOREACH_CORE(i) {
 		g_cores[i].thread_count = cores_info[i].threads_count;
 		g_cores[i].busy = cores_info[i].current_busy_tsc;
 		g_cores[i].idle = cores_info[i].current_idle_tsc;
 		g_cores[i].isolated = cores_info[i].isolated;
 		SPDK_DTRACE_PROBE2(dynsched_core_info, i, &cores_info[i]);
+
+		if (g_scheduler_load_smoothing != 0 && g_cores[i].avg_valid) {
+			g_cores[i].busy = _smooth(g_cores[i].avg_busy, g_cores[i].busy);
+			g_cores[i].idle = _smooth(g_cores[i].avg_idle, g_cores[i].idle);
+		}
+		g_cores[i].avg_busy = g_cores[i].busy;
+		g_cores[i].avg_idle = g_cores[i].idle;
+		g_cores[i].avg_valid = true;
 	}
 	main_core = &g_cores[g_main_lcore];
 
+	if (_history_enabled()) {
+		_foreach_thread(cores_info, _update_thread_history);
+		/* Forget the threads which are gone. */
+		_free_thread_history(true);
+	}
+
 	/* Distribute threads in two passes, to make sure updated core stats are considered on each pass.
 	 * 1) Move all idle threads to main core. */
 	_foreach_thread(cores_info, _balance_idle);
@@ -399,12 +678,18 @@ struct json_scheduler_opts {
 	uint8_t load_limit;
 	uint8_t core_limit;
 	uint8_t core_busy;
+	uint8_t load_smoothing;
+	uint32_t move_interval;
+	uint8_t migration_cost;
 };
 
 static const struct spdk_json_object_decoder sched_decoders[] = {
 	{"load_limit", offsetof(struct json_scheduler_opts, load_limit), spdk_json_decode_uint8, true},
 	{"core_limit", offsetof(struct json_scheduler_opts, core_limit), spdk_json_decode_uint8, true},
 	{"core_busy", offsetof(struct json_scheduler_opts, core_busy), spdk_json_decode_uint8, true},
+	{"load_smoothing", offsetof(struct json_scheduler_opts, load_smoothing), spdk_json_decode_uint8, true},
+	{"move_interval", offsetof(struct json_scheduler_opts, move_interval), spdk_json_decode_uint32, true},
+	{"migration_cost", offsetof(struct json_scheduler_opts, migration_cost), spdk_json_decode_uint8, true},
 };
 
 static int
@@ -415,6 +700,9 @@ set_opts(const struct spdk_json_val *opts)
 	scheduler_opts.load_limit = g_scheduler_load_limit;
 	scheduler_opts.core_limit = g_scheduler_core_limit;
 	scheduler_opts.core_busy = g_scheduler_core_busy;
+	scheduler_opts.load_smoothing = g_scheduler_load_smoothing;
+	scheduler_opts.move_interval = g_scheduler_move_interval;
+	scheduler_opts.migration_cost = g_scheduler_migration_cost;
 
 	if (opts != NULL) {
 		if (spdk_json_decode_object_relaxed(opts, sched_decoders,
@@ -424,12 +712,27 @@ set_opts(const struct spdk_json_val *opts)
 		}
 	}
 
+	if (scheduler_opts.load_smoothing >= 100) {
+		SPDK_ERRLOG("Scheduler load smoothing must be lower than 100\n");
+		return -1;
+	}
+
 	SPDK_NOTICELOG("Setting scheduler load limit to %d\n", scheduler_opts.load_limit);
 	g_scheduler_load_limit = scheduler_opts.load_limit;
 	SPDK_NOTICELOG("Setting scheduler core limit to %d\n", scheduler_opts.core_limit);
 	g_scheduler_core_limit = scheduler_opts.core_limit;
 	SPDK_NOTICELOG("Setting scheduler core busy to %d\n", scheduler_opts.core_busy);
 	g_scheduler_core_busy = scheduler_opts.core_busy;
+	SPDK_NOTICELOG("Setting scheduler load smoothing to %d\n", scheduler_opts.load_smoothing);
+	g_scheduler_load_smoothing = scheduler_opts.load_smoothing;
+	SPDK_NOTICELOG("Setting scheduler move interval to %u\n", scheduler_opts.move_interval);
+	g_scheduler_move_interval = scheduler_opts.move_interval;
+	SPDK_NOTICELOG("Setting scheduler migration cost to %d\n", scheduler_opts.migration_cost);
+	g_scheduler_migration_cost = scheduler_opts.migration_cost;
+
+	if (!_history_enabled()) {
+		_free_thread_history(false);
+	}
 
 	return 0;
 }
@@ -440,6 +743,9 @@ get_opts(struct spdk_json_write_ctx *ctx)
 	spdk_json_write_named_uint8(ctx, "load_limit", g_scheduler_load_limit);
 	spdk_json_write_named_uint8(ctx, "core_limit", g_scheduler_core_limit);
 	spdk_json_write_named_uint8(ctx, "core_busy", g_scheduler_core_busy);
+	spdk_json_write_named_uint8(ctx, "load_smoothing", g_scheduler_load_smoothing);
+	spdk_json_write_named_uint32(ctx, "move_interval", g_scheduler_move_interval);
+	spdk_json_write_named_uint8(ctx, "migration_cost", g_scheduler_migration_cost);
 }
 
 static struct spdk_scheduler scheduler_dynamic = {
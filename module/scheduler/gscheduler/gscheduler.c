@@ -17,6 +17,13 @@ static uint32_t g_max_threshold = 99;
 static uint32_t g_adjust_threshold = 50;
 static uint32_t g_min_threshold = 1;
 
+/* Busy % the core frequency is set to reach, proportionally to the load. 0 steps the frequency
+ * up and down instead. */
+static uint8_t g_target_busy = 0;
+/* Rise of the busy % since the previous period that sets the maximal frequency right away */
+static uint8_t g_boost_delta = 30;
+static uint32_t g_prev_busy_pct[SPDK_CONFIG_MAX_LCORES];
+
 static int
 init(void)
 {
@@ -57,13 +64,49 @@ check_sibling(void *_ctx, uint32_t i)
 	ctx->busy_pct = spdk_max(ctx->busy_pct, busy_pct);
 }
 
+/*
+ * The core did busy_pct % of the work it could do at its current frequency. Set the lowest
+ * frequency doing the same work in g_target_busy % of the time.
+ */
+static int
+set_proportional_freq(struct spdk_governor *governor, uint32_t lcore, uint32_t busy_pct)
+{
+	uint32_t freqs[SPDK_MAX_LCORE_FREQS];
+	uint32_t num_freqs, cur_freq, freq = 0, max_freq = 0, i;
+	uint64_t needed;
+
+	num_freqs = governor->get_core_avail_freqs(lcore, freqs, SPDK_COUNTOF(freqs));
+	cur_freq = governor->get_core_curr_freq(lcore);
+	if (num_freqs == 0 || cur_freq == 0) {
+		return -EINVAL;
+	}
+
+	needed = (uint64_t)cur_freq * busy_pct / g_target_busy;
+	for (i = 0; i < num_freqs; i++) {
+		max_freq = spdk_max(max_freq, freqs[i]);
+		if (freqs[i] >= needed && (freq == 0 || freqs[i] < freq)) {
+			freq = freqs[i];
+		}
+	}
+
+	if (freq == 0) {
+		freq = max_freq;
+	}
+
+	if (freq == cur_freq) {
+		return 0;
+	}
+
+	return governor->set_core_freq(lcore, freq);
+}
+
 static void
 balance(struct spdk_scheduler_core_info *cores, uint32_t core_count)
 {
 	struct spdk_governor *governor;
 	struct spdk_scheduler_core_info *core;
 	struct spdk_governor_capabilities capabilities;
-	uint32_t busy_pct;
+	uint32_t busy_pct, prev_busy_pct;
 	uint32_t i;
 	int rc;
 
@@ -89,6 +132,24 @@ balance(struct spdk_scheduler_core_info *cores, uint32_t core_count)
 			busy_pct = ctx.busy_pct;
 		}
 
+		if (g_target_busy != 0 && governor->set_core_freq != NULL) {
+			prev_busy_pct = g_prev_busy_pct[i];
+			g_prev_busy_pct[i] = busy_pct;
+
+			/* Don't wait for the load to be spread over a whole period at a low frequency
+			 * when it starts rising quickly */
+			if (busy_pct >= g_max_threshold ||
+			    (g_boost_delta != 0 && busy_pct >= prev_busy_pct + g_boost_delta)) {
+				rc = governor->set_core_freq_max(core->lcore);
+			} else {
+				rc = set_proportional_freq(governor, core->lcore, busy_pct);
+			}
+			if (rc < 0) {
+				SPDK_ERRLOG("setting frequency for core %u failed\n", core->lcore);
+			}
+			continue;
+		}
+
 		if (busy_pct < g_min_threshold) {
 			rc = governor->set_core_freq_min(core->lcore);
 			if (rc < 0) {
@@ -113,11 +174,59 @@ balance(struct spdk_scheduler_core_info *cores, uint32_t core_count)
 	}
 }
 
+struct json_scheduler_opts {
+	uint8_t target_busy;
+	uint8_t boost_delta;
+};
+
+static const struct spdk_json_object_decoder sched_decoders[] = {
+	{"target_busy", offsetof(struct json_scheduler_opts, target_busy), spdk_json_decode_uint8, true},
+	{"boost_delta", offsetof(struct json_scheduler_opts, boost_delta), spdk_json_decode_uint8, true},
+};
+
+static int
+set_opts(const struct spdk_json_val *opts)
+{
+	struct json_scheduler_opts scheduler_opts;
+
+	scheduler_opts.target_busy = g_target_busy;
+	scheduler_opts.boost_delta = g_boost_delta;
+
+	if (opts != NULL) {
+		if (spdk_json_decode_object_relaxed(opts, sched_decoders,
+						    SPDK_COUNTOF(sched_decoders), &scheduler_opts)) {
+			SPDK_ERRLOG("Decoding scheduler opts JSON failed\n");
+			return -1;
+		}
+	}
+
+	if (scheduler_opts.target_busy > 100) {
+		SPDK_ERRLOG("Scheduler target busy must not be higher than 100\n");
+		return -1;
+	}
+
+	SPDK_NOTICELOG("Setting scheduler target busy to %d\n", scheduler_opts.target_busy);
+	g_target_busy = scheduler_opts.target_busy;
+	SPDK_NOTICELOG("Setting scheduler boost delta to %d\n", scheduler_opts.boost_delta);
+	g_boost_delta = scheduler_opts.boost_delta;
+
+	return 0;
+}
+
+static void
+get_opts(struct spdk_json_write_ctx *ctx)
+{
+	spdk_json_write_named_uint8(ctx, "target_busy", g_target_busy);
+	spdk_json_write_named_uint8(ctx, "boost_delta", g_boost_delta);
+}
+
 static struct spdk_scheduler gscheduler = {
 	.name = "gscheduler",
 	.init = init,
 	.deinit = deinit,
 	.balance = balance,
+	.set_opts = set_opts,
+	.get_opts = get_opts,
 };
 
 SPDK_SCHEDULER_REGISTER(gscheduler);
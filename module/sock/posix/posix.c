@@ -55,6 +55,10 @@ struct spdk_posix_sock {
 
 	SSL_CTX			*ctx;
 	SSL			*ssl;
+	/* Set once kTLS state was checked after the handshake */
+	bool			ktls_checked;
+	bool			ktls_send;
+	bool			ktls_recv;
 
 	TAILQ_ENTRY(spdk_posix_sock)	link;
 
@@ -88,7 +92,8 @@ static struct spdk_sock_impl_opts g_posix_impl_opts = {
 	.psk_identity = NULL,
 	.get_key = NULL,
 	.get_key_ctx = NULL,
-	.tls_cipher_suites = NULL
+	.tls_cipher_suites = NULL,
+	.busy_poll_usecs = 0
 };
 
 static struct spdk_sock_impl_opts g_ssl_impl_opts = {
@@ -103,7 +108,8 @@ static struct spdk_sock_impl_opts g_ssl_impl_opts = {
 	.tls_version = 0,
 	.enable_ktls = false,
 	.psk_key = NULL,
-	.psk_identity = NULL
+	.psk_identity = NULL,
+	.busy_poll_usecs = 0
 };
 
 static struct spdk_sock_map g_map = {
@@ -149,6 +155,7 @@ posix_sock_copy_impl_opts(struct spdk_sock_impl_opts *dest, const struct spdk_so
 	SET_FIELD(get_key);
 	SET_FIELD(get_key_ctx);
 	SET_FIELD(tls_cipher_suites);
+	SET_FIELD(busy_poll_usecs);
 
 #undef SET_FIELD
 #undef FIELD_OK
@@ -281,6 +288,103 @@ enum posix_sock_create_type {
 	SPDK_SOCK_CREATE_CONNECT,
 };
 
+/*
+ * Listening sockets inherited from the process which started this one, e.g. the previous instance
+ * of the application during an upgrade or a service manager. They are passed using the
+ * sd_listen_fds() convention: LISTEN_PID holds the pid of the receiving process and LISTEN_FDS the
+ * number of descriptors, which are numbered from POSIX_LISTEN_FDS_START. Listening on an address
+ * of an inherited socket takes that socket over instead of binding a new one, so connections are
+ * accepted by the same socket across the restart and none is refused.
+ */
+#define POSIX_LISTEN_FDS_START 3
+
+static struct {
+	pthread_mutex_t	lock;
+	int		*fds;
+	int		num_fds;
+	bool		parsed;
+} g_inherited_listen_fds = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void
+posix_sock_parse_inherited_fds(void)
+{
+	const char *pid_str, *fds_str;
+	long num_fds;
+	int fd, val, i, found = 0;
+	socklen_t len;
+
+	g_inherited_listen_fds.parsed = true;
+
+	pid_str = getenv("LISTEN_PID");
+	fds_str = getenv("LISTEN_FDS");
+	if (pid_str == NULL || fds_str == NULL || spdk_strtol(pid_str, 10) != getpid()) {
+		return;
+	}
+
+	num_fds = spdk_strtol(fds_str, 10);
+	if (num_fds <= 0 || num_fds > INT_MAX - POSIX_LISTEN_FDS_START) {
+		return;
+	}
+
+	g_inherited_listen_fds.fds = calloc(num_fds, sizeof(int));
+	if (g_inherited_listen_fds.fds == NULL) {
+		SPDK_ERRLOG("Failed to allocate inherited sockets array\n");
+		return;
+	}
+	g_inherited_listen_fds.num_fds = num_fds;
+
+	for (i = 0; i < num_fds; i++) {
+		fd = POSIX_LISTEN_FDS_START + i;
+		g_inherited_listen_fds.fds[i] = -1;
+
+		val = 0;
+		len = sizeof(val);
+		if (getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &val, &len) != 0 || val == 0) {
+			/* Not a listening socket, leave it alone */
+			continue;
+		}
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		g_inherited_listen_fds.fds[i] = fd;
+		found++;
+	}
+
+	SPDK_NOTICELOG("Inherited %d listening socket(s)\n", found);
+}
+
+static int
+posix_sock_take_inherited_fd(struct addrinfo *res)
+{
+	struct sockaddr_storage sa;
+	socklen_t len;
+	int i, fd = -1;
+
+	pthread_mutex_lock(&g_inherited_listen_fds.lock);
+	if (!g_inherited_listen_fds.parsed) {
+		posix_sock_parse_inherited_fds();
+	}
+
+	for (i = 0; i < g_inherited_listen_fds.num_fds; i++) {
+		if (g_inherited_listen_fds.fds[i] < 0) {
+			continue;
+		}
+
+		len = sizeof(sa);
+		if (getsockname(g_inherited_listen_fds.fds[i], (struct sockaddr *)&sa, &len) != 0) {
+			continue;
+		}
+		if (len == res->ai_addrlen && memcmp(&sa, res->ai_addr, len) == 0) {
+			fd = g_inherited_listen_fds.fds[i];
+			g_inherited_listen_fds.fds[i] = -1;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&g_inherited_listen_fds.lock);
+
+	return fd;
+}
+
 static int
 posix_sock_alloc_pipe(struct spdk_posix_sock *sock, int sz)
 {
@@ -416,6 +520,44 @@ posix_sock_set_sendbuf(struct spdk_sock *_sock, int sz)
 	return 0;
 }
 
+static uint32_t
+posix_sock_placement_mode(struct spdk_sock_impl_opts *impl_opts)
+{
+	/* Busy polling a group only polls the NIC queue of one of its sockets, so group the
+	 * sockets by their NAPI ID if no placement mode was chosen explicitly. */
+	if (impl_opts->busy_poll_usecs != 0 && impl_opts->enable_placement_id == PLACEMENT_NONE) {
+		return PLACEMENT_NAPI;
+	}
+
+	return impl_opts->enable_placement_id;
+}
+
+static void
+posix_sock_set_busy_poll(struct spdk_posix_sock *sock)
+{
+#if defined(SO_BUSY_POLL) && defined(SO_PREFER_BUSY_POLL)
+	int usecs = sock->base.impl_opts.busy_poll_usecs;
+	int flag = 1;
+	int rc;
+
+	if (usecs == 0) {
+		return;
+	}
+
+	/* Raising the busy poll timeout above net.core.busy_read requires CAP_NET_ADMIN */
+	rc = setsockopt(sock->fd, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs));
+	if (rc != 0) {
+		SPDK_WARNLOG("Failed to set SO_BUSY_POLL: %s\n", spdk_strerror(errno));
+		return;
+	}
+
+	rc = setsockopt(sock->fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &flag, sizeof(flag));
+	if (rc != 0) {
+		SPDK_WARNLOG("Failed to set SO_PREFER_BUSY_POLL: %s\n", spdk_strerror(errno));
+	}
+#endif
+}
+
 static void
 posix_sock_init(struct spdk_posix_sock *sock, bool enable_zero_copy)
 {
@@ -446,7 +588,9 @@ posix_sock_init(struct spdk_posix_sock *sock, bool enable_zero_copy)
 		}
 	}
 
-	spdk_sock_get_placement_id(sock->fd, sock->base.impl_opts.enable_placement_id,
+	posix_sock_set_busy_poll(sock);
+
+	spdk_sock_get_placement_id(sock->fd, posix_sock_placement_mode(&sock->base.impl_opts),
 				   &sock->placement_id);
 
 	if (sock->base.impl_opts.enable_placement_id == PLACEMENT_MARK) {
@@ -926,6 +1070,72 @@ SSL_writev(SSL *ssl, struct iovec *iov, int iovcnt)
 	}
 }
 
+/* If kTLS is enabled, OpenSSL hands the keys over to the kernel once the handshake is done,
+ * provided the kernel supports the negotiated cipher. The kernel then encrypts and decrypts the
+ * records, so the socket can be written and read directly instead of going through the OpenSSL
+ * record layer, one SSL_write() or SSL_read() per iovec. If OpenSSL couldn't set up kTLS, it
+ * keeps doing the crypto in userspace. */
+static void
+ssl_sock_check_ktls(struct spdk_posix_sock *sock)
+{
+	if (spdk_likely(sock->ktls_checked)) {
+		return;
+	}
+
+	if (!sock->base.impl_opts.enable_ktls) {
+		sock->ktls_checked = true;
+		return;
+	}
+
+	if (!SSL_is_init_finished(sock->ssl)) {
+		return;
+	}
+
+	sock->ktls_checked = true;
+	sock->ktls_send = BIO_get_ktls_send(SSL_get_wbio(sock->ssl));
+	sock->ktls_recv = BIO_get_ktls_recv(SSL_get_rbio(sock->ssl));
+	SPDK_DEBUGLOG(sock_posix, "kTLS send: %s, recv: %s\n", sock->ktls_send ? "on" : "off",
+		      sock->ktls_recv ? "on" : "off");
+}
+
+static bool
+ssl_sock_ktls_send(struct spdk_posix_sock *sock)
+{
+	ssl_sock_check_ktls(sock);
+
+	return sock->ktls_send;
+}
+
+static ssize_t
+ssl_sock_readv(struct spdk_posix_sock *sock, struct iovec *iov, int iovcnt)
+{
+	ssize_t rc;
+
+	ssl_sock_check_ktls(sock);
+
+	/* Data already decrypted by OpenSSL has to be consumed first */
+	if (sock->ktls_recv && SSL_pending(sock->ssl) == 0) {
+		rc = readv(sock->fd, iov, iovcnt);
+		/* The kernel fails with EIO if the next record isn't application data, let
+		 * OpenSSL process it. */
+		if (rc >= 0 || errno != EIO) {
+			return rc;
+		}
+	}
+
+	return SSL_readv(sock->ssl, iov, iovcnt);
+}
+
+static ssize_t
+ssl_sock_writev(struct spdk_posix_sock *sock, struct iovec *iov, int iovcnt)
+{
+	if (ssl_sock_ktls_send(sock)) {
+		return writev(sock->fd, iov, iovcnt);
+	}
+
+	return SSL_writev(sock->ssl, iov, iovcnt);
+}
+
 static struct spdk_sock *
 posix_sock_create(const char *ip, int port,
 		  enum posix_sock_create_type type,
@@ -982,6 +1192,14 @@ posix_sock_create(const char *ip, int port,
 	/* try listen */
 	fd = -1;
 	for (res = res0; res != NULL; res = res->ai_next) {
+		if (type == SPDK_SOCK_CREATE_LISTEN) {
+			fd = posix_sock_take_inherited_fd(res);
+			if (fd >= 0) {
+				SPDK_NOTICELOG("Taking over inherited listening socket %d at %s:%d\n", fd, ip, port);
+				enable_zcopy_impl_opts = impl_opts.enable_zerocopy_send_server;
+				goto set_nonblock;
+			}
+		}
 retry:
 		fd = posix_fd_create(res, opts, &impl_opts);
 		if (fd < 0) {
@@ -1077,6 +1295,7 @@ retry:
 			}
 		}
 
+set_nonblock:
 		flag = fcntl(fd, F_GETFL);
 		if (fcntl(fd, F_SETFL, flag | O_NONBLOCK) < 0) {
 			SPDK_ERRLOG("fcntl can't set nonblocking mode for socket, fd: %d (%d)\n", fd, errno);
@@ -1386,7 +1605,7 @@ _sock_flush(struct spdk_sock *sock)
 	msg.msg_iov = iovs;
 	msg.msg_iovlen = iovcnt;
 
-	if (psock->ssl) {
+	if (psock->ssl && !ssl_sock_ktls_send(psock)) {
 		rc = SSL_writev(psock->ssl, iovs, iovcnt);
 	} else {
 		rc = sendmsg(psock->fd, &msg, flags);
@@ -1536,7 +1755,7 @@ posix_sock_read(struct spdk_posix_sock *sock)
 	}
 
 	if (sock->ssl) {
-		bytes_recvd = SSL_readv(sock->ssl, iov, 2);
+		bytes_recvd = ssl_sock_readv(sock, iov, 2);
 	} else {
 		bytes_recvd = readv(sock->fd, iov, 2);
 	}
@@ -1587,7 +1806,7 @@ posix_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 			TAILQ_REMOVE(&group->socks_with_data, sock, link);
 		}
 		if (sock->ssl) {
-			return SSL_readv(sock->ssl, iov, iovcnt);
+			return ssl_sock_readv(sock, iov, iovcnt);
 		} else {
 			return readv(sock->fd, iov, iovcnt);
 		}
@@ -1606,7 +1825,7 @@ posix_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 		if (len >= MIN_SOCK_PIPE_SIZE) {
 			/* TODO: Should this detect if kernel socket is drained? */
 			if (sock->ssl) {
-				return SSL_readv(sock->ssl, iov, iovcnt);
+				return ssl_sock_readv(sock, iov, iovcnt);
 			} else {
 				return readv(sock->fd, iov, iovcnt);
 			}
@@ -1653,7 +1872,7 @@ posix_sock_writev(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 	}
 
 	if (sock->ssl) {
-		return SSL_writev(sock->ssl, iov, iovcnt);
+		return ssl_sock_writev(sock, iov, iovcnt);
 	} else {
 		return writev(sock->fd, iov, iovcnt);
 	}
@@ -1800,8 +2019,26 @@ posix_sock_group_impl_get_optimal(struct spdk_sock *_sock, struct spdk_sock_grou
 	return NULL;
 }
 
+static void
+_sock_group_impl_set_busy_poll(struct spdk_posix_sock_group_impl *group_impl, uint32_t busy_poll_usecs)
+{
+#if defined(SPDK_EPOLL) && defined(EPIOCSPARAMS)
+	struct epoll_params params = {};
+
+	params.busy_poll_usecs = busy_poll_usecs;
+	params.prefer_busy_poll = 1;
+
+	/* Make epoll_wait() run the NAPI poll loop of the group's NIC queue itself */
+	if (ioctl(group_impl->fd, EPIOCSPARAMS, &params) != 0) {
+		SPDK_WARNLOG("Failed to enable epoll busy polling: %s\n", spdk_strerror(errno));
+	}
+#else
+	SPDK_NOTICELOG("Poll group busy polling relies on net.core.busy_poll on this system\n");
+#endif
+}
+
 static struct spdk_sock_group_impl *
-_sock_group_impl_create(uint32_t enable_placement_id)
+_sock_group_impl_create(uint32_t enable_placement_id, uint32_t busy_poll_usecs)
 {
 	struct spdk_posix_sock_group_impl *group_impl;
 	int fd;
@@ -1839,19 +2076,25 @@ _sock_group_impl_create(uint32_t enable_placement_id)
 		group_impl->placement_id = spdk_env_get_current_core();
 	}
 
+	if (busy_poll_usecs != 0) {
+		_sock_group_impl_set_busy_poll(group_impl, busy_poll_usecs);
+	}
+
 	return &group_impl->base;
 }
 
 static struct spdk_sock_group_impl *
 posix_sock_group_impl_create(void)
 {
-	return _sock_group_impl_create(g_posix_impl_opts.enable_placement_id);
+	return _sock_group_impl_create(g_posix_impl_opts.enable_placement_id,
+				       g_posix_impl_opts.busy_poll_usecs);
 }
 
 static struct spdk_sock_group_impl *
 ssl_sock_group_impl_create(void)
 {
-	return _sock_group_impl_create(g_ssl_impl_opts.enable_placement_id);
+	return _sock_group_impl_create(g_ssl_impl_opts.enable_placement_id,
+				       g_ssl_impl_opts.busy_poll_usecs);
 }
 
 static void
@@ -15,6 +15,7 @@
 #include "spdk/pipe.h"
 #include "spdk/sock.h"
 #include "spdk/string.h"
+#include "spdk/thread.h"
 #include "spdk/util.h"
 #include "spdk/net.h"
 #include "spdk/file.h"
@@ -33,12 +34,21 @@ enum uring_task_type {
 	URING_TASK_ERRQUEUE,
 	URING_TASK_WRITE,
 	URING_TASK_CANCEL,
+	URING_TASK_SEND_ZC,
 };
 
 #if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
 #define SPDK_ZEROCOPY
 #endif
 
+#if defined(SPDK_ZEROCOPY) && defined(IORING_CQE_F_NOTIF)
+#define SPDK_URING_SEND_ZC
+#endif
+
+/* Maximum number of io_uring zero copy sends per group whose buffers can still be
+ * referenced by the kernel. Once exhausted, data is copied instead. */
+#define URING_SEND_ZC_TASKS 128
+
 /* We don't know how big the buffers that the user posts will be, but this
  * is the maximum we'll ever allow it to receive in a single command.
  * If the user buffers are smaller, it will just receive less. */
@@ -46,7 +56,22 @@ enum uring_task_type {
 
 /* We don't know how many buffers the user will post, but this is the
  * maximum number we'll take from the pool to post per group. */
-#define URING_BUF_POOL_SIZE 128
+#define URING_BUF_POOL_SIZE 1024
+
+/* The number of buffers actually kept posted to the ring adapts to the load,
+ * starting from this value and never going below it. */
+#define URING_BUF_POOL_MIN_SIZE 128
+
+/* Number of polls after which an idle group shrinks its posted buffer target. */
+#define URING_BUF_POOL_ADJUST_POLLS 4096
+
+/* A multishot recv keeps posting completions until it runs out of buffers, so
+ * allow reaping more completions than there are submissions in flight. */
+#define URING_MAX_REAP_BATCH 128
+
+#ifdef IORING_RECV_MULTISHOT
+#define SPDK_URING_RECV_MULTISHOT
+#endif
 
 /* We use 1 just so it's not zero and we can validate it's right. */
 #define URING_BUF_GROUP_ID 1
@@ -65,6 +90,9 @@ struct spdk_uring_task {
 	int					iov_cnt;
 	struct spdk_sock_request		*last_req;
 	bool					is_zcopy;
+	bool					is_multishot;
+	/* Index of the zero copy send, valid if is_zcopy is set */
+	uint32_t				zcopy_idx;
 	STAILQ_ENTRY(spdk_uring_task)		link;
 };
 
@@ -79,6 +107,10 @@ struct spdk_uring_sock {
 	struct spdk_uring_task			errqueue_task;
 	struct spdk_uring_task			read_task;
 	struct spdk_uring_task			cancel_task;
+	/* io_uring zero copy send carrying write_task, if any */
+	struct spdk_uring_task			*send_zc_task;
+	/* io_uring zero copy sends waiting for their notification */
+	STAILQ_HEAD(, spdk_uring_task)		send_zc_notifs;
 	struct spdk_pipe			*recv_pipe;
 	void					*recv_buf;
 	int					recv_buf_sz;
@@ -117,12 +149,26 @@ struct spdk_uring_sock_group_impl {
 	uint32_t				io_inflight;
 	uint32_t				io_queued;
 	uint32_t				io_avail;
+	/* Zero copy sends waiting for their notification */
+	uint32_t				io_notif;
 	struct pending_recv_list		pending_recv;
 
 	struct io_uring_buf_ring		*buf_ring;
 	uint32_t				buf_ring_count;
+	uint32_t				buf_ring_target;
+	uint32_t				buf_ring_low;
+	uint32_t				buf_ring_polls;
+	bool					buf_ring_starved;
+	bool					recv_multishot;
 	struct spdk_uring_buf_tracker		*trackers;
 	STAILQ_HEAD(, spdk_uring_buf_tracker)	free_trackers;
+
+	bool					send_zc;
+	struct spdk_uring_task			*send_zc_tasks;
+	STAILQ_HEAD(, spdk_uring_task)		free_send_zc_tasks;
+	/* iobuf regions registered as the ring's fixed buffers */
+	struct iovec				*fixed_bufs;
+	int					num_fixed_bufs;
 };
 
 static struct spdk_sock_impl_opts g_spdk_uring_sock_impl_opts = {
@@ -435,6 +481,7 @@ uring_sock_alloc(int fd, struct spdk_sock_impl_opts *impl_opts, bool enable_zero
 	memcpy(&sock->base.impl_opts, impl_opts, sizeof(*impl_opts));
 
 	STAILQ_INIT(&sock->recv_stream);
+	STAILQ_INIT(&sock->send_zc_notifs);
 
 #if defined(__linux__)
 	flag = 1;
@@ -1138,6 +1185,42 @@ sock_complete_write_reqs(struct spdk_sock *_sock, ssize_t rc, bool is_zcopy)
 }
 
 #ifdef SPDK_ZEROCOPY
+/* Complete the requests sent by the zero copy send of the given index */
+static int
+sock_complete_zcopy_reqs(struct spdk_sock *_sock, uint32_t idx)
+{
+	struct spdk_sock_request *req, *treq;
+	bool found = false;
+	int rc;
+
+	/* Most of the time, the pending_reqs array is in the exact
+	 * order we need such that all of the requests to complete are
+	 * in order, in the front. It is guaranteed that all requests
+	 * belonging to the same sendmsg call are sequential, so once
+	 * we encounter one match we can stop looping as soon as a
+	 * non-match is found.
+	 */
+	TAILQ_FOREACH_SAFE(req, &_sock->pending_reqs, internal.link, treq) {
+		if (!req->internal.is_zcopy) {
+			/* This wasn't a zcopy request. It was just waiting in line to complete */
+			rc = spdk_sock_request_put(_sock, req, 0);
+			if (rc < 0) {
+				return rc;
+			}
+		} else if (req->internal.offset == idx) {
+			found = true;
+			rc = spdk_sock_request_put(_sock, req, 0);
+			if (rc < 0) {
+				return rc;
+			}
+		} else if (found) {
+			break;
+		}
+	}
+
+	return 0;
+}
+
 static int
 _sock_check_zcopy(struct spdk_sock *_sock, int status)
 {
@@ -1146,8 +1229,6 @@ _sock_check_zcopy(struct spdk_sock *_sock, int status)
 	struct sock_extended_err *serr;
 	struct cmsghdr *cm;
 	uint32_t idx;
-	struct spdk_sock_request *req, *treq;
-	bool found;
 
 	assert(sock->zcopy == true);
 	if (spdk_unlikely(status) < 0) {
@@ -1173,31 +1254,10 @@ _sock_check_zcopy(struct spdk_sock *_sock, int status)
 		return 0;
 	}
 
-	/* Most of the time, the pending_reqs array is in the exact
-	 * order we need such that all of the requests to complete are
-	 * in order, in the front. It is guaranteed that all requests
-	 * belonging to the same sendmsg call are sequential, so once
-	 * we encounter one match we can stop looping as soon as a
-	 * non-match is found.
-	 */
 	for (idx = serr->ee_info; idx <= serr->ee_data; idx++) {
-		found = false;
-		TAILQ_FOREACH_SAFE(req, &_sock->pending_reqs, internal.link, treq) {
-			if (!req->internal.is_zcopy) {
-				/* This wasn't a zcopy request. It was just waiting in line to complete */
-				rc = spdk_sock_request_put(_sock, req, 0);
-				if (rc < 0) {
-					return rc;
-				}
-			} else if (req->internal.offset == idx) {
-				found = true;
-				rc = spdk_sock_request_put(_sock, req, 0);
-				if (rc < 0) {
-					return rc;
-				}
-			} else if (found) {
-				break;
-			}
+		rc = sock_complete_zcopy_reqs(_sock, idx);
+		if (rc < 0) {
+			return rc;
 		}
 	}
 
@@ -1230,6 +1290,68 @@ _sock_prep_errqueue(struct spdk_sock *_sock)
 
 #endif
 
+#ifdef SPDK_URING_SEND_ZC
+static void
+uring_sock_put_send_zc_task(struct spdk_uring_sock_group_impl *group, struct spdk_uring_task *task)
+{
+	task->sock = NULL;
+	task->is_zcopy = false;
+	task->status = SPDK_URING_SOCK_TASK_NOT_IN_USE;
+	STAILQ_INSERT_HEAD(&group->free_send_zc_tasks, task, link);
+}
+
+static int
+uring_sock_group_get_fixed_buf(struct spdk_uring_sock_group_impl *group, struct iovec *iov)
+{
+	uintptr_t base, addr = (uintptr_t)iov->iov_base;
+	int i;
+
+	for (i = 0; i < group->num_fixed_bufs; i++) {
+		base = (uintptr_t)group->fixed_bufs[i].iov_base;
+		if (addr >= base && addr + iov->iov_len <= base + group->fixed_bufs[i].iov_len) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static bool
+_sock_prep_send_zc(struct spdk_uring_sock *sock, struct io_uring_sqe *sqe, int flags)
+{
+	struct spdk_uring_sock_group_impl *group = sock->group;
+	struct spdk_uring_task *write_task = &sock->write_task;
+	struct spdk_uring_task *task;
+	int idx = -1;
+
+	task = STAILQ_FIRST(&group->free_send_zc_tasks);
+	if (task == NULL) {
+		/* Too many sends are still referenced by the kernel, copy the data instead. */
+		return false;
+	}
+
+	STAILQ_REMOVE_HEAD(&group->free_send_zc_tasks, link);
+	task->sock = sock;
+	task->status = SPDK_URING_SOCK_TASK_IN_PROCESS;
+	sock->send_zc_task = task;
+
+	if (write_task->iov_cnt == 1) {
+		idx = uring_sock_group_get_fixed_buf(group, &write_task->iovs[0]);
+	}
+
+	if (idx >= 0) {
+		/* The buffer comes from a registered iobuf pool, its pages are already pinned */
+		io_uring_prep_send_zc_fixed(sqe, sock->fd, write_task->iovs[0].iov_base,
+					    write_task->iovs[0].iov_len, flags, 0, idx);
+	} else {
+		io_uring_prep_sendmsg_zc(sqe, sock->fd, &write_task->msg, flags);
+	}
+	io_uring_sqe_set_data(sqe, task);
+
+	return true;
+}
+#endif
+
 static void
 _sock_flush(struct spdk_sock *_sock)
 {
@@ -1267,6 +1389,18 @@ _sock_flush(struct spdk_sock *_sock)
 	sock->group->io_queued++;
 
 	sqe = io_uring_get_sqe(&sock->group->uring);
+#ifdef SPDK_URING_SEND_ZC
+	if (task->is_zcopy && sock->group->send_zc) {
+		/* io_uring zero copy sends are completed through notifications posted to the
+		 * ring instead of the socket's error queue. */
+		task->is_zcopy = false;
+		flags &= ~MSG_ZEROCOPY;
+		if (_sock_prep_send_zc(sock, sqe, flags)) {
+			task->status = SPDK_URING_SOCK_TASK_IN_PROCESS;
+			return;
+		}
+	}
+#endif
 	io_uring_prep_sendmsg(sqe, sock->fd, &sock->write_task.msg, flags);
 	io_uring_sqe_set_data(sqe, task);
 	task->status = SPDK_URING_SOCK_TASK_IN_PROCESS;
@@ -1292,7 +1426,19 @@ _sock_prep_read(struct spdk_sock *_sock)
 	sock->group->io_queued++;
 
 	sqe = io_uring_get_sqe(&sock->group->uring);
-	io_uring_prep_recv(sqe, sock->fd, NULL, URING_MAX_RECV_SIZE, 0);
+#ifdef SPDK_URING_RECV_MULTISHOT
+	if (sock->group->recv_multishot) {
+		/* A single multishot recv keeps completing into buffers picked from the
+		 * group's ring until it fails or the ring is exhausted, so it only needs
+		 * to be re-armed once a completion arrives without IORING_CQE_F_MORE. */
+		io_uring_prep_recv_multishot(sqe, sock->fd, NULL, 0, 0);
+		task->is_multishot = true;
+	} else
+#endif
+	{
+		io_uring_prep_recv(sqe, sock->fd, NULL, URING_MAX_RECV_SIZE, 0);
+		task->is_multishot = false;
+	}
 	sqe->buf_group = URING_BUF_GROUP_ID;
 	sqe->flags |= IOSQE_BUFFER_SELECT;
 	io_uring_sqe_set_data(sqe, task);
@@ -1336,6 +1482,66 @@ uring_sock_fail(struct spdk_uring_sock *sock, int status)
 	}
 }
 
+#ifdef SPDK_URING_SEND_ZC
+static void
+uring_sock_send_zc_complete(struct spdk_uring_sock_group_impl *group, struct spdk_uring_task *task,
+			    int status, int flags)
+{
+	struct spdk_uring_sock *sock = task->sock;
+	struct spdk_uring_task *write_task;
+	bool is_zcopy;
+
+	if (flags & IORING_CQE_F_NOTIF) {
+		/* The kernel doesn't reference the buffers of this send anymore. The socket
+		 * is NULL if it was removed from the group in the meantime. */
+		assert(group->io_notif > 0);
+		group->io_notif--;
+		if (sock != NULL) {
+			STAILQ_REMOVE(&sock->send_zc_notifs, task, spdk_uring_task, link);
+			if (task->is_zcopy) {
+				sock_complete_zcopy_reqs(&sock->base, task->zcopy_idx);
+			}
+		}
+		uring_sock_put_send_zc_task(group, task);
+		return;
+	}
+
+	assert(sock != NULL);
+	assert(sock->group == group);
+	assert(sock->send_zc_task == task);
+	group->io_inflight--;
+	group->io_avail++;
+	sock->send_zc_task = NULL;
+	write_task = &sock->write_task;
+	write_task->status = SPDK_URING_SOCK_TASK_NOT_IN_USE;
+
+	/* A notification follows once the kernel is done with the buffers */
+	is_zcopy = (flags & IORING_CQE_F_MORE) != 0;
+	if (is_zcopy) {
+		group->io_notif++;
+		STAILQ_INSERT_TAIL(&sock->send_zc_notifs, task, link);
+	} else {
+		uring_sock_put_send_zc_task(group, task);
+	}
+
+	if (status == -EAGAIN || status == -EWOULDBLOCK || status == -ENOBUFS ||
+	    status == -ECANCELED) {
+		return;
+	} else if (spdk_unlikely(status < 0)) {
+		uring_sock_fail(sock, status);
+	} else {
+		if (is_zcopy) {
+			/* This is the index sock_complete_write_reqs() assigns to the requests */
+			task->zcopy_idx = sock->sendmsg_idx == UINT32_MAX ? 0 : sock->sendmsg_idx;
+			task->is_zcopy = true;
+		}
+		write_task->last_req = NULL;
+		write_task->iov_cnt = 0;
+		sock_complete_write_reqs(&sock->base, status, is_zcopy);
+	}
+}
+#endif
+
 static int
 sock_uring_group_reap(struct spdk_uring_sock_group_impl *group, int max, int max_read_events,
 		      struct spdk_sock **socks)
@@ -1359,21 +1565,40 @@ sock_uring_group_reap(struct spdk_uring_sock_group_impl *group, int max, int max
 
 		task = (struct spdk_uring_task *)cqe->user_data;
 		assert(task != NULL);
+		status = cqe->res;
+		flags = cqe->flags;
+		io_uring_cqe_seen(&group->uring, cqe);
+
+#ifdef SPDK_URING_SEND_ZC
+		if (task->type == URING_TASK_SEND_ZC) {
+			uring_sock_send_zc_complete(group, task, status, flags);
+			continue;
+		}
+#endif
 		sock = task->sock;
 		assert(sock != NULL);
 		assert(sock->group != NULL);
 		assert(sock->group == group);
-		sock->group->io_inflight--;
-		sock->group->io_avail++;
-		status = cqe->res;
-		flags = cqe->flags;
-		io_uring_cqe_seen(&group->uring, cqe);
 
-		task->status = SPDK_URING_SOCK_TASK_NOT_IN_USE;
+		/* A multishot recv stays armed for as long as the kernel sets
+		 * IORING_CQE_F_MORE, so its task is still in flight. */
+		if ((flags & IORING_CQE_F_MORE) == 0) {
+			sock->group->io_inflight--;
+			sock->group->io_avail++;
+			task->status = SPDK_URING_SOCK_TASK_NOT_IN_USE;
+		}
 
 		switch (task->type) {
 		case URING_TASK_READ:
-			if (status == -EAGAIN || status == -EWOULDBLOCK) {
+			if (spdk_unlikely(status == -EINVAL && task->is_multishot)) {
+				/* The kernel doesn't support multishot recv. Fall back to
+				 * single-shot for the whole group. */
+				if (group->recv_multishot) {
+					SPDK_NOTICELOG("Multishot recv not supported, falling back to single-shot\n");
+					group->recv_multishot = false;
+				}
+				_sock_prep_read(&sock->base);
+			} else if (status == -EAGAIN || status == -EWOULDBLOCK) {
 				/* This likely shouldn't happen, but would indicate that the
 				 * kernel didn't have enough resources to queue a task internally. */
 				_sock_prep_read(&sock->base);
@@ -1382,6 +1607,7 @@ sock_uring_group_reap(struct spdk_uring_sock_group_impl *group, int max, int max
 			} else if (status == -ENOBUFS) {
 				/* There's data in the socket but the user hasn't provided any buffers.
 				 * We need to notify the user that the socket has data pending. */
+				group->buf_ring_starved = true;
 				if (sock->base.cb_fn != NULL &&
 				    sock->pending_recv == false) {
 					sock->pending_recv = true;
@@ -1686,6 +1912,8 @@ uring_sock_group_impl_buf_pool_alloc(struct spdk_uring_sock_group_impl *group_im
 	group_impl->buf_ring = buf_ring;
 	io_uring_buf_ring_init(group_impl->buf_ring);
 	group_impl->buf_ring_count = 0;
+	group_impl->buf_ring_target = URING_BUF_POOL_MIN_SIZE;
+	group_impl->buf_ring_low = URING_BUF_POOL_MIN_SIZE;
 
 	group_impl->trackers = calloc(URING_BUF_POOL_SIZE, sizeof(struct spdk_uring_buf_tracker));
 	if (group_impl->trackers == NULL) {
@@ -1709,6 +1937,74 @@ uring_sock_group_impl_buf_pool_alloc(struct spdk_uring_sock_group_impl *group_im
 	return 0;
 }
 
+#ifdef SPDK_URING_SEND_ZC
+static void
+uring_sock_group_impl_send_zc_init(struct spdk_uring_sock_group_impl *group_impl)
+{
+	struct io_uring_probe *probe;
+	struct iovec *fixed_bufs;
+	int i, num, rc;
+
+	probe = io_uring_get_probe_ring(&group_impl->uring);
+	if (probe == NULL) {
+		return;
+	}
+
+	group_impl->send_zc = io_uring_opcode_supported(probe, IORING_OP_SEND_ZC) &&
+			      io_uring_opcode_supported(probe, IORING_OP_SENDMSG_ZC);
+	io_uring_free_probe(probe);
+	if (!group_impl->send_zc) {
+		return;
+	}
+
+	group_impl->send_zc_tasks = calloc(URING_SEND_ZC_TASKS, sizeof(struct spdk_uring_task));
+	if (group_impl->send_zc_tasks == NULL) {
+		group_impl->send_zc = false;
+		return;
+	}
+
+	STAILQ_INIT(&group_impl->free_send_zc_tasks);
+	for (i = 0; i < URING_SEND_ZC_TASKS; i++) {
+		group_impl->send_zc_tasks[i].type = URING_TASK_SEND_ZC;
+		STAILQ_INSERT_TAIL(&group_impl->free_send_zc_tasks, &group_impl->send_zc_tasks[i], link);
+	}
+
+	/* Register the iobuf pools as fixed buffers, so that sending from them doesn't
+	 * require pinning their pages on each send. Zero copy sends work without it. */
+	num = spdk_iobuf_get_regions(NULL, 0);
+	if (num == 0) {
+		return;
+	}
+
+	fixed_bufs = calloc(num, sizeof(*fixed_bufs));
+	if (fixed_bufs == NULL) {
+		return;
+	}
+
+	spdk_iobuf_get_regions(fixed_bufs, num);
+	rc = io_uring_register_buffers(&group_impl->uring, fixed_bufs, num);
+	if (rc != 0) {
+		SPDK_NOTICELOG("Failed to register iobuf buffers with the ring: %s\n", spdk_strerror(-rc));
+		free(fixed_bufs);
+		return;
+	}
+
+	group_impl->fixed_bufs = fixed_bufs;
+	group_impl->num_fixed_bufs = num;
+}
+
+static void
+uring_sock_group_impl_send_zc_fini(struct spdk_uring_sock_group_impl *group_impl)
+{
+	if (group_impl->fixed_bufs != NULL) {
+		io_uring_unregister_buffers(&group_impl->uring);
+		free(group_impl->fixed_bufs);
+	}
+
+	free(group_impl->send_zc_tasks);
+}
+#endif
+
 static struct spdk_sock_group_impl *
 uring_sock_group_impl_create(void)
 {
@@ -1729,6 +2025,9 @@ uring_sock_group_impl_create(void)
 	}
 
 	TAILQ_INIT(&group_impl->pending_recv);
+#ifdef SPDK_URING_RECV_MULTISHOT
+	group_impl->recv_multishot = true;
+#endif
 
 	if (uring_sock_group_impl_buf_pool_alloc(group_impl) < 0) {
 		SPDK_ERRLOG("Failed to create buffer ring."
@@ -1738,6 +2037,10 @@ uring_sock_group_impl_create(void)
 		return NULL;
 	}
 
+#ifdef SPDK_URING_SEND_ZC
+	uring_sock_group_impl_send_zc_init(group_impl);
+#endif
+
 	if (g_spdk_uring_sock_impl_opts.enable_placement_id == PLACEMENT_CPU) {
 		spdk_sock_map_insert(&g_map, spdk_env_get_current_core(), &group_impl->base);
 	}
@@ -1787,7 +2090,8 @@ uring_sock_group_impl_add_sock(struct spdk_sock_group_impl *_group,
 	/* We get an async read going immediately */
 	_sock_prep_read(&sock->base);
 #ifdef SPDK_ZEROCOPY
-	if (sock->zcopy) {
+	/* io_uring zero copy sends don't report their completions through the error queue */
+	if (sock->zcopy && !group->send_zc) {
 		_sock_prep_errqueue(_sock);
 	}
 #endif
@@ -1795,6 +2099,34 @@ uring_sock_group_impl_add_sock(struct spdk_sock_group_impl *_group,
 	return 0;
 }
 
+/* Size the number of buffers kept posted to the ring according to the load. A
+ * recv failing with -ENOBUFS means every posted buffer got consumed before the
+ * ring was refilled, so the target is doubled. If the ring never dropped below
+ * half of its target for a whole adjustment period, the target is halved to
+ * hand the buffers back to the group's pool. */
+static void
+uring_sock_group_adjust_buf_ring(struct spdk_uring_sock_group_impl *group)
+{
+	if (group->buf_ring_starved) {
+		group->buf_ring_starved = false;
+		group->buf_ring_target = spdk_min(group->buf_ring_target * 2, URING_BUF_POOL_SIZE);
+		group->buf_ring_low = group->buf_ring_target;
+		group->buf_ring_polls = 0;
+		return;
+	}
+
+	group->buf_ring_low = spdk_min(group->buf_ring_low, group->buf_ring_count);
+	if (++group->buf_ring_polls < URING_BUF_POOL_ADJUST_POLLS) {
+		return;
+	}
+
+	if (group->buf_ring_low > group->buf_ring_target / 2) {
+		group->buf_ring_target = spdk_max(group->buf_ring_target / 2, URING_BUF_POOL_MIN_SIZE);
+	}
+	group->buf_ring_low = group->buf_ring_target;
+	group->buf_ring_polls = 0;
+}
+
 static void
 uring_sock_group_populate_buf_ring(struct spdk_uring_sock_group_impl *group)
 {
@@ -1806,11 +2138,13 @@ uring_sock_group_populate_buf_ring(struct spdk_uring_sock_group_impl *group)
 		return;
 	}
 
+	uring_sock_group_adjust_buf_ring(group);
+
 	/* Try to re-populate the io_uring's buffer pool using user-provided buffers */
 	tracker = STAILQ_FIRST(&group->free_trackers);
 	count = 0;
 	mask = io_uring_buf_ring_mask(URING_BUF_POOL_SIZE);
-	while (tracker != NULL) {
+	while (tracker != NULL && group->buf_ring_count + count < group->buf_ring_target) {
 		tracker->buflen = spdk_sock_group_get_buf(group->base.group, &tracker->buf, &tracker->ctx);
 		if (tracker->buflen == 0) {
 			break;
@@ -1870,7 +2204,10 @@ uring_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 	}
 
 	count = 0;
-	to_complete = group->io_inflight;
+	to_complete = group->io_inflight + group->io_notif;
+	if (group->recv_multishot && to_complete > 0) {
+		to_complete = spdk_max(to_complete, URING_MAX_REAP_BATCH);
+	}
 	if (to_complete > 0 || !TAILQ_EMPTY(&group->pending_recv)) {
 		count = sock_uring_group_reap(group, to_complete, max_events, socks);
 	}
@@ -1884,11 +2221,15 @@ uring_sock_group_impl_remove_sock(struct spdk_sock_group_impl *_group,
 {
 	struct spdk_uring_sock *sock = __uring_sock(_sock);
 	struct spdk_uring_sock_group_impl *group = __uring_group_impl(_group);
+#ifdef SPDK_URING_SEND_ZC
+	struct spdk_uring_task *task;
+#endif
 
 	sock->pending_group_remove = true;
 
 	if (sock->write_task.status != SPDK_URING_SOCK_TASK_NOT_IN_USE) {
-		_sock_prep_cancel_task(_sock, &sock->write_task);
+		_sock_prep_cancel_task(_sock, sock->send_zc_task != NULL ?
+				       (void *)sock->send_zc_task : (void *)&sock->write_task);
 		/* Since spdk_sock_group_remove_sock is not asynchronous interface, so
 		 * currently can use a while loop here. */
 		while ((sock->write_task.status != SPDK_URING_SOCK_TASK_NOT_IN_USE) ||
@@ -1917,6 +2258,16 @@ uring_sock_group_impl_remove_sock(struct spdk_sock_group_impl *_group,
 		}
 	}
 
+#ifdef SPDK_URING_SEND_ZC
+	/* The notifications of the zero copy sends still referenced by the kernel are reaped
+	 * by this group after the socket is gone. Their requests complete once the socket
+	 * is closed. */
+	STAILQ_FOREACH(task, &sock->send_zc_notifs, link) {
+		task->sock = NULL;
+	}
+	STAILQ_INIT(&sock->send_zc_notifs);
+#endif
+
 	/* Make sure the cancelling the tasks above didn't cause sending new requests */
 	assert(sock->write_task.status == SPDK_URING_SOCK_TASK_NOT_IN_USE);
 	assert(sock->read_task.status == SPDK_URING_SOCK_TASK_NOT_IN_USE);
@@ -1955,6 +2306,9 @@ uring_sock_group_impl_close(struct spdk_sock_group_impl *_group)
 	assert(group->io_avail == SPDK_SOCK_GROUP_QUEUE_DEPTH);
 
 	uring_sock_group_impl_buf_pool_free(group);
+#ifdef SPDK_URING_SEND_ZC
+	uring_sock_group_impl_send_zc_fini(group);
+#endif
 
 	io_uring_queue_exit(&group->uring);
 
@@ -1998,6 +2352,13 @@ uring_sock_flush(struct spdk_sock *_sock)
 		return 0;
 	}
 
+#ifdef SPDK_URING_SEND_ZC
+	/* The group tracks zero copy sends through the ring, so copy the data here */
+	if (sock->group != NULL && sock->group->send_zc) {
+		flags &= ~MSG_ZEROCOPY;
+	}
+#endif
+
 	/* Perform the vectored write */
 	msg.msg_iov = iovs;
 	msg.msg_iovlen = iovcnt;
@@ -94,7 +94,8 @@ def accel_set_driver(client, name):
 
 
 def accel_set_options(client, small_cache_size, large_cache_size,
-                      task_count, sequence_count, buf_count):
+                      task_count, sequence_count, buf_count, sw_worker_count=None,
+                      sw_offload_min_size=None, hw_queue_depth=None):
     """Set accel framework's options."""
     params = {}
 
@@ -108,6 +109,12 @@ def accel_set_options(client, small_cache_size, large_cache_size,
         params['sequence_count'] = sequence_count
     if buf_count is not None:
         params['buf_count'] = buf_count
+    if sw_worker_count is not None:
+        params['sw_worker_count'] = sw_worker_count
+    if sw_offload_min_size is not None:
+        params['sw_offload_min_size'] = sw_offload_min_size
+    if hw_queue_depth is not None:
+        params['hw_queue_depth'] = hw_queue_depth
 
     return client.call('accel_set_options', params)
 
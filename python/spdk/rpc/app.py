@@ -28,6 +28,21 @@ def framework_monitor_context_switch(client, enabled=None):
     return client.call('framework_monitor_context_switch', params)
 
 
+def framework_interrupt_poll_window(client, window_us=None):
+    """Query or set the time reactors in interrupt mode keep polling after a wakeup.
+
+    Args:
+        window_us: Polling window in microseconds, 0 to disable; None to query (optional)
+
+    Returns:
+        Current polling window (after applying window_us).
+    """
+    params = {}
+    if window_us is not None:
+        params['window_us'] = window_us
+    return client.call('framework_interrupt_poll_window', params)
+
+
 def framework_get_reactors(client):
     """Query list of all reactors.
 
@@ -38,7 +53,8 @@ def framework_get_reactors(client):
 
 
 def framework_set_scheduler(client, name, period=None, load_limit=None, core_limit=None,
-                            core_busy=None, mappings=None):
+                            core_busy=None, load_smoothing=None, move_interval=None,
+                            migration_cost=None, target_busy=None, boost_delta=None, mappings=None):
     """Select threads scheduler that will be activated and its period.
 
     Args:
@@ -56,6 +72,16 @@ def framework_set_scheduler(client, name, period=None, load_limit=None, core_lim
         params['core_limit'] = core_limit
     if core_busy is not None:
         params['core_busy'] = core_busy
+    if load_smoothing is not None:
+        params['load_smoothing'] = load_smoothing
+    if move_interval is not None:
+        params['move_interval'] = move_interval
+    if migration_cost is not None:
+        params['migration_cost'] = migration_cost
+    if target_busy is not None:
+        params['target_busy'] = target_busy
+    if boost_delta is not None:
+        params['boost_delta'] = boost_delta
     if mappings is not None:
         params['mappings'] = mappings
     return client.call('framework_set_scheduler', params)
@@ -124,13 +150,19 @@ def log_enable_timestamps(client, enabled):
     return client.call('log_enable_timestamps', params)
 
 
-def thread_get_pollers(client):
+def thread_get_pollers(client, generation=None):
     """Query current pollers.
 
+    Args:
+        generation: Only return the pollers that changed since this report generation (optional)
+
     Returns:
         Current pollers.
     """
-    return client.call('thread_get_pollers')
+    params = {}
+    if generation is not None:
+        params['generation'] = generation
+    return client.call('thread_get_pollers', params)
 
 
 def thread_get_io_channels(client):
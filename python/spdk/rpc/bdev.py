@@ -7,7 +7,9 @@
 
 def bdev_set_options(client, bdev_io_pool_size=None, bdev_io_cache_size=None,
                      bdev_auto_examine=None, iobuf_small_cache_size=None,
-                     iobuf_large_cache_size=None):
+                     iobuf_large_cache_size=None, copy_queue_depth=None,
+                     trace_sample_rate=None, bdev_io_small_pool_size=None,
+                     bdev_io_small_ctx_size=None, bounce_accel_copy_threshold=None):
     """Set parameters for the bdev subsystem.
     Args:
         bdev_io_pool_size: number of bdev_io structures in shared buffer pool (optional)
@@ -15,6 +17,11 @@ def bdev_set_options(client, bdev_io_pool_size=None, bdev_io_cache_size=None,
         bdev_auto_examine: if set to false, the bdev layer will not examine every disks automatically (optional)
         iobuf_small_cache_size: size of the small iobuf per thread cache
         iobuf_large_cache_size: size of the large iobuf per thread cache
+        copy_queue_depth: maximum number of child requests outstanding for a split or emulated copy (optional)
+        trace_sample_rate: record the bdev tracepoints of only one in this many I/Os, 0 or 1 traces all (optional)
+        bdev_io_small_pool_size: number of bdev_io structures in the pool for modules with a small I/O context, 0 disables it (optional)
+        bdev_io_small_ctx_size: maximum I/O context size in bytes of the modules using the small bdev_io pool (optional)
+        bounce_accel_copy_threshold: bounce buffer copies of at least this many bytes go through accel, 0 disables it (optional)
     """
     params = dict()
     if bdev_io_pool_size is not None:
@@ -27,6 +34,16 @@ def bdev_set_options(client, bdev_io_pool_size=None, bdev_io_cache_size=None,
         params['iobuf_small_cache_size'] = iobuf_small_cache_size
     if iobuf_large_cache_size is not None:
         params['iobuf_large_cache_size'] = iobuf_large_cache_size
+    if copy_queue_depth is not None:
+        params['copy_queue_depth'] = copy_queue_depth
+    if trace_sample_rate is not None:
+        params['trace_sample_rate'] = trace_sample_rate
+    if bdev_io_small_pool_size is not None:
+        params['bdev_io_small_pool_size'] = bdev_io_small_pool_size
+    if bdev_io_small_ctx_size is not None:
+        params['bdev_io_small_ctx_size'] = bdev_io_small_ctx_size
+    if bounce_accel_copy_threshold is not None:
+        params['bounce_accel_copy_threshold'] = bounce_accel_copy_threshold
     return client.call('bdev_set_options', params)
 
 
@@ -93,7 +110,19 @@ def bdev_compress_get_orphans(client, name=None):
     return client.call('bdev_compress_get_orphans', params)
 
 
-def bdev_crypto_create(client, base_bdev_name, name, crypto_pmd=None, key=None, cipher=None, key2=None, key_name=None):
+def bdev_compress_set_options(client, read_cache_size_mb=None):
+    """Set options for the compress bdev module.
+    Args:
+        read_cache_size_mb: size of the cache of decompressed chunks of each compress bdev, in MiB (optional)
+    """
+    params = dict()
+    if read_cache_size_mb is not None:
+        params['read_cache_size_mb'] = read_cache_size_mb
+    return client.call('bdev_compress_set_options', params)
+
+
+def bdev_crypto_create(client, base_bdev_name, name, crypto_pmd=None, key=None, cipher=None, key2=None, key_name=None,
+                       key_ranges=None):
     """Construct a crypto virtual block device.
     Args:
         base_bdev_name: name of the underlying base bdev
@@ -103,6 +132,8 @@ def bdev_crypto_create(client, base_bdev_name, name, crypto_pmd=None, key=None,
         cipher: crypto algorithm to use
         key2: Optional second part of the key
         key_name: The key name to use in crypto operations
+        key_ranges: list of dicts with key_name, offset_blocks and num_blocks of LBA ranges
+                    encrypted with their own key (optional)
     Returns:
         Name of created virtual block device.
     """
@@ -119,6 +150,8 @@ def bdev_crypto_create(client, base_bdev_name, name, crypto_pmd=None, key=None,
         params['key2'] = key2
     if key_name is not None:
         params['key_name'] = key_name
+    if key_ranges is not None:
+        params['key_ranges'] = key_ranges
     return client.call('bdev_crypto_create', params)
 
 
@@ -255,7 +288,8 @@ def bdev_ocf_flush_status(client, name):
 
 
 def bdev_malloc_create(client, num_blocks, block_size, physical_block_size=None, name=None, uuid=None, optimal_io_boundary=None,
-                       md_size=None, md_interleave=None, dif_type=None, dif_is_head_of_md=None, dif_pi_format=None):
+                       md_size=None, md_interleave=None, dif_type=None, dif_is_head_of_md=None, dif_pi_format=None,
+                       numa_replicas=None):
     """Construct a malloc block device.
     Args:
         num_blocks: size of block device in blocks
@@ -269,6 +303,7 @@ def bdev_malloc_create(client, num_blocks, block_size, physical_block_size=None,
         dif_type: protection information type (optional)
         dif_is_head_of_md: protection information is in the first 8 bytes of metadata (optional)
         dif_pi_format: protection information format (optional)
+        numa_replicas: keep a copy of the data on each NUMA node for local reads (optional)
     Returns:
         Name of created block device.
     """
@@ -293,6 +328,8 @@ def bdev_malloc_create(client, num_blocks, block_size, physical_block_size=None,
         params['dif_is_head_of_md'] = dif_is_head_of_md
     if dif_pi_format is not None:
         params['dif_pi_format'] = dif_pi_format
+    if numa_replicas is not None:
+        params['numa_replicas'] = numa_replicas
     return client.call('bdev_malloc_create', params)
 
 
@@ -363,11 +400,14 @@ def bdev_null_resize(client, name, new_size):
     return client.call('bdev_null_resize', params)
 
 
-def bdev_raid_set_options(client, process_window_size_kb=None, process_max_bandwidth_mb_sec=None):
+def bdev_raid_set_options(client, process_window_size_kb=None, process_max_bandwidth_mb_sec=None,
+                          process_max_latency_us=None, write_intent_region_size_kb=None):
     """Set options for bdev raid.
     Args:
         process_window_size_kb: Background process (e.g. rebuild) window size in KiB
         process_max_bandwidth_mb_sec: Background process (e.g. rebuild) maximum bandwidth in MiB/Sec
+        process_max_latency_us: Target p99 latency of foreground I/O in microseconds, slows down background process when exceeded
+        write_intent_region_size_kb: Write intent bitmap region size in KiB, 0 to disable
     """
     params = dict()
     if process_window_size_kb is not None:
@@ -376,6 +416,12 @@ def bdev_raid_set_options(client, process_window_size_kb=None, process_max_bandw
     if process_max_bandwidth_mb_sec is not None:
         params['process_max_bandwidth_mb_sec'] = process_max_bandwidth_mb_sec
 
+    if process_max_latency_us is not None:
+        params['process_max_latency_us'] = process_max_latency_us
+
+    if write_intent_region_size_kb is not None:
+        params['write_intent_region_size_kb'] = write_intent_region_size_kb
+
     return client.call('bdev_raid_set_options', params)
 
 
@@ -501,6 +547,23 @@ def bdev_aio_delete(client, name):
     return client.call('bdev_aio_delete', params)
 
 
+def bdev_uring_set_options(client, iopoll=None, sqpoll=None, sqpoll_idle_ms=None):
+    """Set options for the bdev uring module.
+    Args:
+        iopoll: poll the devices for completions, requires O_DIRECT (optional)
+        sqpoll: submit through a kernel thread polling the submission queue (optional)
+        sqpoll_idle_ms: idle time in ms after which the kernel submission thread sleeps (optional)
+    """
+    params = dict()
+    if iopoll is not None:
+        params['iopoll'] = iopoll
+    if sqpoll is not None:
+        params['sqpoll'] = sqpoll
+    if sqpoll_idle_ms is not None:
+        params['sqpoll_idle_ms'] = sqpoll_idle_ms
+    return client.call('bdev_uring_set_options', params)
+
+
 def bdev_uring_create(client, filename, name, block_size=None, uuid=None):
     """Create a bdev with Linux io_uring backend.
     Args:
@@ -541,13 +604,15 @@ def bdev_uring_delete(client, name):
     return client.call('bdev_uring_delete', params)
 
 
-def bdev_xnvme_create(client, filename, name, io_mechanism, conserve_cpu):
+def bdev_xnvme_create(client, filename, name, io_mechanism, conserve_cpu, queue_depth=None, sqpoll=None):
     """Create a bdev with xNVMe backend.
     Args:
         filename: path to device or file (ex: /dev/nvme0n1)
         name: name of xNVMe bdev to create
         io_mechanism: I/O mechanism to use (ex: io_uring, io_uring_cmd, etc.)
         conserve_cpu: Whether or not to conserve CPU when polling (default: False)
+        queue_depth: depth of the xNVMe queue of each I/O channel, power of 2 (optional)
+        sqpoll: use a kernel submission queue polling thread, io_uring and io_uring_cmd only (optional)
     Returns:
         Name of created bdev.
     """
@@ -556,6 +621,10 @@ def bdev_xnvme_create(client, filename, name, io_mechanism, conserve_cpu):
     params['name'] = name
     params['io_mechanism'] = io_mechanism
     params['conserve_cpu'] = conserve_cpu
+    if queue_depth is not None:
+        params['queue_depth'] = queue_depth
+    if sqpoll is not None:
+        params['sqpoll'] = sqpoll
     return client.call('bdev_xnvme_create', params)
 
 
@@ -578,7 +647,12 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, timeo
                           fast_io_fail_timeout_sec=None, disable_auto_failback=None, generate_uuids=None,
                           transport_tos=None, nvme_error_stat=None, rdma_srq_size=None, io_path_stat=None,
                           allow_accel_sequence=None, rdma_max_cq_size=None, rdma_cm_event_timeout_ms=None,
-                          dhchap_digests=None, dhchap_dhgroups=None, rdma_umr_per_io=None):
+                          dhchap_digests=None, dhchap_dhgroups=None, rdma_umr_per_io=None,
+                          numa_affinity_qd_threshold=None, intr_adaptive_idle_polls=None,
+                          intr_coalescing_threshold=None, intr_coalescing_time_us=None,
+                          tcp_recv_buf_count=None, tcp_recv_buf_size=None, tcp_zcopy_threshold=None,
+                          rdma_inline_copy_size=None, io_qpair_idle_timeout_ms=None,
+                          multipath_stripe_size=None):
     """Set options for the bdev nvme. This is startup command.
     Args:
         action_on_timeout:  action to take on command time out. Valid values are: none, reset, abort (optional)
@@ -628,6 +702,25 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, timeo
         dhchap_digests: List of allowed DH-HMAC-CHAP digests. (optional)
         dhchap_dhgroups: List of allowed DH-HMAC-CHAP DH groups. (optional)
         rdma_umr_per_io: Enable/disable scatter-gather UMR per IO in RDMA transport if supported by system (optional).
+        numa_affinity_qd_threshold: Prefer NUMA local io paths in active-active mode until every local path
+        has this many outstanding I/Os. 0 disables the preference. (optional)
+        intr_adaptive_idle_polls: In interrupt mode, keep polling a poll group while it reaps completions and
+        return to interrupts after this many idle polls. 0 disables adaptive polling. (optional)
+        intr_coalescing_threshold: Aggregation threshold of the completions per interrupt for PCIe controllers
+        in interrupt mode. 0 keeps the controller default. (optional)
+        intr_coalescing_time_us: Aggregation time in microseconds for PCIe controllers in interrupt mode.
+        0 keeps the controller default. (optional)
+        tcp_recv_buf_count: Number of receive buffers provided to each NVMe/TCP poll group. If nonzero,
+        TCP I/O qpairs receive the stream through these buffers. 0 disables. (optional)
+        tcp_recv_buf_size: Size in bytes of each NVMe/TCP receive buffer. (optional)
+        tcp_zcopy_threshold: If nonzero, NVMe/TCP I/O qpairs send with zero-copy each flush of at least
+        this many bytes. (optional)
+        rdma_inline_copy_size: If nonzero, NVMe/RDMA I/O qpairs copy write payloads up to this many bytes
+        into pre-registered buffers and send them in capsule. (optional)
+        io_qpair_idle_timeout_ms: If nonzero, connect the I/O qpair of each thread on its first I/O and
+        disconnect it after no I/O was submitted on it for this many milliseconds. (optional)
+        multipath_stripe_size: If nonzero, split read and write I/Os larger than this many bytes, so that
+        active-active nvme bdevs spread them over all their io paths. (optional)
     """
     params = dict()
     if action_on_timeout is not None:
@@ -690,6 +783,26 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, timeo
         params['dhchap_dhgroups'] = dhchap_dhgroups
     if rdma_umr_per_io is not None:
         params['rdma_umr_per_io'] = rdma_umr_per_io
+    if numa_affinity_qd_threshold is not None:
+        params['numa_affinity_qd_threshold'] = numa_affinity_qd_threshold
+    if intr_adaptive_idle_polls is not None:
+        params['intr_adaptive_idle_polls'] = intr_adaptive_idle_polls
+    if intr_coalescing_threshold is not None:
+        params['intr_coalescing_threshold'] = intr_coalescing_threshold
+    if intr_coalescing_time_us is not None:
+        params['intr_coalescing_time_us'] = intr_coalescing_time_us
+    if tcp_recv_buf_count is not None:
+        params['tcp_recv_buf_count'] = tcp_recv_buf_count
+    if tcp_recv_buf_size is not None:
+        params['tcp_recv_buf_size'] = tcp_recv_buf_size
+    if tcp_zcopy_threshold is not None:
+        params['tcp_zcopy_threshold'] = tcp_zcopy_threshold
+    if rdma_inline_copy_size is not None:
+        params['rdma_inline_copy_size'] = rdma_inline_copy_size
+    if io_qpair_idle_timeout_ms is not None:
+        params['io_qpair_idle_timeout_ms'] = io_qpair_idle_timeout_ms
+    if multipath_stripe_size is not None:
+        params['multipath_stripe_size'] = multipath_stripe_size
     return client.call('bdev_nvme_set_options', params)
 
 
@@ -713,7 +826,7 @@ def bdev_nvme_attach_controller(client, name, trtype, traddr, adrfam=None, trsvc
                                 multipath=None, num_io_queues=None, ctrlr_loss_timeout_sec=None,
                                 reconnect_delay_sec=None, fast_io_fail_timeout_sec=None,
                                 psk=None, max_bdevs=None, dhchap_key=None, dhchap_ctrlr_key=None,
-                                allow_unrecognized_csi=None):
+                                allow_unrecognized_csi=None, wait_for_attach=None):
     """Construct block device for each NVMe namespace in the attached controller.
     Args:
         name: bdev name prefix; "n" + namespace ID will be appended to create unique names
@@ -753,8 +866,10 @@ def bdev_nvme_attach_controller(client, name, trtype, traddr, adrfam=None, trsvc
         dhchap_ctrlr_key: DH-HMAC-CHAP controller key name.
         allow_unrecognized_csi: Allow attaching namespaces with unrecognized command set identifiers. These will only support NVMe
         passthrough.
+        wait_for_attach: Wait for the controller to be attached before returning. If false, return immediately
+        and use bdev_nvme_wait_for_attach to wait for the controller. Default is true. (optional)
     Returns:
-        Names of created block devices.
+        Names of created block devices, or true if wait_for_attach is false.
     """
     params = dict()
     params['name'] = name
@@ -804,9 +919,19 @@ def bdev_nvme_attach_controller(client, name, trtype, traddr, adrfam=None, trsvc
         params['dhchap_ctrlr_key'] = dhchap_ctrlr_key
     if allow_unrecognized_csi is not None:
         params['allow_unrecognized_csi'] = allow_unrecognized_csi
+    if wait_for_attach is not None:
+        params['wait_for_attach'] = wait_for_attach
     return client.call('bdev_nvme_attach_controller', params)
 
 
+def bdev_nvme_wait_for_attach(client):
+    """Wait for the controllers attached with wait_for_attach set to false.
+    Returns:
+        True if all of them were attached, an error otherwise.
+    """
+    return client.call('bdev_nvme_wait_for_attach')
+
+
 def bdev_nvme_detach_controller(client, name, trtype=None, traddr=None,
                                 adrfam=None, trsvcid=None, subnqn=None,
                                 hostaddr=None, hostsvcid=None):
@@ -981,7 +1106,7 @@ def bdev_nvme_set_multipath_policy(client, name, policy, selector=None, rr_min_i
     Args:
         name: NVMe bdev name
         policy: Multipath policy (active_passive or active_active)
-        selector: Multipath selector (round_robin, queue_depth)
+        selector: Multipath selector (round_robin, queue_depth, latency)
         rr_min_io: Number of IO to route to a path before switching to another one (optional)
     """
     params = dict()
@@ -1313,6 +1438,168 @@ def bdev_passthru_delete(client, name):
     return client.call('bdev_passthru_delete', params)
 
 
+def bdev_readahead_create(client, base_bdev_name, name, uuid=None, readahead_size=None):
+    """Construct a readahead block device.
+    Args:
+        base_bdev_name: name of the existing bdev
+        name: name of block device
+        uuid: UUID of block device (optional)
+        readahead_size: number of bytes to prefetch ahead of a sequential read stream (optional)
+    Returns:
+        Name of created block device.
+    """
+    params = dict()
+    params['base_bdev_name'] = base_bdev_name
+    params['name'] = name
+    if uuid is not None:
+        params['uuid'] = uuid
+    if readahead_size is not None:
+        params['readahead_size'] = readahead_size
+    return client.call('bdev_readahead_create', params)
+
+
+def bdev_readahead_delete(client, name):
+    """Remove readahead bdev from the system.
+    Args:
+        name: name of readahead bdev to delete
+    """
+    params = dict()
+    params['name'] = name
+    return client.call('bdev_readahead_delete', params)
+
+
+def bdev_wbcache_create(client, name, base_bdev_name, cache_bdev_name, uuid=None, segment_size=None):
+    """Construct a write-back cache block device.
+    Args:
+        name: name of block device
+        base_bdev_name: name of the existing bdev holding the data
+        cache_bdev_name: name of the existing bdev writes are staged on
+        uuid: UUID of block device (optional)
+        segment_size: size of a cache log segment in bytes (optional)
+    Returns:
+        Name of created block device.
+    """
+    params = dict()
+    params['name'] = name
+    params['base_bdev_name'] = base_bdev_name
+    params['cache_bdev_name'] = cache_bdev_name
+    if uuid is not None:
+        params['uuid'] = uuid
+    if segment_size is not None:
+        params['segment_size'] = segment_size
+    return client.call('bdev_wbcache_create', params)
+
+
+def bdev_wbcache_delete(client, name):
+    """Remove write-back cache bdev from the system.
+    Args:
+        name: name of write-back cache bdev to delete
+    """
+    params = dict()
+    params['name'] = name
+    return client.call('bdev_wbcache_delete', params)
+
+
+def bdev_tier_create(client, name, fast_bdev_name, capacity_bdev_name, uuid=None, extent_size=None):
+    """Construct a tiering block device.
+    Args:
+        name: name of block device
+        fast_bdev_name: name of the existing bdev hot extents are moved to
+        capacity_bdev_name: name of the existing bdev holding the cold extents
+        uuid: UUID of block device (optional)
+        extent_size: size of an extent in bytes (optional)
+    Returns:
+        Name of created block device.
+    """
+    params = dict()
+    params['name'] = name
+    params['fast_bdev_name'] = fast_bdev_name
+    params['capacity_bdev_name'] = capacity_bdev_name
+    if uuid is not None:
+        params['uuid'] = uuid
+    if extent_size is not None:
+        params['extent_size'] = extent_size
+    return client.call('bdev_tier_create', params)
+
+
+def bdev_tier_delete(client, name):
+    """Remove tiering bdev from the system.
+    Args:
+        name: name of tiering bdev to delete
+    """
+    params = dict()
+    params['name'] = name
+    return client.call('bdev_tier_delete', params)
+
+
+def bdev_dedup_create(client, name, base_bdev_name, uuid=None, chunk_size=None, num_blocks=None):
+    """Construct a deduplicating block device.
+    Args:
+        name: name of block device
+        base_bdev_name: name of the existing bdev storing the unique chunks
+        uuid: UUID of block device (optional)
+        chunk_size: size of a chunk in bytes (optional)
+        num_blocks: size of the block device in blocks (optional)
+    Returns:
+        Name of created block device.
+    """
+    params = dict()
+    params['name'] = name
+    params['base_bdev_name'] = base_bdev_name
+    if uuid is not None:
+        params['uuid'] = uuid
+    if chunk_size is not None:
+        params['chunk_size'] = chunk_size
+    if num_blocks is not None:
+        params['num_blocks'] = num_blocks
+    return client.call('bdev_dedup_create', params)
+
+
+def bdev_dedup_delete(client, name):
+    """Remove deduplicating bdev from the system.
+    Args:
+        name: name of deduplicating bdev to delete
+    """
+    params = dict()
+    params['name'] = name
+    return client.call('bdev_dedup_delete', params)
+
+
+def bdev_replica_create(client, name, base_bdev_name, journal_bdev_name, remote_bdev_name, uuid=None,
+                        batch_size=None):
+    """Construct an asynchronously replicated block device.
+    Args:
+        name: name of block device
+        base_bdev_name: name of the existing bdev holding the local copy of the data
+        journal_bdev_name: name of the existing bdev holding the journal of the writes
+        remote_bdev_name: name of the existing bdev the writes are replicated to
+        uuid: UUID of block device (optional)
+        batch_size: largest amount of data shipped to the remote bdev at once, in bytes (optional)
+    Returns:
+        Name of created block device.
+    """
+    params = dict()
+    params['name'] = name
+    params['base_bdev_name'] = base_bdev_name
+    params['journal_bdev_name'] = journal_bdev_name
+    params['remote_bdev_name'] = remote_bdev_name
+    if uuid is not None:
+        params['uuid'] = uuid
+    if batch_size is not None:
+        params['batch_size'] = batch_size
+    return client.call('bdev_replica_create', params)
+
+
+def bdev_replica_delete(client, name):
+    """Remove replicated bdev from the system.
+    Args:
+        name: name of replicated bdev to delete
+    """
+    params = dict()
+    params['name'] = name
+    return client.call('bdev_replica_delete', params)
+
+
 def bdev_opal_create(client, nvme_ctrlr_name, nsid, locking_range_id, range_start, range_length, password):
     """Create opal virtual block devices from a base nvme bdev.
     Args:
@@ -1393,12 +1680,14 @@ def bdev_opal_set_lock_state(client, bdev_name, user_id, password, lock_state):
     return client.call('bdev_opal_set_lock_state', params)
 
 
-def bdev_split_create(client, base_bdev, split_count, split_size_mb=None):
+def bdev_split_create(client, base_bdev, split_count, split_size_mb=None, redirect_io=None):
     """Create split block devices from a base bdev.
     Args:
         base_bdev: name of bdev to split
         split_count: number of split bdevs to create
         split_size_mb: size of each split volume in MiB (optional)
+        redirect_io: remap I/Os in place and submit them to the base bdev instead of
+        submitting new I/Os (optional)
     Returns:
         List of created block devices.
     """
@@ -1407,6 +1696,8 @@ def bdev_split_create(client, base_bdev, split_count, split_size_mb=None):
     params['split_count'] = split_count
     if split_size_mb is not None:
         params['split_size_mb'] = split_size_mb
+    if redirect_io is not None:
+        params['redirect_io'] = redirect_io
     return client.call('bdev_split_create', params)
 
 
@@ -1604,6 +1895,49 @@ def bdev_get_histogram(client, name):
     return client.call('bdev_get_histogram', params)
 
 
+def bdev_enable_heatmap(client, name, enable, num_regions=None, opc=None):
+    """Control whether the I/O heatmap is collected for specified bdev.
+    Args:
+        name: name of bdev
+        enable: Enable or disable heatmap on specified device
+        num_regions: number of LBA regions the bdev is divided into (optional)
+        opc: name of io_type (optional)
+    """
+    params = dict()
+    params['name'] = name
+    params['enable'] = enable
+    if num_regions is not None:
+        params['num_regions'] = num_regions
+    if opc:
+        params['opc'] = opc
+    return client.call('bdev_enable_heatmap', params)
+
+
+def bdev_get_heatmap(client, name):
+    """Get I/O heatmap for specified bdev.
+    Args:
+        name: name of bdev
+    """
+    params = dict()
+    params['name'] = name
+    return client.call('bdev_get_heatmap', params)
+
+
+def bdev_set_coalescing(client, name, window_us, max_size_kb=None):
+    """Set the window in which contiguous I/O of a bdev are merged.
+    Args:
+        name: name of bdev
+        window_us: maximum time an I/O is held to be merged, 0 disables coalescing
+        max_size_kb: maximum size of a merged I/O in KiB (optional)
+    """
+    params = dict()
+    params['name'] = name
+    params['window_us'] = window_us
+    if max_size_kb is not None:
+        params['max_size_kb'] = max_size_kb
+    return client.call('bdev_set_coalescing', params)
+
+
 def bdev_error_inject_error(client, name, io_type, error_type, num=None,
                             queue_depth=None, corrupt_offset=None, corrupt_value=None):
     """Inject an error via an error bdev.
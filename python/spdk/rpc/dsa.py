@@ -6,14 +6,20 @@ from spdk.rpc.helpers import deprecated_alias
 
 
 @deprecated_alias('dsa_scan_accel_engine')
-def dsa_scan_accel_module(client, config_kernel_mode=None):
+def dsa_scan_accel_module(client, config_kernel_mode=None, max_batch_size=None, batch_latency_us=None):
     """Scan and enable DSA accel module.
 
     Args:
         config_kernel_mode: Use kernel DSA driver. (optional)
+        max_batch_size: Number of descriptors after which a batch is submitted. (optional)
+        batch_latency_us: Maximum time in microseconds a batch is held before submission. (optional)
     """
     params = {}
 
     if config_kernel_mode is not None:
         params['config_kernel_mode'] = config_kernel_mode
+    if max_batch_size is not None:
+        params['max_batch_size'] = max_batch_size
+    if batch_latency_us is not None:
+        params['batch_latency_us'] = batch_latency_us
     return client.call('dsa_scan_accel_module', params)
@@ -33,7 +33,8 @@ def fsdev_set_opts(client, fsdev_io_pool_size: int = None, fsdev_io_cache_size:
 
 
 def fsdev_aio_create(client, name, root_path, enable_xattr: bool = None,
-                     enable_writeback_cache: bool = None, max_write: int = None, skip_rw: bool = None):
+                     enable_writeback_cache: bool = None, max_write: int = None, skip_rw: bool = None,
+                     attr_valid_ms: int = None, readahead_size: int = None):
     """Create a aio filesystem.
 
     Args:
@@ -43,6 +44,8 @@ def fsdev_aio_create(client, name, root_path, enable_xattr: bool = None,
         writeback_cache: enable/disable the write cache
         max_write: max write size
         skip_rw: if true skips read/write IOs
+        attr_valid_ms: time in ms the attributes and lookups may be cached by the user
+        readahead_size: size in bytes to read ahead of sequential reads, 0 to disable
     """
     params = {
         'name': name,
@@ -56,6 +59,10 @@ def fsdev_aio_create(client, name, root_path, enable_xattr: bool = None,
         params['max_write'] = max_write
     if skip_rw is not None:
         params['skip_rw'] = skip_rw
+    if attr_valid_ms is not None:
+        params['attr_valid_ms'] = attr_valid_ms
+    if readahead_size is not None:
+        params['readahead_size'] = readahead_size
     return client.call('fsdev_aio_create', params)
 
 
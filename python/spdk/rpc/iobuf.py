@@ -3,7 +3,8 @@
 #  All rights reserved.
 
 
-def iobuf_set_options(client, small_pool_count, large_pool_count, small_bufsize, large_bufsize, enable_numa=None):
+def iobuf_set_options(client, small_pool_count, large_pool_count, small_bufsize, large_bufsize, enable_numa=None,
+                      size_classes=None, enable_steal=None):
     """Set iobuf pool options.
 
     Args:
@@ -12,6 +13,8 @@ def iobuf_set_options(client, small_pool_count, large_pool_count, small_bufsize,
         small_bufsize: size of a small buffer
         large_bufsize: size of a large buffer
         enable_numa: enable per-NUMA buffer pools
+        size_classes: list of additional buffer size classes, each a dict with 'bufsize' and 'pool_count'
+        enable_steal: let channels short of buffers take them from other channels' caches
     """
     params = {}
 
@@ -25,6 +28,10 @@ def iobuf_set_options(client, small_pool_count, large_pool_count, small_bufsize,
         params['large_bufsize'] = large_bufsize
     if enable_numa is not None:
         params['enable_numa'] = enable_numa
+    if size_classes is not None:
+        params['size_classes'] = size_classes
+    if enable_steal is not None:
+        params['enable_steal'] = enable_steal
 
     return client.call('iobuf_set_options', params)
 
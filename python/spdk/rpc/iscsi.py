@@ -26,7 +26,9 @@ def iscsi_set_options(
         max_r2t_per_connection=None,
         pdu_pool_size=None,
         immediate_data_pool_size=None,
-        data_out_pool_size=None):
+        data_out_pool_size=None,
+        spread_connections=None,
+        max_outstanding_r2t=None):
     """Set iSCSI target options.
 
     Args:
@@ -52,6 +54,8 @@ def iscsi_set_options(
         pdu_pool_size: Number of PDUs in the pool (optional)
         immediate_data_pool_size: Number of immediate data buffers in the pool (optional)
         data_out_pool_size: Number of data out buffers in the pool (optional)
+        spread_connections: Spread connections across poll groups by load instead of per target (optional)
+        max_outstanding_r2t: Negotiated parameter, MaxOutstandingR2T (optional)
 
     Returns:
         True or False
@@ -102,6 +106,10 @@ def iscsi_set_options(
         params['immediate_data_pool_size'] = immediate_data_pool_size
     if data_out_pool_size:
         params['data_out_pool_size'] = data_out_pool_size
+    if spread_connections:
+        params['spread_connections'] = spread_connections
+    if max_outstanding_r2t:
+        params['max_outstanding_r2t'] = max_outstanding_r2t
 
     return client.call('iscsi_set_options', params)
 
@@ -191,6 +191,20 @@ def bdev_lvol_set_read_only(client, name):
     return client.call('bdev_lvol_set_read_only', params)
 
 
+def bdev_lvol_set_esnap_copy_on_read(client, name, clusters_per_sec):
+    """Set the rate of copy-on-read of an esnap clone logical volume.
+
+    Args:
+        name: name of the esnap clone logical volume
+        clusters_per_sec: largest number of clusters copied per second, 0 to disable
+    """
+    params = {
+        'name': name,
+        'clusters_per_sec': clusters_per_sec,
+    }
+    return client.call('bdev_lvol_set_esnap_copy_on_read', params)
+
+
 def bdev_lvol_delete(client, name):
     """Destroy a logical volume.
 
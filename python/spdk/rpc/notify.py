@@ -9,12 +9,16 @@ def notify_get_types(client):
 
 def notify_get_notifications(client,
                              id=None,
-                             max=None):
+                             max=None,
+                             types=None,
+                             timeout_ms=None):
     """
 
     Args:
         id First ID to start fetching from
         max Maximum number of notifications to return in response
+        types Only return notifications of these types
+        timeout_ms Wait up to this long for a notification if there is none yet
 
     Return:
         Notifications array
@@ -27,4 +31,10 @@ def notify_get_notifications(client,
     if max:
         params['max'] = max
 
+    if types:
+        params['types'] = types
+
+    if timeout_ms:
+        params['timeout_ms'] = timeout_ms
+
     return client.call("notify_get_notifications", params)
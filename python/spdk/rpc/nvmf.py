@@ -116,6 +116,9 @@ def nvmf_create_transport(client, **params):
         num_shared_buffers: The number of pooled data buffers available to the transport (optional)
         buf_cache_size: The number of shared buffers to reserve for each poll group (optional)
         zcopy: Use zero-copy operations if the underlying bdev supports them (optional)
+        host_io_stats: Track the size of host to controller transfers of each host (optional)
+        host_max_iops: I/O commands admitted per second from each host, 0 for no limit (optional)
+        host_max_burst: I/O commands a host can submit at once above host_max_iops (optional)
         num_cqe: The number of CQ entries to configure CQ size. Only used when no_srq=true - RDMA specific (optional)
         max_srq_depth: Max number of outstanding I/O per shared receive queue - RDMA specific (optional)
         no_srq: Boolean flag to disable SRQ even for devices that support it - RDMA specific (optional)
@@ -125,12 +128,14 @@ def nvmf_create_transport(client, **params):
         abort_timeout_sec: Abort execution timeout value, in seconds (optional)
         no_wr_batching: Boolean flag to disable work requests batching - RDMA specific (optional)
         control_msg_num: The number of control messages per poll group - TCP specific (optional)
+        poll_group_load_balance: Boolean flag to place new qpairs on the least loaded poll group - TCP specific (optional)
         disable_mappable_bar0: disable client mmap() of BAR0 - VFIO-USER specific (optional)
         disable_adaptive_irq: Disable adaptive interrupt feature - VFIO-USER specific (optional)
         disable_shadow_doorbells: disable shadow doorbell support - VFIO-USER specific (optional)
         acceptor_poll_rate: Acceptor poll period in microseconds (optional)
         ack_timeout: ACK timeout in milliseconds (optional)
         data_wr_pool_size: RDMA data WR pool size. RDMA specific (optional)
+        srq_lazy_alloc: Boolean flag to allocate SRQ resources when the first qpair on a device connects - RDMA specific (optional)
         disable_command_passthru: Disallow command passthru.
     Returns:
         True or False
@@ -164,6 +169,27 @@ def nvmf_get_transports(client, trtype=None, tgt_name=None):
     return client.call('nvmf_get_transports', params)
 
 
+def nvmf_get_host_io_stats(client, trtype=None, tgt_name=None):
+    """Get the size histogram of host to controller transfers of each host.
+    Args:
+        trtype: Transport type (optional; if omitted, query all transports with host_io_stats enabled).
+        tgt_name: name of the parent NVMe-oF target (optional).
+
+    Returns:
+        List of transports with the I/O stats of their hosts.
+    """
+
+    params = {}
+
+    if tgt_name:
+        params['tgt_name'] = tgt_name
+
+    if trtype:
+        params['trtype'] = trtype
+
+    return client.call('nvmf_get_host_io_stats', params)
+
+
 def nvmf_get_subsystems(client, nqn=None, tgt_name=None):
     """Get list of NVMe-oF subsystems.
     Args:
@@ -490,6 +516,27 @@ def nvmf_subsystem_add_ns(client, **params):
     return client.call('nvmf_subsystem_add_ns', params)
 
 
+def nvmf_subsystem_add_ns_bulk(client, nqn, namespaces, tgt_name=None):
+    """Add multiple namespaces to a subsystem in a single request.
+
+    Args:
+        nqn: Subsystem NQN.
+        namespaces: List of namespace objects, each with the same keys as the
+            namespace of nvmf_subsystem_add_ns (bdev_name, nsid, ...).
+        tgt_name: name of the parent NVMe-oF target (optional).
+
+    Returns:
+        List of the namespace IDs, in the order of namespaces
+    """
+    params = {'nqn': nqn,
+              'namespaces': namespaces}
+
+    if tgt_name:
+        params['tgt_name'] = tgt_name
+
+    return client.call('nvmf_subsystem_add_ns_bulk', params)
+
+
 def nvmf_subsystem_set_ns_ana_group(client, nqn, nsid, anagrpid, tgt_name=None):
     """Change ANA group ID of a namespace.
 
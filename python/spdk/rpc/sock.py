@@ -27,7 +27,8 @@ def sock_impl_set_options(client,
                           enable_zerocopy_send_client=None,
                           zerocopy_threshold=None,
                           tls_version=None,
-                          enable_ktls=None):
+                          enable_ktls=None,
+                          busy_poll_usecs=None):
     """Set parameters for the socket layer implementation.
 
     Args:
@@ -42,6 +43,7 @@ def sock_impl_set_options(client,
         zerocopy_threshold: set zerocopy_threshold in bytes(optional)
         tls_version: set TLS protocol version (optional)
         enable_ktls: enable or disable Kernel TLS (optional)
+        busy_poll_usecs: busy poll timeout in microseconds, 0 to disable (optional)
     """
     params = {}
 
@@ -66,6 +68,8 @@ def sock_impl_set_options(client,
         params['tls_version'] = tls_version
     if enable_ktls is not None:
         params['enable_ktls'] = enable_ktls
+    if busy_poll_usecs is not None:
+        params['busy_poll_usecs'] = busy_poll_usecs
 
     return client.call('sock_impl_set_options', params)
 
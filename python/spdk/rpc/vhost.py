@@ -110,6 +110,8 @@ def vhost_create_blk_controller(client, **params):
         transport: virtio blk transport name (default: vhost_user_blk)
         readonly: set controller as read-only
         packed_ring: support controller packed_ring
+        event_idx: offer VIRTIO_RING_F_EVENT_IDX to the guest
+        vq_threads: number of threads to spread the virtqueues across (default: 1)
     """
     strip_globals(params)
     remove_null(params)
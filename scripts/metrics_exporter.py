@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+#  SPDX-License-Identifier: BSD-3-Clause
+#  Copyright (C) 2026 The SPDK Authors.
+#  All rights reserved.
+#
+
+"""Serve SPDK statistics in the Prometheus text exposition format.
+
+The statistics are collected from the SPDK application over RPC once per
+interval by a background thread. Scrapes are served from the last snapshot,
+so the load on the application does not depend on how often, or by how many
+clients, the endpoint is scraped.
+"""
+
+import argparse
+import logging
+import os
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+sys.path.append(os.path.dirname(__file__) + '/../python')
+
+import spdk.rpc as rpc  # noqa
+from spdk.rpc.client import JSONRPCException  # noqa
+
+
+CONTENT_TYPE = 'text/plain; version=0.0.4; charset=utf-8'
+
+# (RPC field, metric name, help, type, divide by tick rate)
+BDEV_METRICS = [
+    ('bytes_read', 'spdk_bdev_read_bytes_total', 'Bytes read', 'counter', False),
+    ('num_read_ops', 'spdk_bdev_reads_total', 'Read operations', 'counter', False),
+    ('bytes_written', 'spdk_bdev_written_bytes_total', 'Bytes written', 'counter', False),
+    ('num_write_ops', 'spdk_bdev_writes_total', 'Write operations', 'counter', False),
+    ('bytes_unmapped', 'spdk_bdev_unmapped_bytes_total', 'Bytes unmapped', 'counter', False),
+    ('num_unmap_ops', 'spdk_bdev_unmaps_total', 'Unmap operations', 'counter', False),
+    ('read_latency_ticks', 'spdk_bdev_read_latency_seconds_total',
+     'Total latency of read operations', 'counter', True),
+    ('write_latency_ticks', 'spdk_bdev_write_latency_seconds_total',
+     'Total latency of write operations', 'counter', True),
+    ('unmap_latency_ticks', 'spdk_bdev_unmap_latency_seconds_total',
+     'Total latency of unmap operations', 'counter', True),
+    ('queue_depth', 'spdk_bdev_queue_depth', 'Current queue depth', 'gauge', False),
+]
+
+THREAD_METRICS = [
+    ('busy', 'spdk_thread_busy_seconds_total', 'Time spent doing work', 'counter', True),
+    ('idle', 'spdk_thread_idle_seconds_total', 'Time spent idle', 'counter', True),
+]
+
+NVMF_POLL_GROUP_METRICS = [
+    ('admin_qpairs', 'spdk_nvmf_admin_qpairs_total', 'Admin qpairs created', 'counter'),
+    ('io_qpairs', 'spdk_nvmf_io_qpairs_total', 'I/O qpairs created', 'counter'),
+    ('current_admin_qpairs', 'spdk_nvmf_admin_qpairs', 'Current admin qpairs', 'gauge'),
+    ('current_io_qpairs', 'spdk_nvmf_io_qpairs', 'Current I/O qpairs', 'gauge'),
+    ('pending_bdev_io', 'spdk_nvmf_pending_bdev_io', 'I/Os waiting for a bdev_io', 'gauge'),
+    ('completed_nvme_io', 'spdk_nvmf_completed_nvme_io_total', 'Completed NVMe I/O commands', 'counter'),
+]
+
+
+def escape_label(value):
+    return str(value).replace('\\', '\\\\').replace('\n', '\\n').replace('"', '\\"')
+
+
+class MetricFamily:
+
+    def __init__(self, name, help, type):
+        self.name = name
+        self.help = help
+        self.type = type
+        self.samples = []
+
+    def add(self, labels, value):
+        self.samples.append((labels, value))
+
+    def render(self, out):
+        out.append('# HELP %s %s' % (self.name, self.help))
+        out.append('# TYPE %s %s' % (self.name, self.type))
+        for labels, value in self.samples:
+            label_str = ','.join('%s="%s"' % (k, escape_label(v)) for k, v in labels.items())
+            out.append('%s{%s} %s' % (self.name, label_str, repr(float(value))))
+
+
+def collect_table(families, entries, metrics, tick_rate, label_fn):
+    for field, name, help, type, in_ticks in metrics:
+        family = MetricFamily(name, help, type)
+        for entry in entries:
+            if field not in entry:
+                continue
+            value = entry[field]
+            if in_ticks:
+                value = value / tick_rate
+            family.add(label_fn(entry), value)
+        if family.samples:
+            families.append(family)
+
+
+def collect_bdev(client, families):
+    stats = rpc.bdev.bdev_get_iostat(client)
+    collect_table(families, stats['bdevs'], BDEV_METRICS, stats['tick_rate'],
+                  lambda b: {'bdev': b['name']})
+
+
+def collect_thread(client, families):
+    stats = rpc.app.thread_get_stats(client)
+    collect_table(families, stats['threads'], THREAD_METRICS, stats['tick_rate'],
+                  lambda t: {'thread': t['name'], 'id': t['id']})
+
+
+def collect_nvmf(client, families):
+    stats = rpc.nvmf.nvmf_get_stats(client)
+    metrics = [(f, n, h, t, False) for f, n, h, t in NVMF_POLL_GROUP_METRICS]
+    collect_table(families, stats['poll_groups'], metrics, stats['tick_rate'],
+                  lambda p: {'poll_group': p['name']})
+
+
+COLLECTORS = {
+    'bdev': collect_bdev,
+    'nvmf': collect_nvmf,
+    'thread': collect_thread,
+}
+
+
+class Collector(threading.Thread):
+
+    def __init__(self, args):
+        super().__init__(daemon=True)
+        self.args = args
+        self.lock = threading.Lock()
+        self.snapshot = ''
+        self.client = None
+
+    def _disconnect(self):
+        try:
+            self.client.close()
+        except OSError:
+            pass
+        self.client = None
+
+    def _collect_all(self, families):
+        # The connection is kept across collections and re-established once it has been lost,
+        # e.g. because the application was restarted.
+        if self.client is None:
+            try:
+                self.client = rpc.client.JSONRPCClient(
+                    self.args.server_addr, self.args.port, self.args.timeout,
+                    log_level=getattr(logging, self.args.verbose.upper()))
+            except JSONRPCException as e:
+                logging.warning('%s', e)
+                self.client = None
+                return 0
+
+        for name in self.args.collectors:
+            try:
+                COLLECTORS[name](self.client, families)
+            except JSONRPCException as e:
+                if self.client.sock is None:
+                    logging.warning('%s', e)
+                    self.client = None
+                    return 0
+                # E.g. nvmf_get_stats in an application without an NVMe-oF target
+                logging.debug('%s statistics unavailable: %s', name, e)
+            except OSError as e:
+                logging.warning('%s', e)
+                self._disconnect()
+                return 0
+
+        return 1
+
+    def collect(self):
+        families = []
+        start = time.monotonic()
+        up = self._collect_all(families)
+        if not up:
+            families = []
+
+        meta = MetricFamily('spdk_exporter_up', 'Whether the last collection succeeded', 'gauge')
+        meta.add({}, up)
+        families.append(meta)
+        meta = MetricFamily('spdk_exporter_collect_seconds', 'Duration of the last collection', 'gauge')
+        meta.add({}, time.monotonic() - start)
+        families.append(meta)
+
+        out = []
+        for family in families:
+            family.render(out)
+        out.append('')
+
+        with self.lock:
+            self.snapshot = '\n'.join(out)
+
+    def get(self):
+        with self.lock:
+            return self.snapshot
+
+    def run(self):
+        while True:
+            time.sleep(self.args.interval)
+            self.collect()
+
+
+def make_handler(collector):
+
+    class MetricsHandler(BaseHTTPRequestHandler):
+
+        def do_GET(self):
+            if self.path.split('?')[0] != '/metrics':
+                self.send_error(404)
+                return
+
+            body = collector.get().encode('utf-8')
+            self.send_response(200)
+            self.send_header('Content-Type', CONTENT_TYPE)
+            self.send_header('Content-Length', str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, format, *args):
+            logging.debug(format, *args)
+
+    return MetricsHandler
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description='Serve SPDK statistics in the Prometheus text format')
+    parser.add_argument('-s', dest='server_addr',
+                        help='RPC domain socket path or IP address', default='/var/tmp/spdk.sock')
+    parser.add_argument('-p', dest='port',
+                        help='RPC port number (if server_addr is IP address)',
+                        default=5260, type=int)
+    parser.add_argument('-t', dest='timeout',
+                        help='Timeout as a floating point number expressed in seconds, waiting for response. Default: 60.0',
+                        default=60.0, type=float)
+    parser.add_argument('-l', dest='listen_addr', help='Address to serve the metrics on', default='')
+    parser.add_argument('-P', dest='listen_port', help='Port to serve the metrics on',
+                        default=9466, type=int)
+    parser.add_argument('-i', dest='interval', help='Interval between two collections in seconds',
+                        default=5.0, type=float)
+    parser.add_argument('-c', dest='collectors', action='append', choices=sorted(COLLECTORS),
+                        help='Statistics to collect, may be repeated. Default: all')
+    parser.add_argument('-v', dest='verbose', action='store_const', const="INFO",
+                        help='Set verbose mode to INFO', default="ERROR")
+    args = parser.parse_args()
+
+    if args.collectors is None:
+        args.collectors = sorted(COLLECTORS)
+
+    logging.basicConfig(level=getattr(logging, args.verbose.upper()))
+
+    collector = Collector(args)
+    collector.collect()
+    collector.start()
+
+    server = ThreadingHTTPServer((args.listen_addr, args.listen_port), make_handler(collector))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
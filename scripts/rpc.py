@@ -158,6 +158,15 @@ if __name__ == "__main__":
     p.add_argument('-d', '--disable', action='store_true', help='Disable context switch monitoring')
     p.set_defaults(func=framework_monitor_context_switch)
 
+    def framework_interrupt_poll_window(args):
+        print_dict(rpc.app.framework_interrupt_poll_window(args.client,
+                                                           window_us=args.window_us))
+
+    p = subparsers.add_parser('framework_interrupt_poll_window',
+                              help='Query or set how long reactors in interrupt mode keep polling after a wakeup')
+    p.add_argument('-w', '--window-us', type=int, help='Polling window in microseconds, 0 disables it')
+    p.set_defaults(func=framework_interrupt_poll_window)
+
     def framework_get_reactors(args):
         print_dict(rpc.app.framework_get_reactors(args.client))
 
@@ -172,6 +181,11 @@ if __name__ == "__main__":
                                         load_limit=args.load_limit,
                                         core_limit=args.core_limit,
                                         core_busy=args.core_busy,
+                                        load_smoothing=args.load_smoothing,
+                                        move_interval=args.move_interval,
+                                        migration_cost=args.migration_cost,
+                                        target_busy=args.target_busy,
+                                        boost_delta=args.boost_delta,
                                         mappings=args.mappings)
 
     p = subparsers.add_parser(
@@ -181,6 +195,16 @@ if __name__ == "__main__":
     p.add_argument('--load-limit', help="Scheduler load limit. Reserved for dynamic scheduler", type=int)
     p.add_argument('--core-limit', help="Scheduler core limit. Reserved for dynamic scheduler", type=int)
     p.add_argument('--core-busy', help="Scheduler core busy limit. Reserved for dynamic scheduler", type=int)
+    p.add_argument('--load-smoothing', help="""Weight in %% of the load history in the thread and core loads.
+    Reserved for dynamic scheduler""", type=int)
+    p.add_argument('--move-interval', help="""Minimum number of scheduling periods between two moves of a thread.
+    Reserved for dynamic scheduler""", type=int)
+    p.add_argument('--migration-cost', help="""Extra load in %% of a thread's busy time expected on the core it is moved to.
+    Reserved for dynamic scheduler""", type=int)
+    p.add_argument('--target-busy', help="""Busy %% the core frequency is set to reach, proportionally to the load.
+    0 steps the frequency instead. Reserved for gscheduler""", type=int)
+    p.add_argument('--boost-delta', help="""Rise of the core busy %% since the previous period that sets the maximal frequency.
+    Reserved for gscheduler""", type=int)
     p.add_argument('--mappings', help="Comma-separated list of thread:core mappings. Reserved for static scheduler")
     p.set_defaults(func=framework_set_scheduler)
 
@@ -229,7 +253,12 @@ if __name__ == "__main__":
                                   bdev_io_cache_size=args.bdev_io_cache_size,
                                   bdev_auto_examine=args.bdev_auto_examine,
                                   iobuf_small_cache_size=args.iobuf_small_cache_size,
-                                  iobuf_large_cache_size=args.iobuf_large_cache_size)
+                                  iobuf_large_cache_size=args.iobuf_large_cache_size,
+                                  copy_queue_depth=args.copy_queue_depth,
+                                  trace_sample_rate=args.trace_sample_rate,
+                                  bdev_io_small_pool_size=args.bdev_io_small_pool_size,
+                                  bdev_io_small_ctx_size=args.bdev_io_small_ctx_size,
+                                  bounce_accel_copy_threshold=args.bounce_accel_copy_threshold)
 
     p = subparsers.add_parser('bdev_set_options',
                               help="""Set options of bdev subsystem""")
@@ -240,6 +269,16 @@ if __name__ == "__main__":
     group.add_argument('-d', '--disable-auto-examine', dest='bdev_auto_examine', help='Not allow to auto examine', action='store_false')
     p.add_argument('--iobuf-small-cache-size', help='Size of the small iobuf per thread cache', type=int)
     p.add_argument('--iobuf-large-cache-size', help='Size of the large iobuf per thread cache', type=int)
+    p.add_argument('--copy-queue-depth', help='Maximum number of child requests outstanding for a split or emulated copy',
+                   type=int)
+    p.add_argument('--trace-sample-rate', help='Record the bdev tracepoints of only one in this many I/Os (0 or 1 traces all)',
+                   type=int)
+    p.add_argument('--bdev-io-small-pool-size', help='Number of bdev_io structures in the pool for modules with a small I/O context (0 disables it)',
+                   type=int)
+    p.add_argument('--bdev-io-small-ctx-size', help='Maximum I/O context size in bytes of the modules using the small bdev_io pool',
+                   type=int)
+    p.add_argument('--bounce-accel-copy-threshold', help='Bounce buffer copies of at least this many bytes go through accel (0 disables it)',
+                   type=int)
     p.set_defaults(bdev_auto_examine=True)
     p.set_defaults(func=bdev_set_options)
 
@@ -295,7 +334,24 @@ if __name__ == "__main__":
     p.add_argument('-b', '--name', help="Name of a comp bdev. Example: COMP_Nvme0n1")
     p.set_defaults(func=bdev_compress_get_orphans)
 
+    def bdev_compress_set_options(args):
+        rpc.bdev.bdev_compress_set_options(args.client,
+                                           read_cache_size_mb=args.read_cache_size_mb)
+
+    p = subparsers.add_parser('bdev_compress_set_options', help='Set options of the compress bdev module')
+    p.add_argument('-r', '--read-cache-size-mb', help='Size of the cache of decompressed chunks of each compress bdev, in MiB. 0 disables the cache',
+                   type=int)
+    p.set_defaults(func=bdev_compress_set_options)
+
     def bdev_crypto_create(args):
+        key_ranges = None
+        if args.key_range:
+            key_ranges = []
+            for key_range in args.key_range:
+                key_name, offset_blocks, num_blocks = key_range.split(':')
+                key_ranges.append({'key_name': key_name,
+                                   'offset_blocks': int(offset_blocks),
+                                   'num_blocks': int(num_blocks)})
         print_json(rpc.bdev.bdev_crypto_create(args.client,
                                                base_bdev_name=args.base_bdev_name,
                                                name=args.name,
@@ -303,7 +359,8 @@ if __name__ == "__main__":
                                                key=args.key,
                                                cipher=args.cipher,
                                                key2=args.key2,
-                                               key_name=args.key_name))
+                                               key_name=args.key_name,
+                                               key_ranges=key_ranges))
     p = subparsers.add_parser('bdev_crypto_create', help='Add a crypto vbdev')
     p.add_argument('base_bdev_name', help="Name of the base bdev")
     p.add_argument('name', help="Name of the crypto vbdev")
@@ -312,6 +369,9 @@ if __name__ == "__main__":
     p.add_argument('-c', '--cipher', help="cipher to use. Obsolete, see accel_crypto_key_create")
     p.add_argument('-k2', '--key2', help="2nd key for cipher AES_XTS. Obsolete, see accel_crypto_key_create", default=None)
     p.add_argument('-n', '--key-name', help="Key name to use, see accel_crypto_key_create")
+    p.add_argument('-r', '--key-range', action='append',
+                   help="LBA range encrypted with its own key, as key_name:offset_blocks:num_blocks. "
+                   "May be repeated")
     p.set_defaults(func=bdev_crypto_create)
 
     def bdev_crypto_delete(args):
@@ -425,7 +485,8 @@ if __name__ == "__main__":
                                                md_interleave=args.md_interleave,
                                                dif_type=args.dif_type,
                                                dif_is_head_of_md=args.dif_is_head_of_md,
-                                               dif_pi_format=args.dif_pi_format))
+                                               dif_pi_format=args.dif_pi_format,
+                                               numa_replicas=args.numa_replicas))
     p = subparsers.add_parser('bdev_malloc_create', help='Create a bdev with malloc backend')
     p.add_argument('-b', '--name', help="Name of the bdev")
     p.add_argument('-u', '--uuid', help="UUID of the bdev (optional)")
@@ -447,6 +508,8 @@ if __name__ == "__main__":
     p.add_argument('-f', '--dif-pi-format', type=int, choices=[0, 1, 2],
                    help='Protection infromation format. Parameter --dif-type needs to be set together.'
                         '0=16b Guard PI, 1=32b Guard PI, 2=64b Guard PI. Default=0.')
+    p.add_argument('--numa-replicas', action='store_true',
+                   help='Keep a copy of the data on each NUMA node and read from the local one. Default=false.')
     p.set_defaults(func=bdev_malloc_create)
 
     def bdev_malloc_delete(args):
@@ -544,6 +607,21 @@ if __name__ == "__main__":
     p.add_argument('name', help='aio bdev name')
     p.set_defaults(func=bdev_aio_delete)
 
+    def bdev_uring_set_options(args):
+        rpc.bdev.bdev_uring_set_options(args.client,
+                                        iopoll=args.iopoll,
+                                        sqpoll=args.sqpoll,
+                                        sqpoll_idle_ms=args.sqpoll_idle_ms)
+
+    p = subparsers.add_parser('bdev_uring_set_options', help='Set options for the bdev uring module')
+    p.add_argument('--iopoll', help='Poll the devices for completions, requires O_DIRECT',
+                   action='store_true', default=None)
+    p.add_argument('--sqpoll', help='Submit through a kernel thread polling the submission queue',
+                   action='store_true', default=None)
+    p.add_argument('--sqpoll-idle-ms', help='Idle time in ms after which the kernel submission thread sleeps',
+                   type=int)
+    p.set_defaults(func=bdev_uring_set_options)
+
     def bdev_uring_create(args):
         print_json(rpc.bdev.bdev_uring_create(args.client,
                                               filename=args.filename,
@@ -579,13 +657,18 @@ if __name__ == "__main__":
                                               filename=args.filename,
                                               name=args.name,
                                               io_mechanism=args.io_mechanism,
-                                              conserve_cpu=args.conserve_cpu))
+                                              conserve_cpu=args.conserve_cpu,
+                                              queue_depth=args.queue_depth,
+                                              sqpoll=args.sqpoll))
 
     p = subparsers.add_parser('bdev_xnvme_create', help='Create a bdev with xNVMe backend')
     p.add_argument('filename', help='Path to device or file (ex: /dev/nvme0n1)')
     p.add_argument('name', help='name of xNVMe bdev to create')
     p.add_argument('io_mechanism', help='IO mechanism to use (ex: libaio, io_uring, io_uring_cmd, etc.)')
     p.add_argument('-c', '--conserve-cpu', action='store_true', help='Whether or not to conserve CPU when polling')
+    p.add_argument('-q', '--queue-depth', type=int, help='Depth of the xNVMe queue of each I/O channel (power of 2, default: 512)')
+    p.add_argument('-s', '--sqpoll', action='store_true', default=None,
+                   help='Use a kernel submission queue polling thread (io_uring and io_uring_cmd only)')
     p.set_defaults(func=bdev_xnvme_create)
 
     def bdev_xnvme_delete(args):
@@ -627,7 +710,17 @@ if __name__ == "__main__":
                                        rdma_cm_event_timeout_ms=args.rdma_cm_event_timeout_ms,
                                        dhchap_digests=args.dhchap_digests,
                                        dhchap_dhgroups=args.dhchap_dhgroups,
-                                       rdma_umr_per_io=args.rdma_umr_per_io)
+                                       rdma_umr_per_io=args.rdma_umr_per_io,
+                                       numa_affinity_qd_threshold=args.numa_affinity_qd_threshold,
+                                       intr_adaptive_idle_polls=args.intr_adaptive_idle_polls,
+                                       intr_coalescing_threshold=args.intr_coalescing_threshold,
+                                       intr_coalescing_time_us=args.intr_coalescing_time_us,
+                                       tcp_recv_buf_count=args.tcp_recv_buf_count,
+                                       tcp_recv_buf_size=args.tcp_recv_buf_size,
+                                       tcp_zcopy_threshold=args.tcp_zcopy_threshold,
+                                       rdma_inline_copy_size=args.rdma_inline_copy_size,
+                                       io_qpair_idle_timeout_ms=args.io_qpair_idle_timeout_ms,
+                                       multipath_stripe_size=args.multipath_stripe_size)
 
     p = subparsers.add_parser('bdev_nvme_set_options',
                               help='Set options for the bdev nvme type. This is startup command.')
@@ -720,6 +813,36 @@ if __name__ == "__main__":
     p.add_argument('--disable-rdma-umr-per-io',
                    help='''Disable scatter-gather RDMA Memory Region per IO.''',
                    action='store_false', dest='rdma_umr_per_io')
+    p.add_argument('--numa-affinity-qd-threshold',
+                   help='''Prefer io paths on the NUMA node of the submitting core in active-active mode until every
+                   local path has this many outstanding I/Os. 0 disables the preference.''', type=int)
+    p.add_argument('--intr-adaptive-idle-polls',
+                   help='''In interrupt mode, keep polling a poll group while it reaps completions and return to
+                   interrupts after this many idle polls. 0 disables adaptive polling.''', type=int)
+    p.add_argument('--intr-coalescing-threshold',
+                   help='''Aggregation threshold of the completions per interrupt for PCIe controllers in
+                   interrupt mode (1-256). 0 keeps the controller default.''', type=int)
+    p.add_argument('--intr-coalescing-time-us',
+                   help='''Aggregation time in microseconds for PCIe controllers in interrupt mode, rounded up to
+                   100 microsecond units. 0 keeps the controller default.''', type=int)
+    p.add_argument('--tcp-recv-buf-count',
+                   help='''Number of receive buffers provided to each NVMe/TCP poll group. If nonzero, TCP I/O
+                   qpairs receive the stream through these buffers instead of a receive pipe of each socket.''',
+                   type=int)
+    p.add_argument('--tcp-recv-buf-size',
+                   help='Size in bytes of each NVMe/TCP receive buffer.', type=int)
+    p.add_argument('--tcp-zcopy-threshold',
+                   help='''If nonzero, NVMe/TCP I/O qpairs send with zero-copy each flush of at least this many
+                   bytes, e.g. H2C data PDUs of large writes.''', type=int)
+    p.add_argument('--rdma-inline-copy-size',
+                   help='''If nonzero, NVMe/RDMA I/O qpairs copy write payloads up to this many bytes into
+                   pre-registered buffers and send them in capsule, saving the memory translation.''', type=int)
+    p.add_argument('--io-qpair-idle-timeout-ms',
+                   help='''If nonzero, the I/O qpair of each thread is connected on its first I/O and
+                   disconnected again after no I/O was submitted on it for this many milliseconds.''', type=int)
+    p.add_argument('--multipath-stripe-size',
+                   help='''If nonzero, read and write I/Os larger than this many bytes are split, so that
+                   active-active nvme bdevs spread them over all their io paths.''', type=int)
 
     p.set_defaults(func=bdev_nvme_set_options)
 
@@ -734,32 +857,37 @@ if __name__ == "__main__":
     p.set_defaults(func=bdev_nvme_set_hotplug)
 
     def bdev_nvme_attach_controller(args):
-        print_array(rpc.bdev.bdev_nvme_attach_controller(args.client,
-                                                         name=args.name,
-                                                         trtype=args.trtype,
-                                                         traddr=args.traddr,
-                                                         adrfam=args.adrfam,
-                                                         trsvcid=args.trsvcid,
-                                                         priority=args.priority,
-                                                         subnqn=args.subnqn,
-                                                         hostnqn=args.hostnqn,
-                                                         hostaddr=args.hostaddr,
-                                                         hostsvcid=args.hostsvcid,
-                                                         prchk_reftag=args.prchk_reftag,
-                                                         prchk_guard=args.prchk_guard,
-                                                         hdgst=args.hdgst,
-                                                         ddgst=args.ddgst,
-                                                         fabrics_connect_timeout_us=args.fabrics_connect_timeout_us,
-                                                         multipath=args.multipath,
-                                                         num_io_queues=args.num_io_queues,
-                                                         ctrlr_loss_timeout_sec=args.ctrlr_loss_timeout_sec,
-                                                         reconnect_delay_sec=args.reconnect_delay_sec,
-                                                         fast_io_fail_timeout_sec=args.fast_io_fail_timeout_sec,
-                                                         psk=args.psk,
-                                                         max_bdevs=args.max_bdevs,
-                                                         dhchap_key=args.dhchap_key,
-                                                         dhchap_ctrlr_key=args.dhchap_ctrlr_key,
-                                                         allow_unrecognized_csi=args.allow_unrecognized_csi))
+        ret = rpc.bdev.bdev_nvme_attach_controller(args.client,
+                                                   name=args.name,
+                                                   trtype=args.trtype,
+                                                   traddr=args.traddr,
+                                                   adrfam=args.adrfam,
+                                                   trsvcid=args.trsvcid,
+                                                   priority=args.priority,
+                                                   subnqn=args.subnqn,
+                                                   hostnqn=args.hostnqn,
+                                                   hostaddr=args.hostaddr,
+                                                   hostsvcid=args.hostsvcid,
+                                                   prchk_reftag=args.prchk_reftag,
+                                                   prchk_guard=args.prchk_guard,
+                                                   hdgst=args.hdgst,
+                                                   ddgst=args.ddgst,
+                                                   fabrics_connect_timeout_us=args.fabrics_connect_timeout_us,
+                                                   multipath=args.multipath,
+                                                   num_io_queues=args.num_io_queues,
+                                                   ctrlr_loss_timeout_sec=args.ctrlr_loss_timeout_sec,
+                                                   reconnect_delay_sec=args.reconnect_delay_sec,
+                                                   fast_io_fail_timeout_sec=args.fast_io_fail_timeout_sec,
+                                                   psk=args.psk,
+                                                   max_bdevs=args.max_bdevs,
+                                                   dhchap_key=args.dhchap_key,
+                                                   dhchap_ctrlr_key=args.dhchap_ctrlr_key,
+                                                   allow_unrecognized_csi=args.allow_unrecognized_csi,
+                                                   wait_for_attach=args.wait_for_attach)
+        if isinstance(ret, list):
+            print_array(ret)
+        else:
+            print_dict(ret)
 
     p = subparsers.add_parser('bdev_nvme_attach_controller', help='Add bdevs with nvme backend')
     p.add_argument('-b', '--name', help="Name of the NVMe controller, prefix for each bdev name", required=True)
@@ -821,9 +949,19 @@ if __name__ == "__main__":
     p.add_argument('--dhchap-ctrlr-key', help='DH-HMAC-CHAP controller key name')
     p.add_argument('-U', '--allow-unrecognized-csi', help="""Allow attaching namespaces with unrecognized command set identifiers.
                    These will only support NVMe passthrough.""", action='store_true')
+    p.add_argument('--no-wait-for-attach', dest='wait_for_attach', action='store_false', default=None,
+                   help="""Return immediately instead of waiting for the controller to be attached.
+                   Use bdev_nvme_wait_for_attach to wait for it.""")
 
     p.set_defaults(func=bdev_nvme_attach_controller)
 
+    def bdev_nvme_wait_for_attach(args):
+        print_dict(rpc.bdev.bdev_nvme_wait_for_attach(args.client))
+
+    p = subparsers.add_parser('bdev_nvme_wait_for_attach',
+                              help='Wait for the controllers attached with --no-wait-for-attach')
+    p.set_defaults(func=bdev_nvme_wait_for_attach)
+
     def bdev_nvme_get_controllers(args):
         print_dict(rpc.nvme.bdev_nvme_get_controllers(args.client,
                                                       name=args.name))
@@ -990,7 +1128,7 @@ if __name__ == "__main__":
                               help="""Set multipath policy of the NVMe bdev""")
     p.add_argument('-b', '--name', help='Name of the NVMe bdev', required=True)
     p.add_argument('-p', '--policy', help='Multipath policy (active_passive or active_active)', required=True)
-    p.add_argument('-s', '--selector', help='Multipath selector (round_robin, queue_depth)')
+    p.add_argument('-s', '--selector', help='Multipath selector (round_robin, queue_depth, latency)')
     p.add_argument('-r', '--rr-min-io',
                    help='Number of IO to route to a path before switching to another for round-robin',
                    type=int)
@@ -1266,6 +1404,132 @@ if __name__ == "__main__":
     p.add_argument('name', help='pass through bdev name')
     p.set_defaults(func=bdev_passthru_delete)
 
+    def bdev_readahead_create(args):
+        print_json(rpc.bdev.bdev_readahead_create(args.client,
+                                                  base_bdev_name=args.base_bdev_name,
+                                                  name=args.name,
+                                                  uuid=args.uuid,
+                                                  readahead_size=args.readahead_size))
+
+    p = subparsers.add_parser('bdev_readahead_create', help='Add a readahead bdev on existing bdev')
+    p.add_argument('-b', '--base-bdev-name', help="Name of the existing bdev", required=True)
+    p.add_argument('-p', '--name', help="Name of the readahead bdev", required=True)
+    p.add_argument('-u', '--uuid', help="UUID of the bdev")
+    p.add_argument('-s', '--readahead-size', help="""Number of bytes to prefetch ahead of a sequential
+    read stream. Cannot exceed the iobuf large buffer size. Default: 128 KiB""", type=int)
+    p.set_defaults(func=bdev_readahead_create)
+
+    def bdev_readahead_delete(args):
+        rpc.bdev.bdev_readahead_delete(args.client,
+                                       name=args.name)
+
+    p = subparsers.add_parser('bdev_readahead_delete', help='Delete a readahead bdev')
+    p.add_argument('name', help='readahead bdev name')
+    p.set_defaults(func=bdev_readahead_delete)
+
+    def bdev_wbcache_create(args):
+        print_json(rpc.bdev.bdev_wbcache_create(args.client,
+                                                name=args.name,
+                                                base_bdev_name=args.base_bdev_name,
+                                                cache_bdev_name=args.cache_bdev_name,
+                                                uuid=args.uuid,
+                                                segment_size=args.segment_size))
+
+    p = subparsers.add_parser('bdev_wbcache_create', help='Add a write-back cache bdev on existing bdevs')
+    p.add_argument('-b', '--base-bdev-name', help="Name of the existing bdev holding the data", required=True)
+    p.add_argument('-c', '--cache-bdev-name', help="Name of the existing bdev writes are staged on", required=True)
+    p.add_argument('-p', '--name', help="Name of the write-back cache bdev", required=True)
+    p.add_argument('-u', '--uuid', help="UUID of the bdev")
+    p.add_argument('-s', '--segment-size', help="""Size of a cache log segment in bytes. The cache
+    bdev must hold at least two segments. Default: 4 MiB""", type=int)
+    p.set_defaults(func=bdev_wbcache_create)
+
+    def bdev_wbcache_delete(args):
+        rpc.bdev.bdev_wbcache_delete(args.client,
+                                     name=args.name)
+
+    p = subparsers.add_parser('bdev_wbcache_delete', help='Delete a write-back cache bdev')
+    p.add_argument('name', help='write-back cache bdev name')
+    p.set_defaults(func=bdev_wbcache_delete)
+
+    def bdev_tier_create(args):
+        print_json(rpc.bdev.bdev_tier_create(args.client,
+                                             name=args.name,
+                                             fast_bdev_name=args.fast_bdev_name,
+                                             capacity_bdev_name=args.capacity_bdev_name,
+                                             uuid=args.uuid,
+                                             extent_size=args.extent_size))
+
+    p = subparsers.add_parser('bdev_tier_create', help='Add a tiering bdev on existing bdevs')
+    p.add_argument('-f', '--fast-bdev-name', help="Name of the existing bdev hot extents are moved to", required=True)
+    p.add_argument('-c', '--capacity-bdev-name', help="Name of the existing bdev holding the cold extents", required=True)
+    p.add_argument('-p', '--name', help="Name of the tiering bdev", required=True)
+    p.add_argument('-u', '--uuid', help="UUID of the bdev")
+    p.add_argument('-e', '--extent-size', help="""Size of an extent, the unit moved between the bdevs,
+    in bytes. Must match the size the fast bdev was formatted with. Default: 1 MiB""", type=int)
+    p.set_defaults(func=bdev_tier_create)
+
+    def bdev_tier_delete(args):
+        rpc.bdev.bdev_tier_delete(args.client,
+                                  name=args.name)
+
+    p = subparsers.add_parser('bdev_tier_delete', help='Delete a tiering bdev')
+    p.add_argument('name', help='tiering bdev name')
+    p.set_defaults(func=bdev_tier_delete)
+
+    def bdev_dedup_create(args):
+        print_json(rpc.bdev.bdev_dedup_create(args.client,
+                                              name=args.name,
+                                              base_bdev_name=args.base_bdev_name,
+                                              uuid=args.uuid,
+                                              chunk_size=args.chunk_size,
+                                              num_blocks=args.num_blocks))
+
+    p = subparsers.add_parser('bdev_dedup_create', help='Add a deduplicating bdev on an existing bdev')
+    p.add_argument('-b', '--base-bdev-name', help="Name of the existing bdev storing the unique chunks", required=True)
+    p.add_argument('-p', '--name', help="Name of the deduplicating bdev", required=True)
+    p.add_argument('-u', '--uuid', help="UUID of the bdev")
+    p.add_argument('-c', '--chunk-size', help="""Size of a chunk, the unit data is deduplicated in,
+    in bytes. Must match the size the base bdev was formatted with. Default: 4096""", type=int)
+    p.add_argument('-n', '--num-blocks', help="""Size of the bdev in blocks, which may exceed the
+    size of the base bdev. Default: the size of the base bdev""", type=int)
+    p.set_defaults(func=bdev_dedup_create)
+
+    def bdev_dedup_delete(args):
+        rpc.bdev.bdev_dedup_delete(args.client,
+                                   name=args.name)
+
+    p = subparsers.add_parser('bdev_dedup_delete', help='Delete a deduplicating bdev')
+    p.add_argument('name', help='deduplicating bdev name')
+    p.set_defaults(func=bdev_dedup_delete)
+
+    def bdev_replica_create(args):
+        print_json(rpc.bdev.bdev_replica_create(args.client,
+                                                name=args.name,
+                                                base_bdev_name=args.base_bdev_name,
+                                                journal_bdev_name=args.journal_bdev_name,
+                                                remote_bdev_name=args.remote_bdev_name,
+                                                uuid=args.uuid,
+                                                batch_size=args.batch_size))
+
+    p = subparsers.add_parser('bdev_replica_create', help='Add a bdev replicating its writes asynchronously to a remote bdev')
+    p.add_argument('-b', '--base-bdev-name', help="Name of the existing bdev holding the local copy of the data", required=True)
+    p.add_argument('-j', '--journal-bdev-name', help="Name of the existing bdev holding the journal of the writes", required=True)
+    p.add_argument('-r', '--remote-bdev-name', help="Name of the existing bdev the writes are replicated to", required=True)
+    p.add_argument('-p', '--name', help="Name of the replicated bdev", required=True)
+    p.add_argument('-u', '--uuid', help="UUID of the bdev")
+    p.add_argument('-s', '--batch-size', help="""Largest amount of data shipped to the remote bdev
+    at once, in bytes. Also limits the size of the writes. Default: 1 MiB""", type=int)
+    p.set_defaults(func=bdev_replica_create)
+
+    def bdev_replica_delete(args):
+        rpc.bdev.bdev_replica_delete(args.client,
+                                     name=args.name)
+
+    p = subparsers.add_parser('bdev_replica_delete', help='Delete a replicated bdev')
+    p.add_argument('name', help='replicated bdev name')
+    p.set_defaults(func=bdev_replica_delete)
+
     def bdev_get_bdevs(args):
         print_dict(rpc.bdev.bdev_get_bdevs(args.client,
                                            name=args.name, timeout=args.timeout_ms))
@@ -1322,6 +1586,40 @@ if __name__ == "__main__":
     p.add_argument('name', help='bdev name')
     p.set_defaults(func=bdev_get_histogram)
 
+    def bdev_enable_heatmap(args):
+        rpc.bdev.bdev_enable_heatmap(args.client, name=args.name, enable=args.enable,
+                                     num_regions=args.num_regions, opc=args.opc)
+
+    p = subparsers.add_parser('bdev_enable_heatmap',
+                              help='Enable or disable I/O heatmap for specified bdev')
+    p.add_argument('-e', '--enable', default=True, dest='enable', action='store_true', help='Enable heatmap on specified device')
+    p.add_argument('-d', '--disable', dest='enable', action='store_false', help='Disable heatmap on specified device')
+    p.add_argument('-r', '--num-regions', help='Number of LBA regions the bdev is divided into. Default: 64', type=int)
+    p.add_argument('-o', '--opc', help='Collect heatmap for specified io type. Defaults to all io types addressing blocks'
+                   ' if not specified. Refer to bdev_get_bdevs RPC for the list of io types.')
+    p.add_argument('name', help='bdev name')
+    p.set_defaults(func=bdev_enable_heatmap)
+
+    def bdev_get_heatmap(args):
+        print_dict(rpc.bdev.bdev_get_heatmap(args.client, name=args.name))
+
+    p = subparsers.add_parser('bdev_get_heatmap',
+                              help='Get I/O heatmap for specified bdev')
+    p.add_argument('name', help='bdev name')
+    p.set_defaults(func=bdev_get_heatmap)
+
+    def bdev_set_coalescing(args):
+        rpc.bdev.bdev_set_coalescing(args.client, name=args.name, window_us=args.window_us,
+                                     max_size_kb=args.max_size_kb)
+
+    p = subparsers.add_parser('bdev_set_coalescing',
+                              help='Set the window in which contiguous I/O of a bdev are merged')
+    p.add_argument('-w', '--window-us', help='Maximum time an I/O is held to be merged, 0 disables coalescing',
+                   type=int, required=True)
+    p.add_argument('-m', '--max-size-kb', help='Maximum size of a merged I/O in KiB. Default: 128', type=int)
+    p.add_argument('name', help='bdev name')
+    p.set_defaults(func=bdev_set_coalescing)
+
     def bdev_set_qd_sampling_period(args):
         rpc.bdev.bdev_set_qd_sampling_period(args.client,
                                              name=args.name,
@@ -1435,7 +1733,9 @@ if __name__ == "__main__":
             max_r2t_per_connection=args.max_r2t_per_connection,
             pdu_pool_size=args.pdu_pool_size,
             immediate_data_pool_size=args.immediate_data_pool_size,
-            data_out_pool_size=args.data_out_pool_size)
+            data_out_pool_size=args.data_out_pool_size,
+            spread_connections=args.spread_connections,
+            max_outstanding_r2t=args.max_outstanding_r2t)
 
     p = subparsers.add_parser('iscsi_set_options',
                               help="""Set options of iSCSI subsystem""")
@@ -1464,6 +1764,10 @@ if __name__ == "__main__":
     p.add_argument('-u', '--pdu-pool-size', help='Number of PDUs in the pool', type=int)
     p.add_argument('-j', '--immediate-data-pool-size', help='Number of immediate data buffers in the pool', type=int)
     p.add_argument('-z', '--data-out-pool-size', help='Number of data out buffers in the pool', type=int)
+    p.add_argument('--spread-connections', help="""Schedule each connection to the least loaded poll group,
+    spreading connections of a session across poll groups, instead of all connections of a target to one poll group""",
+                   action='store_true')
+    p.add_argument('--max-outstanding-r2t', help='Negotiated parameter, MaxOutstandingR2T.', type=int)
     p.set_defaults(func=iscsi_set_options)
 
     def iscsi_set_discovery_auth(args):
@@ -2190,6 +2494,18 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('name', help='lvol bdev name')
     p.set_defaults(func=bdev_lvol_set_read_only)
 
+    def bdev_lvol_set_esnap_copy_on_read(args):
+        rpc.lvol.bdev_lvol_set_esnap_copy_on_read(args.client,
+                                                  name=args.name,
+                                                  clusters_per_sec=args.clusters_per_sec)
+
+    p = subparsers.add_parser('bdev_lvol_set_esnap_copy_on_read',
+                              help='Copy clusters of an esnap clone lvol bdev on first read')
+    p.add_argument('name', help='lvol bdev name')
+    p.add_argument('clusters_per_sec', help='largest number of clusters copied per second, 0 to disable',
+                   type=int)
+    p.set_defaults(func=bdev_lvol_set_esnap_copy_on_read)
+
     def bdev_lvol_delete(args):
         rpc.lvol.bdev_lvol_delete(args.client,
                                   name=args.name)
@@ -2271,7 +2587,9 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     def bdev_raid_set_options(args):
         rpc.bdev.bdev_raid_set_options(args.client,
                                        process_window_size_kb=args.process_window_size_kb,
-                                       process_max_bandwidth_mb_sec=args.process_max_bandwidth_mb_sec)
+                                       process_max_bandwidth_mb_sec=args.process_max_bandwidth_mb_sec,
+                                       process_max_latency_us=args.process_max_latency_us,
+                                       write_intent_region_size_kb=args.write_intent_region_size_kb)
 
     p = subparsers.add_parser('bdev_raid_set_options',
                               help='Set options for bdev raid.')
@@ -2279,6 +2597,10 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                    help="Background process (e.g. rebuild) window size in KiB")
     p.add_argument('-b', '--process-max-bandwidth-mb-sec', type=int,
                    help="Background process (e.g. rebuild) maximum bandwidth in MiB/Sec")
+    p.add_argument('-l', '--process-max-latency-us', type=int,
+                   help="Target p99 latency of foreground I/O in microseconds, background process is slowed down when exceeded")
+    p.add_argument('-r', '--write-intent-region-size-kb', type=int,
+                   help="Write intent bitmap region size in KiB, 0 to disable")
 
     p.set_defaults(func=bdev_raid_set_options)
 
@@ -2345,7 +2667,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
         print_array(rpc.bdev.bdev_split_create(args.client,
                                                base_bdev=args.base_bdev,
                                                split_count=args.split_count,
-                                               split_size_mb=args.split_size_mb))
+                                               split_size_mb=args.split_size_mb,
+                                               redirect_io=args.redirect_io))
 
     p = subparsers.add_parser('bdev_split_create',
                               help="""Add given disk name to split config. If bdev with base_name
@@ -2353,6 +2676,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     available (during examination process).""")
     p.add_argument('base_bdev', help='base bdev name')
     p.add_argument('-s', '--split-size-mb', help='size in MiB for each bdev', type=int)
+    p.add_argument('-r', '--redirect-io', help="""Remap I/Os in place and submit them to the base bdev
+    instead of submitting new I/Os. Such I/Os can't be aborted through the split bdevs.""", action='store_true')
     p.add_argument('split_count', help="""Optional - number of split bdevs to create. Total size * split_count must not
     exceed the base bdev size.""", type=int)
     p.set_defaults(func=bdev_split_create)
@@ -2375,7 +2700,11 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                             overprovisioning=args.overprovisioning,
                                             l2p_dram_limit=args.l2p_dram_limit,
                                             core_mask=args.core_mask,
-                                            fast_shutdown=args.fast_shutdown))
+                                            fast_shutdown=args.fast_shutdown,
+                                            hot_cold_streams=args.hot_cold_streams,
+                                            l2p_scan_resistant=args.l2p_scan_resistant,
+                                            nv_cache_compaction_chunks=args.nv_cache_compaction_chunks,
+                                            fdp_placement_handles=args.fdp_placement_handles))
 
     p = subparsers.add_parser('bdev_ftl_create', help='Add FTL bdev')
     p.add_argument('-b', '--name', help="Name of the bdev", required=True)
@@ -2392,6 +2721,14 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('--core-mask', help='CPU core mask - which cores will be used for ftl core thread, '
                    'by default core thread will be set to the main application core (optional)')
     p.add_argument('-f', '--fast-shutdown', help="Enable fast shutdown", action='store_true')
+    p.add_argument('--hot-cold-streams', help="Write frequently and rarely updated data to separate bands",
+                   action='store_true')
+    p.add_argument('--l2p-scan-resistant', help="Evict L2P pages used only once before the ones used repeatedly",
+                   action='store_true')
+    p.add_argument('--nv-cache-compaction-chunks', help='Maximum number of NV cache chunks compacted in parallel '
+                   '(optional); default 2', type=int)
+    p.add_argument('--fdp-placement-handles', help='Number of FDP placement handles of the base bdev to spread '
+                   'user and relocated data across (optional); default 0, disabled', type=int)
     p.set_defaults(func=bdev_ftl_create)
 
     def bdev_ftl_load(args):
@@ -2403,7 +2740,11 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                           overprovisioning=args.overprovisioning,
                                           l2p_dram_limit=args.l2p_dram_limit,
                                           core_mask=args.core_mask,
-                                          fast_shutdown=args.fast_shutdown))
+                                          fast_shutdown=args.fast_shutdown,
+                                          hot_cold_streams=args.hot_cold_streams,
+                                          l2p_scan_resistant=args.l2p_scan_resistant,
+                                          nv_cache_compaction_chunks=args.nv_cache_compaction_chunks,
+                                          fdp_placement_handles=args.fdp_placement_handles))
 
     p = subparsers.add_parser('bdev_ftl_load', help='Load FTL bdev')
     p.add_argument('-b', '--name', help="Name of the bdev", required=True)
@@ -2419,6 +2760,14 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('--core-mask', help='CPU core mask - which cores will be used for ftl core thread, '
                    'by default core thread will be set to the main application core (optional)')
     p.add_argument('-f', '--fast-shutdown', help="Enable fast shutdown", action='store_true')
+    p.add_argument('--hot-cold-streams', help="Write frequently and rarely updated data to separate bands",
+                   action='store_true')
+    p.add_argument('--l2p-scan-resistant', help="Evict L2P pages used only once before the ones used repeatedly",
+                   action='store_true')
+    p.add_argument('--nv-cache-compaction-chunks', help='Maximum number of NV cache chunks compacted in parallel '
+                   '(optional); default 2', type=int)
+    p.add_argument('--fdp-placement-handles', help='Number of FDP placement handles of the base bdev to spread '
+                   'user and relocated data across (optional); default 0, disabled', type=int)
     p.set_defaults(func=bdev_ftl_load)
 
     def bdev_ftl_unload(args):
@@ -2558,12 +2907,15 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     def nbd_start_disk(args):
         print(rpc.nbd.nbd_start_disk(args.client,
                                      bdev_name=args.bdev_name,
-                                     nbd_device=args.nbd_device))
+                                     nbd_device=args.nbd_device,
+                                     num_connections=args.num_connections))
 
     p = subparsers.add_parser('nbd_start_disk',
                               help='Export a bdev as an nbd disk')
     p.add_argument('bdev_name', help='Blockdev name to be exported. Example: Malloc0.')
     p.add_argument('nbd_device', help='Nbd device name to be assigned. Example: /dev/nbd0.', nargs='?')
+    p.add_argument('-c', '--num-connections', type=int,
+                   help='Number of connections, each served by its own thread. Default: 1.')
     p.set_defaults(func=nbd_start_disk)
 
     def nbd_stop_disk(args):
@@ -2630,6 +2982,12 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-b', '--buf-cache-size', help='The number of shared buffers to reserve for each poll group', type=int)
     p.add_argument('-z', '--zcopy', action='store_true', help='''Use zero-copy operations if the
     underlying bdev supports them''')
+    p.add_argument('--host-io-stats', action='store_true', help='''Track the size of host to controller
+    transfers of each host''')
+    p.add_argument('--host-max-iops', help='''I/O commands admitted per second from each host, the
+    commands above it are completed with a retryable Namespace Not Ready status. 0 for no limit''', type=int)
+    p.add_argument('--host-max-burst', help='''I/O commands a host can submit at once above
+    host_max_iops. Defaults to a tenth of it''', type=int)
     p.add_argument('-d', '--num-cqe', help="""The number of CQ entries. Only used when no_srq=true.
     Relevant only for RDMA transport""", type=int)
     p.add_argument('-s', '--max-srq-depth', help='Max number of outstanding I/O per SRQ. Relevant only for RDMA transport', type=int)
@@ -2642,6 +3000,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-w', '--no-wr-batching', action='store_true', help='Disable work requests batching. Relevant only for RDMA transport')
     p.add_argument('-e', '--control-msg-num', help="""The number of control messages per poll group.
     Relevant only for TCP transport""", type=int)
+    p.add_argument('--poll-group-load-balance', action='store_true', help="""Place new qpairs on the least loaded poll group.
+    Relevant only for TCP transport""")
     p.add_argument('-M', '--disable-mappable-bar0', action='store_true', help="""Disable mmap() of BAR0.
     Relevant only for VFIO-USER transport""")
     p.add_argument('-I', '--disable-adaptive-irq', action='store_true', help="""Disable adaptive interrupt feature.
@@ -2651,6 +3011,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('--acceptor-poll-rate', help='Polling interval of the acceptor for incoming connections (usec)', type=int)
     p.add_argument('--ack-timeout', help='ACK timeout in milliseconds', type=int)
     p.add_argument('--data-wr-pool-size', help='RDMA data WR pool size. Relevant only for RDMA transport', type=int)
+    p.add_argument('--srq-lazy-alloc', action='store_true', help="""Allocate SRQ resources of a poll group only when
+    its first qpair on the device connects. Relevant only for RDMA transport""")
     p.add_argument('--disable-command-passthru', help='Disallow command passthru', action='store_true')
     p.set_defaults(func=nvmf_create_transport)
 
@@ -2662,6 +3024,15 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-t', '--tgt-name', help='The name of the parent NVMe-oF target (optional)', type=str)
     p.set_defaults(func=nvmf_get_transports)
 
+    def nvmf_get_host_io_stats(args):
+        print_dict(rpc.nvmf.nvmf_get_host_io_stats(args.client, trtype=args.trtype, tgt_name=args.tgt_name))
+
+    p = subparsers.add_parser('nvmf_get_host_io_stats',
+                              help='Display the size histogram of host to controller transfers of each host')
+    p.add_argument('--trtype', help='Transport type (optional)')
+    p.add_argument('-t', '--tgt-name', help='The name of the parent NVMe-oF target (optional)', type=str)
+    p.set_defaults(func=nvmf_get_host_io_stats)
+
     def nvmf_get_subsystems(args):
         print_dict(rpc.nvmf.nvmf_get_subsystems(args.client, nqn=args.nqn, tgt_name=args.tgt_name))
 
@@ -2832,6 +3203,19 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                    help='Enable hide_metadata option to the bdev (optional)')
     p.set_defaults(func=nvmf_subsystem_add_ns)
 
+    def nvmf_subsystem_add_ns_bulk(args):
+        print_dict(rpc.nvmf.nvmf_subsystem_add_ns_bulk(args.client,
+                                                       nqn=args.nqn,
+                                                       namespaces=[{'bdev_name': b} for b in args.bdev_names],
+                                                       tgt_name=args.tgt_name))
+
+    p = subparsers.add_parser('nvmf_subsystem_add_ns_bulk',
+                              help='Add multiple namespaces to an NVMe-oF subsystem in one request')
+    p.add_argument('nqn', help='NVMe-oF subsystem NQN')
+    p.add_argument('bdev_names', nargs='+', help='The names of the bdevs that will back the namespaces')
+    p.add_argument('-t', '--tgt-name', help='The name of the parent NVMe-oF target (optional)', type=str)
+    p.set_defaults(func=nvmf_subsystem_add_ns_bulk)
+
     def nvmf_subsystem_set_ns_ana_group(args):
         rpc.nvmf.nvmf_subsystem_set_ns_ana_group(args.client,
                                                  nqn=args.nqn,
@@ -3113,6 +3497,10 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('--transport', help='virtio blk transport name (default: vhost_user_blk)')
     p.add_argument("-r", "--readonly", action='store_true', help='Set controller as read-only')
     p.add_argument("-p", "--packed_ring", action='store_true', help='Set controller as packed ring supported')
+    p.add_argument("--event-idx", dest='event_idx', action='store_true',
+                   help='Offer VIRTIO_RING_F_EVENT_IDX to let the guest suppress notifications')
+    p.add_argument("--vq-threads", dest='vq_threads', type=int,
+                   help='Number of threads to spread the virtqueues across (default: 1)')
     p.set_defaults(func=vhost_create_blk_controller)
 
     def vhost_get_controllers(args):
@@ -3335,7 +3723,9 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
 
     def accel_set_options(args):
         rpc.accel.accel_set_options(args.client, args.small_cache_size, args.large_cache_size,
-                                    args.task_count, args.sequence_count, args.buf_count)
+                                    args.task_count, args.sequence_count, args.buf_count,
+                                    args.sw_worker_count, args.sw_offload_min_size,
+                                    args.hw_queue_depth)
 
     p = subparsers.add_parser('accel_set_options', help='Set accel framework\'s options')
     p.add_argument('--small-cache-size', type=int, help='Size of the small iobuf cache')
@@ -3343,6 +3733,13 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('--task-count', type=int, help='Maximum number of tasks per IO channel')
     p.add_argument('--sequence-count', type=int, help='Maximum number of sequences per IO channel')
     p.add_argument('--buf-count', type=int, help='Maximum number of buffers per IO channel')
+    p.add_argument('--sw-worker-count', type=int,
+                   help='Number of threads executing the software module\'s CPU-heavy operations')
+    p.add_argument('--sw-offload-min-size', type=int,
+                   help='Minimum size in bytes of an operation handed to a software module\'s worker')
+    p.add_argument('--hw-queue-depth', type=int,
+                   help='Operations of an opcode per IO channel outstanding on a hardware module, '
+                   'before they overflow to the software module (0: no limit)')
     p.set_defaults(func=accel_set_options)
 
     def accel_get_stats(args):
@@ -3369,12 +3766,18 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
 
     # dsa
     def dsa_scan_accel_module(args):
-        rpc.dsa.dsa_scan_accel_module(args.client, config_kernel_mode=args.config_kernel_mode)
+        rpc.dsa.dsa_scan_accel_module(args.client, config_kernel_mode=args.config_kernel_mode,
+                                      max_batch_size=args.max_batch_size,
+                                      batch_latency_us=args.batch_latency_us)
 
     p = subparsers.add_parser('dsa_scan_accel_module', aliases=['dsa_scan_accel_engine'],
                               help='Set config and enable dsa accel module offload.')
     p.add_argument('-k', '--config-kernel-mode', help='Use Kernel mode dsa',
                    action='store_true', dest='config_kernel_mode')
+    p.add_argument('-b', '--max-batch-size', help='Number of descriptors after which a batch is submitted',
+                   type=int)
+    p.add_argument('-l', '--batch-latency-us', help='Maximum time in microseconds a batch is held before submission',
+                   type=int)
     p.set_defaults(func=dsa_scan_accel_module, config_kernel_mode=None)
 
     # iaa
@@ -3573,12 +3976,17 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     def notify_get_notifications(args):
         ret = rpc.notify.notify_get_notifications(args.client,
                                                   id=args.id,
-                                                  max=args.max)
+                                                  max=args.max,
+                                                  types=args.types,
+                                                  timeout_ms=args.timeout_ms)
         print_dict(ret)
 
     p = subparsers.add_parser('notify_get_notifications', help='Get notifications')
     p.add_argument('-i', '--id', help="""First ID to start fetching from""", type=int)
     p.add_argument('-n', '--max', help="""Maximum number of notifications to return in response""", type=int)
+    p.add_argument('-t', '--types', help="""Only return notifications of these types""", nargs='+')
+    p.add_argument('-w', '--timeout-ms', help="""Wait up to this many milliseconds for a notification
+    if there is none yet""", type=int)
     p.set_defaults(func=notify_get_notifications)
 
     def thread_get_stats(args):
@@ -3609,10 +4017,12 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.set_defaults(func=log_enable_timestamps)
 
     def thread_get_pollers(args):
-        print_dict(rpc.app.thread_get_pollers(args.client))
+        print_dict(rpc.app.thread_get_pollers(args.client, generation=args.generation))
 
     p = subparsers.add_parser(
         'thread_get_pollers', help='Display current pollers of all the threads')
+    p.add_argument('-g', '--generation', help="""Only display the pollers that changed since this
+    report generation, as returned by a previous call""", type=int)
     p.set_defaults(func=thread_get_pollers)
 
     def thread_get_io_channels(args):
@@ -3686,7 +4096,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     def fsdev_aio_create(args):
         print(rpc.fsdev.fsdev_aio_create(args.client, name=args.name, root_path=args.root_path,
                                          enable_xattr=args.enable_xattr, enable_writeback_cache=args.enable_writeback_cache,
-                                         max_write=args.max_write, skip_rw=args.skip_rw))
+                                         max_write=args.max_write, skip_rw=args.skip_rw,
+                                         attr_valid_ms=args.attr_valid_ms, readahead_size=args.readahead_size))
 
     p = subparsers.add_parser('fsdev_aio_create', help='Create a aio filesystem')
     p.add_argument('name', help='Filesystem name. Example: aio0.')
@@ -3706,6 +4117,11 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('--skip-rw', dest='skip_rw', help="Do not process read or write commands. This is used for testing.",
                    action='store_true', default=None)
 
+    p.add_argument('--attr-valid-ms', dest='attr_valid_ms', type=int,
+                   help="Time in ms the attributes and name lookups may be cached by the fsdev user. Default: 0")
+    p.add_argument('--readahead-size', dest='readahead_size', type=int,
+                   help="Size in bytes to read ahead of sequential reads into the host page cache. Default: 0 (disabled)")
+
     p.set_defaults(func=fsdev_aio_create)
 
     def fsdev_aio_delete(args):
@@ -3736,7 +4152,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        enable_zerocopy_send_client=args.enable_zerocopy_send_client,
                                        zerocopy_threshold=args.zerocopy_threshold,
                                        tls_version=args.tls_version,
-                                       enable_ktls=args.enable_ktls)
+                                       enable_ktls=args.enable_ktls,
+                                       busy_poll_usecs=args.busy_poll_usecs)
 
     p = subparsers.add_parser('sock_impl_set_options', help="""Set options of socket layer implementation""")
     p.add_argument('-i', '--impl', help='Socket implementation name, e.g. posix', required=True)
@@ -3765,9 +4182,10 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                    action='store_true', dest='enable_ktls')
     p.add_argument('--disable-ktls', help='Disable Kernel TLS',
                    action='store_false', dest='enable_ktls')
+    p.add_argument('--busy-poll-usecs', help='Busy poll timeout in microseconds, 0 to disable', type=int)
     p.set_defaults(func=sock_impl_set_options, enable_recv_pipe=None, enable_quickack=None,
                    enable_placement_id=None, enable_zerocopy_send_server=None, enable_zerocopy_send_client=None,
-                   zerocopy_threshold=None, tls_version=None, enable_ktls=None)
+                   zerocopy_threshold=None, tls_version=None, enable_ktls=None, busy_poll_usecs=None)
 
     def sock_set_default_impl(args):
         print_json(rpc.sock.sock_set_default_impl(args.client,
@@ -3883,18 +4301,30 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.set_defaults(func=bdev_daos_resize)
 
     def iobuf_set_options(args):
+        size_classes = None
+        if args.size_classes is not None:
+            size_classes = []
+            for size_class in args.size_classes.split(','):
+                bufsize, pool_count = size_class.split(':')
+                size_classes.append({'bufsize': int(bufsize), 'pool_count': int(pool_count)})
         rpc.iobuf.iobuf_set_options(args.client,
                                     small_pool_count=args.small_pool_count,
                                     large_pool_count=args.large_pool_count,
                                     small_bufsize=args.small_bufsize,
                                     large_bufsize=args.large_bufsize,
-                                    enable_numa=args.enable_numa)
+                                    enable_numa=args.enable_numa,
+                                    size_classes=size_classes,
+                                    enable_steal=args.enable_steal)
     p = subparsers.add_parser('iobuf_set_options', help='Set iobuf pool options')
     p.add_argument('--small-pool-count', help='number of small buffers in the global pool', type=int)
     p.add_argument('--large-pool-count', help='number of large buffers in the global pool', type=int)
     p.add_argument('--small-bufsize', help='size of a small buffer', type=int)
     p.add_argument('--large-bufsize', help='size of a large buffer', type=int)
     p.add_argument('--enable-numa', help='enable per-NUMA node buffer pools', action='store_true')
+    p.add_argument('--size-classes', help="""comma separated list of additional buffer size classes, as bufsize:pool_count,
+    e.g. 32768:1024,65536:512""")
+    p.add_argument('--enable-steal', help="let channels short of buffers take them from other channels' caches",
+                   action='store_true')
     p.set_defaults(func=iobuf_set_options)
 
     def iobuf_get_stats(args):
@@ -0,0 +1,393 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk/base64.h"
+#include "spdk/bit_array.h"
+#include "spdk/config.h"
+#include "spdk/crc16.h"
+#include "spdk/crc32.h"
+#include "spdk/crc64.h"
+#include "spdk/dif.h"
+#include "spdk/env.h"
+#include "spdk/json.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+#include "spdk/xor.h"
+
+/*
+ * This application measures the throughput of the hot lib/util kernels over a range of buffer
+ *  sizes and alignments, and prints the results as JSON so that they can be compared between
+ *  builds (e.g. with and without ISA-L) and CPUs.
+ *
+ * Throughput is reported in bytes of input per tick of spdk_get_ticks() and in GB/s.
+ */
+
+#define UTIL_PERF_MAX_SIZE	(1024 * 1024)
+#define UTIL_PERF_BUF_ALIGN	64
+#define UTIL_PERF_XOR_SRCS	4
+#define UTIL_PERF_DIF_BLOCK	(512 + 8)
+/* Runs between two reads of the tick counter, so that small sizes aren't dominated by it */
+#define UTIL_PERF_BATCH_BYTES	(64 * 1024)
+
+static const uint32_t g_sizes[] = { 64, 512, 4096, 64 * 1024, UTIL_PERF_MAX_SIZE };
+static const uint32_t g_aligns[] = { 0, 1 };
+
+struct util_perf_ctx {
+	uint8_t			*src;
+	uint8_t			*dst;
+	void			*xor_srcs[UTIL_PERF_XOR_SRCS];
+	char			*text;
+	struct spdk_bit_array	*bits;
+	struct spdk_dif_ctx	dif_ctx;
+	uint32_t		size;
+};
+
+struct util_perf_kernel {
+	const char	*name;
+	/* Prepares ctx for the given size, returns the number of input bytes per run or 0 to skip */
+	uint64_t(*setup)(struct util_perf_ctx *ctx);
+	void (*run)(struct util_perf_ctx *ctx);
+};
+
+static uint64_t
+setup_plain(struct util_perf_ctx *ctx)
+{
+	return ctx->size;
+}
+
+static void
+run_crc16(struct util_perf_ctx *ctx)
+{
+	spdk_crc16_t10dif(0, ctx->src, ctx->size);
+}
+
+static void
+run_crc32_ieee(struct util_perf_ctx *ctx)
+{
+	spdk_crc32_ieee_update(ctx->src, ctx->size, ~0u);
+}
+
+static void
+run_crc32c(struct util_perf_ctx *ctx)
+{
+	spdk_crc32c_update(ctx->src, ctx->size, ~0u);
+}
+
+static void
+run_crc64(struct util_perf_ctx *ctx)
+{
+	spdk_crc64_nvme(ctx->src, ctx->size, 0);
+}
+
+static uint64_t
+setup_xor(struct util_perf_ctx *ctx)
+{
+	return (uint64_t)ctx->size * UTIL_PERF_XOR_SRCS;
+}
+
+static void
+run_xor(struct util_perf_ctx *ctx)
+{
+	spdk_xor_gen(ctx->dst, ctx->xor_srcs, UTIL_PERF_XOR_SRCS, ctx->size);
+}
+
+static uint64_t
+setup_dif(struct util_perf_ctx *ctx)
+{
+	struct spdk_dif_ctx_init_ext_opts dif_opts;
+	int rc;
+
+	if (ctx->size < UTIL_PERF_DIF_BLOCK) {
+		return 0;
+	}
+
+	dif_opts.size = SPDK_SIZEOF(&dif_opts, dif_pi_format);
+	dif_opts.dif_pi_format = SPDK_DIF_PI_FORMAT_16;
+	rc = spdk_dif_ctx_init(&ctx->dif_ctx, UTIL_PERF_DIF_BLOCK, 8, true, false, SPDK_DIF_TYPE1,
+			       SPDK_DIF_FLAGS_GUARD_CHECK | SPDK_DIF_FLAGS_REFTAG_CHECK,
+			       0, 0, 0, 0, 0, &dif_opts);
+	if (rc != 0) {
+		return 0;
+	}
+
+	return ctx->size / UTIL_PERF_DIF_BLOCK * UTIL_PERF_DIF_BLOCK;
+}
+
+static void
+run_dif_generate(struct util_perf_ctx *ctx)
+{
+	struct iovec iov = { .iov_base = ctx->dst, .iov_len = ctx->size };
+
+	spdk_dif_generate(&iov, 1, ctx->size / UTIL_PERF_DIF_BLOCK, &ctx->dif_ctx);
+}
+
+static void
+run_iovcpy(struct util_perf_ctx *ctx)
+{
+	/* Source and destination split at different offsets */
+	uint32_t s = ctx->size / 4, d = ctx->size / 3;
+	struct iovec siov[4] = {
+		{ ctx->src, s }, { ctx->src + s, s }, { ctx->src + 2 * s, s },
+		{ ctx->src + 3 * s, ctx->size - 3 * s }
+	};
+	struct iovec diov[3] = {
+		{ ctx->dst, d }, { ctx->dst + d, d }, { ctx->dst + 2 * d, ctx->size - 2 * d }
+	};
+
+	spdk_iovcpy(siov, SPDK_COUNTOF(siov), diov, SPDK_COUNTOF(diov));
+}
+
+static void
+run_base64_encode(struct util_perf_ctx *ctx)
+{
+	spdk_base64_encode(ctx->text, ctx->src, ctx->size);
+}
+
+static uint64_t
+setup_base64_decode(struct util_perf_ctx *ctx)
+{
+	if (spdk_base64_encode(ctx->text, ctx->src, ctx->size) != 0) {
+		return 0;
+	}
+
+	return strlen(ctx->text);
+}
+
+static void
+run_base64_decode(struct util_perf_ctx *ctx)
+{
+	size_t len;
+
+	spdk_base64_decode(ctx->dst, &len, ctx->text);
+}
+
+static uint64_t
+setup_bit_array(struct util_perf_ctx *ctx)
+{
+	/* Only the last bit is set, so every search scans the whole array */
+	spdk_bit_array_free(&ctx->bits);
+	ctx->bits = spdk_bit_array_create(ctx->size * 8);
+	if (ctx->bits == NULL) {
+		return 0;
+	}
+	spdk_bit_array_set(ctx->bits, ctx->size * 8 - 1);
+
+	return ctx->size;
+}
+
+static void
+run_bit_array_find(struct util_perf_ctx *ctx)
+{
+	spdk_bit_array_find_first_set(ctx->bits, 0);
+}
+
+static const struct util_perf_kernel g_kernels[] = {
+	{ "crc16_t10dif", setup_plain, run_crc16 },
+	{ "crc32_ieee", setup_plain, run_crc32_ieee },
+	{ "crc32c", setup_plain, run_crc32c },
+	{ "crc64_nvme", setup_plain, run_crc64 },
+	{ "xor_gen", setup_xor, run_xor },
+	{ "dif_generate", setup_dif, run_dif_generate },
+	{ "iovcpy", setup_plain, run_iovcpy },
+	{ "base64_encode", setup_plain, run_base64_encode },
+	{ "base64_decode", setup_base64_decode, run_base64_decode },
+	{ "bit_array_find", setup_bit_array, run_bit_array_find },
+};
+
+static int
+json_write_stdout(void *cb_ctx, const void *data, size_t size)
+{
+	return fwrite(data, 1, size, stdout) == size ? 0 : -1;
+}
+
+static void
+usage(const char *prog)
+{
+	uint32_t i;
+
+	printf("usage: %s [options]\n", prog);
+	printf("Options:\n");
+	printf(" -k <name>    run only the named kernel (can be repeated)\n");
+	printf(" -t <msec>    time to run each size and alignment for (default: 100)\n");
+	printf("Kernels:");
+	for (i = 0; i < SPDK_COUNTOF(g_kernels); i++) {
+		printf(" %s", g_kernels[i].name);
+	}
+	printf("\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	const struct util_perf_kernel *kernel;
+	struct spdk_json_write_ctx *w;
+	struct util_perf_ctx ctx = {};
+	struct spdk_env_opts opts;
+	uint8_t *src_base = NULL, *dst_base = NULL, *xor_base[UTIL_PERF_XOR_SRCS] = {};
+	const char *filter[SPDK_COUNTOF(g_kernels)];
+	uint64_t bytes, iterations, batch, b, start, ticks, run_ticks, hz;
+	uint32_t num_filters = 0, i, j, k, s, a;
+	long time_ms = 100;
+	int ch, rc = 1;
+
+	while ((ch = getopt(argc, argv, "hk:t:")) != -1) {
+		switch (ch) {
+		case 'k':
+			if (num_filters == SPDK_COUNTOF(filter)) {
+				usage(argv[0]);
+				return 1;
+			}
+			filter[num_filters++] = optarg;
+			break;
+		case 't':
+			time_ms = spdk_strtol(optarg, 10);
+			if (time_ms <= 0) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'h':
+			usage(argv[0]);
+			return 0;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	for (j = 0; j < num_filters; j++) {
+		for (i = 0; i < SPDK_COUNTOF(g_kernels); i++) {
+			if (strcmp(filter[j], g_kernels[i].name) == 0) {
+				break;
+			}
+		}
+		if (i == SPDK_COUNTOF(g_kernels)) {
+			fprintf(stderr, "Err: Unknown kernel %s\n", filter[j]);
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	opts.opts_size = sizeof(opts);
+	spdk_env_opts_init(&opts);
+	opts.name = "util_perf";
+	if (spdk_env_init(&opts)) {
+		fprintf(stderr, "Err: Unable to initialize SPDK env\n");
+		return 1;
+	}
+
+	/* Room for the largest size at the largest alignment offset */
+	src_base = aligned_alloc(UTIL_PERF_BUF_ALIGN, UTIL_PERF_MAX_SIZE + UTIL_PERF_BUF_ALIGN);
+	dst_base = aligned_alloc(UTIL_PERF_BUF_ALIGN, UTIL_PERF_MAX_SIZE + UTIL_PERF_BUF_ALIGN);
+	ctx.text = malloc(spdk_base64_get_encoded_strlen(UTIL_PERF_MAX_SIZE) + 1);
+	if (src_base == NULL || dst_base == NULL || ctx.text == NULL) {
+		fprintf(stderr, "Err: Unable to allocate buffers\n");
+		goto out;
+	}
+	for (k = 0; k < UTIL_PERF_XOR_SRCS; k++) {
+		xor_base[k] = aligned_alloc(UTIL_PERF_BUF_ALIGN, UTIL_PERF_MAX_SIZE + UTIL_PERF_BUF_ALIGN);
+		if (xor_base[k] == NULL) {
+			fprintf(stderr, "Err: Unable to allocate buffers\n");
+			goto out;
+		}
+		memset(xor_base[k], 0x5a + k, UTIL_PERF_MAX_SIZE + UTIL_PERF_BUF_ALIGN);
+	}
+	for (k = 0; k < UTIL_PERF_MAX_SIZE + UTIL_PERF_BUF_ALIGN; k++) {
+		src_base[k] = rand();
+	}
+	memset(dst_base, 0, UTIL_PERF_MAX_SIZE + UTIL_PERF_BUF_ALIGN);
+
+	hz = spdk_get_ticks_hz();
+	run_ticks = hz * time_ms / 1000;
+
+	w = spdk_json_write_begin(json_write_stdout, NULL, SPDK_JSON_WRITE_FLAG_FORMATTED);
+	if (w == NULL) {
+		goto out;
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_uint64(w, "tick_rate", hz);
+#ifdef SPDK_CONFIG_ISAL
+	spdk_json_write_named_bool(w, "isal", true);
+#else
+	spdk_json_write_named_bool(w, "isal", false);
+#endif
+	spdk_json_write_named_array_begin(w, "results");
+
+	for (i = 0; i < SPDK_COUNTOF(g_kernels); i++) {
+		kernel = &g_kernels[i];
+
+		if (num_filters != 0) {
+			for (j = 0; j < num_filters; j++) {
+				if (strcmp(filter[j], kernel->name) == 0) {
+					break;
+				}
+			}
+			if (j == num_filters) {
+				continue;
+			}
+		}
+
+		for (s = 0; s < SPDK_COUNTOF(g_sizes); s++) {
+			for (a = 0; a < SPDK_COUNTOF(g_aligns); a++) {
+				ctx.size = g_sizes[s];
+				ctx.src = src_base + g_aligns[a];
+				ctx.dst = dst_base + g_aligns[a];
+				for (k = 0; k < UTIL_PERF_XOR_SRCS; k++) {
+					ctx.xor_srcs[k] = xor_base[k] + g_aligns[a];
+				}
+
+				bytes = kernel->setup(&ctx);
+				if (bytes == 0) {
+					continue;
+				}
+
+				/* Warm up the caches first */
+				kernel->run(&ctx);
+
+				batch = spdk_max(UTIL_PERF_BATCH_BYTES / bytes, 1);
+				iterations = 0;
+				start = spdk_get_ticks();
+				do {
+					for (b = 0; b < batch; b++) {
+						kernel->run(&ctx);
+					}
+					iterations += batch;
+					ticks = spdk_get_ticks() - start;
+				} while (ticks < run_ticks);
+
+				spdk_json_write_object_begin(w);
+				spdk_json_write_named_string(w, "kernel", kernel->name);
+				spdk_json_write_named_uint32(w, "size", ctx.size);
+				spdk_json_write_named_uint32(w, "align", g_aligns[a]);
+				spdk_json_write_named_uint64(w, "iterations", iterations);
+				spdk_json_write_named_uint64(w, "ticks", ticks);
+				spdk_json_write_named_double(w, "bytes_per_tick", (double)bytes * iterations / ticks);
+				spdk_json_write_named_double(w, "gbps", (double)bytes * iterations * hz / ticks / 1e9);
+				spdk_json_write_object_end(w);
+			}
+		}
+	}
+
+	spdk_json_write_array_end(w);
+	spdk_json_write_object_end(w);
+	spdk_json_write_end(w);
+	printf("\n");
+	rc = 0;
+
+out:
+	spdk_bit_array_free(&ctx.bits);
+	for (k = 0; k < UTIL_PERF_XOR_SRCS; k++) {
+		free(xor_base[k]);
+	}
+	free(ctx.text);
+	free(dst_base);
+	free(src_base);
+
+	spdk_env_fini();
+	return rc;
+}
@@ -142,6 +142,57 @@ function nbd_with_lvol_verify() {
 	nbd_stop_disks $rpc_server "$nbd"
 }
 
+function nbd_multi_conn_verify() {
+	local rpc_server=$1
+	local nbd=$2
+	local tmp_file=$SPDK_TEST_STORAGE/nbdmulticonn
+	local dd_pids=()
+	local i
+
+	$rootdir/scripts/rpc.py -s $rpc_server bdev_malloc_create -b malloc_multi_conn 16 4096
+	$rootdir/scripts/rpc.py -s $rpc_server nbd_start_disk -c 4 malloc_multi_conn "$nbd"
+	waitfornbd $(basename $nbd)
+	nbd_disks_json=$($rootdir/scripts/rpc.py -s $rpc_server nbd_get_disks -n "$nbd")
+	[[ $(jq -r '.[0].num_connections' <<< "$nbd_disks_json") == 4 ]]
+
+	# Write from several processes at once, so that the kernel uses more than one connection
+	dd if=/dev/urandom of=$tmp_file bs=4096 count=256
+	for ((i = 0; i < 4; i++)); do
+		dd if=$tmp_file of="$nbd" bs=4096 count=64 skip=$((i * 64)) seek=$((i * 64)) oflag=direct &
+		dd_pids+=($!)
+	done
+	for i in "${dd_pids[@]}"; do
+		wait $i
+	done
+	cmp -b -n 1M $tmp_file "$nbd"
+	rm $tmp_file
+
+	nbd_stop_disks $rpc_server "$nbd"
+	if [ $(nbd_get_count $rpc_server) -ne 0 ]; then
+		return 1
+	fi
+
+	# Hot-remove the bdev with I/O in flight on the connections
+	$rootdir/scripts/rpc.py -s $rpc_server nbd_start_disk -c 4 malloc_multi_conn "$nbd"
+	waitfornbd $(basename $nbd)
+	dd_pids=()
+	for ((i = 0; i < 4; i++)); do
+		dd if=/dev/zero of="$nbd" bs=4096 count=1024 oflag=direct &> /dev/null &
+		dd_pids+=($!)
+	done
+	$rootdir/scripts/rpc.py -s $rpc_server bdev_malloc_delete malloc_multi_conn
+	waitfornbd_exit $(basename $nbd)
+	for i in "${dd_pids[@]}"; do
+		# The writes fail once the device goes away
+		wait $i || true
+	done
+	if [ $(nbd_get_count $rpc_server) -ne 0 ]; then
+		return 1
+	fi
+
+	return 0
+}
+
 function wait_for_nbd_set_capacity() {
 	local nbd=${1##*/}
 
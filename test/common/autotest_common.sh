@@ -483,6 +483,7 @@ function get_config_params() {
 
 	if [ $SPDK_TEST_RAID -eq 1 ]; then
 		config_params+=' --with-raid5f'
+		config_params+=' --with-raid6f'
 	fi
 
 	if [ $SPDK_TEST_VFIOUSER -eq 1 ] || [ $SPDK_TEST_VFIOUSER_QEMU -eq 1 ] || [ $SPDK_TEST_SMA -eq 1 ]; then
@@ -0,0 +1,488 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+/*
+ * In-memory base bdevs for the unit tests of the virtual bdev modules. The I/O sent to a disk
+ * is queued on g_ios and completed by ut_complete_ios() or ut_drain(), so the tests control
+ * the order of the completions.
+ *
+ * The including test defines, before including this file and after the module under test:
+ *  UT_BDEV_MODULE	the module expected by spdk_bdev_unregister_by_name()
+ *  UT_POLL_US		how long ut_drain() lets the time advance between the polls
+ *  UT_MODEL_BLOCKS	optional, the number of blocks of g_model checked by ut_check_data()
+ *  UT_BLOCK_SIZE	with UT_MODEL_BLOCKS, the block size of the bdev under test
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+
+#include "spdk/bdev_module.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+#include "spdk/uuid.h"
+
+struct ut_disk {
+	struct spdk_bdev		bdev;
+	uint8_t				*data;
+	/* Don't complete the I/O sent to this disk */
+	bool				hold;
+	/* Fail the next write sent to this disk */
+	bool				fail_write;
+};
+
+struct ut_io {
+	struct ut_disk			*disk;
+	enum spdk_bdev_io_type		type;
+	uint64_t			offset_blocks;
+	uint64_t			num_blocks;
+	struct iovec			iov;
+	struct iovec			*iovs;
+	int				iovcnt;
+	bool				fail;
+	bool				hold;
+	struct spdk_thread		*thread;
+	spdk_bdev_io_completion_cb	cb;
+	void				*cb_arg;
+	TAILQ_ENTRY(ut_io)		link;
+};
+
+static TAILQ_HEAD(ut_io_head, ut_io) g_ios = TAILQ_HEAD_INITIALIZER(g_ios);
+static TAILQ_HEAD(, spdk_bdev) g_bdev_list = TAILQ_HEAD_INITIALIZER(g_bdev_list);
+static struct spdk_thread *g_thread;
+/* Polled by ut_drain() too when the test creates it */
+static struct spdk_thread *g_thread2;
+static int g_base_io_device;
+static bool g_destruct_done;
+/* Number of I/O sent to the disks, reset by the tests */
+static uint32_t g_num_ios;
+
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB_V(spdk_bdev_module_examine_done, (struct spdk_bdev_module *module));
+DEFINE_STUB(spdk_json_write_name, int, (struct spdk_json_write_ctx *w, const char *name), 0);
+DEFINE_STUB(spdk_json_write_object_begin, int, (struct spdk_json_write_ctx *w), 0);
+DEFINE_STUB(spdk_json_write_named_string, int, (struct spdk_json_write_ctx *w,
+		const char *name, const char *val), 0);
+DEFINE_STUB(spdk_json_write_named_uint32, int, (struct spdk_json_write_ctx *w,
+		const char *name, uint32_t val), 0);
+DEFINE_STUB(spdk_json_write_named_uint64, int, (struct spdk_json_write_ctx *w,
+		const char *name, uint64_t val), 0);
+DEFINE_STUB(spdk_json_write_named_uuid, int, (struct spdk_json_write_ctx *w,
+		const char *name, const struct spdk_uuid *val), 0);
+DEFINE_STUB(spdk_json_write_named_object_begin, int, (struct spdk_json_write_ctx *w,
+		const char *name), 0);
+DEFINE_STUB(spdk_json_write_object_end, int, (struct spdk_json_write_ctx *w), 0);
+DEFINE_STUB(spdk_bdev_io_type_supported, bool, (struct spdk_bdev *bdev,
+		enum spdk_bdev_io_type io_type), true);
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io);
+}
+
+int
+spdk_bdev_open_ext(const char *bdev_name, bool write, spdk_bdev_event_cb_t event_cb,
+		   void *event_ctx, struct spdk_bdev_desc **_desc)
+{
+	struct spdk_bdev *bdev;
+
+	TAILQ_FOREACH(bdev, &g_bdev_list, internal.link) {
+		if (strcmp(bdev_name, bdev->name) == 0) {
+			*_desc = (void *)bdev;
+			return 0;
+		}
+	}
+
+	return -ENODEV;
+}
+
+struct spdk_bdev *
+spdk_bdev_desc_get_bdev(struct spdk_bdev_desc *desc)
+{
+	return (void *)desc;
+}
+
+struct spdk_io_channel *
+spdk_bdev_get_io_channel(struct spdk_bdev_desc *desc)
+{
+	return spdk_get_io_channel(&g_base_io_device);
+}
+
+const char *
+spdk_bdev_get_name(const struct spdk_bdev *bdev)
+{
+	return bdev->name;
+}
+
+const struct spdk_uuid *
+spdk_bdev_get_uuid(const struct spdk_bdev *bdev)
+{
+	return &bdev->uuid;
+}
+
+struct spdk_bdev *
+spdk_bdev_get_by_name(const char *bdev_name)
+{
+	struct spdk_bdev *bdev;
+
+	TAILQ_FOREACH(bdev, &g_bdev_list, internal.link) {
+		if (strcmp(bdev_name, bdev->name) == 0) {
+			return bdev;
+		}
+	}
+
+	return NULL;
+}
+
+int
+spdk_bdev_register(struct spdk_bdev *bdev)
+{
+	CU_ASSERT_PTR_NULL(spdk_bdev_get_by_name(bdev->name));
+	TAILQ_INSERT_TAIL(&g_bdev_list, bdev, internal.link);
+
+	return 0;
+}
+
+void
+spdk_bdev_unregister(struct spdk_bdev *bdev, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	int rc;
+
+	CU_ASSERT_EQUAL(spdk_bdev_get_by_name(bdev->name), bdev);
+	TAILQ_REMOVE(&g_bdev_list, bdev, internal.link);
+
+	rc = bdev->fn_table->destruct(bdev->ctxt);
+	CU_ASSERT(rc == 0 || rc == 1);
+	if (rc == 0) {
+		/* Destructed synchronously, spdk_bdev_destruct_done() won't be called */
+		g_destruct_done = true;
+	}
+
+	if (cb_fn) {
+		cb_fn(cb_arg, 0);
+	}
+}
+
+void
+spdk_bdev_destruct_done(struct spdk_bdev *bdev, int bdeverrno)
+{
+	CU_ASSERT(bdeverrno == 0);
+	g_destruct_done = true;
+}
+
+int
+spdk_bdev_unregister_by_name(const char *bdev_name, struct spdk_bdev_module *module,
+			     spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	struct spdk_bdev *bdev;
+
+	CU_ASSERT(module == UT_BDEV_MODULE);
+
+	bdev = spdk_bdev_get_by_name(bdev_name);
+	if (bdev == NULL) {
+		return -ENODEV;
+	}
+
+	spdk_bdev_unregister(bdev, cb_fn, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_module_claim_bdev(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+			    struct spdk_bdev_module *module)
+{
+	if (bdev->internal.claim_type != SPDK_BDEV_CLAIM_NONE) {
+		return -EPERM;
+	}
+	bdev->internal.claim_type = SPDK_BDEV_CLAIM_EXCL_WRITE;
+	bdev->internal.claim.v1.module = module;
+
+	return 0;
+}
+
+void
+spdk_bdev_module_release_bdev(struct spdk_bdev *bdev)
+{
+	CU_ASSERT(bdev->internal.claim_type == SPDK_BDEV_CLAIM_EXCL_WRITE);
+	bdev->internal.claim_type = SPDK_BDEV_CLAIM_NONE;
+	bdev->internal.claim.v1.module = NULL;
+}
+
+void
+spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	bdev_io->internal.status = status;
+}
+
+void
+spdk_bdev_io_get_buf(struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb, uint64_t len)
+{
+	/* The buffers are allocated by the test. */
+	cb(spdk_io_channel_from_ctx(bdev_io->internal.ch), bdev_io, true);
+}
+
+static struct ut_io *
+ut_queue_io(struct spdk_bdev_desc *desc, enum spdk_bdev_io_type type, struct iovec *iovs,
+	    int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+	    spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct ut_disk *disk = SPDK_CONTAINEROF(spdk_bdev_desc_get_bdev(desc), struct ut_disk, bdev);
+	struct ut_io *io;
+
+	CU_ASSERT(offset_blocks + num_blocks <= disk->bdev.blockcnt);
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->disk = disk;
+	io->type = type;
+	io->iovs = iovs;
+	io->iovcnt = iovcnt;
+	io->offset_blocks = offset_blocks;
+	io->num_blocks = num_blocks;
+	io->thread = spdk_get_thread();
+	io->cb = cb;
+	io->cb_arg = cb_arg;
+	if ((type == SPDK_BDEV_IO_TYPE_WRITE || type == SPDK_BDEV_IO_TYPE_WRITE_ZEROES) &&
+	    disk->fail_write) {
+		disk->fail_write = false;
+		io->fail = true;
+	}
+	TAILQ_INSERT_TAIL(&g_ios, io, link);
+	g_num_ios++;
+
+	return io;
+}
+
+int
+spdk_bdev_read_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		      void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		      spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct ut_io *io;
+
+	io = ut_queue_io(desc, SPDK_BDEV_IO_TYPE_READ, NULL, 1, offset_blocks, num_blocks, cb, cb_arg);
+	io->iov.iov_base = buf;
+	io->iov.iov_len = num_blocks * io->disk->bdev.blocklen;
+	io->iovs = &io->iov;
+
+	return 0;
+}
+
+int
+spdk_bdev_write_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct ut_io *io;
+
+	io = ut_queue_io(desc, SPDK_BDEV_IO_TYPE_WRITE, NULL, 1, offset_blocks, num_blocks, cb, cb_arg);
+	io->iov.iov_base = buf;
+	io->iov.iov_len = num_blocks * io->disk->bdev.blocklen;
+	io->iovs = &io->iov;
+
+	return 0;
+}
+
+int
+spdk_bdev_readv_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_queue_io(desc, SPDK_BDEV_IO_TYPE_READ, iov, iovcnt, offset_blocks, num_blocks, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_writev_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_queue_io(desc, SPDK_BDEV_IO_TYPE_WRITE, iov, iovcnt, offset_blocks, num_blocks, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			   struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			   spdk_bdev_io_completion_cb cb, void *cb_arg,
+			   struct spdk_bdev_ext_io_opts *opts)
+{
+	return spdk_bdev_readv_blocks(desc, ch, iov, iovcnt, offset_blocks, num_blocks, cb, cb_arg);
+}
+
+int
+spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			    struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			    spdk_bdev_io_completion_cb cb, void *cb_arg,
+			    struct spdk_bdev_ext_io_opts *opts)
+{
+	return spdk_bdev_writev_blocks(desc, ch, iov, iovcnt, offset_blocks, num_blocks, cb, cb_arg);
+}
+
+int
+spdk_bdev_write_zeroes_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			      uint64_t offset_blocks, uint64_t num_blocks,
+			      spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_queue_io(desc, SPDK_BDEV_IO_TYPE_WRITE_ZEROES, NULL, 0, offset_blocks, num_blocks, cb,
+		    cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_flush_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		       void *cb_arg)
+{
+	ut_queue_io(desc, SPDK_BDEV_IO_TYPE_FLUSH, NULL, 0, offset_blocks, num_blocks, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_reset(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_queue_io(desc, SPDK_BDEV_IO_TYPE_RESET, NULL, 0, 0, 0, cb, cb_arg);
+
+	return 0;
+}
+
+static void
+ut_complete_io(struct ut_io *io)
+{
+	struct spdk_bdev_io *bdev_io;
+	uint32_t blocklen = io->disk->bdev.blocklen;
+	uint64_t len = io->num_blocks * blocklen;
+	uint8_t *data = io->disk->data + io->offset_blocks * blocklen;
+
+	TAILQ_REMOVE(&g_ios, io, link);
+
+	if (!io->fail) {
+		if (io->type == SPDK_BDEV_IO_TYPE_READ) {
+			spdk_copy_buf_to_iovs(io->iovs, io->iovcnt, data, len);
+		} else if (io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+			spdk_copy_iovs_to_buf(data, len, io->iovs, io->iovcnt);
+		} else if (io->type == SPDK_BDEV_IO_TYPE_WRITE_ZEROES) {
+			memset(data, 0, len);
+		}
+	}
+
+	/* Complete on the thread the I/O was submitted from. */
+	bdev_io = calloc(1, sizeof(*bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	spdk_set_thread(io->thread);
+	io->cb(bdev_io, !io->fail, io->cb_arg);
+	spdk_set_thread(g_thread);
+	free(io);
+}
+
+/* Complete the I/O queued to the disks, except the ones held. Returns the number of
+ * I/O completed.
+ */
+static int
+ut_complete_ios(void)
+{
+	struct ut_io *io, *tmp;
+	int count = 0;
+
+	TAILQ_FOREACH_SAFE(io, &g_ios, link, tmp) {
+		if (!io->hold && !io->disk->hold) {
+			ut_complete_io(io);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/* Run the pollers and messages and complete the I/O until nothing is left to do. */
+static void
+ut_drain(void)
+{
+	int count;
+
+	do {
+		count = ut_complete_ios();
+		spdk_delay_us(UT_POLL_US);
+		count += spdk_thread_poll(g_thread, 0, 0);
+		if (g_thread2 != NULL) {
+			count += spdk_thread_poll(g_thread2, 0, 0);
+		}
+	} while (count > 0);
+}
+
+static int
+ut_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	return 0;
+}
+
+static void
+ut_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+}
+
+static struct ut_disk *
+ut_create_disk(const char *name, uint64_t blockcnt, uint32_t blocklen)
+{
+	struct ut_disk *disk;
+	uint64_t i;
+
+	disk = calloc(1, sizeof(*disk));
+	SPDK_CU_ASSERT_FATAL(disk != NULL);
+	disk->bdev.name = strdup(name);
+	SPDK_CU_ASSERT_FATAL(disk->bdev.name != NULL);
+	disk->bdev.blocklen = blocklen;
+	disk->bdev.blockcnt = blockcnt;
+	spdk_uuid_generate(&disk->bdev.uuid);
+	disk->data = calloc(blockcnt, blocklen);
+	SPDK_CU_ASSERT_FATAL(disk->data != NULL);
+	/* Every byte of a block holds the low byte of its LBA. */
+	for (i = 0; i < blockcnt; i++) {
+		memset(disk->data + i * blocklen, (uint8_t)i, blocklen);
+	}
+	TAILQ_INSERT_TAIL(&g_bdev_list, &disk->bdev, internal.link);
+
+	return disk;
+}
+
+static void
+ut_free_disk(struct ut_disk *disk)
+{
+	CU_ASSERT(disk->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+	TAILQ_REMOVE(&g_bdev_list, &disk->bdev, internal.link);
+	free(disk->bdev.name);
+	free(disk->data);
+	free(disk);
+}
+
+#ifdef UT_MODEL_BLOCKS
+/* Expected content of each block of the bdev under test */
+static uint8_t g_model[UT_MODEL_BLOCKS];
+
+static bool
+ut_check_data(uint8_t *buf, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	uint64_t i, j;
+
+	for (i = 0; i < num_blocks; i++) {
+		for (j = 0; j < UT_BLOCK_SIZE; j++) {
+			if (buf[i * UT_BLOCK_SIZE + j] != g_model[offset_blocks + i]) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+#endif
@@ -127,6 +127,15 @@ spdk_env_get_numa_id(uint32_t core)
 	return SPDK_ENV_NUMA_ID_ANY;
 }
 
+DEFINE_RETURN_MOCK(spdk_env_core_get_smt_cpuset, bool);
+bool
+spdk_env_core_get_smt_cpuset(struct spdk_cpuset *cpuset, uint32_t core)
+{
+	HANDLE_RETURN_MOCK(spdk_env_core_get_smt_cpuset);
+
+	return false;
+}
+
 /*
  * These mocks don't use the DEFINE_STUB macros because
  * their default implementation is more complex.
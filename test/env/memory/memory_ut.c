@@ -357,6 +357,75 @@ test_mem_map_translation(void)
 	CU_ASSERT(map == NULL);
 }
 
+static void
+test_mem_map_translation_cache(void)
+{
+	struct spdk_mem_map *map, *map2;
+	uint64_t default_translation = 0xDEADBEEF0BADF00D;
+	uint64_t addr;
+	uint64_t mapping_length;
+	int rc;
+
+	map = spdk_mem_map_alloc(default_translation, &test_mem_map_ops, NULL);
+	SPDK_CU_ASSERT_FATAL(map != NULL);
+	map2 = spdk_mem_map_alloc(default_translation, &test_mem_map_ops, NULL);
+	SPDK_CU_ASSERT_FATAL(map2 != NULL);
+
+	rc = spdk_mem_map_set_translation(map, 0, 2 * VALUE_2MB, 0x1000);
+	CU_ASSERT(rc == 0);
+	rc = spdk_mem_map_set_translation(map2, 0, VALUE_2MB, 0x2000);
+	CU_ASSERT(rc == 0);
+
+	/* Translate twice, the second time from the cache */
+	addr = spdk_mem_map_translate(map, 0, NULL);
+	CU_ASSERT(addr == 0x1000);
+	addr = spdk_mem_map_translate(map, VALUE_4KB, NULL);
+	CU_ASSERT(addr == 0x1000);
+
+	/* The entries of a map aren't used to translate another one's addresses */
+	addr = spdk_mem_map_translate(map2, 0, NULL);
+	CU_ASSERT(addr == 0x2000);
+	addr = spdk_mem_map_translate(map, 0, NULL);
+	CU_ASSERT(addr == 0x1000);
+
+	/* A cached translation still reports the contiguous length of the region */
+	mapping_length = 2 * VALUE_2MB;
+	addr = spdk_mem_map_translate(map, 0, &mapping_length);
+	CU_ASSERT(addr == 0x1000);
+	CU_ASSERT(mapping_length == 2 * VALUE_2MB);
+	mapping_length = 543;
+	addr = spdk_mem_map_translate(map, 0, &mapping_length);
+	CU_ASSERT(addr == 0x1000);
+	CU_ASSERT(mapping_length == 543);
+
+	/* Updating the map invalidates the cached translations */
+	rc = spdk_mem_map_set_translation(map, 0, VALUE_2MB, 0x3000);
+	CU_ASSERT(rc == 0);
+	addr = spdk_mem_map_translate(map, 0, NULL);
+	CU_ASSERT(addr == 0x3000);
+	mapping_length = 2 * VALUE_2MB;
+	addr = spdk_mem_map_translate(map, 0, &mapping_length);
+	CU_ASSERT(addr == 0x3000);
+	CU_ASSERT(mapping_length == VALUE_2MB);
+
+	rc = spdk_mem_map_clear_translation(map, 0, 2 * VALUE_2MB);
+	CU_ASSERT(rc == 0);
+	addr = spdk_mem_map_translate(map, 0, NULL);
+	CU_ASSERT(addr == default_translation);
+
+	/* A map allocated in place of a freed one doesn't use its cached translations */
+	addr = spdk_mem_map_translate(map2, 0, NULL);
+	CU_ASSERT(addr == 0x2000);
+	spdk_mem_map_free(&map2);
+	map2 = spdk_mem_map_alloc(default_translation, &test_mem_map_ops, NULL);
+	SPDK_CU_ASSERT_FATAL(map2 != NULL);
+	addr = spdk_mem_map_translate(map2, 0, NULL);
+	CU_ASSERT(addr == default_translation);
+
+	spdk_mem_map_free(&map2);
+	spdk_mem_map_free(&map);
+}
+
 static void
 test_mem_map_registration(void)
 {
@@ -496,6 +565,7 @@ main(int argc, char **argv)
 	if (
 		CU_add_test(suite, "alloc and free memory map", test_mem_map_alloc_free) == NULL ||
 		CU_add_test(suite, "mem map translation", test_mem_map_translation) == NULL ||
+		CU_add_test(suite, "mem map translation cache", test_mem_map_translation_cache) == NULL ||
 		CU_add_test(suite, "mem map registration", test_mem_map_registration) == NULL ||
 		CU_add_test(suite, "mem map adjacent registrations", test_mem_map_registration_adjacent) == NULL
 	) {
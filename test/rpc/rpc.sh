@@ -47,6 +47,25 @@ function rpc_trace_cmd_test() {
 	[ "$(jq -r .bdev.tpoint_mask <<< "$info")" != "0x0" ]
 }
 
+function rpc_metrics_exporter() {
+	local url=http://127.0.0.1:9466/metrics
+	local exporter_pid malloc metrics
+
+	malloc=$($rpc bdev_malloc_create 8 512)
+	$rootdir/scripts/metrics_exporter.py -s $DEFAULT_RPC_ADDR -l 127.0.0.1 -P 9466 -i 1 &
+	exporter_pid=$!
+
+	waitforcondition '[[ $(curl -sf $url) == *"spdk_exporter_up{} 1.0"* ]]'
+	metrics=$(curl -sf $url)
+	[[ $metrics == *"spdk_bdev_reads_total{bdev=\"$malloc\"}"* ]]
+	[[ $metrics == *"spdk_thread_busy_seconds_total{thread=\"app_thread\""* ]]
+	[ "$(curl -s -o /dev/null -w '%{http_code}' http://127.0.0.1:9466/other)" == "404" ]
+
+	kill $exporter_pid
+	wait $exporter_pid || true
+	$rpc bdev_malloc_delete $malloc
+}
+
 function go_rpc() {
 	bdevs=$($rootdir/build/examples/hello_gorpc)
 	[ "$(jq length <<< "$bdevs")" == "0" ]
@@ -73,6 +92,7 @@ rpc=rpc_cmd
 run_test "rpc_integrity" rpc_integrity
 run_test "rpc_plugins" rpc_plugins
 run_test "rpc_trace_cmd_test" rpc_trace_cmd_test
+run_test "rpc_metrics_exporter" rpc_metrics_exporter
 if [[ $SPDK_JSONRPC_GO_CLIENT -eq 1 ]]; then
 	run_test "go_rpc" go_rpc
 fi
@@ -0,0 +1,182 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "common/lib/ut_multithread.c"
+
+#include "fio/bdev/fio_plugin.c"
+
+/* fio symbols the plugin resolves from the fio binary */
+__typeof__(is_backend) is_backend;
+DEFINE_STUB_V(register_ioengine, (struct ioengine_ops *ops));
+DEFINE_STUB_V(unregister_ioengine, (struct ioengine_ops *ops));
+DEFINE_STUB(add_file, int, (struct thread_data *td, const char *fname, int numjob, int inc), 0);
+DEFINE_STUB(fio_server_text_output, int, (int level, const char *buf, size_t len), 0);
+
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB(spdk_bdev_flush, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset, uint64_t length, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB(spdk_bdev_get_block_size, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_by_name, struct spdk_bdev *, (const char *bdev_name), NULL);
+DEFINE_STUB(spdk_bdev_get_io_channel, struct spdk_io_channel *, (struct spdk_bdev_desc *desc),
+		NULL);
+DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), NULL);
+DEFINE_STUB(spdk_bdev_get_num_blocks, uint64_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_numa_id, int32_t, (struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_zone_id, uint64_t, (const struct spdk_bdev *bdev, uint64_t offset_blocks),
+		0);
+DEFINE_STUB(spdk_bdev_io_type_supported, bool, (struct spdk_bdev *bdev,
+		enum spdk_bdev_io_type io_type), false);
+DEFINE_STUB(spdk_bdev_is_zoned, bool, (const struct spdk_bdev *bdev), false);
+DEFINE_STUB(spdk_bdev_open_ext, int, (const char *bdev_name, bool write,
+		spdk_bdev_event_cb_t event_cb, void *event_ctx, struct spdk_bdev_desc **desc), 0);
+DEFINE_STUB(spdk_bdev_read, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t offset, uint64_t nbytes, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_unmap, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset, uint64_t nbytes, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_write, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t offset, uint64_t nbytes, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_zone_append, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t zone_id, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_for_each_bdev_leaf, int, (void *ctx, spdk_for_each_bdev_fn fn), 0);
+DEFINE_STUB_V(spdk_rpc_finish, (void));
+DEFINE_STUB(spdk_rpc_get_state, uint32_t, (void), 0);
+DEFINE_STUB(spdk_rpc_initialize, int, (const char *listen_addr, const struct spdk_rpc_opts *opts),
+		0);
+DEFINE_STUB_V(spdk_rpc_set_state, (uint32_t state_mask));
+DEFINE_STUB_V(spdk_subsystem_fini, (spdk_subsystem_fini_fn cb_fn, void *cb_arg));
+DEFINE_STUB_V(spdk_subsystem_init, (spdk_subsystem_init_fn cb_fn, void *cb_arg));
+DEFINE_STUB_V(spdk_subsystem_load_config, (void *json, ssize_t json_size,
+		spdk_subsystem_init_fn cb_fn, void *cb_arg, bool stop_on_error));
+DEFINE_STUB_V(spdk_unaffinitize_thread, (void));
+
+
+#define UT_IODEPTH 4
+
+static struct spdk_fio_thread g_fio_thread;
+static struct thread_data g_td;
+static struct io_u g_io[UT_IODEPTH * 2];
+
+static void
+ut_complete_io(void *ctx)
+{
+	SPDK_CU_ASSERT_FATAL(g_fio_thread.iocq_count < g_fio_thread.iocq_size);
+	g_fio_thread.iocq[g_fio_thread.iocq_count++] = ctx;
+}
+
+static void
+ut_fio_thread_init(void)
+{
+	memset(&g_fio_thread, 0, sizeof(g_fio_thread));
+	allocate_threads(1);
+	set_thread(0);
+
+	g_fio_thread.td = &g_td;
+	g_fio_thread.thread = spdk_get_thread();
+	g_fio_thread.iocq_size = UT_IODEPTH;
+	g_fio_thread.iocq = calloc(g_fio_thread.iocq_size, sizeof(*g_fio_thread.iocq));
+	SPDK_CU_ASSERT_FATAL(g_fio_thread.iocq != NULL);
+	g_td.io_ops_data = &g_fio_thread;
+}
+
+static void
+ut_fio_thread_fini(void)
+{
+	free(g_fio_thread.iocq);
+	free_threads();
+}
+
+static void
+test_commit(void)
+{
+	int i, rc;
+
+	ut_fio_thread_init();
+
+	/* Commit polls the thread, e.g. to ring the doorbells of the queued I/O */
+	for (i = 0; i < 3; i++) {
+		spdk_thread_send_msg(g_fio_thread.thread, ut_complete_io, &g_io[i]);
+	}
+	rc = ioengine.commit(&g_td);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_fio_thread.iocq_count == 3);
+
+	/* Completions reaped by commit are returned by getevents */
+	rc = ioengine.getevents(&g_td, 0, UT_IODEPTH, NULL);
+	CU_ASSERT(rc == 3);
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(ioengine.event(&g_td, i) == &g_io[i]);
+	}
+
+	/* Requeue all of them, the returned entries make room for the new completions */
+	for (i = 0; i < UT_IODEPTH; i++) {
+		spdk_thread_send_msg(g_fio_thread.thread, ut_complete_io, &g_io[UT_IODEPTH + i]);
+	}
+	rc = ioengine.commit(&g_td);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_fio_thread.iocq_count == UT_IODEPTH);
+
+	rc = ioengine.getevents(&g_td, 1, UT_IODEPTH, NULL);
+	CU_ASSERT(rc == UT_IODEPTH);
+	for (i = 0; i < UT_IODEPTH; i++) {
+		CU_ASSERT(ioengine.event(&g_td, i) == &g_io[UT_IODEPTH + i]);
+	}
+
+	rc = ioengine.getevents(&g_td, 0, UT_IODEPTH, NULL);
+	CU_ASSERT(rc == 0);
+
+	ut_fio_thread_fini();
+}
+
+static void
+test_getevents_max(void)
+{
+	int i, rc;
+
+	ut_fio_thread_init();
+
+	for (i = 0; i < 3; i++) {
+		spdk_thread_send_msg(g_fio_thread.thread, ut_complete_io, &g_io[i]);
+	}
+
+	/* Completions beyond max are kept for the next call */
+	rc = ioengine.getevents(&g_td, 1, 2, NULL);
+	CU_ASSERT(rc == 2);
+	CU_ASSERT(ioengine.event(&g_td, 0) == &g_io[0]);
+	CU_ASSERT(ioengine.event(&g_td, 1) == &g_io[1]);
+
+	spdk_thread_send_msg(g_fio_thread.thread, ut_complete_io, &g_io[3]);
+	rc = ioengine.getevents(&g_td, 2, UT_IODEPTH, NULL);
+	CU_ASSERT(rc == 2);
+	CU_ASSERT(ioengine.event(&g_td, 0) == &g_io[2]);
+	CU_ASSERT(ioengine.event(&g_td, 1) == &g_io[3]);
+
+	ut_fio_thread_fini();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("fio_plugin", NULL, NULL);
+	CU_ADD_TEST(suite, test_commit);
+	CU_ADD_TEST(suite, test_getevents_max);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
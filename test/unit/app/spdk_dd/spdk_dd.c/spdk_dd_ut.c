@@ -0,0 +1,271 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/test_env.c"
+
+#define main dd_main
+#include "spdk_dd/spdk_dd.c"
+#undef main
+
+DEFINE_STUB_V(spdk_app_fini, (void));
+DEFINE_STUB_V(spdk_app_opts_init, (struct spdk_app_opts *opts, size_t opts_size));
+DEFINE_STUB(spdk_app_parse_args, spdk_app_parse_args_rvals_t, (int argc, char **argv,
+		struct spdk_app_opts *opts, const char *getopt_str,
+		const struct option *app_long_opts, int (*parse)(int ch, char *arg),
+		void (*usage)(void)), 0);
+DEFINE_STUB(spdk_app_start, int, (struct spdk_app_opts *opts_user, spdk_msg_fn start_fn, void *ctx),
+		0);
+DEFINE_STUB_V(spdk_app_stop, (int rc));
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB(spdk_bdev_get_block_size, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_io_channel, struct spdk_io_channel *, (struct spdk_bdev_desc *desc),
+		NULL);
+DEFINE_STUB(spdk_bdev_get_num_blocks, uint64_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_io_get_seek_offset, uint64_t, (const struct spdk_bdev_io *bdev_io), 0);
+DEFINE_STUB(spdk_bdev_io_type_supported, bool, (struct spdk_bdev *bdev,
+		enum spdk_bdev_io_type io_type), false);
+DEFINE_STUB(spdk_bdev_open_ext, int, (const char *bdev_name, bool write,
+		spdk_bdev_event_cb_t event_cb, void *event_ctx, struct spdk_bdev_desc **desc), 0);
+DEFINE_STUB(spdk_bdev_read, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t offset, uint64_t nbytes, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_seek_data, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_seek_hole, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_write, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t offset, uint64_t nbytes, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+
+static uint64_t g_unmap_offset;
+static uint64_t g_unmap_nbytes;
+static int g_unmap_calls;
+
+DEFINE_RETURN_MOCK(spdk_bdev_unmap, int);
+int
+spdk_bdev_unmap(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset, uint64_t nbytes, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	HANDLE_RETURN_MOCK(spdk_bdev_unmap);
+
+	g_unmap_offset = offset;
+	g_unmap_nbytes = nbytes;
+	g_unmap_calls++;
+
+	return 0;
+}
+
+static void
+ut_free_jobs(void)
+{
+	struct spdk_thread *thread;
+	uint32_t i;
+
+	for (i = 1; i < g_num_jobs; i++) {
+		thread = dd_get_job(i)->thread;
+		spdk_set_thread(thread);
+		spdk_thread_exit(thread);
+		while (!spdk_thread_is_exited(thread)) {
+			spdk_thread_poll(thread, 0, 0);
+		}
+		spdk_thread_destroy(thread);
+	}
+	spdk_set_thread(NULL);
+
+	dd_free();
+	memset(&g_opts, 0, sizeof(g_opts));
+	memset(&g_job, 0, sizeof(g_job));
+	g_parallel_jobs = NULL;
+	g_num_jobs = 1;
+}
+
+static void
+ut_init_jobs(uint64_t copy_size, uint32_t num_jobs)
+{
+	g_opts.io_unit_size = 4096;
+	g_opts.input_offset = 1;
+	g_opts.queue_depth = 2;
+	g_opts.num_jobs = num_jobs;
+	g_job.input.type = DD_TARGET_TYPE_BDEV;
+	g_job.output.type = DD_TARGET_TYPE_BDEV;
+	g_job.output.block_size = 512;
+	g_job.input.pos = 4096;
+	g_copy_size = copy_size;
+	g_job.copy_size = copy_size;
+}
+
+static void
+parallel_jobs(void)
+{
+	const struct spdk_cpuset *cpumask;
+	struct dd_job *job;
+
+	allocate_cores(2);
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	/* 10 I/O units over 3 jobs, the last one copies the remainder */
+	ut_init_jobs(10 * 4096, 3);
+	CU_ASSERT(dd_init_parallel_jobs() == 0);
+	CU_ASSERT(g_num_jobs == 3);
+	CU_ASSERT(g_job.copy_size == 4 * 4096);
+	CU_ASSERT(g_opts.queue_depth == 2);
+
+	job = dd_get_job(1);
+	CU_ASSERT(job->input.pos == 4096 + 4 * 4096);
+	CU_ASSERT(job->copy_size == 8 * 4096);
+	CU_ASSERT(job->num_ios == 2);
+	CU_ASSERT(job->ios[1].job == job);
+	CU_ASSERT(job->ios[1].length == 4096);
+	CU_ASSERT(dd_job_remaining(job) == 4 * 4096);
+	SPDK_CU_ASSERT_FATAL(job->thread != NULL);
+	cpumask = spdk_thread_get_cpumask(job->thread);
+	CU_ASSERT(spdk_cpuset_get_cpu(cpumask, 1));
+
+	job = dd_get_job(2);
+	CU_ASSERT(job->input.pos == 4096 + 8 * 4096);
+	CU_ASSERT(job->copy_size == 10 * 4096);
+	CU_ASSERT(dd_job_remaining(job) == 2 * 4096);
+	SPDK_CU_ASSERT_FATAL(job->thread != NULL);
+	cpumask = spdk_thread_get_cpumask(job->thread);
+	CU_ASSERT(spdk_cpuset_get_cpu(cpumask, 0));
+	ut_free_jobs();
+
+	/* No more jobs than I/O units, and the first one's queue depth is limited to its range */
+	ut_init_jobs(2 * 4096 + 100, 8);
+	CU_ASSERT(dd_init_parallel_jobs() == 0);
+	CU_ASSERT(g_num_jobs == 3);
+	CU_ASSERT(g_job.copy_size == 4096);
+	CU_ASSERT(g_opts.queue_depth == 1);
+	job = dd_get_job(2);
+	CU_ASSERT(job->copy_size == 2 * 4096 + 100);
+	CU_ASSERT(job->num_ios == 1);
+	CU_ASSERT(dd_job_remaining(job) == 100);
+	ut_free_jobs();
+
+	/* A single I/O unit is copied by a single job */
+	ut_init_jobs(4096, 4);
+	CU_ASSERT(dd_init_parallel_jobs() == 0);
+	CU_ASSERT(g_num_jobs == 1);
+	CU_ASSERT(g_parallel_jobs == NULL);
+	ut_free_jobs();
+
+	/* I/O units must be made of whole output blocks */
+	ut_init_jobs(10 * 4096, 3);
+	g_opts.io_unit_size = 1000;
+	CU_ASSERT(dd_init_parallel_jobs() == -EINVAL);
+	ut_free_jobs();
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+	free_cores();
+}
+
+static void
+skip_hole(void)
+{
+	struct dd_job job = {};
+
+	g_opts.io_unit_size = 4096;
+	g_opts.input_offset = 0;
+	g_opts.output_offset = 2;
+	job.output.type = DD_TARGET_TYPE_BDEV;
+	job.output.block_size = 4096;
+	job.input.pos = 1000;
+	job.copy_size = 10 * 4096;
+	MOCK_SET(spdk_bdev_io_type_supported, true);
+
+	/* Only whole blocks of the hole are unmapped in the output region */
+	dd_job_skip_hole(&job, 10000);
+	CU_ASSERT(job.input.pos == 10000);
+	CU_ASSERT(g_unmap_calls == 1);
+	CU_ASSERT(g_unmap_offset == 3 * 4096);
+	CU_ASSERT(g_unmap_nbytes == 4096);
+	CU_ASSERT(job.outstanding == 1);
+
+	/* Nothing to skip backwards */
+	dd_job_skip_hole(&job, 5000);
+	CU_ASSERT(job.input.pos == 10000);
+	CU_ASSERT(g_unmap_calls == 1);
+
+	/* A hole within a block is skipped without unmap */
+	dd_job_skip_hole(&job, 12000);
+	CU_ASSERT(job.input.pos == 12000);
+	CU_ASSERT(g_unmap_calls == 1);
+
+	/* The end of the input is a hole up to the end of the job's range */
+	dd_job_skip_hole(&job, UINT64_MAX);
+	CU_ASSERT(job.input.pos == 10 * 4096);
+	CU_ASSERT(dd_job_remaining(&job) == 0);
+	CU_ASSERT(g_unmap_calls == 2);
+	CU_ASSERT(g_unmap_offset == 5 * 4096);
+	CU_ASSERT(g_unmap_nbytes == 7 * 4096);
+	CU_ASSERT(job.outstanding == 2);
+
+	/* Failed unmap */
+	job.input.pos = 0;
+	MOCK_SET(spdk_bdev_unmap, -ENOMEM);
+	dd_job_skip_hole(&job, 8192);
+	CU_ASSERT(job.input.pos == 8192);
+	CU_ASSERT(job.outstanding == 2);
+	CU_ASSERT(g_error == -ENOMEM);
+	MOCK_CLEAR(spdk_bdev_unmap);
+	g_error = 0;
+
+	/* Output bdevs without unmap support and output files are left as they are */
+	job.input.pos = 0;
+	MOCK_SET(spdk_bdev_io_type_supported, false);
+	dd_job_skip_hole(&job, 8192);
+	CU_ASSERT(job.input.pos == 8192);
+	MOCK_SET(spdk_bdev_io_type_supported, true);
+	job.output.type = DD_TARGET_TYPE_FILE;
+	dd_job_skip_hole(&job, 16384);
+	CU_ASSERT(job.input.pos == 16384);
+	CU_ASSERT(g_unmap_calls == 2);
+
+	MOCK_CLEAR(spdk_bdev_io_type_supported);
+	memset(&g_opts, 0, sizeof(g_opts));
+}
+
+static int
+test_setup(void)
+{
+	spdk_thread_lib_init(NULL, 0);
+
+	return 0;
+}
+
+static int
+test_cleanup(void)
+{
+	spdk_thread_lib_fini();
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("spdk_dd", test_setup, test_cleanup);
+
+	CU_ADD_TEST(suite, parallel_jobs);
+	CU_ADD_TEST(suite, skip_hole);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,276 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/test_env.c"
+
+#define main perf_main
+#include "spdk_nvme_perf/perf.c"
+#undef main
+
+DEFINE_STUB(spdk_key_get_name, const char *, (struct spdk_key *key), NULL);
+DEFINE_STUB_V(spdk_keyring_cleanup, (void));
+DEFINE_STUB(spdk_keyring_file_add_key, int, (const char *name, const char *path), 0);
+DEFINE_STUB(spdk_keyring_file_remove_key, int, (const char *name), 0);
+DEFINE_STUB(spdk_keyring_get_key, struct spdk_key *, (const char *name), NULL);
+DEFINE_STUB(spdk_keyring_init, int, (void), 0);
+DEFINE_STUB_V(spdk_keyring_put_key, (struct spdk_key *key));
+DEFINE_STUB(spdk_nvme_ctrlr_alloc_io_qpair, struct spdk_nvme_qpair *,
+		(struct spdk_nvme_ctrlr *ctrlr, const struct spdk_nvme_io_qpair_opts *opts,
+		size_t opts_size), NULL);
+DEFINE_STUB(spdk_nvme_ctrlr_cmd_get_log_page, int, (struct spdk_nvme_ctrlr *ctrlr, uint8_t log_page,
+		uint32_t nsid, void *payload, uint32_t payload_size, uint64_t offset,
+		spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_cmd_set_feature, int, (struct spdk_nvme_ctrlr *ctrlr, uint8_t feature,
+		uint32_t cdw11, uint32_t cdw12, void *payload, uint32_t payload_size,
+		spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_connect_io_qpair, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_qpair *qpair), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_free_io_qpair, int, (struct spdk_nvme_qpair *qpair), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_get_data, const struct spdk_nvme_ctrlr_data *,
+		(struct spdk_nvme_ctrlr *ctrlr), NULL);
+DEFINE_STUB_V(spdk_nvme_ctrlr_get_default_io_qpair_opts, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_io_qpair_opts *opts, size_t opts_size));
+DEFINE_STUB(spdk_nvme_ctrlr_get_first_active_ns, uint32_t, (struct spdk_nvme_ctrlr *ctrlr), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_get_next_active_ns, uint32_t, (struct spdk_nvme_ctrlr *ctrlr,
+		uint32_t prev_nsid), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_get_ns, struct spdk_nvme_ns *, (struct spdk_nvme_ctrlr *ctrlr,
+		uint32_t ns_id), NULL);
+DEFINE_STUB(spdk_nvme_ctrlr_get_numa_id, int32_t, (struct spdk_nvme_ctrlr *ctrlr), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_get_opts, const struct spdk_nvme_ctrlr_opts *,
+		(struct spdk_nvme_ctrlr *ctrlr), NULL);
+DEFINE_STUB(spdk_nvme_ctrlr_get_pci_device, struct spdk_pci_device *,
+		(struct spdk_nvme_ctrlr *ctrlr), NULL);
+DEFINE_STUB(spdk_nvme_ctrlr_get_transport_id, const struct spdk_nvme_transport_id *,
+		(struct spdk_nvme_ctrlr *ctrlr), NULL);
+DEFINE_STUB(spdk_nvme_ctrlr_is_feature_supported, bool, (struct spdk_nvme_ctrlr *ctrlr,
+		uint8_t feature_code), false);
+DEFINE_STUB(spdk_nvme_ctrlr_is_log_page_supported, bool, (struct spdk_nvme_ctrlr *ctrlr,
+		uint8_t log_page), false);
+DEFINE_STUB(spdk_nvme_ctrlr_process_admin_completions, int32_t, (struct spdk_nvme_ctrlr *ctrlr), 0);
+DEFINE_STUB(spdk_nvme_detach_async, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_detach_ctx **detach_ctx), 0);
+DEFINE_STUB_V(spdk_nvme_detach_poll, (struct spdk_nvme_detach_ctx *detach_ctx));
+DEFINE_STUB(spdk_nvme_ns_cmd_read_with_md, int, (struct spdk_nvme_ns *ns,
+		struct spdk_nvme_qpair *qpair, void *payload, void *metadata, uint64_t lba,
+		uint32_t lba_count, spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+		uint16_t apptag_mask, uint16_t apptag), 0);
+DEFINE_STUB(spdk_nvme_ns_cmd_readv_with_md, int, (struct spdk_nvme_ns *ns,
+		struct spdk_nvme_qpair *qpair, uint64_t lba, uint32_t lba_count,
+		spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+		spdk_nvme_req_reset_sgl_cb reset_sgl_fn, spdk_nvme_req_next_sge_cb next_sge_fn,
+		void *metadata, uint16_t apptag_mask, uint16_t apptag), 0);
+DEFINE_STUB(spdk_nvme_ns_cmd_write_with_md, int, (struct spdk_nvme_ns *ns,
+		struct spdk_nvme_qpair *qpair, void *payload, void *metadata, uint64_t lba,
+		uint32_t lba_count, spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+		uint16_t apptag_mask, uint16_t apptag), 0);
+DEFINE_STUB(spdk_nvme_ns_cmd_writev_with_md, int, (struct spdk_nvme_ns *ns,
+		struct spdk_nvme_qpair *qpair, uint64_t lba, uint32_t lba_count,
+		spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+		spdk_nvme_req_reset_sgl_cb reset_sgl_fn, spdk_nvme_req_next_sge_cb next_sge_fn,
+		void *metadata, uint16_t apptag_mask, uint16_t apptag), 0);
+DEFINE_STUB(spdk_nvme_ns_get_data, const struct spdk_nvme_ns_data *, (struct spdk_nvme_ns *ns),
+		NULL);
+DEFINE_STUB(spdk_nvme_ns_get_extended_sector_size, uint32_t, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_get_flags, uint32_t, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_get_id, uint32_t, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_get_max_io_xfer_size, uint32_t, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_get_md_size, uint32_t, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_get_pi_type, enum spdk_nvme_pi_type, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_get_sector_size, uint32_t, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_get_size, uint64_t, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_is_active, bool, (struct spdk_nvme_ns *ns), false);
+DEFINE_STUB(spdk_nvme_ns_supports_extended_lba, bool, (struct spdk_nvme_ns *ns), false);
+DEFINE_STUB(spdk_nvme_poll_group_add, int, (struct spdk_nvme_poll_group *group,
+		struct spdk_nvme_qpair *qpair), 0);
+DEFINE_STUB(spdk_nvme_poll_group_all_connected, int, (struct spdk_nvme_poll_group *group), 0);
+DEFINE_STUB(spdk_nvme_poll_group_create, struct spdk_nvme_poll_group *, (void *ctx,
+		struct spdk_nvme_accel_fn_table *table), NULL);
+DEFINE_STUB(spdk_nvme_poll_group_destroy, int, (struct spdk_nvme_poll_group *group), 0);
+DEFINE_STUB_V(spdk_nvme_poll_group_free_stats, (struct spdk_nvme_poll_group *group,
+		struct spdk_nvme_poll_group_stat *stat));
+DEFINE_STUB(spdk_nvme_poll_group_get_stats, int, (struct spdk_nvme_poll_group *group,
+		struct spdk_nvme_poll_group_stat **stats), 0);
+DEFINE_STUB(spdk_nvme_poll_group_process_completions, int64_t, (struct spdk_nvme_poll_group *group,
+		uint32_t completions_per_qpair,
+		spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb), 0);
+DEFINE_STUB(spdk_nvme_poll_group_wait, int, (struct spdk_nvme_poll_group *group,
+		spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb), 0);
+DEFINE_STUB(spdk_nvme_probe, int, (const struct spdk_nvme_transport_id *trid, void *cb_ctx,
+		spdk_nvme_probe_cb probe_cb, spdk_nvme_attach_cb attach_cb,
+		spdk_nvme_remove_cb remove_cb), 0);
+DEFINE_STUB_V(spdk_nvme_transport_get_opts, (struct spdk_nvme_transport_opts *opts,
+		size_t opts_size));
+DEFINE_STUB(spdk_nvme_transport_id_parse, int, (struct spdk_nvme_transport_id *trid,
+		const char *str), 0);
+DEFINE_STUB(spdk_nvme_transport_id_trtype_str, const char *, (enum spdk_nvme_transport_type trtype),
+		NULL);
+DEFINE_STUB(spdk_nvme_transport_set_opts, int, (const struct spdk_nvme_transport_opts *opts,
+		size_t opts_size), 0);
+DEFINE_STUB(spdk_pci_device_get_id, struct spdk_pci_id, (struct spdk_pci_device *dev), {});
+DEFINE_STUB(spdk_sock_impl_get_opts, int, (const char *impl_name, struct spdk_sock_impl_opts *opts,
+		size_t *len), 0);
+DEFINE_STUB(spdk_sock_impl_set_opts, int, (const char *impl_name,
+		const struct spdk_sock_impl_opts *opts, size_t len), 0);
+DEFINE_STUB(spdk_sock_set_default_impl, int, (const char *impl_name), 0);
+DEFINE_STUB_V(spdk_unaffinitize_thread, (void));
+DEFINE_STUB_V(spdk_vmd_fini, (void));
+DEFINE_STUB(spdk_vmd_init, int, (void), 0);
+
+
+#define UT_SUBMIT_TICKS		30
+#define UT_COMPLETE_TICKS	100
+
+static TAILQ_HEAD(, perf_task) g_outstanding = TAILQ_HEAD_INITIALIZER(g_outstanding);
+
+static void
+ut_setup_payload(struct perf_task *task, uint8_t pattern)
+{
+	task->iovs = calloc(1, sizeof(*task->iovs));
+	SPDK_CU_ASSERT_FATAL(task->iovs != NULL);
+	task->iovcnt = 1;
+}
+
+static int
+ut_submit_io(struct perf_task *task, struct ns_worker_ctx *ns_ctx, struct ns_entry *entry,
+	     uint64_t offset_in_ios)
+{
+	ut_spdk_get_ticks += UT_SUBMIT_TICKS;
+	TAILQ_INSERT_TAIL(&g_outstanding, task, link);
+
+	return 0;
+}
+
+static int64_t
+ut_check_io(struct ns_worker_ctx *ns_ctx)
+{
+	struct perf_task *task;
+
+	task = TAILQ_FIRST(&g_outstanding);
+	if (task == NULL) {
+		return 0;
+	}
+
+	/* Reap a single completion, which resubmits the task unless the job is draining */
+	ut_spdk_get_ticks += UT_COMPLETE_TICKS;
+	TAILQ_REMOVE(&g_outstanding, task, link);
+	task_complete(task);
+
+	return 1;
+}
+
+static int
+ut_init_ns_worker_ctx(struct ns_worker_ctx *ns_ctx)
+{
+	return 0;
+}
+
+static void
+ut_cleanup_ns_worker_ctx(struct ns_worker_ctx *ns_ctx)
+{
+}
+
+static const struct ns_fn_table g_ut_fn_table = {
+	.setup_payload		= ut_setup_payload,
+	.submit_io		= ut_submit_io,
+	.check_io		= ut_check_io,
+	.init_ns_worker_ctx	= ut_init_ns_worker_ctx,
+	.cleanup_ns_worker_ctx	= ut_cleanup_ns_worker_ctx,
+};
+
+static void
+ut_run_worker(struct ns_worker_ctx *ns_ctx)
+{
+	struct worker_thread worker = {};
+
+	TAILQ_INIT(&worker.ns_ctx);
+	TAILQ_INSERT_TAIL(&worker.ns_ctx, ns_ctx, link);
+	worker.lcore = g_main_core + 1;
+
+	SPDK_CU_ASSERT_FATAL(pthread_barrier_init(&g_worker_sync_barrier, NULL, 1) == 0);
+	CU_ASSERT(work_fn(&worker) == 0);
+	pthread_barrier_destroy(&g_worker_sync_barrier);
+	CU_ASSERT(TAILQ_EMPTY(&g_outstanding));
+}
+
+static void
+cycles_per_io(void)
+{
+	struct ns_entry entry = { .type = ENTRY_TYPE_NVME_NS, .fn_table = &g_ut_fn_table };
+	struct ns_worker_ctx ns_ctx = { .entry = &entry };
+
+	entry.size_in_ios = 16;
+	g_rw_percentage = 100;
+	g_queue_depth = 2;
+	g_number_ios = 6;
+	g_time_in_sec = 1000;
+	g_tsc_rate = spdk_get_ticks_hz();
+
+	/* Nothing is accounted without the option */
+	ut_run_worker(&ns_ctx);
+	CU_ASSERT(ns_ctx.stats.io_submitted == 6);
+	CU_ASSERT(ns_ctx.stats.io_completed == 6);
+	CU_ASSERT(ns_ctx.stats.submit_cycles == 0);
+	CU_ASSERT(ns_ctx.stats.complete_cycles == 0);
+
+	/* Each submission is accounted. The 4 completions reaped before the job drains each
+	 * resubmit a task, which is accounted as submission rather than completion. */
+	memset(&ns_ctx.stats, 0, sizeof(ns_ctx.stats));
+	ns_ctx.current_queue_depth = 0;
+	ns_ctx.offset_in_ios = 0;
+	ns_ctx.is_draining = false;
+	g_cycles_per_io = true;
+	ut_run_worker(&ns_ctx);
+	CU_ASSERT(ns_ctx.stats.io_submitted == 6);
+	CU_ASSERT(ns_ctx.stats.io_completed == 6);
+	CU_ASSERT(ns_ctx.stats.submit_cycles == 6 * UT_SUBMIT_TICKS);
+	CU_ASSERT(ns_ctx.stats.complete_cycles == 4 * UT_COMPLETE_TICKS);
+
+	g_cycles_per_io = false;
+	g_number_ios = 0;
+	g_rw_percentage = -1;
+}
+
+static void
+transport_name(void)
+{
+	struct spdk_nvme_transport_id trid = { .trtype = SPDK_NVME_TRANSPORT_TCP };
+	struct ns_entry entry = {};
+
+	entry.type = ENTRY_TYPE_AIO_FILE;
+	CU_ASSERT(strcmp(get_ns_transport_name(&entry), "AIO") == 0);
+	entry.type = ENTRY_TYPE_URING_FILE;
+	CU_ASSERT(strcmp(get_ns_transport_name(&entry), "URING") == 0);
+
+	entry.type = ENTRY_TYPE_NVME_NS;
+	MOCK_SET(spdk_nvme_ctrlr_get_transport_id, &trid);
+	MOCK_SET(spdk_nvme_transport_id_trtype_str, "TCP");
+	CU_ASSERT(strcmp(get_ns_transport_name(&entry), "TCP") == 0);
+	MOCK_CLEAR(spdk_nvme_ctrlr_get_transport_id);
+	MOCK_CLEAR(spdk_nvme_transport_id_trtype_str);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("spdk_nvme_perf", NULL, NULL);
+
+	CU_ADD_TEST(suite, cycles_per_io);
+	CU_ADD_TEST(suite, transport_name);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,72 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+
+#include "common/lib/test_env.c"
+
+#define main trace_record_main
+#include "trace_record/trace_record.c"
+#undef main
+
+static void
+poll_interval_update(void)
+{
+	uint32_t interval_us = 0;
+	int i;
+
+	g_max_poll_interval_us = TRACE_POLL_INTERVAL_MAX_US;
+
+	/* Mostly idle buffers, the interval doubles up to the maximum */
+	interval_us = trace_poll_interval_update(interval_us, 0);
+	CU_ASSERT(interval_us == 1);
+	interval_us = trace_poll_interval_update(interval_us, TRACE_POLL_FILL_LOW - 1);
+	CU_ASSERT(interval_us == 2);
+	for (i = 0; i < 20; i++) {
+		interval_us = trace_poll_interval_update(interval_us, 0);
+	}
+	CU_ASSERT(interval_us == TRACE_POLL_INTERVAL_MAX_US);
+
+	/* Between the thresholds, the interval is kept */
+	interval_us = trace_poll_interval_update(interval_us, TRACE_POLL_FILL_LOW);
+	CU_ASSERT(interval_us == TRACE_POLL_INTERVAL_MAX_US);
+	interval_us = trace_poll_interval_update(interval_us, TRACE_POLL_FILL_HIGH);
+	CU_ASSERT(interval_us == TRACE_POLL_INTERVAL_MAX_US);
+
+	/* Buffers filling up fast, the interval halves down to continuous polling */
+	interval_us = trace_poll_interval_update(interval_us, TRACE_POLL_FILL_HIGH + 1);
+	CU_ASSERT(interval_us == TRACE_POLL_INTERVAL_MAX_US / 2);
+	for (i = 0; i < 20; i++) {
+		interval_us = trace_poll_interval_update(interval_us, 100);
+	}
+	CU_ASSERT(interval_us == 0);
+
+	/* -I 0 keeps polling continuously */
+	g_max_poll_interval_us = 0;
+	interval_us = trace_poll_interval_update(0, 0);
+	CU_ASSERT(interval_us == 0);
+
+	g_max_poll_interval_us = TRACE_POLL_INTERVAL_MAX_US;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("trace_record", NULL, NULL);
+
+	CU_ADD_TEST(suite, poll_interval_update);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,543 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/test_env.c"
+
+#define main bdevperf_main
+#include "bdev/bdevperf/bdevperf.c"
+#undef main
+
+DEFINE_STUB_V(spdk_app_fini, (void));
+DEFINE_STUB_V(spdk_app_opts_init, (struct spdk_app_opts *opts, size_t opts_size));
+DEFINE_STUB(spdk_app_parse_args, spdk_app_parse_args_rvals_t, (int argc, char **argv,
+		struct spdk_app_opts *opts, const char *getopt_str,
+		const struct option *app_long_opts, int (*parse)(int ch, char *arg),
+		void (*usage)(void)), 0);
+DEFINE_STUB(spdk_app_start, int, (struct spdk_app_opts *opts_user, spdk_msg_fn start_fn, void *ctx),
+		0);
+DEFINE_STUB_V(spdk_app_stop, (int rc));
+DEFINE_STUB_V(spdk_app_usage, (void));
+DEFINE_STUB(spdk_bdev_abort, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *bio_cb_arg, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB_V(spdk_bdev_channel_get_histogram, (struct spdk_io_channel *ch,
+		spdk_bdev_histogram_data_cb cb_fn, void *cb_arg));
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB(spdk_bdev_desc_get_block_size, uint32_t, (struct spdk_bdev_desc *desc), 0);
+DEFINE_STUB(spdk_bdev_desc_get_dif_pi_format, enum spdk_dif_pi_format,
+		(struct spdk_bdev_desc *desc), 0);
+DEFINE_STUB(spdk_bdev_desc_get_dif_type, enum spdk_dif_type, (struct spdk_bdev_desc *desc), 0);
+DEFINE_STUB(spdk_bdev_desc_get_md_size, uint32_t, (struct spdk_bdev_desc *desc), 0);
+DEFINE_STUB(spdk_bdev_desc_is_dif_check_enabled, bool, (struct spdk_bdev_desc *desc,
+		enum spdk_dif_check_type check_type), false);
+DEFINE_STUB(spdk_bdev_desc_is_dif_head_of_md, bool, (struct spdk_bdev_desc *desc), false);
+DEFINE_STUB(spdk_bdev_desc_is_md_interleaved, bool, (struct spdk_bdev_desc *desc), false);
+DEFINE_STUB(spdk_bdev_desc_is_md_separate, bool, (struct spdk_bdev_desc *desc), false);
+DEFINE_STUB(spdk_bdev_flush_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB(spdk_bdev_get_block_size, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_buf_align, size_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_by_name, struct spdk_bdev *, (const char *bdev_name), NULL);
+DEFINE_STUB(spdk_bdev_get_data_block_size, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_dif_pi_format, enum spdk_dif_pi_format, (const struct spdk_bdev *bdev),
+		0);
+DEFINE_STUB(spdk_bdev_get_dif_type, enum spdk_dif_type, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_io_channel, struct spdk_io_channel *, (struct spdk_bdev_desc *desc),
+		NULL);
+DEFINE_STUB(spdk_bdev_get_md_size, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), NULL);
+DEFINE_STUB(spdk_bdev_get_num_blocks, uint64_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_numa_id, int32_t, (struct spdk_bdev *bdev), 0);
+DEFINE_STUB_V(spdk_bdev_histogram_enable, (struct spdk_bdev *bdev,
+		spdk_bdev_histogram_status_cb cb_fn, void *cb_arg, bool enable));
+DEFINE_STUB(spdk_bdev_io_get_cb_arg, void *, (struct spdk_bdev_io *bdev_io), NULL);
+DEFINE_STUB_V(spdk_bdev_io_get_iovec, (struct spdk_bdev_io *bdev_io, struct iovec **iovp,
+		int *iovcntp));
+DEFINE_STUB(spdk_bdev_io_get_md_buf, void *, (struct spdk_bdev_io *bdev_io), NULL);
+DEFINE_STUB(spdk_bdev_io_type_supported, bool, (struct spdk_bdev *bdev,
+		enum spdk_bdev_io_type io_type), false);
+DEFINE_STUB(spdk_bdev_is_dif_head_of_md, bool, (const struct spdk_bdev *bdev), false);
+DEFINE_STUB(spdk_bdev_is_md_interleaved, bool, (const struct spdk_bdev *bdev), false);
+DEFINE_STUB(spdk_bdev_is_md_separate, bool, (const struct spdk_bdev *bdev), false);
+DEFINE_STUB(spdk_bdev_open_ext_v2, int, (const char *bdev_name, bool write,
+		spdk_bdev_event_cb_t event_cb, void *event_ctx, struct spdk_bdev_open_opts *opts,
+		struct spdk_bdev_desc **desc), 0);
+DEFINE_STUB_V(spdk_bdev_open_opts_init, (struct spdk_bdev_open_opts *opts, size_t opts_size));
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB(spdk_bdev_readv_blocks_with_md, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, struct iovec *iov, int iovcnt, void *md,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_reset, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_set_timeout, int, (struct spdk_bdev_desc *desc, uint64_t timeout_in_sec,
+		spdk_bdev_io_timeout_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_unmap_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_write_zeroes_blocks, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, uint64_t offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_writev_blocks_with_md, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, struct iovec *iov, int iovcnt, void *md,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_zcopy_end, int, (struct spdk_bdev_io *bdev_io, bool commit,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_zcopy_start, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+		bool populate, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_conf_allocate, struct spdk_conf *, (void), NULL);
+DEFINE_STUB_V(spdk_conf_disable_sections_merge, (struct spdk_conf *cp));
+DEFINE_STUB(spdk_conf_first_section, struct spdk_conf_section *, (struct spdk_conf *cp), NULL);
+DEFINE_STUB_V(spdk_conf_free, (struct spdk_conf *cp));
+DEFINE_STUB(spdk_conf_next_section, struct spdk_conf_section *, (struct spdk_conf_section *sp),
+		NULL);
+DEFINE_STUB(spdk_conf_read, int, (struct spdk_conf *cp, const char *file), 0);
+DEFINE_STUB(spdk_conf_section_get_intval, int, (struct spdk_conf_section *sp, const char *key), 0);
+DEFINE_STUB(spdk_conf_section_get_name, const char *, (const struct spdk_conf_section *sp), NULL);
+DEFINE_STUB(spdk_conf_section_get_val, char *, (struct spdk_conf_section *sp, const char *key),
+		NULL);
+DEFINE_STUB(spdk_for_each_bdev_leaf, int, (void *ctx, spdk_for_each_bdev_fn fn), 0);
+DEFINE_STUB(spdk_jsonrpc_begin_result, struct spdk_json_write_ctx *,
+		(struct spdk_jsonrpc_request *request), NULL);
+DEFINE_STUB_V(spdk_jsonrpc_end_result, (struct spdk_jsonrpc_request *request,
+		struct spdk_json_write_ctx *w));
+DEFINE_STUB_V(spdk_jsonrpc_send_error_response, (struct spdk_jsonrpc_request *request,
+		int error_code, const char *msg));
+DEFINE_STUB_V(spdk_jsonrpc_send_error_response_fmt, (struct spdk_jsonrpc_request *request,
+		int error_code, const char *fmt, ...));
+DEFINE_STUB_V(spdk_rpc_register_method, (const char *method, spdk_rpc_method_handler func,
+		uint32_t state_mask));
+
+
+#define UT_NUM_TASKS 3
+
+static struct bdevperf_task g_tasks[UT_NUM_TASKS];
+
+static void
+ut_job_init(struct bdevperf_job *job)
+{
+	int i;
+
+	memset(job, 0, sizeof(*job));
+	TAILQ_INIT(&job->task_list);
+	for (i = 0; i < UT_NUM_TASKS; i++) {
+		memset(&g_tasks[i], 0, sizeof(g_tasks[i]));
+		g_tasks[i].job = job;
+		TAILQ_INSERT_TAIL(&job->task_list, &g_tasks[i], link);
+	}
+}
+
+static void
+ut_task_complete(struct bdevperf_job *job, struct bdevperf_task *task)
+{
+	job->current_queue_depth--;
+	job->arrivals_outstanding--;
+	TAILQ_INSERT_TAIL(&job->task_list, task, link);
+}
+
+static void
+arrival_interval(void)
+{
+	struct bdevperf_job job = {};
+	uint64_t sum = 0;
+	int i;
+
+	job.arrival_interval_ticks = 100.4;
+	job.seed = 1;
+
+	/* Fixed intervals are the inverse of the rate */
+	g_arrival_fixed = true;
+	CU_ASSERT(bdevperf_job_get_arrival_interval(&job) == 100);
+	CU_ASSERT(bdevperf_job_get_arrival_interval(&job) == 100);
+
+	/* Poisson arrivals vary, but their mean interval is still the inverse of the rate */
+	g_arrival_fixed = false;
+	for (i = 0; i < 10000; i++) {
+		sum += bdevperf_job_get_arrival_interval(&job);
+	}
+	CU_ASSERT(sum / 10000 >= 95 && sum / 10000 <= 105);
+}
+
+static void
+arrival_poll(void)
+{
+	struct bdevperf_job job;
+	struct bdevperf_task *task;
+
+	ut_job_init(&job);
+	job.open_loop = true;
+	job.flush = true;
+	job.queue_depth = 2;
+	job.size_in_ios = 16;
+	job.io_size_blocks = 1;
+	job.arrival_interval_ticks = 10;
+	g_arrival_fixed = true;
+
+	/* Nothing is due yet */
+	job.next_arrival_tsc = 10;
+	MOCK_SET(spdk_get_ticks, 5);
+	CU_ASSERT(bdevperf_job_arrival_poll(&job) == SPDK_POLLER_IDLE);
+	CU_ASSERT(job.arrivals_submitted == 0);
+
+	/* Arrivals due at 10 and 20 are submitted, the one at 30 finds the queue full */
+	MOCK_SET(spdk_get_ticks, 35);
+	CU_ASSERT(bdevperf_job_arrival_poll(&job) == SPDK_POLLER_BUSY);
+	CU_ASSERT(job.arrivals_submitted == 2);
+	CU_ASSERT(job.arrivals_outstanding == 2);
+	CU_ASSERT(job.current_queue_depth == 2);
+	CU_ASSERT(job.arrivals_delayed == 0);
+	CU_ASSERT(job.next_arrival_tsc == 30);
+	CU_ASSERT(job.last_blocked_tsc == 35);
+	CU_ASSERT(g_tasks[0].arrival_tsc == 10);
+	CU_ASSERT(g_tasks[1].arrival_tsc == 20);
+	CU_ASSERT(job.arrival_lag_ticks == 25 + 15);
+	CU_ASSERT(job.arrival_max_lag_ticks == 25);
+
+	/* Still blocked */
+	MOCK_SET(spdk_get_ticks, 36);
+	CU_ASSERT(bdevperf_job_arrival_poll(&job) == SPDK_POLLER_IDLE);
+	CU_ASSERT(job.arrivals_submitted == 2);
+	CU_ASSERT(job.last_blocked_tsc == 36);
+
+	/* A task completes. The arrival at 30 waited for it, so it is counted as delayed and
+	 * keeps its arrival time for the latency. */
+	ut_task_complete(&job, &g_tasks[0]);
+	MOCK_SET(spdk_get_ticks, 38);
+	CU_ASSERT(bdevperf_job_arrival_poll(&job) == SPDK_POLLER_BUSY);
+	CU_ASSERT(job.arrivals_submitted == 3);
+	CU_ASSERT(job.arrivals_delayed == 1);
+	task = &g_tasks[2];
+	CU_ASSERT(task->arrival_tsc == 30);
+	CU_ASSERT(job.next_arrival_tsc == 40);
+	CU_ASSERT(job.arrival_max_lag_ticks == 25);
+
+	/* Once the queue drains, arrivals are on time again */
+	ut_task_complete(&job, &g_tasks[1]);
+	ut_task_complete(&job, task);
+	MOCK_SET(spdk_get_ticks, 40);
+	CU_ASSERT(bdevperf_job_arrival_poll(&job) == SPDK_POLLER_BUSY);
+	CU_ASSERT(job.arrivals_submitted == 4);
+	CU_ASSERT(job.arrivals_delayed == 1);
+	CU_ASSERT(job.next_arrival_tsc == 50);
+
+	MOCK_CLEAR(spdk_get_ticks);
+	g_arrival_fixed = false;
+}
+
+static void
+ut_histogram_count(void *ctx, uint64_t start, uint64_t end, uint64_t count,
+		   uint64_t total, uint64_t so_far)
+{
+	uint64_t *num_ios = ctx;
+
+	*num_ios += count;
+}
+
+static void
+latency_slo(void)
+{
+	struct bdevperf_job job = {};
+	struct bdevperf_task task = {};
+	uint64_t num_ios = 0;
+
+	CU_ASSERT(get_slo_attainment(&job) == 0.0);
+
+	job.slo_latency_ticks = 100;
+	task.arrival_tsc = 1000;
+
+	/* Within the SLO, including its bound */
+	MOCK_SET(spdk_get_ticks, 1050);
+	bdevperf_job_account_latency(&job, &task, true);
+	MOCK_SET(spdk_get_ticks, 1100);
+	bdevperf_job_account_latency(&job, &task, true);
+	CU_ASSERT(job.io_within_slo == 2);
+
+	/* Too slow */
+	MOCK_SET(spdk_get_ticks, 1101);
+	bdevperf_job_account_latency(&job, &task, true);
+	CU_ASSERT(job.io_within_slo == 2);
+
+	/* Failed I/O never meets the SLO */
+	MOCK_SET(spdk_get_ticks, 1010);
+	bdevperf_job_account_latency(&job, &task, false);
+	CU_ASSERT(job.io_within_slo == 2);
+
+	job.io_completed = 3;
+	job.io_failed = 1;
+	CU_ASSERT(get_slo_attainment(&job) == 50.0);
+
+	/* In open-loop mode the job keeps its own histogram, from the arrival time */
+	job.open_loop = true;
+	job.histogram = spdk_histogram_data_alloc();
+	SPDK_CU_ASSERT_FATAL(job.histogram != NULL);
+	bdevperf_job_account_latency(&job, &task, true);
+	bdevperf_job_account_latency(&job, &task, false);
+	spdk_histogram_data_iterate(job.histogram, ut_histogram_count, &num_ios);
+	CU_ASSERT(num_ios == 2);
+	CU_ASSERT(job.io_within_slo == 3);
+	spdk_histogram_data_free(job.histogram);
+
+	MOCK_CLEAR(spdk_get_ticks);
+}
+
+static void
+replay_prep_task(void)
+{
+	struct bdevperf_replay_io ios[] = {
+		{ .offset = 1000, .length = 1000, .io_type = SPDK_BDEV_IO_TYPE_READ },
+		{ .offset = 99 * 512, .length = 4096, .io_type = SPDK_BDEV_IO_TYPE_WRITE },
+		{ .offset = 0, .length = 0, .io_type = SPDK_BDEV_IO_TYPE_FLUSH },
+		{ .offset = 0, .length = 200 * 512, .io_type = SPDK_BDEV_IO_TYPE_WRITE },
+	};
+	struct bdevperf_replay_file file = { .ios = ios, .num_ios = SPDK_COUNTOF(ios) };
+	struct bdevperf_job job;
+	struct bdevperf_task *task = &g_tasks[0];
+
+	ut_job_init(&job);
+	job.replay = &file;
+	job.io_size_blocks = 8;
+	MOCK_SET(spdk_bdev_get_data_block_size, 512);
+	MOCK_SET(spdk_bdev_desc_get_block_size, 512);
+	MOCK_SET(spdk_bdev_get_num_blocks, 100);
+
+	/* Byte ranges are rounded out to whole blocks */
+	bdevperf_job_replay_prep_task(&job, task);
+	CU_ASSERT(task->io_type == SPDK_BDEV_IO_TYPE_READ);
+	CU_ASSERT(task->offset_blocks == 1);
+	CU_ASSERT(task->num_blocks == 3);
+	CU_ASSERT(task->iov.iov_len == 3 * 512);
+
+	/* I/O beyond the end of the bdev wraps around */
+	bdevperf_job_replay_prep_task(&job, task);
+	CU_ASSERT(task->io_type == SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(task->offset_blocks == 99 % (100 - 8 + 1));
+	CU_ASSERT(task->num_blocks == 8);
+	CU_ASSERT(task->iov.iov_len == 8 * 512);
+
+	/* A flush without a range covers the whole bdev */
+	bdevperf_job_replay_prep_task(&job, task);
+	CU_ASSERT(task->io_type == SPDK_BDEV_IO_TYPE_FLUSH);
+	CU_ASSERT(task->offset_blocks == 0);
+	CU_ASSERT(task->num_blocks == 100);
+	CU_ASSERT(!job.is_draining);
+
+	/* I/O larger than the bdev is clamped, and the last one drains the job */
+	bdevperf_job_replay_prep_task(&job, task);
+	CU_ASSERT(task->offset_blocks == 0);
+	CU_ASSERT(task->num_blocks == 100);
+	CU_ASSERT(task->iov.iov_len == 8 * 512);
+	CU_ASSERT(job.is_draining);
+
+	MOCK_CLEAR(spdk_bdev_get_data_block_size);
+	MOCK_CLEAR(spdk_bdev_desc_get_block_size);
+	MOCK_CLEAR(spdk_bdev_get_num_blocks);
+}
+
+static int
+ut_tokenize(char *line, char **tokens)
+{
+	char *saveptr;
+	int num_tokens = 0;
+
+	for (tokens[0] = strtok_r(line, " ", &saveptr); tokens[num_tokens] != NULL;
+	     tokens[num_tokens] = strtok_r(NULL, " ", &saveptr)) {
+		num_tokens++;
+	}
+
+	return num_tokens;
+}
+
+static int
+ut_parse_fio_iolog(const char *str, int version, const char **name,
+		   struct bdevperf_replay_io *io)
+{
+	static char line[128];
+	char *tokens[REPLAY_MAX_TOKENS];
+	int num_tokens;
+
+	snprintf(line, sizeof(line), "%s", str);
+	num_tokens = ut_tokenize(line, tokens);
+	memset(io, 0, sizeof(*io));
+
+	return parse_fio_iolog_line(tokens, num_tokens, version, name, io);
+}
+
+static int
+ut_parse_blkparse(const char *str, const char **name, struct bdevperf_replay_io *io)
+{
+	static char line[128];
+	char *tokens[REPLAY_MAX_TOKENS];
+	int num_tokens;
+
+	snprintf(line, sizeof(line), "%s", str);
+	num_tokens = ut_tokenize(line, tokens);
+	memset(io, 0, sizeof(*io));
+
+	return parse_blkparse_line(tokens, num_tokens, name, io);
+}
+
+static void
+replay_parse_lines(void)
+{
+	struct bdevperf_replay_io io;
+	const char *name = NULL;
+
+	/* fio iolog version 2 */
+	CU_ASSERT(ut_parse_fio_iolog("/dev/sda add", 2, &name, &io) == 0);
+	CU_ASSERT(ut_parse_fio_iolog("/dev/sda open", 2, &name, &io) == 0);
+	CU_ASSERT(ut_parse_fio_iolog("/dev/sda read 4096 8192", 2, &name, &io) == 1);
+	CU_ASSERT(strcmp(name, "/dev/sda") == 0);
+	CU_ASSERT(io.io_type == SPDK_BDEV_IO_TYPE_READ);
+	CU_ASSERT(io.offset == 4096);
+	CU_ASSERT(io.length == 8192);
+	CU_ASSERT(io.time_in_usec == 0);
+	CU_ASSERT(ut_parse_fio_iolog("/dev/sda trim 0 1048576", 2, &name, &io) == 1);
+	CU_ASSERT(io.io_type == SPDK_BDEV_IO_TYPE_UNMAP);
+	CU_ASSERT(ut_parse_fio_iolog("/dev/sda sync", 2, &name, &io) == 1);
+	CU_ASSERT(io.io_type == SPDK_BDEV_IO_TYPE_FLUSH);
+	CU_ASSERT(io.length == 0);
+	CU_ASSERT(ut_parse_fio_iolog("/dev/sda write 4096", 2, &name, &io) == -EINVAL);
+	CU_ASSERT(ut_parse_fio_iolog("/dev/sda write 4096 0", 2, &name, &io) == -EINVAL);
+	CU_ASSERT(ut_parse_fio_iolog("/dev/sda write 4k 4096", 2, &name, &io) == -EINVAL);
+
+	/* fio iolog version 3 adds a timestamp in msec */
+	CU_ASSERT(ut_parse_fio_iolog("1500 /dev/sdb write 512 4096", 3, &name, &io) == 1);
+	CU_ASSERT(strcmp(name, "/dev/sdb") == 0);
+	CU_ASSERT(io.io_type == SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(io.time_in_usec == 1500 * 1000);
+	CU_ASSERT(io.offset == 512);
+	CU_ASSERT(io.length == 4096);
+	CU_ASSERT(ut_parse_fio_iolog("/dev/sdb write 512 4096", 3, &name, &io) == -EINVAL);
+
+	/* blkparse, only the queue events are replayed */
+	CU_ASSERT(ut_parse_blkparse("8,0 3 1 0.000012000 1234 Q WS 2048 + 16 [fio]",
+				    &name, &io) == 1);
+	CU_ASSERT(strcmp(name, "8,0") == 0);
+	CU_ASSERT(io.io_type == SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(io.time_in_usec == 12);
+	CU_ASSERT(io.offset == 2048 * 512);
+	CU_ASSERT(io.length == 16 * 512);
+	CU_ASSERT(ut_parse_blkparse("8,0 3 2 0.000020000 1234 Q R 8 + 8 [fio]", &name, &io) == 1);
+	CU_ASSERT(io.io_type == SPDK_BDEV_IO_TYPE_READ);
+	CU_ASSERT(ut_parse_blkparse("8,0 3 3 0.000030000 1234 Q DS 0 + 2048 [fio]",
+				    &name, &io) == 1);
+	CU_ASSERT(io.io_type == SPDK_BDEV_IO_TYPE_UNMAP);
+	CU_ASSERT(ut_parse_blkparse("8,0 0 4 0.5 99 Q FWS [kworker]", &name, &io) == 1);
+	CU_ASSERT(io.io_type == SPDK_BDEV_IO_TYPE_FLUSH);
+	CU_ASSERT(io.offset == 0);
+	CU_ASSERT(io.length == 0);
+	CU_ASSERT(ut_parse_blkparse("8,0 3 5 0.000040000 1234 C WS 2048 + 16 [0]",
+				    &name, &io) == 0);
+	CU_ASSERT(ut_parse_blkparse("8,0 0 6 0.6 99 Q RS [kworker]", &name, &io) == 0);
+	CU_ASSERT(ut_parse_blkparse("CPU3 (8,0):", &name, &io) == 0);
+	CU_ASSERT(ut_parse_blkparse("Total (8,0):", &name, &io) == 0);
+}
+
+static void
+ut_write_trace(char *path, const char *trace)
+{
+	int fd;
+
+	fd = mkstemp(path);
+	SPDK_CU_ASSERT_FATAL(fd >= 0);
+	SPDK_CU_ASSERT_FATAL(write(fd, trace, strlen(trace)) == (ssize_t)strlen(trace));
+	close(fd);
+}
+
+static void
+replay_read_log(void)
+{
+	char path[] = "/tmp/bdevperf_ut.XXXXXX";
+	struct bdevperf_replay_file *file;
+
+	/* Devices are kept in sync, relative to the first I/O of the trace */
+	ut_write_trace(path, "fio version 3 iolog\n"
+		       "1000 /dev/sda add\n"
+		       "1000 /dev/sdb add\n"
+		       "1002 /dev/sda read 0 4096\n"
+		       "1003 /dev/sdb trim 0 8192\n"
+		       "\n"
+		       "1005 /dev/sda write 4096 4096\n");
+	g_replay_log_file_name = path;
+	CU_ASSERT(read_replay_log() == 0);
+	unlink(path);
+
+	file = TAILQ_FIRST(&g_replay_files);
+	SPDK_CU_ASSERT_FATAL(file != NULL);
+	CU_ASSERT(strcmp(file->name, "/dev/sda") == 0);
+	CU_ASSERT(file->num_ios == 2);
+	CU_ASSERT(file->num_unmaps == 0);
+	CU_ASSERT(file->ios[0].time_in_usec == 0);
+	CU_ASSERT(file->ios[1].time_in_usec == 3000);
+	file = TAILQ_NEXT(file, link);
+	SPDK_CU_ASSERT_FATAL(file != NULL);
+	CU_ASSERT(strcmp(file->name, "/dev/sdb") == 0);
+	CU_ASSERT(file->num_ios == 1);
+	CU_ASSERT(file->num_unmaps == 1);
+	CU_ASSERT(file->ios[0].time_in_usec == 1000);
+	CU_ASSERT(TAILQ_NEXT(file, link) == NULL);
+	CU_ASSERT(g_replay_timed);
+	free_replay_log();
+
+	/* Version 2 has no timestamps, it is replayed at queue depth */
+	snprintf(path, sizeof(path), "/tmp/bdevperf_ut.XXXXXX");
+	ut_write_trace(path, "fio version 2 iolog\n"
+		       "/dev/sda add\n"
+		       "/dev/sda write 0 4096\n");
+	CU_ASSERT(read_replay_log() == 0);
+	unlink(path);
+	CU_ASSERT(!g_replay_timed);
+	free_replay_log();
+
+	/* A trace without any I/O or with a malformed line is rejected */
+	snprintf(path, sizeof(path), "/tmp/bdevperf_ut.XXXXXX");
+	ut_write_trace(path, "fio version 2 iolog\n"
+		       "/dev/sda add\n");
+	CU_ASSERT(read_replay_log() != 0);
+	unlink(path);
+	free_replay_log();
+
+	snprintf(path, sizeof(path), "/tmp/bdevperf_ut.XXXXXX");
+	ut_write_trace(path, "fio version 2 iolog\n"
+		       "/dev/sda write 0 4096\n"
+		       "/dev/sda read 4096\n");
+	CU_ASSERT(read_replay_log() != 0);
+	unlink(path);
+	free_replay_log();
+
+	g_replay_log_file_name = NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("bdevperf", NULL, NULL);
+
+	CU_ADD_TEST(suite, arrival_interval);
+	CU_ADD_TEST(suite, arrival_poll);
+	CU_ADD_TEST(suite, latency_slo);
+	CU_ADD_TEST(suite, replay_prep_task);
+	CU_ADD_TEST(suite, replay_parse_lines);
+	CU_ADD_TEST(suite, replay_read_log);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
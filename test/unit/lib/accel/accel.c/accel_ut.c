@@ -271,6 +271,88 @@ test_spdk_accel_submit_copy(void)
 	CU_ASSERT(expected_accel_task == &task);
 }
 
+static STAILQ_HEAD(, spdk_accel_task) g_hw_tasks = STAILQ_HEAD_INITIALIZER(g_hw_tasks);
+
+static int
+ut_hw_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *task)
+{
+	STAILQ_INSERT_TAIL(&g_hw_tasks, task, link);
+	return 0;
+}
+
+static void
+test_spdk_accel_overflow(void)
+{
+	uint8_t dst[3][TEST_SUBMIT_SIZE] = {};
+	uint8_t src[TEST_SUBMIT_SIZE];
+	struct spdk_accel_task task[3] = {}, *t;
+	struct spdk_accel_task_aux_data task_aux[3];
+	struct spdk_io_channel *overflow_ch;
+	struct sw_accel_io_channel *overflow_sw_ch;
+	uint32_t cb_arg = DUMMY_ARG;
+	int i, rc;
+
+	overflow_ch = calloc(1, sizeof(struct spdk_io_channel) + sizeof(struct sw_accel_io_channel));
+	SPDK_CU_ASSERT_FATAL(overflow_ch != NULL);
+	overflow_sw_ch = spdk_io_channel_get_ctx(overflow_ch);
+	overflow_sw_ch->completion_poller = (void *)0xdeadbeef;
+	STAILQ_INIT(&overflow_sw_ch->tasks_to_complete);
+
+	/* The module assigned to copy only takes one task, the rest goes to software */
+	g_module_if.submit_tasks = ut_hw_submit_tasks;
+	g_opts.hw_queue_depth = 1;
+	g_overflow_module = &g_sw_module;
+	g_overflow_opc[SPDK_ACCEL_OPC_COPY] = true;
+	g_accel_ch->overflow_ch = overflow_ch;
+	memset(g_accel_ch->module_outstanding, 0, sizeof(g_accel_ch->module_outstanding));
+
+	STAILQ_INIT(&g_accel_ch->task_pool);
+	SLIST_INIT(&g_accel_ch->task_aux_data_pool);
+	for (i = 0; i < 3; i++) {
+		STAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task[i], link);
+		SLIST_INSERT_HEAD(&g_accel_ch->task_aux_data_pool, &task_aux[i], link);
+	}
+	memset(src, 0x5a, sizeof(src));
+
+	rc = spdk_accel_submit_copy(g_ch, dst[0], src, sizeof(src), dummy_cb_fn, &cb_arg);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(STAILQ_FIRST(&g_hw_tasks) == &task[0]);
+	CU_ASSERT(g_accel_ch->module_outstanding[SPDK_ACCEL_OPC_COPY] == 1);
+
+	rc = spdk_accel_submit_copy(g_ch, dst[1], src, sizeof(src), dummy_cb_fn, &cb_arg);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(STAILQ_FIRST(&overflow_sw_ch->tasks_to_complete) == &task[1]);
+	CU_ASSERT(memcmp(dst[1], src, sizeof(src)) == 0);
+	CU_ASSERT(g_accel_ch->module_outstanding[SPDK_ACCEL_OPC_COPY] == 1);
+	STAILQ_REMOVE_HEAD(&overflow_sw_ch->tasks_to_complete, link);
+	spdk_accel_task_complete(&task[1], 0);
+	CU_ASSERT(g_accel_ch->module_outstanding[SPDK_ACCEL_OPC_COPY] == 1);
+
+	/* Once the hardware task completes, the next one is submitted to it again */
+	t = STAILQ_FIRST(&g_hw_tasks);
+	STAILQ_REMOVE_HEAD(&g_hw_tasks, link);
+	g_dummy_cb_called = false;
+	spdk_accel_task_complete(t, 0);
+	CU_ASSERT(g_dummy_cb_called);
+	CU_ASSERT(g_accel_ch->module_outstanding[SPDK_ACCEL_OPC_COPY] == 0);
+
+	rc = spdk_accel_submit_copy(g_ch, dst[2], src, sizeof(src), dummy_cb_fn, &cb_arg);
+	CU_ASSERT(rc == 0);
+	t = STAILQ_FIRST(&g_hw_tasks);
+	SPDK_CU_ASSERT_FATAL(t != NULL);
+	CU_ASSERT(g_accel_ch->module_outstanding[SPDK_ACCEL_OPC_COPY] == 1);
+	STAILQ_REMOVE_HEAD(&g_hw_tasks, link);
+	spdk_accel_task_complete(t, 0);
+	CU_ASSERT(g_accel_ch->module_outstanding[SPDK_ACCEL_OPC_COPY] == 0);
+
+	g_module_if.submit_tasks = sw_accel_submit_tasks;
+	g_opts.hw_queue_depth = 0;
+	g_overflow_module = NULL;
+	g_overflow_opc[SPDK_ACCEL_OPC_COPY] = false;
+	g_accel_ch->overflow_ch = NULL;
+	free(overflow_ch);
+}
+
 static void
 test_spdk_accel_submit_dualcast(void)
 {
@@ -575,6 +657,62 @@ test_spdk_accel_submit_xor(void)
 	CU_ASSERT(expected_accel_task == &task);
 }
 
+static void
+test_spdk_accel_submit_gf_dot_prod(void)
+{
+	const uint64_t nbytes = TEST_SUBMIT_SIZE;
+	uint8_t p[TEST_SUBMIT_SIZE] = {0};
+	uint8_t q[TEST_SUBMIT_SIZE] = {0};
+	uint8_t src1[TEST_SUBMIT_SIZE];
+	uint8_t src2[TEST_SUBMIT_SIZE];
+	void *sources[] = { src1, src2 };
+	void *dsts[] = { p, q };
+	const uint8_t coefs[] = { 1, 1, 1, 2 };
+	uint32_t nsrcs = SPDK_COUNTOF(sources);
+	uint64_t i;
+	int rc;
+	struct spdk_accel_task task;
+	struct spdk_accel_task_aux_data task_aux;
+	struct spdk_accel_task *expected_accel_task = NULL;
+
+	memset(src1, 0x5a, sizeof(src1));
+	memset(src2, 0x81, sizeof(src2));
+
+	STAILQ_INIT(&g_accel_ch->task_pool);
+	SLIST_INIT(&g_accel_ch->task_aux_data_pool);
+
+	/* Invalid number of destinations */
+	rc = spdk_accel_submit_gf_dot_prod(g_ch, dsts, 3, sources, nsrcs, coefs, nbytes, NULL, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* Fail with no tasks on _get_task() */
+	rc = spdk_accel_submit_gf_dot_prod(g_ch, dsts, 2, sources, nsrcs, coefs, nbytes, NULL, NULL);
+	CU_ASSERT(rc == -ENOMEM);
+
+	STAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	SLIST_INSERT_HEAD(&g_accel_ch->task_aux_data_pool, &task_aux, link);
+
+	/* submission OK, P = src1 + src2, Q = src1 + {02} * src2 */
+	rc = spdk_accel_submit_gf_dot_prod(g_ch, dsts, 2, sources, nsrcs, coefs, nbytes, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(task.nsrcs.srcs == sources);
+	CU_ASSERT(task.nsrcs.cnt == nsrcs);
+	CU_ASSERT(task.d.iovcnt == 1);
+	CU_ASSERT(task.d.iovs[0].iov_base == p);
+	CU_ASSERT(task.d.iovs[0].iov_len == nbytes);
+	CU_ASSERT(task.d2.iovcnt == 1);
+	CU_ASSERT(task.d2.iovs[0].iov_base == q);
+	CU_ASSERT(task.gf_coefs == coefs);
+	CU_ASSERT(task.op_code == SPDK_ACCEL_OPC_GF_DOT_PROD);
+	for (i = 0; i < nbytes; i++) {
+		CU_ASSERT(p[i] == (0x5a ^ 0x81));
+		CU_ASSERT(q[i] == (0x5a ^ 0x1f));
+	}
+	expected_accel_task = STAILQ_FIRST(&g_sw_ch->tasks_to_complete);
+	STAILQ_REMOVE_HEAD(&g_sw_ch->tasks_to_complete, link);
+	CU_ASSERT(expected_accel_task == &task);
+}
+
 static void
 test_spdk_accel_module_find_by_name(void)
 {
@@ -3937,7 +4075,8 @@ test_sequence_crc32(void)
 	g_seq_operations[SPDK_ACCEL_OPC_CRC32C].count = 0;
 
 	/* Now check copy+crc - This should not remove the copy. Otherwise the data does not
-	 * end up where the user expected it to be. */
+	 * end up where the user expected it to be.  Instead, both should be done as a single
+	 * copy_crc32c operation. */
 	seq = NULL;
 	completed = 0;
 	crc = 0;
@@ -3966,14 +4105,14 @@ test_sequence_crc32(void)
 	CU_ASSERT_EQUAL(completed, 2);
 	CU_ASSERT(ut_seq.complete);
 	CU_ASSERT_EQUAL(ut_seq.status, 0);
-	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_CRC32C].count, 1);
-	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_CRC32C].count, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY_CRC32C].count, 1);
 	CU_ASSERT_EQUAL(memcmp(buf, tmp[0], sizeof(buf)), 0);
 	CU_ASSERT_EQUAL(crc, spdk_crc32c_update(buf, sizeof(buf), ~0u));
-	g_seq_operations[SPDK_ACCEL_OPC_CRC32C].count = 0;
-	g_seq_operations[SPDK_ACCEL_OPC_COPY].count = 0;
+	g_seq_operations[SPDK_ACCEL_OPC_COPY_CRC32C].count = 0;
 
-	/* Check crc+copy - Again, the copy cannot be removed. */
+	/* Check crc+copy - Again, the copy cannot be removed, but it's fused with the crc. */
 	seq = NULL;
 	completed = 0;
 	crc = 0;
@@ -3998,16 +4137,55 @@ test_sequence_crc32(void)
 	ut_seq.complete = false;
 	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
 
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 2);
+	CU_ASSERT(ut_seq.complete);
+	CU_ASSERT_EQUAL(ut_seq.status, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_CRC32C].count, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY_CRC32C].count, 1);
+	CU_ASSERT_EQUAL(crc, spdk_crc32c_update(tmp[0], sizeof(tmp[0]), ~0u));
+	CU_ASSERT_EQUAL(memcmp(buf, tmp[0], sizeof(buf)), 0);
+	g_seq_operations[SPDK_ACCEL_OPC_COPY_CRC32C].count = 0;
+
+	/* Check that copy+crc isn't fused if copy_crc32c is executed by a different module */
+	g_modules_opc[SPDK_ACCEL_OPC_COPY_CRC32C].module = NULL;
+	seq = NULL;
+	completed = 0;
+	crc = 0;
+	memset(buf, 0x5a, sizeof(buf));
+	memset(&tmp[0], 0, sizeof(tmp[0]));
+
+	dst_iovs[0].iov_base = tmp[0];
+	dst_iovs[0].iov_len = sizeof(tmp[0]);
+	src_iovs[0].iov_base = buf;
+	src_iovs[0].iov_len = sizeof(buf);
+	rc = spdk_accel_append_copy(&seq, ioch, &dst_iovs[0], 1, NULL, NULL,
+				    &src_iovs[0], 1, NULL, NULL,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	src_iovs[1].iov_base = tmp[0];
+	src_iovs[1].iov_len = sizeof(tmp[0]);
+	rc = spdk_accel_append_crc32c(&seq, ioch, &crc, &src_iovs[1], 1, NULL, NULL, 0,
+				      ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	ut_seq.complete = false;
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
+
 	poll_threads();
 	CU_ASSERT_EQUAL(completed, 2);
 	CU_ASSERT(ut_seq.complete);
 	CU_ASSERT_EQUAL(ut_seq.status, 0);
 	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_CRC32C].count, 1);
 	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 1);
-	CU_ASSERT_EQUAL(crc, spdk_crc32c_update(tmp[0], sizeof(tmp[0]), ~0u));
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY_CRC32C].count, 0);
 	CU_ASSERT_EQUAL(memcmp(buf, tmp[0], sizeof(buf)), 0);
+	CU_ASSERT_EQUAL(crc, spdk_crc32c_update(buf, sizeof(buf), ~0u));
 	g_seq_operations[SPDK_ACCEL_OPC_CRC32C].count = 0;
 	g_seq_operations[SPDK_ACCEL_OPC_COPY].count = 0;
+	g_modules_opc[SPDK_ACCEL_OPC_COPY_CRC32C] = g_module;
 
 	/* Check a sequence with an operation at the beginning that can have its buffer changed, two
 	 * crc operations and a copy at the end.  The copy should be removed and the dst buffer of
@@ -4336,6 +4514,94 @@ test_sequence_dix(void)
 	poll_threads();
 }
 
+static void
+ut_sw_offload_cb(void *cb_arg, int status)
+{
+	int *done = cb_arg;
+
+	*done = status == 0 ? 1 : -1;
+}
+
+static void
+test_sw_offload(void)
+{
+	struct spdk_io_channel *ioch, *sw_ioch;
+	struct sw_accel_io_channel *sw_ch;
+	struct sw_accel_worker worker = {};
+	uint32_t block_size = 512, md_size = 8;
+	char buf[16 * (512 + 8)];
+	struct iovec iov = { .iov_base = buf, .iov_len = sizeof(buf) };
+	struct spdk_dif_ctx_init_ext_opts dif_opts;
+	struct spdk_dif_ctx dif_ctx = {};
+	struct spdk_dif_error dif_err;
+	int rc, done;
+
+	ioch = spdk_accel_get_io_channel();
+	SPDK_CU_ASSERT_FATAL(ioch != NULL);
+	sw_ioch = spdk_get_io_channel(&g_sw_module);
+	SPDK_CU_ASSERT_FATAL(sw_ioch != NULL);
+	sw_ch = spdk_io_channel_get_ctx(sw_ioch);
+
+	dif_opts.size = SPDK_SIZEOF(&dif_opts, dif_pi_format);
+	dif_opts.dif_pi_format = SPDK_DIF_PI_FORMAT_16;
+	rc = spdk_dif_ctx_init(&dif_ctx, block_size + md_size, md_size, true, false, SPDK_DIF_TYPE1,
+			       SPDK_DIF_FLAGS_GUARD_CHECK | SPDK_DIF_FLAGS_REFTAG_CHECK,
+			       10, 0, 0, 0, 0, &dif_opts);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+
+	/* Use the current thread as the worker, the task still has to go through it */
+	worker.thread = spdk_get_thread();
+	worker.ch = spdk_get_io_channel(&g_sw_module);
+	SPDK_CU_ASSERT_FATAL(worker.ch != NULL);
+	g_sw_workers = &worker;
+	g_sw_num_workers = 1;
+	g_sw_offload_min_size = 4096;
+
+	/* Operations at least sw_offload_min_size large are executed by the worker */
+	memset(buf, 0x5a, sizeof(buf));
+	done = 0;
+	rc = spdk_accel_submit_dif_generate(ioch, &iov, 1, 16, &dif_ctx, ut_sw_offload_cb, &done);
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT_EQUAL(sw_ch->num_offloaded, 1);
+	CU_ASSERT(STAILQ_EMPTY(&sw_ch->tasks_to_complete));
+
+	poll_threads();
+	CU_ASSERT_EQUAL(done, 1);
+	CU_ASSERT_EQUAL(sw_ch->num_offloaded, 0);
+	rc = spdk_dif_verify(&iov, 1, 16, &dif_ctx, &dif_err);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	/* Smaller ones are still executed inline */
+	memset(buf, 0xa5, sizeof(buf));
+	iov.iov_len = 4 * (block_size + md_size);
+	done = 0;
+	rc = spdk_accel_submit_dif_generate(ioch, &iov, 1, 4, &dif_ctx, ut_sw_offload_cb, &done);
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT_EQUAL(sw_ch->num_offloaded, 0);
+	CU_ASSERT(!STAILQ_EMPTY(&sw_ch->tasks_to_complete));
+
+	poll_threads();
+	CU_ASSERT_EQUAL(done, 1);
+	rc = spdk_dif_verify(&iov, 1, 4, &dif_ctx, &dif_err);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	/* Copies are never offloaded */
+	done = 0;
+	rc = spdk_accel_submit_copy(ioch, buf + 4096, buf, 4096, ut_sw_offload_cb, &done);
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT_EQUAL(sw_ch->num_offloaded, 0);
+
+	poll_threads();
+	CU_ASSERT_EQUAL(done, 1);
+
+	g_sw_workers = NULL;
+	g_sw_num_workers = 0;
+	spdk_put_io_channel(worker.ch);
+	spdk_put_io_channel(sw_ioch);
+	spdk_put_io_channel(ioch);
+	poll_threads();
+}
+
 static int
 test_sequence_setup(void)
 {
@@ -4428,11 +4694,13 @@ main(int argc, char **argv)
 	CU_ADD_TEST(seq_suite, test_sequence_crc32);
 	CU_ADD_TEST(seq_suite, test_sequence_dix_generate_verify);
 	CU_ADD_TEST(seq_suite, test_sequence_dix);
+	CU_ADD_TEST(seq_suite, test_sw_offload);
 
 	suite = CU_add_suite("accel", test_setup, test_cleanup);
 	CU_ADD_TEST(suite, test_spdk_accel_task_complete);
 	CU_ADD_TEST(suite, test_get_task);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_copy);
+	CU_ADD_TEST(suite, test_spdk_accel_overflow);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_dualcast);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_compare);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_fill);
@@ -4440,6 +4708,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_spdk_accel_submit_crc32cv);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_copy_crc32c);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_xor);
+	CU_ADD_TEST(suite, test_spdk_accel_submit_gf_dot_prod);
 	CU_ADD_TEST(suite, test_spdk_accel_module_find_by_name);
 	CU_ADD_TEST(suite, test_spdk_accel_module_register);
 
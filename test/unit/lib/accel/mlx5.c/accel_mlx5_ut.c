@@ -0,0 +1,320 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "common/lib/ut_multithread.c"
+#include "unit/lib/json_mock.c"
+
+#include "accel/mlx5/accel_mlx5.c"
+
+DEFINE_STUB(ibv_query_device, int, (struct ibv_context *context,
+		struct ibv_device_attr *device_attr), 0);
+DEFINE_STUB_V(rdma_free_devices, (struct ibv_context **));
+DEFINE_STUB(rdma_get_devices, struct ibv_context **, (int *), NULL);
+DEFINE_STUB_V(spdk_accel_driver_register, (struct spdk_accel_driver *driver));
+DEFINE_STUB(spdk_accel_get_memory_domain, struct spdk_memory_domain *, (void), NULL);
+DEFINE_STUB_V(spdk_accel_module_finish, (void));
+DEFINE_STUB_V(spdk_accel_sequence_continue, (struct spdk_accel_sequence *seq));
+DEFINE_STUB(spdk_accel_sequence_first_task, struct spdk_accel_task *,
+		(struct spdk_accel_sequence *seq), NULL);
+DEFINE_STUB(spdk_accel_set_driver, int, (const char *name), 0);
+DEFINE_STUB(spdk_memory_domain_get_dma_device_type, enum spdk_dma_device_type,
+		(struct spdk_memory_domain *domain), 0);
+DEFINE_STUB(spdk_memory_domain_get_user_context, void *, (struct spdk_memory_domain *domain,
+		size_t *ctx_size), NULL);
+DEFINE_STUB(spdk_memory_domain_transfer_data, int, (struct spdk_memory_domain *dst_domain,
+		void *dst_domain_ctx, struct iovec *dst_iov, uint32_t dst_iovcnt,
+		struct spdk_memory_domain *src_domain, void *src_domain_ctx, struct iovec *src_iov,
+		uint32_t src_iovcnt, struct spdk_memory_domain_translation_result *src_translation,
+		spdk_memory_domain_data_cpl_cb cpl_cb, void *cpl_cb_arg), 0);
+DEFINE_STUB(spdk_memory_domain_translate_data, int, (struct spdk_memory_domain *src_domain,
+		void *src_domain_ctx, struct spdk_memory_domain *dst_domain,
+		struct spdk_memory_domain_translation_ctx *dst_domain_ctx, void *addr, size_t len,
+		struct spdk_memory_domain_translation_result *result), 0);
+DEFINE_STUB(spdk_mempool_create_ctor, struct spdk_mempool *, (const char *name, size_t count,
+		size_t ele_size, size_t cache_size, int numa_id, spdk_mempool_obj_cb_t *obj_init,
+		void *obj_init_arg), NULL);
+DEFINE_STUB(spdk_mlx5_cq_create, int, (struct ibv_pd *pd, struct spdk_mlx5_cq_attr *cq_attr,
+		struct spdk_mlx5_cq **cq_out), 0);
+DEFINE_STUB(spdk_mlx5_cq_destroy, int, (struct spdk_mlx5_cq *cq), 0);
+DEFINE_STUB(spdk_mlx5_cq_poll_completions, int, (struct spdk_mlx5_cq *cq,
+		struct spdk_mlx5_cq_completion *comp, int max_completions), 0);
+DEFINE_STUB(spdk_mlx5_create_psv, struct spdk_mlx5_psv *, (struct ibv_pd *pd), NULL);
+DEFINE_STUB(spdk_mlx5_crypto_devs_allow, int, (const char *const dev_names[], size_t devs_count),
+		0);
+DEFINE_STUB(spdk_mlx5_crypto_get_dek_data, int, (struct spdk_mlx5_crypto_keytag *keytag,
+		struct ibv_pd *pd, struct spdk_mlx5_crypto_dek_data *data), 0);
+DEFINE_STUB(spdk_mlx5_crypto_keytag_create, int, (struct spdk_mlx5_crypto_dek_create_attr *attr,
+		struct spdk_mlx5_crypto_keytag **out), 0);
+DEFINE_STUB_V(spdk_mlx5_crypto_keytag_destroy, (struct spdk_mlx5_crypto_keytag *keytag));
+DEFINE_STUB(spdk_mlx5_destroy_psv, int, (struct spdk_mlx5_psv *psv), 0);
+DEFINE_STUB(spdk_mlx5_device_query_caps, int, (struct ibv_context *context,
+		struct spdk_mlx5_device_caps *caps), 0);
+DEFINE_STUB(spdk_mlx5_mkey_pool_destroy, int, (uint32_t flags, struct ibv_pd *pd), 0);
+DEFINE_STUB(spdk_mlx5_mkey_pool_get_bulk, int, (struct spdk_mlx5_mkey_pool *pool,
+		struct spdk_mlx5_mkey_pool_obj **mkeys, uint32_t mkeys_count), 0);
+DEFINE_STUB(spdk_mlx5_mkey_pool_get_ref, struct spdk_mlx5_mkey_pool *, (struct ibv_pd *pd,
+		uint32_t flags), NULL);
+DEFINE_STUB(spdk_mlx5_mkey_pool_init, int, (struct spdk_mlx5_mkey_pool_param *params,
+		struct ibv_pd *pd), 0);
+DEFINE_STUB_V(spdk_mlx5_mkey_pool_put_bulk, (struct spdk_mlx5_mkey_pool *pool,
+		struct spdk_mlx5_mkey_pool_obj **mkeys, uint32_t mkeys_count));
+DEFINE_STUB_V(spdk_mlx5_mkey_pool_put_ref, (struct spdk_mlx5_mkey_pool *pool));
+DEFINE_STUB_V(spdk_mlx5_qp_complete_send, (struct spdk_mlx5_qp *qp));
+DEFINE_STUB(spdk_mlx5_qp_create, int, (struct ibv_pd *pd, struct spdk_mlx5_cq *cq,
+		struct spdk_mlx5_qp_attr *qp_attr, struct spdk_mlx5_qp **qp_out), 0);
+DEFINE_STUB_V(spdk_mlx5_qp_destroy, (struct spdk_mlx5_qp *qp));
+DEFINE_STUB(spdk_mlx5_qp_get_verbs_qp, struct ibv_qp *, (struct spdk_mlx5_qp *qp), NULL);
+DEFINE_STUB(spdk_mlx5_qp_rdma_read, int, (struct spdk_mlx5_qp *qp, struct ibv_sge *sge,
+		uint32_t sge_count, uint64_t dstaddr, uint32_t rkey, uint64_t wrid, uint32_t flags),
+		0);
+DEFINE_STUB(spdk_mlx5_qp_rdma_write, int, (struct spdk_mlx5_qp *qp, struct ibv_sge *sge,
+		uint32_t sge_count, uint64_t dstaddr, uint32_t rkey, uint64_t wrid, uint32_t flags),
+		0);
+DEFINE_STUB(spdk_mlx5_qp_set_psv, int, (struct spdk_mlx5_qp *qp, uint32_t psv_index,
+		uint32_t crc_seed, uint64_t wr_id, uint32_t flags), 0);
+DEFINE_STUB(spdk_mlx5_umr_configure, int, (struct spdk_mlx5_qp *qp,
+		struct spdk_mlx5_umr_attr *umr_attr, uint64_t wr_id, uint32_t flags), 0);
+DEFINE_STUB(spdk_mlx5_umr_configure_crypto, int, (struct spdk_mlx5_qp *qp,
+		struct spdk_mlx5_umr_attr *umr_attr, struct spdk_mlx5_umr_crypto_attr *crypto_attr,
+		uint64_t wr_id, uint32_t flags), 0);
+DEFINE_STUB(spdk_mlx5_umr_configure_sig, int, (struct spdk_mlx5_qp *qp,
+		struct spdk_mlx5_umr_attr *umr_attr, struct spdk_mlx5_umr_sig_attr *sig_attr,
+		uint64_t wr_id, uint32_t flags), 0);
+DEFINE_STUB(spdk_mlx5_umr_configure_sig_crypto, int, (struct spdk_mlx5_qp *qp,
+		struct spdk_mlx5_umr_attr *umr_attr, struct spdk_mlx5_umr_sig_attr *sig_attr,
+		struct spdk_mlx5_umr_crypto_attr *crypto_attr, uint64_t wr_id, uint32_t flags), 0);
+DEFINE_STUB_V(spdk_mlx5_umr_implementer_register, (bool registered));
+DEFINE_STUB(spdk_rdma_utils_create_mem_map, struct spdk_rdma_utils_mem_map *, (struct ibv_pd *pd,
+		struct spdk_nvme_rdma_hooks *hooks, uint32_t access_flags), NULL);
+DEFINE_STUB_V(spdk_rdma_utils_free_mem_map, (struct spdk_rdma_utils_mem_map **map));
+DEFINE_STUB(spdk_rdma_utils_get_memory_domain, struct spdk_memory_domain *, (struct ibv_pd *pd),
+		NULL);
+DEFINE_STUB(spdk_rdma_utils_get_pd, struct ibv_pd *, (struct ibv_context *context), NULL);
+DEFINE_STUB(spdk_rdma_utils_get_translation, int, (struct spdk_rdma_utils_mem_map *map,
+		void *address, size_t length,
+		struct spdk_rdma_utils_memory_translation *translation), 0);
+DEFINE_STUB(spdk_rdma_utils_put_memory_domain, int, (struct spdk_memory_domain *_domain), 0);
+DEFINE_STUB_V(spdk_rdma_utils_put_pd, (struct ibv_pd *pd));
+
+
+static struct spdk_accel_task *g_completed[4];
+static int g_completed_status[4];
+static int g_num_completed;
+
+void
+spdk_accel_task_complete(struct spdk_accel_task *task, int status)
+{
+	SPDK_CU_ASSERT_FATAL(g_num_completed < (int)SPDK_COUNTOF(g_completed));
+	g_completed[g_num_completed] = task;
+	g_completed_status[g_num_completed] = status;
+	g_num_completed++;
+}
+
+struct spdk_accel_task *
+spdk_accel_sequence_next_task(struct spdk_accel_task *task)
+{
+	return TAILQ_NEXT(task, seq_link);
+}
+
+struct ut_seq {
+	TAILQ_HEAD(, spdk_accel_task) tasks;
+	struct accel_mlx5_task encrypt;
+	struct accel_mlx5_task crc;
+	struct iovec src_iovs[ACCEL_MLX5_MAX_SGE + 1];
+	struct iovec dst_iovs[ACCEL_MLX5_MAX_SGE + 1];
+	struct iovec crc_iovs[ACCEL_MLX5_MAX_SGE + 1];
+	uint32_t crc_dst;
+};
+
+static void
+ut_seq_init(struct ut_seq *seq, uint32_t iovcnt)
+{
+	uint32_t i;
+
+	memset(seq, 0, sizeof(*seq));
+	for (i = 0; i < iovcnt; i++) {
+		seq->src_iovs[i].iov_base = (void *)(uintptr_t)(0x10000 + i * 0x1000);
+		seq->src_iovs[i].iov_len = 0x1000;
+		seq->dst_iovs[i].iov_base = (void *)(uintptr_t)(0x80000 + i * 0x1000);
+		seq->dst_iovs[i].iov_len = 0x1000;
+	}
+	memcpy(seq->crc_iovs, seq->dst_iovs, sizeof(seq->dst_iovs));
+
+	seq->encrypt.base.op_code = SPDK_ACCEL_OPC_ENCRYPT;
+	seq->encrypt.base.s.iovs = seq->src_iovs;
+	seq->encrypt.base.s.iovcnt = iovcnt;
+	seq->encrypt.base.d.iovs = seq->dst_iovs;
+	seq->encrypt.base.d.iovcnt = iovcnt;
+
+	seq->crc.base.op_code = SPDK_ACCEL_OPC_CRC32C;
+	seq->crc.base.s.iovs = seq->crc_iovs;
+	seq->crc.base.s.iovcnt = iovcnt;
+	seq->crc.base.crc_dst = &seq->crc_dst;
+
+	TAILQ_INIT(&seq->tasks);
+	TAILQ_INSERT_TAIL(&seq->tasks, &seq->encrypt.base, seq_link);
+	TAILQ_INSERT_TAIL(&seq->tasks, &seq->crc.base, seq_link);
+}
+
+static void
+test_encrypt_crc_can_merge(void)
+{
+	struct spdk_memory_domain *domain = (struct spdk_memory_domain *)0xfeedbeef;
+	struct ut_seq seq;
+
+	/* crc32c over the encrypt destination */
+	ut_seq_init(&seq, 4);
+	CU_ASSERT(accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+
+	/* In-place encrypt, crc32c over the encrypt source */
+	seq.encrypt.base.d.iovcnt = 0;
+	CU_ASSERT(!accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+	seq.crc.base.s.iovs = seq.src_iovs;
+	CU_ASSERT(accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+
+	/* crc32c over a different buffer */
+	ut_seq_init(&seq, 4);
+	seq.crc_iovs[2].iov_base = (void *)0xdead0000;
+	CU_ASSERT(!accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+
+	/* crc32c over a part of the encrypt destination */
+	ut_seq_init(&seq, 4);
+	seq.crc.base.s.iovcnt = 3;
+	CU_ASSERT(!accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+
+	/* Memory domains don't match */
+	ut_seq_init(&seq, 4);
+	seq.encrypt.base.dst_domain = domain;
+	CU_ASSERT(!accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+	seq.crc.base.src_domain = domain;
+	CU_ASSERT(accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+	seq.crc.base.src_domain_ctx = &seq;
+	CU_ASSERT(!accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+
+	/* One destination sge is reserved for the CRC */
+	ut_seq_init(&seq, ACCEL_MLX5_MAX_SGE - 1);
+	CU_ASSERT(accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+	ut_seq_init(&seq, ACCEL_MLX5_MAX_SGE);
+	CU_ASSERT(!accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+	ut_seq_init(&seq, ACCEL_MLX5_MAX_SGE - 1);
+	seq.encrypt.base.s.iovcnt = ACCEL_MLX5_MAX_SGE + 1;
+	CU_ASSERT(!accel_mlx5_encrypt_crc_can_merge(&seq.encrypt.base, &seq.crc.base));
+}
+
+static void
+test_examine_sequence_encrypt_crc(void)
+{
+	struct spdk_mlx5_mkey_pool *pool = (struct spdk_mlx5_mkey_pool *)0xfeedbeef;
+	struct accel_mlx5_io_channel accel_ch = {};
+	struct accel_mlx5_task copy = {};
+	struct accel_mlx5_dev dev = {};
+	struct ut_seq seq;
+	int rc;
+
+	dev.qp.dev = &dev;
+	dev.sig_crypto_mkeys = pool;
+	dev.crypto_multi_block = true;
+	accel_ch.devs = &dev;
+	accel_ch.num_devs = 1;
+	g_accel_mlx5.crypto_supported = true;
+
+	/* Both tasks are executed with one UMR */
+	ut_seq_init(&seq, 4);
+	MOCK_SET(spdk_accel_sequence_first_task, &seq.encrypt.base);
+	rc = accel_mlx5_driver_examine_sequence((struct spdk_accel_sequence *)&seq, &accel_ch);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(seq.encrypt.qp == &dev.qp);
+	CU_ASSERT(seq.encrypt.mlx5_opcode == ACCEL_MLX5_OPC_ENCRYPT_AND_CRC32C);
+	CU_ASSERT(seq.encrypt.enc_order == SPDK_MLX5_ENCRYPTION_ORDER_ENCRYPTED_WIRE_SIGNATURE);
+	CU_ASSERT(g_num_completed == 0);
+
+	/* No multi-block crypto, the encrypt task is executed alone */
+	ut_seq_init(&seq, 4);
+	dev.crypto_multi_block = false;
+	rc = accel_mlx5_driver_examine_sequence((struct spdk_accel_sequence *)&seq, &accel_ch);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(seq.encrypt.mlx5_opcode == ACCEL_MLX5_OPC_CRYPTO);
+	CU_ASSERT(seq.encrypt.enc_order == SPDK_MLX5_ENCRYPTION_ORDER_ENCRYPTED_RAW_WIRE);
+
+	/* No signature+crypto mkeys */
+	ut_seq_init(&seq, 4);
+	dev.crypto_multi_block = true;
+	dev.sig_crypto_mkeys = NULL;
+	rc = accel_mlx5_driver_examine_sequence((struct spdk_accel_sequence *)&seq, &accel_ch);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(seq.encrypt.mlx5_opcode == ACCEL_MLX5_OPC_CRYPTO);
+	dev.sig_crypto_mkeys = pool;
+
+	/* crc32c is not the last task */
+	ut_seq_init(&seq, 4);
+	copy.base.op_code = SPDK_ACCEL_OPC_COPY;
+	TAILQ_INSERT_TAIL(&seq.tasks, &copy.base, seq_link);
+	rc = accel_mlx5_driver_examine_sequence((struct spdk_accel_sequence *)&seq, &accel_ch);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(seq.encrypt.mlx5_opcode == ACCEL_MLX5_OPC_CRYPTO);
+
+	/* crc32c doesn't cover the encrypted data */
+	ut_seq_init(&seq, 4);
+	seq.crc.base.s.iovs = seq.src_iovs;
+	rc = accel_mlx5_driver_examine_sequence((struct spdk_accel_sequence *)&seq, &accel_ch);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(seq.encrypt.mlx5_opcode == ACCEL_MLX5_OPC_CRYPTO);
+	CU_ASSERT(g_num_completed == 0);
+
+	MOCK_CLEAR(spdk_accel_sequence_first_task);
+	g_accel_mlx5.crypto_supported = false;
+}
+
+static void
+test_encrypt_crc_fail(void)
+{
+	struct accel_mlx5_dev dev = {};
+	struct ut_seq seq;
+
+	dev.qp.dev = &dev;
+
+	/* The merged crc32c task fails together with the encrypt one */
+	ut_seq_init(&seq, 4);
+	seq.encrypt.qp = &dev.qp;
+	seq.encrypt.mlx5_opcode = ACCEL_MLX5_OPC_ENCRYPT_AND_CRC32C;
+	g_num_completed = 0;
+	accel_mlx5_task_fail(&seq.encrypt, -EIO);
+	CU_ASSERT(g_num_completed == 2);
+	CU_ASSERT(g_completed[0] == &seq.encrypt.base);
+	CU_ASSERT(g_completed_status[0] == -EIO);
+	CU_ASSERT(g_completed[1] == &seq.crc.base);
+	CU_ASSERT(g_completed_status[1] == -EIO);
+
+	/* Not merged, only the encrypt task fails */
+	ut_seq_init(&seq, 4);
+	seq.encrypt.qp = &dev.qp;
+	seq.encrypt.mlx5_opcode = ACCEL_MLX5_OPC_CRYPTO;
+	g_num_completed = 0;
+	accel_mlx5_task_fail(&seq.encrypt, -EIO);
+	CU_ASSERT(g_num_completed == 1);
+	CU_ASSERT(g_completed[0] == &seq.encrypt.base);
+	g_num_completed = 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("accel_mlx5", NULL, NULL);
+	CU_ADD_TEST(suite, test_encrypt_crc_can_merge);
+	CU_ADD_TEST(suite, test_examine_sequence_encrypt_crc);
+	CU_ADD_TEST(suite, test_encrypt_crc_fail);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
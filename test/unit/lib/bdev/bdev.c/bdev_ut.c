@@ -45,6 +45,25 @@ spdk_memory_domain_push_data(struct spdk_memory_domain *dst_domain, void *dst_do
 	return 0;
 }
 
+/* Translations add this base to the address in the source domain, none if it's NULL */
+static void *g_memory_domain_translation_base;
+
+int
+spdk_memory_domain_translate_data(struct spdk_memory_domain *src_domain, void *src_domain_ctx,
+				  struct spdk_memory_domain *dst_domain, struct spdk_memory_domain_translation_ctx *dst_domain_ctx,
+				  void *addr, size_t len, struct spdk_memory_domain_translation_result *result)
+{
+	if (g_memory_domain_translation_base == NULL) {
+		return -ENOTSUP;
+	}
+
+	CU_ASSERT(dst_domain == spdk_memory_domain_get_system_domain());
+	result->iov_count = 1;
+	result->iov.iov_base = (uint8_t *)g_memory_domain_translation_base + (uintptr_t)addr;
+	result->iov.iov_len = len;
+	return 0;
+}
+
 struct spdk_io_channel *
 spdk_accel_get_io_channel(void)
 {
@@ -1216,6 +1235,60 @@ bdev_io_types_test(void)
 	ut_fini_bdev();
 }
 
+static void
+bdev_trace_sample_test(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_opts bdev_opts = {};
+	int i, rc;
+
+	spdk_bdev_get_opts(&bdev_opts, sizeof(bdev_opts));
+	bdev_opts.bdev_io_pool_size = 4;
+	bdev_opts.bdev_io_cache_size = 2;
+	bdev_opts.trace_sample_rate = 3;
+	ut_init_bdev(&bdev_opts);
+
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(io_ch != NULL);
+
+	/* Only every third I/O submitted on the channel is traced, starting with the first */
+	for (i = 0; i < 6; i++) {
+		g_bdev_io = NULL;
+		rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+		CU_ASSERT(rc == 0);
+		SPDK_CU_ASSERT_FATAL(g_bdev_io != NULL);
+		CU_ASSERT(spdk_bdev_io_trace_sampled(g_bdev_io) == (i % 3 == 0));
+		stub_complete_io(1);
+	}
+
+	/* 0 traces every I/O */
+	bdev_opts.trace_sample_rate = 0;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == 0);
+
+	for (i = 0; i < 3; i++) {
+		g_bdev_io = NULL;
+		rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+		CU_ASSERT(rc == 0);
+		SPDK_CU_ASSERT_FATAL(g_bdev_io != NULL);
+		CU_ASSERT(spdk_bdev_io_trace_sampled(g_bdev_io));
+		stub_complete_io(1);
+	}
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	ut_fini_bdev();
+}
+
 static void
 bdev_io_wait_test(void)
 {
@@ -1291,6 +1364,76 @@ bdev_io_wait_test(void)
 	ut_fini_bdev();
 }
 
+static void
+bdev_io_small_pool_test(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev_mgmt_channel *mgmt_ch;
+	struct spdk_bdev_opts bdev_opts = {};
+	struct bdev_ut_io_wait_entry io_wait_entry;
+	int rc, i;
+
+	/* bdev_ut_if has no I/O context, so its bdevs use the small pool */
+	spdk_bdev_get_opts(&bdev_opts, sizeof(bdev_opts));
+	bdev_opts.bdev_io_pool_size = 4;
+	bdev_opts.bdev_io_cache_size = 2;
+	bdev_opts.bdev_io_small_pool_size = 6;
+	bdev_opts.bdev_io_small_ctx_size = 0;
+	ut_init_bdev(&bdev_opts);
+
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+	mgmt_ch = bdev_ch->shared_resource->mgmt_ch;
+	CU_ASSERT(bdev_ch->io_cache == &mgmt_ch->small_io_cache);
+
+	/* More I/Os than the main pool holds can be outstanding */
+	for (i = 0; i < 6; i++) {
+		rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 6);
+	CU_ASSERT(mgmt_ch->io_cache.per_thread_cache_count == 2);
+
+	rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == -ENOMEM);
+
+	/* Waiters are woken up by I/Os returned to the small pool */
+	io_wait_entry.entry.bdev = bdev;
+	io_wait_entry.entry.cb_fn = io_wait_cb;
+	io_wait_entry.entry.cb_arg = &io_wait_entry;
+	io_wait_entry.io_ch = io_ch;
+	io_wait_entry.desc = desc;
+	io_wait_entry.submitted = false;
+	rc = spdk_bdev_queue_io_wait(bdev, io_ch, &io_wait_entry.entry);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(!TAILQ_EMPTY(&mgmt_ch->small_io_cache.io_wait_queue));
+
+	stub_complete_io(1);
+	CU_ASSERT(io_wait_entry.submitted == true);
+	CU_ASSERT(TAILQ_EMPTY(&mgmt_ch->small_io_cache.io_wait_queue));
+
+	stub_complete_io(6);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	ut_fini_bdev();
+
+	bdev_opts.bdev_io_small_pool_size = 0;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == 0);
+}
+
 static void
 bdev_io_spans_split_test(void)
 {
@@ -3035,12 +3178,12 @@ bdev_io_split_with_io_wait(void)
 	/* The first child I/O will be queued to wait until an spdk_bdev_io becomes available */
 	rc = spdk_bdev_read_blocks(desc, io_ch, (void *)0xF000, 14, 8, io_done, NULL);
 	CU_ASSERT(rc == 0);
-	CU_ASSERT(!TAILQ_EMPTY(&mgmt_ch->io_wait_queue));
+	CU_ASSERT(!TAILQ_EMPTY(&mgmt_ch->io_cache.io_wait_queue));
 	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
 
 	/* Completing the first read I/O will submit the first child */
 	stub_complete_io(1);
-	CU_ASSERT(TAILQ_EMPTY(&mgmt_ch->io_wait_queue));
+	CU_ASSERT(TAILQ_EMPTY(&mgmt_ch->io_cache.io_wait_queue));
 	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
 
 	/* Completing the first child will submit the second child */
@@ -3445,6 +3588,103 @@ bdev_io_alignment(void)
 	free(buf);
 }
 
+static void
+bdev_io_bounce_accel_copy(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev_opts bdev_opts = {};
+	struct spdk_bdev_io *bdev_io;
+	void *buf = NULL;
+	int rc;
+
+	spdk_bdev_get_opts(&bdev_opts, sizeof(bdev_opts));
+	bdev_opts.bdev_io_pool_size = 20;
+	bdev_opts.bdev_io_cache_size = 2;
+	bdev_opts.bounce_accel_copy_threshold = 1024;
+	ut_init_bdev(&bdev_opts);
+
+	fn_table.submit_request = stub_submit_request_get_buf;
+	bdev = allocate_bdev("bdev0");
+	bdev->required_alignment = spdk_u32log2(4096);
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+
+	rc = posix_memalign(&buf, 4096, 8192);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+
+	/* Bounce below the threshold, copied by the CPU */
+	g_io_done = false;
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf + 8, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(TAILQ_EMPTY(&bdev_ch->io_memory_domain));
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	stub_complete_io(1);
+	poll_threads();
+	CU_ASSERT(g_io_done == true);
+
+	/* Write bounce at the threshold, the I/O is submitted once accel copied the data */
+	g_io_done = false;
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf + 8, 0, 2, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	bdev_io = TAILQ_FIRST(&bdev_ch->io_memory_domain);
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	CU_ASSERT(bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(bdev_io->internal.f.has_bounce_buf == true);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+	bdev_io_pull_data_done_and_track(bdev_io, 0);
+	CU_ASSERT(TAILQ_EMPTY(&bdev_ch->io_memory_domain));
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	stub_complete_io(1);
+	poll_threads();
+	CU_ASSERT(g_io_done == true);
+
+	/* Read bounce, the I/O completes once accel copied the data out of the bounce buffer */
+	g_io_done = false;
+	rc = spdk_bdev_read_blocks(desc, io_ch, buf + 8, 0, 4, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(TAILQ_EMPTY(&bdev_ch->io_memory_domain));
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	stub_complete_io(1);
+	poll_threads();
+	CU_ASSERT(g_io_done == false);
+	bdev_io = TAILQ_FIRST(&bdev_ch->io_memory_domain);
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	CU_ASSERT(bdev_io->type == SPDK_BDEV_IO_TYPE_READ);
+	bdev_io_push_bounce_data_done_and_track(bdev_io, 0);
+	poll_threads();
+	CU_ASSERT(TAILQ_EMPTY(&bdev_ch->io_memory_domain));
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	/* Accel can't take the copy, the CPU does it */
+	MOCK_SET(spdk_accel_append_copy, -ENOMEM);
+	g_io_done = false;
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf + 8, 0, 4, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(TAILQ_EMPTY(&bdev_ch->io_memory_domain));
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	stub_complete_io(1);
+	poll_threads();
+	CU_ASSERT(g_io_done == true);
+	MOCK_CLEAR(spdk_accel_append_copy);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	fn_table.submit_request = stub_submit_request;
+	ut_fini_bdev();
+
+	free(buf);
+}
+
 static void
 bdev_io_alignment_with_boundary(void)
 {
@@ -3713,72 +3953,263 @@ bdev_histograms(void)
 	ut_fini_bdev();
 }
 
+static uint32_t g_heatmap_num_regions;
+static uint64_t g_heatmap_region_size;
+static uint64_t g_heatmap_count[SPDK_BDEV_HEATMAP_NUM_COUNTS(4)];
+
 static void
-_bdev_compare(bool emulated)
+heatmap_status_cb(void *cb_arg, int status)
 {
-	struct spdk_bdev *bdev;
-	struct spdk_bdev_desc *desc = NULL;
-	struct spdk_io_channel *ioch;
-	struct ut_expected_io *expected_io;
-	uint64_t offset, num_blocks;
-	uint32_t num_completed;
-	char aa_buf[512];
-	char bb_buf[512];
-	struct iovec compare_iov;
-	uint8_t expected_io_type;
-	int rc;
+	g_status = status;
+}
 
-	if (emulated) {
-		expected_io_type = SPDK_BDEV_IO_TYPE_READ;
-	} else {
-		expected_io_type = SPDK_BDEV_IO_TYPE_COMPARE;
+static void
+heatmap_data_cb(void *cb_arg, int status, const struct spdk_bdev_heatmap *heatmap)
+{
+	g_status = status;
+	if (status != 0) {
+		return;
 	}
 
-	memset(aa_buf, 0xaa, sizeof(aa_buf));
-	memset(bb_buf, 0xbb, sizeof(bb_buf));
+	g_heatmap_num_regions = heatmap->num_regions;
+	g_heatmap_region_size = heatmap->region_size;
+	SPDK_CU_ASSERT_FATAL(heatmap->num_regions <= 4);
+	memcpy(g_heatmap_count, heatmap->count,
+	       SPDK_BDEV_HEATMAP_NUM_COUNTS(heatmap->num_regions) * sizeof(uint64_t));
+}
 
-	g_io_types_supported[SPDK_BDEV_IO_TYPE_COMPARE] = !emulated;
+static uint64_t
+heatmap_total(void)
+{
+	uint64_t total = 0;
+	size_t i;
+
+	for (i = 0; i < SPDK_BDEV_HEATMAP_NUM_COUNTS(g_heatmap_num_regions); i++) {
+		total += g_heatmap_count[i];
+	}
+
+	return total;
+}
+
+static void
+bdev_heatmap(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_heatmap_opts opts;
+	uint8_t buf[4096];
+	int rc;
 
 	ut_init_bdev(NULL);
-	fn_table.submit_request = stub_submit_request_get_buf;
+
 	bdev = allocate_bdev("bdev");
 
 	rc = spdk_bdev_open_ext("bdev", true, bdev_ut_event_cb, NULL, &desc);
-	CU_ASSERT_EQUAL(rc, 0);
-	SPDK_CU_ASSERT_FATAL(desc != NULL);
-	CU_ASSERT(bdev == spdk_bdev_desc_get_bdev(desc));
-	ioch = spdk_bdev_get_io_channel(desc);
-	SPDK_CU_ASSERT_FATAL(ioch != NULL);
-
-	fn_table.submit_request = stub_submit_request_get_buf;
-	g_io_exp_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(desc != NULL);
 
-	offset = 50;
-	num_blocks = 1;
-	compare_iov.iov_base = aa_buf;
-	compare_iov.iov_len = sizeof(aa_buf);
+	ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(ch != NULL);
 
-	/* 1. successful comparev */
-	expected_io = ut_alloc_expected_io(expected_io_type, offset, num_blocks, 0);
-	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+	/* Heatmap isn't enabled yet */
+	g_status = 0;
+	spdk_bdev_heatmap_get(bdev, heatmap_data_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == -EINVAL);
+
+	/* Invalid number of regions */
+	spdk_bdev_heatmap_opts_init(&opts, sizeof(opts));
+	CU_ASSERT(opts.num_regions == SPDK_BDEV_HEATMAP_DEFAULT_NUM_REGIONS);
+	opts.num_regions = SPDK_BDEV_HEATMAP_MAX_NUM_REGIONS + 1;
+	g_status = 0;
+	spdk_bdev_heatmap_enable(bdev, heatmap_status_cb, NULL, true, &opts);
+	poll_threads();
+	CU_ASSERT(g_status == -EINVAL);
+	CU_ASSERT(bdev->internal.heatmap_enabled == false);
 
-	g_io_done = false;
-	g_compare_read_buf = aa_buf;
-	g_compare_read_buf_len = sizeof(aa_buf);
-	rc = spdk_bdev_comparev_blocks(desc, ioch, &compare_iov, 1, offset, num_blocks, io_done, NULL);
-	CU_ASSERT_EQUAL(rc, 0);
-	num_completed = stub_complete_io(1);
-	CU_ASSERT_EQUAL(num_completed, 1);
-	CU_ASSERT(g_io_done == true);
-	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	/* Split the 1024 blocks into 4 regions of 256 blocks */
+	opts.num_regions = 4;
+	g_status = -1;
+	spdk_bdev_heatmap_enable(bdev, heatmap_status_cb, NULL, true, &opts);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(bdev->internal.heatmap_enabled == true);
 
-	/* 2. miscompare comparev */
-	expected_io = ut_alloc_expected_io(expected_io_type, offset, num_blocks, 0);
-	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+	g_status = -1;
+	spdk_bdev_heatmap_get(bdev, heatmap_data_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(g_heatmap_num_regions == 4);
+	CU_ASSERT(g_heatmap_region_size == 256);
+	CU_ASSERT(heatmap_total() == 0);
 
-	g_io_done = false;
-	g_compare_read_buf = bb_buf;
-	g_compare_read_buf_len = sizeof(bb_buf);
+	/* 1 block written in 10 us to region 0 */
+	rc = spdk_bdev_write_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(10);
+	stub_complete_io(1);
+	poll_threads();
+
+	/* 8 blocks read in less than 1 us from region 2 */
+	rc = spdk_bdev_read_blocks(desc, ch, buf, 600, 8, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	stub_complete_io(1);
+	poll_threads();
+
+	/* 1 block written in 3 ms to the last region */
+	rc = spdk_bdev_write_blocks(desc, ch, buf, 1000, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(3000);
+	stub_complete_io(1);
+	poll_threads();
+
+	/* Flushes don't address a range of blocks, so they aren't counted */
+	rc = spdk_bdev_flush_blocks(desc, ch, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	stub_complete_io(1);
+	poll_threads();
+
+	g_status = -1;
+	spdk_bdev_heatmap_get(bdev, heatmap_data_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(heatmap_total() == 3);
+	CU_ASSERT(g_heatmap_count[spdk_bdev_heatmap_get_index(0, 0, 4)] == 1);
+	CU_ASSERT(g_heatmap_count[spdk_bdev_heatmap_get_index(2, 3, 0)] == 1);
+	CU_ASSERT(g_heatmap_count[spdk_bdev_heatmap_get_index(3, 0, 12)] == 1);
+
+	/* The counts of a deleted channel are kept */
+	spdk_put_io_channel(ch);
+	poll_threads();
+
+	g_status = -1;
+	spdk_bdev_heatmap_get(bdev, heatmap_data_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(heatmap_total() == 3);
+
+	ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(ch != NULL);
+
+	rc = spdk_bdev_write_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(10);
+	stub_complete_io(1);
+	poll_threads();
+
+	g_status = -1;
+	spdk_bdev_heatmap_get(bdev, heatmap_data_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(heatmap_total() == 4);
+	CU_ASSERT(g_heatmap_count[spdk_bdev_heatmap_get_index(0, 0, 4)] == 2);
+
+	/* Collect reads only, enabling the heatmap again also resets it */
+	opts.io_type = SPDK_BDEV_IO_TYPE_READ;
+	g_status = -1;
+	spdk_bdev_heatmap_enable(bdev, heatmap_status_cb, NULL, true, &opts);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+
+	rc = spdk_bdev_write_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_read_blocks(desc, ch, buf, 256, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	stub_complete_io(2);
+	poll_threads();
+
+	g_status = -1;
+	spdk_bdev_heatmap_get(bdev, heatmap_data_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(heatmap_total() == 1);
+	CU_ASSERT(g_heatmap_count[spdk_bdev_heatmap_get_index(1, 0, 0)] == 1);
+
+	/* Disable heatmap */
+	g_status = -1;
+	spdk_bdev_heatmap_enable(bdev, heatmap_status_cb, NULL, false, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(bdev->internal.heatmap_enabled == false);
+	CU_ASSERT(bdev->internal.heatmap == NULL);
+
+	spdk_bdev_heatmap_get(bdev, heatmap_data_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == -EINVAL);
+
+	spdk_put_io_channel(ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	ut_fini_bdev();
+}
+
+static void
+_bdev_compare(bool emulated)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *ioch;
+	struct ut_expected_io *expected_io;
+	uint64_t offset, num_blocks;
+	uint32_t num_completed;
+	char aa_buf[512];
+	char bb_buf[512];
+	struct iovec compare_iov;
+	uint8_t expected_io_type;
+	int rc;
+
+	if (emulated) {
+		expected_io_type = SPDK_BDEV_IO_TYPE_READ;
+	} else {
+		expected_io_type = SPDK_BDEV_IO_TYPE_COMPARE;
+	}
+
+	memset(aa_buf, 0xaa, sizeof(aa_buf));
+	memset(bb_buf, 0xbb, sizeof(bb_buf));
+
+	g_io_types_supported[SPDK_BDEV_IO_TYPE_COMPARE] = !emulated;
+
+	ut_init_bdev(NULL);
+	fn_table.submit_request = stub_submit_request_get_buf;
+	bdev = allocate_bdev("bdev");
+
+	rc = spdk_bdev_open_ext("bdev", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT_EQUAL(rc, 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	CU_ASSERT(bdev == spdk_bdev_desc_get_bdev(desc));
+	ioch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(ioch != NULL);
+
+	fn_table.submit_request = stub_submit_request_get_buf;
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	offset = 50;
+	num_blocks = 1;
+	compare_iov.iov_base = aa_buf;
+	compare_iov.iov_len = sizeof(aa_buf);
+
+	/* 1. successful comparev */
+	expected_io = ut_alloc_expected_io(expected_io_type, offset, num_blocks, 0);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	g_io_done = false;
+	g_compare_read_buf = aa_buf;
+	g_compare_read_buf_len = sizeof(aa_buf);
+	rc = spdk_bdev_comparev_blocks(desc, ioch, &compare_iov, 1, offset, num_blocks, io_done, NULL);
+	CU_ASSERT_EQUAL(rc, 0);
+	num_completed = stub_complete_io(1);
+	CU_ASSERT_EQUAL(num_completed, 1);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	/* 2. miscompare comparev */
+	expected_io = ut_alloc_expected_io(expected_io_type, offset, num_blocks, 0);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	g_io_done = false;
+	g_compare_read_buf = bb_buf;
+	g_compare_read_buf_len = sizeof(bb_buf);
 	rc = spdk_bdev_comparev_blocks(desc, ioch, &compare_iov, 1, offset, num_blocks, io_done, NULL);
 	CU_ASSERT_EQUAL(rc, 0);
 	num_completed = stub_complete_io(1);
@@ -4721,6 +5152,26 @@ bdev_set_io_timeout(void)
 	stub_complete_io(1);
 	poll_threads();
 
+	/* A timeout longer than the submit time buckets cover. The bucket of the first IO is
+	 * reused by the second one, which moves the first one to the older count.
+	 */
+	memset(&cb_arg, 0, sizeof(cb_arg));
+	CU_ASSERT(spdk_bdev_set_timeout(desc, 120, bdev_channel_io_timeout_cb, &cb_arg) == 0);
+	CU_ASSERT(spdk_bdev_write_blocks(desc, io_ch, (void *)0x1000, 0, 1, io_done, NULL) == 0);
+	spdk_delay_us(BDEV_TIMEOUT_BUCKETS << bdev_ch->timeout.shift);
+	poll_threads();
+	CU_ASSERT(spdk_bdev_read_blocks(desc, io_ch, (void *)0x2000, 0, 1, io_done, NULL) == 0);
+	CU_ASSERT(bdev_ch->timeout.older == 1);
+	CU_ASSERT(cb_arg.type == 0);
+
+	spdk_delay_us(120 * spdk_get_ticks_hz() - (BDEV_TIMEOUT_BUCKETS << bdev_ch->timeout.shift));
+	poll_threads();
+	CU_ASSERT(cb_arg.type == SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(cb_arg.iov.iov_base == (void *)0x1000);
+	stub_complete_io(2);
+	CU_ASSERT(bdev_ch->timeout.older == 0);
+	CU_ASSERT(bdev_ch->queue_depth == 0);
+
 	spdk_put_io_channel(io_ch);
 	spdk_bdev_close(desc);
 	free_bdev(bdev);
@@ -5175,6 +5626,114 @@ lock_lba_range_overlapped(void)
 	ut_fini_bdev();
 }
 
+static uint32_t
+ut_count_locked_io(struct spdk_bdev_channel *channel)
+{
+	struct spdk_bdev_io *bdev_io;
+	uint32_t count = 0;
+
+	TAILQ_FOREACH(bdev_io, &channel->io_locked, internal.ch_link) {
+		count++;
+	}
+
+	return count;
+}
+
+static void
+lock_lba_range_lookup(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *channel;
+	char buf[4096];
+	int ctx1, ctx2, ctx3, io_ctx;
+	int rc;
+
+	ut_init_bdev(NULL);
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(io_ch != NULL);
+	channel = spdk_io_channel_get_ctx(io_ch);
+
+	/* Lock 100-109, 200-299 and 320. */
+	rc = bdev_lock_lba_range(desc, io_ch, 100, 10, lock_lba_range_done, &ctx1);
+	CU_ASSERT(rc == 0);
+	rc = bdev_lock_lba_range(desc, io_ch, 200, 100, lock_lba_range_done, &ctx2);
+	CU_ASSERT(rc == 0);
+	rc = bdev_lock_lba_range(desc, io_ch, 320, 1, lock_lba_range_done, &ctx3);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	CU_ASSERT(channel->locked_range_max_length == 100);
+
+	/* Writes outside of the locked ranges are submitted right away. */
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf, 50, 1, io_done, &io_ctx);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf, 110, 90, io_done, &io_ctx);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf, 300, 20, io_done, &io_ctx);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 3);
+	CU_ASSERT(ut_count_locked_io(channel) == 0);
+
+	/* Reads don't conflict with a non-quiesce lock, neither does I/O submitted
+	 * by the lock owner.
+	 */
+	rc = spdk_bdev_read_blocks(desc, io_ch, buf, 290, 1, io_done, &io_ctx);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf, 105, 1, io_done, &ctx1);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 5);
+	CU_ASSERT(ut_count_locked_io(channel) == 0);
+
+	/* Writes overlapping the locked ranges are queued, including the one starting
+	 * before a range, and the one which starts far into the longest range.
+	 */
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf, 95, 10, io_done, &io_ctx);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf, 299, 1, io_done, &io_ctx);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf, 320, 1, io_done, &io_ctx);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf, 105, 1, io_done, &ctx2);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 5);
+	CU_ASSERT(ut_count_locked_io(channel) == 4);
+
+	stub_complete_io(5);
+	poll_threads();
+
+	/* Unlocking the longest range resubmits the write queued on it. */
+	rc = bdev_unlock_lba_range(desc, io_ch, 200, 100, unlock_lba_range_done, &ctx2);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	CU_ASSERT(channel->locked_range_max_length == 10);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	CU_ASSERT(ut_count_locked_io(channel) == 3);
+
+	rc = bdev_unlock_lba_range(desc, io_ch, 100, 10, unlock_lba_range_done, &ctx1);
+	CU_ASSERT(rc == 0);
+	rc = bdev_unlock_lba_range(desc, io_ch, 320, 1, unlock_lba_range_done, &ctx3);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	CU_ASSERT(channel->locked_range_max_length == 0);
+	CU_ASSERT(RB_EMPTY(&channel->locked_range_tree));
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 4);
+	CU_ASSERT(ut_count_locked_io(channel) == 0);
+
+	stub_complete_io(4);
+	poll_threads();
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	ut_fini_bdev();
+}
+
 static void
 bdev_quiesce_done(void *ctx, int status)
 {
@@ -5517,7 +6076,7 @@ bdev_io_abort(void)
 
 	rc = spdk_bdev_abort(desc, io_ch, &io_ctx1, abort_done, NULL);
 	CU_ASSERT(rc == 0);
-	CU_ASSERT(!TAILQ_EMPTY(&mgmt_ch->io_wait_queue));
+	CU_ASSERT(!TAILQ_EMPTY(&mgmt_ch->io_cache.io_wait_queue));
 	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 4);
 
 	stub_complete_io(1);
@@ -6244,6 +6803,93 @@ bdev_io_ext_bounce_buffer(void)
 	ut_fini_bdev();
 }
 
+static void
+bdev_io_ext_translate(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct iovec iov = { .iov_base = (void *)0x1000, .iov_len = 14 * 512 };
+	struct ut_expected_io *expected_io;
+	struct spdk_bdev_ext_io_opts ext_io_opts = {
+		.memory_domain = (struct spdk_memory_domain *)0xdeadbeef,
+		.memory_domain_ctx = (void *)0xbeef,
+		.size = sizeof(ext_io_opts),
+	};
+	int rc;
+
+	ut_init_bdev(NULL);
+
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+
+	/* bdev doesn't support memory domains, but the buffers can be translated to the system
+	 * domain, so they are passed to the bdev without any data copy */
+	g_memory_domain_translation_base = (void *)0xF000;
+
+	/* read */
+	g_io_done = false;
+	g_memory_domain_push_data_called = false;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_READ, 32, 14, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0x10000, 14 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_readv_blocks_ext(desc, io_ch, &iov, 1, 32, 14, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	stub_complete_io(1);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_memory_domain_push_data_called == false);
+	CU_ASSERT(iov.iov_base == (void *)0x1000);
+
+	/* write */
+	g_io_done = false;
+	g_memory_domain_pull_data_called = false;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 32, 14, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0x10000, 14 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_writev_blocks_ext(desc, io_ch, &iov, 1, 32, 14, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_memory_domain_pull_data_called == false);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	stub_complete_io(1);
+	CU_ASSERT(g_io_done == true);
+
+	/* The domain can't translate, the data is bounced and the domain isn't asked again */
+	g_memory_domain_translation_base = NULL;
+	g_io_done = false;
+	rc = spdk_bdev_writev_blocks_ext(desc, io_ch, &iov, 1, 32, 14, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_memory_domain_pull_data_called == true);
+	CU_ASSERT(bdev_ch->untranslatable_domain == ext_io_opts.memory_domain);
+	stub_complete_io(1);
+	CU_ASSERT(g_io_done == true);
+
+	g_memory_domain_translation_base = (void *)0xF000;
+	g_io_done = false;
+	g_memory_domain_pull_data_called = false;
+	rc = spdk_bdev_writev_blocks_ext(desc, io_ch, &iov, 1, 32, 14, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_memory_domain_pull_data_called == true);
+	stub_complete_io(1);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
+	g_memory_domain_translation_base = NULL;
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	ut_fini_bdev();
+}
+
 static void
 bdev_register_uuid_alias(void)
 {
@@ -6675,6 +7321,45 @@ bdev_copy_split_test(void)
 
 	ut_enable_io_type(SPDK_BDEV_IO_TYPE_COPY, true);
 
+	/* Case 5: Same as case 3, but with the number of outstanding children limited to 4 */
+	bdev_opts.copy_queue_depth = 0;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc != 0);
+	bdev_opts.copy_queue_depth = 4;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == 0);
+
+	num_children = 15;
+	max_copy_blocks = 8;
+	bdev->max_copy = max_copy_blocks;
+	num_blocks = max_copy_blocks * num_children;
+	offset = 0;
+	src_offset = bdev->blockcnt - num_blocks;
+
+	g_io_done = false;
+	for (i = 0; i < num_children; i++) {
+		expected_io = ut_alloc_expected_copy_io(SPDK_BDEV_IO_TYPE_COPY, offset,
+							src_offset + offset, max_copy_blocks);
+		TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+		offset += max_copy_blocks;
+	}
+
+	rc = spdk_bdev_copy_blocks(desc, ioch, 0, src_offset, num_blocks, io_done, NULL);
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT(g_io_done == false);
+
+	while (num_children > 0) {
+		num_outstanding = spdk_min(num_children, 4);
+		CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == num_outstanding);
+		stub_complete_io(num_outstanding);
+		num_children -= num_outstanding;
+	}
+	CU_ASSERT(g_io_done == true);
+
+	bdev_opts.copy_queue_depth = SPDK_BDEV_MAX_CHILDREN_COPY_REQS;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == 0);
+
 	spdk_put_io_channel(ioch);
 	spdk_bdev_close(desc);
 	free_bdev(bdev);
@@ -7756,6 +8441,182 @@ bdev_io_init_dif_ctx_test(void)
 	free_bdev(bdev);
 }
 
+static void
+ut_coalesce_io_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	int *count = cb_arg;
+
+	CU_ASSERT(success == true);
+	(*count)++;
+	spdk_bdev_free_io(bdev_io);
+}
+
+static void
+bdev_set_coalescing_cb(void *cb_arg, int status)
+{
+	*(int *)cb_arg = status;
+}
+
+static void
+bdev_io_coalesce(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_opts bdev_opts = {};
+	struct ut_expected_io *expected_io;
+	int count = 0, status = -1;
+	int rc;
+
+	spdk_bdev_get_opts(&bdev_opts, sizeof(bdev_opts));
+	bdev_opts.bdev_io_pool_size = 512;
+	bdev_opts.bdev_io_cache_size = 64;
+	ut_init_bdev(&bdev_opts);
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(io_ch != NULL);
+
+	/* The merged I/O must hold at least two blocks */
+	spdk_bdev_set_coalescing(bdev, 10, 0, bdev_set_coalescing_cb, &status);
+	CU_ASSERT(status == -EINVAL);
+
+	/* Merge up to 8 blocks */
+	spdk_bdev_set_coalescing(bdev, 10, 4, bdev_set_coalescing_cb, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	/* Two contiguous writes are held and submitted as one I/O when the window expires */
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 0, 4, 2);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0xF000, 2 * 512);
+	ut_expected_io_set_iov(expected_io, 1, (void *)0x10000, 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0xF000, 0, 2, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0x10000, 2, 2, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
+	spdk_delay_us(10);
+	poll_threads();
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	CU_ASSERT(count == 0);
+
+	/* Both writes complete with the merged I/O */
+	stub_complete_io(1);
+	CU_ASSERT(count == 2);
+
+	/* A non-contiguous write submits the pending one */
+	count = 0;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 0, 2, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0xF000, 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 8, 2, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0x10000, 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0xF000, 0, 2, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0x10000, 8, 2, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+
+	spdk_delay_us(10);
+	poll_threads();
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 2);
+	stub_complete_io(2);
+	CU_ASSERT(count == 2);
+
+	/* Reads and writes aren't merged together */
+	count = 0;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 0, 2, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0xF000, 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_READ, 2, 2, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0x10000, 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0xF000, 0, 2, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_read_blocks(desc, io_ch, (void *)0x10000, 2, 2, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+
+	spdk_delay_us(10);
+	poll_threads();
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 2);
+	stub_complete_io(2);
+	CU_ASSERT(count == 2);
+
+	/* The merged I/O is submitted right away once it reaches the maximum size */
+	count = 0;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 0, 8, 2);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0xF000, 4 * 512);
+	ut_expected_io_set_iov(expected_io, 1, (void *)0x10000, 4 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0xF000, 0, 4, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0x10000, 4, 4, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	stub_complete_io(1);
+	CU_ASSERT(count == 2);
+
+	/* The merged I/O doesn't cross the optimal I/O boundary */
+	bdev->optimal_io_boundary = 4;
+	bdev->split_on_optimal_io_boundary = true;
+	count = 0;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 2, 2, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0xF000, 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 4, 2, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0x10000, 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0xF000, 2, 2, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0x10000, 4, 2, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+
+	spdk_delay_us(10);
+	poll_threads();
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 2);
+	stub_complete_io(2);
+	CU_ASSERT(count == 2);
+	bdev->optimal_io_boundary = 0;
+	bdev->split_on_optimal_io_boundary = false;
+
+	/* Disabling coalescing submits the pending I/O */
+	count = 0;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 0, 2, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0xF000, 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0xF000, 0, 2, ut_coalesce_io_done, &count);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
+	status = -1;
+	spdk_bdev_set_coalescing(bdev, 0, 0, bdev_set_coalescing_cb, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	stub_complete_io(1);
+	CU_ASSERT(count == 1);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	ut_fini_bdev();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -7774,7 +8635,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, alias_add_del_test);
 	CU_ADD_TEST(suite, get_device_stat_test);
 	CU_ADD_TEST(suite, bdev_io_types_test);
+	CU_ADD_TEST(suite, bdev_trace_sample_test);
 	CU_ADD_TEST(suite, bdev_io_wait_test);
+	CU_ADD_TEST(suite, bdev_io_small_pool_test);
 	CU_ADD_TEST(suite, bdev_io_spans_split_test);
 	CU_ADD_TEST(suite, bdev_io_boundary_split_test);
 	CU_ADD_TEST(suite, bdev_io_max_size_and_segment_split_test);
@@ -7783,7 +8646,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, bdev_io_write_unit_split_test);
 	CU_ADD_TEST(suite, bdev_io_alignment_with_boundary);
 	CU_ADD_TEST(suite, bdev_io_alignment);
+	CU_ADD_TEST(suite, bdev_io_bounce_accel_copy);
 	CU_ADD_TEST(suite, bdev_histograms);
+	CU_ADD_TEST(suite, bdev_heatmap);
 	CU_ADD_TEST(suite, bdev_write_zeroes);
 	CU_ADD_TEST(suite, bdev_compare_and_write);
 	CU_ADD_TEST(suite, bdev_compare);
@@ -7800,6 +8665,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, lock_lba_range_check_ranges);
 	CU_ADD_TEST(suite, lock_lba_range_with_io_outstanding);
 	CU_ADD_TEST(suite, lock_lba_range_overlapped);
+	CU_ADD_TEST(suite, lock_lba_range_lookup);
 	CU_ADD_TEST(suite, bdev_quiesce);
 	CU_ADD_TEST(suite, bdev_io_abort);
 	CU_ADD_TEST(suite, bdev_unmap);
@@ -7811,6 +8677,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, bdev_io_ext_invalid_opts);
 	CU_ADD_TEST(suite, bdev_io_ext_split);
 	CU_ADD_TEST(suite, bdev_io_ext_bounce_buffer);
+	CU_ADD_TEST(suite, bdev_io_ext_translate);
 	CU_ADD_TEST(suite, bdev_register_uuid_alias);
 	CU_ADD_TEST(suite, bdev_unregister_by_name);
 	CU_ADD_TEST(suite, for_each_bdev_test);
@@ -7830,6 +8697,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, get_device_stat_with_reset);
 	CU_ADD_TEST(suite, open_ext_v2_test);
 	CU_ADD_TEST(suite, bdev_io_init_dif_ctx_test);
+	CU_ADD_TEST(suite, bdev_io_coalesce);
 
 	allocate_cores(1);
 	allocate_threads(1);
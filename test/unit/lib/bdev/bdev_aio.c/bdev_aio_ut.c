@@ -0,0 +1,270 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "thread/thread_internal.h"
+
+#include "common/lib/ut_multithread.c"
+#include "unit/lib/json_mock.c"
+
+#include "bdev/aio/bdev_aio.c"
+
+#define UT_MAX_IOS		(SPDK_AIO_QUEUE_DEPTH + 1)
+#define UT_MAX_SUBMIT_RCS	4
+
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB(spdk_bdev_get_uuid, const struct spdk_uuid *, (const struct spdk_bdev *bdev), NULL);
+DEFINE_STUB_V(spdk_bdev_io_get_buf, (struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb,
+				     uint64_t len));
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB(spdk_bdev_notify_blockcnt_change, int, (struct spdk_bdev *bdev, uint64_t size), 0);
+DEFINE_STUB(spdk_bdev_open_ext, int, (const char *bdev_name, bool write,
+				      spdk_bdev_event_cb_t event_cb, void *event_ctx,
+				      struct spdk_bdev_desc **desc), 0);
+DEFINE_STUB(spdk_bdev_register, int, (struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_unregister_by_name, int, (const char *bdev_name,
+		struct spdk_bdev_module *module, spdk_bdev_unregister_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(io_getevents, int, (io_context_t ctx_id, long min_nr, long nr,
+				struct io_event *events, struct timespec *timeout), 0);
+DEFINE_STUB(io_setup, int, (int maxevents, io_context_t *ctxp), 0);
+DEFINE_STUB(io_destroy, int, (io_context_t ctx), 0);
+
+static struct spdk_bdev_io *g_bdev_io[UT_MAX_IOS];
+static enum spdk_bdev_io_status g_io_status[UT_MAX_IOS];
+static int g_io_aio_status[UT_MAX_IOS];
+
+/* Return values of the following io_submit() calls, all requests are accepted when exhausted */
+static int g_submit_rcs[UT_MAX_SUBMIT_RCS];
+static int g_num_submit_rcs;
+static int g_num_submit_calls;
+static long g_submit_nr;
+static struct iocb *g_submit_first;
+
+int
+io_submit(io_context_t ctx, long nr, struct iocb *ios[])
+{
+	int rc = nr;
+
+	if (g_num_submit_calls < g_num_submit_rcs) {
+		rc = g_submit_rcs[g_num_submit_calls];
+	}
+	g_num_submit_calls++;
+	g_submit_nr = nr;
+	g_submit_first = ios[0];
+
+	return rc;
+}
+
+static int
+ut_io_index(struct spdk_bdev_io *bdev_io)
+{
+	int i;
+
+	for (i = 0; i < UT_MAX_IOS; i++) {
+		if (g_bdev_io[i] == bdev_io) {
+			return i;
+		}
+	}
+
+	SPDK_CU_ASSERT_FATAL(false);
+	return -1;
+}
+
+void
+spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	g_io_status[ut_io_index(bdev_io)] = status;
+}
+
+void
+spdk_bdev_io_complete_aio_status(struct spdk_bdev_io *bdev_io, int aio_result)
+{
+	int i = ut_io_index(bdev_io);
+
+	g_io_status[i] = SPDK_BDEV_IO_STATUS_AIO_ERROR;
+	g_io_aio_status[i] = aio_result;
+}
+
+static struct bdev_aio_group_channel g_group_ch;
+static struct spdk_io_channel *g_ch;
+static struct bdev_aio_io_channel *g_aio_ch;
+static struct file_disk g_fdisk;
+static char g_buf[512];
+static struct iovec g_iov = { .iov_base = g_buf, .iov_len = sizeof(g_buf) };
+
+static int
+setup(void)
+{
+	int i;
+
+	for (i = 0; i < UT_MAX_IOS; i++) {
+		g_bdev_io[i] = calloc(1, sizeof(*g_bdev_io[i]) + sizeof(struct bdev_aio_task));
+		if (g_bdev_io[i] == NULL) {
+			return -ENOMEM;
+		}
+	}
+
+	g_ch = calloc(1, sizeof(*g_ch) + sizeof(struct bdev_aio_io_channel));
+	if (g_ch == NULL) {
+		return -ENOMEM;
+	}
+	g_aio_ch = spdk_io_channel_get_ctx(g_ch);
+	g_aio_ch->group_ch = &g_group_ch;
+	g_group_ch.efd = -1;
+	g_fdisk.fd = 10;
+
+	return 0;
+}
+
+static int
+cleanup(void)
+{
+	int i;
+
+	for (i = 0; i < UT_MAX_IOS; i++) {
+		free(g_bdev_io[i]);
+	}
+	free(g_ch);
+
+	return 0;
+}
+
+static void
+ut_reset(void)
+{
+	int i;
+
+	for (i = 0; i < UT_MAX_IOS; i++) {
+		g_io_status[i] = SPDK_BDEV_IO_STATUS_PENDING;
+		g_io_aio_status[i] = 0;
+	}
+	g_num_submit_rcs = 0;
+	g_num_submit_calls = 0;
+	g_submit_nr = 0;
+	g_submit_first = NULL;
+	g_aio_ch->io_inflight = 0;
+	g_aio_ch->num_pending = 0;
+}
+
+static void
+ut_read(int i)
+{
+	bdev_aio_rw(SPDK_BDEV_IO_TYPE_READ, &g_fdisk, g_ch,
+		    (struct bdev_aio_task *)g_bdev_io[i]->driver_ctx, &g_iov, 1, sizeof(g_buf),
+		    i * sizeof(g_buf));
+}
+
+static void
+test_batch_submit(void)
+{
+	int i;
+
+	ut_reset();
+
+	/* Requests are only queued on the channel until the group poll */
+	for (i = 0; i < 3; i++) {
+		ut_read(i);
+	}
+	CU_ASSERT(g_num_submit_calls == 0);
+	CU_ASSERT(g_aio_ch->num_pending == 3);
+	CU_ASSERT(g_aio_ch->io_inflight == 3);
+
+	/* All of them are submitted with a single io_submit() */
+	CU_ASSERT(bdev_aio_io_channel_submit_pending(g_aio_ch) == 3);
+	CU_ASSERT(g_num_submit_calls == 1);
+	CU_ASSERT(g_submit_nr == 3);
+	CU_ASSERT(g_submit_first == &((struct bdev_aio_task *)g_bdev_io[0]->driver_ctx)->iocb);
+	CU_ASSERT(g_aio_ch->num_pending == 0);
+	CU_ASSERT(g_aio_ch->io_inflight == 3);
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(g_io_status[i] == SPDK_BDEV_IO_STATUS_PENDING);
+	}
+
+	/* Nothing is left to submit */
+	CU_ASSERT(bdev_aio_io_channel_submit_pending(g_aio_ch) == 0);
+	CU_ASSERT(g_num_submit_calls == 1);
+
+	/* A full queue is flushed right away */
+	ut_reset();
+	for (i = 0; i < SPDK_AIO_QUEUE_DEPTH; i++) {
+		ut_read(i);
+	}
+	CU_ASSERT(g_num_submit_calls == 1);
+	CU_ASSERT(g_submit_nr == SPDK_AIO_QUEUE_DEPTH);
+	CU_ASSERT(g_aio_ch->num_pending == 0);
+	ut_read(SPDK_AIO_QUEUE_DEPTH);
+	CU_ASSERT(g_aio_ch->num_pending == 1);
+
+	/* Interrupt mode has no group poll, so the requests are submitted right away */
+	ut_reset();
+	g_group_ch.efd = 100;
+	ut_read(0);
+	CU_ASSERT(g_num_submit_calls == 1);
+	CU_ASSERT(g_submit_nr == 1);
+	CU_ASSERT(g_aio_ch->num_pending == 0);
+	CU_ASSERT(g_aio_ch->io_inflight == 1);
+	g_group_ch.efd = -1;
+}
+
+static void
+test_batch_submit_errors(void)
+{
+	int i;
+
+	/* A partial submission continues from the first request that was not accepted, which
+	 * fails with the error returned for it. */
+	ut_reset();
+	for (i = 0; i < 4; i++) {
+		ut_read(i);
+	}
+	g_submit_rcs[0] = 1;
+	g_submit_rcs[1] = -EIO;
+	g_num_submit_rcs = 2;
+	CU_ASSERT(bdev_aio_io_channel_submit_pending(g_aio_ch) == 4);
+	CU_ASSERT(g_num_submit_calls == 3);
+	CU_ASSERT(g_submit_nr == 2);
+	CU_ASSERT(g_submit_first == &((struct bdev_aio_task *)g_bdev_io[2]->driver_ctx)->iocb);
+	CU_ASSERT(g_io_status[0] == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(g_io_status[1] == SPDK_BDEV_IO_STATUS_AIO_ERROR);
+	CU_ASSERT(g_io_aio_status[1] == -EIO);
+	CU_ASSERT(g_io_status[2] == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(g_io_status[3] == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(g_aio_ch->io_inflight == 3);
+
+	/* A full context lets the bdev layer retry all the remaining requests */
+	ut_reset();
+	for (i = 0; i < 3; i++) {
+		ut_read(i);
+	}
+	g_submit_rcs[0] = 1;
+	g_submit_rcs[1] = -EAGAIN;
+	g_num_submit_rcs = 2;
+	CU_ASSERT(bdev_aio_io_channel_submit_pending(g_aio_ch) == 3);
+	CU_ASSERT(g_num_submit_calls == 2);
+	CU_ASSERT(g_io_status[0] == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(g_io_status[1] == SPDK_BDEV_IO_STATUS_NOMEM);
+	CU_ASSERT(g_io_status[2] == SPDK_BDEV_IO_STATUS_NOMEM);
+	CU_ASSERT(g_aio_ch->io_inflight == 1);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("bdev_aio", setup, cleanup);
+
+	CU_ADD_TEST(suite, test_batch_submit);
+	CU_ADD_TEST(suite, test_batch_submit_errors);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
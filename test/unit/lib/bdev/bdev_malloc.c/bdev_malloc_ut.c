@@ -0,0 +1,174 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+
+#include "common/lib/ut_multithread.c"
+#include "unit/lib/json_mock.c"
+
+#include "bdev/malloc/bdev_malloc.c"
+
+#define UT_BLOCK_SIZE	512
+#define UT_NUM_BLOCKS	8
+#define UT_DISK_SIZE	(UT_BLOCK_SIZE * UT_NUM_BLOCKS)
+
+DEFINE_STUB(spdk_accel_append_copy, int, (struct spdk_accel_sequence **seq,
+		struct spdk_io_channel *ch, struct iovec *dst_iovs, uint32_t dst_iovcnt,
+		struct spdk_memory_domain *dst_domain, void *dst_domain_ctx, struct iovec *src_iovs,
+		uint32_t src_iovcnt, struct spdk_memory_domain *src_domain, void *src_domain_ctx,
+		spdk_accel_step_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_accel_get_io_channel, struct spdk_io_channel *, (void), NULL);
+DEFINE_STUB_V(spdk_accel_sequence_abort, (struct spdk_accel_sequence *seq));
+DEFINE_STUB_V(spdk_accel_sequence_finish, (struct spdk_accel_sequence *seq,
+		spdk_accel_completion_cb cb_fn, void *cb_arg));
+DEFINE_STUB_V(spdk_accel_sequence_reverse, (struct spdk_accel_sequence *seq));
+DEFINE_STUB(spdk_accel_submit_copy, int, (struct spdk_io_channel *ch, void *dst, void *src,
+		uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_accel_submit_fill, int, (struct spdk_io_channel *ch, void *dst, uint8_t fill,
+		uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_io_hide_metadata, bool, (struct spdk_bdev_io *bdev_io), false);
+DEFINE_STUB_V(spdk_bdev_io_set_buf, (struct spdk_bdev_io *bdev_io, void *buf, size_t len));
+DEFINE_STUB_V(spdk_bdev_io_set_md_buf, (struct spdk_bdev_io *bdev_io, void *md_buf, size_t len));
+DEFINE_STUB(spdk_bdev_is_md_interleaved, bool, (const struct spdk_bdev *bdev), false);
+DEFINE_STUB(spdk_bdev_is_md_separate, bool, (const struct spdk_bdev *bdev), false);
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB(spdk_bdev_register, int, (struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_unregister_by_name, int, (const char *bdev_name,
+		struct spdk_bdev_module *module, spdk_bdev_unregister_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_memory_domain_get_first, struct spdk_memory_domain *, (const char *id), NULL);
+DEFINE_STUB(spdk_memory_domain_get_next, struct spdk_memory_domain *,
+		(struct spdk_memory_domain *prev, const char *id), NULL);
+
+
+static enum spdk_bdev_io_status g_io_status;
+
+void
+spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	g_io_status = status;
+}
+
+static void
+ut_malloc_done(struct malloc_disk *mdisk, struct spdk_bdev_io *bdev_io,
+	       enum spdk_bdev_io_type type, int status)
+{
+	struct malloc_task *task = (struct malloc_task *)bdev_io->driver_ctx;
+
+	bdev_io->bdev = &mdisk->disk;
+	bdev_io->type = type;
+	bdev_io->u.bdev.offset_blocks = 2;
+	bdev_io->u.bdev.num_blocks = 2;
+	task->status = SPDK_BDEV_IO_STATUS_SUCCESS;
+	task->num_outstanding = 1;
+	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+
+	malloc_done(task, status);
+}
+
+static void
+test_numa_replicas(void)
+{
+	struct malloc_disk *mdisk;
+	struct malloc_disk plain_disk = {};
+	struct malloc_channel mch = {};
+	struct spdk_bdev_io *bdev_io;
+	char zeroes[UT_DISK_SIZE] = {};
+	char *remote;
+
+	mdisk = calloc(1, sizeof(*mdisk));
+	SPDK_CU_ASSERT_FATAL(mdisk != NULL);
+	mdisk->disk.ctxt = mdisk;
+	mdisk->disk.blocklen = UT_BLOCK_SIZE;
+	mdisk->disk.blockcnt = UT_NUM_BLOCKS;
+
+	/* A copy is allocated for each NUMA node present, the first one takes the writes */
+	MOCK_SET(spdk_env_get_first_numa_id, 1);
+	MOCK_SET(spdk_env_get_last_numa_id, 1);
+	CU_ASSERT(malloc_disk_alloc_replicas(mdisk, UT_DISK_SIZE) == 0);
+	MOCK_CLEAR(spdk_env_get_first_numa_id);
+	MOCK_CLEAR(spdk_env_get_last_numa_id);
+	CU_ASSERT(mdisk->num_replicas == 2);
+	SPDK_CU_ASSERT_FATAL(mdisk->replicas != NULL);
+	CU_ASSERT(mdisk->replicas[0] == NULL);
+	SPDK_CU_ASSERT_FATAL(mdisk->replicas[1] != NULL);
+	CU_ASSERT(mdisk->malloc_buf == mdisk->replicas[1]);
+
+	/* Add a copy on node 0 as well */
+	mdisk->replicas[0] = spdk_zmalloc(UT_DISK_SIZE, 0, NULL, 0, SPDK_MALLOC_DMA);
+	SPDK_CU_ASSERT_FATAL(mdisk->replicas[0] != NULL);
+	remote = mdisk->replicas[0];
+
+	/* Each channel reads from the copy on its node */
+	mch.numa_id = 0;
+	CU_ASSERT(malloc_get_local_buf(mdisk, &mch) == mdisk->replicas[0]);
+	mch.numa_id = 1;
+	CU_ASSERT(malloc_get_local_buf(mdisk, &mch) == mdisk->replicas[1]);
+	mch.numa_id = SPDK_ENV_NUMA_ID_ANY;
+	CU_ASSERT(malloc_get_local_buf(mdisk, &mch) == mdisk->malloc_buf);
+	mch.numa_id = 2;
+	CU_ASSERT(malloc_get_local_buf(mdisk, &mch) == mdisk->malloc_buf);
+	plain_disk.malloc_buf = zeroes;
+	mch.numa_id = 0;
+	CU_ASSERT(malloc_get_local_buf(&plain_disk, &mch) == zeroes);
+
+	/* Zero-copy and copy would bypass the replication */
+	CU_ASSERT(bdev_malloc_io_type_supported(mdisk, SPDK_BDEV_IO_TYPE_READ));
+	CU_ASSERT(!bdev_malloc_io_type_supported(mdisk, SPDK_BDEV_IO_TYPE_ZCOPY));
+	CU_ASSERT(!bdev_malloc_io_type_supported(mdisk, SPDK_BDEV_IO_TYPE_COPY));
+	CU_ASSERT(bdev_malloc_io_type_supported(&plain_disk, SPDK_BDEV_IO_TYPE_ZCOPY));
+	CU_ASSERT(bdev_malloc_io_type_supported(&plain_disk, SPDK_BDEV_IO_TYPE_COPY));
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct malloc_task));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+
+	/* A completed write is propagated to the other copies, only in its range */
+	memset(mdisk->malloc_buf, 0xa5, UT_DISK_SIZE);
+	ut_malloc_done(mdisk, bdev_io, SPDK_BDEV_IO_TYPE_WRITE, 0);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(memcmp(remote, zeroes, 2 * UT_BLOCK_SIZE) == 0);
+	CU_ASSERT(memcmp(remote + 2 * UT_BLOCK_SIZE, mdisk->malloc_buf,
+			 2 * UT_BLOCK_SIZE) == 0);
+	CU_ASSERT(memcmp(remote + 4 * UT_BLOCK_SIZE, zeroes, 4 * UT_BLOCK_SIZE) == 0);
+
+	/* Unmap and write zeroes as well */
+	memset(mdisk->malloc_buf, 0, UT_DISK_SIZE);
+	ut_malloc_done(mdisk, bdev_io, SPDK_BDEV_IO_TYPE_UNMAP, 0);
+	CU_ASSERT(memcmp(remote, zeroes, UT_DISK_SIZE) == 0);
+
+	memset(remote + 2 * UT_BLOCK_SIZE, 0xa5, 2 * UT_BLOCK_SIZE);
+	ut_malloc_done(mdisk, bdev_io, SPDK_BDEV_IO_TYPE_WRITE_ZEROES, 0);
+	CU_ASSERT(memcmp(remote, zeroes, UT_DISK_SIZE) == 0);
+
+	/* Neither reads nor failed writes touch the copies */
+	memset(mdisk->malloc_buf, 0xa5, UT_DISK_SIZE);
+	ut_malloc_done(mdisk, bdev_io, SPDK_BDEV_IO_TYPE_READ, 0);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(memcmp(remote, zeroes, UT_DISK_SIZE) == 0);
+
+	ut_malloc_done(mdisk, bdev_io, SPDK_BDEV_IO_TYPE_WRITE, -EIO);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+	CU_ASSERT(memcmp(remote, zeroes, UT_DISK_SIZE) == 0);
+
+	free(bdev_io);
+	malloc_disk_free(mdisk);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("bdev_malloc", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_numa_replicas);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
@@ -0,0 +1,194 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+
+#include "common/lib/ut_multithread.c"
+#include "unit/lib/json_mock.c"
+
+#include "bdev/rbd/bdev_rbd.c"
+
+#define UT_NUM_IOS 3
+
+DEFINE_STUB(rados_conf_read_file, int, (rados_t cluster, const char *path), 0);
+DEFINE_STUB(rados_conf_set, int, (rados_t cluster, const char *option, const char *value), 0);
+DEFINE_STUB(rados_connect, int, (rados_t cluster), 0);
+DEFINE_STUB(rados_create, int, (rados_t *cluster, const char * const id), 0);
+DEFINE_STUB(rados_ioctx_create, int, (rados_t cluster, const char *pool_name, rados_ioctx_t *ioctx),
+		0);
+DEFINE_STUB_V(rados_ioctx_destroy, (rados_ioctx_t io));
+DEFINE_STUB_V(rados_shutdown, (rados_t cluster));
+DEFINE_STUB(rbd_aio_create_completion, int, (void *cb_arg, rbd_callback_t complete_cb,
+		rbd_completion_t *c), 0);
+DEFINE_STUB(rbd_aio_discard, int, (rbd_image_t image, uint64_t off, uint64_t len,
+		rbd_completion_t c), 0);
+DEFINE_STUB(rbd_aio_flush, int, (rbd_image_t image, rbd_completion_t c), 0);
+DEFINE_STUB(rbd_aio_get_arg, void *, (rbd_completion_t c), NULL);
+DEFINE_STUB(rbd_aio_get_return_value, ssize_t, (rbd_completion_t c), 0);
+DEFINE_STUB(rbd_aio_read, int, (rbd_image_t image, uint64_t off, size_t len, char *buf,
+		rbd_completion_t c), 0);
+DEFINE_STUB(rbd_aio_readv, int, (rbd_image_t image, const struct iovec *iov, int iovcnt,
+		uint64_t off, rbd_completion_t c), 0);
+DEFINE_STUB_V(rbd_aio_release, (rbd_completion_t c));
+DEFINE_STUB(rbd_aio_write, int, (rbd_image_t image, uint64_t off, size_t len, const char *buf,
+		rbd_completion_t c), 0);
+DEFINE_STUB(rbd_aio_write_zeroes, int, (rbd_image_t image, uint64_t off, size_t len,
+		rbd_completion_t c, int zero_flags, int op_flags), 0);
+DEFINE_STUB(rbd_aio_writev, int, (rbd_image_t image, const struct iovec *iov, int iovcnt,
+		uint64_t off, rbd_completion_t c), 0);
+DEFINE_STUB(rbd_close, int, (rbd_image_t image), 0);
+DEFINE_STUB(rbd_flush, int, (rbd_image_t image), 0);
+DEFINE_STUB(rbd_get_size, int, (rbd_image_t image, uint64_t *size), 0);
+DEFINE_STUB(rbd_open, int, (rados_ioctx_t io, const char *name, rbd_image_t *image,
+		const char *snap_name), 0);
+DEFINE_STUB(rbd_resize, int, (rbd_image_t image, uint64_t size), 0);
+DEFINE_STUB(rbd_stat, int, (rbd_image_t image, rbd_image_info_t *info, size_t infosize), 0);
+DEFINE_STUB(rbd_update_unwatch, int, (rbd_image_t image, uint64_t handle), 0);
+DEFINE_STUB(rbd_update_watch, int, (rbd_image_t image, uint64_t *handle,
+		rbd_update_callback_t watch_cb, void *arg), 0);
+
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB_V(spdk_bdev_destruct_done, (struct spdk_bdev *bdev, int bdeverrno));
+DEFINE_STUB_V(spdk_bdev_get_current_qd, (struct spdk_bdev *bdev, spdk_bdev_get_current_qd_cb cb_fn,
+		void *cb_arg));
+DEFINE_STUB_V(spdk_bdev_io_get_buf, (struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb,
+		uint64_t len));
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB(spdk_bdev_notify_blockcnt_change, int, (struct spdk_bdev *bdev, uint64_t size), 0);
+DEFINE_STUB(spdk_bdev_open_ext, int, (const char *bdev_name, bool write,
+		spdk_bdev_event_cb_t event_cb, void *event_ctx, struct spdk_bdev_desc **desc), 0);
+DEFINE_STUB(spdk_bdev_register, int, (struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_unregister_by_name, int, (const char *bdev_name,
+		struct spdk_bdev_module *module, spdk_bdev_unregister_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_call_unaffinitized, void *, (void *cb(void *arg), void *arg), NULL);
+DEFINE_STUB(spdk_jsonrpc_begin_result, struct spdk_json_write_ctx *,
+		(struct spdk_jsonrpc_request *request), NULL);
+DEFINE_STUB_V(spdk_jsonrpc_end_result, (struct spdk_jsonrpc_request *request,
+		struct spdk_json_write_ctx *w));
+
+static struct spdk_bdev_io *g_bdev_io[UT_NUM_IOS];
+static enum spdk_bdev_io_status g_io_status[UT_NUM_IOS];
+static struct spdk_thread *g_io_thread[UT_NUM_IOS];
+
+void
+spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	int i;
+
+	for (i = 0; i < UT_NUM_IOS; i++) {
+		if (g_bdev_io[i] == bdev_io) {
+			g_io_status[i] = status;
+			g_io_thread[i] = spdk_get_thread();
+			return;
+		}
+	}
+
+	CU_ASSERT(false);
+}
+
+static void
+test_io_complete_batch(void)
+{
+	struct spdk_io_channel *ch;
+	struct bdev_rbd_group_channel *group_ch;
+	struct bdev_rbd_io *rbd_io;
+	struct spdk_thread *submit_td;
+	int i;
+
+	allocate_threads(2);
+	set_thread(0);
+	submit_td = spdk_get_thread();
+
+	spdk_io_device_register(&g_bdev_io, bdev_rbd_group_create_cb, bdev_rbd_group_destroy_cb,
+				sizeof(struct bdev_rbd_group_channel), "ut_rbd_group");
+	ch = spdk_get_io_channel(&g_bdev_io);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	group_ch = spdk_io_channel_get_ctx(ch);
+	CU_ASSERT(group_ch->completions != NULL);
+	CU_ASSERT(group_ch->efd == -1);
+	CU_ASSERT(group_ch->poller != NULL);
+
+	for (i = 0; i < UT_NUM_IOS; i++) {
+		g_bdev_io[i] = calloc(1, sizeof(struct spdk_bdev_io) + sizeof(struct bdev_rbd_io));
+		SPDK_CU_ASSERT_FATAL(g_bdev_io[i] != NULL);
+		rbd_io = (struct bdev_rbd_io *)g_bdev_io[i]->driver_ctx;
+		rbd_io->submit_td = submit_td;
+		rbd_io->group_ch = group_ch;
+		g_io_status[i] = SPDK_BDEV_IO_STATUS_PENDING;
+		g_io_thread[i] = NULL;
+	}
+
+	/* I/Os completed on the submitting thread complete right away */
+	bdev_rbd_io_complete(g_bdev_io[0], SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(g_io_status[0] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(g_io_thread[0] == submit_td);
+	CU_ASSERT(spdk_ring_count(group_ch->completions) == 0);
+
+	/* I/Os completed by librbd threads are queued to the submitting thread, without
+	 * a message each */
+	g_io_status[0] = SPDK_BDEV_IO_STATUS_PENDING;
+	spdk_set_thread(NULL);
+	bdev_rbd_io_complete(g_bdev_io[0], SPDK_BDEV_IO_STATUS_SUCCESS);
+	bdev_rbd_io_complete(g_bdev_io[1], SPDK_BDEV_IO_STATUS_FAILED);
+	bdev_rbd_io_complete(g_bdev_io[2], SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(spdk_ring_count(group_ch->completions) == UT_NUM_IOS);
+	for (i = 0; i < UT_NUM_IOS; i++) {
+		CU_ASSERT(g_io_status[i] == SPDK_BDEV_IO_STATUS_PENDING);
+	}
+
+	/* The group poller completes all of them at once */
+	set_thread(0);
+	CU_ASSERT(bdev_rbd_group_poll(group_ch) == SPDK_POLLER_BUSY);
+	CU_ASSERT(spdk_ring_count(group_ch->completions) == 0);
+	CU_ASSERT(g_io_status[0] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(g_io_status[1] == SPDK_BDEV_IO_STATUS_FAILED);
+	CU_ASSERT(g_io_status[2] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	for (i = 0; i < UT_NUM_IOS; i++) {
+		CU_ASSERT(g_io_thread[i] == submit_td);
+	}
+	CU_ASSERT(bdev_rbd_group_poll(group_ch) == SPDK_POLLER_IDLE);
+
+	/* A full queue falls back to a message */
+	g_io_status[0] = SPDK_BDEV_IO_STATUS_PENDING;
+	g_io_thread[0] = NULL;
+	MOCK_SET(spdk_ring_enqueue, 0);
+	set_thread(1);
+	bdev_rbd_io_complete(g_bdev_io[0], SPDK_BDEV_IO_STATUS_SUCCESS);
+	MOCK_CLEAR(spdk_ring_enqueue);
+	CU_ASSERT(g_io_status[0] == SPDK_BDEV_IO_STATUS_PENDING);
+	poll_threads();
+	CU_ASSERT(g_io_status[0] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(g_io_thread[0] == submit_td);
+
+	set_thread(0);
+	spdk_put_io_channel(ch);
+	spdk_io_device_unregister(&g_bdev_io, NULL);
+	poll_threads();
+
+	for (i = 0; i < UT_NUM_IOS; i++) {
+		free(g_bdev_io[i]);
+		g_bdev_io[i] = NULL;
+	}
+	free_threads();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("bdev_rbd", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_io_complete_batch);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
@@ -0,0 +1,116 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+
+#include "common/lib/ut_multithread.c"
+#include "unit/lib/json_mock.c"
+
+#include "bdev/uring/bdev_uring.c"
+
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB_V(spdk_bdev_io_complete, (struct spdk_bdev_io *bdev_io,
+				      enum spdk_bdev_io_status status));
+DEFINE_STUB_V(spdk_bdev_io_get_buf, (struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb,
+				     uint64_t len));
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB(spdk_bdev_notify_blockcnt_change, int, (struct spdk_bdev *bdev, uint64_t size), 0);
+DEFINE_STUB(spdk_bdev_open_ext, int, (const char *bdev_name, bool write,
+				      spdk_bdev_event_cb_t event_cb, void *event_ctx,
+				      struct spdk_bdev_desc **desc), 0);
+DEFINE_STUB(spdk_bdev_register, int, (struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_unregister_by_name, int, (const char *bdev_name,
+		struct spdk_bdev_module *module, spdk_bdev_unregister_cb cb_fn, void *cb_arg), 0);
+
+static void
+test_set_opts(void)
+{
+	struct bdev_uring_module_opts opts, default_opts;
+	struct bdev_uring bdev = {};
+
+	/* Both polling modes are opt-in */
+	bdev_uring_get_opts(&default_opts);
+	CU_ASSERT(default_opts.iopoll == false);
+	CU_ASSERT(default_opts.sqpoll == false);
+	CU_ASSERT(default_opts.sqpoll_idle_ms == SPDK_URING_SQPOLL_IDLE_MS_DEFAULT);
+
+	opts.iopoll = true;
+	opts.sqpoll = true;
+	opts.sqpoll_idle_ms = 10;
+	CU_ASSERT(bdev_uring_set_opts(&opts) == 0);
+	memset(&opts, 0, sizeof(opts));
+	bdev_uring_get_opts(&opts);
+	CU_ASSERT(opts.iopoll == true);
+	CU_ASSERT(opts.sqpoll == true);
+	CU_ASSERT(opts.sqpoll_idle_ms == 10);
+
+	/* The rings are shared by all uring bdevs, so the options are fixed once one exists */
+	TAILQ_INSERT_TAIL(&g_uring_bdev_head, &bdev, link);
+	CU_ASSERT(bdev_uring_set_opts(&default_opts) == -EPERM);
+	bdev_uring_get_opts(&opts);
+	CU_ASSERT(opts.iopoll == true);
+	TAILQ_REMOVE(&g_uring_bdev_head, &bdev, link);
+
+	CU_ASSERT(bdev_uring_set_opts(&default_opts) == 0);
+}
+
+static void
+test_group_create(void)
+{
+	struct bdev_uring_module_opts opts, default_opts;
+	struct bdev_uring_group_channel ch = {};
+
+	bdev_uring_get_opts(&default_opts);
+
+	allocate_threads(1);
+	set_thread(0);
+
+	CU_ASSERT(bdev_uring_group_create_cb(NULL, &ch) == 0);
+	CU_ASSERT((ch.uring.flags & (IORING_SETUP_IOPOLL | IORING_SETUP_SQPOLL)) == 0);
+	CU_ASSERT(ch.poller != NULL);
+	bdev_uring_group_destroy_cb(NULL, &ch);
+	CU_ASSERT(ch.poller == NULL);
+
+	opts = default_opts;
+	opts.iopoll = true;
+	CU_ASSERT(bdev_uring_set_opts(&opts) == 0);
+	CU_ASSERT(bdev_uring_group_create_cb(NULL, &ch) == 0);
+	CU_ASSERT(ch.uring.flags & IORING_SETUP_IOPOLL);
+	CU_ASSERT(!(ch.uring.flags & IORING_SETUP_SQPOLL));
+	bdev_uring_group_destroy_cb(NULL, &ch);
+
+	opts = default_opts;
+	opts.sqpoll = true;
+	opts.sqpoll_idle_ms = 10;
+	CU_ASSERT(bdev_uring_set_opts(&opts) == 0);
+	CU_ASSERT(bdev_uring_group_create_cb(NULL, &ch) == 0);
+	CU_ASSERT(!(ch.uring.flags & IORING_SETUP_IOPOLL));
+	CU_ASSERT(ch.uring.flags & IORING_SETUP_SQPOLL);
+	bdev_uring_group_destroy_cb(NULL, &ch);
+
+	CU_ASSERT(bdev_uring_set_opts(&default_opts) == 0);
+
+	free_threads();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("bdev_uring", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_set_opts);
+	CU_ADD_TEST(suite, test_group_create);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
@@ -0,0 +1,250 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "thread/thread_internal.h"
+
+#include "common/lib/ut_multithread.c"
+#include "unit/lib/json_mock.c"
+
+#include "bdev/xnvme/bdev_xnvme.c"
+
+#define UT_NSID 1
+
+DEFINE_STUB_V(spdk_bdev_io_get_buf, (struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb,
+				     uint64_t len));
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB(spdk_bdev_register, int, (struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_unregister_by_name, int, (const char *bdev_name,
+		struct spdk_bdev_module *module, spdk_bdev_unregister_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(xnvme_opts_default, struct xnvme_opts, (void), {});
+DEFINE_STUB_V(xnvme_dev_close, (struct xnvme_dev *dev));
+DEFINE_STUB(xnvme_dev_get_nsid, uint32_t, (const struct xnvme_dev *dev), UT_NSID);
+DEFINE_STUB(xnvme_dev_get_csi, uint8_t, (const struct xnvme_dev *dev), XNVME_SPEC_CSI_NVM);
+DEFINE_STUB(xnvme_dev_get_ctrlr_css, const struct xnvme_spec_idfy_ctrlr *,
+	    (const struct xnvme_dev *dev), NULL);
+DEFINE_STUB(xnvme_queue_term, int, (struct xnvme_queue *queue), 0);
+DEFINE_STUB(xnvme_queue_set_cb, int, (struct xnvme_queue *queue, xnvme_queue_cb cb,
+				      void *cb_arg), 0);
+DEFINE_STUB(xnvme_queue_put_cmd_ctx, int, (struct xnvme_queue *queue, struct xnvme_cmd_ctx *ctx),
+	    0);
+DEFINE_STUB(xnvme_queue_poke, int, (struct xnvme_queue *queue, uint32_t max), 0);
+DEFINE_STUB(xnvme_queue_get_outstanding, uint32_t, (struct xnvme_queue *queue), 0);
+DEFINE_STUB(xnvme_cmd_passv, int, (struct xnvme_cmd_ctx *ctx, struct iovec *dvec, size_t dvec_cnt,
+				   size_t dvec_nbytes, struct iovec *mvec, size_t mvec_cnt,
+				   size_t mvec_nbytes), 0);
+DEFINE_STUB(xnvme_cmd_ctx_pr, int, (const struct xnvme_cmd_ctx *ctx, int opts), 0);
+
+static struct xnvme_cmd_ctx g_cmd_ctx;
+static struct xnvme_spec_nvm_idfy_ctrlr g_idfy_ctrlr;
+static struct xnvme_geo g_geo = { .tbytes = 1024 * 512, .nbytes = 512 };
+static struct xnvme_dev *g_dev = (struct xnvme_dev *)0xDEADBEEF;
+static struct xnvme_opts g_dev_opts;
+
+struct xnvme_dev *
+xnvme_dev_open(const char *dev_uri, struct xnvme_opts *opts)
+{
+	g_dev_opts = *opts;
+
+	return g_dev;
+}
+
+const struct xnvme_geo *
+xnvme_dev_get_geo(const struct xnvme_dev *dev)
+{
+	return &g_geo;
+}
+
+static uint16_t g_queue_capacity;
+
+int
+xnvme_queue_init(struct xnvme_dev *dev, uint16_t capacity, int opts, struct xnvme_queue **queue)
+{
+	g_queue_capacity = capacity;
+	*queue = (struct xnvme_queue *)0xFEEDBEEF;
+
+	return 0;
+}
+
+struct xnvme_cmd_ctx *
+xnvme_queue_get_cmd_ctx(struct xnvme_queue *queue)
+{
+	memset(&g_cmd_ctx, 0, sizeof(g_cmd_ctx));
+	g_cmd_ctx.async.queue = queue;
+
+	return &g_cmd_ctx;
+}
+
+static void *g_pass_dbuf;
+static size_t g_pass_dbuf_nbytes;
+static void *g_pass_mbuf;
+static size_t g_pass_mbuf_nbytes;
+
+int
+xnvme_cmd_pass(struct xnvme_cmd_ctx *ctx, void *dbuf, size_t dbuf_nbytes, void *mbuf,
+	       size_t mbuf_nbytes)
+{
+	g_pass_dbuf = dbuf;
+	g_pass_dbuf_nbytes = dbuf_nbytes;
+	g_pass_mbuf = mbuf;
+	g_pass_mbuf_nbytes = mbuf_nbytes;
+
+	return 0;
+}
+
+static enum spdk_bdev_io_status g_io_status;
+static uint32_t g_io_cdw0;
+static int g_io_sct;
+static int g_io_sc;
+
+void
+spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	g_io_status = status;
+}
+
+void
+spdk_bdev_io_complete_nvme_status(struct spdk_bdev_io *bdev_io, uint32_t cdw0, int sct, int sc)
+{
+	g_io_status = SPDK_BDEV_IO_STATUS_NVME_ERROR;
+	g_io_cdw0 = cdw0;
+	g_io_sct = sct;
+	g_io_sc = sc;
+}
+
+static void
+test_nvme_io_passthru(void)
+{
+	struct bdev_xnvme xnvme = {};
+	struct spdk_bdev_io *bdev_io;
+	struct spdk_io_channel *ch;
+	char buf[512], md_buf[8];
+
+	/* Raw commands can only be passed through the NVMe generic char device */
+	xnvme.io_mechanism = "io_uring_cmd";
+	CU_ASSERT(bdev_xnvme_io_type_supported(&xnvme, SPDK_BDEV_IO_TYPE_NVME_IO));
+	xnvme.io_mechanism = "io_uring";
+	CU_ASSERT(!bdev_xnvme_io_type_supported(&xnvme, SPDK_BDEV_IO_TYPE_NVME_IO));
+	xnvme.io_mechanism = "libaio";
+	CU_ASSERT(!bdev_xnvme_io_type_supported(&xnvme, SPDK_BDEV_IO_TYPE_NVME_IO));
+
+	xnvme.io_mechanism = "io_uring_cmd";
+	xnvme.nsid = UT_NSID;
+	xnvme.bdev.ctxt = &xnvme;
+
+	ch = calloc(1, sizeof(*ch) + sizeof(struct bdev_xnvme_io_channel));
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct bdev_xnvme_task));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+
+	bdev_io->bdev = &xnvme.bdev;
+	bdev_io->type = SPDK_BDEV_IO_TYPE_NVME_IO;
+	bdev_io->u.nvme_passthru.cmd.opc = SPDK_NVME_OPC_COMPARE;
+	bdev_io->u.nvme_passthru.cmd.nsid = 5;
+	bdev_io->u.nvme_passthru.cmd.cdw10 = 0x100;
+	bdev_io->u.nvme_passthru.cmd.cdw12 = 0x7;
+	bdev_io->u.nvme_passthru.buf = buf;
+	bdev_io->u.nvme_passthru.nbytes = sizeof(buf);
+	bdev_io->u.nvme_passthru.md_buf = md_buf;
+	bdev_io->u.nvme_passthru.md_len = sizeof(md_buf);
+
+	/* The command is copied as is, with the namespace forced to the bdev's one */
+	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+	bdev_xnvme_submit_request(ch, bdev_io);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(g_cmd_ctx.cmd.common.opcode == SPDK_NVME_OPC_COMPARE);
+	CU_ASSERT(g_cmd_ctx.cmd.common.nsid == UT_NSID);
+	CU_ASSERT(g_cmd_ctx.cmd.common.cdw10 == 0x100);
+	CU_ASSERT(g_cmd_ctx.cmd.common.cdw12 == 0x7);
+	CU_ASSERT(g_cmd_ctx.async.cb_arg == bdev_io->driver_ctx);
+	CU_ASSERT(g_pass_dbuf == buf);
+	CU_ASSERT(g_pass_dbuf_nbytes == sizeof(buf));
+	CU_ASSERT(g_pass_mbuf == md_buf);
+	CU_ASSERT(g_pass_mbuf_nbytes == sizeof(md_buf));
+
+	/* The submitter sees the NVMe status of the command */
+	g_cmd_ctx.cpl.cdw0 = 0x1234;
+	g_cmd_ctx.cpl.status.sct = SPDK_NVME_SCT_MEDIA_ERROR;
+	g_cmd_ctx.cpl.status.sc = SPDK_NVME_SC_COMPARE_FAILURE;
+	bdev_xnvme_cmd_cb(&g_cmd_ctx, NULL);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_NVME_ERROR);
+	CU_ASSERT(g_io_cdw0 == 0x1234);
+	CU_ASSERT(g_io_sct == SPDK_NVME_SCT_MEDIA_ERROR);
+	CU_ASSERT(g_io_sc == SPDK_NVME_SC_COMPARE_FAILURE);
+
+	free(bdev_io);
+	free(ch);
+}
+
+static void
+test_create_opts(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_io_channel *ch;
+
+	MOCK_SET(xnvme_dev_get_ctrlr_css, (const struct xnvme_spec_idfy_ctrlr *)&g_idfy_ctrlr);
+	allocate_threads(1);
+	set_thread(0);
+
+	/* The queue depth must be a power of 2 */
+	CU_ASSERT(create_xnvme_bdev("xnvme0", "/dev/ng0n1", "io_uring_cmd", false, 100,
+				    false) == NULL);
+
+	/* A kernel submission queue polling thread only exists with io_uring */
+	CU_ASSERT(create_xnvme_bdev("xnvme0", "/dev/nvme0n1", "libaio", false, 0, true) == NULL);
+
+	/* The default queue depth is kept when none is given */
+	bdev = create_xnvme_bdev("xnvme0", "/dev/nvme0n1", "io_uring", false, 0, false);
+	SPDK_CU_ASSERT_FATAL(bdev != NULL);
+	CU_ASSERT(g_dev_opts.poll_sq == 0);
+	CU_ASSERT(g_dev_opts.poll_io == 1);
+
+	ch = spdk_get_io_channel(bdev->ctxt);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	CU_ASSERT(g_queue_capacity == BDEV_XNVME_DEFAULT_QUEUE_DEPTH);
+	spdk_put_io_channel(ch);
+	poll_threads();
+
+	bdev_xnvme_destruct(bdev->ctxt);
+	poll_threads();
+	CU_ASSERT(TAILQ_EMPTY(&g_xnvme_bdev_head));
+
+	bdev = create_xnvme_bdev("xnvme0", "/dev/ng0n1", "io_uring_cmd", true, 64, true);
+	SPDK_CU_ASSERT_FATAL(bdev != NULL);
+	CU_ASSERT(g_dev_opts.poll_sq == 1);
+	CU_ASSERT(g_dev_opts.poll_io == 0);
+
+	ch = spdk_get_io_channel(bdev->ctxt);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	CU_ASSERT(g_queue_capacity == 64);
+	spdk_put_io_channel(ch);
+	poll_threads();
+
+	bdev_xnvme_destruct(bdev->ctxt);
+	poll_threads();
+	CU_ASSERT(TAILQ_EMPTY(&g_xnvme_bdev_head));
+
+	free_threads();
+	MOCK_CLEAR(xnvme_dev_get_ctrlr_css);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("bdev_xnvme", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_nvme_io_passthru);
+	CU_ADD_TEST(suite, test_create_opts);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
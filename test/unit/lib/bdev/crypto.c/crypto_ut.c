@@ -48,6 +48,9 @@ DEFINE_STUB(spdk_bdev_open_ext, int, (const char *bdev_name, bool write,
 				      spdk_bdev_event_cb_t event_cb,
 				      void *event_ctx, struct spdk_bdev_desc **_desc), 0);
 DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB(spdk_bdev_get_dif_type, enum spdk_dif_type, (const struct spdk_bdev *bdev),
+	    SPDK_DIF_DISABLE);
+DEFINE_STUB(spdk_bdev_is_md_interleaved, bool, (const struct spdk_bdev *bdev), false);
 DEFINE_STUB(spdk_bdev_module_claim_bdev, int, (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
 		struct spdk_bdev_module *module), 0);
 DEFINE_STUB_V(spdk_bdev_module_examine_done, (struct spdk_bdev_module *module));
@@ -514,6 +517,86 @@ test_supported_io(void)
 	rc = vbdev_crypto_io_type_supported(ctx, SPDK_BDEV_IO_TYPE_WRITE_ZEROES);
 	CU_ASSERT(rc == false);
 }
+
+static void
+test_key_ranges(void)
+{
+	struct spdk_accel_crypto_key default_key, key1, key2;
+	struct vbdev_crypto_key_range ranges[] = {
+		{ .offset_blocks = 64, .num_blocks = 64, .key = &key1 },
+		{ .offset_blocks = 256, .num_blocks = 128, .key = &key2 },
+	};
+
+	g_crypto_ch->crypto_key = &default_key;
+	g_crypto_bdev_opts.key_ranges = ranges;
+	g_crypto_bdev_opts.num_key_ranges = SPDK_COUNTOF(ranges);
+
+	g_base_io->u.bdev.offset_blocks = 0;
+	CU_ASSERT(crypto_get_key(g_crypto_ch, g_base_io) == &default_key);
+	g_base_io->u.bdev.offset_blocks = 64;
+	CU_ASSERT(crypto_get_key(g_crypto_ch, g_base_io) == &key1);
+	g_base_io->u.bdev.offset_blocks = 127;
+	CU_ASSERT(crypto_get_key(g_crypto_ch, g_base_io) == &key1);
+	g_base_io->u.bdev.offset_blocks = 128;
+	CU_ASSERT(crypto_get_key(g_crypto_ch, g_base_io) == &default_key);
+	g_base_io->u.bdev.offset_blocks = 300;
+	CU_ASSERT(crypto_get_key(g_crypto_ch, g_base_io) == &key2);
+	g_base_io->u.bdev.offset_blocks = 384;
+	CU_ASSERT(crypto_get_key(g_crypto_ch, g_base_io) == &default_key);
+
+	/* The I/Os are split on a boundary that all the ranges start and end on */
+	CU_ASSERT(vbdev_crypto_key_ranges_boundary(&g_crypto_bdev_opts, 0) == 64);
+	CU_ASSERT(vbdev_crypto_key_ranges_boundary(&g_crypto_bdev_opts, 32) == 32);
+
+	ranges[0].offset_blocks = 0;
+	ranges[0].num_blocks = 1ULL << 33;
+	g_crypto_bdev_opts.num_key_ranges = 1;
+	CU_ASSERT(vbdev_crypto_key_ranges_boundary(&g_crypto_bdev_opts, 0) == 1U << 31);
+
+	g_crypto_bdev_opts.key_ranges = NULL;
+	g_crypto_bdev_opts.num_key_ranges = 0;
+	g_base_io->u.bdev.offset_blocks = 0;
+}
+
+static void
+test_claim_dif(void)
+{
+	struct vbdev_crypto_opts opts = { .vbdev_name = "crypto0", .bdev_name = "base0" };
+	struct bdev_names name = { .opts = &opts };
+	struct spdk_bdev base_bdev = { .name = "base0", .blocklen = 512, .blockcnt = 128 };
+	struct vbdev_crypto *vbdev;
+	int rc;
+
+	TAILQ_INSERT_TAIL(&g_bdev_names, &name, link);
+	MOCK_SET(spdk_bdev_desc_get_bdev, &base_bdev);
+	MOCK_SET(spdk_bdev_get_dif_type, SPDK_DIF_TYPE1);
+
+	/* Interleaved protection information would be encrypted along with the data */
+	MOCK_SET(spdk_bdev_is_md_interleaved, true);
+	rc = vbdev_crypto_claim("base0");
+	CU_ASSERT(rc == -ENOTSUP);
+	CU_ASSERT(TAILQ_EMPTY(&g_vbdev_crypto));
+
+	/* Separate metadata is left to the base bdev */
+	MOCK_SET(spdk_bdev_is_md_interleaved, false);
+	rc = vbdev_crypto_claim("base0");
+	CU_ASSERT(rc == 0);
+	vbdev = TAILQ_FIRST(&g_vbdev_crypto);
+	SPDK_CU_ASSERT_FATAL(vbdev != NULL);
+	CU_ASSERT(vbdev->base_bdev == &base_bdev);
+	CU_ASSERT(vbdev->crypto_bdev.blocklen == 512);
+	CU_ASSERT(vbdev->crypto_bdev.md_len == 0);
+
+	TAILQ_REMOVE(&g_vbdev_crypto, vbdev, link);
+	spdk_io_device_unregister(vbdev, NULL);
+	poll_threads();
+	free(vbdev->crypto_bdev.name);
+	free(vbdev);
+
+	MOCK_SET(spdk_bdev_desc_get_bdev, NULL);
+	MOCK_SET(spdk_bdev_get_dif_type, SPDK_DIF_DISABLE);
+	TAILQ_REMOVE(&g_bdev_names, &name, link);
+}
 int
 main(int argc, char **argv)
 {
@@ -530,6 +613,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_crypto_op_complete);
 	CU_ADD_TEST(suite, test_supported_io);
 	CU_ADD_TEST(suite, test_reset);
+	CU_ADD_TEST(suite, test_key_ranges);
+	CU_ADD_TEST(suite, test_claim_dif);
 
 	allocate_threads(1);
 	set_thread(0);
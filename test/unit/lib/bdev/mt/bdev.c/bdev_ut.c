@@ -17,6 +17,11 @@
 
 #include "common/lib/bdev/common_stubs.h"
 
+DEFINE_STUB(spdk_memory_domain_translate_data, int,
+	    (struct spdk_memory_domain *src_domain, void *src_domain_ctx,
+	     struct spdk_memory_domain *dst_domain, struct spdk_memory_domain_translation_ctx *dst_domain_ctx,
+	     void *addr, size_t len, struct spdk_memory_domain_translation_result *result), -ENOTSUP);
+
 #define BDEV_UT_NUM_THREADS 3
 
 DEFINE_RETURN_MOCK(spdk_memory_domain_pull_data, int);
@@ -232,11 +237,20 @@ stub_io_type_supported(void *ctx, enum spdk_bdev_io_type type)
 	return true;
 }
 
+static uint32_t g_max_outstanding_io;
+
+static uint32_t
+stub_get_max_outstanding_io(struct spdk_io_channel *ch)
+{
+	return g_max_outstanding_io;
+}
+
 static struct spdk_bdev_fn_table fn_table = {
 	.get_io_channel =	stub_get_io_channel,
 	.destruct =		stub_destruct,
 	.submit_request =	stub_submit_request,
 	.io_type_supported =	stub_io_type_supported,
+	.get_max_outstanding_io =	stub_get_max_outstanding_io,
 };
 
 struct spdk_bdev_module bdev_ut_if;
@@ -1455,6 +1469,65 @@ enomem(void)
 	teardown_test();
 }
 
+static void
+enomem_max_outstanding(void)
+{
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev_shared_resource *shared_resource;
+	struct ut_bdev_channel *ut_ch;
+	const uint32_t IO_ARRAY_SIZE = 16;
+	const uint32_t MAX_OUTSTANDING = 4;
+	enum spdk_bdev_io_status status[IO_ARRAY_SIZE];
+	uint32_t i;
+	int rc;
+
+	setup_test();
+
+	/* The module publishes how many I/O it can take, so they are never completed with NOMEM */
+	g_max_outstanding_io = MAX_OUTSTANDING;
+	set_thread(0);
+	io_ch = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+	shared_resource = bdev_ch->shared_resource;
+	CU_ASSERT(shared_resource->max_outstanding == MAX_OUTSTANDING);
+	ut_ch = spdk_io_channel_get_ctx(bdev_ch->channel);
+	/* The stub only frees its slot after the completion callback returns */
+	ut_ch->avail_cnt = MAX_OUTSTANDING + 1;
+
+	for (i = 0; i < IO_ARRAY_SIZE; i++) {
+		status[i] = SPDK_BDEV_IO_STATUS_PENDING;
+		rc = spdk_bdev_read_blocks(g_desc, io_ch, NULL, 0, 1, enomem_done, &status[i]);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(ut_ch->outstanding_cnt == MAX_OUTSTANDING);
+	CU_ASSERT(shared_resource->io_outstanding == MAX_OUTSTANDING);
+	CU_ASSERT(bdev_io_tailq_cnt(&shared_resource->nomem_io) == IO_ARRAY_SIZE - MAX_OUTSTANDING);
+
+	/* Each completion frees a slot, which is immediately used by the next queued I/O */
+	stub_complete_io(g_bdev.io_target, 1);
+	CU_ASSERT(status[0] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_ch->outstanding_cnt == MAX_OUTSTANDING);
+	CU_ASSERT(bdev_io_tailq_cnt(&shared_resource->nomem_io) == IO_ARRAY_SIZE - MAX_OUTSTANDING - 1);
+
+	for (i = 1; i < IO_ARRAY_SIZE - MAX_OUTSTANDING; i++) {
+		stub_complete_io(g_bdev.io_target, 1);
+		CU_ASSERT(ut_ch->outstanding_cnt == MAX_OUTSTANDING);
+	}
+	CU_ASSERT(TAILQ_EMPTY(&shared_resource->nomem_io));
+
+	stub_complete_io(g_bdev.io_target, 0);
+	CU_ASSERT(shared_resource->io_outstanding == 0);
+	for (i = 0; i < IO_ARRAY_SIZE; i++) {
+		CU_ASSERT(status[i] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+
+	g_max_outstanding_io = 0;
+	spdk_put_io_channel(io_ch);
+	poll_threads();
+	teardown_test();
+}
+
 static void
 enomem_multi_bdev(void)
 {
@@ -1724,6 +1797,82 @@ enomem_retry_during_abort(void)
 	teardown_test();
 }
 
+static void
+enomem_priority(void)
+{
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev_shared_resource *shared_resource;
+	struct ut_bdev_channel *ut_ch;
+	struct spdk_bdev_ext_io_opts opts = {
+		.size = sizeof(struct spdk_bdev_ext_io_opts),
+	};
+	const uint8_t priorities[] = {
+		SPDK_BDEV_IO_PRIORITY_LOW, SPDK_BDEV_IO_PRIORITY_DEFAULT, SPDK_BDEV_IO_PRIORITY_HIGH
+	};
+	const uint8_t expected[] = {
+		SPDK_BDEV_IO_PRIORITY_HIGH, SPDK_BDEV_IO_PRIORITY_DEFAULT,
+		SPDK_BDEV_IO_PRIORITY_DEFAULT, SPDK_BDEV_IO_PRIORITY_LOW
+	};
+	enum spdk_bdev_io_status status[5], status_reset;
+	struct spdk_bdev_io *bdev_io;
+	struct iovec iov = {};
+	uint32_t i;
+	int rc;
+
+	setup_test();
+
+	set_thread(0);
+	io_ch = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+	shared_resource = bdev_ch->shared_resource;
+	ut_ch = spdk_io_channel_get_ctx(bdev_ch->channel);
+	ut_ch->avail_cnt = 1;
+
+	/* The first I/O fills the channel, the second one goes onto the nomem_io list. */
+	for (i = 0; i < 2; i++) {
+		status[i] = SPDK_BDEV_IO_STATUS_PENDING;
+		rc = spdk_bdev_read_blocks(g_desc, io_ch, NULL, 0, 1, enomem_done, &status[i]);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(bdev_io_tailq_cnt(&shared_resource->nomem_io) == 1);
+
+	/* Queue I/Os of increasing priority, each should overtake the lower priority ones. */
+	for (i = 0; i < SPDK_COUNTOF(priorities); i++) {
+		status[i + 2] = SPDK_BDEV_IO_STATUS_PENDING;
+		opts.priority = priorities[i];
+		rc = spdk_bdev_readv_blocks_ext(g_desc, io_ch, &iov, 1, 0, 1, enomem_done,
+						&status[i + 2], &opts);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(bdev_io_tailq_cnt(&shared_resource->nomem_io) == SPDK_COUNTOF(expected));
+
+	i = 0;
+	TAILQ_FOREACH(bdev_io, &shared_resource->nomem_io, internal.link) {
+		SPDK_CU_ASSERT_FATAL(i < SPDK_COUNTOF(expected));
+		CU_ASSERT(bdev_io->priority == expected[i]);
+		i++;
+	}
+
+	/* An out of range priority is rejected. */
+	opts.priority = SPDK_BDEV_IO_PRIORITY_LOW + 1;
+	rc = spdk_bdev_readv_blocks_ext(g_desc, io_ch, &iov, 1, 0, 1, enomem_done, NULL, &opts);
+	CU_ASSERT(rc == -EINVAL);
+
+	status_reset = SPDK_BDEV_IO_STATUS_PENDING;
+	rc = spdk_bdev_reset(g_desc, io_ch, enomem_done, &status_reset);
+	poll_threads();
+	CU_ASSERT(rc == 0);
+	stub_complete_io(g_bdev.io_target, 0);
+
+	CU_ASSERT(bdev_io_tailq_cnt(&shared_resource->nomem_io) == 0);
+	CU_ASSERT(shared_resource->io_outstanding == 0);
+
+	spdk_put_io_channel(io_ch);
+	poll_threads();
+	teardown_test();
+}
+
 static void
 qos_dynamic_enable_done(void *cb_arg, int status)
 {
@@ -2863,6 +3012,260 @@ reset_start_complete_race(void)
 	teardown_test();
 }
 
+static void
+complete_remote(void)
+{
+	struct spdk_io_channel *io_ch;
+	struct ut_bdev_channel *ut_ch;
+	struct ut_bdev_io *bio;
+	enum spdk_bdev_io_status status[3];
+	int i, rc;
+
+	setup_test();
+
+	set_thread(0);
+	io_ch = spdk_bdev_get_io_channel(g_desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+	ut_ch = TAILQ_FIRST(&g_ut_channels);
+	SPDK_CU_ASSERT_FATAL(ut_ch != NULL);
+
+	for (i = 0; i < 3; i++) {
+		status[i] = SPDK_BDEV_IO_STATUS_PENDING;
+		rc = spdk_bdev_read_blocks(g_desc, io_ch, NULL, i, 1, io_during_io_done, &status[i]);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(ut_ch->outstanding_cnt == 3);
+
+	/* Complete all I/O from another thread.  Nothing is delivered until thread 0 polls. */
+	set_thread(1);
+	for (i = 0; i < 3; i++) {
+		bio = TAILQ_FIRST(&ut_ch->outstanding_io);
+		TAILQ_REMOVE(&ut_ch->outstanding_io, bio, link);
+		ut_ch->outstanding_cnt--;
+		ut_ch->avail_cnt++;
+		spdk_bdev_io_complete_remote(spdk_bdev_io_from_ctx(bio), i == 1 ?
+					     SPDK_BDEV_IO_STATUS_FAILED : SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+	poll_thread(1);
+	CU_ASSERT(status[0] == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(status[1] == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(status[2] == SPDK_BDEV_IO_STATUS_PENDING);
+
+	/* All three completions are delivered by a single message */
+	poll_thread_times(0, 1);
+	CU_ASSERT(status[0] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(status[1] == SPDK_BDEV_IO_STATUS_FAILED);
+	CU_ASSERT(status[2] == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	set_thread(0);
+	spdk_put_io_channel(io_ch);
+	poll_threads();
+
+	teardown_test();
+}
+
+static void
+qos_fair_share_io_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	int *count = cb_arg;
+
+	CU_ASSERT(success);
+	(*count)++;
+	spdk_bdev_free_io(bdev_io);
+}
+
+static void
+qos_fair_share_next_timeslice(void)
+{
+	spdk_delay_us(SPDK_BDEV_QOS_TIMESLICE_IN_USEC);
+	poll_threads();
+	stub_complete_io(g_bdev.io_target, 0);
+	poll_threads();
+}
+
+static void
+qos_fair_share(void)
+{
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev_desc *desc2 = NULL;
+	struct spdk_bdev *bdev;
+	uint64_t max_limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES] = {};
+	uint64_t min_limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES] = {};
+	int count1 = 0, count2 = 0;
+	int i, rc;
+
+	setup_test();
+
+	/* 4000 read/write I/O per second, or 4 per millisecond */
+	bdev = &g_bdev.bdev;
+	bdev->internal.qos = calloc(1, sizeof(*bdev->internal.qos));
+	SPDK_CU_ASSERT_FATAL(bdev->internal.qos != NULL);
+	bdev->internal.qos->rate_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT].limit = 4000;
+
+	set_thread(0);
+	rc = spdk_bdev_open_ext("ut_bdev", true, _bdev_event_cb, NULL, &desc2);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc2 != NULL);
+
+	/* A minimum above the maximum is rejected */
+	min_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] = 2000;
+	max_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] = 1000;
+	rc = spdk_bdev_desc_set_qos_class(desc2, 1, min_limits, max_limits);
+	CU_ASSERT(rc == -EINVAL);
+
+	rc = spdk_bdev_desc_set_qos_class(g_desc, 3, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_desc_set_qos_class(desc2, 1, NULL, NULL);
+	CU_ASSERT(rc == 0);
+
+	io_ch = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+	CU_ASSERT(bdev_ch->flags == BDEV_CH_QOS_ENABLED);
+
+	for (i = 0; i < 8; i++) {
+		rc = spdk_bdev_read_blocks(g_desc, io_ch, NULL, 0, 1, qos_fair_share_io_done, &count1);
+		CU_ASSERT(rc == 0);
+	}
+	for (i = 0; i < 8; i++) {
+		rc = spdk_bdev_read_blocks(desc2, io_ch, NULL, 0, 1, qos_fair_share_io_done, &count2);
+		CU_ASSERT(rc == 0);
+	}
+
+	/* No descriptor was active before, so the first timeslice is first come, first served */
+	poll_threads();
+	stub_complete_io(g_bdev.io_target, 0);
+	poll_threads();
+	CU_ASSERT(count1 == 4);
+	CU_ASSERT(count2 == 0);
+
+	/* Both descriptors are active, the quota is shared 3:1 */
+	qos_fair_share_next_timeslice();
+	CU_ASSERT(count1 == 7);
+	CU_ASSERT(count2 == 1);
+
+	/* The share of the first descriptor is still reserved while it is active */
+	qos_fair_share_next_timeslice();
+	CU_ASSERT(count1 == 8);
+	CU_ASSERT(count2 == 2);
+
+	qos_fair_share_next_timeslice();
+	CU_ASSERT(count2 == 3);
+
+	/* The first descriptor went idle, the second one can use the whole quota */
+	qos_fair_share_next_timeslice();
+	CU_ASSERT(count2 == 7);
+
+	qos_fair_share_next_timeslice();
+	CU_ASSERT(count2 == 8);
+
+	/* The maximum of a descriptor is enforced even if the bdev has quota left */
+	memset(min_limits, 0, sizeof(min_limits));
+	rc = spdk_bdev_desc_set_qos_class(desc2, 0, min_limits, max_limits);
+	CU_ASSERT(rc == 0);
+	count2 = 0;
+	for (i = 0; i < 3; i++) {
+		rc = spdk_bdev_read_blocks(desc2, io_ch, NULL, 0, 1, qos_fair_share_io_done, &count2);
+		CU_ASSERT(rc == 0);
+	}
+	poll_threads();
+	stub_complete_io(g_bdev.io_target, 0);
+	poll_threads();
+	CU_ASSERT(count2 == 1);
+
+	qos_fair_share_next_timeslice();
+	CU_ASSERT(count2 == 2);
+
+	qos_fair_share_next_timeslice();
+	CU_ASSERT(count2 == 3);
+
+	/* Unclassify both descriptors, the quota is first come, first served again */
+	rc = spdk_bdev_desc_set_qos_class(g_desc, 0, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_desc_set_qos_class(desc2, 0, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	qos_fair_share_next_timeslice();
+	CU_ASSERT(bdev->internal.qos->fair_share == false);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc2);
+	poll_threads();
+
+	teardown_test();
+}
+
+static void
+qos_local_quota(void)
+{
+	struct spdk_io_channel *io_ch[2];
+	struct spdk_bdev_channel *bdev_ch[2];
+	struct spdk_bdev_qos_limit *limit;
+	struct spdk_bdev *bdev;
+	enum spdk_bdev_io_status status[3];
+	int rc;
+
+	setup_test();
+
+	/* 1M read/write I/O per second, or 1000 per millisecond */
+	bdev = &g_bdev.bdev;
+	bdev->internal.qos = calloc(1, sizeof(*bdev->internal.qos));
+	SPDK_CU_ASSERT_FATAL(bdev->internal.qos != NULL);
+	bdev->internal.qos->rate_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT].limit = 1000000;
+	limit = &bdev->internal.qos->rate_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT];
+
+	set_thread(0);
+	io_ch[0] = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch[0] = spdk_io_channel_get_ctx(io_ch[0]);
+	set_thread(1);
+	io_ch[1] = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch[1] = spdk_io_channel_get_ctx(io_ch[1]);
+	CU_ASSERT(limit->max_per_timeslice == 1000);
+	CU_ASSERT(limit->local_quota_batch == 1000 / SPDK_BDEV_QOS_LOCAL_QUOTA_DIVISOR);
+
+	/* The first I/O on a channel takes a batch from the shared quota */
+	set_thread(0);
+	status[0] = SPDK_BDEV_IO_STATUS_PENDING;
+	rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done, &status[0]);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(limit->remaining_this_timeslice == 1000 - limit->local_quota_batch);
+	CU_ASSERT(bdev_ch[0]->qos_local_quota[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] ==
+		  limit->local_quota_batch - 1);
+
+	/* The next one is served from the channel's cache */
+	status[1] = SPDK_BDEV_IO_STATUS_PENDING;
+	rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done, &status[1]);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(limit->remaining_this_timeslice == 1000 - limit->local_quota_batch);
+	CU_ASSERT(bdev_ch[0]->qos_local_quota[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] ==
+		  limit->local_quota_batch - 2);
+
+	/* The other channel takes its own batch */
+	set_thread(1);
+	status[2] = SPDK_BDEV_IO_STATUS_PENDING;
+	rc = spdk_bdev_read_blocks(g_desc, io_ch[1], NULL, 0, 1, io_during_io_done, &status[2]);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(limit->remaining_this_timeslice == 1000 - 2 * limit->local_quota_batch);
+	CU_ASSERT(bdev_ch[1]->qos_local_quota[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] ==
+		  limit->local_quota_batch - 1);
+
+	poll_threads();
+	stub_complete_io(g_bdev.io_target, 0);
+	set_thread(0);
+	stub_complete_io(g_bdev.io_target, 0);
+	poll_threads();
+	CU_ASSERT(status[0] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(status[1] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(status[2] == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	set_thread(1);
+	spdk_put_io_channel(io_ch[1]);
+	set_thread(0);
+	spdk_put_io_channel(io_ch[0]);
+	poll_threads();
+
+	teardown_test();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -2887,11 +3290,15 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, io_during_qos_queue);
 	CU_ADD_TEST(suite, io_during_qos_reset);
 	CU_ADD_TEST(suite, enomem);
+	CU_ADD_TEST(suite, enomem_max_outstanding);
 	CU_ADD_TEST(suite, enomem_multi_bdev);
 	CU_ADD_TEST(suite, enomem_multi_bdev_unregister);
 	CU_ADD_TEST(suite, enomem_multi_io_target);
 	CU_ADD_TEST(suite, enomem_retry_during_abort);
+	CU_ADD_TEST(suite, enomem_priority);
 	CU_ADD_TEST(suite, qos_dynamic_enable);
+	CU_ADD_TEST(suite, qos_fair_share);
+	CU_ADD_TEST(suite, qos_local_quota);
 	CU_ADD_TEST(suite, bdev_histograms_mt);
 	CU_ADD_TEST(suite, bdev_set_io_timeout_mt);
 	CU_ADD_TEST(suite, lock_lba_range_then_submit_io);
@@ -2901,6 +3308,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, event_notify_and_close);
 	CU_ADD_TEST(suite, unregister_and_qos_poller);
 	CU_ADD_TEST(suite, reset_start_complete_race);
+	CU_ADD_TEST(suite, complete_remote);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
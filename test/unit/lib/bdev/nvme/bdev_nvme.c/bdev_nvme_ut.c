@@ -90,6 +90,11 @@ DEFINE_STUB(spdk_nvme_ctrlr_get_admin_qp_fd, int, (struct spdk_nvme_ctrlr *ctrlr
 DEFINE_STUB(spdk_nvme_poll_group_set_interrupt_callback, int,
 	    (struct spdk_nvme_poll_group *group,
 	     spdk_nvme_poll_group_interrupt_cb cb_fn, void *ctx), 0);
+DEFINE_STUB(spdk_nvme_poll_group_set_adaptive_polling, int,
+	    (struct spdk_nvme_poll_group *group, uint32_t idle_polls), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_cmd_set_feature, int,
+	    (struct spdk_nvme_ctrlr *ctrlr, uint8_t feature, uint32_t cdw11, uint32_t cdw12,
+	     void *payload, uint32_t payload_size, spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
 int
 spdk_nvme_ctrlr_get_memory_domains(const struct spdk_nvme_ctrlr *ctrlr,
 				   struct spdk_memory_domain **domains, int array_size)
@@ -304,6 +309,7 @@ struct spdk_nvme_qpair {
 	struct spdk_nvme_ctrlr		*ctrlr;
 	uint8_t				failure_reason;
 	bool				is_connected;
+	bool				is_connecting;
 	bool				in_completion_context;
 	bool				delete_after_completion_context;
 	TAILQ_HEAD(, ut_nvme_req)	outstanding_reqs;
@@ -323,6 +329,7 @@ struct spdk_nvme_ctrlr {
 	bool				attached;
 	bool				is_failed;
 	bool				fail_reset;
+	bool				connect_io_qpair_async;
 	bool				is_removed;
 	struct spdk_nvme_transport_id	trid;
 	TAILQ_HEAD(, spdk_nvme_qpair)	active_io_qpairs;
@@ -798,6 +805,7 @@ spdk_nvme_ctrlr_connect_io_qpair(struct spdk_nvme_ctrlr *ctrlr,
 	}
 
 	qpair->is_connected = true;
+	qpair->is_connecting = ctrlr->connect_io_qpair_async;
 	qpair->failure_reason = SPDK_NVME_QPAIR_FAILURE_NONE;
 
 	if (qpair->poll_group) {
@@ -815,6 +823,7 @@ spdk_nvme_ctrlr_disconnect_io_qpair(struct spdk_nvme_qpair *qpair)
 	}
 
 	qpair->is_connected = false;
+	qpair->is_connecting = false;
 
 	if (qpair->poll_group != NULL) {
 		nvme_poll_group_disconnect_qpair(qpair);
@@ -1130,12 +1139,16 @@ spdk_nvme_ns_cmd_writev_ext(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpa
 }
 
 static bool g_ut_write_ext_called;
+static uint32_t g_ut_write_ext_io_flags;
+static uint32_t g_ut_write_ext_cdw13;
 int
 spdk_nvme_ns_cmd_write_ext(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair, void *buffer,
 			   uint64_t lba, uint32_t lba_count, spdk_nvme_cmd_cb cb_fn, void *cb_arg,
 			   struct spdk_nvme_ns_cmd_ext_io_opts *opts)
 {
 	g_ut_write_ext_called = true;
+	g_ut_write_ext_io_flags = opts->io_flags;
+	g_ut_write_ext_cdw13 = opts->cdw13;
 	return ut_submit_nvme_request(ns, qpair, SPDK_NVME_OPC_WRITE, cb_fn, cb_arg);
 }
 
@@ -1218,7 +1231,7 @@ spdk_nvme_qpair_get_failure_reason(struct spdk_nvme_qpair *qpair)
 bool
 spdk_nvme_qpair_is_connected(struct spdk_nvme_qpair *qpair)
 {
-	return qpair->is_connected;
+	return qpair->is_connected && !qpair->is_connecting;
 }
 
 int32_t
@@ -2504,6 +2517,20 @@ test_submit_nvme_cmd(void)
 	g_ut_read_ext_called = false;
 	bdev_io->u.bdev.memory_domain = NULL;
 
+	/* Verify that ext NVME API is called when a write carries a directive */
+	g_ut_write_ext_called = false;
+	ut_test_submit_nvme_cmd(ch, bdev_io, SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(g_ut_write_ext_called == false);
+	bdev_io->u.bdev.nvme_cdw12.write.dtype = SPDK_NVME_DIRECTIVE_TYPE_DATA_PLACEMENT;
+	bdev_io->u.bdev.nvme_cdw13.write.dspec = 3;
+	ut_test_submit_nvme_cmd(ch, bdev_io, SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(g_ut_write_ext_called == true);
+	CU_ASSERT(g_ut_write_ext_io_flags & SPDK_NVME_IO_FLAGS_DATA_PLACEMENT_DIRECTIVE);
+	CU_ASSERT(g_ut_write_ext_cdw13 == bdev_io->u.bdev.nvme_cdw13.raw);
+	g_ut_write_ext_called = false;
+	bdev_io->u.bdev.nvme_cdw12.raw = 0;
+	bdev_io->u.bdev.nvme_cdw13.raw = 0;
+
 	ut_test_submit_admin_cmd(ch, bdev_io, ctrlr);
 
 	free(bdev_io);
@@ -5187,6 +5214,196 @@ test_retry_io_count(void)
 	g_opts.bdev_retry_count = 0;
 }
 
+static void
+test_io_qpair_idle_timeout(void)
+{
+	struct nvme_path_id path = {};
+	struct spdk_nvme_ctrlr *ctrlr;
+	struct spdk_nvme_ctrlr_opts opts = {.hostnqn = UT_HOSTNQN};
+	struct nvme_bdev_ctrlr *nbdev_ctrlr;
+	struct nvme_ctrlr *nvme_ctrlr;
+	const int STRING_SIZE = 32;
+	const char *attached_names[STRING_SIZE];
+	struct nvme_bdev *nbdev;
+	struct spdk_bdev_io *bdev_io;
+	struct spdk_io_channel *ch;
+	struct nvme_bdev_channel *nbdev_ch;
+	struct nvme_io_path *io_path;
+	struct nvme_qpair *nvme_qpair;
+	int rc;
+	struct spdk_bdev_nvme_ctrlr_opts bdev_opts = {0};
+
+	spdk_bdev_nvme_get_default_ctrlr_opts(&bdev_opts);
+	bdev_opts.multipath = false;
+
+	memset(attached_names, 0, sizeof(char *) * STRING_SIZE);
+	ut_init_trid(&path.trid);
+
+	g_opts.io_qpair_idle_timeout_ms = 10;
+
+	set_thread(0);
+
+	ctrlr = ut_attach_ctrlr(&path.trid, 1, false, false);
+	SPDK_CU_ASSERT_FATAL(ctrlr != NULL);
+
+	g_ut_attach_ctrlr_status = 0;
+	g_ut_attach_bdev_count = 1;
+
+	rc = spdk_bdev_nvme_create(&path.trid, "nvme0", attached_names, STRING_SIZE,
+				   attach_ctrlr_done, NULL, &opts, &bdev_opts);
+	CU_ASSERT(rc == 0);
+
+	spdk_delay_us(1000);
+	poll_threads();
+
+	nbdev_ctrlr = nvme_bdev_ctrlr_get_by_name("nvme0");
+	SPDK_CU_ASSERT_FATAL(nbdev_ctrlr != NULL);
+
+	nvme_ctrlr = nvme_bdev_ctrlr_get_ctrlr(nbdev_ctrlr, &path.trid, opts.hostnqn);
+	CU_ASSERT(nvme_ctrlr != NULL);
+
+	nbdev = nvme_bdev_ctrlr_get_bdev(nbdev_ctrlr, 1);
+	CU_ASSERT(nbdev != NULL);
+
+	bdev_io = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, NULL);
+	ut_bdev_io_set_buf(bdev_io);
+
+	ch = spdk_get_io_channel(nbdev);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	nbdev_ch = spdk_io_channel_get_ctx(ch);
+
+	io_path = ut_get_io_path_by_ctrlr(nbdev_ch, nvme_ctrlr);
+	SPDK_CU_ASSERT_FATAL(io_path != NULL);
+
+	nvme_qpair = io_path->qpair;
+	SPDK_CU_ASSERT_FATAL(nvme_qpair != NULL);
+
+	/* The qpair is not connected until the first I/O is submitted. */
+	CU_ASSERT(nvme_qpair->idle == true);
+	CU_ASSERT(nvme_qpair->qpair == NULL);
+
+	bdev_io->internal.ch = (struct spdk_bdev_channel *)ch;
+	bdev_io->internal.f.in_submit_request = true;
+
+	bdev_nvme_submit_request(ch, bdev_io);
+
+	CU_ASSERT(nvme_qpair->idle == false);
+	SPDK_CU_ASSERT_FATAL(nvme_qpair->qpair != NULL);
+	CU_ASSERT(nvme_qpair->qpair->num_outstanding_reqs == 1);
+
+	poll_threads();
+
+	CU_ASSERT(bdev_io->internal.f.in_submit_request == false);
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	/* An I/O was submitted during the first period, so the qpair is kept. */
+	spdk_delay_us(10000);
+	poll_threads();
+
+	CU_ASSERT(nvme_qpair->idle == false);
+	CU_ASSERT(nvme_qpair->qpair != NULL);
+
+	/* No I/O was submitted during the second period. The qpair is disconnected
+	 * without resetting the ctrlr.
+	 */
+	spdk_delay_us(10000);
+	poll_threads();
+
+	CU_ASSERT(nvme_qpair->idle == true);
+	CU_ASSERT(nvme_qpair->qpair == NULL);
+	CU_ASSERT(nvme_ctrlr->resetting == false);
+
+	/* The next I/O connects the qpair again. */
+	bdev_io->internal.f.in_submit_request = true;
+
+	bdev_nvme_submit_request(ch, bdev_io);
+
+	CU_ASSERT(nvme_qpair->idle == false);
+	SPDK_CU_ASSERT_FATAL(nvme_qpair->qpair != NULL);
+	CU_ASSERT(nvme_qpair->qpair->num_outstanding_reqs == 1);
+
+	poll_threads();
+
+	CU_ASSERT(bdev_io->internal.f.in_submit_request == false);
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	free(bdev_io);
+
+	spdk_put_io_channel(ch);
+
+	poll_threads();
+
+	rc = bdev_nvme_delete("nvme0", &g_any_path, NULL, NULL);
+	CU_ASSERT(rc == 0);
+
+	poll_threads();
+	spdk_delay_us(1000);
+	poll_threads();
+
+	CU_ASSERT(nvme_bdev_ctrlr_get_by_name("nvme0") == NULL);
+
+	g_opts.io_qpair_idle_timeout_ms = 0;
+}
+
+static void
+test_multipath_stripe_size(void)
+{
+	struct spdk_nvme_transport_id trid = {};
+	struct spdk_nvme_ctrlr *ctrlr;
+	struct spdk_nvme_ctrlr_opts opts = {.hostnqn = UT_HOSTNQN};
+	struct nvme_ctrlr *nvme_ctrlr;
+	const int STRING_SIZE = 32;
+	const char *attached_names[STRING_SIZE];
+	struct nvme_bdev *nbdev;
+	int rc;
+	struct spdk_bdev_nvme_ctrlr_opts bdev_opts = {0};
+
+	spdk_bdev_nvme_get_default_ctrlr_opts(&bdev_opts);
+
+	memset(attached_names, 0, sizeof(char *) * STRING_SIZE);
+	ut_init_trid(&trid);
+
+	MOCK_SET(spdk_nvme_ns_get_extended_sector_size, 512);
+	g_opts.multipath_stripe_size = 128 * 1024;
+
+	set_thread(0);
+
+	ctrlr = ut_attach_ctrlr(&trid, 1, false, false);
+	SPDK_CU_ASSERT_FATAL(ctrlr != NULL);
+
+	g_ut_attach_ctrlr_status = 0;
+	g_ut_attach_bdev_count = 1;
+
+	rc = spdk_bdev_nvme_create(&trid, "nvme0", attached_names, STRING_SIZE,
+				   attach_ctrlr_done, NULL, &opts, &bdev_opts);
+	CU_ASSERT(rc == 0);
+
+	spdk_delay_us(1000);
+	poll_threads();
+
+	nvme_ctrlr = nvme_ctrlr_get_by_name("nvme0");
+	SPDK_CU_ASSERT_FATAL(nvme_ctrlr != NULL);
+
+	nbdev = nvme_ctrlr_get_ns(nvme_ctrlr, 1)->bdev;
+	SPDK_CU_ASSERT_FATAL(nbdev != NULL);
+
+	/* I/Os larger than the stripe are split by the bdev layer. */
+	CU_ASSERT(nbdev->disk.max_rw_size == 256);
+
+	rc = bdev_nvme_delete("nvme0", &g_any_path, NULL, NULL);
+	CU_ASSERT(rc == 0);
+
+	poll_threads();
+	spdk_delay_us(1000);
+	poll_threads();
+
+	CU_ASSERT(nvme_ctrlr_get_by_name("nvme0") == NULL);
+
+	g_opts.multipath_stripe_size = 0;
+	MOCK_CLEAR(spdk_nvme_ns_get_extended_sector_size);
+}
+
 static void
 test_concurrent_read_ana_log_page(void)
 {
@@ -6471,6 +6688,119 @@ test_find_io_path_min_qd(void)
 	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
 }
 
+static void
+test_find_io_path_min_latency(void)
+{
+	struct nvme_bdev_channel nbdev_ch = {
+		.io_path_list = STAILQ_HEAD_INITIALIZER(nbdev_ch.io_path_list),
+		.mp_policy = BDEV_NVME_MP_POLICY_ACTIVE_ACTIVE,
+		.mp_selector = BDEV_NVME_MP_SELECTOR_LATENCY,
+	};
+	struct spdk_nvme_qpair qpair1 = {}, qpair2 = {}, qpair3 = {};
+	struct spdk_nvme_ctrlr ctrlr1 = {}, ctrlr2 = {}, ctrlr3 = {};
+	struct spdk_nvme_ns ns1 = {}, ns2 = {}, ns3 = {};
+	struct nvme_ctrlr nvme_ctrlr1 = { .ctrlr = &ctrlr1, };
+	struct nvme_ctrlr nvme_ctrlr2 = { .ctrlr = &ctrlr2, };
+	struct nvme_ctrlr nvme_ctrlr3 = { .ctrlr = &ctrlr3, };
+	struct nvme_ctrlr_channel ctrlr_ch1 = {};
+	struct nvme_ctrlr_channel ctrlr_ch2 = {};
+	struct nvme_ctrlr_channel ctrlr_ch3 = {};
+	struct nvme_qpair nvme_qpair1 = { .ctrlr_ch = &ctrlr_ch1, .ctrlr = &nvme_ctrlr1, .qpair = &qpair1, };
+	struct nvme_qpair nvme_qpair2 = { .ctrlr_ch = &ctrlr_ch2, .ctrlr = &nvme_ctrlr2, .qpair = &qpair2, };
+	struct nvme_qpair nvme_qpair3 = { .ctrlr_ch = &ctrlr_ch3, .ctrlr = &nvme_ctrlr3, .qpair = &qpair3, };
+	struct nvme_ns nvme_ns1 = { .ns = &ns1, }, nvme_ns2 = { .ns = &ns2, }, nvme_ns3 = { .ns = &ns3, };
+	struct nvme_io_path io_path1 = { .qpair = &nvme_qpair1, .nvme_ns = &nvme_ns1, };
+	struct nvme_io_path io_path2 = { .qpair = &nvme_qpair2, .nvme_ns = &nvme_ns2, };
+	struct nvme_io_path io_path3 = { .qpair = &nvme_qpair3, .nvme_ns = &nvme_ns3, };
+
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path1, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path2, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path3, stailq);
+
+	nvme_ns1.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns2.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns3.ana_state = SPDK_NVME_ANA_NON_OPTIMIZED_STATE;
+
+	/* A path without a latency sample is probed first. */
+	nvme_qpair1.ewma_latency_ticks = 100;
+	nvme_qpair2.ewma_latency_ticks = 0;
+	nvme_qpair3.ewma_latency_ticks = 10;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+
+	/* The predicted latency is the average latency scaled by the queue depth,
+	 * and the ANA optimized state is still prioritized.
+	 */
+	nvme_qpair2.ewma_latency_ticks = 10;
+	qpair1.num_outstanding_reqs = 0;
+	qpair2.num_outstanding_reqs = 4;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+
+	qpair2.num_outstanding_reqs = 10;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	nvme_ns1.ana_state = SPDK_NVME_ANA_INACCESSIBLE_STATE;
+	nvme_ns2.ana_state = SPDK_NVME_ANA_INACCESSIBLE_STATE;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path3);
+}
+
+static void
+test_find_io_path_numa_local(void)
+{
+	struct nvme_bdev_channel nbdev_ch = {
+		.io_path_list = STAILQ_HEAD_INITIALIZER(nbdev_ch.io_path_list),
+		.mp_policy = BDEV_NVME_MP_POLICY_ACTIVE_ACTIVE,
+		.mp_selector = BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH,
+	};
+	struct spdk_nvme_qpair qpair1 = {}, qpair2 = {}, qpair3 = {};
+	struct spdk_nvme_ctrlr ctrlr1 = {}, ctrlr2 = {}, ctrlr3 = {};
+	struct spdk_nvme_ns ns1 = {}, ns2 = {}, ns3 = {};
+	struct nvme_ctrlr nvme_ctrlr1 = { .ctrlr = &ctrlr1, };
+	struct nvme_ctrlr nvme_ctrlr2 = { .ctrlr = &ctrlr2, };
+	struct nvme_ctrlr nvme_ctrlr3 = { .ctrlr = &ctrlr3, };
+	struct nvme_ctrlr_channel ctrlr_ch1 = {};
+	struct nvme_ctrlr_channel ctrlr_ch2 = {};
+	struct nvme_ctrlr_channel ctrlr_ch3 = {};
+	struct nvme_qpair nvme_qpair1 = { .ctrlr_ch = &ctrlr_ch1, .ctrlr = &nvme_ctrlr1, .qpair = &qpair1, };
+	struct nvme_qpair nvme_qpair2 = { .ctrlr_ch = &ctrlr_ch2, .ctrlr = &nvme_ctrlr2, .qpair = &qpair2, };
+	struct nvme_qpair nvme_qpair3 = { .ctrlr_ch = &ctrlr_ch3, .ctrlr = &nvme_ctrlr3, .qpair = &qpair3, };
+	struct nvme_ns nvme_ns1 = { .ns = &ns1, }, nvme_ns2 = { .ns = &ns2, }, nvme_ns3 = { .ns = &ns3, };
+	struct nvme_io_path io_path1 = { .qpair = &nvme_qpair1, .nvme_ns = &nvme_ns1, .numa_local = false, };
+	struct nvme_io_path io_path2 = { .qpair = &nvme_qpair2, .nvme_ns = &nvme_ns2, .numa_local = true, };
+	struct nvme_io_path io_path3 = { .qpair = &nvme_qpair3, .nvme_ns = &nvme_ns3, .numa_local = true, };
+
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path1, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path2, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path3, stailq);
+
+	nvme_ns1.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns2.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns3.ana_state = SPDK_NVME_ANA_NON_OPTIMIZED_STATE;
+	qpair1.num_outstanding_reqs = 0;
+	qpair2.num_outstanding_reqs = 2;
+	qpair3.num_outstanding_reqs = 0;
+
+	/* Without the threshold, the NUMA locality is ignored. */
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* The local optimized path is used until it is saturated. */
+	g_opts.numa_affinity_qd_threshold = 4;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+
+	qpair2.num_outstanding_reqs = 4;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* A local non-optimized path is not preferred over a remote optimized path. */
+	nvme_ns2.ana_state = SPDK_NVME_ANA_INACCESSIBLE_STATE;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* If there is no optimized path, local non-optimized paths are preferred. */
+	nvme_ns1.ana_state = SPDK_NVME_ANA_NON_OPTIMIZED_STATE;
+	qpair3.num_outstanding_reqs = 1;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path3);
+
+	g_opts.numa_affinity_qd_threshold = 0;
+}
+
 static void
 test_disable_auto_failback(void)
 {
@@ -8160,6 +8490,339 @@ test_race_between_clear_pending_resets_and_reset_ctrlr_complete(void)
 	free(bdev_io);
 }
 
+static void
+test_zone_write_plugging(void)
+{
+	struct nvme_path_id path = {};
+	struct spdk_bdev_nvme_ctrlr_opts opts = {};
+	struct spdk_nvme_ctrlr *ctrlr;
+	struct spdk_nvme_ctrlr_opts dopts = {.hostnqn = UT_HOSTNQN};
+	struct nvme_bdev_ctrlr *nbdev_ctrlr;
+	struct nvme_ctrlr *nvme_ctrlr;
+	const int STRING_SIZE = 32;
+	const char *attached_names[STRING_SIZE];
+	struct nvme_bdev *nbdev;
+	struct spdk_bdev_io *bdev_io1, *bdev_io2, *bdev_io3;
+	struct nvme_bdev_io *bio1, *bio2, *bio3;
+	struct spdk_io_channel *ch;
+	struct nvme_bdev_channel *nbdev_ch;
+	struct nvme_io_path *io_path;
+	struct nvme_qpair *nvme_qpair;
+	int rc;
+
+	memset(attached_names, 0, sizeof(char *) * STRING_SIZE);
+	ut_init_trid(&path.trid);
+
+	set_thread(0);
+
+	ctrlr = ut_attach_ctrlr(&path.trid, 1, false, false);
+	SPDK_CU_ASSERT_FATAL(ctrlr != NULL);
+
+	g_ut_attach_ctrlr_status = 0;
+	g_ut_attach_bdev_count = 1;
+
+	rc = spdk_bdev_nvme_create(&path.trid, "nvme0", attached_names, STRING_SIZE,
+				   attach_ctrlr_done, NULL, &dopts, &opts);
+	CU_ASSERT(rc == 0);
+
+	spdk_delay_us(1000);
+	poll_threads();
+
+	nbdev_ctrlr = nvme_bdev_ctrlr_get_by_name("nvme0");
+	SPDK_CU_ASSERT_FATAL(nbdev_ctrlr != NULL);
+
+	nvme_ctrlr = nvme_bdev_ctrlr_get_ctrlr(nbdev_ctrlr, &path.trid, dopts.hostnqn);
+	CU_ASSERT(nvme_ctrlr != NULL);
+
+	nbdev = nvme_bdev_ctrlr_get_bdev(nbdev_ctrlr, 1);
+	SPDK_CU_ASSERT_FATAL(nbdev != NULL);
+
+	/* Make the bdev look like a zoned namespace with zones of 16 blocks. */
+	nbdev->disk.zoned = true;
+	nbdev->disk.zone_size = 16;
+
+	ch = spdk_get_io_channel(nbdev);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	nbdev_ch = spdk_io_channel_get_ctx(ch);
+
+	io_path = ut_get_io_path_by_ctrlr(nbdev_ch, nvme_ctrlr);
+	SPDK_CU_ASSERT_FATAL(io_path != NULL);
+
+	nvme_qpair = io_path->qpair;
+	SPDK_CU_ASSERT_FATAL(nvme_qpair != NULL);
+	SPDK_CU_ASSERT_FATAL(nvme_qpair->qpair != NULL);
+
+	bdev_io1 = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	ut_bdev_io_set_buf(bdev_io1);
+	bdev_io1->u.bdev.offset_blocks = 0;
+	bdev_io1->u.bdev.num_blocks = 1;
+	bio1 = (struct nvme_bdev_io *)bdev_io1->driver_ctx;
+
+	bdev_io2 = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	ut_bdev_io_set_buf(bdev_io2);
+	bdev_io2->u.bdev.offset_blocks = 1;
+	bdev_io2->u.bdev.num_blocks = 1;
+	bio2 = (struct nvme_bdev_io *)bdev_io2->driver_ctx;
+
+	bdev_io3 = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	ut_bdev_io_set_buf(bdev_io3);
+	bdev_io3->u.bdev.offset_blocks = 16;
+	bdev_io3->u.bdev.num_blocks = 1;
+	bio3 = (struct nvme_bdev_io *)bdev_io3->driver_ctx;
+
+	/* The first write to zone 0 is submitted. The second one waits for it. The write to
+	 * zone 1 is submitted in parallel.
+	 */
+	bdev_io1->internal.f.in_submit_request = true;
+	bdev_io2->internal.f.in_submit_request = true;
+	bdev_io3->internal.f.in_submit_request = true;
+
+	bdev_nvme_submit_request(ch, bdev_io1);
+	bdev_nvme_submit_request(ch, bdev_io2);
+	bdev_nvme_submit_request(ch, bdev_io3);
+
+	CU_ASSERT(nvme_qpair->qpair->num_outstanding_reqs == 2);
+	CU_ASSERT(bio1->zone_write_plugged == true);
+	CU_ASSERT(bio2->zone_write_plugged == false);
+	CU_ASSERT(bio3->zone_write_plugged == true);
+	CU_ASSERT(bio2 == TAILQ_FIRST(&bio1->zone_write_waiters));
+
+	/* The completion of the first write submits the second one. */
+	poll_threads();
+
+	CU_ASSERT(bdev_io1->internal.f.in_submit_request == false);
+	CU_ASSERT(bdev_io1->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(bdev_io2->internal.f.in_submit_request == false);
+	CU_ASSERT(bdev_io2->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(bdev_io3->internal.f.in_submit_request == false);
+	CU_ASSERT(bdev_io3->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(bio1->zone_write_plugged == false);
+	CU_ASSERT(bio2->zone_write_plugged == false);
+	CU_ASSERT(bio3->zone_write_plugged == false);
+	CU_ASSERT(TAILQ_EMPTY(&nbdev_ch->zone_write_list));
+	CU_ASSERT(nvme_qpair->qpair->num_outstanding_reqs == 0);
+
+	/* A waiting write can be aborted. */
+	bdev_io1->internal.f.in_submit_request = true;
+	bdev_io2->internal.f.in_submit_request = true;
+
+	bdev_nvme_submit_request(ch, bdev_io1);
+	bdev_nvme_submit_request(ch, bdev_io2);
+
+	CU_ASSERT(nvme_qpair->qpair->num_outstanding_reqs == 1);
+
+	rc = bdev_nvme_abort_zone_write(nbdev_ch, bio2);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(bdev_io2->internal.f.in_submit_request == false);
+	CU_ASSERT(bdev_io2->internal.status == SPDK_BDEV_IO_STATUS_ABORTED);
+	CU_ASSERT(TAILQ_EMPTY(&bio1->zone_write_waiters));
+
+	poll_threads();
+
+	CU_ASSERT(bdev_io1->internal.f.in_submit_request == false);
+	CU_ASSERT(bdev_io1->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(TAILQ_EMPTY(&nbdev_ch->zone_write_list));
+	CU_ASSERT(nvme_qpair->qpair->num_outstanding_reqs == 0);
+
+	free(bdev_io1);
+	free(bdev_io2);
+	free(bdev_io3);
+
+	spdk_put_io_channel(ch);
+
+	poll_threads();
+
+	rc = bdev_nvme_delete("nvme0", &g_any_path, NULL, NULL);
+	CU_ASSERT(rc == 0);
+
+	poll_threads();
+	spdk_delay_us(1000);
+	poll_threads();
+
+	CU_ASSERT(nvme_bdev_ctrlr_get_by_name("nvme0") == NULL);
+}
+
+static void
+ut_poll_threads_until_reset_waits(struct nvme_ctrlr_channel *ctrlr_ch)
+{
+	int i;
+
+	for (i = 0; i < 100 && ctrlr_ch->reset_iter == NULL; i++) {
+		poll_thread_times(0, 1);
+		poll_thread_times(1, 1);
+	}
+}
+
+static void
+test_reset_ctrlr_connect_qpairs_in_parallel(void)
+{
+	struct spdk_nvme_transport_id trid = {};
+	struct spdk_nvme_ctrlr ctrlr = {};
+	struct nvme_ctrlr *nvme_ctrlr;
+	struct spdk_io_channel *ch1, *ch2;
+	struct nvme_ctrlr_channel *ctrlr_ch1, *ctrlr_ch2;
+	int rc, op_rc;
+
+	ut_init_trid(&trid);
+	TAILQ_INIT(&ctrlr.active_io_qpairs);
+
+	set_thread(0);
+
+	rc = nvme_ctrlr_create(&ctrlr, "nvme0", &trid, NULL);
+	CU_ASSERT(rc == 0);
+
+	nvme_ctrlr = nvme_ctrlr_get_by_name("nvme0");
+	SPDK_CU_ASSERT_FATAL(nvme_ctrlr != NULL);
+
+	ch1 = spdk_get_io_channel(nvme_ctrlr);
+	SPDK_CU_ASSERT_FATAL(ch1 != NULL);
+
+	ctrlr_ch1 = spdk_io_channel_get_ctx(ch1);
+
+	set_thread(1);
+
+	ch2 = spdk_get_io_channel(nvme_ctrlr);
+	SPDK_CU_ASSERT_FATAL(ch2 != NULL);
+
+	ctrlr_ch2 = spdk_io_channel_get_ctx(ch2);
+
+	set_thread(0);
+
+	/* From now on, recreated qpairs stay connecting until the test completes them. */
+	ctrlr.connect_io_qpair_async = true;
+
+	/* Case 1: the qpairs of both ctrlr_channels are created before either of them is
+	 * connected, and the reset completes only after both of them are connected.
+	 */
+	rc = bdev_nvme_reset_ctrlr(nvme_ctrlr);
+	CU_ASSERT(rc == 0);
+
+	/* The connect pollers of connecting qpairs are always busy. Poll until the reset
+	 * waits for the first ctrlr_channel instead of polling until the threads are idle.
+	 */
+	ut_poll_threads_until_reset_waits(ctrlr_ch1);
+
+	CU_ASSERT(ctrlr_ch1->reset_iter != NULL);
+	CU_ASSERT(nvme_ctrlr->resetting == true);
+	SPDK_CU_ASSERT_FATAL(ctrlr_ch1->qpair->qpair != NULL);
+	SPDK_CU_ASSERT_FATAL(ctrlr_ch2->qpair->qpair != NULL);
+	CU_ASSERT(ctrlr_ch1->connect_poller != NULL);
+	CU_ASSERT(ctrlr_ch2->connect_poller != NULL);
+	CU_ASSERT(nvme_ctrlr->connecting_qpairs == 2);
+	/* A qpair that is still connecting is not used for I/O. */
+	CU_ASSERT(nvme_qpair_is_connected(ctrlr_ch1->qpair) == false);
+	CU_ASSERT(nvme_qpair_is_connected(ctrlr_ch2->qpair) == false);
+
+	/* Complete connecting the qpairs out of order. The reset still waits for
+	 * the first ctrlr_channel.
+	 */
+	ctrlr_ch2->qpair->qpair->is_connecting = false;
+
+	poll_thread_times(1, 1);
+	poll_thread_times(0, 1);
+
+	CU_ASSERT(ctrlr_ch2->connect_poller == NULL);
+	CU_ASSERT(nvme_ctrlr->connecting_qpairs == 1);
+	CU_ASSERT(nvme_ctrlr->resetting == true);
+
+	ctrlr_ch1->qpair->qpair->is_connecting = false;
+
+	poll_threads();
+
+	CU_ASSERT(ctrlr_ch1->connect_poller == NULL);
+	CU_ASSERT(nvme_ctrlr->connecting_qpairs == 0);
+	CU_ASSERT(nvme_ctrlr->resetting == false);
+	CU_ASSERT(nvme_qpair_is_connected(ctrlr_ch1->qpair) == true);
+	CU_ASSERT(nvme_qpair_is_connected(ctrlr_ch2->qpair) == true);
+
+	/* Case 2: the qpair the reset waits for fails to connect while the other one is
+	 * still connecting. The reset fails, and the qpair that is still connecting is
+	 * deleted too.
+	 */
+	op_rc = 0;
+
+	rc = bdev_nvme_reset_ctrlr(nvme_ctrlr);
+	CU_ASSERT(rc == 0);
+
+	nvme_ctrlr->ctrlr_op_cb_fn = ut_ctrlr_op_rpc_cb;
+	nvme_ctrlr->ctrlr_op_cb_arg = &op_rc;
+
+	ut_poll_threads_until_reset_waits(ctrlr_ch1);
+
+	CU_ASSERT(ctrlr_ch1->reset_iter != NULL);
+	SPDK_CU_ASSERT_FATAL(ctrlr_ch1->qpair->qpair != NULL);
+	SPDK_CU_ASSERT_FATAL(ctrlr_ch2->qpair->qpair != NULL);
+	CU_ASSERT(nvme_ctrlr->connecting_qpairs == 2);
+
+	ctrlr_ch1->qpair->qpair->failure_reason = SPDK_NVME_QPAIR_FAILURE_REMOTE;
+
+	poll_threads();
+
+	CU_ASSERT(nvme_ctrlr->resetting == false);
+	CU_ASSERT(op_rc == -1);
+	CU_ASSERT(ctrlr_ch1->connect_poller == NULL);
+	CU_ASSERT(ctrlr_ch2->connect_poller == NULL);
+	CU_ASSERT(ctrlr_ch1->qpair->qpair == NULL);
+	CU_ASSERT(ctrlr_ch2->qpair->qpair == NULL);
+
+	/* Case 3: a qpair the reset doesn't wait for yet fails to connect. The reset
+	 * finds it missing after the qpair it waits for is connected, and fails.
+	 */
+	op_rc = 0;
+
+	rc = bdev_nvme_reset_ctrlr(nvme_ctrlr);
+	CU_ASSERT(rc == 0);
+
+	nvme_ctrlr->ctrlr_op_cb_fn = ut_ctrlr_op_rpc_cb;
+	nvme_ctrlr->ctrlr_op_cb_arg = &op_rc;
+
+	ut_poll_threads_until_reset_waits(ctrlr_ch1);
+
+	CU_ASSERT(ctrlr_ch1->reset_iter != NULL);
+	SPDK_CU_ASSERT_FATAL(ctrlr_ch1->qpair->qpair != NULL);
+	SPDK_CU_ASSERT_FATAL(ctrlr_ch2->qpair->qpair != NULL);
+
+	ctrlr_ch2->qpair->qpair->failure_reason = SPDK_NVME_QPAIR_FAILURE_REMOTE;
+
+	poll_thread_times(1, 2);
+
+	CU_ASSERT(ctrlr_ch2->connect_poller == NULL);
+	CU_ASSERT(ctrlr_ch2->qpair->qpair == NULL);
+	CU_ASSERT(nvme_ctrlr->resetting == true);
+
+	ctrlr_ch1->qpair->qpair->is_connecting = false;
+
+	poll_threads();
+
+	CU_ASSERT(nvme_ctrlr->resetting == false);
+	CU_ASSERT(op_rc == -1);
+	CU_ASSERT(ctrlr_ch1->connect_poller == NULL);
+	CU_ASSERT(ctrlr_ch1->qpair->qpair == NULL);
+	CU_ASSERT(ctrlr_ch2->qpair->qpair == NULL);
+
+	ctrlr.connect_io_qpair_async = false;
+
+	spdk_put_io_channel(ch1);
+
+	set_thread(1);
+
+	spdk_put_io_channel(ch2);
+
+	poll_threads();
+
+	set_thread(0);
+
+	rc = bdev_nvme_delete("nvme0", &g_any_path, NULL, NULL);
+	CU_ASSERT(rc == 0);
+
+	poll_threads();
+	spdk_delay_us(1000);
+	poll_threads();
+
+	CU_ASSERT(nvme_ctrlr_get_by_name("nvme0") == NULL);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -8196,6 +8859,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_retry_io_if_ana_state_is_updating);
 	CU_ADD_TEST(suite, test_retry_io_for_io_path_error);
 	CU_ADD_TEST(suite, test_retry_io_count);
+	CU_ADD_TEST(suite, test_io_qpair_idle_timeout);
+	CU_ADD_TEST(suite, test_multipath_stripe_size);
 	CU_ADD_TEST(suite, test_concurrent_read_ana_log_page);
 	CU_ADD_TEST(suite, test_retry_io_for_ana_error);
 	CU_ADD_TEST(suite, test_check_io_error_resiliency_params);
@@ -8208,6 +8873,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_set_preferred_path);
 	CU_ADD_TEST(suite, test_find_next_io_path);
 	CU_ADD_TEST(suite, test_find_io_path_min_qd);
+	CU_ADD_TEST(suite, test_find_io_path_min_latency);
+	CU_ADD_TEST(suite, test_find_io_path_numa_local);
 	CU_ADD_TEST(suite, test_disable_auto_failback);
 	CU_ADD_TEST(suite, test_set_multipath_policy);
 	CU_ADD_TEST(suite, test_uuid_generation);
@@ -8221,6 +8888,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_io_path_is_current);
 	CU_ADD_TEST(suite, test_bdev_reset_abort_io);
 	CU_ADD_TEST(suite, test_race_between_clear_pending_resets_and_reset_ctrlr_complete);
+	CU_ADD_TEST(suite, test_zone_write_plugging);
+	CU_ADD_TEST(suite, test_reset_ctrlr_connect_qpairs_in_parallel);
 
 	allocate_threads(3);
 	set_thread(0);
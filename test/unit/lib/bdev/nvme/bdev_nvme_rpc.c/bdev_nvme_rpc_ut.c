@@ -0,0 +1,445 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/test_env.c"
+#include "bdev/nvme/bdev_nvme_rpc.c"
+
+DEFINE_STUB_V(spdk_rpc_register_method, (const char *method, spdk_rpc_method_handler func,
+		uint32_t state_mask));
+DEFINE_STUB(spdk_jsonrpc_begin_result, struct spdk_json_write_ctx *,
+	    (struct spdk_jsonrpc_request *request), NULL);
+DEFINE_STUB_V(spdk_jsonrpc_end_result, (struct spdk_jsonrpc_request *request,
+					struct spdk_json_write_ctx *w));
+
+DEFINE_STUB(bdev_nvme_delete, int, (const char *name, const struct nvme_path_id *path_id,
+				    bdev_nvme_delete_done_fn delete_done, void *delete_done_ctx),
+	    0);
+DEFINE_STUB(bdev_nvme_get_ctrlr, struct spdk_nvme_ctrlr *, (struct spdk_bdev *bdev), NULL);
+DEFINE_STUB_V(bdev_nvme_get_discovery_info, (struct spdk_json_write_ctx *w));
+DEFINE_STUB_V(bdev_nvme_get_mdns_discovery_info, (struct spdk_jsonrpc_request *request));
+DEFINE_STUB(bdev_nvme_set_hotplug, int, (bool enabled, uint64_t period_us, spdk_msg_fn cb,
+		void *cb_ctx), 0);
+DEFINE_STUB(bdev_nvme_set_keys, int, (const char *name, const char *dhchap_key,
+				      const char *dhchap_ctrlr_key, bdev_nvme_set_keys_cb cb_fn,
+				      void *cb_ctx), 0);
+DEFINE_STUB_V(bdev_nvme_set_preferred_path, (const char *name, uint16_t cntlid,
+		bdev_nvme_set_preferred_path_cb cb_fn, void *cb_arg));
+DEFINE_STUB(bdev_nvme_start_discovery, int, (struct spdk_nvme_transport_id *trid,
+		const char *base_name, struct spdk_nvme_ctrlr_opts *drv_opts,
+		struct spdk_bdev_nvme_ctrlr_opts *bdev_opts, uint64_t timeout, bool from_mdns,
+		spdk_bdev_nvme_start_discovery_fn cb_fn, void *cb_ctx), 0);
+DEFINE_STUB(bdev_nvme_start_mdns_discovery, int, (const char *base_name, const char *svcname,
+		struct spdk_nvme_ctrlr_opts *drv_opts,
+		struct spdk_bdev_nvme_ctrlr_opts *bdev_opts), 0);
+DEFINE_STUB(bdev_nvme_stop_discovery, int, (const char *name,
+		spdk_bdev_nvme_stop_discovery_fn cb_fn, void *cb_ctx), 0);
+DEFINE_STUB(bdev_nvme_stop_mdns_discovery, int, (const char *name), 0);
+DEFINE_STUB_V(nvme_bdev_ctrlr_for_each, (nvme_bdev_ctrlr_for_each_fn fn, void *ctx));
+DEFINE_STUB(nvme_bdev_ctrlr_get_by_name, struct nvme_bdev_ctrlr *, (const char *name), NULL);
+DEFINE_STUB(nvme_bdev_ctrlr_get_ctrlr_by_id, struct nvme_ctrlr *,
+	    (struct nvme_bdev_ctrlr *nbdev_ctrlr, uint16_t cntlid), NULL);
+DEFINE_STUB_V(nvme_bdev_ctrlr_op_rpc, (struct nvme_bdev_ctrlr *nbdev_ctrlr, enum nvme_ctrlr_op op,
+				       bdev_nvme_ctrlr_op_cb cb_fn, void *cb_arg));
+DEFINE_STUB_V(nvme_bdev_dump_trid_json, (const struct spdk_nvme_transport_id *trid,
+		struct spdk_json_write_ctx *w));
+DEFINE_STUB_V(nvme_bdev_for_each_channel, (struct nvme_bdev *nbdev,
+		nvme_bdev_for_each_channel_msg fn, void *ctx, nvme_bdev_for_each_channel_done cpl));
+DEFINE_STUB_V(nvme_bdev_for_each_channel_continue, (struct nvme_bdev_channel_iter *iter,
+		int status));
+DEFINE_STUB_V(nvme_ctrlr_for_each_channel, (struct nvme_ctrlr *nvme_ctrlr,
+		nvme_ctrlr_for_each_channel_msg fn, void *ctx,
+		nvme_ctrlr_for_each_channel_done cpl));
+DEFINE_STUB_V(nvme_ctrlr_for_each_channel_continue, (struct nvme_ctrlr_channel_iter *iter,
+		int status));
+DEFINE_STUB(nvme_ctrlr_get_by_name, struct nvme_ctrlr *, (const char *name), NULL);
+DEFINE_STUB_V(nvme_ctrlr_info_json, (struct spdk_json_write_ctx *w, struct nvme_ctrlr *nvme_ctrlr));
+DEFINE_STUB_V(nvme_ctrlr_op_rpc, (struct nvme_ctrlr *nvme_ctrlr, enum nvme_ctrlr_op op,
+				  bdev_nvme_ctrlr_op_cb cb_fn, void *cb_arg));
+DEFINE_STUB_V(nvme_io_path_info_json, (struct spdk_json_write_ctx *w,
+				       struct nvme_io_path *io_path));
+DEFINE_STUB(spdk_bdev_nvme_admin_passthru, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, const struct spdk_nvme_cmd *cmd, void *buf,
+		size_t nbytes, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB_V(spdk_bdev_nvme_get_opts, (struct spdk_bdev_nvme_opts *opts, size_t opts_size));
+DEFINE_STUB_V(spdk_bdev_nvme_set_multipath_policy, (const char *name,
+		enum spdk_bdev_nvme_multipath_policy policy,
+		enum spdk_bdev_nvme_multipath_selector selector, uint32_t rr_min_io,
+		spdk_bdev_nvme_set_multipath_policy_cb cb_fn, void *cb_arg));
+DEFINE_STUB(spdk_bdev_nvme_set_opts, int, (const struct spdk_bdev_nvme_opts *opts), 0);
+
+DEFINE_STUB_V(spdk_bdev_add_io_stat, (struct spdk_bdev_io_stat *total,
+				      struct spdk_bdev_io_stat *add));
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB_V(spdk_bdev_dump_io_stat_json, (struct spdk_bdev_io_stat *stat,
+		struct spdk_json_write_ctx *w));
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB(spdk_bdev_get_io_channel, struct spdk_io_channel *, (struct spdk_bdev_desc *desc),
+	    NULL);
+DEFINE_STUB(spdk_bdev_open_ext, int, (const char *bdev_name, bool write,
+				      spdk_bdev_event_cb_t event_cb, void *event_ctx,
+				      struct spdk_bdev_desc **desc), -ENODEV);
+
+DEFINE_STUB(spdk_nvme_ctrlr_cmd_admin_raw, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_cmd *cmd, void *buf, uint32_t len, spdk_nvme_cmd_cb cb_fn,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_cmd_get_log_page, int, (struct spdk_nvme_ctrlr *ctrlr,
+		uint8_t log_page, uint32_t nsid, void *payload, uint32_t payload_size,
+		uint64_t offset, spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_get_data, const struct spdk_nvme_ctrlr_data *,
+	    (struct spdk_nvme_ctrlr *ctrlr), NULL);
+DEFINE_STUB(spdk_nvme_ctrlr_get_opts, const struct spdk_nvme_ctrlr_opts *,
+	    (struct spdk_nvme_ctrlr *ctrlr), NULL);
+DEFINE_STUB(spdk_nvme_ctrlr_get_transport_id, const struct spdk_nvme_transport_id *,
+	    (struct spdk_nvme_ctrlr *ctrlr), NULL);
+DEFINE_STUB(spdk_nvme_ctrlr_reset, int, (struct spdk_nvme_ctrlr *ctrlr), 0);
+DEFINE_STUB(spdk_nvme_dhchap_get_dhgroup_id, int, (const char *name), 0);
+DEFINE_STUB(spdk_nvme_dhchap_get_digest_id, int, (const char *name), 0);
+DEFINE_STUB_V(spdk_nvme_poll_group_free_stats, (struct spdk_nvme_poll_group *group,
+		struct spdk_nvme_poll_group_stat *stat));
+DEFINE_STUB(spdk_nvme_poll_group_get_stats, int, (struct spdk_nvme_poll_group *group,
+		struct spdk_nvme_poll_group_stat **stats), 0);
+DEFINE_STUB(spdk_nvme_qpair_add_cmd_error_injection, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_qpair *qpair, uint8_t opc, bool do_not_submit,
+		uint64_t timeout_in_us, uint32_t err_count, uint8_t sct, uint8_t sc), 0);
+DEFINE_STUB_V(spdk_nvme_qpair_remove_cmd_error_injection, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_qpair *qpair, uint8_t opc));
+DEFINE_STUB(spdk_nvme_transport_id_parse_adrfam, int, (enum spdk_nvmf_adrfam *adrfam,
+		const char *str), 0);
+DEFINE_STUB(spdk_nvme_transport_id_trtype_str, const char *,
+	    (enum spdk_nvme_transport_type trtype), NULL);
+
+struct nvme_bdev_ctrlrs g_nvme_bdev_ctrlrs = TAILQ_HEAD_INITIALIZER(g_nvme_bdev_ctrlrs);
+
+#define UT_MAX_ATTACHES	4
+#define UT_MAX_EXAMINES	4
+
+/* The spdk_jsonrpc_request of the tests records the response sent to it. */
+struct spdk_jsonrpc_request {
+	int	num_responses;
+	bool	result;
+	int	error_code;
+};
+
+struct ut_attach {
+	char				name[32];
+	spdk_bdev_nvme_create_cb	cb_fn;
+	void				*cb_ctx;
+};
+
+static struct ut_attach g_attaches[UT_MAX_ATTACHES];
+static int g_num_attaches;
+static int g_create_rc;
+
+static spdk_bdev_wait_for_examine_cb g_examine_cb[UT_MAX_EXAMINES];
+static void *g_examine_arg[UT_MAX_EXAMINES];
+static int g_num_examines;
+
+void
+spdk_jsonrpc_send_bool_response(struct spdk_jsonrpc_request *request, bool value)
+{
+	request->num_responses++;
+	request->result = value;
+}
+
+void
+spdk_jsonrpc_send_error_response(struct spdk_jsonrpc_request *request, int error_code,
+				 const char *msg)
+{
+	request->num_responses++;
+	request->error_code = error_code;
+}
+
+void
+spdk_jsonrpc_send_error_response_fmt(struct spdk_jsonrpc_request *request, int error_code,
+				     const char *fmt, ...)
+{
+	request->num_responses++;
+	request->error_code = error_code;
+}
+
+void
+spdk_nvme_ctrlr_get_default_ctrlr_opts(struct spdk_nvme_ctrlr_opts *opts, size_t opts_size)
+{
+	memset(opts, 0, opts_size);
+	opts->num_io_queues = 1;
+}
+
+void
+spdk_bdev_nvme_get_default_ctrlr_opts(struct spdk_bdev_nvme_ctrlr_opts *opts)
+{
+	memset(opts, 0, sizeof(*opts));
+}
+
+int
+spdk_nvme_transport_id_populate_trstring(struct spdk_nvme_transport_id *trid,
+		const char *trstring)
+{
+	snprintf(trid->trstring, sizeof(trid->trstring), "%s", trstring);
+	return 0;
+}
+
+int
+spdk_nvme_transport_id_parse_trtype(enum spdk_nvme_transport_type *trtype, const char *str)
+{
+	*trtype = SPDK_NVME_TRANSPORT_TCP;
+	return 0;
+}
+
+int
+spdk_bdev_nvme_create(struct spdk_nvme_transport_id *trid, const char *base_name,
+		      const char **names, uint32_t count, spdk_bdev_nvme_create_cb cb_fn,
+		      void *cb_ctx, struct spdk_nvme_ctrlr_opts *drv_opts,
+		      struct spdk_bdev_nvme_ctrlr_opts *bdev_opts)
+{
+	struct ut_attach *attach;
+
+	if (g_create_rc != 0) {
+		return g_create_rc;
+	}
+
+	SPDK_CU_ASSERT_FATAL(g_num_attaches < UT_MAX_ATTACHES);
+	attach = &g_attaches[g_num_attaches++];
+	snprintf(attach->name, sizeof(attach->name), "%s", base_name);
+	attach->cb_fn = cb_fn;
+	attach->cb_ctx = cb_ctx;
+
+	return 0;
+}
+
+int
+spdk_bdev_wait_for_examine(spdk_bdev_wait_for_examine_cb cb_fn, void *cb_arg)
+{
+	SPDK_CU_ASSERT_FATAL(g_num_examines < UT_MAX_EXAMINES);
+	g_examine_cb[g_num_examines] = cb_fn;
+	g_examine_arg[g_num_examines] = cb_arg;
+	g_num_examines++;
+
+	return 0;
+}
+
+static void
+ut_complete_examines(void)
+{
+	int i, num_examines = g_num_examines;
+
+	g_num_examines = 0;
+	for (i = 0; i < num_examines; i++) {
+		g_examine_cb[i](g_examine_arg[i]);
+	}
+}
+
+static void
+ut_complete_attach(const char *name, int rc)
+{
+	int i;
+
+	for (i = 0; i < g_num_attaches; i++) {
+		if (g_attaches[i].cb_fn != NULL && strcmp(g_attaches[i].name, name) == 0) {
+			g_attaches[i].cb_fn(g_attaches[i].cb_ctx, rc == 0 ? 1 : 0, rc);
+			g_attaches[i].cb_fn = NULL;
+			return;
+		}
+	}
+
+	CU_FAIL("no outstanding attach");
+}
+
+static void
+ut_attach_controller(struct spdk_jsonrpc_request *request, const char *name,
+		     bool wait_for_attach)
+{
+	struct spdk_json_val values[32];
+	char params[256];
+	ssize_t rc;
+
+	snprintf(params, sizeof(params),
+		 "{\"name\": \"%s\", \"trtype\": \"tcp\", \"traddr\": \"127.0.0.1\", "
+		 "\"trsvcid\": \"4420\", \"subnqn\": \"nqn.2016-06.io.spdk:%s\", "
+		 "\"wait_for_attach\": %s}", name, name, wait_for_attach ? "true" : "false");
+
+	rc = spdk_json_parse(params, strlen(params), values, SPDK_COUNTOF(values), NULL,
+			     SPDK_JSON_PARSE_FLAG_DECODE_IN_PLACE);
+	SPDK_CU_ASSERT_FATAL(rc > 0);
+
+	memset(request, 0, sizeof(*request));
+	rpc_bdev_nvme_attach_controller(request, values);
+}
+
+static void
+ut_wait_for_attach(struct spdk_jsonrpc_request *request)
+{
+	memset(request, 0, sizeof(*request));
+	rpc_bdev_nvme_wait_for_attach(request, NULL);
+}
+
+static void
+ut_reset(void)
+{
+	memset(g_attaches, 0, sizeof(g_attaches));
+	g_num_attaches = 0;
+	g_num_examines = 0;
+	g_create_rc = 0;
+}
+
+static void
+test_attach_without_waiting(void)
+{
+	struct spdk_jsonrpc_request attach0, attach0_dup, attach1, wait;
+
+	ut_reset();
+
+	/* The RPC responds as soon as the attach has started. */
+	ut_attach_controller(&attach0, "nvme0", false);
+	CU_ASSERT(attach0.num_responses == 1);
+	CU_ASSERT(attach0.result == true);
+	CU_ASSERT(g_num_attaches == 1);
+
+	/* Another path can't be added while the first one is being attached. */
+	ut_attach_controller(&attach0_dup, "nvme0", false);
+	CU_ASSERT(attach0_dup.num_responses == 1);
+	CU_ASSERT(attach0_dup.error_code == -EBUSY);
+	CU_ASSERT(g_num_attaches == 1);
+
+	ut_attach_controller(&attach1, "nvme1", false);
+	CU_ASSERT(attach1.num_responses == 1);
+	CU_ASSERT(attach1.result == true);
+	CU_ASSERT(g_num_attaches == 2);
+
+	/* bdev_nvme_wait_for_attach completes only after all attaches are done and
+	 * their bdevs are examined.
+	 */
+	ut_wait_for_attach(&wait);
+	CU_ASSERT(wait.num_responses == 0);
+
+	ut_complete_attach("nvme1", 0);
+	CU_ASSERT(wait.num_responses == 0);
+	CU_ASSERT(g_num_examines == 0);
+
+	ut_complete_attach("nvme0", 0);
+	CU_ASSERT(wait.num_responses == 0);
+	CU_ASSERT(g_num_examines == 1);
+
+	ut_complete_examines();
+	CU_ASSERT(wait.num_responses == 1);
+	CU_ASSERT(wait.result == true);
+	CU_ASSERT(wait.error_code == 0);
+
+	/* The name can be used again once the attach is done. */
+	ut_attach_controller(&attach0_dup, "nvme0", false);
+	CU_ASSERT(attach0_dup.num_responses == 1);
+	CU_ASSERT(attach0_dup.result == true);
+
+	ut_complete_attach("nvme0", 0);
+	CU_ASSERT(TAILQ_EMPTY(&g_rpc_attach_pending));
+}
+
+static void
+test_wait_for_attach_failure(void)
+{
+	struct spdk_jsonrpc_request attach0, attach1, wait1, wait2;
+
+	ut_reset();
+
+	ut_attach_controller(&attach0, "nvme0", false);
+	ut_attach_controller(&attach1, "nvme1", false);
+	CU_ASSERT(g_num_attaches == 2);
+
+	/* Two requests wait for the same attaches. Both of them report the failure. */
+	ut_wait_for_attach(&wait1);
+	ut_wait_for_attach(&wait2);
+
+	ut_complete_attach("nvme0", -EIO);
+	ut_complete_attach("nvme1", 0);
+	CU_ASSERT(g_num_examines == 2);
+
+	ut_complete_examines();
+	CU_ASSERT(wait1.num_responses == 1);
+	CU_ASSERT(wait1.error_code == -ENXIO);
+	CU_ASSERT(wait2.num_responses == 1);
+	CU_ASSERT(wait2.error_code == -ENXIO);
+
+	/* Failures are reported only once. With nothing pending, the request completes
+	 * after the bdevs are examined.
+	 */
+	ut_wait_for_attach(&wait1);
+	CU_ASSERT(wait1.num_responses == 0);
+	CU_ASSERT(g_num_examines == 1);
+
+	ut_complete_examines();
+	CU_ASSERT(wait1.num_responses == 1);
+	CU_ASSERT(wait1.result == true);
+	CU_ASSERT(wait1.error_code == 0);
+}
+
+static void
+test_attach_without_waiting_create_failure(void)
+{
+	struct spdk_jsonrpc_request attach0, wait;
+
+	ut_reset();
+
+	/* If the attach can't be started, the RPC fails and nothing is left pending. */
+	g_create_rc = -ENOMEM;
+
+	ut_attach_controller(&attach0, "nvme0", false);
+	CU_ASSERT(attach0.num_responses == 1);
+	CU_ASSERT(attach0.error_code == -ENOMEM);
+	CU_ASSERT(TAILQ_EMPTY(&g_rpc_attach_pending));
+
+	g_create_rc = 0;
+
+	ut_wait_for_attach(&wait);
+	ut_complete_examines();
+	CU_ASSERT(wait.num_responses == 1);
+	CU_ASSERT(wait.result == true);
+
+	/* The name isn't reserved by the failed attach. */
+	ut_attach_controller(&attach0, "nvme0", false);
+	CU_ASSERT(attach0.num_responses == 1);
+	CU_ASSERT(attach0.result == true);
+
+	ut_complete_attach("nvme0", 0);
+	CU_ASSERT(TAILQ_EMPTY(&g_rpc_attach_pending));
+}
+
+static void
+test_wait_for_attach_params(void)
+{
+	struct spdk_jsonrpc_request wait = {};
+	struct spdk_json_val params = { .type = SPDK_JSON_VAL_OBJECT_BEGIN };
+
+	ut_reset();
+
+	rpc_bdev_nvme_wait_for_attach(&wait, &params);
+	CU_ASSERT(wait.num_responses == 1);
+	CU_ASSERT(wait.error_code == SPDK_JSONRPC_ERROR_INVALID_PARAMS);
+	CU_ASSERT(TAILQ_EMPTY(&g_rpc_attach_waiters));
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("bdev_nvme_rpc", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_attach_without_waiting);
+	CU_ADD_TEST(suite, test_wait_for_attach_failure);
+	CU_ADD_TEST(suite, test_attach_without_waiting_create_failure);
+	CU_ADD_TEST(suite, test_wait_for_attach_params);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
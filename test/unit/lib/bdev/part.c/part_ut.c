@@ -18,6 +18,11 @@
 
 #include "common/lib/bdev/common_stubs.h"
 
+DEFINE_STUB(spdk_memory_domain_translate_data, int,
+	    (struct spdk_memory_domain *src_domain, void *src_domain_ctx,
+	     struct spdk_memory_domain *dst_domain, struct spdk_memory_domain_translation_ctx *dst_domain_ctx,
+	     void *addr, size_t len, struct spdk_memory_domain_translation_result *result), -ENOTSUP);
+
 struct ut_expected_io {
 };
 
@@ -196,14 +201,37 @@ __io_type_supported(void *ctx, enum spdk_bdev_io_type type)
 	return true;
 }
 
+static void
+base_submit_request(struct spdk_io_channel *_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct bdev_ut_channel *ch = spdk_io_channel_get_ctx(_ch);
+
+	TAILQ_INSERT_TAIL(&ch->outstanding_io, bdev_io, internal.link);
+	ch->outstanding_io_count++;
+}
+
+static void
+part_submit_request(struct spdk_io_channel *_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev_part_channel *ch = spdk_io_channel_get_ctx(_ch);
+	int rc;
+
+	rc = spdk_bdev_part_submit_request(ch, bdev_io);
+	if (rc != 0) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
 static struct spdk_bdev_fn_table base_fn_table = {
 	.destruct		= __destruct,
 	.get_io_channel = part_ut_get_io_channel,
 	.io_type_supported	= __io_type_supported,
+	.submit_request		= base_submit_request,
 };
 static struct spdk_bdev_fn_table part_fn_table = {
 	.destruct		= __destruct,
 	.io_type_supported	= __io_type_supported,
+	.submit_request		= part_submit_request,
 };
 
 static void
@@ -429,6 +457,135 @@ part_construct_ext(void)
 	poll_threads();
 }
 
+struct part_ut_io_status {
+	bool		done;
+	bool		success;
+	struct spdk_bdev *bdev;
+	uint64_t	offset_blocks;
+};
+
+static void
+part_ut_io_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct part_ut_io_status *status = cb_arg;
+
+	status->done = true;
+	status->success = success;
+	status->bdev = bdev_io->bdev;
+	status->offset_blocks = bdev_io->u.bdev.offset_blocks;
+	spdk_bdev_free_io(bdev_io);
+}
+
+static void
+part_redirect_io(void)
+{
+	struct spdk_bdev_part_base	*base = NULL;
+	struct spdk_bdev_desc		*desc = NULL;
+	struct spdk_io_channel		*io_ch;
+	struct spdk_bdev_part		*part;
+	struct spdk_bdev		bdev_base = {};
+	struct spdk_bdev_io		*bdev_io;
+	struct spdk_bdev_part_construct_opts opts;
+	struct part_ut_io_status	status = {};
+	SPDK_BDEV_PART_TAILQ		tailq = TAILQ_HEAD_INITIALIZER(tailq);
+	char				buf[4 * 512];
+	int rc;
+
+	ut_init_bdev();
+	bdev_base.name = "base";
+	bdev_base.blocklen = 512;
+	bdev_base.blockcnt = 1024;
+	bdev_base.fn_table = &base_fn_table;
+	bdev_base.module = &bdev_ut_if;
+	rc = spdk_bdev_register(&bdev_base);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_bdev_part_base_construct_ext("base", NULL, &vbdev_ut_if,
+					       &part_fn_table, &tailq, NULL,
+					       NULL, sizeof(struct spdk_bdev_part_channel),
+					       NULL, NULL, &base);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(base != NULL);
+
+	part = calloc(1, sizeof(*part));
+	SPDK_CU_ASSERT_FATAL(part != NULL);
+	spdk_bdev_part_construct_opts_init(&opts, sizeof(opts));
+	opts.redirect_io = true;
+	rc = spdk_bdev_part_construct_ext(part, base, "test", 100, 100, "test", &opts);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+
+	rc = spdk_bdev_open_ext("test", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+	SPDK_CU_ASSERT_FATAL(g_bdev_ut_channel != NULL);
+
+	/* The base bdev gets the I/O of the part bdev, remapped to its offset */
+	rc = spdk_bdev_read_blocks(desc, io_ch, buf, 10, 4, part_ut_io_done, &status);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_bdev_ut_channel->outstanding_io_count == 1);
+	bdev_io = TAILQ_FIRST(&g_bdev_ut_channel->outstanding_io);
+	CU_ASSERT(bdev_io->bdev == &bdev_base);
+	CU_ASSERT(bdev_io->u.bdev.offset_blocks == 110);
+	CU_ASSERT(bdev_io->u.bdev.num_blocks == 4);
+	CU_ASSERT(bdev_io->internal.caller_ctx == &status);
+
+	/* It's completed on the part bdev, as it was submitted */
+	TAILQ_REMOVE(&g_bdev_ut_channel->outstanding_io, bdev_io, internal.link);
+	g_bdev_ut_channel->outstanding_io_count--;
+	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+	poll_threads();
+	CU_ASSERT(status.done == true);
+	CU_ASSERT(status.success == true);
+	CU_ASSERT(status.bdev == &part->internal.bdev);
+	CU_ASSERT(status.offset_blocks == 10);
+
+	/* Errors are reported to the part bdev's user */
+	memset(&status, 0, sizeof(status));
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf, 96, 4, part_ut_io_done, &status);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_bdev_ut_channel->outstanding_io_count == 1);
+	bdev_io = TAILQ_FIRST(&g_bdev_ut_channel->outstanding_io);
+	CU_ASSERT(bdev_io->u.bdev.offset_blocks == 196);
+	TAILQ_REMOVE(&g_bdev_ut_channel->outstanding_io, bdev_io, internal.link);
+	g_bdev_ut_channel->outstanding_io_count--;
+	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	poll_threads();
+	CU_ASSERT(status.done == true);
+	CU_ASSERT(status.success == false);
+	CU_ASSERT(status.bdev == &part->internal.bdev);
+	CU_ASSERT(status.offset_blocks == 96);
+
+	/* Other I/O types are still submitted to the base bdev as new I/Os */
+	memset(&status, 0, sizeof(status));
+	rc = spdk_bdev_comparev_blocks(desc, io_ch, &(struct iovec) { .iov_base = buf, .iov_len = 512 },
+				       1, 0, 1, part_ut_io_done, &status);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_bdev_ut_channel->outstanding_io_count == 1);
+	bdev_io = TAILQ_FIRST(&g_bdev_ut_channel->outstanding_io);
+	CU_ASSERT(bdev_io->internal.caller_ctx != &status);
+	CU_ASSERT(bdev_io->u.bdev.offset_blocks == 100);
+	TAILQ_REMOVE(&g_bdev_ut_channel->outstanding_io, bdev_io, internal.link);
+	g_bdev_ut_channel->outstanding_io_count--;
+	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+	poll_threads();
+	CU_ASSERT(status.done == true);
+	CU_ASSERT(status.success == true);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	spdk_bdev_unregister(&part->internal.bdev, NULL, NULL);
+	poll_threads();
+
+	rc = spdk_bdev_part_free(part);
+	CU_ASSERT(rc == 1);
+	poll_threads();
+
+	spdk_bdev_unregister(&bdev_base, NULL, NULL);
+	ut_fini_bdev();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -443,6 +600,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, part_free_test);
 	CU_ADD_TEST(suite, part_get_io_channel_test);
 	CU_ADD_TEST(suite, part_construct_ext);
+	CU_ADD_TEST(suite, part_redirect_io);
 
 	allocate_cores(1);
 	allocate_threads(1);
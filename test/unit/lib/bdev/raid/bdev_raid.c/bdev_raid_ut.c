@@ -182,6 +182,7 @@ DEFINE_STUB(spdk_bdev_get_dif_type, enum spdk_dif_type, (const struct spdk_bdev
 	    SPDK_DIF_DISABLE);
 DEFINE_STUB(spdk_bdev_is_dif_head_of_md, bool, (const struct spdk_bdev *bdev), false);
 DEFINE_STUB(spdk_bdev_notify_blockcnt_change, int, (struct spdk_bdev *bdev, uint64_t size), 0);
+DEFINE_STUB(spdk_bdev_io_get_submit_tsc, uint64_t, (struct spdk_bdev_io *bdev_io), 0);
 DEFINE_STUB(spdk_json_write_named_uuid, int, (struct spdk_json_write_ctx *w, const char *name,
 		const struct spdk_uuid *val), 0);
 DEFINE_STUB_V(raid_bdev_init_superblock, (struct raid_bdev *raid_bdev));
@@ -1451,6 +1452,7 @@ test_raid_process_with_qos(void)
 	pbdev->module_private = &num_blocks_processed;
 	pbdev->min_base_bdevs_operational = 0;
 
+	raid_bdev_get_opts(&opts);
 	opts.process_window_size_kb = 1024;
 	opts.process_max_bandwidth_mb_sec = 1;
 	CU_ASSERT(raid_bdev_set_opts(&opts) == 0);
@@ -1488,6 +1490,268 @@ test_raid_process_with_qos(void)
 	reset_globals();
 }
 
+static struct raid_bdev *
+create_raid_with_write_intent(uint32_t region_size_kb)
+{
+	struct rpc_bdev_raid_create req;
+	struct spdk_raid_bdev_opts opts;
+	struct raid_bdev *pbdev;
+	struct spdk_bdev *base_bdev;
+
+	raid_bdev_get_opts(&opts);
+	opts.process_window_size_kb = 1024;
+	opts.process_max_bandwidth_mb_sec = 0;
+	opts.write_intent_region_size_kb = region_size_kb;
+	CU_ASSERT(raid_bdev_set_opts(&opts) == 0);
+
+	create_raid_bdev_create_req(&req, "raid1", 0, true, 0, false);
+	verify_raid_bdev_present("raid1", false);
+	TAILQ_FOREACH(base_bdev, &g_bdev_list, internal.link) {
+		base_bdev->blockcnt = 128;
+	}
+	rpc_bdev_raid_create(NULL, NULL);
+	CU_ASSERT(g_rpc_err == 0);
+	verify_raid_bdev(&req, true, RAID_BDEV_STATE_ONLINE);
+	free_test_req(&req);
+
+	TAILQ_FOREACH(pbdev, &g_raid_bdev_list, global_link) {
+		if (strcmp(pbdev->bdev.name, "raid1") == 0) {
+			break;
+		}
+	}
+	SPDK_CU_ASSERT_FATAL(pbdev != NULL);
+
+	/* The bitmap is only kept for redundant raid bdevs with a superblock */
+	CU_ASSERT(pbdev->write_intent == NULL);
+	pbdev->superblock_enabled = true;
+	pbdev->min_base_bdevs_operational = 0;
+	raid_bdev_write_intent_alloc(pbdev);
+	pbdev->superblock_enabled = false;
+	SPDK_CU_ASSERT_FATAL(pbdev->write_intent != NULL);
+
+	return pbdev;
+}
+
+static void
+delete_raid_with_write_intent(void)
+{
+	struct rpc_bdev_raid_delete destroy_req;
+	struct spdk_raid_bdev_opts opts;
+
+	create_raid_bdev_delete_req(&destroy_req, "raid1", 0);
+	rpc_bdev_raid_delete(NULL, NULL);
+	CU_ASSERT(g_rpc_err == 0);
+	verify_raid_bdev_present("raid1", false);
+
+	raid_bdev_get_opts(&opts);
+	opts.write_intent_region_size_kb = 0;
+	CU_ASSERT(raid_bdev_set_opts(&opts) == 0);
+}
+
+static uint64_t
+run_raid_rebuild(struct raid_bdev *pbdev, bool *resync_dirty_only)
+{
+	uint64_t num_blocks_processed = 0;
+	struct spdk_thread *process_thread;
+
+	pbdev->module_private = &num_blocks_processed;
+
+	CU_ASSERT(raid_bdev_start_rebuild(&pbdev->base_bdev_info[0]) == 0);
+	poll_app_thread();
+
+	SPDK_CU_ASSERT_FATAL(pbdev->process != NULL);
+	*resync_dirty_only = pbdev->process->resync_dirty_only;
+
+	process_thread = g_latest_thread;
+	while (spdk_thread_poll(process_thread, 0, 0) > 0) {
+		poll_app_thread();
+	}
+	poll_app_thread();
+
+	CU_ASSERT(pbdev->process == NULL);
+	pbdev->module_private = NULL;
+
+	return num_blocks_processed;
+}
+
+static void
+test_raid_write_intent_rebuild(void)
+{
+	struct raid_bdev *pbdev;
+	struct raid_bdev_write_intent *wi;
+	struct raid_base_bdev_info *base_info;
+	uint64_t region_blocks;
+	bool resync_dirty_only;
+
+	set_globals();
+	CU_ASSERT(raid_bdev_init() == 0);
+
+	pbdev = create_raid_with_write_intent(4 * g_block_len / 1024);
+	wi = pbdev->write_intent;
+	base_info = &pbdev->base_bdev_info[0];
+	region_blocks = 1ULL << wi->region_shift;
+	CU_ASSERT(region_blocks == 4);
+	CU_ASSERT(wi->num_regions == spdk_divide_round_up(pbdev->bdev.blockcnt, region_blocks));
+
+	/* Dirty regions 0, 5 and 6 */
+	raid_bdev_write_intent_start(pbdev, 1, 1);
+	raid_bdev_write_intent_start(pbdev, 5 * region_blocks + 1, region_blocks);
+	CU_ASSERT(wi->dirty[0] == ((1ULL << 0) | (1ULL << 5) | (1ULL << 6)));
+	CU_ASSERT(wi->writes_outstanding[0] == 1);
+	CU_ASSERT(wi->writes_outstanding[5] == 1);
+	CU_ASSERT(wi->writes_outstanding[6] == 1);
+	raid_bdev_write_intent_end(pbdev, 1, 1);
+	raid_bdev_write_intent_end(pbdev, 5 * region_blocks + 1, region_blocks);
+	CU_ASSERT(wi->writes_outstanding[5] == 0);
+
+	CU_ASSERT(raid_bdev_write_intent_next_dirty(pbdev, 0) == 0);
+	CU_ASSERT(raid_bdev_write_intent_next_dirty(pbdev, 2) == 2);
+	CU_ASSERT(raid_bdev_write_intent_next_dirty(pbdev, region_blocks) == 5 * region_blocks);
+	CU_ASSERT(raid_bdev_write_intent_next_dirty(pbdev, 7 * region_blocks) == pbdev->bdev.blockcnt);
+
+	/* A base bdev that wasn't removed is fully rebuilt */
+	CU_ASSERT(run_raid_rebuild(pbdev, &resync_dirty_only) == pbdev->bdev.blockcnt);
+	CU_ASSERT(resync_dirty_only == false);
+
+	/* The same base bdev returning only gets the dirty regions rebuilt */
+	raid_bdev_write_intent_base_bdev_removed(base_info);
+	CU_ASSERT(spdk_uuid_compare(&wi->departed_uuid[0], &base_info->uuid) == 0);
+	CU_ASSERT(run_raid_rebuild(pbdev, &resync_dirty_only) == 3 * region_blocks);
+	CU_ASSERT(resync_dirty_only == true);
+	CU_ASSERT(spdk_uuid_is_null(&wi->departed_uuid[0]));
+
+	/* Not if some writes couldn't be tracked */
+	raid_bdev_write_intent_base_bdev_removed(base_info);
+	raid_bdev_write_intent_start(pbdev, pbdev->bdev.blockcnt - 1, 2);
+	raid_bdev_write_intent_end(pbdev, pbdev->bdev.blockcnt - 1, 2);
+	CU_ASSERT(wi->incomplete == true);
+	CU_ASSERT(run_raid_rebuild(pbdev, &resync_dirty_only) == pbdev->bdev.blockcnt);
+	CU_ASSERT(resync_dirty_only == false);
+	wi->incomplete = false;
+
+	/* Nor if it came back without a superblock */
+	raid_bdev_write_intent_base_bdev_removed(base_info);
+	raid_bdev_write_intent_forget(pbdev, &base_info->uuid);
+	CU_ASSERT(run_raid_rebuild(pbdev, &resync_dirty_only) == pbdev->bdev.blockcnt);
+	CU_ASSERT(resync_dirty_only == false);
+
+	delete_raid_with_write_intent();
+	raid_bdev_exit();
+	base_bdevs_cleanup();
+	reset_globals();
+}
+
+static void
+test_raid_write_intent_clean(void)
+{
+	struct raid_bdev *pbdev;
+	struct raid_bdev_write_intent *wi;
+	struct raid_base_bdev_info *base_info;
+
+	set_globals();
+	CU_ASSERT(raid_bdev_init() == 0);
+
+	pbdev = create_raid_with_write_intent(4 * g_block_len / 1024);
+	wi = pbdev->write_intent;
+	base_info = &pbdev->base_bdev_info[1];
+
+	raid_bdev_write_intent_start(pbdev, 0, 1);
+	raid_bdev_write_intent_start(pbdev, 8, 1);
+	raid_bdev_write_intent_end(pbdev, 0, 1);
+	raid_bdev_write_intent_base_bdev_removed(base_info);
+
+	/* Regions are not cleaned while a base bdev is missing */
+	base_info->is_configured = false;
+	CU_ASSERT(raid_bdev_write_intent_clean_poll(pbdev) == SPDK_POLLER_IDLE);
+	CU_ASSERT(wi->dirty[0] == ((1ULL << 0) | (1ULL << 2)));
+	CU_ASSERT(!spdk_uuid_is_null(&wi->departed_uuid[1]));
+	base_info->is_configured = true;
+
+	/* Nor while writes to them are outstanding */
+	CU_ASSERT(raid_bdev_write_intent_clean_poll(pbdev) == SPDK_POLLER_BUSY);
+	CU_ASSERT(wi->dirty[0] == (1ULL << 2));
+	CU_ASSERT(spdk_uuid_is_null(&wi->departed_uuid[1]));
+
+	raid_bdev_write_intent_end(pbdev, 8, 1);
+	CU_ASSERT(raid_bdev_write_intent_clean_poll(pbdev) == SPDK_POLLER_BUSY);
+	CU_ASSERT(wi->dirty[0] == 0);
+	CU_ASSERT(raid_bdev_write_intent_clean_poll(pbdev) == SPDK_POLLER_IDLE);
+
+	delete_raid_with_write_intent();
+	raid_bdev_exit();
+	base_bdevs_cleanup();
+	reset_globals();
+}
+
+static void
+test_raid_process_latency_throttle(void)
+{
+	struct raid_bdev_process process = {};
+	const uint64_t delay_min = RAID_PROCESS_THROTTLE_DELAY_MIN_US * spdk_get_ticks_hz() /
+				   SPDK_SEC_TO_USEC;
+	const uint64_t delay_max = RAID_PROCESS_THROTTLE_DELAY_MAX_US * spdk_get_ticks_hz() /
+				   SPDK_SEC_TO_USEC;
+	uint64_t ticks, p99, num_samples;
+	uint32_t bucket;
+
+	/* Each latency falls into a bucket whose upper bound is at most 25% higher */
+	for (ticks = 0; ticks < (1ULL << 40); ticks = ticks * 3 / 2 + 1) {
+		bucket = raid_process_latency_bucket(ticks);
+		SPDK_CU_ASSERT_FATAL(bucket < RAID_PROCESS_LATENCY_NUM_BUCKETS);
+		CU_ASSERT(raid_process_latency_bucket_max(bucket) >= ticks);
+		CU_ASSERT(raid_process_latency_bucket_max(bucket) <= ticks + ticks / 4);
+		CU_ASSERT(raid_process_latency_bucket(raid_process_latency_bucket_max(bucket)) == bucket);
+	}
+	CU_ASSERT(raid_process_latency_bucket(UINT64_MAX) < RAID_PROCESS_LATENCY_NUM_BUCKETS);
+
+	process.throttle.latency.buckets[raid_process_latency_bucket(100)] = 99;
+	process.throttle.latency.buckets[raid_process_latency_bucket(10000)] = 1;
+	p99 = raid_process_latency_p99(&process.throttle.latency, &num_samples);
+	CU_ASSERT(num_samples == 100);
+	CU_ASSERT(p99 == raid_process_latency_bucket_max(raid_process_latency_bucket(100)));
+
+	process.throttle.latency.buckets[raid_process_latency_bucket(10000)] = 2;
+	p99 = raid_process_latency_p99(&process.throttle.latency, &num_samples);
+	CU_ASSERT(p99 == raid_process_latency_bucket_max(raid_process_latency_bucket(10000)));
+
+	/* Disabled */
+	raid_bdev_process_throttle_update(&process);
+	CU_ASSERT(process.throttle.delay_ticks == 0);
+
+	/* Over the target, the delay grows up to the maximum */
+	process.throttle.max_latency_ticks = 1000;
+	raid_bdev_process_throttle_update(&process);
+	CU_ASSERT(process.throttle.delay_ticks == delay_min);
+	CU_ASSERT(process.throttle.next_window_tsc >= spdk_get_ticks() + delay_min);
+	CU_ASSERT(process.throttle.latency.buckets[raid_process_latency_bucket(10000)] == 0);
+
+	while (process.throttle.delay_ticks < delay_max) {
+		ticks = process.throttle.delay_ticks;
+		process.throttle.latency.buckets[raid_process_latency_bucket(10000)] = 100;
+		raid_bdev_process_throttle_update(&process);
+		CU_ASSERT(process.throttle.delay_ticks == spdk_min(ticks * 2, delay_max));
+	}
+
+	/* Too few samples to decide */
+	process.throttle.latency.buckets[raid_process_latency_bucket(100)] = 1;
+	raid_bdev_process_throttle_update(&process);
+	CU_ASSERT(process.throttle.delay_ticks == delay_max);
+	CU_ASSERT(process.throttle.latency.buckets[raid_process_latency_bucket(100)] == 1);
+
+	/* Under the target, the delay shrinks until it's gone */
+	while (process.throttle.delay_ticks != 0) {
+		ticks = process.throttle.delay_ticks;
+		process.throttle.latency.buckets[raid_process_latency_bucket(100)] = 100;
+		raid_bdev_process_throttle_update(&process);
+		CU_ASSERT(process.throttle.delay_ticks == (ticks / 2 < delay_min ? 0 : ticks / 2));
+	}
+
+	/* No foreground I/O at all is also under the target */
+	process.throttle.delay_ticks = delay_min * 2;
+	raid_bdev_process_throttle_update(&process);
+	CU_ASSERT(process.throttle.delay_ticks == delay_min);
+}
+
 static void
 test_raid_io_split(void)
 {
@@ -1796,6 +2060,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_raid_io_split);
 	CU_ADD_TEST(suite, test_raid_process);
 	CU_ADD_TEST(suite, test_raid_process_with_qos);
+	CU_ADD_TEST(suite, test_raid_write_intent_rebuild);
+	CU_ADD_TEST(suite, test_raid_write_intent_clean);
+	CU_ADD_TEST(suite, test_raid_process_latency_throttle);
 
 	spdk_thread_lib_init(test_new_thread_fn, 0);
 	g_app_thread = spdk_thread_create("app_thread", NULL);
@@ -15,19 +15,15 @@
 static enum spdk_bdev_io_status g_io_status;
 static struct spdk_bdev_desc *g_last_io_desc;
 static spdk_bdev_io_completion_cb g_last_io_cb;
+static uint64_t g_last_io_offset;
+static uint32_t g_num_writes;
+static int g_process_status;
 
 DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
 DEFINE_STUB_V(raid_bdev_module_stop_done, (struct raid_bdev *raid_bdev));
 DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
 DEFINE_STUB_V(raid_bdev_queue_io_wait, (struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
 					struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn));
-DEFINE_STUB_V(raid_bdev_process_request_complete, (struct raid_bdev_process_request *process_req,
-		int status));
-DEFINE_STUB_V(raid_bdev_io_init, (struct raid_bdev_io *raid_io,
-				  struct raid_bdev_io_channel *raid_ch,
-				  enum spdk_bdev_io_type type, uint64_t offset_blocks,
-				  uint64_t num_blocks, struct iovec *iovs, int iovcnt, void *md_buf,
-				  struct spdk_memory_domain *memory_domain, void *memory_domain_ctx));
 DEFINE_STUB(raid_bdev_remap_dix_reftag, int, (void *md_buf, uint64_t num_blocks,
 		struct spdk_bdev *bdev, uint32_t remapped_offset), -1);
 DEFINE_STUB(spdk_bdev_notify_blockcnt_change, int, (struct spdk_bdev *bdev, uint64_t size), 0);
@@ -40,6 +36,7 @@ spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc,
 {
 	g_last_io_desc = desc;
 	g_last_io_cb = cb;
+	g_last_io_offset = offset_blocks;
 
 	return 0;
 }
@@ -52,10 +49,28 @@ spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc,
 {
 	g_last_io_desc = desc;
 	g_last_io_cb = cb;
+	g_last_io_offset = offset_blocks;
+	g_num_writes++;
 
 	return 0;
 }
 
+void
+raid_bdev_io_init(struct raid_bdev_io *raid_io, struct raid_bdev_io_channel *raid_ch,
+		  enum spdk_bdev_io_type type, uint64_t offset_blocks,
+		  uint64_t num_blocks, struct iovec *iovs, int iovcnt, void *md_buf,
+		  struct spdk_memory_domain *memory_domain, void *memory_domain_ctx)
+{
+	raid_test_bdev_io_init(raid_io, raid_io->raid_bdev, raid_ch, type, offset_blocks, num_blocks,
+			       iovs, iovcnt, md_buf);
+}
+
+void
+raid_bdev_process_request_complete(struct raid_bdev_process_request *process_req, int status)
+{
+	g_process_status = status;
+}
+
 void
 raid_bdev_fail_base_bdev(struct raid_base_bdev_info *base_info)
 {
@@ -146,19 +161,27 @@ test_raid1_start(void)
 }
 
 static struct raid_bdev_io *
-get_raid_io(struct raid1_info *r1_info, struct raid_bdev_io_channel *raid_ch,
-	    enum spdk_bdev_io_type io_type, uint64_t num_blocks)
+_get_raid_io(struct raid1_info *r1_info, struct raid_bdev_io_channel *raid_ch,
+	     enum spdk_bdev_io_type io_type, uint64_t offset_blocks, uint64_t num_blocks)
 {
 	struct raid_bdev_io *raid_io;
 
 	raid_io = calloc(1, sizeof(*raid_io));
 	SPDK_CU_ASSERT_FATAL(raid_io != NULL);
 
-	raid_test_bdev_io_init(raid_io, r1_info->raid_bdev, raid_ch, io_type, 0, num_blocks, NULL, 0, NULL);
+	raid_test_bdev_io_init(raid_io, r1_info->raid_bdev, raid_ch, io_type, offset_blocks, num_blocks,
+			       NULL, 0, NULL);
 
 	return raid_io;
 }
 
+static struct raid_bdev_io *
+get_raid_io(struct raid1_info *r1_info, struct raid_bdev_io_channel *raid_ch,
+	    enum spdk_bdev_io_type io_type, uint64_t num_blocks)
+{
+	return _get_raid_io(r1_info, raid_ch, io_type, 0, num_blocks);
+}
+
 static void
 put_raid_io(struct raid_bdev_io *raid_io)
 {
@@ -217,8 +240,8 @@ _test_raid1_read_balancing(struct raid_bdev *raid_bdev, struct raid_bdev_io_chan
 	}
 
 	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
-		CU_ASSERT(raid1_ch->read_blocks_outstanding[i] == n * small_io_blocks);
-		raid1_ch->read_blocks_outstanding[i] = 0;
+		CU_ASSERT(raid1_ch->base[i].read_blocks_outstanding == n * small_io_blocks);
+		raid1_ch->base[i].read_blocks_outstanding = 0;
 	}
 
 	/*
@@ -240,7 +263,7 @@ _test_raid1_read_balancing(struct raid_bdev *raid_bdev, struct raid_bdev_io_chan
 	}
 
 	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
-		CU_ASSERT(raid1_ch->read_blocks_outstanding[i] == big_io_blocks);
+		CU_ASSERT(raid1_ch->base[i].read_blocks_outstanding == big_io_blocks);
 	}
 
 	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, small_io_blocks);
@@ -255,6 +278,71 @@ test_raid1_read_balancing(void)
 	run_for_each_raid1_config(_test_raid1_read_balancing);
 }
 
+static void
+_test_raid1_read_latency(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid1_info *r1_info = raid_bdev->module_private;
+	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct spdk_bdev_io bdev_io = {};
+	struct raid_bdev_io *raid_io;
+	uint8_t i;
+	int n;
+
+	/* the first sample seeds the average */
+	MOCK_SET(spdk_get_ticks, 1000);
+	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 10);
+	raid1_submit_read_request(raid_io);
+	CU_ASSERT(raid_io->base_bdev_io_submitted == 0);
+	MOCK_SET(spdk_get_ticks, 2000);
+	raid1_read_bdev_io_completion(&bdev_io, true, raid_io);
+	CU_ASSERT(raid1_ch->base[0].ewma_read_ticks_per_block == 100);
+
+	/* unsampled base bdevs are assumed to be as fast as the fastest one */
+	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 10);
+	raid1_submit_read_request(raid_io);
+	CU_ASSERT(raid_io->base_bdev_io_submitted == 0);
+	MOCK_SET(spdk_get_ticks, 4600);
+	raid1_read_bdev_io_completion(&bdev_io, true, raid_io);
+	CU_ASSERT(raid1_ch->base[0].ewma_read_ticks_per_block ==
+		  100 + (260 - 100) / (1 << RAID1_READ_LATENCY_EWMA_SHIFT));
+	MOCK_CLEAR(spdk_get_ticks);
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		CU_ASSERT(raid1_ch->base[i].read_blocks_outstanding == 0);
+	}
+
+	/* base bdev #0 is 4 times slower than the others and gets a fraction of the reads */
+	raid1_ch->base[0].ewma_read_ticks_per_block = 400;
+	for (i = 1; i < raid_bdev->num_base_bdevs; i++) {
+		raid1_ch->base[i].ewma_read_ticks_per_block = 100;
+	}
+
+	for (n = 0; n < 40 * raid_bdev->num_base_bdevs; n++) {
+		raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 4);
+		raid1_submit_read_request(raid_io);
+		put_raid_io(raid_io);
+	}
+
+	CU_ASSERT(raid1_ch->base[0].read_blocks_outstanding > 0);
+	for (i = 1; i < raid_bdev->num_base_bdevs; i++) {
+		CU_ASSERT(raid1_ch->base[0].read_blocks_outstanding * 2 <
+			  raid1_ch->base[i].read_blocks_outstanding);
+	}
+
+	/* periodically a read goes to a slow base bdev to refresh its latency */
+	raid1_ch->num_reads = raid_bdev->num_base_bdevs * RAID1_READ_LATENCY_PROBE_INTERVAL - 1;
+	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 4);
+	raid1_submit_read_request(raid_io);
+	CU_ASSERT(raid_io->base_bdev_io_submitted == 0);
+	put_raid_io(raid_io);
+}
+
+static void
+test_raid1_read_latency(void)
+{
+	run_for_each_raid1_config(_test_raid1_read_latency);
+}
+
 static void
 _test_raid1_write_error(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
 {
@@ -440,7 +528,7 @@ _test_raid1_read_error(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel
 	/* read from base bdev #1 fails, read from #0 succeeds */
 	base_info->is_failed = false;
 	base_info = &raid_bdev->base_bdev_info[1];
-	raid1_ch->read_blocks_outstanding[0] = 123;
+	raid1_ch->base[0].read_blocks_outstanding = 123;
 	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
 	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 64);
 	raid1_submit_read_request(raid_io);
@@ -502,6 +590,176 @@ test_raid1_read_error(void)
 	run_for_each_raid1_config(_test_raid1_read_error);
 }
 
+static struct raid1_info *
+create_raid10(uint8_t num_base_bdevs, uint64_t base_bdev_blockcnt, uint32_t strip_size)
+{
+	struct raid_params params = {
+		.num_base_bdevs = num_base_bdevs,
+		.base_bdev_blockcnt = base_bdev_blockcnt,
+		.base_bdev_blocklen = 4096,
+		.strip_size = strip_size,
+	};
+	struct raid_bdev *raid_bdev = raid_test_create_raid_bdev(&params, &g_raid10_module);
+
+	SPDK_CU_ASSERT_FATAL(raid10_start(raid_bdev) == 0);
+
+	return raid_bdev->module_private;
+}
+
+static void
+test_raid10_start(void)
+{
+	struct raid_params params = {
+		.num_base_bdevs = 5,
+		.base_bdev_blockcnt = 1024,
+		.base_bdev_blocklen = 4096,
+		.strip_size = 8,
+	};
+	struct raid1_info *r1_info;
+	struct raid_bdev *raid_bdev;
+
+	r1_info = create_raid10(4, 1003, 8);
+	raid_bdev = r1_info->raid_bdev;
+	CU_ASSERT_EQUAL(r1_info->mirror_copies, 2);
+	CU_ASSERT_EQUAL(r1_info->num_mirror_sets, 2);
+	CU_ASSERT_EQUAL(raid_bdev->bdev.blockcnt, 1000 * 2);
+	CU_ASSERT_EQUAL(raid_bdev->base_bdev_info[0].data_size, 1000);
+	CU_ASSERT_EQUAL(raid_bdev->bdev.optimal_io_boundary, 8);
+	CU_ASSERT(raid_bdev->bdev.split_on_optimal_io_boundary == true);
+	delete_raid1(r1_info);
+
+	/* odd number of base bdevs */
+	raid_bdev = raid_test_create_raid_bdev(&params, &g_raid10_module);
+	CU_ASSERT(raid10_start(raid_bdev) == -EINVAL);
+	raid_test_delete_raid_bdev(raid_bdev);
+}
+
+static void
+test_raid10_io(void)
+{
+	const uint32_t strip_size = 8;
+	struct raid1_info *r1_info;
+	struct raid_bdev *raid_bdev;
+	struct raid_bdev_io_channel *raid_ch;
+	struct raid_bdev_io *raid_io;
+	struct spdk_bdev_io bdev_io = {};
+	uint8_t num_base_bdevs, mirror_set;
+	uint64_t strip, base_offset;
+
+	for (num_base_bdevs = 4; num_base_bdevs <= 6; num_base_bdevs += 2) {
+		r1_info = create_raid10(num_base_bdevs, 1024, strip_size);
+		raid_bdev = r1_info->raid_bdev;
+		raid_ch = raid_test_create_io_channel(raid_bdev);
+
+		for (strip = 0; strip < 2 * r1_info->num_mirror_sets; strip++) {
+			mirror_set = strip % r1_info->num_mirror_sets;
+			base_offset = (strip / r1_info->num_mirror_sets) * strip_size + 3;
+
+			/* the read goes to the pair holding the strip */
+			raid_io = _get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ,
+					       strip * strip_size + 3, 2);
+			raid1_submit_read_request(raid_io);
+			CU_ASSERT(raid_io->base_bdev_io_submitted / 2 == mirror_set);
+			CU_ASSERT(g_last_io_desc ==
+				  raid_bdev->base_bdev_info[raid_io->base_bdev_io_submitted].desc);
+			CU_ASSERT(g_last_io_offset == base_offset);
+
+			/* on error, the other base bdev of the pair is read */
+			raid1_read_bdev_io_completion(&bdev_io, false, raid_io);
+			CU_ASSERT(g_last_io_cb == raid1_read_other_completion);
+			CU_ASSERT(g_last_io_desc ==
+				  raid_bdev->base_bdev_info[(raid_io->base_bdev_io_submitted ^ 1)].desc);
+			CU_ASSERT(g_last_io_offset == base_offset);
+			raid1_read_other_completion(&bdev_io, false, raid_io);
+			CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+			raid_bdev->base_bdev_info[mirror_set * 2].is_failed = false;
+			raid_bdev->base_bdev_info[mirror_set * 2 + 1].is_failed = false;
+
+			/* the write goes to both base bdevs of the pair */
+			g_num_writes = 0;
+			g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+			raid_io = _get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_WRITE,
+					       strip * strip_size + 3, 2);
+			raid1_submit_write_request(raid_io);
+			CU_ASSERT(g_num_writes == 2);
+			CU_ASSERT(g_last_io_desc == raid_bdev->base_bdev_info[mirror_set * 2 + 1].desc);
+			CU_ASSERT(g_last_io_offset == base_offset);
+			CU_ASSERT(raid_io->base_bdev_io_remaining == 2);
+			raid1_write_bdev_io_completion(&bdev_io, true, raid_io);
+			raid1_write_bdev_io_completion(&bdev_io, true, raid_io);
+			CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+		}
+
+		raid_test_destroy_io_channel(raid_ch);
+		delete_raid1(r1_info);
+	}
+}
+
+static void
+test_raid10_process(void)
+{
+	const uint32_t strip_size = 8;
+	struct raid_bdev_process_request process_req = {};
+	struct raid1_info *r1_info;
+	struct raid_bdev *raid_bdev;
+	struct raid_bdev_io_channel *raid_ch;
+	struct raid_bdev_io *raid_io = &process_req.raid_io;
+	int ret;
+
+	r1_info = create_raid10(4, 1024, strip_size);
+	raid_bdev = r1_info->raid_bdev;
+	raid_ch = raid_test_create_io_channel(raid_bdev);
+
+	/* rebuild base bdev #2, its strips are the odd ones */
+	process_req.target = &raid_bdev->base_bdev_info[2];
+	raid_ch->_base_channels[2] = NULL;
+	raid_io->raid_bdev = raid_bdev;
+
+	/* the window covers strips 0-3, the request ends with strip 1 */
+	process_req.offset_blocks = 0;
+	process_req.num_blocks = 4 * strip_size;
+	process_req.iov.iov_len = process_req.num_blocks * raid_bdev->bdev.blocklen;
+	ret = raid10_submit_process_request(&process_req, raid_ch);
+	CU_ASSERT(ret == 2 * strip_size);
+	CU_ASSERT(raid_io->offset_blocks == strip_size);
+	CU_ASSERT(raid_io->num_blocks == strip_size);
+	CU_ASSERT(process_req.iov.iov_len == strip_size * raid_bdev->bdev.blocklen);
+	CU_ASSERT(g_last_io_desc == raid_bdev->base_bdev_info[3].desc);
+	CU_ASSERT(g_last_io_offset == 0);
+
+	/* the window starts in the middle of strip 1 */
+	process_req.offset_blocks = strip_size + 2;
+	process_req.num_blocks = 4 * strip_size;
+	ret = raid10_submit_process_request(&process_req, raid_ch);
+	CU_ASSERT(ret == strip_size - 2);
+	CU_ASSERT(raid_io->offset_blocks == strip_size + 2);
+	CU_ASSERT(raid_io->num_blocks == strip_size - 2);
+	CU_ASSERT(g_last_io_offset == 2);
+
+	/* the window starts after strip 1, the request ends with strip 3 */
+	process_req.offset_blocks = 2 * strip_size + 1;
+	process_req.num_blocks = 4 * strip_size;
+	ret = raid10_submit_process_request(&process_req, raid_ch);
+	CU_ASSERT(ret == 2 * strip_size - 1);
+	CU_ASSERT(raid_io->offset_blocks == 3 * strip_size);
+	CU_ASSERT(g_last_io_offset == strip_size);
+
+	/* the window ends before strip 3, the request completes without I/O */
+	g_process_status = -1;
+	g_last_io_desc = NULL;
+	process_req.offset_blocks = 2 * strip_size;
+	process_req.num_blocks = strip_size;
+	ret = raid10_submit_process_request(&process_req, raid_ch);
+	CU_ASSERT(ret == (int)strip_size);
+	CU_ASSERT(g_last_io_desc == NULL);
+	CU_ASSERT(g_process_status == -1);
+	poll_threads();
+	CU_ASSERT(g_process_status == 0);
+
+	raid_test_destroy_io_channel(raid_ch);
+	delete_raid1(r1_info);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -515,6 +773,10 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_raid1_read_balancing);
 	CU_ADD_TEST(suite, test_raid1_write_error);
 	CU_ADD_TEST(suite, test_raid1_read_error);
+	CU_ADD_TEST(suite, test_raid1_read_latency);
+	CU_ADD_TEST(suite, test_raid10_start);
+	CU_ADD_TEST(suite, test_raid10_io);
+	CU_ADD_TEST(suite, test_raid10_process);
 
 	allocate_threads(1);
 	set_thread(0);
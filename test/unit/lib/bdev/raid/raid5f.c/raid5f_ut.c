@@ -187,9 +187,10 @@ test_raid5f_start(void)
 		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.blockcnt,
 				(params->base_bdev_blockcnt - params->base_bdev_blockcnt % params->strip_size) *
 				(params->num_base_bdevs - 1));
-		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.optimal_io_boundary, params->strip_size);
+		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.optimal_io_boundary, r5f_info->stripe_blocks);
 		CU_ASSERT_TRUE(r5f_info->raid_bdev->bdev.split_on_optimal_io_boundary);
 		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.write_unit_size, r5f_info->stripe_blocks);
+		CU_ASSERT_FALSE(r5f_info->raid_bdev->bdev.split_on_write_unit);
 
 		delete_raid5f(r5f_info);
 	}
@@ -242,6 +243,13 @@ struct test_raid_bdev_io {
 	void *buf_md;
 };
 
+/* Contents of the base bdevs, used by the partial stripe request tests */
+static struct {
+	void **bufs;
+	void **md_bufs;
+	uint64_t num_blocks;
+} g_base_bdevs_data;
+
 void
 raid_bdev_queue_io_wait(struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
 			struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn)
@@ -422,6 +430,18 @@ spdk_bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_chan
 	r5f_info = io_info->r5f_info;
 	raid_bdev = r5f_info->raid_bdev;
 
+	if (g_base_bdevs_data.bufs != NULL) {
+		SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= g_base_bdevs_data.num_blocks);
+		dest.iov_base = g_base_bdevs_data.bufs[chunk->index] + offset_blocks * raid_bdev->bdev.blocklen;
+		dest.iov_len = num_blocks * raid_bdev->bdev.blocklen;
+		CU_ASSERT(spdk_iovcpy(iov, iovcnt, &dest, 1) == dest.iov_len);
+		if (md_buf != NULL) {
+			memcpy(g_base_bdevs_data.md_bufs[chunk->index] + offset_blocks * raid_bdev->bdev.md_len,
+			       md_buf, num_blocks * raid_bdev->bdev.md_len);
+		}
+		goto submit;
+	}
+
 	if (chunk == stripe_req->parity_chunk) {
 		if (io_info->parity_buf == NULL) {
 			goto submit;
@@ -472,6 +492,18 @@ spdk_bdev_readv_blocks_degraded(struct spdk_bdev_desc *desc, struct spdk_io_chan
 	io_info = test_raid_bdev_io->io_info;
 	raid_bdev = io_info->r5f_info->raid_bdev;
 
+	if (g_base_bdevs_data.bufs != NULL) {
+		SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= g_base_bdevs_data.num_blocks);
+		src.iov_base = g_base_bdevs_data.bufs[chunk->index] + offset_blocks * raid_bdev->bdev.blocklen;
+		src.iov_len = num_blocks * raid_bdev->bdev.blocklen;
+		CU_ASSERT(spdk_iovcpy(&src, 1, iov, iovcnt) == src.iov_len);
+		if (md_buf != NULL) {
+			memcpy(md_buf, g_base_bdevs_data.md_bufs[chunk->index] + offset_blocks * raid_bdev->bdev.md_len,
+			       num_blocks * raid_bdev->bdev.md_len);
+		}
+		return submit_io(io_info, desc, cb, cb_arg);
+	}
+
 	if (chunk == stripe_req->parity_chunk) {
 		buf = io_info->reference_parity;
 	} else {
@@ -1115,6 +1147,348 @@ test_raid5f_submit_read_request_degraded(void)
 	run_for_each_raid5f_config(__test_raid5f_submit_read_request);
 }
 
+static void
+init_base_bdevs_data(struct raid_bdev *raid_bdev, uint64_t num_stripes)
+{
+	uint32_t md_len = raid_bdev->bdev.md_interleave ? 0 : raid_bdev->bdev.md_len;
+	size_t strip_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	size_t strip_md_len = raid_bdev->strip_size * md_len;
+	uint64_t stripe_index;
+	uint8_t p_idx;
+	uint8_t i;
+	size_t j;
+
+	g_base_bdevs_data.num_blocks = num_stripes * raid_bdev->strip_size;
+	g_base_bdevs_data.bufs = calloc(raid_bdev->num_base_bdevs, sizeof(void *));
+	SPDK_CU_ASSERT_FATAL(g_base_bdevs_data.bufs != NULL);
+	g_base_bdevs_data.md_bufs = calloc(raid_bdev->num_base_bdevs, sizeof(void *));
+	SPDK_CU_ASSERT_FATAL(g_base_bdevs_data.md_bufs != NULL);
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		g_base_bdevs_data.bufs[i] = malloc(num_stripes * strip_len);
+		SPDK_CU_ASSERT_FATAL(g_base_bdevs_data.bufs[i] != NULL);
+		for (j = 0; j < num_stripes * strip_len; j++) {
+			((uint8_t *)g_base_bdevs_data.bufs[i])[j] = rand();
+		}
+
+		if (md_len != 0) {
+			g_base_bdevs_data.md_bufs[i] = malloc(num_stripes * strip_md_len);
+			SPDK_CU_ASSERT_FATAL(g_base_bdevs_data.md_bufs[i] != NULL);
+			for (j = 0; j < num_stripes * strip_md_len; j++) {
+				((uint8_t *)g_base_bdevs_data.md_bufs[i])[j] = rand();
+			}
+		}
+	}
+
+	/* Make the parity consistent with the data */
+	for (stripe_index = 0; stripe_index < num_stripes; stripe_index++) {
+		p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, stripe_index);
+
+		memset(g_base_bdevs_data.bufs[p_idx] + stripe_index * strip_len, 0, strip_len);
+		if (md_len != 0) {
+			memset(g_base_bdevs_data.md_bufs[p_idx] + stripe_index * strip_md_len, 0, strip_md_len);
+		}
+
+		for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+			if (i == p_idx) {
+				continue;
+			}
+			xor_block(g_base_bdevs_data.bufs[p_idx] + stripe_index * strip_len,
+				  g_base_bdevs_data.bufs[i] + stripe_index * strip_len, strip_len);
+			if (md_len != 0) {
+				xor_block(g_base_bdevs_data.md_bufs[p_idx] + stripe_index * strip_md_len,
+					  g_base_bdevs_data.md_bufs[i] + stripe_index * strip_md_len, strip_md_len);
+			}
+		}
+	}
+}
+
+static void
+deinit_base_bdevs_data(struct raid_bdev *raid_bdev)
+{
+	uint8_t i;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		free(g_base_bdevs_data.bufs[i]);
+		free(g_base_bdevs_data.md_bufs[i]);
+	}
+	free(g_base_bdevs_data.bufs);
+	free(g_base_bdevs_data.md_bufs);
+	memset(&g_base_bdevs_data, 0, sizeof(g_base_bdevs_data));
+}
+
+/*
+ * Gets the stripe data from the base bdevs data, rebuilding the missing chunk from parity.
+ * If no chunk is missing, the parity is verified.
+ */
+static void
+get_stripe_data(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch,
+		uint64_t stripe_index, void *buf, void *md_buf)
+{
+	uint32_t md_len = raid_bdev->bdev.md_interleave ? 0 : raid_bdev->bdev.md_len;
+	size_t strip_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	size_t strip_md_len = raid_bdev->strip_size * md_len;
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, stripe_index);
+	void *chunk_buf, *chunk_md_buf;
+	void *xor_buf, *xor_md_buf;
+	int missing_idx = -1;
+	uint8_t data_idx = 0;
+	uint8_t i;
+
+	xor_buf = calloc(1, strip_len);
+	SPDK_CU_ASSERT_FATAL(xor_buf != NULL);
+	xor_md_buf = calloc(1, spdk_max(strip_md_len, 1));
+	SPDK_CU_ASSERT_FATAL(xor_md_buf != NULL);
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (raid_bdev_channel_get_base_channel(raid_ch, i) == NULL) {
+			missing_idx = i;
+			continue;
+		}
+		xor_block(xor_buf, g_base_bdevs_data.bufs[i] + stripe_index * strip_len, strip_len);
+		if (md_len != 0) {
+			xor_block(xor_md_buf, g_base_bdevs_data.md_bufs[i] + stripe_index * strip_md_len,
+				  strip_md_len);
+		}
+	}
+
+	if (missing_idx == -1) {
+		CU_ASSERT(spdk_mem_all_zero(xor_buf, strip_len));
+		CU_ASSERT(spdk_mem_all_zero(xor_md_buf, strip_md_len));
+	}
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (i == p_idx) {
+			continue;
+		}
+
+		if (i == missing_idx) {
+			chunk_buf = xor_buf;
+			chunk_md_buf = xor_md_buf;
+		} else {
+			chunk_buf = g_base_bdevs_data.bufs[i] + stripe_index * strip_len;
+			chunk_md_buf = md_len ? g_base_bdevs_data.md_bufs[i] + stripe_index * strip_md_len : NULL;
+		}
+
+		memcpy(buf + data_idx * strip_len, chunk_buf, strip_len);
+		if (md_len != 0) {
+			memcpy(md_buf + data_idx * strip_md_len, chunk_md_buf, strip_md_len);
+		}
+		data_idx++;
+	}
+
+	free(xor_buf);
+	free(xor_md_buf);
+}
+
+static void
+test_raid5f_partial_request(struct raid_io_info *io_info)
+{
+	struct raid_bdev *raid_bdev = io_info->r5f_info->raid_bdev;
+	uint32_t md_len = raid_bdev->bdev.md_interleave ? 0 : raid_bdev->bdev.md_len;
+	size_t stripe_len = io_info->r5f_info->stripe_blocks * raid_bdev->bdev.blocklen;
+	size_t stripe_md_len = io_info->r5f_info->stripe_blocks * md_len;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	struct raid_bdev_io *raid_io;
+	void *expected, *expected_md;
+	size_t i;
+
+	expected = malloc(stripe_len);
+	SPDK_CU_ASSERT_FATAL(expected != NULL);
+	expected_md = malloc(spdk_max(stripe_md_len, 1));
+	SPDK_CU_ASSERT_FATAL(expected_md != NULL);
+
+	get_stripe_data(raid_bdev, io_info->raid_ch, io_info->stripe_index, expected, expected_md);
+
+	if (io_info->io_type == SPDK_BDEV_IO_TYPE_WRITE) {
+		for (i = 0; i < io_info->buf_size; i++) {
+			((uint8_t *)io_info->src_buf)[i] = rand();
+		}
+		memcpy(expected + io_info->stripe_offset_blocks * blocklen, io_info->src_buf, io_info->buf_size);
+		if (io_info->buf_md_size) {
+			for (i = 0; i < io_info->buf_md_size; i++) {
+				((uint8_t *)io_info->src_md_buf)[i] = rand();
+			}
+			memcpy(expected_md + io_info->stripe_offset_blocks * md_len, io_info->src_md_buf,
+			       io_info->buf_md_size);
+		}
+	}
+
+	raid_io = get_raid_io(io_info);
+
+	raid5f_submit_rw_request(raid_io);
+
+	for (i = 0; i < 10 && io_info->status == SPDK_BDEV_IO_STATUS_PENDING; i++) {
+		poll_threads();
+		process_io_completions(io_info);
+	}
+
+	CU_ASSERT(io_info->status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	if (io_info->io_type == SPDK_BDEV_IO_TYPE_WRITE) {
+		void *data = malloc(stripe_len);
+		void *md = malloc(spdk_max(stripe_md_len, 1));
+
+		SPDK_CU_ASSERT_FATAL(data != NULL);
+		SPDK_CU_ASSERT_FATAL(md != NULL);
+
+		get_stripe_data(raid_bdev, io_info->raid_ch, io_info->stripe_index, data, md);
+		CU_ASSERT(memcmp(data, expected, stripe_len) == 0);
+		CU_ASSERT(memcmp(md, expected_md, stripe_md_len) == 0);
+
+		free(data);
+		free(md);
+	} else {
+		CU_ASSERT(memcmp(io_info->dest_buf, expected + io_info->stripe_offset_blocks * blocklen,
+				 io_info->buf_size) == 0);
+		if (io_info->buf_md_size) {
+			CU_ASSERT(memcmp(io_info->dest_md_buf, expected_md + io_info->stripe_offset_blocks * md_len,
+					 io_info->buf_md_size) == 0);
+		}
+	}
+
+	free(expected);
+	free(expected_md);
+}
+
+static void
+__test_raid5f_submit_partial_stripe_request(struct raid_bdev *raid_bdev,
+		struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	uint64_t strip_size = raid_bdev->strip_size;
+	uint64_t stripe_blocks = r5f_info->stripe_blocks;
+	uint64_t num_stripes = spdk_min(raid_bdev->num_base_bdevs, r5f_info->total_stripes);
+	struct {
+		uint64_t offset;
+		uint64_t num_blocks;
+	} ranges[] = {
+		{ 0, 1 },
+		{ 1, strip_size },
+		{ strip_size - 1, 2 },
+		{ strip_size, strip_size },
+		{ strip_size / 2, strip_size },
+		{ strip_size + 1, strip_size },
+		{ 0, strip_size * 2 },
+		{ strip_size - 1, stripe_blocks - strip_size },
+		{ 0, stripe_blocks - 1 },
+		{ 1, stripe_blocks - 1 },
+	};
+	enum spdk_bdev_io_type io_types[] = { SPDK_BDEV_IO_TYPE_WRITE, SPDK_BDEV_IO_TYPE_READ };
+	struct raid_io_info io_info;
+	uint64_t stripe_index;
+	unsigned int i, j;
+
+	init_base_bdevs_data(raid_bdev, num_stripes);
+
+	RAID5F_TEST_FOR_EACH_STRIPE(raid_bdev, stripe_index) {
+		for (i = 0; i < SPDK_COUNTOF(ranges); i++) {
+			uint64_t offset = ranges[i].offset;
+			uint64_t num_blocks = ranges[i].num_blocks;
+
+			if (num_blocks == 0 || offset + num_blocks > stripe_blocks) {
+				continue;
+			}
+
+			for (j = 0; j < SPDK_COUNTOF(io_types); j++) {
+				/* Reads of a single chunk don't use partial stripe requests */
+				if (io_types[j] == SPDK_BDEV_IO_TYPE_READ &&
+				    offset / strip_size == (offset + num_blocks - 1) / strip_size) {
+					continue;
+				}
+
+				init_io_info(&io_info, r5f_info, raid_ch, io_types[j], stripe_index, offset, num_blocks);
+				test_raid5f_partial_request(&io_info);
+				deinit_io_info(&io_info);
+			}
+		}
+	}
+
+	deinit_base_bdevs_data(raid_bdev);
+}
+static void
+test_raid5f_submit_partial_stripe_request(void)
+{
+	run_for_each_raid5f_config(__test_raid5f_submit_partial_stripe_request);
+}
+
+static void
+test_raid5f_submit_partial_stripe_request_degraded(void)
+{
+	g_test_degraded = true;
+	run_for_each_raid5f_config(__test_raid5f_submit_partial_stripe_request);
+}
+
+static void
+stripe_lock_acquired(void *ctx)
+{
+	struct raid_bdev_io **raid_io = ctx;
+
+	*raid_io = NULL;
+}
+
+static int
+stripe_lock_channel_create(void *io_device, void *ctx_buf)
+{
+	return 0;
+}
+
+static void
+stripe_lock_channel_destroy(void *io_device, void *ctx_buf)
+{
+}
+
+static void
+test_raid5f_stripe_lock(void)
+{
+	struct raid5f_info *r5f_info;
+	struct spdk_io_channel *ch;
+	struct raid_bdev_io_channel *raid_ch;
+	struct raid_bdev_io raid_io[3] = {};
+	struct raid_bdev_io *waiter = &raid_io[1];
+	uint64_t stripe_index = 1;
+
+	r5f_info = create_raid5f(g_params);
+	/* The waiter is resumed on the thread of its raid channel */
+	spdk_io_device_register(&raid_io, stripe_lock_channel_create, stripe_lock_channel_destroy,
+				sizeof(struct raid_bdev_io_channel), NULL);
+	ch = spdk_get_io_channel(&raid_io);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	raid_ch = spdk_io_channel_get_ctx(ch);
+
+	raid_io[0].raid_ch = raid_ch;
+	raid_io[1].raid_ch = raid_ch;
+	raid_io[2].raid_ch = raid_ch;
+
+	CU_ASSERT_TRUE(raid5f_stripe_lock(r5f_info, &raid_io[0], stripe_index));
+
+	/* A stripe in the same bucket has to wait */
+	CU_ASSERT_FALSE(raid5f_stripe_lock(r5f_info, &raid_io[1],
+					   stripe_index + RAID5F_STRIPE_LOCK_BUCKETS));
+	raid_io[1].waitq_entry.cb_fn = stripe_lock_acquired;
+	raid_io[1].waitq_entry.cb_arg = &waiter;
+
+	CU_ASSERT_TRUE(raid5f_stripe_lock(r5f_info, &raid_io[2], stripe_index + 1));
+	raid5f_stripe_unlock(r5f_info, stripe_index + 1);
+	CU_ASSERT_FALSE(r5f_info->stripe_locks[stripe_index + 1].locked);
+
+	/* The lock is handed over to the waiter */
+	raid5f_stripe_unlock(r5f_info, stripe_index);
+	CU_ASSERT_TRUE(r5f_info->stripe_locks[stripe_index].locked);
+	CU_ASSERT(TAILQ_EMPTY(&r5f_info->stripe_locks[stripe_index].waiters));
+	CU_ASSERT(waiter != NULL);
+	poll_threads();
+	CU_ASSERT(waiter == NULL);
+
+	raid5f_stripe_unlock(r5f_info, stripe_index + RAID5F_STRIPE_LOCK_BUCKETS);
+	CU_ASSERT_FALSE(r5f_info->stripe_locks[stripe_index].locked);
+
+	spdk_put_io_channel(ch);
+	spdk_io_device_unregister(&raid_io, NULL);
+	poll_threads();
+	delete_raid5f(r5f_info);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1133,6 +1507,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_raid5f_chunk_write_error_with_enomem);
 	CU_ADD_TEST(suite, test_raid5f_submit_full_stripe_write_request_degraded);
 	CU_ADD_TEST(suite, test_raid5f_submit_read_request_degraded);
+	CU_ADD_TEST(suite, test_raid5f_submit_partial_stripe_request);
+	CU_ADD_TEST(suite, test_raid5f_submit_partial_stripe_request_degraded);
+	CU_ADD_TEST(suite, test_raid5f_stripe_lock);
 
 	allocate_threads(1);
 	set_thread(0);
@@ -0,0 +1,1059 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk/gf.h"
+
+#include "common/lib/ut_multithread.c"
+
+#include "bdev/raid/raid6f.c"
+#include "../common.c"
+
+static void *g_accel_p = (void *)0xdeadbeaf;
+
+DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
+DEFINE_STUB(spdk_bdev_get_buf_align, size_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB_V(raid_bdev_module_stop_done, (struct raid_bdev *raid_bdev));
+DEFINE_STUB(accel_channel_create, int, (void *io_device, void *ctx_buf), 0);
+DEFINE_STUB_V(accel_channel_destroy, (void *io_device, void *ctx_buf));
+DEFINE_STUB(raid_bdev_remap_dix_reftag, int, (void *md_buf, uint64_t num_blocks,
+		struct spdk_bdev *bdev, uint32_t remapped_offset), -1);
+
+struct spdk_io_channel *
+spdk_accel_get_io_channel(void)
+{
+	return spdk_get_io_channel(g_accel_p);
+}
+
+struct gf_dot_prod_ctx {
+	spdk_accel_completion_cb cb_fn;
+	void *cb_arg;
+};
+
+static void
+finish_gf_dot_prod(void *_ctx)
+{
+	struct gf_dot_prod_ctx *ctx = _ctx;
+
+	ctx->cb_fn(ctx->cb_arg, 0);
+
+	free(ctx);
+}
+
+int
+spdk_accel_submit_gf_dot_prod(struct spdk_io_channel *ch, void **dsts, uint32_t ndsts,
+			      void **sources, uint32_t nsrcs, const uint8_t *coefs, uint64_t nbytes,
+			      spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct gf_dot_prod_ctx *ctx;
+
+	ctx = malloc(sizeof(*ctx));
+	SPDK_CU_ASSERT_FATAL(ctx != NULL);
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+	SPDK_CU_ASSERT_FATAL(spdk_gf_dot_prod(dsts, ndsts, sources, nsrcs, coefs, nbytes) == 0);
+
+	spdk_thread_send_msg(spdk_get_thread(), finish_gf_dot_prod, ctx);
+
+	return 0;
+}
+
+static void
+init_accel(void)
+{
+	spdk_io_device_register(g_accel_p, accel_channel_create, accel_channel_destroy,
+				sizeof(int), "accel_p");
+}
+
+static void
+fini_accel(void)
+{
+	spdk_io_device_unregister(g_accel_p, NULL);
+}
+
+static int
+test_suite_init(void)
+{
+	uint8_t num_base_bdevs_values[] = { 4, 5, 6 };
+	uint64_t base_bdev_blockcnt_values[] = { 1, 1024, 1024 * 1024 };
+	uint32_t base_bdev_blocklen_values[] = { 512, 4096 };
+	uint32_t strip_size_kb_values[] = { 1, 4, 16 };
+	enum raid_params_md_type md_type_values[] = { RAID_PARAMS_MD_NONE, RAID_PARAMS_MD_SEPARATE, RAID_PARAMS_MD_INTERLEAVED };
+	uint8_t *num_base_bdevs;
+	uint64_t *base_bdev_blockcnt;
+	uint32_t *base_bdev_blocklen;
+	uint32_t *strip_size_kb;
+	enum raid_params_md_type *md_type;
+	uint64_t params_count;
+	int rc;
+
+	params_count = SPDK_COUNTOF(num_base_bdevs_values) *
+		       SPDK_COUNTOF(base_bdev_blockcnt_values) *
+		       SPDK_COUNTOF(base_bdev_blocklen_values) *
+		       SPDK_COUNTOF(strip_size_kb_values) *
+		       SPDK_COUNTOF(md_type_values);
+	rc = raid_test_params_alloc(params_count);
+	if (rc) {
+		return rc;
+	}
+
+	ARRAY_FOR_EACH(num_base_bdevs_values, num_base_bdevs) {
+		ARRAY_FOR_EACH(base_bdev_blockcnt_values, base_bdev_blockcnt) {
+			ARRAY_FOR_EACH(base_bdev_blocklen_values, base_bdev_blocklen) {
+				ARRAY_FOR_EACH(strip_size_kb_values, strip_size_kb) {
+					ARRAY_FOR_EACH(md_type_values, md_type) {
+						struct raid_params params = {
+							.num_base_bdevs = *num_base_bdevs,
+							.base_bdev_blockcnt = *base_bdev_blockcnt,
+							.base_bdev_blocklen = *base_bdev_blocklen,
+							.strip_size = *strip_size_kb * 1024 / *base_bdev_blocklen,
+							.md_type = *md_type,
+						};
+						if (params.strip_size == 0 ||
+						    params.strip_size > params.base_bdev_blockcnt) {
+							continue;
+						}
+						raid_test_params_add(&params);
+					}
+				}
+			}
+		}
+	}
+
+	init_accel();
+
+	return 0;
+}
+
+static int
+test_suite_cleanup(void)
+{
+	fini_accel();
+	raid_test_params_free();
+	return 0;
+}
+
+static struct raid6f_info *
+create_raid6f(struct raid_params *params)
+{
+	struct raid_bdev *raid_bdev = raid_test_create_raid_bdev(params, &g_raid6f_module);
+
+	SPDK_CU_ASSERT_FATAL(raid6f_start(raid_bdev) == 0);
+
+	return raid_bdev->module_private;
+}
+
+static void
+delete_raid6f(struct raid6f_info *r6f_info)
+{
+	struct raid_bdev *raid_bdev = r6f_info->raid_bdev;
+
+	raid6f_stop(raid_bdev);
+
+	raid_test_delete_raid_bdev(raid_bdev);
+}
+
+static void
+test_raid6f_start(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct raid6f_info *r6f_info;
+
+		r6f_info = create_raid6f(params);
+
+		SPDK_CU_ASSERT_FATAL(r6f_info != NULL);
+
+		CU_ASSERT_EQUAL(r6f_info->stripe_blocks, params->strip_size * (params->num_base_bdevs - 2));
+		CU_ASSERT_EQUAL(r6f_info->total_stripes, params->base_bdev_blockcnt / params->strip_size);
+		CU_ASSERT_EQUAL(r6f_info->raid_bdev->bdev.blockcnt,
+				(params->base_bdev_blockcnt - params->base_bdev_blockcnt % params->strip_size) *
+				(params->num_base_bdevs - 2));
+		CU_ASSERT_EQUAL(r6f_info->raid_bdev->bdev.optimal_io_boundary, params->strip_size);
+		CU_ASSERT_TRUE(r6f_info->raid_bdev->bdev.split_on_optimal_io_boundary);
+		CU_ASSERT_EQUAL(r6f_info->raid_bdev->bdev.write_unit_size, r6f_info->stripe_blocks);
+		CU_ASSERT_TRUE(r6f_info->raid_bdev->bdev.split_on_write_unit);
+
+		delete_raid6f(r6f_info);
+	}
+}
+
+static void
+test_raid6f_stripe_layout(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct raid6f_info *r6f_info = create_raid6f(params);
+		struct raid_bdev *raid_bdev = r6f_info->raid_bdev;
+		uint64_t stripe_index;
+
+		for (stripe_index = 0; stripe_index < 2 * raid_bdev->num_base_bdevs; stripe_index++) {
+			uint8_t p_idx = raid6f_stripe_p_chunk_index(raid_bdev, stripe_index);
+			uint8_t q_idx = raid6f_stripe_q_chunk_index(raid_bdev, stripe_index);
+			uint8_t used[8] = {};
+			uint8_t i, idx;
+
+			CU_ASSERT(p_idx != q_idx);
+			used[p_idx]++;
+			used[q_idx]++;
+
+			for (i = 0; i < raid6f_stripe_data_chunks_num(raid_bdev); i++) {
+				idx = raid6f_stripe_data_chunk_index(raid_bdev, stripe_index, i);
+				SPDK_CU_ASSERT_FATAL(idx < raid_bdev->num_base_bdevs);
+				used[idx]++;
+			}
+
+			for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+				CU_ASSERT(used[i] == 1);
+			}
+		}
+
+		delete_raid6f(r6f_info);
+	}
+}
+
+/* Contents of the base bdevs */
+static struct {
+	void **bufs;
+	void **md_bufs;
+	uint64_t num_blocks;
+} g_base_bdevs_data;
+
+enum test_bdev_error_type {
+	TEST_BDEV_ERROR_NONE,
+	TEST_BDEV_ERROR_SUBMIT,
+	TEST_BDEV_ERROR_COMPLETE,
+	TEST_BDEV_ERROR_NOMEM,
+};
+
+static struct {
+	enum test_bdev_error_type type;
+	struct spdk_bdev *bdev;
+} g_error;
+
+static TAILQ_HEAD(, spdk_bdev_io) g_bdev_io_queue = TAILQ_HEAD_INITIALIZER(g_bdev_io_queue);
+static TAILQ_HEAD(, spdk_bdev_io_wait_entry) g_bdev_io_wait_queue = TAILQ_HEAD_INITIALIZER(
+			g_bdev_io_wait_queue);
+static enum spdk_bdev_io_status g_io_status;
+static int g_process_status;
+
+void
+raid_bdev_queue_io_wait(struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
+			struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn)
+{
+	raid_io->waitq_entry.bdev = bdev;
+	raid_io->waitq_entry.cb_fn = cb_fn;
+	raid_io->waitq_entry.cb_arg = raid_io;
+	TAILQ_INSERT_TAIL(&g_bdev_io_wait_queue, &raid_io->waitq_entry, link);
+}
+
+void
+raid_test_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	g_io_status = status;
+}
+
+void
+raid_bdev_io_init(struct raid_bdev_io *raid_io, struct raid_bdev_io_channel *raid_ch,
+		  enum spdk_bdev_io_type type, uint64_t offset_blocks,
+		  uint64_t num_blocks, struct iovec *iovs, int iovcnt, void *md_buf,
+		  struct spdk_memory_domain *memory_domain, void *memory_domain_ctx)
+{
+	raid_test_bdev_io_init(raid_io, raid_io->raid_bdev, raid_ch, type, offset_blocks, num_blocks,
+			       iovs, iovcnt, md_buf);
+}
+
+void
+raid_bdev_process_request_complete(struct raid_bdev_process_request *process_req, int status)
+{
+	g_process_status = status;
+}
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io);
+}
+
+static int
+submit_io(struct spdk_bdev_desc *desc, bool write, struct iovec *iov, int iovcnt, void *md_buf,
+	  uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct spdk_bdev *bdev = desc->bdev;
+	struct raid_base_bdev_info *base_info = bdev->ctxt;
+	struct raid_bdev *raid_bdev = base_info->raid_bdev;
+	uint8_t idx = base_info - raid_bdev->base_bdev_info;
+	struct spdk_bdev_io *bdev_io;
+	struct iovec data;
+
+	if (bdev == g_error.bdev) {
+		if (g_error.type == TEST_BDEV_ERROR_SUBMIT) {
+			return -EINVAL;
+		} else if (g_error.type == TEST_BDEV_ERROR_NOMEM) {
+			return -ENOMEM;
+		}
+	}
+
+	SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= g_base_bdevs_data.num_blocks);
+	data.iov_base = g_base_bdevs_data.bufs[idx] + offset_blocks * bdev->blocklen;
+	data.iov_len = num_blocks * bdev->blocklen;
+
+	if (write) {
+		CU_ASSERT(spdk_iovcpy(iov, iovcnt, &data, 1) == data.iov_len);
+		if (md_buf != NULL) {
+			memcpy(g_base_bdevs_data.md_bufs[idx] + offset_blocks * bdev->md_len, md_buf,
+			       num_blocks * bdev->md_len);
+		}
+	} else {
+		CU_ASSERT(spdk_iovcpy(&data, 1, iov, iovcnt) == data.iov_len);
+		if (md_buf != NULL) {
+			memcpy(md_buf, g_base_bdevs_data.md_bufs[idx] + offset_blocks * bdev->md_len,
+			       num_blocks * bdev->md_len);
+		}
+	}
+
+	bdev_io = calloc(1, sizeof(*bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = bdev;
+	bdev_io->internal.cb = cb;
+	bdev_io->internal.caller_ctx = cb_arg;
+
+	TAILQ_INSERT_TAIL(&g_bdev_io_queue, bdev_io, internal.link);
+
+	return 0;
+}
+
+int
+spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			    struct iovec *iov, int iovcnt, uint64_t offset_blocks,
+			    uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
+			    struct spdk_bdev_ext_io_opts *opts)
+{
+	CU_ASSERT_PTR_NULL(opts->memory_domain);
+	CU_ASSERT_PTR_NULL(opts->memory_domain_ctx);
+
+	return submit_io(desc, true, iov, iovcnt, opts->metadata, offset_blocks, num_blocks, cb,
+			 cb_arg);
+}
+
+int
+spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			   struct iovec *iov, int iovcnt, uint64_t offset_blocks,
+			   uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
+			   struct spdk_bdev_ext_io_opts *opts)
+{
+	CU_ASSERT_PTR_NULL(opts->memory_domain);
+	CU_ASSERT_PTR_NULL(opts->memory_domain_ctx);
+
+	return submit_io(desc, false, iov, iovcnt, opts->metadata, offset_blocks, num_blocks, cb,
+			 cb_arg);
+}
+
+static void
+process_io_completions(void)
+{
+	struct spdk_bdev_io *bdev_io;
+	bool success;
+
+	do {
+		poll_threads();
+
+		while ((bdev_io = TAILQ_FIRST(&g_bdev_io_queue))) {
+			TAILQ_REMOVE(&g_bdev_io_queue, bdev_io, internal.link);
+
+			success = !(g_error.type == TEST_BDEV_ERROR_COMPLETE && g_error.bdev == bdev_io->bdev);
+
+			bdev_io->internal.cb(bdev_io, success, bdev_io->internal.caller_ctx);
+		}
+
+		if (g_error.type == TEST_BDEV_ERROR_NOMEM) {
+			struct spdk_bdev_io_wait_entry *waitq_entry, *tmp;
+
+			g_error.type = TEST_BDEV_ERROR_NONE;
+
+			TAILQ_FOREACH_SAFE(waitq_entry, &g_bdev_io_wait_queue, link, tmp) {
+				TAILQ_REMOVE(&g_bdev_io_wait_queue, waitq_entry, link);
+				CU_ASSERT(waitq_entry->bdev == g_error.bdev);
+				waitq_entry->cb_fn(waitq_entry->cb_arg);
+			}
+		}
+
+		poll_threads();
+	} while (!TAILQ_EMPTY(&g_bdev_io_queue));
+
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_io_wait_queue));
+}
+
+static inline size_t
+strip_md_len(struct raid_bdev *raid_bdev)
+{
+	return raid_bdev->bdev.md_interleave ? 0 : raid_bdev->strip_size * raid_bdev->bdev.md_len;
+}
+
+/* Calculates the P or Q parity of a stripe in the base bdevs data */
+static void
+calc_parity(struct raid_bdev *raid_bdev, void **bufs, size_t offset, size_t len, uint64_t stripe_index,
+	    bool q, void *parity)
+{
+	uint8_t i;
+	size_t b;
+
+	memset(parity, 0, len);
+
+	for (i = 0; i < raid6f_stripe_data_chunks_num(raid_bdev); i++) {
+		uint8_t idx = raid6f_stripe_data_chunk_index(raid_bdev, stripe_index, i);
+		uint8_t coef = q ? spdk_gf_pow2(i) : 1;
+		uint8_t *data = bufs[idx] + offset;
+
+		for (b = 0; b < len; b++) {
+			((uint8_t *)parity)[b] ^= spdk_gf_mul(coef, data[b]);
+		}
+	}
+}
+
+static void
+init_base_bdevs_data(struct raid_bdev *raid_bdev, uint64_t num_stripes)
+{
+	size_t strip_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	size_t md_len = strip_md_len(raid_bdev);
+	uint64_t stripe_index;
+	uint8_t p_idx, q_idx;
+	uint8_t i;
+	size_t j;
+
+	g_base_bdevs_data.num_blocks = num_stripes * raid_bdev->strip_size;
+	g_base_bdevs_data.bufs = calloc(raid_bdev->num_base_bdevs, sizeof(void *));
+	SPDK_CU_ASSERT_FATAL(g_base_bdevs_data.bufs != NULL);
+	g_base_bdevs_data.md_bufs = calloc(raid_bdev->num_base_bdevs, sizeof(void *));
+	SPDK_CU_ASSERT_FATAL(g_base_bdevs_data.md_bufs != NULL);
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		g_base_bdevs_data.bufs[i] = malloc(num_stripes * strip_len);
+		SPDK_CU_ASSERT_FATAL(g_base_bdevs_data.bufs[i] != NULL);
+		for (j = 0; j < num_stripes * strip_len; j++) {
+			((uint8_t *)g_base_bdevs_data.bufs[i])[j] = rand();
+		}
+
+		if (md_len != 0) {
+			g_base_bdevs_data.md_bufs[i] = malloc(num_stripes * md_len);
+			SPDK_CU_ASSERT_FATAL(g_base_bdevs_data.md_bufs[i] != NULL);
+			for (j = 0; j < num_stripes * md_len; j++) {
+				((uint8_t *)g_base_bdevs_data.md_bufs[i])[j] = rand();
+			}
+		}
+	}
+
+	/* Make the parity consistent with the data */
+	for (stripe_index = 0; stripe_index < num_stripes; stripe_index++) {
+		p_idx = raid6f_stripe_p_chunk_index(raid_bdev, stripe_index);
+		q_idx = raid6f_stripe_q_chunk_index(raid_bdev, stripe_index);
+
+		calc_parity(raid_bdev, g_base_bdevs_data.bufs, stripe_index * strip_len, strip_len,
+			    stripe_index, false, g_base_bdevs_data.bufs[p_idx] + stripe_index * strip_len);
+		calc_parity(raid_bdev, g_base_bdevs_data.bufs, stripe_index * strip_len, strip_len,
+			    stripe_index, true, g_base_bdevs_data.bufs[q_idx] + stripe_index * strip_len);
+		if (md_len != 0) {
+			calc_parity(raid_bdev, g_base_bdevs_data.md_bufs, stripe_index * md_len, md_len,
+				    stripe_index, false, g_base_bdevs_data.md_bufs[p_idx] + stripe_index * md_len);
+			calc_parity(raid_bdev, g_base_bdevs_data.md_bufs, stripe_index * md_len, md_len,
+				    stripe_index, true, g_base_bdevs_data.md_bufs[q_idx] + stripe_index * md_len);
+		}
+	}
+}
+
+static void
+deinit_base_bdevs_data(struct raid_bdev *raid_bdev)
+{
+	uint8_t i;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		free(g_base_bdevs_data.bufs[i]);
+		free(g_base_bdevs_data.md_bufs[i]);
+	}
+	free(g_base_bdevs_data.bufs);
+	free(g_base_bdevs_data.md_bufs);
+	memset(&g_base_bdevs_data, 0, sizeof(g_base_bdevs_data));
+}
+
+/* Splits a buffer into a few iovecs of different lengths */
+static int
+setup_iovs(struct iovec *iovs, void *buf, size_t len)
+{
+	iovs[0].iov_base = buf;
+	iovs[0].iov_len = len / 3;
+	iovs[1].iov_base = buf + iovs[0].iov_len;
+	iovs[1].iov_len = len / 2;
+	iovs[2].iov_base = buf + iovs[0].iov_len + iovs[1].iov_len;
+	iovs[2].iov_len = len - iovs[0].iov_len - iovs[1].iov_len;
+
+	return iovs[2].iov_len == len ? 1 : 3;
+}
+
+static int
+submit_rw_request(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch,
+		  enum spdk_bdev_io_type io_type, uint64_t offset_blocks, uint64_t num_blocks,
+		  void *buf, void *md_buf)
+{
+	struct raid_bdev_io raid_io;
+	struct iovec iovs[3];
+	int iovcnt;
+
+	iovcnt = setup_iovs(iovs, buf, num_blocks * raid_bdev->bdev.blocklen);
+
+	raid_test_bdev_io_init(&raid_io, raid_bdev, raid_ch, io_type, offset_blocks, num_blocks,
+			       iovs, iovcnt, md_buf);
+
+	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+
+	raid6f_submit_rw_request(&raid_io);
+
+	process_io_completions();
+
+	CU_ASSERT(g_io_status != SPDK_BDEV_IO_STATUS_PENDING);
+
+	return g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS ? 0 : -EIO;
+}
+
+static void
+run_for_each_raid6f_config(void (*test_fn)(struct raid_bdev *raid_bdev,
+			   struct raid_bdev_io_channel *raid_ch))
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct raid6f_info *r6f_info;
+		struct raid_bdev_io_channel *raid_ch;
+
+		r6f_info = create_raid6f(params);
+		raid_ch = raid_test_create_io_channel(r6f_info->raid_bdev);
+
+		/* Only the stripes used by the tests are kept in memory */
+		init_base_bdevs_data(r6f_info->raid_bdev, spdk_min(r6f_info->total_stripes,
+				     r6f_info->raid_bdev->num_base_bdevs));
+
+		test_fn(r6f_info->raid_bdev, raid_ch);
+
+		deinit_base_bdevs_data(r6f_info->raid_bdev);
+		raid_test_destroy_io_channel(raid_ch);
+		delete_raid6f(r6f_info);
+	}
+}
+
+#define RAID6F_TEST_FOR_EACH_STRIPE(raid_bdev, i) \
+	for (i = 0; i < spdk_min(raid_bdev->num_base_bdevs, ((struct raid6f_info *)raid_bdev->module_private)->total_stripes); i++)
+
+/* Iterates over all combinations of up to 2 missing base bdevs */
+#define RAID6F_TEST_FOR_EACH_MISSING(raid_bdev, m1, m2) \
+	for (m1 = -1; m1 < (int)raid_bdev->num_base_bdevs; m1++) \
+		for (m2 = m1 == -1 ? -1 : m1 + 1; m2 < (int)raid_bdev->num_base_bdevs; m2++)
+
+static void
+set_missing(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch, int m1, int m2)
+{
+	uint8_t i;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		raid_ch->_base_channels[i] = (i == m1 || i == m2) ? NULL : (void *)1;
+	}
+}
+
+static void
+read_and_verify(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch,
+		uint64_t stripe_index, uint8_t chunk_data_idx, uint64_t chunk_offset, uint64_t num_blocks)
+{
+	struct raid6f_info *r6f_info = raid_bdev->module_private;
+	uint8_t idx = raid6f_stripe_data_chunk_index(raid_bdev, stripe_index, chunk_data_idx);
+	uint32_t md_len = raid_bdev->bdev.md_interleave ? 0 : raid_bdev->bdev.md_len;
+	uint64_t base_offset = stripe_index * raid_bdev->strip_size + chunk_offset;
+	size_t len = num_blocks * raid_bdev->bdev.blocklen;
+	void *buf, *md_buf = NULL;
+	int ret;
+
+	buf = malloc(len);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	memset(buf, 0xcd, len);
+	if (md_len != 0) {
+		md_buf = malloc(num_blocks * md_len);
+		SPDK_CU_ASSERT_FATAL(md_buf != NULL);
+		memset(md_buf, 0xcd, num_blocks * md_len);
+	}
+
+	ret = submit_rw_request(raid_bdev, raid_ch, SPDK_BDEV_IO_TYPE_READ,
+				stripe_index * r6f_info->stripe_blocks +
+				chunk_data_idx * raid_bdev->strip_size + chunk_offset,
+				num_blocks, buf, md_buf);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(buf, g_base_bdevs_data.bufs[idx] + base_offset * raid_bdev->bdev.blocklen,
+			 len) == 0);
+	if (md_len != 0) {
+		CU_ASSERT(memcmp(md_buf, g_base_bdevs_data.md_bufs[idx] + base_offset * md_len,
+				 num_blocks * md_len) == 0);
+	}
+
+	free(buf);
+	free(md_buf);
+}
+
+static void
+__test_raid6f_submit_read_request(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+{
+	uint32_t strip_size = raid_bdev->strip_size;
+	uint64_t stripe_index;
+	uint8_t i;
+	int m1, m2;
+
+	RAID6F_TEST_FOR_EACH_MISSING(raid_bdev, m1, m2) {
+		set_missing(raid_bdev, raid_ch, m1, m2);
+
+		RAID6F_TEST_FOR_EACH_STRIPE(raid_bdev, stripe_index) {
+			for (i = 0; i < raid6f_stripe_data_chunks_num(raid_bdev); i++) {
+				read_and_verify(raid_bdev, raid_ch, stripe_index, i, 0, strip_size);
+				read_and_verify(raid_bdev, raid_ch, stripe_index, i, strip_size - 1, 1);
+				if (strip_size > 2) {
+					read_and_verify(raid_bdev, raid_ch, stripe_index, i, 1, strip_size - 2);
+				}
+			}
+		}
+	}
+}
+static void
+test_raid6f_submit_read_request(void)
+{
+	run_for_each_raid6f_config(__test_raid6f_submit_read_request);
+}
+
+static void
+__test_raid6f_stripe_request_map_iovecs(struct raid_bdev *raid_bdev,
+					struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid6f_io_channel *r6ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	size_t strip_bytes = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	struct raid_bdev_io raid_io = {};
+	struct stripe_request *stripe_req;
+	struct chunk *chunk;
+	struct iovec iovs[] = {
+		{ .iov_base = (void *)0x0ff0000, .iov_len = strip_bytes },
+		{ .iov_base = (void *)0x1ff0000, .iov_len = strip_bytes / 2 },
+		{ .iov_base = (void *)0x2ff0000, .iov_len = strip_bytes * 2 },
+		{ .iov_base = (void *)0x3ff0000, .iov_len = strip_bytes * raid_bdev->num_base_bdevs },
+	};
+	size_t iovcnt = SPDK_COUNTOF(iovs);
+	int ret;
+
+	raid_io.raid_bdev = raid_bdev;
+	raid_io.iovs = iovs;
+	raid_io.iovcnt = iovcnt;
+
+	stripe_req = raid6f_stripe_request_alloc(r6ch, STRIPE_REQ_WRITE);
+	SPDK_CU_ASSERT_FATAL(stripe_req != NULL);
+
+	/* P and Q on the last two chunks */
+	raid6f_stripe_request_init(stripe_req, &raid_io, raid_bdev->num_base_bdevs - 2);
+	CU_ASSERT(stripe_req->p_chunk == &stripe_req->chunks[1]);
+	CU_ASSERT(stripe_req->q_chunk == &stripe_req->chunks[2]);
+	raid6f_stripe_request_init(stripe_req, &raid_io, 0);
+	CU_ASSERT(stripe_req->p_chunk == &stripe_req->chunks[raid_bdev->num_base_bdevs - 1]);
+	CU_ASSERT(stripe_req->q_chunk == &stripe_req->chunks[0]);
+	stripe_req->p_chunk = &stripe_req->chunks[raid_bdev->num_base_bdevs - 2];
+	stripe_req->q_chunk = &stripe_req->chunks[raid_bdev->num_base_bdevs - 1];
+
+	ret = raid6f_stripe_request_map_iovecs(stripe_req);
+	CU_ASSERT(ret == 0);
+
+	chunk = &stripe_req->chunks[0];
+	CU_ASSERT_EQUAL(chunk->iovcnt, 1);
+	CU_ASSERT_EQUAL(chunk->iovs[0].iov_base, iovs[0].iov_base);
+	CU_ASSERT_EQUAL(chunk->iovs[0].iov_len, iovs[0].iov_len);
+
+	chunk = &stripe_req->chunks[1];
+	CU_ASSERT_EQUAL(chunk->iovcnt, 2);
+	CU_ASSERT_EQUAL(chunk->iovs[0].iov_base, iovs[1].iov_base);
+	CU_ASSERT_EQUAL(chunk->iovs[0].iov_len, iovs[1].iov_len);
+	CU_ASSERT_EQUAL(chunk->iovs[1].iov_base, iovs[2].iov_base);
+	CU_ASSERT_EQUAL(chunk->iovs[1].iov_len, iovs[2].iov_len / 4);
+
+	if (raid_bdev->num_base_bdevs > 4) {
+		chunk = &stripe_req->chunks[2];
+		CU_ASSERT_EQUAL(chunk->iovcnt, 1);
+		CU_ASSERT_EQUAL(chunk->iovs[0].iov_base, iovs[2].iov_base + strip_bytes / 2);
+		CU_ASSERT_EQUAL(chunk->iovs[0].iov_len, iovs[2].iov_len / 2);
+	}
+
+	chunk = stripe_req->p_chunk;
+	CU_ASSERT_EQUAL(chunk->iovcnt, 1);
+	CU_ASSERT_EQUAL(chunk->iovs[0].iov_base, stripe_req->write.p_buf);
+	chunk = stripe_req->q_chunk;
+	CU_ASSERT_EQUAL(chunk->iovcnt, 1);
+	CU_ASSERT_EQUAL(chunk->iovs[0].iov_base, stripe_req->write.q_buf);
+
+	raid6f_stripe_request_free(stripe_req);
+}
+static void
+test_raid6f_stripe_request_map_iovecs(void)
+{
+	run_for_each_raid6f_config(__test_raid6f_stripe_request_map_iovecs);
+}
+
+/* Writes a full stripe of new data and verifies the contents of the present base bdevs */
+static void
+write_and_verify(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch,
+		 uint64_t stripe_index)
+{
+	struct raid6f_info *r6f_info = raid_bdev->module_private;
+	size_t strip_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	size_t md_len = strip_md_len(raid_bdev);
+	uint8_t n = raid_bdev->num_base_bdevs;
+	void **bufs, **md_bufs;
+	void *buf, *md_buf = NULL;
+	uint8_t i, idx;
+	size_t j;
+	int ret;
+
+	/* Expected contents of each chunk, only the stripe is used for the parity calculation */
+	bufs = calloc(n, sizeof(void *));
+	md_bufs = calloc(n, sizeof(void *));
+	SPDK_CU_ASSERT_FATAL(bufs != NULL && md_bufs != NULL);
+
+	buf = malloc(r6f_info->stripe_blocks * raid_bdev->bdev.blocklen);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	for (j = 0; j < r6f_info->stripe_blocks * raid_bdev->bdev.blocklen; j++) {
+		((uint8_t *)buf)[j] = rand();
+	}
+	if (md_len != 0) {
+		md_buf = malloc(r6f_info->stripe_blocks * raid_bdev->bdev.md_len);
+		SPDK_CU_ASSERT_FATAL(md_buf != NULL);
+		for (j = 0; j < r6f_info->stripe_blocks * raid_bdev->bdev.md_len; j++) {
+			((uint8_t *)md_buf)[j] = rand();
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		bufs[i] = malloc(strip_len);
+		md_bufs[i] = malloc(spdk_max(md_len, 1));
+		SPDK_CU_ASSERT_FATAL(bufs[i] != NULL && md_bufs[i] != NULL);
+	}
+
+	for (i = 0; i < raid6f_stripe_data_chunks_num(raid_bdev); i++) {
+		idx = raid6f_stripe_data_chunk_index(raid_bdev, stripe_index, i);
+		memcpy(bufs[idx], buf + i * strip_len, strip_len);
+		if (md_len != 0) {
+			memcpy(md_bufs[idx], md_buf + i * md_len, md_len);
+		}
+	}
+	calc_parity(raid_bdev, bufs, 0, strip_len, stripe_index, false,
+		    bufs[raid6f_stripe_p_chunk_index(raid_bdev, stripe_index)]);
+	calc_parity(raid_bdev, bufs, 0, strip_len, stripe_index, true,
+		    bufs[raid6f_stripe_q_chunk_index(raid_bdev, stripe_index)]);
+	if (md_len != 0) {
+		calc_parity(raid_bdev, md_bufs, 0, md_len, stripe_index, false,
+			    md_bufs[raid6f_stripe_p_chunk_index(raid_bdev, stripe_index)]);
+		calc_parity(raid_bdev, md_bufs, 0, md_len, stripe_index, true,
+			    md_bufs[raid6f_stripe_q_chunk_index(raid_bdev, stripe_index)]);
+	}
+
+	ret = submit_rw_request(raid_bdev, raid_ch, SPDK_BDEV_IO_TYPE_WRITE,
+				stripe_index * r6f_info->stripe_blocks, r6f_info->stripe_blocks, buf, md_buf);
+	CU_ASSERT(ret == 0);
+
+	for (i = 0; i < n; i++) {
+		if (raid_bdev_channel_get_base_channel(raid_ch, i) == NULL) {
+			/* Make the missing chunk consistent for the following reads */
+			memcpy(g_base_bdevs_data.bufs[i] + stripe_index * strip_len, bufs[i], strip_len);
+			if (md_len != 0) {
+				memcpy(g_base_bdevs_data.md_bufs[i] + stripe_index * md_len, md_bufs[i], md_len);
+			}
+			continue;
+		}
+		CU_ASSERT(memcmp(g_base_bdevs_data.bufs[i] + stripe_index * strip_len, bufs[i],
+				 strip_len) == 0);
+		if (md_len != 0) {
+			CU_ASSERT(memcmp(g_base_bdevs_data.md_bufs[i] + stripe_index * md_len, md_bufs[i],
+					 md_len) == 0);
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		free(bufs[i]);
+		free(md_bufs[i]);
+	}
+	free(bufs);
+	free(md_bufs);
+	free(buf);
+	free(md_buf);
+}
+
+static void
+__test_raid6f_submit_full_stripe_write_request(struct raid_bdev *raid_bdev,
+		struct raid_bdev_io_channel *raid_ch)
+{
+	uint64_t stripe_index;
+	int m1, m2;
+
+	RAID6F_TEST_FOR_EACH_MISSING(raid_bdev, m1, m2) {
+		set_missing(raid_bdev, raid_ch, m1, m2);
+
+		RAID6F_TEST_FOR_EACH_STRIPE(raid_bdev, stripe_index) {
+			write_and_verify(raid_bdev, raid_ch, stripe_index);
+		}
+	}
+}
+static void
+test_raid6f_submit_full_stripe_write_request(void)
+{
+	run_for_each_raid6f_config(__test_raid6f_submit_full_stripe_write_request);
+}
+
+static void
+__test_raid6f_chunk_write_error(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid6f_info *r6f_info = raid_bdev->module_private;
+	struct raid_base_bdev_info *base_bdev_info;
+	uint64_t stripe_index;
+	enum test_bdev_error_type error_type;
+	void *buf, *md_buf = NULL;
+	int ret;
+
+	buf = calloc(r6f_info->stripe_blocks, raid_bdev->bdev.blocklen);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	if (strip_md_len(raid_bdev) != 0) {
+		md_buf = calloc(r6f_info->stripe_blocks, raid_bdev->bdev.md_len);
+		SPDK_CU_ASSERT_FATAL(md_buf != NULL);
+	}
+
+	for (error_type = TEST_BDEV_ERROR_SUBMIT; error_type <= TEST_BDEV_ERROR_NOMEM; error_type++) {
+		RAID6F_TEST_FOR_EACH_STRIPE(raid_bdev, stripe_index) {
+			RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_bdev_info) {
+				g_error.type = error_type;
+				g_error.bdev = base_bdev_info->desc->bdev;
+
+				ret = submit_rw_request(raid_bdev, raid_ch, SPDK_BDEV_IO_TYPE_WRITE,
+							stripe_index * r6f_info->stripe_blocks,
+							r6f_info->stripe_blocks, buf, md_buf);
+				if (error_type == TEST_BDEV_ERROR_NOMEM) {
+					CU_ASSERT(ret == 0);
+				} else {
+					CU_ASSERT(ret != 0);
+				}
+
+				memset(&g_error, 0, sizeof(g_error));
+			}
+		}
+	}
+
+	free(buf);
+	free(md_buf);
+}
+static void
+test_raid6f_chunk_write_error(void)
+{
+	run_for_each_raid6f_config(__test_raid6f_chunk_write_error);
+}
+
+static void
+__test_raid6f_chunk_read_error(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid6f_io_channel *r6ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	uint32_t md_len = raid_bdev->bdev.md_interleave ? 0 : raid_bdev->bdev.md_len;
+	struct stripe_request *stripe_req;
+	enum test_bdev_error_type error_type;
+	void *buf, *md_buf = NULL;
+	uint8_t i;
+	int ret;
+
+	buf = calloc(raid_bdev->strip_size, raid_bdev->bdev.blocklen);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	if (md_len != 0) {
+		md_buf = calloc(raid_bdev->strip_size, md_len);
+		SPDK_CU_ASSERT_FATAL(md_buf != NULL);
+	}
+
+	/*
+	 * The first data chunk of stripe 0 and the P parity are missing, so all the other chunks
+	 * are needed for the reconstruction and an error on any of them fails the read.
+	 */
+	set_missing(raid_bdev, raid_ch, raid6f_stripe_data_chunk_index(raid_bdev, 0, 0),
+		    raid6f_stripe_p_chunk_index(raid_bdev, 0));
+
+	for (error_type = TEST_BDEV_ERROR_SUBMIT; error_type <= TEST_BDEV_ERROR_NOMEM; error_type++) {
+		for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+			if (raid_bdev_channel_get_base_channel(raid_ch, i) == NULL) {
+				continue;
+			}
+
+			g_error.type = error_type;
+			g_error.bdev = raid_bdev->base_bdev_info[i].desc->bdev;
+
+			ret = submit_rw_request(raid_bdev, raid_ch, SPDK_BDEV_IO_TYPE_READ, 0,
+						raid_bdev->strip_size, buf, md_buf);
+			if (error_type == TEST_BDEV_ERROR_NOMEM) {
+				CU_ASSERT(ret == 0);
+			} else {
+				CU_ASSERT(ret != 0);
+			}
+
+			memset(&g_error, 0, sizeof(g_error));
+		}
+	}
+
+	/* Too many missing base bdevs */
+	raid_ch->_base_channels[raid6f_stripe_data_chunk_index(raid_bdev, 0, 1)] = NULL;
+	ret = submit_rw_request(raid_bdev, raid_ch, SPDK_BDEV_IO_TYPE_READ, 0,
+				raid_bdev->strip_size, buf, md_buf);
+	CU_ASSERT(ret != 0);
+
+	/* All stripe requests are back on the free list */
+	i = 0;
+	TAILQ_FOREACH(stripe_req, &r6ch->free_stripe_requests.reconstruct, link) {
+		i++;
+	}
+	CU_ASSERT(i == RAID6F_MAX_STRIPES);
+
+	free(buf);
+	free(md_buf);
+}
+static void
+test_raid6f_chunk_read_error(void)
+{
+	run_for_each_raid6f_config(__test_raid6f_chunk_read_error);
+}
+
+static struct raid_bdev_io_channel *g_process_raid_ch_template;
+
+static int
+process_raid_ch_create(void *io_device, void *ctx_buf)
+{
+	memcpy(ctx_buf, g_process_raid_ch_template, sizeof(struct raid_bdev_io_channel));
+
+	return 0;
+}
+
+static void
+process_raid_ch_destroy(void *io_device, void *ctx_buf)
+{
+}
+
+static void
+__test_raid6f_submit_process_request(struct raid_bdev *raid_bdev,
+				     struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid6f_info *r6f_info = raid_bdev->module_private;
+	size_t strip_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	size_t md_len = strip_md_len(raid_bdev);
+	struct raid_bdev_process_request process_req = {};
+	struct spdk_io_channel *ch;
+	void *expected, *expected_md = NULL;
+	uint64_t stripe_index;
+	uint8_t target;
+	int other;
+	int ret;
+
+	/* The module gets the raid bdev from the channel, it has to be a real one */
+	g_process_raid_ch_template = raid_ch;
+	spdk_io_device_register(raid_bdev, process_raid_ch_create, process_raid_ch_destroy,
+				sizeof(struct raid_bdev_io_channel), NULL);
+	ch = spdk_get_io_channel(raid_bdev);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	process_req.iov.iov_base = malloc(strip_len);
+	process_req.iov.iov_len = strip_len;
+	SPDK_CU_ASSERT_FATAL(process_req.iov.iov_base != NULL);
+	if (md_len != 0) {
+		process_req.md_buf = malloc(md_len);
+		SPDK_CU_ASSERT_FATAL(process_req.md_buf != NULL);
+		expected_md = malloc(md_len);
+		SPDK_CU_ASSERT_FATAL(expected_md != NULL);
+	}
+	expected = malloc(strip_len);
+	SPDK_CU_ASSERT_FATAL(expected != NULL);
+
+	for (target = 0; target < raid_bdev->num_base_bdevs; target++) {
+		for (other = -1; other < (int)raid_bdev->num_base_bdevs; other++) {
+			if (other == target) {
+				continue;
+			}
+
+			/* The target is not readable, another base bdev can be missing too */
+			set_missing(raid_bdev, raid_ch, target, other);
+			raid_ch->_base_channels[target] = (void *)1;
+
+			RAID6F_TEST_FOR_EACH_STRIPE(raid_bdev, stripe_index) {
+				void *target_buf = g_base_bdevs_data.bufs[target] + stripe_index * strip_len;
+				void *target_md_buf = md_len ? g_base_bdevs_data.md_bufs[target] + stripe_index * md_len : NULL;
+
+				memcpy(expected, target_buf, strip_len);
+				memset(target_buf, 0xab, strip_len);
+				if (md_len != 0) {
+					memcpy(expected_md, target_md_buf, md_len);
+					memset(target_md_buf, 0xab, md_len);
+				}
+
+				process_req.target = &raid_bdev->base_bdev_info[target];
+				process_req.target_ch = (void *)1;
+				process_req.offset_blocks = stripe_index * r6f_info->stripe_blocks;
+				process_req.num_blocks = r6f_info->stripe_blocks;
+				process_req.raid_io.raid_bdev = raid_bdev;
+				g_process_status = 1;
+
+				ret = raid6f_submit_process_request(&process_req, spdk_io_channel_get_ctx(ch));
+				CU_ASSERT(ret == (int)r6f_info->stripe_blocks);
+
+				process_io_completions();
+
+				CU_ASSERT(g_process_status == 0);
+				CU_ASSERT(memcmp(target_buf, expected, strip_len) == 0);
+				if (md_len != 0) {
+					CU_ASSERT(memcmp(target_md_buf, expected_md, md_len) == 0);
+				}
+			}
+		}
+	}
+
+	free(process_req.iov.iov_base);
+	free(process_req.md_buf);
+	free(expected);
+	free(expected_md);
+
+	spdk_put_io_channel(ch);
+	spdk_io_device_unregister(raid_bdev, NULL);
+	poll_threads();
+}
+static void
+test_raid6f_submit_process_request(void)
+{
+	run_for_each_raid6f_config(__test_raid6f_submit_process_request);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("raid6f", test_suite_init, test_suite_cleanup);
+	CU_ADD_TEST(suite, test_raid6f_start);
+	CU_ADD_TEST(suite, test_raid6f_stripe_layout);
+	CU_ADD_TEST(suite, test_raid6f_submit_read_request);
+	CU_ADD_TEST(suite, test_raid6f_stripe_request_map_iovecs);
+	CU_ADD_TEST(suite, test_raid6f_submit_full_stripe_write_request);
+	CU_ADD_TEST(suite, test_raid6f_chunk_write_error);
+	CU_ADD_TEST(suite, test_raid6f_chunk_read_error);
+	CU_ADD_TEST(suite, test_raid6f_submit_process_request);
+
+	allocate_threads(1);
+	set_thread(0);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	free_threads();
+
+	return num_failures;
+}
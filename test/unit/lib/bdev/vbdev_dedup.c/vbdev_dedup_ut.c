@@ -0,0 +1,833 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk/crc32.h"
+#include "spdk_internal/mock.h"
+#include "thread/thread_internal.h"
+#include "common/lib/test_env.c"
+#include "bdev/dedup/vbdev_dedup.c"
+
+#define BLOCK_SIZE 512
+#define CHUNK_BLOCKS 8
+#define CHUNK_SIZE (CHUNK_BLOCKS * BLOCK_SIZE)
+#define NUM_LCHUNKS 32
+#define DEDUP_BLOCK_CNT (NUM_LCHUNKS * CHUNK_BLOCKS)
+/* Three blocks of metadata, padded to one chunk, then the physical chunks */
+#define NUM_PCHUNKS 8
+#define BASE_BLOCK_CNT (CHUNK_BLOCKS * (NUM_PCHUNKS + 1))
+
+#define UT_BDEV_MODULE (&dedup_if)
+#define UT_POLL_US VBDEV_DEDUP_POLL_US
+#define UT_BLOCK_SIZE BLOCK_SIZE
+#define UT_MODEL_BLOCKS DEDUP_BLOCK_CNT
+#include "common/lib/bdev/ut_base_bdev.c"
+
+struct ut_accel_task {
+	spdk_accel_completion_cb	cb_fn;
+	void				*cb_arg;
+	int				status;
+};
+
+static int g_accel_io_device;
+static int g_create_rc;
+/* Give every chunk the same CRC-32C */
+static bool g_crc_collide;
+
+struct spdk_io_channel *
+spdk_accel_get_io_channel(void)
+{
+	return spdk_get_io_channel(&g_accel_io_device);
+}
+
+static void
+ut_accel_done(void *ctx)
+{
+	struct ut_accel_task *task = ctx;
+
+	task->cb_fn(task->cb_arg, task->status);
+	free(task);
+}
+
+/* The accel operations complete asynchronously, like the real ones. */
+static int
+ut_accel_complete(spdk_accel_completion_cb cb_fn, void *cb_arg, int status)
+{
+	struct ut_accel_task *task;
+
+	task = calloc(1, sizeof(*task));
+	SPDK_CU_ASSERT_FATAL(task != NULL);
+	task->cb_fn = cb_fn;
+	task->cb_arg = cb_arg;
+	task->status = status;
+
+	return spdk_thread_send_msg(spdk_get_thread(), ut_accel_done, task);
+}
+
+static uint32_t
+ut_crc32c(const void *buf, size_t len)
+{
+	if (g_crc_collide) {
+		return 0x5a5a5a5a;
+	}
+
+	return spdk_crc32c_update(buf, len, ~0u) ^ ~0u;
+}
+
+int
+spdk_accel_submit_crc32c(struct spdk_io_channel *ch, uint32_t *crc_dst, void *src, uint32_t seed,
+			 uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	*crc_dst = ut_crc32c(src, nbytes);
+
+	return ut_accel_complete(cb_fn, cb_arg, 0);
+}
+
+int
+spdk_accel_submit_copy_crc32cv(struct spdk_io_channel *ch, void *dst, struct iovec *src_iovs,
+			       uint32_t iovcnt, uint32_t *crc_dst, uint32_t seed,
+			       spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	uint64_t nbytes = 0;
+	uint32_t i;
+
+	for (i = 0; i < iovcnt; i++) {
+		nbytes += src_iovs[i].iov_len;
+	}
+	spdk_copy_iovs_to_buf(dst, nbytes, src_iovs, iovcnt);
+	*crc_dst = ut_crc32c(dst, nbytes);
+
+	return ut_accel_complete(cb_fn, cb_arg, 0);
+}
+
+int
+spdk_accel_submit_compare(struct spdk_io_channel *ch, void *src1, void *src2, uint64_t nbytes,
+			  spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	return ut_accel_complete(cb_fn, cb_arg, memcmp(src1, src2, nbytes));
+}
+
+static int
+ut_find_io(enum spdk_bdev_io_type type)
+{
+	struct ut_io *io;
+	int count = 0;
+
+	TAILQ_FOREACH(io, &g_ios, link) {
+		if (io->type == type) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static struct ut_disk *
+ut_create_base(uint64_t blockcnt)
+{
+	/* A freshly formatted dedup bdev reads as zeroes. */
+	memset(g_model, 0, sizeof(g_model));
+
+	return ut_create_disk("Base0", blockcnt, BLOCK_SIZE);
+}
+
+static void
+ut_create_cb(void *cb_arg, int rc)
+{
+	g_create_rc = rc;
+}
+
+static int
+ut_try_create_dedup(uint32_t chunk_size, uint64_t num_blocks)
+{
+	struct spdk_uuid uuid = {};
+	int rc;
+
+	g_create_rc = 1;
+	rc = bdev_dedup_create_disk("Dedup0", "Base0", &uuid, chunk_size, num_blocks, ut_create_cb,
+				    NULL);
+	if (rc != 0) {
+		return rc;
+	}
+	ut_drain();
+
+	return g_create_rc;
+}
+
+static struct vbdev_dedup *
+ut_create_dedup(void)
+{
+	struct vbdev_dedup *node;
+
+	CU_ASSERT(ut_try_create_dedup(CHUNK_SIZE, DEDUP_BLOCK_CNT) == 0);
+
+	node = TAILQ_FIRST(&g_dedup_nodes);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(!node->loading);
+	CU_ASSERT(node->chunk_blocks == CHUNK_BLOCKS);
+	CU_ASSERT(node->num_lchunks == NUM_LCHUNKS);
+	CU_ASSERT(node->num_pchunks == NUM_PCHUNKS);
+	CU_ASSERT(node->md_blocks == 3);
+	CU_ASSERT(node->data_offset_blocks == CHUNK_BLOCKS);
+	CU_ASSERT(node->dedup_bdev.blockcnt == DEDUP_BLOCK_CNT);
+	CU_ASSERT(node->dedup_bdev.optimal_io_boundary == CHUNK_BLOCKS);
+	CU_ASSERT(node->dedup_bdev.split_on_optimal_io_boundary);
+	CU_ASSERT(spdk_bdev_get_by_name("Dedup0") == &node->dedup_bdev);
+
+	return node;
+}
+
+static void
+ut_delete_cb(void *cb_arg, int bdeverrno)
+{
+	CU_ASSERT(bdeverrno == 0);
+}
+
+static void
+ut_delete_dedup(void)
+{
+	g_destruct_done = false;
+	bdev_dedup_delete_disk("Dedup0", ut_delete_cb, NULL);
+	ut_drain();
+	CU_ASSERT(g_destruct_done);
+	CU_ASSERT(TAILQ_EMPTY(&g_dedup_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	CU_ASSERT(TAILQ_EMPTY(&g_ios));
+}
+
+static struct spdk_bdev_io *
+ut_alloc_io(struct vbdev_dedup *node, struct spdk_io_channel *ch, enum spdk_bdev_io_type type,
+	    uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct dedup_bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = &node->dedup_bdev;
+	bdev_io->type = type;
+	bdev_io->internal.ch = spdk_io_channel_get_ctx(ch);
+	bdev_io->internal.status = SPDK_BDEV_IO_STATUS_PENDING;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+	bdev_io->iov.iov_base = calloc(spdk_max(num_blocks, 1), BLOCK_SIZE);
+	SPDK_CU_ASSERT_FATAL(bdev_io->iov.iov_base != NULL);
+	bdev_io->iov.iov_len = num_blocks * BLOCK_SIZE;
+	bdev_io->u.bdev.iovs = &bdev_io->iov;
+	bdev_io->u.bdev.iovcnt = 1;
+
+	return bdev_io;
+}
+
+static void
+ut_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io->iov.iov_base);
+	free(bdev_io);
+}
+
+static void
+ut_check_done(struct spdk_bdev_io *bdev_io)
+{
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	ut_free_io(bdev_io);
+}
+
+/* Submit a write, each block filled with the pattern plus its index in the write. */
+static struct spdk_bdev_io *
+ut_submit_write(struct vbdev_dedup *node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+		uint64_t num_blocks, uint8_t pattern)
+{
+	struct spdk_bdev_io *bdev_io;
+	uint64_t i;
+
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_WRITE, offset_blocks, num_blocks);
+	for (i = 0; i < num_blocks; i++) {
+		memset((uint8_t *)bdev_io->iov.iov_base + i * BLOCK_SIZE, (uint8_t)(pattern + i),
+		       BLOCK_SIZE);
+	}
+	vbdev_dedup_submit_request(ch, bdev_io);
+
+	return bdev_io;
+}
+
+static void
+ut_model_write(uint64_t offset_blocks, uint64_t num_blocks, uint8_t pattern)
+{
+	uint64_t i;
+
+	for (i = 0; i < num_blocks; i++) {
+		g_model[offset_blocks + i] = pattern ? (uint8_t)(pattern + i) : 0;
+	}
+}
+
+/* Write a range, a 0 pattern writing zeroes. */
+static void
+ut_write(struct vbdev_dedup *node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+	 uint64_t num_blocks, uint8_t pattern)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	if (pattern == 0) {
+		bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_WRITE, offset_blocks, num_blocks);
+		vbdev_dedup_submit_request(ch, bdev_io);
+	} else {
+		bdev_io = ut_submit_write(node, ch, offset_blocks, num_blocks, pattern);
+	}
+	ut_drain();
+	ut_check_done(bdev_io);
+	ut_model_write(offset_blocks, num_blocks, pattern);
+}
+
+static void
+ut_read(struct vbdev_dedup *node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+	uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_READ, offset_blocks, num_blocks);
+	memset(bdev_io->iov.iov_base, 0xff, num_blocks * BLOCK_SIZE);
+	vbdev_dedup_submit_request(ch, bdev_io);
+	ut_drain();
+	CU_ASSERT(ut_check_data(bdev_io->iov.iov_base, offset_blocks, num_blocks));
+	ut_check_done(bdev_io);
+}
+
+/* Check the whole content of the dedup bdev, one chunk at a time. */
+static void
+ut_check_all(struct vbdev_dedup *node, struct spdk_io_channel *ch)
+{
+	uint64_t lchunk;
+
+	for (lchunk = 0; lchunk < NUM_LCHUNKS; lchunk++) {
+		ut_read(node, ch, lchunk * CHUNK_BLOCKS, CHUNK_BLOCKS);
+	}
+}
+
+/* Map entry of a logical chunk as persisted on the base bdev. */
+static uint32_t
+ut_disk_map_get(struct ut_disk *base, uint64_t lchunk)
+{
+	return from_le32(base->data + BLOCK_SIZE + lchunk * sizeof(uint32_t));
+}
+
+static uint64_t
+ut_num_refs(struct vbdev_dedup *node)
+{
+	uint64_t pchunk, refs = 0;
+
+	for (pchunk = 0; pchunk < NUM_PCHUNKS; pchunk++) {
+		refs += node->refcnt[pchunk];
+	}
+
+	return refs;
+}
+
+static void
+test_dedup_create(void)
+{
+	struct spdk_uuid uuid = {};
+	struct ut_disk *base;
+	struct dedup_md_header *hdr;
+	struct vbdev_dedup *node;
+	int rc;
+
+	/* Creation is deferred until the base bdev shows up */
+	g_create_rc = 1;
+	rc = bdev_dedup_create_disk("Dedup0", "Base0", &uuid, CHUNK_SIZE, DEDUP_BLOCK_CNT,
+				    ut_create_cb, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_create_rc == 0);
+	rc = bdev_dedup_create_disk("Dedup0", "Base0", &uuid, CHUNK_SIZE, DEDUP_BLOCK_CNT,
+				    ut_create_cb, NULL);
+	CU_ASSERT(rc == -EEXIST);
+	base = ut_create_base(BASE_BLOCK_CNT);
+	vbdev_dedup_examine(&base->bdev);
+
+	/* The bdev is registered once the metadata is loaded */
+	CU_ASSERT(!TAILQ_EMPTY(&g_dedup_nodes));
+	CU_ASSERT(TAILQ_FIRST(&g_dedup_nodes)->loading);
+	CU_ASSERT(spdk_bdev_get_by_name("Dedup0") == NULL);
+	ut_drain();
+	node = TAILQ_FIRST(&g_dedup_nodes);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(spdk_bdev_get_by_name("Dedup0") == &node->dedup_bdev);
+	CU_ASSERT(base->bdev.internal.claim_type == SPDK_BDEV_CLAIM_EXCL_WRITE);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS);
+	CU_ASSERT(node->free_chunks[NUM_PCHUNKS - 1] == 0);
+
+	/* The base bdev was formatted, with all the chunks reading as zeroes */
+	hdr = (struct dedup_md_header *)base->data;
+	CU_ASSERT(memcmp(hdr->magic, VBDEV_DEDUP_MD_MAGIC, sizeof(hdr->magic)) == 0);
+	CU_ASSERT(from_le64(&hdr->chunk_blocks) == CHUNK_BLOCKS);
+	CU_ASSERT(from_le64(&hdr->num_lchunks) == NUM_LCHUNKS);
+	CU_ASSERT(from_le64(&hdr->num_pchunks) == NUM_PCHUNKS);
+	CU_ASSERT(spdk_mem_all_zero(base->data + BLOCK_SIZE, 2 * BLOCK_SIZE));
+	ut_delete_dedup();
+
+	/* Chunk size not a power of two, or too large */
+	CU_ASSERT(ut_try_create_dedup(CHUNK_SIZE + BLOCK_SIZE, 0) == -EINVAL);
+	CU_ASSERT(ut_try_create_dedup(VBDEV_DEDUP_MAX_CHUNK_SIZE * 2, 0) == -EINVAL);
+
+	/* Base bdev too small for any chunk */
+	CU_ASSERT(ut_try_create_dedup(CHUNK_SIZE * 8, 0) == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_dedup_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	CU_ASSERT(base->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+
+	/* A metadata read error fails the creation */
+	base->hold = true;
+	g_create_rc = 1;
+	rc = bdev_dedup_create_disk("Dedup0", "Base0", &uuid, CHUNK_SIZE, DEDUP_BLOCK_CNT,
+				    ut_create_cb, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_create_rc == 1);
+	SPDK_CU_ASSERT_FATAL(!TAILQ_EMPTY(&g_ios));
+	TAILQ_FIRST(&g_ios)->fail = true;
+	base->hold = false;
+	ut_drain();
+	CU_ASSERT(g_create_rc == -EIO);
+	CU_ASSERT(TAILQ_EMPTY(&g_dedup_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	CU_ASSERT(spdk_bdev_get_by_name("Dedup0") == NULL);
+
+	/* The size defaults to the one of the base bdev, in whole chunks */
+	CU_ASSERT(ut_try_create_dedup(CHUNK_SIZE, 0) == -EINVAL);
+	ut_free_disk(base);
+	base = ut_create_base(BASE_BLOCK_CNT + 3);
+	CU_ASSERT(ut_try_create_dedup(CHUNK_SIZE, 0) == 0);
+	node = TAILQ_FIRST(&g_dedup_nodes);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(node->dedup_bdev.blockcnt == BASE_BLOCK_CNT);
+	CU_ASSERT(node->num_pchunks == NUM_PCHUNKS);
+	ut_delete_dedup();
+	ut_free_disk(base);
+}
+
+static void
+test_dedup_read_write(void)
+{
+	struct ut_disk *base;
+	struct vbdev_dedup *node;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io *bdev_io;
+	uint32_t pchunk;
+
+	base = ut_create_base(BASE_BLOCK_CNT);
+	node = ut_create_dedup();
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* Unmapped chunks read as zeroes without reading the base bdev */
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_READ, 10, 4);
+	vbdev_dedup_submit_request(ch, bdev_io);
+	CU_ASSERT(TAILQ_EMPTY(&g_ios));
+	CU_ASSERT(ut_check_data(bdev_io->iov.iov_base, 10, 4));
+	ut_check_done(bdev_io);
+
+	/* A full chunk is written to the first free chunk and the map persisted */
+	ut_write(node, ch, 0, CHUNK_BLOCKS, 0x10);
+	CU_ASSERT(dedup_map_get(node, 0) == 1);
+	CU_ASSERT(ut_disk_map_get(base, 0) == 1);
+	CU_ASSERT(node->refcnt[0] == 1);
+	CU_ASSERT(node->num_unique_writes == 1);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 1);
+	CU_ASSERT(ut_check_data(base->data + CHUNK_BLOCKS * BLOCK_SIZE, 0, CHUNK_BLOCKS));
+	ut_read(node, ch, 0, CHUNK_BLOCKS);
+	ut_read(node, ch, 3, 2);
+
+	/* A partial write of an unmapped chunk is merged with zeroes */
+	ut_write(node, ch, CHUNK_BLOCKS + 2, 3, 0x20);
+	CU_ASSERT(dedup_map_get(node, 1) == 2);
+	ut_read(node, ch, CHUNK_BLOCKS, CHUNK_BLOCKS);
+
+	/* A partial write of a mapped chunk is merged with its content, in a new chunk */
+	ut_write(node, ch, 5, 2, 0x30);
+	pchunk = dedup_map_get(node, 0);
+	CU_ASSERT(pchunk != 0 && pchunk != 1 && pchunk != 2);
+	CU_ASSERT(ut_disk_map_get(base, 0) == pchunk);
+	ut_read(node, ch, 0, CHUNK_BLOCKS);
+
+	/* The replaced chunk is reused right away since the base bdev has no volatile cache */
+	CU_ASSERT(node->refcnt[0] == 0);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 2);
+	CU_ASSERT(node->free_chunks[node->num_free - 1] == 0);
+
+	/* Zeroes don't use a chunk */
+	ut_write(node, ch, CHUNK_BLOCKS, CHUNK_BLOCKS, 0);
+	CU_ASSERT(dedup_map_get(node, 1) == 0);
+	CU_ASSERT(ut_disk_map_get(base, 1) == 0);
+	CU_ASSERT(node->num_zero_writes == 1);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 1);
+	ut_write(node, ch, 2 * CHUNK_BLOCKS + 1, 1, 0);
+	CU_ASSERT(dedup_map_get(node, 2) == 0);
+	CU_ASSERT(node->num_zero_writes == 2);
+
+	/* A failed data write leaves the chunk as it was */
+	base->fail_write = true;
+	bdev_io = ut_submit_write(node, ch, 3 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x40);
+	ut_drain();
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_FAILED);
+	ut_free_io(bdev_io);
+	CU_ASSERT(dedup_map_get(node, 3) == 0);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 1);
+	CU_ASSERT(ut_num_refs(node) == 1);
+
+	ut_check_all(node, ch);
+
+	spdk_put_io_channel(ch);
+	ut_delete_dedup();
+	ut_free_disk(base);
+}
+
+static void
+test_dedup_shared(void)
+{
+	struct ut_disk *base;
+	struct vbdev_dedup *node;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io *bdev_io, *bdev_io2;
+	uint64_t lchunk;
+	uint32_t pchunk;
+
+	base = ut_create_base(BASE_BLOCK_CNT);
+	/* Released chunks are only reused after a flush of the base bdev */
+	base->bdev.write_cache = true;
+	node = ut_create_dedup();
+	CU_ASSERT(node->flush_released);
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* Chunks with the same content share a physical chunk, verified by reading it back */
+	ut_write(node, ch, 2 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x50);
+	pchunk = dedup_map_get(node, 2);
+	CU_ASSERT(pchunk != 0);
+	bdev_io = ut_submit_write(node, ch, 5 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x50);
+	ut_drain();
+	ut_check_done(bdev_io);
+	ut_model_write(5 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x50);
+	ut_write(node, ch, 9 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x50);
+	CU_ASSERT(dedup_map_get(node, 5) == pchunk);
+	CU_ASSERT(dedup_map_get(node, 9) == pchunk);
+	CU_ASSERT(ut_disk_map_get(base, 9) == pchunk);
+	CU_ASSERT(node->refcnt[pchunk - 1] == 3);
+	CU_ASSERT(node->num_unique_writes == 1);
+	CU_ASSERT(node->num_dedup_writes == 2);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 1);
+
+	/* Rewriting the same content doesn't change anything */
+	ut_write(node, ch, 9 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x50);
+	CU_ASSERT(node->refcnt[pchunk - 1] == 3);
+
+	/* A partial write of a shared chunk only changes the chunk written */
+	ut_write(node, ch, 5 * CHUNK_BLOCKS + 7, 1, 0x60);
+	CU_ASSERT(dedup_map_get(node, 5) != pchunk);
+	CU_ASSERT(node->refcnt[pchunk - 1] == 2);
+	ut_read(node, ch, 2 * CHUNK_BLOCKS, CHUNK_BLOCKS);
+	ut_read(node, ch, 5 * CHUNK_BLOCKS, CHUNK_BLOCKS);
+
+	/* The chunk is released once its last reference is dropped, but reused only after a
+	 * flush of the base bdev.
+	 */
+	ut_write(node, ch, 2 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0);
+	ut_write(node, ch, 9 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0);
+	CU_ASSERT(node->refcnt[pchunk - 1] == 0);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 2);
+	CU_ASSERT(dedup_num_free_chunks(node) == NUM_PCHUNKS - 1);
+	CU_ASSERT(ut_find_io(SPDK_BDEV_IO_TYPE_FLUSH) == 0);
+	spdk_delay_us(VBDEV_DEDUP_FLUSH_INTERVAL_US);
+	ut_drain();
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 1);
+	CU_ASSERT(node->free_chunks[node->num_free - 1] == pchunk - 1);
+
+	/* The released chunk isn't a dedup candidate anymore */
+	ut_write(node, ch, 11 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x50);
+	CU_ASSERT(node->num_unique_writes == 3);
+	CU_ASSERT(dedup_map_get(node, 11) == pchunk);
+
+	/* Once all the chunks are used, a write waits for a flush releasing one, which starts
+	 * right away.
+	 */
+	ut_write(node, ch, 11 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0);
+	for (lchunk = 12; lchunk < 12 + NUM_PCHUNKS - 3; lchunk++) {
+		ut_write(node, ch, lchunk * CHUNK_BLOCKS, CHUNK_BLOCKS, (uint8_t)(0x80 + lchunk));
+	}
+	CU_ASSERT(node->num_free == 1);
+	base->hold = true;
+	bdev_io = ut_submit_write(node, ch, 20 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x70);
+	bdev_io2 = ut_submit_write(node, ch, 21 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x78);
+	ut_drain();
+	CU_ASSERT(node->num_free == 0);
+	CU_ASSERT(!TAILQ_EMPTY(&node->alloc_waiters));
+	CU_ASSERT(ut_find_io(SPDK_BDEV_IO_TYPE_FLUSH) == 1);
+	base->hold = false;
+	ut_drain();
+	ut_check_done(bdev_io);
+	ut_check_done(bdev_io2);
+	ut_model_write(20 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x70);
+	ut_model_write(21 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x78);
+	CU_ASSERT(dedup_map_get(node, 21) == pchunk);
+	CU_ASSERT(TAILQ_EMPTY(&node->alloc_waiters));
+
+	/* Without anything to release, writes fail with no space left */
+	bdev_io = ut_submit_write(node, ch, 22 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x71);
+	ut_drain();
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_FAILED);
+	ut_free_io(bdev_io);
+	CU_ASSERT(dedup_map_get(node, 22) == 0);
+
+	ut_check_all(node, ch);
+
+	spdk_put_io_channel(ch);
+	ut_delete_dedup();
+	ut_free_disk(base);
+}
+
+static void
+test_dedup_miscompare(void)
+{
+	struct ut_disk *base;
+	struct vbdev_dedup *node;
+	struct spdk_io_channel *ch;
+
+	base = ut_create_base(BASE_BLOCK_CNT);
+	node = ut_create_dedup();
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* Chunks with the same CRC-32C but different content are stored separately */
+	g_crc_collide = true;
+	ut_write(node, ch, 0, CHUNK_BLOCKS, 0x10);
+	ut_write(node, ch, CHUNK_BLOCKS, CHUNK_BLOCKS, 0x20);
+	CU_ASSERT(node->num_miscompares == 1);
+	CU_ASSERT(node->num_unique_writes == 2);
+	CU_ASSERT(dedup_map_get(node, 0) != dedup_map_get(node, 1));
+	CU_ASSERT(node->refcnt[dedup_map_get(node, 0) - 1] == 1);
+	CU_ASSERT(node->refcnt[dedup_map_get(node, 1) - 1] == 1);
+
+	/* And the ones with the same content still shared */
+	ut_write(node, ch, 2 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x10);
+	CU_ASSERT(node->num_dedup_writes == 1);
+	CU_ASSERT(dedup_map_get(node, 2) == dedup_map_get(node, 0));
+	g_crc_collide = false;
+
+	ut_check_all(node, ch);
+
+	spdk_put_io_channel(ch);
+	ut_delete_dedup();
+	ut_free_disk(base);
+}
+
+static void
+test_dedup_pinned_read(void)
+{
+	struct ut_disk *base;
+	struct vbdev_dedup *node;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io *read_io;
+	struct ut_io *io;
+	uint32_t pchunk;
+
+	base = ut_create_base(BASE_BLOCK_CNT);
+	node = ut_create_dedup();
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	ut_write(node, ch, 4 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x10);
+	pchunk = dedup_map_get(node, 4);
+
+	/* A read of the chunk is in flight when it is overwritten */
+	read_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_READ, 4 * CHUNK_BLOCKS, CHUNK_BLOCKS);
+	vbdev_dedup_submit_request(ch, read_io);
+	io = TAILQ_FIRST(&g_ios);
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->hold = true;
+	CU_ASSERT(node->readers[pchunk - 1] == 1);
+	CU_ASSERT(ut_check_data(base->data + (node->data_offset_blocks + (pchunk - 1) * CHUNK_BLOCKS) *
+				BLOCK_SIZE, 4 * CHUNK_BLOCKS, CHUNK_BLOCKS));
+	ut_write(node, ch, 4 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0);
+
+	/* The released chunk isn't reused until the read is done */
+	CU_ASSERT(node->refcnt[pchunk - 1] == 0);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 1);
+	CU_ASSERT(dedup_num_free_chunks(node) == NUM_PCHUNKS);
+	io->hold = false;
+	ut_drain();
+	CU_ASSERT(node->readers[pchunk - 1] == 0);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS);
+
+	/* The read returns the content from before the write */
+	ut_model_write(4 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x10);
+	CU_ASSERT(ut_check_data(read_io->iov.iov_base, 4 * CHUNK_BLOCKS, CHUNK_BLOCKS));
+	ut_check_done(read_io);
+	ut_model_write(4 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0);
+
+	ut_check_all(node, ch);
+
+	spdk_put_io_channel(ch);
+	ut_delete_dedup();
+	ut_free_disk(base);
+}
+
+static void
+test_dedup_unmap(void)
+{
+	struct ut_disk *base;
+	struct vbdev_dedup *node;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io *bdev_io;
+	uint64_t lchunk;
+
+	base = ut_create_base(BASE_BLOCK_CNT);
+	node = ut_create_dedup();
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	for (lchunk = 0; lchunk < 4; lchunk++) {
+		ut_write(node, ch, lchunk * CHUNK_BLOCKS, CHUNK_BLOCKS, (uint8_t)(0x10 * (lchunk + 1)));
+	}
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 4);
+
+	/* Only the chunks fully unmapped are released */
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_UNMAP, CHUNK_BLOCKS - 1, 2 * CHUNK_BLOCKS + 3);
+	vbdev_dedup_submit_request(ch, bdev_io);
+	ut_drain();
+	ut_check_done(bdev_io);
+	ut_model_write(CHUNK_BLOCKS, 2 * CHUNK_BLOCKS, 0);
+	CU_ASSERT(dedup_map_get(node, 0) != 0);
+	CU_ASSERT(dedup_map_get(node, 1) == 0);
+	CU_ASSERT(dedup_map_get(node, 2) == 0);
+	CU_ASSERT(dedup_map_get(node, 3) != 0);
+	CU_ASSERT(ut_disk_map_get(base, 2) == 0);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 2);
+
+	/* A range within a chunk doesn't change anything */
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_UNMAP, 3 * CHUNK_BLOCKS + 1, 4);
+	vbdev_dedup_submit_request(ch, bdev_io);
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	ut_free_io(bdev_io);
+	CU_ASSERT(dedup_map_get(node, 3) != 0);
+
+	/* Nor unmapping chunks already unmapped */
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_UNMAP, 8 * CHUNK_BLOCKS, 4 * CHUNK_BLOCKS);
+	vbdev_dedup_submit_request(ch, bdev_io);
+	ut_drain();
+	ut_check_done(bdev_io);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 2);
+
+	ut_check_all(node, ch);
+
+	spdk_put_io_channel(ch);
+	ut_delete_dedup();
+	ut_free_disk(base);
+}
+
+static void
+test_dedup_reload(void)
+{
+	struct ut_disk *base;
+	struct vbdev_dedup *node;
+	struct spdk_io_channel *ch;
+	uint32_t pchunk;
+
+	base = ut_create_base(BASE_BLOCK_CNT);
+	node = ut_create_dedup();
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	ut_write(node, ch, 0, CHUNK_BLOCKS, 0x10);
+	ut_write(node, ch, 6 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x10);
+	ut_write(node, ch, 7 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x20);
+	ut_write(node, ch, 8 * CHUNK_BLOCKS + 3, 2, 0x30);
+	pchunk = dedup_map_get(node, 6);
+	spdk_put_io_channel(ch);
+	ut_delete_dedup();
+
+	/* The map is loaded back and the reference counts and index rebuilt from it */
+	node = ut_create_dedup();
+	CU_ASSERT(dedup_map_get(node, 0) == pchunk);
+	CU_ASSERT(node->refcnt[pchunk - 1] == 2);
+	CU_ASSERT(ut_num_refs(node) == 4);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 3);
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	ut_check_all(node, ch);
+	ut_write(node, ch, 10 * CHUNK_BLOCKS, CHUNK_BLOCKS, 0x20);
+	CU_ASSERT(node->num_dedup_writes == 1);
+	CU_ASSERT(node->num_free == NUM_PCHUNKS - 3);
+	spdk_put_io_channel(ch);
+	ut_delete_dedup();
+
+	/* The metadata doesn't match another chunk size */
+	CU_ASSERT(ut_try_create_dedup(CHUNK_SIZE / 2, DEDUP_BLOCK_CNT) == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_dedup_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+
+	/* Nor a map entry past the last chunk */
+	to_le32(base->data + BLOCK_SIZE + 4 * sizeof(uint32_t), NUM_PCHUNKS + 1);
+	CU_ASSERT(ut_try_create_dedup(CHUNK_SIZE, DEDUP_BLOCK_CNT) == -EILSEQ);
+	CU_ASSERT(TAILQ_EMPTY(&g_dedup_nodes));
+
+	ut_free_disk(base);
+}
+
+static void
+ut_iobuf_finish_cb(void *cb_arg)
+{
+	*(bool *)cb_arg = true;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+	struct spdk_iobuf_opts opts;
+	bool done = false;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("dedup", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_dedup_create);
+	CU_ADD_TEST(suite, test_dedup_read_write);
+	CU_ADD_TEST(suite, test_dedup_shared);
+	CU_ADD_TEST(suite, test_dedup_miscompare);
+	CU_ADD_TEST(suite, test_dedup_pinned_read);
+	CU_ADD_TEST(suite, test_dedup_unmap);
+	CU_ADD_TEST(suite, test_dedup_reload);
+
+	g_thread = spdk_thread_create("test", NULL);
+	spdk_set_thread(g_thread);
+
+	spdk_iobuf_get_opts(&opts, sizeof(opts));
+	opts.small_pool_count = 64;
+	opts.large_pool_count = 8;
+	spdk_iobuf_set_opts(&opts);
+	spdk_iobuf_initialize();
+	vbdev_dedup_init();
+	spdk_io_device_register(&g_base_io_device, ut_ch_create_cb, ut_ch_destroy_cb, 0, "base");
+	spdk_io_device_register(&g_accel_io_device, ut_ch_create_cb, ut_ch_destroy_cb, 0, "accel");
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	spdk_io_device_unregister(&g_accel_io_device, NULL);
+	spdk_io_device_unregister(&g_base_io_device, NULL);
+	spdk_iobuf_finish(ut_iobuf_finish_cb, &done);
+	while (!done) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+
+	spdk_thread_exit(g_thread);
+	while (!spdk_thread_is_exited(g_thread)) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+	spdk_thread_destroy(g_thread);
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,442 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk_internal/mock.h"
+#include "thread/thread_internal.h"
+#include "common/lib/test_env.c"
+#include "bdev/readahead/vbdev_readahead.c"
+
+#define BLOCK_CNT 1024
+#define BLOCK_SIZE 512
+#define READAHEAD_SIZE (16 * BLOCK_SIZE)
+#define WINDOW_BLOCKS (READAHEAD_SIZE / BLOCK_SIZE)
+
+#define UT_BDEV_MODULE (&readahead_if)
+#define UT_POLL_US 0
+#include "common/lib/bdev/ut_base_bdev.c"
+
+DEFINE_STUB(spdk_bdev_get_memory_domains, int, (struct spdk_bdev *bdev,
+		struct spdk_memory_domain **domains, int array_size), 0);
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB(spdk_bdev_abort, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+				   void *bio_cb_arg, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_copy_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t dst_offset_blocks, uint64_t src_offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_unmap_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+
+static bool
+ut_io_is_prefetch(struct ut_io *io)
+{
+	return io->cb == readahead_prefetch_done;
+}
+
+static uint32_t
+ut_num_prefetches(void)
+{
+	struct ut_io *io;
+	uint32_t count = 0;
+
+	TAILQ_FOREACH(io, &g_ios, link) {
+		count += ut_io_is_prefetch(io);
+	}
+
+	return count;
+}
+
+static struct vbdev_readahead *
+ut_create_readahead(void)
+{
+	struct spdk_uuid uuid = {};
+	struct vbdev_readahead *ra_node;
+	int rc;
+
+	rc = bdev_readahead_create_disk("Base0", "Ra0", &uuid, READAHEAD_SIZE);
+	CU_ASSERT(rc == 0);
+
+	ra_node = TAILQ_FIRST(&g_ra_nodes);
+	SPDK_CU_ASSERT_FATAL(ra_node != NULL);
+	CU_ASSERT(ra_node->window_blocks == WINDOW_BLOCKS);
+
+	return ra_node;
+}
+
+static void
+ut_delete_cb(void *cb_arg, int bdeverrno)
+{
+	CU_ASSERT(bdeverrno == 0);
+}
+
+static void
+ut_delete_readahead(void)
+{
+	bdev_readahead_delete_disk("Ra0", ut_delete_cb, NULL);
+	ut_drain();
+	CU_ASSERT(TAILQ_EMPTY(&g_ra_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+}
+
+static struct spdk_bdev_io *
+ut_alloc_io(struct vbdev_readahead *ra_node, struct spdk_io_channel *ch,
+	    enum spdk_bdev_io_type type, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct readahead_bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = &ra_node->ra_bdev;
+	bdev_io->type = type;
+	bdev_io->internal.ch = spdk_io_channel_get_ctx(ch);
+	bdev_io->internal.status = SPDK_BDEV_IO_STATUS_PENDING;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+	bdev_io->iov.iov_base = calloc(num_blocks, BLOCK_SIZE);
+	SPDK_CU_ASSERT_FATAL(bdev_io->iov.iov_base != NULL);
+	bdev_io->iov.iov_len = num_blocks * BLOCK_SIZE;
+	bdev_io->u.bdev.iovs = &bdev_io->iov;
+	bdev_io->u.bdev.iovcnt = 1;
+
+	return bdev_io;
+}
+
+static void
+ut_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io->iov.iov_base);
+	free(bdev_io);
+}
+
+static bool
+ut_check_read_data(struct spdk_bdev_io *bdev_io)
+{
+	uint8_t *buf = bdev_io->iov.iov_base;
+	uint64_t i, j;
+
+	for (i = 0; i < bdev_io->u.bdev.num_blocks; i++) {
+		for (j = 0; j < BLOCK_SIZE; j++) {
+			if (buf[i * BLOCK_SIZE + j] != (uint8_t)(bdev_io->u.bdev.offset_blocks + i)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static struct spdk_bdev_io *
+ut_submit_read(struct vbdev_readahead *ra_node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+	       uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = ut_alloc_io(ra_node, ch, SPDK_BDEV_IO_TYPE_READ, offset_blocks, num_blocks);
+	vbdev_readahead_submit_request(ch, bdev_io);
+
+	return bdev_io;
+}
+
+static void
+ut_check_read_done(struct spdk_bdev_io *bdev_io)
+{
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_check_read_data(bdev_io));
+	ut_free_io(bdev_io);
+}
+
+/* Submit a read and complete everything sent to the base bdev. Returns the number of
+ * prefetches the read triggered and, through num_reads, the number of reads it sent to
+ * the base bdev.
+ */
+static uint32_t
+ut_read(struct vbdev_readahead *ra_node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+	uint64_t num_blocks, uint32_t *num_reads)
+{
+	struct spdk_bdev_io *bdev_io;
+	uint32_t num_prefetches;
+
+	CU_ASSERT(TAILQ_EMPTY(&g_ios));
+	g_num_ios = 0;
+	bdev_io = ut_submit_read(ra_node, ch, offset_blocks, num_blocks);
+	num_prefetches = ut_num_prefetches();
+	*num_reads = g_num_ios - num_prefetches;
+	ut_drain();
+	ut_check_read_done(bdev_io);
+
+	return num_prefetches;
+}
+
+static void
+ut_check_windows_free(struct spdk_io_channel *ch)
+{
+	struct ra_io_channel *ra_ch = spdk_io_channel_get_ctx(ch);
+	int i;
+
+	for (i = 0; i < VBDEV_READAHEAD_NUM_WINDOWS; i++) {
+		CU_ASSERT(ra_ch->windows[i].state == READAHEAD_WINDOW_FREE);
+	}
+}
+
+static void
+test_readahead_create(void)
+{
+	struct spdk_uuid uuid = {};
+	struct ut_disk *base;
+	int rc;
+
+	/* Readahead size exceeding the iobuf large buffer size */
+	rc = bdev_readahead_create_disk("Base0", "Ra0", &uuid, 1024 * 1024);
+	CU_ASSERT(rc == -EINVAL);
+	rc = bdev_readahead_create_disk("Base0", "Ra0", &uuid, 0);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+
+	/* Creation is deferred until the base bdev shows up */
+	rc = bdev_readahead_create_disk("Base0", "Ra0", &uuid, READAHEAD_SIZE);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(TAILQ_EMPTY(&g_ra_nodes));
+	rc = bdev_readahead_create_disk("Base0", "Ra0", &uuid, READAHEAD_SIZE);
+	CU_ASSERT(rc == -EEXIST);
+
+	base = ut_create_disk("Base0", BLOCK_CNT, BLOCK_SIZE);
+	vbdev_readahead_examine(&base->bdev);
+	CU_ASSERT(!TAILQ_EMPTY(&g_ra_nodes));
+	CU_ASSERT(spdk_bdev_get_by_name("Ra0") != NULL);
+	ut_delete_readahead();
+
+	/* Readahead size smaller than a block */
+	rc = bdev_readahead_create_disk("Base0", "Ra0", &uuid, BLOCK_SIZE - 1);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_ra_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+
+	ut_free_disk(base);
+}
+
+static void
+test_readahead_sequential(void)
+{
+	struct ut_disk *base;
+	struct vbdev_readahead *ra_node;
+	struct spdk_io_channel *ch;
+	uint32_t num_reads, num_prefetches;
+	uint64_t offset;
+
+	base = ut_create_disk("Base0", BLOCK_CNT, BLOCK_SIZE);
+	ra_node = ut_create_readahead();
+	ch = spdk_get_io_channel(ra_node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* The first reads of a stream go to the base bdev, the third one starts prefetching */
+	CU_ASSERT(ut_read(ra_node, ch, 0, 4, &num_reads) == 0);
+	CU_ASSERT(num_reads == 1);
+	CU_ASSERT(ut_read(ra_node, ch, 4, 4, &num_reads) == 0);
+	CU_ASSERT(num_reads == 1);
+	CU_ASSERT(ut_read(ra_node, ch, 8, 4, &num_reads) == 1);
+	CU_ASSERT(num_reads == 1);
+
+	/* The rest of the stream, including the reads crossing two windows, is served from
+	 * memory, with a prefetch issued for each window.
+	 */
+	num_prefetches = 0;
+	for (offset = 12; offset < 12 + WINDOW_BLOCKS * 8; offset += 6) {
+		num_prefetches += ut_read(ra_node, ch, offset, 6, &num_reads);
+		CU_ASSERT(num_reads == 0);
+	}
+	CU_ASSERT(num_prefetches == 8);
+
+	/* A random read breaks the stream and drops the prefetched data */
+	ut_read(ra_node, ch, 500, 4, &num_reads);
+	CU_ASSERT(num_reads == 1);
+	ut_check_windows_free(ch);
+	CU_ASSERT(ut_read(ra_node, ch, offset, 4, &num_reads) == 0);
+	CU_ASSERT(num_reads == 1);
+
+	/* Reads larger than a window are never prefetched */
+	for (offset = 600; offset < 600 + (WINDOW_BLOCKS + 1) * 3; offset += WINDOW_BLOCKS + 1) {
+		CU_ASSERT(ut_read(ra_node, ch, offset, WINDOW_BLOCKS + 1, &num_reads) == 0);
+		CU_ASSERT(num_reads == 1);
+	}
+
+	/* Prefetches stop at the end of the bdev */
+	for (offset = BLOCK_CNT - 20; offset < BLOCK_CNT - 8; offset += 4) {
+		ut_read(ra_node, ch, offset, 4, &num_reads);
+		CU_ASSERT(num_reads == 1);
+	}
+	for (offset = BLOCK_CNT - 8; offset < BLOCK_CNT; offset += 4) {
+		CU_ASSERT(ut_read(ra_node, ch, offset, 4, &num_reads) == 0);
+		CU_ASSERT(num_reads == 0);
+	}
+
+	spdk_put_io_channel(ch);
+	spdk_thread_poll(g_thread, 0, 0);
+	ut_delete_readahead();
+	ut_free_disk(base);
+}
+
+static void
+test_readahead_wait(void)
+{
+	struct ut_disk *base;
+	struct vbdev_readahead *ra_node;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io *read_io[4], *write_io;
+	struct ut_io *io;
+	uint32_t num_reads;
+	int i;
+
+	base = ut_create_disk("Base0", BLOCK_CNT, BLOCK_SIZE);
+	ra_node = ut_create_readahead();
+	ch = spdk_get_io_channel(ra_node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* A read arriving while its data is being prefetched waits for the prefetch, and moves
+	 * the readahead one window further.
+	 */
+	g_num_ios = 0;
+	for (i = 0; i < 4; i++) {
+		read_io[i] = ut_submit_read(ra_node, ch, i * 4, 4);
+	}
+	CU_ASSERT(g_num_ios == 5);
+	CU_ASSERT(ut_num_prefetches() == 2);
+	CU_ASSERT(read_io[3]->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	ut_drain();
+	for (i = 0; i < 4; i++) {
+		ut_check_read_done(read_io[i]);
+	}
+
+	/* If a write overtakes the prefetch, the waiting reads are sent to the base bdev */
+	ut_read(ra_node, ch, 100, 4, &num_reads);
+	ut_read(ra_node, ch, 104, 4, &num_reads);
+	g_num_ios = 0;
+	read_io[0] = ut_submit_read(ra_node, ch, 108, 4);
+	read_io[1] = ut_submit_read(ra_node, ch, 112, 4);
+	CU_ASSERT(g_num_ios == 3);
+	write_io = ut_alloc_io(ra_node, ch, SPDK_BDEV_IO_TYPE_WRITE, 900, 1);
+	vbdev_readahead_submit_request(ch, write_io);
+	CU_ASSERT(g_num_ios == 4);
+
+	io = TAILQ_FIRST(&g_ios);
+	CU_ASSERT(ut_io_is_prefetch(io));
+	ut_complete_io(io);
+	CU_ASSERT(g_num_ios == 5);
+	CU_ASSERT(read_io[1]->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	ut_drain();
+	ut_check_read_done(read_io[0]);
+	ut_check_read_done(read_io[1]);
+	CU_ASSERT(write_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	ut_free_io(write_io);
+
+	/* Data prefetched before a write isn't used afterwards */
+	CU_ASSERT(ut_read(ra_node, ch, 200, 4, &num_reads) == 0);
+	CU_ASSERT(ut_read(ra_node, ch, 204, 4, &num_reads) == 0);
+	CU_ASSERT(ut_read(ra_node, ch, 208, 4, &num_reads) == 1);
+	write_io = ut_alloc_io(ra_node, ch, SPDK_BDEV_IO_TYPE_WRITE, 900, 1);
+	vbdev_readahead_submit_request(ch, write_io);
+	ut_drain();
+	ut_free_io(write_io);
+	CU_ASSERT(ut_read(ra_node, ch, 212, 4, &num_reads) == 1);
+	CU_ASSERT(num_reads == 1);
+	CU_ASSERT(ut_read(ra_node, ch, 216, 4, &num_reads) == 1);
+	CU_ASSERT(num_reads == 0);
+
+	/* A failed prefetch sends the waiting reads to the base bdev */
+	ut_read(ra_node, ch, 300, 4, &num_reads);
+	ut_read(ra_node, ch, 304, 4, &num_reads);
+	read_io[0] = ut_submit_read(ra_node, ch, 308, 4);
+	read_io[1] = ut_submit_read(ra_node, ch, 312, 4);
+	g_num_ios = 0;
+	TAILQ_FOREACH(io, &g_ios, link) {
+		if (ut_io_is_prefetch(io)) {
+			break;
+		}
+	}
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->fail = true;
+	ut_complete_io(io);
+	CU_ASSERT(g_num_ios == 1);
+	ut_drain();
+	ut_check_read_done(read_io[0]);
+	ut_check_read_done(read_io[1]);
+
+	/* The channel is kept around until the prefetch in flight completes */
+	ut_read(ra_node, ch, 400, 4, &num_reads);
+	ut_read(ra_node, ch, 404, 4, &num_reads);
+	read_io[0] = ut_submit_read(ra_node, ch, 408, 4);
+	TAILQ_FOREACH(io, &g_ios, link) {
+		if (!ut_io_is_prefetch(io)) {
+			break;
+		}
+	}
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	ut_complete_io(io);
+	ut_check_read_done(read_io[0]);
+	CU_ASSERT(ut_num_prefetches() == 1);
+
+	spdk_put_io_channel(ch);
+	spdk_thread_poll(g_thread, 0, 0);
+	ut_drain();
+	spdk_thread_poll(g_thread, 0, 0);
+
+	ut_delete_readahead();
+	ut_free_disk(base);
+}
+
+static void
+ut_iobuf_finish_cb(void *cb_arg)
+{
+	*(bool *)cb_arg = true;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+	struct spdk_iobuf_opts opts;
+	bool done = false;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("readahead", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_readahead_create);
+	CU_ADD_TEST(suite, test_readahead_sequential);
+	CU_ADD_TEST(suite, test_readahead_wait);
+
+	g_thread = spdk_thread_create("test", NULL);
+	spdk_set_thread(g_thread);
+
+	spdk_iobuf_get_opts(&opts, sizeof(opts));
+	opts.small_pool_count = 64;
+	opts.large_pool_count = 8;
+	spdk_iobuf_set_opts(&opts);
+	spdk_iobuf_initialize();
+	vbdev_readahead_init();
+	spdk_io_device_register(&g_base_io_device, ut_ch_create_cb, ut_ch_destroy_cb, 0, "base");
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	spdk_io_device_unregister(&g_base_io_device, NULL);
+	spdk_iobuf_finish(ut_iobuf_finish_cb, &done);
+	while (!done) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+
+	spdk_thread_exit(g_thread);
+	while (!spdk_thread_is_exited(g_thread)) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+	spdk_thread_destroy(g_thread);
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
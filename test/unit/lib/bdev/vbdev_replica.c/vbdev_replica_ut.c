@@ -0,0 +1,776 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk/crc32.h"
+#include "spdk_internal/mock.h"
+#include "thread/thread_internal.h"
+#include "common/lib/test_env.c"
+#include "bdev/replica/vbdev_replica.c"
+
+#define BLOCK_SIZE 512
+#define BASE_BLOCK_CNT 64
+#define BATCH_BLOCKS 16
+#define BATCH_SIZE (BATCH_BLOCKS * BLOCK_SIZE)
+/* The superblock, then the ring */
+#define RING_BLOCKS 32
+#define JOURNAL_BLOCK_CNT (RING_BLOCKS + 1)
+
+#define UT_BDEV_MODULE (&replica_if)
+#define UT_POLL_US VBDEV_REPLICA_POLL_US
+#include "common/lib/bdev/ut_base_bdev.c"
+
+struct ut_accel_task {
+	spdk_accel_completion_cb	cb_fn;
+	void				*cb_arg;
+};
+
+static int g_accel_io_device;
+static int g_create_rc;
+static struct ut_disk *g_base, *g_journal, *g_remote;
+
+struct spdk_io_channel *
+spdk_accel_get_io_channel(void)
+{
+	return spdk_get_io_channel(&g_accel_io_device);
+}
+
+static void
+ut_accel_done(void *ctx)
+{
+	struct ut_accel_task *task = ctx;
+
+	task->cb_fn(task->cb_arg, 0);
+	free(task);
+}
+
+/* The accel operations complete asynchronously, like the real ones. */
+int
+spdk_accel_submit_crc32cv(struct spdk_io_channel *ch, uint32_t *crc_dst, struct iovec *iovs,
+			  uint32_t iovcnt, uint32_t seed, spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct ut_accel_task *task;
+
+	*crc_dst = spdk_crc32c_iov_update(iovs, iovcnt, ~seed);
+
+	task = calloc(1, sizeof(*task));
+	SPDK_CU_ASSERT_FATAL(task != NULL);
+	task->cb_fn = cb_fn;
+	task->cb_arg = cb_arg;
+
+	return spdk_thread_send_msg(spdk_get_thread(), ut_accel_done, task);
+}
+
+static int
+ut_find_io(struct ut_disk *disk, enum spdk_bdev_io_type type)
+{
+	struct ut_io *io;
+	int count = 0;
+
+	TAILQ_FOREACH(io, &g_ios, link) {
+		if (io->disk == disk && io->type == type) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static void
+ut_create_disks(void)
+{
+	g_base = ut_create_disk("Base0", BASE_BLOCK_CNT, BLOCK_SIZE);
+	g_journal = ut_create_disk("Journal0", JOURNAL_BLOCK_CNT, BLOCK_SIZE);
+	g_remote = ut_create_disk("Remote0", BASE_BLOCK_CNT, BLOCK_SIZE);
+}
+
+static void
+ut_free_disks(void)
+{
+	ut_free_disk(g_base);
+	ut_free_disk(g_journal);
+	ut_free_disk(g_remote);
+}
+
+static void
+ut_create_cb(void *cb_arg, int rc)
+{
+	g_create_rc = rc;
+}
+
+static int
+ut_try_create_replica(uint32_t batch_size)
+{
+	struct spdk_uuid uuid = {};
+	int rc;
+
+	g_create_rc = 1;
+	rc = bdev_replica_create_disk("Replica0", "Base0", "Journal0", "Remote0", &uuid, batch_size,
+				      ut_create_cb, NULL);
+	if (rc != 0) {
+		return rc;
+	}
+	ut_drain();
+
+	return g_create_rc;
+}
+
+static struct vbdev_replica *
+ut_create_replica(void)
+{
+	struct vbdev_replica *node;
+
+	CU_ASSERT(ut_try_create_replica(BATCH_SIZE) == 0);
+
+	node = TAILQ_FIRST(&g_replica_nodes);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(!node->loading);
+	CU_ASSERT(node->batch_blocks == BATCH_BLOCKS);
+	CU_ASSERT(node->ring_blocks == RING_BLOCKS);
+	CU_ASSERT(node->replica_bdev.blockcnt == BASE_BLOCK_CNT);
+	CU_ASSERT(node->replica_bdev.max_rw_size == BATCH_BLOCKS - 1);
+	CU_ASSERT(spdk_bdev_get_by_name("Replica0") == &node->replica_bdev);
+
+	return node;
+}
+
+static void
+ut_delete_cb(void *cb_arg, int bdeverrno)
+{
+	CU_ASSERT(bdeverrno == 0);
+}
+
+static void
+ut_delete_replica(void)
+{
+	g_destruct_done = false;
+	bdev_replica_delete_disk("Replica0", ut_delete_cb, NULL);
+	ut_drain();
+	CU_ASSERT(g_destruct_done);
+	CU_ASSERT(TAILQ_EMPTY(&g_replica_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	CU_ASSERT(TAILQ_EMPTY(&g_ios));
+}
+
+static struct spdk_bdev_io *
+ut_alloc_io(struct vbdev_replica *node, struct spdk_io_channel *ch, enum spdk_bdev_io_type type,
+	    uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct replica_bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = &node->replica_bdev;
+	bdev_io->type = type;
+	bdev_io->internal.ch = spdk_io_channel_get_ctx(ch);
+	bdev_io->internal.status = SPDK_BDEV_IO_STATUS_PENDING;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+	bdev_io->iov.iov_base = calloc(spdk_max(num_blocks, 1), BLOCK_SIZE);
+	SPDK_CU_ASSERT_FATAL(bdev_io->iov.iov_base != NULL);
+	bdev_io->iov.iov_len = num_blocks * BLOCK_SIZE;
+	bdev_io->u.bdev.iovs = &bdev_io->iov;
+	bdev_io->u.bdev.iovcnt = 1;
+
+	return bdev_io;
+}
+
+static void
+ut_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io->iov.iov_base);
+	free(bdev_io);
+}
+
+static void
+ut_check_done(struct spdk_bdev_io *bdev_io)
+{
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	ut_free_io(bdev_io);
+}
+
+/* Submit a write, each block filled with the pattern plus its index in the write, a 0 pattern
+ * writing zeroes.
+ */
+static struct spdk_bdev_io *
+ut_submit_write(struct vbdev_replica *node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+		uint64_t num_blocks, uint8_t pattern)
+{
+	struct spdk_bdev_io *bdev_io;
+	uint64_t i;
+
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_WRITE, offset_blocks, num_blocks);
+	for (i = 0; pattern != 0 && i < num_blocks; i++) {
+		memset((uint8_t *)bdev_io->iov.iov_base + i * BLOCK_SIZE, (uint8_t)(pattern + i),
+		       BLOCK_SIZE);
+	}
+	vbdev_replica_submit_request(ch, bdev_io);
+
+	return bdev_io;
+}
+
+static void
+ut_write(struct vbdev_replica *node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+	 uint64_t num_blocks, uint8_t pattern)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = ut_submit_write(node, ch, offset_blocks, num_blocks, pattern);
+	ut_drain();
+	ut_check_done(bdev_io);
+}
+
+/* Check the content of a disk against the pattern of ut_submit_write(). */
+static bool
+ut_check_disk(struct ut_disk *disk, uint64_t offset_blocks, uint64_t num_blocks,
+	      uint8_t pattern)
+{
+	uint8_t *data = disk->data + offset_blocks * BLOCK_SIZE;
+	uint64_t i, j;
+
+	for (i = 0; i < num_blocks; i++) {
+		for (j = 0; j < BLOCK_SIZE; j++) {
+			if (data[i * BLOCK_SIZE + j] != (pattern ? (uint8_t)(pattern + i) : 0)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static struct replica_record_hdr *
+ut_journal_hdr(uint64_t lpos)
+{
+	return (struct replica_record_hdr *)(g_journal->data + (1 + lpos % RING_BLOCKS) * BLOCK_SIZE);
+}
+
+static struct replica_sb *
+ut_journal_sb(void)
+{
+	return (struct replica_sb *)g_journal->data;
+}
+
+/* Stop or resume shipping the journal. */
+static void
+ut_pause_shipping(struct vbdev_replica *node, bool pause)
+{
+	node->ship_retry_tsc = pause ? UINT64_MAX : 0;
+}
+
+static void
+test_replica_create(void)
+{
+	struct spdk_uuid uuid = {};
+	struct vbdev_replica *node;
+	struct replica_sb *sb;
+	int rc;
+
+	/* Creation is deferred until all the bdevs show up */
+	g_create_rc = 1;
+	rc = bdev_replica_create_disk("Replica0", "Base0", "Journal0", "Remote0", &uuid, BATCH_SIZE,
+				      ut_create_cb, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_create_rc == 0);
+	rc = bdev_replica_create_disk("Replica0", "Base0", "Journal0", "Remote0", &uuid, BATCH_SIZE,
+				      ut_create_cb, NULL);
+	CU_ASSERT(rc == -EEXIST);
+	g_base = ut_create_disk("Base0", BASE_BLOCK_CNT, BLOCK_SIZE);
+	vbdev_replica_examine(&g_base->bdev);
+	g_journal = ut_create_disk("Journal0", JOURNAL_BLOCK_CNT, BLOCK_SIZE);
+	vbdev_replica_examine(&g_journal->bdev);
+	CU_ASSERT(TAILQ_EMPTY(&g_replica_nodes));
+	g_remote = ut_create_disk("Remote0", BASE_BLOCK_CNT, BLOCK_SIZE);
+	vbdev_replica_examine(&g_remote->bdev);
+
+	/* The bdev is registered once the journal is loaded */
+	CU_ASSERT(!TAILQ_EMPTY(&g_replica_nodes));
+	CU_ASSERT(TAILQ_FIRST(&g_replica_nodes)->loading);
+	CU_ASSERT(spdk_bdev_get_by_name("Replica0") == NULL);
+	ut_drain();
+	node = TAILQ_FIRST(&g_replica_nodes);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(spdk_bdev_get_by_name("Replica0") == &node->replica_bdev);
+	CU_ASSERT(g_base->bdev.internal.claim_type == SPDK_BDEV_CLAIM_EXCL_WRITE);
+	CU_ASSERT(g_journal->bdev.internal.claim_type == SPDK_BDEV_CLAIM_EXCL_WRITE);
+	CU_ASSERT(g_remote->bdev.internal.claim_type == SPDK_BDEV_CLAIM_EXCL_WRITE);
+	CU_ASSERT(TAILQ_EMPTY(&node->records));
+	CU_ASSERT(node->next_seq == 1);
+
+	/* The journal was formatted, empty */
+	sb = ut_journal_sb();
+	CU_ASSERT(memcmp(sb->magic, VBDEV_REPLICA_SB_MAGIC, sizeof(sb->magic)) == 0);
+	CU_ASSERT(from_le64(&sb->ring_blocks) == RING_BLOCKS);
+	CU_ASSERT(from_le64(&sb->base_blockcnt) == BASE_BLOCK_CNT);
+	CU_ASSERT(from_le64(&sb->head_lpos) == 0);
+	CU_ASSERT(from_le64(&sb->head_seq) == 1);
+
+	/* Removing any of the bdevs removes the replicated bdev */
+	g_destruct_done = false;
+	vbdev_replica_base_bdev_event_cb(SPDK_BDEV_EVENT_REMOVE, &g_remote->bdev, NULL);
+	ut_drain();
+	CU_ASSERT(g_destruct_done);
+	CU_ASSERT(TAILQ_EMPTY(&g_replica_nodes));
+	CU_ASSERT(spdk_bdev_get_by_name("Replica0") == NULL);
+	CU_ASSERT(g_remote->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+	vbdev_replica_finish();
+
+	/* The bdevs must be different */
+	rc = bdev_replica_create_disk("Replica0", "Base0", "Base0", "Remote0", &uuid, BATCH_SIZE,
+				      ut_create_cb, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* A batch holds at least two blocks, and fits in the journal */
+	CU_ASSERT(ut_try_create_replica(BLOCK_SIZE) == -EINVAL);
+	CU_ASSERT(ut_try_create_replica(BATCH_SIZE + 1) == -EINVAL);
+	CU_ASSERT(ut_try_create_replica(JOURNAL_BLOCK_CNT * BLOCK_SIZE) == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_replica_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+
+	/* The remote bdev is at least as large as the base bdev, with the same block size */
+	ut_free_disk(g_remote);
+	g_remote = ut_create_disk("Remote0", BASE_BLOCK_CNT - 1, BLOCK_SIZE);
+	CU_ASSERT(ut_try_create_replica(BATCH_SIZE) == -EINVAL);
+	ut_free_disk(g_remote);
+	g_remote = ut_create_disk("Remote0", BASE_BLOCK_CNT * 2, BLOCK_SIZE * 2);
+	CU_ASSERT(ut_try_create_replica(BATCH_SIZE) == -EINVAL);
+	CU_ASSERT(g_base->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+	CU_ASSERT(g_remote->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+	ut_free_disk(g_remote);
+	g_remote = ut_create_disk("Remote0", BASE_BLOCK_CNT, BLOCK_SIZE);
+
+	/* A superblock read error fails the creation */
+	g_journal->hold = true;
+	g_create_rc = 1;
+	rc = bdev_replica_create_disk("Replica0", "Base0", "Journal0", "Remote0", &uuid, BATCH_SIZE,
+				      ut_create_cb, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_create_rc == 1);
+	SPDK_CU_ASSERT_FATAL(!TAILQ_EMPTY(&g_ios));
+	TAILQ_FIRST(&g_ios)->fail = true;
+	g_journal->hold = false;
+	ut_drain();
+	CU_ASSERT(g_create_rc == -EIO);
+	CU_ASSERT(TAILQ_EMPTY(&g_replica_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	CU_ASSERT(spdk_bdev_get_by_name("Replica0") == NULL);
+
+	/* The journal doesn't match another base bdev */
+	ut_create_replica();
+	ut_delete_replica();
+	ut_free_disk(g_base);
+	g_base = ut_create_disk("Base0", BASE_BLOCK_CNT / 2, BLOCK_SIZE);
+	CU_ASSERT(ut_try_create_replica(BATCH_SIZE) == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_replica_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+
+	ut_free_disks();
+}
+
+static void
+test_replica_write(void)
+{
+	struct vbdev_replica *node;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io *bdev_io, *bdev_io2;
+	struct replica_record_hdr *hdr;
+	struct replica_record *record;
+	struct ut_io *io;
+
+	ut_create_disks();
+	node = ut_create_replica();
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* A write is journaled and written to the base bdev, without waiting for the remote bdev */
+	g_remote->hold = true;
+	ut_write(node, ch, 4, 2, 0x10);
+	hdr = ut_journal_hdr(0);
+	CU_ASSERT(memcmp(hdr->magic, VBDEV_REPLICA_RECORD_MAGIC, sizeof(hdr->magic)) == 0);
+	CU_ASSERT(from_le64(&hdr->seq) == 1);
+	CU_ASSERT(from_le64(&hdr->offset_blocks) == 4);
+	CU_ASSERT(from_le32(&hdr->num_blocks) == 2);
+	CU_ASSERT(ut_check_disk(g_journal, 2, 2, 0x10));
+	CU_ASSERT(ut_check_disk(g_base, 4, 2, 0x10));
+	CU_ASSERT(!ut_check_disk(g_remote, 4, 2, 0x10));
+	CU_ASSERT(ut_find_io(g_remote, SPDK_BDEV_IO_TYPE_WRITE) == 1);
+	CU_ASSERT(node->tail_lpos == 3);
+	CU_ASSERT(node->next_seq == 2);
+
+	/* The recovery point is the age of the write not shipped yet */
+	spdk_delay_us(1000);
+	CU_ASSERT(replica_rpo_ticks(node) >= 1000 * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC);
+
+	/* Once it is on the remote bdev, the head of the journal moves past it */
+	g_remote->hold = false;
+	ut_drain();
+	CU_ASSERT(ut_check_disk(g_remote, 4, 2, 0x10));
+	CU_ASSERT(TAILQ_EMPTY(&node->records));
+	CU_ASSERT(from_le64(&ut_journal_sb()->head_lpos) == 3);
+	CU_ASSERT(from_le64(&ut_journal_sb()->head_seq) == 2);
+	CU_ASSERT(node->num_shipped_writes == 1);
+	CU_ASSERT(node->num_batches == 1);
+	CU_ASSERT(replica_rpo_ticks(node) == 0);
+	CU_ASSERT(node->max_rpo_ticks >= 1000 * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC);
+
+	/* Reads are served by the base bdev */
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_READ, 4, 2);
+	vbdev_replica_submit_request(ch, bdev_io);
+	CU_ASSERT(ut_find_io(g_base, SPDK_BDEV_IO_TYPE_READ) == 1);
+	ut_drain();
+	CU_ASSERT(memcmp(bdev_io->iov.iov_base, g_base->data + 4 * BLOCK_SIZE, 2 * BLOCK_SIZE) == 0);
+	ut_check_done(bdev_io);
+
+	/* A write journaled before an earlier one waits for it to go to the base bdev */
+	ut_pause_shipping(node, true);
+	g_journal->hold = true;
+	bdev_io = ut_submit_write(node, ch, 10, 1, 0x20);
+	ut_drain();
+	TAILQ_FOREACH(io, &g_ios, link) {
+		io->hold = true;
+	}
+	g_journal->hold = false;
+	bdev_io2 = ut_submit_write(node, ch, 11, 1, 0x30);
+	ut_drain();
+	record = TAILQ_LAST(&node->records, replica_record_list);
+	SPDK_CU_ASSERT_FATAL(record != NULL);
+	CU_ASSERT(record->state == REPLICA_RECORD_JOURNALED);
+	CU_ASSERT(TAILQ_FIRST(&node->records)->state == REPLICA_RECORD_JOURNALING);
+	CU_ASSERT(ut_find_io(g_base, SPDK_BDEV_IO_TYPE_WRITE) == 0);
+	CU_ASSERT(bdev_io2->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	TAILQ_FOREACH(io, &g_ios, link) {
+		io->hold = false;
+	}
+	ut_drain();
+	ut_check_done(bdev_io);
+	ut_check_done(bdev_io2);
+	CU_ASSERT(ut_check_disk(g_base, 10, 1, 0x20));
+	CU_ASSERT(ut_check_disk(g_base, 11, 1, 0x30));
+
+	/* A failed journal write fails the write, which doesn't reach any other bdev */
+	g_journal->fail_write = true;
+	bdev_io = ut_submit_write(node, ch, 20, 1, 0x40);
+	ut_drain();
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_FAILED);
+	ut_free_io(bdev_io);
+	CU_ASSERT(!ut_check_disk(g_base, 20, 1, 0x40));
+	CU_ASSERT(TAILQ_LAST(&node->records, replica_record_list)->state == REPLICA_RECORD_FAILED);
+	ut_pause_shipping(node, false);
+	ut_drain();
+	CU_ASSERT(TAILQ_EMPTY(&node->records));
+	CU_ASSERT(node->num_shipped_writes == 3);
+	CU_ASSERT(ut_check_disk(g_remote, 10, 1, 0x20));
+	CU_ASSERT(ut_check_disk(g_remote, 11, 1, 0x30));
+	CU_ASSERT(!ut_check_disk(g_remote, 20, 1, 0x40));
+
+	/* Flushes go to both the base bdev and the journal */
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_FLUSH, 0, BASE_BLOCK_CNT);
+	vbdev_replica_submit_request(ch, bdev_io);
+	CU_ASSERT(ut_find_io(g_base, SPDK_BDEV_IO_TYPE_FLUSH) == 1);
+	CU_ASSERT(ut_find_io(g_journal, SPDK_BDEV_IO_TYPE_FLUSH) == 1);
+	ut_drain();
+	ut_check_done(bdev_io);
+
+	spdk_put_io_channel(ch);
+	ut_delete_replica();
+	ut_free_disks();
+}
+
+static void
+test_replica_coalesce(void)
+{
+	struct vbdev_replica *node;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io *bdev_io[4];
+	int i;
+
+	ut_create_disks();
+	node = ut_create_replica();
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	ut_pause_shipping(node, true);
+	bdev_io[0] = ut_submit_write(node, ch, 0, 2, 0x10);
+	bdev_io[1] = ut_submit_write(node, ch, 0, 4, 0x20);
+	bdev_io[2] = ut_submit_write(node, ch, 8, 2, 0);
+	bdev_io[3] = ut_submit_write(node, ch, 2, 1, 0x30);
+	ut_drain();
+	for (i = 0; i < 4; i++) {
+		ut_check_done(bdev_io[i]);
+	}
+	CU_ASSERT(ut_check_disk(g_base, 0, 2, 0x20));
+	CU_ASSERT(ut_check_disk(g_base, 2, 1, 0x30));
+	CU_ASSERT(ut_check_disk(g_base, 8, 2, 0));
+
+	/* The first batch stops at the write partially overlapping an earlier one. The write covered
+	 * by a later one isn't shipped, and the zeroes are shipped as write zeroes.
+	 */
+	g_remote->hold = true;
+	ut_pause_shipping(node, false);
+	ut_drain();
+	CU_ASSERT(node->shipping);
+	CU_ASSERT(node->ship_last == TAILQ_NEXT(TAILQ_NEXT(TAILQ_FIRST(&node->records), link), link));
+	CU_ASSERT(TAILQ_FIRST(&node->records)->superseded);
+	CU_ASSERT(ut_find_io(g_remote, SPDK_BDEV_IO_TYPE_WRITE) == 1);
+	CU_ASSERT(ut_find_io(g_remote, SPDK_BDEV_IO_TYPE_WRITE_ZEROES) == 1);
+	CU_ASSERT(node->num_coalesced_writes == 1);
+	CU_ASSERT(node->num_zero_writes == 1);
+	g_remote->hold = false;
+	ut_drain();
+
+	CU_ASSERT(TAILQ_EMPTY(&node->records));
+	CU_ASSERT(node->num_batches == 2);
+	CU_ASSERT(node->num_shipped_writes == 3);
+	CU_ASSERT(ut_check_disk(g_remote, 0, 2, 0x20));
+	CU_ASSERT(ut_check_disk(g_remote, 2, 1, 0x30));
+	CU_ASSERT(ut_check_disk(g_remote, 3, 1, 0x23));
+	CU_ASSERT(ut_check_disk(g_remote, 8, 2, 0));
+
+	spdk_put_io_channel(ch);
+	ut_delete_replica();
+	ut_free_disks();
+}
+
+static void
+test_replica_journal_full(void)
+{
+	struct vbdev_replica *node;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io *bdev_io;
+	struct replica_record *record;
+	int i;
+
+	ut_create_disks();
+	node = ut_create_replica();
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* Fill the journal */
+	g_remote->hold = true;
+	for (i = 0; i < 3; i++) {
+		ut_write(node, ch, i * 8, 7, (uint8_t)(0x10 * (i + 1)));
+	}
+	ut_write(node, ch, 24, 5, 0x40);
+	CU_ASSERT(node->tail_lpos == 30);
+
+	/* A write not fitting before the end of the ring starts at its beginning, once the space
+	 * is available.
+	 */
+	bdev_io = ut_submit_write(node, ch, 40, 2, 0x50);
+	ut_drain();
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(!TAILQ_EMPTY(&node->space_waiters));
+
+	g_remote->hold = false;
+	ut_drain();
+	ut_check_done(bdev_io);
+	CU_ASSERT(TAILQ_EMPTY(&node->space_waiters));
+	CU_ASSERT(TAILQ_EMPTY(&node->records));
+	CU_ASSERT(node->tail_lpos == 35);
+	CU_ASSERT(from_le64(&ut_journal_hdr(32)->lpos) == 32);
+	CU_ASSERT(from_le64(&ut_journal_hdr(32)->seq) == 5);
+	CU_ASSERT(ut_check_disk(g_journal, 2, 2, 0x50));
+	CU_ASSERT(from_le64(&ut_journal_sb()->head_lpos) == 35);
+
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(ut_check_disk(g_remote, i * 8, 7, (uint8_t)(0x10 * (i + 1))));
+	}
+	CU_ASSERT(ut_check_disk(g_remote, 24, 5, 0x40));
+	CU_ASSERT(ut_check_disk(g_remote, 40, 2, 0x50));
+
+	/* The records are reused */
+	record = TAILQ_FIRST(&node->free_records);
+	ut_write(node, ch, 0, 1, 0x60);
+	CU_ASSERT(TAILQ_FIRST(&node->free_records) == record);
+
+	spdk_put_io_channel(ch);
+	ut_delete_replica();
+	ut_free_disks();
+}
+
+static void
+test_replica_ship_error(void)
+{
+	struct vbdev_replica *node;
+	struct spdk_io_channel *ch;
+
+	ut_create_disks();
+	node = ut_create_replica();
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* A failed batch stays in the journal and is retried later */
+	g_remote->fail_write = true;
+	ut_write(node, ch, 0, 2, 0x10);
+	CU_ASSERT(node->num_ship_errors == 1);
+	CU_ASSERT(!node->shipping);
+	CU_ASSERT(!TAILQ_EMPTY(&node->records));
+	CU_ASSERT(from_le64(&ut_journal_sb()->head_lpos) == 0);
+	spdk_delay_us(VBDEV_REPLICA_RETRY_US);
+	ut_drain();
+	CU_ASSERT(TAILQ_EMPTY(&node->records));
+	CU_ASSERT(ut_check_disk(g_remote, 0, 2, 0x10));
+	CU_ASSERT(from_le64(&ut_journal_sb()->head_lpos) == 3);
+
+	/* Deleting the bdev waits for the batch in flight */
+	g_remote->hold = true;
+	ut_write(node, ch, 4, 1, 0x20);
+	CU_ASSERT(node->shipping);
+	g_destruct_done = false;
+	bdev_replica_delete_disk("Replica0", ut_delete_cb, NULL);
+	ut_drain();
+	CU_ASSERT(!g_destruct_done);
+	spdk_put_io_channel(ch);
+	g_remote->hold = false;
+	ut_drain();
+	CU_ASSERT(g_destruct_done);
+	CU_ASSERT(TAILQ_EMPTY(&g_ios));
+	CU_ASSERT(ut_check_disk(g_remote, 4, 1, 0x20));
+
+	ut_free_disks();
+}
+
+static void
+test_replica_recovery(void)
+{
+	struct vbdev_replica *node;
+	struct spdk_io_channel *ch;
+	struct replica_record *record;
+	uint64_t lpos;
+	int i;
+
+	ut_create_disks();
+	node = ut_create_replica();
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* Move the head close to the end of the ring */
+	for (i = 0; i < 3; i++) {
+		ut_write(node, ch, 0, 7, 0x10);
+	}
+	CU_ASSERT(from_le64(&ut_journal_sb()->head_lpos) == 24);
+
+	/* Writes not shipped, the second one at the beginning of the ring */
+	ut_pause_shipping(node, true);
+	ut_write(node, ch, 8, 2, 0x20);
+	ut_write(node, ch, 16, 7, 0x30);
+	ut_write(node, ch, 30, 2, 0x40);
+	CU_ASSERT(node->tail_lpos == 43);
+	spdk_put_io_channel(ch);
+	ut_delete_replica();
+
+	/* They are replayed on the base bdev and shipped once the bdev is created again */
+	memset(g_base->data, 0xee, BASE_BLOCK_CNT * BLOCK_SIZE);
+	CU_ASSERT(ut_try_create_replica(BATCH_SIZE) == 0);
+	node = TAILQ_FIRST(&g_replica_nodes);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(TAILQ_EMPTY(&node->records));
+	CU_ASSERT(node->tail_lpos == 43);
+	CU_ASSERT(node->next_seq == 7);
+	CU_ASSERT(node->num_shipped_writes == 3);
+	CU_ASSERT(ut_check_disk(g_base, 8, 2, 0x20));
+	CU_ASSERT(ut_check_disk(g_base, 16, 7, 0x30));
+	CU_ASSERT(ut_check_disk(g_base, 30, 2, 0x40));
+	CU_ASSERT(ut_check_disk(g_remote, 8, 2, 0x20));
+	CU_ASSERT(ut_check_disk(g_remote, 16, 7, 0x30));
+	CU_ASSERT(ut_check_disk(g_remote, 30, 2, 0x40));
+	CU_ASSERT(from_le64(&ut_journal_sb()->head_lpos) == 43);
+
+	/* A record with corrupted data ends the journal */
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	ut_pause_shipping(node, true);
+	ut_write(node, ch, 40, 1, 0x50);
+	lpos = node->tail_lpos;
+	ut_write(node, ch, 41, 1, 0x60);
+	spdk_put_io_channel(ch);
+	ut_delete_replica();
+	g_journal->data[(1 + (lpos + 1) % RING_BLOCKS) * BLOCK_SIZE] ^= 0xff;
+
+	CU_ASSERT(ut_try_create_replica(BATCH_SIZE) == 0);
+	node = TAILQ_FIRST(&g_replica_nodes);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(node->tail_lpos == lpos);
+	CU_ASSERT(node->next_seq == 8);
+	CU_ASSERT(ut_check_disk(g_remote, 40, 1, 0x50));
+	CU_ASSERT(!ut_check_disk(g_remote, 41, 1, 0x60));
+
+	/* The next write takes its place */
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	ut_write(node, ch, 42, 1, 0x70);
+	CU_ASSERT(from_le64(&ut_journal_hdr(lpos)->seq) == 8);
+	record = TAILQ_FIRST(&node->free_records);
+	CU_ASSERT(record != NULL && record->lpos == lpos);
+	spdk_put_io_channel(ch);
+	ut_delete_replica();
+
+	/* A superblock not matching the journal fails the creation */
+	to_le64(&ut_journal_sb()->ring_blocks, RING_BLOCKS - 1);
+	CU_ASSERT(ut_try_create_replica(BATCH_SIZE) == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_replica_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+
+	ut_free_disks();
+}
+
+static void
+ut_iobuf_finish_cb(void *cb_arg)
+{
+	*(bool *)cb_arg = true;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+	struct spdk_iobuf_opts opts;
+	bool done = false;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("replica", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_replica_create);
+	CU_ADD_TEST(suite, test_replica_write);
+	CU_ADD_TEST(suite, test_replica_coalesce);
+	CU_ADD_TEST(suite, test_replica_journal_full);
+	CU_ADD_TEST(suite, test_replica_ship_error);
+	CU_ADD_TEST(suite, test_replica_recovery);
+
+	g_thread = spdk_thread_create("test", NULL);
+	spdk_set_thread(g_thread);
+
+	spdk_iobuf_get_opts(&opts, sizeof(opts));
+	opts.small_pool_count = 64;
+	opts.large_pool_count = 8;
+	spdk_iobuf_set_opts(&opts);
+	spdk_iobuf_initialize();
+	vbdev_replica_init();
+	spdk_io_device_register(&g_base_io_device, ut_ch_create_cb, ut_ch_destroy_cb, 0, "base");
+	spdk_io_device_register(&g_accel_io_device, ut_ch_create_cb, ut_ch_destroy_cb, 0, "accel");
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	spdk_io_device_unregister(&g_accel_io_device, NULL);
+	spdk_io_device_unregister(&g_base_io_device, NULL);
+	spdk_iobuf_finish(ut_iobuf_finish_cb, &done);
+	while (!done) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+
+	spdk_thread_exit(g_thread);
+	while (!spdk_thread_is_exited(g_thread)) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+	spdk_thread_destroy(g_thread);
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
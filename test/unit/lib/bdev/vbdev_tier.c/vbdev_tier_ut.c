@@ -0,0 +1,585 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk_internal/mock.h"
+#include "thread/thread_internal.h"
+#include "common/lib/test_env.c"
+#include "bdev/tier/vbdev_tier.c"
+
+#define BLOCK_SIZE 512
+#define EXTENT_BLOCKS 8
+#define EXTENT_SIZE (EXTENT_BLOCKS * BLOCK_SIZE)
+#define NUM_EXTENTS 32
+/* The last extent is shorter */
+#define CAPACITY_BLOCK_CNT (NUM_EXTENTS * EXTENT_BLOCKS - 3)
+/* Two blocks of metadata, padded to one extent, then the slots */
+#define NUM_SLOTS 4
+#define FAST_BLOCK_CNT (EXTENT_BLOCKS * (NUM_SLOTS + 1) + 3)
+
+#define UT_BDEV_MODULE (&tier_if)
+#define UT_POLL_US VBDEV_TIER_CH_POLL_US
+#define UT_BLOCK_SIZE BLOCK_SIZE
+#define UT_MODEL_BLOCKS CAPACITY_BLOCK_CNT
+#include "common/lib/bdev/ut_base_bdev.c"
+
+static int g_create_rc;
+
+/* Let a sweep start and run the migrations it plans. */
+static void
+ut_sweep(void)
+{
+	spdk_delay_us(VBDEV_TIER_SWEEP_INTERVAL_US);
+	ut_drain();
+}
+
+static void
+ut_create_cb(void *cb_arg, int rc)
+{
+	g_create_rc = rc;
+}
+
+static struct vbdev_tier *
+ut_create_tier(struct ut_disk *fast, struct ut_disk *capacity)
+{
+	struct spdk_uuid uuid = {};
+	struct vbdev_tier *node;
+	int rc;
+
+	g_create_rc = 1;
+	rc = bdev_tier_create_disk("Tier0", fast->bdev.name, capacity->bdev.name, &uuid, EXTENT_SIZE,
+				   ut_create_cb, NULL);
+	CU_ASSERT(rc == 0);
+	ut_drain();
+	CU_ASSERT(g_create_rc == 0);
+
+	node = TAILQ_FIRST(&g_tier_nodes);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(!node->loading);
+	CU_ASSERT(node->extent_blocks == EXTENT_BLOCKS);
+	CU_ASSERT(node->num_extents == NUM_EXTENTS);
+	CU_ASSERT(node->num_slots == NUM_SLOTS);
+	CU_ASSERT(node->data_offset_blocks == EXTENT_BLOCKS);
+	CU_ASSERT(node->tier_bdev.blockcnt == CAPACITY_BLOCK_CNT);
+	CU_ASSERT(node->tier_bdev.optimal_io_boundary == EXTENT_BLOCKS);
+	CU_ASSERT(node->tier_bdev.split_on_optimal_io_boundary);
+	CU_ASSERT(spdk_bdev_get_by_name("Tier0") == &node->tier_bdev);
+
+	return node;
+}
+
+static void
+ut_create_disks(struct ut_disk **fast, struct ut_disk **capacity)
+{
+	uint64_t i;
+
+	*fast = ut_create_disk("Fast0", FAST_BLOCK_CNT, BLOCK_SIZE);
+	*capacity = ut_create_disk("Capacity0", CAPACITY_BLOCK_CNT, BLOCK_SIZE);
+	for (i = 0; i < CAPACITY_BLOCK_CNT; i++) {
+		g_model[i] = (uint8_t)i;
+	}
+}
+
+static void
+ut_delete_cb(void *cb_arg, int bdeverrno)
+{
+	CU_ASSERT(bdeverrno == 0);
+}
+
+static void
+ut_delete_tier(void)
+{
+	g_destruct_done = false;
+	bdev_tier_delete_disk("Tier0", ut_delete_cb, NULL);
+	ut_drain();
+	CU_ASSERT(g_destruct_done);
+	CU_ASSERT(TAILQ_EMPTY(&g_tier_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	CU_ASSERT(TAILQ_EMPTY(&g_ios));
+}
+
+static void
+ut_free_disks(struct ut_disk *fast, struct ut_disk *capacity)
+{
+	CU_ASSERT(fast->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+	CU_ASSERT(capacity->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+	ut_free_disk(fast);
+	ut_free_disk(capacity);
+}
+
+static struct spdk_bdev_io *
+ut_alloc_io(struct vbdev_tier *node, struct spdk_io_channel *ch, enum spdk_bdev_io_type type,
+	    uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct tier_bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = &node->tier_bdev;
+	bdev_io->type = type;
+	bdev_io->internal.ch = spdk_io_channel_get_ctx(ch);
+	bdev_io->internal.status = SPDK_BDEV_IO_STATUS_PENDING;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+	bdev_io->iov.iov_base = calloc(spdk_max(num_blocks, 1), BLOCK_SIZE);
+	SPDK_CU_ASSERT_FATAL(bdev_io->iov.iov_base != NULL);
+	bdev_io->iov.iov_len = num_blocks * BLOCK_SIZE;
+	bdev_io->u.bdev.iovs = &bdev_io->iov;
+	bdev_io->u.bdev.iovcnt = 1;
+
+	return bdev_io;
+}
+
+static void
+ut_check_done(struct spdk_bdev_io *bdev_io)
+{
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	free(bdev_io->iov.iov_base);
+	free(bdev_io);
+}
+
+static struct spdk_bdev_io *
+ut_submit_write(struct vbdev_tier *node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+		uint64_t num_blocks, uint8_t pattern)
+{
+	struct spdk_bdev_io *bdev_io;
+	uint64_t i;
+
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_WRITE, offset_blocks, num_blocks);
+	for (i = 0; i < num_blocks; i++) {
+		memset((uint8_t *)bdev_io->iov.iov_base + i * BLOCK_SIZE, pattern + i, BLOCK_SIZE);
+		g_model[offset_blocks + i] = pattern + i;
+	}
+	vbdev_tier_submit_request(ch, bdev_io);
+
+	return bdev_io;
+}
+
+/* Write a range and return the disk the write was sent to. */
+static struct ut_disk *
+ut_write(struct vbdev_tier *node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+	 uint64_t num_blocks, uint8_t pattern)
+{
+	struct spdk_bdev_io *bdev_io;
+	struct ut_io *io;
+	struct ut_disk *disk;
+
+	CU_ASSERT(TAILQ_EMPTY(&g_ios));
+	bdev_io = ut_submit_write(node, ch, offset_blocks, num_blocks, pattern);
+	io = TAILQ_FIRST(&g_ios);
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	disk = io->disk;
+	ut_complete_ios();
+	ut_check_done(bdev_io);
+
+	return disk;
+}
+
+/* Read a range, check its data and return the disk the read was sent to. */
+static struct ut_disk *
+ut_read(struct vbdev_tier *node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+	uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+	struct ut_io *io;
+	struct ut_disk *disk;
+
+	CU_ASSERT(TAILQ_EMPTY(&g_ios));
+	bdev_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_READ, offset_blocks, num_blocks);
+	vbdev_tier_submit_request(ch, bdev_io);
+	io = TAILQ_FIRST(&g_ios);
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	CU_ASSERT(io->type == SPDK_BDEV_IO_TYPE_READ);
+	disk = io->disk;
+	ut_complete_ios();
+	CU_ASSERT(ut_check_data(bdev_io->iov.iov_base, offset_blocks, num_blocks));
+	ut_check_done(bdev_io);
+
+	return disk;
+}
+
+/* Make an extent hot enough to be promoted by the next sweep. */
+static void
+ut_heat(struct vbdev_tier *node, struct spdk_io_channel *ch, uint64_t extent, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		ut_read(node, ch, extent * EXTENT_BLOCKS, 1);
+	}
+}
+
+/* Check the whole content of the tiering bdev, one extent at a time. */
+static void
+ut_check_all(struct vbdev_tier *node, struct spdk_io_channel *ch)
+{
+	uint64_t extent;
+
+	for (extent = 0; extent < NUM_EXTENTS; extent++) {
+		ut_read(node, ch, extent * EXTENT_BLOCKS, tier_extent_blocks(node, extent));
+	}
+}
+
+static uint32_t
+ut_map_get(struct vbdev_tier *node, uint64_t extent)
+{
+	return from_le32(&node->map[extent]);
+}
+
+static void
+test_tier_create(void)
+{
+	struct spdk_uuid uuid = {};
+	struct ut_disk *fast, *capacity;
+	struct tier_md_header *hdr;
+	int rc;
+
+	/* The same bdev can't be used for both */
+	rc = bdev_tier_create_disk("Tier0", "Fast0", "Fast0", &uuid, EXTENT_SIZE, ut_create_cb, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* Creation is deferred until both the fast and capacity bdev show up */
+	g_create_rc = 1;
+	rc = bdev_tier_create_disk("Tier0", "Fast0", "Capacity0", &uuid, EXTENT_SIZE, ut_create_cb,
+				   NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_create_rc == 0);
+	rc = bdev_tier_create_disk("Tier0", "Fast0", "Capacity0", &uuid, EXTENT_SIZE, ut_create_cb,
+				   NULL);
+	CU_ASSERT(rc == -EEXIST);
+	fast = ut_create_disk("Fast0", FAST_BLOCK_CNT, BLOCK_SIZE);
+	vbdev_tier_examine(&fast->bdev);
+	CU_ASSERT(TAILQ_EMPTY(&g_tier_nodes));
+	capacity = ut_create_disk("Capacity0", CAPACITY_BLOCK_CNT, BLOCK_SIZE);
+	vbdev_tier_examine(&capacity->bdev);
+
+	/* The bdev is registered once the metadata is loaded */
+	CU_ASSERT(!TAILQ_EMPTY(&g_tier_nodes));
+	CU_ASSERT(TAILQ_FIRST(&g_tier_nodes)->loading);
+	CU_ASSERT(spdk_bdev_get_by_name("Tier0") == NULL);
+	ut_drain();
+	CU_ASSERT(spdk_bdev_get_by_name("Tier0") != NULL);
+	CU_ASSERT(fast->bdev.internal.claim_type == SPDK_BDEV_CLAIM_EXCL_WRITE);
+	CU_ASSERT(capacity->bdev.internal.claim_type == SPDK_BDEV_CLAIM_EXCL_WRITE);
+	CU_ASSERT(TAILQ_FIRST(&g_tier_nodes)->num_free_slots == NUM_SLOTS);
+
+	/* The fast bdev was formatted, with all the extents on the capacity bdev */
+	hdr = (struct tier_md_header *)fast->data;
+	CU_ASSERT(memcmp(hdr->magic, VBDEV_TIER_MD_MAGIC, sizeof(hdr->magic)) == 0);
+	CU_ASSERT(from_le64(&hdr->extent_blocks) == EXTENT_BLOCKS);
+	CU_ASSERT(from_le64(&hdr->num_extents) == NUM_EXTENTS);
+	CU_ASSERT(from_le64(&hdr->num_slots) == NUM_SLOTS);
+	CU_ASSERT(spdk_uuid_compare(&hdr->capacity_uuid, &capacity->bdev.uuid) == 0);
+	CU_ASSERT(spdk_mem_all_zero(fast->data + BLOCK_SIZE, BLOCK_SIZE));
+	ut_delete_tier();
+
+	/* Extent size not a multiple of the block size */
+	rc = bdev_tier_create_disk("Tier0", "Fast0", "Capacity0", &uuid, EXTENT_SIZE + 1,
+				   ut_create_cb, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* Fast bdev too small for any slot */
+	rc = bdev_tier_create_disk("Tier0", "Fast0", "Capacity0", &uuid, EXTENT_SIZE * 8,
+				   ut_create_cb, NULL);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_tier_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	CU_ASSERT(fast->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+	CU_ASSERT(capacity->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+
+	/* A metadata read error fails the creation */
+	fast->hold = true;
+	g_create_rc = 1;
+	rc = bdev_tier_create_disk("Tier0", "Fast0", "Capacity0", &uuid, EXTENT_SIZE, ut_create_cb,
+				   NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_create_rc == 1);
+	SPDK_CU_ASSERT_FATAL(!TAILQ_EMPTY(&g_ios));
+	TAILQ_FIRST(&g_ios)->fail = true;
+	fast->hold = false;
+	ut_drain();
+	CU_ASSERT(g_create_rc == -EIO);
+	CU_ASSERT(TAILQ_EMPTY(&g_tier_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	CU_ASSERT(spdk_bdev_get_by_name("Tier0") == NULL);
+	ut_free_disks(fast, capacity);
+
+	/* Block sizes differ */
+	fast = ut_create_disk("Fast0", FAST_BLOCK_CNT, BLOCK_SIZE * 8);
+	capacity = ut_create_disk("Capacity0", CAPACITY_BLOCK_CNT, BLOCK_SIZE);
+	rc = bdev_tier_create_disk("Tier0", "Fast0", "Capacity0", &uuid, EXTENT_SIZE * 8,
+				   ut_create_cb, NULL);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_tier_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	ut_free_disks(fast, capacity);
+}
+
+static void
+test_tier_promote(void)
+{
+	struct ut_disk *fast, *capacity;
+	struct vbdev_tier *node;
+	struct spdk_io_channel *ch;
+	uint64_t offset;
+
+	ut_create_disks(&fast, &capacity);
+	node = ut_create_tier(fast, capacity);
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* Everything starts on the capacity bdev */
+	CU_ASSERT(ut_read(node, ch, 40, 8) == capacity);
+	CU_ASSERT(ut_write(node, ch, 42, 2, 0xa0) == capacity);
+
+	/* Cold extents stay where they are */
+	ut_heat(node, ch, 5, VBDEV_TIER_PROMOTE_MIN_HEAT - 4);
+	ut_sweep();
+	CU_ASSERT(ut_map_get(node, 5) == 0);
+	CU_ASSERT(node->heat[5] == (VBDEV_TIER_PROMOTE_MIN_HEAT - 2) / 2);
+
+	/* A hot extent is copied to the first free slot and the map updated on the fast bdev */
+	ut_heat(node, ch, 5, VBDEV_TIER_PROMOTE_MIN_HEAT);
+	ut_sweep();
+	CU_ASSERT(ut_map_get(node, 5) == 1);
+	CU_ASSERT(node->num_promotions == 1);
+	CU_ASSERT(node->num_free_slots == NUM_SLOTS - 1);
+	CU_ASSERT(from_le32(fast->data + BLOCK_SIZE + 5 * sizeof(uint32_t)) == 1);
+	offset = node->data_offset_blocks;
+	CU_ASSERT(ut_check_data(fast->data + offset * BLOCK_SIZE, 40, EXTENT_BLOCKS));
+
+	/* And accessed there from now on */
+	CU_ASSERT(ut_read(node, ch, 40, 8) == fast);
+	CU_ASSERT(ut_write(node, ch, 43, 3, 0xb0) == fast);
+	CU_ASSERT(ut_read(node, ch, 41, 4) == fast);
+	CU_ASSERT(ut_check_data(fast->data + offset * BLOCK_SIZE, 40, EXTENT_BLOCKS));
+	CU_ASSERT(ut_read(node, ch, 48, 1) == capacity);
+
+	/* The last extent is shorter */
+	ut_heat(node, ch, NUM_EXTENTS - 1, VBDEV_TIER_PROMOTE_MIN_HEAT);
+	ut_sweep();
+	CU_ASSERT(ut_map_get(node, NUM_EXTENTS - 1) == 2);
+	CU_ASSERT(ut_read(node, ch, (NUM_EXTENTS - 1) * EXTENT_BLOCKS, EXTENT_BLOCKS - 3) == fast);
+
+	/* A failed copy leaves the extent on the capacity bdev */
+	ut_heat(node, ch, 7, VBDEV_TIER_PROMOTE_MIN_HEAT);
+	fast->fail_write = true;
+	ut_sweep();
+	CU_ASSERT(ut_map_get(node, 7) == 0);
+	CU_ASSERT(node->num_free_slots == NUM_SLOTS - 2);
+	CU_ASSERT(ut_read(node, ch, 7 * EXTENT_BLOCKS, EXTENT_BLOCKS) == capacity);
+
+	ut_check_all(node, ch);
+
+	spdk_put_io_channel(ch);
+	ut_delete_tier();
+	ut_free_disks(fast, capacity);
+}
+
+static void
+test_tier_migrate_blocked(void)
+{
+	struct ut_disk *fast, *capacity;
+	struct vbdev_tier *node;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io *write_io, *read_io, *other_io;
+	struct ut_io *io;
+
+	ut_create_disks(&fast, &capacity);
+	node = ut_create_tier(fast, capacity);
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* A write to the extent is in flight when the sweep decides to promote it */
+	ut_heat(node, ch, 3, VBDEV_TIER_PROMOTE_MIN_HEAT);
+	write_io = ut_submit_write(node, ch, 25, 2, 0xc0);
+	io = TAILQ_FIRST(&g_ios);
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	CU_ASSERT(io->disk == capacity);
+	io->hold = true;
+	ut_sweep();
+	CU_ASSERT(node->migrator.state == TIER_MIGRATE_DRAIN);
+	CU_ASSERT(TAILQ_FIRST(&g_ios) == io && TAILQ_NEXT(io, link) == NULL);
+
+	/* The new I/Os to the extent wait, the others go through */
+	read_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_READ, 24, 4);
+	vbdev_tier_submit_request(ch, read_io);
+	CU_ASSERT(TAILQ_NEXT(io, link) == NULL);
+	other_io = ut_alloc_io(node, ch, SPDK_BDEV_IO_TYPE_READ, 32, 1);
+	vbdev_tier_submit_request(ch, other_io);
+	SPDK_CU_ASSERT_FATAL(TAILQ_NEXT(io, link) != NULL);
+	CU_ASSERT(TAILQ_NEXT(io, link)->disk == capacity);
+
+	/* Once the write completes, the extent is copied including its data and the read
+	 * is sent to the fast bdev.
+	 */
+	io->hold = false;
+	ut_drain();
+	ut_check_done(write_io);
+	CU_ASSERT(ut_check_data(other_io->iov.iov_base, 32, 1));
+	ut_check_done(other_io);
+	CU_ASSERT(node->migrator.state == TIER_MIGRATE_IDLE);
+	CU_ASSERT(ut_map_get(node, 3) == 1);
+	CU_ASSERT(ut_check_data(read_io->iov.iov_base, 24, 4));
+	ut_check_done(read_io);
+	CU_ASSERT(ut_check_data(fast->data + node->data_offset_blocks * BLOCK_SIZE, 24,
+				EXTENT_BLOCKS));
+	CU_ASSERT(node->io_state[3] == 0);
+
+	ut_check_all(node, ch);
+
+	spdk_put_io_channel(ch);
+	ut_delete_tier();
+	ut_free_disks(fast, capacity);
+}
+
+static void
+test_tier_demote(void)
+{
+	struct ut_disk *fast, *capacity;
+	struct vbdev_tier *node;
+	struct spdk_io_channel *ch;
+	uint64_t extent;
+	uint32_t on_fast = 0;
+
+	ut_create_disks(&fast, &capacity);
+	node = ut_create_tier(fast, capacity);
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* Fill all the slots */
+	for (extent = 0; extent < NUM_SLOTS; extent++) {
+		ut_write(node, ch, extent * EXTENT_BLOCKS, EXTENT_BLOCKS, 0x10 * extent);
+		ut_heat(node, ch, extent, VBDEV_TIER_PROMOTE_MIN_HEAT);
+	}
+	ut_sweep();
+	CU_ASSERT(node->num_promotions == NUM_SLOTS);
+	CU_ASSERT(node->num_free_slots == 0);
+
+	/* An extent only slightly hotter than the fast ones doesn't replace them */
+	ut_heat(node, ch, 20, VBDEV_TIER_PROMOTE_MIN_HEAT + 2);
+	ut_sweep();
+	CU_ASSERT(ut_map_get(node, 20) == 0);
+	CU_ASSERT(node->num_demotions == 0);
+
+	/* A much hotter one does */
+	ut_write(node, ch, 20 * EXTENT_BLOCKS + 2, 3, 0xe0);
+	ut_heat(node, ch, 20, VBDEV_TIER_PROMOTE_MIN_HEAT * 4);
+	ut_sweep();
+	CU_ASSERT(ut_map_get(node, 20) != 0);
+	CU_ASSERT(node->num_demotions == 1);
+	CU_ASSERT(node->num_promotions == NUM_SLOTS + 1);
+	CU_ASSERT(node->num_free_slots == 0);
+	for (extent = 0; extent < NUM_SLOTS; extent++) {
+		if (ut_map_get(node, extent) != 0) {
+			on_fast++;
+		} else {
+			/* The demoted extent is back on the capacity bdev */
+			CU_ASSERT(ut_check_data(capacity->data + extent * EXTENT_BLOCKS * BLOCK_SIZE,
+						extent * EXTENT_BLOCKS, EXTENT_BLOCKS));
+		}
+	}
+	CU_ASSERT(on_fast == NUM_SLOTS - 1);
+
+	ut_check_all(node, ch);
+
+	spdk_put_io_channel(ch);
+	ut_delete_tier();
+	ut_free_disks(fast, capacity);
+}
+
+static void
+test_tier_reload(void)
+{
+	struct spdk_uuid uuid = {};
+	struct ut_disk *fast, *capacity;
+	struct vbdev_tier *node;
+	struct spdk_io_channel *ch;
+	int rc;
+
+	ut_create_disks(&fast, &capacity);
+	node = ut_create_tier(fast, capacity);
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	ut_heat(node, ch, 9, VBDEV_TIER_PROMOTE_MIN_HEAT);
+	ut_sweep();
+	CU_ASSERT(ut_map_get(node, 9) == 1);
+	CU_ASSERT(ut_write(node, ch, 72, 8, 0x40) == fast);
+	spdk_put_io_channel(ch);
+	ut_delete_tier();
+
+	/* The map is loaded back from the fast bdev */
+	node = ut_create_tier(fast, capacity);
+	CU_ASSERT(ut_map_get(node, 9) == 1);
+	CU_ASSERT(node->num_free_slots == NUM_SLOTS - 1);
+	ch = spdk_get_io_channel(node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	CU_ASSERT(ut_read(node, ch, 72, 8) == fast);
+	ut_check_all(node, ch);
+	spdk_put_io_channel(ch);
+	ut_delete_tier();
+
+	/* The metadata doesn't match another extent size */
+	g_create_rc = 1;
+	rc = bdev_tier_create_disk("Tier0", "Fast0", "Capacity0", &uuid, EXTENT_SIZE / 2,
+				   ut_create_cb, NULL);
+	CU_ASSERT(rc == 0);
+	ut_drain();
+	CU_ASSERT(g_create_rc == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_tier_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+
+	/* Nor a duplicated slot */
+	to_le32(fast->data + BLOCK_SIZE + 10 * sizeof(uint32_t), 1);
+	g_create_rc = 1;
+	rc = bdev_tier_create_disk("Tier0", "Fast0", "Capacity0", &uuid, EXTENT_SIZE,
+				   ut_create_cb, NULL);
+	CU_ASSERT(rc == 0);
+	ut_drain();
+	CU_ASSERT(g_create_rc == -EILSEQ);
+	CU_ASSERT(TAILQ_EMPTY(&g_tier_nodes));
+
+	ut_free_disks(fast, capacity);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("tier", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_tier_create);
+	CU_ADD_TEST(suite, test_tier_promote);
+	CU_ADD_TEST(suite, test_tier_migrate_blocked);
+	CU_ADD_TEST(suite, test_tier_demote);
+	CU_ADD_TEST(suite, test_tier_reload);
+
+	g_thread = spdk_thread_create("test", NULL);
+	spdk_set_thread(g_thread);
+
+	vbdev_tier_init();
+	spdk_io_device_register(&g_base_io_device, ut_ch_create_cb, ut_ch_destroy_cb, 0, "base");
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	spdk_io_device_unregister(&g_base_io_device, NULL);
+
+	spdk_thread_exit(g_thread);
+	while (!spdk_thread_is_exited(g_thread)) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+	spdk_thread_destroy(g_thread);
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,593 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk_internal/mock.h"
+#include "thread/thread_internal.h"
+#include "common/lib/test_env.c"
+#include "bdev/wbcache/vbdev_wbcache.c"
+
+#define BLOCK_SIZE 512
+#define BASE_BLOCK_CNT 2048
+#define SEGMENT_BLOCKS 16
+#define SEGMENT_SIZE (SEGMENT_BLOCKS * BLOCK_SIZE)
+#define NUM_SEGMENTS 4
+#define CACHE_BLOCK_CNT (SEGMENT_BLOCKS * NUM_SEGMENTS + 3)
+
+#define UT_BDEV_MODULE (&wbcache_if)
+#define UT_POLL_US VBDEV_WBCACHE_CH_POLL_US
+#define UT_BLOCK_SIZE BLOCK_SIZE
+#define UT_MODEL_BLOCKS BASE_BLOCK_CNT
+#include "common/lib/bdev/ut_base_bdev.c"
+
+static struct vbdev_wbcache *
+ut_create_wbcache(struct ut_disk **base, struct ut_disk **cache)
+{
+	struct spdk_uuid uuid = {};
+	struct vbdev_wbcache *wbc_node;
+	uint64_t i;
+	int rc;
+
+	*base = ut_create_disk("Base0", BASE_BLOCK_CNT, BLOCK_SIZE);
+	*cache = ut_create_disk("Cache0", CACHE_BLOCK_CNT, BLOCK_SIZE);
+	for (i = 0; i < BASE_BLOCK_CNT; i++) {
+		g_model[i] = (uint8_t)i;
+	}
+
+	rc = bdev_wbcache_create_disk("Wbc0", "Base0", "Cache0", &uuid, SEGMENT_SIZE);
+	CU_ASSERT(rc == 0);
+
+	wbc_node = TAILQ_FIRST(&g_wbc_nodes);
+	SPDK_CU_ASSERT_FATAL(wbc_node != NULL);
+	CU_ASSERT(wbc_node->segment_blocks == SEGMENT_BLOCKS);
+	CU_ASSERT(wbc_node->num_segments == NUM_SEGMENTS);
+	CU_ASSERT(wbc_node->wbc_bdev.max_rw_size == SEGMENT_BLOCKS);
+	CU_ASSERT(wbc_node->wbc_bdev.write_cache);
+
+	return wbc_node;
+}
+
+static void
+ut_delete_cb(void *cb_arg, int bdeverrno)
+{
+	CU_ASSERT(bdeverrno == 0);
+}
+
+static void
+ut_delete_wbcache(struct ut_disk *base, struct ut_disk *cache)
+{
+	g_destruct_done = false;
+	bdev_wbcache_delete_disk("Wbc0", ut_delete_cb, NULL);
+	ut_drain();
+	CU_ASSERT(g_destruct_done);
+	CU_ASSERT(TAILQ_EMPTY(&g_wbc_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	CU_ASSERT(TAILQ_EMPTY(&g_ios));
+	CU_ASSERT(base->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+	CU_ASSERT(cache->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+
+	ut_free_disk(base);
+	ut_free_disk(cache);
+}
+
+static struct spdk_bdev_io *
+ut_alloc_io(struct vbdev_wbcache *wbc_node, struct spdk_io_channel *ch,
+	    enum spdk_bdev_io_type type, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct wbcache_bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = &wbc_node->wbc_bdev;
+	bdev_io->type = type;
+	bdev_io->internal.ch = spdk_io_channel_get_ctx(ch);
+	bdev_io->internal.status = SPDK_BDEV_IO_STATUS_PENDING;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+	bdev_io->iov.iov_base = calloc(spdk_max(num_blocks, 1), BLOCK_SIZE);
+	SPDK_CU_ASSERT_FATAL(bdev_io->iov.iov_base != NULL);
+	bdev_io->iov.iov_len = num_blocks * BLOCK_SIZE;
+	bdev_io->u.bdev.iovs = &bdev_io->iov;
+	bdev_io->u.bdev.iovcnt = 1;
+
+	return bdev_io;
+}
+
+static void
+ut_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io->iov.iov_base);
+	free(bdev_io);
+}
+
+/* Submit an I/O on the thread of its channel. */
+static void
+ut_submit(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	spdk_set_thread(spdk_io_channel_get_thread(ch));
+	vbdev_wbcache_submit_request(ch, bdev_io);
+	spdk_set_thread(g_thread);
+}
+
+static struct spdk_bdev_io *
+ut_submit_write(struct vbdev_wbcache *wbc_node, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, uint8_t pattern)
+{
+	struct spdk_bdev_io *bdev_io;
+	uint64_t i;
+
+	bdev_io = ut_alloc_io(wbc_node, ch, SPDK_BDEV_IO_TYPE_WRITE, offset_blocks, num_blocks);
+	for (i = 0; i < num_blocks; i++) {
+		memset((uint8_t *)bdev_io->iov.iov_base + i * BLOCK_SIZE, pattern + i, BLOCK_SIZE);
+		g_model[offset_blocks + i] = pattern + i;
+	}
+	ut_submit(ch, bdev_io);
+
+	return bdev_io;
+}
+
+static void
+ut_check_done(struct spdk_bdev_io *bdev_io)
+{
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	ut_free_io(bdev_io);
+}
+
+static void
+ut_write(struct vbdev_wbcache *wbc_node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+	 uint64_t num_blocks, uint8_t pattern)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = ut_submit_write(wbc_node, ch, offset_blocks, num_blocks, pattern);
+	ut_complete_ios();
+	ut_check_done(bdev_io);
+}
+
+/* Read a range and check its data. Returns the number of I/O sent to the cache bdev and,
+ * through num_base_ios, to the base bdev.
+ */
+static uint32_t
+ut_read(struct vbdev_wbcache *wbc_node, struct spdk_io_channel *ch, uint64_t offset_blocks,
+	uint64_t num_blocks, uint32_t *num_base_ios)
+{
+	struct spdk_bdev_io *bdev_io;
+	struct ut_io *io;
+	uint32_t num_cache_ios = 0;
+
+	CU_ASSERT(TAILQ_EMPTY(&g_ios));
+	*num_base_ios = 0;
+	bdev_io = ut_alloc_io(wbc_node, ch, SPDK_BDEV_IO_TYPE_READ, offset_blocks, num_blocks);
+	ut_submit(ch, bdev_io);
+	TAILQ_FOREACH(io, &g_ios, link) {
+		CU_ASSERT(io->type == SPDK_BDEV_IO_TYPE_READ);
+		if (io->disk->bdev.blockcnt == CACHE_BLOCK_CNT) {
+			num_cache_ios++;
+		} else {
+			(*num_base_ios)++;
+		}
+	}
+	ut_complete_ios();
+	CU_ASSERT(ut_check_data(bdev_io->iov.iov_base, offset_blocks, num_blocks));
+	ut_check_done(bdev_io);
+
+	return num_cache_ios;
+}
+
+static bool
+ut_check_base(struct ut_disk *base)
+{
+	uint64_t i;
+
+	for (i = 0; i < BASE_BLOCK_CNT; i++) {
+		if (!ut_check_data(base->data + i * BLOCK_SIZE, i, 1)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool
+ut_check_clean(struct vbdev_wbcache *wbc_node)
+{
+	uint64_t i;
+
+	for (i = 0; i < BASE_BLOCK_CNT; i++) {
+		if (wbcache_index_get(wbc_node, i) != 0) {
+			return false;
+		}
+	}
+
+	return wbc_node->num_free_segments == NUM_SEGMENTS;
+}
+
+static void
+ut_flush(struct vbdev_wbcache *wbc_node, struct spdk_io_channel *ch)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = ut_alloc_io(wbc_node, ch, SPDK_BDEV_IO_TYPE_FLUSH, 0, BASE_BLOCK_CNT);
+	ut_submit(ch, bdev_io);
+	ut_drain();
+	ut_check_done(bdev_io);
+}
+
+static void
+test_wbcache_create(void)
+{
+	struct spdk_uuid uuid = {};
+	struct ut_disk *base, *cache;
+	int rc;
+
+	/* The same bdev can't be used for both */
+	rc = bdev_wbcache_create_disk("Wbc0", "Base0", "Base0", &uuid, SEGMENT_SIZE);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* Creation is deferred until both the base and cache bdev show up */
+	rc = bdev_wbcache_create_disk("Wbc0", "Base0", "Cache0", &uuid, SEGMENT_SIZE);
+	CU_ASSERT(rc == 0);
+	rc = bdev_wbcache_create_disk("Wbc0", "Base0", "Cache0", &uuid, SEGMENT_SIZE);
+	CU_ASSERT(rc == -EEXIST);
+	base = ut_create_disk("Base0", BASE_BLOCK_CNT, BLOCK_SIZE);
+	vbdev_wbcache_examine(&base->bdev);
+	CU_ASSERT(TAILQ_EMPTY(&g_wbc_nodes));
+	cache = ut_create_disk("Cache0", CACHE_BLOCK_CNT, BLOCK_SIZE);
+	vbdev_wbcache_examine(&cache->bdev);
+	CU_ASSERT(!TAILQ_EMPTY(&g_wbc_nodes));
+	CU_ASSERT(spdk_bdev_get_by_name("Wbc0") != NULL);
+	CU_ASSERT(base->bdev.internal.claim_type == SPDK_BDEV_CLAIM_EXCL_WRITE);
+	CU_ASSERT(cache->bdev.internal.claim_type == SPDK_BDEV_CLAIM_EXCL_WRITE);
+	ut_delete_wbcache(base, cache);
+
+	/* Segment size not a multiple of the block size */
+	base = ut_create_disk("Base0", BASE_BLOCK_CNT, BLOCK_SIZE);
+	cache = ut_create_disk("Cache0", CACHE_BLOCK_CNT, BLOCK_SIZE);
+	rc = bdev_wbcache_create_disk("Wbc0", "Base0", "Cache0", &uuid, SEGMENT_SIZE + 1);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* Cache bdev too small for two segments */
+	rc = bdev_wbcache_create_disk("Wbc0", "Base0", "Cache0", &uuid, SEGMENT_SIZE * NUM_SEGMENTS);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_wbc_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+	CU_ASSERT(base->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+	CU_ASSERT(cache->bdev.internal.claim_type == SPDK_BDEV_CLAIM_NONE);
+	ut_free_disk(cache);
+
+	/* Block sizes differ */
+	cache = ut_create_disk("Cache0", CACHE_BLOCK_CNT, BLOCK_SIZE * 8);
+	rc = bdev_wbcache_create_disk("Wbc0", "Base0", "Cache0", &uuid, SEGMENT_SIZE * 8);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_wbc_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+
+	ut_free_disk(cache);
+	ut_free_disk(base);
+}
+
+static void
+test_wbcache_read_write(void)
+{
+	struct ut_disk *base, *cache;
+	struct vbdev_wbcache *wbc_node;
+	struct spdk_io_channel *ch;
+	struct ut_io *io;
+	struct spdk_bdev_io *bdev_io;
+	uint32_t num_base_ios;
+
+	wbc_node = ut_create_wbcache(&base, &cache);
+	ch = spdk_get_io_channel(wbc_node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* Nothing cached yet, reads go to the base bdev */
+	CU_ASSERT(ut_read(wbc_node, ch, 100, 4, &num_base_ios) == 0);
+	CU_ASSERT(num_base_ios == 1);
+
+	/* Writes are appended to the channel's segment on the cache bdev */
+	bdev_io = ut_submit_write(wbc_node, ch, 100, 4, 0xa0);
+	io = TAILQ_FIRST(&g_ios);
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	CU_ASSERT(io->disk == cache);
+	CU_ASSERT(io->offset_blocks == 0);
+	CU_ASSERT(wbcache_index_get(wbc_node, 100) == 0);
+	ut_complete_ios();
+	ut_check_done(bdev_io);
+	CU_ASSERT(wbcache_index_get(wbc_node, 100) == 1);
+	CU_ASSERT(wbcache_index_get(wbc_node, 103) == 4);
+
+	ut_write(wbc_node, ch, 200, 2, 0xb0);
+	CU_ASSERT(wbcache_index_get(wbc_node, 200) == 5);
+	ut_write(wbc_node, ch, 104, 2, 0xc0);
+	CU_ASSERT(wbcache_index_get(wbc_node, 104) == 7);
+
+	/* Fully cached and contiguous on the cache bdev */
+	CU_ASSERT(ut_read(wbc_node, ch, 101, 3, &num_base_ios) == 1);
+	CU_ASSERT(num_base_ios == 0);
+	/* Cached, but in two places */
+	CU_ASSERT(ut_read(wbc_node, ch, 100, 6, &num_base_ios) == 2);
+	CU_ASSERT(num_base_ios == 0);
+	/* Partially cached */
+	CU_ASSERT(ut_read(wbc_node, ch, 98, 10, &num_base_ios) == 2);
+	CU_ASSERT(num_base_ios == 2);
+	CU_ASSERT(ut_read(wbc_node, ch, 199, 2, &num_base_ios) == 1);
+	CU_ASSERT(num_base_ios == 1);
+
+	/* Overwrites point the index at the new data */
+	ut_write(wbc_node, ch, 101, 1, 0xd0);
+	CU_ASSERT(wbcache_index_get(wbc_node, 101) == 9);
+	CU_ASSERT(ut_read(wbc_node, ch, 100, 3, &num_base_ios) == 3);
+	CU_ASSERT(num_base_ios == 0);
+
+	/* A failed write leaves the previous data in place */
+	cache->fail_write = true;
+	bdev_io = ut_submit_write(wbc_node, ch, 102, 1, 0xe0);
+	ut_complete_ios();
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_FAILED);
+	ut_free_io(bdev_io);
+	g_model[102] = 0xa2;
+	CU_ASSERT(wbcache_index_get(wbc_node, 102) == 3);
+	CU_ASSERT(ut_read(wbc_node, ch, 102, 1, &num_base_ios) == 1);
+	CU_ASSERT(ut_check_base(base) == false);
+
+	/* Nothing was destaged since the segment is still open, a flush destages it */
+	ut_drain();
+	CU_ASSERT(wbc_node->num_free_segments == NUM_SEGMENTS - 1);
+	ut_flush(wbc_node, ch);
+	CU_ASSERT(ut_check_base(base));
+	CU_ASSERT(ut_check_clean(wbc_node));
+	CU_ASSERT(ut_read(wbc_node, ch, 98, 10, &num_base_ios) == 0);
+	CU_ASSERT(num_base_ios == 1);
+
+	spdk_put_io_channel(ch);
+	ut_drain();
+	ut_delete_wbcache(base, cache);
+}
+
+static void
+test_wbcache_destage(void)
+{
+	struct ut_disk *base, *cache;
+	struct vbdev_wbcache *wbc_node;
+	struct spdk_io_channel *ch[2];
+	struct spdk_bdev_io *write_io[8], *flush_io;
+	uint32_t num_base_ios;
+	uint64_t offset;
+	int i;
+
+	wbc_node = ut_create_wbcache(&base, &cache);
+	ch[0] = spdk_get_io_channel(wbc_node);
+	SPDK_CU_ASSERT_FATAL(ch[0] != NULL);
+
+	/* Full segments are destaged in the background, writes to the same block in
+	 * different segments leave the latest data on the base bdev.
+	 */
+	for (offset = 0; offset < SEGMENT_BLOCKS * 3; offset += 8) {
+		ut_write(wbc_node, ch[0], 500 + offset % SEGMENT_BLOCKS, 8, (uint8_t)offset);
+	}
+	ut_write(wbc_node, ch[0], 1000, 1, 0x11);
+	ut_drain();
+	CU_ASSERT(wbc_node->num_free_segments == NUM_SEGMENTS - 1);
+	CU_ASSERT(wbcache_index_get(wbc_node, 500) == 0);
+	CU_ASSERT(wbcache_index_get(wbc_node, 1000) == SEGMENT_BLOCKS * 3 + 1);
+	CU_ASSERT(ut_read(wbc_node, ch[0], 498, 4, &num_base_ios) == 0);
+	CU_ASSERT(num_base_ios == 1);
+	ut_flush(wbc_node, ch[0]);
+	CU_ASSERT(ut_check_base(base));
+	CU_ASSERT(ut_check_clean(wbc_node));
+
+	/* Writes wait for a free segment when the cache is full */
+	base->hold = true;
+	for (i = 0; i < 8; i++) {
+		write_io[i] = ut_submit_write(wbc_node, ch[0], 1500 + i * SEGMENT_BLOCKS / 2,
+					      SEGMENT_BLOCKS / 2, (uint8_t)(0x40 + i));
+	}
+	ut_drain();
+	for (i = 0; i < 8; i++) {
+		ut_check_done(write_io[i]);
+	}
+	write_io[0] = ut_submit_write(wbc_node, ch[0], 10, 1, 0x20);
+	write_io[1] = ut_submit_write(wbc_node, ch[0], 11, 1, 0x21);
+	ut_drain();
+	CU_ASSERT(write_io[0]->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(write_io[1]->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	base->hold = false;
+	ut_drain();
+	ut_check_done(write_io[0]);
+	ut_check_done(write_io[1]);
+	ut_flush(wbc_node, ch[0]);
+	CU_ASSERT(ut_check_base(base));
+	CU_ASSERT(ut_check_clean(wbc_node));
+
+	/* A flush waits for the data written on all the channels */
+	spdk_set_thread(g_thread2);
+	ch[1] = spdk_get_io_channel(wbc_node);
+	spdk_set_thread(g_thread);
+	SPDK_CU_ASSERT_FATAL(ch[1] != NULL);
+	ut_write(wbc_node, ch[0], 20, 2, 0x30);
+	ut_write(wbc_node, ch[1], 30, 2, 0x38);
+	CU_ASSERT(wbc_node->num_free_segments == NUM_SEGMENTS - 2);
+	base->hold = true;
+	flush_io = ut_alloc_io(wbc_node, ch[0], SPDK_BDEV_IO_TYPE_FLUSH, 0, BASE_BLOCK_CNT);
+	ut_submit(ch[0], flush_io);
+	ut_drain();
+	CU_ASSERT(flush_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	/* Writes submitted after the flush aren't waited for */
+	ut_write(wbc_node, ch[1], 40, 1, 0x3f);
+	base->hold = false;
+	ut_drain();
+	ut_check_done(flush_io);
+	CU_ASSERT(wbcache_index_get(wbc_node, 20) == 0);
+	CU_ASSERT(wbcache_index_get(wbc_node, 30) == 0);
+	CU_ASSERT(wbcache_index_get(wbc_node, 40) != 0);
+
+	/* A destage error is retried later */
+	base->fail_write = true;
+	flush_io = ut_alloc_io(wbc_node, ch[1], SPDK_BDEV_IO_TYPE_FLUSH, 0, BASE_BLOCK_CNT);
+	ut_submit(ch[1], flush_io);
+	ut_drain();
+	CU_ASSERT(flush_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(!ut_check_base(base));
+	CU_ASSERT(wbc_node->num_free_segments == NUM_SEGMENTS - 1);
+	spdk_delay_us(VBDEV_WBCACHE_DESTAGE_RETRY_US);
+	ut_drain();
+	ut_check_done(flush_io);
+	CU_ASSERT(ut_check_base(base));
+	CU_ASSERT(ut_check_clean(wbc_node));
+
+	/* Deleting the bdev destages what's left */
+	ut_write(wbc_node, ch[0], 50, 4, 0x50);
+	ut_write(wbc_node, ch[1], 60, 4, 0x60);
+	spdk_put_io_channel(ch[0]);
+	spdk_set_thread(g_thread2);
+	spdk_put_io_channel(ch[1]);
+	spdk_set_thread(g_thread);
+	ut_drain();
+	g_destruct_done = false;
+	bdev_wbcache_delete_disk("Wbc0", ut_delete_cb, NULL);
+	ut_drain();
+	CU_ASSERT(g_destruct_done);
+	CU_ASSERT(ut_check_base(base));
+	CU_ASSERT(TAILQ_EMPTY(&g_wbc_nodes));
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_names));
+
+	ut_free_disk(base);
+	ut_free_disk(cache);
+}
+
+static void
+test_wbcache_segment_reuse(void)
+{
+	struct ut_disk *base, *cache;
+	struct vbdev_wbcache *wbc_node;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io *read_io[2], *flush_io;
+	struct wbcache_segment *seg;
+	struct ut_io *io, *tmp;
+
+	wbc_node = ut_create_wbcache(&base, &cache);
+	ch = spdk_get_io_channel(wbc_node);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* A read of the cache started before the blocks were destaged keeps their segment
+	 * from being reused until it completes.
+	 */
+	ut_write(wbc_node, ch, 300, 4, 0x70);
+	seg = &wbc_node->segments[0];
+	CU_ASSERT(seg->state == WBCACHE_SEGMENT_OPEN);
+	read_io[0] = ut_alloc_io(wbc_node, ch, SPDK_BDEV_IO_TYPE_READ, 300, 4);
+	ut_submit(ch, read_io[0]);
+	io = TAILQ_FIRST(&g_ios);
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	CU_ASSERT(io->disk == cache);
+	io->hold = true;
+
+	flush_io = ut_alloc_io(wbc_node, ch, SPDK_BDEV_IO_TYPE_FLUSH, 0, BASE_BLOCK_CNT);
+	ut_submit(ch, flush_io);
+	ut_drain();
+	CU_ASSERT(flush_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(seg->state == WBCACHE_SEGMENT_DESTAGING);
+	CU_ASSERT(wbc_node->destager.barrier);
+	CU_ASSERT(wbcache_index_get(wbc_node, 300) == 0);
+	CU_ASSERT(ut_check_base(base));
+
+	/* New reads go to the base bdev and don't delay the reuse */
+	read_io[1] = ut_alloc_io(wbc_node, ch, SPDK_BDEV_IO_TYPE_READ, 300, 4);
+	ut_submit(ch, read_io[1]);
+	CU_ASSERT(TAILQ_LAST(&g_ios, ut_io_head)->disk == base);
+	ut_drain();
+	ut_check_done(read_io[1]);
+	CU_ASSERT(flush_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	io->hold = false;
+	ut_drain();
+	CU_ASSERT(ut_check_data(read_io[0]->iov.iov_base, 300, 4));
+	ut_check_done(read_io[0]);
+	ut_check_done(flush_io);
+	CU_ASSERT(seg->state == WBCACHE_SEGMENT_FREE);
+	CU_ASSERT(!wbc_node->destager.barrier);
+	CU_ASSERT(ut_check_clean(wbc_node));
+
+	/* Hot removal of the cache bdev drops the data not destaged */
+	ut_write(wbc_node, ch, 400, 4, 0x80);
+	cache->hold = true;
+	spdk_put_io_channel(ch);
+	ut_drain();
+	CU_ASSERT(!TAILQ_EMPTY(&g_ios));
+	g_destruct_done = false;
+	vbdev_wbcache_base_bdev_event_cb(SPDK_BDEV_EVENT_REMOVE, &cache->bdev, NULL);
+	TAILQ_FOREACH_SAFE(io, &g_ios, link, tmp) {
+		io->fail = true;
+	}
+	cache->hold = false;
+	ut_drain();
+	CU_ASSERT(g_destruct_done);
+	CU_ASSERT(TAILQ_EMPTY(&g_wbc_nodes));
+	CU_ASSERT(!ut_check_base(base));
+
+	vbdev_wbcache_remove_name("Wbc0");
+	ut_free_disk(base);
+	ut_free_disk(cache);
+}
+
+static void
+ut_iobuf_finish_cb(void *cb_arg)
+{
+	*(bool *)cb_arg = true;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+	struct spdk_iobuf_opts opts;
+	bool done = false;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("wbcache", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_wbcache_create);
+	CU_ADD_TEST(suite, test_wbcache_read_write);
+	CU_ADD_TEST(suite, test_wbcache_destage);
+	CU_ADD_TEST(suite, test_wbcache_segment_reuse);
+
+	g_thread2 = spdk_thread_create("test2", NULL);
+	g_thread = spdk_thread_create("test", NULL);
+	spdk_set_thread(g_thread);
+
+	spdk_iobuf_get_opts(&opts, sizeof(opts));
+	opts.small_pool_count = 64;
+	opts.large_pool_count = 8;
+	spdk_iobuf_set_opts(&opts);
+	spdk_iobuf_initialize();
+	vbdev_wbcache_init();
+	spdk_io_device_register(&g_base_io_device, ut_ch_create_cb, ut_ch_destroy_cb, 0, "base");
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	spdk_io_device_unregister(&g_base_io_device, NULL);
+	spdk_iobuf_finish(ut_iobuf_finish_cb, &done);
+	while (!done) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+
+	spdk_set_thread(g_thread2);
+	spdk_thread_exit(g_thread2);
+	spdk_set_thread(g_thread);
+	spdk_thread_exit(g_thread);
+	while (!spdk_thread_is_exited(g_thread) || !spdk_thread_is_exited(g_thread2)) {
+		spdk_thread_poll(g_thread, 0, 0);
+		spdk_thread_poll(g_thread2, 0, 0);
+	}
+	spdk_thread_destroy(g_thread2);
+	spdk_thread_destroy(g_thread);
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
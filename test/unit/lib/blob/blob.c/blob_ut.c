@@ -1179,6 +1179,216 @@ blob_inflate(void)
 	_blob_inflate(true);
 }
 
+static void
+blob_inflate_parallel_copies(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel;
+	spdk_blob_id blobid, snapshotid;
+	uint8_t payload_read[BLOCKLEN];
+	uint8_t payload_write[BLOCKLEN];
+	uint64_t io_units_per_cluster, cluster_sz;
+	uint64_t read_bytes, copy_bytes, write_bytes, issued, max_issued = 0;
+	const uint32_t MAX_COPIES = 3;
+	const uint32_t NUM_CLUSTERS = 8;
+	uint32_t i;
+
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	CU_ASSERT(bs_opts.max_cluster_copies == SPDK_BLOB_OPTS_DEFAULT_MAX_CLUSTER_COPIES);
+	bs_opts.max_cluster_copies = MAX_COPIES;
+
+	dev = init_dev();
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	CU_ASSERT(bs->max_cluster_copies == MAX_COPIES);
+
+	cluster_sz = spdk_bs_get_cluster_size(bs);
+	io_units_per_cluster = cluster_sz / spdk_bs_get_io_unit_size(bs);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = NUM_CLUSTERS;
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+
+	for (i = 0; i < NUM_CLUSTERS; i++) {
+		memset(payload_write, i + 1, sizeof(payload_write));
+		spdk_blob_io_write(blob, channel, payload_write, i * io_units_per_cluster, 1,
+				   blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
+
+	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	snapshotid = g_blobid;
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 0);
+
+	/* Up to MAX_COPIES clusters are read (or copied) before the first one is written */
+	read_bytes = g_dev_read_bytes;
+	copy_bytes = g_dev_copy_bytes;
+	write_bytes = g_dev_write_bytes;
+	g_bserrno = -1;
+	spdk_bs_inflate_blob(bs, channel, blobid, blob_op_complete, NULL);
+	while (g_bserrno == -1) {
+		if (g_dev_write_bytes == write_bytes) {
+			issued = (g_dev_read_bytes - read_bytes + g_dev_copy_bytes - copy_bytes) / cluster_sz;
+			max_issued = spdk_max(max_issued, issued);
+		}
+		poll_thread_times(0, 1);
+	}
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(max_issued == MAX_COPIES);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == NUM_CLUSTERS);
+	CU_ASSERT(spdk_blob_is_thin_provisioned(blob) == false);
+
+	for (i = 0; i < NUM_CLUSTERS; i++) {
+		memset(payload_write, i + 1, sizeof(payload_write));
+		memset(payload_read, 0xFF, sizeof(payload_read));
+		spdk_blob_io_read(blob, channel, payload_read, i * io_units_per_cluster, 1,
+				  blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(memcmp(payload_write, payload_read, sizeof(payload_read)) == 0);
+	}
+
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+
+	ut_blob_close_and_delete(bs, blob);
+	spdk_bs_delete_blob(bs, snapshotid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
+static void
+blob_reclaim_unmap(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	struct spdk_blob *blob[2];
+	spdk_blob_id blobid[2];
+	struct spdk_power_failure_thresholds thresholds = {};
+	uint64_t cluster_lba[2][5];
+	uint64_t free_clusters, cluster_sz, offset;
+	uint32_t i, j;
+
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	CU_ASSERT(bs_opts.reclaim_unmap_depth == 0);
+	bs_opts.reclaim_unmap_depth = 1;
+
+	dev = init_dev();
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	cluster_sz = spdk_bs_get_cluster_size(bs);
+	free_clusters = spdk_bs_free_cluster_count(bs);
+
+	/* Interleave the clusters of two blobs, so that each one alone has no contiguous run */
+	ut_spdk_blob_opts_init(&opts);
+	for (i = 0; i < SPDK_COUNTOF(blob); i++) {
+		blob[i] = ut_blob_create_and_open(bs, &opts);
+		blobid[i] = spdk_blob_get_id(blob[i]);
+	}
+	for (j = 0; j < SPDK_COUNTOF(cluster_lba[0]); j++) {
+		for (i = 0; i < SPDK_COUNTOF(blob); i++) {
+			spdk_blob_resize(blob[i], j + 1, blob_op_complete, NULL);
+			poll_threads();
+			CU_ASSERT(g_bserrno == 0);
+			cluster_lba[i][j] = blob[i]->active.clusters[j];
+		}
+	}
+	for (i = 0; i < SPDK_COUNTOF(blob); i++) {
+		spdk_blob_sync_md(blob[i], blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		spdk_blob_close(blob[i], blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
+	CU_ASSERT(cluster_lba[1][0] == cluster_lba[0][0] + bs_cluster_to_lba(bs, 1));
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 10);
+
+	for (i = 0; i < SPDK_COUNTOF(blob); i++) {
+		for (j = 0; j < SPDK_COUNTOF(cluster_lba[0]); j++) {
+			memset(&g_dev_buffer[cluster_lba[i][j] * dev->blocklen], 0xA5, cluster_sz);
+		}
+	}
+
+	/* Count the unmaps issued by the deletions */
+	dev_reset_power_failure_event();
+	thresholds.unmap_threshold = UINT64_MAX;
+	dev_set_power_failure_thresholds(thresholds);
+
+	/* The freed clusters of both blobs are unmapped in the background, together */
+	spdk_bs_delete_blob(bs, blobid[0], blob_op_complete, NULL);
+	spdk_bs_delete_blob(bs, blobid[1], blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_power_failure_counters.unmap_counter < 10);
+	CU_ASSERT(bs->num_reclaim_clusters == 0);
+	CU_ASSERT(bs->reclaim_unmaps_in_flight == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
+
+	for (i = 0; i < SPDK_COUNTOF(blob); i++) {
+		for (j = 0; j < SPDK_COUNTOF(cluster_lba[0]); j++) {
+			offset = cluster_lba[i][j] * dev->blocklen;
+			CU_ASSERT(spdk_mem_all_zero(&g_dev_buffer[offset], cluster_sz));
+		}
+	}
+
+	dev_reset_power_failure_event();
+
+	/* Unloading right after a deletion waits for the clusters to be reclaimed */
+	blob[0] = ut_blob_create_and_open(bs, &opts);
+	blobid[0] = spdk_blob_get_id(blob[0]);
+	spdk_blob_resize(blob[0], 5, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_close(blob[0], blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	g_bserrno = -1;
+	spdk_bs_delete_blob(bs, blobid[0], blob_op_complete, NULL);
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+
+	dev = init_dev();
+	spdk_bs_load(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	CU_ASSERT(spdk_bs_free_cluster_count(g_bs) == free_clusters);
+
+	spdk_bs_unload(g_bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
 static void
 blob_delete(void)
 {
@@ -1692,6 +1902,152 @@ blob_rw_verify_iov_nomem(void)
 	poll_threads();
 }
 
+static uint32_t g_ut_dev_writes;
+static void (*g_ut_dev_writev)(struct spdk_bs_dev *dev, struct spdk_io_channel *channel,
+			       struct iovec *iov, int iovcnt, uint64_t lba, uint32_t lba_count,
+			       struct spdk_bs_dev_cb_args *cb_args);
+
+static void
+ut_count_dev_writev(struct spdk_bs_dev *dev, struct spdk_io_channel *channel,
+		    struct iovec *iov, int iovcnt, uint64_t lba, uint32_t lba_count,
+		    struct spdk_bs_dev_cb_args *cb_args)
+{
+	g_ut_dev_writes++;
+	g_ut_dev_writev(dev, channel, iov, iovcnt, lba, lba_count, cb_args);
+}
+
+static void
+ut_count_dev_write(struct spdk_bs_dev *dev, struct spdk_io_channel *channel, void *payload,
+		   uint64_t lba, uint32_t lba_count, struct spdk_bs_dev_cb_args *cb_args)
+{
+	g_ut_dev_writes++;
+	dev_write(dev, channel, payload, lba, lba_count, cb_args);
+}
+
+static void
+ut_write_batch_cpl(void *cb_arg, int bserrno)
+{
+	uint32_t *completed = cb_arg;
+
+	CU_ASSERT(bserrno == 0);
+	(*completed)++;
+}
+
+static void
+blob_write_batch(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_bs_dev *dev = bs->dev;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel;
+	uint8_t payload_read[8 * BLOCKLEN];
+	uint8_t payload_write[8 * BLOCKLEN];
+	struct iovec iov;
+	uint32_t completed = 0;
+	uint64_t i;
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+
+	blob = ut_blob_create_and_open(bs, NULL);
+
+	spdk_blob_resize(blob, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	for (i = 0; i < sizeof(payload_write); i++) {
+		payload_write[i] = i / BLOCKLEN + 1;
+	}
+
+	g_ut_dev_writes = 0;
+	g_ut_dev_writev = dev->writev;
+	dev->writev = ut_count_dev_writev;
+	dev->write = ut_count_dev_write;
+
+	/* The first write of the stream goes straight to the device, the writes continuing it
+	 * are submitted at once */
+	spdk_blob_io_write(blob, channel, payload_write, 0, 1, ut_write_batch_cpl, &completed);
+	for (i = 1; i < 4; i++) {
+		spdk_blob_io_write(blob, channel, payload_write + i * BLOCKLEN, i, 1,
+				   ut_write_batch_cpl, &completed);
+	}
+	iov.iov_base = payload_write + 4 * BLOCKLEN;
+	iov.iov_len = 2 * BLOCKLEN;
+	spdk_blob_io_writev(blob, channel, &iov, 1, 4, 2, ut_write_batch_cpl, &completed);
+	CU_ASSERT(g_ut_dev_writes == 1);
+	CU_ASSERT(completed == 0);
+	poll_threads();
+	CU_ASSERT(g_ut_dev_writes == 2);
+	CU_ASSERT(completed == 5);
+
+	spdk_blob_io_read(blob, channel, payload_read, 0, 6, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_write, payload_read, 6 * BLOCKLEN) == 0);
+
+	/* A random write submits the held writes first */
+	g_ut_dev_writes = 0;
+	completed = 0;
+	spdk_blob_io_write(blob, channel, payload_write, 6, 1, ut_write_batch_cpl, &completed);
+	CU_ASSERT(g_ut_dev_writes == 0);
+	spdk_blob_io_write(blob, channel, payload_write, 100, 1, ut_write_batch_cpl, &completed);
+	CU_ASSERT(g_ut_dev_writes == 2);
+	poll_threads();
+	CU_ASSERT(g_ut_dev_writes == 2);
+	CU_ASSERT(completed == 2);
+
+	/* Writes reaching the end of the cluster are submitted right away */
+	g_ut_dev_writes = 0;
+	completed = 0;
+	spdk_blob_io_write(blob, channel, payload_write, 252, 2, ut_write_batch_cpl, &completed);
+	spdk_blob_io_write(blob, channel, payload_write, 254, 1, ut_write_batch_cpl, &completed);
+	CU_ASSERT(g_ut_dev_writes == 1);
+	spdk_blob_io_write(blob, channel, payload_write, 255, 1, ut_write_batch_cpl, &completed);
+	CU_ASSERT(g_ut_dev_writes == 2);
+	poll_threads();
+	CU_ASSERT(g_ut_dev_writes == 2);
+	CU_ASSERT(completed == 3);
+
+	/* Batches don't cross the optimal I/O boundary of the device */
+	dev->optimal_io_boundary = 4;
+	g_ut_dev_writes = 0;
+	completed = 0;
+	for (i = 8; i < 16; i++) {
+		spdk_blob_io_write(blob, channel, payload_write, i, 1, ut_write_batch_cpl, &completed);
+	}
+	poll_threads();
+	/* 8, 9-11 and 12-15 */
+	CU_ASSERT(g_ut_dev_writes == 3);
+	CU_ASSERT(completed == 8);
+	dev->optimal_io_boundary = 0;
+
+	/* Held writes complete before the blob I/O is frozen */
+	g_ut_dev_writes = 0;
+	completed = 0;
+	spdk_blob_io_write(blob, channel, payload_write, 32, 1, ut_write_batch_cpl, &completed);
+	spdk_blob_io_write(blob, channel, payload_write, 33, 1, ut_write_batch_cpl, &completed);
+	CU_ASSERT(g_ut_dev_writes == 1);
+	g_bserrno = -1;
+	blob_freeze_io(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_ut_dev_writes == 2);
+	CU_ASSERT(completed == 2);
+	blob_unfreeze_io(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	dev->writev = g_ut_dev_writev;
+	dev->write = dev_write;
+
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+}
+
 static void
 blob_rw_iov_read_only(void)
 {
@@ -3784,56 +4140,225 @@ super_block_crc(void)
  *   verify the third blob, it should correct.
  */
 static void
-blob_dirty_shutdown(void)
+blob_dirty_load_readahead(void)
 {
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	struct spdk_blob *blob;
+	spdk_blob_id blobid[2];
+	char name[32];
+	char *value;
+	const void *read_value;
+	size_t value_len, read_len;
+	uint32_t num_xattrs;
+	uint32_t i;
 	int rc;
-	int index;
-	struct spdk_blob_store *bs = g_bs;
-	spdk_blob_id blobid1, blobid2, blobid3;
-	struct spdk_blob *blob = g_blob;
-	uint64_t length;
-	uint64_t free_clusters;
-	const void *value;
-	size_t value_len;
-	uint32_t page_num;
-	struct spdk_blob_md_page *page;
-	struct spdk_blob_opts blob_opts;
 
-	/* Create first blob */
-	blobid1 = spdk_blob_get_id(blob);
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	bs_opts.num_md_pages = 2 * BS_LOAD_REPLAY_READAHEAD_PAGES;
 
-	/* Set some xattrs */
-	rc = spdk_blob_set_xattr(blob, "name", "log.txt", strlen("log.txt") + 1);
-	CU_ASSERT(rc == 0);
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
 
-	length = 2345;
-	rc = spdk_blob_set_xattr(blob, "length", &length, sizeof(length));
-	CU_ASSERT(rc == 0);
+	/* Only a single xattr of this size fits in an md page, so the md of the first blob
+	 * is a chain of more pages than are read ahead at once during recovery. */
+	value_len = 3000;
+	num_xattrs = BS_LOAD_REPLAY_READAHEAD_PAGES + 16;
+	value = malloc(value_len);
+	SPDK_CU_ASSERT_FATAL(value != NULL);
+	memset(value, 0xA5, value_len);
 
-	/* Put xattr that fits exactly single page.
-	 * This results in adding additional pages to MD.
-	 * First is flags and smaller xattr, second the large xattr,
-	 * third are just the extents.
-	 */
-	size_t xattr_length = 4072 - sizeof(struct spdk_blob_md_descriptor_xattr) -
-			      strlen("large_xattr");
-	char *xattr = calloc(xattr_length, sizeof(char));
-	SPDK_CU_ASSERT_FATAL(xattr != NULL);
-	rc = spdk_blob_set_xattr(blob, "large_xattr", xattr, xattr_length);
-	free(xattr);
-	SPDK_CU_ASSERT_FATAL(rc == 0);
+	ut_spdk_blob_opts_init(&opts);
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid[0] = spdk_blob_get_id(blob);
 
-	/* Resize the blob */
-	spdk_blob_resize(blob, 10, blob_op_complete, NULL);
-	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
+	for (i = 0; i < num_xattrs; i++) {
+		snprintf(name, sizeof(name), "xattr%" PRIu32, i);
+		rc = spdk_blob_set_xattr(blob, name, value, value_len);
+		CU_ASSERT(rc == 0);
+	}
 
-	/* Set the blob as the super blob */
-	spdk_bs_set_super(bs, blobid1, blob_op_complete, NULL);
+	spdk_blob_close(blob, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_bit_array_count_set(bs->used_md_pages) > BS_LOAD_REPLAY_READAHEAD_PAGES);
 
-	free_clusters = spdk_bs_free_cluster_count(bs);
+	/* The second blob lands past the first read ahead window */
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid[1] = spdk_blob_get_id(blob);
+	CU_ASSERT(bs_blobid_to_page(blobid[1]) > BS_LOAD_REPLAY_READAHEAD_PAGES);
+
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	ut_bs_dirty_load(&bs, &bs_opts);
+
+	spdk_bs_open_blob(bs, blobid[0], blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+
+	for (i = 0; i < num_xattrs; i++) {
+		snprintf(name, sizeof(name), "xattr%" PRIu32, i);
+		rc = spdk_blob_get_xattr_value(blob, name, &read_value, &read_len);
+		CU_ASSERT(rc == 0);
+		CU_ASSERT(read_len == value_len);
+	}
+	CU_ASSERT(memcmp(read_value, value, value_len) == 0);
+
+	ut_blob_close_and_delete(bs, blob);
+
+	spdk_bs_open_blob(bs, blobid[1], blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	ut_blob_close_and_delete(bs, g_blob);
+
+	free(value);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+	g_blob = NULL;
+	g_blobid = SPDK_BLOBID_INVALID;
+}
+
+static void
+blob_open_many(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	struct spdk_blob *blob[3 * BS_OPEN_BLOBS_MIN_BUCKETS];
+	spdk_blob_id blobid[SPDK_COUNTOF(blob)];
+	uint32_t i;
+
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	bs_opts.num_md_pages = 4 * BS_OPEN_BLOBS_MIN_BUCKETS;
+
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+
+	CU_ASSERT(bs->num_open_blob_buckets == BS_OPEN_BLOBS_MIN_BUCKETS);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+
+	/* Opening more blobs than there are buckets grows the hash table */
+	for (i = 0; i < SPDK_COUNTOF(blob); i++) {
+		blob[i] = ut_blob_create_and_open(bs, &opts);
+		blobid[i] = spdk_blob_get_id(blob[i]);
+	}
+	CU_ASSERT(bs->num_open_blobs == SPDK_COUNTOF(blob));
+	CU_ASSERT(bs->num_open_blob_buckets >= SPDK_COUNTOF(blob));
+
+	for (i = 0; i < SPDK_COUNTOF(blob); i++) {
+		CU_ASSERT(blob_lookup(bs, blobid[i]) == blob[i]);
+	}
+
+	/* Opening an already open blob returns the same handle */
+	spdk_bs_open_blob(bs, blobid[1], blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_blob == blob[1]);
+	CU_ASSERT(blob[1]->open_ref == 2);
+	spdk_blob_close(blob[1], blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* Closed blobs are not found anymore, the others still are */
+	for (i = 0; i < SPDK_COUNTOF(blob); i += 2) {
+		spdk_blob_close(blob[i], blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
+	for (i = 0; i < SPDK_COUNTOF(blob); i++) {
+		if (i % 2 == 0) {
+			CU_ASSERT(blob_lookup(bs, blobid[i]) == NULL);
+		} else {
+			CU_ASSERT(blob_lookup(bs, blobid[i]) == blob[i]);
+		}
+	}
+
+	for (i = 1; i < SPDK_COUNTOF(blob); i += 2) {
+		spdk_blob_close(blob[i], blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
+	CU_ASSERT(bs->num_open_blobs == 0);
+	g_blob = NULL;
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
+static void
+blob_dirty_shutdown(void)
+{
+	int rc;
+	int index;
+	struct spdk_blob_store *bs = g_bs;
+	spdk_blob_id blobid1, blobid2, blobid3;
+	struct spdk_blob *blob = g_blob;
+	uint64_t length;
+	uint64_t free_clusters;
+	const void *value;
+	size_t value_len;
+	uint32_t page_num;
+	struct spdk_blob_md_page *page;
+	struct spdk_blob_opts blob_opts;
+
+	/* Create first blob */
+	blobid1 = spdk_blob_get_id(blob);
+
+	/* Set some xattrs */
+	rc = spdk_blob_set_xattr(blob, "name", "log.txt", strlen("log.txt") + 1);
+	CU_ASSERT(rc == 0);
+
+	length = 2345;
+	rc = spdk_blob_set_xattr(blob, "length", &length, sizeof(length));
+	CU_ASSERT(rc == 0);
+
+	/* Put xattr that fits exactly single page.
+	 * This results in adding additional pages to MD.
+	 * First is flags and smaller xattr, second the large xattr,
+	 * third are just the extents.
+	 */
+	size_t xattr_length = 4072 - sizeof(struct spdk_blob_md_descriptor_xattr) -
+			      strlen("large_xattr");
+	char *xattr = calloc(xattr_length, sizeof(char));
+	SPDK_CU_ASSERT_FATAL(xattr != NULL);
+	rc = spdk_blob_set_xattr(blob, "large_xattr", xattr, xattr_length);
+	free(xattr);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+
+	/* Resize the blob */
+	spdk_blob_resize(blob, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* Set the blob as the super blob */
+	spdk_bs_set_super(bs, blobid1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
 
 	spdk_blob_close(blob, blob_op_complete, NULL);
 	poll_threads();
@@ -4433,16 +4958,6 @@ blob_insert_cluster_msg_test(void)
 	struct spdk_blob_store *bs = g_bs;
 	struct spdk_blob *blob;
 	struct spdk_blob_opts opts;
-	/* For now, even if md_page_size is > 4KB, we still only use the first
-	 * 4KB of it. The rest is left unused. Future changes may allow using the
-	 * rest of the md_page, but that will require more extensive changes since
-	 * then the struct spdk_blob_md_page cannot be used directly (since some
-	 * fields such as crc would have variable placement in the struct).
-	 */
-	struct {
-		struct spdk_blob_md_page page;
-		uint8_t pad[DEV_MAX_PHYS_BLOCKLEN - sizeof(struct spdk_blob_md_page)];
-	} md = {};
 	spdk_blob_id blobid;
 	uint64_t free_clusters;
 	uint64_t new_cluster = 0;
@@ -4472,7 +4987,7 @@ blob_insert_cluster_msg_test(void)
 	CU_ASSERT(blob->active.clusters[cluster_num] == 0);
 	spdk_spin_unlock(&bs->used_lock);
 
-	blob_insert_cluster_on_md_thread(blob, cluster_num, new_cluster, extent_page, &md.page,
+	blob_insert_cluster_on_md_thread(blob, cluster_num, new_cluster, extent_page,
 					 blob_op_complete, NULL);
 	poll_threads();
 
@@ -4495,6 +5010,96 @@ blob_insert_cluster_msg_test(void)
 	ut_blob_close_and_delete(bs, blob);
 }
 
+static void
+blob_thin_prov_ep_batch(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *ch[2];
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid;
+	uint8_t payload_write[BLOCKLEN];
+	uint64_t io_units_per_cluster;
+	uint64_t free_clusters;
+	uint64_t write_bytes;
+	uint64_t io_unit_size;
+	int bserrno[2];
+	int i;
+
+	if (!g_use_extent_table) {
+		/* Only the extent pages are batched */
+		return;
+	}
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	io_unit_size = spdk_bs_get_io_unit_size(bs);
+	io_units_per_cluster = spdk_bs_get_cluster_size(bs) / io_unit_size;
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 4;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+
+	for (i = 0; i < 2; i++) {
+		set_thread(i);
+		ch[i] = spdk_bs_alloc_io_channel(bs);
+		SPDK_CU_ASSERT_FATAL(ch[i] != NULL);
+	}
+
+	/* The first write allocates the extent page */
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	set_thread(0);
+	g_bserrno = -1;
+	spdk_blob_io_write(blob, ch[0], payload_write, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->active.extent_pages[0] != 0);
+
+	/* Allocate two more clusters at once from different threads. Both updates of the
+	 * extent page are coalesced into a single md page write. */
+	write_bytes = g_dev_write_bytes;
+	for (i = 0; i < 2; i++) {
+		set_thread(i);
+		bserrno[i] = -1;
+		spdk_blob_io_write(blob, ch[i], payload_write, io_units_per_cluster * (i + 1), 1,
+				   blob_op_complete, &bserrno[i]);
+	}
+	poll_threads();
+	CU_ASSERT(bserrno[0] == 0);
+	CU_ASSERT(bserrno[1] == 0);
+	CU_ASSERT(g_dev_write_bytes - write_bytes == 2 * io_unit_size + spdk_bs_get_page_size(bs));
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 3);
+	CU_ASSERT(free_clusters - 3 == spdk_bs_free_cluster_count(bs));
+	CU_ASSERT(TAILQ_EMPTY(&bs->ep_updates));
+	CU_ASSERT(!bs->ep_batch_in_progress);
+
+	for (i = 0; i < 2; i++) {
+		set_thread(i);
+		spdk_bs_free_io_channel(ch[i]);
+	}
+	set_thread(0);
+	poll_threads();
+
+	/* The extent page holds all three clusters */
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	ut_bs_reload(&bs, NULL);
+
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 3);
+
+	ut_blob_close_and_delete(bs, blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+}
+
 static void
 blob_thin_prov_rw(void)
 {
@@ -4635,117 +5240,464 @@ blob_thin_prov_write_count_io(void)
 	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
 	bs = g_bs;
 
-	free_clusters = spdk_bs_free_cluster_count(bs);
-	io_unit_size = spdk_bs_get_io_unit_size(bs);
-	io_units_per_cluster = CLUSTER_SZ / io_unit_size;
-	io_units_per_extent_page = SPDK_EXTENTS_PER_EP * io_units_per_cluster;
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	io_unit_size = spdk_bs_get_io_unit_size(bs);
+	io_units_per_cluster = CLUSTER_SZ / io_unit_size;
+	io_units_per_extent_page = SPDK_EXTENTS_PER_EP * io_units_per_cluster;
+
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+
+	/* Resize the blob so that it will require 8 extent pages to hold all of
+	 * the clusters.
+	 */
+	g_bserrno = -1;
+	spdk_blob_resize(blob, SPDK_EXTENTS_PER_EP * 8, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	g_bserrno = -1;
+	spdk_blob_sync_md(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+	CU_ASSERT(blob->active.num_clusters == SPDK_EXTENTS_PER_EP * 8);
+
+	memset(payload_write, 0, sizeof(payload_write));
+	for (i = 0; i < 8; i++) {
+		write_bytes = g_dev_write_bytes;
+		read_bytes = g_dev_read_bytes;
+
+		g_bserrno = -1;
+		spdk_blob_io_write(blob, ch, payload_write, io_units_per_extent_page * i, 1, blob_op_complete,
+				   NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(free_clusters - (2 * i + 1) == spdk_bs_free_cluster_count(bs));
+
+		CU_ASSERT(g_dev_read_bytes == read_bytes);
+		if (!g_use_extent_table) {
+			/* For legacy metadata, we should have written the io_unit for
+			 * the write I/O, plus the blob's primary metadata page
+			 */
+			expected_bytes = io_unit_size + spdk_bs_get_page_size(bs);
+		} else {
+			/* For extent table metadata, we should have written the io_unit for
+			 * the write I/O, plus 2 metadata pages - the extent page and the
+			 * blob's primary metadata page
+			 */
+			expected_bytes = io_unit_size + 2 * spdk_bs_get_page_size(bs);
+		}
+		CU_ASSERT((g_dev_write_bytes - write_bytes) == expected_bytes);
+
+		/* The write should have synced the metadata already.  Do another sync here
+		 * just to confirm.
+		 */
+		write_bytes = g_dev_write_bytes;
+		read_bytes = g_dev_read_bytes;
+
+		g_bserrno = -1;
+		spdk_blob_sync_md(blob, blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(free_clusters - (2 * i + 1) == spdk_bs_free_cluster_count(bs));
+		CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 2 * i + 1);
+
+		CU_ASSERT(g_dev_read_bytes == read_bytes);
+		CU_ASSERT(g_dev_write_bytes == write_bytes);
+
+		/* Now write to another unallocated cluster that is part of the same extent page. */
+		g_bserrno = -1;
+		spdk_blob_io_write(blob, ch, payload_write, io_units_per_extent_page * i + io_units_per_cluster,
+				   1, blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(free_clusters - (2 * i + 2) == spdk_bs_free_cluster_count(bs));
+		CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 2 * i + 2);
+
+		CU_ASSERT(g_dev_read_bytes == read_bytes);
+		/*
+		 * For legacy metadata, we should have written the I/O and the primary metadata page.
+		 * For extent table metadata, we should have written the I/O and the extent metadata page.
+		 */
+		expected_bytes = io_unit_size + spdk_bs_get_page_size(bs);
+		CU_ASSERT((g_dev_write_bytes - write_bytes) == expected_bytes);
+
+		/* Send unmap aligned to the whole cluster - should free it up */
+		g_bserrno = -1;
+		spdk_blob_io_unmap(blob, ch, io_units_per_extent_page * i, io_units_per_cluster, blob_op_complete,
+				   NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(free_clusters - (2 * i + 1) == spdk_bs_free_cluster_count(bs));
+
+		/* Write back to the freed cluster */
+		g_bserrno = -1;
+		spdk_blob_io_write(blob, ch, payload_write, io_units_per_extent_page * i, 1, blob_op_complete,
+				   NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(free_clusters - (2 * i + 2) == spdk_bs_free_cluster_count(bs));
+	}
+
+	ut_blob_close_and_delete(bs, blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+	g_blob = NULL;
+	g_blobid = 0;
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
+static void
+blob_load_extent_pages_batch(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *ch;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid;
+	uint8_t payload_write[BLOCKLEN];
+	uint8_t payload_read[BLOCKLEN];
+	const uint32_t CLUSTER_SZ = g_phys_blocklen * 4;
+	const uint32_t NUM_EXTENT_PAGES = 3 * BLOB_LOAD_EXTENT_PAGES_BATCH;
+	uint64_t io_units_per_extent_page;
+	uint64_t num_allocated = 0;
+	uint32_t i;
+
+	if (!g_use_extent_table) {
+		return;
+	}
+
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	bs_opts.cluster_sz = CLUSTER_SZ;
+
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+
+	io_units_per_extent_page = SPDK_EXTENTS_PER_EP * CLUSTER_SZ / spdk_bs_get_io_unit_size(bs);
+
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = SPDK_EXTENTS_PER_EP * NUM_EXTENT_PAGES;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+
+	/* Allocate a cluster in two out of every three extent pages, so that more than one
+	 * batch of extent pages has to be read and unallocated extent pages are mixed in. */
+	for (i = 0; i < NUM_EXTENT_PAGES; i++) {
+		if (i % 3 == 2) {
+			continue;
+		}
+		memset(payload_write, i, sizeof(payload_write));
+		spdk_blob_io_write(blob, ch, payload_write, io_units_per_extent_page * i, 1,
+				   blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		num_allocated++;
+	}
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == num_allocated);
+
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	ut_bs_reload(&bs, &bs_opts);
+
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+
+	CU_ASSERT(spdk_blob_get_num_clusters(blob) == SPDK_EXTENTS_PER_EP * NUM_EXTENT_PAGES);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == num_allocated);
+
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	for (i = 0; i < NUM_EXTENT_PAGES; i++) {
+		CU_ASSERT(bs_io_unit_is_allocated(blob, io_units_per_extent_page * i) == (i % 3 != 2));
+		memset(payload_write, i % 3 == 2 ? 0 : i, sizeof(payload_write));
+		memset(payload_read, 0xFF, sizeof(payload_read));
+		spdk_blob_io_read(blob, ch, payload_read, io_units_per_extent_page * i, 1,
+				  blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(memcmp(payload_write, payload_read, sizeof(payload_read)) == 0);
+	}
+
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+
+	ut_blob_close_and_delete(bs, blob);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
+static void
+blob_thin_prov_reserved_clusters(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *ch;
+	struct spdk_bs_channel *bs_ch;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid;
+	uint64_t free_clusters;
+	uint8_t payload_write[BLOCKLEN];
+	const uint32_t CLUSTER_SZ = g_phys_blocklen * 4;
+	uint32_t io_units_per_cluster;
+	uint32_t cluster;
+	uint32_t i;
+
+	/* Use a small cluster size, so that the blobstore has enough free clusters
+	 * for the channels to reserve them. */
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	bs_opts.cluster_sz = CLUSTER_SZ;
+
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	io_units_per_cluster = CLUSTER_SZ / spdk_bs_get_io_unit_size(bs);
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 64;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+
+	/* Do the I/O on a thread other than the md thread, so that the channel is
+	 * destroyed once it is freed. */
+	set_thread(1);
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	bs_ch = spdk_io_channel_get_ctx(ch);
+
+	/* The first write to a cluster takes it from the clusters reserved by the channel.
+	 * With the extent table, the first cluster of an extent page is still allocated
+	 * from the pool to claim the md page along with it. */
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	for (i = 0; i < 2; i++) {
+		g_bserrno = -1;
+		spdk_blob_io_write(blob, ch, payload_write, io_units_per_cluster * i, 1,
+				   blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(free_clusters - (i + 1) == spdk_bs_free_cluster_count(bs));
+		CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == i + 1);
+	}
+
+	SPDK_CU_ASSERT_FATAL(bs_ch->next_reserved_cluster > 0);
+	CU_ASSERT(bs_ch->num_reserved_clusters == SPDK_BS_CHANNEL_RESERVED_CLUSTERS);
+	CU_ASSERT(bs->num_reserved_clusters ==
+		  bs_ch->num_reserved_clusters - bs_ch->next_reserved_cluster);
+	cluster = bs_ch->reserved_clusters[bs_ch->next_reserved_cluster - 1];
+	CU_ASSERT(blob->active.clusters[1] == bs_cluster_to_lba(bs, cluster));
+	CU_ASSERT(spdk_bit_pool_is_allocated(bs->used_clusters, cluster));
+	/* Reserved clusters are claimed in the pool, but still reported as free */
+	CU_ASSERT(bs->num_free_clusters + bs->num_reserved_clusters == spdk_bs_free_cluster_count(bs));
+	cluster = bs_ch->reserved_clusters[bs_ch->next_reserved_cluster];
+	CU_ASSERT(spdk_bit_pool_is_allocated(bs->used_clusters, cluster));
+
+	/* Channel destruction gives the unused clusters back to the pool */
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+	CU_ASSERT(bs->num_free_clusters == free_clusters - 2);
+	CU_ASSERT(!spdk_bit_pool_is_allocated(bs->used_clusters, cluster));
+
+	/* A new channel reserves clusters again */
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	bs_ch = spdk_io_channel_get_ctx(ch);
+
+	g_bserrno = -1;
+	spdk_blob_io_write(blob, ch, payload_write, io_units_per_cluster * 2, 1,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs_ch->next_reserved_cluster == 1);
+	CU_ASSERT(bs->num_reserved_clusters == SPDK_BS_CHANNEL_RESERVED_CLUSTERS - 1);
+	CU_ASSERT(free_clusters - 3 == spdk_bs_free_cluster_count(bs));
+
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+	set_thread(0);
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* None of the reserved clusters is left allocated after reload */
+	ut_bs_reload(&bs, &bs_opts);
+	CU_ASSERT(free_clusters - 3 == spdk_bs_free_cluster_count(bs));
+
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 3);
+
+	ut_blob_close_and_delete(bs, blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+	g_blob = NULL;
+	g_blobid = 0;
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
+static void
+blob_thin_prov_reserved_clusters_allocate(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_blob *blob, *thick_blob;
+	struct spdk_io_channel *ch, *md_ch;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid;
+	uint64_t free_clusters;
+	uint8_t payload_write[BLOCKLEN];
+	const uint32_t CLUSTER_SZ = g_phys_blocklen * 4;
+	uint32_t io_units_per_cluster;
+	uint32_t i;
+
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	bs_opts.cluster_sz = CLUSTER_SZ;
+
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	io_units_per_cluster = CLUSTER_SZ / spdk_bs_get_io_unit_size(bs);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 64;
+	blob = ut_blob_create_and_open(bs, &opts);
 
+	/* Make a channel on another thread reserve clusters and keep it around. With the extent
+	 * table, the first cluster of an extent page is allocated from the pool. */
+	set_thread(1);
 	ch = spdk_bs_alloc_io_channel(bs);
 	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	for (i = 0; i < 2; i++) {
+		g_bserrno = -1;
+		spdk_blob_io_write(blob, ch, payload_write, io_units_per_cluster * i, 1,
+				   blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
+	set_thread(0);
+	CU_ASSERT(bs->num_reserved_clusters > 0);
 
+	/* A thick blob can be resized to all the clusters reported as free */
+	free_clusters = spdk_bs_free_cluster_count(bs);
 	ut_spdk_blob_opts_init(&opts);
-	opts.thin_provision = true;
-
-	blob = ut_blob_create_and_open(bs, &opts);
-	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
-
-	/* Resize the blob so that it will require 8 extent pages to hold all of
-	 * the clusters.
-	 */
-	g_bserrno = -1;
-	spdk_blob_resize(blob, SPDK_EXTENTS_PER_EP * 8, blob_op_complete, NULL);
+	thick_blob = ut_blob_create_and_open(bs, &opts);
+	spdk_blob_resize(thick_blob, free_clusters, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+	ut_blob_close_and_delete(bs, thick_blob);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
 
+	/* Same for a thick blob created with all of them */
+	set_thread(1);
 	g_bserrno = -1;
-	spdk_blob_sync_md(blob, blob_op_complete, NULL);
+	spdk_blob_io_write(blob, ch, payload_write, io_units_per_cluster * 2, 1,
+			   blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
-	CU_ASSERT(blob->active.num_clusters == SPDK_EXTENTS_PER_EP * 8);
-
-	memset(payload_write, 0, sizeof(payload_write));
-	for (i = 0; i < 8; i++) {
-		write_bytes = g_dev_write_bytes;
-		read_bytes = g_dev_read_bytes;
-
-		g_bserrno = -1;
-		spdk_blob_io_write(blob, ch, payload_write, io_units_per_extent_page * i, 1, blob_op_complete,
-				   NULL);
-		poll_threads();
-		CU_ASSERT(g_bserrno == 0);
-		CU_ASSERT(free_clusters - (2 * i + 1) == spdk_bs_free_cluster_count(bs));
-
-		CU_ASSERT(g_dev_read_bytes == read_bytes);
-		if (!g_use_extent_table) {
-			/* For legacy metadata, we should have written the io_unit for
-			 * the write I/O, plus the blob's primary metadata page
-			 */
-			expected_bytes = io_unit_size + spdk_bs_get_page_size(bs);
-		} else {
-			/* For extent table metadata, we should have written the io_unit for
-			 * the write I/O, plus 2 metadata pages - the extent page and the
-			 * blob's primary metadata page
-			 */
-			expected_bytes = io_unit_size + 2 * spdk_bs_get_page_size(bs);
-		}
-		CU_ASSERT((g_dev_write_bytes - write_bytes) == expected_bytes);
-
-		/* The write should have synced the metadata already.  Do another sync here
-		 * just to confirm.
-		 */
-		write_bytes = g_dev_write_bytes;
-		read_bytes = g_dev_read_bytes;
-
-		g_bserrno = -1;
-		spdk_blob_sync_md(blob, blob_op_complete, NULL);
-		poll_threads();
-		CU_ASSERT(g_bserrno == 0);
-		CU_ASSERT(free_clusters - (2 * i + 1) == spdk_bs_free_cluster_count(bs));
-		CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 2 * i + 1);
-
-		CU_ASSERT(g_dev_read_bytes == read_bytes);
-		CU_ASSERT(g_dev_write_bytes == write_bytes);
-
-		/* Now write to another unallocated cluster that is part of the same extent page. */
-		g_bserrno = -1;
-		spdk_blob_io_write(blob, ch, payload_write, io_units_per_extent_page * i + io_units_per_cluster,
-				   1, blob_op_complete, NULL);
-		poll_threads();
-		CU_ASSERT(g_bserrno == 0);
-		CU_ASSERT(free_clusters - (2 * i + 2) == spdk_bs_free_cluster_count(bs));
-		CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 2 * i + 2);
-
-		CU_ASSERT(g_dev_read_bytes == read_bytes);
-		/*
-		 * For legacy metadata, we should have written the I/O and the primary metadata page.
-		 * For extent table metadata, we should have written the I/O and the extent metadata page.
-		 */
-		expected_bytes = io_unit_size + spdk_bs_get_page_size(bs);
-		CU_ASSERT((g_dev_write_bytes - write_bytes) == expected_bytes);
+	set_thread(0);
+	CU_ASSERT(bs->num_reserved_clusters > 0);
 
-		/* Send unmap aligned to the whole cluster - should free it up */
-		g_bserrno = -1;
-		spdk_blob_io_unmap(blob, ch, io_units_per_extent_page * i, io_units_per_cluster, blob_op_complete,
-				   NULL);
-		poll_threads();
-		CU_ASSERT(g_bserrno == 0);
-		CU_ASSERT(free_clusters - (2 * i + 1) == spdk_bs_free_cluster_count(bs));
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	ut_spdk_blob_opts_init(&opts);
+	opts.num_clusters = free_clusters;
+	thick_blob = ut_blob_create_and_open(bs, &opts);
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+	ut_blob_close_and_delete(bs, thick_blob);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
 
-		/* Write back to the freed cluster */
-		g_bserrno = -1;
-		spdk_blob_io_write(blob, ch, payload_write, io_units_per_extent_page * i, 1, blob_op_complete,
-				   NULL);
-		poll_threads();
-		CU_ASSERT(g_bserrno == 0);
-		CU_ASSERT(free_clusters - (2 * i + 2) == spdk_bs_free_cluster_count(bs));
-	}
+	/* And for the inflation of a thin blob needing all of them */
+	set_thread(1);
+	g_bserrno = -1;
+	spdk_blob_io_write(blob, ch, payload_write, io_units_per_cluster * 3, 1,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	set_thread(0);
+	CU_ASSERT(bs->num_reserved_clusters > 0);
 
-	ut_blob_close_and_delete(bs, blob);
-	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = free_clusters;
+	thick_blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(thick_blob);
+	md_ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(md_ch != NULL);
+	spdk_bs_inflate_blob(bs, md_ch, blobid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(thick_blob) == free_clusters);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+	spdk_bs_free_io_channel(md_ch);
+	poll_threads();
+	ut_blob_close_and_delete(bs, thick_blob);
 
+	set_thread(1);
 	spdk_bs_free_io_channel(ch);
 	poll_threads();
+	set_thread(0);
+	ut_blob_close_and_delete(bs, blob);
 	g_blob = NULL;
 	g_blobid = 0;
 
@@ -5797,6 +6749,123 @@ _blob_inflate_rw(bool decouple_parent)
 	ut_blob_close_and_delete(bs, blob);
 }
 
+static struct spdk_blob *
+ut_chain_cache_lookup(struct spdk_io_channel *channel, struct spdk_blob *blob, uint64_t cluster)
+{
+	struct spdk_bs_channel *ch = spdk_io_channel_get_ctx(channel);
+	uint64_t gen = blob->bs->chain_gen;
+	uint32_t i;
+
+	for (i = 0; i < SPDK_BS_CHANNEL_CHAIN_CACHE_SIZE; i++) {
+		if (ch->chain_cache[i].blob == blob && ch->chain_cache[i].cluster == cluster &&
+		    ch->chain_cache[i].gen == gen) {
+			return ch->chain_cache[i].ancestor;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+blob_snapshot_chain_read(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel;
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid, snapshotid[4];
+	uint64_t io_units_per_cluster;
+	uint8_t payload_read[BLOCKLEN];
+	uint8_t payload_write[BLOCKLEN];
+	uint64_t gen;
+	uint32_t i;
+
+	io_units_per_cluster = spdk_bs_get_cluster_size(bs) / spdk_bs_get_io_unit_size(bs);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 5;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+
+	/* Build a chain of 4 snapshots, cluster i is allocated only in snapshot i */
+	for (i = 0; i < SPDK_COUNTOF(snapshotid); i++) {
+		memset(payload_write, i + 1, sizeof(payload_write));
+		spdk_blob_io_write(blob, channel, payload_write, i * io_units_per_cluster, 1,
+				   blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+
+		spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
+		snapshotid[i] = g_blobid;
+	}
+
+	/* Reads resolve to the snapshot holding the cluster, or to the oldest snapshot */
+	for (i = 0; i <= SPDK_COUNTOF(snapshotid); i++) {
+		memset(payload_write, i < SPDK_COUNTOF(snapshotid) ? i + 1 : 0, sizeof(payload_write));
+		memset(payload_read, 0xFF, sizeof(payload_read));
+		spdk_blob_io_read(blob, channel, payload_read, i * io_units_per_cluster, 1,
+				  blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(memcmp(payload_write, payload_read, sizeof(payload_read)) == 0);
+		CU_ASSERT(ut_chain_cache_lookup(channel, blob, i) ==
+			  blob_lookup(bs, snapshotid[i < SPDK_COUNTOF(snapshotid) ? i : 0]));
+	}
+
+	/* Deleting a snapshot in the middle of the chain invalidates the cache */
+	gen = bs->chain_gen;
+	spdk_bs_delete_blob(bs, snapshotid[1], blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs->chain_gen != gen);
+	CU_ASSERT(ut_chain_cache_lookup(channel, blob, 1) == NULL);
+
+	memset(payload_write, 2, sizeof(payload_write));
+	memset(payload_read, 0xFF, sizeof(payload_read));
+	spdk_blob_io_read(blob, channel, payload_read, io_units_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_write, payload_read, sizeof(payload_read)) == 0);
+	CU_ASSERT(ut_chain_cache_lookup(channel, blob, 1) == blob_lookup(bs, snapshotid[2]));
+
+	/* Once inflated, the blob does not go through its ancestors anymore */
+	spdk_bs_inflate_blob(bs, channel, blobid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	for (i = 0; i < SPDK_COUNTOF(snapshotid); i++) {
+		memset(payload_write, i + 1, sizeof(payload_write));
+		memset(payload_read, 0xFF, sizeof(payload_read));
+		spdk_blob_io_read(blob, channel, payload_read, i * io_units_per_cluster, 1,
+				  blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(memcmp(payload_write, payload_read, sizeof(payload_read)) == 0);
+		CU_ASSERT(ut_chain_cache_lookup(channel, blob, i) == NULL);
+	}
+
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+
+	ut_blob_close_and_delete(bs, blob);
+	for (i = SPDK_COUNTOF(snapshotid); i > 0; i--) {
+		if (i - 1 == 1) {
+			continue;
+		}
+		spdk_bs_delete_blob(bs, snapshotid[i - 1], blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
+}
+
 static void
 blob_inflate_rw(void)
 {
@@ -9122,6 +10191,109 @@ blob_esnap_clone_decouple(void)
 	_blob_esnap_clone_hydrate(false);
 }
 
+static void
+blob_esnap_copy_on_read(void)
+{
+	struct spdk_blob_store	*bs = g_bs;
+	struct spdk_blob_opts	opts;
+	struct ut_esnap_opts	esnap_opts;
+	struct spdk_blob	*blob, *plain;
+	struct spdk_io_channel	*ch;
+	struct ut_esnap_channel	*ut_ch;
+	const uint32_t		blocklen = bs->io_unit_size;
+	const uint64_t		blocks_per_cluster = bs->cluster_sz / blocklen;
+	const uint64_t		num_clusters = 4;
+	char			buf[2][blocklen];
+	uint64_t		blocks_read;
+	int			rc;
+
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* Create and open the esnap clone */
+	ut_esnap_opts_init(blocklen, num_clusters * blocks_per_cluster, __func__, NULL, &esnap_opts);
+	ut_spdk_blob_opts_init(&opts);
+	opts.esnap_id = &esnap_opts;
+	opts.esnap_id_len = sizeof(esnap_opts);
+	opts.num_clusters = num_clusters;
+	blob = ut_blob_create_and_open(bs, &opts);
+	SPDK_CU_ASSERT_FATAL(blob != NULL);
+
+	/* Copy-on-read is only for esnap clones */
+	plain = ut_blob_create_and_open(bs, NULL);
+	SPDK_CU_ASSERT_FATAL(plain != NULL);
+	rc = spdk_blob_set_esnap_copy_on_read(plain, 10);
+	CU_ASSERT(rc == -EINVAL);
+	ut_blob_close_and_delete(bs, plain);
+
+	/* Disabled by default: reads are served by the esnap */
+	spdk_blob_io_read(blob, ch, buf[0], 0, 1, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 0);
+	ut_ch = ut_esnap_get_io_channel(ch, blob->id);
+	SPDK_CU_ASSERT_FATAL(ut_ch != NULL);
+	CU_ASSERT(ut_ch->blocks_read == 1);
+
+	/* Two reads of a cluster copy it once, then read it locally */
+	rc = spdk_blob_set_esnap_copy_on_read(blob, 1);
+	CU_ASSERT(rc == 0);
+	blocks_read = ut_ch->blocks_read;
+	memset(buf, 0, sizeof(buf));
+	spdk_blob_io_read(blob, ch, buf[0], 0, 1, bs_op_complete, NULL);
+	spdk_blob_io_read(blob, ch, buf[1], 1, 1, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 1);
+	CU_ASSERT(ut_ch->blocks_read == blocks_read + blocks_per_cluster);
+	CU_ASSERT(ut_esnap_content_is_correct(buf[0], blocklen, blob->id, 0, blocklen));
+	CU_ASSERT(ut_esnap_content_is_correct(buf[1], blocklen, blob->id, blocklen, blocklen));
+
+	blocks_read = ut_ch->blocks_read;
+	spdk_blob_io_read(blob, ch, buf[0], 2, 1, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(ut_ch->blocks_read == blocks_read);
+	CU_ASSERT(ut_esnap_content_is_correct(buf[0], blocklen, blob->id, 2 * blocklen, blocklen));
+
+	/* Over the rate, reads are served by the esnap until a copy is allowed again */
+	blocks_read = ut_ch->blocks_read;
+	spdk_blob_io_read(blob, ch, buf[0], blocks_per_cluster, 1, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 1);
+	CU_ASSERT(ut_ch->blocks_read == blocks_read + 1);
+
+	spdk_delay_us(1000000);
+	spdk_blob_io_read(blob, ch, buf[0], blocks_per_cluster, 1, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 2);
+	CU_ASSERT(ut_esnap_content_is_correct(buf[0], blocklen, blob->id,
+					      blocks_per_cluster * blocklen, blocklen));
+
+	/* Disable it again */
+	rc = spdk_blob_set_esnap_copy_on_read(blob, 0);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(1000000);
+	spdk_blob_io_read(blob, ch, buf[0], 2 * blocks_per_cluster, 1, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 2);
+
+	/* A read-only blob can't be written by copies */
+	spdk_blob_set_read_only(blob);
+	spdk_blob_sync_md(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	rc = spdk_blob_set_esnap_copy_on_read(blob, 1);
+	CU_ASSERT(rc == -EPERM);
+
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+	ut_blob_close_and_delete(bs, blob);
+}
+
 static void
 blob_esnap_hotplug(void)
 {
@@ -10208,6 +11380,7 @@ main(int argc, char **argv)
 		CU_ADD_TEST(suite_blob, blob_rw_verify);
 		CU_ADD_TEST(suite_bs, blob_rw_verify_iov);
 		CU_ADD_TEST(suite_blob, blob_rw_verify_iov_nomem);
+		CU_ADD_TEST(suite_bs, blob_write_batch);
 		CU_ADD_TEST(suite_blob, blob_rw_iov_read_only);
 		CU_ADD_TEST(suite_bs, blob_unmap);
 		CU_ADD_TEST(suite_bs, blob_iter);
@@ -10238,13 +11411,22 @@ main(int argc, char **argv)
 		CU_ADD_TEST(suite_bs, blob_set_xattrs_test);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_alloc);
 		CU_ADD_TEST(suite_bs, blob_insert_cluster_msg_test);
+		CU_ADD_TEST(suite_bs, blob_thin_prov_ep_batch);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_rw);
 		CU_ADD_TEST(suite, blob_thin_prov_write_count_io);
+		CU_ADD_TEST(suite, blob_load_extent_pages_batch);
+		CU_ADD_TEST(suite, blob_inflate_parallel_copies);
+		CU_ADD_TEST(suite, blob_reclaim_unmap);
+		CU_ADD_TEST(suite, blob_thin_prov_reserved_clusters);
+		CU_ADD_TEST(suite, blob_thin_prov_reserved_clusters_allocate);
 		CU_ADD_TEST(suite, blob_thin_prov_unmap_cluster);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_rle);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_rw_iov);
 		CU_ADD_TEST(suite, bs_load_iter_test);
+		CU_ADD_TEST(suite, blob_dirty_load_readahead);
+		CU_ADD_TEST(suite, blob_open_many);
 		CU_ADD_TEST(suite_bs, blob_snapshot_rw);
+		CU_ADD_TEST(suite_bs, blob_snapshot_chain_read);
 		CU_ADD_TEST(suite_bs, blob_snapshot_rw_iov);
 		CU_ADD_TEST(suite, blob_relations);
 		CU_ADD_TEST(suite, blob_relations2);
@@ -10273,6 +11455,7 @@ main(int argc, char **argv)
 		CU_ADD_TEST(suite_esnap_bs, blob_esnap_clone_snapshot);
 		CU_ADD_TEST(suite_esnap_bs, blob_esnap_clone_inflate);
 		CU_ADD_TEST(suite_esnap_bs, blob_esnap_clone_decouple);
+		CU_ADD_TEST(suite_esnap_bs, blob_esnap_copy_on_read);
 		CU_ADD_TEST(suite_esnap_bs, blob_esnap_clone_reload);
 		CU_ADD_TEST(suite_esnap_bs, blob_esnap_hotplug);
 		CU_ADD_TEST(suite_blob, blob_is_degraded);
@@ -15,6 +15,7 @@ static void ut_put_io_channel(struct spdk_io_channel *ch);
 DEFINE_STUB(spdk_bdev_io_type_supported, bool, (struct spdk_bdev *bdev,
 		enum spdk_bdev_io_type io_type), false);
 DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *g_bdev_io));
+DEFINE_STUB(spdk_bdev_get_optimal_io_boundary, uint32_t, (const struct spdk_bdev *bdev), 0);
 DEFINE_STUB(spdk_bdev_queue_io_wait, int,
 	    (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
 	     struct spdk_bdev_io_wait_entry *entry), 0);
@@ -102,6 +102,52 @@ blobfs_tree_op_test(void)
 	free(tree);
 }
 
+static void
+blobfs_tree_free_limit_test(void)
+{
+	struct cache_tree *tree;
+	struct cache_buffer *buffer;
+	uint32_t i;
+
+	tree = calloc(1, sizeof(*tree));
+	SPDK_CU_ASSERT_FATAL(tree != NULL);
+
+	/* Spread the buffers over two level 0 subtrees */
+	for (i = 0; i < 8; i++) {
+		buffer = calloc(1, sizeof(*buffer));
+		SPDK_CU_ASSERT_FATAL(buffer != NULL);
+		buffer->offset = (i % 2) * CACHE_TREE_LEVEL_SIZE(1) + (i / 2) * CACHE_BUFFER_SIZE;
+		tree = tree_insert_buffer(tree, buffer);
+	}
+	CU_ASSERT(tree->level == 1);
+
+	/* A buffer still being read cannot be freed */
+	buffer = tree_find_buffer(tree, 0);
+	SPDK_CU_ASSERT_FATAL(buffer != NULL);
+	buffer->in_progress = true;
+
+	CU_ASSERT(tree_free_buffers_limit(tree, 2) == 2);
+	CU_ASSERT(tree_find_buffer(tree, 0) == buffer);
+	CU_ASSERT(tree_find_buffer(tree, CACHE_BUFFER_SIZE) == NULL);
+	CU_ASSERT(tree_find_buffer(tree, 2 * CACHE_BUFFER_SIZE) == NULL);
+	CU_ASSERT(tree_find_buffer(tree, 3 * CACHE_BUFFER_SIZE) != NULL);
+
+	CU_ASSERT(tree_free_buffers_limit(tree, 3) == 3);
+	CU_ASSERT(tree_find_buffer(tree, 3 * CACHE_BUFFER_SIZE) == NULL);
+	CU_ASSERT(tree_find_buffer(tree, CACHE_TREE_LEVEL_SIZE(1)) == NULL);
+	CU_ASSERT(tree_find_buffer(tree, CACHE_TREE_LEVEL_SIZE(1) + CACHE_BUFFER_SIZE) == NULL);
+	CU_ASSERT(tree_find_buffer(tree, CACHE_TREE_LEVEL_SIZE(1) + 2 * CACHE_BUFFER_SIZE) != NULL);
+
+	CU_ASSERT(tree_free_buffers_limit(tree, UINT32_MAX) == 2);
+	CU_ASSERT(tree->present_mask == 0x1ULL);
+
+	buffer->in_progress = false;
+	CU_ASSERT(tree_free_buffers_limit(tree, UINT32_MAX) == 1);
+	CU_ASSERT(tree->present_mask == 0);
+
+	free(tree);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -112,6 +158,7 @@ main(int argc, char **argv)
 
 	suite = CU_add_suite("tree", NULL, NULL);
 	CU_ADD_TEST(suite, blobfs_tree_op_test);
+	CU_ADD_TEST(suite, blobfs_tree_free_limit_test);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
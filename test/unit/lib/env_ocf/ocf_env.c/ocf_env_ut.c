@@ -0,0 +1,83 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "common/lib/test_env.c"
+
+#include "env_ocf/ocf_env.c"
+
+static void
+test_execution_context(void)
+{
+	unsigned cpus = g_exec_context_cpus;
+	unsigned ctx;
+
+	SPDK_CU_ASSERT_FATAL(cpus > 0);
+	CU_ASSERT(env_get_execution_context_count() == cpus * 2);
+
+	/* A reactor owns the context of its core, no lock is taken */
+	MOCK_SET(spdk_env_get_current_core, cpus - 1);
+	ctx = env_get_execution_context();
+	CU_ASSERT(ctx == cpus - 1);
+	CU_ASSERT(pthread_mutex_trylock(&exec_context_mutex[ctx]) == 0);
+	pthread_mutex_unlock(&exec_context_mutex[ctx]);
+	env_put_execution_context(ctx);
+
+	/* Other threads lock one of the shared contexts */
+	MOCK_SET(spdk_env_get_current_core, SPDK_ENV_LCORE_ID_ANY);
+	ctx = env_get_execution_context();
+	CU_ASSERT(ctx >= cpus && ctx < cpus * 2);
+	CU_ASSERT(pthread_mutex_trylock(&exec_context_mutex[ctx]) == EBUSY);
+	env_put_execution_context(ctx);
+	CU_ASSERT(pthread_mutex_trylock(&exec_context_mutex[ctx]) == 0);
+	pthread_mutex_unlock(&exec_context_mutex[ctx]);
+
+	/* So do cores beyond the number of CPUs */
+	MOCK_SET(spdk_env_get_current_core, cpus);
+	ctx = env_get_execution_context();
+	CU_ASSERT(ctx >= cpus && ctx < cpus * 2);
+	CU_ASSERT(pthread_mutex_trylock(&exec_context_mutex[ctx]) == EBUSY);
+	env_put_execution_context(ctx);
+	CU_ASSERT(pthread_mutex_trylock(&exec_context_mutex[ctx]) == 0);
+	pthread_mutex_unlock(&exec_context_mutex[ctx]);
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+}
+
+static void
+test_numa_id(void)
+{
+	MOCK_SET(spdk_env_get_numa_id, 1);
+
+	MOCK_SET(spdk_env_get_current_core, 3);
+	CU_ASSERT(env_numa_id() == 1);
+
+	/* Allocations from outside of reactors can use any node */
+	MOCK_SET(spdk_env_get_current_core, SPDK_ENV_LCORE_ID_ANY);
+	CU_ASSERT(env_numa_id() == SPDK_ENV_NUMA_ID_ANY);
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+	MOCK_CLEAR(spdk_env_get_numa_id);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ocf_env", NULL, NULL);
+	CU_ADD_TEST(suite, test_execution_context);
+	CU_ADD_TEST(suite, test_numa_id);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
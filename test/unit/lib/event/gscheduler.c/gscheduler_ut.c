@@ -0,0 +1,207 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "common/lib/test_env.c"
+#include "../module/scheduler/gscheduler/gscheduler.c"
+
+DEFINE_STUB_V(spdk_scheduler_register, (struct spdk_scheduler *scheduler));
+DEFINE_STUB(spdk_governor_set, int, (const char *name), 0);
+
+#define UT_NUM_CORES 2
+
+static const uint32_t g_avail_freqs[] = { 1000, 1500, 2000, 2500, 3000 };
+static uint32_t g_curr_freq[UT_NUM_CORES];
+static uint32_t g_set_freq[UT_NUM_CORES];
+static uint32_t g_num_steps[UT_NUM_CORES];
+
+static uint32_t
+get_core_avail_freqs(uint32_t lcore, uint32_t *freqs, uint32_t num)
+{
+	num = spdk_min(num, SPDK_COUNTOF(g_avail_freqs));
+	memcpy(freqs, g_avail_freqs, num * sizeof(*freqs));
+
+	return num;
+}
+
+static uint32_t
+get_core_curr_freq(uint32_t lcore)
+{
+	return g_curr_freq[lcore];
+}
+
+static int
+set_core_freq(uint32_t lcore, uint32_t freq)
+{
+	g_set_freq[lcore] = freq;
+
+	return 1;
+}
+
+static int
+set_core_freq_max(uint32_t lcore)
+{
+	g_set_freq[lcore] = g_avail_freqs[SPDK_COUNTOF(g_avail_freqs) - 1];
+
+	return 1;
+}
+
+static int
+core_freq_step(uint32_t lcore)
+{
+	g_num_steps[lcore]++;
+
+	return 1;
+}
+
+DEFINE_STUB(set_core_freq_min, int, (uint32_t lcore), 0);
+DEFINE_STUB(get_core_capabilities, int,
+	    (uint32_t lcore, struct spdk_governor_capabilities *capabilities), 0);
+
+static struct spdk_governor g_governor = {
+	.name = "ut_governor",
+	.get_core_avail_freqs = get_core_avail_freqs,
+	.get_core_curr_freq = get_core_curr_freq,
+	.core_freq_up = core_freq_step,
+	.core_freq_down = core_freq_step,
+	.set_core_freq_max = set_core_freq_max,
+	.set_core_freq_min = set_core_freq_min,
+	.set_core_freq = set_core_freq,
+	.get_core_capabilities = get_core_capabilities,
+};
+
+struct spdk_governor *
+spdk_governor_get(void)
+{
+	return &g_governor;
+}
+
+static int
+ut_set_opts(const char *text)
+{
+	struct spdk_json_val values[16];
+	char buf[128];
+	ssize_t rc;
+
+	snprintf(buf, sizeof(buf), "%s", text);
+	rc = spdk_json_parse(buf, strlen(buf), values, SPDK_COUNTOF(values), NULL, 0);
+	SPDK_CU_ASSERT_FATAL(rc > 0);
+
+	return set_opts(values);
+}
+
+static void
+ut_balance(struct spdk_scheduler_core_info *cores, uint32_t busy_pct0, uint32_t busy_pct1)
+{
+	memset(g_set_freq, 0, sizeof(g_set_freq));
+	memset(g_num_steps, 0, sizeof(g_num_steps));
+	cores[0].current_busy_tsc = busy_pct0;
+	cores[0].current_idle_tsc = 100 - busy_pct0;
+	cores[1].current_busy_tsc = busy_pct1;
+	cores[1].current_idle_tsc = 100 - busy_pct1;
+
+	balance(cores, UT_NUM_CORES);
+}
+
+static void
+test_proportional_freq(void)
+{
+	struct spdk_scheduler_core_info cores[UT_NUM_CORES] = {};
+
+	allocate_cores(UT_NUM_CORES);
+	cores[0].lcore = 0;
+	cores[1].lcore = 1;
+	memset(g_prev_busy_pct, 0, sizeof(g_prev_busy_pct));
+
+	/* Invalid target busy */
+	CU_ASSERT(ut_set_opts("{\"target_busy\": 101}") != 0);
+	CU_ASSERT(g_target_busy == 0);
+
+	/* Frequency is stepped when target busy is not set */
+	g_curr_freq[0] = 3000;
+	g_curr_freq[1] = 1000;
+	ut_balance(cores, 20, 70);
+	CU_ASSERT(g_set_freq[0] == 0);
+	CU_ASSERT(g_set_freq[1] == 0);
+	CU_ASSERT(g_num_steps[0] == 1);
+	CU_ASSERT(g_num_steps[1] == 1);
+
+	CU_ASSERT(ut_set_opts("{\"target_busy\": 50, \"boost_delta\": 0}") == 0);
+	CU_ASSERT(g_target_busy == 50);
+	CU_ASSERT(g_boost_delta == 0);
+
+	/*
+	 * Core 0 needs 3000 * 20 / 50 = 1200, the lowest frequency above that is 1500.
+	 * Core 1 needs 1000 * 70 / 50 = 1400, it goes up to 1500 directly.
+	 */
+	ut_balance(cores, 20, 70);
+	CU_ASSERT(g_set_freq[0] == 1500);
+	CU_ASSERT(g_set_freq[1] == 1500);
+	CU_ASSERT(g_num_steps[0] == 0);
+	CU_ASSERT(g_num_steps[1] == 0);
+
+	/* Core 0 is already at the right frequency, core 1 needs more than the maximum */
+	g_curr_freq[0] = 2000;
+	g_curr_freq[1] = 2500;
+	ut_balance(cores, 50, 90);
+	CU_ASSERT(g_set_freq[0] == 0);
+	CU_ASSERT(g_set_freq[1] == 3000);
+
+	CU_ASSERT(ut_set_opts("{\"target_busy\": 0, \"boost_delta\": 30}") == 0);
+	free_cores();
+}
+
+static void
+test_boost(void)
+{
+	struct spdk_scheduler_core_info cores[UT_NUM_CORES] = {};
+
+	allocate_cores(UT_NUM_CORES);
+	cores[0].lcore = 0;
+	cores[1].lcore = 1;
+	memset(g_prev_busy_pct, 0, sizeof(g_prev_busy_pct));
+	g_curr_freq[0] = 1000;
+	g_curr_freq[1] = 1000;
+
+	CU_ASSERT(ut_set_opts("{\"target_busy\": 80}") == 0);
+	CU_ASSERT(g_boost_delta == 30);
+
+	ut_balance(cores, 10, 20);
+	CU_ASSERT(g_set_freq[0] == 0);
+	CU_ASSERT(g_set_freq[1] == 0);
+
+	/* Busy % of core 1 rose by the boost delta, it goes to the maximal frequency */
+	ut_balance(cores, 39, 50);
+	CU_ASSERT(g_set_freq[0] == 0);
+	CU_ASSERT(g_set_freq[1] == 3000);
+
+	/* Without a rise the frequency follows the load again */
+	g_curr_freq[1] = 3000;
+	ut_balance(cores, 39, 40);
+	CU_ASSERT(g_set_freq[1] == 1500);
+
+	CU_ASSERT(ut_set_opts("{\"target_busy\": 0}") == 0);
+	free_cores();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("gscheduler", NULL, NULL);
+	CU_ADD_TEST(suite, test_proportional_freq);
+	CU_ADD_TEST(suite, test_boost);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -33,6 +33,7 @@ test_create_reactor(void)
 	CU_ASSERT(spdk_reactor_get(0) == reactor);
 
 	spdk_ring_free(reactor->events);
+	spdk_ring_free(reactor->priority_events);
 	reactor_interrupt_fini(reactor);
 	free(reactor);
 	g_reactors = NULL;
@@ -107,6 +108,131 @@ test_event_call(void)
 	MOCK_CLEAR(spdk_env_get_current_core);
 }
 
+static void
+test_event_call_notify(void)
+{
+	uint8_t test1 = 0, test2 = 0;
+	struct spdk_event *evt;
+	struct spdk_reactor *reactor;
+	uint64_t notify;
+	int i;
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	allocate_cores(1);
+
+	CU_ASSERT(spdk_reactors_init(SPDK_DEFAULT_MSG_MEMPOOL_SIZE) == 0);
+
+	reactor = spdk_reactor_get(0);
+	SPDK_CU_ASSERT_FATAL(reactor != NULL);
+	if (reactor->events_fd < 0) {
+		/* No interrupt support */
+		goto out;
+	}
+
+	/* Events sent from outside of a reactor always need a notification, but only
+	 * the first one queued since the reactor checked its queues writes the eventfd. */
+	MOCK_SET(spdk_env_get_current_core, SPDK_ENV_LCORE_ID_ANY);
+	for (i = 0; i < 3; i++) {
+		evt = spdk_event_allocate(0, ut_event_fn, &test1, &test2);
+		SPDK_CU_ASSERT_FATAL(evt != NULL);
+		spdk_event_call(evt);
+	}
+	CU_ASSERT(reactor->events_notified == true);
+	CU_ASSERT(read(reactor->events_fd, &notify, sizeof(notify)) == sizeof(notify));
+	CU_ASSERT(notify == 1);
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+	CU_ASSERT(event_queue_run_batch(reactor) == 3);
+	CU_ASSERT(reactor->events_notified == false);
+
+	/* The next event notifies the reactor again */
+	MOCK_SET(spdk_env_get_current_core, SPDK_ENV_LCORE_ID_ANY);
+	evt = spdk_event_allocate(0, ut_event_fn, &test1, &test2);
+	SPDK_CU_ASSERT_FATAL(evt != NULL);
+	spdk_event_call(evt);
+	CU_ASSERT(reactor->events_notified == true);
+	CU_ASSERT(read(reactor->events_fd, &notify, sizeof(notify)) == sizeof(notify));
+	CU_ASSERT(notify == 1);
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+	CU_ASSERT(event_queue_run_batch(reactor) == 1);
+
+out:
+	spdk_reactors_fini();
+
+	free_cores();
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+}
+
+static uint32_t g_event_order[32];
+static uint32_t g_event_count;
+
+static void
+ut_event_order_fn(void *arg1, void *arg2)
+{
+	SPDK_CU_ASSERT_FATAL(g_event_count < SPDK_COUNTOF(g_event_order));
+	g_event_order[g_event_count++] = (uint32_t)(uintptr_t)arg1;
+}
+
+static void
+test_event_call_priority(void)
+{
+	struct spdk_event *evt;
+	struct spdk_reactor *reactor;
+	uint32_t i;
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	allocate_cores(1);
+
+	CU_ASSERT(spdk_reactors_init(SPDK_DEFAULT_MSG_MEMPOOL_SIZE) == 0);
+
+	reactor = spdk_reactor_get(0);
+	SPDK_CU_ASSERT_FATAL(reactor != NULL);
+	CU_ASSERT(reactor->event_batch_size == SPDK_EVENT_BATCH_SIZE);
+	g_event_count = 0;
+
+	/* Queue a backlog of regular events and a priority event after them */
+	for (i = 0; i < 20; i++) {
+		evt = spdk_event_allocate(0, ut_event_order_fn, (void *)(uintptr_t)i, NULL);
+		SPDK_CU_ASSERT_FATAL(evt != NULL);
+		spdk_event_call(evt);
+	}
+	evt = spdk_event_allocate(0, ut_event_order_fn, (void *)(uintptr_t)100, NULL);
+	SPDK_CU_ASSERT_FATAL(evt != NULL);
+	spdk_event_call_priority(evt);
+
+	/* The priority event jumps ahead and shares the batch with the regular ones.
+	 * The backlog left behind grows the batch. */
+	CU_ASSERT(event_queue_run_batch(reactor) == SPDK_EVENT_BATCH_SIZE);
+	CU_ASSERT(g_event_count == SPDK_EVENT_BATCH_SIZE);
+	CU_ASSERT(g_event_order[0] == 100);
+	for (i = 1; i < SPDK_EVENT_BATCH_SIZE; i++) {
+		CU_ASSERT(g_event_order[i] == i - 1);
+	}
+	CU_ASSERT(reactor->event_batch_size == SPDK_EVENT_BATCH_SIZE * 2);
+
+	/* The rest of the backlog fits in the larger batch */
+	CU_ASSERT(event_queue_run_batch(reactor) == 13);
+	CU_ASSERT(g_event_count == 21);
+	for (i = SPDK_EVENT_BATCH_SIZE; i < 21; i++) {
+		CU_ASSERT(g_event_order[i] == i - 1);
+	}
+	CU_ASSERT(reactor->event_batch_size == SPDK_EVENT_BATCH_SIZE * 2);
+
+	/* Once the queues drain, the batch shrinks back */
+	CU_ASSERT(event_queue_run_batch(reactor) == 0);
+	CU_ASSERT(reactor->event_batch_size == SPDK_EVENT_BATCH_SIZE);
+
+	spdk_reactors_fini();
+
+	free_cores();
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+}
+
 static void
 test_schedule_thread(void)
 {
@@ -1224,6 +1350,198 @@ test_mixed_workload(void)
 	free_cores();
 }
 
+static void
+ut_set_core_stats(uint32_t core, uint64_t busy, uint64_t idle, uint32_t thread_count)
+{
+	g_cores[core].busy = busy;
+	g_cores[core].idle = idle;
+	g_cores[core].thread_count = thread_count;
+}
+
+static void
+test_scheduler_dynamic_locality(void)
+{
+	struct spdk_scheduler_thread_info thread_info = {};
+	struct spdk_reactor *reactor;
+	struct spdk_thread *thread;
+	uint32_t i;
+
+	allocate_cores(8);
+	for (i = 0; i < 8; i++) {
+		spdk_cpuset_set_cpu(&g_reactor_core_mask, i, true);
+	}
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+	CU_ASSERT(spdk_reactors_init(SPDK_DEFAULT_MSG_MEMPOOL_SIZE) == 0);
+	reactor = spdk_reactor_get(0);
+	/* Reset the scheduler, so it's initialized for all the cores. */
+	CU_ASSERT(spdk_scheduler_set("static") == 0);
+	CU_ASSERT(spdk_scheduler_set("dynamic") == 0);
+
+	g_next_core = 0;
+	thread = spdk_thread_create(NULL, &g_reactor_core_mask);
+	SPDK_CU_ASSERT_FATAL(thread != NULL);
+	_reactor_run(reactor);
+
+	/* Cores 0-3 are on NUMA node 0, cores 4-7 on node 1. Cores 4-5 and 6-7 are SMT siblings. */
+	for (i = 0; i < 8; i++) {
+		g_cores[i].numa_id = i / 4;
+		spdk_cpuset_zero(&g_cores[i].smt_siblings);
+		if (i >= 4) {
+			spdk_cpuset_set_cpu(&g_cores[i].smt_siblings, i & ~1U, true);
+			spdk_cpuset_set_cpu(&g_cores[i].smt_siblings, i | 1U, true);
+		}
+	}
+
+	thread_info.thread_id = spdk_thread_get_id(thread);
+	thread_info.lcore = 4;
+	thread_info.current_stats.busy_tsc = 30;
+	thread_info.current_stats.idle_tsc = 70;
+
+	/* Core 4 is over the limit. Main core 0 could fit the thread, but the free core 5 on the
+	 * same node is picked, even though its sibling keeps running another busy thread. */
+	for (i = 0; i < 4; i++) {
+		ut_set_core_stats(i, 0, 100, 1);
+	}
+	ut_set_core_stats(4, 90, 10, 2);
+	ut_set_core_stats(5, 0, 0, 0);
+	ut_set_core_stats(6, 90, 10, 1);
+	ut_set_core_stats(7, 0, 0, 0);
+	CU_ASSERT(_find_optimal_core(&thread_info) == 5);
+
+	/* Core 6 can fit the thread and its sibling is idle. It is preferred over core 5. */
+	ut_set_core_stats(6, 5, 95, 1);
+	CU_ASSERT(_find_optimal_core(&thread_info) == 6);
+
+	/* Nothing fits on node 1, cross to main core on node 0. */
+	ut_set_core_stats(5, 95, 5, 1);
+	ut_set_core_stats(6, 95, 5, 1);
+	ut_set_core_stats(7, 95, 5, 1);
+	CU_ASSERT(_find_optimal_core(&thread_info) == 0);
+
+	/* Nothing fits anywhere, the least busy core of node 1 is the current one,
+	 * so the least busy core of all is used. */
+	ut_set_core_stats(0, 95, 5, 1);
+	ut_set_core_stats(1, 50, 50, 1);
+	ut_set_core_stats(2, 60, 40, 1);
+	ut_set_core_stats(3, 60, 40, 1);
+	CU_ASSERT(_find_optimal_core(&thread_info) == 1);
+
+	/* Core 4 is not over the limit. Threads are not consolidated on the main core
+	 * if it means leaving the NUMA node. */
+	for (i = 0; i < 4; i++) {
+		ut_set_core_stats(i, 0, 100, 1);
+	}
+	ut_set_core_stats(4, 30, 70, 1);
+	CU_ASSERT(_find_optimal_core(&thread_info) == 4);
+
+	/* Thread on core 1 on node 0 is consolidated on main core 0. */
+	thread_info.lcore = 1;
+	ut_set_core_stats(1, 30, 70, 1);
+	CU_ASSERT(_find_optimal_core(&thread_info) == 0);
+
+	spdk_set_thread(thread);
+	spdk_thread_exit(thread);
+	_reactor_run(reactor);
+	spdk_thread_destroy(thread);
+	spdk_set_thread(NULL);
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+
+	spdk_reactors_fini();
+	free_cores();
+}
+
+static void
+test_scheduler_dynamic_history(void)
+{
+	struct spdk_scheduler_thread_info thread_info = {};
+	struct spdk_reactor *reactor;
+	struct spdk_thread *thread;
+	uint32_t i;
+
+	allocate_cores(2);
+	for (i = 0; i < 2; i++) {
+		spdk_cpuset_set_cpu(&g_reactor_core_mask, i, true);
+	}
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+	CU_ASSERT(spdk_reactors_init(SPDK_DEFAULT_MSG_MEMPOOL_SIZE) == 0);
+	reactor = spdk_reactor_get(0);
+	CU_ASSERT(spdk_scheduler_set("static") == 0);
+	CU_ASSERT(spdk_scheduler_set("dynamic") == 0);
+
+	g_next_core = 0;
+	thread = spdk_thread_create(NULL, &g_reactor_core_mask);
+	SPDK_CU_ASSERT_FATAL(thread != NULL);
+	_reactor_run(reactor);
+
+	/* Smoothed load keeps 75% of the history. */
+	g_scheduler_load_smoothing = 75;
+	CU_ASSERT(_smooth(100, 200) == 125);
+	CU_ASSERT(_smooth(UINT64_MAX, UINT64_MAX) == UINT64_MAX);
+	CU_ASSERT(_smooth(0, 0) == 0);
+
+	/* Thread with 25% load fits a core at 50%, unless moving it costs 20% more. */
+	thread_info.thread_id = spdk_thread_get_id(thread);
+	thread_info.lcore = 0;
+	thread_info.current_stats.busy_tsc = 25;
+	thread_info.current_stats.idle_tsc = 75;
+	ut_set_core_stats(1, 50, 50, 1);
+	CU_ASSERT(_can_core_fit_thread(&thread_info, 1));
+	g_scheduler_migration_cost = 20;
+	CU_ASSERT(!_can_core_fit_thread(&thread_info, 1));
+	g_scheduler_migration_cost = 0;
+
+	/* A load burst of a single period is damped. */
+	g_period = 10;
+	_update_thread_history(&thread_info);
+	thread_info.current_stats.busy_tsc = 100;
+	thread_info.current_stats.idle_tsc = 0;
+	g_period++;
+	_update_thread_history(&thread_info);
+	CU_ASSERT(thread_info.current_stats.busy_tsc == 43);
+	CU_ASSERT(thread_info.current_stats.idle_tsc == 56);
+	CU_ASSERT(_get_thread_load(&thread_info) >= g_scheduler_load_limit);
+
+	/* The active thread moves out of the busy main core, but once moved
+	 * it stays during the move interval. */
+	g_scheduler_move_interval = 3;
+	ut_set_core_stats(0, 90, 10, 2);
+	ut_set_core_stats(1, 0, 100, 0);
+	_balance_active(&thread_info);
+	CU_ASSERT(thread_info.lcore == 1);
+
+	for (i = 0; i < 3; i++) {
+		thread_info.current_stats.busy_tsc = 0;
+		thread_info.current_stats.idle_tsc = 100;
+		g_period++;
+		_update_thread_history(&thread_info);
+		_balance_idle(&thread_info);
+		CU_ASSERT(thread_info.lcore == (i < 2 ? 1 : 0));
+	}
+
+	/* Threads which are gone are forgotten. */
+	CU_ASSERT(_get_thread_history(thread_info.thread_id) != NULL);
+	g_period++;
+	_free_thread_history(true);
+	CU_ASSERT(_get_thread_history(thread_info.thread_id) == NULL);
+
+	g_scheduler_load_smoothing = 0;
+	g_scheduler_move_interval = 0;
+
+	spdk_set_thread(thread);
+	spdk_thread_exit(thread);
+	_reactor_run(reactor);
+	spdk_thread_destroy(thread);
+	spdk_set_thread(NULL);
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+
+	spdk_reactors_fini();
+	free_cores();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1237,6 +1555,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_create_reactor);
 	CU_ADD_TEST(suite, test_init_reactors);
 	CU_ADD_TEST(suite, test_event_call);
+	CU_ADD_TEST(suite, test_event_call_priority);
+	CU_ADD_TEST(suite, test_event_call_notify);
 	CU_ADD_TEST(suite, test_schedule_thread);
 	CU_ADD_TEST(suite, test_reschedule_thread);
 	CU_ADD_TEST(suite, test_bind_thread);
@@ -1249,6 +1569,8 @@ main(int argc, char **argv)
 #endif
 	CU_ADD_TEST(suite, test_scheduler_set_isolated_core_mask);
 	CU_ADD_TEST(suite, test_mixed_workload);
+	CU_ADD_TEST(suite, test_scheduler_dynamic_locality);
+	CU_ADD_TEST(suite, test_scheduler_dynamic_history);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -0,0 +1,130 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk_internal/cunit.h"
+
+#include "common/lib/ut_multithread.c"
+#include "unit/lib/json_mock.c"
+
+#include "fsdev/aio/fsdev_aio.c"
+
+DEFINE_STUB(spdk_aio_mgr_create, struct spdk_aio_mgr *, (uint32_t max_aios), NULL);
+DEFINE_STUB_V(spdk_aio_mgr_delete, (struct spdk_aio_mgr *mgr));
+DEFINE_STUB(spdk_aio_mgr_poll, bool, (struct spdk_aio_mgr *mgr), false);
+DEFINE_STUB_V(spdk_aio_mgr_cancel, (struct spdk_aio_mgr *mgr, struct spdk_aio_mgr_io *aio));
+DEFINE_STUB(spdk_aio_mgr_read, struct spdk_aio_mgr_io *, (struct spdk_aio_mgr *mgr,
+		fsdev_aio_done_cb clb, void *ctx, int fd, uint64_t offs, uint32_t size,
+		struct iovec *iovs, uint32_t iovcnt), NULL);
+DEFINE_STUB(spdk_aio_mgr_write, struct spdk_aio_mgr_io *, (struct spdk_aio_mgr *mgr,
+		fsdev_aio_done_cb clb, void *ctx, int fd, uint64_t offs, uint32_t size,
+		const struct iovec *iovs, uint32_t iovcnt), NULL);
+DEFINE_STUB(spdk_fsdev_get_name, const char *, (const struct spdk_fsdev *fsdev), NULL);
+DEFINE_STUB_V(spdk_fsdev_io_complete, (struct spdk_fsdev_io *fsdev_io, int status));
+DEFINE_STUB_V(spdk_fsdev_module_list_add, (struct spdk_fsdev_module *fsdev_module));
+DEFINE_STUB(spdk_fsdev_register, int, (struct spdk_fsdev *fsdev), 0);
+DEFINE_STUB(spdk_fsdev_unregister_by_name, int, (const char *fsdev_name,
+		struct spdk_fsdev_module *module, spdk_fsdev_unregister_cb cb_fn, void *cb_arg), 0);
+
+static int
+ut_create_file(void)
+{
+	char path[] = "/tmp/fsdev_aio_ut.XXXXXX";
+	int fd;
+
+	fd = mkstemp(path);
+	SPDK_CU_ASSERT_FATAL(fd >= 0);
+	unlink(path);
+
+	return fd;
+}
+
+static void
+test_attr_valid_ms(void)
+{
+	struct spdk_fsdev_aio_opts opts;
+	struct aio_fsdev vfsdev = {};
+	struct spdk_fsdev_file_object fobject = {};
+	struct spdk_fsdev_file_attr attr;
+
+	/* Attributes are not cached by default */
+	spdk_fsdev_aio_get_default_opts(&opts);
+	CU_ASSERT(opts.attr_valid_ms == 0);
+
+	fobject.fd = ut_create_file();
+	CU_ASSERT(pwrite(fobject.fd, "data", 4, 0) == 4);
+
+	CU_ASSERT(file_object_fill_attr(&vfsdev, &fobject, &attr) == 0);
+	CU_ASSERT(attr.size == 4);
+	CU_ASSERT(attr.valid_ms == 0);
+
+	vfsdev.attr_valid_ms = 1000;
+	CU_ASSERT(file_object_fill_attr(&vfsdev, &fobject, &attr) == 0);
+	CU_ASSERT(attr.size == 4);
+	CU_ASSERT(attr.valid_ms == 1000);
+
+	close(fobject.fd);
+}
+
+static void
+test_readahead(void)
+{
+	struct spdk_fsdev_aio_opts opts;
+	struct aio_fsdev vfsdev = {};
+	struct spdk_fsdev_file_handle fhandle = {};
+
+	spdk_fsdev_aio_get_default_opts(&opts);
+	CU_ASSERT(opts.readahead_size == 0);
+
+	vfsdev.readahead_size = 0x10000;
+	fhandle.fd = ut_create_file();
+
+	/* The first read at offset 0 starts a stream and opens the window */
+	file_handle_readahead(&vfsdev, &fhandle, 0, 0x1000);
+	CU_ASSERT(fhandle.ra.next_offs == 0x1000);
+	CU_ASSERT(fhandle.ra.end == 0x11000);
+
+	/* The window is not refilled until half of it has been consumed */
+	file_handle_readahead(&vfsdev, &fhandle, 0x1000, 0x1000);
+	CU_ASSERT(fhandle.ra.next_offs == 0x2000);
+	CU_ASSERT(fhandle.ra.end == 0x11000);
+
+	file_handle_readahead(&vfsdev, &fhandle, 0x2000, 0x7000);
+	CU_ASSERT(fhandle.ra.next_offs == 0x9000);
+	CU_ASSERT(fhandle.ra.end == 0x11000);
+
+	file_handle_readahead(&vfsdev, &fhandle, 0x9000, 0x1000);
+	CU_ASSERT(fhandle.ra.next_offs == 0xa000);
+	CU_ASSERT(fhandle.ra.end == 0x1a000);
+
+	/* A random read restarts the detection without reading ahead */
+	file_handle_readahead(&vfsdev, &fhandle, 0x100000, 0x1000);
+	CU_ASSERT(fhandle.ra.next_offs == 0x101000);
+	CU_ASSERT(fhandle.ra.end == 0x101000);
+
+	/* The stream continuing from there opens a new window */
+	file_handle_readahead(&vfsdev, &fhandle, 0x101000, 0x1000);
+	CU_ASSERT(fhandle.ra.next_offs == 0x102000);
+	CU_ASSERT(fhandle.ra.end == 0x112000);
+
+	close(fhandle.fd);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("fsdev_aio", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_attr_valid_ms);
+	CU_ADD_TEST(suite, test_readahead);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
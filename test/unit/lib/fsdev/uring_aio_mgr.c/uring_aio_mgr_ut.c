@@ -0,0 +1,221 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+
+#include "fsdev/aio/uring_aio_mgr.c"
+
+#define UT_MAX_POLLS 1000
+
+struct ut_aio_ctx {
+	bool		done;
+	uint32_t	data_size;
+	int		error;
+};
+
+static void
+ut_aio_done(void *ctx, uint32_t data_size, int error)
+{
+	struct ut_aio_ctx *ut_ctx = ctx;
+
+	ut_ctx->done = true;
+	ut_ctx->data_size = data_size;
+	ut_ctx->error = error;
+}
+
+static void
+ut_poll_until_done(struct spdk_aio_mgr *mgr, struct ut_aio_ctx *ctx, int num_ctx)
+{
+	int i, j;
+
+	for (i = 0; i < UT_MAX_POLLS; i++) {
+		spdk_aio_mgr_poll(mgr);
+		for (j = 0; j < num_ctx; j++) {
+			if (!ctx[j].done) {
+				break;
+			}
+		}
+		if (j == num_ctx) {
+			return;
+		}
+		usleep(1000);
+	}
+}
+
+static int
+ut_create_file(void)
+{
+	char path[] = "/tmp/uring_aio_mgr_ut.XXXXXX";
+	int fd;
+
+	fd = mkstemp(path);
+	SPDK_CU_ASSERT_FATAL(fd >= 0);
+	unlink(path);
+
+	return fd;
+}
+
+static void
+test_read_write(void)
+{
+	struct spdk_aio_mgr *mgr;
+	struct spdk_aio_mgr_io *aio;
+	struct ut_aio_ctx ctx = {};
+	char data1[] = "abcd", data2[] = "efgh", buf[8] = {};
+	struct iovec iovs[2];
+	struct stat st;
+	int fd;
+
+	fd = ut_create_file();
+	mgr = spdk_aio_mgr_create(4);
+	SPDK_CU_ASSERT_FATAL(mgr != NULL);
+
+	/* The write is only prepared until the next poll */
+	iovs[0].iov_base = data1;
+	iovs[0].iov_len = 4;
+	iovs[1].iov_base = data2;
+	iovs[1].iov_len = 4;
+	aio = spdk_aio_mgr_write(mgr, ut_aio_done, &ctx, fd, 0, 8, iovs, 2);
+	CU_ASSERT(aio != NULL);
+	CU_ASSERT(mgr->num_pending == 1);
+	CU_ASSERT(fstat(fd, &st) == 0);
+	CU_ASSERT(st.st_size == 0);
+	CU_ASSERT(!ctx.done);
+
+	ut_poll_until_done(mgr, &ctx, 1);
+	CU_ASSERT(ctx.done);
+	CU_ASSERT(ctx.error == 0);
+	CU_ASSERT(ctx.data_size == 8);
+	CU_ASSERT(mgr->num_pending == 0);
+	CU_ASSERT(TAILQ_EMPTY(&mgr->in_flight));
+
+	/* Read it back, starting at an offset */
+	memset(&ctx, 0, sizeof(ctx));
+	iovs[0].iov_base = buf;
+	iovs[0].iov_len = sizeof(buf);
+	aio = spdk_aio_mgr_read(mgr, ut_aio_done, &ctx, fd, 2, sizeof(buf), iovs, 1);
+	CU_ASSERT(aio != NULL);
+	ut_poll_until_done(mgr, &ctx, 1);
+	CU_ASSERT(ctx.done);
+	CU_ASSERT(ctx.error == 0);
+	CU_ASSERT(ctx.data_size == 6);
+	CU_ASSERT(memcmp(buf, "cdefgh", 6) == 0);
+
+	/* Errors are reported as positive errno values */
+	memset(&ctx, 0, sizeof(ctx));
+	aio = spdk_aio_mgr_read(mgr, ut_aio_done, &ctx, -1, 0, sizeof(buf), iovs, 1);
+	CU_ASSERT(aio != NULL);
+	ut_poll_until_done(mgr, &ctx, 1);
+	CU_ASSERT(ctx.done);
+	CU_ASSERT(ctx.error == EBADF);
+
+	spdk_aio_mgr_delete(mgr);
+	close(fd);
+}
+
+static void
+test_batch_submit(void)
+{
+	struct spdk_aio_mgr *mgr;
+	struct ut_aio_ctx ctx[3] = {}, ctx_nomem = {};
+	char data[3][4] = {"aaaa", "bbbb", "cccc"}, buf[12];
+	struct iovec iovs[3];
+	int fd, i;
+
+	fd = ut_create_file();
+	mgr = spdk_aio_mgr_create(3);
+	SPDK_CU_ASSERT_FATAL(mgr != NULL);
+
+	for (i = 0; i < 3; i++) {
+		iovs[i].iov_base = data[i];
+		iovs[i].iov_len = 4;
+		CU_ASSERT(spdk_aio_mgr_write(mgr, ut_aio_done, &ctx[i], fd, i * 4, 4,
+					     &iovs[i], 1) != NULL);
+	}
+	CU_ASSERT(mgr->num_pending == 3);
+
+	/* All of the aios are in use */
+	CU_ASSERT(spdk_aio_mgr_write(mgr, ut_aio_done, &ctx_nomem, fd, 0, 4, &iovs[0], 1) == NULL);
+	CU_ASSERT(ctx_nomem.done);
+	CU_ASSERT(ctx_nomem.error == EFAULT);
+
+	/* A single poll submits everything prepared */
+	CU_ASSERT(spdk_aio_mgr_poll(mgr) == true);
+	CU_ASSERT(mgr->num_pending == 0);
+
+	ut_poll_until_done(mgr, ctx, 3);
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(ctx[i].done);
+		CU_ASSERT(ctx[i].error == 0);
+		CU_ASSERT(ctx[i].data_size == 4);
+	}
+	CU_ASSERT(pread(fd, buf, sizeof(buf), 0) == sizeof(buf));
+	CU_ASSERT(memcmp(buf, "aaaabbbbcccc", sizeof(buf)) == 0);
+
+	/* Nothing to do */
+	CU_ASSERT(spdk_aio_mgr_poll(mgr) == false);
+
+	spdk_aio_mgr_delete(mgr);
+	close(fd);
+}
+
+static void
+test_cancel(void)
+{
+	struct spdk_aio_mgr *mgr;
+	struct spdk_aio_mgr_io *aio;
+	struct ut_aio_ctx ctx = {};
+	struct iovec iov;
+	char buf[4];
+	int fds[2];
+
+	SPDK_CU_ASSERT_FATAL(pipe(fds) == 0);
+	mgr = spdk_aio_mgr_create(1);
+	SPDK_CU_ASSERT_FATAL(mgr != NULL);
+
+	/* A read from an empty pipe stays in flight until it is cancelled */
+	iov.iov_base = buf;
+	iov.iov_len = sizeof(buf);
+	aio = spdk_aio_mgr_read(mgr, ut_aio_done, &ctx, fds[0], 0, sizeof(buf), &iov, 1);
+	SPDK_CU_ASSERT_FATAL(aio != NULL);
+	spdk_aio_mgr_poll(mgr);
+	CU_ASSERT(!ctx.done);
+
+	spdk_aio_mgr_cancel(mgr, aio);
+	CU_ASSERT(mgr->num_pending == 1);
+	ut_poll_until_done(mgr, &ctx, 1);
+	CU_ASSERT(ctx.done);
+	CU_ASSERT(ctx.error == ECANCELED || ctx.error == EINTR);
+	CU_ASSERT(TAILQ_EMPTY(&mgr->in_flight));
+
+	/* The completion of the cancel itself is consumed */
+	spdk_aio_mgr_poll(mgr);
+	CU_ASSERT(io_uring_cq_ready(&mgr->ring) == 0);
+
+	spdk_aio_mgr_delete(mgr);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("uring_aio_mgr", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_read_write);
+	CU_ADD_TEST(suite, test_batch_submit);
+	CU_ADD_TEST(suite, test_cancel);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
@@ -385,6 +385,64 @@ test_next_xfer_addr(void)
 	cleanup_band();
 }
 
+static void
+test_gc_victim(void)
+{
+	struct ftl_band *young, *old, *band;
+	uint64_t user_blocks, i;
+
+	setup_band();
+	g_dev->sb = calloc(1, sizeof(*g_dev->sb));
+	SPDK_CU_ASSERT_FATAL(g_dev->sb != NULL);
+	g_dev->sb_shm = calloc(1, sizeof(*g_dev->sb_shm));
+	SPDK_CU_ASSERT_FATAL(g_dev->sb_shm != NULL);
+
+	g_dev->num_logical_bands_in_physical = 1;
+	for (i = 0; i < g_dev->num_bands; i++) {
+		g_dev->bands[i].phys_id = i;
+	}
+
+	/* Mostly invalid band closed recently, and a less invalid band holding old data */
+	young = test_init_ftl_band(g_dev, 1, ftl_get_num_blocks_in_band(g_dev));
+	old = test_init_ftl_band(g_dev, 2, ftl_get_num_blocks_in_band(g_dev));
+	user_blocks = ftl_band_user_blocks(young);
+	young->p2l_map.num_valid = user_blocks * 4 / 10;
+	young->md->close_seq_id = 990;
+	old->p2l_map.num_valid = user_blocks * 6 / 10;
+	old->md->close_seq_id = 10;
+	g_band->p2l_map.num_valid = user_blocks;
+	g_dev->sb->seq_id = 1000;
+
+	/* Greedy policy picks the most invalid band */
+	ftl_band_reset_gc_iter(g_dev);
+	band = ftl_band_search_next_to_reloc(g_dev);
+	CU_ASSERT_EQUAL(band, young);
+	CU_ASSERT_EQUAL(g_dev->gc.bands_picked, 1);
+	CU_ASSERT_EQUAL(g_dev->gc.valid_blocks, young->p2l_map.num_valid);
+	CU_ASSERT_EQUAL(g_dev->gc.user_blocks, user_blocks);
+
+	/* Cost-benefit policy prefers the old band, even though it's less invalid */
+	young->reloc = false;
+	TAILQ_INSERT_TAIL(&g_dev->shut_bands, young, queue_entry);
+	g_dev->gc.cost_benefit = true;
+	ftl_band_reset_gc_iter(g_dev);
+	band = ftl_band_search_next_to_reloc(g_dev);
+	CU_ASSERT_EQUAL(band, old);
+	CU_ASSERT_EQUAL(g_dev->gc.bands_picked, 2);
+
+	/* Only fully valid bands left, nothing to relocate */
+	ftl_band_reset_gc_iter(g_dev);
+	young->p2l_map.num_valid = user_blocks;
+	band = ftl_band_search_next_to_reloc(g_dev);
+	CU_ASSERT_PTR_NULL(band);
+
+	test_free_ftl_band(young);
+	test_free_ftl_band(old);
+	free(g_dev->sb_shm);
+	free(g_dev->sb);
+	cleanup_band();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -402,6 +460,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_band_set_addr);
 	CU_ADD_TEST(suite, test_invalidate_addr);
 	CU_ADD_TEST(suite, test_next_xfer_addr);
+	CU_ADD_TEST(suite, test_gc_victim);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
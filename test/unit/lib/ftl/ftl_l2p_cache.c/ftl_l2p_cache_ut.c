@@ -0,0 +1,288 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "common/lib/test_env.c"
+
+#include "ftl/ftl_l2p_cache.c"
+
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB(spdk_bdev_get_md_size, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB(spdk_bdev_read_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_read_blocks_with_md, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, void *buf, void *md, uint64_t offset_blocks,
+		uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_readv_blocks_with_md, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, struct iovec *iov, int iovcnt, void *md,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_write_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_write_blocks_with_md, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, void *buf, void *md, uint64_t offset_blocks,
+		uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB_V(ftl_bitmap_clear, (struct ftl_bitmap *bitmap, uint64_t bit));
+DEFINE_STUB(ftl_bitmap_find_first_set, uint64_t, (struct ftl_bitmap *bitmap, uint64_t start_bit,
+		uint64_t end_bit), UINT64_MAX);
+DEFINE_STUB(ftl_bitmap_get, bool, (const struct ftl_bitmap *bitmap, uint64_t bit), false);
+DEFINE_STUB_V(ftl_invalidate_addr, (struct spdk_ftl_dev *dev, ftl_addr addr));
+DEFINE_STUB_V(ftl_l2p_pin_complete, (struct spdk_ftl_dev *dev, int status,
+				     struct ftl_l2p_pin_ctx *pin_ctx));
+DEFINE_STUB_V(ftl_md_clear, (struct ftl_md *md, int pattern, union ftl_md_vss *vss_pattern));
+DEFINE_STUB(ftl_md_create, struct ftl_md *, (struct spdk_ftl_dev *dev, uint64_t blocks,
+		uint64_t vss_blksz, const char *name, int flags,
+		const struct ftl_layout_region *region), NULL);
+DEFINE_STUB(ftl_md_create_shm_flags, int, (struct spdk_ftl_dev *dev), 0);
+DEFINE_STUB_V(ftl_md_destroy, (struct ftl_md *md, int flags));
+DEFINE_STUB(ftl_md_destroy_shm_flags, int, (struct spdk_ftl_dev *dev), 0);
+DEFINE_STUB(ftl_md_get_buffer, void *, (struct ftl_md *md), NULL);
+DEFINE_STUB(ftl_md_get_buffer_size, uint64_t, (struct ftl_md *md), 0);
+DEFINE_STUB(ftl_mempool_claim_df, void *, (struct ftl_mempool *mpool, ftl_df_obj_id df_obj_id),
+	    NULL);
+DEFINE_STUB(ftl_mempool_create, struct ftl_mempool *, (size_t count, size_t size,
+		size_t alignment, int socket_id), NULL);
+DEFINE_STUB(ftl_mempool_create_ext, struct ftl_mempool *, (void *buffer, size_t count,
+		size_t size, size_t alignment), NULL);
+DEFINE_STUB_V(ftl_mempool_destroy, (struct ftl_mempool *mpool));
+DEFINE_STUB_V(ftl_mempool_destroy_ext, (struct ftl_mempool *mpool));
+DEFINE_STUB(ftl_mempool_get_df_obj_id, ftl_df_obj_id, (struct ftl_mempool *mpool,
+		void *df_obj_ptr), 0);
+DEFINE_STUB(ftl_mempool_get_df_obj_index, size_t, (struct ftl_mempool *mpool, void *df_obj_ptr),
+	    0);
+DEFINE_STUB(ftl_mempool_get_df_ptr, void *, (struct ftl_mempool *mpool, ftl_df_obj_id df_obj_id),
+	    NULL);
+DEFINE_STUB_V(ftl_mempool_initialize_ext, (struct ftl_mempool *mpool));
+DEFINE_STUB_V(ftl_mempool_release_df, (struct ftl_mempool *mpool, ftl_df_obj_id df_obj_id));
+DEFINE_STUB_V(ftl_stats_bdev_io_completed, (struct spdk_ftl_dev *dev, enum ftl_stats_type type,
+		struct spdk_bdev_io *bdev_io));
+
+void *g_ftl_write_buf;
+void *g_ftl_read_buf;
+
+static struct spdk_ftl_dev g_dev;
+
+void *
+ftl_mempool_get(struct ftl_mempool *mpool)
+{
+	return calloc(1, sizeof(struct ftl_l2p_cache_page_in_batch));
+}
+
+void
+ftl_mempool_put(struct ftl_mempool *mpool, void *element)
+{
+	free(element);
+}
+
+struct ut_readv {
+	int iovcnt;
+	uint64_t offset_blocks;
+	uint64_t num_blocks;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+};
+
+static struct ut_readv g_readv[4];
+static int g_num_readv;
+
+int
+spdk_bdev_readv_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct ut_readv *readv;
+
+	SPDK_CU_ASSERT_FATAL(g_num_readv < (int)SPDK_COUNTOF(g_readv));
+	readv = &g_readv[g_num_readv++];
+	readv->iovcnt = iovcnt;
+	readv->offset_blocks = offset_blocks;
+	readv->num_blocks = num_blocks;
+	readv->cb = cb;
+	readv->cb_arg = cb_arg;
+
+	return 0;
+}
+
+static struct ftl_l2p_cache *
+ut_cache_alloc(uint64_t num_pages)
+{
+	struct ftl_l2p_cache *cache;
+
+	cache = calloc(1, sizeof(*cache));
+	SPDK_CU_ASSERT_FATAL(cache != NULL);
+	cache->dev = &g_dev;
+	cache->num_pages = num_pages;
+	TAILQ_INIT(&cache->lru_list);
+	TAILQ_INIT(&cache->freq_list);
+
+	return cache;
+}
+
+static void
+test_prefetch_detect(void)
+{
+	struct ftl_l2p_cache *cache = ut_cache_alloc(100);
+
+	/* A random pin starts tracking a new stream */
+	CU_ASSERT(!ftl_l2p_cache_prefetch_detect(cache, 10, 10));
+	CU_ASSERT(cache->prefetch.end_page_no == 0);
+
+	/* The first adjacent pin continues the stream, but doesn't trigger the prefetch yet */
+	CU_ASSERT(ftl_l2p_cache_prefetch_detect(cache, 11, 11));
+	CU_ASSERT(cache->prefetch.end_page_no == 0);
+
+	/* The second one reads ahead the pages following the stream */
+	CU_ASSERT(ftl_l2p_cache_prefetch_detect(cache, 11, 12));
+	CU_ASSERT(cache->prefetch.next_page_no == 13);
+	CU_ASSERT(cache->prefetch.end_page_no == 13 + FTL_L2P_CACHE_PREFETCH_PAGES);
+
+	/* Pins within the last page of the stream don't move the window */
+	CU_ASSERT(ftl_l2p_cache_prefetch_detect(cache, 12, 12));
+	CU_ASSERT(cache->prefetch.next_page_no == 13);
+
+	/* Another stream is tracked independently */
+	CU_ASSERT(!ftl_l2p_cache_prefetch_detect(cache, 50, 50));
+	CU_ASSERT(ftl_l2p_cache_prefetch_detect(cache, 51, 51));
+	CU_ASSERT(ftl_l2p_cache_prefetch_detect(cache, 13, 13));
+	CU_ASSERT(cache->prefetch.next_page_no == 14);
+	CU_ASSERT(cache->prefetch.end_page_no == 14 + FTL_L2P_CACHE_PREFETCH_PAGES);
+
+	/* A window far from the stream is restarted right after it */
+	CU_ASSERT(ftl_l2p_cache_prefetch_detect(cache, 52, 52));
+	CU_ASSERT(cache->prefetch.next_page_no == 53);
+	CU_ASSERT(cache->prefetch.end_page_no == 53 + FTL_L2P_CACHE_PREFETCH_PAGES);
+
+	/* The prefetch stops at the end of the L2P */
+	CU_ASSERT(!ftl_l2p_cache_prefetch_detect(cache, 95, 95));
+	CU_ASSERT(ftl_l2p_cache_prefetch_detect(cache, 96, 96));
+	CU_ASSERT(ftl_l2p_cache_prefetch_detect(cache, 97, 97));
+	CU_ASSERT(cache->prefetch.next_page_no == 98);
+	CU_ASSERT(cache->prefetch.end_page_no == 100);
+
+	free(cache);
+}
+
+static void
+test_scan_resistant_eviction(void)
+{
+	struct ftl_l2p_cache *cache = ut_cache_alloc(100);
+	struct ftl_l2p_page pages[3] = {};
+
+	cache->scan_resistant = true;
+	cache->freq_max = 1;
+
+	ftl_l2p_cache_lru_add_page(cache, &pages[0]);
+	pages[1].frequent = true;
+	ftl_l2p_cache_lru_add_page(cache, &pages[1]);
+	pages[2].frequent = true;
+	ftl_l2p_cache_lru_add_page(cache, &pages[2]);
+	CU_ASSERT(cache->freq_cnt == 2);
+
+	/* The oldest frequent page exceeding the limit ages out to the recency list */
+	CU_ASSERT(ftl_l2p_cache_get_coldest_page(cache) == &pages[0]);
+	CU_ASSERT(cache->freq_cnt == 1);
+	CU_ASSERT(!pages[1].frequent);
+	CU_ASSERT(TAILQ_FIRST(&cache->lru_list) == &pages[1]);
+
+	/* Pages are evicted from the recency list first */
+	ftl_l2p_cache_lru_remove_page(cache, &pages[0]);
+	CU_ASSERT(ftl_l2p_cache_get_coldest_page(cache) == &pages[1]);
+	ftl_l2p_cache_lru_remove_page(cache, &pages[1]);
+	CU_ASSERT(ftl_l2p_cache_get_coldest_page(cache) == &pages[2]);
+	ftl_l2p_cache_lru_remove_page(cache, &pages[2]);
+	CU_ASSERT(cache->freq_cnt == 0);
+	CU_ASSERT(ftl_l2p_cache_get_coldest_page(cache) == NULL);
+
+	free(cache);
+}
+
+static void
+test_page_in_batch(void)
+{
+	struct ftl_l2p_cache *cache = ut_cache_alloc(100);
+	struct ftl_l2p_page pages[FTL_L2P_CACHE_PAGE_IN_BATCH_MAX + 4] = {};
+	uint64_t page_no[] = { 5, 6, 7, 9 };
+	uint64_t i;
+
+	cache->cache_layout_offset = 1000;
+	for (i = 0; i < SPDK_COUNTOF(pages); i++) {
+		TAILQ_INIT(&pages[i].ppe_list);
+		pages[i].state = L2P_CACHE_PAGE_INIT;
+	}
+
+	/* Adjacent pages are read with a single IO, a gap starts a new one */
+	for (i = 0; i < SPDK_COUNTOF(page_no); i++) {
+		pages[i].page_no = page_no[i];
+		page_in_queue(&g_dev, cache, &pages[i]);
+	}
+	CU_ASSERT(cache->ios_in_flight == 4);
+	CU_ASSERT(g_num_readv == 1);
+	CU_ASSERT(g_readv[0].iovcnt == 3);
+	CU_ASSERT(g_readv[0].num_blocks == 3);
+	CU_ASSERT(g_readv[0].offset_blocks == 1005);
+
+	page_in_flush(cache);
+	CU_ASSERT(g_num_readv == 2);
+	CU_ASSERT(g_readv[1].iovcnt == 1);
+	CU_ASSERT(g_readv[1].offset_blocks == 1009);
+	CU_ASSERT(cache->page_in_batch == NULL);
+
+	/* Pages read ahead which nobody waits for become evictable */
+	g_readv[0].cb(NULL, true, g_readv[0].cb_arg);
+	g_readv[1].cb(NULL, true, g_readv[1].cb_arg);
+	CU_ASSERT(cache->ios_in_flight == 0);
+	for (i = 0; i < SPDK_COUNTOF(page_no); i++) {
+		CU_ASSERT(pages[i].state == L2P_CACHE_PAGE_READY);
+		CU_ASSERT(pages[i].on_lru_list);
+	}
+
+	/* A batch is limited in size */
+	g_num_readv = 0;
+	for (i = 0; i < FTL_L2P_CACHE_PAGE_IN_BATCH_MAX + 1; i++) {
+		pages[i].page_no = 20 + i;
+		pages[i].state = L2P_CACHE_PAGE_INIT;
+		pages[i].on_lru_list = false;
+		page_in_queue(&g_dev, cache, &pages[i]);
+	}
+	page_in_flush(cache);
+	CU_ASSERT(g_num_readv == 2);
+	CU_ASSERT(g_readv[0].iovcnt == FTL_L2P_CACHE_PAGE_IN_BATCH_MAX);
+	CU_ASSERT(g_readv[0].offset_blocks == 1020);
+	CU_ASSERT(g_readv[1].iovcnt == 1);
+	CU_ASSERT(g_readv[1].offset_blocks == 1020 + FTL_L2P_CACHE_PAGE_IN_BATCH_MAX);
+	g_readv[0].cb(NULL, true, g_readv[0].cb_arg);
+	g_readv[1].cb(NULL, true, g_readv[1].cb_arg);
+	CU_ASSERT(cache->ios_in_flight == 0);
+
+	g_num_readv = 0;
+	free(cache);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ftl_l2p_cache", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_prefetch_detect);
+	CU_ADD_TEST(suite, test_scan_resistant_eviction);
+	CU_ADD_TEST(suite, test_page_in_batch);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
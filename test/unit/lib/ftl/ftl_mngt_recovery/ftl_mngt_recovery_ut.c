@@ -0,0 +1,247 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "common/lib/test_env.c"
+
+#include "ftl/mngt/ftl_mngt_recovery.c"
+
+DEFINE_STUB_V(ftl_band_acquire_p2l_map, (struct ftl_band *band));
+DEFINE_STUB(ftl_band_addr_from_block_offset, ftl_addr, (struct ftl_band *band, uint64_t block_off),
+		0);
+DEFINE_STUB(ftl_band_alloc_p2l_map, int, (struct ftl_band *band), 0);
+DEFINE_STUB(ftl_band_block_offset_from_addr, uint64_t, (struct ftl_band *band, ftl_addr addr), 0);
+DEFINE_STUB(ftl_band_filled, int, (struct ftl_band *band, size_t offset), 0);
+DEFINE_STUB(ftl_band_from_addr, struct ftl_band *, (struct spdk_ftl_dev *dev, ftl_addr addr), NULL);
+DEFINE_STUB_V(ftl_band_initialize_free_state, (struct ftl_band *band));
+DEFINE_STUB_V(ftl_band_release_p2l_map, (struct ftl_band *band));
+DEFINE_STUB_V(ftl_band_set_p2l, (struct ftl_band *band, uint64_t lba, ftl_addr addr,
+		uint64_t seq_id));
+DEFINE_STUB(ftl_bitmap_get, bool, (const struct ftl_bitmap *bitmap, uint64_t bit), false);
+DEFINE_STUB_V(ftl_bitmap_set, (struct ftl_bitmap *bitmap, uint64_t bit));
+DEFINE_STUB(ftl_chunk_map_get_lba, uint64_t, (struct ftl_nv_cache_chunk *chunk, uint64_t offset),
+		0);
+DEFINE_STUB(ftl_layout_region_get, struct ftl_layout_region *, (struct spdk_ftl_dev *dev,
+		enum ftl_layout_region_type reg_type), NULL);
+DEFINE_STUB(ftl_md_create, struct ftl_md *, (struct spdk_ftl_dev *dev, uint64_t blocks,
+		uint64_t vss_blksz, const char *name, int flags,
+		const struct ftl_layout_region *region), NULL);
+DEFINE_STUB(ftl_md_create_shm_flags, int, (struct spdk_ftl_dev *dev), 0);
+DEFINE_STUB_V(ftl_md_destroy, (struct ftl_md *md, int flags));
+DEFINE_STUB(ftl_md_get_buffer, void *, (struct ftl_md *md), NULL);
+DEFINE_STUB(ftl_md_get_buffer_size, uint64_t, (struct ftl_md *md), 0);
+DEFINE_STUB_V(ftl_md_persist, (struct ftl_md *md));
+DEFINE_STUB_V(ftl_md_restore, (struct ftl_md *md));
+DEFINE_STUB_V(ftl_md_set_region, (struct ftl_md *md, const struct ftl_layout_region *region));
+DEFINE_STUB(ftl_md_unlink, int, (struct spdk_ftl_dev *dev, const char *name, int flags), 0);
+DEFINE_STUB(ftl_mngt_alloc_step_ctx, int, (struct ftl_mngt_process *mngt, size_t size), 0);
+DEFINE_STUB_V(ftl_mngt_call_process, (struct ftl_mngt_process *mngt,
+		const struct ftl_mngt_process_desc *process, void *init_ctx));
+DEFINE_STUB_V(ftl_mngt_deinit_l2p, (struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_fail_step, (struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_finalize_init_bands, (struct spdk_ftl_dev *dev,
+		struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_finalize_startup, (struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt));
+DEFINE_STUB(ftl_mngt_get_process_ctx, void *, (struct ftl_mngt_process *mngt), NULL);
+DEFINE_STUB_V(ftl_mngt_init_l2p, (struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_nv_cache_recover_open_chunk, (struct spdk_ftl_dev *dev,
+		struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_nv_cache_restore_chunk_state, (struct spdk_ftl_dev *dev,
+		struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_nv_cache_restore_l2p, (struct spdk_ftl_dev *dev,
+		struct ftl_mngt_process *mngt, ftl_chunk_md_cb cb, void *cb_ctx));
+DEFINE_STUB(ftl_mngt_p2l_ckpt_get_seq_id, uint64_t, (struct spdk_ftl_dev *dev, int md_region), 0);
+DEFINE_STUB(ftl_mngt_p2l_ckpt_restore, int, (struct ftl_band *band, uint32_t md_region,
+		uint64_t seq_id), 0);
+DEFINE_STUB_V(ftl_mngt_p2l_deinit_ckpt, (struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_p2l_init_ckpt, (struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_p2l_restore_ckpt, (struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt));
+DEFINE_STUB(ftl_mngt_process_execute, int, (struct spdk_ftl_dev *dev,
+		const struct ftl_mngt_process_desc *process, ftl_mngt_completion cb, void *cb_ctx),
+		0);
+DEFINE_STUB_V(ftl_mngt_restore_l2p, (struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_self_test, (struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_skip_step, (struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_start_core_poller, (struct spdk_ftl_dev *dev,
+		struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_stop_core_poller, (struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt));
+DEFINE_STUB(ftl_nv_cache_chunk_tail_md_num_blocks, size_t, (const struct ftl_nv_cache *nv_cache),
+		0);
+DEFINE_STUB(ftl_p2l_ckpt_acquire_region_type, struct ftl_p2l_ckpt *, (struct spdk_ftl_dev *dev,
+		uint32_t region_type), NULL);
+DEFINE_STUB_V(ftl_recover_max_seq, (struct spdk_ftl_dev *dev));
+DEFINE_STUB_V(ftl_set_trim_map, (struct spdk_ftl_dev *dev, uint64_t lba, uint64_t num_blocks,
+		uint64_t seq_id));
+DEFINE_STUB_V(ftl_stats_crc_error, (struct spdk_ftl_dev *dev, enum ftl_stats_type type));
+DEFINE_STUB_V(ftl_valid_map_load_state, (struct spdk_ftl_dev *dev));
+
+#define UT_NUM_BANDS 4
+
+static struct band_md_ctx g_step_ctx;
+static struct ftl_mngt_recovery_ctx g_caller_ctx;
+static bool g_band_read[UT_NUM_BANDS];
+static int g_next_step;
+static int g_continue_step;
+
+void *
+ftl_mngt_get_step_ctx(struct ftl_mngt_process *mngt)
+{
+	return &g_step_ctx;
+}
+
+void *
+ftl_mngt_get_caller_ctx(struct ftl_mngt_process *mngt)
+{
+	return &g_caller_ctx;
+}
+
+void
+ftl_mngt_next_step(struct ftl_mngt_process *mngt)
+{
+	g_next_step++;
+}
+
+void
+ftl_mngt_continue_step(struct ftl_mngt_process *mngt)
+{
+	g_continue_step++;
+}
+
+void
+ftl_band_read_tail_brq_md(struct ftl_band *band, ftl_band_md_cb cb, void *cntx)
+{
+	g_band_read[band->id] = true;
+}
+
+static void
+ut_band_md_cb(struct ftl_band *band, void *ctx, enum ftl_md_status status)
+{
+}
+
+static void
+test_band_iters_mask(void)
+{
+	struct ftl_mngt_recovery_ctx ctx = {};
+	struct ftl_band band = {};
+	uint64_t mask = 0;
+
+	ctx.l2p_snippet.count = 100;
+	ctx.band_iters.iters_per_bit = 1;
+	ctx.band_iters.mask = &mask;
+
+	/* Each iteration has its own bit */
+	CU_ASSERT(recovery_band_iters_bit(&ctx, 0) == 1);
+	CU_ASSERT(recovery_band_iters_bit(&ctx, 99) == 1);
+	CU_ASSERT(recovery_band_iters_bit(&ctx, 100) == 2);
+	CU_ASSERT(recovery_band_iters_bit(&ctx, 250) == 4);
+
+	/* With more than 64 iterations, a bit covers several of them */
+	ctx.band_iters.iters_per_bit = 2;
+	CU_ASSERT(recovery_band_iters_bit(&ctx, 150) == 1);
+	CU_ASSERT(recovery_band_iters_bit(&ctx, 250) == 2);
+	CU_ASSERT(recovery_band_iters_bit(&ctx, 64 * 200 - 1) == 1ULL << 63);
+
+	/* Every band is read until the masks are gathered by the first iteration */
+	ctx.band_iters.iters_per_bit = 1;
+	ctx.iter.lba_first = 100;
+	CU_ASSERT(recovery_band_in_iter(&ctx, &band));
+
+	ctx.band_iters.ready = true;
+	CU_ASSERT(!recovery_band_in_iter(&ctx, &band));
+	mask = 2;
+	CU_ASSERT(recovery_band_in_iter(&ctx, &band));
+	ctx.iter.lba_first = 200;
+	CU_ASSERT(!recovery_band_in_iter(&ctx, &band));
+}
+
+static void
+test_walk_band_tail_md_skip(void)
+{
+	struct spdk_ftl_dev dev = {};
+	struct ftl_superblock sb = {};
+	struct ftl_band bands[UT_NUM_BANDS] = {};
+	struct ftl_band_md band_md[UT_NUM_BANDS] = {};
+	uint64_t mask[UT_NUM_BANDS] = { 1, 2, 3, 0 };
+	int i;
+
+	dev.num_bands = UT_NUM_BANDS;
+	dev.bands = bands;
+	dev.sb = &sb;
+	for (i = 0; i < UT_NUM_BANDS; i++) {
+		bands[i].id = i;
+		bands[i].dev = &dev;
+		bands[i].md = &band_md[i];
+		band_md[i].state = FTL_BAND_STATE_CLOSED;
+	}
+
+	g_caller_ctx.l2p_snippet.count = 100;
+	g_caller_ctx.band_iters.iters_per_bit = 1;
+	g_caller_ctx.band_iters.mask = mask;
+
+	/* The first iteration reads all the bands */
+	memset(&g_step_ctx, 0, sizeof(g_step_ctx));
+	ftl_mngt_recovery_walk_band_tail_md(&dev, NULL, ut_band_md_cb);
+	for (i = 0; i < UT_NUM_BANDS; i++) {
+		CU_ASSERT(g_band_read[i]);
+	}
+	CU_ASSERT(g_step_ctx.skipped == 0);
+	CU_ASSERT(g_step_ctx.qd == UT_NUM_BANDS);
+
+	/* The following ones read only the bands holding their LBAs */
+	g_caller_ctx.band_iters.ready = true;
+	memset(&g_step_ctx, 0, sizeof(g_step_ctx));
+	memset(g_band_read, 0, sizeof(g_band_read));
+	ftl_mngt_recovery_walk_band_tail_md(&dev, NULL, ut_band_md_cb);
+	CU_ASSERT(g_band_read[0]);
+	CU_ASSERT(!g_band_read[1]);
+	CU_ASSERT(g_band_read[2]);
+	CU_ASSERT(!g_band_read[3]);
+	CU_ASSERT(g_step_ctx.skipped == 2);
+	CU_ASSERT(g_step_ctx.qd == 2);
+
+	g_caller_ctx.iter.lba_first = 100;
+	memset(&g_step_ctx, 0, sizeof(g_step_ctx));
+	memset(g_band_read, 0, sizeof(g_band_read));
+	ftl_mngt_recovery_walk_band_tail_md(&dev, NULL, ut_band_md_cb);
+	CU_ASSERT(!g_band_read[0]);
+	CU_ASSERT(g_band_read[1]);
+	CU_ASSERT(g_band_read[2]);
+	CU_ASSERT(!g_band_read[3]);
+
+	/* With no band to read, the step is finished */
+	g_caller_ctx.iter.lba_first = 200;
+	memset(&g_step_ctx, 0, sizeof(g_step_ctx));
+	memset(g_band_read, 0, sizeof(g_band_read));
+	g_continue_step = 0;
+	ftl_mngt_recovery_walk_band_tail_md(&dev, NULL, ut_band_md_cb);
+	CU_ASSERT(g_step_ctx.skipped == UT_NUM_BANDS);
+	CU_ASSERT(g_continue_step == 1);
+	g_next_step = 0;
+	ftl_mngt_recovery_walk_band_tail_md(&dev, NULL, ut_band_md_cb);
+	CU_ASSERT(g_next_step == 1);
+
+	memset(&g_caller_ctx, 0, sizeof(g_caller_ctx));
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ftl_mngt_recovery", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_band_iters_mask);
+	CU_ADD_TEST(suite, test_walk_band_tail_md_skip);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,272 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "common/lib/test_env.c"
+
+#include "ftl/ftl_nv_cache.c"
+
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB(spdk_bdev_get_md_size, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB(spdk_bdev_read_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_read_blocks_with_md, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, void *buf, void *md, uint64_t offset_blocks,
+		uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_write_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_write_blocks_with_md, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, void *buf, void *md, uint64_t offset_blocks,
+		uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_json_write_array_end, int, (struct spdk_json_write_ctx *w), 0);
+DEFINE_STUB(spdk_json_write_named_array_begin, int, (struct spdk_json_write_ctx *w,
+		const char *name), 0);
+DEFINE_STUB(spdk_json_write_named_double, int, (struct spdk_json_write_ctx *w, const char *name,
+		double val), 0);
+DEFINE_STUB(spdk_json_write_named_string, int, (struct spdk_json_write_ctx *w, const char *name,
+		const char *val), 0);
+DEFINE_STUB(spdk_json_write_named_uint64, int, (struct spdk_json_write_ctx *w, const char *name,
+		uint64_t val), 0);
+DEFINE_STUB(spdk_json_write_object_begin, int, (struct spdk_json_write_ctx *w), 0);
+DEFINE_STUB(spdk_json_write_object_end, int, (struct spdk_json_write_ctx *w), 0);
+DEFINE_STUB(ftl_band_next_addr, ftl_addr, (struct ftl_band *band, ftl_addr addr, size_t offset),
+	    0);
+DEFINE_STUB(ftl_bitmap_find_first_set, uint64_t, (struct ftl_bitmap *bitmap, uint64_t start_bit,
+		uint64_t end_bit), UINT64_MAX);
+DEFINE_STUB_V(ftl_bitmap_set, (struct ftl_bitmap *bitmap, uint64_t bit));
+DEFINE_STUB_V(ftl_io_complete, (struct ftl_io *io));
+DEFINE_STUB(ftl_io_get_lba, uint64_t, (const struct ftl_io *io, size_t offset), 0);
+DEFINE_STUB(ftl_io_iovec_addr, void *, (struct ftl_io *io), NULL);
+DEFINE_STUB(ftl_l2p_get, ftl_addr, (struct spdk_ftl_dev *dev, uint64_t lba), 0);
+DEFINE_STUB_V(ftl_l2p_pin, (struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count,
+			    ftl_l2p_pin_cb cb, void *cb_ctx, struct ftl_l2p_pin_ctx *pin_ctx));
+DEFINE_STUB_V(ftl_l2p_pin_skip, (struct spdk_ftl_dev *dev, ftl_l2p_pin_cb cb, void *cb_ctx,
+				 struct ftl_l2p_pin_ctx *pin_ctx));
+DEFINE_STUB_V(ftl_l2p_unpin, (struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count));
+DEFINE_STUB_V(ftl_l2p_update_base, (struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr new_addr,
+				    ftl_addr old_addr));
+DEFINE_STUB_V(ftl_l2p_update_cache, (struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr new_addr,
+				     ftl_addr old_addr));
+DEFINE_STUB(ftl_layout_region_get, struct ftl_layout_region *, (struct spdk_ftl_dev *dev,
+		enum ftl_layout_region_type reg_type), NULL);
+DEFINE_STUB_V(ftl_md_clear, (struct ftl_md *md, int pattern, union ftl_md_vss *vss_pattern));
+DEFINE_STUB(ftl_md_create, struct ftl_md *, (struct spdk_ftl_dev *dev, uint64_t blocks,
+		uint64_t vss_blksz, const char *name, int flags,
+		const struct ftl_layout_region *region), NULL);
+DEFINE_STUB_V(ftl_md_destroy, (struct ftl_md *md, int flags));
+DEFINE_STUB(ftl_md_get_buffer, void *, (struct ftl_md *md), NULL);
+DEFINE_STUB(ftl_md_get_buffer_size, uint64_t, (struct ftl_md *md), 0);
+DEFINE_STUB_V(ftl_md_persist_entries, (struct ftl_md *md, uint64_t start_entry,
+				       uint64_t num_entries, void *buffer,
+				       void *vss_buffer, ftl_md_io_entry_cb cb, void *cb_arg,
+				       struct ftl_md_io_entry_ctx *ctx));
+DEFINE_STUB(ftl_md_region_name, const char *, (enum ftl_layout_region_type reg_type), "");
+DEFINE_STUB_V(ftl_md_restore, (struct ftl_md *md));
+DEFINE_STUB(ftl_mempool_create, struct ftl_mempool *, (size_t count, size_t size,
+		size_t alignment, int socket_id), NULL);
+DEFINE_STUB_V(ftl_mempool_destroy, (struct ftl_mempool *mpool));
+DEFINE_STUB(ftl_mempool_get, void *, (struct ftl_mempool *mpool), NULL);
+DEFINE_STUB_V(ftl_mempool_put, (struct ftl_mempool *mpool, void *element));
+DEFINE_STUB(ftl_mngt_alloc_step_ctx, int, (struct ftl_mngt_process *mngt, size_t size), 0);
+DEFINE_STUB_V(ftl_mngt_continue_step, (struct ftl_mngt_process *mngt));
+DEFINE_STUB_V(ftl_mngt_fail_step, (struct ftl_mngt_process *mngt));
+DEFINE_STUB(ftl_mngt_get_process_ctx, void *, (struct ftl_mngt_process *mngt), NULL);
+DEFINE_STUB(ftl_mngt_get_step_ctx, void *, (struct ftl_mngt_process *mngt), NULL);
+DEFINE_STUB_V(ftl_mngt_next_step, (struct ftl_mngt_process *mngt));
+DEFINE_STUB(ftl_mngt_process_execute, int, (struct spdk_ftl_dev *dev,
+		const struct ftl_mngt_process_desc *process,
+		ftl_mngt_completion cb, void *cb_ctx), 0);
+DEFINE_STUB_V(ftl_property_register, (struct spdk_ftl_dev *dev,
+				      const char *name, void *value, size_t size,
+				      const char *unit, const char *desc,
+				      ftl_property_dump_fn dump,
+				      ftl_property_decode_fn decode,
+				      ftl_property_set_fn set,
+				      bool verbose_mode));
+DEFINE_STUB_V(ftl_rq_del, (struct ftl_rq *rq));
+DEFINE_STUB(ftl_rq_new, struct ftl_rq *, (struct spdk_ftl_dev *dev, uint32_t io_md_size), NULL);
+DEFINE_STUB_V(ftl_rq_unpin, (struct ftl_rq *rq));
+DEFINE_STUB_V(ftl_stats_bdev_io_completed, (struct spdk_ftl_dev *dev, enum ftl_stats_type type,
+		struct spdk_bdev_io *bdev_io));
+
+#if defined(DEBUG)
+DEFINE_STUB_V(ftl_trace_submission, (struct spdk_ftl_dev *dev, const struct ftl_io *io,
+				     ftl_addr addr, size_t addr_cnt));
+#endif
+
+void *g_ftl_write_buf;
+void *g_ftl_read_buf;
+
+static struct spdk_ftl_dev g_dev;
+
+static void
+heat_tracking(void)
+{
+	struct ftl_nv_cache *nv_cache = &g_dev.nv_cache;
+
+	nv_cache->heat.num_regions = 4;
+	nv_cache->heat.counters = calloc(nv_cache->heat.num_regions,
+					 sizeof(*nv_cache->heat.counters));
+	SPDK_CU_ASSERT_FATAL(nv_cache->heat.counters != NULL);
+	nv_cache->heat.decay_blocks = 1024;
+
+	/* Writes crossing a region boundary are split between both regions */
+	heat_update(nv_cache, 250, 10);
+	CU_ASSERT(nv_cache->heat.counters[0] == 6);
+	CU_ASSERT(nv_cache->heat.counters[1] == 4);
+	CU_ASSERT(nv_cache->heat.total == 10);
+	CU_ASSERT(nv_cache->heat.blocks_written == 10);
+
+	/* Only regions written more than twice as often as the average are hot */
+	heat_update(nv_cache, 3 * 256, 90);
+	CU_ASSERT(nv_cache->heat.total == 100);
+	CU_ASSERT(heat_lba_is_hot(nv_cache, 3 * 256 + 10));
+	CU_ASSERT(!heat_lba_is_hot(nv_cache, 0));
+	CU_ASSERT(!heat_lba_is_hot(nv_cache, 256));
+	CU_ASSERT(!heat_lba_is_hot(nv_cache, 2 * 256));
+
+	/* Counters are halved once a cache-worth of data has been written */
+	nv_cache->heat.decay_blocks = 104;
+	heat_update(nv_cache, 2 * 256, 4);
+	CU_ASSERT(nv_cache->heat.blocks_written == 0);
+	CU_ASSERT(nv_cache->heat.counters[0] == 3);
+	CU_ASSERT(nv_cache->heat.counters[1] == 2);
+	CU_ASSERT(nv_cache->heat.counters[2] == 4);
+	CU_ASSERT(nv_cache->heat.counters[3] == 45);
+	CU_ASSERT(nv_cache->heat.total == 54);
+
+	/* Counters saturate instead of wrapping around */
+	nv_cache->heat.counters[1] = UINT16_MAX - 1;
+	nv_cache->heat.total += UINT16_MAX - 1 - 2;
+	heat_update(nv_cache, 256, 8);
+	CU_ASSERT(nv_cache->heat.counters[1] == UINT16_MAX);
+	CU_ASSERT(nv_cache->heat.total == 54 + UINT16_MAX - 2);
+
+	free(nv_cache->heat.counters);
+	memset(&nv_cache->heat, 0, sizeof(nv_cache->heat));
+}
+
+static void
+heat_compaction_writer(void)
+{
+	struct ftl_nv_cache *nv_cache = &g_dev.nv_cache;
+	struct ftl_rq *rq;
+	uint64_t i;
+
+	rq = calloc(1, sizeof(*rq) + 4 * sizeof(struct ftl_rq_entry));
+	SPDK_CU_ASSERT_FATAL(rq != NULL);
+	rq->num_blocks = 4;
+	rq->iter.count = 4;
+	for (i = 0; i < 4; i++) {
+		rq->entries[i].lba = FTL_LBA_INVALID;
+	}
+
+	/* Without heat tracking everything goes to the user writer */
+	CU_ASSERT(compaction_writer(&g_dev, rq) == &g_dev.writer_user);
+
+	nv_cache->heat.num_regions = 4;
+	nv_cache->heat.counters = calloc(nv_cache->heat.num_regions,
+					 sizeof(*nv_cache->heat.counters));
+	SPDK_CU_ASSERT_FATAL(nv_cache->heat.counters != NULL);
+	nv_cache->heat.counters[0] = 100;
+	nv_cache->heat.counters[1] = 10;
+	nv_cache->heat.total = 110;
+
+	/* Mostly cold blocks go to the cold writer */
+	rq->entries[0].lba = 0;
+	rq->entries[1].lba = 256;
+	rq->entries[2].lba = 257;
+	rq->entries[3].lba = 258;
+	CU_ASSERT(compaction_writer(&g_dev, rq) == &g_dev.writer_user_cold);
+
+	/* Half of the valid blocks being hot is enough, invalid entries don't count */
+	rq->entries[2].lba = FTL_LBA_INVALID;
+	rq->entries[3].lba = FTL_LBA_INVALID;
+	CU_ASSERT(compaction_writer(&g_dev, rq) == &g_dev.writer_user);
+
+	rq->entries[1].lba = 1;
+	CU_ASSERT(compaction_writer(&g_dev, rq) == &g_dev.writer_user);
+
+	free(nv_cache->heat.counters);
+	memset(&nv_cache->heat, 0, sizeof(nv_cache->heat));
+	free(rq);
+}
+
+static void
+compaction_parallel(void)
+{
+	struct ftl_nv_cache *nv_cache = &g_dev.nv_cache;
+	struct ftl_nv_cache_chunk chunks[3] = {};
+	struct ftl_nv_cache_chunk_md md[3] = {};
+	int i;
+
+	TAILQ_INIT(&nv_cache->chunk_comp_list);
+	for (i = 0; i < 3; i++) {
+		chunks[i].nv_cache = nv_cache;
+		chunks[i].md = &md[i];
+		md[i].blocks_written = 10;
+		TAILQ_INSERT_TAIL(&nv_cache->chunk_comp_list, &chunks[i], entry);
+	}
+
+	/* Chunks read entirely are passed over while their writes are still in flight */
+	md[0].read_pointer = 10;
+	md[1].read_pointer = 3;
+	CU_ASSERT(get_chunk_for_compaction(nv_cache) == &chunks[1]);
+	md[1].read_pointer = 10;
+	CU_ASSERT(get_chunk_for_compaction(nv_cache) == &chunks[2]);
+	md[2].read_pointer = 10;
+	CU_ASSERT(get_chunk_for_compaction(nv_cache) == NULL);
+
+	/* Below the full chunk threshold compaction only runs when free chunks run out */
+	nv_cache->chunk_compaction_threshold = 5;
+	nv_cache->chunk_full_count = 1;
+	nv_cache->chunk_free_target = 5;
+	nv_cache->chunk_free_count = 5;
+	CU_ASSERT(!is_compaction_urgent(nv_cache));
+	CU_ASSERT(!is_compaction_required(nv_cache));
+
+	nv_cache->chunk_free_count = 4;
+	CU_ASSERT(is_compaction_urgent(nv_cache));
+	CU_ASSERT(is_compaction_required(nv_cache));
+
+	/* There has to be something to compact */
+	nv_cache->chunk_full_count = 0;
+	CU_ASSERT(is_compaction_required(nv_cache));
+	TAILQ_INIT(&nv_cache->chunk_comp_list);
+	CU_ASSERT(!is_compaction_required(nv_cache));
+
+	nv_cache->chunk_full_count = 5;
+	nv_cache->chunk_free_count = 10;
+	CU_ASSERT(is_compaction_required(nv_cache));
+
+	memset(nv_cache, 0, sizeof(*nv_cache));
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ftl_nv_cache", NULL, NULL);
+
+	CU_ADD_TEST(suite, heat_tracking);
+	CU_ADD_TEST(suite, heat_compaction_writer);
+	CU_ADD_TEST(suite, compaction_parallel);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -571,6 +571,107 @@ test_idxd_get_app_tag_mask(void)
 	CU_ASSERT(app_tag_mask == app_tag_mask_expected);
 }
 
+static void
+test_idxd_batch_opts(void)
+{
+	struct spdk_idxd_device idxd = {};
+	struct spdk_idxd_io_channel chan = {};
+	struct idxd_batch batch = {};
+	struct idxd_hw_desc desc __attribute__((aligned(64))) = {};
+	struct idxd_hw_desc user_desc[4] __attribute__((aligned(64))) = {};
+	struct idxd_ops ops = {}, *op;
+	struct idxd_ops user_ops[4] = {};
+	struct idxd_hw_desc *tmp_desc;
+	struct idxd_ops *tmp_op;
+	void *portal;
+	int rc;
+
+	portal = aligned_alloc(PORTAL_STRIDE, PORTAL_SIZE);
+	SPDK_CU_ASSERT_FATAL(portal != NULL);
+
+	idxd.chan_per_device = 1;
+	chan.idxd = &idxd;
+	chan.portal = portal;
+	STAILQ_INIT(&chan.ops_pool);
+	STAILQ_INIT(&chan.ops_outstanding);
+	TAILQ_INIT(&chan.batch_pool);
+	ops.desc = &desc;
+	STAILQ_INSERT_TAIL(&chan.ops_pool, &ops, link);
+	batch.size = SPDK_COUNTOF(user_desc);
+	batch.user_desc = user_desc;
+	batch.user_ops = user_ops;
+	TAILQ_INSERT_TAIL(&chan.batch_pool, &batch, link);
+
+	rc = spdk_idxd_set_batch_opts(0, 0);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* spdk_get_ticks_hz() is 1000000 in the test env, so one tick is one microsecond */
+	rc = spdk_idxd_set_batch_opts(2, 10);
+	CU_ASSERT(rc == 0);
+
+	/* A single descriptor stays in the open batch until the latency bound expires */
+	rc = _idxd_setup_batch(&chan);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(chan.batch == &batch);
+	rc = _idxd_prep_batch_cmd(&chan, NULL, NULL, 0, &tmp_desc, &tmp_op);
+	CU_ASSERT(rc == 0);
+	tmp_desc->opcode = IDXD_OPCODE_MEMMOVE;
+	CU_ASSERT(_idxd_flush_batch(&chan) == 0);
+	CU_ASSERT(chan.batch == &batch);
+
+	spdk_idxd_process_events(&chan);
+	CU_ASSERT(chan.batch == &batch);
+	CU_ASSERT(STAILQ_EMPTY(&chan.ops_outstanding));
+
+	spdk_delay_us(10);
+	spdk_idxd_process_events(&chan);
+	CU_ASSERT(chan.batch == NULL);
+	/* A batch with a single entry is submitted as a regular descriptor */
+	op = STAILQ_FIRST(&chan.ops_outstanding);
+	CU_ASSERT(op == &ops);
+	CU_ASSERT(desc.opcode == IDXD_OPCODE_MEMMOVE);
+	CU_ASSERT(TAILQ_FIRST(&chan.batch_pool) == &batch);
+	STAILQ_REMOVE_HEAD(&chan.ops_outstanding, link);
+	STAILQ_INSERT_TAIL(&chan.ops_pool, &ops, link);
+
+	/* Reaching max_batch_size submits the batch right away */
+	rc = _idxd_setup_batch(&chan);
+	CU_ASSERT(rc == 0);
+	rc = _idxd_prep_batch_cmd(&chan, NULL, NULL, 0, &tmp_desc, &tmp_op);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(_idxd_flush_batch(&chan) == 0);
+	CU_ASSERT(chan.batch == &batch);
+	rc = _idxd_prep_batch_cmd(&chan, NULL, NULL, 0, &tmp_desc, &tmp_op);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(_idxd_flush_batch(&chan) == 0);
+	CU_ASSERT(chan.batch == NULL);
+	CU_ASSERT(desc.opcode == IDXD_OPCODE_BATCH);
+	CU_ASSERT(desc.desc_count == 2);
+	CU_ASSERT(STAILQ_FIRST(&chan.ops_outstanding) == &user_ops[0]);
+	CU_ASSERT(STAILQ_LAST(&chan.ops_outstanding, idxd_ops, link) == &ops);
+	STAILQ_INIT(&chan.ops_outstanding);
+	STAILQ_INSERT_TAIL(&chan.ops_pool, &ops, link);
+	batch.refcnt = 0;
+	TAILQ_INSERT_TAIL(&chan.batch_pool, &batch, link);
+
+	/* An expired batch is closed out before a new submission is added to it */
+	rc = _idxd_setup_batch(&chan);
+	CU_ASSERT(rc == 0);
+	rc = _idxd_prep_batch_cmd(&chan, NULL, NULL, 0, &tmp_desc, &tmp_op);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(10);
+	rc = _idxd_setup_batch(&chan);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(chan.batch == &batch);
+	CU_ASSERT(batch.index == 0);
+	CU_ASSERT(STAILQ_FIRST(&chan.ops_outstanding) == &ops);
+	idxd_batch_cancel(&chan, 0);
+
+	rc = spdk_idxd_set_batch_opts(IDXD_MIN_BATCH_FLUSH, 0);
+	CU_ASSERT(rc == 0);
+	free(portal);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -590,6 +691,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_idxd_get_dif_flags);
 	CU_ADD_TEST(suite, test_idxd_get_source_dif_flags);
 	CU_ADD_TEST(suite, test_idxd_get_app_tag_mask);
+	CU_ADD_TEST(suite, test_idxd_batch_opts);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -0,0 +1,470 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+
+#include "common/lib/ut_multithread.c"
+#include "jsonrpc/jsonrpc_client.c"
+#include "init/json_config.c"
+
+DEFINE_STUB(spdk_rpc_server_listen, struct spdk_rpc_server *, (const char *listen_addr),
+	    (struct spdk_rpc_server *)0xdeadbeef);
+DEFINE_STUB(spdk_rpc_verify_methods, bool, (void), true);
+DEFINE_STUB_V(spdk_rpc_server_close, (struct spdk_rpc_server *server));
+DEFINE_STUB_V(spdk_rpc_set_state, (uint32_t state));
+DEFINE_STUB(spdk_rpc_get_state, uint32_t, (void), SPDK_RPC_RUNTIME);
+DEFINE_STUB(spdk_subsystem_exists, bool, (const char *name), true);
+DEFINE_STUB_V(spdk_subsystem_init, (spdk_subsystem_init_fn cb_fn, void *cb_arg));
+
+#define UT_MAX_RPCS 32
+
+static const char g_config[] =
+	"{\"subsystems\": ["
+	" {\"subsystem\": \"bdev\", \"config\": ["
+	"  {\"method\": \"bdev_malloc_create\", \"params\": {\"name\": \"Malloc0\"}},"
+	"  {\"method\": \"bdev_malloc_create\", \"params\": {\"name\": \"Malloc1\"}}]},"
+	" {\"subsystem\": \"nvmf\", \"config\": ["
+	"  {\"method\": \"nvmf_create_transport\", \"params\": {\"trtype\": \"TCP\"}},"
+	"  {\"method\": \"nvmf_create_subsystem\", \"params\": {\"nqn\": \"nqn.ut:0\"}},"
+	"  {\"method\": \"nvmf_create_subsystem\", \"params\": {\"nqn\": \"nqn.ut:1\"}},"
+	"  {\"method\": \"nvmf_subsystem_add_ns\", \"params\": {\"nqn\": \"nqn.ut:0\","
+	"   \"namespace\": {\"bdev_name\": \"Malloc0\"}}},"
+	"  {\"method\": \"nvmf_subsystem_add_ns\", \"params\": {\"nqn\": \"nqn.ut:1\","
+	"   \"namespace\": {\"bdev_name\": \"Malloc1\"}}},"
+	"  {\"method\": \"nvmf_subsystem_add_listener\", \"params\": {\"nqn\": \"nqn.ut:0\"}}]},"
+	" {\"subsystem\": \"iscsi\", \"config\": ["
+	"  {\"method\": \"iscsi_set_options\"}]}"
+	"]}";
+
+/* Entries that have to be applied successfully before the given one is sent */
+static const struct {
+	const char *method;
+	const char *key;
+	const char *dep_method;
+	const char *dep_key;
+} g_deps[] = {
+	{ "bdev_malloc_create", "Malloc1", "bdev_malloc_create", "Malloc0" },
+	{ "nvmf_create_transport", "", "bdev_malloc_create", "Malloc1" },
+	{ "nvmf_create_subsystem", "nqn.ut:0", "nvmf_create_transport", "" },
+	{ "nvmf_create_subsystem", "nqn.ut:1", "nvmf_create_transport", "" },
+	{ "nvmf_subsystem_add_ns", "nqn.ut:0", "nvmf_create_subsystem", "nqn.ut:0" },
+	{ "nvmf_subsystem_add_ns", "nqn.ut:1", "nvmf_create_subsystem", "nqn.ut:1" },
+	{ "nvmf_subsystem_add_listener", "nqn.ut:0", "nvmf_subsystem_add_ns", "nqn.ut:0" },
+	{ "iscsi_set_options", "", "nvmf_subsystem_add_ns", "nqn.ut:1" },
+	{ "iscsi_set_options", "", "nvmf_subsystem_add_listener", "nqn.ut:0" },
+};
+
+/* Requests received by the RPC server */
+static struct ut_rpc {
+	char	method[64];
+	/* "nqn" or "name" parameter, empty if there is none */
+	char	key[64];
+	bool	done;
+	bool	error;
+} g_rpcs[UT_MAX_RPCS];
+static int g_num_rpcs;
+
+static struct ut_conn {
+	struct spdk_jsonrpc_client	*client;
+	/* Index of the request in flight in g_rpcs, -1 if there is none */
+	int				rpc;
+} g_conns[RPC_CLIENT_MAX_CONNS];
+static int g_num_closed;
+
+static struct spdk_json_val g_error_val = {
+	.start = "failed",
+	.len = 6,
+	.type = SPDK_JSON_VAL_STRING,
+};
+
+static bool g_load_done;
+static int g_load_rc;
+/* Apply the requests in flight whenever the RPC server is polled */
+static bool g_sync_methods;
+static int g_num_accept;
+
+static struct ut_conn *
+ut_find_conn(struct spdk_jsonrpc_client *client)
+{
+	uint32_t i;
+
+	for (i = 0; i < SPDK_COUNTOF(g_conns); i++) {
+		if (g_conns[i].client == client) {
+			return &g_conns[i];
+		}
+	}
+
+	SPDK_CU_ASSERT_FATAL(false);
+	return NULL;
+}
+
+static struct ut_rpc *
+ut_find_rpc(const char *method, const char *key)
+{
+	int i;
+
+	for (i = 0; i < g_num_rpcs; i++) {
+		if (strcmp(g_rpcs[i].method, method) == 0 && strcmp(g_rpcs[i].key, key) == 0) {
+			return &g_rpcs[i];
+		}
+	}
+
+	return NULL;
+}
+
+static int
+ut_num_in_flight(void)
+{
+	uint32_t i;
+	int num = 0;
+
+	for (i = 0; i < SPDK_COUNTOF(g_conns); i++) {
+		if (g_conns[i].client != NULL && g_conns[i].rpc >= 0) {
+			num++;
+		}
+	}
+
+	return num;
+}
+
+struct spdk_jsonrpc_client *
+spdk_jsonrpc_client_connect(const char *addr, int addr_family)
+{
+	uint32_t i;
+
+	for (i = 0; i < SPDK_COUNTOF(g_conns); i++) {
+		if (g_conns[i].client == NULL) {
+			g_conns[i].client = calloc(1, sizeof(struct spdk_jsonrpc_client));
+			g_conns[i].rpc = -1;
+			return g_conns[i].client;
+		}
+	}
+
+	return NULL;
+}
+
+void
+spdk_jsonrpc_client_close(struct spdk_jsonrpc_client *client)
+{
+	struct ut_conn *conn = ut_find_conn(client);
+
+	/* A connection must not be closed with a request in flight */
+	CU_ASSERT(conn->rpc == -1);
+	conn->client = NULL;
+	free(client);
+	g_num_closed++;
+}
+
+struct spdk_jsonrpc_client_request *
+spdk_jsonrpc_client_create_request(void)
+{
+	struct spdk_jsonrpc_client_request *request;
+
+	request = calloc(1, sizeof(*request));
+	SPDK_CU_ASSERT_FATAL(request != NULL);
+	request->send_buf = malloc(SPDK_JSONRPC_SEND_BUF_SIZE_INIT);
+	SPDK_CU_ASSERT_FATAL(request->send_buf != NULL);
+	request->send_buf_size = SPDK_JSONRPC_SEND_BUF_SIZE_INIT;
+
+	return request;
+}
+
+void
+spdk_jsonrpc_client_free_request(struct spdk_jsonrpc_client_request *req)
+{
+	free(req->send_buf);
+	free(req);
+}
+
+int
+spdk_jsonrpc_client_poll(struct spdk_jsonrpc_client *client, int timeout)
+{
+	struct ut_conn *conn = ut_find_conn(client);
+
+	return conn->rpc >= 0 && g_rpcs[conn->rpc].done ? 1 : 0;
+}
+
+static void
+ut_copy_string(char *dst, size_t size, struct spdk_json_val *object, const char *name)
+{
+	struct spdk_json_val *val;
+
+	dst[0] = '\0';
+	if (object != NULL && spdk_json_find_string(object, name, NULL, &val) == 0) {
+		snprintf(dst, size, "%.*s", val->len, (char *)val->start);
+	}
+}
+
+int
+spdk_jsonrpc_client_send_request(struct spdk_jsonrpc_client *client,
+				 struct spdk_jsonrpc_client_request *req)
+{
+	struct ut_conn *conn = ut_find_conn(client);
+	struct spdk_json_val values[64], *params = NULL;
+	struct ut_rpc *rpc, *dep;
+	char buf[1024];
+	uint32_t i;
+	ssize_t rc;
+
+	CU_ASSERT(conn->rpc == -1);
+	SPDK_CU_ASSERT_FATAL(g_num_rpcs < UT_MAX_RPCS);
+	SPDK_CU_ASSERT_FATAL(req->send_len <= sizeof(buf));
+
+	memcpy(buf, req->send_buf, req->send_len);
+	rc = spdk_json_parse(buf, req->send_len, values, SPDK_COUNTOF(values), NULL, 0);
+	SPDK_CU_ASSERT_FATAL(rc > 0);
+
+	rpc = &g_rpcs[g_num_rpcs];
+	ut_copy_string(rpc->method, sizeof(rpc->method), values, "method");
+	spdk_json_find(values, "params", NULL, &params, SPDK_JSON_VAL_OBJECT_BEGIN);
+	ut_copy_string(rpc->key, sizeof(rpc->key), params, "nqn");
+	if (rpc->key[0] == '\0') {
+		ut_copy_string(rpc->key, sizeof(rpc->key), params, "name");
+	}
+
+	/* Each entry is sent once, and only after everything it depends on was applied */
+	CU_ASSERT(ut_find_rpc(rpc->method, rpc->key) == NULL);
+	for (i = 0; i < SPDK_COUNTOF(g_deps); i++) {
+		if (strcmp(g_deps[i].method, rpc->method) == 0 &&
+		    strcmp(g_deps[i].key, rpc->key) == 0) {
+			dep = ut_find_rpc(g_deps[i].dep_method, g_deps[i].dep_key);
+			CU_ASSERT(dep != NULL && dep->done && !dep->error);
+		}
+	}
+
+	conn->rpc = g_num_rpcs++;
+	spdk_jsonrpc_client_free_request(req);
+
+	return 0;
+}
+
+struct spdk_jsonrpc_client_response *
+spdk_jsonrpc_client_get_response(struct spdk_jsonrpc_client *client)
+{
+	struct ut_conn *conn = ut_find_conn(client);
+	struct spdk_jsonrpc_client_response *resp;
+
+	SPDK_CU_ASSERT_FATAL(conn->rpc >= 0 && g_rpcs[conn->rpc].done);
+	resp = calloc(1, sizeof(*resp));
+	SPDK_CU_ASSERT_FATAL(resp != NULL);
+	if (g_rpcs[conn->rpc].error) {
+		resp->error = &g_error_val;
+	}
+	conn->rpc = -1;
+
+	return resp;
+}
+
+void
+spdk_jsonrpc_client_free_response(struct spdk_jsonrpc_client_response *resp)
+{
+	free(resp);
+}
+
+void
+spdk_rpc_server_accept(struct spdk_rpc_server *server)
+{
+	uint32_t i;
+
+	g_num_accept++;
+	if (!g_sync_methods) {
+		return;
+	}
+
+	for (i = 0; i < SPDK_COUNTOF(g_conns); i++) {
+		if (g_conns[i].client != NULL && g_conns[i].rpc >= 0) {
+			g_rpcs[g_conns[i].rpc].done = true;
+		}
+	}
+}
+
+int
+spdk_rpc_get_method_state_mask(const char *method, uint32_t *state_mask)
+{
+	*state_mask = SPDK_RPC_RUNTIME;
+	return 0;
+}
+
+static void
+ut_load_done(int rc, void *ctx)
+{
+	g_load_done = true;
+	g_load_rc = rc;
+}
+
+static void
+ut_poll(void)
+{
+	int i;
+
+	for (i = 0; i < 10; i++) {
+		spdk_delay_us(100);
+		poll_threads();
+	}
+}
+
+/* Let the server apply the given entry and the loader receive the response */
+static void
+ut_complete(const char *method, const char *key, bool error)
+{
+	struct ut_rpc *rpc = ut_find_rpc(method, key);
+
+	SPDK_CU_ASSERT_FATAL(rpc != NULL);
+	CU_ASSERT(!rpc->done);
+	rpc->done = true;
+	rpc->error = error;
+	ut_poll();
+}
+
+static void
+ut_load(bool stop_on_error)
+{
+	memset(g_rpcs, 0, sizeof(g_rpcs));
+	g_num_rpcs = 0;
+	g_num_closed = 0;
+	g_load_done = false;
+	g_load_rc = -1;
+	g_num_accept = 0;
+
+	spdk_subsystem_load_config((void *)g_config, sizeof(g_config) - 1, ut_load_done, NULL,
+				   stop_on_error);
+	ut_poll();
+}
+
+static void
+test_load_config_concurrent(void)
+{
+	ut_load(false);
+
+	/* Entries without "nqn" are applied one at a time */
+	CU_ASSERT(g_num_rpcs == 1);
+	CU_ASSERT(ut_num_in_flight() == 1);
+	ut_complete("bdev_malloc_create", "Malloc0", false);
+	CU_ASSERT(g_num_rpcs == 2);
+	CU_ASSERT(ut_num_in_flight() == 1);
+	ut_complete("bdev_malloc_create", "Malloc1", false);
+	CU_ASSERT(ut_num_in_flight() == 1);
+	ut_complete("nvmf_create_transport", "", false);
+
+	/* Different subsystems are created concurrently */
+	CU_ASSERT(ut_num_in_flight() == 2);
+	CU_ASSERT(ut_find_rpc("nvmf_create_subsystem", "nqn.ut:0") != NULL);
+	CU_ASSERT(ut_find_rpc("nvmf_create_subsystem", "nqn.ut:1") != NULL);
+
+	/* The next entry belongs to the first subsystem and keeps waiting for it */
+	ut_complete("nvmf_create_subsystem", "nqn.ut:1", false);
+	CU_ASSERT(ut_num_in_flight() == 1);
+	CU_ASSERT(ut_find_rpc("nvmf_subsystem_add_ns", "nqn.ut:0") == NULL);
+	ut_complete("nvmf_create_subsystem", "nqn.ut:0", false);
+	CU_ASSERT(ut_num_in_flight() == 2);
+	CU_ASSERT(ut_find_rpc("nvmf_subsystem_add_listener", "nqn.ut:0") == NULL);
+
+	ut_complete("nvmf_subsystem_add_ns", "nqn.ut:0", false);
+	CU_ASSERT(ut_num_in_flight() == 2);
+	ut_complete("nvmf_subsystem_add_listener", "nqn.ut:0", false);
+
+	/* The next subsystem's section waits for the whole previous one */
+	CU_ASSERT(ut_num_in_flight() == 1);
+	CU_ASSERT(ut_find_rpc("iscsi_set_options", "") == NULL);
+	ut_complete("nvmf_subsystem_add_ns", "nqn.ut:1", false);
+	CU_ASSERT(ut_num_in_flight() == 1);
+	CU_ASSERT(!g_load_done);
+	ut_complete("iscsi_set_options", "", false);
+
+	CU_ASSERT(g_num_rpcs == 9);
+	CU_ASSERT(g_load_done);
+	CU_ASSERT(g_load_rc == 0);
+	CU_ASSERT(g_num_closed == RPC_CLIENT_MAX_CONNS);
+}
+
+static void
+test_load_config_stop_on_error(void)
+{
+	ut_load(true);
+
+	ut_complete("bdev_malloc_create", "Malloc0", false);
+	ut_complete("bdev_malloc_create", "Malloc1", false);
+	ut_complete("nvmf_create_transport", "", false);
+	CU_ASSERT(ut_num_in_flight() == 2);
+
+	/* Nothing else is sent after an error, but the loading waits for the outstanding request */
+	ut_complete("nvmf_create_subsystem", "nqn.ut:0", true);
+	CU_ASSERT(g_num_rpcs == 5);
+	CU_ASSERT(ut_num_in_flight() == 1);
+	CU_ASSERT(!g_load_done);
+	CU_ASSERT(g_num_closed == 0);
+
+	ut_complete("nvmf_create_subsystem", "nqn.ut:1", false);
+	CU_ASSERT(g_num_rpcs == 5);
+	CU_ASSERT(g_load_done);
+	CU_ASSERT(g_load_rc == -EINVAL);
+	CU_ASSERT(g_num_closed == RPC_CLIENT_MAX_CONNS);
+
+	/* Nothing is left running */
+	ut_poll();
+	CU_ASSERT(g_num_rpcs == 5);
+}
+
+static void
+test_load_config_sync_methods(void)
+{
+	int i, ticks = 0;
+
+	g_sync_methods = true;
+	memset(g_rpcs, 0, sizeof(g_rpcs));
+	g_num_rpcs = 0;
+	g_num_closed = 0;
+	g_load_done = false;
+	g_load_rc = -1;
+	g_num_accept = 0;
+
+	spdk_subsystem_load_config((void *)g_config, sizeof(g_config) - 1, ut_load_done, NULL,
+				   false);
+
+	/* The loader polls the server itself, each entry is applied within one poller tick */
+	while (!g_load_done && ticks < 100) {
+		spdk_delay_us(100);
+		poll_threads();
+		ticks++;
+	}
+
+	CU_ASSERT(g_load_done);
+	CU_ASSERT(g_load_rc == 0);
+	CU_ASSERT(g_num_rpcs == 9);
+	CU_ASSERT(g_num_accept > 0);
+	for (i = 0; i < g_num_rpcs; i++) {
+		CU_ASSERT(g_rpcs[i].done);
+	}
+	/* The longest chain of dependent entries is 7 entries long, plus the connect */
+	CU_ASSERT(ticks <= 8);
+
+	g_sync_methods = false;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("json_config", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_load_config_concurrent);
+	CU_ADD_TEST(suite, test_load_config_stop_on_error);
+	CU_ADD_TEST(suite, test_load_config_sync_methods);
+
+	allocate_threads(1);
+	set_thread(0);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	free_threads();
+	CU_cleanup_registry();
+	return num_failures;
+}
@@ -22,8 +22,6 @@ DEFINE_STUB(iscsi_get_pdu, struct spdk_iscsi_pdu *,
 DEFINE_STUB(iscsi_param_eq_val, int,
 	    (struct iscsi_param *params, const char *key, const char *val), 0);
 DEFINE_STUB(iscsi_pdu_calc_data_digest, uint32_t, (struct spdk_iscsi_pdu *pdu), 0);
-DEFINE_STUB_V(spdk_sock_writev_async,
-	      (struct spdk_sock *sock, struct spdk_sock_request *req));
 
 struct spdk_scsi_lun {
 	uint8_t reserved;
@@ -37,6 +35,31 @@ static TAILQ_HEAD(read_tasks_head, spdk_iscsi_task) g_ut_read_tasks =
 	TAILQ_HEAD_INITIALIZER(g_ut_read_tasks);
 static struct spdk_iscsi_task *g_new_task = NULL;
 static ssize_t g_sock_writev_bytes = 0;
+static struct spdk_sock_request *g_sock_reqs[4];
+static uint32_t g_sock_req_cnt;
+static spdk_accel_completion_cb g_accel_cb_fn;
+static void *g_accel_cb_arg;
+
+void
+spdk_sock_writev_async(struct spdk_sock *sock, struct spdk_sock_request *req)
+{
+	if (g_sock_req_cnt < SPDK_COUNTOF(g_sock_reqs)) {
+		g_sock_reqs[g_sock_req_cnt] = req;
+	}
+	g_sock_req_cnt++;
+}
+
+int
+spdk_accel_submit_crc32cv(struct spdk_io_channel *ch, uint32_t *dst, struct iovec *iovs,
+			  uint32_t iovcnt, uint32_t seed, spdk_accel_completion_cb cb_fn,
+			  void *cb_arg)
+{
+	*dst = spdk_crc32c_iov_update(iovs, iovcnt, ~seed);
+	g_accel_cb_fn = cb_fn;
+	g_accel_cb_arg = cb_arg;
+
+	return 0;
+}
 
 DEFINE_STUB(spdk_app_get_shm_id, int, (void), 0);
 
@@ -537,6 +560,53 @@ iscsi_conn_pdu_dummy_complete(void *arg)
 {
 }
 
+static void
+least_loaded_poll_group_test(void)
+{
+	struct spdk_iscsi_poll_group pg[3] = {};
+	struct spdk_iscsi_conn conn[3] = {};
+	struct spdk_iscsi_conn *conns[3] = { &conn[0], &conn[1], &conn[2] };
+	struct spdk_iscsi_sess sess = {};
+	int i;
+
+	TAILQ_INIT(&g_iscsi.poll_group_head);
+	for (i = 0; i < 3; i++) {
+		TAILQ_INSERT_TAIL(&g_iscsi.poll_group_head, &pg[i], link);
+	}
+	sess.conns = conns;
+
+	pg[0].load = 10;
+	pg[1].load = 5;
+	pg[1].num_active_conns = 2;
+	pg[2].load = 5;
+	pg[2].num_active_conns = 1;
+
+	/* Same load, the poll group with fewer connections wins */
+	CU_ASSERT(iscsi_get_least_loaded_poll_group(&sess) == &pg[2]);
+
+	/* A poll group already used by the session is avoided, even if it's less loaded */
+	conn[0].pg = &pg[2];
+	conn[0].scheduled = 1;
+	sess.connections = 1;
+	CU_ASSERT(iscsi_get_least_loaded_poll_group(&sess) == &pg[1]);
+
+	/* A connection that is not scheduled yet doesn't count */
+	conn[1].pg = &pg[1];
+	sess.connections = 2;
+	CU_ASSERT(iscsi_get_least_loaded_poll_group(&sess) == &pg[1]);
+
+	conn[1].scheduled = 1;
+	CU_ASSERT(iscsi_get_least_loaded_poll_group(&sess) == &pg[0]);
+
+	/* All poll groups used by the session, the least loaded one is picked */
+	conn[2].pg = &pg[0];
+	conn[2].scheduled = 1;
+	sess.connections = 3;
+	CU_ASSERT(iscsi_get_least_loaded_poll_group(&sess) == &pg[2]);
+
+	TAILQ_INIT(&g_iscsi.poll_group_head);
+}
+
 static void
 free_tasks_on_connection(void)
 {
@@ -886,6 +956,86 @@ abort_queued_datain_tasks_test(void)
 	g_new_task = NULL;
 }
 
+static void
+write_pdu_data_digest_test(void)
+{
+	struct spdk_iscsi_conn conn = {};
+	struct spdk_iscsi_poll_group pg = {};
+	struct spdk_iscsi_pdu pdu1 = {}, pdu2 = {}, pdu3 = {};
+	uint8_t data[512];
+	uint8_t digest[ISCSI_DIGEST_LEN];
+	uint32_t crc32c;
+
+	memset(data, 0xa5, sizeof(data));
+	pg.accel_ch = (struct spdk_io_channel *)0xdeadbeef;
+	conn.pg = &pg;
+	conn.data_digest = 1;
+	conn.state = ISCSI_CONN_STATE_RUNNING;
+	TAILQ_INIT(&conn.write_pdu_list);
+	g_sock_req_cnt = 0;
+
+	/* Data-In PDU, its data digest is calculated by accel */
+	pdu1.conn = &conn;
+	pdu1.bhs.opcode = ISCSI_OP_SCSI_DATAIN;
+	pdu1.data = data;
+	DSET24(pdu1.bhs.data_segment_len, sizeof(data));
+
+	iscsi_conn_write_pdu(&conn, &pdu1, iscsi_conn_pdu_generic_complete, NULL);
+	CU_ASSERT(pdu1.data_digest_pending);
+	CU_ASSERT(pdu1.write_deferred);
+	CU_ASSERT(conn.data_digest_cnt == 1);
+	CU_ASSERT(g_sock_req_cnt == 0);
+
+	/* PDU without data written after it has to wait too */
+	pdu2.conn = &conn;
+	pdu2.bhs.opcode = ISCSI_OP_SCSI_RSP;
+
+	iscsi_conn_write_pdu(&conn, &pdu2, iscsi_conn_pdu_generic_complete, NULL);
+	CU_ASSERT(!pdu2.data_digest_pending);
+	CU_ASSERT(pdu2.write_deferred);
+	CU_ASSERT(conn.deferred_pdu_cnt == 2);
+	CU_ASSERT(g_sock_req_cnt == 0);
+
+	g_accel_cb_fn(g_accel_cb_arg, 0);
+	CU_ASSERT(conn.data_digest_cnt == 0);
+	CU_ASSERT(conn.deferred_pdu_cnt == 0);
+	CU_ASSERT(g_sock_req_cnt == 2);
+	CU_ASSERT(g_sock_reqs[0] == &pdu1.sock_req);
+	CU_ASSERT(g_sock_reqs[1] == &pdu2.sock_req);
+
+	crc32c = spdk_crc32c_update(data, sizeof(data), SPDK_CRC32C_INITIAL) ^ SPDK_CRC32C_XOR;
+	MAKE_DIGEST_WORD(digest, crc32c);
+	CU_ASSERT(memcmp(pdu1.data_digest, digest, ISCSI_DIGEST_LEN) == 0);
+
+	/* Nothing pending, the PDU is written immediately */
+	pdu3.conn = &conn;
+	pdu3.bhs.opcode = ISCSI_OP_SCSI_RSP;
+
+	iscsi_conn_write_pdu(&conn, &pdu3, iscsi_conn_pdu_generic_complete, NULL);
+	CU_ASSERT(!pdu3.write_deferred);
+	CU_ASSERT(g_sock_req_cnt == 3);
+	CU_ASSERT(g_sock_reqs[2] == &pdu3.sock_req);
+
+	/* A PDU waiting for its digest isn't freed with the connection */
+	memset(&pdu1, 0, sizeof(pdu1));
+	pdu1.conn = &conn;
+	pdu1.bhs.opcode = ISCSI_OP_SCSI_DATAIN;
+	pdu1.data = data;
+	DSET24(pdu1.bhs.data_segment_len, sizeof(data));
+	TAILQ_INIT(&conn.write_pdu_list);
+
+	iscsi_conn_write_pdu(&conn, &pdu1, iscsi_conn_pdu_generic_complete, NULL);
+	CU_ASSERT(pdu1.data_digest_pending);
+
+	conn.state = ISCSI_CONN_STATE_EXITING;
+	CU_ASSERT(iscsi_conn_free_tasks(&conn) == -1);
+	CU_ASSERT(TAILQ_FIRST(&conn.write_pdu_list) == &pdu1);
+
+	g_accel_cb_fn(g_accel_cb_arg, 0);
+	CU_ASSERT(conn.data_digest_cnt == 0);
+	CU_ASSERT(g_sock_req_cnt == 3);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -900,10 +1050,12 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, read_task_split_reverse_order_case);
 	CU_ADD_TEST(suite, propagate_scsi_error_status_for_split_read_tasks);
 	CU_ADD_TEST(suite, process_non_read_task_completion_test);
+	CU_ADD_TEST(suite, least_loaded_poll_group_test);
 	CU_ADD_TEST(suite, free_tasks_on_connection);
 	CU_ADD_TEST(suite, free_tasks_with_queued_datain);
 	CU_ADD_TEST(suite, abort_queued_datain_task_test);
 	CU_ADD_TEST(suite, abort_queued_datain_tasks_test);
+	CU_ADD_TEST(suite, write_pdu_data_digest_test);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
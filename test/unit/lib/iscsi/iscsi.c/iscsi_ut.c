@@ -282,6 +282,7 @@ maxburstlength_test(void)
 	sess.MaxCmdSN = 64;
 	sess.session_type = SESSION_TYPE_NORMAL;
 	sess.MaxBurstLength = 1024;
+	sess.MaxOutstandingR2T = 2;
 
 	lun.id = 0;
 
@@ -727,6 +728,49 @@ add_transfer_task_test(void)
 	iscsi_put_pdu(pdu);
 }
 
+static void
+r2t_window_test(void)
+{
+	struct spdk_iscsi_sess sess = {};
+	struct spdk_iscsi_conn conn = {};
+
+	sess.MaxBurstLength = SPDK_ISCSI_MAX_BURST_LENGTH;	/* 16 data out buffers */
+	conn.sess = &sess;
+
+	MOCK_SET(spdk_mempool_count, 1024);
+
+	/* Only a single R2T negotiated */
+	sess.MaxOutstandingR2T = 1;
+	CU_ASSERT(iscsi_conn_r2t_window(&conn) == 1);
+
+	/* Nothing measured yet, use all negotiated R2Ts */
+	sess.MaxOutstandingR2T = 8;
+	CU_ASSERT(iscsi_conn_r2t_window(&conn) == 8);
+
+	/* The first sample is taken as is, later ones are averaged */
+	iscsi_conn_r2t_sample(&conn.r2t_rtt_ticks, 300);
+	iscsi_conn_r2t_sample(&conn.r2t_burst_ticks, 100);
+	CU_ASSERT(conn.r2t_rtt_ticks == 300);
+	CU_ASSERT(conn.r2t_burst_ticks == 100);
+	CU_ASSERT(iscsi_conn_r2t_window(&conn) == 4);
+
+	iscsi_conn_r2t_sample(&conn.r2t_rtt_ticks, 1100);
+	CU_ASSERT(conn.r2t_rtt_ticks == 400);
+	CU_ASSERT(iscsi_conn_r2t_window(&conn) == 5);
+
+	/* Limited by the negotiated MaxOutstandingR2T */
+	conn.r2t_rtt_ticks = 100000;
+	CU_ASSERT(iscsi_conn_r2t_window(&conn) == 8);
+
+	/* Limited by the free data out buffers, but at least one R2T */
+	MOCK_SET(spdk_mempool_count, 16 * 3 + 1);
+	CU_ASSERT(iscsi_conn_r2t_window(&conn) == 3);
+	MOCK_SET(spdk_mempool_count, 0);
+	CU_ASSERT(iscsi_conn_r2t_window(&conn) == 1);
+
+	MOCK_CLEAR(spdk_mempool_count);
+}
+
 static void
 get_transfer_task_test(void)
 {
@@ -1982,6 +2026,7 @@ pdu_hdr_op_data_test(void)
 	to_be32(&data_reqh->data_sn, primary.r2t_datasn);
 	to_be32(&data_reqh->buffer_offset, primary.next_expected_r2t_offset);
 	primary.scsi.transfer_len = pdu.data_segment_len * 5;
+	primary.R2TSN = 1;
 
 	rc = iscsi_pdu_hdr_op_data(&conn, &pdu);
 	CU_ASSERT(rc == 0);
@@ -2608,6 +2653,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, underflow_for_request_sense_test);
 	CU_ADD_TEST(suite, underflow_for_check_condition_test);
 	CU_ADD_TEST(suite, add_transfer_task_test);
+	CU_ADD_TEST(suite, r2t_window_test);
 	CU_ADD_TEST(suite, get_transfer_task_test);
 	CU_ADD_TEST(suite, del_transfer_task_test);
 	CU_ADD_TEST(suite, clear_all_transfer_tasks_test);
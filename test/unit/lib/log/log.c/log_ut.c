@@ -242,6 +242,57 @@ log_ext_test(void)
 	CU_ASSERT(g_log_state == LOG_EXT_CLOSED);
 }
 
+static void
+log_async_test(void)
+{
+	char line[MAX_TMPBUF + 128];
+	int stderr_fd, num_msgs = 0, num_suppressed = 0, i;
+	FILE *out;
+
+	out = tmpfile();
+	SPDK_CU_ASSERT_FATAL(out != NULL);
+	stderr_fd = dup(STDERR_FILENO);
+	SPDK_CU_ASSERT_FATAL(stderr_fd >= 0);
+	fflush(stderr);
+	dup2(fileno(out), STDERR_FILENO);
+
+	spdk_log_open(NULL);
+	spdk_log_set_level(SPDK_LOG_DISABLED);
+	spdk_log_set_print_level(SPDK_LOG_NOTICE);
+	CU_ASSERT(spdk_log_enable_async(true) == 0);
+	CU_ASSERT(g_log_async.enabled);
+
+	/* A single call site is limited to LOG_ASYNC_SITE_BURST messages per second */
+	for (i = 0; i < LOG_ASYNC_SITE_BURST + 10; i++) {
+		SPDK_NOTICELOG("async log unit test %d\n", i);
+	}
+
+	/* Closing the log writes all queued messages and reports the suppressed ones */
+	spdk_log_close();
+	CU_ASSERT(!g_log_async.enabled);
+	CU_ASSERT(g_log_async.ring == NULL);
+
+	fflush(stderr);
+	dup2(stderr_fd, STDERR_FILENO);
+	close(stderr_fd);
+
+	rewind(out);
+	while (fgets(line, sizeof(line), out) != NULL) {
+		if (strstr(line, "async log unit test") != NULL) {
+			num_msgs++;
+		} else if (strstr(line, "log messages suppressed") != NULL) {
+			num_suppressed++;
+		}
+	}
+	fclose(out);
+
+	/* The messages may have spanned two seconds, letting more through */
+	CU_ASSERT(num_msgs >= LOG_ASYNC_SITE_BURST);
+	CU_ASSERT(num_msgs == LOG_ASYNC_SITE_BURST + 10 || num_suppressed == 1);
+
+	spdk_log_set_print_level(SPDK_LOG_DEBUG);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -255,6 +306,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, log_test);
 	CU_ADD_TEST(suite, deprecation);
 	CU_ADD_TEST(suite, log_ext_test);
+	CU_ADD_TEST(suite, log_async_test);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
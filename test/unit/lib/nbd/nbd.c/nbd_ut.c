@@ -0,0 +1,678 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+#include "spdk/bdev_module.h"
+
+#include "common/lib/test_env.c"
+#include "unit/lib/json_mock.c"
+#include "nbd/nbd.c"
+
+#define UT_NBD_PATH		"/dev/nbd_ut"
+#define UT_BLOCK_SIZE		512
+#define UT_NUM_BLOCKS		64
+#define UT_NUM_CONNS		4
+#define UT_MAX_THREADS		(UT_NUM_CONNS + 1)
+#define UT_MAX_POLLS		100000
+
+/* I/O sent to the bdev, completed by ut_poll_threads() unless g_hold_bdev_ios is set */
+struct ut_bdev_io {
+	bool				write;
+	void				*buf;
+	uint64_t			offset;
+	uint64_t			nbytes;
+	struct spdk_thread		*thread;
+	spdk_bdev_io_completion_cb	cb;
+	void				*cb_arg;
+	TAILQ_ENTRY(ut_bdev_io)		link;
+};
+
+static TAILQ_HEAD(, ut_bdev_io) g_bdev_ios = TAILQ_HEAD_INITIALIZER(g_bdev_ios);
+static bool g_hold_bdev_ios;
+static struct spdk_bdev g_bdev = {
+	.name = "Malloc0",
+	.blocklen = UT_BLOCK_SIZE,
+	.blockcnt = UT_NUM_BLOCKS,
+};
+static uint8_t g_bdev_data[UT_NUM_BLOCKS * UT_BLOCK_SIZE];
+static spdk_bdev_event_cb_t g_bdev_event_cb;
+static void *g_bdev_event_ctx;
+static int g_bdev_io_device;
+static uint32_t g_num_bdev_channels;
+
+/* The first thread is the app thread the disks are started on */
+static struct spdk_thread *g_threads[UT_MAX_THREADS];
+static uint32_t g_num_threads;
+/* spdk_thread_create() fails once this many threads exist */
+static uint32_t g_max_threads = UT_MAX_THREADS;
+
+/* The kernel side of the connections, duplicated as the kernel holds its own reference */
+static int g_kernel_fds[UT_NUM_CONNS];
+static uint32_t g_num_kernel_fds;
+static unsigned long g_nbd_flags;
+
+static struct spdk_nbd_disk *g_start_nbd;
+static int g_start_rc;
+static bool g_start_done;
+
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB(spdk_bdev_get_buf_align, size_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_io_type_supported, bool, (struct spdk_bdev *bdev,
+		enum spdk_bdev_io_type io_type), true);
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB_V(spdk_unaffinitize_thread, (void));
+
+int __wrap_ioctl(int fd, unsigned long request, ...);
+int __wrap_open(const char *pathname, int flags, ...);
+int __real_open(const char *pathname, int flags, ...);
+
+/* Serve the kernel side until SPDK closed all the sockets, like the NBD_DO_IT ioctl does */
+static void
+ut_nbd_do_it(void)
+{
+	struct pollfd pfd;
+	uint32_t i;
+
+	for (i = 0; i < g_num_kernel_fds; i++) {
+		pfd.fd = g_kernel_fds[i];
+		pfd.events = POLLRDHUP;
+		while (poll(&pfd, 1, 10) == 0 || !(pfd.revents & (POLLRDHUP | POLLHUP))) {
+		}
+	}
+}
+
+int
+__wrap_ioctl(int fd, unsigned long request, ...)
+{
+	va_list ap;
+
+	switch (request) {
+	case NBD_SET_SOCK:
+		va_start(ap, request);
+		g_kernel_fds[g_num_kernel_fds] = dup(va_arg(ap, int));
+		va_end(ap);
+		SPDK_CU_ASSERT_FATAL(g_kernel_fds[g_num_kernel_fds] >= 0);
+		g_num_kernel_fds++;
+		break;
+	case NBD_SET_FLAGS:
+		va_start(ap, request);
+		g_nbd_flags = va_arg(ap, unsigned long);
+		va_end(ap);
+		break;
+	case NBD_DO_IT:
+		ut_nbd_do_it();
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+int
+__wrap_open(const char *pathname, int flags, ...)
+{
+	va_list ap;
+	mode_t mode = 0;
+
+	if (strcmp(pathname, UT_NBD_PATH) == 0) {
+		return __real_open("/dev/null", O_RDWR);
+	}
+
+	if (flags & O_CREAT) {
+		va_start(ap, flags);
+		mode = va_arg(ap, mode_t);
+		va_end(ap);
+	}
+
+	return __real_open(pathname, flags, mode);
+}
+
+int
+spdk_bdev_open_ext(const char *bdev_name, bool write, spdk_bdev_event_cb_t event_cb,
+		   void *event_ctx, struct spdk_bdev_desc **desc)
+{
+	if (strcmp(bdev_name, g_bdev.name) != 0) {
+		return -ENODEV;
+	}
+
+	g_bdev_event_cb = event_cb;
+	g_bdev_event_ctx = event_ctx;
+	*desc = (void *)&g_bdev;
+
+	return 0;
+}
+
+struct spdk_bdev *
+spdk_bdev_desc_get_bdev(struct spdk_bdev_desc *desc)
+{
+	return (void *)desc;
+}
+
+const char *
+spdk_bdev_get_name(const struct spdk_bdev *bdev)
+{
+	return bdev->name;
+}
+
+uint32_t
+spdk_bdev_get_block_size(const struct spdk_bdev *bdev)
+{
+	return bdev->blocklen;
+}
+
+uint64_t
+spdk_bdev_get_num_blocks(const struct spdk_bdev *bdev)
+{
+	return bdev->blockcnt;
+}
+
+struct spdk_io_channel *
+spdk_bdev_get_io_channel(struct spdk_bdev_desc *desc)
+{
+	return spdk_get_io_channel(&g_bdev_io_device);
+}
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io);
+}
+
+static int
+ut_queue_bdev_io(bool write, void *buf, uint64_t offset, uint64_t nbytes,
+		 spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct ut_bdev_io *io;
+
+	CU_ASSERT(offset + nbytes <= sizeof(g_bdev_data));
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->write = write;
+	io->buf = buf;
+	io->offset = offset;
+	io->nbytes = nbytes;
+	io->thread = spdk_get_thread();
+	io->cb = cb;
+	io->cb_arg = cb_arg;
+	TAILQ_INSERT_TAIL(&g_bdev_ios, io, link);
+
+	return 0;
+}
+
+int
+spdk_bdev_read(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch, void *buf,
+	       uint64_t offset, uint64_t nbytes, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return ut_queue_bdev_io(false, buf, offset, nbytes, cb, cb_arg);
+}
+
+int
+spdk_bdev_write(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch, void *buf,
+		uint64_t offset, uint64_t nbytes, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return ut_queue_bdev_io(true, buf, offset, nbytes, cb, cb_arg);
+}
+
+int
+spdk_bdev_flush(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset, uint64_t length, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return ut_queue_bdev_io(false, NULL, offset, 0, cb, cb_arg);
+}
+
+int
+spdk_bdev_unmap(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset, uint64_t nbytes, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return ut_queue_bdev_io(false, NULL, offset, 0, cb, cb_arg);
+}
+
+/* Complete the I/O sent to the bdev, on the threads they were submitted from. */
+static int
+ut_complete_bdev_ios(void)
+{
+	struct ut_bdev_io *io;
+	int count = 0;
+
+	while ((io = TAILQ_FIRST(&g_bdev_ios)) != NULL) {
+		TAILQ_REMOVE(&g_bdev_ios, io, link);
+		if (io->write) {
+			memcpy(g_bdev_data + io->offset, io->buf, io->nbytes);
+		} else if (io->buf != NULL) {
+			memcpy(io->buf, g_bdev_data + io->offset, io->nbytes);
+		}
+
+		spdk_set_thread(io->thread);
+		/* The ut_bdev_io is released by spdk_bdev_free_io() */
+		io->cb((struct spdk_bdev_io *)io, true, io->cb_arg);
+		count++;
+	}
+
+	spdk_set_thread(g_threads[0]);
+
+	return count;
+}
+
+static int
+ut_bdev_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	g_num_bdev_channels++;
+
+	return 0;
+}
+
+static void
+ut_bdev_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+	g_num_bdev_channels--;
+}
+
+static int
+ut_new_thread(struct spdk_thread *thread)
+{
+	if (g_num_threads == g_max_threads) {
+		return -ENOMEM;
+	}
+
+	g_threads[g_num_threads++] = thread;
+
+	return 0;
+}
+
+/* Poll all the threads once, destroying the ones that exited. Returns the amount of work done. */
+static int
+ut_poll_threads(void)
+{
+	struct spdk_thread *thread;
+	uint32_t i = 0;
+	int count = 0;
+
+	if (!g_hold_bdev_ios) {
+		count += ut_complete_bdev_ios();
+	}
+
+	while (i < g_num_threads) {
+		thread = g_threads[i];
+		count += spdk_thread_poll(thread, 0, 0);
+		if (spdk_thread_is_exited(thread)) {
+			spdk_thread_destroy(thread);
+			g_threads[i] = g_threads[--g_num_threads];
+			count++;
+			continue;
+		}
+		i++;
+	}
+
+	spdk_set_thread(g_threads[0]);
+
+	return count;
+}
+
+/* Poll the threads until they are idle, giving the nbd pthread and the timed pollers a chance to
+ * run in between.
+ */
+static void
+ut_poll_idle(void)
+{
+	int i;
+
+	for (i = 0; i < 10; i++) {
+		while (ut_poll_threads() > 0) {
+		}
+		spdk_delay_us(NBD_BUSY_POLLING_INTERVAL_US);
+		usleep(100);
+	}
+}
+
+static bool
+ut_nbd_stopped(void)
+{
+	return nbd_disk_first() == NULL && g_num_threads == 1;
+}
+
+static void
+ut_wait_stopped(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < UT_MAX_POLLS && !ut_nbd_stopped(); i++) {
+		if (ut_poll_threads() == 0) {
+			spdk_delay_us(NBD_BUSY_POLLING_INTERVAL_US);
+			usleep(10);
+		}
+	}
+
+	CU_ASSERT(ut_nbd_stopped());
+	CU_ASSERT(g_num_bdev_channels == 0);
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_ios));
+}
+
+static void
+ut_close_kernel_fds(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < g_num_kernel_fds; i++) {
+		close(g_kernel_fds[i]);
+	}
+	g_num_kernel_fds = 0;
+}
+
+static void
+ut_start_cb(void *cb_arg, struct spdk_nbd_disk *nbd, int rc)
+{
+	g_start_nbd = nbd;
+	g_start_rc = rc;
+	g_start_done = true;
+}
+
+static void
+ut_start(uint32_t num_connections)
+{
+	struct spdk_nbd_start_opts opts;
+
+	g_start_nbd = NULL;
+	g_start_rc = 1;
+	g_start_done = false;
+	g_nbd_flags = 0;
+
+	spdk_nbd_start_opts_init(&opts, sizeof(opts));
+	opts.num_connections = num_connections;
+	spdk_nbd_start_ext(g_bdev.name, UT_NBD_PATH, &opts, ut_start_cb, NULL);
+}
+
+static struct spdk_nbd_disk *
+ut_start_wait(uint32_t num_connections)
+{
+	uint32_t i;
+
+	ut_start(num_connections);
+	for (i = 0; i < UT_MAX_POLLS && !g_start_done; i++) {
+		if (ut_poll_threads() == 0) {
+			usleep(10);
+		}
+	}
+
+	CU_ASSERT(g_start_done);
+	CU_ASSERT(g_start_rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_start_nbd != NULL);
+	CU_ASSERT(g_num_kernel_fds == num_connections);
+	CU_ASSERT(g_num_threads == num_connections);
+
+	return g_start_nbd;
+}
+
+static void
+ut_send_request(uint32_t conn, uint32_t type, uint64_t handle, uint64_t offset, uint32_t len,
+		void *payload)
+{
+	struct nbd_request req = {};
+
+	to_be32(&req.magic, NBD_REQUEST_MAGIC);
+	to_be32(&req.type, type);
+	memcpy(&req.handle, &handle, sizeof(req.handle));
+	to_be64(&req.from, offset);
+	to_be32(&req.len, len);
+
+	CU_ASSERT(write(g_kernel_fds[conn], &req, sizeof(req)) == sizeof(req));
+	if (payload != NULL) {
+		CU_ASSERT(write(g_kernel_fds[conn], payload, len) == len);
+	}
+}
+
+static void
+ut_read_all(int fd, void *buf, size_t len)
+{
+	size_t done = 0;
+	ssize_t rc;
+	uint32_t i;
+
+	for (i = 0; i < UT_MAX_POLLS && done < len; i++) {
+		rc = read(fd, (uint8_t *)buf + done, len - done);
+		if (rc > 0) {
+			done += rc;
+		} else {
+			CU_ASSERT(rc == -1 && errno == EAGAIN);
+			ut_poll_threads();
+		}
+	}
+
+	CU_ASSERT(done == len);
+}
+
+/* Receive the reply to a request, with the payload of a read. Returns the error of the reply. */
+static uint32_t
+ut_recv_reply(uint32_t conn, uint64_t handle, void *payload, uint32_t len)
+{
+	struct nbd_reply reply = {};
+
+	ut_read_all(g_kernel_fds[conn], &reply, sizeof(reply));
+	CU_ASSERT(from_be32(&reply.magic) == NBD_REPLY_MAGIC);
+	CU_ASSERT(memcmp(&reply.handle, &handle, sizeof(reply.handle)) == 0);
+	if (reply.error == 0 && payload != NULL) {
+		ut_read_all(g_kernel_fds[conn], payload, len);
+	}
+
+	return from_be32(&reply.error);
+}
+
+static void
+test_nbd_multi_conn(void)
+{
+	struct spdk_nbd_disk *nbd;
+	uint8_t wbuf[UT_BLOCK_SIZE], rbuf[UT_BLOCK_SIZE];
+	bool seen[UT_NUM_CONNS] = {};
+	struct ut_bdev_io *io;
+	uint32_t i, j;
+
+	nbd = ut_start_wait(UT_NUM_CONNS);
+	CU_ASSERT(nbd_disk_get_num_connections(nbd) == UT_NUM_CONNS);
+	CU_ASSERT(g_nbd_flags & NBD_FLAG_CAN_MULTI_CONN);
+	CU_ASSERT(g_num_bdev_channels == UT_NUM_CONNS);
+
+	/* Each connection submits its requests from its own thread */
+	g_hold_bdev_ios = true;
+	for (i = 0; i < UT_NUM_CONNS; i++) {
+		ut_send_request(i, NBD_CMD_READ, i, i * UT_BLOCK_SIZE, UT_BLOCK_SIZE, NULL);
+	}
+	ut_poll_idle();
+	TAILQ_FOREACH(io, &g_bdev_ios, link) {
+		for (j = 0; j < UT_NUM_CONNS; j++) {
+			if (io->thread == nbd->conns[j].thread) {
+				break;
+			}
+		}
+		SPDK_CU_ASSERT_FATAL(j < UT_NUM_CONNS);
+		CU_ASSERT(io->offset == j * UT_BLOCK_SIZE);
+		CU_ASSERT(!seen[j]);
+		seen[j] = true;
+	}
+	for (i = 0; i < UT_NUM_CONNS; i++) {
+		CU_ASSERT(seen[i]);
+	}
+	g_hold_bdev_ios = false;
+	for (i = 0; i < UT_NUM_CONNS; i++) {
+		CU_ASSERT(ut_recv_reply(i, i, rbuf, UT_BLOCK_SIZE) == 0);
+	}
+
+	/* Data written over a connection is read back over another one */
+	for (i = 0; i < UT_NUM_CONNS; i++) {
+		memset(wbuf, 0x10 + i, sizeof(wbuf));
+		ut_send_request(i, NBD_CMD_WRITE, i, i * UT_BLOCK_SIZE, UT_BLOCK_SIZE, wbuf);
+		CU_ASSERT(ut_recv_reply(i, i, NULL, 0) == 0);
+	}
+	for (i = 0; i < UT_NUM_CONNS; i++) {
+		j = (i + 1) % UT_NUM_CONNS;
+		memset(wbuf, 0x10 + i, sizeof(wbuf));
+		ut_send_request(j, NBD_CMD_READ, i, i * UT_BLOCK_SIZE, UT_BLOCK_SIZE, NULL);
+		CU_ASSERT(ut_recv_reply(j, i, rbuf, UT_BLOCK_SIZE) == 0);
+		CU_ASSERT(memcmp(rbuf, wbuf, sizeof(rbuf)) == 0);
+	}
+
+	/* Stopping completes asynchronously, once every connection released its thread */
+	CU_ASSERT(spdk_nbd_stop(nbd) == 1);
+	ut_wait_stopped();
+	ut_close_kernel_fds();
+}
+
+static void
+test_nbd_stop_while_starting(void)
+{
+	struct spdk_nbd_disk *nbd;
+	uint32_t i;
+
+	/* The nbd pthread hasn't let the start complete yet, the stop is deferred to then */
+	ut_start(UT_NUM_CONNS);
+	nbd = nbd_disk_first();
+	SPDK_CU_ASSERT_FATAL(nbd != NULL);
+	CU_ASSERT(!g_start_done);
+	CU_ASSERT(spdk_nbd_stop(nbd) == 1);
+	CU_ASSERT(nbd_disk_first() == nbd);
+
+	for (i = 0; i < UT_MAX_POLLS && !g_start_done; i++) {
+		if (ut_poll_threads() == 0) {
+			usleep(10);
+		}
+	}
+	CU_ASSERT(g_start_done);
+	CU_ASSERT(g_start_rc == 0);
+	CU_ASSERT(g_start_nbd == nbd);
+
+	ut_wait_stopped();
+	ut_close_kernel_fds();
+}
+
+static void
+test_nbd_conn_threads_fail(void)
+{
+	/* Only two of the three connection threads can be created */
+	g_max_threads = UT_NUM_CONNS - 1;
+	ut_start(UT_NUM_CONNS);
+	CU_ASSERT(g_start_done);
+	CU_ASSERT(g_start_rc == -ENOMEM);
+	CU_ASSERT(g_start_nbd == NULL);
+	CU_ASSERT(g_num_bdev_channels == 0);
+
+	/* The threads already created exit */
+	ut_wait_stopped();
+	ut_close_kernel_fds();
+	g_max_threads = UT_MAX_THREADS;
+}
+
+static void
+test_nbd_conn_disconnect(void)
+{
+	struct spdk_nbd_disk *nbd;
+
+	/* NBD_CMD_DISC on one connection takes the whole disk down */
+	nbd = ut_start_wait(UT_NUM_CONNS);
+	ut_send_request(2, NBD_CMD_DISC, 0, 0, 0, NULL);
+	ut_wait_stopped();
+	ut_close_kernel_fds();
+	CU_ASSERT(nbd_disk_find_by_nbd_path(UT_NBD_PATH) == NULL);
+
+	/* So does a socket error, with I/O in flight on another connection */
+	nbd = ut_start_wait(UT_NUM_CONNS);
+	CU_ASSERT(nbd != NULL);
+	g_hold_bdev_ios = true;
+	ut_send_request(0, NBD_CMD_READ, 0, 0, UT_BLOCK_SIZE, NULL);
+	ut_poll_idle();
+	CU_ASSERT(!TAILQ_EMPTY(&g_bdev_ios));
+	shutdown(g_kernel_fds[1], SHUT_RDWR);
+	ut_poll_idle();
+	CU_ASSERT(nbd_disk_first() == nbd);
+	g_hold_bdev_ios = false;
+	ut_wait_stopped();
+	CU_ASSERT(ut_recv_reply(0, 0, NULL, 0) == 0);
+	ut_close_kernel_fds();
+}
+
+static void
+test_nbd_hot_remove(void)
+{
+	struct spdk_nbd_disk *nbd;
+	struct ut_bdev_io *io;
+	uint8_t buf[UT_BLOCK_SIZE] = {};
+	uint32_t i, num_ios = 0;
+
+	nbd = ut_start_wait(UT_NUM_CONNS);
+
+	/* Writes in flight on all the connections */
+	g_hold_bdev_ios = true;
+	for (i = 0; i < UT_NUM_CONNS; i++) {
+		ut_send_request(i, NBD_CMD_WRITE, i, i * UT_BLOCK_SIZE, UT_BLOCK_SIZE, buf);
+	}
+	ut_poll_idle();
+	TAILQ_FOREACH(io, &g_bdev_ios, link) {
+		num_ios++;
+	}
+	CU_ASSERT(num_ios == UT_NUM_CONNS);
+
+	/* The connections wait for their I/O before releasing the bdev channels */
+	g_bdev_event_cb(SPDK_BDEV_EVENT_REMOVE, &g_bdev, g_bdev_event_ctx);
+	ut_poll_idle();
+	CU_ASSERT(nbd_disk_first() == nbd);
+	CU_ASSERT(g_num_bdev_channels == UT_NUM_CONNS);
+
+	/* A request received after the removal is failed without reaching the bdev */
+	ut_send_request(0, NBD_CMD_READ, UT_NUM_CONNS, 0, UT_BLOCK_SIZE, NULL);
+	ut_poll_idle();
+	num_ios = 0;
+	TAILQ_FOREACH(io, &g_bdev_ios, link) {
+		num_ios++;
+	}
+	CU_ASSERT(num_ios == UT_NUM_CONNS);
+
+	g_hold_bdev_ios = false;
+	ut_wait_stopped();
+	CU_ASSERT(ut_recv_reply(0, UT_NUM_CONNS, NULL, 0) == EIO);
+	for (i = 0; i < UT_NUM_CONNS; i++) {
+		CU_ASSERT(ut_recv_reply(i, i, NULL, 0) == 0);
+	}
+	ut_close_kernel_fds();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("nbd", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_nbd_multi_conn);
+	CU_ADD_TEST(suite, test_nbd_stop_while_starting);
+	CU_ADD_TEST(suite, test_nbd_conn_threads_fail);
+	CU_ADD_TEST(suite, test_nbd_conn_disconnect);
+	CU_ADD_TEST(suite, test_nbd_hot_remove);
+
+	spdk_thread_lib_init(ut_new_thread, 0);
+	spdk_set_thread(spdk_thread_create("app_thread", NULL));
+	spdk_io_device_register(&g_bdev_io_device, ut_bdev_ch_create_cb, ut_bdev_ch_destroy_cb, 0,
+				"bdev");
+	spdk_nbd_init();
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	spdk_io_device_unregister(&g_bdev_io_device, NULL);
+	spdk_thread_exit(g_threads[0]);
+	while (!spdk_thread_is_exited(g_threads[0])) {
+		spdk_thread_poll(g_threads[0], 0, 0);
+	}
+	spdk_thread_destroy(g_threads[0]);
+	spdk_thread_lib_fini();
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -9,12 +9,44 @@
 #include "unit/lib/json_mock.c"
 #include "notify/notify.c"
 
+static struct spdk_notify_event g_event;
+
 static int
 event_cb(uint64_t idx, const struct spdk_notify_event *event, void *ctx)
 {
 	const struct spdk_notify_event **_event = ctx;
 
-	*_event = event;
+	g_event = *event;
+	*_event = &g_event;
+	return 0;
+}
+
+struct ut_event_ids {
+	uint64_t first;
+	uint64_t last;
+	uint64_t count;
+	bool in_order;
+};
+
+static int
+event_ids_cb(uint64_t idx, const struct spdk_notify_event *event, void *ctx)
+{
+	struct ut_event_ids *ids = ctx;
+	char expected[SPDK_NOTIFY_MAX_CTX_SIZE];
+
+	if (ids->count == 0) {
+		ids->first = idx;
+	} else if (idx != ids->last + 1) {
+		ids->in_order = false;
+	}
+
+	snprintf(expected, sizeof(expected), "%" PRIu64, idx);
+	if (strcmp(event->ctx, expected) != 0) {
+		ids->in_order = false;
+	}
+
+	ids->last = idx;
+	ids->count++;
 	return 0;
 }
 
@@ -62,6 +94,53 @@ notify(void)
 	SPDK_CU_ASSERT_FATAL(event == NULL);
 }
 
+static void
+notify_ring(void)
+{
+	struct ut_event_ids ids = { .in_order = true };
+	char ctx[SPDK_NOTIFY_MAX_CTX_SIZE];
+	uint64_t start, idx, cnt;
+
+	start = spdk_notify_get_event_count();
+	for (idx = start; idx < start + SPDK_NOTIFY_MAX_EVENTS + 100; idx++) {
+		snprintf(ctx, sizeof(ctx), "%" PRIu64, idx);
+		CU_ASSERT(spdk_notify_send("ring", ctx) == idx);
+	}
+	CU_ASSERT(spdk_notify_get_event_count() == idx);
+
+	/* Overwritten events are skipped */
+	cnt = spdk_notify_foreach_event(start, UINT64_MAX, event_ids_cb, &ids);
+	CU_ASSERT(cnt == SPDK_NOTIFY_MAX_EVENTS);
+	CU_ASSERT(ids.count == SPDK_NOTIFY_MAX_EVENTS);
+	CU_ASSERT(ids.first == idx - SPDK_NOTIFY_MAX_EVENTS);
+	CU_ASSERT(ids.last == idx - 1);
+	CU_ASSERT(ids.in_order);
+
+	/* The walk stops at an event still being sent */
+	__atomic_fetch_add(&g_events_head, 1, __ATOMIC_RELAXED);
+	snprintf(ctx, sizeof(ctx), "%" PRIu64, idx + 1);
+	CU_ASSERT(spdk_notify_send("ring", ctx) == idx + 1);
+	memset(&ids, 0, sizeof(ids));
+	ids.in_order = true;
+	cnt = spdk_notify_foreach_event(idx - 1, UINT64_MAX, event_ids_cb, &ids);
+	CU_ASSERT(cnt == 1);
+	CU_ASSERT(ids.last == idx - 1);
+	CU_ASSERT(ids.in_order);
+
+	/* And goes on once it is sent */
+	snprintf(ctx, sizeof(ctx), "%" PRIu64, idx);
+	g_events[idx % SPDK_NOTIFY_MAX_EVENTS].seq = NOTIFY_EVENT_SEQ(idx) - 1;
+	spdk_strcpy_pad(g_events[idx % SPDK_NOTIFY_MAX_EVENTS].event.ctx, ctx,
+			SPDK_NOTIFY_MAX_CTX_SIZE, '\0');
+	g_events[idx % SPDK_NOTIFY_MAX_EVENTS].seq = NOTIFY_EVENT_SEQ(idx);
+	memset(&ids, 0, sizeof(ids));
+	ids.in_order = true;
+	cnt = spdk_notify_foreach_event(idx - 1, UINT64_MAX, event_ids_cb, &ids);
+	CU_ASSERT(cnt == 3);
+	CU_ASSERT(ids.last == idx + 1);
+	CU_ASSERT(ids.in_order);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -72,6 +151,7 @@ main(int argc, char **argv)
 
 	suite = CU_add_suite("app_suite", NULL, NULL);
 	CU_ADD_TEST(suite, notify);
+	CU_ADD_TEST(suite, notify_ring);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -44,6 +44,8 @@ DEFINE_STUB_V(nvme_ns_set_identify_data, (struct spdk_nvme_ns *ns));
 DEFINE_STUB_V(nvme_ns_set_id_desc_list_data, (struct spdk_nvme_ns *ns));
 DEFINE_STUB_V(nvme_ns_free_iocs_specific_data, (struct spdk_nvme_ns *ns));
 DEFINE_STUB_V(nvme_qpair_abort_all_queued_reqs, (struct spdk_nvme_qpair *qpair));
+DEFINE_STUB(nvme_qpair_init_child_requests, int, (struct spdk_nvme_qpair *qpair,
+		uint32_t num_requests), 0);
 DEFINE_STUB(spdk_nvme_poll_group_remove, int, (struct spdk_nvme_poll_group *group,
 		struct spdk_nvme_qpair *qpair), 0);
 DEFINE_STUB_V(nvme_io_msg_ctrlr_update, (struct spdk_nvme_ctrlr *ctrlr));
@@ -491,6 +493,13 @@ static uint32_t *g_active_ns_list = NULL;
 static uint32_t g_active_ns_list_length = 0;
 static struct spdk_nvme_ctrlr_data *g_cdata = NULL;
 static bool g_fail_next_identify = false;
+/* When set, identify namespace commands are completed by ut_complete_identify_ns() */
+static bool g_defer_identify_ns = false;
+static struct {
+	spdk_nvme_cmd_cb	cb_fn;
+	void			*cb_arg;
+} g_identify_ns_reqs[NVME_MAX_IDENTIFY_NS_OUTSTANDING];
+static uint32_t g_num_identify_ns_reqs = 0;
 
 int
 nvme_ctrlr_cmd_identify(struct spdk_nvme_ctrlr *ctrlr, uint8_t cns, uint16_t cntid, uint32_t nsid,
@@ -502,6 +511,14 @@ nvme_ctrlr_cmd_identify(struct spdk_nvme_ctrlr *ctrlr, uint8_t cns, uint16_t cnt
 		return 1;
 	}
 
+	if (g_defer_identify_ns && cns == SPDK_NVME_IDENTIFY_NS) {
+		SPDK_CU_ASSERT_FATAL(g_num_identify_ns_reqs < SPDK_COUNTOF(g_identify_ns_reqs));
+		g_identify_ns_reqs[g_num_identify_ns_reqs].cb_fn = cb_fn;
+		g_identify_ns_reqs[g_num_identify_ns_reqs].cb_arg = cb_arg;
+		g_num_identify_ns_reqs++;
+		return 0;
+	}
+
 	memset(payload, 0, payload_size);
 	if (cns == SPDK_NVME_IDENTIFY_ACTIVE_NS_LIST) {
 		uint32_t count = 0;
@@ -3134,6 +3151,99 @@ test_nvme_ctrlr_identify_namespaces_iocs_specific_next(void)
 	CU_ASSERT(pthread_mutex_destroy(&ctrlr.ctrlr_lock) == 0);
 }
 
+/* Complete the oldest deferred identify namespace command */
+static void
+ut_complete_identify_ns(void)
+{
+	spdk_nvme_cmd_cb cb_fn;
+	void *cb_arg;
+
+	SPDK_CU_ASSERT_FATAL(g_num_identify_ns_reqs > 0);
+	cb_fn = g_identify_ns_reqs[0].cb_fn;
+	cb_arg = g_identify_ns_reqs[0].cb_arg;
+	g_num_identify_ns_reqs--;
+	memmove(&g_identify_ns_reqs[0], &g_identify_ns_reqs[1],
+		g_num_identify_ns_reqs * sizeof(g_identify_ns_reqs[0]));
+
+	fake_cpl_sc(cb_fn, cb_arg);
+}
+
+static void
+test_nvme_ctrlr_identify_namespaces(void)
+{
+	struct spdk_nvme_ctrlr ctrlr = {};
+	struct spdk_nvme_ns ns[20] = {};
+	uint32_t completed;
+	int rc, i;
+
+	RB_INIT(&ctrlr.ns);
+	for (i = 0; i < 20; i++) {
+		ns[i].id = i + 1;
+		ns[i].active = true;
+		RB_INSERT(nvme_ns_tree, &ctrlr.ns, &ns[i]);
+	}
+	ctrlr.cdata.nn = 20;
+	ctrlr.active_ns_count = 20;
+	ctrlr.opts.admin_timeout_ms = NVME_TIMEOUT_INFINITE;
+	ctrlr.opts.admin_queue_size = 32;
+	CU_ASSERT(pthread_mutex_init(&ctrlr.ctrlr_lock, NULL) == 0);
+	g_defer_identify_ns = true;
+
+	/* Up to NVME_MAX_IDENTIFY_NS_OUTSTANDING commands are submitted at once */
+	rc = nvme_ctrlr_identify_namespaces(&ctrlr);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(ctrlr.state == NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_NS);
+	CU_ASSERT(g_num_identify_ns_reqs == NVME_MAX_IDENTIFY_NS_OUTSTANDING);
+	CU_ASSERT(ctrlr.identify_ns_outstanding == NVME_MAX_IDENTIFY_NS_OUTSTANDING);
+	CU_ASSERT(ctrlr.identify_ns_next == NVME_MAX_IDENTIFY_NS_OUTSTANDING + 1);
+
+	/* Each completion refills the window */
+	ut_complete_identify_ns();
+	CU_ASSERT(g_num_identify_ns_reqs == NVME_MAX_IDENTIFY_NS_OUTSTANDING);
+	CU_ASSERT(ctrlr.identify_ns_next == NVME_MAX_IDENTIFY_NS_OUTSTANDING + 2);
+	CU_ASSERT(ns[0].ctrlr == &ctrlr);
+
+	/* The state moves on only after the last namespace has completed */
+	completed = 1;
+	while (g_num_identify_ns_reqs > 0) {
+		CU_ASSERT(ctrlr.state == NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_NS);
+		ut_complete_identify_ns();
+		completed++;
+	}
+	CU_ASSERT(completed == 20);
+	CU_ASSERT(ctrlr.identify_ns_outstanding == 0);
+	CU_ASSERT(ctrlr.state == NVME_CTRLR_STATE_IDENTIFY_ID_DESCS);
+
+	/* A small admin queue limits the window to a quarter of it */
+	ctrlr.opts.admin_queue_size = 8;
+	rc = nvme_ctrlr_identify_namespaces(&ctrlr);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_num_identify_ns_reqs == 2);
+	while (g_num_identify_ns_reqs > 0) {
+		CU_ASSERT(g_num_identify_ns_reqs <= 2);
+		ut_complete_identify_ns();
+	}
+	CU_ASSERT(ctrlr.state == NVME_CTRLR_STATE_IDENTIFY_ID_DESCS);
+
+	/* After a failure no more commands are submitted */
+	ctrlr.opts.admin_queue_size = 32;
+	rc = nvme_ctrlr_identify_namespaces(&ctrlr);
+	CU_ASSERT(rc == 0);
+	set_status_code = SPDK_NVME_SC_INVALID_FIELD;
+	ut_complete_identify_ns();
+	set_status_code = SPDK_NVME_SC_SUCCESS;
+	CU_ASSERT(ctrlr.state == NVME_CTRLR_STATE_ERROR);
+	CU_ASSERT(g_num_identify_ns_reqs == NVME_MAX_IDENTIFY_NS_OUTSTANDING - 1);
+	while (g_num_identify_ns_reqs > 0) {
+		ut_complete_identify_ns();
+	}
+	CU_ASSERT(ctrlr.identify_ns_outstanding == 0);
+	CU_ASSERT(ctrlr.state == NVME_CTRLR_STATE_ERROR);
+
+	g_defer_identify_ns = false;
+	CU_ASSERT(pthread_mutex_destroy(&ctrlr.ctrlr_lock) == 0);
+}
+
 static void
 test_nvme_ctrlr_set_supported_log_pages(void)
 {
@@ -3492,6 +3602,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_ctrlr_aer_callback);
 	CU_ADD_TEST(suite, test_nvme_ctrlr_ns_attr_changed);
 	CU_ADD_TEST(suite, test_nvme_ctrlr_identify_namespaces_iocs_specific_next);
+	CU_ADD_TEST(suite, test_nvme_ctrlr_identify_namespaces);
 	CU_ADD_TEST(suite, test_nvme_ctrlr_set_supported_log_pages);
 	CU_ADD_TEST(suite, test_nvme_ctrlr_set_intel_supported_log_pages);
 	CU_ADD_TEST(suite, test_nvme_ctrlr_parse_ana_log_page);
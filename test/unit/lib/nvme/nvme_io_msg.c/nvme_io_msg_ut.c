@@ -57,6 +57,21 @@ test_nvme_io_msg_process(void)
 	CU_ASSERT(rc == SPDK_NVME_MSG_IO_PROCESS_SIZE);
 	CU_ASSERT(TAILQ_EMPTY(&external_io_msgs.elements));
 
+	/* More requests than a single chunk are all processed, up to the budget of one call */
+	for (i = SPDK_NVME_MSG_IO_PROCESS_SIZE;
+	     i < SPDK_NVME_MSG_IO_PROCESS_SIZE + SPDK_NVME_MSG_IO_PROCESS_MAX + 1; i++) {
+		nvme_io_msg_send(&ctrlr, i, ut_io_msg_fn,
+				 (void *)(0xDEADBEEF + sizeof(int *) * i));
+	}
+
+	rc = nvme_io_msg_process(&ctrlr);
+	CU_ASSERT(rc == SPDK_NVME_MSG_IO_PROCESS_MAX);
+	CU_ASSERT(!TAILQ_EMPTY(&external_io_msgs.elements));
+
+	rc = nvme_io_msg_process(&ctrlr);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(TAILQ_EMPTY(&external_io_msgs.elements));
+
 	/* Unavailable external_io_msgs and external_io_msgs_qpair */
 	ctrlr.external_io_msgs = NULL;
 	ctrlr.external_io_msgs_qpair = NULL;
@@ -94,6 +109,53 @@ test_nvme_io_msg_send(void)
 	free(request);
 }
 
+static void
+test_nvme_io_msg_send_batch(void)
+{
+	struct spdk_nvme_ctrlr ctrlr = {};
+	struct spdk_nvme_io_msg *requests[SPDK_NVME_MSG_IO_SEND_BATCH_MAX] = {};
+	void *args[SPDK_NVME_MSG_IO_SEND_BATCH_MAX + 1];
+	struct spdk_ring external_io_msgs = {};
+	uint32_t nsid = 1, i;
+	size_t count;
+	int rc;
+
+	ctrlr.external_io_msgs = &external_io_msgs;
+	TAILQ_INIT(&external_io_msgs.elements);
+	pthread_mutex_init(&ctrlr.external_io_msgs_lock, NULL);
+	pthread_mutex_init(&ctrlr.external_io_msgs->lock, NULL);
+
+	for (i = 0; i < SPDK_NVME_MSG_IO_SEND_BATCH_MAX + 1; i++) {
+		args[i] = (void *)(0xDEADBEEF + sizeof(int *) * i);
+	}
+
+	/* All messages of a batch are enqueued in order */
+	rc = nvme_io_msg_send_batch(&ctrlr, nsid, ut_io_msg_fn, args, SPDK_NVME_MSG_IO_SEND_BATCH_MAX);
+	CU_ASSERT(rc == 0);
+
+	count = spdk_ring_dequeue(ctrlr.external_io_msgs, (void **)requests,
+				  SPDK_NVME_MSG_IO_SEND_BATCH_MAX);
+	CU_ASSERT(count == SPDK_NVME_MSG_IO_SEND_BATCH_MAX);
+	CU_ASSERT(TAILQ_EMPTY(&external_io_msgs.elements));
+
+	for (i = 0; i < count; i++) {
+		CU_ASSERT(requests[i]->ctrlr == &ctrlr);
+		CU_ASSERT(requests[i]->nsid == nsid);
+		CU_ASSERT(requests[i]->fn == ut_io_msg_fn);
+		CU_ASSERT(requests[i]->arg == args[i]);
+		free(requests[i]);
+	}
+
+	/* Empty and too large batches are rejected */
+	rc = nvme_io_msg_send_batch(&ctrlr, nsid, ut_io_msg_fn, args, 0);
+	CU_ASSERT(rc == -EINVAL);
+
+	rc = nvme_io_msg_send_batch(&ctrlr, nsid, ut_io_msg_fn, args,
+				    SPDK_NVME_MSG_IO_SEND_BATCH_MAX + 1);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&external_io_msgs.elements));
+}
+
 static void
 ut_stop(struct spdk_nvme_ctrlr *ctrlr)
 {
@@ -178,6 +240,7 @@ main(int argc, char **argv)
 
 	suite = CU_add_suite("nvme_io_msg", NULL, NULL);
 	CU_ADD_TEST(suite, test_nvme_io_msg_send);
+	CU_ADD_TEST(suite, test_nvme_io_msg_send_batch);
 	CU_ADD_TEST(suite, test_nvme_io_msg_process);
 	CU_ADD_TEST(suite, test_nvme_io_msg_ctrlr_register_unregister);
 
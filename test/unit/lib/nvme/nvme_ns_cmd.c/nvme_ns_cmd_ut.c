@@ -352,6 +352,83 @@ split_test2(void)
 	cleanup_after_test(&qpair);
 }
 
+static void
+split_test_child_pool(void)
+{
+	struct spdk_nvme_ns	ns;
+	struct spdk_nvme_ctrlr	ctrlr;
+	struct spdk_nvme_qpair	qpair;
+	struct nvme_request	*child, *children[3], *req;
+	struct nvme_request	child_reqs[2];
+	void			*payload;
+	int			i, rc;
+
+	/*
+	 * Controller has max xfer of 128 KB (256 blocks) and the qpair has a child pool
+	 * of 2 requests. Submit an I/O of 384 KB, which is split into three I/Os. The first
+	 * two children come from the child pool, the third one from the regular pool.
+	 */
+	prepare_for_test(&ns, &ctrlr, &qpair, 512, 0, 128 * 1024, 0, false);
+	memset(child_reqs, 0, sizeof(child_reqs));
+	qpair.child_req_buf = child_reqs;
+	qpair.child_req_buf_size = sizeof(child_reqs);
+	for (i = 0; i < 2; i++) {
+		child_reqs[i].qpair = &qpair;
+		STAILQ_INSERT_HEAD(&qpair.free_child_req, &child_reqs[i], stailq);
+	}
+	payload = malloc(384 * 1024);
+
+	rc = spdk_nvme_ns_cmd_read(&ns, &qpair, payload, 0, (384 * 1024) / 512, NULL, NULL, 0);
+
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_request != NULL);
+	CU_ASSERT(g_request->num_children == 3);
+	CU_ASSERT(!nvme_request_is_child_pool(&qpair, g_request));
+	CU_ASSERT(STAILQ_EMPTY(&qpair.free_child_req));
+	CU_ASSERT(qpair.num_outstanding_reqs == 4);
+
+	i = 0;
+	TAILQ_FOREACH(child, &g_request->children, child_tailq) {
+		children[i++] = child;
+	}
+	CU_ASSERT(nvme_request_is_child_pool(&qpair, children[0]));
+	CU_ASSERT(nvme_request_is_child_pool(&qpair, children[1]));
+	CU_ASSERT(!nvme_request_is_child_pool(&qpair, children[2]));
+
+	/* Freed children go back to the pool they came from */
+	for (i = 0; i < 3; i++) {
+		nvme_request_remove_child(g_request, children[i]);
+		nvme_free_request(children[i]);
+	}
+	nvme_free_request(g_request);
+	CU_ASSERT(qpair.num_outstanding_reqs == 0);
+
+	i = 0;
+	STAILQ_FOREACH(req, &qpair.free_child_req, stailq) {
+		CU_ASSERT(nvme_request_is_child_pool(&qpair, req));
+		i++;
+	}
+	CU_ASSERT(i == 2);
+
+	i = 0;
+	STAILQ_FOREACH(req, &qpair.free_req, stailq) {
+		CU_ASSERT(!nvme_request_is_child_pool(&qpair, req));
+		i++;
+	}
+	CU_ASSERT(i == 32);
+
+	/* Allocation failures are counted when the regular pool is exhausted */
+	CU_ASSERT(qpair.num_req_alloc_failures == 0);
+	STAILQ_INIT(&qpair.free_req);
+	ctrlr.opts.io_queue_requests = 32;
+	rc = spdk_nvme_ns_cmd_read(&ns, &qpair, payload, 0, 1, NULL, NULL, 0);
+	CU_ASSERT(rc == -ENOMEM);
+	CU_ASSERT(qpair.num_req_alloc_failures == 1);
+
+	free(payload);
+	cleanup_after_test(&qpair);
+}
+
 static void
 split_test3(void)
 {
@@ -2450,6 +2527,7 @@ main(int argc, char **argv)
 
 	CU_ADD_TEST(suite, split_test);
 	CU_ADD_TEST(suite, split_test2);
+	CU_ADD_TEST(suite, split_test_child_pool);
 	CU_ADD_TEST(suite, split_test3);
 	CU_ADD_TEST(suite, split_test4);
 	CU_ADD_TEST(suite, test_nvme_ns_cmd_flush);
@@ -131,9 +131,13 @@ DEFINE_STUB_V(spdk_nvme_qpair_print_completion, (struct spdk_nvme_qpair *qpair,
 static void
 prp_list_prep(struct nvme_tracker *tr, struct nvme_request *req, uint32_t *prp_index)
 {
+	struct nvme_tracker_prp_sgl *prp_sgl = tr->prp_sgl;
+
 	memset(req, 0, sizeof(*req));
 	memset(tr, 0, sizeof(*tr));
+	memset(prp_sgl, 0, sizeof(*prp_sgl));
 	tr->req = req;
+	tr->prp_sgl = prp_sgl;
 	tr->prp_sgl_bus_addr = 0xDEADBEEF;
 	if (prp_index) {
 		*prp_index = 0;
@@ -144,7 +148,8 @@ static void
 test_prp_list_append(void)
 {
 	struct nvme_request req;
-	struct nvme_tracker tr;
+	struct nvme_tracker_prp_sgl prp_sgl = {};
+	struct nvme_tracker tr = { .prp_sgl = &prp_sgl, };
 	struct spdk_nvme_ctrlr ctrlr = {};
 	uint32_t prp_index;
 
@@ -196,8 +201,8 @@ test_prp_list_append(void)
 	CU_ASSERT(prp_index == 3);
 	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0x100800);
 	CU_ASSERT(req.cmd.dptr.prp.prp2 == tr.prp_sgl_bus_addr);
-	CU_ASSERT(tr.u.prp[0] == 0x101000);
-	CU_ASSERT(tr.u.prp[1] == 0x102000);
+	CU_ASSERT(prp_sgl.u.prp[0] == 0x101000);
+	CU_ASSERT(prp_sgl.u.prp[1] == 0x102000);
 
 	/* 12K buffer, 4K aligned */
 	prp_list_prep(&tr, &req, &prp_index);
@@ -206,8 +211,8 @@ test_prp_list_append(void)
 	CU_ASSERT(prp_index == 3);
 	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0x100000);
 	CU_ASSERT(req.cmd.dptr.prp.prp2 == tr.prp_sgl_bus_addr);
-	CU_ASSERT(tr.u.prp[0] == 0x101000);
-	CU_ASSERT(tr.u.prp[1] == 0x102000);
+	CU_ASSERT(prp_sgl.u.prp[0] == 0x101000);
+	CU_ASSERT(prp_sgl.u.prp[1] == 0x102000);
 
 	/* 12K buffer, non-4K aligned */
 	prp_list_prep(&tr, &req, &prp_index);
@@ -216,9 +221,9 @@ test_prp_list_append(void)
 	CU_ASSERT(prp_index == 4);
 	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0x100800);
 	CU_ASSERT(req.cmd.dptr.prp.prp2 == tr.prp_sgl_bus_addr);
-	CU_ASSERT(tr.u.prp[0] == 0x101000);
-	CU_ASSERT(tr.u.prp[1] == 0x102000);
-	CU_ASSERT(tr.u.prp[2] == 0x103000);
+	CU_ASSERT(prp_sgl.u.prp[0] == 0x101000);
+	CU_ASSERT(prp_sgl.u.prp[1] == 0x102000);
+	CU_ASSERT(prp_sgl.u.prp[2] == 0x103000);
 
 	/* Two 4K buffers, both 4K aligned */
 	prp_list_prep(&tr, &req, &prp_index);
@@ -241,8 +246,8 @@ test_prp_list_append(void)
 	CU_ASSERT(prp_index == 3);
 	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0x100800);
 	CU_ASSERT(req.cmd.dptr.prp.prp2 == tr.prp_sgl_bus_addr);
-	CU_ASSERT(tr.u.prp[0] == 0x101000);
-	CU_ASSERT(tr.u.prp[1] == 0x900000);
+	CU_ASSERT(prp_sgl.u.prp[0] == 0x101000);
+	CU_ASSERT(prp_sgl.u.prp[1] == 0x900000);
 
 	/* Two 4K buffers, both non-4K aligned (invalid) */
 	prp_list_prep(&tr, &req, &prp_index);
@@ -420,7 +425,8 @@ test_build_contig_hw_sgl_request(void)
 {
 	struct spdk_nvme_qpair qpair = {};
 	struct nvme_request req = {};
-	struct nvme_tracker tr = {};
+	struct nvme_tracker_prp_sgl prp_sgl = {};
+	struct nvme_tracker tr = { .prp_sgl = &prp_sgl, };
 	struct spdk_nvme_ctrlr ctrlr = {};
 	int rc;
 
@@ -443,6 +449,7 @@ test_build_contig_hw_sgl_request(void)
 	memset(&qpair, 0, sizeof(qpair));
 	memset(&req, 0, sizeof(req));
 	memset(&tr, 0, sizeof(tr));
+	tr.prp_sgl = &prp_sgl;
 
 	/* Test 2: Payload covered by a single mapping, but request is at an offset */
 	qpair.ctrlr = &ctrlr;
@@ -463,6 +470,7 @@ test_build_contig_hw_sgl_request(void)
 	memset(&qpair, 0, sizeof(qpair));
 	memset(&req, 0, sizeof(req));
 	memset(&tr, 0, sizeof(tr));
+	tr.prp_sgl = &prp_sgl;
 
 	/* Test 3: Payload spans two mappings */
 	qpair.ctrlr = &ctrlr;
@@ -477,18 +485,19 @@ test_build_contig_hw_sgl_request(void)
 	CU_ASSERT(req.cmd.dptr.sgl1.unkeyed.type == SPDK_NVME_SGL_TYPE_LAST_SEGMENT);
 	CU_ASSERT(req.cmd.dptr.sgl1.address == tr.prp_sgl_bus_addr);
 	CU_ASSERT(req.cmd.dptr.sgl1.unkeyed.length == 2 * sizeof(struct spdk_nvme_sgl_descriptor));
-	CU_ASSERT(tr.u.sgl[0].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
-	CU_ASSERT(tr.u.sgl[0].unkeyed.length == 60);
-	CU_ASSERT(tr.u.sgl[0].address == 0xDEADBEEF);
-	CU_ASSERT(tr.u.sgl[1].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
-	CU_ASSERT(tr.u.sgl[1].unkeyed.length == 40);
-	CU_ASSERT(tr.u.sgl[1].address == 0xDEADBEEF);
+	CU_ASSERT(prp_sgl.u.sgl[0].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	CU_ASSERT(prp_sgl.u.sgl[0].unkeyed.length == 60);
+	CU_ASSERT(prp_sgl.u.sgl[0].address == 0xDEADBEEF);
+	CU_ASSERT(prp_sgl.u.sgl[1].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	CU_ASSERT(prp_sgl.u.sgl[1].unkeyed.length == 40);
+	CU_ASSERT(prp_sgl.u.sgl[1].address == 0xDEADBEEF);
 
 	MOCK_CLEAR(spdk_vtophys);
 	g_vtophys_size = 0;
 	memset(&qpair, 0, sizeof(qpair));
 	memset(&req, 0, sizeof(req));
 	memset(&tr, 0, sizeof(tr));
+	tr.prp_sgl = &prp_sgl;
 }
 
 static void
@@ -496,7 +505,8 @@ test_nvme_pcie_qpair_build_metadata(void)
 {
 	struct nvme_pcie_qpair pqpair = {};
 	struct spdk_nvme_qpair *qpair = &pqpair.qpair;
-	struct nvme_tracker tr = {};
+	struct nvme_tracker_prp_sgl prp_sgl = {};
+	struct nvme_tracker tr = { .prp_sgl = &prp_sgl, };
 	struct nvme_request req = {};
 	struct spdk_nvme_ctrlr	ctrlr = {};
 	int rc;
@@ -520,10 +530,10 @@ test_nvme_pcie_qpair_build_metadata(void)
 	rc = nvme_pcie_qpair_build_metadata(qpair, &tr, true, true, true);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(req.cmd.psdt == SPDK_NVME_PSDT_SGL_MPTR_SGL);
-	CU_ASSERT(tr.meta_sgl.address == 0xDCADBEE0);
-	CU_ASSERT(tr.meta_sgl.unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
-	CU_ASSERT(tr.meta_sgl.unkeyed.length == 4096);
-	CU_ASSERT(tr.meta_sgl.unkeyed.subtype == 0);
+	CU_ASSERT(prp_sgl.meta_sgl.address == 0xDCADBEE0);
+	CU_ASSERT(prp_sgl.meta_sgl.unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	CU_ASSERT(prp_sgl.meta_sgl.unkeyed.length == 4096);
+	CU_ASSERT(prp_sgl.meta_sgl.unkeyed.subtype == 0);
 	CU_ASSERT(req.cmd.mptr == (0xDBADBEEF - sizeof(struct spdk_nvme_sgl_descriptor)));
 
 	/* Non-IOVA contiguous metadata buffers should fail. */
@@ -543,15 +553,15 @@ test_nvme_pcie_qpair_build_metadata(void)
 	CU_ASSERT(req.cmd.mptr == 0xDDADBEE0);
 
 	/* Build non sgl metadata while sgls are supported */
-	memset(&tr.meta_sgl, 0, sizeof(tr.meta_sgl));
+	memset(&prp_sgl.meta_sgl, 0, sizeof(prp_sgl.meta_sgl));
 	/* If SGLs are supported, but not in metadata, the cmd.psdt
 	 * shall not be changed to SPDK_NVME_PSDT_SGL_MPTR_SGL
 	 */
 	req.cmd.psdt = SPDK_NVME_PSDT_SGL_MPTR_CONTIG;
 	rc = nvme_pcie_qpair_build_metadata(qpair, &tr, true, false, true);
 	CU_ASSERT(rc == 0);
-	CU_ASSERT(tr.meta_sgl.address == 0);
-	CU_ASSERT(tr.meta_sgl.unkeyed.length == 0);
+	CU_ASSERT(prp_sgl.meta_sgl.address == 0);
+	CU_ASSERT(prp_sgl.meta_sgl.unkeyed.length == 0);
 	CU_ASSERT(req.cmd.psdt == SPDK_NVME_PSDT_SGL_MPTR_CONTIG);
 	CU_ASSERT(req.cmd.mptr == 0xDDADBEE0);
 
@@ -607,7 +617,8 @@ test_nvme_pcie_qpair_build_prps_sgl_request(void)
 {
 	struct spdk_nvme_qpair qpair = {};
 	struct nvme_request req = {};
-	struct nvme_tracker tr = {};
+	struct nvme_tracker_prp_sgl prp_sgl = {};
+	struct nvme_tracker tr = { .prp_sgl = &prp_sgl, };
 	struct spdk_nvme_ctrlr ctrlr = {};
 	struct nvme_pcie_ut_bdev_io bio = {};
 	int rc;
@@ -631,7 +642,8 @@ test_nvme_pcie_qpair_build_hw_sgl_request(void)
 	struct nvme_pcie_qpair pqpair = {};
 	struct spdk_nvme_qpair *qpair = &pqpair.qpair;
 	struct nvme_request req = {};
-	struct nvme_tracker tr = {};
+	struct nvme_tracker_prp_sgl prp_sgl = {};
+	struct nvme_tracker tr = { .prp_sgl = &prp_sgl, };
 	struct nvme_pcie_ut_bdev_io bio = {};
 	struct spdk_nvme_ctrlr ctrlr = {};
 	int rc;
@@ -655,17 +667,17 @@ test_nvme_pcie_qpair_build_hw_sgl_request(void)
 
 	rc = nvme_pcie_qpair_build_hw_sgl_request(qpair, &req, &tr, true);
 	CU_ASSERT(rc == 0);
-	CU_ASSERT(tr.u.sgl[0].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
-	CU_ASSERT(tr.u.sgl[0].unkeyed.length == 2048);
-	CU_ASSERT(tr.u.sgl[0].address == 0xDBADBEE0);
-	CU_ASSERT(tr.u.sgl[0].unkeyed.subtype == 0);
-	CU_ASSERT(tr.u.sgl[1].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
-	CU_ASSERT(tr.u.sgl[1].unkeyed.length == 4096);
-	CU_ASSERT(tr.u.sgl[1].address == 0xDCADBEE0);
-	CU_ASSERT(tr.u.sgl[2].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
-	CU_ASSERT(tr.u.sgl[2].unkeyed.length == 2048);
-	CU_ASSERT(tr.u.sgl[2].unkeyed.length == 2048);
-	CU_ASSERT(tr.u.sgl[2].address == 0xDDADBEE0);
+	CU_ASSERT(prp_sgl.u.sgl[0].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	CU_ASSERT(prp_sgl.u.sgl[0].unkeyed.length == 2048);
+	CU_ASSERT(prp_sgl.u.sgl[0].address == 0xDBADBEE0);
+	CU_ASSERT(prp_sgl.u.sgl[0].unkeyed.subtype == 0);
+	CU_ASSERT(prp_sgl.u.sgl[1].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	CU_ASSERT(prp_sgl.u.sgl[1].unkeyed.length == 4096);
+	CU_ASSERT(prp_sgl.u.sgl[1].address == 0xDCADBEE0);
+	CU_ASSERT(prp_sgl.u.sgl[2].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	CU_ASSERT(prp_sgl.u.sgl[2].unkeyed.length == 2048);
+	CU_ASSERT(prp_sgl.u.sgl[2].unkeyed.length == 2048);
+	CU_ASSERT(prp_sgl.u.sgl[2].address == 0xDDADBEE0);
 	CU_ASSERT(req.cmd.psdt == SPDK_NVME_PSDT_SGL_MPTR_CONTIG);
 	CU_ASSERT(req.cmd.dptr.sgl1.unkeyed.subtype == 0);
 	CU_ASSERT(req.cmd.dptr.sgl1.unkeyed.type == SPDK_NVME_SGL_TYPE_LAST_SEGMENT);
@@ -674,6 +686,7 @@ test_nvme_pcie_qpair_build_hw_sgl_request(void)
 
 	/* Single vector */
 	memset(&tr, 0, sizeof(tr));
+	tr.prp_sgl = &prp_sgl;
 	memset(&bio, 0, sizeof(bio));
 	memset(&req, 0, sizeof(req));
 	req.payload = NVME_PAYLOAD_SGL(nvme_pcie_ut_reset_sgl, nvme_pcie_ut_next_sge, &bio, NULL);
@@ -685,10 +698,10 @@ test_nvme_pcie_qpair_build_hw_sgl_request(void)
 
 	rc = nvme_pcie_qpair_build_hw_sgl_request(qpair, &req, &tr, true);
 	CU_ASSERT(rc == 0);
-	CU_ASSERT(tr.u.sgl[0].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
-	CU_ASSERT(tr.u.sgl[0].unkeyed.length == 4096);
-	CU_ASSERT(tr.u.sgl[0].address == 0xDBADBEE0);
-	CU_ASSERT(tr.u.sgl[0].unkeyed.subtype == 0);
+	CU_ASSERT(prp_sgl.u.sgl[0].unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	CU_ASSERT(prp_sgl.u.sgl[0].unkeyed.length == 4096);
+	CU_ASSERT(prp_sgl.u.sgl[0].address == 0xDBADBEE0);
+	CU_ASSERT(prp_sgl.u.sgl[0].unkeyed.subtype == 0);
 	CU_ASSERT(req.cmd.psdt == SPDK_NVME_PSDT_SGL_MPTR_CONTIG);
 	CU_ASSERT(req.cmd.dptr.sgl1.unkeyed.subtype == 0);
 	CU_ASSERT(req.cmd.dptr.sgl1.unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
@@ -701,7 +714,8 @@ test_nvme_pcie_qpair_build_contig_request(void)
 {
 	struct nvme_pcie_qpair pqpair = {};
 	struct nvme_request req = {};
-	struct nvme_tracker tr = {};
+	struct nvme_tracker_prp_sgl prp_sgl = {};
+	struct nvme_tracker tr = { .prp_sgl = &prp_sgl, };
 	struct spdk_nvme_ctrlr ctrlr = {};
 	int rc;
 
@@ -737,8 +751,8 @@ test_nvme_pcie_qpair_build_contig_request(void)
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0x100000);
 	CU_ASSERT(req.cmd.dptr.prp.prp2 == tr.prp_sgl_bus_addr);
-	CU_ASSERT(tr.u.prp[0] == 0x101000);
-	CU_ASSERT(tr.u.prp[1] == 0x102000);
+	CU_ASSERT(prp_sgl.u.prp[0] == 0x101000);
+	CU_ASSERT(prp_sgl.u.prp[1] == 0x102000);
 
 	/* address not dword aligned */
 	prp_list_prep(&tr, &req, NULL);
@@ -578,6 +578,49 @@ test_nvme_pcie_poll_group_get_stats(void)
 	CU_ASSERT(rc == 0);
 }
 
+static void
+test_nvme_pcie_qpair_submit_batch(void)
+{
+	struct nvme_pcie_ctrlr pctrlr = {};
+	struct nvme_pcie_qpair pqpair = {};
+	struct spdk_nvme_pcie_stat stat = {};
+	struct spdk_nvme_cmd cmd[8] = {};
+	struct nvme_request req = {};
+	struct nvme_tracker tr = { .req = &req, };
+	volatile uint32_t sq_tdbl = 0;
+
+	pqpair.qpair.ctrlr = &pctrlr.ctrlr;
+	pqpair.qpair.id = 1;
+	pqpair.qpair.trtype = SPDK_NVME_TRANSPORT_PCIE;
+	pqpair.cmd = cmd;
+	pqpair.num_entries = SPDK_COUNTOF(cmd);
+	pqpair.sq_tdbl = &sq_tdbl;
+	pqpair.stat = &stat;
+
+	/* Without a batch, the doorbell is rung for each command. */
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(sq_tdbl == 1);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 1);
+
+	/* Within a batch, the doorbell is rung once when the batch ends. */
+	pqpair.qpair.in_submit_batch = 1;
+
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(sq_tdbl == 1);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 1);
+
+	pqpair.qpair.in_submit_batch = 0;
+	nvme_pcie_qpair_submit_batch_end(&pqpair.qpair);
+	CU_ASSERT(sq_tdbl == 4);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 2);
+
+	/* An empty batch does not ring the doorbell. */
+	nvme_pcie_qpair_submit_batch_end(&pqpair.qpair);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 2);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -593,6 +636,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_pcie_ctrlr_connect_qpair);
 	CU_ADD_TEST(suite, test_nvme_pcie_ctrlr_construct_admin_qpair);
 	CU_ADD_TEST(suite, test_nvme_pcie_poll_group_get_stats);
+	CU_ADD_TEST(suite, test_nvme_pcie_qpair_submit_batch);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -579,6 +579,68 @@ test_spdk_nvme_poll_group_get_free_stats(void)
 	CU_ASSERT(rc == -ENOTSUP);
 }
 
+static int64_t g_adaptive_poll_completions;
+static uint32_t g_adaptive_poll_count;
+
+static void
+ut_adaptive_poll_interrupt_cb(struct spdk_nvme_poll_group *group, void *ctx)
+{
+	g_adaptive_poll_count++;
+	group->adaptive.num_completions += g_adaptive_poll_completions;
+}
+
+static void
+test_spdk_nvme_poll_group_adaptive_polling(void)
+{
+	struct spdk_nvme_poll_group *group;
+	int rc;
+
+	group = spdk_nvme_poll_group_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+
+	/* The interrupt callback is required to poll the poll group. */
+	rc = spdk_nvme_poll_group_set_adaptive_polling(group, 2);
+	CU_ASSERT(rc == -EINVAL);
+
+	rc = spdk_nvme_poll_group_set_interrupt_callback(group, ut_adaptive_poll_interrupt_cb, NULL);
+	CU_ASSERT(rc == 0);
+
+	/* The fd is not added until interrupts are known to be enabled. */
+	rc = spdk_nvme_poll_group_set_adaptive_polling(group, 2);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(group->adaptive.fd == -1);
+
+	rc = nvme_poll_group_add_adaptive_poll_fd(group);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(group->adaptive.fd >= 0);
+
+	/* A completion processed by an interrupt starts polling. */
+	nvme_poll_group_start_adaptive_polling(group);
+	CU_ASSERT(group->adaptive.polling == true);
+
+	/* Polling continues while completions are found. */
+	g_adaptive_poll_completions = 1;
+	nvme_poll_group_adaptive_poll(group);
+	nvme_poll_group_adaptive_poll(group);
+	CU_ASSERT(g_adaptive_poll_count == 2);
+	CU_ASSERT(group->adaptive.polling == true);
+
+	/* Polling stops after idle_polls polls without completions. */
+	g_adaptive_poll_completions = 0;
+	nvme_poll_group_adaptive_poll(group);
+	CU_ASSERT(group->adaptive.polling == true);
+	nvme_poll_group_adaptive_poll(group);
+	CU_ASSERT(group->adaptive.polling == false);
+
+	/* Polling is not started once disabled. */
+	rc = spdk_nvme_poll_group_set_adaptive_polling(group, 0);
+	CU_ASSERT(rc == 0);
+	nvme_poll_group_start_adaptive_polling(group);
+	CU_ASSERT(group->adaptive.polling == false);
+
+	SPDK_CU_ASSERT_FATAL(spdk_nvme_poll_group_destroy(group) == 0);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -603,7 +665,9 @@ main(int argc, char **argv)
 			    test_spdk_nvme_poll_group_process_completions) == NULL ||
 		CU_add_test(suite, "nvme_poll_group_destroy_test", test_spdk_nvme_poll_group_destroy) == NULL ||
 		CU_add_test(suite, "nvme_poll_group_get_free_stats",
-			    test_spdk_nvme_poll_group_get_free_stats) == NULL
+			    test_spdk_nvme_poll_group_get_free_stats) == NULL ||
+		CU_add_test(suite, "nvme_poll_group_adaptive_polling",
+			    test_spdk_nvme_poll_group_adaptive_polling) == NULL
 	) {
 		CU_cleanup_registry();
 		return CU_get_error();
@@ -26,6 +26,7 @@ struct nvme_driver _g_nvme_driver = {
 DEFINE_STUB_V(nvme_transport_qpair_abort_reqs, (struct spdk_nvme_qpair *qpair));
 DEFINE_STUB(nvme_transport_qpair_submit_request, int,
 	    (struct spdk_nvme_qpair *qpair, struct nvme_request *req), 0);
+DEFINE_STUB_V(nvme_transport_qpair_submit_batch_end, (struct spdk_nvme_qpair *qpair));
 DEFINE_STUB(spdk_nvme_ctrlr_free_io_qpair, int, (struct spdk_nvme_qpair *qpair), 0);
 DEFINE_STUB_V(nvme_transport_ctrlr_disconnect_qpair, (struct spdk_nvme_ctrlr *ctrlr,
 		struct spdk_nvme_qpair *qpair));
@@ -746,6 +747,35 @@ test_nvme_get_sgl_print_info(void)
 			   NVME_CMD_DPTR_STR_SIZE));
 }
 
+static void
+test_nvme_qpair_submit_batch(void)
+{
+	struct spdk_nvme_qpair qpair = {};
+	int rc;
+
+	/* The admin queue does not support batching. */
+	qpair.id = 0;
+	rc = spdk_nvme_qpair_submit_batch_begin(&qpair);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(qpair.in_submit_batch == 0);
+
+	qpair.id = 1;
+	rc = spdk_nvme_qpair_submit_batch_end(&qpair);
+	CU_ASSERT(rc == -EINVAL);
+
+	rc = spdk_nvme_qpair_submit_batch_begin(&qpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(qpair.in_submit_batch == 1);
+
+	/* Batches do not nest. */
+	rc = spdk_nvme_qpair_submit_batch_begin(&qpair);
+	CU_ASSERT(rc == -EBUSY);
+
+	rc = spdk_nvme_qpair_submit_batch_end(&qpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(qpair.in_submit_batch == 0);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -770,6 +800,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_qpair_manual_complete_request);
 	CU_ADD_TEST(suite, test_nvme_qpair_init_deinit);
 	CU_ADD_TEST(suite, test_nvme_get_sgl_print_info);
+	CU_ADD_TEST(suite, test_nvme_qpair_submit_batch);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
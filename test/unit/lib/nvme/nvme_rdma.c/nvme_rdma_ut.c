@@ -812,6 +812,9 @@ test_nvme_rdma_req_init(void)
 	struct spdk_nvme_rdma_req rdma_req = {};
 	struct nvme_request req = {};
 	struct nvme_rdma_ut_bdev_io bio = { .iovcnt = NVME_RDMA_MAX_SGL_DESCRIPTORS };
+	struct spdk_nvmf_cmd cmds[2] = {};
+	uint8_t inline_bufs[1024];
+	uint8_t data[1024];
 	int rc = 1;
 
 	ctrlr.max_sges = NVME_RDMA_MAX_SGL_DESCRIPTORS;
@@ -914,6 +917,56 @@ test_nvme_rdma_req_init(void)
 	CU_ASSERT(req.cmd.dptr.sgl1.keyed.key == RDMA_UT_RKEY);
 	CU_ASSERT(req.cmd.dptr.sgl1.address == (uint64_t)bio.iovs[0].iov_base);
 	CU_ASSERT(rdma_req.send_sgl[0].length == sizeof(struct spdk_nvme_cmd));
+
+	/* case 4: payload fits the inline copy buffer, expect: pass. */
+	memset(data, 0xa5, sizeof(data));
+	memset(inline_bufs, 0, sizeof(inline_bufs));
+	rqpair.inline_bufs = inline_bufs;
+	rqpair.inline_copy_size = 512;
+	rdma_req.id = 1;
+	rdma_req.inline_buf_lkey = 0x5a5a;
+	rqpair.cmds = cmds;
+	rqpair.qpair.ctrlr->icdoff = 0;
+
+	/* Contig payload */
+	req.payload = NVME_PAYLOAD_CONTIG(data, NULL);
+	req.payload_offset = 0;
+	req.payload_size = 512;
+	rc = nvme_rdma_req_init(&rqpair, &rdma_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(req.cmd.dptr.sgl1.unkeyed.type == SPDK_NVME_SGL_TYPE_DATA_BLOCK);
+	CU_ASSERT(req.cmd.dptr.sgl1.unkeyed.subtype == SPDK_NVME_SGL_SUBTYPE_OFFSET);
+	CU_ASSERT(req.cmd.dptr.sgl1.unkeyed.length == 512);
+	CU_ASSERT(req.cmd.dptr.sgl1.address == 0);
+	CU_ASSERT(rdma_req.send_wr.num_sge == 2);
+	CU_ASSERT(rdma_req.send_sgl[1].addr == (uint64_t)&inline_bufs[512]);
+	CU_ASSERT(rdma_req.send_sgl[1].length == 512);
+	CU_ASSERT(rdma_req.send_sgl[1].lkey == 0x5a5a);
+	CU_ASSERT(memcmp(&inline_bufs[512], data, 512) == 0);
+
+	/* SGL payload spread over two elements */
+	memset(inline_bufs, 0, sizeof(inline_bufs));
+	req.payload = NVME_PAYLOAD_SGL(nvme_rdma_ut_reset_sgl, nvme_rdma_ut_next_sge, &bio, NULL);
+	bio.iovpos = 0;
+	bio.iovcnt = 2;
+	bio.iovs[0].iov_base = data;
+	bio.iovs[0].iov_len = 256;
+	bio.iovs[1].iov_base = &data[256];
+	bio.iovs[1].iov_len = 256;
+	rc = nvme_rdma_req_init(&rqpair, &rdma_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(bio.iovpos == 2);
+	CU_ASSERT(rdma_req.send_sgl[1].addr == (uint64_t)&inline_bufs[512]);
+	CU_ASSERT(rdma_req.send_sgl[1].length == 512);
+	CU_ASSERT(memcmp(&inline_bufs[512], data, 512) == 0);
+
+	/* Payload larger than the inline copy buffer is not copied */
+	req.payload = NVME_PAYLOAD_CONTIG(data, NULL);
+	req.payload_size = 1024;
+	rc = nvme_rdma_req_init(&rqpair, &rdma_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(rdma_req.send_sgl[1].addr == (uint64_t)data);
+	CU_ASSERT(rdma_req.send_sgl[1].lkey == RDMA_UT_LKEY);
 }
 
 static void
@@ -1360,6 +1413,65 @@ test_nvme_rdma_qpair_set_poller(void)
 	CU_ASSERT(rc == 0);
 }
 
+static void
+test_nvme_rdma_poll_group_check_qpairs(void)
+{
+	struct nvme_rdma_poll_group group = {};
+	struct spdk_nvme_transport_poll_group *tgroup = &group.group;
+	struct nvme_rdma_qpair rqpair = {};
+	int64_t rc;
+
+	STAILQ_INIT(&group.pollers);
+	TAILQ_INIT(&group.connecting_qpairs);
+	TAILQ_INIT(&group.active_qpairs);
+	STAILQ_INIT(&tgroup->connected_qpairs);
+	STAILQ_INIT(&tgroup->disconnected_qpairs);
+
+	rqpair.qpair.trtype = SPDK_NVME_TRANSPORT_RDMA;
+	rqpair.qpair.poll_group = tgroup;
+	rqpair.qpair.state = NVME_QPAIR_CONNECTED;
+	STAILQ_INSERT_TAIL(&tgroup->connected_qpairs, &rqpair.qpair, poll_group_stailq);
+	tgroup->num_connected_qpairs = 1;
+
+	/* The first poll walks the connected qpairs */
+	MOCK_SET(spdk_get_ticks, 1000);
+	rc = nvme_rdma_poll_group_process_completions(tgroup, 0, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(group.next_check_qpairs_tsc == 1000 + NVME_RDMA_POLL_GROUP_CHECK_QPAIRS_US);
+
+	/* A failure set outside of the transport is only found by the next periodic walk */
+	rqpair.qpair.transport_failure_reason = SPDK_NVME_QPAIR_FAILURE_LOCAL;
+	MOCK_SET(spdk_get_ticks, 1000 + NVME_RDMA_POLL_GROUP_CHECK_QPAIRS_US - 1);
+	rc = nvme_rdma_poll_group_process_completions(tgroup, 0, NULL);
+	CU_ASSERT(rc == 0);
+
+	MOCK_SET(spdk_get_ticks, 1000 + NVME_RDMA_POLL_GROUP_CHECK_QPAIRS_US);
+	rc = nvme_rdma_poll_group_process_completions(tgroup, 0, NULL);
+	CU_ASSERT(rc == -ENXIO);
+	CU_ASSERT(group.next_check_qpairs_tsc == 1000 + 2 * NVME_RDMA_POLL_GROUP_CHECK_QPAIRS_US);
+
+	rc = nvme_rdma_poll_group_process_completions(tgroup, 0, NULL);
+	CU_ASSERT(rc == 0);
+
+	/* A qpair connecting to the group or receiving a CM event makes the next poll walk them */
+	nvme_rdma_poll_group_connect_qpair(&rqpair.qpair);
+	CU_ASSERT(group.check_qpairs == true);
+	rc = nvme_rdma_poll_group_process_completions(tgroup, 0, NULL);
+	CU_ASSERT(rc == -ENXIO);
+	CU_ASSERT(group.check_qpairs == false);
+
+	nvme_rdma_poll_group_check_qpairs(&rqpair);
+	rc = nvme_rdma_poll_group_process_completions(tgroup, 0, NULL);
+	CU_ASSERT(rc == -ENXIO);
+
+	/* Qpairs outside of a poll group are ignored */
+	rqpair.qpair.poll_group = NULL;
+	nvme_rdma_poll_group_check_qpairs(&rqpair);
+	CU_ASSERT(group.check_qpairs == false);
+
+	MOCK_CLEAR(spdk_get_ticks);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1390,6 +1502,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_rdma_ctrlr_get_max_sges);
 	CU_ADD_TEST(suite, test_nvme_rdma_poll_group_get_stats);
 	CU_ADD_TEST(suite, test_nvme_rdma_qpair_set_poller);
+	CU_ADD_TEST(suite, test_nvme_rdma_poll_group_check_qpairs);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -22,6 +22,8 @@ static void nvme_transport_ctrlr_disconnect_qpair_done_mocked(struct spdk_nvme_q
 
 SPDK_LOG_REGISTER_COMPONENT(nvme)
 
+struct spdk_nvme_transport_opts g_spdk_nvme_transport_opts = {};
+
 DEFINE_STUB(nvme_qpair_submit_request,
 	    int, (struct spdk_nvme_qpair *qpair, struct nvme_request *req), 0);
 
@@ -1040,6 +1042,12 @@ spdk_sock_connect_ext(const char *ip, int port,
 	CU_ASSERT(opts->priority == 1);
 	CU_ASSERT(opts->zcopy == true);
 	CU_ASSERT(!strcmp(ip, "192.168.1.78"));
+	if (g_spdk_nvme_transport_opts.tcp_zcopy_threshold != 0) {
+		CU_ASSERT(_impl_name != NULL && !strcmp(_impl_name, "posix"));
+		SPDK_CU_ASSERT_FATAL(opts->impl_opts != NULL);
+		CU_ASSERT(opts->impl_opts->enable_zerocopy_send_client == true);
+		CU_ASSERT(opts->impl_opts->zerocopy_threshold == g_spdk_nvme_transport_opts.tcp_zcopy_threshold);
+	}
 	return (struct spdk_sock *)0xDDADBEEF;
 }
 
@@ -1064,6 +1072,16 @@ test_nvme_tcp_qpair_connect_sock(void)
 	rc = nvme_tcp_qpair_connect_sock(ctrlr, &tqpair.qpair);
 	CU_ASSERT(rc == 0);
 
+	/* Zero-copy send is enabled with the threshold from the transport options */
+	MOCK_SET(spdk_sock_get_default_impl, "posix");
+	g_spdk_nvme_transport_opts.tcp_zcopy_threshold = 16384;
+
+	rc = nvme_tcp_qpair_connect_sock(ctrlr, &tqpair.qpair);
+	CU_ASSERT(rc == 0);
+
+	g_spdk_nvme_transport_opts.tcp_zcopy_threshold = 0;
+	MOCK_CLEAR(spdk_sock_get_default_impl);
+
 	/* Unsupported family of the transport address */
 	ctrlr->trid.adrfam = SPDK_NVMF_ADRFAM_IB;
 
@@ -1739,6 +1757,73 @@ test_nvme_tcp_poll_group_get_stats(void)
 	MOCK_CLEAR(spdk_sock_group_create);
 }
 
+static void
+test_nvme_tcp_qpair_recv_next(void)
+{
+	struct nvme_tcp_poll_group group = {};
+	struct nvme_tcp_qpair tqpair = {};
+	struct spdk_sock sock = {};
+	uint8_t hdr[8], data[0x1000];
+	struct nvme_tcp_pdu pdu = {};
+	int rc, i;
+
+	for (i = 0; i < (int)sizeof(g_buf); i++) {
+		g_buf[i] = i;
+	}
+
+	group.recv_buf_size = sizeof(g_buf);
+	tqpair.qpair.poll_group = &group.group;
+	tqpair.sock = &sock;
+	tqpair.flags.recv_next = 1;
+
+	/* Header is copied from the start of a new buffer and the rest of it is kept */
+	rc = nvme_tcp_qpair_read_data(&tqpair, sizeof(hdr), hdr);
+	CU_ASSERT(rc == sizeof(hdr));
+	CU_ASSERT(memcmp(hdr, g_buf, sizeof(hdr)) == 0);
+	CU_ASSERT(tqpair.recv_buf.buf == g_buf + sizeof(hdr));
+	CU_ASSERT(tqpair.recv_buf.len == sizeof(g_buf) - sizeof(hdr));
+
+	/* Payload spans the rest of the current buffer and the start of the next one */
+	pdu.data_iovcnt = 1;
+	pdu.data_iov[0].iov_base = data;
+	pdu.data_iov[0].iov_len = sizeof(data);
+	pdu.data_len = sizeof(data);
+	rc = nvme_tcp_qpair_read_payload_data(&tqpair, &pdu);
+	CU_ASSERT(rc == sizeof(data));
+	CU_ASSERT(memcmp(data, g_buf + sizeof(hdr), sizeof(g_buf) - sizeof(hdr)) == 0);
+	CU_ASSERT(memcmp(data + sizeof(g_buf) - sizeof(hdr), g_buf, sizeof(hdr)) == 0);
+	CU_ASSERT(tqpair.recv_buf.len == sizeof(g_buf) - sizeof(hdr));
+
+	/* Data which has already been received is returned before an error */
+	MOCK_SET(spdk_sock_recv_next, -1);
+	errno = EAGAIN;
+	rc = nvme_tcp_qpair_read_data(&tqpair, sizeof(data), data);
+	CU_ASSERT(rc == sizeof(g_buf) - sizeof(hdr));
+	CU_ASSERT(tqpair.recv_buf.len == 0);
+
+	/* No data available */
+	errno = EAGAIN;
+	rc = nvme_tcp_qpair_read_data(&tqpair, sizeof(hdr), hdr);
+	CU_ASSERT(rc == 0);
+
+	/* No buffers left, read from the socket directly */
+	errno = ENOBUFS;
+	rc = nvme_tcp_qpair_read_data(&tqpair, sizeof(hdr), hdr);
+	CU_ASSERT(rc == 1);
+
+	/* Connection failure */
+	errno = ECONNRESET;
+	rc = nvme_tcp_qpair_read_data(&tqpair, sizeof(hdr), hdr);
+	CU_ASSERT(rc == NVME_TCP_CONNECTION_FATAL);
+
+	/* Connection closed */
+	MOCK_SET(spdk_sock_recv_next, 0);
+	rc = nvme_tcp_qpair_read_data(&tqpair, sizeof(hdr), hdr);
+	CU_ASSERT(rc == NVME_TCP_CONNECTION_FATAL);
+
+	MOCK_CLEAR(spdk_sock_recv_next);
+}
+
 static void
 test_nvme_tcp_ctrlr_construct(void)
 {
@@ -1953,6 +2038,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_tcp_ctrlr_create_io_qpair);
 	CU_ADD_TEST(suite, test_nvme_tcp_ctrlr_delete_io_qpair);
 	CU_ADD_TEST(suite, test_nvme_tcp_poll_group_get_stats);
+	CU_ADD_TEST(suite, test_nvme_tcp_qpair_recv_next);
 	CU_ADD_TEST(suite, test_nvme_tcp_ctrlr_construct);
 	CU_ADD_TEST(suite, test_nvme_tcp_qpair_submit_request);
 
@@ -180,6 +180,11 @@ DEFINE_STUB(nvmf_bdev_ctrlr_get_dif_ctx, bool,
 DEFINE_STUB_V(nvmf_transport_qpair_abort_request,
 	      (struct spdk_nvmf_qpair *qpair, struct spdk_nvmf_request *req));
 
+DEFINE_STUB(nvmf_transport_get_host_stats, struct nvmf_transport_host_stats *,
+	    (struct spdk_nvmf_transport *transport, const char *hostnqn), NULL);
+DEFINE_STUB(nvmf_transport_get_host_admission, struct nvmf_transport_host_admission *,
+	    (struct spdk_nvmf_transport *transport, const char *hostnqn), NULL);
+
 DEFINE_STUB_V(spdk_nvme_print_command, (uint16_t qid, struct spdk_nvme_cmd *cmd));
 DEFINE_STUB_V(spdk_nvme_print_completion, (uint16_t qid, struct spdk_nvme_cpl *cpl));
 
@@ -472,6 +477,7 @@ test_connect(void)
 
 	memset(&group, 0, sizeof(group));
 	group.thread = spdk_get_thread();
+	TAILQ_INIT(&group.keep_alive_ctrlrs);
 
 	memset(&ctrlr, 0, sizeof(ctrlr));
 	ctrlr.subsys = &subsystem;
@@ -569,7 +575,7 @@ test_connect(void)
 	poll_threads();
 	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
 	CU_ASSERT(nvme_status_success(&rsp.nvme_cpl.status));
-	CU_ASSERT(qpair.ctrlr != NULL && qpair.ctrlr->keep_alive_poller == NULL);
+	CU_ASSERT(qpair.ctrlr != NULL && qpair.ctrlr->keep_alive_group == NULL);
 	CU_ASSERT(qpair.state == SPDK_NVMF_QPAIR_ENABLED);
 	CU_ASSERT(sgroups[subsystem.id].mgmt_io_outstanding == 0);
 	spdk_bit_array_free(&qpair.ctrlr->qpair_mask);
@@ -783,7 +789,7 @@ test_connect(void)
 	CU_ASSERT(nvme_status_success(&rsp.nvme_cpl.status));
 	CU_ASSERT(qpair.state == SPDK_NVMF_QPAIR_ENABLED);
 	CU_ASSERT(qpair.ctrlr != NULL);
-	CU_ASSERT(qpair.ctrlr->keep_alive_poller != NULL);
+	CU_ASSERT(qpair.ctrlr->keep_alive_group == &group);
 	CU_ASSERT(sgroups[subsystem.id].mgmt_io_outstanding == 0);
 	nvmf_ctrlr_stop_keep_alive_timer(qpair.ctrlr);
 	spdk_bit_array_free(&qpair.ctrlr->qpair_mask);
@@ -809,7 +815,7 @@ test_connect(void)
 	CU_ASSERT(nvme_status_success(&rsp.nvme_cpl.status));
 	CU_ASSERT(qpair.state == SPDK_NVMF_QPAIR_ENABLED);
 	CU_ASSERT(qpair.ctrlr != NULL);
-	CU_ASSERT(qpair.ctrlr->keep_alive_poller != NULL);
+	CU_ASSERT(qpair.ctrlr->keep_alive_group == &group);
 	CU_ASSERT(sgroups[subsystem.id].mgmt_io_outstanding == 0);
 	nvmf_ctrlr_stop_keep_alive_timer(qpair.ctrlr);
 	spdk_bit_array_free(&qpair.ctrlr->qpair_mask);
@@ -1462,6 +1468,7 @@ test_set_get_features(void)
  */
 
 static struct spdk_nvmf_ctrlr g_ctrlr1_A, g_ctrlr2_A, g_ctrlr_B, g_ctrlr_C;
+static uint8_t g_ctrlr1_A_role, g_ctrlr2_A_role, g_ctrlr_B_role, g_ctrlr_C_role;
 struct spdk_nvmf_subsystem_pg_ns_info g_ns_info;
 
 static void
@@ -1470,18 +1477,32 @@ ut_reservation_init(enum spdk_nvme_reservation_type rtype)
 	/* Host A has two controllers */
 	spdk_uuid_generate(&g_ctrlr1_A.hostid);
 	spdk_uuid_copy(&g_ctrlr2_A.hostid, &g_ctrlr1_A.hostid);
+	g_ctrlr1_A.ns_resv_role = &g_ctrlr1_A_role;
+	g_ctrlr2_A.ns_resv_role = &g_ctrlr2_A_role;
 
 	/* Host B has 1 controller */
 	spdk_uuid_generate(&g_ctrlr_B.hostid);
+	g_ctrlr_B.ns_resv_role = &g_ctrlr_B_role;
 
 	/* Host C has 1 controller */
 	spdk_uuid_generate(&g_ctrlr_C.hostid);
+	g_ctrlr_C.ns_resv_role = &g_ctrlr_C_role;
 
 	memset(&g_ns_info, 0, sizeof(g_ns_info));
 	g_ns_info.rtype = rtype;
-	g_ns_info.reg_hostid[0] = g_ctrlr1_A.hostid;
-	g_ns_info.reg_hostid[1] = g_ctrlr_B.hostid;
-	g_ns_info.reg_hostid[2] = g_ctrlr_C.hostid;
+
+	/* All hosts are registrants */
+	g_ctrlr1_A_role = NVMF_NS_RESV_ROLE_REGISTRANT;
+	g_ctrlr2_A_role = NVMF_NS_RESV_ROLE_REGISTRANT;
+	g_ctrlr_B_role = NVMF_NS_RESV_ROLE_REGISTRANT;
+	g_ctrlr_C_role = NVMF_NS_RESV_ROLE_REGISTRANT;
+}
+
+static void
+ut_reservation_set_holder_a(void)
+{
+	g_ctrlr1_A_role |= NVMF_NS_RESV_ROLE_HOLDER;
+	g_ctrlr2_A_role |= NVMF_NS_RESV_ROLE_HOLDER;
 }
 
 static void
@@ -1494,10 +1515,11 @@ test_reservation_write_exclusive(void)
 
 	req.cmd = &cmd;
 	req.rsp = &rsp;
+	cmd.nvme_cmd.nsid = 1;
 
 	/* Host A holds reservation with type SPDK_NVME_RESERVE_WRITE_EXCLUSIVE */
 	ut_reservation_init(SPDK_NVME_RESERVE_WRITE_EXCLUSIVE);
-	g_ns_info.holder_id = g_ctrlr1_A.hostid;
+	ut_reservation_set_holder_a();
 
 	/* Test Case: Issue a Read command from Host A and Host B */
 	cmd.nvme_cmd.opc = SPDK_NVME_OPC_READ;
@@ -1526,7 +1548,7 @@ test_reservation_write_exclusive(void)
 	SPDK_CU_ASSERT_FATAL(rc == 0);
 
 	/* Unregister Host C */
-	spdk_uuid_set_null(&g_ns_info.reg_hostid[2]);
+	g_ctrlr_C_role = 0;
 
 	/* Test Case: Read and Write commands from non-registrant Host C */
 	cmd.nvme_cmd.opc = SPDK_NVME_OPC_WRITE;
@@ -1548,10 +1570,11 @@ test_reservation_exclusive_access(void)
 
 	req.cmd = &cmd;
 	req.rsp = &rsp;
+	cmd.nvme_cmd.nsid = 1;
 
 	/* Host A holds reservation with type SPDK_NVME_RESERVE_EXCLUSIVE_ACCESS */
 	ut_reservation_init(SPDK_NVME_RESERVE_EXCLUSIVE_ACCESS);
-	g_ns_info.holder_id = g_ctrlr1_A.hostid;
+	ut_reservation_set_holder_a();
 
 	/* Test Case: Issue a Read command from Host B */
 	cmd.nvme_cmd.opc = SPDK_NVME_OPC_READ;
@@ -1575,10 +1598,11 @@ _test_reservation_write_exclusive_regs_only_and_all_regs(enum spdk_nvme_reservat
 
 	req.cmd = &cmd;
 	req.rsp = &rsp;
+	cmd.nvme_cmd.nsid = 1;
 
 	/* SPDK_NVME_RESERVE_WRITE_EXCLUSIVE_REG_ONLY and SPDK_NVME_RESERVE_WRITE_EXCLUSIVE_ALL_REGS */
 	ut_reservation_init(rtype);
-	g_ns_info.holder_id = g_ctrlr1_A.hostid;
+	ut_reservation_set_holder_a();
 
 	/* Test Case: Issue a Read command from Host A and Host C */
 	cmd.nvme_cmd.opc = SPDK_NVME_OPC_READ;
@@ -1595,7 +1619,7 @@ _test_reservation_write_exclusive_regs_only_and_all_regs(enum spdk_nvme_reservat
 	SPDK_CU_ASSERT_FATAL(rc == 0);
 
 	/* Unregister Host C */
-	spdk_uuid_set_null(&g_ns_info.reg_hostid[2]);
+	g_ctrlr_C_role = 0;
 
 	/* Test Case: Read and Write commands from non-registrant Host C */
 	cmd.nvme_cmd.opc = SPDK_NVME_OPC_READ;
@@ -1626,10 +1650,11 @@ _test_reservation_exclusive_access_regs_only_and_all_regs(enum spdk_nvme_reserva
 
 	req.cmd = &cmd;
 	req.rsp = &rsp;
+	cmd.nvme_cmd.nsid = 1;
 
 	/* SPDK_NVME_RESERVE_EXCLUSIVE_ACCESS_REG_ONLY and SPDK_NVME_RESERVE_EXCLUSIVE_ACCESS_ALL_REGS */
 	ut_reservation_init(rtype);
-	g_ns_info.holder_id = g_ctrlr1_A.hostid;
+	ut_reservation_set_holder_a();
 
 	/* Test Case: Issue a Write command from Host B */
 	cmd.nvme_cmd.opc = SPDK_NVME_OPC_WRITE;
@@ -1637,7 +1662,7 @@ _test_reservation_exclusive_access_regs_only_and_all_regs(enum spdk_nvme_reserva
 	SPDK_CU_ASSERT_FATAL(rc == 0);
 
 	/* Unregister Host B */
-	spdk_uuid_set_null(&g_ns_info.reg_hostid[1]);
+	g_ctrlr_B_role = 0;
 
 	/* Test Case: Issue a Read command from Host B */
 	cmd.nvme_cmd.opc = SPDK_NVME_OPC_READ;
@@ -2120,6 +2145,105 @@ test_fused_compare_and_write(void)
 	spdk_bit_array_free(&ctrlr.visible_ns);
 }
 
+static void
+test_reservation_io_cmd(void)
+{
+	struct spdk_nvmf_request req = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvme_cmd cmd = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ns ns = {};
+	struct spdk_nvmf_ns *subsys_ns[1] = {};
+	enum spdk_nvme_ana_state ana_state[1];
+	struct spdk_nvmf_subsystem_listener listener = { .ana_state = ana_state };
+	struct spdk_bdev bdev = {};
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroups = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info = {};
+	struct spdk_io_channel io_ch = {};
+	uint8_t role = 0;
+	int rc;
+
+	/* The fields checked for each I/O must share the first cache line */
+	CU_ASSERT(offsetof(struct spdk_nvmf_subsystem_pg_ns_info, io_outstanding) < 64);
+	CU_ASSERT(offsetof(struct spdk_nvmf_subsystem_pg_ns_info, state) < 64);
+	CU_ASSERT(offsetof(struct spdk_nvmf_subsystem_pg_ns_info, rtype) < 64);
+
+	ns.bdev = &bdev;
+	ns.anagrpid = 1;
+
+	subsystem.id = 0;
+	subsystem.max_nsid = 1;
+	subsys_ns[0] = &ns;
+	subsystem.ns = (struct spdk_nvmf_ns **)&subsys_ns;
+
+	listener.ana_state[0] = SPDK_NVME_ANA_OPTIMIZED_STATE;
+
+	ctrlr.vcprop.cc.bits.en = 1;
+	ctrlr.subsys = &subsystem;
+	ctrlr.listener = &listener;
+	ctrlr.visible_ns = spdk_bit_array_create(1);
+	spdk_bit_array_set(ctrlr.visible_ns, 0);
+	ctrlr.ns_resv_role = &role;
+
+	group.num_sgroups = 1;
+	sgroups.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	sgroups.num_ns = 1;
+	ns_info.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	ns_info.channel = &io_ch;
+	sgroups.ns_info = &ns_info;
+	TAILQ_INIT(&sgroups.queued);
+	group.sgroups = &sgroups;
+	TAILQ_INIT(&qpair.outstanding);
+
+	qpair.ctrlr = &ctrlr;
+	qpair.group = &group;
+	qpair.qid = 1;
+	qpair.state = SPDK_NVMF_QPAIR_ENABLED;
+
+	cmd.nsid = 1;
+	cmd.opc = SPDK_NVME_OPC_WRITE;
+
+	req.qpair = &qpair;
+	req.cmd = (union nvmf_h2c_msg *)&cmd;
+	req.rsp = &rsp;
+
+	MOCK_SET(nvmf_bdev_ctrlr_read_cmd, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	MOCK_SET(nvmf_bdev_ctrlr_write_cmd, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+
+	/* No reservation: the write is passed to the bdev */
+	rc = nvmf_ctrlr_process_io_cmd(&req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	CU_ASSERT(nvme_status_success(&rsp.nvme_cpl.status));
+
+	/* Write Exclusive held by another host: the write conflicts */
+	ns_info.rtype = SPDK_NVME_RESERVE_WRITE_EXCLUSIVE;
+	rc = nvmf_ctrlr_process_io_cmd(&req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_RESERVATION_CONFLICT);
+
+	/* Reads are still allowed */
+	memset(&rsp, 0, sizeof(rsp));
+	cmd.opc = SPDK_NVME_OPC_READ;
+	rc = nvmf_ctrlr_process_io_cmd(&req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	CU_ASSERT(nvme_status_success(&rsp.nvme_cpl.status));
+
+	/* The reservation holder may write */
+	cmd.opc = SPDK_NVME_OPC_WRITE;
+	role = NVMF_NS_RESV_ROLE_REGISTRANT | NVMF_NS_RESV_ROLE_HOLDER;
+	rc = nvmf_ctrlr_process_io_cmd(&req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	CU_ASSERT(nvme_status_success(&rsp.nvme_cpl.status));
+
+	MOCK_CLEAR(nvmf_bdev_ctrlr_read_cmd);
+	MOCK_CLEAR(nvmf_bdev_ctrlr_write_cmd);
+	spdk_bit_array_free(&ctrlr.visible_ns);
+}
+
 static void
 test_multi_async_event_reqs(void)
 {
@@ -2569,6 +2693,56 @@ test_rae(void)
 	cleanup_pending_async_events(&ctrlr);
 }
 
+static void
+test_keep_alive_timer(void)
+{
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvmf_ctrlr ctrlr1 = {}, ctrlr2 = {};
+
+	group.thread = spdk_get_thread();
+	TAILQ_INIT(&group.keep_alive_ctrlrs);
+	qpair.group = &group;
+	ctrlr1.admin_qpair = &qpair;
+	ctrlr2.admin_qpair = &qpair;
+
+	/* Both controllers share the poller of the group and are sorted by deadline. */
+	ctrlr1.feat.keep_alive_timer.bits.kato = 20000;
+	nvmf_ctrlr_start_keep_alive_timer(&ctrlr1);
+	ctrlr2.feat.keep_alive_timer.bits.kato = 10000;
+	nvmf_ctrlr_start_keep_alive_timer(&ctrlr2);
+	CU_ASSERT(ctrlr1.keep_alive_group == &group);
+	CU_ASSERT(ctrlr2.keep_alive_group == &group);
+	CU_ASSERT(group.keep_alive_poller != NULL);
+	CU_ASSERT(TAILQ_FIRST(&group.keep_alive_ctrlrs) == &ctrlr2);
+	CU_ASSERT(TAILQ_LAST(&group.keep_alive_ctrlrs, spdk_nvmf_keep_alive_ctrlrs) == &ctrlr1);
+
+	/* A keep alive received before the deadline moves the controller to its new deadline. */
+	spdk_delay_us(5000 * 1000);
+	ctrlr2.last_keep_alive_tick = spdk_get_ticks();
+	spdk_delay_us(6000 * 1000);
+	poll_threads();
+	CU_ASSERT(ctrlr2.vcprop.csts.bits.cfs == 0);
+	CU_ASSERT(ctrlr2.keep_alive_group == &group);
+	CU_ASSERT(TAILQ_FIRST(&group.keep_alive_ctrlrs) == &ctrlr2);
+	CU_ASSERT(ctrlr2.keep_alive_deadline_tick == ctrlr2.last_keep_alive_tick +
+		  10000 * spdk_get_ticks_hz() / 1000);
+
+	/* Controllers being destroyed are dropped once their deadline passes. */
+	ctrlr2.in_destruct = true;
+	spdk_delay_us(5000 * 1000);
+	poll_threads();
+	CU_ASSERT(ctrlr2.keep_alive_group == NULL);
+	CU_ASSERT(TAILQ_FIRST(&group.keep_alive_ctrlrs) == &ctrlr1);
+	CU_ASSERT(group.keep_alive_poller != NULL);
+
+	/* The poller is unregistered with the last timer. */
+	nvmf_ctrlr_stop_keep_alive_timer(&ctrlr1);
+	CU_ASSERT(ctrlr1.keep_alive_group == NULL);
+	CU_ASSERT(TAILQ_EMPTY(&group.keep_alive_ctrlrs));
+	CU_ASSERT(group.keep_alive_poller == NULL);
+}
+
 static void
 test_nvmf_ctrlr_create_destruct(void)
 {
@@ -2593,6 +2767,7 @@ test_nvmf_ctrlr_create_destruct(void)
 	const char hostnqn[] = "nqn.2016-06.io.spdk:host1";
 
 	group.thread = spdk_get_thread();
+	TAILQ_INIT(&group.keep_alive_ctrlrs);
 	transport.ops = &tops;
 	transport.opts.max_aq_depth = 32;
 	transport.opts.max_queue_depth = 64;
@@ -3471,6 +3646,53 @@ test_nvmf_check_qpair_active(void)
 	}
 }
 
+static void
+test_nvmf_check_subsystem_active(void)
+{
+	union nvmf_c2h_msg rsp = {};
+	union nvmf_h2c_msg cmd = {};
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ctrlr ctrlr = { .subsys = &subsystem };
+	struct spdk_nvmf_subsystem_poll_group sgroup = { .queued = TAILQ_HEAD_INITIALIZER(sgroup.queued) };
+	struct spdk_nvmf_poll_group group = { .sgroups = &sgroup, .num_sgroups = 1 };
+	struct spdk_nvmf_qpair qpair = { .outstanding = TAILQ_HEAD_INITIALIZER(qpair.outstanding) };
+	struct spdk_nvmf_request req = { .qpair = &qpair, .cmd = &cmd, .rsp = &rsp };
+
+	qpair.ctrlr = &ctrlr;
+	qpair.group = &group;
+	qpair.qid = 0;
+	qpair.state = SPDK_NVMF_QPAIR_ENABLED;
+
+	/* The subsystem is being paused while an admin command is outstanding */
+	sgroup.state = SPDK_NVMF_SUBSYSTEM_PAUSING;
+	sgroup.mgmt_io_outstanding = 1;
+
+	/* Admin commands are queued */
+	cmd.nvme_cmd.opc = SPDK_NVME_OPC_IDENTIFY;
+	CU_ASSERT_EQUAL(nvmf_check_subsystem_active(&req), false);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&sgroup.queued), &req);
+	CU_ASSERT_EQUAL(sgroup.mgmt_io_outstanding, 1);
+	TAILQ_REMOVE(&sgroup.queued, &req, link);
+
+	/* Keep Alive is executed and isn't accounted as outstanding admin command */
+	cmd.nvme_cmd.opc = SPDK_NVME_OPC_KEEP_ALIVE;
+	CU_ASSERT_EQUAL(nvmf_check_subsystem_active(&req), true);
+	CU_ASSERT(TAILQ_EMPTY(&sgroup.queued));
+	CU_ASSERT_EQUAL(sgroup.mgmt_io_outstanding, 1);
+
+	TAILQ_INSERT_TAIL(&qpair.outstanding, &req, link);
+	_nvmf_request_complete(&req);
+	CU_ASSERT(TAILQ_EMPTY(&qpair.outstanding));
+	CU_ASSERT_EQUAL(sgroup.mgmt_io_outstanding, 1);
+	CU_ASSERT_EQUAL(sgroup.state, SPDK_NVMF_SUBSYSTEM_PAUSING);
+
+	/* The same opcode on an I/O queue is not a Keep Alive */
+	qpair.qid = 1;
+	cmd.nvme_cmd.nsid = 1;
+	CU_ASSERT_EQUAL(nvmf_check_subsystem_active(&req), false);
+	CU_ASSERT_EQUAL(rsp.nvme_cpl.status.sc, SPDK_NVME_SC_INVALID_NAMESPACE_OR_FORMAT);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -3497,11 +3719,13 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_identify_ctrlr_iocs_specific);
 	CU_ADD_TEST(suite, test_custom_admin_cmd);
 	CU_ADD_TEST(suite, test_fused_compare_and_write);
+	CU_ADD_TEST(suite, test_reservation_io_cmd);
 	CU_ADD_TEST(suite, test_multi_async_event_reqs);
 	CU_ADD_TEST(suite, test_get_ana_log_page_one_ns_per_anagrp);
 	CU_ADD_TEST(suite, test_get_ana_log_page_multi_ns_per_anagrp);
 	CU_ADD_TEST(suite, test_multi_async_events);
 	CU_ADD_TEST(suite, test_rae);
+	CU_ADD_TEST(suite, test_keep_alive_timer);
 	CU_ADD_TEST(suite, test_nvmf_ctrlr_create_destruct);
 	CU_ADD_TEST(suite, test_nvmf_ctrlr_use_zcopy);
 	CU_ADD_TEST(suite, test_spdk_nvmf_request_zcopy_start);
@@ -3512,6 +3736,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvmf_ctrlr_set_features_host_behavior_support);
 	CU_ADD_TEST(suite, test_nvmf_ctrlr_ns_attachment);
 	CU_ADD_TEST(suite, test_nvmf_check_qpair_active);
+	CU_ADD_TEST(suite, test_nvmf_check_subsystem_active);
 
 	allocate_threads(1);
 	set_thread(0);
@@ -294,6 +294,7 @@ test_discovery_log(void)
 	tgt.max_subsystems = 1024;
 	tgt.subsystem_ids = spdk_bit_array_create(tgt.max_subsystems);
 	RB_INIT(&tgt.subsystems);
+	TAILQ_INIT(&tgt.discovery_log_cache);
 
 	/* Add one subsystem and verify that the discovery log contains it */
 	subsystem = spdk_nvmf_subsystem_create(&tgt, "nqn.2016-06.io.spdk:subsystem1",
@@ -356,6 +357,36 @@ test_discovery_log(void)
 				    offsetof(struct spdk_nvmf_discovery_log_page, entries[0]), sizeof(*entry), &trid);
 	CU_ASSERT(entry->trtype == 42);
 
+	/* All of the reads above were served from the same cached log page */
+	CU_ASSERT(tgt.num_discovery_log_cache_entries == 1);
+
+	/* The cached log page is used as long as genctr doesn't change */
+	subsystem->state = SPDK_NVMF_SUBSYSTEM_INACTIVE;
+	memset(buffer, 0xCC, sizeof(buffer));
+	disc_log = (struct spdk_nvmf_discovery_log_page *)buffer;
+	nvmf_get_discovery_log_page(&tgt, hostnqn, &iov, 1, 0, sizeof(*disc_log), &trid);
+	CU_ASSERT(disc_log->genctr == 1);
+	CU_ASSERT(disc_log->numrec == 1);
+
+	spdk_nvmf_send_discovery_log_notice(&tgt, NULL);
+	memset(buffer, 0xCC, sizeof(buffer));
+	disc_log = (struct spdk_nvmf_discovery_log_page *)buffer;
+	nvmf_get_discovery_log_page(&tgt, hostnqn, &iov, 1, 0, sizeof(*disc_log), &trid);
+	CU_ASSERT(disc_log->genctr == 2);
+	CU_ASSERT(disc_log->numrec == 0);
+	CU_ASSERT(tgt.num_discovery_log_cache_entries == 1);
+
+	/* Other hosts get their own log page */
+	subsystem->state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	spdk_nvmf_send_discovery_log_notice(&tgt, NULL);
+	memset(buffer, 0xCC, sizeof(buffer));
+	disc_log = (struct spdk_nvmf_discovery_log_page *)buffer;
+	nvmf_get_discovery_log_page(&tgt, "nqn.2016-06.io.spdk:host2", &iov, 1, 0, sizeof(*disc_log),
+				    &trid);
+	CU_ASSERT(disc_log->genctr == 3);
+	CU_ASSERT(disc_log->numrec == 0);
+	CU_ASSERT(tgt.num_discovery_log_cache_entries == 2);
+
 	/* remove the host and verify that the discovery log contains nothing */
 	rc = spdk_nvmf_subsystem_remove_host(subsystem, hostnqn);
 	CU_ASSERT(rc == 0);
@@ -381,6 +412,7 @@ test_discovery_log(void)
 	CU_ASSERT(disc_log->genctr != 0);
 	CU_ASSERT(disc_log->numrec == 0);
 
+	nvmf_tgt_free_discovery_log_cache(&tgt);
 	spdk_bit_array_free(&tgt.subsystem_ids);
 }
 
@@ -428,6 +460,7 @@ test_discovery_log_with_filters(void)
 	tgt.max_subsystems = 4;
 	tgt.subsystem_ids = spdk_bit_array_create(tgt.max_subsystems);
 	RB_INIT(&tgt.subsystems);
+	TAILQ_INIT(&tgt.discovery_log_cache);
 
 	subsystem = spdk_nvmf_subsystem_create(&tgt, "nqn.2016-06.io.spdk:subsystem1",
 					       SPDK_NVMF_SUBTYPE_NVME, 0);
@@ -788,6 +821,7 @@ test_discovery_log_with_filters(void)
 
 	subsystem->state = SPDK_NVMF_SUBSYSTEM_INACTIVE;
 	spdk_nvmf_subsystem_destroy(subsystem, NULL, NULL);
+	nvmf_tgt_free_discovery_log_cache(&tgt);
 	spdk_bit_array_free(&tgt.subsystem_ids);
 }
 
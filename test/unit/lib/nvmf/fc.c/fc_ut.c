@@ -39,6 +39,8 @@ DEFINE_STUB(spdk_nvme_transport_id_compare, int,
 	     const struct spdk_nvme_transport_id *trid2), 0);
 DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), "fc_ut_test");
 DEFINE_STUB_V(nvmf_ctrlr_destruct, (struct spdk_nvmf_ctrlr *ctrlr));
+DEFINE_STUB_V(nvmf_poll_group_stop_keep_alive_timers, (struct spdk_nvmf_poll_group *group));
+DEFINE_STUB_V(nvmf_tgt_free_discovery_log_cache, (struct spdk_nvmf_tgt *tgt));
 DEFINE_STUB_V(nvmf_qpair_free_aer, (struct spdk_nvmf_qpair *qpair));
 DEFINE_STUB_V(nvmf_qpair_abort_pending_zcopy_reqs, (struct spdk_nvmf_qpair *qpair));
 DEFINE_STUB(spdk_bdev_get_io_channel, struct spdk_io_channel *, (struct spdk_bdev_desc *desc),
@@ -375,6 +377,53 @@ poll_group_poll_test(void)
 	}
 }
 
+static int
+ut_json_write_cb(void *cb_ctx, const void *data, size_t size)
+{
+	char *buf = cb_ctx;
+
+	strncat(buf, data, spdk_min(size, 4095 - strlen(buf)));
+	return 0;
+}
+
+static void
+poll_group_dump_stat_test(void)
+{
+	struct spdk_nvmf_fc_poll_group fgroup = {};
+	struct spdk_nvmf_fc_port fc_port = {};
+	struct spdk_nvmf_fc_hwqp hwqp[2] = {};
+	struct spdk_json_write_ctx *w;
+	char buf[4096] = {};
+
+	SPDK_CU_ASSERT_FATAL(g_nvmf_tprt != NULL);
+
+	fc_port.port_hdl = 3;
+	TAILQ_INIT(&fgroup.hwqp_list);
+	hwqp[0].fc_port = &fc_port;
+	hwqp[0].num_conns = 1;
+	hwqp[0].num_reqs = 7;
+	hwqp[0].counters.num_aborted = 2;
+	TAILQ_INSERT_TAIL(&fgroup.hwqp_list, &hwqp[0], link);
+	hwqp[1].fc_port = &fc_port;
+	hwqp[1].hwqp_id = 1;
+	hwqp[1].num_reqs = 5;
+	TAILQ_INSERT_TAIL(&fgroup.hwqp_list, &hwqp[1], link);
+
+	w = spdk_json_write_begin(ut_json_write_cb, buf, 0);
+	SPDK_CU_ASSERT_FATAL(w != NULL);
+	spdk_json_write_object_begin(w);
+	nvmf_fc_poll_group_dump_stat(&fgroup.group, w);
+	spdk_json_write_object_end(w);
+	CU_ASSERT(spdk_json_write_end(w) == 0);
+
+	/* Each hwqp of the poll group is reported with its own counters */
+	CU_ASSERT(strstr(buf, "{\"hwqps\":[{\"port_hdl\":3,\"hwqp_id\":0,\"lcore\":0,"
+			 "\"num_conns\":1,\"requests\":7,\"aborted\":2,") != NULL);
+	CU_ASSERT(strstr(buf, "{\"port_hdl\":3,\"hwqp_id\":1,\"lcore\":0,"
+			 "\"num_conns\":0,\"requests\":5,\"aborted\":0,") != NULL);
+	CU_ASSERT(g_nvmf_tprt->ops->poll_group_dump_stat == nvmf_fc_poll_group_dump_stat);
+}
+
 static void
 remove_hwqps_from_poll_groups_test(void)
 {
@@ -442,6 +491,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, create_fc_port_test);
 	CU_ADD_TEST(suite, online_fc_port_test);
 	CU_ADD_TEST(suite, poll_group_poll_test);
+	CU_ADD_TEST(suite, poll_group_dump_stat_test);
 	CU_ADD_TEST(suite, remove_hwqps_from_poll_groups_test);
 	CU_ADD_TEST(suite, destroy_transport_test);
 
@@ -11,6 +11,8 @@
 
 DEFINE_STUB_V(nvmf_transport_poll_group_destroy, (struct spdk_nvmf_transport_poll_group *group));
 DEFINE_STUB_V(nvmf_ctrlr_destruct, (struct spdk_nvmf_ctrlr *ctrlr));
+DEFINE_STUB_V(nvmf_poll_group_stop_keep_alive_timers, (struct spdk_nvmf_poll_group *group));
+DEFINE_STUB_V(nvmf_tgt_free_discovery_log_cache, (struct spdk_nvmf_tgt *tgt));
 DEFINE_STUB_V(nvmf_transport_qpair_fini, (struct spdk_nvmf_qpair *qpair,
 		spdk_nvmf_transport_qpair_fini_cb cb_fn,
 		void *cb_arg));
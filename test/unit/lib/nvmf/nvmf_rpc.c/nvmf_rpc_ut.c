@@ -0,0 +1,385 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/test_env.c"
+#include "nvmf/nvmf_rpc.c"
+
+DEFINE_STUB_V(spdk_rpc_register_method, (const char *method, spdk_rpc_method_handler func,
+		uint32_t state_mask));
+
+DEFINE_STUB(nvmf_publish_mdns_prr, int, (struct spdk_nvmf_tgt *tgt), 0);
+DEFINE_STUB_V(nvmf_qpair_auth_dump, (struct spdk_nvmf_qpair *qpair, struct spdk_json_write_ctx *w));
+DEFINE_STUB(nvmf_subsystem_find_listener, struct spdk_nvmf_subsystem_listener *,
+		(struct spdk_nvmf_subsystem *subsystem, const struct spdk_nvme_transport_id *trid),
+		NULL);
+DEFINE_STUB_V(nvmf_subsystem_remove_all_listeners, (struct spdk_nvmf_subsystem *subsystem,
+		bool stop));
+DEFINE_STUB_V(nvmf_tgt_stop_mdns_prr, (struct spdk_nvmf_tgt *tgt));
+DEFINE_STUB_V(nvmf_transport_dump_host_stats, (struct spdk_nvmf_transport *transport,
+		struct spdk_json_write_ctx *w));
+DEFINE_STUB_V(nvmf_transport_dump_opts, (struct spdk_nvmf_transport *transport,
+		struct spdk_json_write_ctx *w, bool named));
+DEFINE_STUB_V(nvmf_transport_listen_dump_trid, (const struct spdk_nvme_transport_id *trid,
+		struct spdk_json_write_ctx *w));
+DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), NULL);
+DEFINE_STUB_V(spdk_jsonrpc_send_bool_response, (struct spdk_jsonrpc_request *request, bool value));
+DEFINE_STUB(spdk_key_get_name, const char *, (struct spdk_key *key), NULL);
+DEFINE_STUB(spdk_keyring_get_key, struct spdk_key *, (const char *name), NULL);
+DEFINE_STUB_V(spdk_keyring_put_key, (struct spdk_key *key));
+DEFINE_STUB(spdk_nvme_transport_id_parse_adrfam, int, (enum spdk_nvmf_adrfam *adrfam,
+		const char *str), 0);
+DEFINE_STUB(spdk_nvme_transport_id_parse_trtype, int, (enum spdk_nvme_transport_type *trtype,
+		const char *str), 0);
+DEFINE_STUB(spdk_nvme_transport_id_populate_trstring, int, (struct spdk_nvme_transport_id *trid,
+		const char *trstring), 0);
+DEFINE_STUB(spdk_nvmf_get_first_tgt, struct spdk_nvmf_tgt *, (void), NULL);
+DEFINE_STUB(spdk_nvmf_get_next_tgt, struct spdk_nvmf_tgt *, (struct spdk_nvmf_tgt *prev), NULL);
+DEFINE_STUB(spdk_nvmf_get_tgt, struct spdk_nvmf_tgt *, (const char *name),
+		(struct spdk_nvmf_tgt *)0xdeadbeef);
+DEFINE_STUB(spdk_nvmf_host_get_nqn, const char *, (const struct spdk_nvmf_host *host), NULL);
+DEFINE_STUB_V(spdk_nvmf_listen_opts_init, (struct spdk_nvmf_listen_opts *opts, size_t opts_size));
+DEFINE_STUB(spdk_nvmf_ns_add_host, int, (struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+		const char *hostnqn, uint32_t flags), 0);
+DEFINE_STUB(spdk_nvmf_ns_get_bdev, struct spdk_bdev *, (struct spdk_nvmf_ns *ns), NULL);
+DEFINE_STUB(spdk_nvmf_ns_get_id, uint32_t, (const struct spdk_nvmf_ns *ns), 0);
+DEFINE_STUB_V(spdk_nvmf_ns_get_opts, (const struct spdk_nvmf_ns *ns, struct spdk_nvmf_ns_opts *opts,
+		size_t opts_size));
+DEFINE_STUB_V(spdk_nvmf_ns_opts_get_defaults, (struct spdk_nvmf_ns_opts *opts, size_t opts_size));
+DEFINE_STUB(spdk_nvmf_ns_remove_host, int, (struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+		const char *hostnqn, uint32_t flags), 0);
+DEFINE_STUB_V(spdk_nvmf_poll_group_dump_stat, (struct spdk_nvmf_poll_group *group,
+		struct spdk_json_write_ctx *w));
+DEFINE_STUB(spdk_nvmf_qpair_get_listen_trid, int, (struct spdk_nvmf_qpair *qpair,
+		struct spdk_nvme_transport_id *trid), 0);
+DEFINE_STUB(spdk_nvmf_qpair_get_peer_trid, int, (struct spdk_nvmf_qpair *qpair,
+		struct spdk_nvme_transport_id *trid), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_add_host_ext, int, (struct spdk_nvmf_subsystem *subsystem,
+		const char *hostnqn, struct spdk_nvmf_host_opts *opts), 0);
+DEFINE_STUB_V(spdk_nvmf_subsystem_add_listener_ext, (struct spdk_nvmf_subsystem *subsystem,
+		struct spdk_nvme_transport_id *trid, spdk_nvmf_tgt_subsystem_listen_done_fn cb_fn,
+		void *cb_arg, struct spdk_nvmf_listener_opts *opts));
+DEFINE_STUB(spdk_nvmf_subsystem_create, struct spdk_nvmf_subsystem *, (struct spdk_nvmf_tgt *tgt,
+		const char *nqn, enum spdk_nvmf_subtype type, uint32_t num_ns), NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_destroy, int, (struct spdk_nvmf_subsystem *subsystem,
+		nvmf_subsystem_destroy_cb cpl_cb, void *cpl_cb_arg), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_disconnect_host, int, (struct spdk_nvmf_subsystem *subsystem,
+		const char *hostnqn, spdk_nvmf_tgt_subsystem_listen_done_fn cb_fn, void *cb_arg),
+		0);
+DEFINE_STUB(spdk_nvmf_subsystem_get_allow_any_host, bool,
+		(const struct spdk_nvmf_subsystem *subsystem), false);
+DEFINE_STUB(spdk_nvmf_subsystem_get_ana_reporting, bool, (struct spdk_nvmf_subsystem *subsystem),
+		false);
+DEFINE_STUB(spdk_nvmf_subsystem_get_first, struct spdk_nvmf_subsystem *,
+		(struct spdk_nvmf_tgt *tgt), NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_first_host, struct spdk_nvmf_host *,
+		(struct spdk_nvmf_subsystem *subsystem), NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_first_listener, struct spdk_nvmf_subsystem_listener *,
+		(struct spdk_nvmf_subsystem *subsystem), NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_first_ns, struct spdk_nvmf_ns *,
+		(struct spdk_nvmf_subsystem *subsystem), NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_max_cntlid, uint16_t,
+		(const struct spdk_nvmf_subsystem *subsystem), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_get_max_namespaces, uint32_t,
+		(const struct spdk_nvmf_subsystem *subsystem), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_get_min_cntlid, uint16_t,
+		(const struct spdk_nvmf_subsystem *subsystem), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_get_mn, const char *, (const struct spdk_nvmf_subsystem *subsystem),
+		NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_next, struct spdk_nvmf_subsystem *,
+		(struct spdk_nvmf_subsystem *subsystem), NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_next_host, struct spdk_nvmf_host *,
+		(struct spdk_nvmf_subsystem *subsystem, struct spdk_nvmf_host *prev_host), NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_next_listener, struct spdk_nvmf_subsystem_listener *,
+		(struct spdk_nvmf_subsystem *subsystem,
+		struct spdk_nvmf_subsystem_listener *prev_listener), NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_next_ns, struct spdk_nvmf_ns *,
+		(struct spdk_nvmf_subsystem *subsystem, struct spdk_nvmf_ns *prev_ns), NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_nqn, const char *,
+		(const struct spdk_nvmf_subsystem *subsystem), NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_sn, const char *, (const struct spdk_nvmf_subsystem *subsystem),
+		NULL);
+DEFINE_STUB(spdk_nvmf_subsystem_get_type, enum spdk_nvmf_subtype,
+		(struct spdk_nvmf_subsystem *subsystem), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_listener_get_trid, const struct spdk_nvme_transport_id *,
+		(struct spdk_nvmf_subsystem_listener *listener), NULL);
+DEFINE_STUB_V(spdk_nvmf_subsystem_listener_opts_init, (struct spdk_nvmf_listener_opts *opts,
+		size_t size));
+DEFINE_STUB(spdk_nvmf_subsystem_remove_host, int, (struct spdk_nvmf_subsystem *subsystem,
+		const char *hostnqn), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_remove_listener, int, (struct spdk_nvmf_subsystem *subsystem,
+		const struct spdk_nvme_transport_id *trid), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_set_allow_any_host, int, (struct spdk_nvmf_subsystem *subsystem,
+		bool allow_any_host), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_set_ana_reporting, int, (struct spdk_nvmf_subsystem *subsystem,
+		bool ana_reporting), 0);
+DEFINE_STUB_V(spdk_nvmf_subsystem_set_ana_state, (struct spdk_nvmf_subsystem *subsystem,
+		const struct spdk_nvme_transport_id *trid, enum spdk_nvme_ana_state ana_state,
+		uint32_t anagrpid, spdk_nvmf_tgt_subsystem_listen_done_fn cb_fn, void *cb_arg));
+DEFINE_STUB(spdk_nvmf_subsystem_set_cntlid_range, int, (struct spdk_nvmf_subsystem *subsystem,
+		uint16_t min_cntlid, uint16_t max_cntlid), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_set_keys, int, (struct spdk_nvmf_subsystem *subsystem,
+		const char *hostnqn, struct spdk_nvmf_subsystem_key_opts *opts), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_set_mn, int, (struct spdk_nvmf_subsystem *subsystem,
+		const char *mn), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_set_ns_ana_group, int, (struct spdk_nvmf_subsystem *subsystem,
+		uint32_t nsid, uint32_t anagrpid), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_set_sn, int, (struct spdk_nvmf_subsystem *subsystem,
+		const char *sn), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_start, int, (struct spdk_nvmf_subsystem *subsystem,
+		spdk_nvmf_subsystem_state_change_done cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvmf_subsystem_stop, int, (struct spdk_nvmf_subsystem *subsystem,
+		spdk_nvmf_subsystem_state_change_done cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvmf_tgt_add_referral, int, (struct spdk_nvmf_tgt *tgt,
+		const struct spdk_nvmf_referral_opts *opts), 0);
+DEFINE_STUB_V(spdk_nvmf_tgt_add_transport, (struct spdk_nvmf_tgt *tgt,
+		struct spdk_nvmf_transport *transport, spdk_nvmf_tgt_add_transport_done_fn cb_fn,
+		void *cb_arg));
+DEFINE_STUB(spdk_nvmf_tgt_create, struct spdk_nvmf_tgt *, (struct spdk_nvmf_target_opts *opts),
+		NULL);
+DEFINE_STUB_V(spdk_nvmf_tgt_destroy, (struct spdk_nvmf_tgt *tgt,
+		spdk_nvmf_tgt_destroy_done_fn cb_fn, void *cb_arg));
+DEFINE_STUB(spdk_nvmf_tgt_get_name, const char *, (struct spdk_nvmf_tgt *tgt), NULL);
+DEFINE_STUB(spdk_nvmf_tgt_get_transport, struct spdk_nvmf_transport *, (struct spdk_nvmf_tgt *tgt,
+		const char *transport_name), NULL);
+DEFINE_STUB(spdk_nvmf_tgt_listen_ext, int, (struct spdk_nvmf_tgt *tgt,
+		const struct spdk_nvme_transport_id *trid, struct spdk_nvmf_listen_opts *opts), 0);
+DEFINE_STUB(spdk_nvmf_tgt_remove_referral, int, (struct spdk_nvmf_tgt *tgt,
+		const struct spdk_nvmf_referral_opts *opts), 0);
+DEFINE_STUB(spdk_nvmf_tgt_stop_listen, int, (struct spdk_nvmf_tgt *tgt,
+		struct spdk_nvme_transport_id *trid), 0);
+DEFINE_STUB(spdk_nvmf_transport_create_async, int, (const char *transport_name,
+		struct spdk_nvmf_transport_opts *opts, spdk_nvmf_transport_create_done_cb cb_fn,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_nvmf_transport_destroy, int, (struct spdk_nvmf_transport *transport,
+		spdk_nvmf_transport_destroy_done_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvmf_transport_get_first, struct spdk_nvmf_transport *,
+		(struct spdk_nvmf_tgt *tgt), NULL);
+DEFINE_STUB(spdk_nvmf_transport_get_next, struct spdk_nvmf_transport *,
+		(struct spdk_nvmf_transport *transport), NULL);
+DEFINE_STUB(spdk_nvmf_transport_opts_init, bool, (const char *transport_name,
+		struct spdk_nvmf_transport_opts *opts, size_t opts_size), false);
+DEFINE_STUB(spdk_nvmf_transport_stop_listen_async, int, (struct spdk_nvmf_transport *transport,
+		const struct spdk_nvme_transport_id *trid, struct spdk_nvmf_subsystem *subsystem,
+		spdk_nvmf_tgt_subsystem_listen_done_fn cb_fn, void *cb_arg), 0);
+
+
+#define UT_MAX_NS 8
+
+static struct spdk_nvmf_subsystem *g_subsystem = (struct spdk_nvmf_subsystem *)0xfeedbeef;
+static int g_num_pause;
+static int g_num_resume;
+/* Namespace added for each NSID, NULL if there is none */
+static char g_ns_bdev[UT_MAX_NS + 1][32];
+static const char *g_fail_bdev;
+static uint32_t g_removed[UT_MAX_NS];
+static int g_num_removed;
+
+static int g_num_responses;
+static int g_error_code;
+static char g_result[256];
+static size_t g_result_len;
+
+struct spdk_nvmf_subsystem *
+spdk_nvmf_tgt_find_subsystem(struct spdk_nvmf_tgt *tgt, const char *subnqn)
+{
+	return strcmp(subnqn, "nqn.2016-06.io.spdk:cnode1") == 0 ? g_subsystem : NULL;
+}
+
+int
+spdk_nvmf_subsystem_pause(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+			  spdk_nvmf_subsystem_state_change_done cb_fn, void *cb_arg)
+{
+	CU_ASSERT(subsystem == g_subsystem);
+	CU_ASSERT(g_num_pause == g_num_resume);
+	g_num_pause++;
+	cb_fn(subsystem, cb_arg, 0);
+
+	return 0;
+}
+
+int
+spdk_nvmf_subsystem_resume(struct spdk_nvmf_subsystem *subsystem,
+			   spdk_nvmf_subsystem_state_change_done cb_fn, void *cb_arg)
+{
+	CU_ASSERT(subsystem == g_subsystem);
+	g_num_resume++;
+	CU_ASSERT(g_num_pause == g_num_resume);
+	cb_fn(subsystem, cb_arg, 0);
+
+	return 0;
+}
+
+uint32_t
+spdk_nvmf_subsystem_add_ns_ext(struct spdk_nvmf_subsystem *subsystem, const char *bdev_name,
+			       const struct spdk_nvmf_ns_opts *opts, size_t opts_size,
+			       const char *ptpl_file)
+{
+	uint32_t nsid;
+
+	/* Namespaces are only added while the subsystem is paused */
+	CU_ASSERT(g_num_pause == g_num_resume + 1);
+	if (g_fail_bdev != NULL && strcmp(bdev_name, g_fail_bdev) == 0) {
+		return 0;
+	}
+
+	for (nsid = 1; nsid <= UT_MAX_NS; nsid++) {
+		if (g_ns_bdev[nsid][0] == '\0') {
+			snprintf(g_ns_bdev[nsid], sizeof(g_ns_bdev[nsid]), "%s", bdev_name);
+			return nsid;
+		}
+	}
+
+	return 0;
+}
+
+int
+spdk_nvmf_subsystem_remove_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid)
+{
+	CU_ASSERT(g_num_pause == g_num_resume + 1);
+	SPDK_CU_ASSERT_FATAL(nsid > 0 && nsid <= UT_MAX_NS);
+	CU_ASSERT(g_ns_bdev[nsid][0] != '\0');
+	g_ns_bdev[nsid][0] = '\0';
+	g_removed[g_num_removed++] = nsid;
+
+	return 0;
+}
+
+static int
+ut_write_cb(void *cb_ctx, const void *data, size_t size)
+{
+	SPDK_CU_ASSERT_FATAL(g_result_len + size < sizeof(g_result));
+	memcpy(&g_result[g_result_len], data, size);
+	g_result_len += size;
+	g_result[g_result_len] = '\0';
+
+	return 0;
+}
+
+struct spdk_json_write_ctx *
+spdk_jsonrpc_begin_result(struct spdk_jsonrpc_request *request)
+{
+	return spdk_json_write_begin(ut_write_cb, NULL, 0);
+}
+
+void
+spdk_jsonrpc_end_result(struct spdk_jsonrpc_request *request, struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_end(w);
+	g_num_responses++;
+}
+
+void
+spdk_jsonrpc_send_error_response(struct spdk_jsonrpc_request *request, int error_code,
+				 const char *msg)
+{
+	g_error_code = error_code;
+	g_num_responses++;
+}
+
+void
+spdk_jsonrpc_send_error_response_fmt(struct spdk_jsonrpc_request *request, int error_code,
+				     const char *fmt, ...)
+{
+	g_error_code = error_code;
+	g_num_responses++;
+}
+
+static void
+ut_add_ns_bulk(const char *json)
+{
+	struct spdk_json_val values[64];
+	char buf[512];
+	ssize_t rc;
+
+	g_num_pause = 0;
+	g_num_resume = 0;
+	g_num_removed = 0;
+	g_num_responses = 0;
+	g_error_code = 0;
+	g_result_len = 0;
+	g_result[0] = '\0';
+
+	snprintf(buf, sizeof(buf), "%s", json);
+	rc = spdk_json_parse(buf, strlen(buf), values, SPDK_COUNTOF(values), NULL, 0);
+	SPDK_CU_ASSERT_FATAL(rc > 0);
+
+	rpc_nvmf_subsystem_add_ns_bulk(NULL, values);
+}
+
+static void
+add_ns_bulk(void)
+{
+	memset(g_ns_bdev, 0, sizeof(g_ns_bdev));
+	snprintf(g_ns_bdev[2], sizeof(g_ns_bdev[2]), "Existing");
+
+	/* All namespaces are added under a single pause, the result lists their NSIDs */
+	ut_add_ns_bulk("{\"nqn\": \"nqn.2016-06.io.spdk:cnode1\", \"namespaces\": ["
+		       "{\"bdev_name\": \"Malloc0\"}, {\"bdev_name\": \"Malloc1\"},"
+		       "{\"bdev_name\": \"Malloc2\"}]}");
+	CU_ASSERT(g_num_pause == 1);
+	CU_ASSERT(g_num_resume == 1);
+	CU_ASSERT(g_num_responses == 1);
+	CU_ASSERT(g_error_code == 0);
+	CU_ASSERT(strcmp(g_result, "[1,3,4]") == 0);
+	CU_ASSERT(strcmp(g_ns_bdev[1], "Malloc0") == 0);
+	CU_ASSERT(strcmp(g_ns_bdev[3], "Malloc1") == 0);
+	CU_ASSERT(strcmp(g_ns_bdev[4], "Malloc2") == 0);
+	CU_ASSERT(g_num_removed == 0);
+
+	/* A namespace that can't be added rolls back the ones added before it */
+	g_fail_bdev = "Malloc5";
+	ut_add_ns_bulk("{\"nqn\": \"nqn.2016-06.io.spdk:cnode1\", \"namespaces\": ["
+		       "{\"bdev_name\": \"Malloc3\"}, {\"bdev_name\": \"Malloc4\"},"
+		       "{\"bdev_name\": \"Malloc5\"}, {\"bdev_name\": \"Malloc6\"}]}");
+	CU_ASSERT(g_num_pause == 1);
+	CU_ASSERT(g_num_resume == 1);
+	CU_ASSERT(g_num_responses == 1);
+	CU_ASSERT(g_error_code == SPDK_JSONRPC_ERROR_INVALID_PARAMS);
+	CU_ASSERT(g_num_removed == 2);
+	CU_ASSERT(g_removed[0] == 6);
+	CU_ASSERT(g_removed[1] == 5);
+	CU_ASSERT(g_ns_bdev[5][0] == '\0');
+	CU_ASSERT(g_ns_bdev[6][0] == '\0');
+	CU_ASSERT(g_ns_bdev[7][0] == '\0');
+	CU_ASSERT(strcmp(g_ns_bdev[4], "Malloc2") == 0);
+	g_fail_bdev = NULL;
+
+	/* Unknown subsystem, nothing is paused */
+	ut_add_ns_bulk("{\"nqn\": \"nqn.2016-06.io.spdk:cnode2\", \"namespaces\": ["
+		       "{\"bdev_name\": \"Malloc3\"}]}");
+	CU_ASSERT(g_num_pause == 0);
+	CU_ASSERT(g_num_responses == 1);
+	CU_ASSERT(g_error_code == SPDK_JSONRPC_ERROR_INVALID_PARAMS);
+
+	/* Namespace without a bdev */
+	ut_add_ns_bulk("{\"nqn\": \"nqn.2016-06.io.spdk:cnode1\", \"namespaces\": ["
+		       "{\"bdev_name\": \"Malloc3\"}, {\"nsid\": 7}]}");
+	CU_ASSERT(g_num_pause == 0);
+	CU_ASSERT(g_num_responses == 1);
+	CU_ASSERT(g_error_code == SPDK_JSONRPC_ERROR_INVALID_PARAMS);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("nvmf_rpc", NULL, NULL);
+
+	CU_ADD_TEST(suite, add_ns_bulk);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -52,12 +52,48 @@ DEFINE_STUB(ibv_dereg_mr, int, (struct ibv_mr *mr), 0);
 DEFINE_STUB(ibv_resize_cq, int, (struct ibv_cq *cq, int cqe), 0);
 DEFINE_STUB(spdk_mempool_lookup, struct spdk_mempool *, (const char *name), NULL);
 DEFINE_STUB(spdk_rdma_cm_id_get_numa_id, int32_t, (struct rdma_cm_id *cm_id), 0);
+DEFINE_STUB(spdk_accel_get_io_channel, struct spdk_io_channel *, (void), NULL);
+DEFINE_STUB(spdk_accel_get_opc_module_name, int, (enum spdk_accel_opcode opcode,
+		const char **module_name), -ENOENT);
+DEFINE_STUB(spdk_accel_submit_dif_verify_copy, int, (struct spdk_io_channel *ch,
+		struct iovec *dst_iovs, size_t dst_iovcnt, struct iovec *src_iovs, size_t src_iovcnt,
+		uint32_t num_blocks, const struct spdk_dif_ctx *ctx, struct spdk_dif_error *err,
+		spdk_accel_completion_cb cb_fn, void *cb_arg), 0);
 
 /* ibv_reg_mr can be a macro, need to undefine it */
 #ifdef ibv_reg_mr
 #undef ibv_reg_mr
 #endif
 
+static spdk_accel_completion_cb g_accel_cb_fn;
+static void *g_accel_cb_arg;
+static struct spdk_dif_error *g_accel_dif_err;
+
+DEFINE_RETURN_MOCK(spdk_accel_submit_dif_generate, int);
+int
+spdk_accel_submit_dif_generate(struct spdk_io_channel *ch, struct iovec *iovs, size_t iovcnt,
+			       uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+			       spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	HANDLE_RETURN_MOCK(spdk_accel_submit_dif_generate);
+	g_accel_cb_fn = cb_fn;
+	g_accel_cb_arg = cb_arg;
+	return 0;
+}
+
+DEFINE_RETURN_MOCK(spdk_accel_submit_dif_verify, int);
+int
+spdk_accel_submit_dif_verify(struct spdk_io_channel *ch, struct iovec *iovs, size_t iovcnt,
+			     uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+			     struct spdk_dif_error *err, spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	HANDLE_RETURN_MOCK(spdk_accel_submit_dif_verify);
+	g_accel_cb_fn = cb_fn;
+	g_accel_cb_arg = cb_arg;
+	g_accel_dif_err = err;
+	return 0;
+}
+
 DEFINE_RETURN_MOCK(ibv_reg_mr, struct ibv_mr *);
 struct ibv_mr *
 ibv_reg_mr(struct ibv_pd *pd, void *addr, size_t length, int access)
@@ -1437,6 +1473,160 @@ test_nvmf_rdma_resize_cq(void)
 	CU_ASSERT(rpoller.num_cqe > tnum_cqe);
 }
 
+static void
+test_nvmf_rdma_poll_group_add_srq_lazy(void)
+{
+	struct spdk_nvmf_rdma_transport rtransport = {};
+	struct spdk_nvmf_rdma_poll_group rgroup = {};
+	struct spdk_nvmf_rdma_poller rpoller = {};
+	struct spdk_nvmf_rdma_device rdevice = {};
+	struct spdk_nvmf_rdma_qpair rqpair = {};
+	struct spdk_rdma_provider_srq rsrq = {};
+	struct spdk_rdma_provider_qp rdma_qp = {};
+	struct ibv_qp ibv_qp = {};
+	struct rdma_cm_id cm_id = {};
+	int rc;
+
+	rtransport.transport.opts.in_capsule_data_size = 0;
+	rgroup.group.transport = &rtransport.transport;
+	TAILQ_INIT(&rgroup.pollers);
+
+	/* A poller with an SRQ, whose resources haven't been allocated yet */
+	rpoller.device = &rdevice;
+	rpoller.group = &rgroup;
+	rpoller.srq = &rsrq;
+	rpoller.max_srq_depth = 16;
+	RB_INIT(&rpoller.qpairs);
+	STAILQ_INIT(&rpoller.qpairs_pending_recv);
+	TAILQ_INSERT_TAIL(&rgroup.pollers, &rpoller, link);
+
+	rqpair.device = &rdevice;
+	rqpair.cm_id = &cm_id;
+	rqpair.max_queue_depth = 16;
+	rqpair.qpair.transport = &rtransport.transport;
+	rdma_qp.qp = &ibv_qp;
+
+	/* Test1: Resources allocation fails, the qpair isn't added. */
+	MOCK_SET(spdk_zmalloc, NULL);
+	MOCK_SET(spdk_rdma_provider_qp_create, &rdma_qp);
+
+	rc = nvmf_rdma_poll_group_add(&rgroup.group, &rqpair.qpair);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(rpoller.resources == NULL);
+	CU_ASSERT(rqpair.poller == NULL);
+	CU_ASSERT(rqpair.rdma_qp == NULL);
+	CU_ASSERT(RB_EMPTY(&rpoller.qpairs));
+
+	/* Test2: The first qpair allocates the resources and shares them. */
+	MOCK_CLEAR(spdk_zmalloc);
+
+	rc = nvmf_rdma_poll_group_add(&rgroup.group, &rqpair.qpair);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(rpoller.resources != NULL);
+	CU_ASSERT(rpoller.resources->recvs[0].qpair == NULL);
+	CU_ASSERT(rqpair.poller == &rpoller);
+	CU_ASSERT(rqpair.srq == &rsrq);
+	CU_ASSERT(rqpair.resources == rpoller.resources);
+	CU_ASSERT(rqpair.rdma_qp == &rdma_qp);
+	CU_ASSERT(RB_FIND(qpairs_tree, &rpoller.qpairs, &rqpair) == &rqpair);
+
+	MOCK_CLEAR(spdk_rdma_provider_qp_create);
+	nvmf_rdma_resources_destroy(rpoller.resources);
+}
+
+static void
+test_nvmf_rdma_request_process_accel_dif(void)
+{
+	struct spdk_nvmf_rdma_transport rtransport = {};
+	struct spdk_nvmf_transport_ops ops = {};
+	struct spdk_nvmf_rdma_poll_group group = {};
+	struct spdk_nvmf_rdma_poller poller = {};
+	struct spdk_nvmf_rdma_device device = {};
+	struct spdk_nvmf_rdma_resources resources = {};
+	struct spdk_nvmf_rdma_qpair rqpair = {};
+	struct spdk_nvmf_rdma_recv *rdma_recv;
+	struct spdk_nvmf_rdma_request *rdma_req;
+	struct spdk_nvme_cpl *rsp;
+	bool progress;
+
+	group.accel_dif = true;
+	STAILQ_INIT(&group.group.pending_buf_queue);
+	poller_reset(&poller, &group);
+	qpair_reset(&rqpair, &poller, &device, &resources, &rtransport.transport);
+	rtransport.transport.opts = g_rdma_ut_transport_opts;
+	rtransport.transport.ops = &ops;
+
+	/* WRITE: DIF is generated by the accel framework before the request executes */
+	rdma_recv = create_recv(&rqpair, SPDK_NVME_OPC_WRITE);
+	rdma_req = create_req(&rqpair, rdma_recv);
+	rdma_req->req.cmd = (union nvmf_h2c_msg *)rdma_recv->sgl[0].addr;
+	rdma_req->req.xfer = SPDK_NVME_DATA_HOST_TO_CONTROLLER;
+	rdma_req->req.dif_enabled = true;
+	rdma_req->req.dif.dif_ctx.block_size = 520;
+	rdma_req->req.dif.orig_length = 4096;
+	rdma_req->req.dif.elba_length = 4160;
+	rdma_req->req.length = 4096;
+	rdma_req->state = RDMA_REQUEST_STATE_READY_TO_EXECUTE;
+	rqpair.current_recv_depth = 1;
+	g_accel_cb_fn = NULL;
+
+	progress = nvmf_rdma_request_process(&rtransport, rdma_req);
+	CU_ASSERT(progress == true);
+	CU_ASSERT(rdma_req->state == RDMA_REQUEST_STATE_GENERATING_DIF);
+	CU_ASSERT(rdma_req->req.length == 4096);
+	SPDK_CU_ASSERT_FATAL(g_accel_cb_fn != NULL);
+
+	/* GENERATING_DIF -> EXECUTING, without generating DIF again */
+	g_accel_cb_fn(g_accel_cb_arg, 0);
+	CU_ASSERT(rdma_req->state == RDMA_REQUEST_STATE_EXECUTING);
+	CU_ASSERT(rdma_req->req.length == 4160);
+
+	/* EXECUTED -> COMPLETING */
+	rdma_req->state = RDMA_REQUEST_STATE_EXECUTED;
+	progress = nvmf_rdma_request_process(&rtransport, rdma_req);
+	CU_ASSERT(progress == true);
+	CU_ASSERT(rdma_req->state == RDMA_REQUEST_STATE_COMPLETING);
+	CU_ASSERT(rdma_req->req.length == 4096);
+
+	free_recv(rdma_recv);
+	free_req(rdma_req);
+	poller_reset(&poller, &group);
+	qpair_reset(&rqpair, &poller, &device, &resources, &rtransport.transport);
+
+	/* READ: a DIF error reported by the accel framework fails the request */
+	rdma_recv = create_recv(&rqpair, SPDK_NVME_OPC_READ);
+	rdma_req = create_req(&rqpair, rdma_recv);
+	rsp = &rdma_req->req.rsp->nvme_cpl;
+	rdma_req->req.cmd = (union nvmf_h2c_msg *)rdma_recv->sgl[0].addr;
+	rdma_req->req.xfer = SPDK_NVME_DATA_CONTROLLER_TO_HOST;
+	rdma_req->req.dif_enabled = true;
+	rdma_req->req.dif.dif_ctx.block_size = 520;
+	rdma_req->req.dif.orig_length = 4096;
+	rdma_req->req.dif.elba_length = 4160;
+	rdma_req->req.length = 4160;
+	rdma_req->state = RDMA_REQUEST_STATE_EXECUTED;
+	rqpair.current_recv_depth = 1;
+	g_accel_cb_fn = NULL;
+
+	progress = nvmf_rdma_request_process(&rtransport, rdma_req);
+	CU_ASSERT(progress == true);
+	CU_ASSERT(rdma_req->state == RDMA_REQUEST_STATE_VERIFYING_DIF);
+	CU_ASSERT(rdma_req->req.length == 4096);
+	CU_ASSERT(STAILQ_EMPTY(&rqpair.pending_rdma_write_queue));
+	SPDK_CU_ASSERT_FATAL(g_accel_cb_fn != NULL);
+
+	/* VERIFYING_DIF -> COMPLETING with a media error */
+	g_accel_dif_err->err_type = SPDK_DIF_GUARD_ERROR;
+	g_accel_cb_fn(g_accel_cb_arg, -EIO);
+	CU_ASSERT(rdma_req->state == RDMA_REQUEST_STATE_COMPLETING);
+	CU_ASSERT(rsp->status.sct == SPDK_NVME_SCT_MEDIA_ERROR);
+	CU_ASSERT(rsp->status.sc == SPDK_NVME_SC_GUARD_CHECK_ERROR);
+	CU_ASSERT(STAILQ_EMPTY(&rqpair.pending_rdma_write_queue));
+
+	free_recv(rdma_recv);
+	free_req(rdma_req);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1456,6 +1646,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvmf_rdma_resources_create);
 	CU_ADD_TEST(suite, test_nvmf_rdma_qpair_compare);
 	CU_ADD_TEST(suite, test_nvmf_rdma_resize_cq);
+	CU_ADD_TEST(suite, test_nvmf_rdma_poll_group_add_srq_lazy);
+	CU_ADD_TEST(suite, test_nvmf_rdma_request_process_accel_dif);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -221,6 +221,12 @@ DEFINE_STUB_V(spdk_nvmf_tgt_new_qpair, (struct spdk_nvmf_tgt *tgt, struct spdk_n
 DEFINE_STUB_V(nvmf_transport_qpair_abort_request,
 	      (struct spdk_nvmf_qpair *qpair, struct spdk_nvmf_request *req));
 
+DEFINE_STUB(nvmf_transport_get_host_stats, struct nvmf_transport_host_stats *,
+	    (struct spdk_nvmf_transport *transport, const char *hostnqn), NULL);
+DEFINE_STUB(nvmf_transport_get_host_admission, struct nvmf_transport_host_admission *,
+	    (struct spdk_nvmf_transport *transport, const char *hostnqn), NULL);
+DEFINE_STUB(nvmf_transport_req_admit, bool, (struct spdk_nvmf_request *req), true);
+
 DEFINE_STUB_V(nvmf_qpair_set_state, (struct spdk_nvmf_qpair *q, enum spdk_nvmf_qpair_state s));
 
 DEFINE_STUB_V(spdk_nvme_print_command, (uint16_t qid, struct spdk_nvme_cmd *cmd));
@@ -278,6 +284,8 @@ DEFINE_STUB(spdk_accel_submit_crc32cv,
 	    (struct spdk_io_channel *ch, uint32_t *dst, struct iovec *iovs,
 	     uint32_t iovcnt, uint32_t seed, spdk_accel_completion_cb cb_fn, void *cb_arg),
 	    0);
+DEFINE_STUB(spdk_accel_get_opc_module_name, int,
+	    (enum spdk_accel_opcode opcode, const char **module_name), -ENOENT);
 
 DEFINE_STUB(spdk_nvmf_bdev_ctrlr_nvme_passthru_admin,
 	    int,
@@ -619,6 +627,7 @@ test_nvmf_tcp_send_c2h_data(void)
 	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_ERROR;
 
 	tcp_req.req.cmd = (union nvmf_h2c_msg *)&tcp_req.cmd;
+	tcp_req.req.rsp = (union nvmf_c2h_msg *)&tcp_req.rsp;
 
 	tcp_req.req.iov[0].iov_base = (void *)0xDEADBEEF;
 	tcp_req.req.iov[0].iov_len = 101;
@@ -637,6 +646,9 @@ test_nvmf_tcp_send_c2h_data(void)
 	CU_ASSERT(c2h_data->common.plen == sizeof(*c2h_data) + 300);
 	CU_ASSERT(c2h_data->common.flags & SPDK_NVME_TCP_C2H_DATA_FLAGS_LAST_PDU);
 	CU_ASSERT(c2h_data->common.flags & SPDK_NVME_TCP_C2H_DATA_FLAGS_SUCCESS);
+	CU_ASSERT(pdu.req == NULL);
+	CU_ASSERT(pdu.cb_fn == nvmf_tcp_pdu_c2h_data_complete);
+	CU_ASSERT(pdu.sock_req.iovcnt == 4);
 
 	CU_ASSERT(pdu.data_iovcnt == 3);
 	CU_ASSERT((uint64_t)pdu.data_iov[0].iov_base == 0xDEADBEEF);
@@ -653,6 +665,15 @@ test_nvmf_tcp_send_c2h_data(void)
 	CU_ASSERT(c2h_data->common.flags & SPDK_NVME_TCP_C2H_DATA_FLAGS_LAST_PDU);
 	CU_ASSERT((c2h_data->common.flags & SPDK_NVME_TCP_C2H_DATA_FLAGS_SUCCESS) == 0);
 
+	/* The capsule response is written in the same socket request as the data */
+	CU_ASSERT(pdu.req == &tcp_req);
+	CU_ASSERT(pdu.cb_fn == nvmf_tcp_request_free);
+	CU_ASSERT(pdu.sock_req.iovcnt == 5);
+	CU_ASSERT(pdu.iov[4].iov_base == &tcp_req.c2h_capsule_resp);
+	CU_ASSERT(pdu.iov[4].iov_len == sizeof(struct spdk_nvme_tcp_rsp));
+	CU_ASSERT(tcp_req.c2h_capsule_resp.hdr.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_CAPSULE_RESP);
+	CU_ASSERT(tcp_req.c2h_capsule_resp.hdr.rccqe.cdw0 == 1);
+
 	ttransport.tcp_opts.c2h_success = false;
 	tcp_req.pdu_in_use = false;
 	tcp_req.rsp.cdw0 = 0;
@@ -813,6 +834,149 @@ test_nvmf_tcp_in_capsule_data_handle(void)
 	CU_ASSERT(tcp_req1.state == TCP_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER);
 }
 
+static void
+test_nvmf_tcp_in_capsule_data_zcopy(void)
+{
+	struct spdk_nvmf_tcp_transport ttransport = {};
+	struct spdk_nvmf_tcp_qpair tqpair = {};
+	struct nvme_tcp_pdu pdu_in_progress = {};
+	struct nvme_tcp_pdu rsp_pdu = {};
+	struct spdk_nvmf_tcp_req tcp_req = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvmf_tcp_poll_group tcp_group = {};
+	struct spdk_sock_group grp = {};
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_ns ns = {};
+	struct spdk_nvmf_ns *ns_array[1] = { &ns };
+	struct spdk_nvme_sgl_descriptor *sgl;
+	uint8_t icd_buf[UT_IN_CAPSULE_DATA_SIZE];
+	uint8_t zcopy_buf[UT_IN_CAPSULE_DATA_SIZE];
+	uint32_t length = 512;
+
+	ttransport.transport.opts.max_io_size = UT_MAX_IO_SIZE;
+	ttransport.transport.opts.io_unit_size = UT_IO_UNIT_SIZE;
+	ttransport.transport.opts.in_capsule_data_size = UT_IN_CAPSULE_DATA_SIZE;
+	ttransport.transport.opts.zcopy = true;
+
+	/* A namespace that can be accessed through zero-copy */
+	ns.bdev = (struct spdk_bdev *)0xdeadbeef;
+	ns.zcopy = true;
+	subsystem.max_nsid = 1;
+	subsystem.ns = ns_array;
+	ctrlr.subsys = &subsystem;
+	ctrlr.visible_ns = spdk_bit_array_create(1);
+	SPDK_CU_ASSERT_FATAL(ctrlr.visible_ns != NULL);
+	spdk_bit_array_set(ctrlr.visible_ns, 0);
+
+	tcp_group.sock_group = &grp;
+	TAILQ_INIT(&tcp_group.qpairs);
+	tcp_group.group.transport = &ttransport.transport;
+
+	TAILQ_INIT(&tqpair.tcp_req_free_queue);
+	TAILQ_INIT(&tqpair.tcp_req_working_queue);
+	tqpair.pdu_in_progress = &pdu_in_progress;
+	tqpair.group = &tcp_group;
+	tqpair.qpair.transport = &ttransport.transport;
+	tqpair.qpair.ctrlr = &ctrlr;
+	tqpair.qpair.qid = 1;
+	tqpair.qpair.sq_head_max = UT_SQ_HEAD_MAX;
+	tqpair.qpair.state = SPDK_NVMF_QPAIR_ENABLED;
+	tqpair.state = NVMF_TCP_QPAIR_STATE_RUNNING;
+
+	tcp_req.req.qpair = &tqpair.qpair;
+	tcp_req.req.cmd = (union nvmf_h2c_msg *)&tcp_req.cmd;
+	tcp_req.req.rsp = &rsp;
+	tcp_req.req.xfer = SPDK_NVME_DATA_HOST_TO_CONTROLLER;
+	tcp_req.pdu = &rsp_pdu;
+	tcp_req.pdu->qpair = &tqpair;
+	tcp_req.buf = icd_buf;
+	tcp_req.has_in_capsule_data = true;
+
+	/* A write carrying its data in the capsule */
+	tcp_req.cmd.opc = SPDK_NVME_OPC_WRITE;
+	tcp_req.cmd.nsid = 1;
+	sgl = &tcp_req.cmd.dptr.sgl1;
+	sgl->generic.type = SPDK_NVME_SGL_TYPE_DATA_BLOCK;
+	sgl->unkeyed.subtype = SPDK_NVME_SGL_SUBTYPE_OFFSET;
+	sgl->unkeyed.length = length;
+	pdu_in_progress.hdr.common.pdu_type = SPDK_NVME_TCP_PDU_TYPE_CAPSULE_CMD;
+	pdu_in_progress.psh_len = sizeof(struct spdk_nvme_tcp_cmd) -
+				  sizeof(struct spdk_nvme_tcp_common_pdu_hdr);
+	pdu_in_progress.hdr.common.plen = sizeof(struct spdk_nvme_tcp_cmd) + length;
+	pdu_in_progress.req = &tcp_req;
+
+	/* zcopy_start succeeds: the payload is received straight into the zcopy buffers */
+	tcp_req.state = TCP_REQUEST_STATE_NEED_BUFFER;
+	tqpair.state_cntr[TCP_REQUEST_STATE_NEED_BUFFER] = 1;
+	TAILQ_INSERT_TAIL(&tqpair.tcp_req_working_queue, &tcp_req, state_link);
+	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PSH;
+
+	nvmf_tcp_req_parse_sgl(&tcp_req, &ttransport.transport, &tcp_group.group);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_HAVE_BUFFER);
+	CU_ASSERT(tqpair.recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_BUF);
+	CU_ASSERT(tcp_req.req.zcopy_phase == NVMF_ZCOPY_PHASE_INIT);
+	CU_ASSERT(tcp_req.req.length == length);
+	CU_ASSERT(tcp_req.req.data_from_pool == false);
+
+	/* Complete zcopy_start as the bdev layer would */
+	nvmf_tcp_req_set_state(&tcp_req, TCP_REQUEST_STATE_ZCOPY_START_COMPLETED);
+	tcp_req.req.zcopy_phase = NVMF_ZCOPY_PHASE_EXECUTE;
+	tcp_req.req.iov[0].iov_base = zcopy_buf;
+	tcp_req.req.iov[0].iov_len = length;
+	tcp_req.req.iovcnt = 1;
+
+	nvmf_tcp_req_process(&ttransport, &tcp_req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER);
+	CU_ASSERT(tqpair.recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PAYLOAD);
+	CU_ASSERT(pdu_in_progress.data_iovcnt == 1);
+	CU_ASSERT(pdu_in_progress.data_iov[0].iov_base == zcopy_buf);
+	CU_ASSERT(pdu_in_progress.data_iov[0].iov_len == length);
+	CU_ASSERT(pdu_in_progress.data_len == length);
+
+	/* Once the payload is received, the buffers are committed */
+	nvmf_tcp_capsule_cmd_payload_handle(&ttransport, &tqpair, &pdu_in_progress);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_COMMIT);
+	CU_ASSERT(tcp_req.req.zcopy_phase == NVMF_ZCOPY_PHASE_END_PENDING);
+
+	/* zcopy_start fails: the payload is drained into the request's own buffer */
+	TAILQ_REMOVE(&tqpair.tcp_req_working_queue, &tcp_req, state_link);
+	memset(tqpair.state_cntr, 0, sizeof(tqpair.state_cntr));
+	memset(&pdu_in_progress.data_iov, 0, sizeof(pdu_in_progress.data_iov));
+	memset(&rsp, 0, sizeof(rsp));
+	tcp_req.req.zcopy_phase = NVMF_ZCOPY_PHASE_NONE;
+	tcp_req.state = TCP_REQUEST_STATE_NEED_BUFFER;
+	tqpair.state_cntr[TCP_REQUEST_STATE_NEED_BUFFER] = 1;
+	TAILQ_INSERT_TAIL(&tqpair.tcp_req_working_queue, &tcp_req, state_link);
+	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PSH;
+
+	nvmf_tcp_req_parse_sgl(&tcp_req, &ttransport.transport, &tcp_group.group);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_HAVE_BUFFER);
+	CU_ASSERT(tqpair.recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_BUF);
+	CU_ASSERT(tcp_req.req.zcopy_phase == NVMF_ZCOPY_PHASE_INIT);
+
+	nvmf_tcp_req_set_state(&tcp_req, TCP_REQUEST_STATE_ZCOPY_START_COMPLETED);
+	tcp_req.req.zcopy_phase = NVMF_ZCOPY_PHASE_INIT_FAILED;
+	tcp_req.req.iovcnt = 0;
+	rsp.nvme_cpl.status.sct = SPDK_NVME_SCT_GENERIC;
+	rsp.nvme_cpl.status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+
+	nvmf_tcp_req_process(&ttransport, &tcp_req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER);
+	CU_ASSERT(tqpair.recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PAYLOAD);
+	CU_ASSERT(pdu_in_progress.data_iovcnt == 1);
+	CU_ASSERT(pdu_in_progress.data_iov[0].iov_base == icd_buf);
+	CU_ASSERT(pdu_in_progress.data_iov[0].iov_len == length);
+
+	/* Once the payload is drained, the request is completed with the error */
+	nvmf_tcp_capsule_cmd_payload_handle(&ttransport, &tqpair, &pdu_in_progress);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST);
+	CU_ASSERT(rsp_pdu.hdr.capsule_resp.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_CAPSULE_RESP);
+	CU_ASSERT(rsp_pdu.hdr.capsule_resp.rccqe.status.sc == SPDK_NVME_SC_INTERNAL_DEVICE_ERROR);
+
+	spdk_bit_array_free(&ctrlr.visible_ns);
+}
+
 static void
 test_nvmf_tcp_qpair_init_mem_resource(void)
 {
@@ -1522,6 +1686,89 @@ test_nvmf_tcp_tls_generate_tls_psk(void)
 					  NVME_TCP_CIPHER_AES_128_GCM_SHA256) < 0);
 }
 
+static void
+test_nvmf_tcp_get_least_loaded_poll_group(void)
+{
+	struct spdk_nvmf_tcp_transport ttransport = {};
+	struct spdk_nvmf_tcp_poll_group tgroups[3] = {};
+	struct spdk_nvmf_poll_group groups[3] = {};
+	int i;
+
+	TAILQ_INIT(&ttransport.poll_groups);
+	for (i = 0; i < 3; i++) {
+		pthread_mutex_init(&groups[i].mutex, NULL);
+		tgroups[i].group.group = &groups[i];
+		TAILQ_INSERT_TAIL(&ttransport.poll_groups, &tgroups[i], link);
+	}
+	ttransport.next_pg = &tgroups[0];
+
+	/* Idle poll groups with equal load: the search starts from next_pg */
+	CU_ASSERT(nvmf_tcp_get_least_loaded_poll_group(&ttransport) == &tgroups[0]);
+	ttransport.next_pg = &tgroups[2];
+	CU_ASSERT(nvmf_tcp_get_least_loaded_poll_group(&ttransport) == &tgroups[2]);
+
+	/* The poll group with the lowest command rate is picked */
+	tgroups[0].load.rate = 300;
+	tgroups[1].load.rate = 100;
+	tgroups[2].load.rate = 200;
+	for (i = 0; i < 3; i++) {
+		groups[i].stat.current_io_qpairs = 2;
+	}
+	CU_ASSERT(nvmf_tcp_get_least_loaded_poll_group(&ttransport) == &tgroups[1]);
+
+	/* Qpairs not yet associated count as an average qpair's load (600 / 6 = 100) */
+	groups[1].current_unassociated_qpairs = 2;
+	CU_ASSERT(nvmf_tcp_get_least_loaded_poll_group(&ttransport) == &tgroups[2]);
+
+	for (i = 0; i < 3; i++) {
+		pthread_mutex_destroy(&groups[i].mutex);
+	}
+}
+
+static void
+test_nvmf_tcp_pdu_stream_data_digest(void)
+{
+	struct nvme_tcp_pdu pdu = {};
+	uint8_t buf1[1000], buf2[2001];
+	uint32_t crc32c;
+	size_t i;
+
+	for (i = 0; i < sizeof(buf1); i++) {
+		buf1[i] = i;
+	}
+	for (i = 0; i < sizeof(buf2); i++) {
+		buf2[i] = i * 7;
+	}
+
+	pdu.data_iov[0].iov_base = buf1;
+	pdu.data_iov[0].iov_len = sizeof(buf1);
+	pdu.data_iov[1].iov_base = buf2;
+	pdu.data_iov[1].iov_len = sizeof(buf2);
+	pdu.data_iovcnt = 2;
+	pdu.data_len = sizeof(buf1) + sizeof(buf2);
+	crc32c = nvme_tcp_pdu_calc_data_digest(&pdu);
+
+	/* Nothing received yet */
+	nvmf_tcp_pdu_stream_data_digest(&pdu);
+	CU_ASSERT(pdu.ddgst_offset == 0);
+
+	/* Segments ending inside the first iov, across both iovs and inside the digest */
+	pdu.rw_offset = 500;
+	nvmf_tcp_pdu_stream_data_digest(&pdu);
+	CU_ASSERT(pdu.ddgst_offset == 500);
+	pdu.rw_offset = 1500;
+	nvmf_tcp_pdu_stream_data_digest(&pdu);
+	CU_ASSERT(pdu.ddgst_offset == 1500);
+	pdu.rw_offset = pdu.data_len + 2;
+	nvmf_tcp_pdu_stream_data_digest(&pdu);
+	CU_ASSERT(pdu.ddgst_offset == pdu.data_len);
+	pdu.rw_offset = pdu.data_len + SPDK_NVME_TCP_DIGEST_LEN;
+	nvmf_tcp_pdu_stream_data_digest(&pdu);
+	CU_ASSERT(pdu.ddgst_offset == pdu.data_len);
+
+	CU_ASSERT(nvme_tcp_pdu_pad_data_digest(&pdu, pdu.data_digest_crc32) == crc32c);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1538,6 +1785,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvmf_tcp_send_c2h_data);
 	CU_ADD_TEST(suite, test_nvmf_tcp_h2c_data_hdr_handle);
 	CU_ADD_TEST(suite, test_nvmf_tcp_in_capsule_data_handle);
+	CU_ADD_TEST(suite, test_nvmf_tcp_in_capsule_data_zcopy);
 	CU_ADD_TEST(suite, test_nvmf_tcp_qpair_init_mem_resource);
 	CU_ADD_TEST(suite, test_nvmf_tcp_send_c2h_term_req);
 	CU_ADD_TEST(suite, test_nvmf_tcp_send_capsule_resp_pdu);
@@ -1549,6 +1797,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvmf_tcp_tls_generate_psk_id);
 	CU_ADD_TEST(suite, test_nvmf_tcp_tls_generate_retained_psk);
 	CU_ADD_TEST(suite, test_nvmf_tcp_tls_generate_tls_psk);
+	CU_ADD_TEST(suite, test_nvmf_tcp_get_least_loaded_poll_group);
+	CU_ADD_TEST(suite, test_nvmf_tcp_pdu_stream_data_digest);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
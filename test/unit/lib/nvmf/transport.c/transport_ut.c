@@ -380,6 +380,155 @@ test_spdk_nvmf_transport_listen_ext(void)
 	CU_ASSERT(rc == 0);
 }
 
+static void
+test_nvmf_transport_host_stats(void)
+{
+	struct spdk_nvmf_transport transport = {};
+	struct nvmf_transport_host_stats *stats1, *stats2;
+	int i;
+
+	pthread_mutex_init(&transport.mutex, NULL);
+	TAILQ_INIT(&transport.host_stats);
+
+	/* Controllers of the same host share the stats */
+	stats1 = nvmf_transport_get_host_stats(&transport, "nqn.2016-06.io.spdk:host1");
+	SPDK_CU_ASSERT_FATAL(stats1 != NULL);
+	CU_ASSERT(strcmp(stats1->hostnqn, "nqn.2016-06.io.spdk:host1") == 0);
+	CU_ASSERT(nvmf_transport_get_host_stats(&transport, "nqn.2016-06.io.spdk:host1") == stats1);
+	stats2 = nvmf_transport_get_host_stats(&transport, "nqn.2016-06.io.spdk:host2");
+	SPDK_CU_ASSERT_FATAL(stats2 != NULL);
+	CU_ASSERT(stats2 != stats1);
+
+	/* Bucket boundaries */
+	nvmf_transport_host_stats_record(stats1, 1);
+	nvmf_transport_host_stats_record(stats1, 512);
+	CU_ASSERT(stats1->write_size_hist[0] == 2);
+	nvmf_transport_host_stats_record(stats1, 513);
+	nvmf_transport_host_stats_record(stats1, 1024);
+	CU_ASSERT(stats1->write_size_hist[1] == 2);
+	nvmf_transport_host_stats_record(stats1, 1025);
+	CU_ASSERT(stats1->write_size_hist[2] == 1);
+	nvmf_transport_host_stats_record(stats1, 65536);
+	CU_ASSERT(stats1->write_size_hist[7] == 1);
+	nvmf_transport_host_stats_record(stats1, 65537);
+	nvmf_transport_host_stats_record(stats1, 1024 * 1024);
+	CU_ASSERT(stats1->write_size_hist[NVMF_HOST_IO_STATS_NUM_BUCKETS - 1] == 2);
+	for (i = 0; i < NVMF_HOST_IO_STATS_NUM_BUCKETS; i++) {
+		CU_ASSERT(stats2->write_size_hist[i] == 0);
+	}
+
+	/* No transfers, or mostly larger than the last bucket */
+	CU_ASSERT(nvmf_transport_host_stats_get_icd(stats2->write_size_hist) == 0);
+	CU_ASSERT(nvmf_transport_host_stats_get_icd(stats1->write_size_hist) == 0);
+
+	/* 90% of the transfers are 4 KiB or less */
+	memset(stats2->write_size_hist, 0, sizeof(stats2->write_size_hist));
+	stats2->write_size_hist[0] = 10;
+	stats2->write_size_hist[3] = 80;
+	stats2->write_size_hist[7] = 10;
+	CU_ASSERT(nvmf_transport_host_stats_get_icd(stats2->write_size_hist) == 4096);
+
+	free(stats1);
+	free(stats2);
+	pthread_mutex_destroy(&transport.mutex);
+}
+
+static void
+test_nvmf_transport_host_admission(void)
+{
+	struct spdk_nvmf_transport transport = {};
+	struct nvmf_transport_host_admission *admission1, *admission2;
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvmf_request req = {};
+	union nvmf_h2c_msg cmd = {};
+	union nvmf_c2h_msg rsp = {};
+	int i;
+
+	pthread_mutex_init(&transport.mutex, NULL);
+	TAILQ_INIT(&transport.host_admission);
+	/* 1 tick per us, so one command every 1000 ticks */
+	transport.opts.host_max_iops = 1000;
+	transport.opts.host_max_burst = 4;
+
+	/* Controllers of the same host share the limit */
+	admission1 = nvmf_transport_get_host_admission(&transport, "nqn.2016-06.io.spdk:host1");
+	SPDK_CU_ASSERT_FATAL(admission1 != NULL);
+	CU_ASSERT(strcmp(admission1->hostnqn, "nqn.2016-06.io.spdk:host1") == 0);
+	CU_ASSERT(admission1->interval == 1000);
+	CU_ASSERT(admission1->tolerance == 4000);
+	CU_ASSERT(nvmf_transport_get_host_admission(&transport,
+			"nqn.2016-06.io.spdk:host1") == admission1);
+	admission2 = nvmf_transport_get_host_admission(&transport, "nqn.2016-06.io.spdk:host2");
+	SPDK_CU_ASSERT_FATAL(admission2 != NULL);
+	CU_ASSERT(admission2 != admission1);
+
+	/* The burst gets in at once, then one command per interval */
+	for (i = 0; i < 4; i++) {
+		CU_ASSERT(nvmf_transport_host_admit(admission1, 10000));
+	}
+	CU_ASSERT(!nvmf_transport_host_admit(admission1, 10000));
+	CU_ASSERT(!nvmf_transport_host_admit(admission1, 10999));
+	CU_ASSERT(nvmf_transport_host_admit(admission1, 11000));
+	CU_ASSERT(!nvmf_transport_host_admit(admission1, 11000));
+
+	/* Other hosts aren't affected */
+	CU_ASSERT(nvmf_transport_host_admit(admission2, 11000));
+
+	/* An idle host gets its whole burst back, but not more */
+	for (i = 0; i < 4; i++) {
+		CU_ASSERT(nvmf_transport_host_admit(admission1, 100000));
+	}
+	CU_ASSERT(!nvmf_transport_host_admit(admission1, 100000));
+
+	/* Default burst is a tenth of the limit */
+	transport.opts.host_max_burst = 0;
+	admission2 = nvmf_transport_get_host_admission(&transport, "nqn.2016-06.io.spdk:host3");
+	SPDK_CU_ASSERT_FATAL(admission2 != NULL);
+	CU_ASSERT(admission2->tolerance == 100 * 1000);
+
+	/* Commands over the limit are completed with a retryable status */
+	qpair.ctrlr = &ctrlr;
+	qpair.group = &group;
+	qpair.qid = 1;
+	req.qpair = &qpair;
+	req.cmd = &cmd;
+	req.rsp = &rsp;
+	cmd.nvme_cmd.cid = 7;
+	ctrlr.acre_enabled = true;
+
+	CU_ASSERT(nvmf_transport_req_admit(&req));
+	ctrlr.host_admission = admission1;
+	MOCK_SET(spdk_get_ticks, 100000);
+	CU_ASSERT(!nvmf_transport_req_admit(&req));
+	CU_ASSERT(rsp.nvme_cpl.cid == 7);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_NAMESPACE_NOT_READY);
+	CU_ASSERT(rsp.nvme_cpl.status.dnr == 0);
+	CU_ASSERT(rsp.nvme_cpl.status.crd == 1);
+	CU_ASSERT(group.stat.rejected_nvme_io == 1);
+
+	/* Admin and fused commands are always let in */
+	cmd.nvme_cmd.fuse = SPDK_NVME_CMD_FUSE_FIRST;
+	CU_ASSERT(nvmf_transport_req_admit(&req));
+	cmd.nvme_cmd.fuse = SPDK_NVME_CMD_FUSE_NONE;
+	qpair.qid = 0;
+	CU_ASSERT(nvmf_transport_req_admit(&req));
+	CU_ASSERT(group.stat.rejected_nvme_io == 1);
+
+	qpair.qid = 1;
+	MOCK_SET(spdk_get_ticks, 101000);
+	CU_ASSERT(nvmf_transport_req_admit(&req));
+	MOCK_CLEAR(spdk_get_ticks);
+
+	TAILQ_FOREACH_SAFE(admission1, &transport.host_admission, link, admission2) {
+		TAILQ_REMOVE(&transport.host_admission, admission1, link);
+		free(admission1);
+	}
+	pthread_mutex_destroy(&transport.mutex);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -394,6 +543,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvmf_transport_poll_group_create);
 	CU_ADD_TEST(suite, test_spdk_nvmf_transport_opts_init);
 	CU_ADD_TEST(suite, test_spdk_nvmf_transport_listen_ext);
+	CU_ADD_TEST(suite, test_nvmf_transport_host_stats);
+	CU_ADD_TEST(suite, test_nvmf_transport_host_admission);
 
 	allocate_threads(1);
 	set_thread(0);
@@ -247,6 +247,150 @@ test_nvmf_vfio_user_create_destroy(void)
 	CU_ASSERT(done == 1);
 }
 
+static void
+test_nvmf_vfio_user_migr_data(void)
+{
+	struct nvmf_vfio_user_endpoint src = {}, dst = {};
+	struct nvmf_vfio_user_ctrlr vu_ctrlr = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct nvmf_vfio_user_sq sq = {};
+	struct nvmf_vfio_user_cq cq = {};
+	struct vfio_user_nvme_migr_header *hdr;
+	struct vfio_user_nvme_migr_state *migr_state;
+	uint32_t doorbells[NVMF_VFIO_USER_DOORBELLS_SIZE / sizeof(uint32_t)] = {};
+	uint8_t *cfg;
+	uint64_t len;
+
+	src.migr_data = calloc(1, vfio_user_migr_data_len());
+	dst.migr_data = calloc(1, vfio_user_migr_data_len());
+	cfg = calloc(1, NVME_REG_CFG_SIZE);
+	migr_state = calloc(1, sizeof(*migr_state));
+	SPDK_CU_ASSERT_FATAL(src.migr_data != NULL && dst.migr_data != NULL);
+	SPDK_CU_ASSERT_FATAL(cfg != NULL && migr_state != NULL);
+
+	/* Source controller with only the admin queue */
+	memset(cfg, 0xA5, NVME_REG_CFG_SIZE);
+	src.pci_config_space = (vfu_pci_config_space_t *)cfg;
+	doorbells[0] = 5;
+	vu_ctrlr.bar0_doorbells = doorbells;
+	vu_ctrlr.endpoint = &src;
+	vu_ctrlr.ctrlr = &ctrlr;
+	TAILQ_INIT(&vu_ctrlr.connected_sqs);
+	sq.size = 32;
+	sq.head = 3;
+	cq.size = 32;
+	cq.tail = 4;
+	vu_ctrlr.sqs[0] = &sq;
+	vu_ctrlr.cqs[0] = &cq;
+	TAILQ_INSERT_TAIL(&vu_ctrlr.connected_sqs, &sq, tailq);
+
+	/* Only the used part of the region is transferred */
+	vfio_user_migr_ctrlr_save_data(&vu_ctrlr);
+	len = sizeof(struct vfio_user_nvme_migr_header) + sizeof(struct spdk_nvmf_ctrlr_migr_data) +
+	      sizeof(struct nvme_migr_sq_state) + sizeof(struct nvme_migr_cq_state) +
+	      NVMF_VFIO_USER_DOORBELLS_SIZE + NVME_REG_CFG_SIZE;
+	CU_ASSERT(src.migr_data_len == len);
+	CU_ASSERT(len < vfio_user_migr_data_len());
+
+	/* The destination accepts it as long as it holds everything the header points to */
+	memcpy(dst.migr_data, src.migr_data, len);
+	CU_ASSERT(vfio_user_migr_data_check(&dst, len) == 0);
+	CU_ASSERT(vfio_user_migr_data_check(&dst, vfio_user_migr_data_len()) == 0);
+	CU_ASSERT(vfio_user_migr_data_check(&dst, len - 1) == -EINVAL);
+	CU_ASSERT(vfio_user_migr_data_check(&dst, sizeof(struct vfio_user_nvme_migr_header) - 1) ==
+		  -EINVAL);
+	CU_ASSERT(vfio_user_migr_data_check(&dst, vfio_user_migr_data_len() + 1) == -EINVAL);
+
+	hdr = dst.migr_data;
+	hdr->qp_len = sizeof(migr_state->qps) + 1;
+	CU_ASSERT(vfio_user_migr_data_check(&dst, vfio_user_migr_data_len()) == -EINVAL);
+	hdr->qp_len = sizeof(struct nvme_migr_sq_state) + sizeof(struct nvme_migr_cq_state);
+	hdr->nvmf_data_offset = 0;
+	CU_ASSERT(vfio_user_migr_data_check(&dst, len) == -EINVAL);
+	hdr->nvmf_data_offset = sizeof(struct vfio_user_nvme_migr_header);
+	hdr->magic = 0;
+	CU_ASSERT(vfio_user_migr_data_check(&dst, len) == -EINVAL);
+	hdr->magic = VFIO_USER_NVME_MIGR_MAGIC;
+
+	dst.migr_data_len = len;
+	CU_ASSERT(vfio_user_migr_stream_to_data(&dst, migr_state) == 0);
+	CU_ASSERT(migr_state->ctrlr_header.num_io_queues == 0);
+	CU_ASSERT(migr_state->qps[0].sq.size == 32);
+	CU_ASSERT(migr_state->qps[0].sq.head == 3);
+	CU_ASSERT(migr_state->qps[0].cq.tail == 4);
+	CU_ASSERT(((uint32_t *)migr_state->doorbells)[0] == 5);
+	CU_ASSERT(memcmp(migr_state->cfg, cfg, NVME_REG_CFG_SIZE) == 0);
+
+	free(migr_state);
+	free(cfg);
+	free(dst.migr_data);
+	free(src.migr_data);
+}
+
+static void
+test_nvmf_vfio_user_poll_group_poll(void)
+{
+	struct nvmf_vfio_user_poll_group vu_group = {};
+	struct nvmf_vfio_user_endpoint endpoint = {};
+	struct nvmf_vfio_user_ctrlr vu_ctrlr = {};
+	struct nvmf_vfio_user_sq sq = {};
+	struct nvmf_vfio_user_cq cq = {};
+	uint32_t sq_tail = 0, cq_head = 0;
+	uint8_t *cfg;
+	int rc;
+
+	cfg = calloc(1, NVME_REG_CFG_SIZE);
+	SPDK_CU_ASSERT_FATAL(cfg != NULL);
+
+	endpoint.pci_config_space = (vfu_pci_config_space_t *)cfg;
+	vu_ctrlr.endpoint = &endpoint;
+	vu_ctrlr.state = VFIO_USER_CTRLR_RUNNING;
+	vu_ctrlr.cqs[1] = &cq;
+
+	sq.ctrlr = &vu_ctrlr;
+	sq.qid = 1;
+	sq.cqid = 1;
+	sq.size = 32;
+	sq.sq_state = VFIO_USER_SQ_ACTIVE;
+	sq.dbl_tailp = &sq_tail;
+	cq.qid = 1;
+	cq.ien = true;
+	cq.dbl_headp = &cq_head;
+
+	TAILQ_INIT(&vu_group.sqs);
+	TAILQ_INSERT_TAIL(&vu_group.sqs, &sq, link);
+
+	/* The doorbell matches the head, the SQ is skipped */
+	sq.head = 3;
+	sq_tail = 3;
+	CU_ASSERT(!sq_has_new_cmds(&sq));
+	rc = nvmf_vfio_user_poll_group_poll(&vu_group.group);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(vu_group.stats.polls == 1);
+	CU_ASSERT(vu_group.stats.polls_spurious == 1);
+
+	/* Only the low 16 bits of the doorbell are compared */
+	sq_tail = 0x10003;
+	CU_ASSERT(!sq_has_new_cmds(&sq));
+
+	/* A moved doorbell is polled, an invalid value fails the poll */
+	sq_tail = 40;
+	CU_ASSERT(sq_has_new_cmds(&sq));
+	rc = nvmf_vfio_user_poll_group_poll(&vu_group.group);
+	CU_ASSERT(rc == -1);
+
+	/* Idle SQs of controllers with adaptive IRQs are still polled */
+	sq_tail = 3;
+	cq.tail = 5;
+	cq_head = 5;
+	vu_ctrlr.adaptive_irqs_enabled = true;
+	rc = nvmf_vfio_user_poll_group_poll(&vu_group.group);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cq.last_head == 5);
+
+	free(cfg);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -260,6 +404,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_cmd_map_prps);
 	CU_ADD_TEST(suite, test_nvme_cmd_map_sgls);
 	CU_ADD_TEST(suite, test_nvmf_vfio_user_create_destroy);
+	CU_ADD_TEST(suite, test_nvmf_vfio_user_migr_data);
+	CU_ADD_TEST(suite, test_nvmf_vfio_user_poll_group_poll);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
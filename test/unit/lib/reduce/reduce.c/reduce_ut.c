@@ -67,6 +67,7 @@ static TAILQ_HEAD(, ut_reduce_bdev_io) g_pending_bdev_io =
 	TAILQ_HEAD_INITIALIZER(g_pending_bdev_io);
 static uint32_t g_pending_bdev_io_count = 0;
 static struct spdk_thread *g_thread = NULL;
+static int g_pm_is_pmem = 1;
 
 static void
 sync_pm_buf(const void *addr, size_t length)
@@ -133,7 +134,7 @@ pmem_map_file(const char *path, size_t len, int flags, mode_t mode,
 {
 	CU_ASSERT(g_volatile_pm_buf == NULL);
 	snprintf(g_path, sizeof(g_path), "%s", path);
-	*is_pmemp = 1;
+	*is_pmemp = g_pm_is_pmem;
 
 	if (g_persistent_pm_buf == NULL) {
 		g_persistent_pm_buf = calloc(1, len);
@@ -998,6 +999,214 @@ _read_write(uint32_t backing_blocklen)
 	backing_dev_destroy(&backing_dev);
 }
 
+static void
+count_cb(void *arg, int reduce_errno)
+{
+	uint32_t *count = arg;
+
+	CU_ASSERT(reduce_errno == 0);
+	(*count)++;
+}
+
+static uint64_t
+_persistent_chunk_map_index(struct spdk_reduce_vol *vol, uint64_t logical_map_index)
+{
+	uint64_t offset = (char *)&vol->pm_logical_map[logical_map_index] - g_volatile_pm_buf;
+
+	return *(uint64_t *)&g_persistent_pm_buf[offset];
+}
+
+static void
+write_persist_batch(void)
+{
+	struct spdk_reduce_vol_params params = {};
+	struct spdk_reduce_backing_dev backing_dev = {};
+	struct iovec iov;
+	const int bufsize = 16 * 1024; /* chunk size */
+	char buf[bufsize];
+	uint32_t num_lbas, i, count;
+	uint64_t old_chunk0_map_index;
+
+	params.chunk_size = bufsize;
+	params.backing_io_unit_size = 4096;
+	params.logical_block_size = 512;
+	num_lbas = bufsize / params.logical_block_size;
+	spdk_uuid_generate(&params.uuid);
+
+	/* The pm file is not on persistent memory, so the map updates are batched */
+	g_pm_is_pmem = 0;
+	backing_dev_init(&backing_dev, &params, 512);
+
+	g_vol = NULL;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_init(&params, &backing_dev, TEST_MD_PATH, init_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	SPDK_CU_ASSERT_FATAL(g_vol != NULL);
+
+	ut_build_data_buffer(buf, bufsize, 0x00, 1);
+	iov.iov_base = buf;
+	iov.iov_len = bufsize;
+	count = 0;
+	for (i = 0; i < 3; i++) {
+		spdk_reduce_vol_writev(g_vol, &iov, 1, i * num_lbas, num_lbas, count_cb, &count);
+	}
+
+	/* The writes complete only once their map updates are persisted together */
+	CU_ASSERT(count == 0);
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(g_vol->pm_logical_map[i] == REDUCE_EMPTY_MAP_ENTRY);
+		CU_ASSERT(_persistent_chunk_map_index(g_vol, i) == REDUCE_EMPTY_MAP_ENTRY);
+	}
+	spdk_thread_poll(g_thread, 0, 0);
+	CU_ASSERT(count == 3);
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(g_vol->pm_logical_map[i] != REDUCE_EMPTY_MAP_ENTRY);
+		CU_ASSERT(_persistent_chunk_map_index(g_vol, i) == g_vol->pm_logical_map[i]);
+	}
+	CU_ASSERT(TAILQ_EMPTY(&g_vol->persist_requests));
+
+	/* The replaced chunk map is released only after the new one is persisted */
+	old_chunk0_map_index = g_vol->pm_logical_map[0];
+	spdk_reduce_vol_writev(g_vol, &iov, 1, 0, num_lbas, count_cb, &count);
+	CU_ASSERT(count == 3);
+	CU_ASSERT(spdk_bit_array_get(g_vol->allocated_chunk_maps, old_chunk0_map_index) == true);
+	spdk_thread_poll(g_thread, 0, 0);
+	CU_ASSERT(count == 4);
+	CU_ASSERT(spdk_bit_array_get(g_vol->allocated_chunk_maps, old_chunk0_map_index) == false);
+	CU_ASSERT(_persistent_chunk_map_index(g_vol, 0) != old_chunk0_map_index);
+	CU_ASSERT(_persistent_chunk_map_index(g_vol, 0) == g_vol->pm_logical_map[0]);
+
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unload(g_vol, unload_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	g_pm_is_pmem = 1;
+	persistent_pm_buf_destroy();
+	backing_dev_destroy(&backing_dev);
+}
+
+static void
+ut_write_chunk(uint64_t chunk, char *buf, uint32_t bufsize, uint32_t repeat)
+{
+	struct iovec iov = { .iov_base = buf, .iov_len = bufsize };
+	uint32_t num_lbas = bufsize / g_vol->params.logical_block_size;
+
+	ut_build_data_buffer(buf, bufsize, chunk, repeat);
+	g_reduce_errno = -1;
+	spdk_reduce_vol_writev(g_vol, &iov, 1, chunk * num_lbas, num_lbas, write_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+}
+
+static void
+ut_verify_chunk(uint64_t chunk, char *buf, uint32_t bufsize, uint32_t repeat)
+{
+	char compare_buf[16 * 1024];
+	struct iovec iov = { .iov_base = buf, .iov_len = bufsize };
+	uint32_t num_lbas = bufsize / g_vol->params.logical_block_size;
+
+	SPDK_CU_ASSERT_FATAL(bufsize <= sizeof(compare_buf));
+	ut_build_data_buffer(compare_buf, bufsize, chunk, repeat);
+	memset(buf, 0xFF, bufsize);
+	g_reduce_errno = -1;
+	spdk_reduce_vol_readv(g_vol, &iov, 1, chunk * num_lbas, num_lbas, read_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	CU_ASSERT(memcmp(buf, compare_buf, bufsize) == 0);
+}
+
+static void
+write_packed_chunks(void)
+{
+	struct spdk_reduce_vol_params params = {};
+	struct spdk_reduce_backing_dev backing_dev = {};
+	const int bufsize = 16 * 1024; /* chunk size */
+	char buf[bufsize];
+	struct spdk_reduce_chunk_map *chunk[3];
+	uint64_t shared_io_unit, allocated_io_units;
+	uint32_t i;
+
+	params.chunk_size = bufsize;
+	params.backing_io_unit_size = 4096;
+	params.logical_block_size = 512;
+	params.pack_chunks = 1;
+	spdk_uuid_generate(&params.uuid);
+
+	/* 8 backing blocks per io unit */
+	backing_dev_init(&backing_dev, &params, 512);
+
+	g_vol = NULL;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_init(&params, &backing_dev, TEST_MD_PATH, init_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	SPDK_CU_ASSERT_FATAL(g_vol != NULL);
+	allocated_io_units = spdk_reduce_vol_get_info(g_vol)->allocated_io_units;
+
+	/*
+	 * Chunks 0 and 1 compress to 1KB, 2 backing blocks, and share one io unit.  Chunk 2
+	 *  compresses to one full io unit plus 5 backing blocks, which do not fit in the rest
+	 *  of the shared io unit, so its tail starts another one.
+	 */
+	ut_write_chunk(0, buf, bufsize, 32);
+	ut_write_chunk(1, buf, bufsize, 32);
+	ut_write_chunk(2, buf, bufsize, 5);
+	for (i = 0; i < 3; i++) {
+		chunk[i] = _reduce_vol_get_chunk_map(g_vol, g_vol->pm_logical_map[i]);
+	}
+	CU_ASSERT(chunk[0]->compressed_size == 1024);
+	CU_ASSERT(chunk[0]->tail == (REDUCE_CHUNK_TAIL_PACKED | 0));
+	CU_ASSERT(chunk[1]->tail == (REDUCE_CHUNK_TAIL_PACKED | 2));
+	CU_ASSERT(chunk[0]->io_unit_index[0] == chunk[1]->io_unit_index[0]);
+	CU_ASSERT(chunk[2]->tail == (REDUCE_CHUNK_TAIL_PACKED | 0));
+	CU_ASSERT(chunk[2]->io_unit_index[1] != chunk[0]->io_unit_index[0]);
+	CU_ASSERT(chunk[2]->io_unit_index[1] == g_vol->pack_io_unit);
+	shared_io_unit = chunk[0]->io_unit_index[0];
+	CU_ASSERT(g_vol->io_unit_tails[shared_io_unit] == 2);
+	CU_ASSERT(spdk_reduce_vol_get_info(g_vol)->allocated_io_units == allocated_io_units + 3);
+
+	for (i = 0; i < 3; i++) {
+		ut_verify_chunk(i, buf, bufsize, i == 2 ? 5 : 32);
+	}
+
+	/* The shared io unit is freed once both of its chunks are overwritten */
+	ut_write_chunk(0, buf, bufsize, 32);
+	CU_ASSERT(g_vol->io_unit_tails[shared_io_unit] == 1);
+	CU_ASSERT(spdk_bit_array_get(g_vol->allocated_backing_io_units, shared_io_unit) == true);
+	ut_write_chunk(1, buf, bufsize, 32);
+	CU_ASSERT(g_vol->io_unit_tails[shared_io_unit] == 0);
+	CU_ASSERT(spdk_bit_array_get(g_vol->allocated_backing_io_units, shared_io_unit) == false);
+	/* Chunk 0 was packed after the tail of chunk 2, chunk 1 did not fit anymore */
+	CU_ASSERT(g_vol->io_unit_tails[chunk[2]->io_unit_index[1]] == 2);
+	CU_ASSERT(g_vol->io_unit_tails[g_vol->pack_io_unit] == 1);
+	CU_ASSERT(spdk_reduce_vol_get_info(g_vol)->allocated_io_units == allocated_io_units + 3);
+	allocated_io_units = spdk_reduce_vol_get_info(g_vol)->allocated_io_units;
+
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unload(g_vol, unload_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	/* The shared io units are accounted once after reloading */
+	g_vol = NULL;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_load(&backing_dev, load_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	SPDK_CU_ASSERT_FATAL(g_vol != NULL);
+	CU_ASSERT(g_vol->params.pack_chunks == 1);
+	CU_ASSERT(spdk_reduce_vol_get_info(g_vol)->allocated_io_units == allocated_io_units);
+	chunk[2] = _reduce_vol_get_chunk_map(g_vol, g_vol->pm_logical_map[2]);
+	CU_ASSERT(g_vol->io_unit_tails[chunk[2]->io_unit_index[1]] == 2);
+	CU_ASSERT(g_vol->pack_io_unit == REDUCE_EMPTY_MAP_ENTRY);
+
+	for (i = 0; i < 3; i++) {
+		ut_verify_chunk(i, buf, bufsize, i == 2 ? 5 : 32);
+	}
+
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unload(g_vol, unload_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	persistent_pm_buf_destroy();
+	backing_dev_destroy(&backing_dev);
+}
+
 static void
 read_write(void)
 {
@@ -1346,6 +1555,190 @@ overlapped(void)
 
 #define BUFSIZE 4096
 
+static void
+overlapped_reads(void)
+{
+	struct spdk_reduce_vol_params params = {};
+	struct spdk_reduce_backing_dev backing_dev = {};
+	const uint32_t logical_block_size = 512;
+	struct iovec iov, read_iov[3], write_iov;
+	char buf[16 * 1024];
+	char read_buf[3][logical_block_size];
+	char write_buf[logical_block_size];
+	char compare_buf[logical_block_size];
+	uint32_t reads = 0, writes = 0;
+
+	params.chunk_size = 16 * 1024;
+	params.backing_io_unit_size = 4096;
+	params.logical_block_size = logical_block_size;
+	spdk_uuid_generate(&params.uuid);
+
+	backing_dev_init(&backing_dev, &params, 512);
+
+	g_vol = NULL;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_init(&params, &backing_dev, TEST_MD_PATH, init_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	SPDK_CU_ASSERT_FATAL(g_vol != NULL);
+
+	/* Fill the first chunk with 0xAA, it compresses to a single io unit. */
+	memset(buf, 0xAA, sizeof(buf));
+	iov.iov_base = buf;
+	iov.iov_len = sizeof(buf);
+	g_reduce_errno = -1;
+	spdk_reduce_vol_writev(g_vol, &iov, 1, 0, sizeof(buf) / logical_block_size, write_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	g_defer_bdev_io = true;
+
+	/* Reads of the same chunk execute together. */
+	read_iov[0].iov_base = read_buf[0];
+	read_iov[0].iov_len = logical_block_size;
+	spdk_reduce_vol_readv(g_vol, &read_iov[0], 1, 0, 1, count_cb, &reads);
+	CU_ASSERT(g_pending_bdev_io_count == 1);
+	read_iov[1].iov_base = read_buf[1];
+	read_iov[1].iov_len = logical_block_size;
+	spdk_reduce_vol_readv(g_vol, &read_iov[1], 1, 1, 1, count_cb, &reads);
+	CU_ASSERT(g_pending_bdev_io_count == 2);
+
+	/* A write waits for the reads, and a later read waits for the write. */
+	memset(write_buf, 0xBB, sizeof(write_buf));
+	write_iov.iov_base = write_buf;
+	write_iov.iov_len = logical_block_size;
+	spdk_reduce_vol_writev(g_vol, &write_iov, 1, 2, 1, count_cb, &writes);
+	read_iov[2].iov_base = read_buf[2];
+	read_iov[2].iov_len = logical_block_size;
+	spdk_reduce_vol_readv(g_vol, &read_iov[2], 1, 2, 1, count_cb, &reads);
+	CU_ASSERT(g_pending_bdev_io_count == 2);
+
+	/* Completing both reads starts the read-modify-write of the chunk only. */
+	backing_dev_io_execute(2);
+	CU_ASSERT(reads == 2);
+	CU_ASSERT(writes == 0);
+	CU_ASSERT(g_pending_bdev_io_count == 1);
+
+	backing_dev_io_execute(0);
+	CU_ASSERT(writes == 1);
+	CU_ASSERT(reads == 3);
+
+	memset(compare_buf, 0xAA, sizeof(compare_buf));
+	CU_ASSERT(memcmp(read_buf[0], compare_buf, logical_block_size) == 0);
+	CU_ASSERT(memcmp(read_buf[1], compare_buf, logical_block_size) == 0);
+	CU_ASSERT(memcmp(read_buf[2], write_buf, logical_block_size) == 0);
+	g_defer_bdev_io = false;
+
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unload(g_vol, unload_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	persistent_pm_buf_destroy();
+	backing_dev_destroy(&backing_dev);
+}
+
+static void
+read_cache(void)
+{
+	struct spdk_reduce_vol_params params = {};
+	struct spdk_reduce_backing_dev backing_dev = {};
+	const uint32_t logical_block_size = 512;
+	const uint64_t blocks_per_chunk = 16 * 1024 / logical_block_size;
+	struct iovec iov;
+	char buf[16 * 1024];
+	char read_buf[logical_block_size];
+	char compare_buf[logical_block_size];
+	uint32_t reads = 0;
+	uint64_t i;
+	int rc;
+
+	params.chunk_size = 16 * 1024;
+	params.backing_io_unit_size = 4096;
+	params.logical_block_size = logical_block_size;
+	spdk_uuid_generate(&params.uuid);
+
+	backing_dev_init(&backing_dev, &params, 512);
+
+	g_vol = NULL;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_init(&params, &backing_dev, TEST_MD_PATH, init_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	SPDK_CU_ASSERT_FATAL(g_vol != NULL);
+
+	/* Cache two chunks */
+	rc = spdk_reduce_vol_set_read_cache_size(g_vol, 2 * params.chunk_size);
+	CU_ASSERT(rc == 0);
+
+	/* Fill the first three chunks with 0xAA, 0xAB and 0xAC */
+	for (i = 0; i < 3; i++) {
+		memset(buf, 0xAA + i, sizeof(buf));
+		iov.iov_base = buf;
+		iov.iov_len = sizeof(buf);
+		g_reduce_errno = -1;
+		spdk_reduce_vol_writev(g_vol, &iov, 1, i * blocks_per_chunk, blocks_per_chunk,
+				       write_cb, NULL);
+		CU_ASSERT(g_reduce_errno == 0);
+	}
+
+	g_defer_bdev_io = true;
+	iov.iov_base = read_buf;
+	iov.iov_len = logical_block_size;
+
+	/* The first read of the chunk goes to the backing device */
+	spdk_reduce_vol_readv(g_vol, &iov, 1, 0, 1, count_cb, &reads);
+	CU_ASSERT(g_pending_bdev_io_count == 1);
+	backing_dev_io_execute(0);
+	CU_ASSERT(reads == 1);
+
+	/* The next one is served from the cache */
+	memset(read_buf, 0, sizeof(read_buf));
+	spdk_reduce_vol_readv(g_vol, &iov, 1, 1, 1, count_cb, &reads);
+	CU_ASSERT(g_pending_bdev_io_count == 0);
+	CU_ASSERT(reads == 2);
+	memset(compare_buf, 0xAA, sizeof(compare_buf));
+	CU_ASSERT(memcmp(read_buf, compare_buf, logical_block_size) == 0);
+
+	/* A write invalidates the cached chunk */
+	g_defer_bdev_io = false;
+	memset(buf, 0xBB, logical_block_size);
+	iov.iov_base = buf;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_writev(g_vol, &iov, 1, 1, 1, write_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	g_defer_bdev_io = true;
+	iov.iov_base = read_buf;
+	spdk_reduce_vol_readv(g_vol, &iov, 1, 1, 1, count_cb, &reads);
+	CU_ASSERT(g_pending_bdev_io_count == 1);
+	backing_dev_io_execute(0);
+	CU_ASSERT(reads == 3);
+	memset(compare_buf, 0xBB, sizeof(compare_buf));
+	CU_ASSERT(memcmp(read_buf, compare_buf, logical_block_size) == 0);
+
+	/* Reading two other chunks evicts the least recently used one */
+	for (i = 1; i < 3; i++) {
+		spdk_reduce_vol_readv(g_vol, &iov, 1, i * blocks_per_chunk, 1, count_cb, &reads);
+		CU_ASSERT(g_pending_bdev_io_count == 1);
+		backing_dev_io_execute(0);
+	}
+	CU_ASSERT(reads == 5);
+
+	spdk_reduce_vol_readv(g_vol, &iov, 1, 2 * blocks_per_chunk, 1, count_cb, &reads);
+	CU_ASSERT(g_pending_bdev_io_count == 0);
+	spdk_reduce_vol_readv(g_vol, &iov, 1, 0, 1, count_cb, &reads);
+	CU_ASSERT(g_pending_bdev_io_count == 1);
+	backing_dev_io_execute(0);
+	CU_ASSERT(reads == 7);
+	memset(compare_buf, 0xAA, sizeof(compare_buf));
+	CU_ASSERT(memcmp(read_buf, compare_buf, logical_block_size) == 0);
+	g_defer_bdev_io = false;
+
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unload(g_vol, unload_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	persistent_pm_buf_destroy();
+	backing_dev_destroy(&backing_dev);
+}
+
 static void
 compress_algorithm(void)
 {
@@ -1985,12 +2378,16 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, init_backing_dev);
 	CU_ADD_TEST(suite, load);
 	CU_ADD_TEST(suite, write_maps);
+	CU_ADD_TEST(suite, write_persist_batch);
+	CU_ADD_TEST(suite, write_packed_chunks);
 	CU_ADD_TEST(suite, read_write);
 	CU_ADD_TEST(suite, readv_writev);
 	CU_ADD_TEST(suite, write_unmap_verify);
 	CU_ADD_TEST(suite, destroy);
 	CU_ADD_TEST(suite, defer_bdev_io);
 	CU_ADD_TEST(suite, overlapped);
+	CU_ADD_TEST(suite, overlapped_reads);
+	CU_ADD_TEST(suite, read_cache);
 	CU_ADD_TEST(suite, compress_algorithm);
 	CU_ADD_TEST(suite, test_prepare_compress_chunk);
 	CU_ADD_TEST(suite, test_reduce_decompress_chunk);
@@ -271,6 +271,14 @@ spdk_bdev_unmap_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 	return _spdk_bdev_io_op(cb, cb_arg);
 }
 
+int
+spdk_bdev_write_zeroes_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			      uint64_t offset_blocks, uint64_t num_blocks,
+			      spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return _spdk_bdev_io_op(cb, cb_arg);
+}
+
 int
 spdk_bdev_reset(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 		spdk_bdev_io_completion_cb cb, void *cb_arg)
@@ -1045,9 +1053,9 @@ unmap_split_test(void)
 	/* Test block device size of 512 MiB */
 	g_test_bdev_num_blocks = 512 * 1024 * 1024;
 
-	/* Unmap 5 blocks using 6 descriptors(descriptor 2 has 0 blocks). bdev_io pool size is 2.
-	 * Hence, unmap should be done by 3 iterations.
-	 * 1st - 2 unmaps(0, 1), 2nd - 3 unmaps(2, 3, 4), and 3rd - 1 unmap(5).
+	/* Unmap 11 blocks using 6 descriptors(descriptor 2 has 0 blocks and is dropped).
+	 * bdev_io pool size is 2. Hence, unmap should be done by 3 iterations.
+	 * 1st - 2 unmaps(0, 1), 2nd - 2 unmaps(3, 4), and 3rd - 1 unmap(5).
 	 */
 	ut_init_task(&task);
 	task.lun = &lun;
@@ -1096,7 +1104,7 @@ unmap_split_test(void)
 
 	ut_bdev_io_retry();
 
-	/* descriptor 2 and 3 (descriptor 2 is valid even though it is 0 blocks) */
+	/* descriptor 3 and 4 */
 	CU_ASSERT(g_outstanding_bdev_io_count == 2);
 	CU_ASSERT(g_pending_bdev_io_count == 0);
 
@@ -1108,8 +1116,8 @@ unmap_split_test(void)
 
 	ut_bdev_io_retry();
 
-	/* descriptor 4 and 5 */
-	CU_ASSERT(g_outstanding_bdev_io_count == 2);
+	/* descriptor 5 */
+	CU_ASSERT(g_outstanding_bdev_io_count == 1);
 	CU_ASSERT(g_pending_bdev_io_count == 0);
 
 	ut_bdev_io_complete();
@@ -1126,6 +1134,75 @@ unmap_split_test(void)
 	ut_put_task(&task);
 }
 
+static void
+unmap_merge_test(void)
+{
+	struct spdk_bdev bdev = { .blocklen = 512 };
+	struct spdk_scsi_lun lun;
+	struct spdk_scsi_task task;
+	uint8_t cdb[16];
+	char data[4096];
+	int rc;
+
+	lun.bdev = &bdev;
+
+	g_test_bdev_num_blocks = 512 * 1024 * 1024;
+
+	/* Unsorted, overlapping and adjacent descriptors covering LBA 1-11 are merged into
+	 * a single unmap.
+	 */
+	ut_init_task(&task);
+	task.lun = &lun;
+	task.cdb = cdb;
+	memset(cdb, 0, sizeof(cdb));
+	cdb[0] = 0x42; /* UNMAP */
+	memset(data, 0, sizeof(data));
+	to_be16(&data[2], 16 * 4); /* 4 descriptors */
+	to_be64(&data[8], 8); /* LBA 8 */
+	to_be32(&data[16], 4); /* 4 blocks */
+	to_be64(&data[24], 1); /* LBA 1 */
+	to_be32(&data[32], 3); /* 3 blocks */
+	to_be64(&data[40], 3); /* LBA 3 */
+	to_be32(&data[48], 2); /* 2 blocks */
+	to_be64(&data[56], 5); /* LBA 5 */
+	to_be32(&data[64], 3); /* 3 blocks */
+	spdk_scsi_task_set_data(&task, data, sizeof(data));
+	task.status = SPDK_SCSI_STATUS_GOOD;
+
+	rc = bdev_scsi_execute(&task);
+	CU_ASSERT(rc == SPDK_SCSI_TASK_PENDING);
+	CU_ASSERT(g_outstanding_bdev_io_count == 1);
+	CU_ASSERT(g_pending_bdev_io_count == 0);
+
+	ut_bdev_io_complete();
+
+	CU_ASSERT(task.status == SPDK_SCSI_STATUS_GOOD);
+	CU_ASSERT(g_scsi_cb_called == 1);
+
+	g_scsi_cb_called = 0;
+
+	/* Only 0 block descriptors, nothing to unmap */
+	ut_init_task(&task);
+	task.lun = &lun;
+	task.cdb = cdb;
+	memset(data, 0, sizeof(data));
+	to_be16(&data[2], 16 * 2); /* 2 descriptors */
+	to_be64(&data[8], 8); /* LBA 8 */
+	to_be64(&data[24], 1); /* LBA 1 */
+	spdk_scsi_task_set_data(&task, data, sizeof(data));
+	task.status = SPDK_SCSI_STATUS_GOOD;
+
+	rc = bdev_scsi_execute(&task);
+	CU_ASSERT(rc == SPDK_SCSI_TASK_COMPLETE);
+	CU_ASSERT(task.status == SPDK_SCSI_STATUS_GOOD);
+	CU_ASSERT(g_outstanding_bdev_io_count == 0);
+
+	SPDK_CU_ASSERT_FATAL(TAILQ_EMPTY(&g_bdev_io_queue));
+	SPDK_CU_ASSERT_FATAL(TAILQ_EMPTY(&g_io_wait_queue));
+
+	ut_put_task(&task);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1153,6 +1230,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, scsi_name_padding_test);
 	CU_ADD_TEST(suite, get_dif_ctx_test);
 	CU_ADD_TEST(suite, unmap_split_test);
+	CU_ADD_TEST(suite, unmap_merge_test);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
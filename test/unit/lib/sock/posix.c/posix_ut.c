@@ -136,6 +136,110 @@ flush(void)
 	free(req2);
 }
 
+static void
+placement_mode(void)
+{
+	struct spdk_sock_impl_opts impl_opts = {};
+
+	impl_opts.enable_placement_id = PLACEMENT_NONE;
+	CU_ASSERT(posix_sock_placement_mode(&impl_opts) == PLACEMENT_NONE);
+
+	/* Busy polling groups the sockets by their NAPI ID by default */
+	impl_opts.busy_poll_usecs = 50;
+	CU_ASSERT(posix_sock_placement_mode(&impl_opts) == PLACEMENT_NAPI);
+
+	/* An explicitly chosen placement mode is kept */
+	impl_opts.enable_placement_id = PLACEMENT_CPU;
+	CU_ASSERT(posix_sock_placement_mode(&impl_opts) == PLACEMENT_CPU);
+}
+
+static void
+ktls(void)
+{
+	struct spdk_posix_sock_group_impl group = {};
+	struct spdk_posix_sock psock = {};
+	struct spdk_sock *sock = &psock.base;
+	struct spdk_sock_request *req;
+	struct iovec iov;
+	char buf[16] = {};
+	bool cb_arg;
+	int fds[2];
+	int rc;
+
+	TAILQ_INIT(&sock->queued_reqs);
+	TAILQ_INIT(&sock->pending_reqs);
+	sock->group_impl = &group.base;
+
+	psock.ctx = SSL_CTX_new(TLS_method());
+	SPDK_CU_ASSERT_FATAL(psock.ctx != NULL);
+	psock.ssl = SSL_new(psock.ctx);
+	SPDK_CU_ASSERT_FATAL(psock.ssl != NULL);
+
+	/* Without enable_ktls, the crypto always stays in userspace */
+	sock->impl_opts.enable_ktls = false;
+	CU_ASSERT(!ssl_sock_ktls_send(&psock));
+	CU_ASSERT(psock.ktls_checked);
+
+	/* kTLS can only be checked once the handshake is done */
+	psock.ktls_checked = false;
+	sock->impl_opts.enable_ktls = true;
+	CU_ASSERT(!ssl_sock_ktls_send(&psock));
+	CU_ASSERT(!psock.ktls_checked);
+
+	/* Sends offloaded to the kernel go straight to the socket */
+	psock.ktls_checked = true;
+	psock.ktls_send = true;
+	req = calloc(1, sizeof(struct spdk_sock_request) + sizeof(struct iovec));
+	SPDK_CU_ASSERT_FATAL(req != NULL);
+	SPDK_SOCK_REQUEST_IOV(req, 0)->iov_base = buf;
+	SPDK_SOCK_REQUEST_IOV(req, 0)->iov_len = sizeof(buf);
+	req->iovcnt = 1;
+	req->cb_fn = _req_cb;
+	req->cb_arg = &cb_arg;
+	spdk_sock_request_queue(sock, req);
+	MOCK_SET(sendmsg, sizeof(buf));
+	cb_arg = false;
+	rc = _sock_flush(sock);
+	CU_ASSERT(rc == sizeof(buf));
+	CU_ASSERT(cb_arg == true);
+	CU_ASSERT(TAILQ_EMPTY(&sock->queued_reqs));
+	MOCK_CLEAR(sendmsg);
+
+	iov.iov_base = buf;
+	iov.iov_len = sizeof(buf);
+	MOCK_SET(writev, sizeof(buf));
+	rc = posix_sock_writev(sock, &iov, 1);
+	CU_ASSERT(rc == sizeof(buf));
+	MOCK_CLEAR(writev);
+
+	/* Receives offloaded to the kernel read the socket directly */
+	rc = pipe(fds);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	psock.fd = fds[0];
+	psock.ktls_recv = true;
+	rc = write(fds[1], "ktls", 4);
+	CU_ASSERT(rc == 4);
+	rc = ssl_sock_readv(&psock, &iov, 1);
+	CU_ASSERT(rc == 4);
+	CU_ASSERT(memcmp(buf, "ktls", 4) == 0);
+
+	/* Without kTLS, the data goes through OpenSSL, which has no transport here */
+	psock.ktls_send = false;
+	psock.ktls_recv = false;
+	rc = write(fds[1], "ktls", 4);
+	CU_ASSERT(rc == 4);
+	rc = ssl_sock_readv(&psock, &iov, 1);
+	CU_ASSERT(rc < 0);
+	rc = ssl_sock_writev(&psock, &iov, 1);
+	CU_ASSERT(rc < 0);
+
+	close(fds[0]);
+	close(fds[1]);
+	free(req);
+	SSL_free(psock.ssl);
+	SSL_CTX_free(psock.ctx);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -147,6 +251,8 @@ main(int argc, char **argv)
 	suite = CU_add_suite("posix", NULL, NULL);
 
 	CU_ADD_TEST(suite, flush);
+	CU_ADD_TEST(suite, placement_mode);
+	CU_ADD_TEST(suite, ktls);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
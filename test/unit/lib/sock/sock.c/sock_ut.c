@@ -1283,6 +1283,63 @@ posix_get_interface_name(void)
 	spdk_sock_close(&lsock);
 }
 
+static void
+posix_sock_inherited_listen(void)
+{
+	struct sockaddr_in addr = {};
+	struct spdk_sock *lsock, *csock, *asock;
+	struct spdk_posix_sock *psock;
+	int fds[1];
+	int fd, val = 1, rc;
+
+	/* Listening socket created by the "previous" process */
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	SPDK_CU_ASSERT_FATAL(fd >= 0);
+	rc = setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val));
+	CU_ASSERT(rc == 0);
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(UT_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	rc = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	rc = listen(fd, 16);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+
+	fds[0] = fd;
+	g_inherited_listen_fds.fds = fds;
+	g_inherited_listen_fds.num_fds = 1;
+	g_inherited_listen_fds.parsed = true;
+
+	/* Listening on another address doesn't take the inherited socket */
+	lsock = spdk_sock_listen("127.0.0.1", UT_PORT + 1, "posix");
+	SPDK_CU_ASSERT_FATAL(lsock != NULL);
+	psock = SPDK_CONTAINEROF(lsock, struct spdk_posix_sock, base);
+	CU_ASSERT(psock->fd != fd);
+	CU_ASSERT(fds[0] == fd);
+	spdk_sock_close(&lsock);
+
+	/* Listening on its address takes it over instead of binding a new socket */
+	lsock = spdk_sock_listen("127.0.0.1", UT_PORT, "posix");
+	SPDK_CU_ASSERT_FATAL(lsock != NULL);
+	psock = SPDK_CONTAINEROF(lsock, struct spdk_posix_sock, base);
+	CU_ASSERT(psock->fd == fd);
+	CU_ASSERT(fds[0] == -1);
+
+	csock = spdk_sock_connect("127.0.0.1", UT_PORT, "posix");
+	SPDK_CU_ASSERT_FATAL(csock != NULL);
+	do {
+		asock = spdk_sock_accept(lsock);
+	} while (asock == NULL && errno == EAGAIN);
+	SPDK_CU_ASSERT_FATAL(asock != NULL);
+
+	spdk_sock_close(&asock);
+	spdk_sock_close(&csock);
+	spdk_sock_close(&lsock);
+
+	g_inherited_listen_fds.fds = NULL;
+	g_inherited_listen_fds.num_fds = 0;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1306,6 +1363,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, override_impl_opts);
 	CU_ADD_TEST(suite, ut_sock_group_get_ctx);
 	CU_ADD_TEST(suite, posix_get_interface_name);
+	CU_ADD_TEST(suite, posix_sock_inherited_listen);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
@@ -29,8 +29,20 @@ DEFINE_STUB(io_uring_queue_init, int, (unsigned entries, struct io_uring *ring,
 DEFINE_STUB_V(io_uring_queue_exit, (struct io_uring *ring));
 DEFINE_STUB(spdk_sock_group_provide_buf, int, (struct spdk_sock_group *group, void *buf,
 		size_t len, void *ctx), 0);
-DEFINE_STUB(spdk_sock_group_get_buf, size_t, (struct spdk_sock_group *group, void **buf,
-		void **ctx), 0);
+
+static char g_buf[64];
+
+DEFINE_RETURN_MOCK(spdk_sock_group_get_buf, size_t);
+size_t
+spdk_sock_group_get_buf(struct spdk_sock_group *group, void **buf, void **ctx)
+{
+	HANDLE_RETURN_MOCK(spdk_sock_group_get_buf);
+
+	*buf = g_buf;
+	*ctx = NULL;
+
+	return sizeof(g_buf);
+}
 
 static void
 _req_cb(void *cb_arg, int len)
@@ -228,6 +240,86 @@ flush_server(void)
 	free(req2);
 }
 
+static void
+buf_ring_adjust(void)
+{
+	struct spdk_uring_sock_group_impl group = {};
+	struct spdk_uring_buf_tracker *tracker;
+	int i;
+
+	group.buf_ring = calloc(URING_BUF_POOL_SIZE, sizeof(struct io_uring_buf));
+	SPDK_CU_ASSERT_FATAL(group.buf_ring != NULL);
+	group.trackers = calloc(URING_BUF_POOL_SIZE, sizeof(struct spdk_uring_buf_tracker));
+	SPDK_CU_ASSERT_FATAL(group.trackers != NULL);
+	STAILQ_INIT(&group.free_trackers);
+	for (i = 0; i < URING_BUF_POOL_SIZE; i++) {
+		group.trackers[i].id = i;
+		STAILQ_INSERT_TAIL(&group.free_trackers, &group.trackers[i], link);
+	}
+	group.buf_ring_target = URING_BUF_POOL_MIN_SIZE;
+	group.buf_ring_low = URING_BUF_POOL_MIN_SIZE;
+	g_spdk_uring_sock_impl_opts.enable_recv_pipe = false;
+
+	/* Only the target number of buffers is posted, not the whole pool */
+	uring_sock_group_populate_buf_ring(&group);
+	CU_ASSERT(group.buf_ring_count == URING_BUF_POOL_MIN_SIZE);
+	CU_ASSERT(group.buf_ring->tail == URING_BUF_POOL_MIN_SIZE);
+	CU_ASSERT(group.buf_ring->bufs[0].bid == 0);
+	CU_ASSERT(group.buf_ring->bufs[0].addr == (uintptr_t)g_buf);
+	CU_ASSERT(group.buf_ring->bufs[0].len == sizeof(g_buf));
+	tracker = STAILQ_FIRST(&group.free_trackers);
+	CU_ASSERT(tracker == &group.trackers[URING_BUF_POOL_MIN_SIZE]);
+
+	/* Running out of buffers doubles the target and tops the ring up to it */
+	group.buf_ring_starved = true;
+	uring_sock_group_populate_buf_ring(&group);
+	CU_ASSERT(!group.buf_ring_starved);
+	CU_ASSERT(group.buf_ring_target == 2 * URING_BUF_POOL_MIN_SIZE);
+	CU_ASSERT(group.buf_ring_count == 2 * URING_BUF_POOL_MIN_SIZE);
+	CU_ASSERT(group.buf_ring->tail == 2 * URING_BUF_POOL_MIN_SIZE);
+
+	/* The ring dipping below half of the target keeps the target where it is */
+	group.buf_ring_count = URING_BUF_POOL_MIN_SIZE / 2;
+	for (i = 0; i < URING_BUF_POOL_ADJUST_POLLS; i++) {
+		uring_sock_group_populate_buf_ring(&group);
+	}
+	CU_ASSERT(group.buf_ring_target == 2 * URING_BUF_POOL_MIN_SIZE);
+	CU_ASSERT(group.buf_ring_polls == 0);
+
+	/* A whole period above half of the target halves it, but never below the minimum */
+	for (i = 0; i < URING_BUF_POOL_ADJUST_POLLS - 1; i++) {
+		uring_sock_group_populate_buf_ring(&group);
+	}
+	CU_ASSERT(group.buf_ring_target == 2 * URING_BUF_POOL_MIN_SIZE);
+	uring_sock_group_populate_buf_ring(&group);
+	CU_ASSERT(group.buf_ring_target == URING_BUF_POOL_MIN_SIZE);
+	for (i = 0; i < URING_BUF_POOL_ADJUST_POLLS; i++) {
+		uring_sock_group_populate_buf_ring(&group);
+	}
+	CU_ASSERT(group.buf_ring_target == URING_BUF_POOL_MIN_SIZE);
+
+	/* Repeated starvation grows the target up to the size of the pool */
+	for (i = 0; i < 16; i++) {
+		group.buf_ring_starved = true;
+		uring_sock_group_populate_buf_ring(&group);
+	}
+	CU_ASSERT(group.buf_ring_target == URING_BUF_POOL_SIZE);
+	CU_ASSERT(STAILQ_EMPTY(&group.free_trackers));
+
+	/* Nothing is posted when the group has no buffers to give */
+	group.buf_ring_count = 0;
+	MOCK_SET(spdk_sock_group_get_buf, 0);
+	STAILQ_INSERT_TAIL(&group.free_trackers, &group.trackers[0], link);
+	uring_sock_group_populate_buf_ring(&group);
+	CU_ASSERT(group.buf_ring_count == 0);
+	CU_ASSERT(STAILQ_FIRST(&group.free_trackers) == &group.trackers[0]);
+	MOCK_CLEAR(spdk_sock_group_get_buf);
+
+	g_spdk_uring_sock_impl_opts.enable_recv_pipe = true;
+	free(group.trackers);
+	free(group.buf_ring);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -241,6 +333,7 @@ main(int argc, char **argv)
 
 	CU_ADD_TEST(suite, flush_client);
 	CU_ADD_TEST(suite, flush_server);
+	CU_ADD_TEST(suite, buf_ring_adjust);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
@@ -45,6 +45,11 @@ ut_iobuf_foreach_cb(struct spdk_iobuf_channel *ch, struct spdk_iobuf_entry *entr
 	return 0;
 }
 
+struct ut_iobuf_iov_entry {
+	struct spdk_iobuf_iov_entry	entry;
+	int				*done;
+};
+
 #define SMALL_BUFSIZE 4096
 #define LARGE_BUFSIZE 8192
 
@@ -704,6 +709,335 @@ iobuf_priority(void)
 	free_cores();
 }
 
+static bool
+ut_iobuf_from_pool(void *buf, void *pool_base, uint64_t pool_count, uint32_t bufsize)
+{
+	return (uintptr_t)buf >= (uintptr_t)pool_base &&
+	       (uintptr_t)buf < (uintptr_t)pool_base + pool_count * bufsize;
+}
+
+static void
+iobuf_classes(void)
+{
+	struct spdk_iobuf_opts opts = {
+		.small_pool_count = 2,
+		.large_pool_count = 2,
+		.small_bufsize = SMALL_BUFSIZE,
+		.large_bufsize = 4 * LARGE_BUFSIZE,
+		.num_classes = 2,
+		.class_bufsize = { LARGE_BUFSIZE, 2 * LARGE_BUFSIZE },
+		.class_pool_count = { 2, 2 },
+	};
+	struct spdk_iobuf_opts bad_opts = {};
+	struct ut_iobuf_entry entry = {};
+	struct spdk_iobuf_channel iobuf_ch = {};
+	struct iobuf_node *node = &g_iobuf.node[0];
+	struct iovec regions[4];
+	void *bufs[3], *large;
+	int rc, finish = 0;
+
+	/* Check the validation of the size classes */
+	spdk_iobuf_get_opts(&bad_opts, sizeof(bad_opts));
+	bad_opts.small_pool_count = IOBUF_MIN_SMALL_POOL_SIZE;
+	bad_opts.large_pool_count = IOBUF_MIN_LARGE_POOL_SIZE;
+	bad_opts.small_bufsize = SMALL_BUFSIZE;
+	bad_opts.large_bufsize = 4 * LARGE_BUFSIZE;
+	bad_opts.num_classes = SPDK_IOBUF_MAX_CLASSES + 1;
+	CU_ASSERT_EQUAL(spdk_iobuf_set_opts(&bad_opts), -EINVAL);
+	bad_opts.num_classes = 2;
+	bad_opts.class_pool_count[0] = IOBUF_MIN_CLASS_POOL_SIZE;
+	bad_opts.class_pool_count[1] = IOBUF_MIN_CLASS_POOL_SIZE;
+	/* Not ascending once aligned */
+	bad_opts.class_bufsize[0] = LARGE_BUFSIZE + 1;
+	bad_opts.class_bufsize[1] = LARGE_BUFSIZE + 2;
+	CU_ASSERT_EQUAL(spdk_iobuf_set_opts(&bad_opts), -EINVAL);
+	/* Not smaller than the large buffers */
+	bad_opts.class_bufsize[0] = LARGE_BUFSIZE;
+	bad_opts.class_bufsize[1] = 4 * LARGE_BUFSIZE;
+	CU_ASSERT_EQUAL(spdk_iobuf_set_opts(&bad_opts), -EINVAL);
+	/* Too small pool */
+	bad_opts.class_bufsize[1] = 2 * LARGE_BUFSIZE;
+	bad_opts.class_pool_count[1] = 1;
+	CU_ASSERT_EQUAL(spdk_iobuf_set_opts(&bad_opts), -EINVAL);
+	bad_opts.class_pool_count[1] = IOBUF_MIN_CLASS_POOL_SIZE;
+	CU_ASSERT_EQUAL(spdk_iobuf_set_opts(&bad_opts), 0);
+
+	allocate_cores(1);
+	allocate_threads(1);
+
+	set_thread(0);
+
+	/* We cannot use spdk_iobuf_set_opts(), as it won't allow us to use such small pools */
+	g_iobuf.opts = opts;
+	rc = spdk_iobuf_initialize();
+	CU_ASSERT_EQUAL(rc, 0);
+
+	rc = spdk_iobuf_register_module("ut_module");
+	CU_ASSERT_EQUAL(rc, 0);
+	rc = spdk_iobuf_channel_init(&iobuf_ch, "ut_module", 0, 0);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	/* Each pool is backed by its own region */
+	rc = spdk_iobuf_get_regions(NULL, 0);
+	CU_ASSERT_EQUAL(rc, 4);
+	rc = spdk_iobuf_get_regions(regions, 2);
+	CU_ASSERT_EQUAL(rc, 4);
+	CU_ASSERT_EQUAL(regions[0].iov_base, node->small_pool_base);
+	CU_ASSERT_EQUAL(regions[0].iov_len, 2 * SMALL_BUFSIZE);
+	CU_ASSERT_EQUAL(regions[1].iov_base, node->large_pool_base);
+	CU_ASSERT_EQUAL(regions[1].iov_len, 2 * 4 * LARGE_BUFSIZE);
+	rc = spdk_iobuf_get_regions(regions, 4);
+	CU_ASSERT_EQUAL(rc, 4);
+	CU_ASSERT_EQUAL(regions[2].iov_base, node->class_pool_base[0]);
+	CU_ASSERT_EQUAL(regions[2].iov_len, 2 * LARGE_BUFSIZE);
+	CU_ASSERT_EQUAL(regions[3].iov_base, node->class_pool_base[1]);
+	CU_ASSERT_EQUAL(regions[3].iov_len, 2 * 2 * LARGE_BUFSIZE);
+
+	/* Each request is served by the smallest class that fits it */
+	bufs[0] = spdk_iobuf_get(&iobuf_ch, SMALL_BUFSIZE + 1, NULL, NULL);
+	CU_ASSERT(ut_iobuf_from_pool(bufs[0], node->class_pool_base[0], 2, LARGE_BUFSIZE));
+	bufs[1] = spdk_iobuf_get(&iobuf_ch, LARGE_BUFSIZE + 1, NULL, NULL);
+	CU_ASSERT(ut_iobuf_from_pool(bufs[1], node->class_pool_base[1], 2, 2 * LARGE_BUFSIZE));
+	large = spdk_iobuf_get(&iobuf_ch, 2 * LARGE_BUFSIZE + 1, NULL, NULL);
+	CU_ASSERT(ut_iobuf_from_pool(large, node->large_pool_base, 2, 4 * LARGE_BUFSIZE));
+	CU_ASSERT_EQUAL(spdk_ring_count(node->large_pool), 1);
+
+	/* Once a class is exhausted, the requests wait for it, without falling back on
+	 * the larger buffers */
+	bufs[2] = spdk_iobuf_get(&iobuf_ch, LARGE_BUFSIZE, NULL, NULL);
+	CU_ASSERT(ut_iobuf_from_pool(bufs[2], node->class_pool_base[0], 2, LARGE_BUFSIZE));
+	entry.buf = spdk_iobuf_get(&iobuf_ch, LARGE_BUFSIZE, &entry.iobuf, ut_iobuf_get_buf_cb);
+	CU_ASSERT_PTR_NULL(entry.buf);
+	CU_ASSERT_EQUAL(iobuf_ch.cache[0].classes[0].stats.main, 2);
+	CU_ASSERT_EQUAL(iobuf_ch.cache[0].classes[0].stats.retry, 1);
+	CU_ASSERT_EQUAL(iobuf_ch.cache[0].classes[1].stats.main, 1);
+	CU_ASSERT_EQUAL(iobuf_ch.cache[0].large.stats.main, 1);
+
+	spdk_iobuf_put(&iobuf_ch, bufs[0], SMALL_BUFSIZE + 1);
+	CU_ASSERT_PTR_EQUAL(entry.buf, bufs[0]);
+
+	spdk_iobuf_put(&iobuf_ch, entry.buf, LARGE_BUFSIZE);
+	spdk_iobuf_put(&iobuf_ch, bufs[1], LARGE_BUFSIZE + 1);
+	spdk_iobuf_put(&iobuf_ch, bufs[2], LARGE_BUFSIZE);
+	spdk_iobuf_put(&iobuf_ch, large, 2 * LARGE_BUFSIZE + 1);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->class_pool[0]), 2);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->class_pool[1]), 2);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->large_pool), 2);
+
+	spdk_iobuf_channel_fini(&iobuf_ch);
+	poll_threads();
+
+	spdk_iobuf_finish(ut_iobuf_finish_cb, &finish);
+	poll_threads();
+
+	CU_ASSERT_EQUAL(finish, 1);
+
+	free_threads();
+	free_cores();
+}
+
+static void
+iobuf_steal(void)
+{
+	struct spdk_iobuf_opts opts = {
+		.small_pool_count = 4,
+		.large_pool_count = 4,
+		.small_bufsize = SMALL_BUFSIZE,
+		.large_bufsize = LARGE_BUFSIZE,
+		.enable_steal = true,
+	};
+	struct spdk_iobuf_channel iobuf_ch[3] = {};
+	struct ut_iobuf_entry entry = {};
+	struct iobuf_node *node = &g_iobuf.node[0];
+	void *buf, *bufs[2];
+	int rc, finish = 0;
+
+	allocate_cores(2);
+	allocate_threads(2);
+
+	set_thread(0);
+
+	/* We cannot use spdk_iobuf_set_opts(), as it won't allow us to use such small pools */
+	g_iobuf.opts = opts;
+	rc = spdk_iobuf_initialize();
+	CU_ASSERT_EQUAL(rc, 0);
+
+	rc = spdk_iobuf_register_module("ut_module0");
+	CU_ASSERT_EQUAL(rc, 0);
+	rc = spdk_iobuf_register_module("ut_module1");
+	CU_ASSERT_EQUAL(rc, 0);
+
+	/* The first channel caches the whole small pool */
+	rc = spdk_iobuf_channel_init(&iobuf_ch[0], "ut_module0", 4, 0);
+	CU_ASSERT_EQUAL(rc, 0);
+	rc = spdk_iobuf_channel_init(&iobuf_ch[1], "ut_module1", 0, 0);
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->small_pool), 0);
+
+	/* A channel on the same thread takes half of its cache */
+	buf = spdk_iobuf_get(&iobuf_ch[1], SMALL_BUFSIZE, NULL, NULL);
+	CU_ASSERT_PTR_NOT_NULL(buf);
+	CU_ASSERT_EQUAL(iobuf_ch[0].cache[0].small.cache_count, 2);
+	CU_ASSERT_EQUAL(iobuf_ch[1].cache[0].small.cache_count, 1);
+	CU_ASSERT_EQUAL(iobuf_ch[1].cache[0].small.stats.steal, 2);
+	CU_ASSERT_EQUAL(iobuf_ch[1].cache[0].small.stats.main, 0);
+
+	/* A channel on another thread has to wait for the other threads to give their spare
+	 * buffers back to the pool */
+	set_thread(1);
+	rc = spdk_iobuf_channel_init(&iobuf_ch[2], "ut_module0", 0, 0);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	spdk_delay_us(IOBUF_RECLAIM_INTERVAL_US);
+	entry.buf = spdk_iobuf_get(&iobuf_ch[2], SMALL_BUFSIZE, &entry.iobuf, ut_iobuf_get_buf_cb);
+	CU_ASSERT_PTR_NULL(entry.buf);
+	CU_ASSERT_EQUAL(iobuf_ch[2].cache[0].small.stats.retry, 1);
+
+	poll_threads();
+	CU_ASSERT_PTR_NOT_NULL(entry.buf);
+	CU_ASSERT_EQUAL(iobuf_ch[2].cache[0].small.stats.steal, 1);
+	CU_ASSERT_EQUAL(iobuf_ch[0].cache[0].small.cache_count, 1);
+	CU_ASSERT_EQUAL(iobuf_ch[1].cache[0].small.cache_count, 0);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->small_pool), 1);
+	CU_ASSERT(!node->reclaim_in_progress[IOBUF_POOL_SMALL]);
+
+	/* Another reclaim isn't started until the interval elapses */
+	bufs[0] = spdk_iobuf_get(&iobuf_ch[2], SMALL_BUFSIZE, NULL, NULL);
+	CU_ASSERT_PTR_NOT_NULL(bufs[0]);
+	bufs[1] = entry.buf;
+	entry.buf = spdk_iobuf_get(&iobuf_ch[2], SMALL_BUFSIZE, &entry.iobuf, ut_iobuf_get_buf_cb);
+	CU_ASSERT_PTR_NULL(entry.buf);
+	poll_threads();
+	CU_ASSERT_PTR_NULL(entry.buf);
+	CU_ASSERT_EQUAL(iobuf_ch[0].cache[0].small.cache_count, 1);
+
+	spdk_iobuf_put(&iobuf_ch[2], bufs[0], SMALL_BUFSIZE);
+	CU_ASSERT_PTR_EQUAL(entry.buf, bufs[0]);
+	spdk_iobuf_put(&iobuf_ch[2], bufs[1], SMALL_BUFSIZE);
+	spdk_iobuf_put(&iobuf_ch[2], entry.buf, SMALL_BUFSIZE);
+
+	spdk_iobuf_channel_fini(&iobuf_ch[2]);
+	poll_threads();
+
+	set_thread(0);
+	spdk_iobuf_put(&iobuf_ch[1], buf, SMALL_BUFSIZE);
+	spdk_iobuf_channel_fini(&iobuf_ch[1]);
+	spdk_iobuf_channel_fini(&iobuf_ch[0]);
+	poll_threads();
+	CU_ASSERT_EQUAL(spdk_ring_count(node->small_pool), 4);
+
+	spdk_iobuf_finish(ut_iobuf_finish_cb, &finish);
+	poll_threads();
+
+	CU_ASSERT_EQUAL(finish, 1);
+
+	free_threads();
+	free_cores();
+}
+
+static void
+ut_iobuf_get_iov_cb(struct spdk_iobuf_iov_entry *entry, struct iovec *iovs, int iovcnt)
+{
+	*(int *)SPDK_CONTAINEROF(entry, struct ut_iobuf_iov_entry, entry)->done = iovcnt;
+}
+
+static void
+iobuf_iov(void)
+{
+	struct spdk_iobuf_opts opts = {
+		.small_pool_count = 4,
+		.large_pool_count = 4,
+		.small_bufsize = SMALL_BUFSIZE,
+		.large_bufsize = LARGE_BUFSIZE,
+	};
+	struct spdk_iobuf_channel iobuf_ch = {};
+	struct ut_iobuf_iov_entry entry = {}, entry2 = {};
+	struct iovec iovs[4], iovs2[4], iovs3[4];
+	struct iobuf_node *node = &g_iobuf.node[0];
+	int rc, done = -1, done2 = -1, finish = 0;
+
+	allocate_cores(1);
+	allocate_threads(1);
+
+	set_thread(0);
+
+	/* We cannot use spdk_iobuf_set_opts(), as it won't allow us to use such small pools */
+	g_iobuf.opts = opts;
+	rc = spdk_iobuf_initialize();
+	CU_ASSERT_EQUAL(rc, 0);
+
+	rc = spdk_iobuf_register_module("ut_module");
+	CU_ASSERT_EQUAL(rc, 0);
+	rc = spdk_iobuf_channel_init(&iobuf_ch, "ut_module", 0, 0);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	/* Too few iovecs */
+	rc = spdk_iobuf_get_iov(&iobuf_ch, 4 * LARGE_BUFSIZE + 1, iovs, 4, NULL, NULL);
+	CU_ASSERT_EQUAL(rc, -EINVAL);
+	rc = spdk_iobuf_get_iov(&iobuf_ch, 0, iovs, 4, NULL, NULL);
+	CU_ASSERT_EQUAL(rc, -EINVAL);
+
+	/* The request is made of large buffers and the smallest buffer fitting the rest */
+	rc = spdk_iobuf_get_iov(&iobuf_ch, 3 * LARGE_BUFSIZE + 100, iovs, 4, NULL, NULL);
+	CU_ASSERT_EQUAL(rc, 4);
+	CU_ASSERT(ut_iobuf_from_pool(iovs[0].iov_base, node->large_pool_base, 4, LARGE_BUFSIZE));
+	CU_ASSERT(ut_iobuf_from_pool(iovs[1].iov_base, node->large_pool_base, 4, LARGE_BUFSIZE));
+	CU_ASSERT(ut_iobuf_from_pool(iovs[2].iov_base, node->large_pool_base, 4, LARGE_BUFSIZE));
+	CU_ASSERT(ut_iobuf_from_pool(iovs[3].iov_base, node->small_pool_base, 4, SMALL_BUFSIZE));
+	CU_ASSERT_EQUAL(iovs[0].iov_len, LARGE_BUFSIZE);
+	CU_ASSERT_EQUAL(iovs[3].iov_len, 100);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->large_pool), 1);
+
+	/* Without an entry, the buffers acquired are released if the request can't be completed */
+	rc = spdk_iobuf_get_iov(&iobuf_ch, 2 * LARGE_BUFSIZE, iovs2, 4, NULL, NULL);
+	CU_ASSERT_EQUAL(rc, -ENOMEM);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->large_pool), 1);
+
+	/* With an entry, they are kept until the remaining ones are available */
+	entry.done = &done;
+	rc = spdk_iobuf_get_iov(&iobuf_ch, 2 * LARGE_BUFSIZE, iovs2, 4, &entry.entry,
+				ut_iobuf_get_iov_cb);
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT_EQUAL(entry.entry.iovcnt, 1);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->large_pool), 0);
+
+	entry2.done = &done2;
+	rc = spdk_iobuf_get_iov(&iobuf_ch, 2 * LARGE_BUFSIZE, iovs3, 4, &entry2.entry,
+				ut_iobuf_get_iov_cb);
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT_EQUAL(entry2.entry.iovcnt, 0);
+
+	/* The first request gets the first buffer released and completes */
+	spdk_iobuf_put_iov(&iobuf_ch, iovs, 1);
+	CU_ASSERT_EQUAL(done, 2);
+	CU_ASSERT_PTR_EQUAL(iovs2[1].iov_base, iovs[0].iov_base);
+	CU_ASSERT_EQUAL(done2, -1);
+
+	/* The second one keeps the next buffer and is then aborted, returning it to the pool */
+	spdk_iobuf_put_iov(&iobuf_ch, &iovs[1], 1);
+	CU_ASSERT_EQUAL(entry2.entry.iovcnt, 1);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->large_pool), 0);
+	spdk_iobuf_iov_entry_abort(&entry2.entry);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->large_pool), 1);
+	CU_ASSERT_EQUAL(done2, -1);
+
+	spdk_iobuf_put_iov(&iobuf_ch, &iovs[2], 2);
+	spdk_iobuf_put_iov(&iobuf_ch, iovs2, 2);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->large_pool), 4);
+	CU_ASSERT_EQUAL(spdk_ring_count(node->small_pool), 4);
+
+	spdk_iobuf_channel_fini(&iobuf_ch);
+	poll_threads();
+
+	spdk_iobuf_finish(ut_iobuf_finish_cb, &finish);
+	poll_threads();
+
+	CU_ASSERT_EQUAL(finish, 1);
+
+	free_threads();
+	free_cores();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -716,6 +1050,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, iobuf);
 	CU_ADD_TEST(suite, iobuf_cache);
 	CU_ADD_TEST(suite, iobuf_priority);
+	CU_ADD_TEST(suite, iobuf_classes);
+	CU_ADD_TEST(suite, iobuf_steal);
+	CU_ADD_TEST(suite, iobuf_iov);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
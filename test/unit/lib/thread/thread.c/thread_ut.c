@@ -146,6 +146,156 @@ thread_send_msg(void)
 	free_threads();
 }
 
+#define STAGED_MSG_COUNT 20
+#define STAGED_MSG_THREADS (SPDK_MSG_STAGE_TARGETS + 2)
+
+static uint32_t g_staged_msgs[STAGED_MSG_COUNT];
+static uint32_t g_staged_msg_count;
+static bool g_staged_msg_done[STAGED_MSG_THREADS];
+
+static void
+staged_msg_cb(void *ctx)
+{
+	SPDK_CU_ASSERT_FATAL(g_staged_msg_count < STAGED_MSG_COUNT);
+	g_staged_msgs[g_staged_msg_count++] = (uint32_t)(uintptr_t)ctx;
+}
+
+static void
+send_staged_msgs_cb(void *ctx)
+{
+	struct spdk_thread **threads = ctx;
+	uint32_t i;
+	int rc;
+
+	/* Messages sent while polling are held until the poll is done */
+	for (i = 0; i < 3; i++) {
+		rc = spdk_thread_send_msg(threads[1], staged_msg_cb, (void *)(uintptr_t)i);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(spdk_thread_is_idle(threads[1]));
+
+	/* A full batch is published right away */
+	for (; i < STAGED_MSG_COUNT; i++) {
+		rc = spdk_thread_send_msg(threads[1], staged_msg_cb, (void *)(uintptr_t)i);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(!spdk_thread_is_idle(threads[1]));
+
+	/* Once all the staging slots are taken, messages to other threads are published directly */
+	for (i = 2; i < STAGED_MSG_THREADS; i++) {
+		rc = spdk_thread_send_msg(threads[i], send_msg_cb, &g_staged_msg_done[i]);
+		CU_ASSERT(rc == 0);
+	}
+	for (i = 2; i < STAGED_MSG_THREADS - 1; i++) {
+		CU_ASSERT(spdk_thread_is_idle(threads[i]));
+	}
+	CU_ASSERT(!spdk_thread_is_idle(threads[STAGED_MSG_THREADS - 1]));
+}
+
+static void
+nested_poll_cb(void *ctx)
+{
+	struct spdk_thread *thread = spdk_get_thread();
+	bool *done = ctx;
+
+	spdk_thread_send_msg(thread, send_msg_cb, done);
+	CU_ASSERT(!*done);
+
+	/* A nested poll runs the messages staged by the outer one */
+	spdk_thread_poll(thread, 0, 0);
+	CU_ASSERT(*done);
+}
+
+static void
+thread_send_msg_staged(void)
+{
+	struct spdk_thread *threads[STAGED_MSG_THREADS];
+	bool done = false;
+	uint32_t i;
+
+	allocate_threads(STAGED_MSG_THREADS);
+	for (i = 0; i < STAGED_MSG_THREADS; i++) {
+		set_thread(i);
+		threads[i] = spdk_get_thread();
+	}
+
+	g_staged_msg_count = 0;
+	set_thread(1);
+	spdk_thread_send_msg(threads[0], send_staged_msgs_cb, threads);
+	poll_thread(0);
+
+	for (i = 1; i < STAGED_MSG_THREADS; i++) {
+		CU_ASSERT(!spdk_thread_is_idle(threads[i]));
+	}
+
+	/* Batches are delivered in the order they were sent */
+	poll_threads();
+	CU_ASSERT(g_staged_msg_count == STAGED_MSG_COUNT);
+	for (i = 0; i < STAGED_MSG_COUNT; i++) {
+		CU_ASSERT(g_staged_msgs[i] == i);
+	}
+	for (i = 2; i < STAGED_MSG_THREADS; i++) {
+		CU_ASSERT(g_staged_msg_done[i]);
+	}
+
+	/* Sending from outside of a poll isn't delayed */
+	set_thread(1);
+	spdk_thread_send_msg(threads[0], send_msg_cb, &done);
+	CU_ASSERT(!spdk_thread_is_idle(threads[0]));
+	poll_thread(0);
+	CU_ASSERT(done);
+	CU_ASSERT(spdk_thread_is_idle(threads[0]));
+
+	done = false;
+	set_thread(0);
+	spdk_thread_send_msg(threads[0], nested_poll_cb, &done);
+	poll_thread(0);
+	CU_ASSERT(done);
+
+	free_threads();
+}
+
+static void
+send_msg_to_exiting_cb(void *ctx)
+{
+	struct spdk_thread *thread = ctx;
+	int rc;
+
+	rc = spdk_thread_send_msg(thread, send_msg_cb, &g_staged_msg_done[0]);
+	CU_ASSERT(rc == 0);
+
+	/* The target is polled while the message is still staged here, it must not exit */
+	spdk_thread_poll(thread, 0, 0);
+	CU_ASSERT(!g_staged_msg_done[0]);
+	CU_ASSERT(!spdk_thread_is_exited(thread));
+}
+
+static void
+thread_send_msg_exiting(void)
+{
+	struct spdk_thread *thread;
+
+	allocate_threads(2);
+	set_thread(1);
+	thread = spdk_get_thread();
+	spdk_thread_exit(thread);
+	CU_ASSERT(spdk_thread_is_exited(thread) == false);
+
+	g_staged_msg_done[0] = false;
+	set_thread(0);
+	spdk_thread_send_msg(spdk_get_thread(), send_msg_to_exiting_cb, thread);
+	poll_thread(0);
+
+	/* The message is published once the poll of thread 0 is done and run before the thread
+	 * exits.
+	 */
+	poll_thread(1);
+	CU_ASSERT(g_staged_msg_done[0]);
+	CU_ASSERT(spdk_thread_is_exited(thread));
+
+	free_threads();
+}
+
 static int
 poller_run_done(void *ctx)
 {
@@ -584,6 +734,100 @@ for_each_channel_remove(void)
 	free_threads();
 }
 
+struct parallel_ctx {
+	int	msg_count;
+	int	cpl_count;
+	int	status;
+};
+
+static void
+parallel_msg(struct spdk_io_channel_iter *i)
+{
+	struct parallel_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	ctx->msg_count++;
+	spdk_for_each_channel_continue(i, spdk_get_thread() == g_ut_threads[1].thread ? -EIO : 0);
+}
+
+static void
+parallel_cpl(struct spdk_io_channel_iter *i, int status)
+{
+	struct parallel_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	CU_ASSERT(spdk_get_thread() == g_ut_threads[0].thread);
+	CU_ASSERT(spdk_io_channel_iter_get_channel(i) == NULL);
+	ctx->cpl_count++;
+	ctx->status = status;
+}
+
+static void
+for_each_channel_parallel(void)
+{
+	struct spdk_io_channel *ch0, *ch1, *ch2;
+	struct parallel_ctx ctx = {};
+	struct io_device *dev;
+	int ch_count = 0;
+
+	allocate_threads(3);
+	set_thread(0);
+	spdk_io_device_register(&ch_count, channel_create, channel_destroy, sizeof(int), NULL);
+	ch0 = spdk_get_io_channel(&ch_count);
+	set_thread(1);
+	ch1 = spdk_get_io_channel(&ch_count);
+	set_thread(2);
+	ch2 = spdk_get_io_channel(&ch_count);
+	CU_ASSERT(ch_count == 3);
+	dev = RB_MIN(io_device_tree, &g_io_devices);
+	SPDK_CU_ASSERT_FATAL(dev != NULL);
+
+	/* The messages are sent to all the threads at once, any order of polling works */
+	set_thread(0);
+	spdk_for_each_channel_parallel(&ch_count, parallel_msg, &ctx, parallel_cpl);
+	CU_ASSERT(dev->for_each_count == 1);
+	poll_thread(2);
+	CU_ASSERT(ctx.msg_count == 1);
+	poll_thread(1);
+	CU_ASSERT(ctx.msg_count == 2);
+	CU_ASSERT(ctx.cpl_count == 0);
+	poll_thread(0);
+	CU_ASSERT(ctx.msg_count == 3);
+	poll_thread(0);
+	CU_ASSERT(ctx.cpl_count == 1);
+	/* A failure on one channel doesn't stop the others and is reported */
+	CU_ASSERT(ctx.status == -EIO);
+	CU_ASSERT(dev->for_each_count == 0);
+
+	/* Only the remaining channels are visited once one is released */
+	memset(&ctx, 0, sizeof(ctx));
+	set_thread(1);
+	spdk_put_io_channel(ch1);
+	poll_threads();
+	CU_ASSERT(ch_count == 2);
+	set_thread(0);
+	spdk_for_each_channel_parallel(&ch_count, parallel_msg, &ctx, parallel_cpl);
+	poll_threads();
+	CU_ASSERT(ctx.msg_count == 2);
+	CU_ASSERT(ctx.cpl_count == 1);
+	CU_ASSERT(ctx.status == 0);
+
+	/* Unregistering the device waits for the outstanding operation */
+	memset(&ctx, 0, sizeof(ctx));
+	set_thread(0);
+	spdk_for_each_channel_parallel(&ch_count, parallel_msg, &ctx, parallel_cpl);
+	spdk_put_io_channel(ch0);
+	set_thread(2);
+	spdk_put_io_channel(ch2);
+	set_thread(0);
+	spdk_io_device_unregister(&ch_count, NULL);
+	CU_ASSERT(dev == RB_MIN(io_device_tree, &g_io_devices));
+	poll_threads();
+	CU_ASSERT(ctx.cpl_count == 1);
+	CU_ASSERT(ch_count == 0);
+	CU_ASSERT(RB_EMPTY(&g_io_devices));
+
+	free_threads();
+}
+
 struct unreg_ctx {
 	bool	ch_done;
 	bool	foreach_done;
@@ -830,6 +1074,80 @@ destroy_cb(void *io_device, void *ctx_buf)
  * the deferred put operation to complete doesn't result in releasing the memory
  * for the channel twice.
  */
+static void
+thread_arena(void)
+{
+	struct spdk_thread_arena_opts opts = {}, default_opts = {};
+	struct spdk_io_channel *ch1, *ch2, *ch3;
+	struct spdk_poller *poller;
+	struct spdk_thread *thread;
+	bool poller_run = false;
+
+	spdk_thread_arena_get_opts(&default_opts, sizeof(default_opts));
+	CU_ASSERT(default_opts.chunk_size == 0);
+	CU_ASSERT(default_opts.hugepages == false);
+
+	opts = default_opts;
+	opts.chunk_size = 4096;
+	CU_ASSERT(spdk_thread_arena_set_opts(&opts) == -EINVAL);
+	opts.chunk_size = SPDK_THREAD_ARENA_MIN_CHUNK_SIZE;
+	CU_ASSERT(spdk_thread_arena_set_opts(&opts) == 0);
+
+	allocate_threads(1);
+	set_thread(0);
+	thread = spdk_get_thread();
+	SPDK_CU_ASSERT_FATAL(thread != NULL);
+	CU_ASSERT(thread->arena.chunk_size == SPDK_THREAD_ARENA_MIN_CHUNK_SIZE);
+
+	/* Small channels and pollers are cache line aligned objects carved from the arena */
+	spdk_io_device_register(&g_device1, create_cb_1, destroy_cb_1, sizeof(g_ctx1), NULL);
+	spdk_io_device_register(&g_device2, create_cb_2, destroy_cb_2,
+				SPDK_THREAD_ARENA_MAX_OBJ_SIZE, NULL);
+
+	ch1 = spdk_get_io_channel(&g_device1);
+	SPDK_CU_ASSERT_FATAL(ch1 != NULL);
+	CU_ASSERT(ch1->arena == true);
+	CU_ASSERT((uintptr_t)ch1 % SPDK_CACHE_LINE_SIZE == 0);
+	CU_ASSERT(thread->arena.outstanding == 1);
+
+	poller = spdk_poller_register(poller_run_done, &poller_run, 0);
+	SPDK_CU_ASSERT_FATAL(poller != NULL);
+	CU_ASSERT(poller->arena == true);
+	CU_ASSERT((uintptr_t)poller % SPDK_CACHE_LINE_SIZE == 0);
+	CU_ASSERT(thread->arena.outstanding == 2);
+
+	/* Objects larger than the last size class are allocated separately */
+	ch2 = spdk_get_io_channel(&g_device2);
+	SPDK_CU_ASSERT_FATAL(ch2 != NULL);
+	CU_ASSERT(ch2->arena == false);
+	CU_ASSERT(thread->arena.outstanding == 2);
+
+	/* A freed object is reused for the next one of the same size class */
+	spdk_put_io_channel(ch1);
+	poll_threads();
+	CU_ASSERT(thread->arena.outstanding == 1);
+
+	ch3 = spdk_get_io_channel(&g_device1);
+	CU_ASSERT(ch3 == ch1);
+	CU_ASSERT(ch3->arena == true);
+	CU_ASSERT(*(uint64_t *)spdk_io_channel_get_ctx(ch3) == g_ctx1);
+	CU_ASSERT(thread->arena.outstanding == 2);
+
+	spdk_put_io_channel(ch3);
+	spdk_put_io_channel(ch2);
+	spdk_poller_unregister(&poller);
+	poll_threads();
+	CU_ASSERT(thread->arena.outstanding == 0);
+
+	spdk_io_device_unregister(&g_device1, NULL);
+	spdk_io_device_unregister(&g_device2, NULL);
+	poll_threads();
+	CU_ASSERT(RB_EMPTY(&g_io_devices));
+	free_threads();
+
+	CU_ASSERT(spdk_thread_arena_set_opts(&default_opts) == 0);
+}
+
 static void
 channel_destroy_races(void)
 {
@@ -1422,13 +1740,13 @@ cache_closest_timed_poller(void)
 	 * have the closest timed poller.
 	 */
 	CU_ASSERT(thread->first_timed_poller == poller1);
-	CU_ASSERT(RB_MIN(timed_pollers_tree, &thread->timed_pollers) == poller1);
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == poller1);
 
 	spdk_delay_us(1000);
 	poll_threads();
 
 	CU_ASSERT(thread->first_timed_poller == poller2);
-	CU_ASSERT(RB_MIN(timed_pollers_tree, &thread->timed_pollers) == poller2);
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == poller2);
 
 	/* If we unregister a timed poller by spdk_poller_unregister()
 	 * when it is waiting, it is marked as being unregistered and
@@ -1446,13 +1764,13 @@ cache_closest_timed_poller(void)
 	poll_threads();
 
 	CU_ASSERT(thread->first_timed_poller == tmp);
-	CU_ASSERT(RB_MIN(timed_pollers_tree, &thread->timed_pollers) == tmp);
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == tmp);
 
 	spdk_delay_us(1);
 	poll_threads();
 
 	CU_ASSERT(thread->first_timed_poller == poller3);
-	CU_ASSERT(RB_MIN(timed_pollers_tree, &thread->timed_pollers) == poller3);
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == poller3);
 
 	/* If we pause a timed poller by spdk_poller_pause() when it is waiting,
 	 * it is marked as being paused and is actually paused when it is expired.
@@ -1466,13 +1784,13 @@ cache_closest_timed_poller(void)
 	poll_threads();
 
 	CU_ASSERT(thread->first_timed_poller == poller3);
-	CU_ASSERT(RB_MIN(timed_pollers_tree, &thread->timed_pollers) == poller3);
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == poller3);
 
 	spdk_delay_us(1);
 	poll_threads();
 
 	CU_ASSERT(thread->first_timed_poller == poller1);
-	CU_ASSERT(RB_MIN(timed_pollers_tree, &thread->timed_pollers) == poller1);
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == poller1);
 
 	/* After unregistering all timed pollers, the cache should
 	 * be NULL.
@@ -1484,7 +1802,7 @@ cache_closest_timed_poller(void)
 	poll_threads();
 
 	CU_ASSERT(thread->first_timed_poller == NULL);
-	CU_ASSERT(RB_EMPTY(&thread->timed_pollers));
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == NULL);
 
 	free_threads();
 }
@@ -1580,7 +1898,7 @@ multi_timed_pollers_have_same_expiration(void)
 	poll_threads();
 
 	CU_ASSERT(thread->first_timed_poller == NULL);
-	CU_ASSERT(RB_EMPTY(&thread->timed_pollers));
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == NULL);
 
 	/*
 	 * case 2: unregister timed pollers while multiple timed pollers are registered.
@@ -1647,7 +1965,137 @@ multi_timed_pollers_have_same_expiration(void)
 	poll_threads();
 
 	CU_ASSERT(thread->first_timed_poller == NULL);
-	CU_ASSERT(RB_EMPTY(&thread->timed_pollers));
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == NULL);
+
+	free_threads();
+}
+
+static int
+count_poller(void *arg)
+{
+	int *count = arg;
+
+	(*count)++;
+
+	return SPDK_POLLER_BUSY;
+}
+
+static void
+timed_pollers_wheel(void)
+{
+	struct spdk_thread *thread;
+	struct spdk_poller *pollers[5], *poller;
+	uint64_t periods[5] = { 10, 100, 5000, 300000, 20000000 };
+	uint64_t start_ticks;
+	int counts[5] = {};
+	int i, j, num;
+
+	allocate_threads(1);
+	set_thread(0);
+
+	thread = spdk_get_thread();
+	SPDK_CU_ASSERT_FATAL(thread != NULL);
+
+	start_ticks = spdk_get_ticks();
+
+	/* Register the furthest poller first, each poller lands on its own level. */
+	for (i = 4; i >= 0; i--) {
+		pollers[i] = spdk_poller_register(count_poller, &counts[i], periods[i]);
+		SPDK_CU_ASSERT_FATAL(pollers[i] != NULL);
+		CU_ASSERT(thread->first_timed_poller == pollers[i]);
+		CU_ASSERT(pollers[i]->wheel_level == i);
+	}
+
+	num = 0;
+	for (poller = spdk_thread_get_first_timed_poller(thread); poller != NULL;
+	     poller = spdk_thread_get_next_timed_poller(poller)) {
+		num++;
+	}
+	CU_ASSERT(num == 5);
+
+	/* Once the period of a poller elapses, it and all the shorter ones have run once more. */
+	for (i = 0; i < 5; i++) {
+		spdk_delay_us(start_ticks + periods[i] - spdk_get_ticks());
+		poll_threads();
+
+		for (j = 0; j < 5; j++) {
+			CU_ASSERT(counts[j] == (j <= i ? i - j + 1 : 0));
+		}
+		CU_ASSERT(thread->first_timed_poller == pollers[0]);
+		CU_ASSERT(spdk_thread_next_poller_expiration(thread) == spdk_get_ticks() + periods[0]);
+		CU_ASSERT(pollers[i]->next_run_tick == spdk_get_ticks() + periods[i]);
+	}
+
+	for (i = 0; i < 5; i++) {
+		spdk_poller_unregister(&pollers[i]);
+	}
+
+	/* Unregistered timed pollers are released when they expire. */
+	spdk_delay_us(periods[4]);
+	poll_threads();
+
+	CU_ASSERT(thread->first_timed_poller == NULL);
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == NULL);
+
+	free_threads();
+}
+
+static void
+timed_pollers_wheel_remove(void)
+{
+	struct spdk_thread *thread;
+	struct spdk_poller *pollers[9], *keep, *poller;
+	/* Besides the level 0 one, pairs share a slot, the later poller is armed first. */
+	uint64_t periods[9] = { 10, 1000, 995, 5000, 4900, 300000, 290000, 20000000, 19000000 };
+	int count = 0;
+	int i, num;
+
+	/* Start the wheel on a slot boundary of every level. */
+	spdk_delay_us(SPDK_ALIGN_CEIL(spdk_get_ticks(), 1ULL << 24) - spdk_get_ticks());
+
+	allocate_threads(1);
+	set_thread(0);
+
+	thread = spdk_get_thread();
+	SPDK_CU_ASSERT_FATAL(thread != NULL);
+
+	for (i = 0; i < 9; i++) {
+		pollers[i] = spdk_poller_register(count_poller, &count, periods[i]);
+		SPDK_CU_ASSERT_FATAL(pollers[i] != NULL);
+	}
+	keep = spdk_poller_register(count_poller, &count, 400000);
+	SPDK_CU_ASSERT_FATAL(keep != NULL);
+	for (i = 0; i < 9; i++) {
+		CU_ASSERT(pollers[i]->wheel_level == (i + 1) / 2);
+	}
+
+	for (i = 0; i < 9; i++) {
+		spdk_poller_unregister(&pollers[i]);
+	}
+
+	/* In interrupt mode unregistered pollers are removed by a message, not when
+	 * they expire.  Removing them all at once must not lose any of them while the
+	 * wheel is walked, whichever level they sit on.
+	 */
+	_thread_remove_pollers(thread);
+
+	num = 0;
+	for (poller = spdk_thread_get_first_timed_poller(thread); poller != NULL;
+	     poller = spdk_thread_get_next_timed_poller(poller)) {
+		CU_ASSERT(poller == keep);
+		num++;
+	}
+	CU_ASSERT(num == 1);
+	CU_ASSERT(thread->first_timed_poller == keep);
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == keep);
+	CU_ASSERT(count == 0);
+
+	spdk_poller_unregister(&keep);
+	spdk_delay_us(400000);
+	poll_threads();
+
+	CU_ASSERT(thread->first_timed_poller == NULL);
+	CU_ASSERT(poller_wheel_first(&thread->timed_pollers) == NULL);
 
 	free_threads();
 }
@@ -2169,6 +2617,123 @@ poller_get_stats(void)
 	free_threads();
 }
 
+static void
+poller_stats_generation(void)
+{
+	struct spdk_poller *idle_poller = NULL;
+	struct spdk_poller *busy_poller = NULL;
+	struct spdk_thread *thread;
+	int period = 5;
+
+	allocate_threads(1);
+	set_thread(0);
+	thread = spdk_get_thread();
+
+	idle_poller = spdk_poller_register(ut_null_poll, NULL, 0);
+	busy_poller = spdk_poller_register(ut_busy_poll, NULL, period);
+
+	/* The thread hasn't been reported yet, so its pollers are always considered changed */
+	CU_ASSERT(spdk_thread_pollers_changed(thread, 1));
+	spdk_thread_set_stats_generation(thread, 1);
+	CU_ASSERT(spdk_thread_pollers_changed(thread, 1));
+	CU_ASSERT(!spdk_poller_stats_changed(idle_poller, 1));
+	CU_ASSERT(!spdk_poller_stats_changed(busy_poller, 1));
+
+	/* Only the poller that ran since generation 1 changed */
+	poll_thread(0);
+	CU_ASSERT(spdk_poller_stats_changed(idle_poller, 1));
+	CU_ASSERT(!spdk_poller_stats_changed(busy_poller, 1));
+
+	spdk_thread_set_stats_generation(thread, 2);
+	CU_ASSERT(!spdk_thread_pollers_changed(thread, 2));
+	spdk_delay_us(period);
+	poll_thread(0);
+	CU_ASSERT(spdk_poller_stats_changed(idle_poller, 2));
+	CU_ASSERT(spdk_poller_stats_changed(busy_poller, 2));
+
+	/* An older report doesn't move the generation back */
+	spdk_thread_set_stats_generation(thread, 4);
+	spdk_thread_set_stats_generation(thread, 3);
+	poll_thread(0);
+	CU_ASSERT(spdk_poller_stats_changed(idle_poller, 4));
+
+	/* Pausing, resuming and unregistering pollers changes the thread */
+	CU_ASSERT(!spdk_thread_pollers_changed(thread, 4));
+	spdk_poller_pause(idle_poller);
+	CU_ASSERT(spdk_thread_pollers_changed(thread, 4));
+	spdk_thread_set_stats_generation(thread, 5);
+	CU_ASSERT(!spdk_thread_pollers_changed(thread, 5));
+	spdk_poller_resume(idle_poller);
+	CU_ASSERT(spdk_thread_pollers_changed(thread, 5));
+	spdk_thread_set_stats_generation(thread, 6);
+	spdk_poller_unregister(&busy_poller);
+	CU_ASSERT(spdk_thread_pollers_changed(thread, 6));
+
+	spdk_poller_unregister(&idle_poller);
+	free_threads();
+}
+
+static int
+ut_delay_poll(void *ctx)
+{
+	int *delay_us = ctx;
+
+	spdk_delay_us(abs(*delay_us));
+
+	return *delay_us > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+static void
+poller_get_stats_tsc(void)
+{
+	struct spdk_poller *active_poller, *timed_poller;
+	struct spdk_poller_stats stats;
+	int active_delay = 10, timed_delay = -3;
+	int period = 100;
+
+	allocate_threads(1);
+	set_thread(0);
+
+	/* Positive delays make the poller report busy, negative ones idle. */
+	active_poller = spdk_poller_register(ut_delay_poll, &active_delay, 0);
+	timed_poller = spdk_poller_register(ut_delay_poll, &timed_delay, period);
+
+	poll_thread_times(0, 1);
+
+	spdk_poller_get_stats(active_poller, &stats);
+	CU_ASSERT_EQUAL(stats.run_count, 1);
+	CU_ASSERT_EQUAL(stats.busy_tsc, 10);
+	CU_ASSERT_EQUAL(stats.idle_tsc, 0);
+	CU_ASSERT_EQUAL(stats.max_run_tsc, 10);
+
+	active_delay = 30;
+	poll_thread_times(0, 1);
+	active_delay = -20;
+	poll_thread_times(0, 1);
+
+	spdk_poller_get_stats(active_poller, &stats);
+	CU_ASSERT_EQUAL(stats.run_count, 3);
+	CU_ASSERT_EQUAL(stats.busy_count, 2);
+	CU_ASSERT_EQUAL(stats.busy_tsc, 40);
+	CU_ASSERT_EQUAL(stats.idle_tsc, 20);
+	CU_ASSERT_EQUAL(stats.max_run_tsc, 30);
+
+	spdk_poller_unregister(&active_poller);
+
+	spdk_delay_us(period);
+	poll_thread(0);
+
+	spdk_poller_get_stats(timed_poller, &stats);
+	CU_ASSERT_EQUAL(stats.run_count, 1);
+	CU_ASSERT_EQUAL(stats.busy_count, 0);
+	CU_ASSERT_EQUAL(stats.busy_tsc, 0);
+	CU_ASSERT_EQUAL(stats.idle_tsc, 3);
+	CU_ASSERT_EQUAL(stats.max_run_tsc, 3);
+
+	spdk_poller_unregister(&timed_poller);
+	free_threads();
+}
+
 
 int
 main(int argc, char **argv)
@@ -2182,13 +2747,17 @@ main(int argc, char **argv)
 
 	CU_ADD_TEST(suite, thread_alloc);
 	CU_ADD_TEST(suite, thread_send_msg);
+	CU_ADD_TEST(suite, thread_send_msg_staged);
+	CU_ADD_TEST(suite, thread_send_msg_exiting);
 	CU_ADD_TEST(suite, thread_poller);
 	CU_ADD_TEST(suite, poller_pause);
 	CU_ADD_TEST(suite, thread_for_each);
 	CU_ADD_TEST(suite, for_each_channel_remove);
 	CU_ADD_TEST(suite, for_each_channel_unreg);
+	CU_ADD_TEST(suite, for_each_channel_parallel);
 	CU_ADD_TEST(suite, thread_name);
 	CU_ADD_TEST(suite, channel);
+	CU_ADD_TEST(suite, thread_arena);
 	CU_ADD_TEST(suite, channel_destroy_races);
 	CU_ADD_TEST(suite, thread_exit_test);
 	CU_ADD_TEST(suite, thread_update_stats_test);
@@ -2196,6 +2765,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, device_unregister_and_thread_exit_race);
 	CU_ADD_TEST(suite, cache_closest_timed_poller);
 	CU_ADD_TEST(suite, multi_timed_pollers_have_same_expiration);
+	CU_ADD_TEST(suite, timed_pollers_wheel);
+	CU_ADD_TEST(suite, timed_pollers_wheel_remove);
 	CU_ADD_TEST(suite, io_device_lookup);
 	CU_ADD_TEST(suite, spdk_spin);
 	CU_ADD_TEST(suite, for_each_channel_and_thread_exit_race);
@@ -2205,6 +2776,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, poller_get_state_str);
 	CU_ADD_TEST(suite, poller_get_period_ticks);
 	CU_ADD_TEST(suite, poller_get_stats);
+	CU_ADD_TEST(suite, poller_get_stats_tsc);
+	CU_ADD_TEST(suite, poller_stats_generation);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -0,0 +1,271 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk/trace.h"
+#include "spdk/trace_parser.h"
+#include "spdk/util.h"
+
+#define UT_NUM_LCORES		4
+#define UT_NUM_ENTRIES		8
+#define UT_TPOINT_CREATE	1
+#define UT_TPOINT_PROGRESS	2
+#define UT_TPOINT_DONE		3
+#define UT_OBJECT		1
+
+static char g_path[PATH_MAX];
+static struct spdk_trace_file *g_file;
+static size_t g_file_size;
+
+static int
+ut_trace_file_create(void)
+{
+	struct spdk_trace_history *history;
+	struct spdk_trace_tpoint *tpoint;
+	uint64_t offset;
+	int fd, i;
+
+	snprintf(g_path, sizeof(g_path), "/tmp/trace_parser_ut.XXXXXX");
+	fd = mkstemp(g_path);
+	if (fd < 0) {
+		return -errno;
+	}
+
+	g_file_size = sizeof(*g_file) + UT_NUM_LCORES * spdk_get_trace_history_size(UT_NUM_ENTRIES);
+	if (ftruncate(fd, g_file_size) != 0) {
+		close(fd);
+		return -errno;
+	}
+
+	g_file = mmap(NULL, g_file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (g_file == MAP_FAILED) {
+		return -errno;
+	}
+
+	g_file->file_size = g_file_size;
+	offset = sizeof(*g_file);
+	for (i = 0; i < UT_NUM_LCORES; i++) {
+		g_file->lcore_history_offsets[i] = offset;
+		history = spdk_get_per_lcore_history(g_file, i);
+		history->lcore = i;
+		history->num_entries = UT_NUM_ENTRIES;
+		offset += spdk_get_trace_history_size(UT_NUM_ENTRIES);
+	}
+
+	tpoint = &g_file->tpoint[UT_TPOINT_CREATE];
+	tpoint->tpoint_id = UT_TPOINT_CREATE;
+	tpoint->object_type = UT_OBJECT;
+	tpoint->new_object = 1;
+	g_file->tpoint[UT_TPOINT_PROGRESS] = *tpoint;
+	g_file->tpoint[UT_TPOINT_PROGRESS].tpoint_id = UT_TPOINT_PROGRESS;
+	g_file->tpoint[UT_TPOINT_PROGRESS].new_object = 0;
+	g_file->tpoint[UT_TPOINT_DONE] = g_file->tpoint[UT_TPOINT_PROGRESS];
+	g_file->tpoint[UT_TPOINT_DONE].tpoint_id = UT_TPOINT_DONE;
+
+	return 0;
+}
+
+static int
+ut_trace_file_destroy(void)
+{
+	munmap(g_file, g_file_size);
+	unlink(g_path);
+
+	return 0;
+}
+
+static void
+ut_history_reset(void)
+{
+	struct spdk_trace_history *history;
+	int i;
+
+	for (i = 0; i < UT_NUM_LCORES; i++) {
+		history = spdk_get_per_lcore_history(g_file, i);
+		memset(history->entries, 0, UT_NUM_ENTRIES * sizeof(history->entries[0]));
+	}
+}
+
+static void
+ut_record(uint16_t lcore, uint16_t idx, uint64_t tsc, uint16_t tpoint_id, uint64_t object_id)
+{
+	struct spdk_trace_history *history = spdk_get_per_lcore_history(g_file, lcore);
+
+	history->entries[idx].tsc = tsc;
+	history->entries[idx].tpoint_id = tpoint_id;
+	history->entries[idx].object_id = object_id;
+}
+
+static struct spdk_trace_parser *
+ut_parser_init(void)
+{
+	struct spdk_trace_parser_opts opts = {
+		.filename = g_path,
+		.mode = SPDK_TRACE_PARSER_MODE_FILE,
+		.lcore = SPDK_TRACE_MAX_LCORE,
+	};
+
+	return spdk_trace_parser_init(&opts);
+}
+
+static void
+test_merge(void)
+{
+	struct spdk_trace_parser_entry entry;
+	struct spdk_trace_parser *parser;
+	struct {
+		uint64_t tsc;
+		uint16_t lcore;
+	} expected[] = {
+		{ 10, 0 }, { 15, 2 }, { 20, 1 }, { 25, 2 }, { 30, 0 }, { 30, 1 },
+		{ 40, 1 }, { 40, 1 }, { 50, 0 },
+	};
+	size_t i;
+
+	ut_history_reset();
+	ut_record(0, 0, 10, UT_TPOINT_PROGRESS, 0);
+	ut_record(0, 1, 30, UT_TPOINT_PROGRESS, 0);
+	ut_record(0, 2, 50, UT_TPOINT_PROGRESS, 0);
+	/* Entries with an identical tsc on the same core are all kept */
+	ut_record(1, 0, 20, UT_TPOINT_PROGRESS, 0);
+	ut_record(1, 1, 30, UT_TPOINT_PROGRESS, 0);
+	ut_record(1, 2, 40, UT_TPOINT_PROGRESS, 0);
+	ut_record(1, 3, 40, UT_TPOINT_PROGRESS, 0);
+	/* Entries recorded with an explicit tsc aren't ordered */
+	ut_record(2, 0, 25, UT_TPOINT_PROGRESS, 0);
+	ut_record(2, 1, 15, UT_TPOINT_PROGRESS, 0);
+
+	parser = ut_parser_init();
+	SPDK_CU_ASSERT_FATAL(parser != NULL);
+	CU_ASSERT(spdk_trace_parser_get_tsc_offset(parser) == 0);
+	CU_ASSERT(spdk_trace_parser_get_entry_count(parser, 0) == UT_NUM_ENTRIES);
+
+	for (i = 0; i < SPDK_COUNTOF(expected); i++) {
+		SPDK_CU_ASSERT_FATAL(spdk_trace_parser_next_entry(parser, &entry));
+		CU_ASSERT(entry.entry->tsc == expected[i].tsc);
+		CU_ASSERT(entry.lcore == expected[i].lcore);
+	}
+	CU_ASSERT(!spdk_trace_parser_next_entry(parser, &entry));
+
+	spdk_trace_parser_cleanup(parser);
+}
+
+static void
+test_overflow(void)
+{
+	struct spdk_trace_parser_entry entry;
+	struct spdk_trace_parser *parser;
+	uint64_t tsc;
+	uint16_t i;
+
+	ut_history_reset();
+	/* The buffer of core 0 wrapped around, its oldest entry is in the middle */
+	for (i = 0; i < UT_NUM_ENTRIES; i++) {
+		ut_record(0, i, 100 + ((i + 3) % UT_NUM_ENTRIES) * 10, UT_TPOINT_PROGRESS, 0);
+	}
+	ut_record(1, 0, 90, UT_TPOINT_PROGRESS, 0);
+	ut_record(1, 1, 120, UT_TPOINT_PROGRESS, 0);
+
+	parser = ut_parser_init();
+	SPDK_CU_ASSERT_FATAL(parser != NULL);
+	/* Events preceding the oldest entry of the overflowed core are to be skipped */
+	CU_ASSERT(spdk_trace_parser_get_tsc_offset(parser) == 100);
+
+	SPDK_CU_ASSERT_FATAL(spdk_trace_parser_next_entry(parser, &entry));
+	CU_ASSERT(entry.entry->tsc == 90);
+	CU_ASSERT(entry.lcore == 1);
+	for (tsc = 100; tsc < 100 + UT_NUM_ENTRIES * 10; tsc += 10) {
+		SPDK_CU_ASSERT_FATAL(spdk_trace_parser_next_entry(parser, &entry));
+		CU_ASSERT(entry.entry->tsc == tsc);
+		CU_ASSERT(entry.lcore == 0);
+		if (tsc == 120) {
+			SPDK_CU_ASSERT_FATAL(spdk_trace_parser_next_entry(parser, &entry));
+			CU_ASSERT(entry.entry->tsc == 120);
+			CU_ASSERT(entry.lcore == 1);
+		}
+	}
+	CU_ASSERT(!spdk_trace_parser_next_entry(parser, &entry));
+
+	spdk_trace_parser_cleanup(parser);
+}
+
+static void
+test_tpoint_stats(void)
+{
+	struct spdk_trace_parser_tpoint_stats stats;
+	struct spdk_trace_parser_entry entry;
+	struct spdk_trace_parser *parser;
+	uint64_t object_index[2];
+	int rc;
+
+	ut_history_reset();
+	ut_record(0, 0, 100, UT_TPOINT_CREATE, 0xa);
+	ut_record(0, 1, 130, UT_TPOINT_PROGRESS, 0xa);
+	ut_record(0, 2, 170, UT_TPOINT_DONE, 0xa);
+	ut_record(1, 0, 110, UT_TPOINT_CREATE, 0xb);
+	ut_record(1, 1, 120, UT_TPOINT_PROGRESS, 0xb);
+	ut_record(1, 2, 200, UT_TPOINT_DONE, 0xb);
+	/* An entry of an object whose creation wasn't recorded is not counted */
+	ut_record(1, 3, 300, UT_TPOINT_DONE, 0xc);
+
+	parser = ut_parser_init();
+	SPDK_CU_ASSERT_FATAL(parser != NULL);
+
+	while (spdk_trace_parser_next_entry(parser, &entry)) {
+		if (entry.entry->object_id == 0xc) {
+			CU_ASSERT(entry.object_index == UINT64_MAX);
+			continue;
+		}
+		object_index[entry.entry->object_id - 0xa] = entry.object_index;
+		CU_ASSERT(entry.object_start == (entry.entry->object_id == 0xa ? 100 : 110));
+	}
+	CU_ASSERT(object_index[0] == 0);
+	CU_ASSERT(object_index[1] == 1);
+
+	rc = spdk_trace_parser_get_tpoint_stats(parser, UT_TPOINT_CREATE, &stats);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stats.count == 0);
+
+	rc = spdk_trace_parser_get_tpoint_stats(parser, UT_TPOINT_PROGRESS, &stats);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stats.count == 2);
+	CU_ASSERT(stats.min_tsc == 10);
+	CU_ASSERT(stats.max_tsc == 30);
+	CU_ASSERT(stats.total_tsc == 40);
+
+	rc = spdk_trace_parser_get_tpoint_stats(parser, UT_TPOINT_DONE, &stats);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stats.count == 2);
+	CU_ASSERT(stats.min_tsc == 70);
+	CU_ASSERT(stats.max_tsc == 90);
+	CU_ASSERT(stats.total_tsc == 160);
+
+	rc = spdk_trace_parser_get_tpoint_stats(parser, SPDK_TRACE_MAX_TPOINT_ID, &stats);
+	CU_ASSERT(rc == -EINVAL);
+
+	spdk_trace_parser_cleanup(parser);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("trace_parser", ut_trace_file_create, ut_trace_file_destroy);
+	CU_ADD_TEST(suite, test_merge);
+	CU_ADD_TEST(suite, test_overflow);
+	CU_ADD_TEST(suite, test_tpoint_stats);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
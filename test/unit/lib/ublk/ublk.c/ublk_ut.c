@@ -0,0 +1,187 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/test_env.c"
+#include "ublk/ublk.c"
+
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB(spdk_bdev_flush_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB(spdk_bdev_get_data_block_size, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_io_channel, struct spdk_io_channel *, (struct spdk_bdev_desc *desc),
+		NULL);
+DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), NULL);
+DEFINE_STUB(spdk_bdev_get_num_blocks, uint64_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_optimal_io_boundary, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_get_physical_block_size, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_io_type_supported, bool, (struct spdk_bdev *bdev,
+		enum spdk_bdev_io_type io_type), false);
+DEFINE_STUB(spdk_bdev_open_ext, int, (const char *bdev_name, bool write,
+		spdk_bdev_event_cb_t event_cb, void *event_ctx, struct spdk_bdev_desc **desc), 0);
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB(spdk_bdev_read_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_unmap_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_write_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_write_zeroes_blocks, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, uint64_t offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB_V(spdk_env_get_cpuset, (struct spdk_cpuset *cpuset));
+
+#define UT_Q_DEPTH	4
+#define UT_CQ_ENTRIES	8
+
+struct ut_queue {
+	struct ublk_queue		q;
+	struct ublk_poll_group		poll_group;
+	struct ublk_io			ios[UT_Q_DEPTH];
+	struct ublksrv_io_desc		iods[UT_Q_DEPTH];
+	/* Completion ring shared with the "kernel", only the fields walked by liburing are set */
+	struct io_uring_cqe		cqes[UT_CQ_ENTRIES];
+	unsigned			cq_head;
+	unsigned			cq_tail;
+};
+
+static void
+ut_queue_init(struct ut_queue *uq)
+{
+	uint16_t i;
+
+	memset(uq, 0, sizeof(*uq));
+	uq->q.q_depth = UT_Q_DEPTH;
+	uq->q.ios = uq->ios;
+	uq->q.poll_group = &uq->poll_group;
+	TAILQ_INIT(&uq->q.completed_io_list);
+	TAILQ_INIT(&uq->q.inflight_io_list);
+	uq->q.ring.cq.khead = &uq->cq_head;
+	uq->q.ring.cq.ktail = &uq->cq_tail;
+	uq->q.ring.cq.cqes = uq->cqes;
+	uq->q.ring.cq.ring_mask = UT_CQ_ENTRIES - 1;
+	uq->q.ring.cq.ring_entries = UT_CQ_ENTRIES;
+
+	for (i = 0; i < UT_Q_DEPTH; i++) {
+		uq->ios[i].q = &uq->q;
+		uq->ios[i].tag = i;
+		uq->ios[i].iod = &uq->iods[i];
+	}
+}
+
+static void
+ut_queue_post_cqe(struct ut_queue *uq, uint16_t tag, uint8_t op, int res)
+{
+	struct io_uring_cqe *cqe = &uq->cqes[uq->cq_tail & (UT_CQ_ENTRIES - 1)];
+
+	cqe->user_data = build_user_data(tag, op);
+	cqe->res = res;
+	uq->cq_tail++;
+	uq->q.cmd_inflight++;
+}
+
+static void
+recv_linked_commit(void)
+{
+	struct ut_queue uq;
+	struct ublk_io *io0, *io1;
+	int count;
+
+	ut_queue_init(&uq);
+	io0 = &uq.ios[0];
+	io1 = &uq.ios[1];
+
+	/* READ data copied to the kernel with the COMMIT_AND_FETCH linked behind the copy */
+	uq.iods[0].op_flags = UBLK_IO_OP_READ;
+	io0->user_copy = true;
+	io0->commit_linked = true;
+	io0->result = 4096;
+	ut_queue_post_cqe(&uq, 0, 0, 4096);
+
+	/* Failed copy cancels the linked commit, it has to be committed again with an error */
+	uq.iods[1].op_flags = UBLK_IO_OP_READ;
+	io1->cmd_op = UBLK_IO_COMMIT_AND_FETCH_REQ;
+	io1->result = 4096;
+	ut_queue_post_cqe(&uq, 1, UBLK_IO_COMMIT_AND_FETCH_REQ, -ECANCELED);
+
+	count = ublk_io_recv(&uq.q);
+	CU_ASSERT(count == 2);
+	CU_ASSERT(uq.cq_head == 2);
+	CU_ASSERT(uq.q.cmd_inflight == 0);
+	CU_ASSERT(!uq.q.is_stopping);
+
+	/* The linked commit is already in flight, so the copy completion must not commit again */
+	CU_ASSERT(!io0->user_copy);
+	CU_ASSERT(!io0->commit_linked);
+	CU_ASSERT(io0->result == 4096);
+	CU_ASSERT(TAILQ_EMPTY(&uq.q.inflight_io_list));
+
+	CU_ASSERT(TAILQ_FIRST(&uq.q.completed_io_list) == io1);
+	CU_ASSERT(TAILQ_NEXT(io1, tailq) == NULL);
+	CU_ASSERT(io1->cmd_op == UBLK_IO_COMMIT_AND_FETCH_REQ);
+	CU_ASSERT(io1->result == -EIO);
+}
+
+static void
+recv_budget(void)
+{
+	struct ut_queue uq;
+	uint16_t i;
+	int count;
+
+	ut_queue_init(&uq);
+
+	/* More CQEs than the queue depth, the reap budget of one poll is the queue depth */
+	for (i = 0; i < UT_Q_DEPTH + 2; i++) {
+		ut_queue_post_cqe(&uq, i % UT_Q_DEPTH, UBLK_IO_FETCH_REQ, UBLK_IO_RES_ABORT);
+	}
+
+	count = ublk_io_recv(&uq.q);
+	CU_ASSERT(count == UT_Q_DEPTH);
+	CU_ASSERT(uq.cq_head == UT_Q_DEPTH);
+	CU_ASSERT(uq.q.cmd_inflight == 2);
+	CU_ASSERT(uq.q.is_stopping);
+
+	count = ublk_io_recv(&uq.q);
+	CU_ASSERT(count == 2);
+	CU_ASSERT(uq.cq_head == UT_Q_DEPTH + 2);
+	CU_ASSERT(uq.q.cmd_inflight == 0);
+
+	CU_ASSERT(TAILQ_EMPTY(&uq.q.inflight_io_list));
+	CU_ASSERT(TAILQ_EMPTY(&uq.q.completed_io_list));
+
+	/* Nothing in flight, nothing to reap */
+	CU_ASSERT(ublk_io_recv(&uq.q) == 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ublk", NULL, NULL);
+
+	CU_ADD_TEST(suite, recv_linked_commit);
+	CU_ADD_TEST(suite, recv_budget);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
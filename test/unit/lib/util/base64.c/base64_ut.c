@@ -324,6 +324,100 @@ test_base64_urlsafe_decode(void)
 	CU_ASSERT_EQUAL(ret, -EINVAL);
 }
 
+#ifdef __x86_64__
+static void
+check_base64_x86_kernel(void (*encode_fn)(char **, const char *, const void **, size_t *),
+			void (*decode_fn)(void **, const uint8_t *, const uint8_t **, size_t *))
+{
+	uint8_t raw[300], raw_ref[300], dec[301];
+	char text[401], text_ref[401], bad[401];
+	size_t len, dec_len, text_len, i;
+	char invalid[] = { '*', '=', '\x80', '\xff' };
+	int urlsafe, j;
+
+	for (i = 0; i < sizeof(raw); i++) {
+		raw[i] = rand();
+	}
+
+	for (urlsafe = 0; urlsafe <= 1; urlsafe++) {
+		for (len = 1; len <= sizeof(raw); len++) {
+			/* The generic code gives the reference results */
+			g_base64_encode_x86 = NULL;
+			g_base64_decode_x86 = NULL;
+			if (urlsafe) {
+				CU_ASSERT(spdk_base64_urlsafe_encode(text_ref, raw, len) == 0);
+			} else {
+				CU_ASSERT(spdk_base64_encode(text_ref, raw, len) == 0);
+			}
+
+			g_base64_encode_x86 = encode_fn;
+			g_base64_decode_x86 = decode_fn;
+			memset(text, 0xa5, sizeof(text));
+			memset(dec, 0xa5, sizeof(dec));
+			if (urlsafe) {
+				CU_ASSERT(spdk_base64_urlsafe_encode(text, raw, len) == 0);
+				CU_ASSERT(spdk_base64_urlsafe_decode(dec, &dec_len, text) == 0);
+			} else {
+				CU_ASSERT(spdk_base64_encode(text, raw, len) == 0);
+				CU_ASSERT(spdk_base64_decode(dec, &dec_len, text) == 0);
+			}
+			CU_ASSERT(strcmp(text, text_ref) == 0);
+			CU_ASSERT(dec_len == len);
+			CU_ASSERT(memcmp(dec, raw, len) == 0);
+			/* Nothing is written past the decoded data */
+			CU_ASSERT(dec[len] == 0xa5);
+		}
+
+		/* An invalid character anywhere must be caught */
+		text_len = strlen(text);
+		for (i = 0; i < text_len; i++) {
+			if (text[i] == '=') {
+				break;
+			}
+			for (j = 0; j < (int)sizeof(invalid); j++) {
+				if (invalid[j] == '=' && i + 4 >= text_len) {
+					/* That's valid padding of a shorter string */
+					continue;
+				}
+				memcpy(bad, text, text_len + 1);
+				bad[i] = invalid[j];
+				if (urlsafe) {
+					CU_ASSERT(spdk_base64_urlsafe_decode(raw_ref, &dec_len, bad) == -EINVAL);
+				} else {
+					CU_ASSERT(spdk_base64_decode(raw_ref, &dec_len, bad) == -EINVAL);
+				}
+			}
+			/* Characters of the other alphabet are invalid too */
+			memcpy(bad, text, text_len + 1);
+			bad[i] = urlsafe ? '+' : '-';
+			if (urlsafe) {
+				CU_ASSERT(spdk_base64_urlsafe_decode(raw_ref, &dec_len, bad) == -EINVAL);
+			} else {
+				CU_ASSERT(spdk_base64_decode(raw_ref, &dec_len, bad) == -EINVAL);
+			}
+		}
+	}
+}
+
+static void
+test_base64_x86_kernels(void)
+{
+	void (*encode_fn)(char **, const char *, const void **, size_t *) = g_base64_encode_x86;
+	void (*decode_fn)(void **, const uint8_t *, const uint8_t **, size_t *) = g_base64_decode_x86;
+
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		check_base64_x86_kernel(base64_encode_avx2, base64_decode_avx2);
+	}
+	if (__builtin_cpu_supports("avx512vbmi") && __builtin_cpu_supports("avx512bw")) {
+		check_base64_x86_kernel(base64_encode_avx512vbmi, base64_decode_avx512vbmi);
+	}
+
+	g_base64_encode_x86 = encode_fn;
+	g_base64_decode_x86 = decode_fn;
+}
+#endif
+
 int
 main(int argc, char **argv)
 {
@@ -340,6 +434,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_base64_decode);
 	CU_ADD_TEST(suite, test_base64_urlsafe_encode);
 	CU_ADD_TEST(suite, test_base64_urlsafe_decode);
+#ifdef __x86_64__
+	CU_ADD_TEST(suite, test_base64_x86_kernels);
+#endif
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
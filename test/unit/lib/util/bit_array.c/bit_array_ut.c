@@ -317,6 +317,132 @@ test_mask_clear(void)
 	spdk_bit_array_free(&ba);
 }
 
+static void
+test_find_long(void)
+{
+	struct spdk_bit_array *ba;
+	uint32_t num_bits = 64 * 1024 + 13;
+	uint32_t i, pos[] = { 0, 63, 64, 1000, 4095, 4096, 33333, 64 * 1024 - 1, 64 * 1024 + 12 };
+
+	ba = spdk_bit_array_create(num_bits);
+	SPDK_CU_ASSERT_FATAL(ba != NULL);
+
+	/* Single set bits far apart exercise the block skipping of every kernel */
+	for (i = 0; i < SPDK_COUNTOF(pos); i++) {
+		CU_ASSERT(spdk_bit_array_find_first_set(ba, 0) == (i == 0 ? UINT32_MAX : pos[0]));
+		CU_ASSERT(spdk_bit_array_set(ba, pos[i]) == 0);
+		CU_ASSERT(spdk_bit_array_find_first_set(ba, i == 0 ? 0 : pos[i - 1] + 1) == pos[i]);
+	}
+	CU_ASSERT(spdk_bit_array_find_first_set(ba, pos[SPDK_COUNTOF(pos) - 1] + 1) == UINT32_MAX);
+
+	/* Same with single cleared bits */
+	for (i = 0; i < num_bits; i++) {
+		spdk_bit_array_set(ba, i);
+	}
+	CU_ASSERT(spdk_bit_array_find_first_clear(ba, 0) == UINT32_MAX);
+	for (i = 0; i < SPDK_COUNTOF(pos); i++) {
+		spdk_bit_array_clear(ba, pos[i]);
+		CU_ASSERT(spdk_bit_array_find_first_clear(ba, i == 0 ? 0 : pos[i - 1] + 1) == pos[i]);
+	}
+	CU_ASSERT(spdk_bit_array_find_first_clear(ba, pos[SPDK_COUNTOF(pos) - 1] + 1) == UINT32_MAX);
+
+	/* The basic kernel must agree with the selected one */
+	for (i = 0; i < bit_array_word_count(num_bits); i += 7) {
+		CU_ASSERT(bit_array_skip_words(ba->words, i, bit_array_word_count(num_bits),
+					       ~SPDK_BIT_ARRAY_WORD_C(0)) ==
+			  bit_array_skip_words_basic(ba->words, i, bit_array_word_count(num_bits),
+					  ~SPDK_BIT_ARRAY_WORD_C(0)));
+	}
+
+	spdk_bit_array_free(&ba);
+}
+
+static void
+test_find_run(void)
+{
+	struct spdk_bit_array *ba;
+	uint32_t i;
+
+	ba = spdk_bit_array_create(1000);
+	SPDK_CU_ASSERT_FATAL(ba != NULL);
+
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 0, 0) == UINT32_MAX);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 0, 1000) == 0);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 0, 1001) == UINT32_MAX);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 10, 990) == 10);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 10, 991) == UINT32_MAX);
+
+	/* Fragment the array: every 10th bit is set, except for a hole at [500, 700) */
+	for (i = 0; i < 1000; i += 10) {
+		if (i < 500 || i >= 700) {
+			spdk_bit_array_set(ba, i);
+		}
+	}
+
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 0, 9) == 1);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 5, 9) == 11);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 0, 10) == 491);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 0, 209) == 491);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 0, 210) == UINT32_MAX);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 600, 10) == 600);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 991, 9) == 991);
+	CU_ASSERT(spdk_bit_array_find_first_clear_run(ba, 992, 9) == UINT32_MAX);
+
+	spdk_bit_array_free(&ba);
+}
+
+static void
+test_bit_pool(void)
+{
+	struct spdk_bit_pool *pool;
+	uint32_t num_bits = 64 * 100 + 7;
+	uint32_t i;
+
+	pool = spdk_bit_pool_create(num_bits);
+	SPDK_CU_ASSERT_FATAL(pool != NULL);
+
+	for (i = 0; i < num_bits; i++) {
+		CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == i);
+	}
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == UINT32_MAX);
+	CU_ASSERT(spdk_bit_pool_count_free(pool) == 0);
+
+	/* Free bits across fully allocated words, they must be found again in order */
+	spdk_bit_pool_free_bit(pool, 6000);
+	spdk_bit_pool_free_bit(pool, 130);
+	spdk_bit_pool_free_bit(pool, num_bits - 1);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == 130);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == 6000);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == num_bits - 1);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == UINT32_MAX);
+
+	/* Contiguous allocations skip the holes that are too short */
+	spdk_bit_pool_free_bit(pool, 10);
+	for (i = 1000; i < 1100; i++) {
+		spdk_bit_pool_free_bit(pool, i);
+	}
+	CU_ASSERT(spdk_bit_pool_allocate_contig_bits(pool, 0) == UINT32_MAX);
+	CU_ASSERT(spdk_bit_pool_allocate_contig_bits(pool, 102) == UINT32_MAX);
+	CU_ASSERT(spdk_bit_pool_allocate_contig_bits(pool, 101) == UINT32_MAX);
+	CU_ASSERT(spdk_bit_pool_allocate_contig_bits(pool, 64) == 1000);
+	CU_ASSERT(spdk_bit_pool_count_free(pool) == 37);
+	CU_ASSERT(spdk_bit_pool_allocate_contig_bits(pool, 37) == UINT32_MAX);
+	CU_ASSERT(spdk_bit_pool_allocate_contig_bits(pool, 36) == 1064);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == 10);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == UINT32_MAX);
+
+	/* Growing the pool makes the new bits available */
+	CU_ASSERT(spdk_bit_pool_resize(&pool, num_bits + 200) == 0);
+	CU_ASSERT(spdk_bit_pool_allocate_contig_bits(pool, 200) == num_bits);
+	CU_ASSERT(spdk_bit_pool_count_free(pool) == 0);
+
+	spdk_bit_pool_free_all_bits(pool);
+	CU_ASSERT(spdk_bit_pool_allocate_contig_bits(pool, num_bits + 200) == 0);
+
+	spdk_bit_pool_free(&pool);
+	CU_ASSERT(pool == NULL);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -335,6 +461,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_count);
 	CU_ADD_TEST(suite, test_mask_store_load);
 	CU_ADD_TEST(suite, test_mask_clear);
+	CU_ADD_TEST(suite, test_find_long);
+	CU_ADD_TEST(suite, test_find_run);
+	CU_ADD_TEST(suite, test_bit_pool);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
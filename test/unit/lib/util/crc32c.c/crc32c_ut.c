@@ -164,6 +164,62 @@ test_crc32c_nvme(void)
 	CU_ASSERT(crc == 0x214941A8);
 }
 
+static uint32_t
+ut_crc32c_bitwise(const uint8_t *buf, size_t len, uint32_t crc)
+{
+	size_t i;
+	int j;
+
+	for (i = 0; i < len; i++) {
+		crc ^= buf[i];
+		for (j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ (SPDK_CRC32C_POLYNOMIAL_REFLECT & -(crc & 1));
+		}
+	}
+
+	return crc;
+}
+
+static void
+test_crc32c_lengths(void)
+{
+	/* Cover the aligned head, both main loops (including the interleaved lanes) and the tail */
+	size_t lens[] = { 1, 7, 8, 9, 63, 1024, 3 * 1024 - 1, 3 * 1024, 3 * 1024 + 9, 7 * 1024 + 5 };
+	size_t buf_size = 8 * 1024, i, off, split;
+	uint8_t *buf;
+	uint32_t crc, expected;
+
+	buf = malloc(buf_size);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	for (i = 0; i < buf_size; i++) {
+		buf[i] = (uint8_t)(i * 7 + (i >> 8));
+	}
+
+	for (i = 0; i < SPDK_COUNTOF(lens); i++) {
+		for (off = 0; off < 8; off++) {
+			expected = ut_crc32c_bitwise(buf + off, lens[i], 0xFFFFFFFFu);
+			crc = spdk_crc32c_update(buf + off, lens[i], 0xFFFFFFFFu);
+			CU_ASSERT(crc == expected);
+#ifdef SPDK_HAVE_SSE4_2_DISPATCH
+			crc = crc32c_update_table(buf + off, lens[i], 0xFFFFFFFFu);
+			CU_ASSERT(crc == expected);
+			if (__builtin_cpu_supports("sse4.2")) {
+				crc = crc32c_update_sse4_2(buf + off, lens[i], 0xFFFFFFFFu);
+				CU_ASSERT(crc == expected);
+			}
+#endif
+
+			/* Chaining the updates must give the same result as one pass */
+			split = lens[i] / 3;
+			crc = spdk_crc32c_update(buf + off, split, 0xFFFFFFFFu);
+			crc = spdk_crc32c_update(buf + off + split, lens[i] - split, crc);
+			CU_ASSERT(crc == expected);
+		}
+	}
+
+	free(buf);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -176,6 +232,7 @@ main(int argc, char **argv)
 
 	CU_ADD_TEST(suite, test_crc32c);
 	CU_ADD_TEST(suite, test_crc32c_nvme);
+	CU_ADD_TEST(suite, test_crc32c_lengths);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
@@ -58,6 +58,36 @@ test_crc64_nvme(void)
 	CU_ASSERT(crc == 0x9A2DF64B8E9E517E);
 }
 
+static void
+test_crc64_nvme_unaligned(void)
+{
+	uint8_t buf[256 + 8];
+	uint64_t crc, expected;
+	size_t i, off, len;
+	int j;
+
+	for (i = 0; i < sizeof(buf); i++) {
+		buf[i] = (uint8_t)(i * 13 + 1);
+	}
+
+	/* Compare the sliced implementation against a bitwise one for every head/tail split */
+	for (off = 0; off < 8; off++) {
+		for (len = 0; len <= 256; len += 3) {
+			expected = ~0ULL;
+			for (i = 0; i < len; i++) {
+				expected ^= buf[off + i];
+				for (j = 0; j < 8; j++) {
+					expected = (expected >> 1) ^ (0x9a6c9329ac4bc9b5ULL & -(expected & 1));
+				}
+			}
+			expected = ~expected;
+
+			crc = spdk_crc64_nvme(buf + off, len, 0);
+			CU_ASSERT(crc == expected);
+		}
+	}
+}
+
 int
 main(int argc, char **argv)
 {
@@ -70,6 +100,7 @@ main(int argc, char **argv)
 	suite = CU_add_suite("crc64", NULL, NULL);
 
 	CU_ADD_TEST(suite, test_crc64_nvme);
+	CU_ADD_TEST(suite, test_crc64_nvme_unaligned);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 
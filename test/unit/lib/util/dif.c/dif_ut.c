@@ -534,6 +534,82 @@ dif_apptag_mask_test(void)
 	_dif_apptag_mask_test(SPDK_DIF_PI_FORMAT_32);
 }
 
+static void
+_dif_verify_multi_block_test(enum spdk_dif_pi_format dif_pi_format)
+{
+	struct spdk_dif_ctx ctx = {};
+	struct spdk_dif_ctx_init_ext_opts dif_opts;
+	struct spdk_dif_error err_blk = {};
+	struct iovec iov;
+	uint32_t dif_flags, i;
+	uint8_t *dif;
+	int rc;
+
+	dif_flags = SPDK_DIF_FLAGS_GUARD_CHECK | SPDK_DIF_FLAGS_APPTAG_CHECK |
+		    SPDK_DIF_FLAGS_REFTAG_CHECK;
+
+	_iov_alloc_buf(&iov, (4096 + 16) * 4);
+
+	rc = ut_data_pattern_generate(&iov, 1, 4096 + 16, 16, 4);
+	CU_ASSERT(rc == 0);
+
+	/* The storage tag space of the 32b guard format is left as is by generate */
+	for (i = 0; i < 4; i++) {
+		dif = (uint8_t *)iov.iov_base + (4096 + 16) * i + 4096;
+		dif[6] = 0xAB;
+		dif[7] = 0xCD;
+	}
+
+	dif_opts.size = SPDK_SIZEOF(&dif_opts, dif_pi_format);
+	dif_opts.dif_pi_format = dif_pi_format;
+	rc = spdk_dif_ctx_init(&ctx, 4096 + 16, 16, true, true, SPDK_DIF_TYPE1, dif_flags,
+			       22, 0xFFFF, 0x1234, 0, 0, &dif_opts);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_dif_generate(&iov, 1, 4, &ctx);
+	CU_ASSERT(rc == 0);
+
+	if (dif_pi_format == SPDK_DIF_PI_FORMAT_32) {
+		for (i = 0; i < 4; i++) {
+			dif = (uint8_t *)iov.iov_base + (4096 + 16) * i + 4096;
+			CU_ASSERT(dif[6] == 0xAB);
+			CU_ASSERT(dif[7] == 0xCD);
+		}
+	}
+
+	rc = spdk_dif_verify(&iov, 1, 4, &ctx, &err_blk);
+	CU_ASSERT(rc == 0);
+
+	/* All checks of a block are disabled by an Application Tag of 0xFFFF */
+	dif = (uint8_t *)iov.iov_base + (4096 + 16) + 4096;
+	dif[0] ^= 0xFF;
+	dif[_dif_apptag_offset(dif_pi_format)] = 0xFF;
+	dif[_dif_apptag_offset(dif_pi_format) + 1] = 0xFF;
+
+	rc = spdk_dif_verify(&iov, 1, 4, &ctx, &err_blk);
+	CU_ASSERT(rc == 0);
+
+	/* The error is reported for the first block that doesn't match */
+	dif = (uint8_t *)iov.iov_base + (4096 + 16) * 3 + 4096;
+	dif[_dif_reftag_offset(dif_pi_format) + _dif_reftag_size(dif_pi_format) - 1] ^= 0x1;
+
+	rc = spdk_dif_verify(&iov, 1, 4, &ctx, &err_blk);
+	CU_ASSERT(rc != 0);
+	CU_ASSERT(err_blk.err_type == SPDK_DIF_REFTAG_ERROR);
+	CU_ASSERT(err_blk.expected == 22 + 3);
+	CU_ASSERT(err_blk.err_offset == 3);
+
+	_iov_free_buf(&iov);
+}
+
+static void
+dif_verify_multi_block_test(void)
+{
+	_dif_verify_multi_block_test(SPDK_DIF_PI_FORMAT_16);
+	_dif_verify_multi_block_test(SPDK_DIF_PI_FORMAT_32);
+	_dif_verify_multi_block_test(SPDK_DIF_PI_FORMAT_64);
+}
+
 static void
 dif_sec_8_md_8_error_test(void)
 {
@@ -4538,6 +4614,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, dif_disable_check_test);
 	CU_ADD_TEST(suite, dif_generate_and_verify_different_pi_formats_test);
 	CU_ADD_TEST(suite, dif_apptag_mask_test);
+	CU_ADD_TEST(suite, dif_verify_multi_block_test);
 	CU_ADD_TEST(suite, dif_sec_8_md_8_error_test);
 	CU_ADD_TEST(suite, dif_sec_512_md_0_error_test);
 	CU_ADD_TEST(suite, dif_sec_512_md_16_error_test);
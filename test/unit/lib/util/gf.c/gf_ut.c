@@ -0,0 +1,270 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+
+#include "util/gf.c"
+#include "common/lib/test_env.c"
+
+#define SRC_BUF_COUNT 6
+#define BUF_SIZE (4096 + 40)
+
+/* Bitwise reference multiplication */
+static uint8_t
+ref_gf_mul(uint8_t a, uint8_t b)
+{
+	uint32_t x = a;
+	uint8_t p = 0;
+
+	while (b) {
+		if (b & 1) {
+			p ^= x;
+		}
+		b >>= 1;
+		x <<= 1;
+		if (x & 0x100) {
+			x ^= GF_POLY;
+		}
+	}
+
+	return p;
+}
+
+static void
+test_gf_arith(void)
+{
+	uint32_t a, b;
+
+	for (a = 0; a < 256; a++) {
+		for (b = 0; b < 256; b++) {
+			CU_ASSERT(spdk_gf_mul(a, b) == ref_gf_mul(a, b));
+		}
+	}
+
+	for (a = 1; a < 256; a++) {
+		CU_ASSERT(spdk_gf_mul(a, spdk_gf_inv(a)) == 1);
+	}
+	CU_ASSERT(spdk_gf_inv(0) == 0);
+
+	CU_ASSERT(spdk_gf_pow2(0) == 1);
+	CU_ASSERT(spdk_gf_pow2(1) == 2);
+	CU_ASSERT(spdk_gf_pow2(8) == 0x1d);
+	CU_ASSERT(spdk_gf_pow2(255) == 1);
+	for (a = 0; a < 300; a++) {
+		CU_ASSERT(spdk_gf_mul(spdk_gf_pow2(a), 2) == spdk_gf_pow2(a + 1));
+	}
+}
+
+static void
+ref_dot_prod(uint8_t *dest, void **sources, uint32_t n, const uint8_t *coefs, uint32_t len)
+{
+	uint32_t i, j;
+
+	for (i = 0; i < len; i++) {
+		uint8_t v = 0;
+
+		for (j = 0; j < n; j++) {
+			v ^= ref_gf_mul(coefs[j], ((uint8_t *)sources[j])[i]);
+		}
+		dest[i] = v;
+	}
+}
+
+static void
+test_gf_dot_prod(void)
+{
+	void *bufs[SRC_BUF_COUNT];
+	void *dests[SPDK_GF_DOT_PROD_MAX_DESTS];
+	uint8_t *ref[SPDK_GF_DOT_PROD_MAX_DESTS];
+	uint8_t coefs[SPDK_GF_DOT_PROD_MAX_DESTS * SRC_BUF_COUNT];
+	uint32_t lens[] = { 1, 31, 32, 4096, BUF_SIZE };
+	size_t i, j, l;
+	int ret;
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		bufs[i] = malloc(BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(bufs[i] != NULL);
+		for (j = 0; j < BUF_SIZE; j++) {
+			((uint8_t *)bufs[i])[j] = rand();
+		}
+	}
+
+	for (i = 0; i < SPDK_GF_DOT_PROD_MAX_DESTS; i++) {
+		/* one extra byte to check nothing is written past len */
+		dests[i] = malloc(BUF_SIZE + 1);
+		SPDK_CU_ASSERT_FATAL(dests[i] != NULL);
+		ref[i] = malloc(BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(ref[i] != NULL);
+	}
+
+	/* Row 0 is the P (xor) syndrome, including a zero coefficient, row 1 is random */
+	for (j = 0; j < SRC_BUF_COUNT; j++) {
+		coefs[j] = j == 3 ? 0 : 1;
+		coefs[SRC_BUF_COUNT + j] = rand();
+	}
+
+	for (i = 0; i < SPDK_GF_DOT_PROD_MAX_DESTS; i++) {
+		ref_dot_prod(ref[i], bufs, SRC_BUF_COUNT, &coefs[i * SRC_BUF_COUNT], BUF_SIZE);
+	}
+
+	for (l = 0; l < SPDK_COUNTOF(lens); l++) {
+		for (i = 0; i < SPDK_GF_DOT_PROD_MAX_DESTS; i++) {
+			memset(dests[i], 0xba, BUF_SIZE + 1);
+		}
+
+		ret = spdk_gf_dot_prod(dests, SPDK_GF_DOT_PROD_MAX_DESTS, bufs, SRC_BUF_COUNT, coefs, lens[l]);
+		CU_ASSERT(ret == 0);
+		for (i = 0; i < SPDK_GF_DOT_PROD_MAX_DESTS; i++) {
+			CU_ASSERT(memcmp(ref[i], dests[i], lens[l]) == 0);
+			CU_ASSERT(((uint8_t *)dests[i])[lens[l]] == 0xba);
+		}
+
+		/* A single destination with the second row of coefficients */
+		memset(dests[0], 0xba, BUF_SIZE + 1);
+		ret = spdk_gf_dot_prod(dests, 1, bufs, SRC_BUF_COUNT, &coefs[SRC_BUF_COUNT], lens[l]);
+		CU_ASSERT(ret == 0);
+		CU_ASSERT(memcmp(ref[1], dests[0], lens[l]) == 0);
+		CU_ASSERT(((uint8_t *)dests[0])[lens[l]] == 0xba);
+	}
+
+	/* Unaligned buffers */
+	bufs[1] += 1;
+	bufs[4] += 3;
+	dests[1] += 5;
+	for (i = 0; i < SPDK_GF_DOT_PROD_MAX_DESTS; i++) {
+		ref_dot_prod(ref[i], bufs, SRC_BUF_COUNT, &coefs[i * SRC_BUF_COUNT], BUF_SIZE - 5);
+	}
+	ret = spdk_gf_dot_prod(dests, SPDK_GF_DOT_PROD_MAX_DESTS, bufs, SRC_BUF_COUNT, coefs,
+			       BUF_SIZE - 5);
+	CU_ASSERT(ret == 0);
+	for (i = 0; i < SPDK_GF_DOT_PROD_MAX_DESTS; i++) {
+		CU_ASSERT(memcmp(ref[i], dests[i], BUF_SIZE - 5) == 0);
+	}
+	bufs[1] -= 1;
+	bufs[4] -= 3;
+	dests[1] -= 5;
+
+	/* Invalid parameters */
+	ret = spdk_gf_dot_prod(dests, 0, bufs, SRC_BUF_COUNT, coefs, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+	ret = spdk_gf_dot_prod(dests, SPDK_GF_DOT_PROD_MAX_DESTS + 1, bufs, SRC_BUF_COUNT, coefs,
+			       BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+	ret = spdk_gf_dot_prod(dests, 1, bufs, 0, coefs, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		free(bufs[i]);
+	}
+	for (i = 0; i < SPDK_GF_DOT_PROD_MAX_DESTS; i++) {
+		free(dests[i]);
+		free(ref[i]);
+	}
+}
+
+static void
+test_gf_pq_recover(void)
+{
+	void *data[SRC_BUF_COUNT];
+	void *sources[SRC_BUF_COUNT];
+	void *pq[2], *dests[2];
+	uint8_t coefs[2 * SRC_BUF_COUNT];
+	uint8_t *rec[2];
+	uint8_t a, b, d;
+	uint32_t x = 1, y = 4;
+	size_t i, j, n;
+	int ret;
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		data[i] = malloc(BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(data[i] != NULL);
+		for (j = 0; j < BUF_SIZE; j++) {
+			((uint8_t *)data[i])[j] = rand();
+		}
+	}
+	for (i = 0; i < 2; i++) {
+		pq[i] = malloc(BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(pq[i] != NULL);
+		rec[i] = malloc(BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(rec[i] != NULL);
+	}
+
+	/* P = sum(D_i), Q = sum({02}^i * D_i) */
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		coefs[i] = 1;
+		coefs[SRC_BUF_COUNT + i] = spdk_gf_pow2(i);
+	}
+	ret = spdk_gf_dot_prod(pq, 2, data, SRC_BUF_COUNT, coefs, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+
+	/*
+	 * Recover D_x and D_y from P, Q and the remaining data:
+	 * D_x = A * P + B * Q + sum((A + B * {02}^i) * D_i), D_y = P + D_x + sum(D_i),
+	 * where A = {02}^y / ({02}^x + {02}^y) and B = 1 / ({02}^x + {02}^y).
+	 */
+	d = spdk_gf_inv(spdk_gf_pow2(x) ^ spdk_gf_pow2(y));
+	a = spdk_gf_mul(spdk_gf_pow2(y), d);
+	b = d;
+
+	n = 0;
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		if (i == x || i == y) {
+			continue;
+		}
+		sources[n] = data[i];
+		coefs[n] = a ^ spdk_gf_mul(b, spdk_gf_pow2(i));
+		coefs[SRC_BUF_COUNT + n] = 1 ^ coefs[n];
+		n++;
+	}
+	sources[n] = pq[0];
+	coefs[n] = a;
+	coefs[SRC_BUF_COUNT + n] = 1 ^ a;
+	n++;
+	sources[n] = pq[1];
+	coefs[n] = b;
+	coefs[SRC_BUF_COUNT + n] = b;
+	n++;
+
+	/* The second row has to start right after the first one */
+	memmove(&coefs[n], &coefs[SRC_BUF_COUNT], n);
+
+	dests[0] = rec[0];
+	dests[1] = rec[1];
+	ret = spdk_gf_dot_prod(dests, 2, sources, n, coefs, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(rec[0], data[x], BUF_SIZE) == 0);
+	CU_ASSERT(memcmp(rec[1], data[y], BUF_SIZE) == 0);
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		free(data[i]);
+	}
+	for (i = 0; i < 2; i++) {
+		free(pq[i]);
+		free(rec[i]);
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("gf", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_gf_arith);
+	CU_ADD_TEST(suite, test_gf_dot_prod);
+	CU_ADD_TEST(suite, test_gf_pq_recover);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
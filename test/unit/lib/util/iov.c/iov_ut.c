@@ -327,6 +327,59 @@ test_iov_xfer(void)
 	}
 }
 
+static void
+test_large_copy(void)
+{
+	size_t total = IOV_NT_COPY_THRESHOLD + 4099;
+	uint8_t *src, *dst, *buf;
+	struct iovec siov[3], diov[2];
+	struct spdk_iov_xfer ix;
+	size_t i;
+
+	/* One extra byte to misalign the buffers */
+	src = malloc(total + 1);
+	dst = malloc(total + 1);
+	buf = malloc(total + 1);
+	SPDK_CU_ASSERT_FATAL(src != NULL && dst != NULL && buf != NULL);
+
+	for (i = 0; i < total; i++) {
+		src[i + 1] = i * 7;
+	}
+
+	/* Segments of all sizes, above and below the non-temporal minimum, at odd offsets */
+	siov[0].iov_base = src + 1;
+	siov[0].iov_len = 100;
+	siov[1].iov_base = src + 101;
+	siov[1].iov_len = IOV_NT_COPY_THRESHOLD / 2 + 3;
+	siov[2].iov_base = (uint8_t *)siov[1].iov_base + siov[1].iov_len;
+	siov[2].iov_len = total - siov[0].iov_len - siov[1].iov_len;
+	diov[0].iov_base = dst + 1;
+	diov[0].iov_len = IOV_NT_COPY_MIN_LEN + 5;
+	diov[1].iov_base = dst + 1 + diov[0].iov_len;
+	diov[1].iov_len = total - diov[0].iov_len;
+
+	memset(dst, 0, total + 1);
+	CU_ASSERT(spdk_iovcpy(siov, 3, diov, 2) == total);
+	CU_ASSERT(memcmp(dst + 1, src + 1, total) == 0);
+	CU_ASSERT(dst[0] == 0);
+
+	memset(buf, 0, total + 1);
+	spdk_iov_xfer_init(&ix, siov, 3);
+	CU_ASSERT(spdk_iov_xfer_to_buf(&ix, buf + 1, total) == total);
+	CU_ASSERT(memcmp(buf + 1, src + 1, total) == 0);
+	CU_ASSERT(buf[0] == 0);
+
+	memset(dst, 0, total + 1);
+	spdk_iov_xfer_init(&ix, diov, 2);
+	CU_ASSERT(spdk_iov_xfer_from_buf(&ix, buf + 1, total) == total);
+	CU_ASSERT(memcmp(dst + 1, src + 1, total) == 0);
+	CU_ASSERT(dst[0] == 0);
+
+	free(buf);
+	free(dst);
+	free(src);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -345,6 +398,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_memset);
 	CU_ADD_TEST(suite, test_iov_one);
 	CU_ADD_TEST(suite, test_iov_xfer);
+	CU_ADD_TEST(suite, test_large_copy);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
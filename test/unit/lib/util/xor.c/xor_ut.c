@@ -97,6 +97,68 @@ test_xor_gen(void)
 	free(ref);
 }
 
+#define WIDE_SRC_BUF_COUNT 16
+#define WIDE_BUF_SIZE (256 * 1024 + 72)
+
+static void
+test_xor_gen_wide(void)
+{
+	void *bufs[WIDE_SRC_BUF_COUNT];
+	uint8_t *ref, *dest;
+	uint32_t lens[] = { 64, 127, 4096 + 8, WIDE_BUF_SIZE };
+	int ret;
+	size_t i, j, l;
+
+	for (i = 0; i < WIDE_SRC_BUF_COUNT; i++) {
+		ret = posix_memalign(&bufs[i], 64, WIDE_BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(ret == 0);
+
+		for (j = 0; j < WIDE_BUF_SIZE; j++) {
+			((uint8_t *)bufs[i])[j] = (uint8_t)(i * 31 + j * 7 + (j >> 9));
+		}
+	}
+
+	/* one extra cache line to check nothing is written past len */
+	ret = posix_memalign((void **)&dest, 64, WIDE_BUF_SIZE + 64);
+	SPDK_CU_ASSERT_FATAL(ret == 0);
+	ref = calloc(1, WIDE_BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ref != NULL);
+
+	for (i = 0; i < WIDE_SRC_BUF_COUNT; i++) {
+		for (j = 0; j < WIDE_BUF_SIZE; j++) {
+			ref[j] ^= ((uint8_t *)bufs[i])[j];
+		}
+	}
+
+	/* Cover whole cache line blocks, partial blocks and the non-temporal store path */
+	for (l = 0; l < SPDK_COUNTOF(lens); l++) {
+		memset(dest, 0xba, WIDE_BUF_SIZE + 64);
+		ret = spdk_xor_gen(dest, bufs, WIDE_SRC_BUF_COUNT, lens[l]);
+		CU_ASSERT(ret == 0);
+		CU_ASSERT(memcmp(ref, dest, lens[l]) == 0);
+		CU_ASSERT(dest[lens[l]] == 0xba);
+
+		memset(dest, 0xba, WIDE_BUF_SIZE + 64);
+		xor_gen_basic(dest, bufs, WIDE_SRC_BUF_COUNT, lens[l]);
+		CU_ASSERT(memcmp(ref, dest, lens[l]) == 0);
+		CU_ASSERT(dest[lens[l]] == 0xba);
+#if !defined(SPDK_CONFIG_ISAL) && defined(__x86_64__)
+		if (__builtin_cpu_supports("avx2")) {
+			memset(dest, 0xba, WIDE_BUF_SIZE + 64);
+			xor_gen_avx2(dest, bufs, WIDE_SRC_BUF_COUNT, lens[l]);
+			CU_ASSERT(memcmp(ref, dest, lens[l]) == 0);
+			CU_ASSERT(dest[lens[l]] == 0xba);
+		}
+#endif
+	}
+
+	for (i = 0; i < WIDE_SRC_BUF_COUNT; i++) {
+		free(bufs[i]);
+	}
+	free(dest);
+	free(ref);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -108,6 +170,7 @@ main(int argc, char **argv)
 	suite = CU_add_suite("xor", NULL, NULL);
 
 	CU_ADD_TEST(suite, test_xor_gen);
+	CU_ADD_TEST(suite, test_xor_gen_wide);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
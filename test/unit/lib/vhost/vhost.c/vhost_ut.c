@@ -115,7 +115,6 @@ DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
 DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
 		struct spdk_bdev_io_wait_entry *entry), 0);
 DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
-DEFINE_STUB(spdk_bdev_get_io_channel, struct spdk_io_channel *, (struct spdk_bdev_desc *desc), 0);
 DEFINE_STUB(spdk_bdev_readv, int,
 	    (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 	     struct iovec *iov, int iovcnt, uint64_t offset, uint64_t nbytes,
@@ -135,6 +134,7 @@ DEFINE_STUB(rte_vhost_backend_config_change, int, (int vid, bool need_reply), 0)
 DEFINE_STUB(rte_vhost_slave_config_change, int, (int vid, bool need_reply), 0);
 #endif
 DEFINE_STUB(spdk_json_decode_bool, int, (const struct spdk_json_val *val, void *out), 0);
+DEFINE_STUB(spdk_json_decode_uint16, int, (const struct spdk_json_val *val, void *out), 0);
 DEFINE_STUB(spdk_json_decode_object_relaxed, int,
 	    (const struct spdk_json_val *values, const struct spdk_json_object_decoder *decoders,
 	     size_t num_decoders, void *out), 0);
@@ -145,6 +145,15 @@ spdk_call_unaffinitized(void *cb(void *arg), void *arg)
 	return cb(arg);
 }
 
+/* Registered by the tests that need bdev I/O channels */
+static int g_bdev_io_device;
+
+struct spdk_io_channel *
+spdk_bdev_get_io_channel(struct spdk_bdev_desc *desc)
+{
+	return spdk_get_io_channel(&g_bdev_io_device);
+}
+
 static struct spdk_vhost_dev_backend g_vdev_backend = {.type = VHOST_BACKEND_SCSI};
 static struct spdk_vhost_user_dev_backend g_vdev_user_backend;
 
@@ -521,6 +530,48 @@ vq_avail_ring_get_test(void)
 	}
 }
 
+static void
+vq_event_idx_test(void)
+{
+	struct spdk_vhost_session vsession = {};
+	struct spdk_vhost_virtqueue vq = {};
+	uint16_t avail_mem[35] = {};
+
+	vq.vsession = &vsession;
+	vq.vring.avail = (struct vring_avail *)avail_mem;
+	vq.vring.size = 32;
+
+	/* Without EVENT_IDX only the avail ring flags count */
+	vq.last_used_idx = 10;
+	vq.used_req_cnt = 2;
+	CU_ASSERT(!vhost_vq_event_is_suppressed(&vq));
+	vq.vring.avail->flags = VRING_AVAIL_F_NO_INTERRUPT;
+	CU_ASSERT(vhost_vq_event_is_suppressed(&vq));
+
+	/* With EVENT_IDX the flags are ignored and used_event decides */
+	vsession.negotiated_features = 1ULL << VIRTIO_RING_F_EVENT_IDX;
+
+	/* Entries 8 and 9 were used since the last signal, the guest asked for one past 7 */
+	vq.vring.avail->ring[vq.vring.size] = 7;
+	CU_ASSERT(vhost_vq_event_is_suppressed(&vq));
+
+	/* Entry 9 is the one the guest is waiting for */
+	vq.vring.avail->ring[vq.vring.size] = 9;
+	CU_ASSERT(!vhost_vq_event_is_suppressed(&vq));
+
+	/* The guest is waiting for an entry that is not used yet */
+	vq.vring.avail->ring[vq.vring.size] = 10;
+	CU_ASSERT(vhost_vq_event_is_suppressed(&vq));
+
+	/* Wrap of the used index */
+	vq.last_used_idx = 1;
+	vq.used_req_cnt = 3;
+	vq.vring.avail->ring[vq.vring.size] = 65535;
+	CU_ASSERT(!vhost_vq_event_is_suppressed(&vq));
+	vq.vring.avail->ring[vq.vring.size] = 1;
+	CU_ASSERT(vhost_vq_event_is_suppressed(&vq));
+}
+
 static bool
 vq_desc_guest_is_used(struct spdk_vhost_virtqueue *vq, int16_t guest_last_used_idx,
 		      int16_t guest_used_phase)
@@ -693,6 +744,211 @@ vhost_blk_construct_test(void)
 	CU_ASSERT(ret == 0);
 }
 
+static int
+ut_bdev_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	return 0;
+}
+
+static void
+ut_bdev_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+}
+
+/* Poll the controller thread and the vq threads, which are not managed by ut_multithread */
+static void
+poll_vq_threads(struct spdk_vhost_blk_dev *bvdev, struct spdk_thread **vq_threads)
+{
+	int i, j;
+
+	for (i = 0; i < 10; i++) {
+		spdk_delay_us(SPDK_VHOST_SESSION_STOP_RETRY_PERIOD_IN_US);
+		spdk_thread_poll(bvdev->vdev.thread, 0, 0);
+		for (j = 0; j < 2; j++) {
+			spdk_thread_poll(vq_threads[j], 0, 0);
+		}
+	}
+}
+
+static struct spdk_vhost_blk_session *
+alloc_blk_session(struct spdk_vhost_dev *vdev, uint16_t max_queues)
+{
+	struct spdk_vhost_blk_session *bvsession = NULL;
+	struct spdk_vhost_session *vsession;
+	struct spdk_vhost_virtqueue *vq;
+	uint16_t i;
+	int rc;
+
+	rc = posix_memalign((void **)&bvsession, 64, sizeof(*bvsession));
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(bvsession != NULL);
+	memset(bvsession, 0, sizeof(*bvsession));
+
+	vsession = &bvsession->vsession;
+	vsession->vdev = vdev;
+	vsession->name = "vhost.blk.vq.0";
+	vsession->started = true;
+	vsession->max_queues = max_queues;
+	sem_init(&vsession->dpdk_sem, 0, 0);
+
+	for (i = 0; i < max_queues; i++) {
+		vq = &vsession->virtqueue[i];
+		vq->vsession = vsession;
+		vq->vring_idx = i;
+		vq->vring.size = 4;
+		vq->vring.desc = calloc(vq->vring.size, sizeof(struct vring_desc));
+		vq->vring.avail = calloc(1, sizeof(struct vring_avail) + 6 * sizeof(uint16_t));
+		vq->vring.used = calloc(1, sizeof(struct vring_used) +
+					vq->vring.size * sizeof(struct vring_used_elem) + sizeof(uint16_t));
+		SPDK_CU_ASSERT_FATAL(vq->vring.desc && vq->vring.avail && vq->vring.used);
+	}
+
+	return bvsession;
+}
+
+static void
+free_blk_session(struct spdk_vhost_blk_session *bvsession)
+{
+	struct spdk_vhost_session *vsession = &bvsession->vsession;
+	uint16_t i;
+
+	for (i = 0; i < vsession->max_queues; i++) {
+		free(vsession->virtqueue[i].vring.desc);
+		free(vsession->virtqueue[i].vring.avail);
+		free(vsession->virtqueue[i].vring.used);
+	}
+
+	sem_destroy(&vsession->dpdk_sem);
+	free(bvsession);
+}
+
+static void
+vhost_blk_vq_threads_test(void)
+{
+	struct spdk_vhost_blk_session *bvsession;
+	struct spdk_vhost_session *vsession;
+	struct spdk_vhost_blk_dev *bvdev;
+	struct spdk_vhost_dev *vdev;
+	struct spdk_vhost_user_blk_task *task;
+	struct spdk_thread *vq_threads[2];
+	struct spdk_bdev bdev = {};
+	uint16_t i;
+	int rc;
+
+	spdk_io_device_register(&g_bdev_io_device, ut_bdev_ch_create_cb, ut_bdev_ch_destroy_cb, 0,
+				"ut_bdev");
+
+	rc = spdk_vhost_blk_construct("vhost.blk.vq", "0x1", "Malloc0", NULL, NULL);
+	CU_ASSERT(rc == 0);
+	vdev = spdk_vhost_dev_find("vhost.blk.vq");
+	SPDK_CU_ASSERT_FATAL(vdev != NULL);
+	bvdev = to_blk_dev(vdev);
+	bvdev->bdev = &bdev;
+	bvdev->bdev_desc = (struct spdk_bdev_desc *)0x1;
+
+	/* Spread the virtqueues across the controller thread and two more threads */
+	rc = vhost_user_blk_create_vq_threads(bvdev, NULL, 3);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(bvdev->num_vq_threads == 3);
+	vq_threads[0] = bvdev->vq_threads[0];
+	vq_threads[1] = bvdev->vq_threads[1];
+
+	/* Queues 0 and 3 are processed by the controller thread, 1 and 2 by the vq threads */
+	bvsession = alloc_blk_session(vdev, 4);
+	vsession = &bvsession->vsession;
+	for (i = 0; i < vsession->max_queues; i++) {
+		rc = alloc_vq_task_pool(vsession, i);
+		CU_ASSERT(rc == 0);
+		task = vsession->virtqueue[i].tasks;
+		SPDK_CU_ASSERT_FATAL(task != NULL);
+		CU_ASSERT(task->vq_group == (i % 3 == 0 ? NULL : &bvsession->vq_groups[i % 3 - 1]));
+	}
+
+	/* Session start registers a poller with its own I/O channel on each vq thread */
+	spdk_set_thread(vdev->thread);
+	rc = vhost_blk_start(vdev, vsession, NULL);
+	CU_ASSERT(rc == 0);
+	set_thread(0);
+	CU_ASSERT(bvdev->vq_threads_pending == 2);
+	CU_ASSERT(bvsession->vq_groups_running == 2);
+
+	poll_vq_threads(bvdev, vq_threads);
+	CU_ASSERT(bvdev->vq_threads_pending == 0);
+	CU_ASSERT(spdk_io_channel_get_thread(bvsession->io_channel) == vdev->thread);
+	for (i = 0; i < 2; i++) {
+		CU_ASSERT(bvsession->vq_groups[i].started);
+		CU_ASSERT(bvsession->vq_groups[i].first_vq == i + 1);
+		CU_ASSERT(bvsession->vq_groups[i].poller != NULL);
+		SPDK_CU_ASSERT_FATAL(bvsession->vq_groups[i].io_channel != NULL);
+		CU_ASSERT(spdk_io_channel_get_thread(bvsession->vq_groups[i].io_channel) == vq_threads[i]);
+	}
+
+	/* Hot-remove: the vq threads switch to failing requests and drop their channels */
+	spdk_set_thread(vdev->thread);
+	rc = vhost_user_session_bdev_remove_cb(vdev, vsession, NULL);
+	CU_ASSERT(rc == 0);
+	bdev_event_cpl_cb(vdev, (void *)SPDK_BDEV_EVENT_REMOVE);
+	set_thread(0);
+	CU_ASSERT(bvdev->vq_threads_pending == 2);
+
+	/* The bdev is closed only once the vq threads stopped using it */
+	CU_ASSERT(vhost_blk_destroy(vdev) == -EBUSY);
+	spdk_thread_poll(bvdev->vdev.thread, 0, 0);
+	CU_ASSERT(bvdev->bdev_desc != NULL);
+
+	poll_vq_threads(bvdev, vq_threads);
+	CU_ASSERT(bvdev->vq_threads_pending == 0);
+	CU_ASSERT(bvdev->bdev_desc == NULL);
+	CU_ASSERT(bvdev->bdev == NULL);
+	CU_ASSERT(bvsession->io_channel == NULL);
+	for (i = 0; i < 2; i++) {
+		CU_ASSERT(bvsession->vq_groups[i].io_channel == NULL);
+		CU_ASSERT(bvsession->vq_groups[i].poller != NULL);
+	}
+
+	/* Session stop waits for the tasks in flight on the vq threads */
+	bvsession->vq_groups[1].task_cnt = 1;
+	spdk_set_thread(vdev->thread);
+	rc = vhost_blk_stop(vdev, vsession, NULL);
+	CU_ASSERT(rc == 0);
+	set_thread(0);
+
+	poll_vq_threads(bvdev, vq_threads);
+	CU_ASSERT(bvsession->vq_groups_running == 1);
+	CU_ASSERT(bvsession->vq_groups[0].poller == NULL);
+	CU_ASSERT(bvsession->vq_groups[1].poller != NULL);
+	CU_ASSERT(vsession->started);
+	CU_ASSERT(vsession->virtqueue[0].tasks != NULL);
+
+	bvsession->vq_groups[1].task_cnt = 0;
+	poll_vq_threads(bvdev, vq_threads);
+	CU_ASSERT(bvsession->vq_groups_running == 0);
+	CU_ASSERT(bvsession->vq_groups[1].poller == NULL);
+	CU_ASSERT(!vsession->started);
+	CU_ASSERT(bvsession->stop_poller == NULL);
+	for (i = 0; i < vsession->max_queues; i++) {
+		CU_ASSERT(vsession->virtqueue[i].tasks == NULL);
+	}
+
+	free_blk_session(bvsession);
+
+	/* Let the vq threads exit */
+	vhost_user_blk_destroy_vq_threads(bvdev);
+	CU_ASSERT(bvdev->num_vq_threads == 1);
+	for (i = 0; i < 2; i++) {
+		while (!spdk_thread_is_exited(vq_threads[i])) {
+			spdk_thread_poll(vq_threads[i], 0, 0);
+		}
+		spdk_thread_destroy(vq_threads[i]);
+	}
+
+	rc = spdk_vhost_dev_remove(vdev);
+	CU_ASSERT(rc == 0);
+
+	spdk_io_device_unregister(&g_bdev_io_device, NULL);
+	poll_threads();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -708,8 +964,10 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, session_find_by_vid_test);
 	CU_ADD_TEST(suite, remove_controller_test);
 	CU_ADD_TEST(suite, vq_avail_ring_get_test);
+	CU_ADD_TEST(suite, vq_event_idx_test);
 	CU_ADD_TEST(suite, vq_packed_ring_test);
 	CU_ADD_TEST(suite, vhost_blk_construct_test);
+	CU_ADD_TEST(suite, vhost_blk_vq_threads_test);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
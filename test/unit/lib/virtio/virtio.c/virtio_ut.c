@@ -0,0 +1,378 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/test_env.c"
+#include "unit/lib/json_mock.c"
+#include "virtio/virtio.c"
+
+#define UT_VQ_SIZE	4
+#define UT_AVAIL_USED	(VQ_PACKED_DESC_F_AVAIL | VQ_PACKED_DESC_F_USED)
+
+static struct virtio_dev g_vdev;
+static uint8_t g_status;
+static int g_notify_count;
+
+/* Device side of the packed ring, consuming what the driver made available */
+static struct {
+	uint16_t	avail_idx;
+	bool		avail_wrap_counter;
+	uint16_t	used_idx;
+	bool		used_wrap_counter;
+} g_dev;
+
+static uint8_t
+ut_get_status(struct virtio_dev *vdev)
+{
+	return g_status;
+}
+
+static void
+ut_set_status(struct virtio_dev *vdev, uint8_t status)
+{
+	g_status = status;
+}
+
+static uint16_t
+ut_get_queue_size(struct virtio_dev *vdev, uint16_t queue_id)
+{
+	return UT_VQ_SIZE;
+}
+
+static int
+ut_setup_queue(struct virtio_dev *vdev, struct virtqueue *vq)
+{
+	if (posix_memalign(&vq->vq_ring_virt_mem, SPDK_CACHE_LINE_SIZE, vq->vq_ring_size)) {
+		return -ENOMEM;
+	}
+
+	vq->vq_ring_mem = (uintptr_t)vq->vq_ring_virt_mem;
+	return 0;
+}
+
+static void
+ut_del_queue(struct virtio_dev *vdev, struct virtqueue *vq)
+{
+	free(vq->vq_ring_virt_mem);
+}
+
+static void
+ut_notify_queue(struct virtio_dev *vdev, struct virtqueue *vq)
+{
+	g_notify_count++;
+}
+
+static void
+ut_destruct_dev(struct virtio_dev *vdev)
+{
+}
+
+static const struct virtio_dev_ops g_ut_ops = {
+	.get_status = ut_get_status,
+	.set_status = ut_set_status,
+	.destruct_dev = ut_destruct_dev,
+	.get_queue_size = ut_get_queue_size,
+	.setup_queue = ut_setup_queue,
+	.del_queue = ut_del_queue,
+	.notify_queue = ut_notify_queue,
+};
+
+static struct virtqueue *
+ut_start(void)
+{
+	int rc;
+
+	memset(&g_vdev, 0, sizeof(g_vdev));
+	memset(&g_dev, 0, sizeof(g_dev));
+	g_dev.avail_wrap_counter = true;
+	g_dev.used_wrap_counter = true;
+	g_status = 0;
+	g_notify_count = 0;
+
+	rc = virtio_dev_construct(&g_vdev, "virtio_ut", &g_ut_ops, NULL);
+	CU_ASSERT(rc == 0);
+	g_vdev.negotiated_features = 1ULL << VIRTIO_F_RING_PACKED;
+
+	rc = virtio_dev_start(&g_vdev, 1, 0);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_vdev.vqs != NULL && g_vdev.vqs[0] != NULL);
+	CU_ASSERT(g_vdev.vqs[0]->vq_packed);
+
+	return g_vdev.vqs[0];
+}
+
+static void
+ut_stop(void)
+{
+	virtio_dev_stop(&g_vdev);
+	virtio_dev_destruct(&g_vdev);
+}
+
+static bool
+ut_dev_desc_is_avail(struct virtqueue *vq, uint16_t idx, bool wrap_counter)
+{
+	uint16_t flags = vq->vq_packed_ring.desc[idx].flags;
+
+	return !!(flags & VQ_PACKED_DESC_F_AVAIL) == wrap_counter &&
+	       !!(flags & VQ_PACKED_DESC_F_USED) != wrap_counter;
+}
+
+/* Fetch the next available chain, return the number of its descriptors or 0 */
+static uint16_t
+ut_dev_fetch(struct virtqueue *vq, uint16_t *id, void **addrs)
+{
+	struct vring_packed_desc *desc;
+	uint16_t ndescs = 0;
+
+	while (ut_dev_desc_is_avail(vq, g_dev.avail_idx, g_dev.avail_wrap_counter)) {
+		desc = &vq->vq_packed_ring.desc[g_dev.avail_idx];
+		*id = desc->id;
+		if (addrs != NULL) {
+			addrs[ndescs] = (void *)(uintptr_t)desc->addr;
+		}
+		ndescs++;
+
+		if (++g_dev.avail_idx == vq->vq_nentries) {
+			g_dev.avail_idx = 0;
+			g_dev.avail_wrap_counter = !g_dev.avail_wrap_counter;
+		}
+
+		if (!(desc->flags & VRING_DESC_F_NEXT)) {
+			break;
+		}
+	}
+
+	return ndescs;
+}
+
+/* Write a single used descriptor for a chain of ndescs descriptors */
+static void
+ut_dev_complete(struct virtqueue *vq, uint16_t id, uint32_t len, uint16_t ndescs)
+{
+	struct vring_packed_desc *desc = &vq->vq_packed_ring.desc[g_dev.used_idx];
+
+	desc->id = id;
+	desc->len = len;
+	desc->flags = g_dev.used_wrap_counter ? UT_AVAIL_USED : 0;
+
+	g_dev.used_idx += ndescs;
+	if (g_dev.used_idx >= vq->vq_nentries) {
+		g_dev.used_idx -= vq->vq_nentries;
+		g_dev.used_wrap_counter = !g_dev.used_wrap_counter;
+	}
+}
+
+static void
+ut_submit(struct virtqueue *vq, void *cookie, void *buf)
+{
+	struct iovec iov = { .iov_base = buf, .iov_len = 512 };
+	int rc;
+
+	rc = virtqueue_req_start(vq, cookie, 1);
+	CU_ASSERT(rc == 0);
+	virtqueue_req_add_iovs(vq, &iov, 1, SPDK_VIRTIO_DESC_WR);
+	virtqueue_req_flush(vq);
+}
+
+static void
+test_packed_desc_wrap(void)
+{
+	struct virtqueue *vq = ut_start();
+	char buf[512];
+	void *cookie;
+	uint32_t len;
+	uint16_t id, ndescs, lap, i;
+
+	for (lap = 0; lap < 3; lap++) {
+		for (i = 0; i < UT_VQ_SIZE; i++) {
+			ut_submit(vq, &buf[i], buf);
+
+			/* Descriptors are marked available with the flags of the current lap */
+			CU_ASSERT((vq->vq_packed_ring.desc[i].flags & UT_AVAIL_USED) ==
+				  (lap % 2 == 0 ? VQ_PACKED_DESC_F_AVAIL : VQ_PACKED_DESC_F_USED));
+			CU_ASSERT(!(vq->vq_packed_ring.desc[i].flags & VRING_DESC_F_NEXT));
+			CU_ASSERT(vq->vq_packed_ring.desc[i].flags & VRING_DESC_F_WRITE);
+			CU_ASSERT(g_notify_count == lap * UT_VQ_SIZE + i + 1);
+
+			ndescs = ut_dev_fetch(vq, &id, NULL);
+			CU_ASSERT(ndescs == 1);
+			ut_dev_complete(vq, id, i, ndescs);
+
+			CU_ASSERT(virtio_recv_pkts(vq, &cookie, &len, 1) == 1);
+			CU_ASSERT(cookie == &buf[i]);
+			CU_ASSERT(len == i);
+			CU_ASSERT(vq->vq_free_cnt == UT_VQ_SIZE);
+		}
+
+		CU_ASSERT(vq->vq_avail_idx == 0);
+		CU_ASSERT(vq->vq_used_cons_idx == 0);
+		CU_ASSERT(vq->vq_packed_ring.used_wrap_counter == (lap % 2 == 1));
+		CU_ASSERT((vq->vq_packed_ring.avail_flags == VQ_PACKED_DESC_F_AVAIL) == (lap % 2 == 1));
+
+		/* The used descriptors left from this lap must not be consumed again */
+		CU_ASSERT(virtio_recv_pkts(vq, &cookie, &len, 1) == 0);
+	}
+
+	ut_stop();
+}
+
+static void
+test_packed_chain_across_ring_end(void)
+{
+	struct virtqueue *vq = ut_start();
+	struct vring_packed_desc *desc;
+	char hdr[16], data[512], status;
+	struct iovec iov;
+	void *addrs[UT_VQ_SIZE];
+	void *cookie;
+	uint32_t len;
+	uint16_t id, ndescs, i;
+	int rc;
+
+	/* Move the ring to the position right before its end */
+	for (i = 0; i < 2; i++) {
+		ut_submit(vq, &data[i], data);
+		ndescs = ut_dev_fetch(vq, &id, NULL);
+		ut_dev_complete(vq, id, 0, ndescs);
+		CU_ASSERT(virtio_recv_pkts(vq, &cookie, &len, 1) == 1);
+	}
+	CU_ASSERT(vq->vq_avail_idx == 2);
+
+	/* A request spanning positions 2, 3 and 0 */
+	rc = virtqueue_req_start(vq, hdr, 2);
+	CU_ASSERT(rc == 0);
+	iov.iov_base = hdr;
+	iov.iov_len = sizeof(hdr);
+	virtqueue_req_add_iovs(vq, &iov, 1, SPDK_VIRTIO_DESC_RO);
+	iov.iov_base = data;
+	iov.iov_len = sizeof(data);
+	virtqueue_req_add_iovs(vq, &iov, 1, SPDK_VIRTIO_DESC_WR);
+	iov.iov_base = &status;
+	iov.iov_len = sizeof(status);
+	virtqueue_req_add_iovs(vq, &iov, 1, SPDK_VIRTIO_DESC_WR);
+	CU_ASSERT(vq->vq_free_cnt == UT_VQ_SIZE - 3);
+	CU_ASSERT(vq->vq_avail_idx == 1);
+
+	/* Until the flush, the head is left untouched and hides the whole chain */
+	desc = vq->vq_packed_ring.desc;
+	CU_ASSERT(!ut_dev_desc_is_avail(vq, 2, true));
+	CU_ASSERT(ut_dev_desc_is_avail(vq, 3, true));
+	CU_ASSERT(ut_dev_desc_is_avail(vq, 0, false));
+	CU_ASSERT(desc[3].flags & VRING_DESC_F_NEXT);
+	CU_ASSERT(ut_dev_fetch(vq, &id, NULL) == 0);
+
+	virtqueue_req_flush(vq);
+	CU_ASSERT(ut_dev_desc_is_avail(vq, 2, true));
+	CU_ASSERT((desc[2].flags & UT_AVAIL_USED) == VQ_PACKED_DESC_F_AVAIL);
+	CU_ASSERT((desc[0].flags & UT_AVAIL_USED) == VQ_PACKED_DESC_F_USED);
+	CU_ASSERT(desc[2].flags & VRING_DESC_F_NEXT);
+	CU_ASSERT(!(desc[2].flags & VRING_DESC_F_WRITE));
+	CU_ASSERT(desc[3].flags & VRING_DESC_F_NEXT);
+	CU_ASSERT(!(desc[0].flags & VRING_DESC_F_NEXT));
+	CU_ASSERT(desc[2].id == desc[3].id && desc[3].id == desc[0].id);
+
+	ndescs = ut_dev_fetch(vq, &id, addrs);
+	CU_ASSERT(ndescs == 3);
+	CU_ASSERT(addrs[0] == hdr);
+	CU_ASSERT(addrs[1] == data);
+	CU_ASSERT(addrs[2] == &status);
+
+	/* Nothing is used yet, the head still carries the driver's flags */
+	CU_ASSERT(virtio_recv_pkts(vq, &cookie, &len, 1) == 0);
+
+	/* The device writes a single used descriptor in place of the head */
+	ut_dev_complete(vq, id, sizeof(data) + 1, ndescs);
+	CU_ASSERT(virtio_recv_pkts(vq, &cookie, &len, 1) == 1);
+	CU_ASSERT(cookie == hdr);
+	CU_ASSERT(len == sizeof(data) + 1);
+	CU_ASSERT(vq->vq_used_cons_idx == 1);
+	CU_ASSERT(vq->vq_packed_ring.used_wrap_counter == false);
+	CU_ASSERT(vq->vq_free_cnt == UT_VQ_SIZE);
+
+	/* The ring keeps working in the next lap */
+	ut_submit(vq, data, data);
+	CU_ASSERT((desc[1].flags & UT_AVAIL_USED) == VQ_PACKED_DESC_F_USED);
+	ndescs = ut_dev_fetch(vq, &id, NULL);
+	CU_ASSERT(ndescs == 1);
+	ut_dev_complete(vq, id, 0, ndescs);
+	CU_ASSERT(virtio_recv_pkts(vq, &cookie, &len, 1) == 1);
+	CU_ASSERT(cookie == data);
+	CU_ASSERT(vq->vq_used_cons_idx == 2);
+
+	ut_stop();
+}
+
+static void
+test_packed_used_polling(void)
+{
+	struct virtqueue *vq = ut_start();
+	char buf[512];
+	void *cookies[2];
+	uint32_t lens[2];
+	uint16_t ids[2], ndescs;
+
+	/* An empty ring */
+	CU_ASSERT(virtio_recv_pkts(vq, cookies, lens, 2) == 0);
+
+	ut_submit(vq, &buf[0], buf);
+	ut_submit(vq, &buf[1], buf);
+	CU_ASSERT(vq->vq_free_cnt == UT_VQ_SIZE - 2);
+
+	/* Available descriptors must not be taken as used ones */
+	CU_ASSERT(virtio_recv_pkts(vq, cookies, lens, 2) == 0);
+
+	ndescs = ut_dev_fetch(vq, &ids[0], NULL);
+	CU_ASSERT(ndescs == 1);
+	ndescs = ut_dev_fetch(vq, &ids[1], NULL);
+	CU_ASSERT(ndescs == 1);
+	CU_ASSERT(ids[0] != ids[1]);
+
+	/* Complete the requests out of order, one at a time */
+	ut_dev_complete(vq, ids[1], 1, 1);
+	CU_ASSERT(virtio_recv_pkts(vq, cookies, lens, 2) == 1);
+	CU_ASSERT(cookies[0] == &buf[1]);
+	CU_ASSERT(lens[0] == 1);
+	CU_ASSERT(vq->vq_free_cnt == UT_VQ_SIZE - 1);
+	CU_ASSERT(virtio_recv_pkts(vq, cookies, lens, 2) == 0);
+
+	ut_dev_complete(vq, ids[0], 0, 1);
+	CU_ASSERT(virtio_recv_pkts(vq, cookies, lens, 2) == 1);
+	CU_ASSERT(cookies[0] == &buf[0]);
+	CU_ASSERT(vq->vq_free_cnt == UT_VQ_SIZE);
+
+	/* The freed buffer ids are handed out again */
+	ut_submit(vq, &buf[2], buf);
+	ndescs = ut_dev_fetch(vq, &ids[1], NULL);
+	CU_ASSERT(ndescs == 1);
+	CU_ASSERT(ids[1] == ids[0]);
+	ut_dev_complete(vq, ids[1], 0, 1);
+	CU_ASSERT(virtio_recv_pkts(vq, cookies, lens, 2) == 1);
+	CU_ASSERT(cookies[0] == &buf[2]);
+
+	ut_stop();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("virtio", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_packed_desc_wrap);
+	CU_ADD_TEST(suite, test_packed_chain_across_ring_end);
+	CU_ADD_TEST(suite, test_packed_used_polling);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
@@ -0,0 +1,169 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 The SPDK Authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "common/lib/test_env.c"
+
+#include "vmd/vmd.c"
+
+DEFINE_STUB(spdk_pci_device_cfg_read, int, (struct spdk_pci_device *dev, void *buf, uint32_t len,
+		uint32_t offset), 0);
+DEFINE_STUB(spdk_pci_device_cfg_read32, int, (struct spdk_pci_device *dev, uint32_t *value,
+		uint32_t offset), 0);
+DEFINE_STUB(spdk_pci_device_cfg_write32, int, (struct spdk_pci_device *dev, uint32_t value,
+		uint32_t offset), 0);
+DEFINE_STUB_V(spdk_pci_device_detach, (struct spdk_pci_device *device));
+DEFINE_STUB(spdk_pci_device_get_numa_id, int, (struct spdk_pci_device *dev), 0);
+DEFINE_STUB(spdk_pci_device_get_type, const char *, (const struct spdk_pci_device *dev), NULL);
+DEFINE_STUB(spdk_pci_device_map_bar, int, (struct spdk_pci_device *dev, uint32_t bar,
+		void **mapped_addr, uint64_t *phys_addr, uint64_t *size), 0);
+DEFINE_STUB(spdk_pci_enumerate, int, (struct spdk_pci_driver *driver, spdk_pci_enum_cb enum_cb,
+		void *enum_ctx), 0);
+DEFINE_STUB(spdk_pci_hook_device, int, (struct spdk_pci_driver *drv, struct spdk_pci_device *dev),
+		0);
+DEFINE_STUB_V(spdk_pci_register_device_provider, (struct spdk_pci_device_provider *provider));
+DEFINE_STUB_V(spdk_pci_unhook_device, (struct spdk_pci_device *dev));
+DEFINE_STUB(spdk_pci_vmd_get_driver, struct spdk_pci_driver *, (void), NULL);
+
+
+static struct pci_express_cap g_pcie_cap;
+static struct vmd_pci_device g_bridge;
+static struct vmd_pci_bus g_hp_bus;
+static struct vmd_pci_bus g_bus;
+
+/*
+ * Builds a domain with two buses: g_hp_bus, below a hotplug capable slot, and g_bus. The
+ * configuration space is empty, so scanning either bus never finds a device.
+ */
+static void
+ut_init_domain(void)
+{
+	struct vmd_adapter *vmd = &g_vmd_container.vmd[0];
+
+	memset(&g_vmd_container, 0, sizeof(g_vmd_container));
+	memset(&g_pcie_cap, 0, sizeof(g_pcie_cap));
+	memset(&g_bridge, 0, sizeof(g_bridge));
+	memset(&g_hp_bus, 0, sizeof(g_hp_bus));
+	memset(&g_bus, 0, sizeof(g_bus));
+
+	g_vmd_container.count = 1;
+	TAILQ_INIT(&vmd->bus_list);
+	TAILQ_INIT(&vmd->hp_bus_list);
+
+	g_bridge.pcie_cap = &g_pcie_cap;
+	g_bridge.hotplug_capable = true;
+
+	g_hp_bus.vmd = vmd;
+	g_hp_bus.self = &g_bridge;
+	TAILQ_INIT(&g_hp_bus.dev_list);
+	TAILQ_INSERT_TAIL(&vmd->bus_list, &g_hp_bus, tailq);
+	TAILQ_INSERT_TAIL(&vmd->hp_bus_list, &g_hp_bus, hp_tailq);
+
+	g_bus.vmd = vmd;
+	g_bus.self = &g_bridge;
+	TAILQ_INIT(&g_bus.dev_list);
+	TAILQ_INSERT_TAIL(&vmd->bus_list, &g_bus, tailq);
+
+	ut_spdk_get_ticks = 0;
+}
+
+static void
+test_hotplug_monitor_no_change(void)
+{
+	ut_init_domain();
+
+	/* Without a data link layer change, the slot status isn't cleared */
+	g_pcie_cap.slot_status.bit_field.presence_detect_changed = 1;
+
+	CU_ASSERT(spdk_vmd_hotplug_monitor() == 0);
+	CU_ASSERT(g_bridge.hp.slot_status.as_uint16_t == g_pcie_cap.slot_status.as_uint16_t);
+	CU_ASSERT(g_pcie_cap.slot_status.bit_field.presence_detect_changed == 1);
+	CU_ASSERT(g_hp_bus.hp_scan_deadline == 0);
+
+	/* Buses outside of hp_bus_list aren't monitored */
+	TAILQ_REMOVE(&g_vmd_container.vmd[0].hp_bus_list, &g_hp_bus, hp_tailq);
+	g_pcie_cap.slot_status.bit_field.datalink_state_changed = 1;
+
+	CU_ASSERT(spdk_vmd_hotplug_monitor() == 0);
+	CU_ASSERT(g_pcie_cap.slot_status.bit_field.datalink_state_changed == 1);
+}
+
+static void
+test_hotplug_monitor_hotremove(void)
+{
+	union express_slot_status_register status = {};
+
+	ut_init_domain();
+
+	status.bit_field.datalink_state_changed = 1;
+	status.bit_field.presence_detect_changed = 1;
+	g_pcie_cap.slot_status = status;
+	g_pcie_cap.link_status.bit_field.datalink_layer_active = 0;
+
+	CU_ASSERT(spdk_vmd_hotplug_monitor() == 1);
+	CU_ASSERT(g_bridge.hp.slot_status.as_uint16_t == status.as_uint16_t);
+	/* The status written back is the one that was handled */
+	CU_ASSERT(g_pcie_cap.slot_status.as_uint16_t == status.as_uint16_t);
+	CU_ASSERT(g_hp_bus.hp_scan_deadline == 0);
+
+	/* A change reported after the status was cached isn't cleared */
+	g_pcie_cap.slot_status.bit_field.power_fault_detected = 1;
+	vmd_clear_hotplug_status(&g_hp_bus);
+	CU_ASSERT(g_pcie_cap.slot_status.as_uint16_t == status.as_uint16_t);
+}
+
+static void
+test_hotplug_monitor_hotplug_deadline(void)
+{
+	uint64_t deadline = VMD_HOTPLUG_SCAN_TIMEOUT_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+
+	ut_init_domain();
+
+	/* The device isn't visible yet, the scan is retried instead of waiting for it */
+	ut_spdk_get_ticks = 1000;
+	g_pcie_cap.slot_status.bit_field.datalink_state_changed = 1;
+	g_pcie_cap.link_status.bit_field.datalink_layer_active = 1;
+
+	CU_ASSERT(spdk_vmd_hotplug_monitor() == 1);
+	CU_ASSERT(ut_spdk_get_ticks == 1000);
+	CU_ASSERT(g_hp_bus.hp_scan_deadline == 1000 + deadline);
+	CU_ASSERT(g_bridge.hp.slot_status.bit_field.datalink_state_changed == 1);
+
+	/* The change was acknowledged, only the retry runs on the next calls */
+	g_pcie_cap.slot_status.bit_field.datalink_state_changed = 0;
+	ut_spdk_get_ticks = 1000 + deadline - 1;
+
+	CU_ASSERT(spdk_vmd_hotplug_monitor() == 1);
+	CU_ASSERT(g_hp_bus.hp_scan_deadline == 1000 + deadline);
+
+	ut_spdk_get_ticks = 1000 + deadline;
+
+	CU_ASSERT(spdk_vmd_hotplug_monitor() == 1);
+	CU_ASSERT(g_hp_bus.hp_scan_deadline == 0);
+
+	CU_ASSERT(spdk_vmd_hotplug_monitor() == 0);
+	CU_ASSERT(g_hp_bus.hp_scan_deadline == 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("vmd", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_hotplug_monitor_no_change);
+	CU_ADD_TEST(suite, test_hotplug_monitor_hotremove);
+	CU_ADD_TEST(suite, test_hotplug_monitor_hotplug_deadline);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
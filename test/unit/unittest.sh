@@ -19,6 +19,7 @@ cd "$rootdir"
 function unittest_bdev() {
 	$valgrind $testdir/lib/bdev/bdev.c/bdev_ut
 	$valgrind $testdir/lib/bdev/nvme/bdev_nvme.c/bdev_nvme_ut
+	$valgrind $testdir/lib/bdev/nvme/bdev_nvme_rpc.c/bdev_nvme_rpc_ut
 	$valgrind $testdir/lib/bdev/raid/bdev_raid.c/bdev_raid_ut
 	$valgrind $testdir/lib/bdev/raid/bdev_raid_sb.c/bdev_raid_sb_ut
 	$valgrind $testdir/lib/bdev/raid/concat.c/concat_ut
@@ -30,6 +31,15 @@ function unittest_bdev() {
 	$valgrind $testdir/lib/bdev/scsi_nvme.c/scsi_nvme_ut
 	$valgrind $testdir/lib/bdev/vbdev_lvol.c/vbdev_lvol_ut
 	$valgrind $testdir/lib/bdev/vbdev_zone_block.c/vbdev_zone_block_ut
+	$valgrind $testdir/lib/bdev/vbdev_readahead.c/vbdev_readahead_ut
+	$valgrind $testdir/lib/bdev/vbdev_wbcache.c/vbdev_wbcache_ut
+	$valgrind $testdir/lib/bdev/vbdev_tier.c/vbdev_tier_ut
+	$valgrind $testdir/lib/bdev/vbdev_dedup.c/vbdev_dedup_ut
+	$valgrind $testdir/lib/bdev/vbdev_replica.c/vbdev_replica_ut
+	$valgrind $testdir/lib/bdev/bdev_malloc.c/bdev_malloc_ut
+	if [ $(uname -s) = Linux ]; then
+		$valgrind $testdir/lib/bdev/bdev_aio.c/bdev_aio_ut
+	fi
 	$valgrind $testdir/lib/bdev/mt/bdev.c/bdev_ut
 }
 
@@ -50,6 +60,7 @@ function unittest_blob() {
 function unittest_event() {
 	$valgrind $testdir/lib/event/app.c/app_ut
 	$valgrind $testdir/lib/event/reactor.c/reactor_ut
+	$valgrind $testdir/lib/event/gscheduler.c/gscheduler_ut
 }
 
 function unittest_ftl() {
@@ -62,6 +73,9 @@ function unittest_ftl() {
 	$valgrind $testdir/lib/ftl/ftl_sb/ftl_sb_ut
 	$valgrind $testdir/lib/ftl/ftl_layout_upgrade/ftl_layout_upgrade_ut
 	$valgrind $testdir/lib/ftl/ftl_p2l.c/ftl_p2l_ut
+	$valgrind $testdir/lib/ftl/ftl_nv_cache.c/ftl_nv_cache_ut
+	$valgrind $testdir/lib/ftl/ftl_l2p_cache.c/ftl_l2p_cache_ut
+	$valgrind $testdir/lib/ftl/ftl_mngt_recovery/ftl_mngt_recovery_ut
 }
 
 function unittest_iscsi() {
@@ -111,6 +125,7 @@ function unittest_nvmf() {
 	$valgrind $testdir/lib/nvmf/subsystem.c/subsystem_ut
 	$valgrind $testdir/lib/nvmf/tcp.c/tcp_ut
 	$valgrind $testdir/lib/nvmf/nvmf.c/nvmf_ut
+	$valgrind $testdir/lib/nvmf/nvmf_rpc.c/nvmf_rpc_ut
 }
 
 function unittest_scsi() {
@@ -140,6 +155,7 @@ function unittest_util() {
 	$valgrind $testdir/lib/util/crc64.c/crc64_ut
 	$valgrind $testdir/lib/util/string.c/string_ut
 	$valgrind $testdir/lib/util/dif.c/dif_ut
+	$valgrind $testdir/lib/util/gf.c/gf_ut
 	$valgrind $testdir/lib/util/iov.c/iov_ut
 	$valgrind $testdir/lib/util/math.c/math_ut
 	$valgrind $testdir/lib/util/pipe.c/pipe_ut
@@ -150,10 +166,15 @@ function unittest_util() {
 
 function unittest_fsdev() {
 	$valgrind $testdir/lib/fsdev/fsdev.c/fsdev_ut
+	$valgrind $testdir/lib/fsdev/fsdev_aio.c/fsdev_aio_ut
+	if [[ $CONFIG_URING == y ]]; then
+		$valgrind $testdir/lib/fsdev/uring_aio_mgr.c/uring_aio_mgr_ut
+	fi
 }
 
 function unittest_init() {
 	$valgrind $testdir/lib/init/subsystem.c/subsystem_ut
+	$valgrind $testdir/lib/init/json_config.c/json_config_ut
 }
 
 if [ $SPDK_RUN_VALGRIND -eq 1 ] && [ $SPDK_RUN_ASAN -eq 1 ]; then
@@ -212,6 +233,22 @@ if [[ $CONFIG_RAID5F == y ]]; then
 	run_test "unittest_bdev_raid5f" $valgrind $testdir/lib/bdev/raid/raid5f.c/raid5f_ut
 fi
 
+if [[ $CONFIG_RAID6F == y ]]; then
+	run_test "unittest_bdev_raid6f" $valgrind $testdir/lib/bdev/raid/raid6f.c/raid6f_ut
+fi
+
+if [[ $CONFIG_RBD == y ]]; then
+	run_test "unittest_bdev_rbd" $valgrind $testdir/lib/bdev/bdev_rbd.c/bdev_rbd_ut
+fi
+
+if [[ $CONFIG_URING == y ]]; then
+	run_test "unittest_bdev_uring" $valgrind $testdir/lib/bdev/bdev_uring.c/bdev_uring_ut
+fi
+
+if [[ $CONFIG_XNVME == y ]]; then
+	run_test "unittest_bdev_xnvme" $valgrind $testdir/lib/bdev/bdev_xnvme.c/bdev_xnvme_ut
+fi
+
 run_test "unittest_blob_blobfs" unittest_blob
 run_test "unittest_event" unittest_event
 if [ $(uname -s) = Linux ]; then
@@ -219,6 +256,9 @@ if [ $(uname -s) = Linux ]; then
 fi
 
 run_test "unittest_accel" $valgrind $testdir/lib/accel/accel.c/accel_ut
+if [[ $CONFIG_RDMA_PROV == mlx5_dv ]]; then
+	run_test "unittest_accel_mlx5" $valgrind $testdir/lib/accel/mlx5.c/accel_mlx5_ut
+fi
 run_test "unittest_ioat" $valgrind $testdir/lib/ioat/ioat.c/ioat_ut
 if [[ $CONFIG_IDXD == y ]]; then
 	run_test "unittest_idxd_user" $valgrind $testdir/lib/idxd/idxd_user.c/idxd_user_ut
@@ -227,6 +267,7 @@ run_test "unittest_iscsi" unittest_iscsi
 run_test "unittest_json" unittest_json
 run_test "unittest_rpc" unittest_rpc
 run_test "unittest_notify" $valgrind $testdir/lib/notify/notify.c/notify_ut
+run_test "unittest_trace_parser" $valgrind $testdir/lib/trace_parser/trace.c/trace_parser_ut
 run_test "unittest_nvme" unittest_nvme
 run_test "unittest_log" $valgrind $testdir/lib/log/log.c/log_ut
 run_test "unittest_lvol" $valgrind $testdir/lib/lvol/lvol.c/lvol_ut
@@ -266,10 +307,30 @@ fi
 if [[ $CONFIG_VHOST == y ]]; then
 	run_test "unittest_vhost" $valgrind $testdir/lib/vhost/vhost.c/vhost_ut
 fi
+if [[ $CONFIG_VIRTIO == y ]]; then
+	run_test "unittest_virtio" $valgrind $testdir/lib/virtio/virtio.c/virtio_ut
+fi
 run_test "unittest_dma" $valgrind $testdir/lib/dma/dma.c/dma_ut
+run_test "unittest_vmd" $valgrind $testdir/lib/vmd/vmd.c/vmd_ut
+if [ $(uname -s) = Linux ]; then
+	run_test "unittest_nbd" $valgrind $testdir/lib/nbd/nbd.c/nbd_ut
+fi
+if [[ $CONFIG_UBLK == y ]]; then
+	run_test "unittest_ublk" $valgrind $testdir/lib/ublk/ublk.c/ublk_ut
+fi
+if [[ $CONFIG_OCF == y ]]; then
+	run_test "unittest_env_ocf" $valgrind $testdir/lib/env_ocf/ocf_env.c/ocf_env_ut
+fi
 
 run_test "unittest_init" unittest_init
 run_test "unittest_keyring" $valgrind "$testdir/lib/keyring/keyring.c/keyring_ut"
+run_test "unittest_trace_record" $valgrind $testdir/app/trace_record/trace_record.c/trace_record_ut
+run_test "unittest_nvme_perf" $valgrind $testdir/app/spdk_nvme_perf/perf.c/perf_ut
+run_test "unittest_spdk_dd" $valgrind $testdir/app/spdk_dd/spdk_dd.c/spdk_dd_ut
+if [[ $CONFIG_FIO_PLUGIN == y ]]; then
+	run_test "unittest_fio_bdev" $valgrind $testdir/app/fio/bdev/fio_plugin.c/fio_plugin_ut
+fi
+run_test "unittest_bdevperf" $valgrind $testdir/examples/bdev/bdevperf/bdevperf.c/bdevperf_ut
 
 if [[ $CONFIG_COVERAGE == y ]]; then
 	$LCOV -q -d . -c --no-external -t "$(hostname)" -o $UT_COVERAGE/ut_cov_test.info